@@ -33,12 +33,75 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct LRUCacheOptions, high_pri_pool_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"use_frequency_admission",
+         {offsetof(struct LRUCacheOptions, use_frequency_admission),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"lock_free_lookup",
+         {offsetof(struct LRUCacheOptions, lock_free_lookup),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"min_shard_size",
+         {offsetof(struct LRUCacheOptions, min_shard_size), OptionType::kSizeT,
+          OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
+};
+
+// CompressedSecondaryCacheOptions extends LRUCacheOptions, so offsetof() is
+// only used on the base struct, and the fields of the derived struct are
+// parsed through the struct itself (at offset 0).
+static std::unordered_map<std::string, OptionTypeInfo>
+    comp_sec_cache_options_type_info = {
+        {"capacity",
+         {offsetof(struct LRUCacheOptions, capacity), OptionType::kSizeT,
+          OptionVerificationType::kNormal, OptionTypeFlags::kMutable}},
+        {"num_shard_bits",
+         {offsetof(struct LRUCacheOptions, num_shard_bits), OptionType::kInt,
+          OptionVerificationType::kNormal, OptionTypeFlags::kMutable}},
+        {"compression_type",
+         {0, OptionType::kCompressionType, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable,
+          [](const ConfigOptions& opts, const std::string& name,
+             const std::string& value, void* addr) {
+            auto* sec_cache_opts =
+                static_cast<CompressedSecondaryCacheOptions*>(addr);
+            return OptionTypeInfo(0, OptionType::kCompressionType)
+                .Parse(opts, name, value, &sec_cache_opts->compression_type);
+          }}},
+        {"compress_format_version",
+         {0, OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable,
+          [](const ConfigOptions& opts, const std::string& name,
+             const std::string& value, void* addr) {
+            auto* sec_cache_opts =
+                static_cast<CompressedSecondaryCacheOptions*>(addr);
+            return OptionTypeInfo(0, OptionType::kUInt32T)
+                .Parse(opts, name, value,
+                       &sec_cache_opts->compress_format_version);
+          }}},
 };
 #endif  // ROCKSDB_LITE
 
 Status SecondaryCache::CreateFromString(
     const ConfigOptions& config_options, const std::string& value,
     std::shared_ptr<SecondaryCache>* result) {
+  static const std::string kCompressedSecondaryCachePrefix =
+      "compressed_secondary_cache://";
+  if (value.compare(0, kCompressedSecondaryCachePrefix.size(),
+                    kCompressedSecondaryCachePrefix) == 0) {
+#ifndef ROCKSDB_LITE
+    std::string args = value.substr(kCompressedSecondaryCachePrefix.size());
+    CompressedSecondaryCacheOptions sec_cache_opts;
+    Status status = OptionTypeInfo::ParseStruct(
+        config_options, "", &comp_sec_cache_options_type_info, "", args,
+        &sec_cache_opts);
+    if (status.ok()) {
+      *result = NewCompressedSecondaryCache(sec_cache_opts);
+    }
+    return status;
+#else
+    return Status::NotSupported("Cannot load cache in LITE mode ", value);
+#endif  // ROCKSDB_LITE
+  }
   return LoadSharedObject<SecondaryCache>(config_options, value, nullptr,
                                           result);
 }
@@ -5,6 +5,7 @@
 
 #ifdef GFLAGS
 #include <cinttypes>
+#include <cmath>
 #include <cstdio>
 #include <limits>
 #include <set>
@@ -42,8 +43,46 @@ DEFINE_double(resident_ratio, 0.25,
               "Ratio of keys fitting in cache to keyspace.");
 DEFINE_uint64(ops_per_thread, 2000000U, "Number of operations per thread.");
 DEFINE_uint32(value_bytes, 8 * KiB, "Size of each value added.");
+DEFINE_bool(compressible_values, false,
+            "If true, values compress about 2:1, for evaluating a compressed "
+            "secondary cache.");
+DEFINE_string(value_size_distribution, "fixed",
+              "Charge of the values: \"fixed\" for the value size of the "
+              "tenant, or \"block\" for the spread of block cache entries "
+              "of a block-based table with that block size: mostly data "
+              "blocks within 25% of it, depending on where they were cut and "
+              "how well they compressed, and one in 16 entries an index or "
+              "filter partition 2 to 8 times as large. The size of a key "
+              "does not change.");
+DEFINE_string(tenant_value_bytes, "",
+              "Comma-separated value sizes, one per tenant sharing the "
+              "cache, each with keys of its own, e.g. 4096,16384,1024. "
+              "Empty for a single tenant with --value_bytes.");
+DEFINE_string(tenant_weights, "",
+              "Comma-separated shares of the operations, and of the cache "
+              "size the keys of each tenant span with --resident_ratio, one "
+              "per tenant of --tenant_value_bytes. Empty for equal shares.");
 
 DEFINE_uint32(skew, 5, "Degree of skew in key selection");
+DEFINE_string(key_distribution, "skew",
+              "How keys are picked: \"skew\" for the smallest of --skew + 1 "
+              "uniform picks, \"zipf\" for a Zipfian distribution with "
+              "--zipf_theta, or \"hot_set\" for a set of hot keys, see "
+              "--hot_set_fraction. Ignored with --skewed.");
+DEFINE_double(zipf_theta, 0.99,
+              "Skew of --key_distribution=zipf, in (0, 1); the larger, the "
+              "more skewed.");
+DEFINE_double(hot_set_fraction, 0.05,
+              "For --key_distribution=hot_set, the fraction of the keys of a "
+              "tenant that are hot.");
+DEFINE_double(hot_set_access_fraction, 0.9,
+              "For --key_distribution=hot_set, the fraction of operations on "
+              "the hot keys; the others pick any key uniformly.");
+DEFINE_uint64(hot_set_shift_ops, 0,
+              "For --key_distribution=hot_set, moves the hot keys on to the "
+              "next --hot_set_fraction of the keys every this many operations "
+              "of a thread, to model a shifting working set. 0 to never move "
+              "them.");
 DEFINE_bool(populate_cache, true, "Populate cache before operations");
 
 DEFINE_uint32(lookup_insert_percent, 87,
@@ -65,9 +104,19 @@ DEFINE_uint32(
 DEFINE_uint32(gather_stats_entries_per_lock, 256,
               "For Cache::ApplyToAllEntries");
 DEFINE_bool(skewed, false, "If true, skew the key access distribution");
+DEFINE_bool(lock_free_lookup, false,
+            "For LRUCache, look up entries without taking the shard mutex "
+            "(see LRUCacheOptions::lock_free_lookup).");
+DEFINE_bool(report_shard_stats, false,
+            "Print per-shard lookups, hits and lock contentions at the end, "
+            "and the shards that are hot.");
 #ifndef ROCKSDB_LITE
 DEFINE_string(secondary_cache_uri, "",
               "Full URI for creating a custom secondary cache object");
+DEFINE_uint64(secondary_cache_size, 0,
+              "If non-zero and --secondary_cache_uri is not set, layers a "
+              "compressed secondary cache of this many bytes under the LRU "
+              "cache.");
 static class std::shared_ptr<ROCKSDB_NAMESPACE::SecondaryCache> secondary_cache;
 #endif  // ROCKSDB_LITE
 
@@ -125,34 +174,85 @@ struct ThreadState {
   SharedState* shared;
   HistogramImpl latency_ns_hist;
   uint64_t duration_us = 0;
+  // By tenant
+  std::vector<uint64_t> lookups;
+  std::vector<uint64_t> hits;
 
   ThreadState(uint32_t index, SharedState* _shared)
       : tid(index), rnd(1000 + index), shared(_shared) {}
 };
 
+// Uniform in [0, 1)
+double RandomDouble(Random64& rnd) {
+  return static_cast<double>(rnd.Next() >> 11) / 9007199254740992.0;
+}
+
+// Picks ranks in [0, n), rank k with a probability proportional to
+// 1 / (k + 1)^theta, as in YCSB (Gray et al., "Quickly Generating
+// Billion-Record Synthetic Databases").
+class ZipfGenerator {
+ public:
+  ZipfGenerator(uint64_t n, double theta)
+      : n_(n),
+        theta_(theta),
+        zetan_(Zeta(n, theta)),
+        alpha_(1.0 / (1.0 - theta)),
+        eta_((1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) /
+             (1.0 - Zeta(2, theta) / zetan_)) {}
+
+  uint64_t Next(Random64& rnd) const {
+    const double u = RandomDouble(rnd);
+    const double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return std::min<uint64_t>(1, n_ - 1);
+    }
+    const auto rank = static_cast<uint64_t>(static_cast<double>(n_) *
+                                            std::pow(eta_ * u - eta_ + 1,
+                                                     alpha_));
+    return std::min(rank, n_ - 1);
+  }
+
+ private:
+  static double Zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+  }
+
+  const uint64_t n_;
+  const double theta_;
+  const double zetan_;
+  const double alpha_;
+  const double eta_;
+};
+
+// A set of keys sharing the cache, with a value size of its own
+struct Tenant {
+  uint32_t value_bytes = 0;
+  uint64_t max_key = 0;
+  // The tenant takes the operations with a random uint64_t below this, and
+  // not below that of the previous tenant
+  uint64_t op_threshold = 0;
+  // For --skewed
+  int max_log = 0;
+  std::unique_ptr<ZipfGenerator> zipf;
+};
+
 struct KeyGen {
   char key_data[27];
 
-  Slice GetRand(Random64& rnd, uint64_t max_key, int max_log) {
-    uint64_t key = 0;
-    if (!FLAGS_skewed) {
-      uint64_t raw = rnd.Next();
-      // Skew according to setting
-      for (uint32_t i = 0; i < FLAGS_skew; ++i) {
-        raw = std::min(raw, rnd.Next());
-      }
-      key = FastRange64(raw, max_key);
-    } else {
-      key = rnd.Skewed(max_log);
-      if (key > max_key) {
-        key -= max_key;
-      }
-    }
+  Slice Get(uint64_t key, size_t tenant) {
     // Variable size and alignment
     size_t off = key % 8;
     key_data[0] = char{42};
     EncodeFixed64(key_data + 1, key);
-    key_data[9] = char{11};
+    // Always in the key, whatever its offset
+    key_data[9] = static_cast<char>(11 + tenant);
     EncodeFixed64(key_data + 10, key);
     key_data[18] = char{4};
     EncodeFixed64(key_data + 19, key);
@@ -160,17 +260,49 @@ struct KeyGen {
   }
 };
 
-char* createValue(Random64& rnd) {
-  char* rv = new char[FLAGS_value_bytes];
+// The size of the value for `key` of a tenant with values of `value_bytes`,
+// see --value_size_distribution
+uint32_t ValueSize(const Slice& key, uint32_t value_bytes, bool block_sizes) {
+  uint32_t size = value_bytes;
+  if (block_sizes) {
+    const uint64_t h = GetSliceNPHash64(key);
+    if ((h & 15) == 0) {
+      // An index or filter partition
+      size = static_cast<uint32_t>(FastRange64(h >> 4, 6 * value_bytes)) +
+             2 * value_bytes;
+    } else {
+      // A data block
+      size = static_cast<uint32_t>(FastRange64(h >> 4, value_bytes / 2)) +
+             value_bytes * 3 / 4;
+    }
+  }
+  // Room for the size header
+  return std::max(size, uint32_t{16});
+}
+
+// Values start with their size, for SizeFn() and to use them
+uint32_t GetValueSize(const void* value) {
+  return DecodeFixed32(static_cast<const char*>(value));
+}
+
+char* createValue(Random64& rnd, uint32_t size) {
+  char* rv = new char[size];
   // Fill with some filler data, and take some CPU time
-  for (uint32_t i = 0; i < FLAGS_value_bytes; i += 8) {
-    EncodeFixed64(rv + i, rnd.Next());
+  for (uint32_t i = 0; i + 8 <= size; i += 8) {
+    if (FLAGS_compressible_values && (i & 8) != 0) {
+      // Repeat the previous 8 bytes
+      memcpy(rv + i, rv + i - 8, 8);
+    } else {
+      EncodeFixed64(rv + i, rnd.Next());
+    }
   }
+  memset(rv + (size & ~uint32_t{7}), 0, size & 7);
+  EncodeFixed32(rv, size);
   return rv;
 }
 
 // Callbacks for secondary cache
-size_t SizeFn(void* /*obj*/) { return FLAGS_value_bytes; }
+size_t SizeFn(void* obj) { return GetValueSize(obj); }
 
 Status SaveToFn(void* obj, size_t /*offset*/, size_t size, void* out) {
   memcpy(out, obj, size);
@@ -200,9 +332,7 @@ class CacheBench {
 
  public:
   CacheBench()
-      : max_key_(static_cast<uint64_t>(FLAGS_cache_size / FLAGS_resident_ratio /
-                                       FLAGS_value_bytes)),
-        lookup_insert_threshold_(kHundredthUint64 *
+      : lookup_insert_threshold_(kHundredthUint64 *
                                  FLAGS_lookup_insert_percent),
         insert_threshold_(lookup_insert_threshold_ +
                           kHundredthUint64 * FLAGS_insert_percent),
@@ -210,27 +340,95 @@ class CacheBench {
                           kHundredthUint64 * FLAGS_lookup_percent),
         erase_threshold_(lookup_threshold_ +
                          kHundredthUint64 * FLAGS_erase_percent),
-        skewed_(FLAGS_skewed) {
+        skewed_(FLAGS_skewed),
+        block_value_sizes_(FLAGS_value_size_distribution == "block") {
     if (erase_threshold_ != 100U * kHundredthUint64) {
       fprintf(stderr, "Percentages must add to 100.\n");
       exit(1);
     }
+    if (FLAGS_value_size_distribution != "fixed" && !block_value_sizes_) {
+      fprintf(stderr, "Unknown --value_size_distribution: %s\n",
+              FLAGS_value_size_distribution.c_str());
+      exit(1);
+    }
+    if (FLAGS_key_distribution == "zipf") {
+      key_distribution_ = kZipf;
+      if (!(FLAGS_zipf_theta > 0 && FLAGS_zipf_theta < 1)) {
+        fprintf(stderr, "--zipf_theta must be in (0, 1).\n");
+        exit(1);
+      }
+    } else if (FLAGS_key_distribution == "hot_set") {
+      key_distribution_ = kHotSet;
+    } else if (FLAGS_key_distribution != "skew") {
+      fprintf(stderr, "Unknown --key_distribution: %s\n",
+              FLAGS_key_distribution.c_str());
+      exit(1);
+    }
 
-    max_log_ = 0;
-    if (skewed_) {
-      uint64_t max_key = max_key_;
-      while (max_key >>= 1) max_log_++;
-      if (max_key > (1u << max_log_)) max_log_++;
+    std::vector<uint32_t> value_bytes;
+    for (const std::string& s : StringSplit(FLAGS_tenant_value_bytes, ',')) {
+      value_bytes.push_back(ParseUint32(s));
+    }
+    if (value_bytes.empty()) {
+      value_bytes.push_back(FLAGS_value_bytes);
+    }
+    std::vector<double> weights;
+    for (const std::string& s : StringSplit(FLAGS_tenant_weights, ',')) {
+      weights.push_back(ParseDouble(s));
+    }
+    if (weights.empty()) {
+      weights.assign(value_bytes.size(), 1.0);
+    }
+    if (weights.size() != value_bytes.size()) {
+      fprintf(stderr, "--tenant_weights needs one weight per tenant.\n");
+      exit(1);
+    }
+    double total_weight = 0;
+    for (double weight : weights) {
+      total_weight += weight;
+    }
+    double cumulative_weight = 0;
+    double avg_value_bytes = 0;
+    for (size_t i = 0; i < value_bytes.size(); i++) {
+      tenants_.emplace_back();
+      Tenant& tenant = tenants_.back();
+      tenant.value_bytes = value_bytes[i];
+      const double share = weights[i] / total_weight;
+      avg_value_bytes += share * value_bytes[i];
+      tenant.max_key = std::max<uint64_t>(
+          1, static_cast<uint64_t>(FLAGS_cache_size * share /
+                                   FLAGS_resident_ratio / value_bytes[i]));
+      cumulative_weight += weights[i];
+      tenant.op_threshold =
+          i + 1 == value_bytes.size()
+              ? std::numeric_limits<uint64_t>::max()
+              : static_cast<uint64_t>(cumulative_weight / total_weight *
+                                      static_cast<double>(std::numeric_limits<
+                                                          uint64_t>::max()));
+      if (skewed_) {
+        uint64_t max_key = tenant.max_key;
+        while (max_key >>= 1) tenant.max_log++;
+        if (max_key > (1u << tenant.max_log)) tenant.max_log++;
+      }
+      if (key_distribution_ == kZipf) {
+        tenant.zipf.reset(
+            new ZipfGenerator(tenant.max_key, FLAGS_zipf_theta));
+      }
     }
 
     if (FLAGS_use_clock_cache) {
-      cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+      cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits,
+                             false /*strict_capacity_limit*/,
+                             kDefaultCacheMetadataChargePolicy,
+                             static_cast<size_t>(avg_value_bytes)
+                             /*estimated_entry_charge*/);
       if (!cache_) {
         fprintf(stderr, "Clock cache not supported.\n");
         exit(1);
       }
     } else {
       LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits, false, 0.5);
+      opts.lock_free_lookup = FLAGS_lock_free_lookup;
 #ifndef ROCKSDB_LITE
       if (!FLAGS_secondary_cache_uri.empty()) {
         Status s = SecondaryCache::CreateFromString(
@@ -243,6 +441,10 @@ class CacheBench {
           exit(1);
         }
         opts.secondary_cache = secondary_cache;
+      } else if (FLAGS_secondary_cache_size > 0) {
+        secondary_cache = NewCompressedSecondaryCache(
+            static_cast<size_t>(FLAGS_secondary_cache_size));
+        opts.secondary_cache = secondary_cache;
       }
 #endif  // ROCKSDB_LITE
 
@@ -255,9 +457,13 @@ class CacheBench {
   void PopulateCache() {
     Random64 rnd(1);
     KeyGen keygen;
-    for (uint64_t i = 0; i < 2 * FLAGS_cache_size; i += FLAGS_value_bytes) {
-      cache_->Insert(keygen.GetRand(rnd, max_key_, max_log_), createValue(rnd),
-                     &helper1, FLAGS_value_bytes);
+    for (uint64_t i = 0; i < 2 * FLAGS_cache_size;) {
+      const size_t t = PickTenant(rnd);
+      const Slice key = keygen.Get(PickKey(rnd, t, 0 /* op */), t);
+      const uint32_t size =
+          ValueSize(key, tenants_[t].value_bytes, block_value_sizes_);
+      cache_->Insert(key, createValue(rnd, size), &helper1, size);
+      i += size;
     }
   }
 
@@ -324,6 +530,18 @@ class CacheBench {
     }
     printf("%s", combined.ToString().c_str());
 
+    printf("\nTenant  Lookups      Hit rate\n");
+    for (size_t t = 0; t < tenants_.size(); t++) {
+      uint64_t lookups = 0;
+      uint64_t hits = 0;
+      for (uint32_t i = 0; i < FLAGS_threads; i++) {
+        lookups += threads[i]->lookups[t];
+        hits += threads[i]->hits[t];
+      }
+      printf("%-7" ROCKSDB_PRIszt " %-12" PRIu64 " %.2f%%\n", t, lookups,
+             lookups > 0 ? 100.0 * hits / lookups : 0.0);
+    }
+
     if (FLAGS_gather_stats) {
       printf("\nGather stats latency (us):\n");
       printf("%s", stats_hist.ToString().c_str());
@@ -331,19 +549,72 @@ class CacheBench {
 
     printf("\n%s", stats_report.c_str());
 
+    if (FLAGS_report_shard_stats) {
+      PrintShardStats();
+    }
+
     return true;
   }
 
  private:
+  enum KeyDistribution { kSkew, kZipf, kHotSet };
+
   std::shared_ptr<Cache> cache_;
-  const uint64_t max_key_;
   // Cumulative thresholds in the space of a random uint64_t
   const uint64_t lookup_insert_threshold_;
   const uint64_t insert_threshold_;
   const uint64_t lookup_threshold_;
   const uint64_t erase_threshold_;
   const bool skewed_;
-  int max_log_;
+  const bool block_value_sizes_;
+  KeyDistribution key_distribution_ = kSkew;
+  std::vector<Tenant> tenants_;
+
+  size_t PickTenant(Random64& rnd) const {
+    if (tenants_.size() == 1) {
+      return 0;
+    }
+    const uint64_t raw = rnd.Next();
+    size_t t = 0;
+    while (raw >= tenants_[t].op_threshold && t + 1 < tenants_.size()) {
+      t++;
+    }
+    return t;
+  }
+
+  // Picks a key of tenant `t` for the `op`-th operation of a thread
+  uint64_t PickKey(Random64& rnd, size_t t, uint64_t op) const {
+    const Tenant& tenant = tenants_[t];
+    uint64_t key = 0;
+    if (skewed_) {
+      key = rnd.Skewed(tenant.max_log);
+      if (key > tenant.max_key) {
+        key -= tenant.max_key;
+      }
+    } else if (key_distribution_ == kZipf) {
+      key = tenant.zipf->Next(rnd);
+    } else if (key_distribution_ == kHotSet) {
+      const uint64_t hot_keys = std::max<uint64_t>(
+          1, static_cast<uint64_t>(FLAGS_hot_set_fraction *
+                                   static_cast<double>(tenant.max_key)));
+      if (RandomDouble(rnd) < FLAGS_hot_set_access_fraction) {
+        const uint64_t shifts =
+            FLAGS_hot_set_shift_ops > 0 ? op / FLAGS_hot_set_shift_ops : 0;
+        key = (shifts * hot_keys + FastRange64(rnd.Next(), hot_keys)) %
+              tenant.max_key;
+      } else {
+        key = FastRange64(rnd.Next(), tenant.max_key);
+      }
+    } else {
+      uint64_t raw = rnd.Next();
+      // Skew according to setting
+      for (uint32_t i = 0; i < FLAGS_skew; ++i) {
+        raw = std::min(raw, rnd.Next());
+      }
+      key = FastRange64(raw, tenant.max_key);
+    }
+    return key;
+  }
 
   // A benchmark version of gathering stats on an active block cache by
   // iterating over it. The primary purpose is to measure the impact of
@@ -448,10 +719,15 @@ class CacheBench {
     const auto clock = SystemClock::Default().get();
     uint64_t start_time = clock->NowMicros();
     StopWatchNano timer(clock);
+    thread->lookups.assign(tenants_.size(), 0);
+    thread->hits.assign(tenants_.size(), 0);
 
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
       timer.Start();
-      Slice key = gen.GetRand(thread->rnd, max_key_, max_log_);
+      const size_t t = PickTenant(thread->rnd);
+      Slice key = gen.Get(PickKey(thread->rnd, t, i), t);
+      const uint32_t value_size =
+          ValueSize(key, tenants_[t].value_bytes, block_value_sizes_);
       uint64_t random_op = thread->rnd.Next();
       Cache::CreateCallback create_cb =
           [](void* buf, size_t size, void** out_obj, size_t* charge) -> Status {
@@ -469,14 +745,17 @@ class CacheBench {
         // do lookup
         handle = cache_->Lookup(key, &helper2, create_cb, Cache::Priority::LOW,
                                 true);
+        thread->lookups[t]++;
         if (handle) {
+          thread->hits[t]++;
           // do something with the data
-          result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                             FLAGS_value_bytes);
+          void* value = cache_->Value(handle);
+          result +=
+              NPHash64(static_cast<char*>(value), GetValueSize(value));
         } else {
           // do insert
-          cache_->Insert(key, createValue(thread->rnd), &helper2,
-                         FLAGS_value_bytes, &handle);
+          cache_->Insert(key, createValue(thread->rnd, value_size), &helper2,
+                         value_size, &handle);
         }
       } else if (random_op < insert_threshold_) {
         if (handle) {
@@ -484,8 +763,8 @@ class CacheBench {
           handle = nullptr;
         }
         // do insert
-        cache_->Insert(key, createValue(thread->rnd), &helper3,
-                       FLAGS_value_bytes, &handle);
+        cache_->Insert(key, createValue(thread->rnd, value_size), &helper3,
+                       value_size, &handle);
       } else if (random_op < lookup_threshold_) {
         if (handle) {
           cache_->Release(handle);
@@ -494,10 +773,13 @@ class CacheBench {
         // do lookup
         handle = cache_->Lookup(key, &helper2, create_cb, Cache::Priority::LOW,
                                 true);
+        thread->lookups[t]++;
         if (handle) {
+          thread->hits[t]++;
           // do something with the data
-          result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                             FLAGS_value_bytes);
+          void* value = cache_->Value(handle);
+          result +=
+              NPHash64(static_cast<char*>(value), GetValueSize(value));
         }
       } else if (random_op < erase_threshold_) {
         // do erase
@@ -520,6 +802,23 @@ class CacheBench {
     thread->duration_us = clock->NowMicros() - start_time;
   }
 
+  void PrintShardStats() const {
+    std::vector<CacheShardStats> shard_stats;
+    cache_->GetShardStats(&shard_stats);
+    printf("\nShard  Lookups      Hits         Inserts      Contentions\n");
+    for (size_t i = 0; i < shard_stats.size(); i++) {
+      const CacheShardStats& s = shard_stats[i];
+      printf("%-6" ROCKSDB_PRIszt " %-12" PRIu64 " %-12" PRIu64 " %-12" PRIu64 " %" PRIu64
+             "\n",
+             i, s.lookups, s.hits, s.inserts, s.lock_contentions);
+    }
+    printf("Hot shards          :");
+    for (size_t i : FindHotCacheShards(shard_stats)) {
+      printf(" %" ROCKSDB_PRIszt, i);
+    }
+    printf("\n");
+  }
+
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
     printf("Number of threads   : %u\n", FLAGS_threads);
@@ -527,9 +826,27 @@ class CacheBench {
     printf("Cache size          : %s\n",
            BytesToHumanString(FLAGS_cache_size).c_str());
     printf("Num shard bits      : %u\n", FLAGS_num_shard_bits);
-    printf("Max key             : %" PRIu64 "\n", max_key_);
+    for (size_t t = 0; t < tenants_.size(); t++) {
+      printf("Tenant %-2" ROCKSDB_PRIszt "           : %s values, %" PRIu64
+             " keys\n",
+             t, BytesToHumanString(tenants_[t].value_bytes).c_str(),
+             tenants_[t].max_key);
+    }
     printf("Resident ratio      : %g\n", FLAGS_resident_ratio);
-    printf("Skew degree         : %u\n", FLAGS_skew);
+    printf("Value sizes         : %s\n",
+           FLAGS_value_size_distribution.c_str());
+    if (skewed_) {
+      printf("Key distribution    : skewed\n");
+    } else if (key_distribution_ == kZipf) {
+      printf("Key distribution    : zipf (theta %g)\n", FLAGS_zipf_theta);
+    } else if (key_distribution_ == kHotSet) {
+      printf("Key distribution    : hot set (%g of keys, %g of ops, moves "
+             "every %" PRIu64 " ops)\n",
+             FLAGS_hot_set_fraction, FLAGS_hot_set_access_fraction,
+             FLAGS_hot_set_shift_ops);
+    } else {
+      printf("Skew degree         : %u\n", FLAGS_skew);
+    }
     printf("Populate cache      : %d\n", int{FLAGS_populate_cache});
     printf("Lookup+Insert pct   : %u%%\n", FLAGS_lookup_insert_percent);
     printf("Insert percentage   : %u%%\n", FLAGS_insert_percent);
@@ -543,6 +860,13 @@ class CacheBench {
       stats << "disabled";
     }
     printf("Gather stats        : %s\n", stats.str().c_str());
+#ifndef ROCKSDB_LITE
+    if (secondary_cache) {
+      printf("Compressible values : %d\n", int{FLAGS_compressible_values});
+      printf("Secondary cache     : %s\n%s", secondary_cache->Name(),
+             secondary_cache->GetPrintableOptions().c_str());
+    }
+#endif  // ROCKSDB_LITE
     printf("----------------------------\n");
   }
 };
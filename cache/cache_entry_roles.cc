@@ -19,6 +19,8 @@ std::array<const char*, kNumCacheEntryRoles> kCacheEntryRoleToCamelString{{
     "IndexBlock",
     "OtherBlock",
     "WriteBuffer",
+    "FilterConstruction",
+    "BlobValue",
     "Misc",
 }};
 
@@ -30,6 +32,8 @@ std::array<const char*, kNumCacheEntryRoles> kCacheEntryRoleToHyphenString{{
     "index-block",
     "other-block",
     "write-buffer",
+    "filter-construction",
+    "blob-value",
     "misc",
 }};
 
@@ -29,6 +29,11 @@ enum class CacheEntryRole {
   kOtherBlock,
   // WriteBufferManager reservations to account for memtable usage
   kWriteBuffer,
+  // Filter builder reservations to account for the memory used while
+  // building filters (see BlockBasedTableOptions::reserve_table_builder_memory)
+  kFilterConstruction,
+  // Uncompressed blob values (see ColumnFamilyOptions::blob_cache)
+  kBlobValue,
   // Default bucket, for miscellaneous cache entries. Do not use for
   // entries that could potentially add up to large usage.
   kMisc,
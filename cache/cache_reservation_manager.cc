@@ -0,0 +1,63 @@
+//  Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/cache_reservation_manager.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace ROCKSDB_NAMESPACE {
+
+constexpr size_t CacheReservationManager::kSizeDummyEntry;
+
+CacheReservationManager::CacheReservationManager(std::shared_ptr<Cache> cache)
+    : cache_(std::move(cache)) {
+  assert(cache_ != nullptr);
+  // Construct the cache key using the pointer to this.
+  memset(cache_key_, 0, kCacheKeyPrefixSize);
+  size_t pointer_size = sizeof(const void*);
+  assert(pointer_size <= kCacheKeyPrefixSize);
+  memcpy(cache_key_, static_cast<const void*>(this), pointer_size);
+}
+
+CacheReservationManager::~CacheReservationManager() {
+  for (auto* handle : dummy_handles_) {
+    cache_->Release(handle, true);
+  }
+}
+
+template <CacheEntryRole R>
+Status CacheReservationManager::UpdateCacheReservation(size_t new_mem_used) {
+  while (GetTotalReservedCacheSize() < new_mem_used) {
+    Cache::Handle* handle = nullptr;
+    Status s = cache_->Insert(GetNextCacheKey(), nullptr, kSizeDummyEntry,
+                              GetNoopDeleterForRole<R>(), &handle);
+    if (!s.ok()) {
+      return s;
+    }
+    dummy_handles_.push_back(handle);
+  }
+  while (GetTotalReservedCacheSize() >= new_mem_used + kSizeDummyEntry) {
+    cache_->Release(dummy_handles_.back(), true);
+    dummy_handles_.pop_back();
+  }
+  return Status::OK();
+}
+
+// Explicitly instantiate templates for the roles that reserve memory
+template Status CacheReservationManager::UpdateCacheReservation<
+    CacheEntryRole::kFilterConstruction>(size_t new_mem_used);
+template Status
+CacheReservationManager::UpdateCacheReservation<CacheEntryRole::kMisc>(
+    size_t new_mem_used);
+
+Slice CacheReservationManager::GetNextCacheKey() {
+  memset(cache_key_ + kCacheKeyPrefixSize, 0, kMaxVarint64Length);
+  char* end =
+      EncodeVarint64(cache_key_ + kCacheKeyPrefixSize, next_cache_key_id_++);
+  return Slice(cache_key_, static_cast<size_t>(end - cache_key_));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
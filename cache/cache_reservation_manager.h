@@ -0,0 +1,68 @@
+//  Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "cache/cache_entry_roles.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Charges memory that is not itself stored in a Cache to that cache, by
+// inserting dummy entries of kSizeDummyEntry bytes each, the same way
+// WriteBufferManager accounts memtable memory. This lets temporary
+// allocations (e.g. while building a table) compete with cached blocks for
+// the block cache capacity, and fail cleanly when a cache with
+// strict_capacity_limit is full.
+//
+// Not thread-safe; each user is expected to own its manager.
+class CacheReservationManager {
+ public:
+  static constexpr size_t kSizeDummyEntry = 256 * 1024;
+
+  explicit CacheReservationManager(std::shared_ptr<Cache> cache);
+
+  // No copying allowed
+  CacheReservationManager(const CacheReservationManager&) = delete;
+  CacheReservationManager& operator=(const CacheReservationManager&) = delete;
+
+  // Releases all reserved dummy entries
+  ~CacheReservationManager();
+
+  // Inserts or releases dummy entries, tagged with role R, so that the
+  // reservation is the smallest multiple of kSizeDummyEntry covering
+  // new_mem_used. Returns the error from Cache::Insert (Status::Incomplete
+  // if the cache is full and strict_capacity_limit is set) when growing
+  // fails; the reservation then stays at what could be inserted.
+  template <CacheEntryRole R>
+  Status UpdateCacheReservation(size_t new_mem_used);
+
+  // Total size charged to the cache, a multiple of kSizeDummyEntry
+  size_t GetTotalReservedCacheSize() const {
+    return dummy_handles_.size() * kSizeDummyEntry;
+  }
+
+ private:
+  // Same as WriteBufferManager, the keys are longer than keys for blocks in
+  // SST files so they won't conflict.
+  static constexpr size_t kCacheKeyPrefixSize = kMaxVarint64Length * 4 + 1;
+
+  Slice GetNextCacheKey();
+
+  std::shared_ptr<Cache> cache_;
+  std::vector<Cache::Handle*> dummy_handles_;
+  // The non-prefix part will be updated according to the ID to use.
+  char cache_key_[kCacheKeyPrefixSize + kMaxVarint64Length];
+  uint64_t next_cache_key_id_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
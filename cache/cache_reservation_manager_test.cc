@@ -0,0 +1,106 @@
+//  Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/cache_reservation_manager.h"
+
+#include <memory>
+
+#include "cache/cache_entry_roles.h"
+#include "rocksdb/cache.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CacheReservationManagerTest : public testing::Test {
+ protected:
+  static constexpr size_t kSizeDummyEntry =
+      CacheReservationManager::kSizeDummyEntry;
+  static constexpr size_t kCacheCapacity = 4096 * kSizeDummyEntry;
+
+  CacheReservationManagerTest() {
+    LRUCacheOptions lo;
+    lo.capacity = kCacheCapacity;
+    lo.num_shard_bits = 0;
+    lo.metadata_charge_policy = kDontChargeCacheMetadata;
+    cache_ = NewLRUCache(lo);
+    manager_.reset(new CacheReservationManager(cache_));
+  }
+
+  std::shared_ptr<Cache> cache_;
+  std::unique_ptr<CacheReservationManager> manager_;
+};
+
+constexpr size_t CacheReservationManagerTest::kSizeDummyEntry;
+constexpr size_t CacheReservationManagerTest::kCacheCapacity;
+
+TEST_F(CacheReservationManagerTest, GrowAndShrink) {
+  ASSERT_EQ(0U, manager_->GetTotalReservedCacheSize());
+
+  // Rounded up to whole dummy entries
+  ASSERT_OK(manager_->UpdateCacheReservation<CacheEntryRole::kMisc>(1));
+  ASSERT_EQ(kSizeDummyEntry, manager_->GetTotalReservedCacheSize());
+  ASSERT_EQ(kSizeDummyEntry, cache_->GetPinnedUsage());
+
+  ASSERT_OK(manager_->UpdateCacheReservation<CacheEntryRole::kMisc>(
+      10 * kSizeDummyEntry + 1));
+  ASSERT_EQ(11 * kSizeDummyEntry, manager_->GetTotalReservedCacheSize());
+  ASSERT_EQ(11 * kSizeDummyEntry, cache_->GetPinnedUsage());
+
+  ASSERT_OK(manager_->UpdateCacheReservation<CacheEntryRole::kMisc>(
+      3 * kSizeDummyEntry));
+  ASSERT_EQ(3 * kSizeDummyEntry, manager_->GetTotalReservedCacheSize());
+  ASSERT_EQ(3 * kSizeDummyEntry, cache_->GetPinnedUsage());
+
+  ASSERT_OK(manager_->UpdateCacheReservation<CacheEntryRole::kMisc>(0));
+  ASSERT_EQ(0U, manager_->GetTotalReservedCacheSize());
+  ASSERT_EQ(0U, cache_->GetUsage());
+}
+
+TEST_F(CacheReservationManagerTest, ReleaseOnDestruction) {
+  ASSERT_OK(manager_->UpdateCacheReservation<CacheEntryRole::kMisc>(
+      5 * kSizeDummyEntry));
+  ASSERT_EQ(5 * kSizeDummyEntry, cache_->GetUsage());
+  manager_.reset();
+  ASSERT_EQ(0U, cache_->GetUsage());
+}
+
+TEST_F(CacheReservationManagerTest, StrictCapacityLimit) {
+  cache_->SetStrictCapacityLimit(true);
+  Status s = manager_->UpdateCacheReservation<CacheEntryRole::kMisc>(
+      kCacheCapacity + 1);
+  ASSERT_TRUE(s.IsIncomplete()) << s.ToString();
+  // Keeps what fit
+  ASSERT_EQ(kCacheCapacity, manager_->GetTotalReservedCacheSize());
+
+  ASSERT_OK(manager_->UpdateCacheReservation<CacheEntryRole::kMisc>(
+      kSizeDummyEntry));
+  ASSERT_EQ(kSizeDummyEntry, manager_->GetTotalReservedCacheSize());
+}
+
+TEST_F(CacheReservationManagerTest, EntriesTaggedWithRole) {
+  ASSERT_OK(
+      manager_->UpdateCacheReservation<CacheEntryRole::kFilterConstruction>(
+          2 * kSizeDummyEntry));
+  auto role_map = CopyCacheDeleterRoleMap();
+  size_t tagged = 0;
+  cache_->ApplyToAllEntries(
+      [&](const Slice& /*key*/, void* /*value*/, size_t charge,
+          Cache::DeleterFn deleter) {
+        auto it = role_map.find(deleter);
+        if (it != role_map.end() &&
+            it->second == CacheEntryRole::kFilterConstruction) {
+          tagged += charge;
+        }
+      },
+      {});
+  ASSERT_EQ(2 * kSizeDummyEntry, tagged);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -9,15 +9,18 @@
 
 #include "rocksdb/cache.h"
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include "cache/clock_cache.h"
 #include "cache/lru_cache.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -100,8 +103,9 @@ class CacheTest : public testing::TestWithParam<std::string> {
       return NewLRUCache(co);
     }
     if (type == kClock) {
+      // Tests insert entries of charge 1, so size the table for them.
       return NewClockCache(capacity, num_shard_bits, strict_capacity_limit,
-                           charge_policy);
+                           charge_policy, /*estimated_entry_charge*/ 1);
     }
     return nullptr;
   }
@@ -152,6 +156,7 @@ class CacheTest : public testing::TestWithParam<std::string> {
 CacheTest* CacheTest::current_;
 
 class LRUCacheTest : public CacheTest {};
+class ClockCacheTest : public CacheTest {};
 
 TEST_P(CacheTest, UsageTest) {
   // cache is std::shared_ptr and will be automatically cleaned up.
@@ -389,9 +394,10 @@ TEST_P(CacheTest, ExternalRefPinsEntries) {
       // the below insertions should push out the cache entry.
       cache_->Release(h);
     }
-    // double cache size because the usage bit in block cache prevents 100 from
-    // being evicted in the first kCacheSize iterations
-    for (int j = 0; j < 2 * kCacheSize + 100; j++) {
+    // Insert several times the cache size, because the usage bit (clock
+    // countdown) of 100 protects it until the clock hand has passed over it
+    // twice, and the hand only moves as far as needed to evict.
+    for (int j = 0; j < 5 * kCacheSize; j++) {
       Insert(1000 + j, 2000 + j);
     }
     if (i < 2) {
@@ -420,7 +426,7 @@ TEST_P(CacheTest, EvictionPolicyRef) {
   Insert(303, 104);
 
   // Insert entries much more than Cache capacity
-  for (int i = 0; i < kCacheSize * 2; i++) {
+  for (int i = 0; i < kCacheSize * 5; i++) {
     Insert(1000 + i, 2000 + i);
   }
 
@@ -831,15 +837,93 @@ TEST_P(CacheTest, GetChargeAndDeleter) {
   cache_->Release(h1);
 }
 
-#ifdef SUPPORT_CLOCK_CACHE
-std::shared_ptr<Cache> (*new_clock_cache_func)(
-    size_t, int, bool, CacheMetadataChargePolicy) = NewClockCache;
+TEST_P(CacheTest, ConcurrentInsertLookupErase) {
+  // Many threads insert, look up, pin and erase a small set of keys, so that
+  // they race on the same entries. All charges must be accounted for once
+  // every handle is released.
+  std::shared_ptr<Cache> cache = NewCache(100, 2, false);
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 200;
+  constexpr int kOpsPerThread = 20000;
+  std::atomic<int> num_deleted{0};
+  std::atomic<int> num_inserted{0};
+  static std::atomic<int>* deleted_counter;
+  deleted_counter = &num_deleted;
+  auto counting_deleter = [](const Slice& /*key*/, void* /*value*/) {
+    deleted_counter->fetch_add(1);
+  };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      for (int i = 0; i < kOpsPerThread; i++) {
+        std::string key = EncodeKey(rnd.Uniform(kNumKeys));
+        switch (rnd.Uniform(4)) {
+          case 0: {
+            Cache::Handle* handle = nullptr;
+            Status s = cache->Insert(key, EncodeValue(DecodeKey(key)), 1,
+                                     counting_deleter, &handle);
+            if (s.ok()) {
+              num_inserted.fetch_add(1);
+              ASSERT_EQ(DecodeKey(key), DecodeValue(cache->Value(handle)));
+              cache->Release(handle);
+            }
+            break;
+          }
+          case 1:
+            ASSERT_OK(cache->Insert(key, EncodeValue(DecodeKey(key)), 1,
+                                    counting_deleter));
+            num_inserted.fetch_add(1);
+            break;
+          case 2: {
+            Cache::Handle* handle = cache->Lookup(key);
+            if (handle != nullptr) {
+              ASSERT_EQ(DecodeKey(key), DecodeValue(cache->Value(handle)));
+              cache->Release(handle);
+            }
+            break;
+          }
+          default:
+            cache->Erase(key);
+            break;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0U, cache->GetPinnedUsage());
+  ASSERT_LE(cache->GetUsage(), 100U);
+  cache->EraseUnRefEntries();
+  ASSERT_EQ(0U, cache->GetUsage());
+  ASSERT_EQ(num_inserted.load(), num_deleted.load());
+}
+
+TEST_P(ClockCacheTest, HighPriorityEntriesSurviveLonger) {
+  std::shared_ptr<Cache> cache = NewCache(100, 0, false);
+  ASSERT_OK(cache->Insert(EncodeKey(1), EncodeValue(1), 1,
+                          &CacheTest::Deleter, nullptr,
+                          Cache::Priority::HIGH));
+  ASSERT_OK(cache->Insert(EncodeKey(2), EncodeValue(2), 1,
+                          &CacheTest::Deleter, nullptr,
+                          Cache::Priority::LOW));
+  // Evict about 150 entries, so that the clock hand goes around the table
+  // one to two times. The low priority entry is evicted the first time the
+  // hand passes over it, while the high priority entry survives two passes.
+  for (int i = 0; i < 250; i++) {
+    Insert(cache, 1000 + i, 1000 + i);
+  }
+  ASSERT_EQ(1, Lookup(cache, 1));
+  ASSERT_EQ(-1, Lookup(cache, 2));
+}
+
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
                         testing::Values(kLRU, kClock));
-#else
-INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest, testing::Values(kLRU));
-#endif  // SUPPORT_CLOCK_CACHE
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, LRUCacheTest, testing::Values(kLRU));
+INSTANTIATE_TEST_CASE_P(CacheTestInstance, ClockCacheTest,
+                        testing::Values(kClock));
 
 }  // namespace ROCKSDB_NAMESPACE
 
@@ -9,268 +9,152 @@
 
 #include "cache/clock_cache.h"
 
-#ifndef SUPPORT_CLOCK_CACHE
-
-namespace ROCKSDB_NAMESPACE {
-
-std::shared_ptr<Cache> NewClockCache(
-    size_t /*capacity*/, int /*num_shard_bits*/, bool /*strict_capacity_limit*/,
-    CacheMetadataChargePolicy /*metadata_charge_policy*/) {
-  // Clock cache not supported.
-  return nullptr;
-}
-
-}  // namespace ROCKSDB_NAMESPACE
-
-#else
-
 #include <assert.h>
-#include <atomic>
-#include <deque>
 
-// "tbb/concurrent_hash_map.h" requires RTTI if exception is enabled.
-// Disable it so users can chooose to disable RTTI.
-#ifndef ROCKSDB_USE_RTTI
-#define TBB_USE_EXCEPTIONS 0
-#endif
-#include "tbb/concurrent_hash_map.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
 
 #include "cache/sharded_cache.h"
 #include "port/malloc.h"
 #include "port/port.h"
-#include "util/autovector.h"
-#include "util/mutexlock.h"
+#include "util/hash.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
 
-// An implementation of the Cache interface based on CLOCK algorithm, with
-// better concurrent performance than LRUCache. The idea of CLOCK algorithm
-// is to maintain all cache entries in a circular list, and an iterator
-// (the "head") pointing to the last examined entry. Eviction starts from the
-// current head. Each entry is given a second chance before eviction, if it
-// has been access since last examine. In contrast to LRU, no modification
-// to the internal data-structure (except for flipping the usage bit) needs
-// to be done upon lookup. This gives us oppertunity to implement a cache
-// with better concurrency.
-//
-// Each cache entry is represented by a cache handle, and all the handles
-// are arranged in a circular list, as describe above. Upon erase of an entry,
-// we never remove the handle. Instead, the handle is put into a recycle bin
-// to be re-use. This is to avoid memory dealocation, which is hard to deal
-// with in concurrent environment.
-//
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
-//
-// Each cache handle has the following flags and counters, which are squeeze
-// in an atomic interger, to make sure the handle always be in a consistent
-// state:
-//
-//   * In-cache bit: whether the entry is reference by the cache itself. If
-//     an entry is in cache, its key would also be available in the hash map.
-//   * Usage bit: whether the entry has been access by user since last
-//     examine for eviction. Can be reset by eviction.
-//   * Reference count: reference count by user.
-//
-// An entry can be reference only when it's in cache. An entry can be evicted
-// only when it is in cache, has no usage since last examine, and reference
-// count is zero.
+// An implementation of the Cache interface based on the CLOCK algorithm,
+// without any locks. Lookup(), Insert(), Release() and eviction only use
+// atomic operations on the entries they touch, so that concurrent readers of
+// different (or the same) blocks do not serialize on a shard mutex as they
+// do with LRUCache.
 //
-// The follow figure shows a possible layout of the cache. Boxes represents
-// cache handles and numbers in each box being in-cache bit, usage bit and
-// reference count respectively.
+// Each shard stores its entries in a fixed-size, open-addressing hash table
+// sized for the shard capacity divided by `estimated_entry_charge`, at a load
+// factor of kLoadFactor. A key is looked for along its probe sequence (double
+// hashing). Every slot counts the entries stored further along a probe
+// sequence passing over it ("displacements"), so that a lookup can stop at
+// the first slot that does not hold its key and has no displacements, and a
+// removed entry leaves no tombstone behind.
 //
-//    hash map:
-//      +-------+--------+
-//      |  key  | handle |
-//      +-------+--------+
-//      | "foo" |    5   |-------------------------------------+
-//      +-------+--------+                                     |
-//      | "bar" |    2   |--+                                  |
-//      +-------+--------+  |                                  |
-//                          |                                  |
-//                     head |                                  |
-//                       |  |                                  |
-//    circular list:     |  |                                  |
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//         |(0,0,0)|---|(1,1,0)|---|(0,0,0)|---|(0,1,3)|---|(1,0,0)|---|  ...
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//             |                       |
-//             +-------+   +-----------+
-//                     |   |
-//                   +---+---+
-//    recycle bin:   | 1 | 3 |
-//                   +---+---+
+// The state of a slot is kept in a single atomic word (`meta`):
 //
-// Suppose we try to insert "baz" into the cache at this point and the cache is
-// full. The cache will first look for entries to evict, starting from where
-// head points to (the second entry). It resets usage bit of the second entry,
-// skips the third and fourth entry since they are not in cache, and finally
-// evict the fifth entry ("foo"). It looks at recycle bin for available handle,
-// grabs handle 3, and insert the key into the handle. The following figure
-// shows the resulting layout.
+//   * State: empty, under construction (exclusively owned by the thread that
+//     fills or frees the slot), visible (in cache, found by lookups), or
+//     invisible (erased or replaced, but still referenced).
+//   * Clock countdown: the number of times the clock hand has to pass over
+//     an unreferenced entry before it is evicted. It is set by Insert() and
+//     raised by hits, more for high priority entries.
+//   * High priority bit.
+//   * Reference count.
 //
-//    hash map:
-//      +-------+--------+
-//      |  key  | handle |
-//      +-------+--------+
-//      | "baz" |    3   |-------------+
-//      +-------+--------+             |
-//      | "bar" |    2   |--+          |
-//      +-------+--------+  |          |
-//                          |          |
-//                          |          |                                 head
-//                          |          |                                   |
-//    circular list:        |          |                                   |
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//         |(0,0,0)|---|(1,0,0)|---|(1,0,0)|---|(0,1,3)|---|(0,0,0)|---|  ...
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//             |                                               |
-//             +-------+   +-----------------------------------+
-//                     |   |
-//                   +---+---+
-//    recycle bin:   | 1 | 5 |
-//                   +---+---+
+// A lookup speculatively adds a reference to each slot it examines, and only
+// then checks that the slot is visible and holds its key. A reference added
+// to an empty or constructing slot is simply taken back. Because only
+// unreferenced entries change state (except visible -> invisible), a
+// referenced entry can be read safely.
 //
-// A global mutex guards the circular list, the head, and the recycle bin.
-// We additionally require that modifying the hash map needs to hold the mutex.
-// As such, Modifying the cache (such as Insert() and Erase()) require to
-// hold the mutex. Lookup() only access the hash map and the flags associated
-// with each handle, and don't require explicit locking. Release() has to
-// acquire the mutex only when it releases the last reference to the entry and
-// the entry has been erased from cache explicitly. A future improvement could
-// be to remove the mutex completely.
-//
-// Benchmark:
-// We run readrandom db_bench on a test DB of size 13GB, with size of each
-// level:
-//
-//    Level    Files   Size(MB)
-//    -------------------------
-//      L0        1       0.01
-//      L1       18      17.32
-//      L2      230     182.94
-//      L3     1186    1833.63
-//      L4     4602    8140.30
-//
-// We test with both 32 and 16 read threads, with 2GB cache size (the whole DB
-// doesn't fits in) and 64GB cache size (the whole DB can fit in cache), and
-// whether to put index and filter blocks in block cache. The benchmark runs
-// with
-// with RocksDB 4.10. We got the following result:
-//
-// Threads Cache     Cache               ClockCache               LRUCache
-//         Size  Index/Filter Throughput(MB/s)   Hit Throughput(MB/s)    Hit
-//     32   2GB       yes               466.7  85.9%           433.7   86.5%
-//     32   2GB       no                529.9  72.7%           532.7   73.9%
-//     32  64GB       yes               649.9  99.9%           507.9   99.9%
-//     32  64GB       no                740.4  99.9%           662.8   99.9%
-//     16   2GB       yes               278.4  85.9%           283.4   86.5%
-//     16   2GB       no                318.6  72.7%           335.8   73.9%
-//     16  64GB       yes               391.9  99.9%           353.3   99.9%
-//     16  64GB       no                433.8  99.8%           419.4   99.8%
-
-// Cache entry meta data.
-struct CacheHandle {
-  Slice key;
+// The clock hand is a shared counter. An evicting thread advances it by a few
+// slots at a time, decrements the countdown of the unreferenced entries it
+// passes over and evicts those whose countdown is already zero, until the
+// shard is within its capacity and its table within its occupancy limit. A
+// table full of referenced entries makes Insert() fail, like a full cache
+// with strict_capacity_limit.
+
+struct ClockHandle {
   void* value;
-  size_t charge;
   Cache::DeleterFn deleter;
+  const char* key_data;
+  size_t charge;
+  uint32_t key_size;
   uint32_t hash;
 
   // Addition to "charge" to get "total charge" under metadata policy.
   uint32_t meta_charge;
 
-  // Flags and counters associated with the cache handle:
-  //   lowest bit: in-cache bit
-  //   second lowest bit: usage bit
-  //   the rest bits: reference count
-  // The handle is unused when flags equals to 0. The thread decreases the count
-  // to 0 is responsible to put the handle back to recycle_ and cleanup memory.
-  std::atomic<uint32_t> flags;
+  // Number of entries whose probe sequence passes over this slot, i.e. that
+  // are stored further along it.
+  std::atomic<uint32_t> displacements{0};
 
-  CacheHandle() = default;
+  // See the kState*, kHighPriBit, kCountdown* and kRefs* constants below.
+  std::atomic<uint64_t> meta{0};
 
-  CacheHandle(const CacheHandle& a) { *this = a; }
+  Slice key() const { return Slice(key_data, key_size); }
 
-  CacheHandle(const Slice& k, void* v,
-              void (*del)(const Slice& key, void* value))
-      : key(k), value(v), deleter(del) {}
-
-  CacheHandle& operator=(const CacheHandle& a) {
-    // Only copy members needed for deletion.
-    key = a.key;
-    value = a.value;
-    deleter = a.deleter;
-    return *this;
-  }
-
-  inline static uint32_t CalcMetadataCharge(
-      Slice key, CacheMetadataChargePolicy metadata_charge_policy) {
-    size_t meta_charge = 0;
-    if (metadata_charge_policy == kFullChargeCacheMetadata) {
-      meta_charge += sizeof(CacheHandle);
-#ifdef ROCKSDB_MALLOC_USABLE_SIZE
-      meta_charge +=
-          malloc_usable_size(static_cast<void*>(const_cast<char*>(key.data())));
-#else
-      meta_charge += key.size();
-#endif
-    }
-    assert(meta_charge <= UINT32_MAX);
-    return static_cast<uint32_t>(meta_charge);
-  }
-
-  inline size_t GetTotalCharge() { return charge + meta_charge; }
+  size_t GetTotalCharge() const { return charge + meta_charge; }
 };
 
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
-
-  CacheKey() = default;
-
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
-  }
-
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
-  }
-
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
-  }
-};
-
-struct CleanupContext {
-  // List of values to be deleted, along with the key and deleter.
-  autovector<CacheHandle> to_delete_value;
-
-  // List of keys to be deleted.
-  autovector<const char*> to_delete_key;
-};
+// Lowest two bits of ClockHandle::meta: the state of the slot.
+constexpr uint64_t kStateMask = 3;
+constexpr uint64_t kStateEmpty = 0;
+constexpr uint64_t kStateConstruction = 1;
+constexpr uint64_t kStateVisible = 2;
+constexpr uint64_t kStateInvisible = 3;
+// Third bit: set for entries inserted with Cache::Priority::HIGH.
+constexpr uint64_t kHighPriBit = 4;
+// Next two bits: the clock countdown.
+constexpr int kCountdownShift = 3;
+constexpr uint64_t kMaxCountdown = 3;
+constexpr uint64_t kOneCountdown = uint64_t{1} << kCountdownShift;
+// The rest: the reference count.
+constexpr int kRefsShift = 8;
+constexpr uint64_t kOneRef = uint64_t{1} << kRefsShift;
+
+// Initial countdown of new entries, and countdown after a hit, by priority.
+constexpr uint64_t kLowPriInsertCountdown = 0;
+constexpr uint64_t kLowPriHitCountdown = 1;
+constexpr uint64_t kHighPriInsertCountdown = 2;
+constexpr uint64_t kHighPriHitCountdown = kMaxCountdown;
+
+inline uint64_t GetState(uint64_t meta) { return meta & kStateMask; }
+inline bool IsOccupied(uint64_t meta) {
+  return GetState(meta) >= kStateVisible;
+}
+inline uint64_t GetCountdown(uint64_t meta) {
+  return (meta >> kCountdownShift) & kMaxCountdown;
+}
+inline uint64_t GetRefs(uint64_t meta) { return meta >> kRefsShift; }
+
+// Tables are sized for this fraction of their slots to be used when the
+// shard is full of entries of the estimated charge, and entries are evicted
+// regardless of the capacity to keep at most kStrictLoadFactor of them used.
+constexpr double kLoadFactor = 0.7;
+constexpr double kStrictLoadFactor = 0.84;
+
+constexpr int kMinLengthBits = 6;
+constexpr int kMaxLengthBits = 30;
+
+// Number of slots the clock hand advances at a time.
+constexpr uint32_t kClockStep = 4;
+
+int CalcLengthBits(size_t capacity, size_t estimated_entry_charge) {
+  double num_entries = static_cast<double>(capacity) /
+                       static_cast<double>(std::max<size_t>(
+                           estimated_entry_charge, 1));
+  double num_slots = num_entries / kLoadFactor;
+  int length_bits = kMinLengthBits;
+  while (length_bits < kMaxLengthBits &&
+         static_cast<double>(uint64_t{1} << length_bits) < num_slots) {
+    ++length_bits;
+  }
+  return length_bits;
+}
 
 // A cache shard which maintains its own CLOCK cache.
-class ClockCacheShard final : public CacheShard {
+class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShard {
  public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
-  ClockCacheShard();
+  ClockCacheShard(size_t capacity, bool strict_capacity_limit,
+                  size_t estimated_entry_charge,
+                  CacheMetadataChargePolicy metadata_charge_policy);
   ~ClockCacheShard() override;
 
   // Interfaces
   void SetCapacity(size_t capacity) override;
   void SetStrictCapacityLimit(bool strict_capacity_limit) override;
   Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
-                void (*deleter)(const Slice& key, void* value),
-                Cache::Handle** handle, Cache::Priority priority) override;
+                DeleterFn deleter, Cache::Handle** handle,
+                Cache::Priority priority) override;
   Status Insert(const Slice& key, uint32_t hash, void* value,
                 const Cache::CacheItemHelper* helper, size_t charge,
                 Cache::Handle** handle, Cache::Priority priority) override {
@@ -289,16 +173,9 @@ class ClockCacheShard final : public CacheShard {
   }
   bool IsReady(Cache::Handle* /*handle*/) override { return true; }
   void Wait(Cache::Handle* /*handle*/) override {}
-
-  // If the entry in in cache, increase reference count and return true.
-  // Return false otherwise.
-  //
-  // Not necessary to hold mutex_ before being called.
   bool Ref(Cache::Handle* handle) override;
   bool Release(Cache::Handle* handle, bool force_erase = false) override;
   void Erase(const Slice& key, uint32_t hash) override;
-  bool EraseAndConfirm(const Slice& key, uint32_t hash,
-                       CleanupContext* context);
   size_t GetUsage() const override;
   size_t GetPinnedUsage() const override;
   void EraseUnRefEntries() override;
@@ -306,84 +183,66 @@ class ClockCacheShard final : public CacheShard {
       const std::function<void(const Slice& key, void* value, size_t charge,
                                DeleterFn deleter)>& callback,
       uint32_t average_entries_per_lock, uint32_t* state) override;
+  std::string GetPrintableOptions() const override;
 
  private:
-  static const uint32_t kInCacheBit = 1;
-  static const uint32_t kUsageBit = 2;
-  static const uint32_t kRefsOffset = 2;
-  static const uint32_t kOneRef = 1 << kRefsOffset;
-
-  // Helper functions to extract cache handle flags and counters.
-  static bool InCache(uint32_t flags) { return flags & kInCacheBit; }
-  static bool HasUsage(uint32_t flags) { return flags & kUsageBit; }
-  static uint32_t CountRefs(uint32_t flags) { return flags >> kRefsOffset; }
-
-  // Decrease reference count of the entry. If this decreases the count to 0,
-  // recycle the entry. If set_usage is true, also set the usage bit.
-  //
-  // returns true if a value is erased.
-  //
-  // Not necessary to hold mutex_ before being called.
-  bool Unref(CacheHandle* handle, bool set_usage, CleanupContext* context);
+  uint32_t GetLength() const { return length_bits_mask_ + 1; }
 
-  // Unset in-cache bit of the entry. Recycle the handle if necessary.
-  //
-  // returns true if a value is erased.
-  //
-  // Has to hold mutex_ before being called.
-  bool UnsetInCache(CacheHandle* handle, CleanupContext* context);
+  // Sets the start and the (odd) step of the probe sequence of `hash`.
+  void InitProbe(uint32_t hash, uint32_t* base, uint32_t* increment) const {
+    *base = Upper32of64(uint64_t{hash} * 0x9E3779B97F4A7C15U);
+    *increment = Upper32of64(uint64_t{hash} * 0xC2B2AE3D27D4EB4FU) | 1;
+  }
 
-  // Put the handle back to recycle_ list, and put the value associated with
-  // it into to-be-deleted list. It doesn't cleanup the key as it might be
-  // reused by another handle.
-  //
-  // Has to hold mutex_ before being called.
-  void RecycleHandle(CacheHandle* handle, CleanupContext* context);
+  ClockHandle* GetSlot(uint32_t base, uint32_t increment,
+                       uint32_t probe) const {
+    return &array_[(base + probe * increment) & length_bits_mask_];
+  }
 
-  // Delete keys and values in to-be-deleted list. Call the method without
-  // holding mutex, as destructors can be expensive.
-  void Cleanup(const CleanupContext& context);
+  uint32_t CalcMetadataCharge(const Slice& key) const;
 
-  // Examine the handle for eviction. If the handle is in cache, usage bit is
-  // not set, and referece count is 0, evict it from cache. Otherwise unset
-  // the usage bit.
-  //
-  // Has to hold mutex_ before being called.
-  bool TryEvict(CacheHandle* value, CleanupContext* context);
+  // Adds a reference to the entry in `handle` and returns true if it is
+  // visible. Returns false, without a reference, otherwise.
+  bool TryRef(ClockHandle* handle);
 
-  // Scan through the circular list, evict entries until we get enough capacity
-  // for new cache entry of specific size. Return true if success, false
-  // otherwise.
-  //
-  // Has to hold mutex_ before being called.
-  bool EvictFromCache(size_t charge, CleanupContext* context);
-
-  CacheHandle* Insert(const Slice& key, uint32_t hash, void* value,
-                      size_t change,
-                      void (*deleter)(const Slice& key, void* value),
-                      bool hold_reference, CleanupContext* context,
-                      bool* overwritten);
-
-  // Guards list_, head_, and recycle_. In addition, updating table_ also has
-  // to hold the mutex, to avoid the cache being in inconsistent state.
-  mutable port::Mutex mutex_;
-
-  // The circular list of cache handles. Initially the list is empty. Once a
-  // handle is needed by insertion, and no more handles are available in
-  // recycle bin, one more handle is appended to the end.
+  // Removes a reference to an entry. Frees the entry if this was the last
+  // reference and the entry is invisible or the shard is over capacity.
   //
-  // We use std::deque for the circular list because we want to make sure
-  // pointers to handles are valid through out the life-cycle of the cache
-  // (in contrast to std::vector), and be able to grow the list (in contrast
-  // to statically allocated arrays).
-  std::deque<CacheHandle> list_;
+  // returns true if the entry is freed.
+  bool Unref(ClockHandle* handle);
 
-  // Pointer to the next handle in the circular list to be examine for
-  // eviction.
-  size_t head_;
+  // Makes a referenced entry invisible, so that it is freed when its last
+  // reference is removed.
+  void MarkInvisible(ClockHandle* handle) {
+    // Visible is 2 and invisible is 3, and a referenced entry is one of them.
+    handle->meta.fetch_or(kStateInvisible, std::memory_order_acq_rel);
+  }
+
+  // Raises the clock countdown of a referenced entry after a hit.
+  void Touch(ClockHandle* handle);
+
+  // Calls `fn` with a reference to each visible entry of `key` along its
+  // probe sequence, until `fn` returns false. `fn` takes over the reference.
+  template <typename Fn>
+  void FindVisible(const Slice& key, uint32_t hash, Fn fn);
+
+  // Frees the entry in a slot that the caller moved to the construction
+  // state, and makes the slot empty.
+  void FreeSlot(ClockHandle* handle);
+
+  // Removes the displacements that an entry of `hash` added to the first
+  // `num_probes` slots of its probe sequence.
+  void RollbackDisplacements(uint32_t hash, uint32_t num_probes);
+
+  // Advances the clock hand, evicting entries, until there is room for an
+  // entry of `total_charge` or every entry has been passed over
+  // kMaxCountdown + 1 times.
+  void Evict(size_t total_charge);
 
-  // Recycle bin of cache handles.
-  autovector<CacheHandle*> recycle_;
+  const int length_bits_;
+  const uint32_t length_bits_mask_;
+  const uint32_t occupancy_limit_;
+  const std::unique_ptr<ClockHandle[]> array_;
 
   // Maximum cache size.
   std::atomic<size_t> capacity_;
@@ -394,24 +253,42 @@ class ClockCacheShard final : public CacheShard {
   // Total un-released cache size.
   std::atomic<size_t> pinned_usage_;
 
+  // Number of occupied slots.
+  std::atomic<uint32_t> occupancy_;
+
   // Whether allow insert into cache if cache is full.
   std::atomic<bool> strict_capacity_limit_;
 
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
+  // Number of slots the clock hand has advanced.
+  std::atomic<uint64_t> clock_pointer_;
 };
 
-ClockCacheShard::ClockCacheShard()
-    : head_(0), usage_(0), pinned_usage_(0), strict_capacity_limit_(false) {}
+ClockCacheShard::ClockCacheShard(
+    size_t capacity, bool strict_capacity_limit, size_t estimated_entry_charge,
+    CacheMetadataChargePolicy metadata_charge_policy)
+    : length_bits_(CalcLengthBits(capacity, estimated_entry_charge)),
+      length_bits_mask_((uint32_t{1} << length_bits_) - 1),
+      occupancy_limit_(static_cast<uint32_t>(
+          static_cast<double>(uint64_t{1} << length_bits_) *
+          kStrictLoadFactor)),
+      array_(new ClockHandle[size_t{1} << length_bits_]),
+      capacity_(capacity),
+      usage_(0),
+      pinned_usage_(0),
+      occupancy_(0),
+      strict_capacity_limit_(strict_capacity_limit),
+      clock_pointer_(0) {
+  set_metadata_charge_policy(metadata_charge_policy);
+}
 
 ClockCacheShard::~ClockCacheShard() {
-  for (auto& handle : list_) {
-    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
-    if (InCache(flags) || CountRefs(flags) > 0) {
+  for (uint32_t i = 0; i < GetLength(); i++) {
+    ClockHandle& handle = array_[i];
+    if (IsOccupied(handle.meta.load(std::memory_order_relaxed))) {
       if (handle.deleter != nullptr) {
-        (*handle.deleter)(handle.key, handle.value);
+        (*handle.deleter)(handle.key(), handle.value);
       }
-      delete[] handle.key.data();
+      delete[] handle.key_data;
     }
   }
 }
@@ -424,183 +301,179 @@ size_t ClockCacheShard::GetPinnedUsage() const {
   return pinned_usage_.load(std::memory_order_relaxed);
 }
 
-void ClockCacheShard::ApplyToSomeEntries(
-    const std::function<void(const Slice& key, void* value, size_t charge,
-                             DeleterFn deleter)>& callback,
-    uint32_t average_entries_per_lock, uint32_t* state) {
-  assert(average_entries_per_lock > 0);
-  MutexLock lock(&mutex_);
+uint32_t ClockCacheShard::CalcMetadataCharge(const Slice& key) const {
+  size_t meta_charge = 0;
+  if (metadata_charge_policy_ == kFullChargeCacheMetadata) {
+    meta_charge += sizeof(ClockHandle);
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+    meta_charge +=
+        malloc_usable_size(static_cast<void*>(const_cast<char*>(key.data())));
+#else
+    meta_charge += key.size();
+#endif
+  }
+  assert(meta_charge <= UINT32_MAX);
+  return static_cast<uint32_t>(meta_charge);
+}
 
-  // Figure out the range to iterate, update `state`
-  size_t list_size = list_.size();
-  size_t start_idx = *state;
-  size_t end_idx = start_idx + average_entries_per_lock;
-  if (start_idx > list_size) {
-    // Shouldn't reach here, but recoverable
-    assert(false);
-    // Mark finished with all
-    *state = UINT32_MAX;
-    return;
+bool ClockCacheShard::TryRef(ClockHandle* handle) {
+  // Use acquire semantics, as the entry is read after the reference is added.
+  uint64_t old_meta = handle->meta.fetch_add(kOneRef, std::memory_order_acquire);
+  if (!IsOccupied(old_meta)) {
+    // The slot is empty or owned by another thread, which ignores our
+    // reference.
+    handle->meta.fetch_sub(kOneRef, std::memory_order_release);
+    return false;
   }
-  if (end_idx >= list_size || end_idx >= UINT32_MAX) {
-    // This also includes the hypothetical case of >4 billion
-    // cache handles.
-    end_idx = list_size;
-    // Mark finished with all
-    *state = UINT32_MAX;
-  } else {
-    *state = static_cast<uint32_t>(end_idx);
+  if (GetRefs(old_meta) == 0) {
+    pinned_usage_.fetch_add(handle->GetTotalCharge(),
+                            std::memory_order_relaxed);
   }
-
-  // Do the iteration
-  auto cur = list_.begin() + start_idx;
-  auto end = list_.begin() + end_idx;
-  for (; cur != end; ++cur) {
-    const CacheHandle& handle = *cur;
-    // Use relaxed semantics instead of acquire semantics since we are
-    // holding mutex
-    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
-    if (InCache(flags)) {
-      callback(handle.key, handle.value, handle.charge, handle.deleter);
-    }
+  if (GetState(old_meta) != kStateVisible) {
+    Unref(handle);
+    return false;
   }
+  return true;
 }
 
-void ClockCacheShard::RecycleHandle(CacheHandle* handle,
-                                    CleanupContext* context) {
-  mutex_.AssertHeld();
-  assert(!InCache(handle->flags) && CountRefs(handle->flags) == 0);
-  context->to_delete_key.push_back(handle->key.data());
-  context->to_delete_value.emplace_back(*handle);
+bool ClockCacheShard::Unref(ClockHandle* handle) {
+  // The entry cannot be accessed after the last reference is removed, as it
+  // could be evicted.
   size_t total_charge = handle->GetTotalCharge();
-  // clearing `handle` fields would go here but not strictly required
-  recycle_.push_back(handle);
-  usage_.fetch_sub(total_charge, std::memory_order_relaxed);
-}
 
-void ClockCacheShard::Cleanup(const CleanupContext& context) {
-  for (const CacheHandle& handle : context.to_delete_value) {
-    if (handle.deleter) {
-      (*handle.deleter)(handle.key, handle.value);
+  // Use acquire-release semantics as previous operations on the entry have to
+  // be ordered before the reference count is decreased, and freeing the
+  // entry has to be ordered after.
+  uint64_t old_meta = handle->meta.fetch_sub(kOneRef, std::memory_order_acq_rel);
+  assert(IsOccupied(old_meta) && GetRefs(old_meta) > 0);
+  if (GetRefs(old_meta) != 1) {
+    return false;
+  }
+  pinned_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  uint64_t meta = old_meta - kOneRef;
+  if (GetState(meta) == kStateInvisible ||
+      usage_.load(std::memory_order_relaxed) >
+          capacity_.load(std::memory_order_relaxed)) {
+    // Free the entry, unless another thread references it again first.
+    if (handle->meta.compare_exchange_strong(meta, kStateConstruction,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+      FreeSlot(handle);
+      return true;
     }
   }
-  for (const char* key : context.to_delete_key) {
-    delete[] key;
+  return false;
+}
+
+void ClockCacheShard::Touch(ClockHandle* handle) {
+  uint64_t meta = handle->meta.load(std::memory_order_relaxed);
+  uint64_t countdown = (meta & kHighPriBit) ? kHighPriHitCountdown
+                                            : kLowPriHitCountdown;
+  if (GetCountdown(meta) < countdown) {
+    // Best effort: a concurrent update of the entry wins.
+    uint64_t new_meta = (meta & ~(kMaxCountdown << kCountdownShift)) |
+                        (countdown << kCountdownShift);
+    handle->meta.compare_exchange_weak(meta, new_meta,
+                                       std::memory_order_relaxed);
   }
 }
 
-bool ClockCacheShard::Ref(Cache::Handle* h) {
-  auto handle = reinterpret_cast<CacheHandle*>(h);
-  // CAS loop to increase reference count.
-  uint32_t flags = handle->flags.load(std::memory_order_relaxed);
-  while (InCache(flags)) {
-    // Use acquire semantics on success, as further operations on the cache
-    // entry has to be order after reference count is increased.
-    if (handle->flags.compare_exchange_weak(flags, flags + kOneRef,
-                                            std::memory_order_acquire,
-                                            std::memory_order_relaxed)) {
-      if (CountRefs(flags) == 0) {
-        // No reference count before the operation.
-        size_t total_charge = handle->GetTotalCharge();
-        pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
+template <typename Fn>
+void ClockCacheShard::FindVisible(const Slice& key, uint32_t hash, Fn fn) {
+  uint32_t base;
+  uint32_t increment;
+  InitProbe(hash, &base, &increment);
+  for (uint32_t probe = 0; probe < GetLength(); probe++) {
+    ClockHandle* handle = GetSlot(base, increment, probe);
+    if (TryRef(handle)) {
+      if (handle->hash == hash && handle->key() == key) {
+        if (!fn(handle)) {
+          return;
+        }
+      } else {
+        Unref(handle);
       }
-      return true;
+    }
+    if (handle->displacements.load(std::memory_order_relaxed) == 0) {
+      return;
     }
   }
-  return false;
 }
 
-bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
-                            CleanupContext* context) {
-  if (set_usage) {
-    handle->flags.fetch_or(kUsageBit, std::memory_order_relaxed);
-  }
-  // If the handle reaches state refs=0 and InCache=true after this
-  // atomic operation then we cannot access `handle` afterward, because
-  // it could be evicted before we access the `handle`.
+void ClockCacheShard::FreeSlot(ClockHandle* handle) {
+  assert(GetState(handle->meta.load(std::memory_order_relaxed)) ==
+         kStateConstruction);
+  const char* key_data = handle->key_data;
+  Slice key = handle->key();
+  void* value = handle->value;
+  DeleterFn deleter = handle->deleter;
   size_t total_charge = handle->GetTotalCharge();
 
-  // Use acquire-release semantics as previous operations on the cache entry
-  // has to be order before reference count is decreased, and potential cleanup
-  // of the entry has to be order after.
-  uint32_t flags = handle->flags.fetch_sub(kOneRef, std::memory_order_acq_rel);
-  assert(CountRefs(flags) > 0);
-  if (CountRefs(flags) == 1) {
-    // this is the last reference.
-    pinned_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
-    // Cleanup if it is the last reference.
-    if (!InCache(flags)) {
-      MutexLock l(&mutex_);
-      RecycleHandle(handle, context);
-    }
+  uint32_t base;
+  uint32_t increment;
+  InitProbe(handle->hash, &base, &increment);
+  uint32_t probe = 0;
+  while (GetSlot(base, increment, probe) != handle) {
+    probe++;
   }
-  return context->to_delete_value.size();
-}
+  RollbackDisplacements(handle->hash, probe);
+  usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  occupancy_.fetch_sub(1, std::memory_order_relaxed);
+  // Keep the references other threads may have added speculatively; they
+  // take them back.
+  handle->meta.fetch_sub(kStateConstruction, std::memory_order_release);
 
-bool ClockCacheShard::UnsetInCache(CacheHandle* handle,
-                                   CleanupContext* context) {
-  mutex_.AssertHeld();
-  // Use acquire-release semantics as previous operations on the cache entry
-  // has to be order before reference count is decreased, and potential cleanup
-  // of the entry has to be order after.
-  uint32_t flags =
-      handle->flags.fetch_and(~kInCacheBit, std::memory_order_acq_rel);
-  // Cleanup if it is the last reference.
-  if (InCache(flags) && CountRefs(flags) == 0) {
-    RecycleHandle(handle, context);
-  }
-  return context->to_delete_value.size();
+  // Destructors can be expensive, so the slot is released first.
+  if (deleter != nullptr) {
+    (*deleter)(key, value);
+  }
+  delete[] key_data;
 }
 
-bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
-  mutex_.AssertHeld();
-  uint32_t flags = kInCacheBit;
-  if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
-                                            std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
-    assert(erased);
-    RecycleHandle(handle, context);
-    return true;
+void ClockCacheShard::RollbackDisplacements(uint32_t hash,
+                                            uint32_t num_probes) {
+  uint32_t base;
+  uint32_t increment;
+  InitProbe(hash, &base, &increment);
+  for (uint32_t probe = 0; probe < num_probes; probe++) {
+    GetSlot(base, increment, probe)
+        ->displacements.fetch_sub(1, std::memory_order_relaxed);
   }
-  handle->flags.fetch_and(~kUsageBit, std::memory_order_relaxed);
-  return false;
 }
 
-bool ClockCacheShard::EvictFromCache(size_t charge, CleanupContext* context) {
-  size_t usage = usage_.load(std::memory_order_relaxed);
-  size_t capacity = capacity_.load(std::memory_order_relaxed);
-  if (usage == 0) {
-    return charge <= capacity;
-  }
-  size_t new_head = head_;
-  bool second_iteration = false;
-  while (usage + charge > capacity) {
-    assert(new_head < list_.size());
-    if (TryEvict(&list_[new_head], context)) {
-      usage = usage_.load(std::memory_order_relaxed);
+void ClockCacheShard::Evict(size_t total_charge) {
+  const uint64_t max_steps = (kMaxCountdown + 1) * uint64_t{GetLength()};
+  for (uint64_t steps = 0; steps < max_steps; steps += kClockStep) {
+    if (occupancy_.load(std::memory_order_relaxed) == 0 ||
+        (usage_.load(std::memory_order_relaxed) + total_charge <=
+             capacity_.load(std::memory_order_relaxed) &&
+         occupancy_.load(std::memory_order_relaxed) < occupancy_limit_)) {
+      return;
     }
-    new_head = (new_head + 1 >= list_.size()) ? 0 : new_head + 1;
-    if (new_head == head_) {
-      if (second_iteration) {
-        return false;
-      } else {
-        second_iteration = true;
+    uint64_t start =
+        clock_pointer_.fetch_add(kClockStep, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < kClockStep; i++) {
+      ClockHandle* handle =
+          &array_[static_cast<uint32_t>(start + i) & length_bits_mask_];
+      uint64_t meta = handle->meta.load(std::memory_order_relaxed);
+      if (GetState(meta) != kStateVisible || GetRefs(meta) != 0) {
+        continue;
+      }
+      if (GetCountdown(meta) > 0) {
+        handle->meta.compare_exchange_strong(meta, meta - kOneCountdown,
+                                             std::memory_order_relaxed);
+      } else if (handle->meta.compare_exchange_strong(
+                     meta, kStateConstruction, std::memory_order_acquire,
+                     std::memory_order_relaxed)) {
+        FreeSlot(handle);
       }
     }
   }
-  head_ = new_head;
-  return true;
 }
 
 void ClockCacheShard::SetCapacity(size_t capacity) {
-  CleanupContext context;
-  {
-    MutexLock l(&mutex_);
-    capacity_.store(capacity, std::memory_order_relaxed);
-    EvictFromCache(0, &context);
-  }
-  Cleanup(context);
+  capacity_.store(capacity, std::memory_order_relaxed);
+  Evict(0);
 }
 
 void ClockCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
@@ -608,178 +481,219 @@ void ClockCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
                                std::memory_order_relaxed);
 }
 
-CacheHandle* ClockCacheShard::Insert(
-    const Slice& key, uint32_t hash, void* value, size_t charge,
-    void (*deleter)(const Slice& key, void* value), bool hold_reference,
-    CleanupContext* context, bool* overwritten) {
-  assert(overwritten != nullptr && *overwritten == false);
-  uint32_t meta_charge =
-      CacheHandle::CalcMetadataCharge(key, metadata_charge_policy_);
+Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
+                               size_t charge, DeleterFn deleter,
+                               Cache::Handle** out_handle,
+                               Cache::Priority priority) {
+  char* key_data = new char[key.size()];
+  memcpy(key_data, key.data(), key.size());
+  Slice key_copy(key_data, key.size());
+  uint32_t meta_charge = CalcMetadataCharge(key_copy);
   size_t total_charge = charge + meta_charge;
-  MutexLock l(&mutex_);
-  bool success = EvictFromCache(total_charge, context);
+
+  if (usage_.load(std::memory_order_relaxed) + total_charge >
+          capacity_.load(std::memory_order_relaxed) ||
+      occupancy_.load(std::memory_order_relaxed) >= occupancy_limit_) {
+    Evict(total_charge);
+  }
+  bool fits = usage_.load(std::memory_order_relaxed) + total_charge <=
+              capacity_.load(std::memory_order_relaxed);
   bool strict = strict_capacity_limit_.load(std::memory_order_relaxed);
-  if (!success && (strict || !hold_reference)) {
-    context->to_delete_key.push_back(key.data());
-    if (!hold_reference) {
-      context->to_delete_value.emplace_back(key, value, deleter);
+  ClockHandle* handle = nullptr;
+  if ((fits || (out_handle != nullptr && !strict)) &&
+      occupancy_.load(std::memory_order_relaxed) < occupancy_limit_) {
+    // Claim the first empty slot of the probe sequence.
+    uint32_t base;
+    uint32_t increment;
+    InitProbe(hash, &base, &increment);
+    uint32_t probe = 0;
+    for (; probe < GetLength(); probe++) {
+      ClockHandle* slot = GetSlot(base, increment, probe);
+      uint64_t meta = kStateEmpty;
+      if (slot->meta.compare_exchange_strong(meta, kStateConstruction,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+        handle = slot;
+        break;
+      }
+      slot->displacements.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (handle == nullptr) {
+      RollbackDisplacements(hash, probe);
     }
-    return nullptr;
-  }
-  // Grab available handle from recycle bin. If recycle bin is empty, create
-  // and append new handle to end of circular list.
-  CacheHandle* handle = nullptr;
-  if (!recycle_.empty()) {
-    handle = recycle_.back();
-    recycle_.pop_back();
-  } else {
-    list_.emplace_back();
-    handle = &list_.back();
   }
-  // Fill handle.
-  handle->key = key;
-  handle->hash = hash;
+
+  if (handle == nullptr) {
+    delete[] key_data;
+    if (out_handle == nullptr) {
+      // As if the entry was inserted and evicted immediately.
+      if (deleter != nullptr) {
+        (*deleter)(key, value);
+      }
+      return Status::OK();
+    }
+    *out_handle = nullptr;
+    return Status::Incomplete("Insert failed due to clock cache being full.");
+  }
+
+  usage_.fetch_add(total_charge, std::memory_order_relaxed);
+  occupancy_.fetch_add(1, std::memory_order_relaxed);
   handle->value = value;
+  handle->deleter = deleter;
+  handle->key_data = key_data;
+  handle->key_size = static_cast<uint32_t>(key.size());
   handle->charge = charge;
+  handle->hash = hash;
   handle->meta_charge = meta_charge;
-  handle->deleter = deleter;
-  uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-
-  // TODO investigate+fix suspected race condition:
-  // [thread 1] Lookup starts, up to Ref()
-  // [thread 2] Erase/evict the entry just looked up
-  // [thread 1] Ref() the handle, even though it's in the recycle bin
-  // [thread 2] Insert with recycling that handle
-  // Here we obliterate the other thread's Ref
-  // Possible fix: never blindly overwrite the flags, but only make
-  // relative updates (fetch_add, etc).
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    *overwritten = true;
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
-    UnsetInCache(existing_handle, context);
-  }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
-  if (hold_reference) {
+  bool high_pri = priority == Cache::Priority::HIGH;
+  uint64_t new_meta =
+      kStateVisible | (high_pri ? kHighPriBit : 0) |
+      ((high_pri ? kHighPriInsertCountdown : kLowPriInsertCountdown)
+       << kCountdownShift);
+  if (out_handle != nullptr) {
+    new_meta += kOneRef;
     pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
   }
-  usage_.fetch_add(total_charge, std::memory_order_relaxed);
-  return handle;
-}
+  // Publish the entry once the speculative references of other threads,
+  // which saw the slot empty or under construction, are taken back.
+  uint64_t meta = kStateConstruction;
+  while (!handle->meta.compare_exchange_weak(meta, new_meta,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+    meta = kStateConstruction;
+  }
 
-Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
-                               size_t charge,
-                               void (*deleter)(const Slice& key, void* value),
-                               Cache::Handle** out_handle,
-                               Cache::Priority /*priority*/) {
-  CleanupContext context;
-  HashTable::accessor accessor;
-  char* key_data = new char[key.size()];
-  memcpy(key_data, key.data(), key.size());
-  Slice key_copy(key_data, key.size());
+  // Replace the older entries of the same key.
   bool overwritten = false;
-  CacheHandle* handle = Insert(key_copy, hash, value, charge, deleter,
-                               out_handle != nullptr, &context, &overwritten);
-  Status s;
-  if (out_handle != nullptr) {
-    if (handle == nullptr) {
-      s = Status::Incomplete("Insert failed due to LRU cache being full.");
-    } else {
-      *out_handle = reinterpret_cast<Cache::Handle*>(handle);
+  FindVisible(key_copy, hash, [&](ClockHandle* other) {
+    if (other != handle) {
+      MarkInvisible(other);
+      overwritten = true;
     }
+    Unref(other);
+    return true;
+  });
+
+  if (out_handle != nullptr) {
+    *out_handle = reinterpret_cast<Cache::Handle*>(handle);
   }
-  if (overwritten) {
-    assert(s.ok());
-    s = Status::OkOverwritten();
-  }
-  Cleanup(context);
-  return s;
+  return overwritten ? Status::OkOverwritten() : Status::OK();
 }
 
 Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
-  }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
-  }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
-    CleanupContext context;
-    Unref(handle, false, &context);
-    // It is possible Unref() delete the entry, so we need to cleanup.
-    Cleanup(context);
-    return nullptr;
-  }
-  return reinterpret_cast<Cache::Handle*>(handle);
+  ClockHandle* found = nullptr;
+  FindVisible(key, hash, [&](ClockHandle* handle) {
+    found = handle;
+    return false;
+  });
+  if (found != nullptr) {
+    Touch(found);
+  }
+  return reinterpret_cast<Cache::Handle*>(found);
+}
+
+bool ClockCacheShard::Ref(Cache::Handle* h) {
+  ClockHandle* handle = reinterpret_cast<ClockHandle*>(h);
+  // The caller holds a reference already, so the entry cannot be freed.
+  handle->meta.fetch_add(kOneRef, std::memory_order_relaxed);
+  return true;
 }
 
 bool ClockCacheShard::Release(Cache::Handle* h, bool force_erase) {
-  CleanupContext context;
-  CacheHandle* handle = reinterpret_cast<CacheHandle*>(h);
-  bool erased = Unref(handle, true, &context);
-  if (force_erase && !erased) {
-    erased = EraseAndConfirm(handle->key, handle->hash, &context);
-  }
-  Cleanup(context);
-  return erased;
+  ClockHandle* handle = reinterpret_cast<ClockHandle*>(h);
+  if (force_erase) {
+    MarkInvisible(handle);
+  }
+  return Unref(handle);
 }
 
 void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
-  CleanupContext context;
-  EraseAndConfirm(key, hash, &context);
-  Cleanup(context);
+  FindVisible(key, hash, [&](ClockHandle* handle) {
+    MarkInvisible(handle);
+    Unref(handle);
+    return true;
+  });
 }
 
-bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
-                                      CleanupContext* context) {
-  MutexLock l(&mutex_);
-  HashTable::accessor accessor;
-  bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
-    erased = UnsetInCache(handle, context);
-  }
-  return erased;
+void ClockCacheShard::EraseUnRefEntries() {
+  for (uint32_t i = 0; i < GetLength(); i++) {
+    ClockHandle* handle = &array_[i];
+    uint64_t meta = handle->meta.load(std::memory_order_relaxed);
+    if (GetState(meta) == kStateVisible && GetRefs(meta) == 0 &&
+        handle->meta.compare_exchange_strong(meta, kStateConstruction,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+      FreeSlot(handle);
+    }
+  }
 }
 
-void ClockCacheShard::EraseUnRefEntries() {
-  CleanupContext context;
-  {
-    MutexLock l(&mutex_);
-    table_.clear();
-    for (auto& handle : list_) {
-      UnsetInCache(&handle, &context);
+void ClockCacheShard::ApplyToSomeEntries(
+    const std::function<void(const Slice& key, void* value, size_t charge,
+                             DeleterFn deleter)>& callback,
+    uint32_t average_entries_per_lock, uint32_t* state) {
+  assert(average_entries_per_lock > 0);
+  // Figure out the range of slots to iterate, update `state`
+  uint32_t length = GetLength();
+  size_t start_idx = *state;
+  size_t end_idx = start_idx + average_entries_per_lock;
+  if (start_idx > length) {
+    // Shouldn't reach here, but recoverable
+    assert(false);
+    // Mark finished with all
+    *state = UINT32_MAX;
+    return;
+  }
+  if (end_idx >= length) {
+    end_idx = length;
+    // Mark finished with all
+    *state = UINT32_MAX;
+  } else {
+    *state = static_cast<uint32_t>(end_idx);
+  }
+
+  for (size_t i = start_idx; i < end_idx; i++) {
+    ClockHandle* handle = &array_[i];
+    if (TryRef(handle)) {
+      callback(handle->key(), handle->value, handle->charge, handle->deleter);
+      Unref(handle);
     }
   }
-  Cleanup(context);
+}
+
+std::string ClockCacheShard::GetPrintableOptions() const {
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    table_size: %u\n", GetLength());
+  return std::string(buffer);
 }
 
 class ClockCache final : public ShardedCache {
  public:
   ClockCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-             CacheMetadataChargePolicy metadata_charge_policy)
+             CacheMetadataChargePolicy metadata_charge_policy,
+             size_t estimated_entry_charge)
       : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
-    int num_shards = 1 << num_shard_bits;
-    shards_ = new ClockCacheShard[num_shards];
-    for (int i = 0; i < num_shards; i++) {
-      shards_[i].set_metadata_charge_policy(metadata_charge_policy);
+    num_shards_ = 1 << num_shard_bits;
+    shards_ = reinterpret_cast<ClockCacheShard*>(
+        port::cacheline_aligned_alloc(sizeof(ClockCacheShard) * num_shards_));
+    size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+    for (int i = 0; i < num_shards_; i++) {
+      new (&shards_[i])
+          ClockCacheShard(per_shard, strict_capacity_limit,
+                          estimated_entry_charge, metadata_charge_policy);
     }
-    SetCapacity(capacity);
-    SetStrictCapacityLimit(strict_capacity_limit);
   }
 
-  ~ClockCache() override { delete[] shards_; }
+  ~ClockCache() override {
+    if (shards_ != nullptr) {
+      assert(num_shards_ > 0);
+      for (int i = 0; i < num_shards_; i++) {
+        shards_[i].~ClockCacheShard();
+      }
+      port::cacheline_aligned_free(shards_);
+    }
+  }
 
   const char* Name() const override { return "ClockCache"; }
 
@@ -792,45 +706,52 @@ class ClockCache final : public ShardedCache {
   }
 
   void* Value(Handle* handle) override {
-    return reinterpret_cast<const CacheHandle*>(handle)->value;
+    return reinterpret_cast<const ClockHandle*>(handle)->value;
   }
 
   size_t GetCharge(Handle* handle) const override {
-    return reinterpret_cast<const CacheHandle*>(handle)->charge;
+    return reinterpret_cast<const ClockHandle*>(handle)->charge;
   }
 
   uint32_t GetHash(Handle* handle) const override {
-    return reinterpret_cast<const CacheHandle*>(handle)->hash;
+    return reinterpret_cast<const ClockHandle*>(handle)->hash;
   }
 
   DeleterFn GetDeleter(Handle* handle) const override {
-    return reinterpret_cast<const CacheHandle*>(handle)->deleter;
+    return reinterpret_cast<const ClockHandle*>(handle)->deleter;
   }
 
   void DisownData() override {
+// Do not drop data if compile with ASAN to suppress leak warning.
 #ifndef MUST_FREE_HEAP_ALLOCATIONS
     shards_ = nullptr;
+    num_shards_ = 0;
 #endif
   }
 
   void WaitAll(std::vector<Handle*>& /*handles*/) override {}
 
  private:
-  ClockCacheShard* shards_;
+  ClockCacheShard* shards_ = nullptr;
+  int num_shards_ = 0;
 };
 
 }  // end anonymous namespace
 
 std::shared_ptr<Cache> NewClockCache(
     size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-    CacheMetadataChargePolicy metadata_charge_policy) {
+    CacheMetadataChargePolicy metadata_charge_policy,
+    size_t estimated_entry_charge) {
+  if (num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
   if (num_shard_bits < 0) {
     num_shard_bits = GetDefaultCacheShardBits(capacity);
   }
-  return std::make_shared<ClockCache>(
-      capacity, num_shard_bits, strict_capacity_limit, metadata_charge_policy);
+  return std::make_shared<ClockCache>(capacity, num_shard_bits,
+                                      strict_capacity_limit,
+                                      metadata_charge_policy,
+                                      estimated_entry_charge);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
-
-#endif  // SUPPORT_CLOCK_CACHE
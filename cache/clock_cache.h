@@ -10,7 +10,3 @@
 #pragma once
 
 #include "rocksdb/cache.h"
-
-#if defined(TBB) && !defined(ROCKSDB_LITE)
-#define SUPPORT_CLOCK_CACHE
-#endif
@@ -0,0 +1,179 @@
+//  Copyright (c) 2021-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <memory>
+
+#include "memory/memory_allocator.h"
+#include "monitoring/perf_context_imp.h"
+#include "util/compression.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+void DeletionCallback(const Slice& /*key*/, void* obj) {
+  delete reinterpret_cast<std::string*>(obj);
+}
+
+}  // namespace
+
+CompressedSecondaryCache::CompressedSecondaryCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    CompressionType compression_type, uint32_t compress_format_version)
+    : cache_options_(capacity, num_shard_bits, strict_capacity_limit,
+                     high_pri_pool_ratio, memory_allocator, use_adaptive_mutex,
+                     metadata_charge_policy, compression_type,
+                     compress_format_version) {
+  cache_ = NewLRUCache(capacity, num_shard_bits, strict_capacity_limit,
+                       high_pri_pool_ratio, memory_allocator,
+                       use_adaptive_mutex, metadata_charge_policy);
+}
+
+CompressedSecondaryCache::~CompressedSecondaryCache() { cache_.reset(); }
+
+std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
+    const Slice& key, const Cache::CreateCallback& create_cb, bool /*wait*/) {
+  std::unique_ptr<SecondaryCacheResultHandle> handle;
+  Cache::Handle* lru_handle = cache_->Lookup(key);
+  if (lru_handle == nullptr) {
+    return handle;
+  }
+
+  const std::string* entry =
+      reinterpret_cast<std::string*>(cache_->Value(lru_handle));
+  assert(!entry->empty());
+  CompressionType type = static_cast<CompressionType>((*entry)[0]);
+  const char* data = entry->data() + 1;
+  size_t data_size = entry->size() - 1;
+
+  CacheAllocationPtr uncompressed;
+  if (type != kNoCompression) {
+    UncompressionContext uncompression_context(type);
+    UncompressionInfo uncompression_info(uncompression_context,
+                                         UncompressionDict::GetEmptyDict(),
+                                         type);
+    size_t uncompressed_size = 0;
+    uncompressed = UncompressData(uncompression_info, data, data_size,
+                                  &uncompressed_size,
+                                  cache_options_.compress_format_version,
+                                  cache_options_.memory_allocator.get());
+    if (!uncompressed) {
+      cache_->Release(lru_handle, /* force_erase */ true);
+      return handle;
+    }
+    data = uncompressed.get();
+    data_size = uncompressed_size;
+  }
+
+  void* value = nullptr;
+  size_t charge = 0;
+  Status s = create_cb(const_cast<char*>(data), data_size, &value, &charge);
+  // The entry stays here: the primary cache does not demote promoted entries
+  // again when it evicts them.
+  cache_->Release(lru_handle);
+  if (!s.ok()) {
+    return handle;
+  }
+  handle.reset(new CompressedSecondaryCacheResultHandle(value, charge));
+  return handle;
+}
+
+Status CompressedSecondaryCache::Insert(const Slice& key, void* value,
+                                        const Cache::CacheItemHelper* helper) {
+  size_t size = (*helper->size_cb)(value);
+  CacheAllocationPtr ptr =
+      AllocateBlock(size, cache_options_.memory_allocator.get());
+
+  Status s = (*helper->saveto_cb)(value, 0, size, ptr.get());
+  if (!s.ok()) {
+    return s;
+  }
+  Slice val(ptr.get(), size);
+
+  std::string compressed;
+  CompressionType type = cache_options_.compression_type;
+  if (type != kNoCompression) {
+    CompressionOptions compression_opts;
+    CompressionContext compression_context(type);
+    uint64_t sample_for_compression = 0;
+    CompressionInfo compression_info(
+        compression_opts, compression_context, CompressionDict::GetEmptyDict(),
+        type, sample_for_compression);
+    if (!CompressData(val, compression_info,
+                      cache_options_.compress_format_version, &compressed) ||
+        compressed.size() >= size) {
+      // Not supported or not worth it; keep the entry uncompressed.
+      type = kNoCompression;
+    }
+  }
+
+  std::unique_ptr<std::string> entry(new std::string());
+  if (type != kNoCompression) {
+    entry->reserve(1 + compressed.size());
+    entry->push_back(static_cast<char>(type));
+    entry->append(compressed);
+  } else {
+    entry->reserve(1 + size);
+    entry->push_back(static_cast<char>(kNoCompression));
+    entry->append(val.data(), val.size());
+  }
+
+  PERF_COUNTER_ADD(compressed_sec_cache_insert_count, 1);
+  PERF_COUNTER_ADD(compressed_sec_cache_uncompressed_bytes, size);
+  PERF_COUNTER_ADD(compressed_sec_cache_compressed_bytes, entry->size() - 1);
+  size_t charge = entry->size();
+  s = cache_->Insert(key, entry.get(), charge, &DeletionCallback);
+  if (s.ok()) {
+    entry.release();
+  }
+  return s;
+}
+
+void CompressedSecondaryCache::Erase(const Slice& key) { cache_->Erase(key); }
+
+std::string CompressedSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  ret.append(cache_->GetPrintableOptions());
+  snprintf(buffer, kBufferSize, "    compression_type : %s\n",
+           CompressionTypeToString(cache_options_.compression_type).c_str());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    compress_format_version : %u\n",
+           cache_options_.compress_format_version);
+  ret.append(buffer);
+  return ret;
+}
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    CompressionType compression_type, uint32_t compress_format_version) {
+  return std::make_shared<CompressedSecondaryCache>(
+      capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
+      memory_allocator, use_adaptive_mutex, metadata_charge_policy,
+      compression_type, compress_format_version);
+}
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts) {
+  // The secondary_cache is disabled for this LRUCache instance.
+  assert(opts.secondary_cache == nullptr);
+  return NewCompressedSecondaryCache(
+      opts.capacity, opts.num_shard_bits, opts.strict_capacity_limit,
+      opts.high_pri_pool_ratio, opts.memory_allocator, opts.use_adaptive_mutex,
+      opts.metadata_charge_policy, opts.compression_type,
+      opts.compress_format_version);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
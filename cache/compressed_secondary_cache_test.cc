@@ -0,0 +1,294 @@
+//  Copyright (c) 2021-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <cstdint>
+#include <string>
+
+#include "port/stack_trace.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/perf_context.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/compression.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CompressedSecondaryCacheTest : public testing::Test {
+ public:
+  CompressedSecondaryCacheTest() : fail_create_(false) {}
+  ~CompressedSecondaryCacheTest() override {}
+
+ protected:
+  class TestItem {
+   public:
+    TestItem(const char* buf, size_t size) : buf_(new char[size]), size_(size) {
+      memcpy(buf_.get(), buf, size);
+    }
+    ~TestItem() {}
+
+    char* Buf() { return buf_.get(); }
+    size_t Size() { return size_; }
+
+   private:
+    std::unique_ptr<char[]> buf_;
+    size_t size_;
+  };
+
+  static size_t SizeCallback(void* obj) {
+    return reinterpret_cast<TestItem*>(obj)->Size();
+  }
+
+  static Status SaveToCallback(void* from_obj, size_t from_offset,
+                               size_t length, void* out) {
+    TestItem* item = reinterpret_cast<TestItem*>(from_obj);
+    const char* buf = item->Buf();
+    EXPECT_EQ(length, item->Size());
+    EXPECT_EQ(from_offset, 0);
+    memcpy(out, buf, length);
+    return Status::OK();
+  }
+
+  static void DeletionCallback(const Slice& /*key*/, void* obj) {
+    delete reinterpret_cast<TestItem*>(obj);
+  }
+
+  static Cache::CacheItemHelper helper_;
+
+  static Status SaveToCallbackFail(void* /*obj*/, size_t /*offset*/,
+                                   size_t /*size*/, void* /*out*/) {
+    return Status::NotSupported();
+  }
+
+  static Cache::CacheItemHelper helper_fail_;
+
+  Cache::CreateCallback test_item_creator = [&](const void* buf, size_t size,
+                                                void** out_obj,
+                                                size_t* charge) -> Status {
+    if (fail_create_) {
+      return Status::NotSupported();
+    }
+    *out_obj = reinterpret_cast<void*>(
+        new TestItem(static_cast<const char*>(buf), size));
+    *charge = size;
+    return Status::OK();
+  };
+
+  void SetFailCreate(bool fail) { fail_create_ = fail; }
+
+  // Returns a value that compresses about 2:1.
+  static std::string CompressibleValue(Random* rnd, size_t size) {
+    std::string value;
+    test::CompressibleString(rnd, 0.5, static_cast<int>(size), &value);
+    return value;
+  }
+
+  void BasicTest(CompressionType compression_type) {
+    std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(
+        1000, 0, false, 0.5, nullptr, kDefaultToAdaptiveMutex,
+        kDontChargeCacheMetadata, compression_type);
+    get_perf_context()->Reset();
+    SetPerfLevel(PerfLevel::kEnableCount);
+
+    // Lookup an non-existent key.
+    std::unique_ptr<SecondaryCacheResultHandle> handle0 =
+        sec_cache->Lookup("k0", test_item_creator, true);
+    ASSERT_EQ(handle0, nullptr);
+
+    Random rnd(301);
+    std::string str1 = CompressibleValue(&rnd, 200);
+    TestItem item1(str1.data(), str1.length());
+    ASSERT_OK(sec_cache->Insert("k1", &item1, &helper_));
+    ASSERT_EQ(get_perf_context()->compressed_sec_cache_insert_count, 1);
+    ASSERT_EQ(get_perf_context()->compressed_sec_cache_uncompressed_bytes,
+              200);
+    if (compression_type == kNoCompression) {
+      ASSERT_EQ(get_perf_context()->compressed_sec_cache_compressed_bytes, 200);
+    } else {
+      ASSERT_LT(get_perf_context()->compressed_sec_cache_compressed_bytes, 200);
+    }
+
+    std::string str2 = rnd.RandomString(200);
+    TestItem item2(str2.data(), str2.length());
+    ASSERT_OK(sec_cache->Insert("k2", &item2, &helper_));
+    ASSERT_EQ(get_perf_context()->compressed_sec_cache_insert_count, 2);
+
+    std::unique_ptr<SecondaryCacheResultHandle> handle2 =
+        sec_cache->Lookup("k2", test_item_creator, true);
+    ASSERT_NE(handle2, nullptr);
+    ASSERT_TRUE(handle2->IsReady());
+    std::unique_ptr<TestItem> val2(static_cast<TestItem*>(handle2->Value()));
+    ASSERT_NE(val2, nullptr);
+    ASSERT_EQ(memcmp(val2->Buf(), item2.Buf(), item2.Size()), 0);
+    ASSERT_EQ(handle2->Size(), 200);
+
+    // Entries stay after they are promoted.
+    std::unique_ptr<SecondaryCacheResultHandle> handle2_1 =
+        sec_cache->Lookup("k2", test_item_creator, true);
+    ASSERT_NE(handle2_1, nullptr);
+    delete static_cast<TestItem*>(handle2_1->Value());
+
+    std::unique_ptr<SecondaryCacheResultHandle> handle1 =
+        sec_cache->Lookup("k1", test_item_creator, true);
+    ASSERT_NE(handle1, nullptr);
+    std::unique_ptr<TestItem> val1(static_cast<TestItem*>(handle1->Value()));
+    ASSERT_NE(val1, nullptr);
+    ASSERT_EQ(memcmp(val1->Buf(), item1.Buf(), item1.Size()), 0);
+
+    ASSERT_OK(sec_cache->Insert("k1", &item1, &helper_));
+    sec_cache->Erase("k1");
+    handle1 = sec_cache->Lookup("k1", test_item_creator, true);
+    ASSERT_EQ(handle1, nullptr);
+
+    // Failures of the callbacks fail the operations.
+    ASSERT_NOK(sec_cache->Insert("k1", &item1, &helper_fail_));
+    ASSERT_OK(sec_cache->Insert("k1", &item1, &helper_));
+    SetFailCreate(true);
+    handle1 = sec_cache->Lookup("k1", test_item_creator, true);
+    ASSERT_EQ(handle1, nullptr);
+    SetFailCreate(false);
+
+    SetPerfLevel(PerfLevel::kDisable);
+  }
+
+  void IntegrationTest(CompressionType compression_type) {
+    CompressedSecondaryCacheOptions secondary_cache_opts;
+    secondary_cache_opts.compression_type = compression_type;
+    secondary_cache_opts.capacity = 6000;
+    secondary_cache_opts.num_shard_bits = 0;
+    secondary_cache_opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    std::shared_ptr<SecondaryCache> secondary_cache =
+        NewCompressedSecondaryCache(secondary_cache_opts);
+    LRUCacheOptions lru_cache_opts(1300, 0, /*_strict_capacity_limit=*/false,
+                                   0.5, nullptr, kDefaultToAdaptiveMutex,
+                                   kDontChargeCacheMetadata);
+    lru_cache_opts.secondary_cache = secondary_cache;
+    std::shared_ptr<Cache> cache = NewLRUCache(lru_cache_opts);
+    get_perf_context()->Reset();
+    SetPerfLevel(PerfLevel::kEnableCount);
+
+    Random rnd(301);
+    std::string str1 = CompressibleValue(&rnd, 1000);
+    TestItem* item1 = new TestItem(str1.data(), str1.length());
+    ASSERT_OK(cache->Insert("k1", item1, &helper_, str1.length()));
+    std::string str2 = CompressibleValue(&rnd, 1000);
+    TestItem* item2 = new TestItem(str2.data(), str2.length());
+    // k1 is demoted to the secondary cache.
+    ASSERT_OK(cache->Insert("k2", item2, &helper_, str2.length()));
+    ASSERT_EQ(get_perf_context()->compressed_sec_cache_insert_count, 1);
+
+    Cache::Handle* handle =
+        cache->Lookup("k2", &helper_, test_item_creator, Cache::Priority::LOW,
+                      true);
+    ASSERT_NE(handle, nullptr);
+    cache->Release(handle);
+    ASSERT_EQ(get_perf_context()->secondary_cache_hit_count, 0);
+
+    // k1 is promoted back to the primary cache, demoting k2.
+    handle = cache->Lookup("k1", &helper_, test_item_creator,
+                           Cache::Priority::LOW, true);
+    ASSERT_NE(handle, nullptr);
+    TestItem* val1 = static_cast<TestItem*>(cache->Value(handle));
+    ASSERT_EQ(memcmp(val1->Buf(), str1.data(), str1.size()), 0);
+    cache->Release(handle);
+    ASSERT_EQ(get_perf_context()->secondary_cache_hit_count, 1);
+    ASSERT_EQ(get_perf_context()->compressed_sec_cache_insert_count, 2);
+
+    handle = cache->Lookup("k2", &helper_, test_item_creator,
+                           Cache::Priority::LOW, true);
+    ASSERT_NE(handle, nullptr);
+    TestItem* val2 = static_cast<TestItem*>(cache->Value(handle));
+    ASSERT_EQ(memcmp(val2->Buf(), str2.data(), str2.size()), 0);
+    cache->Release(handle);
+    ASSERT_EQ(get_perf_context()->secondary_cache_hit_count, 2);
+
+    // The primary cache evicted promoted k1 without demoting it again, and
+    // it is still found in the secondary cache.
+    ASSERT_EQ(get_perf_context()->compressed_sec_cache_insert_count, 2);
+    handle = cache->Lookup("k1", &helper_, test_item_creator,
+                           Cache::Priority::LOW, true);
+    ASSERT_NE(handle, nullptr);
+    cache->Release(handle);
+    ASSERT_EQ(get_perf_context()->secondary_cache_hit_count, 3);
+
+    cache.reset();
+    secondary_cache.reset();
+    SetPerfLevel(PerfLevel::kDisable);
+  }
+
+ private:
+  bool fail_create_;
+};
+
+Cache::CacheItemHelper CompressedSecondaryCacheTest::helper_(
+    CompressedSecondaryCacheTest::SizeCallback,
+    CompressedSecondaryCacheTest::SaveToCallback,
+    CompressedSecondaryCacheTest::DeletionCallback);
+
+Cache::CacheItemHelper CompressedSecondaryCacheTest::helper_fail_(
+    CompressedSecondaryCacheTest::SizeCallback,
+    CompressedSecondaryCacheTest::SaveToCallbackFail,
+    CompressedSecondaryCacheTest::DeletionCallback);
+
+TEST_F(CompressedSecondaryCacheTest, BasicTestWithNoCompression) {
+  BasicTest(kNoCompression);
+}
+
+TEST_F(CompressedSecondaryCacheTest, BasicTestWithLZ4Compression) {
+  if (!LZ4_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires LZ4 support.");
+    return;
+  }
+  BasicTest(kLZ4Compression);
+}
+
+TEST_F(CompressedSecondaryCacheTest, BasicTestWithZSTDCompression) {
+  if (!ZSTD_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires ZSTD support.");
+    return;
+  }
+  BasicTest(kZSTD);
+}
+
+TEST_F(CompressedSecondaryCacheTest, IntegrationWithNoCompression) {
+  IntegrationTest(kNoCompression);
+}
+
+TEST_F(CompressedSecondaryCacheTest, IntegrationWithLZ4Compression) {
+  if (!LZ4_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires LZ4 support.");
+    return;
+  }
+  IntegrationTest(kLZ4Compression);
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(CompressedSecondaryCacheTest, CreateFromString) {
+  std::shared_ptr<SecondaryCache> sec_cache;
+  ASSERT_OK(SecondaryCache::CreateFromString(
+      ConfigOptions(),
+      "compressed_secondary_cache://capacity=2048;num_shard_bits=1;"
+      "compression_type=kNoCompression;compress_format_version=2",
+      &sec_cache));
+  ASSERT_NE(sec_cache, nullptr);
+  ASSERT_STREQ(sec_cache->Name(), CompressedSecondaryCache::kClassName());
+  std::string options = sec_cache->GetPrintableOptions();
+  ASSERT_NE(options.find("compression_type : NoCompression"),
+            std::string::npos);
+  ASSERT_NOK(SecondaryCache::CreateFromString(
+      ConfigOptions(), "compressed_secondary_cache://capacity=abc",
+      &sec_cache));
+}
+#endif  // ROCKSDB_LITE
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,111 @@
+//  Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A compact count-min sketch of 4-bit counters estimating how often each
+// key hash was seen recently, as used by TinyLFU-style cache admission.
+// Each key maps to four counters spread over the table (one per "row") and
+// its estimate is the minimum of them. To favor recent history, all counters
+// are halved after a sample of increments proportional to the table size.
+//
+// Not thread safe; callers provide their own synchronization.
+class FrequencySketch {
+ public:
+  // Largest value a single counter can hold.
+  static constexpr uint32_t kMaxFrequency = 15;
+
+  FrequencySketch() = default;
+
+  // (Re-)sizes the sketch for tracking about `expected_entries` distinct
+  // keys, forgetting all previous history.
+  void Reset(size_t expected_entries) {
+    // A floor keeps hash collisions rare for small caches.
+    size_t words = 1024;
+    while (words < expected_entries && words < kMaxWords) {
+      words <<= 1;
+    }
+    table_.reset(new uint64_t[words]());
+    mask_ = words - 1;
+    // Each word holds 16 counters, i.e. room for ~4 keys; aging after
+    // ~10 increments per tracked key keeps estimates fresh.
+    sample_size_ = 10 * words;
+    additions_ = 0;
+  }
+
+  bool IsInitialized() const { return table_ != nullptr; }
+
+  void Increment(uint32_t hash) {
+    bool added = false;
+    for (int row = 0; row < 4; ++row) {
+      uint64_t* word;
+      int shift;
+      Locate(hash, row, &word, &shift);
+      if (((*word >> shift) & 0xf) < kMaxFrequency) {
+        *word += uint64_t{1} << shift;
+        added = true;
+      }
+    }
+    if (added && ++additions_ >= sample_size_) {
+      Age();
+    }
+  }
+
+  uint32_t Estimate(uint32_t hash) const {
+    uint32_t freq = kMaxFrequency;
+    for (int row = 0; row < 4; ++row) {
+      uint64_t* word;
+      int shift;
+      Locate(hash, row, &word, &shift);
+      uint32_t count = static_cast<uint32_t>((*word >> shift) & 0xf);
+      if (count < freq) {
+        freq = count;
+      }
+    }
+    return freq;
+  }
+
+  size_t ApproximateMemoryUsage() const {
+    return table_ ? (mask_ + 1) * sizeof(uint64_t) : 0;
+  }
+
+ private:
+  // 128MB of counters is far beyond any useful cache shard.
+  static constexpr size_t kMaxWords = size_t{1} << 24;
+
+  void Locate(uint32_t hash, int row, uint64_t** word, int* shift) const {
+    // Cache shards only see hashes with the same lowest bits, so remix the
+    // whole hash independently for each row.
+    static constexpr uint64_t kSeeds[4] = {
+        0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL,
+        0xD6E8FEB86659FD93ULL};
+    uint64_t h = (uint64_t{hash} + kSeeds[row]) * kSeeds[row];
+    h ^= h >> 29;
+    *word = &table_[static_cast<size_t>(h) & mask_];
+    *shift = static_cast<int>(h >> 60) << 2;
+  }
+
+  void Age() {
+    for (size_t i = 0; i <= mask_; ++i) {
+      table_[i] = (table_[i] >> 1) & 0x7777777777777777ULL;
+    }
+    additions_ >>= 1;
+  }
+
+  std::unique_ptr<uint64_t[]> table_;
+  size_t mask_ = 0;
+  size_t sample_size_ = 0;
+  size_t additions_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
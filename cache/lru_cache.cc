@@ -13,15 +13,19 @@
 #include <cstdint>
 #include <cstdio>
 
+#include "monitoring/perf_context_imp.h"
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
-LRUHandleTable::LRUHandleTable(int max_upper_hash_bits)
+LRUHandleTable::LRUHandleTable(int max_upper_hash_bits,
+                               bool concurrent_lookups)
     : length_bits_(/* historical starting size*/ 4),
-      list_(new LRUHandle* [size_t{1} << length_bits_] {}),
+      list_(new Bucket[size_t{1} << length_bits_]{}),
+      published_list_(list_.get()),
       elems_(0),
-      max_length_bits_(max_upper_hash_bits) {}
+      max_length_bits_(max_upper_hash_bits),
+      concurrent_lookups_(concurrent_lookups) {}
 
 LRUHandleTable::~LRUHandleTable() {
   ApplyToEntriesRange(
@@ -30,21 +34,39 @@ LRUHandleTable::~LRUHandleTable() {
           h->Free();
         }
       },
-      0, uint32_t{1} << length_bits_);
+      0, uint32_t{1} << GetLengthBits());
 }
 
 LRUHandle* LRUHandleTable::Lookup(const Slice& key, uint32_t hash) {
-  return *FindPointer(key, hash);
+  return FindPointer(key, hash)->load(std::memory_order_relaxed);
+}
+
+LRUHandle* LRUHandleTable::LookupConcurrent(const Slice& key,
+                                            uint32_t hash) const {
+  // Resize() publishes the new array before the new length, so the index
+  // is always within the array, though maybe for the wrong bucket.
+  int length_bits = length_bits_.load(std::memory_order_acquire);
+  const Bucket* list = published_list_.load(std::memory_order_acquire);
+  LRUHandle* h =
+      list[hash >> (32 - length_bits)].load(std::memory_order_acquire);
+  while (h != nullptr && (h->hash != hash || key != h->key())) {
+    h = h->next_hash.load(std::memory_order_acquire);
+  }
+  return h;
 }
 
 LRUHandle* LRUHandleTable::Insert(LRUHandle* h) {
-  LRUHandle** ptr = FindPointer(h->key(), h->hash);
-  LRUHandle* old = *ptr;
-  h->next_hash = (old == nullptr ? nullptr : old->next_hash);
-  *ptr = h;
+  Bucket* ptr = FindPointer(h->key(), h->hash);
+  LRUHandle* old = ptr->load(std::memory_order_relaxed);
+  h->next_hash.store(old == nullptr
+                         ? nullptr
+                         : old->next_hash.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+  // Release so that concurrent lookups see an initialized entry
+  ptr->store(h, std::memory_order_release);
   if (old == nullptr) {
     ++elems_;
-    if ((elems_ >> length_bits_) > 0) {  // elems_ >= length
+    if ((elems_ >> GetLengthBits()) > 0) {  // elems_ >= length
       // Since each cache entry is fairly large, we aim for a small
       // average linked list length (<= 1).
       Resize();
@@ -54,97 +76,144 @@ LRUHandle* LRUHandleTable::Insert(LRUHandle* h) {
 }
 
 LRUHandle* LRUHandleTable::Remove(const Slice& key, uint32_t hash) {
-  LRUHandle** ptr = FindPointer(key, hash);
-  LRUHandle* result = *ptr;
+  Bucket* ptr = FindPointer(key, hash);
+  LRUHandle* result = ptr->load(std::memory_order_relaxed);
   if (result != nullptr) {
-    *ptr = result->next_hash;
+    // A concurrent lookup at `result` can still follow its next_hash
+    ptr->store(result->next_hash.load(std::memory_order_relaxed),
+               std::memory_order_release);
     --elems_;
   }
   return result;
 }
 
-LRUHandle** LRUHandleTable::FindPointer(const Slice& key, uint32_t hash) {
-  LRUHandle** ptr = &list_[hash >> (32 - length_bits_)];
-  while (*ptr != nullptr && ((*ptr)->hash != hash || key != (*ptr)->key())) {
-    ptr = &(*ptr)->next_hash;
+LRUHandleTable::Bucket* LRUHandleTable::FindPointer(const Slice& key,
+                                                    uint32_t hash) {
+  Bucket* ptr = &list_[hash >> (32 - GetLengthBits())];
+  LRUHandle* h;
+  while ((h = ptr->load(std::memory_order_relaxed)) != nullptr &&
+         (h->hash != hash || key != h->key())) {
+    ptr = &h->next_hash;
   }
   return ptr;
 }
 
 void LRUHandleTable::Resize() {
-  if (length_bits_ >= max_length_bits_) {
+  int length_bits = GetLengthBits();
+  if (length_bits >= max_length_bits_) {
     // Due to reaching limit of hash information, if we made the table
     // bigger, we would allocate more addresses but only the same
     // number would be used.
     return;
   }
-  if (length_bits_ >= 31) {
+  if (length_bits >= 31) {
     // Avoid undefined behavior shifting uint32_t by 32
     return;
   }
 
-  uint32_t old_length = uint32_t{1} << length_bits_;
-  int new_length_bits = length_bits_ + 1;
-  std::unique_ptr<LRUHandle* []> new_list {
-    new LRUHandle* [size_t{1} << new_length_bits] {}
-  };
+  uint32_t old_length = uint32_t{1} << length_bits;
+  int new_length_bits = length_bits + 1;
+  std::unique_ptr<Bucket[]> new_list{
+      new Bucket[size_t{1} << new_length_bits]{}};
   uint32_t count = 0;
   for (uint32_t i = 0; i < old_length; i++) {
-    LRUHandle* h = list_[i];
+    LRUHandle* h = list_[i].load(std::memory_order_relaxed);
     while (h != nullptr) {
-      LRUHandle* next = h->next_hash;
+      LRUHandle* next = h->next_hash.load(std::memory_order_relaxed);
       uint32_t hash = h->hash;
-      LRUHandle** ptr = &new_list[hash >> (32 - new_length_bits)];
-      h->next_hash = *ptr;
-      *ptr = h;
+      Bucket* ptr = &new_list[hash >> (32 - new_length_bits)];
+      // A concurrent lookup following the old chains may miss entries, but
+      // every next_hash points to an entry of the table, and the chains
+      // cannot form a cycle.
+      h->next_hash.store(ptr->load(std::memory_order_relaxed),
+                         std::memory_order_release);
+      ptr->store(h, std::memory_order_relaxed);
       h = next;
       count++;
     }
   }
   assert(elems_ == count);
+  published_list_.store(new_list.get(), std::memory_order_release);
+  if (concurrent_lookups_) {
+    old_lists_.push_back(std::move(list_));
+  }
   list_ = std::move(new_list);
-  length_bits_ = new_length_bits;
+  length_bits_.store(new_length_bits, std::memory_order_release);
 }
 
 LRUCacheShard::LRUCacheShard(
     size_t capacity, bool strict_capacity_limit, double high_pri_pool_ratio,
     bool use_adaptive_mutex, CacheMetadataChargePolicy metadata_charge_policy,
     int max_upper_hash_bits,
-    const std::shared_ptr<SecondaryCache>& secondary_cache)
+    const std::shared_ptr<SecondaryCache>& secondary_cache,
+    bool use_frequency_admission, bool lock_free_lookup)
     : capacity_(0),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
-      table_(max_upper_hash_bits),
+      table_(max_upper_hash_bits, lock_free_lookup),
       usage_(0),
       lru_usage_(0),
       mutex_(use_adaptive_mutex),
-      secondary_cache_(secondary_cache) {
+      secondary_cache_(secondary_cache),
+      lock_free_lookup_(lock_free_lookup) {
+  assert(!lock_free_lookup || (!use_frequency_admission && !secondary_cache));
   set_metadata_charge_policy(metadata_charge_policy);
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
   lru_low_pri_ = &lru_;
+  if (use_frequency_admission) {
+    // Sized properly by SetCapacity()
+    sketch_.Reset(0);
+  }
+  if (lock_free_lookup_) {
+    readers_.reset(new CoreLocalArray<ReaderCount>());
+  }
   SetCapacity(capacity);
 }
 
+LRUCacheShard::~LRUCacheShard() {
+  // No lookups can be in progress any more
+  for (LRUHandle* e : draining_) {
+    e->Free();
+  }
+  for (LRUHandle* e : retired_) {
+    e->Free();
+  }
+}
+
 void LRUCacheShard::EraseUnRefEntries() {
   autovector<LRUHandle*> last_reference_list;
   {
     MutexLock l(&mutex_);
-    while (lru_.next != &lru_) {
-      LRUHandle* old = lru_.next;
-      // LRU list contains only elements which can be evicted
-      assert(old->InCache() && !old->HasRefs());
+    LRUHandle* old = lru_.next;
+    while (old != &lru_) {
+      LRUHandle* next = old->next;
+      assert(old->InCache());
+      if (lock_free_lookup_) {
+        // Only remove the entry if no lookup has referenced it meanwhile
+        uint32_t refs = old->refs.load(std::memory_order_relaxed);
+        if ((refs & LRUHandle::kRefsMask) != 0 ||
+            !old->refs.compare_exchange_strong(refs, LRUHandle::kRemoved)) {
+          old = next;
+          continue;
+        }
+      } else {
+        // LRU list contains only elements which can be evicted
+        assert(!old->HasRefs());
+      }
       LRU_Remove(old);
       table_.Remove(old->key(), old->hash);
       old->SetInCache(false);
       size_t total_charge = old->CalcTotalCharge(metadata_charge_policy_);
       assert(usage_ >= total_charge);
       usage_ -= total_charge;
-      last_reference_list.push_back(old);
+      FreeRemovedEntry(old, &last_reference_list);
+      old = next;
     }
+    ReclaimRemovedEntries(&last_reference_list);
   }
 
   for (auto entry : last_reference_list) {
@@ -210,6 +279,16 @@ double LRUCacheShard::GetHighPriPoolRatio() {
   return high_pri_pool_ratio_;
 }
 
+void LRUCacheShard::AddAdmissionCounts(
+    std::unordered_map<DeleterFn, AdmissionCounts>* counts) const {
+  MutexLock l(&mutex_);
+  for (const auto& p : admission_counts_) {
+    AdmissionCounts& total = (*counts)[p.first];
+    total.admitted += p.second.admitted;
+    total.rejected += p.second.rejected;
+  }
+}
+
 void LRUCacheShard::LRU_Remove(LRUHandle* e) {
   assert(e->next != nullptr);
   assert(e->prev != nullptr);
@@ -269,6 +348,10 @@ void LRUCacheShard::MaintainPoolSize() {
 
 void LRUCacheShard::EvictFromLRU(size_t charge,
                                  autovector<LRUHandle*>* deleted) {
+  if (lock_free_lookup_) {
+    EvictFromLRULockFree(charge, deleted);
+    return;
+  }
   while ((usage_ + charge) > capacity_ && lru_.next != &lru_) {
     LRUHandle* old = lru_.next;
     // LRU list contains only elements which can be evicted
@@ -283,13 +366,89 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
   }
 }
 
+void LRUCacheShard::EvictFromLRULockFree(size_t charge,
+                                         autovector<LRUHandle*>* deleted) {
+  size_t budget = 2 * size_t{table_.GetElems()};
+  while ((usage_ + charge) > capacity_ && lru_.next != &lru_ && budget > 0) {
+    --budget;
+    LRUHandle* old = lru_.next;
+    assert(old->InCache());
+    uint32_t refs = old->refs.load(std::memory_order_relaxed);
+    if ((refs & (LRUHandle::kRefsMask | LRUHandle::kAccessed)) == 0 &&
+        old->refs.compare_exchange_strong(refs, LRUHandle::kRemoved)) {
+      LRU_Remove(old);
+      table_.Remove(old->key(), old->hash);
+      old->SetInCache(false);
+      size_t old_total_charge = old->CalcTotalCharge(metadata_charge_policy_);
+      assert(usage_ >= old_total_charge);
+      usage_ -= old_total_charge;
+      FreeRemovedEntry(old, deleted);
+    } else {
+      // Referenced, or looked up since it was last moved here: move it to
+      // the MRU end as a locked lookup would have done.
+      if (old->refs.fetch_and(~LRUHandle::kAccessed,
+                              std::memory_order_relaxed) &
+          LRUHandle::kAccessed) {
+        old->SetHit();
+      }
+      LRU_Remove(old);
+      LRU_Insert(old);
+    }
+  }
+}
+
+void LRUCacheShard::FreeRemovedEntry(LRUHandle* e,
+                                     autovector<LRUHandle*>* deleted) {
+  assert(!e->HasRefs());
+  if (lock_free_lookup_) {
+    retired_.push_back(e);
+  } else {
+    deleted->push_back(e);
+  }
+}
+
+void LRUCacheShard::ReclaimRemovedEntries(autovector<LRUHandle*>* deleted) {
+  if (draining_.empty()) {
+    if (retired_.empty()) {
+      return;
+    }
+    draining_.swap(retired_);
+    quiesced_.assign(readers_->Size(), false);
+  }
+  // Pairs with the increment in LookupLockFree(): a lookup not yet counted
+  // here cannot find the entries removed before.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool all_quiesced = true;
+  for (size_t i = 0; i < quiesced_.size(); ++i) {
+    if (!quiesced_[i]) {
+      if (readers_->AccessAtCore(i)->count.load(std::memory_order_seq_cst) ==
+          0) {
+        quiesced_[i] = true;
+      } else {
+        all_quiesced = false;
+      }
+    }
+  }
+  if (all_quiesced) {
+    for (LRUHandle* e : draining_) {
+      deleted->push_back(e);
+    }
+    draining_.clear();
+  }
+}
+
 void LRUCacheShard::SetCapacity(size_t capacity) {
   autovector<LRUHandle*> last_reference_list;
   {
     MutexLock l(&mutex_);
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+    if (sketch_.IsInitialized()) {
+      // Track roughly one key per typical block
+      sketch_.Reset(capacity_ / 4096);
+    }
     EvictFromLRU(0, &last_reference_list);
+    ReclaimRemovedEntries(&last_reference_list);
   }
 
   // Try to insert the evicted entries into tiered cache
@@ -309,59 +468,111 @@ void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
   strict_capacity_limit_ = strict_capacity_limit;
 }
 
+bool LRUCacheShard::Admit(const LRUHandle* e) {
+  LRUHandle* victim = lru_.next;
+  assert(victim != &lru_);
+  // Like TinyLFU, a tie goes to the entry already in the cache so that a
+  // stream of keys seen only once cannot displace anything.
+  bool admit = sketch_.Estimate(e->hash) > sketch_.Estimate(victim->hash);
+  DeleterFn deleter = e->IsSecondaryCacheCompatible() ? e->info_.helper->del_cb
+                                                      : e->info_.deleter;
+  AdmissionCounts& counts = admission_counts_[deleter];
+  if (admit) {
+    ++counts.admitted;
+  } else {
+    ++counts.rejected;
+  }
+  return admit;
+}
+
 Status LRUCacheShard::InsertItem(LRUHandle* e, Cache::Handle** handle,
-                                 bool free_handle_on_fail) {
+                                 bool free_handle_on_fail,
+                                 bool check_admission) {
   Status s = Status::OK();
   autovector<LRUHandle*> last_reference_list;
   size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
 
   {
-    MutexLock l(&mutex_);
-
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty
-    EvictFromLRU(total_charge, &last_reference_list);
+    CountingMutexLock l(this);
+    ++inserts_;
 
-    if ((usage_ + total_charge) > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    if (check_admission && sketch_.IsInitialized()) {
+      sketch_.Increment(e->hash);
+    }
+    // The admission filter only arbitrates between low-pri entries and LRU
+    // victims when the shard is full. It never blocks overwriting an existing
+    // key, and is skipped when a strict capacity limit forbids charging an
+    // uninserted entry to the caller.
+    if (check_admission && sketch_.IsInitialized() && !e->IsHighPri() &&
+        (usage_ + total_charge) > capacity_ && lru_.next != &lru_ &&
+        !(strict_capacity_limit_ && handle != nullptr) &&
+        table_.Lookup(e->key(), e->hash) == nullptr && !Admit(e)) {
       e->SetInCache(false);
       if (handle == nullptr) {
-        // Don't insert the entry but still return ok, as if the entry inserted
-        // into cache and get evicted immediately.
+        // As if the entry was inserted and evicted immediately
         last_reference_list.push_back(e);
       } else {
-        if (free_handle_on_fail) {
-          delete[] reinterpret_cast<char*>(e);
-          *handle = nullptr;
-        }
-        s = Status::Incomplete("Insert failed due to LRU cache being full.");
+        // The caller gets a private entry, which is charged until its last
+        // reference is released.
+        usage_ += total_charge;
+        e->Ref();
+        *handle = reinterpret_cast<Cache::Handle*>(e);
       }
     } else {
-      // Insert into the cache. Note that the cache might get larger than its
-      // capacity if not enough space was freed up.
-      LRUHandle* old = table_.Insert(e);
-      usage_ += total_charge;
-      if (old != nullptr) {
-        s = Status::OkOverwritten();
-        assert(old->InCache());
-        old->SetInCache(false);
-        if (!old->HasRefs()) {
-          // old is on LRU because it's in cache and its reference count is 0
-          LRU_Remove(old);
-          size_t old_total_charge =
-              old->CalcTotalCharge(metadata_charge_policy_);
-          assert(usage_ >= old_total_charge);
-          usage_ -= old_total_charge;
-          last_reference_list.push_back(old);
+      // Free the space following strict LRU policy until enough space
+      // is freed or the lru list is empty
+      EvictFromLRU(total_charge, &last_reference_list);
+
+      if ((usage_ + total_charge) > capacity_ &&
+          (strict_capacity_limit_ || handle == nullptr)) {
+        e->SetInCache(false);
+        if (handle == nullptr) {
+          // Don't insert the entry but still return ok, as if the entry
+          // inserted into cache and get evicted immediately.
+          last_reference_list.push_back(e);
+        } else {
+          if (free_handle_on_fail) {
+            delete[] reinterpret_cast<char*>(e);
+            *handle = nullptr;
+          }
+          s = Status::Incomplete(
+              "Insert failed due to LRU cache being full.");
         }
-      }
-      if (handle == nullptr) {
-        LRU_Insert(e);
       } else {
-        e->Ref();
-        *handle = reinterpret_cast<Cache::Handle*>(e);
+        // Insert into the cache. Note that the cache might get larger than
+        // its capacity if not enough space was freed up.
+        if (handle != nullptr) {
+          // Before a lock-free lookup can see the entry
+          e->Ref();
+        }
+        LRUHandle* old = table_.Insert(e);
+        usage_ += total_charge;
+        if (old != nullptr) {
+          s = Status::OkOverwritten();
+          assert(old->InCache());
+          bool old_has_refs = old->RemoveFromCache();
+          if (lock_free_lookup_ || !old_has_refs) {
+            // old is on LRU because it's in cache and its reference count is 0
+            // (or with lock-free lookups, whatever its reference count)
+            LRU_Remove(old);
+          }
+          if (!old_has_refs) {
+            size_t old_total_charge =
+                old->CalcTotalCharge(metadata_charge_policy_);
+            assert(usage_ >= old_total_charge);
+            usage_ -= old_total_charge;
+            FreeRemovedEntry(old, &last_reference_list);
+          }
+        }
+        if (handle == nullptr || lock_free_lookup_) {
+          LRU_Insert(e);
+        }
+        if (handle != nullptr) {
+          *handle = reinterpret_cast<Cache::Handle*>(e);
+        }
       }
     }
+    ReclaimRemovedEntries(&last_reference_list);
   }
 
   // Try to insert the evicted entries into the secondary cache
@@ -420,17 +631,38 @@ Cache::Handle* LRUCacheShard::Lookup(
     const ShardedCache::CreateCallback& create_cb, Cache::Priority priority,
     bool wait) {
   LRUHandle* e = nullptr;
+  if (lock_free_lookup_) {
+    e = LookupLockFree(key, hash);
+    if (e != nullptr) {
+      return reinterpret_cast<Cache::Handle*>(e);
+    }
+    // Retry under the mutex, in case the entry was being inserted or the
+    // table resized
+  }
   {
-    MutexLock l(&mutex_);
+    CountingMutexLock l(this);
+    ++lookups_;
+    if (sketch_.IsInitialized()) {
+      sketch_.Increment(hash);
+    }
     e = table_.Lookup(key, hash);
     if (e != nullptr) {
+      ++hits_;
       assert(e->InCache());
-      if (!e->HasRefs()) {
-        // The entry is in LRU since it's in hash and has no external references
-        LRU_Remove(e);
+      if (lock_free_lookup_) {
+        // Entries in the hash table are not removed from it without the mutex
+        bool referenced = e->TryRefForLookup();
+        assert(referenced);
+        (void)referenced;
+      } else {
+        if (!e->HasRefs()) {
+          // The entry is in LRU since it's in hash and has no external
+          // references
+          LRU_Remove(e);
+        }
+        e->Ref();
+        e->SetHit();
       }
-      e->Ref();
-      e->SetHit();
     }
   }
 
@@ -448,6 +680,7 @@ Cache::Handle* LRUCacheShard::Lookup(
     std::unique_ptr<SecondaryCacheResultHandle> secondary_handle =
         secondary_cache_->Lookup(key, create_cb, wait);
     if (secondary_handle != nullptr) {
+      PERF_COUNTER_ADD(secondary_cache_hit_count, 1);
       e = reinterpret_cast<LRUHandle*>(
           new char[sizeof(LRUHandle) - 1 + key.size()]);
 
@@ -482,8 +715,29 @@ Cache::Handle* LRUCacheShard::Lookup(
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
+LRUHandle* LRUCacheShard::LookupLockFree(const Slice& key, uint32_t hash) {
+  ReaderCount* readers = readers_->Access();
+  // Pairs with the fence in ReclaimRemovedEntries()
+  readers->count.fetch_add(1, std::memory_order_seq_cst);
+  LRUHandle* e = table_.LookupConcurrent(key, hash);
+  if (e != nullptr && !e->TryRefForLookup()) {
+    // Removed from the cache concurrently
+    e = nullptr;
+  }
+  if (e != nullptr) {
+    readers->hits.fetch_add(1, std::memory_order_relaxed);
+  }
+  readers->count.fetch_sub(1, std::memory_order_release);
+  return e;
+}
+
 bool LRUCacheShard::Ref(Cache::Handle* h) {
   LRUHandle* e = reinterpret_cast<LRUHandle*>(h);
+  if (lock_free_lookup_) {
+    assert(e->HasRefs());
+    e->AtomicRef();
+    return true;
+  }
   MutexLock l(&mutex_);
   // To create another reference - entry must be already externally referenced
   assert(e->HasRefs());
@@ -503,9 +757,12 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
     return false;
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
+  if (lock_free_lookup_) {
+    return ReleaseLockFree(e, force_erase);
+  }
   bool last_reference = false;
   {
-    MutexLock l(&mutex_);
+    CountingMutexLock l(this);
     last_reference = e->Unref();
     if (last_reference && e->InCache()) {
       // The item is still in cache, and nobody else holds a reference to it
@@ -514,7 +771,7 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
         assert(lru_.next == &lru_ || force_erase);
         // Take this opportunity and remove the item
         table_.Remove(e->key(), e->hash);
-        e->SetInCache(false);
+        e->RemoveFromCache();
       } else {
         // Put the item back on the LRU list, and don't free it
         LRU_Insert(e);
@@ -540,6 +797,57 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   return last_reference;
 }
 
+bool LRUCacheShard::ReleaseLockFree(LRUHandle* e, bool force_erase) {
+  if (!force_erase) {
+    uint32_t old_refs = e->AtomicUnref();
+    if ((old_refs & LRUHandle::kRefsMask) > 1 ||
+        (old_refs & LRUHandle::kRemoved) == 0) {
+      // Still referenced, or still in the cache and on the LRU list. Unlike
+      // with locked lookups, an over-capacity cache only frees such an entry
+      // on the next insert.
+      return false;
+    }
+  }
+  // The entry is removed from the cache, or is about to be
+  bool last_reference = false;
+  autovector<LRUHandle*> last_reference_list;
+  {
+    CountingMutexLock l(this);
+    if (force_erase) {
+      uint32_t refs = e->refs.load(std::memory_order_relaxed);
+      if ((refs & LRUHandle::kRemoved) == 0 &&
+          (refs & LRUHandle::kRefsMask) == 1 &&
+          e->refs.compare_exchange_strong(refs, LRUHandle::kRemoved)) {
+        // Dropped the last reference to an entry in the cache, which lookups
+        // cannot reference any more
+        LRU_Remove(e);
+        table_.Remove(e->key(), e->hash);
+        e->SetInCache(false);
+        last_reference = true;
+      } else {
+        uint32_t old_refs = e->AtomicUnref();
+        last_reference = (old_refs & LRUHandle::kRefsMask) == 1 &&
+                         (old_refs & LRUHandle::kRemoved) != 0;
+      }
+    } else {
+      last_reference = true;
+    }
+    if (last_reference) {
+      size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
+      assert(usage_ >= total_charge);
+      usage_ -= total_charge;
+      FreeRemovedEntry(e, &last_reference_list);
+    }
+    ReclaimRemovedEntries(&last_reference_list);
+  }
+
+  // Free the entries here outside of mutex for performance reasons
+  for (auto entry : last_reference_list) {
+    entry->Free();
+  }
+  return last_reference;
+}
+
 Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
@@ -571,33 +879,36 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   e->SetPriority(priority);
   memcpy(e->key_data, key.data(), key.size());
 
-  return InsertItem(e, handle, /* free_handle_on_fail */ true);
+  return InsertItem(e, handle, /* free_handle_on_fail */ true,
+                    /* check_admission */ true);
 }
 
 void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
-  LRUHandle* e;
-  bool last_reference = false;
+  autovector<LRUHandle*> last_reference_list;
   {
-    MutexLock l(&mutex_);
-    e = table_.Remove(key, hash);
+    CountingMutexLock l(this);
+    LRUHandle* e = table_.Remove(key, hash);
     if (e != nullptr) {
       assert(e->InCache());
-      e->SetInCache(false);
-      if (!e->HasRefs()) {
+      bool has_refs = e->RemoveFromCache();
+      if (lock_free_lookup_ || !has_refs) {
         // The entry is in LRU since it's in hash and has no external references
+        // (or with lock-free lookups, whatever its references)
         LRU_Remove(e);
+      }
+      if (!has_refs) {
         size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
         assert(usage_ >= total_charge);
         usage_ -= total_charge;
-        last_reference = true;
+        FreeRemovedEntry(e, &last_reference_list);
       }
     }
+    ReclaimRemovedEntries(&last_reference_list);
   }
 
   // Free the entry here outside of mutex for performance reasons
-  // last_reference will only be true if e != nullptr
-  if (last_reference) {
-    e->Free();
+  for (auto entry : last_reference_list) {
+    entry->Free();
   }
 }
 
@@ -621,7 +932,16 @@ size_t LRUCacheShard::GetUsage() const {
 size_t LRUCacheShard::GetPinnedUsage() const {
   MutexLock l(&mutex_);
   assert(usage_ >= lru_usage_);
-  return usage_ - lru_usage_;
+  size_t pinned_usage = usage_ - lru_usage_;
+  if (lock_free_lookup_) {
+    // The LRU list also holds the referenced entries in the cache
+    for (LRUHandle* e = lru_.next; e != &lru_; e = e->next) {
+      if (e->HasRefs()) {
+        pinned_usage += e->CalcTotalCharge(metadata_charge_policy_);
+      }
+    }
+  }
+  return pinned_usage;
 }
 
 std::string LRUCacheShard::GetPrintableOptions() const {
@@ -629,29 +949,52 @@ std::string LRUCacheShard::GetPrintableOptions() const {
   char buffer[kBufferSize];
   {
     MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    use_frequency_admission: %d\n"
+             "    lock_free_lookup: %d\n",
+             high_pri_pool_ratio_, sketch_.IsInitialized(), lock_free_lookup_);
   }
   return std::string(buffer);
 }
 
+void LRUCacheShard::GetStats(CacheShardStats* stats) const {
+  uint64_t lock_free_hits = 0;
+  if (lock_free_lookup_) {
+    for (size_t i = 0; i < readers_->Size(); ++i) {
+      lock_free_hits +=
+          readers_->AccessAtCore(i)->hits.load(std::memory_order_relaxed);
+    }
+  }
+  MutexLock l(&mutex_);
+  stats->lookups = lookups_ + lock_free_hits;
+  stats->hits = hits_ + lock_free_hits;
+  stats->inserts = inserts_;
+  stats->lock_contentions = lock_contentions_;
+}
+
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
                    bool strict_capacity_limit, double high_pri_pool_ratio,
                    std::shared_ptr<MemoryAllocator> allocator,
                    bool use_adaptive_mutex,
                    CacheMetadataChargePolicy metadata_charge_policy,
-                   const std::shared_ptr<SecondaryCache>& secondary_cache)
+                   const std::shared_ptr<SecondaryCache>& secondary_cache,
+                   bool use_frequency_admission, bool lock_free_lookup)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
                    std::move(allocator)) {
   num_shards_ = 1 << num_shard_bits;
   shards_ = reinterpret_cast<LRUCacheShard*>(
       port::cacheline_aligned_alloc(sizeof(LRUCacheShard) * num_shards_));
   size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+  // The frequency sketch and secondary cache lookups need the mutex
+  lock_free_lookup =
+      lock_free_lookup && !use_frequency_admission && !secondary_cache;
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i]) LRUCacheShard(
         per_shard, strict_capacity_limit, high_pri_pool_ratio,
         use_adaptive_mutex, metadata_charge_policy,
-        /* max_upper_hash_bits */ 32 - num_shard_bits, secondary_cache);
+        /* max_upper_hash_bits */ 32 - num_shard_bits, secondary_cache,
+        use_frequency_admission, lock_free_lookup);
   }
   secondary_cache_ = secondary_cache;
 }
@@ -719,6 +1062,28 @@ double LRUCache::GetHighPriPoolRatio() {
   return result;
 }
 
+void LRUCache::GetAdmissionCounts(
+    std::array<uint64_t, kNumCacheEntryRoles>* admitted,
+    std::array<uint64_t, kNumCacheEntryRoles>* rejected) const {
+  admitted->fill(0);
+  rejected->fill(0);
+  std::unordered_map<DeleterFn, AdmissionCounts> counts;
+  for (int i = 0; i < num_shards_; i++) {
+    shards_[i].AddAdmissionCounts(&counts);
+  }
+  if (counts.empty()) {
+    return;
+  }
+  auto role_map = CopyCacheDeleterRoleMap();
+  for (const auto& p : counts) {
+    auto it = role_map.find(p.first);
+    size_t role_idx = static_cast<size_t>(
+        it == role_map.end() ? CacheEntryRole::kMisc : it->second);
+    (*admitted)[role_idx] += p.second.admitted;
+    (*rejected)[role_idx] += p.second.rejected;
+  }
+}
+
 void LRUCache::WaitAll(std::vector<Handle*>& handles) {
   if (secondary_cache_) {
     std::vector<SecondaryCacheResultHandle*> sec_handles;
@@ -754,7 +1119,8 @@ std::shared_ptr<Cache> NewLRUCache(
     double high_pri_pool_ratio,
     std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
     CacheMetadataChargePolicy metadata_charge_policy,
-    const std::shared_ptr<SecondaryCache>& secondary_cache) {
+    const std::shared_ptr<SecondaryCache>& secondary_cache,
+    bool use_frequency_admission, bool lock_free_lookup) {
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
@@ -768,15 +1134,21 @@ std::shared_ptr<Cache> NewLRUCache(
   return std::make_shared<LRUCache>(
       capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
       std::move(memory_allocator), use_adaptive_mutex, metadata_charge_policy,
-      secondary_cache);
+      secondary_cache, use_frequency_admission, lock_free_lookup);
 }
 
 std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
+  int num_shard_bits = cache_opts.num_shard_bits;
+  if (num_shard_bits < 0) {
+    num_shard_bits =
+        GetDefaultCacheShardBits(cache_opts.capacity, cache_opts.min_shard_size);
+  }
   return NewLRUCache(
-      cache_opts.capacity, cache_opts.num_shard_bits,
+      cache_opts.capacity, num_shard_bits,
       cache_opts.strict_capacity_limit, cache_opts.high_pri_pool_ratio,
       cache_opts.memory_allocator, cache_opts.use_adaptive_mutex,
-      cache_opts.metadata_charge_policy, cache_opts.secondary_cache);
+      cache_opts.metadata_charge_policy, cache_opts.secondary_cache,
+      cache_opts.use_frequency_admission, cache_opts.lock_free_lookup);
 }
 
 std::shared_ptr<Cache> NewLRUCache(
@@ -786,6 +1158,8 @@ std::shared_ptr<Cache> NewLRUCache(
     CacheMetadataChargePolicy metadata_charge_policy) {
   return NewLRUCache(capacity, num_shard_bits, strict_capacity_limit,
                      high_pri_pool_ratio, memory_allocator, use_adaptive_mutex,
-                     metadata_charge_policy, nullptr);
+                     metadata_charge_policy, nullptr,
+                     /* use_frequency_admission */ false,
+                     /* lock_free_lookup */ false);
 }
 }  // namespace ROCKSDB_NAMESPACE
@@ -8,15 +8,22 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "cache/cache_entry_roles.h"
+#include "cache/frequency_sketch.h"
 #include "cache/sharded_cache.h"
 #include "port/lang.h"
 #include "port/malloc.h"
 #include "port/port.h"
 #include "rocksdb/secondary_cache.h"
 #include "util/autovector.h"
+#include "util/core_local.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -48,6 +55,16 @@ namespace ROCKSDB_NAMESPACE {
 // that any successful LRUCacheShard::Lookup/LRUCacheShard::Insert have a
 // matching LRUCache::Release (to move into state 2) or LRUCacheShard::Erase
 // (to move into state 3).
+//
+// With lock-free lookups (LRUCacheOptions::lock_free_lookup), lookups and
+// releases of entries in the cache do not take the shard mutex and cannot
+// move entries on or off the LRU list. Instead, every entry in the hash
+// table stays on the LRU list whatever its refs, and a lookup only sets the
+// kAccessed bit of refs. Eviction skips referenced entries and moves
+// accessed ones to the MRU end, which approximates moving them there on
+// lookup. The transitions that Release must observe, i.e. the entry leaving
+// the cache (kRemoved) and the last ref going away, are atomic updates of
+// the single refs word.
 
 struct LRUHandle {
   void* value;
@@ -60,7 +77,9 @@ struct LRUHandle {
   // An entry is not added to the LRUHandleTable until the secondary cache
   // lookup is complete, so its safe to have this union.
   union {
-    LRUHandle* next_hash;
+    // Atomic for lock-free lookups, which walk hash chains concurrently with
+    // updates under the shard mutex.
+    std::atomic<LRUHandle*> next_hash;
     SecondaryCacheResultHandle* sec_handle;
   };
   LRUHandle* next;
@@ -69,8 +88,18 @@ struct LRUHandle {
   size_t key_length;
   // The hash of key(). Used for fast sharding and comparisons.
   uint32_t hash;
-  // The number of external refs to this entry. The cache itself is not counted.
-  uint32_t refs;
+  // The number of external refs to this entry, in the bits of kRefsMask. The
+  // cache itself is not counted. Without lock-free lookups it is only
+  // updated under the shard mutex.
+  std::atomic<uint32_t> refs;
+
+  // Bits of `refs` beyond the count, only used with lock-free lookups.
+  // The entry has been removed from the cache, so lookups must not
+  // reference it, and the last Release() has to free it.
+  static constexpr uint32_t kRemoved = uint32_t{1} << 31;
+  // The entry was looked up since it was last (re)inserted in the LRU list.
+  static constexpr uint32_t kAccessed = uint32_t{1} << 30;
+  static constexpr uint32_t kRefsMask = kAccessed - 1;
 
   enum Flags : uint8_t {
     // Whether this entry is referenced by the hash table.
@@ -104,18 +133,58 @@ struct LRUHandle {
 
   Slice key() const { return Slice(key_data, key_length); }
 
-  // Increase the reference count by 1.
-  void Ref() { refs++; }
+  // Increase the reference count by 1. Not safe against concurrent lock-free
+  // lookups (see AtomicRef()).
+  void Ref() {
+    refs.store(refs.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+  }
 
   // Just reduce the reference count by 1. Return true if it was last reference.
+  // Not safe against concurrent lock-free lookups (see AtomicUnref()).
   bool Unref() {
-    assert(refs > 0);
-    refs--;
-    return refs == 0;
+    uint32_t r = refs.load(std::memory_order_relaxed);
+    assert((r & kRefsMask) > 0);
+    refs.store(r - 1, std::memory_order_relaxed);
+    return ((r - 1) & kRefsMask) == 0;
   }
 
   // Return true if there are external refs, false otherwise.
-  bool HasRefs() const { return refs > 0; }
+  bool HasRefs() const {
+    return (refs.load(std::memory_order_relaxed) & kRefsMask) > 0;
+  }
+
+  // Versions of Ref() and Unref() for entries that lock-free lookups may
+  // reference concurrently. AtomicUnref() returns the previous value of refs.
+  void AtomicRef() { refs.fetch_add(1, std::memory_order_relaxed); }
+  uint32_t AtomicUnref() {
+    uint32_t old = refs.fetch_sub(1, std::memory_order_acq_rel);
+    assert((old & kRefsMask) > 0);
+    return old;
+  }
+
+  // Takes a reference for a lookup and marks the entry accessed, unless it
+  // has been removed from the cache.
+  bool TryRefForLookup() {
+    uint32_t r = refs.load(std::memory_order_relaxed);
+    do {
+      if (r & kRemoved) {
+        return false;
+      }
+    } while (!refs.compare_exchange_weak(r, (r + 1) | kAccessed,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed));
+    return true;
+  }
+
+  // Marks an entry as no longer in the cache. Returns whether it still had
+  // external refs; with lock-free lookups only this result, taken atomically
+  // with the removal, tells whether the last Release() will free the entry.
+  bool RemoveFromCache() {
+    flags &= ~IN_CACHE;
+    return (refs.fetch_or(kRemoved, std::memory_order_acq_rel) & kRefsMask) !=
+           0;
+  }
 
   bool InCache() const { return flags & IN_CACHE; }
   bool IsHighPri() const { return flags & IS_HIGH_PRI; }
@@ -185,7 +254,7 @@ struct LRUHandle {
   }
 
   void Free() {
-    assert(refs == 0);
+    assert(!HasRefs());
 #ifdef __SANITIZE_THREAD__
     // Here we can safely assert they are the same without a data race reported
     assert(((flags & IS_SECONDARY_CACHE_COMPATIBLE) != 0) ==
@@ -234,19 +303,30 @@ class LRUHandleTable {
   // If the table uses more hash bits than `max_upper_hash_bits`,
   // it will eat into the bits used for sharding, which are constant
   // for a given LRUHandleTable.
-  explicit LRUHandleTable(int max_upper_hash_bits);
+  //
+  // With `concurrent_lookups`, LookupConcurrent() may run without the
+  // external synchronization that all other methods need. Bucket arrays
+  // replaced by a resize are then kept until destruction (at most as much
+  // memory again as the current array), as such lookups may still read them.
+  explicit LRUHandleTable(int max_upper_hash_bits,
+                          bool concurrent_lookups = false);
   ~LRUHandleTable();
 
   LRUHandle* Lookup(const Slice& key, uint32_t hash);
   LRUHandle* Insert(LRUHandle* h);
   LRUHandle* Remove(const Slice& key, uint32_t hash);
 
+  // May miss an entry that is concurrently inserted or moved by a resize, and
+  // may return an entry that is concurrently removed. The caller must keep
+  // removed entries from being freed while this runs.
+  LRUHandle* LookupConcurrent(const Slice& key, uint32_t hash) const;
+
   template <typename T>
   void ApplyToEntriesRange(T func, uint32_t index_begin, uint32_t index_end) {
     for (uint32_t i = index_begin; i < index_end; i++) {
-      LRUHandle* h = list_[i];
+      LRUHandle* h = list_[i].load(std::memory_order_relaxed);
       while (h != nullptr) {
-        auto n = h->next_hash;
+        auto n = h->next_hash.load(std::memory_order_relaxed);
         assert(h->InCache());
         func(h);
         h = n;
@@ -254,40 +334,64 @@ class LRUHandleTable {
     }
   }
 
-  int GetLengthBits() const { return length_bits_; }
+  int GetLengthBits() const {
+    return length_bits_.load(std::memory_order_relaxed);
+  }
+
+  uint32_t GetElems() const { return elems_; }
 
  private:
+  using Bucket = std::atomic<LRUHandle*>;
+
   // Return a pointer to slot that points to a cache entry that
   // matches key/hash.  If there is no such cache entry, return a
   // pointer to the trailing slot in the corresponding linked list.
-  LRUHandle** FindPointer(const Slice& key, uint32_t hash);
+  Bucket* FindPointer(const Slice& key, uint32_t hash);
 
   void Resize();
 
   // Number of hash bits (upper because lower bits used for sharding)
   // used for table index. Length == 1 << length_bits_
-  int length_bits_;
+  std::atomic<int> length_bits_;
 
   // The table consists of an array of buckets where each bucket is
   // a linked list of cache entries that hash into the bucket.
-  std::unique_ptr<LRUHandle*[]> list_;
+  std::unique_ptr<Bucket[]> list_;
+
+  // list_, for LookupConcurrent()
+  std::atomic<Bucket*> published_list_;
+
+  // Arrays replaced by Resize(), kept for concurrent lookups
+  std::vector<std::unique_ptr<Bucket[]>> old_lists_;
 
   // Number of elements currently in the table
   uint32_t elems_;
 
   // Set from max_upper_hash_bits (see constructor)
   const int max_length_bits_;
+
+  const bool concurrent_lookups_;
+};
+
+// Outcomes of the frequency admission filter for one kind of entry.
+struct AdmissionCounts {
+  uint64_t admitted = 0;
+  uint64_t rejected = 0;
 };
 
 // A single shard of sharded cache.
 class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
  public:
+  // lock_free_lookup requires !use_frequency_admission and no
+  // secondary_cache.
   LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                 double high_pri_pool_ratio, bool use_adaptive_mutex,
                 CacheMetadataChargePolicy metadata_charge_policy,
                 int max_upper_hash_bits,
-                const std::shared_ptr<SecondaryCache>& secondary_cache);
-  virtual ~LRUCacheShard() override = default;
+                const std::shared_ptr<SecondaryCache>& secondary_cache,
+                bool use_frequency_admission = false,
+                bool lock_free_lookup = false);
+  virtual ~LRUCacheShard() override;
 
   // Separate from constructor so caller can easily make an array of LRUCache
   // if current usage is more than new capacity, the function will attempt to
@@ -351,6 +455,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
 
   virtual std::string GetPrintableOptions() const override;
 
+  virtual void GetStats(CacheShardStats* stats) const override;
+
   void TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri);
 
   //  Retrieves number of elements in LRU, for unit test purpose only
@@ -360,13 +466,24 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   //  Retrieves high pri pool ratio
   double GetHighPriPoolRatio();
 
+  // Adds this shard's frequency admission decisions, keyed by the deleter of
+  // the inserted entries, to `*counts`.
+  void AddAdmissionCounts(
+      std::unordered_map<DeleterFn, AdmissionCounts>* counts) const;
+
  private:
   friend class LRUCache;
   // Insert an item into the hash table and, if handle is null, insert into
   // the LRU list. Older items are evicted as necessary. If the cache is full
   // and free_handle_on_fail is true, the item is deleted and handle is set to.
+  // If check_admission is true and the frequency admission filter rejects
+  // the item, it is freed (handle == nullptr) or returned to the caller
+  // without being inserted in the hash table, and OK is returned.
   Status InsertItem(LRUHandle* item, Cache::Handle** handle,
-                    bool free_handle_on_fail);
+                    bool free_handle_on_fail, bool check_admission = false);
+  // Returns false if the frequency admission filter says `e` should not
+  // displace the least recently used entry. Requires mutex_ held.
+  bool Admit(const LRUHandle* e);
   Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
                 DeleterFn deleter, const Cache::CacheItemHelper* helper,
                 Cache::Handle** handle, Cache::Priority priority);
@@ -381,6 +498,21 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
+  // Lookup() and Release() without the mutex, for lock-free lookups. The
+  // lookup returns nullptr if it did not find the entry, in which case the
+  // caller retries under the mutex.
+  LRUHandle* LookupLockFree(const Slice& key, uint32_t hash);
+  bool ReleaseLockFree(LRUHandle* e, bool force_erase);
+
+  // Frees `e`, which was removed from the hash table, once no lock-free lookup
+  // can still be reading it: via `deleted` right away, or after the lookups in
+  // progress have finished with lock-free lookups. Requires mutex_ held.
+  void FreeRemovedEntry(LRUHandle* e, autovector<LRUHandle*>* deleted);
+
+  // Moves the entries passed to FreeRemovedEntry() that no lock-free lookup
+  // can see any more to `deleted`. Requires mutex_ held.
+  void ReclaimRemovedEntries(autovector<LRUHandle*>* deleted);
+
   // Overflow the last entry in high-pri pool to low-pri pool until size of
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
@@ -390,6 +522,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // This function is not thread safe - it needs to be executed while
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
+  // EvictFromLRU() with lock-free lookups, where the LRU list also holds
+  // referenced entries. Gives up once every entry was examined twice.
+  void EvictFromLRULockFree(size_t charge, autovector<LRUHandle*>* deleted);
 
   // Initialized before use.
   size_t capacity_;
@@ -440,6 +575,60 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   mutable port::Mutex mutex_;
 
   std::shared_ptr<SecondaryCache> secondary_cache_;
+
+  // Recent access frequencies for frequency admission. Only initialized
+  // when use_frequency_admission is set.
+  FrequencySketch sketch_;
+
+  // Admission decisions made while the shard was full, by deleter.
+  std::unordered_map<DeleterFn, AdmissionCounts> admission_counts_;
+
+  // Whether lookups and releases of cached entries skip the mutex.
+  const bool lock_free_lookup_;
+
+  // Number of lock-free lookups in progress, counted per core, so that
+  // entries removed from the hash table are only freed once no lookup can
+  // still be reading them. Only allocated with lock-free lookups.
+  struct ALIGN_AS(CACHE_LINE_SIZE) ReaderCount {
+    std::atomic<uint64_t> count{0};
+    // Lock-free lookups that found their entry, for GetStats()
+    std::atomic<uint64_t> hits{0};
+  };
+  std::unique_ptr<CoreLocalArray<ReaderCount>> readers_;
+
+  // Removed entries waiting for the lock-free lookups in progress when they
+  // were removed to finish. Entries in `draining_` are freed once every core
+  // was seen without lookups in progress (`quiesced_`) since the draining
+  // started; `retired_` entries are drained next.
+  std::vector<LRUHandle*> retired_;
+  std::vector<LRUHandle*> draining_;
+  std::vector<bool> quiesced_;
+
+  // Activity counters for GetStats(), protected by mutex_. Lookups that hit
+  // without the mutex are counted in `readers_` instead.
+  uint64_t lookups_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t inserts_ = 0;
+  uint64_t lock_contentions_ = 0;
+
+  // Holds mutex_, like MutexLock, counting in lock_contentions_ whether it
+  // had to wait for another thread to release it.
+  class CountingMutexLock {
+   public:
+    explicit CountingMutexLock(LRUCacheShard* shard) : shard_(shard) {
+      if (!shard_->mutex_.TryLock()) {
+        shard_->mutex_.Lock();
+        ++shard_->lock_contentions_;
+      }
+    }
+    ~CountingMutexLock() { shard_->mutex_.Unlock(); }
+    // No copying allowed
+    CountingMutexLock(const CountingMutexLock&) = delete;
+    void operator=(const CountingMutexLock&) = delete;
+
+   private:
+    LRUCacheShard* const shard_;
+  };
 };
 
 class LRUCache
@@ -454,7 +643,9 @@ class LRUCache
            bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
            CacheMetadataChargePolicy metadata_charge_policy =
                kDontChargeCacheMetadata,
-           const std::shared_ptr<SecondaryCache>& secondary_cache = nullptr);
+           const std::shared_ptr<SecondaryCache>& secondary_cache = nullptr,
+           bool use_frequency_admission = false,
+           bool lock_free_lookup = false);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(uint32_t shard) override;
@@ -471,6 +662,13 @@ class LRUCache
   //  Retrieves high pri pool ratio
   double GetHighPriPoolRatio();
 
+  // Retrieves the number of entries admitted and rejected by the frequency
+  // admission filter (see LRUCacheOptions::use_frequency_admission) for
+  // each CacheEntryRole. All zero if the filter is not enabled.
+  void GetAdmissionCounts(
+      std::array<uint64_t, kNumCacheEntryRoles>* admitted,
+      std::array<uint64_t, kNumCacheEntryRoles>* rejected) const;
+
  private:
   LRUCacheShard* shards_ = nullptr;
   int num_shards_ = 0;
@@ -36,14 +36,16 @@ class LRUCacheTest : public testing::Test {
   }
 
   void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
-                bool use_adaptive_mutex = kDefaultToAdaptiveMutex) {
+                bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+                bool lock_free_lookup = false) {
     DeleteCache();
     cache_ = reinterpret_cast<LRUCacheShard*>(
         port::cacheline_aligned_alloc(sizeof(LRUCacheShard)));
     new (cache_) LRUCacheShard(
         capacity, false /*strict_capcity_limit*/, high_pri_pool_ratio,
         use_adaptive_mutex, kDontChargeCacheMetadata,
-        24 /*max_upper_hash_bits*/, nullptr /*secondary_cache*/);
+        24 /*max_upper_hash_bits*/, nullptr /*secondary_cache*/,
+        false /*use_frequency_admission*/, lock_free_lookup);
   }
 
   void Insert(const std::string& key,
@@ -99,7 +101,7 @@ class LRUCacheTest : public testing::Test {
     ASSERT_EQ(num_high_pri_pool_keys, high_pri_pool_keys);
   }
 
- private:
+ protected:
   LRUCacheShard* cache_ = nullptr;
 };
 
@@ -202,6 +204,295 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+TEST_F(LRUCacheTest, LockFreeLookup) {
+  NewCache(5, 0.0, kDefaultToAdaptiveMutex, true /*lock_free_lookup*/);
+  for (char ch = 'a'; ch <= 'e'; ch++) {
+    Insert(ch);
+  }
+  ValidateLRUList({"a", "b", "c", "d", "e"});
+  // Lookups only mark the entries, which eviction then moves to the MRU end
+  ASSERT_TRUE(Lookup('a'));
+  ASSERT_TRUE(Lookup('b'));
+  ValidateLRUList({"a", "b", "c", "d", "e"});
+  Insert('x');
+  ValidateLRUList({"d", "e", "a", "b", "x"});
+  ASSERT_FALSE(Lookup('c'));
+
+  // Referenced entries stay on the LRU list, but are not evicted
+  Cache::Handle* h = cache_->Lookup("d", 0 /*hash*/);
+  ASSERT_NE(h, nullptr);
+  ASSERT_EQ(1, cache_->GetPinnedUsage());
+  Insert('y');
+  ValidateLRUList({"a", "b", "x", "d", "y"});
+  ASSERT_FALSE(Lookup('e'));
+  ASSERT_EQ(5, cache_->GetUsage());
+  ASSERT_FALSE(cache_->Release(h));
+  ASSERT_EQ(0, cache_->GetPinnedUsage());
+  ASSERT_TRUE(Lookup('d'));
+
+  // An erased entry is freed on its last release
+  h = cache_->Lookup("x", 0 /*hash*/);
+  ASSERT_NE(h, nullptr);
+  Erase("x");
+  ASSERT_FALSE(Lookup('x'));
+  ValidateLRUList({"a", "b", "d", "y"});
+  ASSERT_EQ(5, cache_->GetUsage());
+  ASSERT_TRUE(cache_->Release(h));
+  ASSERT_EQ(4, cache_->GetUsage());
+
+  // As does a referenced entry that is overwritten, or force erased
+  h = cache_->Lookup("y", 0 /*hash*/);
+  ASSERT_NE(h, nullptr);
+  Insert('y');
+  ASSERT_EQ(5, cache_->GetUsage());
+  ASSERT_TRUE(cache_->Release(h));
+  ASSERT_EQ(4, cache_->GetUsage());
+  h = cache_->Lookup("y", 0 /*hash*/);
+  ASSERT_NE(h, nullptr);
+  ASSERT_TRUE(cache_->Release(h, true /*force_erase*/));
+  ASSERT_FALSE(Lookup('y'));
+  ValidateLRUList({"a", "b", "d"});
+  ASSERT_EQ(3, cache_->GetUsage());
+
+  // With a strict capacity limit, inserts fail while everything is pinned
+  cache_->SetStrictCapacityLimit(true);
+  std::vector<Cache::Handle*> handles;
+  for (char ch : {'a', 'b'}) {
+    handles.push_back(cache_->Lookup(std::string(1, ch), 0 /*hash*/));
+    ASSERT_NE(handles.back(), nullptr);
+  }
+  for (char ch = 'p'; ch <= 'r'; ch++) {
+    handles.push_back(nullptr);
+    ASSERT_OK(cache_->Insert(std::string(1, ch), 0 /*hash*/, nullptr, 1,
+                             nullptr, &handles.back(),
+                             Cache::Priority::LOW));
+  }
+  ASSERT_FALSE(Lookup('d'));
+  Cache::Handle* h2 = nullptr;
+  ASSERT_TRUE(cache_->Insert("s", 0 /*hash*/, nullptr, 1, nullptr, &h2,
+                             Cache::Priority::LOW)
+                  .IsIncomplete());
+  ASSERT_EQ(5, cache_->GetPinnedUsage());
+  for (Cache::Handle* handle : handles) {
+    cache_->Release(handle);
+  }
+  ASSERT_EQ(0, cache_->GetPinnedUsage());
+  ASSERT_OK(cache_->Insert("s", 0 /*hash*/, nullptr, 1, nullptr, &h2,
+                           Cache::Priority::LOW));
+  cache_->Release(h2);
+  ASSERT_EQ(5, cache_->GetUsage());
+}
+
+TEST_F(LRUCacheTest, LockFreeLookupConcurrency) {
+  static std::atomic<int> live_values{0};
+  auto deleter = [](const Slice& /*key*/, void* value) {
+    delete static_cast<std::string*>(value);
+    live_values.fetch_sub(1);
+  };
+  LRUCacheOptions opts(64 /*capacity*/, 2 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.5 /*high_pri_pool_ratio*/);
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.lock_free_lookup = true;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+
+  const int kNumThreads = 8;
+  const int kNumOps = 20000;
+  const int kNumKeys = 200;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      std::vector<Cache::Handle*> pinned;
+      for (int i = 0; i < kNumOps; i++) {
+        std::string key = std::to_string(rnd.Uniform(kNumKeys));
+        uint32_t op = rnd.Uniform(100);
+        if (op < 70) {
+          Cache::Handle* h = cache->Lookup(key);
+          if (h != nullptr) {
+            ASSERT_EQ(key, *static_cast<std::string*>(cache->Value(h)));
+            if (pinned.size() < 4 && rnd.OneIn(8)) {
+              pinned.push_back(h);
+            } else {
+              cache->Release(h, rnd.OneIn(50) /*force_erase*/);
+            }
+          }
+        } else if (op < 95) {
+          live_values.fetch_add(1);
+          ASSERT_OK(cache->Insert(key, new std::string(key), 1, deleter,
+                                  nullptr,
+                                  rnd.OneIn(2) ? Cache::Priority::HIGH
+                                               : Cache::Priority::LOW));
+        } else {
+          cache->Erase(key);
+        }
+        if (!pinned.empty() && rnd.OneIn(4)) {
+          cache->Release(pinned.back());
+          pinned.pop_back();
+        }
+      }
+      for (Cache::Handle* h : pinned) {
+        cache->Release(h);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, cache->GetPinnedUsage());
+  ASSERT_LE(cache->GetUsage(), 64);
+  cache.reset();
+  ASSERT_EQ(0, live_values.load());
+}
+
+TEST_F(LRUCacheTest, FrequencyAdmission) {
+  LRUCacheOptions opts(100 /*capacity*/, 0 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.0 /*high_pri_pool_ratio*/);
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.use_frequency_admission = true;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  auto key = [](const char* prefix, int i) {
+    return prefix + std::to_string(i);
+  };
+
+  // A working set that is used repeatedly, plus a few one-time entries
+  for (int i = 0; i < 80; i++) {
+    ASSERT_OK(cache->Insert(key("hot", i), nullptr, 1, nullptr));
+  }
+  for (int i = 0; i < 20; i++) {
+    ASSERT_OK(cache->Insert(key("cold", i), nullptr, 1, nullptr));
+  }
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 80; i++) {
+      Cache::Handle* h = cache->Lookup(key("hot", i));
+      ASSERT_NE(h, nullptr);
+      cache->Release(h);
+    }
+  }
+
+  // A scan of keys that are never seen again must not flush the working set
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(cache->Insert(key("scan", i), nullptr, 1, nullptr));
+  }
+  for (int i = 0; i < 80; i++) {
+    Cache::Handle* h = cache->Lookup(key("hot", i));
+    ASSERT_NE(h, nullptr);
+    cache->Release(h);
+  }
+  ASSERT_EQ(100, cache->GetUsage());
+
+  // A rejected insert with a handle still hands out a usable entry, which is
+  // dropped when released.
+  Cache::Handle* h = nullptr;
+  ASSERT_OK(cache->Insert("once", nullptr, 1, nullptr, &h));
+  ASSERT_NE(h, nullptr);
+  ASSERT_EQ(101, cache->GetUsage());
+  cache->Release(h);
+  ASSERT_EQ(100, cache->GetUsage());
+  ASSERT_EQ(nullptr, cache->Lookup("once"));
+
+  // Keys that keep coming back are eventually admitted
+  for (int round = 0; round < 3; round++) {
+    ASSERT_OK(cache->Insert("recurring", nullptr, 1, nullptr));
+  }
+  h = cache->Lookup("recurring");
+  ASSERT_NE(h, nullptr);
+  cache->Release(h);
+
+  std::array<uint64_t, kNumCacheEntryRoles> admitted;
+  std::array<uint64_t, kNumCacheEntryRoles> rejected;
+  static_cast<LRUCache*>(cache.get())
+      ->GetAdmissionCounts(&admitted, &rejected);
+  size_t misc = static_cast<size_t>(CacheEntryRole::kMisc);
+  ASSERT_GE(rejected[misc], 900);
+  ASSERT_GE(admitted[misc], 1);
+  for (size_t i = 0; i < kNumCacheEntryRoles; i++) {
+    if (i != misc) {
+      ASSERT_EQ(0, admitted[i] + rejected[i]);
+    }
+  }
+}
+
+TEST_F(LRUCacheTest, ShardStats) {
+  for (bool lock_free_lookup : {false, true}) {
+    LRUCacheOptions opts(1024 /*capacity*/, 2 /*num_shard_bits*/,
+                         false /*strict_capacity_limit*/,
+                         0.0 /*high_pri_pool_ratio*/);
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.lock_free_lookup = lock_free_lookup;
+    std::shared_ptr<Cache> cache = NewLRUCache(opts);
+
+    // All the traffic goes to one key, so to one shard
+    ASSERT_OK(cache->Insert("hot", nullptr, 1, nullptr));
+    for (int i = 0; i < 100; i++) {
+      Cache::Handle* h = cache->Lookup("hot");
+      ASSERT_NE(h, nullptr);
+      cache->Release(h);
+    }
+    ASSERT_EQ(nullptr, cache->Lookup("missing"));
+
+    std::vector<CacheShardStats> stats;
+    cache->GetShardStats(&stats);
+    ASSERT_EQ(4, stats.size());
+    CacheShardStats total;
+    size_t hot_shard = stats.size();
+    for (size_t i = 0; i < stats.size(); i++) {
+      ASSERT_EQ(256, stats[i].capacity);
+      total.lookups += stats[i].lookups;
+      total.hits += stats[i].hits;
+      total.inserts += stats[i].inserts;
+      total.usage += stats[i].usage;
+      if (stats[i].hits > 0) {
+        hot_shard = i;
+      }
+    }
+    ASSERT_EQ(101, total.lookups);
+    ASSERT_EQ(100, total.hits);
+    ASSERT_EQ(1, total.inserts);
+    ASSERT_EQ(1, total.usage);
+    ASSERT_EQ(std::vector<size_t>{hot_shard}, FindHotCacheShards(stats));
+  }
+}
+
+TEST_F(LRUCacheTest, AdjacentBlocksSpreadAcrossShards) {
+  // Block cache keys of one file only differ in the encoded block offset.
+  // The whole key is hashed, so a hot range of blocks is not concentrated
+  // in a few shards.
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(1 << 20, 4 /*num_shard_bits*/, false, 0.0);
+  const int kNumBlocks = 1024;
+  std::string prefix(24, 'p');
+  for (int i = 0; i < kNumBlocks; i++) {
+    std::string key = prefix;
+    PutVarint64(&key, uint64_t{4096} * i);
+    ASSERT_OK(cache->Insert(key, nullptr, 1, nullptr));
+  }
+  std::vector<CacheShardStats> stats;
+  cache->GetShardStats(&stats);
+  ASSERT_EQ(16, stats.size());
+  for (const CacheShardStats& shard : stats) {
+    // 64 on average
+    ASSERT_GE(shard.inserts, 32);
+    ASSERT_LE(shard.inserts, 96);
+  }
+  ASSERT_TRUE(FindHotCacheShards(stats).empty());
+}
+
+TEST_F(LRUCacheTest, DefaultShardBits) {
+  ASSERT_EQ(1, GetDefaultCacheShardBits(1 << 20));
+  ASSERT_EQ(4, GetDefaultCacheShardBits(8 << 20));
+  ASSERT_EQ(6, GetDefaultCacheShardBits(32 << 20));
+  ASSERT_EQ(4, GetDefaultCacheShardBits(1 << 20, 64 << 10));
+  ASSERT_GE(GetDefaultCacheShardBits(1 << 20, 1), 6);
+
+  LRUCacheOptions opts;
+  opts.capacity = 1 << 20;
+  opts.min_shard_size = 64 << 10;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  ASSERT_EQ(4, static_cast<LRUCache*>(cache.get())->GetNumShardBits());
+}
+
 class TestSecondaryCache : public SecondaryCache {
  public:
   // Specifies what action to take on a lookup for a particular key
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <thread>
 
 #include "util/hash.h"
 #include "util/math.h"
@@ -212,19 +213,67 @@ std::string ShardedCache::GetPrintableOptions() const {
   ret.append(GetShard(0)->GetPrintableOptions());
   return ret;
 }
-int GetDefaultCacheShardBits(size_t capacity) {
+
+void ShardedCache::GetShardStats(std::vector<CacheShardStats>* stats) const {
+  uint32_t num_shards = GetNumShards();
+  stats->assign(num_shards, CacheShardStats());
+  size_t per_shard;
+  {
+    MutexLock l(&capacity_mutex_);
+    per_shard = (capacity_ + (num_shards - 1)) / num_shards;
+  }
+  for (uint32_t s = 0; s < num_shards; s++) {
+    CacheShardStats& shard_stats = (*stats)[s];
+    shard_stats.usage = GetShard(s)->GetUsage();
+    shard_stats.capacity = per_shard;
+    GetShard(s)->GetStats(&shard_stats);
+  }
+}
+
+int GetDefaultCacheShardBits(size_t capacity, size_t min_shard_size) {
+  int max_num_shard_bits = 6;
+  unsigned num_cpus = std::thread::hardware_concurrency();
+  if (num_cpus > 32) {
+    // Two shards per core, so that the threads rarely wait for each other
+    max_num_shard_bits = std::min(FloorLog2(num_cpus) + 1, 19);
+  }
   int num_shard_bits = 0;
-  size_t min_shard_size = 512L * 1024L;  // Every shard is at least 512KB.
-  size_t num_shards = capacity / min_shard_size;
+  size_t num_shards = capacity / std::max(min_shard_size, size_t{1});
   while (num_shards >>= 1) {
-    if (++num_shard_bits >= 6) {
-      // No more than 6.
+    if (++num_shard_bits >= max_num_shard_bits) {
       return num_shard_bits;
     }
   }
   return num_shard_bits;
 }
 
+std::vector<size_t> FindHotCacheShards(
+    const std::vector<CacheShardStats>& shard_stats, double min_ratio) {
+  std::vector<size_t> hot_shards;
+  if (shard_stats.size() < 2) {
+    return hot_shards;
+  }
+  double total_lookups = 0;
+  double total_contentions = 0;
+  for (const CacheShardStats& stats : shard_stats) {
+    total_lookups += static_cast<double>(stats.lookups);
+    total_contentions += static_cast<double>(stats.lock_contentions);
+  }
+  double n = static_cast<double>(shard_stats.size());
+  double min_lookups = min_ratio * total_lookups / n;
+  double min_contentions = min_ratio * total_contentions / n;
+  for (size_t i = 0; i < shard_stats.size(); i++) {
+    if ((total_lookups > 0 &&
+         static_cast<double>(shard_stats[i].lookups) >= min_lookups) ||
+        (total_contentions > 0 &&
+         static_cast<double>(shard_stats[i].lock_contentions) >=
+             min_contentions)) {
+      hot_shards.push_back(i);
+    }
+  }
+  return hot_shards;
+}
+
 int ShardedCache::GetNumShardBits() const { return BitsSetToOne(shard_mask_); }
 
 uint32_t ShardedCache::GetNumShards() const { return shard_mask_ + 1; }
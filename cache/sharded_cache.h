@@ -11,6 +11,7 @@
 
 #include <atomic>
 #include <string>
+#include <vector>
 
 #include "port/port.h"
 #include "rocksdb/cache.h"
@@ -56,6 +57,8 @@ class CacheShard {
       uint32_t average_entries_per_lock, uint32_t* state) = 0;
   virtual void EraseUnRefEntries() = 0;
   virtual std::string GetPrintableOptions() const { return ""; }
+  // Fills in the activity counters of *stats that the shard keeps
+  virtual void GetStats(CacheShardStats* /*stats*/) const {}
   void set_metadata_charge_policy(
       CacheMetadataChargePolicy metadata_charge_policy) {
     metadata_charge_policy_ = metadata_charge_policy;
@@ -111,6 +114,8 @@ class ShardedCache : public Cache {
       const ApplyToAllEntriesOptions& opts) override;
   virtual void EraseUnRefEntries() override;
   virtual std::string GetPrintableOptions() const override;
+  virtual void GetShardStats(
+      std::vector<CacheShardStats>* stats) const override;
 
   int GetNumShardBits() const;
   uint32_t GetNumShards() const;
@@ -126,6 +131,9 @@ class ShardedCache : public Cache {
   std::atomic<uint64_t> last_id_;
 };
 
-extern int GetDefaultCacheShardBits(size_t capacity);
+// The number of shard bits for shards of at least min_shard_size bytes, up
+// to 6 bits or, with more than 32 cores, enough for two shards per core.
+extern int GetDefaultCacheShardBits(size_t capacity,
+                                    size_t min_shard_size = 512 * 1024);
 
 }  // namespace ROCKSDB_NAMESPACE
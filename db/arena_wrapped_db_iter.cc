@@ -61,8 +61,14 @@ Status ArenaWrappedDBIter::Refresh() {
   if (sv_number_ != cur_sv_number) {
     Env* env = db_iter_->env();
     db_iter_->~DBIter();
+    if (block_pool_ == nullptr) {
+      block_pool_.reset(new ArenaBlockPool(/*write_buffer_manager=*/nullptr));
+    }
+    // The rebuilt iterator is likely to take about as much memory
+    block_pool_->SetCapacity(arena_.MemoryAllocatedBytes());
     arena_.~Arena();
-    new (&arena_) Arena();
+    new (&arena_) Arena(Arena::kMinBlockSize, /*tracker=*/nullptr,
+                        /*huge_page_size=*/0, block_pool_.get());
 
     SuperVersion* sv = cfd_->GetReferencedSuperVersion(db_impl_);
     SequenceNumber latest_seq = db_impl_->GetLatestSequenceNumber();
@@ -9,6 +9,7 @@
 
 #pragma once
 #include <stdint.h>
+#include <memory>
 #include <string>
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
@@ -61,6 +62,11 @@ class ArenaWrappedDBIter : public Iterator {
   }
   void Next() override { db_iter_->Next(); }
   void Prev() override { db_iter_->Prev(); }
+  Status NextBatch(size_t max_entries, size_t max_bytes,
+                   std::vector<Slice>* keys, std::vector<Slice>* values,
+                   std::string* buf) override {
+    return db_iter_->NextBatch(max_entries, max_bytes, keys, values, buf);
+  }
   Slice key() const override { return db_iter_->key(); }
   Slice value() const override { return db_iter_->value(); }
   Status status() const override { return db_iter_->status(); }
@@ -91,6 +97,10 @@ class ArenaWrappedDBIter : public Iterator {
 
  private:
   DBIter* db_iter_;
+  // Created by the first Refresh() that rebuilds the iterator. It takes back
+  // the blocks of each arena_ rebuilt, for the next one to reuse. Declared
+  // before arena_ to outlive it.
+  std::unique_ptr<ArenaBlockPool> block_pool_;
   Arena arena_;
   uint64_t sv_number_;
   ColumnFamilyData* cfd_ = nullptr;
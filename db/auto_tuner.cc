@@ -0,0 +1,206 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "db/auto_tuner.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "logging/logging.h"
+#include "monitoring/statistics.h"
+#include "rocksdb/statistics.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Moves towards `next` without going past `cap`, or down
+int64_t StepUp(int64_t current, int64_t next, int64_t cap) {
+  return std::max(current, std::min(next, cap));
+}
+
+// Moves towards `next` without going below `configured`, or up
+int64_t StepDown(int64_t current, int64_t next, int64_t configured) {
+  return current <= configured ? current : std::max(next, configured);
+}
+}  // namespace
+
+AutoTuner::AutoTuner(uint64_t target_write_p99_micros, Logger* info_log)
+    : target_write_p99_micros_(target_write_p99_micros),
+      info_log_(info_log) {}
+
+void AutoTuner::CollectStatistics(Statistics* stats, Signals* signals) {
+  if (stats == nullptr) {
+    return;
+  }
+  const uint64_t stall_micros = stats->getTickerCount(STALL_MICROS);
+  if (has_stall_micros_ && stall_micros >= prev_stall_micros_) {
+    signals->stall_micros = stall_micros - prev_stall_micros_;
+  }
+  has_stall_micros_ = true;
+  prev_stall_micros_ = stall_micros;
+
+  // Only StatisticsImpl lets the tuner keep its own interval, and not take
+  // those of histogramDataInterval()
+  auto* stats_impl = dynamic_cast<StatisticsImpl*>(stats);
+  if (stats_impl != nullptr) {
+    const bool has_base = write_hist_base_ != nullptr;
+    HistogramData data;
+    stats_impl->histogramDataSince(DB_WRITE, &write_hist_base_, &data);
+    if (has_base && data.count > 0) {
+      signals->write_p99_micros = data.percentile99;
+    }
+  }
+}
+
+int64_t AutoTuner::Track(Knob* knob, int64_t current) {
+  if (!knob->initialized || current != knob->last_set) {
+    knob->initialized = true;
+    knob->configured = current;
+    knob->last_set = current;
+  }
+  return knob->configured;
+}
+
+void AutoTuner::Set(Knob* knob, const std::string& name, int64_t from,
+                    int64_t to, const std::string& reason) {
+  knob->last_set = to;
+  ROCKS_LOG_INFO(info_log_,
+                 "[auto-tune] %s: %" PRId64 " -> %" PRId64
+                 " (configured %" PRId64 "): %s",
+                 name.c_str(), from, to, knob->configured, reason.c_str());
+}
+
+void AutoTuner::Tune(const Signals& signals, Decision* decision) {
+  // Why compaction is taken to fall behind, if it is
+  std::string behind;
+  if (signals.stall_micros > 0) {
+    behind = "writes stalled for " + ToString(signals.stall_micros) + "us";
+  }
+  const ColumnFamilySignals* stalling_cf = nullptr;
+  for (const auto& cf : signals.column_families) {
+    if (cf.seconds_to_stall >= 0 && cf.seconds_to_stall < kStallHorizonSecs &&
+        (stalling_cf == nullptr ||
+         cf.seconds_to_stall < stalling_cf->seconds_to_stall)) {
+      stalling_cf = &cf;
+    }
+  }
+  if (stalling_cf != nullptr) {
+    char buf[200];
+    snprintf(buf, sizeof(buf), "column family %s expected to stall in %.0fs",
+             stalling_cf->name.c_str(), stalling_cf->seconds_to_stall);
+    behind += behind.empty() ? buf : std::string(", ") + buf;
+  }
+
+  const bool missed_target =
+      target_write_p99_micros_ > 0 &&
+      signals.write_p99_micros > static_cast<double>(target_write_p99_micros_);
+  // Why to step back down, if at all
+  std::string calm;
+  if (!behind.empty()) {
+    calm_periods_ = 0;
+  } else if (missed_target) {
+    calm_periods_ = 0;
+    char buf[200];
+    snprintf(buf, sizeof(buf),
+             "write P99 %.0fus above target %" PRIu64
+             "us with compaction keeping up",
+             signals.write_p99_micros, target_write_p99_micros_);
+    calm = buf;
+  } else if (++calm_periods_ >= kCalmPeriodsBeforeStepDown) {
+    calm_periods_ = 0;
+    calm = "compaction kept up for " + ToString(kCalmPeriodsBeforeStepDown) +
+           " periods";
+  }
+  const std::string& reason = behind.empty() ? calm : behind;
+
+  {
+    const int64_t current = signals.max_background_jobs;
+    const int64_t configured = Track(&max_background_jobs_, current);
+    int64_t next = current;
+    if (!behind.empty()) {
+      next = StepUp(current, current + 1,
+                    std::max(2 * configured, configured + 1));
+    } else if (!calm.empty()) {
+      next = StepDown(current, current - 1, configured);
+    }
+    if (next != current) {
+      decision->db_options["max_background_jobs"] = ToString(next);
+      Set(&max_background_jobs_, "max_background_jobs", current, next,
+          reason);
+    }
+  }
+
+  {
+    const int64_t current = signals.compaction_readahead_size;
+    const int64_t configured = Track(&compaction_readahead_size_, current);
+    int64_t next = current;
+    if (!behind.empty()) {
+      next = StepUp(current, std::max(2 * current, kMinCompactionReadahead),
+                    std::max(2 * configured, kMinCompactionReadaheadCap));
+    } else if (!calm.empty()) {
+      next = StepDown(current, current / 2, configured);
+      if (next < kMinCompactionReadahead) {
+        next = configured;
+      }
+    }
+    if (next != current) {
+      decision->db_options["compaction_readahead_size"] = ToString(next);
+      Set(&compaction_readahead_size_, "compaction_readahead_size", current,
+          next, reason);
+    }
+  }
+
+  if (signals.rate_limiter_bytes_per_sec > 0) {
+    const int64_t current = signals.rate_limiter_bytes_per_sec;
+    const int64_t configured = Track(&rate_limiter_bytes_per_sec_, current);
+    int64_t next = current;
+    if (!behind.empty()) {
+      next = StepUp(current, current + std::max<int64_t>(current / 4, 1),
+                    4 * configured);
+    } else if (!calm.empty()) {
+      next = StepDown(current, current - current / 5, configured);
+    }
+    if (next != current) {
+      decision->rate_limiter_bytes_per_sec = next;
+      Set(&rate_limiter_bytes_per_sec_, "rate_limiter.bytes_per_sec", current,
+          next, reason);
+    }
+  }
+
+  std::map<uint32_t, Knob> level0_slowdown_writes_trigger;
+  for (const auto& cf : signals.column_families) {
+    Knob& knob = level0_slowdown_writes_trigger[cf.id];
+    auto it = level0_slowdown_writes_trigger_.find(cf.id);
+    if (it != level0_slowdown_writes_trigger_.end()) {
+      knob = it->second;
+    }
+    const int64_t current = cf.level0_slowdown_writes_trigger;
+    const int64_t configured = Track(&knob, current);
+    int64_t next = current;
+    // Only raised while writes are slowed down for the files in L0
+    if (!behind.empty() && cf.l0_files >= current) {
+      next = StepUp(current, current + 2,
+                    std::min<int64_t>(2 * configured,
+                                      cf.level0_stop_writes_trigger - 1));
+    } else if (!calm.empty()) {
+      next = StepDown(current, current - 2, configured);
+    }
+    if (next != current) {
+      decision->cf_options[cf.id]["level0_slowdown_writes_trigger"] =
+          ToString(next);
+      Set(&knob, "[" + cf.name + "] level0_slowdown_writes_trigger", current,
+          next, reason);
+    }
+  }
+  // Forgets dropped column families
+  level0_slowdown_writes_trigger_.swap(level0_slowdown_writes_trigger);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
@@ -0,0 +1,120 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "monitoring/histogram.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Logger;
+class Statistics;
+
+// Decides how to adjust the mutable options of a DB to its load, see
+// DBOptions::auto_tune_period_sec. DBImpl::AutoTune() gathers the signals
+// every period, and applies the decision through SetDBOptions() and
+// SetOptions().
+//
+// Every tuned option is stepped between its configured value and a cap, at
+// most one step per period. Compaction is taken to fall behind when writes
+// stalled during the period, or the compaction debt forecast of a column
+// family expects a stall within kStallHorizonSecs; the options are then
+// raised. They step back down once compaction kept up for
+// kCalmPeriodsBeforeStepDown periods in a row, or right away while the write
+// latency target is missed with compaction keeping up.
+//
+// Not thread-safe; only used from the periodic work scheduler thread.
+class AutoTuner {
+ public:
+  static constexpr double kStallHorizonSecs = 300;
+  static constexpr int kCalmPeriodsBeforeStepDown = 3;
+  // The smallest non-zero compaction_readahead_size set, and the least cap
+  static constexpr int64_t kMinCompactionReadahead = 256 << 10;
+  static constexpr int64_t kMinCompactionReadaheadCap = 2 << 20;
+
+  struct ColumnFamilySignals {
+    uint32_t id = 0;
+    std::string name;
+    int l0_files = 0;
+    int level0_slowdown_writes_trigger = 0;
+    int level0_stop_writes_trigger = 0;
+    // From the compaction debt forecast; -1 when no stall is expected
+    double seconds_to_stall = -1;
+  };
+
+  struct Signals {
+    int max_background_jobs = 0;
+    int64_t compaction_readahead_size = 0;
+    // 0 without a rate limiter
+    int64_t rate_limiter_bytes_per_sec = 0;
+    // Since the previous period; 0 without statistics
+    uint64_t stall_micros = 0;
+    // Over the previous period; -1 when unknown
+    double write_p99_micros = -1;
+    std::vector<ColumnFamilySignals> column_families;
+  };
+
+  struct Decision {
+    // For SetDBOptions()
+    std::unordered_map<std::string, std::string> db_options;
+    // For SetOptions(), by column family ID
+    std::map<uint32_t, std::unordered_map<std::string, std::string>>
+        cf_options;
+    // 0 to leave the rate limiter as is
+    int64_t rate_limiter_bytes_per_sec = 0;
+  };
+
+  AutoTuner(uint64_t target_write_p99_micros, Logger* info_log);
+
+  // Fills in the stall time and write latency of `signals` from `stats`,
+  // which may be nullptr, since the previous call
+  void CollectStatistics(Statistics* stats, Signals* signals);
+
+  // Decides on the changes for `signals`, and logs them
+  void Tune(const Signals& signals, Decision* decision);
+
+ private:
+  // A tuned option. The value it was configured to is adopted on the first
+  // period, and whenever it no longer has the value the tuner last set.
+  struct Knob {
+    bool initialized = false;
+    int64_t configured = 0;
+    int64_t last_set = 0;
+  };
+
+  // Returns the configured value of `knob`, currently `current`
+  static int64_t Track(Knob* knob, int64_t current);
+  // Records and logs a change of `knob` from `from` to `to`
+  void Set(Knob* knob, const std::string& name, int64_t from, int64_t to,
+           const std::string& reason);
+
+  const uint64_t target_write_p99_micros_;
+  Logger* const info_log_;
+
+  Knob max_background_jobs_;
+  Knob compaction_readahead_size_;
+  Knob rate_limiter_bytes_per_sec_;
+  // By column family ID
+  std::map<uint32_t, Knob> level0_slowdown_writes_trigger_;
+  int calm_periods_ = 0;
+
+  bool has_stall_micros_ = false;
+  uint64_t prev_stall_micros_ = 0;
+  std::unique_ptr<Histogram> write_hist_base_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
@@ -5,6 +5,7 @@
 
 #include "db/blob/blob_file_builder.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "db/blob/blob_file_addition.h"
@@ -61,6 +62,10 @@ BlobFileBuilder::BlobFileBuilder(
       min_blob_size_(mutable_cf_options->min_blob_size),
       blob_file_size_(mutable_cf_options->blob_file_size),
       blob_compression_type_(mutable_cf_options->blob_compression_type),
+      blob_compression_max_dict_bytes_(
+          DictCompressionTypeSupported(blob_compression_type_)
+              ? mutable_cf_options->blob_compression_max_dict_bytes
+              : 0),
       file_options_(file_options),
       job_id_(job_id),
       column_family_id_(column_family_id),
@@ -72,7 +77,15 @@ BlobFileBuilder::BlobFileBuilder(
       blob_file_paths_(blob_file_paths),
       blob_file_additions_(blob_file_additions),
       blob_count_(0),
-      blob_bytes_(0) {
+      blob_bytes_(0),
+      compression_dict_records_offset_(0),
+      // The workers cannot use a dictionary created along the way
+      compress_ahead_(
+          mutable_cf_options->blob_compression_parallel_threads > 1 &&
+          blob_compression_type_ != kNoCompression &&
+          blob_compression_max_dict_bytes_ == 0),
+      num_compress_threads_(
+          mutable_cf_options->blob_compression_parallel_threads) {
   assert(file_number_generator_);
   assert(fs_);
   assert(immutable_options_);
@@ -83,7 +96,12 @@ BlobFileBuilder::BlobFileBuilder(
   assert(blob_file_additions_->empty());
 }
 
-BlobFileBuilder::~BlobFileBuilder() = default;
+BlobFileBuilder::~BlobFileBuilder() {
+  compress_queue_.finish();
+  for (auto& thread : compress_threads_) {
+    thread.join();
+  }
+}
 
 Status BlobFileBuilder::Add(const Slice& key, const Slice& value,
                             std::string* blob_index) {
@@ -122,6 +140,10 @@ Status BlobFileBuilder::Add(const Slice& key, const Slice& value,
     }
   }
 
+  if (blob_compression_max_dict_bytes_ > 0 && !compression_dict_) {
+    AddCompressionDictSample(value);
+  }
+
   {
     const Status s = CloseBlobFileIfNeeded();
     if (!s.ok()) {
@@ -165,6 +187,12 @@ Status BlobFileBuilder::OpenBlobFileIfNeeded() {
 
   {
     assert(file_options_);
+
+    bool use_direct_writes = file_options_->use_direct_writes;
+    TEST_SYNC_POINT_CALLBACK(
+        "BlobFileBuilder::OpenBlobFileIfNeeded:UseDirectWrites",
+        &use_direct_writes);
+
     Status s = NewWritableFile(fs_, blob_file_path, &file, *file_options_);
 
     TEST_SYNC_POINT_CALLBACK(
@@ -204,6 +232,9 @@ Status BlobFileBuilder::OpenBlobFileIfNeeded() {
 
   BlobLogHeader header(column_family_id_, blob_compression_type_, has_ttl,
                        expiration_range);
+  if (blob_compression_max_dict_bytes_ > 0) {
+    header.version = kVersion2;
+  }
 
   {
     Status s = blob_log_writer->WriteHeader(header);
@@ -220,11 +251,14 @@ Status BlobFileBuilder::OpenBlobFileIfNeeded() {
 
   assert(IsBlobFileOpen());
 
+  // A dictionary created for an earlier file applies to all records
+  compression_dict_records_offset_ = BlobLogHeader::kSize;
+
   return Status::OK();
 }
 
-Status BlobFileBuilder::CompressBlobIfNeeded(
-    Slice* blob, std::string* compressed_blob) const {
+Status BlobFileBuilder::CompressBlobIfNeeded(Slice* blob,
+                                             std::string* compressed_blob) {
   assert(blob);
   assert(compressed_blob);
   assert(compressed_blob->empty());
@@ -233,24 +267,131 @@ Status BlobFileBuilder::CompressBlobIfNeeded(
     return Status::OK();
   }
 
+  Status s;
+
+  if (!TakeCompressedBlob(*blob, compressed_blob, &s)) {
+    CompressionContext context(blob_compression_type_);
+    s = CompressBlob(*blob, &context, compressed_blob);
+  }
+
+  if (!s.ok()) {
+    return s;
+  }
+
+  *blob = Slice(*compressed_blob);
+
+  return Status::OK();
+}
+
+Status BlobFileBuilder::CompressBlob(const Slice& blob,
+                                     CompressionContext* context,
+                                     std::string* compressed_blob) const {
+  assert(context);
+  assert(compressed_blob);
+
   CompressionOptions opts;
-  CompressionContext context(blob_compression_type_);
   constexpr uint64_t sample_for_compression = 0;
 
-  CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(),
-                       blob_compression_type_, sample_for_compression);
+  CompressionInfo info(
+      opts, *context,
+      compression_dict_ ? *compression_dict_ : CompressionDict::GetEmptyDict(),
+      blob_compression_type_, sample_for_compression,
+      immutable_options_->compressor.get());
 
   constexpr uint32_t compression_format_version = 2;
 
-  if (!CompressData(*blob, info, compression_format_version, compressed_blob)) {
+  if (!CompressData(blob, info, compression_format_version, compressed_blob)) {
     return Status::Corruption("Error compressing blob");
   }
 
-  *blob = Slice(*compressed_blob);
-
   return Status::OK();
 }
 
+void BlobFileBuilder::CompressAhead(const Slice& value) {
+  assert(compress_ahead_);
+
+  if (value.size() < min_blob_size_) {
+    return;
+  }
+
+  if (compress_threads_.empty()) {
+    compress_threads_.reserve(num_compress_threads_);
+    for (uint32_t i = 0; i < num_compress_threads_; ++i) {
+      compress_threads_.emplace_back([this] { CompressThread(); });
+    }
+  }
+
+  std::shared_ptr<CompressedBlob> compressed_blob(new CompressedBlob);
+  compressed_blob->value.assign(value.data(), value.size());
+
+  {
+    std::lock_guard<std::mutex> lock(compressed_blobs_mutex_);
+    // Only values that were skipped can be this far behind
+    while (compressed_blobs_.size() >= MaxCompressAhead()) {
+      compressed_blobs_.pop_front();
+    }
+    compressed_blobs_.push_back(compressed_blob);
+  }
+
+  compress_queue_.push(std::move(compressed_blob));
+}
+
+bool BlobFileBuilder::TakeCompressedBlob(const Slice& blob,
+                                         std::string* compressed_blob,
+                                         Status* s) {
+  assert(compressed_blob);
+  assert(s);
+
+  if (!compress_ahead_) {
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(compressed_blobs_mutex_);
+
+  // Values before the one being added were not added after all
+  auto it = compressed_blobs_.begin();
+  for (; it != compressed_blobs_.end(); ++it) {
+    if (Slice((*it)->value) == blob) {
+      break;
+    }
+  }
+
+  if (it == compressed_blobs_.end()) {
+    return false;
+  }
+
+  std::shared_ptr<CompressedBlob> found = *it;
+  compressed_blobs_.erase(compressed_blobs_.begin(), it + 1);
+
+  compressed_blobs_cv_.wait(lock, [&found] { return found->done; });
+
+  *s = found->status;
+  compressed_blob->swap(found->compressed_value);
+
+  return true;
+}
+
+void BlobFileBuilder::CompressThread() {
+  CompressionContext context(blob_compression_type_);
+
+  std::shared_ptr<CompressedBlob> compressed_blob;
+  while (compress_queue_.pop(compressed_blob)) {
+    std::string compressed_value;
+    const Status s =
+        CompressBlob(compressed_blob->value, &context, &compressed_value);
+
+    {
+      std::lock_guard<std::mutex> lock(compressed_blobs_mutex_);
+      compressed_blob->compressed_value = std::move(compressed_value);
+      compressed_blob->status = s;
+      compressed_blob->done = true;
+    }
+
+    compressed_blobs_cv_.notify_all();
+    compressed_blob.reset();
+  }
+}
+
 Status BlobFileBuilder::WriteBlobToFile(const Slice& key, const Slice& blob,
                                         uint64_t* blob_file_number,
                                         uint64_t* blob_offset) {
@@ -279,6 +420,19 @@ Status BlobFileBuilder::WriteBlobToFile(const Slice& key, const Slice& blob,
 Status BlobFileBuilder::CloseBlobFile() {
   assert(IsBlobFileOpen());
 
+  if (blob_compression_max_dict_bytes_ > 0) {
+    BlobLogCompressionDict compression_dict;
+    if (compression_dict_) {
+      compression_dict.records_offset = compression_dict_records_offset_;
+      compression_dict.dict = compression_dict_->GetRawDict().ToString();
+    }
+
+    const Status s = writer_->AppendCompressionDict(compression_dict);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
   BlobLogFooter footer;
   footer.blob_count = blob_count_;
 
@@ -330,6 +484,61 @@ Status BlobFileBuilder::CloseBlobFileIfNeeded() {
   return CloseBlobFile();
 }
 
+void BlobFileBuilder::AddCompressionDictSample(const Slice& value) {
+  assert(blob_compression_max_dict_bytes_ > 0);
+  assert(!compression_dict_);
+
+  const size_t max_sample_bytes =
+      static_cast<size_t>(blob_compression_max_dict_bytes_) *
+      kCompressionDictSampleFactor;
+  assert(compression_dict_samples_.size() < max_sample_bytes);
+
+  const size_t len = std::min(
+      value.size(), max_sample_bytes - compression_dict_samples_.size());
+  compression_dict_samples_.append(value.data(), len);
+  compression_dict_sample_lens_.emplace_back(len);
+
+  if (compression_dict_samples_.size() >= max_sample_bytes) {
+    CreateCompressionDict();
+  }
+}
+
+void BlobFileBuilder::CreateCompressionDict() {
+  assert(IsBlobFileOpen());
+
+  std::string dict;
+  if ((blob_compression_type_ == kZSTD ||
+       blob_compression_type_ == kZSTDNotFinalCompression) &&
+      ZSTD_TrainDictionarySupported()) {
+    // An empty dictionary if training fails, which disables it
+    dict = ZSTD_TrainDictionary(compression_dict_samples_,
+                                compression_dict_sample_lens_,
+                                blob_compression_max_dict_bytes_);
+  } else {
+    dict = std::move(compression_dict_samples_);
+    dict.resize(std::min<size_t>(dict.size(),
+                                 blob_compression_max_dict_bytes_));
+  }
+
+  compression_dict_.reset(
+      new CompressionDict(std::move(dict), blob_compression_type_,
+                          CompressionOptions::kDefaultCompressionLevel));
+
+  std::string().swap(compression_dict_samples_);
+  std::vector<size_t>().swap(compression_dict_sample_lens_);
+
+  // The records written from now on in the current file use the dictionary
+  compression_dict_records_offset_ = writer_->file()->GetFileSize();
+
+  assert(immutable_options_);
+  ROCKS_LOG_INFO(immutable_options_->logger,
+                 "[%s] [JOB %d] Created %" ROCKSDB_PRIszt
+                 " byte blob compression dictionary in blob file #%" PRIu64,
+                 column_family_name_.c_str(), job_id_,
+                 compression_dict_->GetRawDict().size(),
+                 writer_->get_log_number());
+}
+
 void BlobFileBuilder::Abandon() {
   if (!IsBlobFileOpen()) {
     return;
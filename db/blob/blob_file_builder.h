@@ -5,14 +5,20 @@
 #pragma once
 
 #include <cinttypes>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "port/port.h"
 #include "rocksdb/compression_type.h"
 #include "rocksdb/env.h"
 #include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/status.h"
+#include "util/work_queue.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -23,14 +29,23 @@ struct ImmutableOptions;
 struct MutableCFOptions;
 struct FileOptions;
 class BlobFileAddition;
-class Status;
 class Slice;
 class BlobLogWriter;
 class IOTracer;
 class BlobFileCompletionCallback;
+struct CompressionDict;
+class CompressionContext;
 
 class BlobFileBuilder {
  public:
+  // With blob_compression_max_dict_bytes set, the compression dictionary is
+  // built from this many times its maximum size worth of blobs.
+  static constexpr size_t kCompressionDictSampleFactor = 100;
+
+  // How many values per thread CompressAhead() may be called for ahead of
+  // Add(), with blob_compression_parallel_threads set
+  static constexpr size_t kCompressAheadPerThread = 8;
+
   BlobFileBuilder(VersionSet* versions, FileSystem* fs,
                   const ImmutableOptions* immutable_options,
                   const MutableCFOptions* mutable_cf_options,
@@ -66,14 +81,45 @@ class BlobFileBuilder {
   Status Finish();
   void Abandon();
 
+  // Whether values can be passed to CompressAhead(), i.e. whether blobs are
+  // compressed on blob_compression_parallel_threads worker threads.
+  bool CanCompressAhead() const { return compress_ahead_; }
+
+  // How far ahead of Add() CompressAhead() may be called, as a number of
+  // entries of the input
+  size_t MaxCompressAhead() const {
+    return num_compress_threads_ * kCompressAheadPerThread;
+  }
+
+  // Starts compressing `value` on a worker thread if it is large enough to
+  // be written to a blob file, so that Add() can use the result. Values must
+  // be passed in the order of the Add() calls they are expected in; those
+  // Add() is not called for are discarded. `value` is copied.
+  void CompressAhead(const Slice& value);
+
  private:
+  // A value passed to CompressAhead(), and its compressed form once done
+  struct CompressedBlob {
+    std::string value;
+    std::string compressed_value;
+    Status status;
+    bool done = false;
+  };
+
   bool IsBlobFileOpen() const;
   Status OpenBlobFileIfNeeded();
-  Status CompressBlobIfNeeded(Slice* blob, std::string* compressed_blob) const;
+  Status CompressBlobIfNeeded(Slice* blob, std::string* compressed_blob);
+  Status CompressBlob(const Slice& blob, CompressionContext* context,
+                      std::string* compressed_blob) const;
+  bool TakeCompressedBlob(const Slice& blob, std::string* compressed_blob,
+                          Status* s);
+  void CompressThread();
   Status WriteBlobToFile(const Slice& key, const Slice& blob,
                          uint64_t* blob_file_number, uint64_t* blob_offset);
   Status CloseBlobFile();
   Status CloseBlobFileIfNeeded();
+  void AddCompressionDictSample(const Slice& value);
+  void CreateCompressionDict();
 
   std::function<uint64_t()> file_number_generator_;
   FileSystem* fs_;
@@ -81,6 +127,7 @@ class BlobFileBuilder {
   uint64_t min_blob_size_;
   uint64_t blob_file_size_;
   CompressionType blob_compression_type_;
+  uint32_t blob_compression_max_dict_bytes_;
   const FileOptions* file_options_;
   int job_id_;
   uint32_t column_family_id_;
@@ -94,6 +141,23 @@ class BlobFileBuilder {
   std::unique_ptr<BlobLogWriter> writer_;
   uint64_t blob_count_;
   uint64_t blob_bytes_;
+
+  // Values sampled for the compression dictionary until it is created, and
+  // the offset of the first record of the current file compressed with it
+  std::string compression_dict_samples_;
+  std::vector<size_t> compression_dict_sample_lens_;
+  std::unique_ptr<CompressionDict> compression_dict_;
+  uint64_t compression_dict_records_offset_;
+
+  const bool compress_ahead_;
+  const uint32_t num_compress_threads_;
+  std::vector<port::Thread> compress_threads_;
+  WorkQueue<std::shared_ptr<CompressedBlob>> compress_queue_;
+  std::mutex compressed_blobs_mutex_;
+  std::condition_variable compressed_blobs_cv_;
+  // The values passed to CompressAhead() that Add() may still be called for,
+  // in order
+  std::deque<std::shared_ptr<CompressedBlob>> compressed_blobs_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -421,6 +421,95 @@ TEST_F(BlobFileBuilderTest, Compression) {
                  kSnappyCompression, expected_key_value_pairs, blob_indexes);
 }
 
+TEST_F(BlobFileBuilderTest, ParallelCompression) {
+  // Build a blob file with blobs compressed ahead on worker threads
+  if (!Snappy_Supported()) {
+    return;
+  }
+
+  constexpr size_t number_of_blobs = 10;
+
+  Options options;
+  options.cf_paths.emplace_back(
+      test::PerThreadDBPath(&mock_env_,
+                            "BlobFileBuilderTest_ParallelCompression"),
+      0);
+  options.enable_blob_files = true;
+  options.blob_compression_type = kSnappyCompression;
+  options.blob_compression_parallel_threads = 4;
+  options.env = &mock_env_;
+
+  ImmutableOptions immutable_options(options);
+  MutableCFOptions mutable_cf_options(options);
+
+  constexpr int job_id = 1;
+  constexpr uint32_t column_family_id = 123;
+  constexpr char column_family_name[] = "foobar";
+  constexpr Env::IOPriority io_priority = Env::IO_HIGH;
+  constexpr Env::WriteLifeTimeHint write_hint = Env::WLTH_MEDIUM;
+
+  std::vector<std::string> blob_file_paths;
+  std::vector<BlobFileAddition> blob_file_additions;
+
+  BlobFileBuilder builder(
+      TestFileNumberGenerator(), fs_, &immutable_options, &mutable_cf_options,
+      &file_options_, job_id, column_family_id, column_family_name, io_priority,
+      write_hint, nullptr /*IOTracer*/, nullptr /*BlobFileCompletionCallback*/,
+      &blob_file_paths, &blob_file_additions);
+
+  ASSERT_TRUE(builder.CanCompressAhead());
+
+  std::vector<std::pair<std::string, std::string>> uncompressed_key_values;
+  for (size_t i = 0; i < number_of_blobs; ++i) {
+    uncompressed_key_values.emplace_back(
+        std::to_string(i),
+        std::string(100 * (i + 1), static_cast<char>('a' + i)));
+  }
+
+  // All but the last value are compressed ahead, along with one that does
+  // not get added
+  for (size_t i = 0; i + 1 < number_of_blobs; ++i) {
+    builder.CompressAhead(uncompressed_key_values[i].second);
+    if (i == 4) {
+      builder.CompressAhead(std::string(1000, 'z'));
+    }
+  }
+
+  std::vector<std::string> blob_indexes(number_of_blobs);
+  for (size_t i = 0; i < number_of_blobs; ++i) {
+    ASSERT_OK(builder.Add(uncompressed_key_values[i].first,
+                          uncompressed_key_values[i].second, &blob_indexes[i]));
+    ASSERT_FALSE(blob_indexes[i].empty());
+  }
+
+  ASSERT_OK(builder.Finish());
+
+  // The blobs are the same as if compressed one by one
+  constexpr uint64_t blob_file_number = 2;
+
+  ASSERT_EQ(blob_file_paths.size(), 1);
+  ASSERT_EQ(blob_file_additions.size(), 1);
+  ASSERT_EQ(blob_file_additions[0].GetTotalBlobCount(), number_of_blobs);
+
+  CompressionOptions opts;
+  CompressionContext context(kSnappyCompression);
+  constexpr uint64_t sample_for_compression = 0;
+
+  CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(),
+                       kSnappyCompression, sample_for_compression);
+
+  std::vector<std::pair<std::string, std::string>> expected_key_value_pairs;
+  for (const auto& key_value : uncompressed_key_values) {
+    std::string compressed_value;
+    ASSERT_TRUE(Snappy_Compress(info, key_value.second.data(),
+                                key_value.second.size(), &compressed_value));
+    expected_key_value_pairs.emplace_back(key_value.first, compressed_value);
+  }
+
+  VerifyBlobFile(blob_file_number, blob_file_paths[0], column_family_id,
+                 kSnappyCompression, expected_key_value_pairs, blob_indexes);
+}
+
 TEST_F(BlobFileBuilderTest, CompressionError) {
   // Simulate an error during compression
   if (!Snappy_Supported()) {
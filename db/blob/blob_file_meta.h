@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <iosfwd>
 #include <memory>
@@ -58,6 +59,20 @@ class SharedBlobFileMetaData {
   const std::string& GetChecksumMethod() const { return checksum_method_; }
   const std::string& GetChecksumValue() const { return checksum_value_; }
 
+  // Reads of the file's blobs and the bytes they read from the file,
+  // estimated by sampling (see monitoring/file_read_sample.h). Blobs served
+  // from the blob cache are not counted.
+  uint64_t GetNumReadsSampled() const {
+    return num_reads_sampled_.load(std::memory_order_relaxed);
+  }
+  uint64_t GetBytesReadSampled() const {
+    return bytes_read_sampled_.load(std::memory_order_relaxed);
+  }
+  void AddReadsSampled(uint64_t num_reads, uint64_t bytes_read) const {
+    num_reads_sampled_.fetch_add(num_reads, std::memory_order_relaxed);
+    bytes_read_sampled_.fetch_add(bytes_read, std::memory_order_relaxed);
+  }
+
   std::string DebugString() const;
 
  private:
@@ -77,6 +92,8 @@ class SharedBlobFileMetaData {
   uint64_t total_blob_bytes_;
   std::string checksum_method_;
   std::string checksum_value_;
+  mutable std::atomic<uint64_t> num_reads_sampled_{0};
+  mutable std::atomic<uint64_t> bytes_read_sampled_{0};
 };
 
 std::ostream& operator<<(std::ostream& os,
@@ -138,6 +155,14 @@ class BlobFileMetaData {
     assert(shared_meta_);
     return shared_meta_->GetChecksumValue();
   }
+  uint64_t GetNumReadsSampled() const {
+    assert(shared_meta_);
+    return shared_meta_->GetNumReadsSampled();
+  }
+  uint64_t GetBytesReadSampled() const {
+    assert(shared_meta_);
+    return shared_meta_->GetBytesReadSampled();
+  }
 
   const LinkedSsts& GetLinkedSsts() const { return linked_ssts_; }
 
@@ -5,10 +5,12 @@
 
 #include "db/blob/blob_file_reader.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 
 #include "db/blob/blob_log_format.h"
+#include "file/file_prefetch_buffer.h"
 #include "file/filename.h"
 #include "options/cf_options.h"
 #include "rocksdb/file_system.h"
@@ -43,10 +45,11 @@ Status BlobFileReader::Create(
   assert(file_reader);
 
   CompressionType compression_type = kNoCompression;
+  bool has_compression_dict = false;
 
   {
-    const Status s =
-        ReadHeader(file_reader.get(), column_family_id, &compression_type);
+    const Status s = ReadHeader(file_reader.get(), column_family_id,
+                                &compression_type, &has_compression_dict);
     if (!s.ok()) {
       return s;
     }
@@ -59,8 +62,22 @@ Status BlobFileReader::Create(
     }
   }
 
-  blob_file_reader->reset(
-      new BlobFileReader(std::move(file_reader), file_size, compression_type));
+  std::unique_ptr<UncompressionDict> uncompression_dict;
+  uint64_t compression_dict_records_offset = 0;
+
+  if (has_compression_dict) {
+    const Status s = ReadCompressionDict(
+        file_size, file_reader.get(), compression_type, &uncompression_dict,
+        &compression_dict_records_offset);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  blob_file_reader->reset(new BlobFileReader(
+      std::move(file_reader), file_size, compression_type,
+      std::move(uncompression_dict), compression_dict_records_offset,
+      immutable_options.compressor));
 
   return Status::OK();
 }
@@ -98,13 +115,20 @@ Status BlobFileReader::OpenFile(
     return Status::Corruption("Malformed blob file");
   }
 
+  FileOptions blob_file_opts(file_opts);
+  blob_file_opts.use_direct_reads |=
+      immutable_options.use_direct_reads_for_blob_files;
+
+  TEST_SYNC_POINT_CALLBACK("BlobFileReader::OpenFile:UseDirectReads",
+                           &blob_file_opts.use_direct_reads);
+
   std::unique_ptr<FSRandomAccessFile> file;
 
   {
     TEST_SYNC_POINT("BlobFileReader::OpenFile:NewRandomAccessFile");
 
     const Status s =
-        fs->NewRandomAccessFile(blob_file_path, file_opts, &file, dbg);
+        fs->NewRandomAccessFile(blob_file_path, blob_file_opts, &file, dbg);
     if (!s.ok()) {
       return s;
     }
@@ -127,9 +151,11 @@ Status BlobFileReader::OpenFile(
 
 Status BlobFileReader::ReadHeader(const RandomAccessFileReader* file_reader,
                                   uint32_t column_family_id,
-                                  CompressionType* compression_type) {
+                                  CompressionType* compression_type,
+                                  bool* has_compression_dict) {
   assert(file_reader);
   assert(compression_type);
+  assert(has_compression_dict);
 
   Slice header_slice;
   Buffer buf;
@@ -171,6 +197,7 @@ Status BlobFileReader::ReadHeader(const RandomAccessFileReader* file_reader,
   }
 
   *compression_type = header.compression;
+  *has_compression_dict = header.version == kVersion2;
 
   return Status::OK();
 }
@@ -218,6 +245,82 @@ Status BlobFileReader::ReadFooter(uint64_t file_size,
   return Status::OK();
 }
 
+Status BlobFileReader::ReadCompressionDict(
+    uint64_t file_size, const RandomAccessFileReader* file_reader,
+    CompressionType compression_type,
+    std::unique_ptr<UncompressionDict>* uncompression_dict,
+    uint64_t* compression_dict_records_offset) {
+  assert(file_reader);
+  assert(uncompression_dict);
+  assert(compression_dict_records_offset);
+
+  constexpr uint64_t min_file_size = BlobLogHeader::kSize +
+                                     BlobLogCompressionDict::kTrailerSize +
+                                     BlobLogFooter::kSize;
+  if (file_size < min_file_size) {
+    return Status::Corruption("Malformed blob file");
+  }
+
+  const uint64_t trailer_offset =
+      file_size - BlobLogFooter::kSize - BlobLogCompressionDict::kTrailerSize;
+  uint32_t dict_size = 0;
+
+  {
+    Slice trailer_slice;
+    Buffer buf;
+    AlignedBuf aligned_buf;
+
+    Status s = ReadFromFile(file_reader, trailer_offset,
+                            BlobLogCompressionDict::kTrailerSize,
+                            &trailer_slice, &buf, &aligned_buf);
+    if (!s.ok()) {
+      return s;
+    }
+
+    s = BlobLogCompressionDict::DecodeDictSizeFrom(trailer_slice, &dict_size);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  if (dict_size > file_size - min_file_size) {
+    return Status::Corruption("Malformed blob file");
+  }
+
+  BlobLogCompressionDict compression_dict;
+
+  {
+    TEST_SYNC_POINT("BlobFileReader::ReadCompressionDict:ReadFromFile");
+
+    Slice dict_slice;
+    Buffer buf;
+    AlignedBuf aligned_buf;
+
+    Status s = ReadFromFile(
+        file_reader, trailer_offset - dict_size,
+        static_cast<size_t>(dict_size) + BlobLogCompressionDict::kTrailerSize,
+        &dict_slice, &buf, &aligned_buf);
+    if (!s.ok()) {
+      return s;
+    }
+
+    s = compression_dict.DecodeFrom(dict_slice);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  if (!compression_dict.dict.empty()) {
+    uncompression_dict->reset(new UncompressionDict(
+        std::move(compression_dict.dict),
+        compression_type == kZSTD ||
+            compression_type == kZSTDNotFinalCompression));
+  }
+  *compression_dict_records_offset = compression_dict.records_offset;
+
+  return Status::OK();
+}
+
 Status BlobFileReader::ReadFromFile(const RandomAccessFileReader* file_reader,
                                     uint64_t read_offset, size_t read_size,
                                     Slice* slice, Buffer* buf,
@@ -256,10 +359,16 @@ Status BlobFileReader::ReadFromFile(const RandomAccessFileReader* file_reader,
 
 BlobFileReader::BlobFileReader(
     std::unique_ptr<RandomAccessFileReader>&& file_reader, uint64_t file_size,
-    CompressionType compression_type)
+    CompressionType compression_type,
+    std::unique_ptr<UncompressionDict>&& uncompression_dict,
+    uint64_t compression_dict_records_offset,
+    const std::shared_ptr<Compressor>& compressor)
     : file_reader_(std::move(file_reader)),
       file_size_(file_size),
-      compression_type_(compression_type) {
+      compression_type_(compression_type),
+      uncompression_dict_(std::move(uncompression_dict)),
+      compression_dict_records_offset_(compression_dict_records_offset),
+      compressor_(compressor) {
   assert(file_reader_);
 }
 
@@ -269,6 +378,7 @@ Status BlobFileReader::GetBlob(const ReadOptions& read_options,
                                const Slice& user_key, uint64_t offset,
                                uint64_t value_size,
                                CompressionType compression_type,
+                               FilePrefetchBuffer* prefetch_buffer,
                                PinnableSlice* value,
                                uint64_t* bytes_read) const {
   assert(value);
@@ -300,7 +410,19 @@ Status BlobFileReader::GetBlob(const ReadOptions& read_options,
   Buffer buf;
   AlignedBuf aligned_buf;
 
-  {
+  bool prefetched = false;
+
+  if (prefetch_buffer) {
+    Status s;
+    prefetched = prefetch_buffer->TryReadFromCache(
+        IOOptions(), record_offset, static_cast<size_t>(record_size),
+        &record_slice, &s);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  if (!prefetched) {
     TEST_SYNC_POINT("BlobFileReader::GetBlob:ReadFromFile");
 
     const Status s = ReadFromFile(file_reader_.get(), record_offset,
@@ -324,8 +446,9 @@ Status BlobFileReader::GetBlob(const ReadOptions& read_options,
   const Slice value_slice(record_slice.data() + adjustment, value_size);
 
   {
-    const Status s =
-        UncompressBlobIfNeeded(value_slice, compression_type, value);
+    const Status s = UncompressBlobIfNeeded(
+        value_slice, compression_type,
+        GetUncompressionDict(offset, key_size), compressor_.get(), value);
     if (!s.ok()) {
       return s;
     }
@@ -338,6 +461,158 @@ Status BlobFileReader::GetBlob(const ReadOptions& read_options,
   return Status::OK();
 }
 
+void BlobFileReader::MultiGetBlob(const ReadOptions& read_options,
+                                  const std::vector<BlobReadRequest>& requests,
+                                  uint64_t* bytes_read) const {
+  // Blob records less than this far apart are read in one request, along
+  // with the bytes between them; that is cheaper than another request.
+  constexpr uint64_t kMaxCoalescedGap = 4096;
+
+  struct RecordRead {
+    size_t request;
+    uint64_t record_offset;
+    uint64_t record_size;
+    size_t fs_request;
+  };
+
+  std::vector<RecordRead> reads;
+  reads.reserve(requests.size());
+
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const BlobReadRequest& request = requests[i];
+    assert(request.value);
+    assert(request.status);
+
+    const uint64_t key_size = request.user_key.size();
+
+    if (!IsValidBlobOffset(request.offset, key_size, request.value_size,
+                           file_size_)) {
+      *request.status = Status::Corruption("Invalid blob offset");
+      continue;
+    }
+
+    if (request.compression_type != compression_type_) {
+      *request.status =
+          Status::Corruption("Compression type mismatch when reading blob");
+      continue;
+    }
+
+    // See GetBlob() for the adjustment
+    const uint64_t adjustment =
+        read_options.verify_checksums
+            ? BlobLogRecord::CalculateAdjustmentForRecordHeader(key_size)
+            : 0;
+    assert(request.offset >= adjustment);
+
+    reads.push_back({i, request.offset - adjustment,
+                     request.value_size + adjustment, 0});
+  }
+
+  if (bytes_read) {
+    *bytes_read = 0;
+  }
+
+  if (reads.empty()) {
+    return;
+  }
+
+  std::sort(reads.begin(), reads.end(),
+            [](const RecordRead& lhs, const RecordRead& rhs) {
+              return lhs.record_offset < rhs.record_offset;
+            });
+
+  std::vector<FSReadRequest> fs_requests;
+  size_t total_len = 0;
+
+  for (RecordRead& read : reads) {
+    const uint64_t record_end = read.record_offset + read.record_size;
+
+    if (!fs_requests.empty() &&
+        read.record_offset <= fs_requests.back().offset +
+                                  fs_requests.back().len + kMaxCoalescedGap) {
+      FSReadRequest& last = fs_requests.back();
+      const uint64_t last_end = last.offset + last.len;
+      if (record_end > last_end) {
+        total_len += static_cast<size_t>(record_end - last_end);
+        last.len = static_cast<size_t>(record_end - last.offset);
+      }
+    } else {
+      FSReadRequest fs_request;
+      fs_request.offset = read.record_offset;
+      fs_request.len = static_cast<size_t>(read.record_size);
+      total_len += fs_request.len;
+      fs_requests.emplace_back(std::move(fs_request));
+    }
+
+    read.fs_request = fs_requests.size() - 1;
+  }
+
+  Buffer buf;
+  AlignedBuf aligned_buf;
+
+  if (!file_reader_->use_direct_io()) {
+    buf.reset(new char[total_len]);
+    char* scratch = buf.get();
+    for (FSReadRequest& fs_request : fs_requests) {
+      fs_request.scratch = scratch;
+      scratch += fs_request.len;
+    }
+  }
+
+  TEST_SYNC_POINT("BlobFileReader::MultiGetBlob:ReadFromFile");
+
+  const IOStatus io_s = file_reader_->MultiRead(
+      IOOptions(), fs_requests.data(), fs_requests.size(), &aligned_buf);
+
+  for (const FSReadRequest& fs_request : fs_requests) {
+    fs_request.status.PermitUncheckedError();
+  }
+
+  uint64_t total_bytes = 0;
+
+  for (const RecordRead& read : reads) {
+    const BlobReadRequest& request = requests[read.request];
+    const FSReadRequest& fs_request = fs_requests[read.fs_request];
+
+    Status s = io_s.ok() ? Status(fs_request.status) : Status(io_s);
+
+    const uint64_t offset_in_request = read.record_offset - fs_request.offset;
+    if (s.ok() &&
+        fs_request.result.size() < offset_in_request + read.record_size) {
+      s = Status::Corruption("Failed to read data from blob file");
+    }
+
+    if (s.ok()) {
+      const Slice record_slice(fs_request.result.data() + offset_in_request,
+                               static_cast<size_t>(read.record_size));
+
+      if (read_options.verify_checksums) {
+        s = VerifyBlob(record_slice, request.user_key, request.value_size);
+      }
+
+      if (s.ok()) {
+        const uint64_t adjustment = read.record_size - request.value_size;
+        const Slice value_slice(record_slice.data() + adjustment,
+                                static_cast<size_t>(request.value_size));
+        s = UncompressBlobIfNeeded(
+            value_slice, request.compression_type,
+            GetUncompressionDict(request.offset, request.user_key.size()),
+            compressor_.get(), request.value);
+      }
+
+      if (s.ok()) {
+        total_bytes += read.record_size;
+      }
+    }
+
+    *request.status = s;
+  }
+
+  if (bytes_read) {
+    *bytes_read = total_bytes;
+  }
+}
+
 Status BlobFileReader::VerifyBlob(const Slice& record_slice,
                                   const Slice& user_key, uint64_t value_size) {
   BlobLogRecord record;
@@ -382,6 +657,8 @@ Status BlobFileReader::VerifyBlob(const Slice& record_slice,
 
 Status BlobFileReader::UncompressBlobIfNeeded(const Slice& value_slice,
                                               CompressionType compression_type,
+                                              const UncompressionDict& dict,
+                                              Compressor* compressor,
                                               PinnableSlice* value) {
   assert(value);
 
@@ -392,8 +669,7 @@ Status BlobFileReader::UncompressBlobIfNeeded(const Slice& value_slice,
   }
 
   UncompressionContext context(compression_type);
-  UncompressionInfo info(context, UncompressionDict::GetEmptyDict(),
-                         compression_type);
+  UncompressionInfo info(context, dict, compression_type, compressor);
 
   size_t uncompressed_size = 0;
   constexpr uint32_t compression_format_version = 2;
@@ -415,6 +691,19 @@ Status BlobFileReader::UncompressBlobIfNeeded(const Slice& value_slice,
   return Status::OK();
 }
 
+const UncompressionDict& BlobFileReader::GetUncompressionDict(
+    uint64_t offset, uint64_t key_size) const {
+  assert(offset >= BlobLogRecord::CalculateAdjustmentForRecordHeader(key_size));
+
+  if (!uncompression_dict_ ||
+      offset - BlobLogRecord::CalculateAdjustmentForRecordHeader(key_size) <
+          compression_dict_records_offset_) {
+    return UncompressionDict::GetEmptyDict();
+  }
+
+  return *uncompression_dict_;
+}
+
 void BlobFileReader::SaveValue(const Slice& src, PinnableSlice* dst) {
   assert(dst);
 
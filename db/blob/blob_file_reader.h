@@ -7,23 +7,36 @@
 
 #include <cinttypes>
 #include <memory>
+#include <vector>
 
 #include "file/random_access_file_reader.h"
 #include "rocksdb/compression_type.h"
 #include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 class Status;
 struct ImmutableOptions;
 struct FileOptions;
+class FilePrefetchBuffer;
 class HistogramImpl;
 struct ReadOptions;
-class Slice;
-class PinnableSlice;
+struct UncompressionDict;
 
 class BlobFileReader {
  public:
+  // A blob for MultiGetBlob() to read, with the arguments GetBlob() takes,
+  // and where to store its status.
+  struct BlobReadRequest {
+    Slice user_key;
+    uint64_t offset = 0;
+    uint64_t value_size = 0;
+    CompressionType compression_type = kNoCompression;
+    PinnableSlice* value = nullptr;
+    Status* status = nullptr;
+  };
+
   static Status Create(const ImmutableOptions& immutable_options,
                        const FileOptions& file_options,
                        uint32_t column_family_id,
@@ -37,14 +50,32 @@ class BlobFileReader {
 
   ~BlobFileReader();
 
+  // Reads the blob record through prefetch_buffer, if not nullptr, and
+  // directly from the file if the buffer cannot serve it.
   Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
                  uint64_t offset, uint64_t value_size,
-                 CompressionType compression_type, PinnableSlice* value,
+                 CompressionType compression_type,
+                 FilePrefetchBuffer* prefetch_buffer, PinnableSlice* value,
                  uint64_t* bytes_read) const;
 
+  // Reads several blobs of the file with a single
+  // RandomAccessFileReader::MultiRead(), in offset order, reading blobs that
+  // are close together in one request. Each request gets its own status.
+  // bytes_read, if not nullptr, is set to the total size of the blob records
+  // read.
+  void MultiGetBlob(const ReadOptions& read_options,
+                    const std::vector<BlobReadRequest>& requests,
+                    uint64_t* bytes_read) const;
+
+  // The reader of the file, for buffers passed to GetBlob() to read through
+  RandomAccessFileReader* GetFileReader() const { return file_reader_.get(); }
+
  private:
   BlobFileReader(std::unique_ptr<RandomAccessFileReader>&& file_reader,
-                 uint64_t file_size, CompressionType compression_type);
+                 uint64_t file_size, CompressionType compression_type,
+                 std::unique_ptr<UncompressionDict>&& uncompression_dict,
+                 uint64_t compression_dict_records_offset,
+                 const std::shared_ptr<Compressor>& compressor);
 
   static Status OpenFile(const ImmutableOptions& immutable_options,
                          const FileOptions& file_opts,
@@ -56,11 +87,20 @@ class BlobFileReader {
 
   static Status ReadHeader(const RandomAccessFileReader* file_reader,
                            uint32_t column_family_id,
-                           CompressionType* compression_type);
+                           CompressionType* compression_type,
+                           bool* has_compression_dict);
 
   static Status ReadFooter(uint64_t file_size,
                            const RandomAccessFileReader* file_reader);
 
+  // Reads the compression dictionary section of version 2 files. Sets
+  // uncompression_dict to nullptr if the file has no dictionary.
+  static Status ReadCompressionDict(
+      uint64_t file_size, const RandomAccessFileReader* file_reader,
+      CompressionType compression_type,
+      std::unique_ptr<UncompressionDict>* uncompression_dict,
+      uint64_t* compression_dict_records_offset);
+
   using Buffer = std::unique_ptr<char[]>;
 
   static Status ReadFromFile(const RandomAccessFileReader* file_reader,
@@ -71,15 +111,25 @@ class BlobFileReader {
   static Status VerifyBlob(const Slice& record_slice, const Slice& user_key,
                            uint64_t value_size);
 
+  // `compressor` is used for kCustomCompression
   static Status UncompressBlobIfNeeded(const Slice& value_slice,
                                        CompressionType compression_type,
+                                       const UncompressionDict& dict,
+                                       Compressor* compressor,
                                        PinnableSlice* value);
 
+  // The dictionary the value of the blob at offset was compressed with
+  const UncompressionDict& GetUncompressionDict(uint64_t offset,
+                                                uint64_t key_size) const;
+
   static void SaveValue(const Slice& src, PinnableSlice* dst);
 
   std::unique_ptr<RandomAccessFileReader> file_reader_;
   uint64_t file_size_;
   CompressionType compression_type_;
+  std::unique_ptr<UncompressionDict> uncompression_dict_;
+  uint64_t compression_dict_records_offset_;
+  std::shared_ptr<Compressor> compressor_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
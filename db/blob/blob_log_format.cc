@@ -43,7 +43,7 @@ Status BlobLogHeader::DecodeFrom(Slice src) {
   if (magic_number != kMagicNumber) {
     return Status::Corruption(kErrorMessage, "Magic number mismatch");
   }
-  if (version != kVersion1) {
+  if (version != kVersion1 && version != kVersion2) {
     return Status::Corruption(kErrorMessage, "Unknown header version");
   }
   flags = src.data()[0];
@@ -95,6 +95,56 @@ Status BlobLogFooter::DecodeFrom(Slice src) {
   return Status::OK();
 }
 
+void BlobLogCompressionDict::EncodeTo(std::string* dst) const {
+  assert(dst != nullptr);
+  dst->clear();
+  dst->reserve(dict.size() + kTrailerSize);
+  dst->append(dict);
+  PutFixed64(dst, records_offset);
+  PutFixed32(dst, static_cast<uint32_t>(dict.size()));
+  uint32_t crc = crc32c::Value(dst->c_str(), dst->size());
+  crc = crc32c::Mask(crc);
+  PutFixed32(dst, crc);
+}
+
+Status BlobLogCompressionDict::DecodeDictSizeFrom(Slice trailer,
+                                                  uint32_t* dict_size) {
+  assert(dict_size != nullptr);
+  if (trailer.size() != kTrailerSize) {
+    return Status::Corruption("Error while decoding blob compression dict",
+                              "Unexpected trailer size");
+  }
+  *dict_size = DecodeFixed32(trailer.data() + sizeof(uint64_t));
+  return Status::OK();
+}
+
+Status BlobLogCompressionDict::DecodeFrom(Slice src) {
+  static const std::string kErrorMessage =
+      "Error while decoding blob compression dict";
+  if (src.size() < kTrailerSize) {
+    return Status::Corruption(kErrorMessage,
+                              "Unexpected compression dict size");
+  }
+  const size_t dict_size = src.size() - kTrailerSize;
+  uint32_t src_crc = crc32c::Value(src.data(), src.size() - sizeof(uint32_t));
+  src_crc = crc32c::Mask(src_crc);
+  dict.assign(src.data(), dict_size);
+  src.remove_prefix(dict_size);
+  uint32_t encoded_dict_size = 0;
+  uint32_t crc = 0;
+  if (!GetFixed64(&src, &records_offset) ||
+      !GetFixed32(&src, &encoded_dict_size) || !GetFixed32(&src, &crc)) {
+    return Status::Corruption(kErrorMessage, "Error decoding content");
+  }
+  if (encoded_dict_size != dict_size) {
+    return Status::Corruption(kErrorMessage, "Dictionary size mismatch");
+  }
+  if (src_crc != crc) {
+    return Status::Corruption(kErrorMessage, "CRC mismatch");
+  }
+  return Status::OK();
+}
+
 void BlobLogRecord::EncodeHeaderTo(std::string* dst) {
   assert(dst != nullptr);
   dst->clear();
@@ -19,6 +19,9 @@ namespace ROCKSDB_NAMESPACE {
 
 constexpr uint32_t kMagicNumber = 2395959;  // 0x00248f37
 constexpr uint32_t kVersion1 = 1;
+// Version 2 files have a compression dictionary section (see
+// BlobLogCompressionDict) between the last record and the footer.
+constexpr uint32_t kVersion2 = 2;
 
 using ExpirationRange = std::pair<uint64_t, uint64_t>;
 
@@ -81,6 +84,36 @@ struct BlobLogFooter {
   Status DecodeFrom(Slice slice);
 };
 
+// Format of the compression dictionary section of version 2 blob files,
+// written right before the footer (dictionary + 16 bytes):
+//
+//    +------------+----------------+-----------------+----------+
+//    | dictionary | records offset | dictionary size |   CRC    |
+//    +------------+----------------+-----------------+----------+
+//    |  dict size |    Fixed64     |     Fixed32     |  Fixed32 |
+//    +------------+----------------+-----------------+----------+
+//
+// Values of the records starting at or after the records offset are
+// compressed with the dictionary, those of earlier records without one. The
+// dictionary is empty if none was used in the file. CRC is the checksum of
+// everything before it in the section.
+struct BlobLogCompressionDict {
+  // Size of the fields after the dictionary
+  static constexpr size_t kTrailerSize = 16;
+
+  uint64_t records_offset = 0;
+  std::string dict;
+
+  void EncodeTo(std::string* dst) const;
+
+  // Decodes the dictionary size from the last kTrailerSize bytes of the
+  // section, to find where the section starts.
+  static Status DecodeDictSizeFrom(Slice trailer, uint32_t* dict_size);
+
+  // Decodes the whole section
+  Status DecodeFrom(Slice src);
+};
+
 // Blob record format (32 bytes header + key + value):
 //
 //    +------------+--------------+------------+------------+----------+---------+-----------+
@@ -110,6 +110,23 @@ Status BlobLogWriter::AppendFooter(BlobLogFooter& footer,
   return s;
 }
 
+Status BlobLogWriter::AppendCompressionDict(
+    const BlobLogCompressionDict& compression_dict) {
+  assert(block_offset_ != 0);
+  assert(last_elem_type_ == kEtFileHdr || last_elem_type_ == kEtRecord);
+
+  std::string str;
+  compression_dict.EncodeTo(&str);
+
+  Status s = dest_->Append(Slice(str));
+  if (s.ok()) {
+    block_offset_ += str.size();
+  }
+
+  RecordTick(statistics_, BLOB_DB_BLOB_FILE_BYTES_WRITTEN, str.size());
+  return s;
+}
+
 Status BlobLogWriter::AddRecord(const Slice& key, const Slice& val,
                                 uint64_t expiration, uint64_t* key_offset,
                                 uint64_t* blob_offset) {
@@ -53,6 +53,10 @@ class BlobLogWriter {
                             const Slice& val, uint64_t* key_offset,
                             uint64_t* blob_offset);
 
+  // Appends the compression dictionary section of version 2 files, after the
+  // last record.
+  Status AppendCompressionDict(const BlobLogCompressionDict& compression_dict);
+
   Status AppendFooter(BlobLogFooter& footer, std::string* checksum_method,
                       std::string* checksum_value);
 
@@ -0,0 +1,94 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/blob/blob_prefetcher.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "db/blob/blob_file_reader.h"
+#include "options/cf_options.h"
+#include "rocksdb/options.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+BlobPrefetcher::BlobPrefetcher(const ImmutableOptions& ioptions,
+                               const ReadOptions& read_options)
+    : fs_(ioptions.fs.get()),
+      // mmap reads do not go through the buffer
+      enable_(!ioptions.allow_mmap_reads),
+      readahead_size_(read_options.readahead_size > 0
+                          ? read_options.readahead_size
+                          : kInitReadaheadSize),
+      max_readahead_size_(read_options.readahead_size > 0
+                              ? read_options.readahead_size
+                              : kMaxReadaheadSize),
+      explicit_readahead_(read_options.readahead_size > 0),
+      async_io_(read_options.async_io) {}
+
+FilePrefetchBuffer* BlobPrefetcher::GetPrefetchBuffer(
+    uint64_t blob_file_number, uint64_t offset,
+    const CacheHandleGuard<BlobFileReader>& blob_file_reader) {
+  assert(blob_file_reader.GetValue());
+
+  if (!enable_) {
+    return nullptr;
+  }
+
+  ++num_reads_;
+
+  auto it = files_.find(blob_file_number);
+  if (it == files_.end()) {
+    if (files_.size() >= kMaxNumFiles) {
+      files_.erase(std::min_element(
+          files_.begin(), files_.end(),
+          [](const std::pair<const uint64_t, FileState>& lhs,
+             const std::pair<const uint64_t, FileState>& rhs) {
+            return lhs.second.last_use < rhs.second.last_use;
+          }));
+    }
+
+    FileState& state = files_[blob_file_number];
+
+    // Our own reference, since the buffer outlives the caller's
+    Cache* const cache = blob_file_reader.GetCache();
+    Cache::Handle* const handle = blob_file_reader.GetCacheHandle();
+    cache->Ref(handle);
+    state.blob_file_reader = CacheHandleGuard<BlobFileReader>(cache, handle);
+
+    state.prefetch_buffer.reset(new FilePrefetchBuffer(
+        blob_file_reader.GetValue()->GetFileReader(), readahead_size_,
+        max_readahead_size_, true /* enable */, false /* track_min_offset */,
+        false /* implicit_auto_readahead */, fs_, async_io_));
+    state.prev_offset = offset;
+    state.last_use = num_reads_;
+
+    return explicit_readahead_ ? state.prefetch_buffer.get() : nullptr;
+  }
+
+  FileState& state = it->second;
+  state.last_use = num_reads_;
+
+  const bool sequential = offset > state.prev_offset &&
+                          offset - state.prev_offset <= max_readahead_size_;
+  state.prev_offset = offset;
+
+  if (!sequential) {
+    state.num_sequential_reads = 0;
+    state.prefetch_buffer->ResetValues();
+    return nullptr;
+  }
+
+  // An explicit readahead size applies right away
+  if (!explicit_readahead_ &&
+      ++state.num_sequential_reads <
+          FilePrefetchBuffer::kMinNumFileReadsToStartAutoReadahead) {
+    return nullptr;
+  }
+
+  return state.prefetch_buffer.get();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
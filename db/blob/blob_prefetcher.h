@@ -0,0 +1,73 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "cache/cache_helpers.h"
+#include "file/file_prefetch_buffer.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class BlobFileReader;
+struct ImmutableOptions;
+struct ReadOptions;
+
+// Reads ahead in the blob files an iterator reads values from. Blobs are
+// written in key order, so the values of consecutive keys are usually at
+// ascending offsets of the same blob file. Once two reads of a file in a row
+// go forward by no more than the maximum readahead size, the following blobs
+// of the file are read through a FilePrefetchBuffer that reads ahead of them,
+// starting at kInitReadaheadSize and doubling with every read up to
+// kMaxReadaheadSize. An explicit ReadOptions::readahead_size is used as is,
+// from the first read. With ReadOptions::async_io, the window after the
+// current one is read in the background.
+//
+// Not thread-safe; meant to be owned by a single iterator.
+class BlobPrefetcher {
+ public:
+  static constexpr size_t kInitReadaheadSize = 8 * 1024;
+  static constexpr size_t kMaxReadaheadSize = 256 * 1024;
+  // The most files buffers are kept for at a time
+  static constexpr size_t kMaxNumFiles = 8;
+
+  BlobPrefetcher(const ImmutableOptions& ioptions,
+                 const ReadOptions& read_options);
+
+  BlobPrefetcher(const BlobPrefetcher&) = delete;
+  BlobPrefetcher& operator=(const BlobPrefetcher&) = delete;
+
+  // Called before the blob at `offset` of blob file `blob_file_number` is
+  // read through `blob_file_reader`. Returns the buffer to read it through,
+  // or nullptr if the reads of the file do not look sequential. The buffer
+  // keeps the reader pinned in the blob file cache.
+  FilePrefetchBuffer* GetPrefetchBuffer(
+      uint64_t blob_file_number, uint64_t offset,
+      const CacheHandleGuard<BlobFileReader>& blob_file_reader);
+
+ private:
+  struct FileState {
+    CacheHandleGuard<BlobFileReader> blob_file_reader;
+    std::unique_ptr<FilePrefetchBuffer> prefetch_buffer;
+    uint64_t prev_offset = 0;
+    int num_sequential_reads = 0;
+    uint64_t last_use = 0;
+  };
+
+  FileSystem* const fs_;
+  const bool enable_;
+  const size_t readahead_size_;
+  const size_t max_readahead_size_;
+  const bool explicit_readahead_;
+  const bool async_io_;
+
+  std::unordered_map<uint64_t, FileState> files_;
+  uint64_t num_reads_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
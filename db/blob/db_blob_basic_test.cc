@@ -46,6 +46,58 @@ TEST_F(DBBlobBasicTest, GetBlob) {
                   .IsIncomplete());
 }
 
+TEST_F(DBBlobBasicTest, GetBlobFromCache) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.blob_compression_type = kSnappyCompression;
+  options.blob_cache = NewLRUCache(1 << 20);
+  options.statistics = CreateDBStatistics();
+
+  if (!Snappy_Supported()) {
+    options.blob_compression_type = kNoCompression;
+  }
+
+  Reopen(options);
+
+  constexpr char key[] = "key";
+  constexpr char blob_value[] = "blob_value";
+
+  ASSERT_OK(Put(key, blob_value));
+
+  ASSERT_OK(Flush());
+
+  // Without fill_cache, the blob is read from the file but not cached
+  ReadOptions read_options;
+  read_options.fill_cache = false;
+
+  PinnableSlice result;
+  ASSERT_OK(db_->Get(read_options, db_->DefaultColumnFamily(), key, &result));
+  ASSERT_EQ(result, blob_value);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_MISS), 1);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_ADD), 0);
+
+  result.Reset();
+  ASSERT_EQ(Get(key), blob_value);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_MISS), 2);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_ADD), 1);
+
+  // Now the blob can be read with no I/O allowed, from the cache
+  read_options.read_tier = kBlockCacheTier;
+
+  ASSERT_OK(db_->Get(read_options, db_->DefaultColumnFamily(), key, &result));
+  ASSERT_EQ(result, blob_value);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_HIT), 1);
+
+  // Iterators use the cache as well
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(iter->value(), blob_value);
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_HIT), 2);
+}
+
 TEST_F(DBBlobBasicTest, MultiGetBlobs) {
   constexpr size_t min_blob_size = 6;
 
@@ -125,6 +177,189 @@ TEST_F(DBBlobBasicTest, MultiGetBlobs) {
   }
 }
 
+TEST_F(DBBlobBasicTest, MultiGetBlobsBatched) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+
+  Reopen(options);
+
+  // Two blob files, with the keys of each interleaved with the other's
+  constexpr size_t num_keys = 8;
+  std::array<std::string, num_keys> key_strs;
+  std::array<std::string, num_keys> value_strs;
+  for (size_t i = 0; i < num_keys; ++i) {
+    key_strs[i] = "key" + std::to_string(i);
+    value_strs[i] = "blob_value" + std::to_string(i);
+  }
+  for (size_t file = 0; file < 2; ++file) {
+    for (size_t i = file; i < num_keys; i += 2) {
+      ASSERT_OK(Put(key_strs[i], value_strs[i]));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  int num_single_reads = 0;
+  int num_batched_reads = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::GetBlob:ReadFromFile",
+      [&](void* /* arg */) { ++num_single_reads; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::MultiGetBlob:ReadFromFile",
+      [&](void* /* arg */) { ++num_batched_reads; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::array<Slice, num_keys> keys;
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys[i] = key_strs[i];
+  }
+  std::array<PinnableSlice, num_keys> values;
+  std::array<Status, num_keys> statuses;
+
+  db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), num_keys, &keys[0],
+                &values[0], &statuses[0]);
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ(values[i], value_strs[i]);
+  }
+
+  // One batch per blob file
+  ASSERT_EQ(num_single_reads, 0);
+  ASSERT_EQ(num_batched_reads, 2);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBBlobBasicTest, IterateBlobsWithReadahead) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+
+  Reopen(options);
+
+  constexpr int num_keys = 100;
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+
+  int num_single_reads = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::GetBlob:ReadFromFile",
+      [&](void* /* arg */) { ++num_single_reads; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto scan = [&](const ReadOptions& read_options, bool forward) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    int i = forward ? 0 : num_keys - 1;
+    for (forward ? iter->SeekToFirst() : iter->SeekToLast(); iter->Valid();
+         forward ? iter->Next() : iter->Prev()) {
+      ASSERT_EQ(iter->key(), Key(i));
+      ASSERT_EQ(iter->value(), std::string(100, 'a' + i % 26));
+      i += forward ? 1 : -1;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(i, forward ? num_keys : -1);
+  };
+
+  // Once two blobs in a row follow each other, the rest are read ahead
+  scan(ReadOptions(), true /* forward */);
+  ASSERT_EQ(num_single_reads, 2);
+
+  // Blobs read backwards are read one by one
+  num_single_reads = 0;
+  scan(ReadOptions(), false /* forward */);
+  ASSERT_EQ(num_single_reads, num_keys);
+
+  // An explicit readahead size applies from the first blob on
+  num_single_reads = 0;
+  ReadOptions read_options;
+  read_options.readahead_size = 1 << 20;
+  scan(read_options, true /* forward */);
+  ASSERT_EQ(num_single_reads, 0);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBBlobBasicTest, GetBlobsWithCompressionDict) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.blob_file_size = 64 << 10;
+  options.blob_compression_max_dict_bytes = 1 << 10;
+  options.disable_auto_compactions = true;
+
+  if (DictCompressionTypeSupported(kZSTD)) {
+    options.blob_compression_type = kZSTD;
+  } else if (DictCompressionTypeSupported(kLZ4Compression)) {
+    options.blob_compression_type = kLZ4Compression;
+  } else if (DictCompressionTypeSupported(kZlibCompression)) {
+    options.blob_compression_type = kZlibCompression;
+  } else {
+    ROCKSDB_GTEST_SKIP("No compression type supporting dictionaries");
+    return;
+  }
+
+  Reopen(options);
+
+  // Enough values for the dictionary to be created in the middle of a blob
+  // file, with more blob files after that
+  constexpr int num_keys = 2000;
+  auto value = [](int i) {
+    return "{\"id\": " + std::to_string(i) +
+           ", \"name\": \"user" + std::to_string(i * 7919 % num_keys) +
+           "\", \"email\": \"user" + std::to_string(i) +
+           "@example.com\", \"active\": true, \"tags\": [\"alpha\", "
+           "\"beta\"]}";
+  };
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_OK(Put(Key(i), value(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_GT(GetBlobFileNumbers().size(), 1);
+
+  int num_dict_reads = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::ReadCompressionDict:ReadFromFile",
+      [&](void* /* arg */) { ++num_dict_reads; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto verify = [&]() {
+    for (int i = 0; i < num_keys; ++i) {
+      ASSERT_EQ(Get(Key(i)), value(i));
+    }
+
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+      ASSERT_EQ(iter->key(), Key(i));
+      ASSERT_EQ(iter->value(), value(i));
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(i, num_keys);
+  };
+
+  verify();
+  ASSERT_GT(num_dict_reads, 0);
+
+  // Relocating the blobs reads them with the old dictionaries and writes
+  // them with a new one
+  ASSERT_OK(db_->SetOptions({{"enable_blob_garbage_collection", "true"},
+                             {"blob_garbage_collection_age_cutoff", "1.0"}}));
+  const std::vector<uint64_t> original_blob_files = GetBlobFileNumbers();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_NE(GetBlobFileNumbers(), original_blob_files);
+
+  Reopen(options);
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBlobBasicTest, GetBlob_CorruptIndex) {
   Options options = GetDefaultOptions();
   options.enable_blob_files = true;
@@ -180,6 +415,71 @@ TEST_F(DBBlobBasicTest, GetBlob_InlinedTTLIndex) {
                   .IsCorruption());
 }
 
+TEST_F(DBBlobBasicTest, DirectIO) {
+  if (!IsDirectIOSupported()) {
+    ROCKSDB_GTEST_SKIP("Direct IO not supported");
+    return;
+  }
+
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.use_direct_io_for_flush_and_compaction = true;
+  options.use_direct_reads_for_blob_files = true;
+
+  int num_direct_writes = 0;
+  int num_direct_reads = 0;
+
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileBuilder::OpenBlobFileIfNeeded:UseDirectWrites",
+      [&num_direct_writes](void* arg) {
+        if (*static_cast<bool*>(arg)) {
+          ++num_direct_writes;
+        }
+      });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::OpenFile:UseDirectReads",
+      [&num_direct_reads](void* arg) {
+        if (*static_cast<bool*>(arg)) {
+          ++num_direct_reads;
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Reopen(options);
+
+  constexpr char first_key[] = "first_key";
+  constexpr char second_key[] = "second_key";
+  const std::string second_value(3000, 'b');
+  const std::string first_value(5000, 'c');
+
+  ASSERT_OK(Put(first_key, std::string(4000, 'a')));
+  ASSERT_OK(Put(second_key, second_value));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(first_key, first_value));
+  ASSERT_OK(Flush());
+
+  ASSERT_EQ(Get(first_key), first_value);
+  ASSERT_EQ(Get(second_key), second_value);
+
+  options.enable_blob_garbage_collection = true;
+  options.blob_garbage_collection_age_cutoff = 1.0;
+  Reopen(options);
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  ASSERT_EQ(Get(first_key), first_value);
+  ASSERT_EQ(Get(second_key), second_value);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Two blob files were flushed, and the compaction relocated the live
+  // blobs of both to a third one
+  ASSERT_EQ(num_direct_writes, 3);
+  ASSERT_GE(num_direct_reads, 3);
+}
+
 TEST_F(DBBlobBasicTest, GetBlob_IndexWithInvalidFileNumber) {
   Options options = GetDefaultOptions();
   options.enable_blob_files = true;
@@ -265,6 +565,51 @@ TEST_F(DBBlobBasicTest, GenerateIOTracing) {
     ASSERT_GT(blob_files_op_count, 2);
   }
 }
+
+TEST_F(DBBlobBasicTest, SampledFileReads) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Reopen(options);
+
+  constexpr char key[] = "key";
+  constexpr char blob_value[] = "blob_value";
+
+  ASSERT_OK(Put(key, blob_value));
+  ASSERT_OK(Flush());
+
+  // One in kFileReadSampleRate reads is sampled; with this many, missing all
+  // of them is practically impossible
+  constexpr int num_reads = 20000;
+  for (int i = 0; i < num_reads; ++i) {
+    ASSERT_EQ(Get(key), blob_value);
+  }
+
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+
+  ASSERT_EQ(cf_meta.levels[0].files.size(), 1);
+  const SstFileMetaData& sst_meta = cf_meta.levels[0].files[0];
+  ASSERT_GT(sst_meta.num_reads_sampled, 0);
+  ASSERT_GT(sst_meta.bytes_read_sampled, 0);
+
+  ASSERT_EQ(cf_meta.blob_files.size(), 1);
+  const BlobMetaData& blob_meta = cf_meta.blob_files[0];
+  ASSERT_GT(blob_meta.num_reads_sampled, 0);
+  ASSERT_GT(blob_meta.bytes_read_sampled, 0);
+
+  std::vector<LiveFileMetaData> live_files;
+  db_->GetLiveFilesMetaData(&live_files);
+
+  ASSERT_EQ(live_files.size(), 1);
+  ASSERT_EQ(live_files[0].num_reads_sampled, sst_meta.num_reads_sampled);
+  ASSERT_EQ(live_files[0].bytes_read_sampled, sst_meta.bytes_read_sampled);
+}
 #endif  // !ROCKSDB_LITE
 
 TEST_F(DBBlobBasicTest, BestEffortsRecovery_MissingNewestBlobFile) {
@@ -439,7 +784,13 @@ TEST_P(DBBlobBasicIOErrorTest, MultiGetBlobs_IOError) {
   std::array<PinnableSlice, num_keys> values;
   std::array<Status, num_keys> statuses;
 
-  SyncPoint::GetInstance()->SetCallBack(sync_point_, [this](void* /* arg */) {
+  // MultiGet reads the blobs of a blob file in one batch
+  const std::string sync_point =
+      sync_point_ == "BlobFileReader::GetBlob:ReadFromFile"
+          ? "BlobFileReader::MultiGetBlob:ReadFromFile"
+          : sync_point_;
+
+  SyncPoint::GetInstance()->SetCallBack(sync_point, [this](void* /* arg */) {
     fault_injection_env_->SetFilesystemActive(false,
                                               Status::IOError(sync_point_));
   });
@@ -565,6 +565,117 @@ TEST_F(DBBlobCompactionTest, TrackGarbage) {
   }
 }
 
+TEST_F(DBBlobCompactionTest, ForcedBlobGC) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+
+  Reopen(options);
+
+  // The first blob file ends up with three garbage blobs out of four, and
+  // only referenced by a bottommost SST file
+  ASSERT_OK(Put("key1", "value1"));
+  ASSERT_OK(Put("key2", "value2"));
+  ASSERT_OK(Put("key3", "value3"));
+  ASSERT_OK(Put("key4", "value4"));
+  ASSERT_OK(Flush());
+
+  ASSERT_OK(Put("key1", "new_value1"));
+  ASSERT_OK(Put("key2", "new_value2"));
+  ASSERT_OK(Put("key3", "new_value3"));
+  ASSERT_OK(Flush());
+
+  constexpr Slice* begin = nullptr;
+  constexpr Slice* end = nullptr;
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), begin, end));
+
+  const std::vector<uint64_t> blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(blob_files.size(), 2);
+
+  std::vector<CompactionReason> reasons;
+  SyncPoint::GetInstance()->SetCallBack(
+      "LevelCompactionPicker::PickCompaction:Return", [&](void* arg) {
+        Compaction* const compaction = static_cast<Compaction*>(arg);
+        if (compaction != nullptr) {
+          reasons.push_back(compaction->compaction_reason());
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Below the threshold, nothing happens
+  ASSERT_OK(db_->SetOptions({{"enable_blob_garbage_collection", "true"},
+                             {"blob_garbage_collection_age_cutoff", "0.5"},
+                             {"blob_garbage_collection_force_threshold",
+                              "0.8"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_TRUE(reasons.empty());
+  ASSERT_EQ(GetBlobFileNumbers(), blob_files);
+
+  // The SST file is compacted in place and the live blob relocated, which
+  // leaves nothing in the first blob file
+  ASSERT_OK(db_->SetOptions(
+      {{"blob_garbage_collection_force_threshold", "0.5"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(reasons, std::vector<CompactionReason>{
+                         CompactionReason::kForcedBlobGC});
+
+  const std::vector<uint64_t> new_blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(new_blob_files.size(), 2);
+  ASSERT_EQ(new_blob_files[0], blob_files[1]);
+
+  ASSERT_EQ(Get("key1"), "new_value1");
+  ASSERT_EQ(Get("key2"), "new_value2");
+  ASSERT_EQ(Get("key3"), "new_value3");
+  ASSERT_EQ(Get("key4"), "value4");
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBBlobCompactionTest, ColdBlobFiles) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.blob_file_size = 1;  // One blob per file
+  options.disable_auto_compactions = true;
+
+  Reopen(options);
+
+  ASSERT_OK(Put("key1", "value1"));
+  ASSERT_OK(Put("key2", "value2"));
+  ASSERT_OK(Put("key3", "value3"));
+  ASSERT_OK(Put("key4", "value4"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(GetBlobFileNumbers().size(), 4);
+
+  // Values the compaction stores in blob files for the first time
+  ASSERT_OK(db_->SetOptions({{"min_blob_size", "100"}}));
+  ASSERT_OK(Put("key5", "value5"));
+  ASSERT_OK(Put("key6", "value6"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(GetBlobFileNumbers().size(), 4);
+
+  ASSERT_OK(db_->SetOptions({{"min_blob_size", "0"},
+                             {"enable_blob_garbage_collection", "true"},
+                             {"blob_garbage_collection_age_cutoff", "1.0"},
+                             {"cold_blob_file_size", "1048576"}}));
+
+  constexpr Slice* begin = nullptr;
+  constexpr Slice* end = nullptr;
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), begin, end));
+
+  // The relocated blobs share a cold blob file, while the new ones still get
+  // a file each
+  ASSERT_EQ(GetBlobFileNumbers().size(), 3);
+
+  ASSERT_EQ(Get("key1"), "value1");
+  ASSERT_EQ(Get("key2"), "value2");
+  ASSERT_EQ(Get("key3"), "value3");
+  ASSERT_EQ(Get("key4"), "value4");
+  ASSERT_EQ(Get("key5"), "value5");
+  ASSERT_EQ(Get("key6"), "value6");
+}
+
 TEST_F(DBBlobCompactionTest, MergeBlobWithBase) {
   Options options = GetDefaultOptions();
   options.enable_blob_files = true;
@@ -0,0 +1,114 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/block_cache_hot_set.h"
+
+#include <algorithm>
+
+#include "rocksdb/table_properties.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const uint32_t kFormatVersion = 1;
+}  // namespace
+
+std::string BlockCacheHotSet::GetFileId(const TableProperties& props,
+                                        uint64_t file_number) {
+  std::string id;
+  PutLengthPrefixedSlice(&id, props.db_session_id);
+  PutVarint64(&id, file_number);
+  return id;
+}
+
+const std::vector<uint64_t>* BlockCacheHotSet::GetBlockOffsets(
+    const std::string& file_id) {
+  Normalize();
+  auto it = files_.find(file_id);
+  return it == files_.end() ? nullptr : &it->second;
+}
+
+void BlockCacheHotSet::Normalize() {
+  if (normalized_) {
+    return;
+  }
+  for (auto& file : files_) {
+    auto& offsets = file.second;
+    std::sort(offsets.begin(), offsets.end());
+    offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+  }
+  normalized_ = true;
+}
+
+void BlockCacheHotSet::EncodeTo(std::string* dst) {
+  Normalize();
+  size_t start = dst->size();
+  PutFixed32(dst, kFormatVersion);
+  PutVarint64(dst, files_.size());
+  for (const auto& file : files_) {
+    PutLengthPrefixedSlice(dst, file.first);
+    PutVarint64(dst, file.second.size());
+    uint64_t prev = 0;
+    for (uint64_t offset : file.second) {
+      PutVarint64(dst, offset - prev);
+      prev = offset;
+    }
+  }
+  uint32_t crc = crc32c::Value(dst->data() + start, dst->size() - start);
+  PutFixed32(dst, crc32c::Mask(crc));
+}
+
+Status BlockCacheHotSet::DecodeFrom(const Slice& src) {
+  files_.clear();
+  normalized_ = true;
+  if (src.size() < 2 * sizeof(uint32_t)) {
+    return Status::Corruption("Block cache hot set too short");
+  }
+  Slice input(src.data(), src.size() - sizeof(uint32_t));
+  uint32_t expected_crc =
+      crc32c::Unmask(DecodeFixed32(src.data() + input.size()));
+  if (crc32c::Value(input.data(), input.size()) != expected_crc) {
+    return Status::Corruption("Block cache hot set checksum mismatch");
+  }
+
+  uint32_t version = 0;
+  uint64_t num_files = 0;
+  if (!GetFixed32(&input, &version) || !GetVarint64(&input, &num_files)) {
+    return Status::Corruption("Bad block cache hot set header");
+  }
+  if (version != kFormatVersion) {
+    return Status::NotSupported("Unknown block cache hot set format version",
+                                std::to_string(version));
+  }
+  for (uint64_t i = 0; i < num_files; ++i) {
+    Slice file_id;
+    uint64_t num_blocks = 0;
+    if (!GetLengthPrefixedSlice(&input, &file_id) ||
+        !GetVarint64(&input, &num_blocks)) {
+      files_.clear();
+      return Status::Corruption("Bad block cache hot set file entry");
+    }
+    auto& offsets = files_[file_id.ToString()];
+    uint64_t offset = 0;
+    for (uint64_t j = 0; j < num_blocks; ++j) {
+      uint64_t delta = 0;
+      if (!GetVarint64(&input, &delta)) {
+        files_.clear();
+        return Status::Corruption("Bad block cache hot set block offset");
+      }
+      offset += delta;
+      offsets.push_back(offset);
+    }
+  }
+  if (!input.empty()) {
+    files_.clear();
+    return Status::Corruption("Trailing bytes in block cache hot set");
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,66 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct TableProperties;
+
+// The set of SST data blocks that were in the block cache when it was dumped
+// by DB::DumpBlockCacheHotSet(), so that DB::WarmUpBlockCache() can load
+// them again, e.g. after a restart.
+//
+// Block cache keys are derived from in-process file identities, so files are
+// instead identified by an ID that stays the same across DB instances: the
+// session ID of the DB that created the file (from its table properties) and
+// the file number. Blocks are identified by their offset in the file.
+class BlockCacheHotSet {
+ public:
+  // Returns the stable ID of the SST file with the given properties and
+  // number.
+  static std::string GetFileId(const TableProperties& props,
+                               uint64_t file_number);
+
+  void AddBlock(const std::string& file_id, uint64_t block_offset) {
+    files_[file_id].push_back(block_offset);
+    normalized_ = false;
+  }
+
+  // Returns the offsets of the blocks of the given file in increasing order,
+  // or nullptr if there are none.
+  const std::vector<uint64_t>* GetBlockOffsets(const std::string& file_id);
+
+  size_t NumFiles() const { return files_.size(); }
+
+  // Serialized format:
+  //   fixed32: format version (1)
+  //   varint64: number of files
+  //   per file:
+  //     length-prefixed file ID
+  //     varint64: number of blocks
+  //     varint64: delta of each block offset from the previous one
+  //   fixed32: masked crc32c of the above
+  void EncodeTo(std::string* dst);
+  Status DecodeFrom(const Slice& src);
+
+ private:
+  // Sorts and de-duplicates the offsets of each file.
+  void Normalize();
+
+  std::map<std::string, std::vector<uint64_t>> files_;
+  bool normalized_ = true;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -1199,6 +1199,37 @@ void rocksdb_multi_get_cf(
   }
 }
 
+void rocksdb_batched_multi_get_cf(rocksdb_t* db,
+                                  const rocksdb_readoptions_t* options,
+                                  rocksdb_column_family_handle_t* column_family,
+                                  size_t num_keys, const char* const* keys_list,
+                                  const size_t* keys_list_sizes,
+                                  rocksdb_pinnableslice_t** values, char** errs,
+                                  unsigned char sorted_input) {
+  std::vector<Slice> keys(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    keys[i] = Slice(keys_list[i], keys_list_sizes[i]);
+  }
+  std::vector<PinnableSlice> pinnable_values(num_keys);
+  std::vector<Status> statuses(num_keys);
+  db->rep->MultiGet(options->rep, column_family->rep, num_keys, keys.data(),
+                    pinnable_values.data(), statuses.data(), sorted_input);
+  for (size_t i = 0; i < num_keys; i++) {
+    if (statuses[i].ok()) {
+      values[i] = new (rocksdb_pinnableslice_t);
+      values[i]->rep = std::move(pinnable_values[i]);
+      errs[i] = nullptr;
+    } else {
+      values[i] = nullptr;
+      if (!statuses[i].IsNotFound()) {
+        errs[i] = strdup(statuses[i].ToString().c_str());
+      } else {
+        errs[i] = nullptr;
+      }
+    }
+  }
+}
+
 unsigned char rocksdb_key_may_exist(rocksdb_t* db,
                                     const rocksdb_readoptions_t* options,
                                     const char* key, size_t key_len,
@@ -1594,6 +1625,32 @@ void rocksdb_iter_get_error(const rocksdb_iterator_t* iter, char** errptr) {
   SaveError(errptr, iter->rep->status());
 }
 
+size_t rocksdb_iter_next_batch(rocksdb_iterator_t* iter, size_t max_entries,
+                               char* keys_buf, size_t keys_buf_size,
+                               size_t* key_sizes, char* values_buf,
+                               size_t values_buf_size, size_t* value_sizes) {
+  size_t num_entries = 0;
+  size_t keys_used = 0;
+  size_t values_used = 0;
+  while (num_entries < max_entries && iter->rep->Valid()) {
+    Slice key = iter->rep->key();
+    Slice value = iter->rep->value();
+    if (key.size() > keys_buf_size - keys_used ||
+        value.size() > values_buf_size - values_used) {
+      break;
+    }
+    memcpy(keys_buf + keys_used, key.data(), key.size());
+    memcpy(values_buf + values_used, value.data(), value.size());
+    keys_used += key.size();
+    values_used += value.size();
+    key_sizes[num_entries] = key.size();
+    value_sizes[num_entries] = value.size();
+    num_entries++;
+    iter->rep->Next();
+  }
+  return num_entries;
+}
+
 rocksdb_writebatch_t* rocksdb_writebatch_create() {
   return new rocksdb_writebatch_t;
 }
@@ -965,6 +965,30 @@ int main(int argc, char** argv) {
     }
   }
 
+  StartPhase("iter_next_batch");
+  {
+    rocksdb_iterator_t* iter = rocksdb_create_iterator(db, roptions);
+    char keys_buf[8];
+    char values_buf[8];
+    size_t key_sizes[2];
+    size_t value_sizes[2];
+    rocksdb_iter_seek(iter, "box", 3);
+    // "foo" => "hello" does not fit after "box" => "c"
+    CheckCondition(1 == rocksdb_iter_next_batch(iter, 2, keys_buf, 5,
+                                                key_sizes, values_buf, 5,
+                                                value_sizes));
+    CheckEqual("box", keys_buf, key_sizes[0]);
+    CheckEqual("c", values_buf, value_sizes[0]);
+    CheckIter(iter, "foo", "hello");
+    CheckCondition(1 == rocksdb_iter_next_batch(iter, 2, keys_buf, 8,
+                                                key_sizes, values_buf, 8,
+                                                value_sizes));
+    CheckEqual("foo", keys_buf, key_sizes[0]);
+    CheckEqual("hello", values_buf, value_sizes[0]);
+    CheckCondition(!rocksdb_iter_valid(iter));
+    rocksdb_iter_destroy(iter);
+  }
+
   StartPhase("pin_get");
   {
     CheckPinGet(db, roptions, "box", "c");
@@ -1312,6 +1336,21 @@ int main(int argc, char** argv) {
       Free(&vals[i]);
     }
 
+    {
+      const char* batched_keys[2] = {"barfooxx", "box"};
+      const size_t batched_keys_sizes[2] = {8, 3};
+      rocksdb_pinnableslice_t* pinned_vals[2];
+      rocksdb_batched_multi_get_cf(db, roptions, handles[1], 2, batched_keys,
+                                   batched_keys_sizes, pinned_vals, errs, 1);
+      CheckEqual(NULL, errs[0], 0);
+      CheckEqual(NULL, errs[1], 0);
+      CheckCondition(pinned_vals[0] == NULL);
+      size_t val_len;
+      const char* val = rocksdb_pinnableslice_value(pinned_vals[1], &val_len);
+      CheckEqual("c", val, val_len);
+      rocksdb_pinnableslice_destroy(pinned_vals[1]);
+    }
+
     {
       unsigned char value_found = 0;
 
@@ -119,13 +119,30 @@ void GetIntTblPropCollectorFactory(
     int_tbl_prop_collector_factories->emplace_back(
         new UserKeyTablePropertiesCollectorFactory(collector_factories[i]));
   }
+  if (ioptions.user_comparator->timestamp_size() > 0) {
+    int_tbl_prop_collector_factories->emplace_back(
+        new TimestampTablePropertiesCollectorFactory(
+            ioptions.user_comparator));
+  }
 }
 
+namespace {
+// kCustomCompression is supported if there is a compressor for it
+bool CompressionTypeAvailable(const ColumnFamilyOptions& cf_options,
+                              CompressionType type) {
+  if (type == kCustomCompression) {
+    return cf_options.compressor != nullptr;
+  }
+  return CompressionTypeSupported(type);
+}
+}  // namespace
+
 Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options) {
   if (!cf_options.compression_per_level.empty()) {
     for (size_t level = 0; level < cf_options.compression_per_level.size();
          ++level) {
-      if (!CompressionTypeSupported(cf_options.compression_per_level[level])) {
+      if (!CompressionTypeAvailable(cf_options,
+                                    cf_options.compression_per_level[level])) {
         return Status::InvalidArgument(
             "Compression type " +
             CompressionTypeToString(cf_options.compression_per_level[level]) +
@@ -133,7 +150,7 @@ Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options) {
       }
     }
   } else {
-    if (!CompressionTypeSupported(cf_options.compression)) {
+    if (!CompressionTypeAvailable(cf_options, cf_options.compression)) {
       return Status::InvalidArgument(
           "Compression type " +
           CompressionTypeToString(cf_options.compression) +
@@ -153,7 +170,7 @@ Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options) {
     }
   }
 
-  if (!CompressionTypeSupported(cf_options.blob_compression_type)) {
+  if (!CompressionTypeAvailable(cf_options, cf_options.blob_compression_type)) {
     std::ostringstream oss;
     oss << "The specified blob compression type "
         << CompressionTypeToString(cf_options.blob_compression_type)
@@ -166,10 +183,11 @@ Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options) {
 }
 
 Status CheckConcurrentWritesSupported(const ColumnFamilyOptions& cf_options) {
-  if (cf_options.inplace_update_support) {
+  if (cf_options.inplace_update_support &&
+      cf_options.inplace_callback != nullptr) {
     return Status::InvalidArgument(
-        "In-place memtable updates (inplace_update_support) is not compatible "
-        "with concurrent writes (allow_concurrent_memtable_write)");
+        "In-place memtable updates with a callback (inplace_callback) is not "
+        "compatible with concurrent writes (allow_concurrent_memtable_write)");
   }
   if (!cf_options.memtable_factory->IsInsertConcurrentlySupported()) {
     return Status::InvalidArgument(
@@ -466,6 +484,9 @@ void SuperVersion::Init(ColumnFamilyData* new_cfd, MemTable* new_mem,
   mem = new_mem;
   imm = new_imm;
   current = new_current;
+  if (mem->hot_key_cache_slots() > 0) {
+    hot_key_cache.reset(new HotKeyCache(mem->hot_key_cache_slots()));
+  }
   cfd->Ref();
   mem->Ref();
   imm->Ref();
@@ -538,6 +559,11 @@ ColumnFamilyData::ColumnFamilyData(
       queued_for_flush_(false),
       queued_for_compaction_(false),
       prev_compaction_needed_bytes_(0),
+      prev_stall_recalc_micros_(0),
+      prev_bytes_flushed_(0),
+      prev_bytes_compacted_(0),
+      prev_stall_recalc_debt_(0),
+      sustainable_write_rate_(0),
       allow_2pc_(db_options.allow_2pc),
       last_memtable_id_(0),
       db_paths_registered_(false) {
@@ -805,6 +831,9 @@ std::unique_ptr<WriteControllerToken> SetupDelay(
   return write_controller->GetDelayToken(write_rate);
 }
 
+// Weight of the newest sample in the sustainable write rate estimate.
+const double kSustainableRateSmoothing = 0.3;
+
 int GetL0ThresholdSpeedupCompaction(int level0_file_num_compaction_trigger,
                                     int level0_slowdown_writes_trigger) {
   // SanitizeOptions() ensures it.
@@ -895,6 +924,21 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
     bool was_stopped = write_controller->IsStopped();
     bool needed_delay = write_controller->NeedsDelay();
 
+    UpdateSustainableWriteRate(compaction_needed_bytes);
+    internal_stats_->UpdateCompactionDebtRates();
+    const double slowdown_start_ratio =
+        mutable_cf_options.pending_compaction_bytes_slowdown_start_ratio;
+    const uint64_t slowdown_start_bytes = static_cast<uint64_t>(
+        slowdown_start_ratio *
+        static_cast<double>(
+            mutable_cf_options.soft_pending_compaction_bytes_limit));
+    const bool smooth_slowdown =
+        write_stall_condition == WriteStallCondition::kNormal &&
+        !mutable_cf_options.disable_auto_compactions &&
+        slowdown_start_ratio > 0 && slowdown_start_ratio < 1 &&
+        mutable_cf_options.soft_pending_compaction_bytes_limit > 0 &&
+        compaction_needed_bytes >= slowdown_start_bytes;
+
     if (write_stall_condition == WriteStallCondition::kStopped &&
         write_stall_cause == WriteStallCause::kMemtableLimit) {
       write_controller_token_ = write_controller->GetStopToken();
@@ -986,6 +1030,33 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
           "bytes %" PRIu64 " rate %" PRIu64,
           name_.c_str(), vstorage->estimated_compaction_needed_bytes(),
           write_controller->delayed_write_rate());
+    } else if (smooth_slowdown) {
+      // Scale the sustainable rate down from 100% to 50% as the debt moves
+      // from the start of the slowdown range to the soft limit, so that the
+      // debt shrinks before writes would hit the soft limit.
+      const double progress =
+          static_cast<double>(compaction_needed_bytes - slowdown_start_bytes) /
+          static_cast<double>(
+              mutable_cf_options.soft_pending_compaction_bytes_limit -
+              slowdown_start_bytes + 1);
+      const uint64_t kMinWriteRate = 16 * 1024u;
+      const uint64_t max_write_rate = write_controller->max_delayed_write_rate();
+      double base_rate = sustainable_write_rate_ > 0
+                             ? sustainable_write_rate_
+                             : static_cast<double>(max_write_rate);
+      uint64_t write_rate =
+          static_cast<uint64_t>(base_rate * (1.0 - 0.5 * progress));
+      write_rate = std::max(std::min(write_rate, max_write_rate),
+                            std::min(kMinWriteRate, max_write_rate));
+      write_controller_token_ = write_controller->GetDelayToken(write_rate);
+      internal_stats_->AddCFStats(
+          InternalStats::PENDING_COMPACTION_BYTES_SMOOTH_SLOWDOWNS, 1);
+      ROCKS_LOG_INFO(
+          ioptions_.logger,
+          "[%s] Smoothly slowing down writes because of estimated pending "
+          "compaction bytes %" PRIu64 " rate %" PRIu64,
+          name_.c_str(), compaction_needed_bytes,
+          write_controller->delayed_write_rate());
     } else {
       assert(write_stall_condition == WriteStallCondition::kNormal);
       if (vstorage->l0_delay_trigger_count() >=
@@ -1038,6 +1109,52 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
   return write_stall_condition;
 }
 
+void ColumnFamilyData::UpdateSustainableWriteRate(
+    uint64_t compaction_needed_bytes) {
+  const uint64_t now = ioptions_.clock->NowMicros();
+  const uint64_t bytes_flushed = internal_stats_->GetBytesFlushed();
+  const uint64_t bytes_compacted =
+      internal_stats_->GetBytesWritten() - bytes_flushed;
+  if (prev_stall_recalc_micros_ != 0 && now > prev_stall_recalc_micros_ &&
+      bytes_flushed > prev_bytes_flushed_ &&
+      bytes_compacted >= prev_bytes_compacted_) {
+    // Over the last interval, flushes added debt and compactions paid off
+    // roughly the bytes they wrote. The ingest rate that keeps the debt
+    // constant is the observed one, scaled by the fraction of new debt that
+    // compaction kept up with.
+    const double elapsed_sec =
+        static_cast<double>(now - prev_stall_recalc_micros_) / 1e6;
+    const double ingest_rate =
+        static_cast<double>(bytes_flushed - prev_bytes_flushed_) / elapsed_sec;
+    const double compacted =
+        static_cast<double>(bytes_compacted - prev_bytes_compacted_);
+    const double debt_growth = static_cast<double>(compaction_needed_bytes) -
+                               static_cast<double>(prev_stall_recalc_debt_);
+    double sample = 0;
+    if (compacted + debt_growth <= 0) {
+      // Debt shrank faster than compaction wrote; no constraint observed.
+      sample = std::max(ingest_rate,
+                        static_cast<double>(column_family_set_->write_controller_
+                                                ->max_delayed_write_rate()));
+    } else {
+      sample = ingest_rate * compacted / (compacted + debt_growth);
+    }
+    sustainable_write_rate_ =
+        sustainable_write_rate_ > 0
+            ? kSustainableRateSmoothing * sample +
+                  (1 - kSustainableRateSmoothing) * sustainable_write_rate_
+            : sample;
+  }
+  if (prev_stall_recalc_micros_ == 0 || bytes_flushed > prev_bytes_flushed_) {
+    // Only start a new interval once something was flushed, so that the
+    // many recalculations between flushes do not produce empty samples.
+    prev_stall_recalc_micros_ = now;
+    prev_bytes_flushed_ = bytes_flushed;
+    prev_bytes_compacted_ = bytes_compacted;
+    prev_stall_recalc_debt_ = compaction_needed_bytes;
+  }
+}
+
 const FileOptions* ColumnFamilyData::soptions() const {
   return &(column_family_set_->file_options_);
 }
@@ -1064,6 +1181,33 @@ MemTable* ColumnFamilyData::ConstructNewMemtable(
                       write_buffer_manager_, earliest_seq, id_);
 }
 
+size_t ColumnFamilyData::NextWriteBufferSize(
+    const MutableCFOptions& mutable_cf_options) {
+  const size_t base_size = mutable_cf_options.write_buffer_size;
+  size_t max_size = mutable_cf_options.max_adaptive_write_buffer_size;
+  if (write_buffer_manager_ != nullptr && write_buffer_manager_->enabled()) {
+    max_size = std::min(max_size, write_buffer_manager_->buffer_size() / 2);
+  }
+  if (max_size <= base_size || mem_ == nullptr) {
+    return base_size;
+  }
+  const size_t cur_size = mem_->GetWriteBufferSize();
+  size_t next_size = cur_size;
+  if (mem_->IsFull()) {
+    next_size = cur_size > max_size / 2 ? max_size : cur_size * 2;
+  } else if (mem_->ApproximateMemoryUsageFast() < cur_size / 2) {
+    next_size = cur_size / 2;
+  }
+  next_size = std::max(std::min(next_size, max_size), base_size);
+  if (next_size != cur_size) {
+    ROCKS_LOG_INFO(ioptions_.logger,
+                   "[%s] Write buffer size of new memtable: %" ROCKSDB_PRIszt
+                   " (was %" ROCKSDB_PRIszt ")",
+                   name_.c_str(), next_size, cur_size);
+  }
+  return next_size;
+}
+
 void ColumnFamilyData::CreateNewMemtable(
     const MutableCFOptions& mutable_cf_options, SequenceNumber earliest_seq) {
   if (mem_ != nullptr) {
@@ -1324,11 +1468,22 @@ Status ColumnFamilyData::ValidateOptions(
   if (s.ok() && db_options.allow_concurrent_memtable_write) {
     s = CheckConcurrentWritesSupported(cf_options);
   }
+  if (s.ok() && db_options.unordered_write &&
+      cf_options.inplace_update_support) {
+    s = Status::InvalidArgument(
+        "inplace_update_support is incompatible with unordered_write");
+  }
   if (s.ok() && db_options.unordered_write &&
       cf_options.max_successive_merges != 0) {
     s = Status::InvalidArgument(
         "max_successive_merges > 0 is incompatible with unordered_write");
   }
+  if (s.ok() && db_options.unordered_write &&
+      cf_options.merge_operands_collapse_threshold != 0) {
+    s = Status::InvalidArgument(
+        "merge_operands_collapse_threshold > 0 is incompatible with "
+        "unordered_write");
+  }
   if (s.ok()) {
     s = CheckCFPathsSupported(db_options, cf_options);
   }
@@ -1354,6 +1509,14 @@ Status ColumnFamilyData::ValidateOptions(
     }
   }
 
+  if (cf_options.use_direct_reads_for_blob_files &&
+      db_options.allow_mmap_reads) {
+    return Status::NotSupported(
+        "If memory mapped reads (allow_mmap_reads) are enabled "
+        "then direct I/O reads of blob files (use_direct_reads_for_blob_files) "
+        "must be disabled.");
+  }
+
   if (cf_options.enable_blob_garbage_collection &&
       (cf_options.blob_garbage_collection_age_cutoff < 0.0 ||
        cf_options.blob_garbage_collection_age_cutoff > 1.0)) {
@@ -1362,12 +1525,25 @@ Status ColumnFamilyData::ValidateOptions(
         "[0.0, 1.0].");
   }
 
+  if (cf_options.enable_blob_garbage_collection &&
+      (cf_options.blob_garbage_collection_force_threshold < 0.0 ||
+       cf_options.blob_garbage_collection_force_threshold > 1.0)) {
+    return Status::InvalidArgument(
+        "The garbage ratio threshold for forcing blob garbage collection "
+        "should be in the range [0.0, 1.0].");
+  }
+
   if (cf_options.compaction_style == kCompactionStyleFIFO &&
       db_options.max_open_files != -1 && cf_options.ttl > 0) {
     return Status::NotSupported(
         "FIFO compaction only supported with max_open_files = -1.");
   }
 
+  if (!(cf_options.write_buffer_share_weight > 0.0)) {
+    return Status::InvalidArgument(
+        "write_buffer_share_weight should be positive.");
+  }
+
   return s;
 }
 
@@ -14,6 +14,7 @@
 #include <vector>
 #include <atomic>
 
+#include "db/hot_key_cache.h"
 #include "db/memtable_list.h"
 #include "db/table_cache.h"
 #include "db/table_properties_collector.h"
@@ -207,6 +208,8 @@ struct SuperVersion {
   // Version number of the current SuperVersion
   uint64_t version_number;
   WriteStallCondition write_stall_condition;
+  // Recent Get() results, if enabled for `mem`
+  std::unique_ptr<HotKeyCache> hot_key_cache;
 
   InstrumentedMutex* db_mutex;
 
@@ -360,6 +363,11 @@ class ColumnFamilyData {
   uint64_t GetNumLiveVersions() const;  // REQUIRE: DB mutex held
   uint64_t GetTotalSstFilesSize() const;  // REQUIRE: DB mutex held
   uint64_t GetLiveSstFilesSize() const;   // REQUIRE: DB mutex held
+  // Estimated ingest rate in bytes/sec that compaction can keep up with, or
+  // 0 if unknown. REQUIRE: DB mutex held
+  uint64_t GetSustainableWriteRate() const {
+    return static_cast<uint64_t>(sustainable_write_rate_);
+  }
   void SetMemtable(MemTable* new_mem) {
     uint64_t memtable_id = last_memtable_id_.fetch_add(1) + 1;
     new_mem->SetID(memtable_id);
@@ -375,6 +383,12 @@ class ColumnFamilyData {
   void CreateNewMemtable(const MutableCFOptions& mutable_cf_options,
                          SequenceNumber earliest_seq);
 
+  // Returns the write buffer size of the memtable to replace mem() with. It
+  // is write_buffer_size, unless max_adaptive_write_buffer_size adapts it to
+  // how mem() filled up.
+  // REQUIRES: DB mutex held
+  size_t NextWriteBufferSize(const MutableCFOptions& mutable_cf_options);
+
   TableCache* table_cache() const { return table_cache_.get(); }
   BlobFileCache* blob_file_cache() const { return blob_file_cache_.get(); }
 
@@ -538,6 +552,10 @@ class ColumnFamilyData {
 
   std::vector<std::string> GetDbPaths() const;
 
+  // Folds the flush and compaction progress since the previous flush into
+  // the sustainable write rate estimate. REQUIRE: DB mutex held
+  void UpdateSustainableWriteRate(uint64_t compaction_needed_bytes);
+
   uint32_t id_;
   const std::string name_;
   Version* dummy_versions_;  // Head of circular doubly-linked list of versions.
@@ -606,6 +624,15 @@ class ColumnFamilyData {
 
   uint64_t prev_compaction_needed_bytes_;
 
+  // State for estimating the sustainable write rate, see
+  // pending_compaction_bytes_slowdown_start_ratio. Updated on every
+  // RecalculateWriteStallConditions().
+  uint64_t prev_stall_recalc_micros_;
+  uint64_t prev_bytes_flushed_;
+  uint64_t prev_bytes_compacted_;
+  uint64_t prev_stall_recalc_debt_;
+  double sustainable_write_rate_;
+
   // if the database was opened with 2pc enabled
   bool allow_2pc_;
 
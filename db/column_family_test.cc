@@ -2226,6 +2226,39 @@ TEST_P(ColumnFamilyTest, FlushStaleColumnFamilies) {
   ASSERT_EQ(0, dbfull()->TEST_total_log_size());
   Close();
 }
+
+TEST_P(ColumnFamilyTest, FlushManyColumnFamiliesOnFullWal) {
+  const int kNumColumnFamilies = 20;
+  db_options_.max_total_wal_size = 60000;
+  Open();
+  std::vector<std::string> names;
+  for (int i = 1; i <= kNumColumnFamilies; ++i) {
+    names.push_back("cf" + ToString(i));
+  }
+  CreateColumnFamilies(names);
+  for (int i = 1; i <= kNumColumnFamilies; ++i) {
+    PutRandomData(i, 1, 10);
+  }
+
+  int num_passes = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::SwitchMemtable:UpdateEmptyColumnFamilies",
+      [&](void* /*arg*/) { ++num_passes; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  // The WAL gets full, and the memtables of all column families are switched
+  // at once. Only the switch creating the new WAL scans the column families.
+  PutRandomData(0, 70, 1000);
+  ASSERT_EQ(1, num_passes);
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+  for (int i = 0; i <= kNumColumnFamilies; ++i) {
+    WaitForFlush(i);
+    ASSERT_EQ(1, NumTableFilesAtLevel(0, i));
+  }
+  Close();
+}
 #endif  // !ROCKSDB_LITE
 
 TEST_P(ColumnFamilyTest, CreateMissingColumnFamilies) {
@@ -2551,6 +2584,64 @@ TEST_P(ColumnFamilyTest, CreateAndDropRace) {
 }
 #endif  // !ROCKSDB_LITE
 
+TEST_P(ColumnFamilyTest, SmoothWriteSlowdownBeforeSoftLimit) {
+  const uint64_t kBaseRate = 800000u;
+  db_options_.delayed_write_rate = kBaseRate;
+
+  Open({"default"});
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+
+  MutableCFOptions mutable_cf_options(column_family_options_);
+  mutable_cf_options.level0_slowdown_writes_trigger = 20;
+  mutable_cf_options.level0_stop_writes_trigger = 10000;
+  mutable_cf_options.soft_pending_compaction_bytes_limit = 200;
+  mutable_cf_options.hard_pending_compaction_bytes_limit = 2000;
+  mutable_cf_options.disable_auto_compactions = false;
+  mutable_cf_options.pending_compaction_bytes_slowdown_start_ratio = 0.5;
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(50);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_FALSE(dbfull()->TEST_write_controler().NeedsDelay());
+
+  // Without flushes there is no throughput estimate yet, so the slowdown
+  // starts from the configured delayed write rate.
+  vstorage->TEST_set_estimated_compaction_needed_bytes(100);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_FALSE(IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(kBaseRate, GetDbDelayedWriteRate());
+
+  // The rate keeps dropping as the debt approaches the soft limit.
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  uint64_t rate_at_150 = GetDbDelayedWriteRate();
+  ASSERT_LT(rate_at_150, kBaseRate);
+  ASSERT_GT(rate_at_150, kBaseRate / 2);
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(199);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_LT(GetDbDelayedWriteRate(), rate_at_150);
+  ASSERT_GE(GetDbDelayedWriteRate(), kBaseRate / 2);
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(40);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_FALSE(dbfull()->TEST_write_controler().NeedsDelay());
+
+  uint64_t sustainable_rate = 1;
+  ASSERT_TRUE(db_->GetIntProperty(
+      DB::Properties::kEstimatedSustainableWriteRate, &sustainable_rate));
+  ASSERT_EQ(0, sustainable_rate);
+
+  // Disabled by default
+  mutable_cf_options.pending_compaction_bytes_slowdown_start_ratio = 0;
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_FALSE(dbfull()->TEST_write_controler().NeedsDelay());
+}
+
 TEST_P(ColumnFamilyTest, WriteStallSingleColumnFamily) {
   const uint64_t kBaseRate = 800000u;
   db_options_.delayed_write_rate = kBaseRate;
@@ -349,6 +349,30 @@ bool Compaction::IsTrivialMove() const {
   return true;
 }
 
+void Compaction::SkipInputFiles(
+    const std::unordered_set<uint64_t>& file_numbers) {
+  input_boundaries_.resize(num_input_levels());
+  for (size_t which = 0; which < num_input_levels(); which++) {
+    const CompactionInputFiles& level_inputs = inputs_[which];
+    std::vector<FileMetaData*> files;
+    std::vector<AtomicCompactionUnitBoundary>& boundaries =
+        input_boundaries_[which];
+    boundaries.clear();
+    for (size_t i = 0; i < level_inputs.size(); i++) {
+      if (file_numbers.count(level_inputs[i]->fd.GetNumber()) > 0) {
+        continue;
+      }
+      files.push_back(level_inputs[i]);
+      if (!level_inputs.atomic_compaction_unit_boundaries.empty()) {
+        // Files keep the boundary of their unit even if other files of the
+        // unit are skipped, so range tombstones are truncated as before.
+        boundaries.push_back(level_inputs.atomic_compaction_unit_boundaries[i]);
+      }
+    }
+    DoGenerateLevelFilesBrief(&input_levels_[which], files, &arena_);
+  }
+}
+
 void Compaction::AddInputDeletions(VersionEdit* out_edit) {
   for (size_t which = 0; which < num_input_levels(); which++) {
     for (size_t i = 0; i < inputs_[which].size(); i++) {
@@ -565,16 +589,9 @@ bool Compaction::ShouldFormSubcompactions() const {
     return false;
   }
 
-  // Note: the subcompaction boundary picking logic does not currently guarantee
-  // that all user keys that differ only by timestamp get processed by the same
-  // subcompaction.
-  if (cfd_->user_comparator()->timestamp_size() > 0) {
-    return false;
-  }
-
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
-    return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0 &&
-           !IsOutputLevelEmpty();
+    // Files of a non-L0 input level split the compaction by themselves
+    return output_level_ > 0 && (start_level_ > 0 || !IsOutputLevelEmpty());
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
   } else {
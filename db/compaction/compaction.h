@@ -8,6 +8,9 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+
+#include <unordered_set>
+
 #include "db/version_set.h"
 #include "memory/arena.h"
 #include "options/cf_options.h"
@@ -132,9 +135,14 @@ class Compaction {
     return inputs_[compaction_input_level][i];
   }
 
+  // Returns the atomic compaction unit boundaries of the files in
+  // input_levels(compaction_input_level).
   const std::vector<AtomicCompactionUnitBoundary>* boundaries(
       size_t compaction_input_level) const {
     assert(compaction_input_level < inputs_.size());
+    if (!input_boundaries_.empty()) {
+      return &input_boundaries_[compaction_input_level];
+    }
     return &inputs_[compaction_input_level].atomic_compaction_unit_boundaries;
   }
 
@@ -155,6 +163,12 @@ class Compaction {
     return &input_levels_[compaction_input_level];
   }
 
+  // Removes the given input files from input_levels(), so that the compaction
+  // does not read them. They stay in inputs() and are still deleted by
+  // AddInputDeletions(). Only for files whose keys are all known to be
+  // obsolete, e.g. covered by a range tombstone in another input file.
+  void SkipInputFiles(const std::unordered_set<uint64_t>& file_numbers);
+
   // Maximum size of files to build during this compaction.
   uint64_t max_output_file_size() const { return max_output_file_size_; }
 
@@ -291,7 +305,7 @@ class Compaction {
 
   int GetInputBaseLevel() const;
 
-  CompactionReason compaction_reason() { return compaction_reason_; }
+  CompactionReason compaction_reason() const { return compaction_reason_; }
 
   const std::vector<FileMetaData*>& grandparents() const {
     return grandparents_;
@@ -365,6 +379,10 @@ class Compaction {
   // A copy of inputs_, organized more closely in memory
   autovector<LevelFilesBrief, 2> input_levels_;
 
+  // The atomic compaction unit boundaries of input_levels_, set by
+  // SkipInputFiles(). Empty if no input files are skipped.
+  std::vector<std::vector<AtomicCompactionUnitBoundary>> input_boundaries_;
+
   // State used to check for number of overlapping grandparent files
   // (grandparent == "output_level_ + 1")
   std::vector<FileMetaData*> grandparents_;
@@ -0,0 +1,245 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/compaction_block_copier.h"
+
+#include <algorithm>
+
+#include "db/compaction/compaction.h"
+#include "db/table_cache.h"
+#include "db/version_edit.h"
+#include "rocksdb/table_properties.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CompactionBlockCopier::CompactionBlockCopier(const Compaction* compaction,
+                                             TableCache* table_cache,
+                                             const FileOptions& file_options,
+                                             bool bottommost_level,
+                                             const Slice* end)
+    : compaction_(compaction),
+      table_cache_(table_cache),
+      file_options_(file_options),
+      icmp_(&compaction->column_family_data()->internal_comparator()),
+      ucmp_(compaction->column_family_data()->user_comparator()),
+      bottommost_level_(bottommost_level),
+      end_(end) {
+  for (size_t i = 0; i < compaction_->num_input_levels(); ++i) {
+    const std::vector<FileMetaData*>& files = *compaction_->inputs(i);
+    if (compaction_->level(i) == 0) {
+      for (const FileMetaData* f : files) {
+        file_groups_.push_back({f});
+      }
+    } else if (!files.empty()) {
+      file_groups_.emplace_back(files.begin(), files.end());
+    }
+  }
+}
+
+CompactionBlockCopier::~CompactionBlockCopier() {
+  for (auto& input : input_files_) {
+    input.second.iter.reset();
+    if (input.second.handle != nullptr) {
+      table_cache_->ReleaseHandle(input.second.handle);
+    }
+  }
+}
+
+bool CompactionBlockCopier::Seek(const Slice& key) {
+  if (ready_ && icmp_->Compare(key, entries_.front().first) == 0) {
+    // Next() found the block, but the output file ended before it
+    return true;
+  }
+  ready_ = false;
+  const Slice user_key = ExtractUserKey(key);
+  if (has_skip_until_ && ucmp_->Compare(user_key, skip_until_) <= 0) {
+    return false;
+  }
+
+  // The block following the last one loaded. No other input file starts
+  // between here and that one.
+  if (iter_ != nullptr && iter_->Valid() &&
+      icmp_->Compare(iter_->entries().front().first, key) == 0 &&
+      (!has_next_file_start_ ||
+       ucmp_->Compare(user_key, next_file_start_) < 0)) {
+    return Load();
+  }
+
+  // Find the input files whose key range includes the key, and the closest
+  // one starting after it
+  const FileMetaData* file = nullptr;
+  size_t num_files = 0;
+  Slice min_largest;
+  Slice next_start;
+  bool has_next_start = false;
+  for (const auto& group : file_groups_) {
+    auto it = std::lower_bound(
+        group.begin(), group.end(), user_key,
+        [this](const FileMetaData* f, const Slice& k) {
+          return ucmp_->Compare(f->largest.user_key(), k) < 0;
+        });
+    if (it == group.end()) {
+      continue;
+    }
+    if (ucmp_->Compare((*it)->smallest.user_key(), user_key) <= 0) {
+      if (num_files == 0 ||
+          ucmp_->Compare((*it)->largest.user_key(), min_largest) < 0) {
+        min_largest = (*it)->largest.user_key();
+      }
+      file = *it;
+      ++num_files;
+      if (++it == group.end()) {
+        continue;
+      }
+    }
+    if (!has_next_start ||
+        ucmp_->Compare((*it)->smallest.user_key(), next_start) < 0) {
+      next_start = (*it)->smallest.user_key();
+      has_next_start = true;
+    }
+  }
+  iter_ = nullptr;
+  if (num_files != 1) {
+    if (num_files > 1) {
+      // The files overlap at least up to the first one's end
+      SkipUntil(min_largest);
+    }
+    return false;
+  }
+  iter_ = GetIterator(file);
+  if (iter_ == nullptr) {
+    SkipUntil(file->largest.user_key());
+    return false;
+  }
+  next_file_start_.assign(next_start.data(), next_start.size());
+  has_next_file_start_ = has_next_start;
+
+  iter_->Seek(key);
+  if (!iter_->Valid()) {
+    iter_->status().PermitUncheckedError();
+    SkipUntil(file->largest.user_key());
+    iter_ = nullptr;
+    return false;
+  }
+  if (icmp_->Compare(iter_->entries().front().first, key) != 0) {
+    SkipUntil(ExtractUserKey(iter_->entries().back().first));
+    return false;
+  }
+  return Load();
+}
+
+bool CompactionBlockCopier::Next() {
+  assert(ready_);
+  ready_ = false;
+  if (iter_ == nullptr || !iter_->Valid()) {
+    return false;
+  }
+  return Load();
+}
+
+RawDataBlockIterator* CompactionBlockCopier::GetIterator(
+    const FileMetaData* file) {
+  auto it = input_files_.find(file->fd.GetNumber());
+  if (it != input_files_.end()) {
+    return it->second.iter.get();
+  }
+  InputFile& input = input_files_[file->fd.GetNumber()];
+  Status s = table_cache_->FindTable(
+      ReadOptions(), file_options_, *icmp_, file->fd, &input.handle,
+      compaction_->mutable_cf_options()->prefix_extractor.get());
+  if (!s.ok()) {
+    input.handle = nullptr;
+    return nullptr;
+  }
+  TableReader* reader = table_cache_->GetTableReaderFromHandle(input.handle);
+  std::shared_ptr<const TableProperties> props = reader->GetTableProperties();
+  if (props == nullptr || props->num_range_deletions > 0) {
+    return nullptr;
+  }
+  ReadOptions read_options;
+  read_options.verify_checksums = true;
+  read_options.fill_cache = false;
+  input.iter.reset(reader->NewRawDataBlockIterator(read_options));
+  return input.iter.get();
+}
+
+bool CompactionBlockCopier::Load() {
+  assert(iter_ != nullptr && iter_->Valid());
+  const std::vector<std::pair<Slice, Slice>>& entries = iter_->entries();
+  if (!Qualifies(entries)) {
+    SkipUntil(ExtractUserKey(entries.back().first));
+    return false;
+  }
+
+  contents_.assign(iter_->contents().data(), iter_->contents().size());
+  compression_type_ = iter_->compression_type();
+  compress_format_version_ = iter_->compress_format_version();
+  entry_data_.clear();
+  for (const auto& entry : entries) {
+    entry_data_.append(entry.first.data(), entry.first.size());
+    entry_data_.append(entry.second.data(), entry.second.size());
+  }
+  std::vector<std::pair<Slice, Slice>> copied;
+  copied.reserve(entries.size());
+  const char* p = entry_data_.data();
+  for (const auto& entry : entries) {
+    Slice key(p, entry.first.size());
+    p += entry.first.size();
+    copied.emplace_back(key, Slice(p, entry.second.size()));
+    p += entry.second.size();
+  }
+  entries_.swap(copied);
+
+  // The block must not end in the middle of a user key's versions
+  const Slice last_user_key = ExtractUserKey(entries_.back().first);
+  iter_->Next();
+  if (iter_->Valid()) {
+    const Slice& next = iter_->entries().front().first;
+    if (ucmp_->Compare(ExtractUserKey(next), last_user_key) == 0) {
+      SkipUntil(last_user_key);
+      return false;
+    }
+    next_key_.assign(next.data(), next.size());
+  } else if (!iter_->status().ok()) {
+    SkipUntil(last_user_key);
+    iter_ = nullptr;
+    return false;
+  } else if (has_next_file_start_) {
+    // Nothing else is left before the next input file
+    next_key_ = InternalKey(next_file_start_, kMaxSequenceNumber,
+                            kValueTypeForSeek)
+                    .Encode()
+                    .ToString();
+  } else {
+    next_key_ = InternalKey(last_user_key, 0, kTypeDeletion).Encode().ToString();
+  }
+  ready_ = true;
+  return true;
+}
+
+bool CompactionBlockCopier::Qualifies(
+    const std::vector<std::pair<Slice, Slice>>& entries) const {
+  Slice prev_user_key;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    ParsedInternalKey ikey;
+    if (!ParseInternalKey(entries[i].first, &ikey, false /* log_err_key */)
+             .ok() ||
+        ikey.type != kTypeValue ||
+        (bottommost_level_ && ikey.sequence != 0)) {
+      return false;
+    }
+    if (i > 0 && ucmp_->Compare(prev_user_key, ikey.user_key) >= 0) {
+      return false;
+    }
+    prev_user_key = ikey.user_key;
+  }
+  if (end_ != nullptr && ucmp_->Compare(prev_user_key, *end_) >= 0) {
+    return false;
+  }
+  return !has_next_file_start_ ||
+         ucmp_->Compare(prev_user_key, next_file_start_) < 0;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
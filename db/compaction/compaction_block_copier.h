@@ -0,0 +1,126 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/options.h"
+#include "table/table_reader.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Compaction;
+class TableCache;
+struct FileMetaData;
+
+// Finds the data blocks of a compaction's input files that the compaction
+// would write out unchanged, so that they can be copied into its output as
+// they are stored instead of being decoded, merged and encoded again.
+//
+// A block qualifies when no other input file overlaps its key range and its
+// entries are plain values of distinct user keys (with sequence number 0 if
+// the output is the bottommost level), none of them continued in the next
+// block. Merging, deletions, snapshots and range tombstones then cannot
+// change it. Files with range tombstones, and tables that cannot hand out
+// their blocks (see TableReader::NewRawDataBlockIterator()), are skipped.
+//
+// Read errors only make blocks not qualify; the compaction reading the same
+// blocks reports them.
+class CompactionBlockCopier {
+ public:
+  // `end` is the exclusive upper bound, as a user key, of the keys being
+  // compacted, or nullptr if unbounded.
+  CompactionBlockCopier(const Compaction* compaction, TableCache* table_cache,
+                        const FileOptions& file_options, bool bottommost_level,
+                        const Slice* end);
+  ~CompactionBlockCopier();
+
+  CompactionBlockCopier(const CompactionBlockCopier&) = delete;
+  CompactionBlockCopier& operator=(const CompactionBlockCopier&) = delete;
+
+  // Returns true if the internal key `key`, the next one the compaction is
+  // going to output, is the first key of a qualifying block, which then
+  // becomes the current block. Calls must be made in increasing key order.
+  bool Seek(const Slice& key);
+
+  // Moves to the block after the current one in the same file, and returns
+  // true if it qualifies as well.
+  bool Next();
+
+  // The current block. See RawDataBlockIterator.
+  Slice contents() const { return contents_; }
+  CompressionType compression_type() const { return compression_type_; }
+  uint32_t compress_format_version() const { return compress_format_version_; }
+  const std::vector<std::pair<Slice, Slice>>& entries() const {
+    return entries_;
+  }
+
+  // An internal key the compaction input can be positioned at to continue
+  // after the current block: the first input entry after it, or a key
+  // between the two.
+  Slice next_key() const { return next_key_; }
+
+ private:
+  struct InputFile {
+    Cache::Handle* handle = nullptr;
+    std::unique_ptr<RawDataBlockIterator> iter;
+  };
+
+  // Returns the raw block iterator of `file`, or nullptr if its blocks
+  // cannot be copied.
+  RawDataBlockIterator* GetIterator(const FileMetaData* file);
+
+  // Makes the block `iter_` is at the current block if it qualifies, and
+  // moves `iter_` past it.
+  bool Load();
+
+  bool Qualifies(const std::vector<std::pair<Slice, Slice>>& entries) const;
+
+  void SkipUntil(const Slice& user_key) {
+    skip_until_.assign(user_key.data(), user_key.size());
+    has_skip_until_ = true;
+  }
+
+  const Compaction* compaction_;
+  TableCache* table_cache_;
+  const FileOptions file_options_;
+  const InternalKeyComparator* icmp_;
+  const Comparator* ucmp_;
+  const bool bottommost_level_;
+  const Slice* end_;
+
+  // Input files in groups of non-overlapping files sorted by key, one per
+  // input level, or per file of level 0
+  std::vector<std::vector<const FileMetaData*>> file_groups_;
+  std::unordered_map<uint64_t, InputFile> input_files_;
+
+  // Keys up to and including this user key cannot start a qualifying block
+  std::string skip_until_;
+  bool has_skip_until_ = false;
+
+  // The file blocks are taken from, and where the next input file starts
+  RawDataBlockIterator* iter_ = nullptr;
+  std::string next_file_start_;
+  bool has_next_file_start_ = false;
+
+  // A copy of the current block, valid if ready_
+  bool ready_ = false;
+  std::string contents_;
+  CompressionType compression_type_ = kNoCompression;
+  uint32_t compress_format_version_ = 0;
+  std::string entry_data_;
+  std::vector<std::pair<Slice, Slice>> entries_;
+  std::string next_key_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
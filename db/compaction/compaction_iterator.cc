@@ -17,6 +17,149 @@
 #include "test_util/sync_point.h"
 
 namespace ROCKSDB_NAMESPACE {
+FilterBatchIterator::FilterBatchIterator(
+    InternalIterator* iter, const Comparator* cmp,
+    const CompactionFilter* compaction_filter, int level, SystemClock* clock,
+    bool report_detailed_time)
+    : iter_(iter),
+      icmp_(cmp, /*named=*/false),
+      compaction_filter_(compaction_filter),
+      level_(level),
+      clock_(clock),
+      report_detailed_time_(report_detailed_time),
+      batch_size_(compaction_filter->GetFilterBatchSize()) {
+  assert(batch_size_ > 0);
+  Fill();
+}
+
+void FilterBatchIterator::Next() {
+  assert(Valid());
+  if (++pos_ == entries_.size()) {
+    Fill();
+  }
+}
+
+void FilterBatchIterator::Seek(const Slice& target) {
+  if (Valid() && icmp_.Compare(entries_[pos_].key, target) <= 0 &&
+      icmp_.Compare(entries_.back().key, target) >= 0) {
+    // The target is within the current batch
+    while (icmp_.Compare(entries_[pos_].key, target) < 0) {
+      ++pos_;
+    }
+    return;
+  }
+  entries_.clear();
+  pos_ = 0;
+  has_prev_user_key_ = false;
+  iter_->Seek(target);
+  Fill();
+}
+
+bool FilterBatchIterator::TakeDecision(CompactionFilter::Decision* decision,
+                                       std::string* new_value,
+                                       std::string* skip_until) {
+  assert(Valid());
+  Entry& entry = entries_[pos_];
+  if (entry.batch_index < 0) {
+    return false;
+  }
+  CompactionFilter::BatchEntry& batch_entry = batch_[entry.batch_index];
+  entry.batch_index = -1;
+  *decision = batch_entry.decision;
+  new_value->swap(batch_entry.new_value);
+  skip_until->swap(batch_entry.skip_until);
+  return true;
+}
+
+void FilterBatchIterator::Fill() {
+  entries_.clear();
+  pos_ = 0;
+  batch_.clear();
+  while (entries_.size() < batch_size_ && iter_->Valid()) {
+    entries_.emplace_back();
+    entries_.back().key.assign(iter_->key().data(), iter_->key().size());
+    entries_.back().value.assign(iter_->value().data(),
+                                 iter_->value().size());
+    iter_->Next();
+  }
+
+  // No more entries are added, so the slices into them stay valid
+  const Comparator* ucmp = icmp_.user_comparator();
+  Slice prev_user_key = prev_user_key_;
+  bool has_prev_user_key = has_prev_user_key_;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    ParsedInternalKey ikey;
+    if (!ParseInternalKey(entries_[i].key, &ikey, false /* log_err_key */)
+             .ok()) {
+      has_prev_user_key = false;
+      continue;
+    }
+    if (ikey.type == kTypeValue &&
+        (!has_prev_user_key || ucmp->Compare(ikey.user_key, prev_user_key))) {
+      entries_[i].batch_index = static_cast<int>(batch_.size());
+      batch_.emplace_back();
+      batch_.back().key = ikey.user_key;
+      batch_.back().existing_value = entries_[i].value;
+    }
+    prev_user_key = ikey.user_key;
+    has_prev_user_key = true;
+  }
+  prev_user_key_ = prev_user_key.ToString();
+  has_prev_user_key_ = has_prev_user_key;
+
+  if (!batch_.empty()) {
+    StopWatchNano timer(clock_, report_detailed_time_);
+    compaction_filter_->FilterBatch(level_, &batch_);
+    filter_time_ += report_detailed_time_ ? timer.ElapsedNanos() : 0;
+  }
+}
+
+BlobCompressAheadIterator::BlobCompressAheadIterator(
+    InternalIterator* iter, const Comparator* cmp,
+    BlobFileBuilder* blob_file_builder)
+    : iter_(iter),
+      icmp_(cmp, /*named=*/false),
+      blob_file_builder_(blob_file_builder),
+      max_entries_(blob_file_builder->MaxCompressAhead()) {
+  assert(max_entries_ > 0);
+  Fill();
+}
+
+void BlobCompressAheadIterator::Next() {
+  assert(Valid());
+  entries_.pop_front();
+  Fill();
+}
+
+void BlobCompressAheadIterator::Seek(const Slice& target) {
+  if (Valid() && icmp_.Compare(entries_.back().key, target) >= 0) {
+    // The target is within the window
+    while (icmp_.Compare(entries_.front().key, target) < 0) {
+      entries_.pop_front();
+    }
+    Fill();
+    return;
+  }
+  entries_.clear();
+  iter_->Seek(target);
+  Fill();
+}
+
+void BlobCompressAheadIterator::Fill() {
+  while (entries_.size() < max_entries_ && iter_->Valid()) {
+    entries_.emplace_back();
+    Entry& entry = entries_.back();
+    entry.key.assign(iter_->key().data(), iter_->key().size());
+    entry.value.assign(iter_->value().data(), iter_->value().size());
+    iter_->Next();
+
+    if (entry.key.size() >= kNumInternalBytes &&
+        ExtractValueType(entry.key) == kTypeValue) {
+      blob_file_builder_->CompressAhead(entry.value);
+    }
+  }
+}
+
 CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
     SequenceNumber last_sequence, std::vector<SequenceNumber>* snapshots,
@@ -31,7 +174,8 @@ CompactionIterator::CompactionIterator(
     const std::atomic<int>* manual_compaction_paused,
     const std::atomic<bool>* manual_compaction_canceled,
     const std::shared_ptr<Logger> info_log,
-    const std::string* full_history_ts_low)
+    const std::string* full_history_ts_low,
+    BlobFileBuilder* cold_blob_file_builder)
     : CompactionIterator(
           input, cmp, merge_helper, last_sequence, snapshots,
           earliest_write_conflict_snapshot, snapshot_checker, env,
@@ -41,7 +185,7 @@ CompactionIterator::CompactionIterator(
               compaction ? new RealCompaction(compaction) : nullptr),
           compaction_filter, shutting_down, preserve_deletes_seqnum,
           manual_compaction_paused, manual_compaction_canceled, info_log,
-          full_history_ts_low) {}
+          full_history_ts_low, cold_blob_file_builder) {}
 
 CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
@@ -58,9 +202,19 @@ CompactionIterator::CompactionIterator(
     const std::atomic<int>* manual_compaction_paused,
     const std::atomic<bool>* manual_compaction_canceled,
     const std::shared_ptr<Logger> info_log,
-    const std::string* full_history_ts_low)
-    : input_(input, cmp,
-             !compaction || compaction->DoesInputReferenceBlobFiles()),
+    const std::string* full_history_ts_low,
+    BlobFileBuilder* cold_blob_file_builder)
+    : filter_batch_iter_(NewFilterBatchIterator(input, cmp, compaction_filter,
+                                                compaction.get(), env,
+                                                report_detailed_time)),
+      compress_ahead_iter_(filter_batch_iter_ == nullptr
+                               ? NewBlobCompressAheadIterator(
+                                     input, cmp, blob_file_builder)
+                               : nullptr),
+      input_(filter_batch_iter_ != nullptr     ? filter_batch_iter_.get()
+             : compress_ahead_iter_ != nullptr ? compress_ahead_iter_.get()
+                                               : input,
+             cmp, !compaction || compaction->DoesInputReferenceBlobFiles()),
       cmp_(cmp),
       merge_helper_(merge_helper),
       snapshots_(snapshots),
@@ -72,6 +226,7 @@ CompactionIterator::CompactionIterator(
       expect_valid_internal_key_(expect_valid_internal_key),
       range_del_agg_(range_del_agg),
       blob_file_builder_(blob_file_builder),
+      cold_blob_file_builder_(cold_blob_file_builder),
       compaction_(std::move(compaction)),
       compaction_filter_(compaction_filter),
       shutting_down_(shutting_down),
@@ -127,6 +282,34 @@ CompactionIterator::~CompactionIterator() {
   input_.SetPinnedItersMgr(nullptr);
 }
 
+FilterBatchIterator* CompactionIterator::NewFilterBatchIterator(
+    InternalIterator* input, const Comparator* cmp,
+    const CompactionFilter* compaction_filter,
+    const CompactionProxy* compaction, Env* env, bool report_detailed_time) {
+  // With user-defined timestamps, the filter is invoked on more than the
+  // newest version of a user key
+  if (compaction_filter == nullptr ||
+      compaction_filter->GetFilterBatchSize() == 0 ||
+      compaction_filter->IsStackedBlobDbInternalCompactionFilter() ||
+      cmp == nullptr || cmp->timestamp_size() > 0) {
+    return nullptr;
+  }
+  return new FilterBatchIterator(
+      input, cmp, compaction_filter,
+      compaction == nullptr ? 0 : compaction->level(),
+      env->GetSystemClock().get(), report_detailed_time);
+}
+
+BlobCompressAheadIterator* CompactionIterator::NewBlobCompressAheadIterator(
+    InternalIterator* input, const Comparator* cmp,
+    BlobFileBuilder* blob_file_builder) {
+  if (blob_file_builder == nullptr || !blob_file_builder->CanCompressAhead() ||
+      cmp == nullptr) {
+    return nullptr;
+  }
+  return new BlobCompressAheadIterator(input, cmp, blob_file_builder);
+}
+
 void CompactionIterator::ResetRecordCounts() {
   iter_stats_.num_record_drop_user = 0;
   iter_stats_.num_record_drop_hidden = 0;
@@ -190,6 +373,17 @@ void CompactionIterator::Next() {
   PrepareOutput();
 }
 
+void CompactionIterator::SkipCopied(const Slice& target) {
+  assert(!merge_out_iter_.Valid());
+  assert(!at_next_);
+  input_.Seek(target);
+  NextFromInput();
+  if (valid_) {
+    has_outputted_key_ = true;
+  }
+  PrepareOutput();
+}
+
 bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
                                               Slice* skip_until) {
   if (!compaction_filter_ ||
@@ -248,9 +442,13 @@ bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
         const Version* const version = compaction_->input_version();
         assert(version);
 
+        // Compactions read each blob once; keep them out of the blob cache
+        ReadOptions read_options;
+        read_options.fill_cache = false;
+        constexpr BlobPrefetcher* prefetcher = nullptr;
         uint64_t bytes_read = 0;
-        s = version->GetBlob(ReadOptions(), ikey_.user_key, blob_index,
-                             &blob_value_, &bytes_read);
+        s = version->GetBlob(read_options, ikey_.user_key, blob_index,
+                             prefetcher, &blob_value_, &bytes_read);
         if (!s.ok()) {
           status_ = s;
           valid_ = false;
@@ -263,7 +461,11 @@ bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
         value_type = CompactionFilter::ValueType::kValue;
       }
     }
-    if (CompactionFilter::Decision::kUndetermined == filter) {
+    if (CompactionFilter::Decision::kUndetermined == filter &&
+        (filter_batch_iter_ == nullptr ||
+         !filter_batch_iter_->TakeDecision(
+             &filter, &compaction_filter_value_,
+             compaction_filter_skip_until_.rep()))) {
       filter = compaction_filter_->FilterV2(
           level_, filter_key, value_type,
           blob_value_.empty() ? value_ : blob_value_, &compaction_filter_value_,
@@ -271,6 +473,9 @@ bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
     }
     iter_stats_.total_filter_time +=
         env_ != nullptr && report_detailed_time_ ? timer.ElapsedNanos() : 0;
+    if (filter_batch_iter_ != nullptr) {
+      iter_stats_.total_filter_time += filter_batch_iter_->TakeFilterTime();
+    }
   }
 
   if (CompactionFilter::Decision::kUndetermined == filter) {
@@ -809,13 +1014,14 @@ void CompactionIterator::NextFromInput() {
   }
 }
 
-bool CompactionIterator::ExtractLargeValueIfNeededImpl() {
-  if (!blob_file_builder_) {
+bool CompactionIterator::ExtractLargeValueIfNeededImpl(
+    BlobFileBuilder* blob_file_builder) {
+  if (!blob_file_builder) {
     return false;
   }
 
   blob_index_.clear();
-  const Status s = blob_file_builder_->Add(user_key(), value_, &blob_index_);
+  const Status s = blob_file_builder->Add(user_key(), value_, &blob_index_);
 
   if (!s.ok()) {
     status_ = s;
@@ -836,7 +1042,7 @@ bool CompactionIterator::ExtractLargeValueIfNeededImpl() {
 void CompactionIterator::ExtractLargeValueIfNeeded() {
   assert(ikey_.type == kTypeValue);
 
-  if (!ExtractLargeValueIfNeededImpl()) {
+  if (!ExtractLargeValueIfNeededImpl(blob_file_builder_)) {
     return;
   }
 
@@ -881,11 +1087,15 @@ void CompactionIterator::GarbageCollectBlobIfNeeded() {
     const Version* const version = compaction_->input_version();
     assert(version);
 
+    ReadOptions read_options;
+    read_options.fill_cache = false;
+    constexpr BlobPrefetcher* prefetcher = nullptr;
     uint64_t bytes_read = 0;
 
     {
-      const Status s = version->GetBlob(ReadOptions(), user_key(), blob_index,
-                                        &blob_value_, &bytes_read);
+      const Status s =
+          version->GetBlob(read_options, user_key(), blob_index, prefetcher,
+                           &blob_value_, &bytes_read);
 
       if (!s.ok()) {
         status_ = s;
@@ -900,7 +1110,9 @@ void CompactionIterator::GarbageCollectBlobIfNeeded() {
 
     value_ = blob_value_;
 
-    if (ExtractLargeValueIfNeededImpl()) {
+    if (ExtractLargeValueIfNeededImpl(cold_blob_file_builder_
+                                          ? cold_blob_file_builder_
+                                          : blob_file_builder_)) {
       return;
     }
 
@@ -992,6 +1204,11 @@ inline SequenceNumber CompactionIterator::findEarliestVisibleSnapshot(
     ROCKS_LOG_FATAL(info_log_,
                     "No snapshot left in findEarliestVisibleSnapshot");
   }
+  if (snapshot_checker_ == nullptr && stripe_valid_ && in >= stripe_lower_ &&
+      in <= stripe_upper_) {
+    *prev_snapshot = stripe_prev_snapshot_;
+    return stripe_upper_;
+  }
   auto snapshots_iter = std::lower_bound(
       snapshots_->begin(), snapshots_->end(), in);
   if (snapshots_iter == snapshots_->begin()) {
@@ -1005,8 +1222,13 @@ inline SequenceNumber CompactionIterator::findEarliestVisibleSnapshot(
     }
   }
   if (snapshot_checker_ == nullptr) {
-    return snapshots_iter != snapshots_->end()
-      ? *snapshots_iter : kMaxSequenceNumber;
+    stripe_valid_ = true;
+    stripe_lower_ =
+        snapshots_iter == snapshots_->begin() ? 0 : *prev_snapshot + 1;
+    stripe_upper_ = snapshots_iter != snapshots_->end() ? *snapshots_iter
+                                                        : kMaxSequenceNumber;
+    stripe_prev_snapshot_ = *prev_snapshot;
+    return stripe_upper_;
   }
   bool has_released_snapshot = !released_snapshots_.empty();
   for (; snapshots_iter != snapshots_->end(); ++snapshots_iter) {
@@ -69,6 +69,131 @@ class SequenceIterWrapper : public InternalIterator {
   bool need_count_entries_;
 };
 
+// A wrapper of the compaction input that reads CompactionFilter::
+// GetFilterBatchSize() entries ahead at a time, and has the compaction filter
+// decide with FilterBatch() on the values among them that are the newest
+// version of their user key, the ones CompactionIterator invokes the filter
+// on in the absence of snapshot checkers. The entries are copied.
+//
+// REQUIRES: the input is positioned when the wrapper is created, and only
+// moves forward.
+class FilterBatchIterator : public InternalIterator {
+ public:
+  FilterBatchIterator(InternalIterator* iter, const Comparator* cmp,
+                      const CompactionFilter* compaction_filter, int level,
+                      SystemClock* clock, bool report_detailed_time);
+
+  bool Valid() const override { return pos_ < entries_.size(); }
+  Status status() const override { return iter_->status(); }
+  void Next() override;
+  void Seek(const Slice& target) override;
+  Slice key() const override {
+    assert(Valid());
+    return entries_[pos_].key;
+  }
+  Slice value() const override {
+    assert(Valid());
+    return entries_[pos_].value;
+  }
+
+  // Unused InternalIterator methods
+  void SeekToFirst() override { assert(false); }
+  void Prev() override { assert(false); }
+  void SeekForPrev(const Slice& /* target */) override { assert(false); }
+  void SeekToLast() override { assert(false); }
+
+  // If FilterBatch() decided on the current entry, moves the decision and
+  // its results out and returns true.
+  bool TakeDecision(CompactionFilter::Decision* decision,
+                    std::string* new_value, std::string* skip_until);
+
+  // Returns the time spent in FilterBatch() since the last call, if
+  // report_detailed_time.
+  uint64_t TakeFilterTime() {
+    uint64_t nanos = filter_time_;
+    filter_time_ = 0;
+    return nanos;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    // Index in batch_, or -1 if FilterBatch() did not decide on it
+    int batch_index = -1;
+  };
+
+  // Reads the next batch of entries from `iter_` and has the filter decide
+  // on them.
+  void Fill();
+
+  InternalIterator* iter_;  // not owned
+  InternalKeyComparator icmp_;
+  const CompactionFilter* compaction_filter_;
+  const int level_;
+  SystemClock* clock_;
+  const bool report_detailed_time_;
+  const size_t batch_size_;
+
+  std::vector<Entry> entries_;
+  size_t pos_ = 0;
+  std::vector<CompactionFilter::BatchEntry> batch_;
+  // The user key of the last entry of the previous batch, if it was read
+  // right before this one
+  std::string prev_user_key_;
+  bool has_prev_user_key_ = false;
+  uint64_t filter_time_ = 0;
+};
+
+// A wrapper of the compaction input that reads up to
+// BlobFileBuilder::MaxCompressAhead() entries ahead, and passes the values of
+// the plain values among them to BlobFileBuilder::CompressAhead(), so that
+// they are compressed on the builder's threads by the time they are written
+// to a blob file. The entries are copied.
+//
+// REQUIRES: the input is positioned when the wrapper is created, and only
+// moves forward.
+class BlobCompressAheadIterator : public InternalIterator {
+ public:
+  BlobCompressAheadIterator(InternalIterator* iter, const Comparator* cmp,
+                            BlobFileBuilder* blob_file_builder);
+
+  bool Valid() const override { return !entries_.empty(); }
+  Status status() const override { return iter_->status(); }
+  void Next() override;
+  void Seek(const Slice& target) override;
+  Slice key() const override {
+    assert(Valid());
+    return entries_.front().key;
+  }
+  Slice value() const override {
+    assert(Valid());
+    return entries_.front().value;
+  }
+
+  // Unused InternalIterator methods
+  void SeekToFirst() override { assert(false); }
+  void Prev() override { assert(false); }
+  void SeekForPrev(const Slice& /* target */) override { assert(false); }
+  void SeekToLast() override { assert(false); }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+  };
+
+  // Reads entries from `iter_` until the window is full
+  void Fill();
+
+  InternalIterator* iter_;  // not owned
+  InternalKeyComparator icmp_;
+  BlobFileBuilder* blob_file_builder_;
+  const size_t max_entries_;
+
+  std::deque<Entry> entries_;
+};
+
 class CompactionIterator {
  public:
   // A wrapper around Compaction. Has a much smaller interface, only what
@@ -171,7 +296,8 @@ class CompactionIterator {
       const std::atomic<int>* manual_compaction_paused = nullptr,
       const std::atomic<bool>* manual_compaction_canceled = nullptr,
       const std::shared_ptr<Logger> info_log = nullptr,
-      const std::string* full_history_ts_low = nullptr);
+      const std::string* full_history_ts_low = nullptr,
+      BlobFileBuilder* cold_blob_file_builder = nullptr);
 
   // Constructor with custom CompactionProxy, used for tests.
   CompactionIterator(
@@ -189,7 +315,8 @@ class CompactionIterator {
       const std::atomic<int>* manual_compaction_paused = nullptr,
       const std::atomic<bool>* manual_compaction_canceled = nullptr,
       const std::shared_ptr<Logger> info_log = nullptr,
-      const std::string* full_history_ts_low = nullptr);
+      const std::string* full_history_ts_low = nullptr,
+      BlobFileBuilder* cold_blob_file_builder = nullptr);
 
   ~CompactionIterator();
 
@@ -205,6 +332,14 @@ class CompactionIterator {
   // REQUIRED: SeekToFirst() has been called.
   void Next();
 
+  // Produces the first record at or after the input key `target`, skipping
+  // the input before it. The caller has output the current record and the
+  // skipped ones itself, which must be what the iterator would have output.
+  //
+  // REQUIRED: the current record was read from the input unchanged, and the
+  // input is still positioned at it.
+  void SkipCopied(const Slice& target);
+
   // Getters
   const Slice& key() const { return key_; }
   const Slice& value() const { return value_; }
@@ -222,11 +357,11 @@ class CompactionIterator {
   // Do final preparations before presenting the output to the callee.
   void PrepareOutput();
 
-  // Passes the output value to the blob file builder (if any), and replaces it
-  // with the corresponding blob reference if it has been actually written to a
-  // blob file (i.e. if it passed the value size check). Returns true if the
-  // value got extracted to a blob file, false otherwise.
-  bool ExtractLargeValueIfNeededImpl();
+  // Passes the output value to the given blob file builder (if any), and
+  // replaces it with the corresponding blob reference if it has been actually
+  // written to a blob file (i.e. if it passed the value size check). Returns
+  // true if the value got extracted to a blob file, false otherwise.
+  bool ExtractLargeValueIfNeededImpl(BlobFileBuilder* blob_file_builder);
 
   // Extracts large values as described above, and updates the internal key's
   // type to kTypeBlobIndex if the value got extracted. Should only be called
@@ -251,8 +386,6 @@ class CompactionIterator {
   // earliest snapshot that this sequence number is visible in.
   // The snapshots themselves are arranged in ascending order of
   // sequence numbers.
-  // Employ a sequential search because the total number of
-  // snapshots are typically small.
   inline SequenceNumber findEarliestVisibleSnapshot(
       SequenceNumber in, SequenceNumber* prev_snapshot);
 
@@ -292,6 +425,24 @@ class CompactionIterator {
   static uint64_t ComputeBlobGarbageCollectionCutoffFileNumber(
       const CompactionProxy* compaction);
 
+  // Returns a FilterBatchIterator over `input` if `compaction_filter` asks
+  // for batches and they can be used, or nullptr.
+  static FilterBatchIterator* NewFilterBatchIterator(
+      InternalIterator* input, const Comparator* cmp,
+      const CompactionFilter* compaction_filter,
+      const CompactionProxy* compaction, Env* env, bool report_detailed_time);
+
+  // Returns a BlobCompressAheadIterator over `input` if `blob_file_builder`
+  // compresses blobs on worker threads, or nullptr.
+  static BlobCompressAheadIterator* NewBlobCompressAheadIterator(
+      InternalIterator* input, const Comparator* cmp,
+      BlobFileBuilder* blob_file_builder);
+
+  // Wraps the input given to the constructor if not nullptr
+  std::unique_ptr<FilterBatchIterator> filter_batch_iter_;
+  // Wraps the input given to the constructor if not nullptr and there is no
+  // filter_batch_iter_
+  std::unique_ptr<BlobCompressAheadIterator> compress_ahead_iter_;
   SequenceIterWrapper input_;
   const Comparator* cmp_;
   MergeHelper* merge_helper_;
@@ -311,6 +462,8 @@ class CompactionIterator {
   bool expect_valid_internal_key_;
   CompactionRangeDelAggregator* range_del_agg_;
   BlobFileBuilder* blob_file_builder_;
+  // Where blobs relocated by garbage collection go, if not with the others
+  BlobFileBuilder* cold_blob_file_builder_;
   std::unique_ptr<CompactionProxy> compaction_;
   const CompactionFilter* compaction_filter_;
   const std::atomic<bool>* shutting_down_;
@@ -322,6 +475,14 @@ class CompactionIterator {
   bool visible_at_tip_;
   SequenceNumber earliest_snapshot_;
   SequenceNumber latest_snapshot_;
+  // The sequence numbers [stripe_lower_, stripe_upper_] between two adjacent
+  // snapshots that the last findEarliestVisibleSnapshot() fell into, with
+  // its results. Neighbouring keys, like the bulk of the old data among many
+  // snapshots, mostly fall into the same stripe, which saves the search.
+  bool stripe_valid_ = false;
+  SequenceNumber stripe_lower_ = 0;
+  SequenceNumber stripe_upper_ = 0;
+  SequenceNumber stripe_prev_snapshot_ = 0;
 
   std::shared_ptr<Logger> info_log_;
 
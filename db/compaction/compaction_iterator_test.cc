@@ -529,6 +529,71 @@ TEST_P(CompactionIteratorTest, CompactionFilterSkipUntil) {
   ASSERT_EQ(expected_actions, iter_->log);
 }
 
+TEST_P(CompactionIteratorTest, CompactionFilterBatch) {
+  class Filter : public CompactionFilter {
+   public:
+    size_t GetFilterBatchSize() const override { return 3; }
+
+    void FilterBatch(int /*level*/,
+                     std::vector<BatchEntry>* entries) const override {
+      batches.emplace_back();
+      for (BatchEntry& entry : *entries) {
+        std::string k = entry.key.ToString();
+        batches.back().push_back(k);
+        EXPECT_EQ(ValueType::kValue, entry.value_type);
+        EXPECT_EQ(k + "v", entry.existing_value.ToString().substr(0, 2));
+        if (k == "b") {
+          entry.decision = Decision::kRemove;
+        } else if (k == "c") {
+          entry.decision = Decision::kChangeValue;
+          entry.new_value = "new";
+        } else if (k == "d") {
+          entry.decision = Decision::kRemoveAndSkipUntil;
+          entry.skip_until = "f+";
+        } else {
+          entry.decision = Decision::kKeep;
+        }
+      }
+    }
+
+    Decision FilterV2(int /*level*/, const Slice& /*key*/, ValueType /*t*/,
+                      const Slice& /*existing_value*/,
+                      std::string* /*new_value*/,
+                      std::string* /*skip_until*/) const override {
+      ADD_FAILURE();
+      return Decision::kKeep;
+    }
+
+    const char* Name() const override {
+      return "CompactionIteratorTest.CompactionFilterBatch::Filter";
+    }
+
+    mutable std::vector<std::vector<std::string>> batches;
+  };
+
+  Filter filter;
+  RunTest({test::KeyStr("a", 50, kTypeValue),
+           test::KeyStr("a", 40, kTypeValue),
+           test::KeyStr("b", 60, kTypeValue),  // remove
+           test::KeyStr("c", 55, kTypeValue),  // change value
+           test::KeyStr("d", 45, kTypeValue),  // skip to "f+"
+           test::KeyStr("e", 30, kTypeValue), test::KeyStr("f", 20, kTypeValue),
+           test::KeyStr("g", 10, kTypeValue)},
+          {"av50", "av40", "bv60", "cv55", "dv45", "ev30", "fv20", "gv10"},
+          {test::KeyStr("a", 50, kTypeValue),
+           test::KeyStr("b", 60, kTypeDeletion),
+           test::KeyStr("c", 55, kTypeValue),
+           test::KeyStr("g", 10, kTypeValue)},
+          {"av50", "", "new", "gv10"}, kMaxSequenceNumber /*last_commited_seq*/,
+          nullptr /*merge_operator*/, &filter);
+
+  // Each batch of three input entries has the newest version of each user
+  // key decided on
+  std::vector<std::vector<std::string>> expected_batches = {
+      {"a", "b"}, {"c", "d", "e"}, {"g"}};
+  ASSERT_EQ(expected_batches, filter.batches);
+}
+
 TEST_P(CompactionIteratorTest, ShuttingDownInFilter) {
   NoMergingMergeOp merge_op;
   StallingFilter filter;
@@ -10,10 +10,15 @@
 #include "db/compaction/compaction_job.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <set>
 #include <thread>
@@ -26,6 +31,7 @@
 #include "db/blob/blob_garbage_meter.h"
 #include "db/builder.h"
 #include "db/compaction/clipping_iterator.h"
+#include "db/compaction/compaction_block_copier.h"
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
@@ -39,6 +45,7 @@
 #include "db/merge_helper.h"
 #include "db/output_validator.h"
 #include "db/range_del_aggregator.h"
+#include "db/range_tombstone_fragmenter.h"
 #include "db/version_set.h"
 #include "file/filename.h"
 #include "file/read_write_util.h"
@@ -107,6 +114,12 @@ const char* GetCompactionReasonString(CompactionReason compaction_reason) {
       return "ExternalSstIngestion";
     case CompactionReason::kPeriodicCompaction:
       return "PeriodicCompaction";
+    case CompactionReason::kForcedBlobGC:
+      return "ForcedBlobGC";
+    case CompactionReason::kChangeTemperature:
+      return "ChangeTemperature";
+    case CompactionReason::kFIFOTimeWindow:
+      return "FIFOTimeWindow";
     case CompactionReason::kNumOfReasons:
       // fall through
     default:
@@ -153,6 +166,24 @@ struct CompactionJob::SubcompactionState {
   std::unique_ptr<WritableFileWriter> outfile;
   std::unique_ptr<TableBuilder> builder;
 
+  // A finished output file being synced and closed on a helper thread while
+  // the following ones are built (pipelined_compaction_io). Up to
+  // kMaxPendingCloses files are synced at a time, so a compaction producing
+  // many files does not wait for each fsync in turn.
+  static const size_t kMaxPendingCloses = 8;
+  struct PendingClose {
+    std::unique_ptr<WritableFileWriter> file;
+    // Index into outputs, which may grow before the close completes
+    size_t output_index = 0;
+    uint64_t num_entries = 0;
+    uint64_t file_size = 0;
+    TableProperties table_properties;
+    IOStatus io_status;
+    port::Thread thread;
+  };
+  // Oldest first
+  std::deque<std::unique_ptr<PendingClose>> pending_closes;
+
   Output* current_output() {
     if (outputs.empty()) {
       // This subcompaction's output could be empty if compaction was aborted
@@ -180,6 +211,9 @@ struct CompactionJob::SubcompactionState {
   uint64_t overlapped_bytes = 0;
   // A flag determine whether the key has been seen in ShouldStopBefore()
   bool seen_key = false;
+  // The number of grandparent file boundaries the current output spans, used
+  // in ShouldStopBefore() with level_compaction_dynamic_file_size.
+  size_t grandparent_boundaries_crossed = 0;
   // sub compaction job id, which is used to identify different sub-compaction
   // within the same compaction job.
   const uint32_t sub_job_id;
@@ -216,12 +250,14 @@ struct CompactionJob::SubcompactionState {
     const std::vector<FileMetaData*>& grandparents = compaction->grandparents();
 
     // Scan to find earliest grandparent file that contains key.
+    size_t num_boundaries = 0;
     while (grandparent_index < grandparents.size() &&
            icmp->Compare(internal_key,
                          grandparents[grandparent_index]->largest.Encode()) >
                0) {
       if (seen_key) {
         overlapped_bytes += grandparents[grandparent_index]->fd.GetFileSize();
+        num_boundaries++;
       }
       assert(grandparent_index + 1 >= grandparents.size() ||
              icmp->Compare(
@@ -235,9 +271,25 @@ struct CompactionJob::SubcompactionState {
         compaction->max_compaction_bytes()) {
       // Too much overlap for current output; start new output
       overlapped_bytes = 0;
+      grandparent_boundaries_crossed = 0;
       return true;
     }
 
+    if (num_boundaries > 0 &&
+        compaction->mutable_cf_options()->level_compaction_dynamic_file_size) {
+      // The key is past the end of a grandparent file the output overlaps.
+      // Cut here if the output is large enough, the more boundaries it spans
+      // the closer to its target size.
+      grandparent_boundaries_crossed += num_boundaries;
+      uint64_t percent =
+          50 + std::min(grandparent_boundaries_crossed * 5, size_t{40});
+      if (curr_file_size >= compaction->max_output_file_size() / 100 * percent) {
+        overlapped_bytes = 0;
+        grandparent_boundaries_crossed = 0;
+        return true;
+      }
+    }
+
     return false;
   }
 
@@ -480,6 +532,114 @@ struct RangeWithSize {
       : range(a, b), size(s) {}
 };
 
+void CompactionJob::SkipInputFilesCoveredByRangeTombstones() {
+  Compaction* c = compact_->compaction;
+  ColumnFamilyData* cfd = c->column_family_data();
+  const InternalKeyComparator& icmp = cfd->internal_comparator();
+  const Comparator* ucmp = icmp.user_comparator();
+  // Compaction filters see keys before range tombstones are applied, and
+  // snapshot checkers make visibility depend on more than sequence numbers.
+  if (ucmp->timestamp_size() > 0 || snapshot_checker_ != nullptr ||
+      cfd->ioptions()->compaction_filter != nullptr ||
+      cfd->ioptions()->compaction_filter_factory != nullptr) {
+    return;
+  }
+
+  struct TombstoneSource {
+    const FileMetaData* file;
+    // Owns the tombstones (and the table cache handle) the stripes refer to.
+    std::unique_ptr<FragmentedRangeTombstoneIterator> iter;
+    std::map<SequenceNumber, std::unique_ptr<FragmentedRangeTombstoneIterator>>
+        stripes;
+  };
+  std::vector<TombstoneSource> sources;
+  std::vector<const FileMetaData*> candidates;
+  ReadOptions read_options;
+  read_options.verify_checksums = true;
+  read_options.fill_cache = false;
+  for (size_t which = 0; which < c->num_input_levels(); which++) {
+    for (const FileMetaData* f : *c->inputs(which)) {
+      std::unique_ptr<FragmentedRangeTombstoneIterator> iter;
+      Status s = cfd->table_cache()->GetRangeTombstoneIterator(
+          read_options, icmp, *f, &iter);
+      if (!s.ok()) {
+        // Let the compaction itself run into the error.
+        return;
+      }
+      if (iter != nullptr) {
+        auto stripes = iter->SplitBySnapshot(existing_snapshots_);
+        sources.push_back({f, std::move(iter), std::move(stripes)});
+      } else if (f->oldest_blob_file_number == kInvalidBlobFileNumber) {
+        // Skipping files that reference blobs would skew the garbage
+        // accounting of those blob files.
+        candidates.push_back(f);
+      }
+    }
+  }
+  if (sources.empty() || candidates.empty()) {
+    return;
+  }
+
+  // Whether all keys of `f` are deleted by visible tombstones in `source`
+  // that are newer than them and in the same snapshot stripe.
+  auto covers = [&](const TombstoneSource& source, const FileMetaData* f) {
+    // Tombstones only apply within their file's boundaries during compaction.
+    if (icmp.Compare(source.file->smallest, f->smallest) > 0 ||
+        ucmp->Compare(f->largest.user_key(),
+                      source.file->largest.user_key()) >= 0) {
+      return false;
+    }
+    auto stripe = source.stripes.lower_bound(f->fd.smallest_seqno);
+    if (stripe == source.stripes.end() ||
+        stripe->second->lower_bound() > f->fd.smallest_seqno ||
+        stripe->first < f->fd.largest_seqno) {
+      return false;
+    }
+    FragmentedRangeTombstoneIterator* iter = stripe->second.get();
+    iter->Seek(f->smallest.user_key());
+    if (!iter->Valid() ||
+        ucmp->Compare(iter->start_key(), f->smallest.user_key()) > 0) {
+      return false;
+    }
+    while (iter->seq() > f->fd.largest_seqno) {
+      Slice end_key = iter->end_key();
+      if (ucmp->Compare(f->largest.user_key(), end_key) < 0) {
+        return true;
+      }
+      iter->Next();
+      if (!iter->Valid() || ucmp->Compare(iter->start_key(), end_key) != 0) {
+        return false;
+      }
+    }
+    return false;
+  };
+
+  std::unordered_set<uint64_t> covered_files;
+  uint64_t covered_bytes = 0;
+  for (const FileMetaData* f : candidates) {
+    for (const auto& source : sources) {
+      if (covers(source, f)) {
+        covered_files.insert(f->fd.GetNumber());
+        covered_bytes += f->fd.GetFileSize();
+        break;
+      }
+    }
+  }
+  TEST_SYNC_POINT_CALLBACK(
+      "CompactionJob::SkipInputFilesCoveredByRangeTombstones:NumFiles",
+      &covered_files);
+  if (covered_files.empty()) {
+    return;
+  }
+  c->SkipInputFiles(covered_files);
+  ROCKS_LOG_INFO(db_options_.info_log,
+                 "[%s] [JOB %d] Dropping %" ROCKSDB_PRIszt
+                 " input files (%" PRIu64
+                 " bytes) covered by range tombstones without reading them",
+                 cfd->GetName().c_str(), job_id_, covered_files.size(),
+                 covered_bytes);
+}
+
 void CompactionJob::GenSubcompactionBoundaries() {
   auto* c = compact_->compaction;
   auto* cfd = c->column_family_data();
@@ -509,33 +669,32 @@ void CompactionJob::GenSubcompactionBoundaries() {
         }
       } else {
         // For all other levels add the smallest/largest key in the level to
-        // encompass the range covered by that level
+        // encompass the range covered by that level, and the starting keys
+        // of all files. Since the level is range partitioned, the ending key
+        // of one file and the starting key of the next are very close (or
+        // identical).
         bounds.emplace_back(flevel->files[0].smallest_key);
         bounds.emplace_back(flevel->files[num_files - 1].largest_key);
-        if (lvl == out_lvl) {
-          // For the last level include the starting keys of all files since
-          // the last level is the largest and probably has the widest key
-          // range. Since it's range partitioned, the ending key of one file
-          // and the starting key of the next are very close (or identical).
-          for (size_t i = 1; i < num_files; i++) {
-            bounds.emplace_back(flevel->files[i].smallest_key);
-          }
+        for (size_t i = 1; i < num_files; i++) {
+          bounds.emplace_back(flevel->files[i].smallest_key);
         }
       }
     }
   }
 
+  // Versions of a user key that differ only by timestamp must be processed by
+  // the same subcompaction, so bounds are compared without timestamps
   std::sort(bounds.begin(), bounds.end(),
             [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-              return cfd_comparator->Compare(ExtractUserKey(a),
-                                             ExtractUserKey(b)) < 0;
+              return cfd_comparator->CompareWithoutTimestamp(
+                         ExtractUserKey(a), ExtractUserKey(b)) < 0;
             });
   // Remove duplicated entries from bounds
   bounds.erase(
       std::unique(bounds.begin(), bounds.end(),
                   [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-                    return cfd_comparator->Compare(ExtractUserKey(a),
-                                                   ExtractUserKey(b)) == 0;
+                    return cfd_comparator->CompareWithoutTimestamp(
+                               ExtractUserKey(a), ExtractUserKey(b)) == 0;
                   }),
       bounds.end());
 
@@ -596,7 +755,18 @@ void CompactionJob::GenSubcompactionBoundaries() {
         continue;
       }
       if (sum >= mean) {
-        boundaries_.emplace_back(ExtractUserKey(ranges[i].range.limit));
+        Slice boundary = ExtractUserKey(ranges[i].range.limit);
+        size_t ts_sz = cfd_comparator->timestamp_size();
+        if (ts_sz > 0) {
+          // The boundary is the first version of its user key, the one with
+          // the maximum timestamp
+          boundary_keys_.emplace_back();
+          AppendKeyWithMaxTimestamp(&boundary_keys_.back(),
+                                    StripTimestampFromUserKey(boundary, ts_sz),
+                                    ts_sz);
+          boundary = boundary_keys_.back();
+        }
+        boundaries_.emplace_back(boundary);
         sizes_.emplace_back(sum);
         subcompactions--;
         sum = 0;
@@ -612,10 +782,14 @@ void CompactionJob::GenSubcompactionBoundaries() {
 Status CompactionJob::Run() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_RUN);
+  // Also covers CompactFiles(), which runs on the calling thread
+  IOActivityGuard io_activity(IOActivity::kCompaction);
   TEST_SYNC_POINT("CompactionJob::Run():Start");
   log_buffer_->FlushBufferToLog();
   LogCompaction();
 
+  SkipInputFilesCoveredByRangeTombstones();
+
   const size_t num_threads = compact_->sub_compact_states.size();
   assert(num_threads > 0);
   const uint64_t start_micros = db_options_.clock->NowMicros();
@@ -911,7 +1085,9 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
     stream << "file_fsync_nanos" << compaction_job_stats_->file_fsync_nanos;
     stream << "file_prepare_write_nanos"
            << compaction_job_stats_->file_prepare_write_nanos;
+    stream << "file_read_nanos" << compaction_job_stats_->file_read_nanos;
   }
+  stream << "file_read_bytes" << compaction_job_stats_->file_read_bytes;
 
   stream << "lsm_state";
   stream.StartArray();
@@ -930,7 +1106,8 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
 }
 
 #ifndef ROCKSDB_LITE
-void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
+CompactionServiceJobStatus
+CompactionJob::ProcessKeyValueCompactionWithCompactionService(
     SubcompactionState* sub_compact) {
   assert(sub_compact);
   assert(sub_compact->compaction);
@@ -940,10 +1117,21 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
   CompactionServiceInput compaction_input;
   compaction_input.output_level = compaction->output_level();
 
+  // A subcompaction's job only needs the files overlapping its key range,
+  // so that its worker reads no more than its share of the input
+  const Comparator* ucmp = compaction->column_family_data()->user_comparator();
   const std::vector<CompactionInputFiles>& inputs =
       *(compact_->compaction->inputs());
   for (const auto& files_per_level : inputs) {
     for (const auto& file : files_per_level.files) {
+      if ((sub_compact->start != nullptr &&
+           ucmp->CompareWithoutTimestamp(file->largest.user_key(),
+                                         *sub_compact->start) < 0) ||
+          (sub_compact->end != nullptr &&
+           ucmp->CompareWithoutTimestamp(file->smallest.user_key(),
+                                         *sub_compact->end) >= 0)) {
+        continue;
+      }
       compaction_input.input_files.emplace_back(
           MakeTableFileName(file->fd.GetNumber()));
     }
@@ -967,7 +1155,7 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
   Status s = compaction_input.Write(&compaction_input_binary);
   if (!s.ok()) {
     sub_compact->status = s;
-    return;
+    return CompactionServiceJobStatus::kFailure;
   }
 
   std::ostringstream input_files_oss;
@@ -985,15 +1173,29 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
   CompactionServiceJobStatus compaction_status =
       db_options_.compaction_service->Start(compaction_input_binary,
                                             GetCompactionId(sub_compact));
+  if (compaction_status == CompactionServiceJobStatus::kUseLocal) {
+    ROCKS_LOG_INFO(db_options_.info_log,
+                   "[%s] [JOB %d] Remote compaction not started, running it "
+                   "locally",
+                   compaction_input.column_family.name.c_str(), job_id_);
+    return compaction_status;
+  }
   if (compaction_status != CompactionServiceJobStatus::kSuccess) {
     sub_compact->status =
         Status::Incomplete("CompactionService failed to start compaction job.");
-    return;
+    return compaction_status;
   }
 
   std::string compaction_result_binary;
-  compaction_status = db_options_.compaction_service->WaitForComplete(
-      GetCompactionId(sub_compact), &compaction_result_binary);
+  compaction_status = WaitForCompactionService(GetCompactionId(sub_compact),
+                                               &compaction_result_binary);
+  if (compaction_status == CompactionServiceJobStatus::kUseLocal) {
+    ROCKS_LOG_WARN(db_options_.info_log,
+                   "[%s] [JOB %d] Remote compaction abandoned, running it "
+                   "locally",
+                   compaction_input.column_family.name.c_str(), job_id_);
+    return compaction_status;
+  }
 
   CompactionServiceResult compaction_result;
   s = CompactionServiceResult::Read(compaction_result_binary,
@@ -1008,13 +1210,13 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
                    "[%s] [JOB %d] Remote compaction failed, status: %s",
                    compaction_input.column_family.name.c_str(), job_id_,
                    s.ToString().c_str());
-    return;
+    return CompactionServiceJobStatus::kFailure;
   }
 
   if (!s.ok()) {
     sub_compact->status = s;
     compaction_result.status.PermitUncheckedError();
-    return;
+    return CompactionServiceJobStatus::kFailure;
   }
   sub_compact->status = compaction_result.status;
 
@@ -1034,7 +1236,7 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
 
   if (!s.ok()) {
     sub_compact->status = s;
-    return;
+    return CompactionServiceJobStatus::kFailure;
   }
 
   for (const auto& file : compaction_result.output_files) {
@@ -1045,7 +1247,7 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
     s = fs_->RenameFile(src_file, tgt_file, IOOptions(), nullptr);
     if (!s.ok()) {
       sub_compact->status = s;
-      return;
+      return CompactionServiceJobStatus::kFailure;
     }
 
     FileMetaData meta;
@@ -1053,7 +1255,7 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
     s = fs_->GetFileSize(tgt_file, IOOptions(), &file_size, nullptr);
     if (!s.ok()) {
       sub_compact->status = s;
-      return;
+      return CompactionServiceJobStatus::kFailure;
     }
     meta.fd = FileDescriptor(file_num, compaction->output_path_id(), file_size,
                              file.smallest_seqno, file.largest_seqno);
@@ -1074,16 +1276,93 @@ void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
   sub_compact->total_bytes = compaction_result.total_bytes;
   IOSTATS_ADD(bytes_written, compaction_result.bytes_written);
   IOSTATS_ADD(bytes_read, compaction_result.bytes_read);
+  return CompactionServiceJobStatus::kSuccess;
+}
+
+CompactionServiceJobStatus CompactionJob::WaitForCompactionService(
+    uint64_t job_id, std::string* compaction_service_result) {
+  CompactionService* service = db_options_.compaction_service.get();
+  const uint64_t timeout_us = db_options_.compaction_service_timeout_ms * 1000;
+  if (timeout_us == 0) {
+    return service->WaitForComplete(job_id, compaction_service_result);
+  }
+
+  // Wait on a helper thread, and poll the job's progress meanwhile
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  CompactionServiceJobStatus status = CompactionServiceJobStatus::kFailure;
+  port::Thread waiter([&]() {
+    CompactionServiceJobStatus s =
+        service->WaitForComplete(job_id, compaction_service_result);
+    std::lock_guard<std::mutex> lock(mutex);
+    status = s;
+    done = true;
+    cv.notify_all();
+  });
+
+  const std::chrono::microseconds poll_interval(
+      std::min(std::max(timeout_us / 10, uint64_t{1000}), uint64_t{1000000}));
+  CompactionServiceJobProgress last_progress;
+  uint64_t last_progress_micros = db_options_.clock->NowMicros();
+  bool timed_out = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!cv.wait_for(lock, poll_interval, [&] { return done; })) {
+      lock.unlock();
+      CompactionServiceJobProgress progress;
+      Status s = service->GetProgress(job_id, &progress);
+      const uint64_t now = db_options_.clock->NowMicros();
+      if (s.ok() && (progress.bytes_read != last_progress.bytes_read ||
+                     progress.bytes_written != last_progress.bytes_written)) {
+        last_progress = progress;
+        last_progress_micros = now;
+        ThreadStatusUtil::SetThreadOperationProperty(
+            ThreadStatus::COMPACTION_BYTES_READ, progress.bytes_read);
+        ThreadStatusUtil::SetThreadOperationProperty(
+            ThreadStatus::COMPACTION_BYTES_WRITTEN, progress.bytes_written);
+      }
+      lock.lock();
+      if (!done && now - last_progress_micros >= timeout_us) {
+        timed_out = true;
+        break;
+      }
+    }
+  }
+
+  if (timed_out) {
+    ROCKS_LOG_WARN(db_options_.info_log,
+                   "[JOB %d] Remote compaction %" PRIu64
+                   " made no progress for %" PRIu64 " ms, cancelling it",
+                   job_id_, job_id, db_options_.compaction_service_timeout_ms);
+    service->Cancel(job_id);
+  }
+  waiter.join();
+  return timed_out ? CompactionServiceJobStatus::kUseLocal : status;
 }
 #endif  // !ROCKSDB_LITE
 
+namespace {
+// Subcompactions of all DBs in the process that are reading their input, and
+// share DBOptions::max_compaction_readahead_size
+std::atomic<size_t> num_subcompactions_reading{0};
+}  // namespace
+
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
+  // Subcompactions run on threads of their own
+  IOActivityGuard io_activity(IOActivity::kCompaction);
   assert(sub_compact);
   assert(sub_compact->compaction);
 
 #ifndef ROCKSDB_LITE
   if (db_options_.compaction_service) {
-    return ProcessKeyValueCompactionWithCompactionService(sub_compact);
+    CompactionServiceJobStatus comp_status =
+        ProcessKeyValueCompactionWithCompactionService(sub_compact);
+    if (comp_status != CompactionServiceJobStatus::kUseLocal) {
+      return;
+    }
+    // Fall back to local compaction
+    assert(sub_compact->status.ok());
   }
 #endif  // !ROCKSDB_LITE
 
@@ -1122,12 +1401,34 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // (a) concurrent compactions,
   // (b) CompactionFilter::Decision::kRemoveAndSkipUntil.
   read_options.total_order_seek = true;
-
-  // Note: if we're going to support subcompactions for user-defined timestamps,
-  // the timestamp part will have to be stripped from the bounds here.
-  assert((!start && !end) || cfd->user_comparator()->timestamp_size() == 0);
-  read_options.iterate_lower_bound = start;
-  read_options.iterate_upper_bound = end;
+  // Have the input files' prefetch buffers read the next readahead window
+  // while the current one is being merged.
+  read_options.async_io = db_options_.pipelined_compaction_io;
+  // For compaction, readahead_size is how far the input files' readahead
+  // grows from compaction_readahead_size as they are read sequentially.
+  const size_t num_reading = num_subcompactions_reading.fetch_add(1) + 1;
+  const size_t compaction_readahead_size =
+      file_options_for_read_.compaction_readahead_size;
+  if (compaction_readahead_size > 0 &&
+      mutable_db_options_copy_.max_compaction_readahead_size >
+          compaction_readahead_size) {
+    read_options.readahead_size = std::max(
+        compaction_readahead_size,
+        mutable_db_options_copy_.max_compaction_readahead_size / num_reading);
+  }
+
+  // Iterate bounds are user keys without timestamp
+  const size_t ts_sz = cfd->user_comparator()->timestamp_size();
+  Slice start_without_ts;
+  Slice end_without_ts;
+  if (start) {
+    start_without_ts = StripTimestampFromUserKey(*start, ts_sz);
+    read_options.iterate_lower_bound = &start_without_ts;
+  }
+  if (end) {
+    end_without_ts = StripTimestampFromUserKey(*end, ts_sz);
+    read_options.iterate_upper_bound = &end_without_ts;
+  }
 
   // Although the v2 aggregator is what the level iterator(s) know about,
   // the AddTombstones calls will be propagated down to the v1 aggregator.
@@ -1181,6 +1482,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   uint64_t prev_prepare_write_nanos = 0;
   uint64_t prev_cpu_write_nanos = 0;
   uint64_t prev_cpu_read_nanos = 0;
+  uint64_t prev_read_nanos = 0;
+  const uint64_t prev_bytes_read = IOSTATS(bytes_read);
   if (measure_io_stats_) {
     prev_perf_level = GetPerfLevel();
     SetPerfLevel(PerfLevel::kEnableTimeAndCPUTimeExceptForMutex);
@@ -1190,6 +1493,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     prev_prepare_write_nanos = IOSTATS(prepare_write_nanos);
     prev_cpu_write_nanos = IOSTATS(cpu_write_nanos);
     prev_cpu_read_nanos = IOSTATS(cpu_read_nanos);
+    prev_read_nanos = IOSTATS(read_nanos);
   }
 
   MergeHelper merge(
@@ -1216,6 +1520,28 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
                                 &sub_compact->blob_file_additions)
           : nullptr);
 
+  // Blobs relocated by garbage collection are written to their own files, of
+  // the cold blob file size and temperature
+  MutableCFOptions cold_blob_cf_options = *mutable_cf_options;
+  cold_blob_cf_options.blob_file_size = mutable_cf_options->cold_blob_file_size;
+  FileOptions cold_blob_file_options = file_options_;
+  cold_blob_file_options.temperature =
+      mutable_cf_options->cold_blob_file_temperature;
+  std::vector<std::string> cold_blob_file_paths;
+
+  std::unique_ptr<BlobFileBuilder> cold_blob_file_builder(
+      blob_file_builder && mutable_cf_options->enable_blob_garbage_collection &&
+              mutable_cf_options->cold_blob_file_size > 0
+          ? new BlobFileBuilder(versions_, fs_.get(),
+                                sub_compact->compaction->immutable_options(),
+                                &cold_blob_cf_options, &cold_blob_file_options,
+                                job_id_, cfd->GetID(), cfd->GetName(),
+                                Env::IOPriority::IO_LOW, write_hint_,
+                                io_tracer_, blob_callback_,
+                                &cold_blob_file_paths,
+                                &sub_compact->blob_file_additions)
+          : nullptr);
+
   TEST_SYNC_POINT("CompactionJob::Run():Inprogress");
   TEST_SYNC_POINT_CALLBACK(
       "CompactionJob::Run():PausingManualCompaction:1",
@@ -1233,7 +1559,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       blob_file_builder.get(), db_options_.allow_data_in_errors,
       sub_compact->compaction, compaction_filter, shutting_down_,
       preserve_deletes_seqnum_, manual_compaction_paused_,
-      manual_compaction_canceled_, db_options_.info_log, full_history_ts_low));
+      manual_compaction_canceled_, db_options_.info_log, full_history_ts_low,
+      cold_blob_file_builder.get()));
   auto c_iter = sub_compact->c_iter.get();
   c_iter->SeekToFirst();
   if (c_iter->Valid() && sub_compact->compaction->output_level() != 0) {
@@ -1251,6 +1578,19 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
           : sub_compact->compaction->CreateSstPartitioner();
   std::string last_key_for_partitioner;
 
+  // Data blocks the compaction would write out unchanged are copied as they
+  // are stored. Anything that may rewrite plain values keeps it from doing so.
+  std::unique_ptr<CompactionBlockCopier> block_copier;
+  if (db_options_.compaction_copy_unchanged_blocks &&
+      compaction_filter == nullptr && blob_file_builder == nullptr &&
+      !sub_compact->compaction->DoesInputReferenceBlobFiles() && ts_sz == 0 &&
+      partitioner == nullptr && snapshot_checker_ == nullptr) {
+    block_copier.reset(new CompactionBlockCopier(
+        sub_compact->compaction, cfd->table_cache(), file_options_for_read_,
+        sub_compact->compaction->bottommost_level(), end));
+  }
+  std::string copied_next_key;
+
   while (status.ok() && !cfd->IsDropped() && c_iter->Valid()) {
     // Invariant: c_iter.status() is guaranteed to be OK if c_iter->Valid()
     // returns true.
@@ -1274,22 +1614,36 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         break;
       }
     }
-    status = sub_compact->AddToBuilder(key, value);
-    if (!status.ok()) {
-      break;
-    }
 
-    status = sub_compact->ProcessOutFlowIfNeeded(key, value);
-    if (!status.ok()) {
-      break;
+    bool output_file_ended = false;
+    copied_next_key.clear();
+    if (block_copier != nullptr && input->Valid() &&
+        cfd->internal_comparator().Compare(input->key(), key) == 0 &&
+        block_copier->Seek(key)) {
+      status = CopyDataBlocks(sub_compact, block_copier.get(),
+                              &copied_next_key, &output_file_ended);
+      if (!status.ok()) {
+        break;
+      }
     }
+    if (copied_next_key.empty()) {
+      status = sub_compact->AddToBuilder(key, value);
+      if (!status.ok()) {
+        break;
+      }
 
-    sub_compact->current_output_file_size =
-        sub_compact->builder->EstimatedFileSize();
-    const ParsedInternalKey& ikey = c_iter->ikey();
-    sub_compact->current_output()->meta.UpdateBoundaries(
-        key, value, ikey.sequence, ikey.type);
-    sub_compact->num_output_records++;
+      status = sub_compact->ProcessOutFlowIfNeeded(key, value);
+      if (!status.ok()) {
+        break;
+      }
+
+      sub_compact->current_output_file_size =
+          sub_compact->builder->EstimatedFileSize();
+      const ParsedInternalKey& ikey = c_iter->ikey();
+      sub_compact->current_output()->meta.UpdateBoundaries(
+          key, value, ikey.sequence, ikey.type);
+      sub_compact->num_output_records++;
+    }
 
     // Close output file if it is big enough. Two possibilities determine it's
     // time to close it: (1) the current key should be this file's last key, (2)
@@ -1299,7 +1653,6 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     // during subcompactions (i.e. if output size, estimated by input size, is
     // going to be 1.2MB and max_output_file_size = 1MB, prefer to have 0.6MB
     // and 0.6MB instead of 1MB and 0.2MB)
-    bool output_file_ended = false;
     if (sub_compact->compaction->output_level() != 0 &&
         sub_compact->current_output_file_size >=
             sub_compact->compaction->max_output_file_size()) {
@@ -1315,7 +1668,11 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       last_key_for_partitioner.assign(c_iter->user_key().data_,
                                       c_iter->user_key().size_);
     }
-    c_iter->Next();
+    if (copied_next_key.empty()) {
+      c_iter->Next();
+    } else {
+      c_iter->SkipCopied(copied_next_key);
+    }
     if (c_iter->status().IsManualCompactionPaused()) {
       break;
     }
@@ -1409,6 +1766,15 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     }
     RecordDroppedKeys(range_del_out_stats, &sub_compact->compaction_job_stats);
   }
+  {
+    // All outputs must be durable before they are installed
+    Status s = WaitForPendingOutputCloses(sub_compact, 0 /* max_pending */);
+    if (status.ok()) {
+      status = s;
+    } else {
+      s.PermitUncheckedError();
+    }
+  }
 
   if (blob_file_builder) {
     if (status.ok()) {
@@ -1419,8 +1785,19 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     blob_file_builder.reset();
   }
 
+  if (cold_blob_file_builder) {
+    if (status.ok()) {
+      status = cold_blob_file_builder->Finish();
+    } else {
+      cold_blob_file_builder->Abandon();
+    }
+    cold_blob_file_builder.reset();
+  }
+
   sub_compact->compaction_job_stats.cpu_micros =
       db_options_.clock->CPUNanos() / 1000 - prev_cpu_micros;
+  sub_compact->compaction_job_stats.file_read_bytes +=
+      IOSTATS(bytes_read) - prev_bytes_read;
 
   if (measure_io_stats_) {
     sub_compact->compaction_job_stats.file_write_nanos +=
@@ -1431,6 +1808,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         IOSTATS(range_sync_nanos) - prev_range_sync_nanos;
     sub_compact->compaction_job_stats.file_prepare_write_nanos +=
         IOSTATS(prepare_write_nanos) - prev_prepare_write_nanos;
+    sub_compact->compaction_job_stats.file_read_nanos +=
+        IOSTATS(read_nanos) - prev_read_nanos;
     sub_compact->compaction_job_stats.cpu_micros -=
         (IOSTATS(cpu_write_nanos) - prev_cpu_write_nanos +
          IOSTATS(cpu_read_nanos) - prev_cpu_read_nanos) /
@@ -1454,6 +1833,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   blob_counter.reset();
   clip.reset();
   raw_input.reset();
+  num_subcompactions_reading.fetch_sub(1);
   sub_compact->status = status;
 }
 
@@ -1498,6 +1878,55 @@ void CompactionJob::RecordDroppedKeys(
   }
 }
 
+Status CompactionJob::CopyDataBlocks(SubcompactionState* sub_compact,
+                                     CompactionBlockCopier* copier,
+                                     std::string* next_key,
+                                     bool* output_file_ended) {
+  assert(sub_compact->builder != nullptr);
+  const Compaction* c = sub_compact->compaction;
+  next_key->clear();
+  while (sub_compact->builder->AddRawDataBlock(
+      copier->contents(), copier->compression_type(),
+      copier->compress_format_version(), copier->entries())) {
+    auto output = sub_compact->current_output();
+    for (const auto& entry : copier->entries()) {
+      Status s = output->validator.Add(entry.first, entry.second);
+      if (!s.ok()) {
+        return s;
+      }
+      ParsedInternalKey ikey;
+      s = ParseInternalKey(entry.first, &ikey,
+                           db_options_.allow_data_in_errors);
+      if (!s.ok()) {
+        return s;
+      }
+      output->meta.UpdateBoundaries(entry.first, entry.second, ikey.sequence,
+                                    ikey.type);
+    }
+    sub_compact->num_output_records += copier->entries().size();
+    RecordTick(stats_, COMPACT_COPIED_DATA_BLOCKS);
+    next_key->assign(copier->next_key().data(), copier->next_key().size());
+
+    sub_compact->current_output_file_size =
+        sub_compact->builder->EstimatedFileSize();
+    if (c->output_level() != 0 && sub_compact->current_output_file_size >=
+                                      c->max_output_file_size()) {
+      break;
+    }
+    if (!copier->Next()) {
+      break;
+    }
+    if (c->output_level() != 0 &&
+        sub_compact->ShouldStopBefore(copier->entries().front().first,
+                                      sub_compact->current_output_file_size)) {
+      // The block is copied into the next file, if it still qualifies then
+      *output_file_ended = true;
+      break;
+    }
+  }
+  return sub_compact->builder->status();
+}
+
 Status CompactionJob::FinishCompactionOutputFile(
     const Status& input_status, SubcompactionState* sub_compact,
     CompactionRangeDelAggregator* range_del_agg,
@@ -1518,8 +1947,17 @@ Status CompactionJob::FinishCompactionOutputFile(
   std::string file_checksum = kUnknownFileChecksum;
   std::string file_checksum_func_name = kUnknownFileChecksumFuncName;
 
+  // Make room for this file among the ones being synced
+  Status close_s = WaitForPendingOutputCloses(
+      sub_compact, SubcompactionState::kMaxPendingCloses - 1);
+
   // Check for iterator errors
   Status s = input_status;
+  if (s.ok()) {
+    s = close_s;
+  } else {
+    close_s.PermitUncheckedError();
+  }
   auto meta = &sub_compact->current_output()->meta;
   assert(meta != nullptr);
   if (s.ok()) {
@@ -1703,6 +2141,36 @@ Status CompactionJob::FinishCompactionOutputFile(
   sub_compact->current_output()->finished = true;
   sub_compact->total_bytes += current_bytes;
 
+  if (s.ok() && db_options_.pipelined_compaction_io) {
+    TableProperties tp = sub_compact->builder->GetTableProperties();
+    if (current_entries > 0 || tp.num_range_deletions > 0) {
+      // Sync and close the file on a helper thread so that merging continues
+      // into the next file meanwhile. The file is reported once that is done.
+      std::unique_ptr<SubcompactionState::PendingClose> pending(
+          new SubcompactionState::PendingClose);
+      pending->file = std::move(sub_compact->outfile);
+      pending->output_index = sub_compact->outputs.size() - 1;
+      pending->num_entries = current_entries;
+      pending->file_size = current_bytes;
+      pending->table_properties = std::move(tp);
+      SubcompactionState::PendingClose* p = pending.get();
+      pending->thread = port::Thread([this, p]() {
+        {
+          StopWatch sw(db_options_.clock, stats_,
+                       COMPACTION_OUTFILE_SYNC_MICROS);
+          p->io_status = p->file->Sync(db_options_.use_fsync);
+        }
+        if (p->io_status.ok()) {
+          p->io_status = p->file->Close();
+        }
+      });
+      sub_compact->pending_closes.push_back(std::move(pending));
+      sub_compact->builder.reset();
+      sub_compact->current_output_file_size = 0;
+      return s;
+    }
+  }
+
   // Finish and check for file errors
   if (s.ok()) {
     StopWatch sw(db_options_.clock, stats_, COMPACTION_OUTFILE_SYNC_MICROS);
@@ -1773,6 +2241,77 @@ Status CompactionJob::FinishCompactionOutputFile(
                    current_entries, current_bytes,
                    meta->marked_for_compaction ? " (need compaction)" : "");
   }
+  s = ReportCompactionOutputFile(sub_compact, meta, tp, s, file_checksum,
+                                 file_checksum_func_name);
+
+  sub_compact->builder.reset();
+  sub_compact->current_output_file_size = 0;
+  return s;
+}
+
+Status CompactionJob::WaitForPendingOutputCloses(
+    SubcompactionState* sub_compact, size_t max_pending) {
+  Status s;
+  while (sub_compact->pending_closes.size() > max_pending) {
+    Status close_s = FinishOldestPendingOutputClose(sub_compact);
+    if (s.ok()) {
+      s = close_s;
+    } else {
+      close_s.PermitUncheckedError();
+    }
+  }
+  return s;
+}
+
+Status CompactionJob::FinishOldestPendingOutputClose(
+    SubcompactionState* sub_compact) {
+  assert(!sub_compact->pending_closes.empty());
+  std::unique_ptr<SubcompactionState::PendingClose> pending =
+      std::move(sub_compact->pending_closes.front());
+  sub_compact->pending_closes.pop_front();
+  pending->thread.join();
+
+  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
+  assert(pending->output_index < sub_compact->outputs.size());
+  SubcompactionState::Output& output =
+      sub_compact->outputs[pending->output_index];
+  FileMetaData* meta = &output.meta;
+  IOStatus io_s = pending->io_status;
+  std::string file_checksum = kUnknownFileChecksum;
+  std::string file_checksum_func_name = kUnknownFileChecksumFuncName;
+  if (io_s.ok()) {
+    meta->file_checksum = pending->file->GetFileChecksum();
+    meta->file_checksum_func_name = pending->file->GetFileChecksumFuncName();
+    file_checksum = meta->file_checksum;
+    file_checksum_func_name = meta->file_checksum_func_name;
+  }
+  Status s = io_s;
+  if (sub_compact->io_status.ok()) {
+    sub_compact->io_status = io_s;
+    sub_compact->io_status.PermitUncheckedError();
+  }
+  pending->file.reset();
+
+  if (s.ok()) {
+    output.table_properties =
+        std::make_shared<TableProperties>(pending->table_properties);
+    ROCKS_LOG_INFO(db_options_.info_log,
+                   "[%s] [JOB %d] Generated table #%" PRIu64 ": %" PRIu64
+                   " keys, %" PRIu64 " bytes%s",
+                   cfd->GetName().c_str(), job_id_, meta->fd.GetNumber(),
+                   pending->num_entries, pending->file_size,
+                   meta->marked_for_compaction ? " (need compaction)" : "");
+  }
+  return ReportCompactionOutputFile(sub_compact, meta,
+                                    pending->table_properties, s,
+                                    file_checksum, file_checksum_func_name);
+}
+
+Status CompactionJob::ReportCompactionOutputFile(
+    SubcompactionState* sub_compact, const FileMetaData* meta,
+    const TableProperties& tp, Status s, const std::string& file_checksum,
+    const std::string& file_checksum_func_name) {
+  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
   std::string fname;
   FileDescriptor output_fd;
   uint64_t oldest_blob_file_number = kInvalidBlobFileNumber;
@@ -1810,9 +2349,6 @@ Status CompactionJob::FinishCompactionOutputFile(
     }
   }
 #endif
-
-  sub_compact->builder.reset();
-  sub_compact->current_output_file_size = 0;
   return s;
 }
 
@@ -1903,10 +2439,45 @@ void CompactionJob::RecordCompactionIOStats() {
   IOSTATS_RESET(bytes_written);
 }
 
+namespace {
+// Shape of the LSM tree once the compaction is installed, for filter
+// policies that adapt to it: the input files are replaced by about as
+// many bytes of output in the output level.
+void GetLsmShapeAfterCompaction(const Compaction& c,
+                                std::vector<uint64_t>* level_bytes,
+                                int* num_level0_files) {
+  c.input_version()->storage_info()->GetLsmShape(level_bytes,
+                                                 num_level0_files);
+  const int output_level = c.output_level();
+  for (size_t i = 0; i < c.num_input_levels(); i++) {
+    const int level = c.level(i);
+    const size_t num_files = c.num_input_files(i);
+    if (num_files == 0) {
+      continue;
+    }
+    if (level == 0) {
+      // Input L0 files are merged into one sorted run, which is in L0
+      // only if that is the output level
+      *num_level0_files -= static_cast<int>(num_files);
+      if (output_level == 0) {
+        ++*num_level0_files;
+      }
+    }
+    if (level != output_level) {
+      uint64_t bytes =
+          std::min(TotalFileSize(*c.inputs(i)), (*level_bytes)[level]);
+      (*level_bytes)[level] -= bytes;
+      (*level_bytes)[output_level] += bytes;
+    }
+  }
+}
+}  // namespace
+
 Status CompactionJob::OpenCompactionOutputFile(
     SubcompactionState* sub_compact) {
   assert(sub_compact != nullptr);
   assert(sub_compact->builder == nullptr);
+  sub_compact->grandparent_boundaries_crossed = 0;
   // no need to lock because VersionSet::next_file_number_ is atomic
   uint64_t file_number = versions_->NewFileNumber();
   std::string fname = GetTableFileName(file_number);
@@ -1929,8 +2500,14 @@ Status CompactionJob::OpenCompactionOutputFile(
   FileOptions fo_copy = file_options_;
   Temperature temperature = Temperature::kUnknown;
   if (bottommost_level_) {
-    fo_copy.temperature = temperature =
-        sub_compact->compaction->mutable_cf_options()->bottommost_temperature;
+    const Compaction* const c = sub_compact->compaction;
+    temperature = c->mutable_cf_options()->bottommost_temperature;
+    // Hot files leave bottommost_temperature; the others return to it
+    if (c->compaction_reason() == CompactionReason::kChangeTemperature &&
+        c->input(0, 0)->temperature == temperature) {
+      temperature = Temperature::kUnknown;
+    }
+    fo_copy.temperature = temperature;
   }
 
   Status s;
@@ -2001,7 +2578,8 @@ Status CompactionJob::OpenCompactionOutputFile(
       std::move(writable_file), fname, file_options_, db_options_.clock,
       io_tracer_, db_options_.stats, listeners,
       db_options_.file_checksum_gen_factory.get(),
-      tmp_set.Contains(FileType::kTableFile), false));
+      tmp_set.Contains(FileType::kTableFile),
+      tmp_set.Contains(FileType::kTableFile)));
 
   TableBuilderOptions tboptions(
       *cfd->ioptions(), *(sub_compact->compaction->mutable_cf_options()),
@@ -2013,6 +2591,8 @@ Status CompactionJob::OpenCompactionOutputFile(
       oldest_ancester_time, 0 /* oldest_key_time */, current_time, db_id_,
       db_session_id_, sub_compact->compaction->max_output_file_size(),
       file_number);
+  GetLsmShapeAfterCompaction(*sub_compact->compaction, &tboptions.level_bytes,
+                             &tboptions.num_level0_files);
   sub_compact->builder.reset(
       NewTableBuilder(tboptions, sub_compact->outfile.get()));
   LogFlush(db_options_.info_log);
@@ -2578,6 +3158,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct CompactionJobStats, file_prepare_write_nanos),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"file_read_nanos",
+         {offsetof(struct CompactionJobStats, file_read_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"file_read_bytes",
+         {offsetof(struct CompactionJobStats, file_read_bytes),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"smallest_output_key_prefix",
          {offsetof(struct CompactionJobStats, smallest_output_key_prefix),
           OptionType::kEncodedString, OptionVerificationType::kNormal,
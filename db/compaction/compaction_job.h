@@ -48,6 +48,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 class Arena;
+class CompactionBlockCopier;
 class ErrorHandler;
 class MemTable;
 class SnapshotChecker;
@@ -146,18 +147,51 @@ class CompactionJob {
   // consecutive groups such that each group has a similar size.
   void GenSubcompactionBoundaries();
 
-  void ProcessKeyValueCompactionWithCompactionService(
+  // Removes from the compaction's input iterators the input files whose keys
+  // are all deleted by a range tombstone in another input file, with no
+  // snapshot in between. The files are still deleted when the compaction is
+  // installed, but never read.
+  void SkipInputFilesCoveredByRangeTombstones();
+
+  // Runs the subcompaction on the CompactionService. Returns kUseLocal if
+  // it has to run locally instead.
+  CompactionServiceJobStatus ProcessKeyValueCompactionWithCompactionService(
       SubcompactionState* sub_compact);
+  // Waits for a started remote job. If its progress stalls for
+  // compaction_service_timeout_ms, cancels it and returns kUseLocal.
+  CompactionServiceJobStatus WaitForCompactionService(
+      uint64_t job_id, std::string* compaction_service_result);
 
   // update the thread status for starting a compaction.
   void ReportStartedCompaction(Compaction* compaction);
   void AllocateCompactionOutputFileNumbers();
 
+  // Copies `copier`'s current block, and the qualifying blocks following
+  // it, into the current output file as they are stored, until the file is
+  // full. Sets *next_key to the input key to continue from, or leaves it
+  // empty if the builder took no block.
+  Status CopyDataBlocks(SubcompactionState* sub_compact,
+                        CompactionBlockCopier* copier, std::string* next_key,
+                        bool* output_file_ended);
+
   Status FinishCompactionOutputFile(
       const Status& input_status, SubcompactionState* sub_compact,
       CompactionRangeDelAggregator* range_del_agg,
       CompactionIterationStats* range_del_out_stats,
       const Slice* next_table_min_key = nullptr);
+  // Waits for the oldest output files handed to helper threads by
+  // FinishCompactionOutputFile() until at most `max_pending` remain, and
+  // reports them in order. Returns the first error.
+  Status WaitForPendingOutputCloses(SubcompactionState* sub_compact,
+                                    size_t max_pending);
+  Status FinishOldestPendingOutputClose(SubcompactionState* sub_compact);
+  // Logs the creation of a finished output file, notifies listeners and the
+  // SstFileManager. Returns `s`, or the error the SstFileManager reported.
+  Status ReportCompactionOutputFile(SubcompactionState* sub_compact,
+                                    const FileMetaData* meta,
+                                    const TableProperties& tp, Status s,
+                                    const std::string& file_checksum,
+                                    const std::string& file_checksum_func_name);
   Status InstallCompactionResults(const MutableCFOptions& mutable_cf_options);
   Status OpenCompactionOutputFile(SubcompactionState* sub_compact);
   void UpdateCompactionJobStats(
@@ -213,6 +247,8 @@ class CompactionJob {
   bool measure_io_stats_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<Slice> boundaries_;
+  // Backs the boundaries that are not in the input files' keys
+  std::deque<std::string> boundary_keys_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
   Env::Priority thread_pri_;
@@ -425,6 +425,8 @@ class CompactionJobStatsChecker : public EventListener {
       ASSERT_GT(ci.stats.file_range_sync_nanos, 0);
       ASSERT_GT(ci.stats.file_fsync_nanos, 0);
       ASSERT_GT(ci.stats.file_prepare_write_nanos, 0);
+      ASSERT_GT(ci.stats.file_read_nanos, 0);
+      ASSERT_GT(ci.stats.file_read_bytes, 0);
       verify_next_comp_io_stats_ = false;
     }
 
@@ -81,6 +81,26 @@ bool FindIntraL0Compaction(const std::vector<FileMetaData*>& level_files,
     compact_bytes_per_del_file = new_compact_bytes_per_del_file;
   }
 
+  // The outputs of a partitioned flush share one sequence number range.
+  // Compacting only some of them would create a file that overlaps the rest
+  // in both key and sequence number space, so keep them together.
+  bool trimmed = false;
+  while (limit > start && limit < level_files.size() &&
+         level_files[limit - 1]->fd.smallest_seqno ==
+             level_files[limit]->fd.smallest_seqno &&
+         level_files[limit - 1]->fd.largest_seqno ==
+             level_files[limit]->fd.largest_seqno) {
+    --limit;
+    trimmed = true;
+  }
+  if (trimmed && limit - start > 1) {
+    compact_bytes = 0;
+    for (size_t i = start; i < limit; ++i) {
+      compact_bytes += static_cast<size_t>(level_files[i]->fd.file_size);
+    }
+    compact_bytes_per_del_file = compact_bytes / (limit - start - 1);
+  }
+
   if ((limit - start) >= min_files_to_compact &&
       compact_bytes_per_del_file < max_compact_bytes_per_del_file) {
     assert(comp_inputs != nullptr);
@@ -637,7 +657,7 @@ Compaction* CompactionPicker::CompactRange(
         compact_range_options.max_subcompactions, /* grandparents */ {},
         /* is manual */ true);
     RegisterCompaction(c);
-    vstorage->ComputeCompactionScore(ioptions_, mutable_cf_options);
+    vstorage->UpdateCompactionScoreAfterPick(ioptions_, mutable_cf_options);
     return c;
   }
 
@@ -822,7 +842,7 @@ Compaction* CompactionPicker::CompactRange(
   // takes running compactions into account (by skipping files that are already
   // being compacted). Since we just changed compaction score, we recalculate it
   // here
-  vstorage->ComputeCompactionScore(ioptions_, mutable_cf_options);
+  vstorage->UpdateCompactionScoreAfterPick(ioptions_, mutable_cf_options);
 
   return compaction;
 }
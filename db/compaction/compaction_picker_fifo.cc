@@ -70,14 +70,20 @@ Compaction* FIFOCompactionPicker::PickTTLCompaction(
 
   // avoid underflow
   if (current_time > mutable_cf_options.ttl) {
+    const uint64_t time_window =
+        mutable_cf_options.compaction_options_fifo.time_window_seconds;
     for (auto ritr = level_files.rbegin(); ritr != level_files.rend(); ++ritr) {
       FileMetaData* f = *ritr;
       assert(f);
       if (f->fd.table_reader && f->fd.table_reader->GetTableProperties()) {
         uint64_t creation_time =
             f->fd.table_reader->GetTableProperties()->creation_time;
+        // With time windows, the file expires with the end of its window
+        uint64_t expiration_time =
+            time_window > 0 ? (creation_time / time_window + 1) * time_window
+                            : creation_time;
         if (creation_time == 0 ||
-            creation_time >= (current_time - mutable_cf_options.ttl)) {
+            expiration_time >= (current_time - mutable_cf_options.ttl)) {
           break;
         }
       }
@@ -131,6 +137,7 @@ Compaction* FIFOCompactionPicker::PickSizeCompaction(
       level_files.size() == 0) {
     // total size not exceeded
     if (mutable_cf_options.compaction_options_fifo.allow_compaction &&
+        mutable_cf_options.compaction_options_fifo.time_window_seconds == 0 &&
         level_files.size() > 0) {
       CompactionInputFiles comp_inputs;
       // try to prevent same files from being compacted multiple times, which
@@ -210,6 +217,105 @@ Compaction* FIFOCompactionPicker::PickSizeCompaction(
   return c;
 }
 
+Compaction* FIFOCompactionPicker::PickTimeWindowCompaction(
+    const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+    const MutableDBOptions& mutable_db_options, VersionStorageInfo* vstorage,
+    LogBuffer* log_buffer) {
+  const uint64_t time_window =
+      mutable_cf_options.compaction_options_fifo.time_window_seconds;
+  assert(time_window > 0);
+
+  const int kLevel0 = 0;
+  const std::vector<FileMetaData*>& level_files = vstorage->LevelFiles(kLevel0);
+  if (GetTotalFilesSize(level_files) >
+      mutable_cf_options.compaction_options_fifo.max_table_files_size) {
+    // Delete files first
+    return nullptr;
+  }
+
+  if (!level0_compactions_in_progress_.empty()) {
+    ROCKS_LOG_BUFFER(
+        log_buffer,
+        "[%s] FIFO compaction: Already executing compaction. No need "
+        "to run parallel compactions since compactions are very fast",
+        cf_name.c_str());
+    return nullptr;
+  }
+
+  int64_t _current_time;
+  auto status = ioptions_.clock->GetCurrentTime(&_current_time);
+  if (!status.ok()) {
+    ROCKS_LOG_BUFFER(log_buffer,
+                     "[%s] FIFO compaction: Couldn't get current time: %s. "
+                     "Not doing time window compactions. ",
+                     cf_name.c_str(), status.ToString().c_str());
+    return nullptr;
+  }
+  const uint64_t current_window =
+      static_cast<uint64_t>(_current_time) / time_window;
+
+  // L0 files go from newest to oldest, and only adjacent files can be merged
+  // without reordering keys, so look for a run of adjacent files of the same
+  // window, starting from the newest.
+  size_t start = 0;
+  while (start < level_files.size()) {
+    const uint64_t oldest_ancester_time =
+        level_files[start]->TryGetOldestAncesterTime();
+    size_t end = start + 1;
+    if (oldest_ancester_time == kUnknownOldestAncesterTime) {
+      start = end;
+      continue;
+    }
+    const uint64_t window = oldest_ancester_time / time_window;
+    while (end < level_files.size()) {
+      const uint64_t t = level_files[end]->TryGetOldestAncesterTime();
+      if (t == kUnknownOldestAncesterTime || t / time_window != window) {
+        break;
+      }
+      end++;
+    }
+    // Past windows are merged into a single file. The current window still
+    // receives flushes, so only its newest files up to about the memtable
+    // size are merged once there are enough of them, which keeps it from
+    // rewriting its earlier merged files on every compaction.
+    size_t min_files = 2;
+    size_t last = end;
+    if (window >= current_window) {
+      min_files = static_cast<size_t>(
+          std::max(2, mutable_cf_options.level0_file_num_compaction_trigger));
+      const uint64_t max_flushed_file_size = MultiplyCheckOverflow(
+          static_cast<uint64_t>(mutable_cf_options.write_buffer_size), 1.1);
+      last = start;
+      while (last < end &&
+             level_files[last]->fd.GetFileSize() <= max_flushed_file_size) {
+        last++;
+      }
+    }
+    if (last - start >= min_files) {
+      CompactionInputFiles comp_inputs;
+      comp_inputs.level = 0;
+      comp_inputs.files.assign(level_files.begin() + start,
+                               level_files.begin() + last);
+      ROCKS_LOG_BUFFER(log_buffer,
+                       "[%s] FIFO compaction: merging %" ROCKSDB_PRIszt
+                       " files of time window starting at %" PRIu64,
+                       cf_name.c_str(), comp_inputs.size(),
+                       window * time_window);
+      Compaction* c = new Compaction(
+          vstorage, ioptions_, mutable_cf_options, mutable_db_options,
+          {comp_inputs}, 0, port::kMaxUint64 /* one output file */,
+          0 /* max compaction bytes, not applicable */, 0 /* output path ID */,
+          mutable_cf_options.compression, mutable_cf_options.compression_opts,
+          0 /* max_subcompactions */, {}, /* is manual */ false,
+          vstorage->CompactionScore(0),
+          /* is deletion compaction */ false, CompactionReason::kFIFOTimeWindow);
+      return c;
+    }
+    start = end;
+  }
+  return nullptr;
+}
+
 Compaction* FIFOCompactionPicker::PickCompaction(
     const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
     const MutableDBOptions& mutable_db_options, VersionStorageInfo* vstorage,
@@ -221,6 +327,11 @@ Compaction* FIFOCompactionPicker::PickCompaction(
     c = PickTTLCompaction(cf_name, mutable_cf_options, mutable_db_options,
                           vstorage, log_buffer);
   }
+  if (c == nullptr &&
+      mutable_cf_options.compaction_options_fifo.time_window_seconds > 0) {
+    c = PickTimeWindowCompaction(cf_name, mutable_cf_options,
+                                 mutable_db_options, vstorage, log_buffer);
+  }
   if (c == nullptr) {
     c = PickSizeCompaction(cf_name, mutable_cf_options, mutable_db_options,
                            vstorage, log_buffer);
@@ -28,6 +28,12 @@ bool LevelCompactionPicker::NeedsCompaction(
   if (!vstorage->BottommostFilesMarkedForCompaction().empty()) {
     return true;
   }
+  if (!vstorage->FilesMarkedForForcedBlobGC().empty()) {
+    return true;
+  }
+  if (!vstorage->FilesMarkedForTemperatureChange().empty()) {
+    return true;
+  }
   if (!vstorage->FilesMarkedForCompaction().empty()) {
     return true;
   }
@@ -248,6 +254,20 @@ void LevelCompactionBuilder::SetupInitialFiles() {
     compaction_reason_ = CompactionReason::kPeriodicCompaction;
     return;
   }
+
+  // Forced blob garbage collection
+  PickFileToCompact(vstorage_->FilesMarkedForForcedBlobGC(), false);
+  if (!start_level_inputs_.empty()) {
+    compaction_reason_ = CompactionReason::kForcedBlobGC;
+    return;
+  }
+
+  // Temperature change
+  PickFileToCompact(vstorage_->FilesMarkedForTemperatureChange(), false);
+  if (!start_level_inputs_.empty()) {
+    compaction_reason_ = CompactionReason::kChangeTemperature;
+    return;
+  }
 }
 
 bool LevelCompactionBuilder::SetupOtherL0FilesIfNeeded() {
@@ -347,7 +367,7 @@ Compaction* LevelCompactionBuilder::GetCompaction() {
   // takes running compactions into account (by skipping files that are already
   // being compacted). Since we just changed compaction score, we recalculate it
   // here
-  vstorage_->ComputeCompactionScore(ioptions_, mutable_cf_options_);
+  vstorage_->UpdateCompactionScoreAfterPick(ioptions_, mutable_cf_options_);
   return c;
 }
 
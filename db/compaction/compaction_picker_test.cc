@@ -729,6 +729,87 @@ TEST_F(CompactionPickerTest, UniversalPeriodicCompaction6) {
   ASSERT_EQ(4, compaction->output_level());
 }
 
+TEST_F(CompactionPickerTest, UniversalIncrementalSizeAmp) {
+  // Size amp compacts the range of L3 with the lowest fanout into L4, plus
+  // the L2 file within it, instead of every sorted run.
+  const uint64_t kFileSize = 100000;
+
+  mutable_cf_options_.max_compaction_bytes = 5 * kFileSize;
+  mutable_cf_options_.compaction_options_universal.incremental = true;
+  mutable_cf_options_.compaction_options_universal
+      .max_size_amplification_percent = 30;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(5, kCompactionStyleUniversal);
+
+  Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+  Add(2, 2U, "320", "350", kFileSize, 0, 300, 350);
+  Add(3, 5U, "310", "380", kFileSize, 0, 200, 251);
+  Add(3, 6U, "410", "480", kFileSize, 0, 200, 251);
+  Add(3, 7U, "910", "980", kFileSize, 0, 200, 251);
+  Add(4, 10U, "201", "250", kFileSize, 0, 101, 150);
+  Add(4, 11U, "301", "350", kFileSize, 0, 101, 150);
+  Add(4, 12U, "401", "450", kFileSize, 0, 101, 150);
+  Add(4, 13U, "501", "750", kFileSize, 0, 101, 150);
+  Add(4, 14U, "801", "850", kFileSize, 0, 101, 150);
+  Add(4, 15U, "901", "950", kFileSize, 0, 101, 150);
+  Add(4, 16U, "951", "990", kFileSize, 0, 101, 150);
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(
+      universal_compaction_picker.PickCompaction(
+          cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+          &log_buffer_));
+  ASSERT_TRUE(compaction);
+  ASSERT_EQ(CompactionReason::kUniversalSizeAmplification,
+            compaction->compaction_reason());
+  ASSERT_EQ(2, compaction->start_level());
+  ASSERT_EQ(4, compaction->output_level());
+  ASSERT_EQ(3U, compaction->num_input_levels());
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  ASSERT_EQ(2U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(2U, compaction->num_input_files(1));
+  ASSERT_EQ(5U, compaction->input(1, 0)->fd.GetNumber());
+  ASSERT_EQ(6U, compaction->input(1, 1)->fd.GetNumber());
+  ASSERT_EQ(2U, compaction->num_input_files(2));
+  ASSERT_EQ(11U, compaction->input(2, 0)->fd.GetNumber());
+  ASSERT_EQ(12U, compaction->input(2, 1)->fd.GetNumber());
+}
+
+TEST_F(CompactionPickerTest, UniversalIncrementalSizeAmpFallsBackToFull) {
+  // No range of L3 can be compacted into L4 without rewriting much more of
+  // L4 than a full compaction would, per byte of newer data.
+  const uint64_t kFileSize = 100000;
+
+  mutable_cf_options_.max_compaction_bytes = 5 * kFileSize;
+  mutable_cf_options_.compaction_options_universal.incremental = true;
+  mutable_cf_options_.compaction_options_universal
+      .max_size_amplification_percent = 30;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(5, kCompactionStyleUniversal);
+
+  Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+  Add(2, 2U, "320", "350", kFileSize, 0, 300, 350);
+  Add(3, 5U, "010", "990", kFileSize, 0, 200, 251);
+  Add(4, 10U, "201", "250", kFileSize, 0, 101, 150);
+  Add(4, 11U, "301", "350", kFileSize, 0, 101, 150);
+  Add(4, 12U, "401", "450", kFileSize, 0, 101, 150);
+  Add(4, 13U, "501", "750", kFileSize, 0, 101, 150);
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(
+      universal_compaction_picker.PickCompaction(
+          cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+          &log_buffer_));
+  ASSERT_TRUE(compaction);
+  ASSERT_EQ(CompactionReason::kUniversalSizeAmplification,
+            compaction->compaction_reason());
+  ASSERT_EQ(0, compaction->start_level());
+  ASSERT_EQ(4, compaction->output_level());
+  ASSERT_EQ(4U, compaction->num_input_files(4));
+}
+
 TEST_F(CompactionPickerTest, NeedsCompactionFIFO) {
   NewVersionStorage(1, kCompactionStyleFIFO);
   const int kFileCount =
@@ -790,6 +871,45 @@ TEST_F(CompactionPickerTest, CompactionPriMinOverlapping1) {
   ASSERT_GE(uint64_t{55000000}, compaction->OutputFilePreallocationSize());
 }
 
+TEST_F(CompactionPickerTest, CompactionPriHotnessAware) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  ioptions_.compaction_pri = kHotnessAware;
+  mutable_cf_options_.target_file_size_base = 100000000000;
+  mutable_cf_options_.target_file_size_multiplier = 10;
+  mutable_cf_options_.max_bytes_for_level_base = 10 * 1024 * 1024;
+  mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+
+  Add(2, 6U, "150", "179", 50000000U);
+  Add(2, 7U, "180", "220", 50000000U);
+  Add(2, 8U, "321", "400", 50000000U);  // File not overlapping
+  Add(2, 9U, "721", "800", 50000000U);
+
+  Add(3, 26U, "150", "170", 260000000U);
+  Add(3, 27U, "171", "179", 260000000U);
+  Add(3, 28U, "191", "220", 260000000U);
+  Add(3, 29U, "221", "300", 260000000U);
+  Add(3, 30U, "750", "900", 260000000U);
+
+  // Reads of file 7 outweigh its overlap with level 3
+  file_map_[7U].first->stats.num_reads_sampled = 100000;
+  file_map_[9U].first->stats.num_reads_sampled = 1000;
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  ASSERT_EQ(7U, compaction->input(0, 0)->fd.GetNumber());
+  // Files never read are ordered by overlapping ratio
+  const std::vector<int>& order = vstorage_->FilesByCompactionPri(2);
+  ASSERT_EQ(4U, order.size());
+  ASSERT_EQ(7U, vstorage_->LevelFiles(2)[order[0]]->fd.GetNumber());
+  ASSERT_EQ(9U, vstorage_->LevelFiles(2)[order[1]]->fd.GetNumber());
+  ASSERT_EQ(8U, vstorage_->LevelFiles(2)[order[2]]->fd.GetNumber());
+  ASSERT_EQ(6U, vstorage_->LevelFiles(2)[order[3]]->fd.GetNumber());
+}
+
 TEST_F(CompactionPickerTest, CompactionPriMinOverlapping2) {
   NewVersionStorage(6, kCompactionStyleLevel);
   ioptions_.compaction_pri = kMinOverlappingRatio;
@@ -1050,6 +1170,39 @@ TEST_F(CompactionPickerTest, OverlappingUserKeys6) {
   ASSERT_EQ(3U, compaction->num_input_files(1));
 }
 
+TEST_F(CompactionPickerTest, UpdateScoreAfterPickPrunesMarkedFiles) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  Add(1, 1U, "100", "150", 1U, 0, 0, 0, 0, true);
+  Add(1, 2U, "200", "250", 1U, 0, 0, 0, 0, true);
+  Add(1, 3U, "300", "350", 1U, 0, 0, 0, 0, true);
+  Add(2, 4U, "100", "150", 1U);
+  Add(2, 5U, "200", "250", 1U);
+  Add(2, 6U, "300", "350", 1U);
+  UpdateVersionStorageInfo();
+  ASSERT_EQ(3U, vstorage_->FilesMarkedForCompaction().size());
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(CompactionReason::kFilesMarkedForCompaction,
+            compaction->compaction_reason());
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+
+  // The picked file is pruned, and the rest is what a full recompute finds
+  const auto pruned = vstorage_->FilesMarkedForCompaction();
+  const double pruned_score = vstorage_->CompactionScore(0);
+  ASSERT_EQ(2U, pruned.size());
+  vstorage_->ComputeCompactionScore(ioptions_, mutable_cf_options_);
+  const auto& recomputed = vstorage_->FilesMarkedForCompaction();
+  ASSERT_EQ(recomputed.size(), pruned.size());
+  for (size_t i = 0; i < pruned.size(); ++i) {
+    ASSERT_FALSE(pruned[i].second->being_compacted);
+    ASSERT_EQ(recomputed[i], pruned[i]);
+  }
+  ASSERT_EQ(vstorage_->CompactionScore(0), pruned_score);
+}
+
 TEST_F(CompactionPickerTest, OverlappingUserKeys7) {
   NewVersionStorage(6, kCompactionStyleLevel);
   mutable_cf_options_.max_compaction_bytes = 100000000000u;
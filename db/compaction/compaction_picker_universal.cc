@@ -10,6 +10,7 @@
 #include "db/compaction/compaction_picker_universal.h"
 #ifndef ROCKSDB_LITE
 
+#include <algorithm>
 #include <cinttypes>
 #include <limits>
 #include <queue>
@@ -87,6 +88,14 @@ class UniversalCompactionBuilder {
   // Pick Universal compaction to limit space amplification.
   Compaction* PickCompactionToReduceSizeAmp();
 
+  // Pick a compaction of a key range of the two oldest sorted runs, plus the
+  // files of newer non-L0 sorted runs within it, instead of a full one.
+  // Returns nullptr if every such compaction would rewrite more than
+  // `fanout_threshold` bytes of the oldest sorted run per byte of the second
+  // oldest.
+  Compaction* PickIncrementalForReduceSizeAmp(size_t start_index,
+                                              double fanout_threshold);
+
   Compaction* PickDeleteTriggeredCompaction();
 
   // Form a compaction from the sorted run indicated by start_index to the
@@ -490,7 +499,7 @@ Compaction* UniversalCompactionBuilder::PickCompaction() {
                     c->inputs(0)->size());
 
   picker_->RegisterCompaction(c);
-  vstorage_->ComputeCompactionScore(ioptions_, mutable_cf_options_);
+  vstorage_->UpdateCompactionScoreAfterPick(ioptions_, mutable_cf_options_);
 
   TEST_SYNC_POINT_CALLBACK("UniversalCompactionBuilder::PickCompaction:Return",
                            c);
@@ -818,10 +827,192 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSizeAmp() {
         " earliest-file-size %" PRIu64,
         cf_name_.c_str(), candidate_size, earliest_file_size);
   }
+  if (mutable_cf_options_.compaction_options_universal.incremental) {
+    // A full compaction rewrites earliest_file_size bytes for candidate_size
+    // bytes of newer data. Take a partial one unless it is a lot less
+    // efficient than that.
+    const double kMaxFanoutRatio = 1.8;
+    double fanout_threshold = static_cast<double>(earliest_file_size) /
+                              static_cast<double>(candidate_size) *
+                              kMaxFanoutRatio;
+    Compaction* c =
+        PickIncrementalForReduceSizeAmp(start_index, fanout_threshold);
+    if (c != nullptr) {
+      return c;
+    }
+  }
   return PickCompactionToOldest(start_index,
                                 CompactionReason::kUniversalSizeAmplification);
 }
 
+Compaction* UniversalCompactionBuilder::PickIncrementalForReduceSizeAmp(
+    size_t start_index, double fanout_threshold) {
+  assert(sorted_runs_.size() >= 2);
+  const int second_last_level = sorted_runs_[sorted_runs_.size() - 2].level;
+  if (second_last_level == 0) {
+    // An L0 file cannot be split by key range
+    return nullptr;
+  }
+  const int output_level = sorted_runs_.back().level;
+  const std::vector<FileMetaData*>& files =
+      vstorage_->LevelFiles(second_last_level);
+  const std::vector<FileMetaData*>& bottom_files =
+      vstorage_->LevelFiles(output_level);
+  const Comparator* ucmp = icmp_->user_comparator();
+
+  // The files of both sorted runs are cut by target_file_size_base and the
+  // SstPartitioner, if any, so a window of consecutive files of the second
+  // oldest one is compacted with the files of the oldest one overlapping
+  // it: from bottom_begin[] of its first file to bottom_end[] of its last.
+  const size_t n = files.size();
+  std::vector<uint64_t> size_before(n + 1, 0);
+  std::vector<uint64_t> bottom_size_before(bottom_files.size() + 1, 0);
+  std::vector<size_t> bottom_begin(n);
+  std::vector<size_t> bottom_end(n);
+  for (size_t i = 0; i < bottom_files.size(); i++) {
+    bottom_size_before[i + 1] =
+        bottom_size_before[i] + bottom_files[i]->fd.GetFileSize();
+  }
+  size_t b = 0;
+  size_t e = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_before[i + 1] = size_before[i] + files[i]->fd.GetFileSize();
+    while (b < bottom_files.size() &&
+           ucmp->Compare(bottom_files[b]->largest.user_key(),
+                         files[i]->smallest.user_key()) < 0) {
+      b++;
+    }
+    e = std::max(e, b);
+    while (e < bottom_files.size() &&
+           ucmp->Compare(bottom_files[e]->smallest.user_key(),
+                         files[i]->largest.user_key()) <= 0) {
+      e++;
+    }
+    bottom_begin[i] = b;
+    bottom_end[i] = e;
+  }
+
+  // Slide a window just over half of max_compaction_bytes, leaving room for
+  // the files the clean cut and the newer sorted runs add, and keep the one
+  // rewriting the fewest bytes of the oldest sorted run per byte of the
+  // second oldest.
+  const uint64_t target_size = mutable_cf_options_.max_compaction_bytes / 2;
+  auto window_size = [&](size_t first, size_t last, uint64_t* bottom_size) {
+    *bottom_size = bottom_size_before[bottom_end[last]] -
+                   bottom_size_before[bottom_begin[first]];
+    return size_before[last + 1] - size_before[first] + *bottom_size;
+  };
+  bool picked = false;
+  size_t picked_first = 0;
+  size_t picked_last = 0;
+  double picked_fanout = fanout_threshold;
+  size_t last = 0;
+  for (size_t first = 0; first < n; first++) {
+    last = std::max(last, first);
+    uint64_t bottom_size = 0;
+    while (last + 1 < n &&
+           window_size(first, last, &bottom_size) < target_size) {
+      last++;
+    }
+    window_size(first, last, &bottom_size);
+    uint64_t size = size_before[last + 1] - size_before[first];
+    if (size > 0) {
+      double fanout =
+          static_cast<double>(bottom_size) / static_cast<double>(size);
+      if (fanout < picked_fanout) {
+        picked = true;
+        picked_first = first;
+        picked_last = last;
+        picked_fanout = fanout;
+      }
+    }
+    if (last + 1 == n) {
+      // Later windows would only be smaller parts of this one
+      break;
+    }
+  }
+  if (!picked) {
+    ROCKS_LOG_BUFFER(log_buffer_,
+                     "[%s] Universal: no incremental compaction within "
+                     "fanout %.2f to reduce size amp\n",
+                     cf_name_.c_str(), fanout_threshold);
+    return nullptr;
+  }
+
+  CompactionInputFiles second_last_level_inputs;
+  second_last_level_inputs.level = second_last_level;
+  second_last_level_inputs.files.assign(files.begin() + picked_first,
+                                        files.begin() + picked_last + 1);
+  if (!picker_->ExpandInputsToCleanCut(cf_name_, vstorage_,
+                                       &second_last_level_inputs)) {
+    return nullptr;
+  }
+  CompactionInputFiles bottom_level_inputs;
+  bottom_level_inputs.level = output_level;
+  int parent_index = -1;
+  if (!picker_->SetupOtherInputs(cf_name_, mutable_cf_options_, vstorage_,
+                                 &second_last_level_inputs,
+                                 &bottom_level_inputs, &parent_index, -1)) {
+    return nullptr;
+  }
+
+  // Newer non-L0 sorted runs can join with the files entirely within the
+  // range, going up one sorted run at a time and narrowing the range to the
+  // files picked, so that no newer version of a key moves below an older
+  // one left behind.
+  std::vector<CompactionInputFiles> inputs;
+  InternalKey smallest;
+  InternalKey largest;
+  picker_->GetRange(second_last_level_inputs, &smallest, &largest);
+  for (size_t i = sorted_runs_.size() - 2; i-- > start_index;) {
+    if (sorted_runs_[i].level == 0) {
+      break;
+    }
+    CompactionInputFiles level_inputs;
+    level_inputs.level = sorted_runs_[i].level;
+    vstorage_->GetCleanInputsWithinInterval(level_inputs.level, &smallest,
+                                            &largest, &level_inputs.files);
+    if (level_inputs.empty()) {
+      break;
+    }
+    picker_->GetRange(level_inputs, &smallest, &largest);
+    inputs.push_back(level_inputs);
+  }
+  std::reverse(inputs.begin(), inputs.end());
+  inputs.push_back(second_last_level_inputs);
+  if (!bottom_level_inputs.empty()) {
+    inputs.push_back(bottom_level_inputs);
+  }
+  if (picker_->FilesRangeOverlapWithCompaction(inputs, output_level)) {
+    return nullptr;
+  }
+
+  uint64_t estimated_total_size = 0;
+  for (const auto& level_inputs : inputs) {
+    for (FileMetaData* f : level_inputs.files) {
+      estimated_total_size += f->fd.GetFileSize();
+    }
+  }
+  ROCKS_LOG_BUFFER(log_buffer_,
+                   "[%s] Universal: incremental compaction of %" PRIu64
+                   " bytes with fanout %.2f to reduce size amp\n",
+                   cf_name_.c_str(), estimated_total_size, picked_fanout);
+  uint32_t path_id =
+      GetPathId(ioptions_, mutable_cf_options_, estimated_total_size);
+  return new Compaction(
+      vstorage_, ioptions_, mutable_cf_options_, mutable_db_options_,
+      std::move(inputs), output_level,
+      MaxFileSizeForLevel(mutable_cf_options_, output_level,
+                          kCompactionStyleUniversal),
+      LLONG_MAX, path_id,
+      GetCompressionType(ioptions_, vstorage_, mutable_cf_options_,
+                         output_level, 1),
+      GetCompressionOptions(mutable_cf_options_, vstorage_, output_level),
+      /* max_subcompactions */ 0, /* grandparents */ {}, /* is manual */ false,
+      score_, false /* deletion_compaction */,
+      CompactionReason::kUniversalSizeAmplification);
+}
+
 // Pick files marked for compaction. Typically, files are marked by
 // CompactOnDeleteCollector due to the presence of tombstones.
 Compaction* UniversalCompactionBuilder::PickDeleteTriggeredCompaction() {
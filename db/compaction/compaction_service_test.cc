@@ -24,6 +24,7 @@ class MyTestCompactionService : public CompactionService {
                                    uint64_t job_id) override {
     InstrumentedMutexLock l(&mutex_);
     jobs_.emplace(job_id, compaction_service_input);
+    inputs_.push_back(compaction_service_input);
     CompactionServiceJobStatus s = CompactionServiceJobStatus::kSuccess;
     TEST_SYNC_POINT_CALLBACK("MyTestCompactionService::Start::End", &s);
     return s;
@@ -71,15 +72,66 @@ class MyTestCompactionService : public CompactionService {
 
   int GetCompactionNum() { return compaction_num_.load(); }
 
+  std::vector<CompactionServiceInput> GetInputs() {
+    InstrumentedMutexLock l(&mutex_);
+    std::vector<CompactionServiceInput> inputs;
+    for (const auto& input_str : inputs_) {
+      CompactionServiceInput input;
+      EXPECT_OK(CompactionServiceInput::Read(input_str, &input));
+      inputs.push_back(input);
+    }
+    return inputs;
+  }
+
  private:
   InstrumentedMutex mutex_;
   std::atomic_int compaction_num_{0};
   std::map<uint64_t, std::string> jobs_;
+  std::vector<std::string> inputs_;
   const std::string db_path_;
   Options options_;
   std::shared_ptr<Statistics> statistics_;
 };
 
+// Never completes a job unless it is cancelled
+class StuckCompactionService : public CompactionService {
+ public:
+  static const char* kClassName() { return "StuckCompactionService"; }
+
+  const char* Name() const override { return kClassName(); }
+
+  CompactionServiceJobStatus Start(
+      const std::string& /*compaction_service_input*/,
+      uint64_t /*job_id*/) override {
+    return CompactionServiceJobStatus::kSuccess;
+  }
+
+  CompactionServiceJobStatus WaitForComplete(
+      uint64_t /*job_id*/, std::string* /*compaction_service_result*/) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return cancelled_ > waited_; });
+    waited_++;
+    return CompactionServiceJobStatus::kFailure;
+  }
+
+  void Cancel(uint64_t /*job_id*/) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_++;
+    cv_.notify_all();
+  }
+
+  int GetCancelledNum() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int cancelled_ = 0;
+  int waited_ = 0;
+};
+
 class CompactionServiceTest : public DBTestBase {
  public:
   explicit CompactionServiceTest()
@@ -266,6 +318,53 @@ TEST_F(CompactionServiceTest, FailedToStart) {
   ASSERT_TRUE(s.IsIncomplete());
 }
 
+TEST_F(CompactionServiceTest, UseLocal) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.compaction_service =
+      std::make_shared<MyTestCompactionService>(dbname_, options);
+  DestroyAndReopen(options);
+  GenerateTestData();
+
+  SyncPoint::GetInstance()->SetCallBack(
+      "MyTestCompactionService::Start::End", [&](void* status) {
+        // override job status
+        auto s = static_cast<CompactionServiceJobStatus*>(status);
+        *s = CompactionServiceJobStatus::kUseLocal;
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::string start_str = Key(15);
+  std::string end_str = Key(45);
+  Slice start(start_str);
+  Slice end(end_str);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), &start, &end));
+  auto my_cs =
+      dynamic_cast<MyTestCompactionService*>(options.compaction_service.get());
+  ASSERT_EQ(0, my_cs->GetCompactionNum());
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, TimeoutFallsBackToLocal) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.compaction_service_timeout_ms = 100;
+  auto stuck_cs = std::make_shared<StuckCompactionService>();
+  options.compaction_service = stuck_cs;
+  DestroyAndReopen(options);
+  GenerateTestData();
+
+  std::string start_str = Key(15);
+  std::string end_str = Key(45);
+  Slice start(start_str);
+  Slice end(end_str);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), &start, &end));
+  ASSERT_GE(stuck_cs->GetCancelledNum(), 1);
+  VerifyTestData();
+}
+
 TEST_F(CompactionServiceTest, InvalidResult) {
   Options options = CurrentOptions();
   options.env = env_;
@@ -316,6 +415,17 @@ TEST_F(CompactionServiceTest, SubCompaction) {
   int compaction_num = my_cs->GetCompactionNum() - compaction_num_before;
   // make sure there's sub-compaction by checking the compaction number
   ASSERT_GE(compaction_num, 2);
+
+  // Each subcompaction's job got only the files overlapping its range, out
+  // of the 30 files of the compaction
+  std::vector<CompactionServiceInput> inputs = my_cs->GetInputs();
+  ASSERT_GE(inputs.size(), 2U);
+  for (size_t i = inputs.size() - static_cast<size_t>(compaction_num);
+       i < inputs.size(); i++) {
+    ASSERT_TRUE(inputs[i].has_begin || inputs[i].has_end);
+    ASSERT_GT(inputs[i].input_files.size(), 0U);
+    ASSERT_LT(inputs[i].input_files.size(), 30U);
+  }
 }
 
 class PartialDeleteCompactionFilter : public CompactionFilter {
@@ -317,6 +317,23 @@ TEST_F(CorruptionTest, TableFile) {
   ASSERT_NOK(dbi->VerifyChecksum());
 }
 
+TEST_F(CorruptionTest, VerifyChecksumWithThreads) {
+  Options options;
+  options.disable_auto_compactions = true;
+  options.max_file_verification_threads = 4;
+  Reopen(&options);
+
+  // 10 table files
+  Build(1000, 100);
+  DBImpl* dbi = static_cast_with_check<DBImpl>(db_);
+  ASSERT_OK(dbi->TEST_FlushMemTable());
+  ASSERT_EQ(10, Property("rocksdb.num-files-at-level0"));
+  ASSERT_OK(dbi->VerifyChecksum());
+
+  Corrupt(kTableFile, 100, 1);
+  ASSERT_TRUE(dbi->VerifyChecksum().IsCorruption());
+}
+
 TEST_F(CorruptionTest, VerifyChecksumReadahead) {
   Options options;
   SpecialEnv senv(env_->target());
@@ -342,10 +359,10 @@ TEST_F(CorruptionTest, VerifyChecksumReadahead) {
   // Make sure the counter is enabled.
   ASSERT_GT(senv.random_read_counter_.Read(), 0);
 
-  // The SST file is about 10MB. Default readahead size is 256KB.
+  // The SST file is about 10MB. Default readahead size is 2MB.
   // Give a conservative 20 reads for metadata blocks, The number
-  // of random reads should be within 10 MB / 256KB + 20 = 60.
-  ASSERT_LT(senv.random_read_counter_.Read(), 60);
+  // of random reads should be within 10 MB / 2MB + 20 = 25.
+  ASSERT_LE(senv.random_read_counter_.Read(), 25);
 
   senv.random_read_bytes_counter_ = 0;
   ReadOptions ro;
@@ -232,11 +232,15 @@ TEST_F(DBBasicTest, CompactedDB) {
   ASSERT_OK(Flush());
   Close();
 
+  // Multiple overlapping files, still CompactedDB
   ASSERT_OK(ReadOnlyReopen(options));
-  // Fallback to read-only DB
   s = Put("new", "value");
   ASSERT_EQ(s.ToString(),
-            "Not implemented: Not supported operation in read only mode.");
+            "Not implemented: Not supported in compacted db mode.");
+  ASSERT_EQ(DummyString(kFileSize / 2, 'a'), Get("aaa"));
+  ASSERT_EQ(DummyString(kFileSize / 2, 'b'), Get("bbb"));
+  ASSERT_EQ("NOT_FOUND", Get("ccc"));
+  ASSERT_EQ(DummyString(kFileSize / 2, 'e'), Get("eee"));
   Close();
 
   // Full compaction
@@ -286,6 +290,55 @@ TEST_F(DBBasicTest, CompactedDB) {
   ASSERT_EQ(DummyString(kFileSize / 2, 'i'), values[4]);
   ASSERT_TRUE(status_list[5].IsNotFound());
 
+  // Files in more than one level, with newer values and deletions on top
+  Reopen(options);
+  ASSERT_OK(Put("aaa", "new_a"));
+  ASSERT_OK(Delete("bbb"));
+  ASSERT_OK(Put("ccc", "new_c"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("jjj", "new_j"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Delete("jjj"));
+  ASSERT_OK(Flush());
+  Close();
+  ASSERT_OK(ReadOnlyReopen(options));
+  s = Put("new", "value");
+  ASSERT_EQ(s.ToString(),
+            "Not implemented: Not supported in compacted db mode.");
+  ASSERT_EQ("new_a", Get("aaa"));
+  ASSERT_EQ("NOT_FOUND", Get("bbb"));
+  ASSERT_EQ("new_c", Get("ccc"));
+  ASSERT_EQ(DummyString(kFileSize / 2, 'e'), Get("eee"));
+  ASSERT_EQ("NOT_FOUND", Get("jjj"));
+  status_list = dbfull()->MultiGet(
+      ReadOptions(),
+      std::vector<Slice>({Slice("aaa"), Slice("bbb"), Slice("ccc"),
+                          Slice("iii"), Slice("jjj")}),
+      &values);
+  ASSERT_EQ(status_list.size(), static_cast<uint64_t>(5));
+  ASSERT_OK(status_list[0]);
+  ASSERT_EQ("new_a", values[0]);
+  ASSERT_TRUE(status_list[1].IsNotFound());
+  ASSERT_OK(status_list[2]);
+  ASSERT_EQ("new_c", values[2]);
+  ASSERT_OK(status_list[3]);
+  ASSERT_EQ(DummyString(kFileSize / 2, 'i'), values[3]);
+  ASSERT_TRUE(status_list[4].IsNotFound());
+  Close();
+
+  // Range deletions fall back to read-only DB
+  Reopen(options);
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             "hhh", "iii"));
+  ASSERT_OK(Flush());
+  Close();
+  ASSERT_OK(ReadOnlyReopen(options));
+  s = Put("new", "value");
+  ASSERT_EQ(s.ToString(),
+            "Not implemented: Not supported operation in read only mode.");
+  ASSERT_EQ("NOT_FOUND", Get("hhh"));
+  Close();
+
   Reopen(options);
   // Add a key
   ASSERT_OK(Put("fff", DummyString(kFileSize / 2, 'f')));
@@ -556,6 +609,92 @@ TEST_F(DBBasicTest, ManifestRollOver) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, ManifestRollOverBySpaceAmp) {
+  SyncPoint::GetInstance()->SetCallBack(
+      "VersionSet::ProcessManifestWrites:MinManifestFileSizeForSpaceAmp",
+      [](void* arg) { *static_cast<uint64_t*>(arg) = 0; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (uint32_t space_amp_pct : {0, 100}) {
+    Options options = CurrentOptions();
+    options.max_manifest_space_amp_pct = space_amp_pct;
+    options.disable_auto_compactions = true;
+    DestroyAndReopen(options);
+
+    const uint64_t first_manifest = dbfull()->TEST_Current_Manifest_FileNo();
+    for (int i = 0; i < 20; ++i) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+      ASSERT_OK(Flush());
+    }
+    if (space_amp_pct == 0) {
+      ASSERT_EQ(dbfull()->TEST_Current_Manifest_FileNo(), first_manifest);
+    } else {
+      ASSERT_GT(dbfull()->TEST_Current_Manifest_FileNo(), first_manifest);
+    }
+
+    Reopen(options);
+    for (int i = 0; i < 20; ++i) {
+      ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+    }
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBBasicTest, OpenTableFilesInBackground) {
+  Options options = CurrentOptions();
+  options.max_open_files = -1;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(Flush());
+    if (i == 2) {
+      ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    }
+  }
+  const int num_files = NumTableFilesAtLevel(0) + NumTableFilesAtLevel(1);
+  ASSERT_GT(NumTableFilesAtLevel(1), 0);
+
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBBasicTest::OpenTableFilesInBackground:Checked",
+        "DBImpl::BackgroundCallOpenTableFiles:Start"},
+       {"DBImpl::BackgroundCallOpenTableFiles:Done",
+        "DBBasicTest::OpenTableFilesInBackground:Opened"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  options.open_table_files_in_background = true;
+  Reopen(options);
+
+  // No table reader is pinned by DB::Open
+  {
+    VersionStorageInfo* vstorage = dbfull()
+                                       ->TEST_GetVersionSet()
+                                       ->GetColumnFamilySet()
+                                       ->GetDefault()
+                                       ->current()
+                                       ->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); ++level) {
+      for (const FileMetaData* f : vstorage->LevelFiles(level)) {
+        ASSERT_EQ(f->fd.table_reader, nullptr);
+      }
+    }
+  }
+  TEST_SYNC_POINT("DBBasicTest::OpenTableFilesInBackground:Checked");
+  TEST_SYNC_POINT("DBBasicTest::OpenTableFilesInBackground:Opened");
+
+  ASSERT_EQ(dbfull()->TEST_table_cache()->GetUsage(),
+            static_cast<size_t>(num_files));
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBasicTest, IdentityAcrossRestarts1) {
   do {
     std::string id1;
@@ -977,7 +1116,7 @@ TEST_F(DBBasicTest, ChecksumTest) {
   BlockBasedTableOptions table_options;
   Options options = CurrentOptions();
   // change when new checksum type added
-  int max_checksum = static_cast<int>(kxxHash64);
+  int max_checksum = static_cast<int>(kXXH3);
   const int kNumPerFile = 2;
 
   // generate one table with each type of checksum
@@ -1577,6 +1716,93 @@ TEST_F(DBBasicTest, MultiGetBatchedMultiLevel) {
   }
 }
 
+TEST_F(DBBasicTest, MultiGetAsyncIOMultiLevel) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  // key_i lives in L2, every 3rd key is overwritten in L1 and every 5th in
+  // L0, with several files per level.
+  const int kStep[] = {1, 3, 5};
+  const char* kPrefix[] = {"val_l2_", "val_l1_", "val_l0_"};
+  for (int l = 0; l < 3; ++l) {
+    int num_keys = 0;
+    for (int i = 0; i < 128; i += kStep[l]) {
+      ASSERT_OK(
+          Put("key_" + std::to_string(i), kPrefix[l] + std::to_string(i)));
+      if (++num_keys % 8 == 0) {
+        ASSERT_OK(Flush());
+      }
+    }
+    ASSERT_OK(Flush());
+    if (l < 2) {
+      MoveFilesToLevel(2 - l);
+    }
+  }
+  // Start with a cold block cache.
+  Reopen(options);
+
+  size_t total_requests = 0;
+  int num_prefetch_calls = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::PrefetchForMultiGet:Requests", [&](void* arg) {
+        total_requests += *static_cast<size_t*>(arg);
+        num_prefetch_calls++;
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::vector<std::string> key_strs;
+  for (int i = 32; i < 64; ++i) {
+    key_strs.push_back("key_" + std::to_string(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+
+  ReadOptions ro;
+  ro.async_io = true;
+  for (int round = 0; round < 2; ++round) {
+    db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                  values.data(), statuses.data());
+    for (size_t j = 0; j < keys.size(); ++j) {
+      int key = static_cast<int>(j) + 32;
+      ASSERT_OK(statuses[j]);
+      if (key % 5 == 0) {
+        ASSERT_EQ(values[j], "val_l0_" + std::to_string(key));
+      } else if (key % 3 == 0) {
+        ASSERT_EQ(values[j], "val_l1_" + std::to_string(key));
+      } else {
+        ASSERT_EQ(values[j], "val_l2_" + std::to_string(key));
+      }
+      values[j].Reset();
+    }
+    ASSERT_GT(num_prefetch_calls, 0);
+    if (round == 0) {
+      ASSERT_GT(total_requests, 0);
+    } else {
+      // Everything is cached now, so nothing is requested from the files.
+      ASSERT_EQ(total_requests, 0);
+    }
+    total_requests = 0;
+    num_prefetch_calls = 0;
+  }
+
+  // Without async_io no prefetching is done.
+  ro.async_io = false;
+  db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                values.data(), statuses.data());
+  for (size_t j = 0; j < keys.size(); ++j) {
+    ASSERT_OK(statuses[j]);
+  }
+  ASSERT_EQ(num_prefetch_calls, 0);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBasicTest, MultiGetBatchedMultiLevelMerge) {
   Options options = CurrentOptions();
   options.disable_auto_compactions = true;
@@ -2207,6 +2433,101 @@ TEST_F(DBBasicTest, MultiGetIOBufferOverrun) {
                      keys.data(), values.data(), statuses.data(), true);
 }
 
+TEST_F(DBBasicTest, MultiGetParallelDecompression) {
+  if (!Snappy_Supported()) {
+    ROCKSDB_GTEST_SKIP("Test requires Snappy support");
+    return;
+  }
+  Options options = CurrentOptions();
+  options.compression = kSnappyCompression;
+  options.statistics = CreateDBStatistics();
+  Random rnd(301);
+  std::vector<std::string> expected;
+  std::string zero_str(128, '\0');
+  for (bool no_block_cache : {false, true}) {
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 256;
+    table_options.multiget_decompression_threads = 3;
+    table_options.no_block_cache = no_block_cache;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    expected.clear();
+    for (int i = 0; i < 100; ++i) {
+      // Compressible, so that the data blocks are compressed
+      expected.push_back(rnd.RandomString(64) + zero_str);
+      ASSERT_OK(Put(Key(i), expected.back()));
+    }
+    ASSERT_OK(Flush());
+
+    for (bool fill_cache : {true, false}) {
+      ReadOptions ro;
+      ro.fill_cache = fill_cache;
+      std::vector<std::string> key_data;
+      for (int i = 0; i < 100; i += 3) {
+        key_data.push_back(Key(i));
+      }
+      std::vector<Slice> keys(key_data.begin(), key_data.end());
+      std::vector<PinnableSlice> values(keys.size());
+      std::vector<Status> statuses(keys.size());
+      const uint64_t decompressed_before =
+          options.statistics->getTickerCount(NUMBER_BLOCK_DECOMPRESSED);
+      db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                    values.data(), statuses.data());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_OK(statuses[i]);
+        ASSERT_EQ(expected[i * 3], values[i].ToString());
+      }
+      if (fill_cache && !no_block_cache) {
+        // Every key is in a block of its own
+        ASSERT_GE(
+            options.statistics->getTickerCount(NUMBER_BLOCK_DECOMPRESSED) -
+                decompressed_before,
+            keys.size());
+      }
+    }
+  }
+}
+
+TEST_F(DBBasicTest, MultiGetDataBlockHashIndex) {
+  Options options = CurrentOptions();
+  for (bool wide : {false, true}) {
+    BlockBasedTableOptions table_options;
+    table_options.data_block_index_type =
+        BlockBasedTableOptions::kDataBlockBinaryAndHash;
+    table_options.wide_data_block_hash_index = wide;
+    // With many restart intervals per block, which need wide buckets
+    table_options.block_size = 32 << 10;
+    table_options.block_restart_interval = 1;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    for (int i = 0; i < 1000; i += 2) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    }
+    ASSERT_OK(Flush());
+
+    // Many keys per data block, found and not found
+    std::vector<std::string> key_data;
+    for (int i = 100; i < 132; ++i) {
+      key_data.push_back(Key(i));
+    }
+    std::vector<Slice> keys(key_data.begin(), key_data.end());
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), keys.size(),
+                  keys.data(), values.data(), statuses.data());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if ((100 + i) % 2 == 0) {
+        ASSERT_OK(statuses[i]);
+        ASSERT_EQ("v" + ToString(100 + i), values[i].ToString());
+      } else {
+        ASSERT_TRUE(statuses[i].IsNotFound());
+      }
+    }
+  }
+}
+
 TEST_F(DBBasicTest, IncrementalRecoveryNoCorrupt) {
   Options options = CurrentOptions();
   DestroyAndReopen(options);
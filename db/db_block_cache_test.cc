@@ -505,6 +505,57 @@ TEST_F(DBBlockCacheTest, WarmCacheWithDataBlocksDuringFlush) {
 }
 #endif
 
+TEST_F(DBBlockCacheTest, DumpAndWarmUpBlockCache) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  Options options = GetOptions(table_options);
+  DestroyAndReopen(options);
+
+  std::string value(kValueSize, 'a');
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_OK(Put(ToString(i), value));
+    if (i == kNumBlocks / 2) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(Flush());
+
+  // Only every other key is hot.
+  size_t num_hot = 0;
+  for (size_t i = 0; i < kNumBlocks; i += 2) {
+    ASSERT_EQ(value, Get(ToString(i)));
+    num_hot++;
+  }
+  const std::string dump_path = dbname_ + "_hot_set";
+  ASSERT_OK(db_->DumpBlockCacheHotSet(dump_path));
+
+  // Reopen with an empty block cache and load the hot blocks back.
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  options = GetOptions(table_options);
+  Reopen(options);
+  ASSERT_OK(db_->WarmUpBlockCache(ReadOptions(), dump_path));
+  ASSERT_EQ(num_hot, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+
+  // Warming up again finds everything already cached.
+  ASSERT_OK(db_->WarmUpBlockCache(ReadOptions(), dump_path));
+  ASSERT_EQ(num_hot, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+
+  for (size_t i = 0; i < kNumBlocks; i += 2) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(num_hot, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+
+  // A damaged dump is rejected.
+  std::string data;
+  ASSERT_OK(ReadFileToString(env_, dump_path, &data));
+  data[data.size() / 2] ^= 0x55;
+  ASSERT_OK(WriteStringToFile(env_, data, dump_path));
+  ASSERT_TRUE(db_->WarmUpBlockCache(ReadOptions(), dump_path).IsCorruption());
+
+  ASSERT_OK(env_->DeleteFile(dump_path));
+}
+
 namespace {
 
 // A mock cache wraps LRUCache, and record how many entries have been
@@ -1210,6 +1261,57 @@ TEST_F(DBBlockCacheTest, CacheEntryRoleStats) {
   }
 }
 
+TEST_F(DBBlockCacheTest, UpperLevelsPinning) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 20 /* capacity */);
+  table_options.block_size = 128;
+  table_options.metadata_block_size = 128;
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.index_type =
+      BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+  table_options.partition_filters = true;
+  table_options.filter_policy.reset(
+      NewBloomFilterPolicy(10 /* bits_per_key */));
+  table_options.metadata_cache_options.top_level_index_pinning =
+      PinningTier::kUpperLevels;
+  table_options.metadata_cache_options.partition_pinning =
+      PinningTier::kUpperLevels;
+  table_options.metadata_cache_options.max_upper_level = 1;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(32)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  for (int i = 200; i < 400; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(32)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1,0,1", FilesPerLevel());
+  // Opens the files again, with the levels they are in now
+  Reopen(options);
+  table_options.block_cache->EraseUnRefEntries();
+
+  uint64_t filter_misses = TestGetTickerCount(options, BLOCK_CACHE_FILTER_MISS);
+  uint64_t index_misses = TestGetTickerCount(options, BLOCK_CACHE_INDEX_MISS);
+  // The metadata of the L0 file is pinned
+  Get(Key(300));
+  ASSERT_EQ(filter_misses,
+            TestGetTickerCount(options, BLOCK_CACHE_FILTER_MISS));
+  ASSERT_EQ(index_misses, TestGetTickerCount(options, BLOCK_CACHE_INDEX_MISS));
+  // That of the L2 file is not
+  Get(Key(100));
+  ASSERT_LT(filter_misses,
+            TestGetTickerCount(options, BLOCK_CACHE_FILTER_MISS));
+  ASSERT_LT(index_misses, TestGetTickerCount(options, BLOCK_CACHE_INDEX_MISS));
+}
+
 #endif  // ROCKSDB_LITE
 
 class DBBlockCachePinningTest
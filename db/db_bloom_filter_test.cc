@@ -10,6 +10,8 @@
 #include <iomanip>
 #include <sstream>
 
+#include "cache/cache_entry_roles.h"
+#include "cache/cache_reservation_manager.h"
 #include "db/db_test_util.h"
 #include "options/options_helper.h"
 #include "port/stack_trace.h"
@@ -666,6 +668,204 @@ TEST_F(DBBloomFilterTest, BloomFilterReverseCompatibility) {
   }
 }
 
+namespace {
+// Tracks the block cache charge of filter construction reservations.
+// Flushes in these tests happen one at a time, so no synchronization.
+class FilterConstructionTrackingCache : public CacheWrapper {
+ public:
+  explicit FilterConstructionTrackingCache(std::shared_ptr<Cache> target)
+      : CacheWrapper(std::move(target)),
+        deleter_(
+            GetNoopDeleterForRole<CacheEntryRole::kFilterConstruction>()) {}
+
+  using Cache::Insert;
+  Status Insert(const Slice& key, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value),
+                Handle** handle = nullptr,
+                Priority priority = Priority::LOW) override {
+    Status s = target_->Insert(key, value, charge, deleter, handle, priority);
+    if (s.ok() && deleter == deleter_) {
+      charged_ += charge;
+      peak_charged_ = std::max(peak_charged_, charged_);
+    }
+    return s;
+  }
+
+  using Cache::Release;
+  bool Release(Handle* handle, bool force_erase = false) override {
+    if (target_->GetDeleter(handle) == deleter_) {
+      charged_ -= target_->GetCharge(handle);
+    }
+    return target_->Release(handle, force_erase);
+  }
+
+  size_t GetCharged() const { return charged_; }
+  size_t GetPeakCharged() const { return peak_charged_; }
+
+ private:
+  const DeleterFn deleter_;
+  size_t charged_ = 0;
+  size_t peak_charged_ = 0;
+};
+
+uint64_t TotalFilterSize(DB* db) {
+  TablePropertiesCollection props;
+  EXPECT_OK(db->GetPropertiesOfAllTables(&props));
+  uint64_t total = 0;
+  for (const auto& p : props) {
+    total += p.second->filter_size;
+  }
+  return total;
+}
+}  // namespace
+
+TEST_F(DBBloomFilterTest, ReserveTableBuilderMemory) {
+  const int kNumKeys = 20000;
+  for (bool partition_filters : {false, true}) {
+    for (bool reserve : {false, true}) {
+      Options options = CurrentOptions();
+      BlockBasedTableOptions table_options;
+      auto cache = std::make_shared<FilterConstructionTrackingCache>(
+          NewLRUCache(64 << 20));
+      table_options.block_cache = cache;
+      table_options.reserve_table_builder_memory = reserve;
+      table_options.filter_policy.reset(NewRibbonFilterPolicy(10));
+      if (partition_filters) {
+        table_options.partition_filters = true;
+        table_options.index_type =
+            BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+      }
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+      DestroyAndReopen(options);
+
+      for (int i = 0; i < kNumKeys; i++) {
+        ASSERT_OK(Put(Key(i), Key(i)));
+      }
+      ASSERT_OK(Flush());
+
+      if (!reserve) {
+        ASSERT_EQ(0U, cache->GetPeakCharged());
+      } else if (partition_filters) {
+        // Partitions are finished as they fill up, so only some of the
+        // keys are charged at a time
+        ASSERT_GE(cache->GetPeakCharged(),
+                  CacheReservationManager::kSizeDummyEntry);
+      } else {
+        // Hashes of all keys, plus Ribbon banding of at least one
+        // (16 + 4 byte) row per key
+        ASSERT_GE(cache->GetPeakCharged(), size_t{kNumKeys} * (8 + 20));
+      }
+      // Everything released once the file is built
+      ASSERT_EQ(0U, cache->GetCharged());
+
+      for (int i = 0; i < kNumKeys; i += 97) {
+        ASSERT_EQ(Key(i), Get(Key(i)));
+      }
+    }
+  }
+}
+
+TEST_F(DBBloomFilterTest, RangeFilter) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.range_filter_prefix_len = 2;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // One L0 file each for "a000".."a099", "c000".."c099" and "e000".."e099"
+  for (char c : {'a', 'c', 'e'}) {
+    for (int i = 0; i < 100; ++i) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "%c%03d", c, i);
+      ASSERT_OK(Put(buf, buf));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ("3", FilesPerLevel());
+
+  auto count_range = [&](const std::string& start, const std::string& end) {
+    ReadOptions ro;
+    Slice upper_bound(end);
+    ro.iterate_upper_bound = &upper_bound;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    int count = 0;
+    for (iter->Seek(start); iter->Valid(); iter->Next()) {
+      EXPECT_GE(iter->key().compare(start), 0);
+      EXPECT_LT(iter->key().compare(end), 0);
+      ++count;
+    }
+    EXPECT_OK(iter->status());
+    return count;
+  };
+
+  // No file has keys in the range
+  ASSERT_EQ(0, count_range("b", "bz"));
+  ASSERT_EQ(3U, TestGetAndResetTickerCount(options, RANGE_FILTER_USEFUL));
+  // Key prefixes in "c" file are all "c0", so "c1" is filtered out there too
+  ASSERT_EQ(0, count_range("c1", "c2"));
+  ASSERT_EQ(3U, TestGetAndResetTickerCount(options, RANGE_FILTER_USEFUL));
+
+  // Ranges with keys are not filtered out where they have keys
+  ASSERT_EQ(10, count_range("a050", "a060"));
+  ASSERT_EQ(2U, TestGetAndResetTickerCount(options, RANGE_FILTER_USEFUL));
+  ASSERT_EQ(140, count_range("a080", "e020"));
+  ASSERT_EQ(0U, TestGetAndResetTickerCount(options, RANGE_FILTER_USEFUL));
+
+  // No effect without an upper bound
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->Seek("b");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("c000", iter->key());
+  ASSERT_EQ(0U, TestGetAndResetTickerCount(options, RANGE_FILTER_USEFUL));
+  iter.reset();
+
+  // Same results with the files in L1, where only files overlapping the
+  // range are opened
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,3", FilesPerLevel());
+  ASSERT_EQ(0, count_range("b", "bz"));
+  ASSERT_EQ(1U, TestGetAndResetTickerCount(options, RANGE_FILTER_USEFUL));
+  ASSERT_EQ(10, count_range("a050", "a060"));
+  ASSERT_EQ(140, count_range("a080", "e020"));
+  ASSERT_EQ(0U, TestGetAndResetTickerCount(options, RANGE_FILTER_USEFUL));
+}
+
+TEST_F(DBBloomFilterTest, ReserveTableBuilderMemoryBloomFallback) {
+  const int kNumKeys = 20000;
+  uint64_t filter_size[2];
+  for (bool strict : {false, true}) {
+    Options options = CurrentOptions();
+    BlockBasedTableOptions table_options;
+    // Hashes fit (in one dummy entry) but Ribbon banding does not, when
+    // strict
+    auto cache = std::make_shared<FilterConstructionTrackingCache>(
+        NewLRUCache(2 * CacheReservationManager::kSizeDummyEntry,
+                    /*num_shard_bits*/ 0, strict));
+    table_options.block_cache = cache;
+    table_options.reserve_table_builder_memory = true;
+    table_options.filter_policy.reset(NewRibbonFilterPolicy(10));
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), Key(i)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_GT(cache->GetPeakCharged(), 0U);
+    ASSERT_EQ(0U, cache->GetCharged());
+    filter_size[strict] = TotalFilterSize(db_);
+
+    for (int i = 0; i < kNumKeys; i += 97) {
+      ASSERT_EQ(Key(i), Get(Key(i)));
+    }
+    ASSERT_EQ("NOT_FOUND", Get(Key(kNumKeys + 1)));
+  }
+  // Bloom filter is roughly 40% bigger than the Ribbon filter it replaced
+  ASSERT_GT(filter_size[1], filter_size[0] * 5 / 4);
+}
+
 namespace {
 // A wrapped bloom over block-based FilterPolicy
 class TestingWrappedBlockBasedFilterPolicy : public FilterPolicy {
@@ -1085,6 +1285,34 @@ TEST_F(DBBloomFilterTest, MemtablePrefixBloomOutOfDomain) {
   ASSERT_EQ(kKey, iter->key());
 }
 
+TEST_F(DBBloomFilterTest, MemtableWholeKeyBloomMultiGet) {
+  Options options = CurrentOptions();
+  options.statistics = CreateDBStatistics();
+  options.prefix_extractor.reset(NewFixedPrefixTransform(4));
+  options.memtable_prefix_bloom_size_ratio = 0.25;
+  options.memtable_whole_key_filtering = true;
+  Reopen(options);
+  ASSERT_OK(Put("AAAA0001", "v1"));
+  ASSERT_OK(Put("AAAA0003", "v3"));
+
+  // The keys share the prefix of the written ones, so only the whole key
+  // filter can rule the missing ones out.
+  std::vector<std::string> keys = {"AAAA0001", "AAAA0002", "AAAA0003",
+                                   "AAAA0004"};
+  std::vector<std::string> values = MultiGet(keys);
+  ASSERT_EQ("v1", values[0]);
+  ASSERT_EQ("NOT_FOUND", values[1]);
+  ASSERT_EQ("v3", values[2]);
+  ASSERT_EQ("NOT_FOUND", values[3]);
+
+  ASSERT_EQ(4, TestGetTickerCount(options, MEMTABLE_BLOOM_CHECKED));
+  ASSERT_EQ(2, TestGetTickerCount(options, MEMTABLE_BLOOM_USEFUL));
+
+  ASSERT_EQ("NOT_FOUND", Get("AAAA0002"));
+  ASSERT_EQ(5, TestGetTickerCount(options, MEMTABLE_BLOOM_CHECKED));
+  ASSERT_EQ(3, TestGetTickerCount(options, MEMTABLE_BLOOM_USEFUL));
+}
+
 class DBBloomFilterTestVaryPrefixAndFormatVer
     : public DBTestBase,
       public testing::WithParamInterface<std::tuple<bool, uint32_t>> {
@@ -1294,7 +1522,133 @@ INSTANTIATE_TEST_CASE_P(DBBloomFilterTestVaryPrefixAndFormatVer,
                             std::make_tuple(true, 4),
                             std::make_tuple(true, 5)));
 
+TEST_F(DBBloomFilterTest, PartitionedMultiGetReadsFilterPartitionsTogether) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  BlockBasedTableOptions bbto;
+  bbto.filter_policy.reset(NewBloomFilterPolicy(20));
+  bbto.partition_filters = true;
+  bbto.index_type = BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+  bbto.metadata_block_size = 290;
+  bbto.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  DestroyAndReopen(options);
+
+  constexpr int N = 12000;
+  // Add N/2 evens
+  for (int i = 0; i < N; i += 2) {
+    ASSERT_OK(Put(Key(i), Key(i)));
+  }
+  ASSERT_OK(Flush());
+  // Drop the partitions loaded when the table was opened
+  bbto.block_cache->EraseUnRefEntries();
+
+  int num_reads = 0;
+  size_t num_blocks_read = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "PartitionedFilterBlockReader::ReadFilterPartitions:NumBlocks",
+      [&](void* arg) {
+        ++num_reads;
+        num_blocks_read += *static_cast<size_t*>(arg);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  constexpr int Q = 29;
+  constexpr int stride = (N / Q) | 1;
+  std::vector<std::string> keys;
+  for (int i = 0; i < Q; ++i) {
+    keys.push_back(Key(i * stride));
+  }
+  std::vector<Slice> key_slices(keys.begin(), keys.end());
+  std::vector<ColumnFamilyHandle*> column_families(Q,
+                                                   db_->DefaultColumnFamily());
+  std::vector<PinnableSlice> values(Q);
+  std::vector<Status> statuses(Q);
+
+  TestGetAndResetTickerCount(options, BLOCK_CACHE_FILTER_HIT);
+  TestGetAndResetTickerCount(options, BLOCK_CACHE_FILTER_MISS);
+  for (int round = 0; round < 2; ++round) {
+    db_->MultiGet(ReadOptions(), Q, column_families.data(), key_slices.data(),
+                  values.data(), statuses.data(), /*sorted_input=*/true);
+    for (int i = 0; i < Q; ++i) {
+      if ((i * stride % 2) == 0) {
+        ASSERT_OK(statuses[i]);
+        ASSERT_EQ(values[i].ToString(), keys[i]);
+      } else {
+        ASSERT_TRUE(statuses[i].IsNotFound());
+      }
+      values[i].Reset();
+    }
+  }
+
+  // The first MultiGet looked up each partition once and read all of them
+  // together; the second one found them all in the block cache.
+  uint64_t misses = TestGetAndResetTickerCount(options, BLOCK_CACHE_FILTER_MISS);
+  uint64_t hits = TestGetAndResetTickerCount(options, BLOCK_CACHE_FILTER_HIT);
+  EXPECT_GT(misses, 1U);
+  EXPECT_EQ(hits, misses);
+  EXPECT_EQ(num_reads, 1);
+  EXPECT_EQ(num_blocks_read, misses);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 #ifndef ROCKSDB_LITE
+TEST_F(DBBloomFilterTest, SkipUnhelpfulFilters) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.skip_filters_after_unhelpful_checks = 10;
+  BlockBasedTableOptions bbto;
+  bbto.filter_policy.reset(NewBloomFilterPolicy(20));
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 200; i += 2) {
+    ASSERT_OK(Put(Key(i), Key(i)));
+  }
+  ASSERT_OK(Flush());
+
+  auto get_filter_stats = [&]() {
+    std::map<std::string, std::string> stats;
+    EXPECT_TRUE(dbfull()->GetMapProperty(DB::Properties::kFilterStats, &stats));
+    return stats;
+  };
+
+  // Every lookup finds its key, so the filter never rules one out. After 10
+  // checks, it is checked once per 11 lookups: by lookups 20, 31, ..., 97.
+  for (int i = 0; i < 200; i += 2) {
+    ASSERT_EQ(Get(Key(i)), Key(i));
+  }
+  auto stats = get_filter_stats();
+  EXPECT_EQ(stats["L0.whole-key-checked"], "18");
+  EXPECT_EQ(stats["L0.whole-key-useful"], "0");
+  EXPECT_EQ(stats["L0.skipped"], "82");
+  EXPECT_EQ(stats["L0.prefix-checked"], "0");
+  EXPECT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 0);
+
+  // The first check after 8 more skipped lookups rules out a missing key,
+  // and the filter is checked from then on.
+  for (int i = 1; i < 40; i += 2) {
+    ASSERT_EQ(Get(Key(i)), "NOT_FOUND");
+  }
+  stats = get_filter_stats();
+  EXPECT_EQ(stats["L0.whole-key-checked"], "30");
+  EXPECT_EQ(stats["L0.whole-key-useful"], "12");
+  EXPECT_EQ(stats["L0.skipped"], "90");
+  EXPECT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 12);
+
+  // Disabled by default
+  ASSERT_OK(
+      dbfull()->SetOptions({{"skip_filters_after_unhelpful_checks", "0"}}));
+  for (int i = 0; i < 40; i += 2) {
+    ASSERT_EQ(Get(Key(i)), Key(i));
+  }
+  stats = get_filter_stats();
+  EXPECT_EQ(stats["L0.whole-key-checked"], "50");
+  EXPECT_EQ(stats["L0.skipped"], "90");
+}
+
 namespace {
 namespace BFP2 {
 // Extends BFP::Mode with option to use Plain table
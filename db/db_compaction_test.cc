@@ -2535,6 +2535,193 @@ TEST_P(DBCompactionTestWithParam, ConvertCompactionStyle) {
   ASSERT_EQ(keys_in_db, expected_keys);
 }
 
+TEST_F(DBCompactionTest, SubcompactionsForNonL0LevelCompaction) {
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleLevel;
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = 4;
+  options.target_file_size_base = 64 << 10;
+  options.max_bytes_for_level_base = 4 << 20;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  const int kNumKeys = 1000;
+  auto write_all_keys = [&]() {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+    }
+    ASSERT_OK(Flush());
+  };
+  // ~1MB in L2 and another version of the same keys in L1, each split into
+  // files of target_file_size_base
+  write_all_keys();
+  MoveFilesToLevel(2);
+  write_all_keys();
+  MoveFilesToLevel(1);
+  ASSERT_GT(NumTableFilesAtLevel(1), 4);
+  ASSERT_GT(NumTableFilesAtLevel(2), 4);
+  ASSERT_OK(options.statistics->Reset());
+
+  // L1 now exceeds its target size; each automatic L1->L2 compaction spans
+  // several target-sized output files, so it is split into subcompactions.
+  ASSERT_OK(dbfull()->SetOptions({{"max_bytes_for_level_base", "262144"},
+                                  {"disable_auto_compactions", "false"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  HistogramData subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &subcompactions);
+  ASSERT_GT(subcompactions.count, 0);
+  ASSERT_GT(subcompactions.max, 1);
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(1000, Get(Key(i)).size());
+  }
+}
+
+TEST_F(DBCompactionTest, PipelinedCompactionIO) {
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 64 << 10;
+  options.pipelined_compaction_io = true;
+  options.file_checksum_gen_factory = GetFileChecksumGenCrc32cFactory();
+  DestroyAndReopen(options);
+  ASSERT_EQ(2 << 20, dbfull()->GetDBOptions().compaction_readahead_size);
+
+  Random rnd(301);
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+    if (i % 250 == 249) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(NumTableFilesAtLevel(1), 4);
+
+  // Every output file was closed and reported, with its checksum
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  for (const auto& file : files) {
+    ASSERT_NE(kUnknownFileChecksum, file.file_checksum);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(1000, Get(Key(i)).size());
+  }
+
+  Reopen(options);
+  ASSERT_GT(NumTableFilesAtLevel(1), 4);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(1000, Get(Key(i)).size());
+  }
+}
+
+TEST_F(DBCompactionTest, CopyUnchangedBlocks) {
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.num_levels = 3;
+  options.compaction_copy_unchanged_blocks = true;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 4 << 10;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Older versions of the first and last key keep L1 from being the
+  // bottommost level, where sequence numbers would be zeroed
+  const int kNumKeys = 1000;
+  ASSERT_OK(Put(Key(0), "old"));
+  ASSERT_OK(Put(Key(kNumKeys - 1), "old"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+
+  // L0 files with disjoint key ranges, one of them with a deletion
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumKeys; i++) {
+    values.push_back(rnd.RandomString(100));
+    ASSERT_OK(Put(Key(i), values[i]));
+    if (i % 250 == 249) {
+      if (i == 749) {
+        ASSERT_OK(Delete(Key(600)));
+        values[600] = "NOT_FOUND";
+      }
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_EQ(4, NumTableFilesAtLevel(0));
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(TestGetTickerCount(options, COMPACT_COPIED_DATA_BLOCKS), 0);
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys - 1, count);
+  iter.reset();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  Reopen(options);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, LevelCompactionDynamicFileSize) {
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.num_levels = 3;
+  options.target_file_size_base = 150 << 10;
+  options.level_compaction_dynamic_file_size = true;
+  DestroyAndReopen(options);
+
+  // Four L2 files of about 100KB each
+  const int kKeysPerFile = 100;
+  const int kNumFiles = 4;
+  Random rnd(301);
+  for (int f = 0; f < kNumFiles; f++) {
+    for (int i = f * kKeysPerFile; i < (f + 1) * kKeysPerFile; i++) {
+      ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+    }
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(2);
+  }
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(2));
+
+  // Compacting all the keys into L1 would cut output files at 150KB, each
+  // but the last overlapping two L2 files. They are cut at the L2 file
+  // boundaries instead.
+  for (int i = 0; i < kNumFiles * kKeysPerFile; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr, nullptr,
+                                        true /* disallow_trivial_move */));
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(1));
+
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  const std::vector<SstFileMetaData>& l1_files = cf_meta.levels[1].files;
+  const std::vector<SstFileMetaData>& l2_files = cf_meta.levels[2].files;
+  ASSERT_EQ(l2_files.size(), l1_files.size());
+  for (size_t i = 0; i < l1_files.size(); i++) {
+    ASSERT_EQ(l2_files[i].smallestkey, l1_files[i].smallestkey);
+    ASSERT_EQ(l2_files[i].largestkey, l1_files[i].largestkey);
+  }
+}
+
 TEST_F(DBCompactionTest, L0_CompactionBug_Issue44_a) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -6018,6 +6205,44 @@ TEST_F(DBCompactionTest, ChangeLevelErrorPathTest) {
   ASSERT_EQ("0,5", FilesPerLevel(0));
 }
 
+TEST_F(DBCompactionTest, CompactionWithManySnapshots) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // Ten versions of every key, with a snapshot after each round of writes
+  const int kNumKeys = 200;
+  const int kNumVersions = 10;
+  std::vector<const Snapshot*> snapshots;
+  for (int v = 0; v < kNumVersions; v++) {
+    for (int k = 0; k < kNumKeys; k++) {
+      ASSERT_OK(Put(Key(k), "v" + ToString(v)));
+    }
+    ASSERT_OK(Flush());
+    snapshots.push_back(db_->GetSnapshot());
+  }
+
+  // Snapshots come and go while the compaction runs
+  std::atomic<bool> done(false);
+  port::Thread churn([&]() {
+    while (!done) {
+      const Snapshot* s = db_->GetSnapshot();
+      db_->ReleaseSnapshot(s);
+    }
+  });
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  done = true;
+  churn.join();
+
+  for (int v = 0; v < kNumVersions; v++) {
+    for (int k = 0; k < kNumKeys; k++) {
+      ASSERT_EQ("v" + ToString(v), Get(Key(k), snapshots[v]));
+    }
+    db_->ReleaseSnapshot(snapshots[v]);
+  }
+  ASSERT_EQ(0U, dbfull()->snapshots().count());
+}
+
 TEST_F(DBCompactionTest, CompactionWithBlob) {
   Options options;
   options.env = env_;
@@ -6746,6 +6971,61 @@ TEST_F(DBCompactionTest, CompactionWithChecksumHandoffManifest2) {
   Destroy(options);
 }
 
+TEST_F(DBCompactionTest, PrioritizeStallRelievingCompaction) {
+  class CompactionOrderCollector : public EventListener {
+   public:
+    void OnCompactionBegin(DB* /*db*/, const CompactionJobInfo& ci) override {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cf_names_.push_back(ci.cf_name);
+    }
+    std::vector<std::string> GetCfNames() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return cf_names_;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::vector<std::string> cf_names_;
+  };
+
+  Options options = CurrentOptions();
+  auto collector = std::make_shared<CompactionOrderCollector>();
+  options.listeners.emplace_back(collector);
+  options.prioritize_stall_relieving_work = true;
+  options.max_background_compactions = 1;
+  options.level0_file_num_compaction_trigger = 2;
+  options.level0_slowdown_writes_trigger = 20;
+  options.level0_stop_writes_trigger = 30;
+  env_->SetBackgroundThreads(1, Env::LOW);
+  CreateAndReopenWithCF({"pikachu", "eevee"}, options);
+
+  // Hold the compaction thread while both column families queue up
+  test::SleepingBackgroundTask sleeping_task_low;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task_low,
+                 Env::Priority::LOW);
+
+  // "pikachu" is queued first, but "eevee" is closer to a write stall
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK(Put(1, Key(i), "val"));
+    ASSERT_OK(Flush(1));
+  }
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_OK(Put(2, Key(i), "val"));
+    ASSERT_OK(Flush(2));
+  }
+  ASSERT_EQ(2, NumTableFilesAtLevel(0, 1));
+  ASSERT_EQ(8, NumTableFilesAtLevel(0, 2));
+
+  sleeping_task_low.WakeUp();
+  sleeping_task_low.WaitUntilDone();
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  std::vector<std::string> cf_names = collector->GetCfNames();
+  ASSERT_EQ(2U, cf_names.size());
+  ASSERT_EQ("eevee", cf_names[0]);
+  ASSERT_EQ("pikachu", cf_names[1]);
+}
+
 #endif  // !defined(ROCKSDB_LITE)
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -7,6 +7,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
+#include <algorithm>
 #include <atomic>
 
 #include "db/db_impl/db_impl.h"
@@ -1569,6 +1570,198 @@ TEST_F(DBFlushTest, FlushWithBlob) {
 #endif  // ROCKSDB_LITE
 }
 
+#ifndef ROCKSDB_LITE
+TEST_F(DBFlushTest, PartitionedFlush) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_flush_partitions = 4;
+  options.env = env_;
+  Reopen(options);
+
+  SyncPoint::GetInstance()->SetCallBack(
+      "FlushJob::PickFlushPartitionBoundaries:MinPartitionBytes",
+      [](void* arg) { *static_cast<uint64_t*>(arg) = 1; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  constexpr int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), "v1_" + Key(i)));
+  }
+  // Keep the older versions alive so that every partition boundary has to
+  // avoid splitting the versions of a key.
+  const Snapshot* snapshot = db_->GetSnapshot();
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), "v2_" + Key(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("4", FilesPerLevel());
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(4, files.size());
+  std::sort(files.begin(), files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              return a.smallestkey < b.smallestkey;
+            });
+  ASSERT_EQ(Key(0), files.front().smallestkey);
+  ASSERT_EQ(Key(kNumKeys - 1), files.back().largestkey);
+  for (size_t i = 1; i < files.size(); ++i) {
+    ASSERT_LT(files[i - 1].largestkey, files[i].smallestkey);
+    ASSERT_EQ(files[0].smallest_seqno, files[i].smallest_seqno);
+    ASSERT_EQ(files[0].largest_seqno, files[i].largest_seqno);
+  }
+
+  ReadOptions snapshot_read;
+  snapshot_read.snapshot = snapshot;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ((i % 2 == 0 ? "v2_" : "v1_") + Key(i), Get(Key(i)));
+    ASSERT_EQ("v1_" + Key(i), Get(Key(i), snapshot));
+  }
+  db_->ReleaseSnapshot(snapshot);
+
+  // A second partitioned flush on top of the first one, followed by a
+  // reopen, exercises the L0 consistency checks on both groups of files.
+  for (int i = 0; i < kNumKeys; i += 3) {
+    ASSERT_OK(Put(Key(i), "v3_" + Key(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("8", FilesPerLevel());
+  Reopen(options);
+
+  auto verify = [&]() {
+    for (int i = 0; i < kNumKeys; ++i) {
+      std::string expected = i % 3 == 0   ? "v3_"
+                             : i % 2 == 0 ? "v2_"
+                                          : "v1_";
+      ASSERT_EQ(expected + Key(i), Get(Key(i)));
+    }
+  };
+  verify();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBFlushTest, PartitionedFlushAlignedToBaseLevel) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 20 << 10;
+  options.env = env_;
+  Reopen(options);
+
+  constexpr int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a')));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(1), 2);
+
+  ASSERT_OK(
+      db_->SetOptions({{"max_flush_partitions", "16"},
+                       {"align_flush_partitions_to_base_level", "true"}}));
+  SyncPoint::GetInstance()->SetCallBack(
+      "FlushJob::PickFlushPartitionBoundaries:MinPartitionBytes",
+      [](void* arg) { *static_cast<uint64_t*>(arg) = 1; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'b')));
+  }
+  ASSERT_OK(Flush());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Cuts are made where L1 files start, so no L1 file overlaps more than one
+  // of the L0 files
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  std::vector<LiveFileMetaData> l0_files;
+  std::vector<LiveFileMetaData> l1_files;
+  for (const auto& file : files) {
+    (file.level == 0 ? l0_files : l1_files).push_back(file);
+  }
+  ASSERT_GT(l0_files.size(), 1);
+  for (const auto& l1_file : l1_files) {
+    int num_overlapping = 0;
+    for (const auto& l0_file : l0_files) {
+      if (l0_file.smallestkey <= l1_file.largestkey &&
+          l1_file.smallestkey <= l0_file.largestkey) {
+        num_overlapping++;
+      }
+    }
+    ASSERT_LE(num_overlapping, 1);
+  }
+
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(std::string(100, i % 2 == 0 ? 'b' : 'a'), Get(Key(i)));
+  }
+}
+
+TEST_F(DBFlushTest, FlushToLowestNonOverlappingLevel) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.num_levels = 4;
+  options.flush_to_lowest_nonoverlapping_level = true;
+  options.env = env_;
+  Reopen(options);
+
+  auto put_range = [&](int begin, int end, const std::string& prefix) {
+    for (int i = begin; i < end; ++i) {
+      ASSERT_OK(Put(Key(i), prefix + Key(i)));
+    }
+  };
+
+  // Each new key range that overlaps nothing goes straight to the last level.
+  put_range(0, 100, "a");
+  ASSERT_OK(Flush());
+  ASSERT_EQ("0,0,0,1", FilesPerLevel());
+  put_range(100, 200, "a");
+  ASSERT_OK(Flush());
+  ASSERT_EQ("0,0,0,2", FilesPerLevel());
+
+  // An overlapping flush stops right above the first overlapping level.
+  put_range(150, 250, "b");
+  ASSERT_OK(Flush());
+  ASSERT_EQ("0,0,1,2", FilesPerLevel());
+  put_range(240, 260, "c");
+  ASSERT_OK(Flush());
+  ASSERT_EQ("0,1,1,2", FilesPerLevel());
+  put_range(255, 256, "d");
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1,1,1,2", FilesPerLevel());
+
+  // Once L0 overlaps, output stays in L0.
+  put_range(255, 256, "e");
+  ASSERT_OK(Flush());
+  ASSERT_EQ("2,1,1,2", FilesPerLevel());
+
+  ASSERT_OK(
+      db_->SetOptions({{"flush_to_lowest_nonoverlapping_level", "false"}}));
+  put_range(1000, 1001, "f");
+  ASSERT_OK(Flush());
+  ASSERT_EQ("3,1,1,2", FilesPerLevel());
+
+  auto verify = [&]() {
+    for (int i = 0; i < 260; ++i) {
+      std::string expected = i == 255   ? "e"
+                             : i >= 240 ? "c"
+                             : i >= 150 ? "b"
+                                        : "a";
+      ASSERT_EQ(expected + Key(i), Get(Key(i)));
+    }
+    ASSERT_EQ("f" + Key(1000), Get(Key(1000)));
+  };
+  verify();
+  Reopen(options);
+  verify();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  verify();
+}
+#endif  // ROCKSDB_LITE
+
 TEST_F(DBFlushTest, FlushWithChecksumHandoff1) {
   if (mem_env_ || encrypted_env_) {
     ROCKSDB_GTEST_SKIP("Test requires non-mem or non-encrypted environment");
@@ -1767,6 +1960,44 @@ TEST_F(DBFlushTest, FlushWithChecksumHandoffManifest2) {
   Destroy(options);
 }
 
+TEST_F(DBFlushTest, AdaptiveWriteBufferSize) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.write_buffer_size = 64 << 10;
+  options.arena_block_size = 4 << 10;
+  options.max_adaptive_write_buffer_size = 256 << 10;
+  options.max_write_buffer_number = 4;
+  options.level0_file_num_compaction_trigger = 100;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  auto cfd = static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+                 ->cfd();
+  ASSERT_EQ(64 << 10, cfd->mem()->GetWriteBufferSize());
+
+  // Memtables filling up grow up to the maximum
+  Random rnd(301);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+    ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable());
+  }
+  ASSERT_EQ(256 << 10, cfd->mem()->GetWriteBufferSize());
+
+  // and shrink back when switched well before
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(64 << 10, cfd->mem()->GetWriteBufferSize());
+
+  // Disabled again
+  ASSERT_OK(dbfull()->SetOptions({{"max_adaptive_write_buffer_size", "0"}}));
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+    ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable());
+  }
+  ASSERT_EQ(64 << 10, cfd->mem()->GetWriteBufferSize());
+}
+
 class DBFlushTestBlobError : public DBFlushTest,
                              public testing::WithParamInterface<std::string> {
  public:
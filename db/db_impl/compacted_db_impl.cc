@@ -6,6 +6,8 @@
 #ifndef ROCKSDB_LITE
 #include "db/db_impl/compacted_db_impl.h"
 
+#include <algorithm>
+
 #include "db/db_impl/db_impl.h"
 #include "db/version_set.h"
 #include "table/get_context.h"
@@ -28,13 +30,15 @@ CompactedDBImpl::CompactedDBImpl(const DBOptions& options,
 CompactedDBImpl::~CompactedDBImpl() {
 }
 
-size_t CompactedDBImpl::FindFile(const Slice& key) {
-  size_t right = files_.num_files - 1;
-  auto cmp = [&](const FdWithKeyRange& f, const Slice& k) -> bool {
-    return user_comparator_->Compare(ExtractUserKey(f.largest_key), k) < 0;
+size_t CompactedDBImpl::FindRoute(const Slice& user_key) const {
+  auto cmp = [this](const Slice& k, const RouteBoundary& b) -> bool {
+    const int c = user_comparator_->Compare(b.user_key, k);
+    return c > 0 || (c == 0 && b.after_key);
   };
-  return static_cast<size_t>(std::lower_bound(files_.files,
-                            files_.files + right, key, cmp) - files_.files);
+  return static_cast<size_t>(
+      std::upper_bound(route_boundaries_.begin(), route_boundaries_.end(),
+                       user_key, cmp) -
+      route_boundaries_.begin());
 }
 
 Status CompactedDBImpl::Get(const ReadOptions& options, ColumnFamilyHandle*,
@@ -43,10 +47,16 @@ Status CompactedDBImpl::Get(const ReadOptions& options, ColumnFamilyHandle*,
                          GetContext::kNotFound, key, value, nullptr, nullptr,
                          nullptr, true, nullptr, nullptr);
   LookupKey lkey(key, kMaxSequenceNumber);
-  Status s = files_.files[FindFile(key)].fd.table_reader->Get(
-      options, lkey.internal_key(), &get_context, nullptr);
-  if (!s.ok() && !s.IsNotFound()) {
-    return s;
+  const size_t route = FindRoute(key);
+  for (size_t i = route_offsets_[route]; i < route_offsets_[route + 1]; ++i) {
+    Status s = route_files_[i]->fd.table_reader->Get(
+        options, lkey.internal_key(), &get_context, nullptr);
+    if (!s.ok() && !s.IsNotFound()) {
+      return s;
+    }
+    if (get_context.State() != GetContext::kNotFound) {
+      break;
+    }
   }
   if (get_context.State() == GetContext::kFound) {
     return Status::OK();
@@ -57,40 +67,47 @@ Status CompactedDBImpl::Get(const ReadOptions& options, ColumnFamilyHandle*,
 std::vector<Status> CompactedDBImpl::MultiGet(const ReadOptions& options,
     const std::vector<ColumnFamilyHandle*>&,
     const std::vector<Slice>& keys, std::vector<std::string>* values) {
-  autovector<TableReader*, 16> reader_list;
+  autovector<size_t, 16> route_list;
   for (const auto& key : keys) {
-    const FdWithKeyRange& f = files_.files[FindFile(key)];
-    if (user_comparator_->Compare(key, ExtractUserKey(f.smallest_key)) < 0) {
-      reader_list.push_back(nullptr);
-    } else {
+    const size_t route = FindRoute(key);
+    if (route_offsets_[route] < route_offsets_[route + 1]) {
       LookupKey lkey(key, kMaxSequenceNumber);
-      f.fd.table_reader->Prepare(lkey.internal_key());
-      reader_list.push_back(f.fd.table_reader);
+      route_files_[route_offsets_[route]]->fd.table_reader->Prepare(
+          lkey.internal_key());
     }
+    route_list.push_back(route);
   }
   std::vector<Status> statuses(keys.size(), Status::NotFound());
   values->resize(keys.size());
-  int idx = 0;
-  for (auto* r : reader_list) {
-    if (r != nullptr) {
-      PinnableSlice pinnable_val;
-      std::string& value = (*values)[idx];
-      GetContext get_context(user_comparator_, nullptr, nullptr, nullptr,
-                             GetContext::kNotFound, keys[idx], &pinnable_val,
-                             nullptr, nullptr, nullptr, true, nullptr, nullptr);
-      LookupKey lkey(keys[idx], kMaxSequenceNumber);
-      Status s = r->Get(options, lkey.internal_key(), &get_context, nullptr);
-      assert(static_cast<size_t>(idx) < statuses.size());
-      if (!s.ok() && !s.IsNotFound()) {
-        statuses[idx] = s;
-      } else {
-        value.assign(pinnable_val.data(), pinnable_val.size());
-        if (get_context.State() == GetContext::kFound) {
-          statuses[idx] = Status::OK();
-        }
+  for (size_t idx = 0; idx < keys.size(); ++idx) {
+    const size_t route = route_list[idx];
+    if (route_offsets_[route] == route_offsets_[route + 1]) {
+      continue;
+    }
+    PinnableSlice pinnable_val;
+    std::string& value = (*values)[idx];
+    GetContext get_context(user_comparator_, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, keys[idx], &pinnable_val,
+                           nullptr, nullptr, nullptr, true, nullptr, nullptr);
+    LookupKey lkey(keys[idx], kMaxSequenceNumber);
+    Status s;
+    for (size_t i = route_offsets_[route]; i < route_offsets_[route + 1];
+         ++i) {
+      s = route_files_[i]->fd.table_reader->Get(options, lkey.internal_key(),
+                                                &get_context, nullptr);
+      if ((!s.ok() && !s.IsNotFound()) ||
+          get_context.State() != GetContext::kNotFound) {
+        break;
+      }
+    }
+    if (!s.ok() && !s.IsNotFound()) {
+      statuses[idx] = s;
+    } else {
+      value.assign(pinnable_val.data(), pinnable_val.size());
+      if (get_context.State() == GetContext::kFound) {
+        statuses[idx] = Status::OK();
       }
     }
-    ++idx;
   }
   return statuses;
 }
@@ -118,31 +135,76 @@ Status CompactedDBImpl::Init(const Options& options) {
   if (vstorage->num_non_empty_levels() == 0) {
     return Status::NotSupported("no file exists");
   }
-  const LevelFilesBrief& l0 = vstorage->LevelFilesBrief(0);
-  // L0 should not have files
-  if (l0.num_files > 1) {
-    return Status::NotSupported("L0 contain more than 1 file");
-  }
-  if (l0.num_files == 1) {
-    if (vstorage->num_non_empty_levels() > 1) {
-      return Status::NotSupported("Both L0 and other level contain files");
-    }
-    files_ = l0;
-    return Status::OK();
+  if (!vstorage->GetBlobFiles().empty()) {
+    return Status::NotSupported("blob files are not supported");
   }
+  return BuildRoutes(vstorage);
+}
 
-  for (int i = 1; i < vstorage->num_non_empty_levels() - 1; ++i) {
-    if (vstorage->LevelFilesBrief(i).num_files > 0) {
-      return Status::NotSupported("Other levels also contain files");
+Status CompactedDBImpl::BuildRoutes(const VersionStorageInfo* vstorage) {
+  // A file enters the routes at its smallest key and leaves them after its
+  // largest one. Each L0 file is searched on its own, newest first, then
+  // each other level, where at most one file can have a key.
+  struct Event {
+    RouteBoundary boundary;
+    size_t group;
+    const FdWithKeyRange* file;  // nullptr when leaving
+  };
+  std::vector<Event> events;
+  size_t num_groups = 0;
+  for (int level = 0; level < vstorage->num_non_empty_levels(); ++level) {
+    const LevelFilesBrief& files = vstorage->LevelFilesBrief(level);
+    for (size_t i = 0; i < files.num_files; ++i) {
+      const FdWithKeyRange& f = files.files[i];
+      TableReader* reader = f.fd.table_reader;
+      if (reader == nullptr) {
+        return Status::NotSupported("table file is not open");
+      }
+      if (reader->GetTableProperties() == nullptr ||
+          reader->GetTableProperties()->num_range_deletions > 0) {
+        return Status::NotSupported("range deletions are not supported");
+      }
+      const Slice smallest = ExtractUserKey(f.smallest_key);
+      if (level > 0 && i > 0 &&
+          user_comparator_->Compare(
+              ExtractUserKey(files.files[i - 1].largest_key), smallest) >= 0) {
+        return Status::NotSupported("a user key spans files of a level");
+      }
+      const size_t group = level == 0 ? num_groups + i : num_groups;
+      events.push_back({{smallest, false}, group, &f});
+      events.push_back({{ExtractUserKey(f.largest_key), true}, group, nullptr});
     }
+    num_groups += level == 0 ? files.num_files : (files.num_files > 0 ? 1 : 0);
   }
+  std::sort(events.begin(), events.end(),
+            [this](const Event& a, const Event& b) {
+              const int c = user_comparator_->Compare(a.boundary.user_key,
+                                                      b.boundary.user_key);
+              return c < 0 || (c == 0 && !a.boundary.after_key &&
+                               b.boundary.after_key);
+            });
 
-  int level = vstorage->num_non_empty_levels() - 1;
-  if (vstorage->LevelFilesBrief(level).num_files > 0) {
-    files_ = vstorage->LevelFilesBrief(level);
-    return Status::OK();
+  std::vector<const FdWithKeyRange*> active(num_groups, nullptr);
+  // No file has keys before the first boundary
+  route_offsets_.assign(2, 0);
+  for (size_t i = 0; i < events.size();) {
+    const RouteBoundary& boundary = events[i].boundary;
+    for (; i < events.size() &&
+           events[i].boundary.after_key == boundary.after_key &&
+           user_comparator_->Compare(events[i].boundary.user_key,
+                                     boundary.user_key) == 0;
+         ++i) {
+      active[events[i].group] = events[i].file;
+    }
+    route_boundaries_.push_back(boundary);
+    for (const FdWithKeyRange* f : active) {
+      if (f != nullptr) {
+        route_files_.push_back(f);
+      }
+    }
+    route_offsets_.push_back(route_files_.size());
   }
-  return Status::NotSupported("no file exists");
+  return Status::OK();
 }
 
 Status CompactedDBImpl::Open(const Options& options,
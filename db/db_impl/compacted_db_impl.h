@@ -11,6 +11,14 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+// A read-only DB that serves Get and MultiGet straight from the table files
+// of the default column family, without memtables or SuperVersions. Used by
+// DB::OpenForReadOnly() when the WAL is empty, max_open_files is -1, and
+// there is no merge operator, blob file or range deletion.
+//
+// The files may be in any number of levels. Init() partitions the key space
+// into ranges covered by the same files, so a lookup takes one binary search
+// to find the files that may have the key, newest first.
 class CompactedDBImpl : public DBImpl {
  public:
   CompactedDBImpl(const DBOptions& options, const std::string& dbname);
@@ -106,13 +114,26 @@ class CompactedDBImpl : public DBImpl {
 
  private:
   friend class DB;
-  inline size_t FindFile(const Slice& key);
+
+  // Where the files that may have a key change: at `user_key` if not
+  // `after_key`, else right after it.
+  struct RouteBoundary {
+    Slice user_key;
+    bool after_key;
+  };
+
+  // Returns the index of the range of `user_key`; its files are
+  // route_files_[route_offsets_[i]] up to route_offsets_[i + 1].
+  size_t FindRoute(const Slice& user_key) const;
   Status Init(const Options& options);
+  Status BuildRoutes(const VersionStorageInfo* vstorage);
 
   ColumnFamilyData* cfd_;
   Version* version_;
   const Comparator* user_comparator_;
-  LevelFilesBrief files_;
+  std::vector<RouteBoundary> route_boundaries_;
+  std::vector<size_t> route_offsets_;
+  std::vector<const FdWithKeyRange*> route_files_;
 };
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // ROCKSDB_LITE
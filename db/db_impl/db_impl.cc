@@ -25,7 +25,10 @@
 #include <utility>
 #include <vector>
 
+#include "cache/cache_entry_roles.h"
 #include "db/arena_wrapped_db_iter.h"
+#include "db/auto_tuner.h"
+#include "db/block_cache_hot_set.h"
 #include "db/builder.h"
 #include "db/compaction/compaction_job.h"
 #include "db/db_info_dumper.h"
@@ -36,6 +39,7 @@
 #include "db/external_sst_file_ingestion_job.h"
 #include "db/flush_job.h"
 #include "db/forward_iterator.h"
+#include "db/hot_key_cache.h"
 #include "db/import_column_family_job.h"
 #include "db/job_context.h"
 #include "db/log_reader.h"
@@ -101,6 +105,7 @@
 #include "util/crc32c.h"
 #include "util/defer.h"
 #include "util/mutexlock.h"
+#include "util/random.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 
@@ -195,6 +200,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
       bg_purge_scheduled_(0),
+      bg_open_table_files_scheduled_(0),
       disable_delete_obsolete_files_(0),
       pending_purge_obsolete_files_(0),
       delete_obsolete_files_last_run_(immutable_db_options_.clock->NowMicros()),
@@ -539,7 +545,7 @@ Status DBImpl::CloseHelper() {
   // Wait for background work to finish
   while (bg_bottom_compaction_scheduled_ || bg_compaction_scheduled_ ||
          bg_flush_scheduled_ || bg_purge_scheduled_ ||
-         pending_purge_obsolete_files_ ||
+         bg_open_table_files_scheduled_ || pending_purge_obsolete_files_ ||
          error_handler_.IsRecoveryInProgress()) {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
     bg_cv_.Wait();
@@ -773,7 +779,8 @@ void DBImpl::StartPeriodicWorkScheduler() {
 
   periodic_work_scheduler_->Register(
       this, mutable_db_options_.stats_dump_period_sec,
-      mutable_db_options_.stats_persist_period_sec);
+      mutable_db_options_.stats_persist_period_sec,
+      immutable_db_options_.auto_tune_period_sec);
 #endif  // !ROCKSDB_LITE
 }
 
@@ -824,23 +831,32 @@ void DBImpl::PersistStats() {
   if (immutable_db_options_.persist_stats_to_disk) {
     WriteBatch batch;
     Status s = Status::OK();
+    std::string schema;
+    uint64_t schema_id = 0;
     if (stats_slice_initialized_) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
                      "Reading %" ROCKSDB_PRIszt " stats from statistics\n",
                      stats_slice_.size());
+      // calculate the delta from last time
+      std::map<std::string, uint64_t> stats_delta;
       for (const auto& stat : stats_map) {
-        if (s.ok()) {
-          char key[100];
-          int length =
-              EncodePersistentStatsKey(now_seconds, stat.first, 100, key);
-          // calculate the delta from last time
-          if (stats_slice_.find(stat.first) != stats_slice_.end()) {
-            uint64_t delta = stat.second - stats_slice_[stat.first];
-            s = batch.Put(persist_stats_cf_handle_,
-                          Slice(key, std::min(100, length)), ToString(delta));
-          }
+        auto it = stats_slice_.find(stat.first);
+        if (it != stats_slice_.end()) {
+          stats_delta[stat.first] = stat.second - it->second;
         }
       }
+      // Write the schema with the first record that uses it
+      schema_id = EncodePersistentStatsSchema(stats_delta, &schema);
+      if (persist_stats_schema_id_ != schema_id) {
+        s = batch.Put(persist_stats_cf_handle_,
+                      PersistentStatsSchemaKey(schema_id), schema);
+      }
+      if (s.ok()) {
+        std::string record;
+        EncodePersistentStatsRecord(schema_id, stats_delta, &record);
+        s = batch.Put(persist_stats_cf_handle_,
+                      PersistentStatsRecordKey(now_seconds), record);
+      }
     }
     stats_slice_initialized_ = true;
     std::swap(stats_slice_, stats_map);
@@ -851,6 +867,9 @@ void DBImpl::PersistStats() {
       wo.sync = false;
       s = Write(wo, &batch);
     }
+    if (s.ok() && !schema.empty()) {
+      persist_stats_schema_id_ = schema_id;
+    }
     if (!s.ok()) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
                      "Writing to persistent stats CF failed -- %s",
@@ -1016,6 +1035,80 @@ void DBImpl::FlushInfoLog() {
   LogFlush(immutable_db_options_.info_log);
 }
 
+void DBImpl::AutoTune() {
+#ifndef ROCKSDB_LITE
+  if (shutdown_initiated_) {
+    return;
+  }
+  TEST_SYNC_POINT("DBImpl::AutoTune:StartRunning");
+  if (auto_tuner_ == nullptr) {
+    auto_tuner_.reset(
+        new AutoTuner(immutable_db_options_.auto_tune_write_p99_micros,
+                      immutable_db_options_.info_log.get()));
+  }
+
+  AutoTuner::Signals signals;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    signals.max_background_jobs = mutable_db_options_.max_background_jobs;
+    signals.compaction_readahead_size =
+        static_cast<int64_t>(mutable_db_options_.compaction_readahead_size);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->initialized() || cfd->IsDropped()) {
+        continue;
+      }
+      const MutableCFOptions* mutable_cf_options =
+          cfd->GetLatestMutableCFOptions();
+      AutoTuner::ColumnFamilySignals cf;
+      cf.id = cfd->GetID();
+      cf.name = cfd->GetName();
+      cf.l0_files = cfd->current()->storage_info()->NumLevelFiles(0);
+      cf.level0_slowdown_writes_trigger =
+          mutable_cf_options->level0_slowdown_writes_trigger;
+      cf.level0_stop_writes_trigger =
+          mutable_cf_options->level0_stop_writes_trigger;
+      InternalStats::CompactionDebtForecast forecast;
+      cfd->internal_stats()->GetCompactionDebtForecast(&forecast);
+      cf.seconds_to_stall = forecast.seconds_to_stall;
+      signals.column_families.push_back(std::move(cf));
+    }
+  }
+  RateLimiter* rate_limiter = immutable_db_options_.rate_limiter.get();
+  if (rate_limiter != nullptr) {
+    signals.rate_limiter_bytes_per_sec = rate_limiter->GetBytesPerSecond();
+  }
+  auto_tuner_->CollectStatistics(immutable_db_options_.stats, &signals);
+
+  AutoTuner::Decision decision;
+  auto_tuner_->Tune(signals, &decision);
+  if (decision.rate_limiter_bytes_per_sec > 0) {
+    rate_limiter->SetBytesPerSecond(decision.rate_limiter_bytes_per_sec);
+  }
+  if (!decision.db_options.empty()) {
+    Status s = SetDBOptions(decision.db_options);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "[auto-tune] SetDBOptions() failed: %s",
+                     s.ToString().c_str());
+    }
+  }
+  for (const auto& cf_options : decision.cf_options) {
+    std::unique_ptr<ColumnFamilyHandle> cfh =
+        GetColumnFamilyHandleUnlocked(cf_options.first);
+    if (cfh == nullptr) {
+      continue;
+    }
+    Status s = SetOptions(cfh.get(), cf_options.second);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "[auto-tune] SetOptions() failed: %s",
+                     s.ToString().c_str());
+    }
+  }
+  TEST_SYNC_POINT("DBImpl::AutoTune:Done");
+#endif  // !ROCKSDB_LITE
+}
+
 Status DBImpl::TablesRangeTombstoneSummary(ColumnFamilyHandle* column_family,
                                            int max_entries_to_print,
                                            std::string* out_str) {
@@ -1206,7 +1299,8 @@ Status DBImpl::SetDBOptions(
         periodic_work_scheduler_->Unregister(this);
         periodic_work_scheduler_->Register(
             this, new_options.stats_dump_period_sec,
-            new_options.stats_persist_period_sec);
+            new_options.stats_persist_period_sec,
+            immutable_db_options_.auto_tune_period_sec);
         mutex_.Lock();
       }
       write_controller_.set_max_delayed_write_rate(
@@ -1564,6 +1658,105 @@ void DBImpl::BackgroundCallPurge() {
   mutex_.Unlock();
 }
 
+void DBImpl::ScheduleOpenTableFiles() {
+  mutex_.AssertHeld();
+  assert(opened_successfully_);
+
+  bg_open_table_files_scheduled_++;
+  env_->Schedule(&DBImpl::BGWorkOpenTableFiles, this, Env::Priority::LOW,
+                 nullptr);
+}
+
+void DBImpl::BackgroundCallOpenTableFiles() {
+  TEST_SYNC_POINT("DBImpl::BackgroundCallOpenTableFiles:Start");
+  struct FileToOpen {
+    Version* version;
+    const FileMetaData* file;
+    int level;
+  };
+  std::vector<Version*> versions;
+  std::vector<FileToOpen> files;
+
+  mutex_.Lock();
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped() || !cfd->initialized()) {
+      continue;
+    }
+    Version* const version = cfd->current();
+    version->Ref();
+    versions.push_back(version);
+  }
+  mutex_.Unlock();
+
+  // Level 0 of all column families first, as every read may touch its
+  // files, then the smaller levels above the larger ones
+  int max_num_levels = 0;
+  for (Version* version : versions) {
+    max_num_levels =
+        std::max(max_num_levels, version->storage_info()->num_levels());
+  }
+  for (int level = 0; level < max_num_levels; ++level) {
+    for (Version* version : versions) {
+      const VersionStorageInfo* vstorage = version->storage_info();
+      if (level >= vstorage->num_levels()) {
+        continue;
+      }
+      for (const FileMetaData* f : vstorage->LevelFiles(level)) {
+        if (f->fd.table_reader == nullptr) {
+          files.push_back({version, f, level});
+        }
+      }
+    }
+  }
+
+  size_t num_opened = 0;
+  const uint64_t start_micros = immutable_db_options_.clock->NowMicros();
+  for (const FileToOpen& to_open : files) {
+    if (shutting_down_.load(std::memory_order_acquire) ||
+        table_cache_->GetUsage() >= table_cache_->GetCapacity()) {
+      break;
+    }
+    ColumnFamilyData* const cfd = to_open.version->cfd();
+    const MutableCFOptions& mutable_cf_options =
+        to_open.version->GetMutableCFOptions();
+    Cache::Handle* handle = nullptr;
+    Status s = cfd->table_cache()->FindTable(
+        ReadOptions(), file_options_, cfd->internal_comparator(),
+        to_open.file->fd, &handle,
+        mutable_cf_options.prefix_extractor.get(), false /* no_io */,
+        true /* record_read_stats */,
+        cfd->internal_stats()->GetFileReadHist(to_open.level),
+        false /* skip_filters */, to_open.level,
+        true /* prefetch_index_and_filter_in_cache */,
+        MaxFileSizeForL0MetaPin(mutable_cf_options));
+    if (s.ok()) {
+      cfd->table_cache()->ReleaseHandle(handle);
+      ++num_opened;
+    } else {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Failed to open table file #%" PRIu64 ": %s",
+                     to_open.file->fd.GetNumber(), s.ToString().c_str());
+    }
+  }
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Opened %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+                 " table files in the background in %" PRIu64 " us",
+                 num_opened, files.size(),
+                 immutable_db_options_.clock->NowMicros() - start_micros);
+  TEST_SYNC_POINT("DBImpl::BackgroundCallOpenTableFiles:Done");
+
+  mutex_.Lock();
+  for (Version* version : versions) {
+    version->Unref();
+  }
+  bg_open_table_files_scheduled_--;
+
+  bg_cv_.SignalAll();
+  // IMPORTANT: there should be no code after calling SignalAll. See
+  // BackgroundCallPurge().
+  mutex_.Unlock();
+}
+
 namespace {
 struct IterState {
   IterState(DBImpl* _db, InstrumentedMutex* _mu, SuperVersion* _super_version,
@@ -1618,6 +1811,33 @@ static void CleanupIteratorState(void* arg1, void* /*arg2*/) {
 
   delete state;
 }
+
+// Pins memtable values with a reference on the SuperVersion that holds the
+// memtables, released the same way as the one of an iterator.
+class SuperVersionValuePinner : public MemTableValuePinner {
+ public:
+  SuperVersionValuePinner(DBImpl* db, InstrumentedMutex* mu,
+                          SuperVersion* super_version, bool background_purge,
+                          uint64_t min_value_size)
+      : MemTableValuePinner(min_value_size),
+        db_(db),
+        mu_(mu),
+        super_version_(super_version),
+        background_purge_(background_purge) {}
+
+  void Pin(const Slice& value, PinnableSlice* result) override {
+    super_version_->Ref();
+    result->PinSlice(
+        value, CleanupIteratorState,
+        new IterState(db_, mu_, super_version_, background_purge_), nullptr);
+  }
+
+ private:
+  DBImpl* db_;
+  InstrumentedMutex* mu_;
+  SuperVersion* super_version_;
+  bool background_purge_;
+};
 }  // namespace
 
 InternalIterator* DBImpl::NewInternalIterator(const ReadOptions& read_options,
@@ -1634,7 +1854,8 @@ InternalIterator* DBImpl::NewInternalIterator(const ReadOptions& read_options,
   MergeIteratorBuilder merge_iter_builder(
       &cfd->internal_comparator(), arena,
       !read_options.total_order_seek &&
-          super_version->mutable_cf_options.prefix_extractor != nullptr);
+          super_version->mutable_cf_options.prefix_extractor != nullptr,
+      super_version->mutable_cf_options.use_loser_tree_merging_iterator);
   // Collect iterator for mutable mem
   merge_iter_builder.AddIterator(
       super_version->mem->NewIterator(read_options, arena));
@@ -1696,10 +1917,73 @@ Status DBImpl::Get(const ReadOptions& read_options,
   get_impl_options.column_family = column_family;
   get_impl_options.value = value;
   get_impl_options.timestamp = timestamp;
+#ifndef ROCKSDB_LITE
+  if (UNLIKELY(ShouldSampleRequest())) {
+    return SampleRequest(SampledRequestType::kGet, column_family, [&]() {
+      return GetImpl(read_options, key, get_impl_options);
+    });
+  }
+#endif  // !ROCKSDB_LITE
   Status s = GetImpl(read_options, key, get_impl_options);
   return s;
 }
 
+#ifndef ROCKSDB_LITE
+bool DBImpl::ShouldSampleRequest() const {
+  const uint32_t one_in = immutable_db_options_.perf_context_sample_one_in;
+  return one_in > 0 && GetPerfLevel() == PerfLevel::kDisable &&
+         Random::GetTLSInstance()->OneIn(static_cast<int>(one_in));
+}
+
+Status DBImpl::SampleRequest(SampledRequestType type,
+                             ColumnFamilyHandle* column_family,
+                             const std::function<Status()>& request) {
+  PerfContext* perf_context = get_perf_context();
+  IOStatsContext* iostats_context = get_iostats_context();
+  const PerfContext saved_perf_context = *perf_context;
+  const IOStatsContext saved_iostats_context = *iostats_context;
+  perf_context->Reset();
+  iostats_context->Reset();
+  SetPerfLevel(PerfLevel::kEnableTimeExceptForMutex);
+
+  const uint64_t start_micros = immutable_db_options_.clock->NowMicros();
+  Status s = request();
+  SampledRequestInfo info;
+  info.latency_micros = immutable_db_options_.clock->NowMicros() - start_micros;
+
+  SetPerfLevel(PerfLevel::kDisable);
+  info.type = type;
+  if (column_family != nullptr) {
+    info.cf_name = column_family->GetName();
+  }
+  info.status = s;
+  info.perf_context = *perf_context;
+  info.iostats_context = *iostats_context;
+  *perf_context = saved_perf_context;
+  *iostats_context = saved_iostats_context;
+
+  if (type == SampledRequestType::kGet) {
+    RecordInHistogram(stats_, SAMPLED_GET_MEMTABLE_NANOS,
+                      info.perf_context.get_from_memtable_time);
+    RecordInHistogram(stats_, SAMPLED_GET_FILTER_NANOS,
+                      info.perf_context.read_filter_block_nanos);
+    RecordInHistogram(stats_, SAMPLED_GET_INDEX_NANOS,
+                      info.perf_context.read_index_block_nanos);
+    RecordInHistogram(stats_, SAMPLED_GET_DATA_BLOCK_NANOS,
+                      info.perf_context.new_table_block_iter_nanos);
+    RecordInHistogram(stats_, SAMPLED_GET_DECOMPRESS_NANOS,
+                      info.perf_context.block_decompress_time);
+    RecordInHistogram(stats_, SAMPLED_GET_IO_NANOS,
+                      info.iostats_context.read_nanos);
+  }
+  for (const auto& listener : immutable_db_options_.listeners) {
+    listener->OnRequestSampled(info);
+  }
+  info.status.PermitUncheckedError();
+  return s;
+}
+#endif  // !ROCKSDB_LITE
+
 namespace {
 class GetWithTimestampReadCallback : public ReadCallback {
  public:
@@ -1709,6 +1993,46 @@ class GetWithTimestampReadCallback : public ReadCallback {
     return seq <= max_visible_seq_;
   }
 };
+
+// Lets the write-back of a value merged by a Get() through only if the key
+// has not been written since it was read, going by the memtables as
+// OptimisticTransaction does.
+class CollapseMergeOperandsCallback : public WriteCallback {
+ public:
+  CollapseMergeOperandsCallback(DBImpl* db, ColumnFamilyData* cfd,
+                                const Slice& key, SequenceNumber read_seq)
+      : db_(db), cfd_(cfd), key_(key), read_seq_(read_seq) {}
+
+  Status Callback(DB* /*db*/) override {
+    SuperVersion* sv = db_->GetAndRefSuperVersion(cfd_);
+    Status s;
+    SequenceNumber earliest_seq =
+        db_->GetEarliestMemTableSequenceNumber(sv, true /* include_history */);
+    if (earliest_seq == kMaxSequenceNumber || read_seq_ < earliest_seq) {
+      s = Status::Busy("Memtables do not reach back to the read");
+    } else {
+      SequenceNumber seq = kMaxSequenceNumber;
+      bool found_record_for_key = false;
+      s = db_->GetLatestSequenceForKey(sv, key_, true /* cache_only */,
+                                       read_seq_, &seq, &found_record_for_key);
+      if (s.ok() || s.IsNotFound() || s.IsMergeInProgress()) {
+        s = found_record_for_key && seq > read_seq_
+                ? Status::Busy("Key written since the read")
+                : Status::OK();
+      }
+    }
+    db_->ReturnAndCleanupSuperVersion(cfd_, sv);
+    return s;
+  }
+
+  bool AllowWriteBatching() override { return true; }
+
+ private:
+  DBImpl* db_;
+  ColumnFamilyData* cfd_;
+  Slice key_;
+  SequenceNumber read_seq_;
+};
 }  // namespace
 
 Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
@@ -1738,6 +2062,8 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(
       get_impl_options.column_family);
   auto cfd = cfh->cfd();
+  Statistics* const cf_stats = cfd->ioptions()->cf_statistics.get();
+  StopWatch cf_sw(immutable_db_options_.clock, cf_stats, DB_GET);
 
   if (tracer_) {
     // TODO: This mutex should be removed later, to improve performance when
@@ -1822,24 +2148,71 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
                         has_unpersisted_data_.load(std::memory_order_relaxed));
   bool done = false;
   std::string* timestamp = ts_sz > 0 ? get_impl_options.timestamp : nullptr;
-  if (!skip_memtable) {
+
+  // Only plain reads of the latest data use the hot key cache.
+  HotKeyCache* hot_key_cache =
+      sv->hot_key_cache != nullptr && get_impl_options.get_value &&
+              get_impl_options.callback == nullptr &&
+              get_impl_options.is_blob_index == nullptr &&
+              !read_options.ignore_range_deletions &&
+              read_options.read_tier == kReadAllTier
+          ? sv->hot_key_cache.get()
+          : nullptr;
+  uint64_t hot_key_hash = 0;
+  bool hot_key_hit = false;
+  if (hot_key_cache != nullptr) {
+    hot_key_hash = HotKeyCache::Hash(key);
+    bool found = false;
+    if (hot_key_cache->Lookup(key, hot_key_hash, snapshot,
+                              sv->mem->HotKeyLastWriteSeq(hot_key_hash),
+                              get_impl_options.value->GetSelf(), &found)) {
+      hot_key_hit = true;
+      done = true;
+      if (found) {
+        get_impl_options.value->PinSelf();
+      } else {
+        s = Status::NotFound();
+      }
+      RecordTick(stats_, HOT_KEY_CACHE_HIT);
+    } else {
+      RecordTick(stats_, HOT_KEY_CACHE_MISS);
+    }
+  }
+
+  if (!done && !skip_memtable) {
     // Get value associated with key
     if (get_impl_options.get_value) {
+      SuperVersionValuePinner sv_pinner(
+          this, &mutex_, sv,
+          read_options.background_purge_on_iterator_cleanup ||
+              immutable_db_options_.avoid_unnecessary_blocking_io,
+          read_options.min_memtable_value_size_to_pin);
+      MemTableValuePinner* pinner =
+          read_options.min_memtable_value_size_to_pin !=
+                  std::numeric_limits<uint64_t>::max()
+              ? &sv_pinner
+              : nullptr;
       if (sv->mem->Get(lkey, get_impl_options.value->GetSelf(), timestamp, &s,
                        &merge_context, &max_covering_tombstone_seq,
                        read_options, get_impl_options.callback,
-                       get_impl_options.is_blob_index)) {
+                       get_impl_options.is_blob_index, true /* do_merge */,
+                       get_impl_options.value, pinner)) {
         done = true;
-        get_impl_options.value->PinSelf();
+        if (!get_impl_options.value->IsPinned()) {
+          get_impl_options.value->PinSelf();
+        }
         RecordTick(stats_, MEMTABLE_HIT);
       } else if ((s.ok() || s.IsMergeInProgress()) &&
                  sv->imm->Get(lkey, get_impl_options.value->GetSelf(),
                               timestamp, &s, &merge_context,
                               &max_covering_tombstone_seq, read_options,
                               get_impl_options.callback,
-                              get_impl_options.is_blob_index)) {
+                              get_impl_options.is_blob_index,
+                              get_impl_options.value, pinner)) {
         done = true;
-        get_impl_options.value->PinSelf();
+        if (!get_impl_options.value->IsPinned()) {
+          get_impl_options.value->PinSelf();
+        }
         RecordTick(stats_, MEMTABLE_HIT);
       }
     } else {
@@ -1876,12 +2249,36 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
     RecordTick(stats_, MEMTABLE_MISS);
   }
 
+  // Only reads of the latest data, as seen by every reader, are written back.
+  // A read at an explicit snapshot could also come from the write path, see
+  // MemTableInserter::MergeCF().
+  const size_t collapse_threshold =
+      sv->mutable_cf_options.merge_operands_collapse_threshold;
+  const bool collapse_merge_operands =
+      collapse_threshold > 0 && s.ok() && get_impl_options.get_value &&
+      merge_context.GetNumOperands() > collapse_threshold &&
+      read_options.snapshot == nullptr && ts_sz == 0 &&
+      get_impl_options.callback == nullptr &&
+      get_impl_options.is_blob_index == nullptr &&
+      !read_options.ignore_range_deletions &&
+      read_options.read_tier == kReadAllTier && !two_write_queues_ &&
+      !seq_per_batch_;
+
   {
     PERF_TIMER_GUARD(get_post_process_time);
 
+    if (hot_key_cache != nullptr && !hot_key_hit &&
+        read_options.snapshot == nullptr && (s.ok() || s.IsNotFound())) {
+      Slice value(get_impl_options.value->data(),
+                  get_impl_options.value->size());
+      hot_key_cache->Insert(key, hot_key_hash, snapshot,
+                            s.ok() ? &value : nullptr);
+    }
+
     ReturnAndCleanupSuperVersion(cfd, sv);
 
     RecordTick(stats_, NUMBER_KEYS_READ);
+    RecordTick(cf_stats, NUMBER_KEYS_READ);
     size_t size = 0;
     if (s.ok()) {
       if (get_impl_options.get_value) {
@@ -1904,13 +2301,164 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
         }
       }
       RecordTick(stats_, BYTES_READ, size);
+      RecordTick(cf_stats, BYTES_READ, size);
       PERF_COUNTER_ADD(get_read_bytes, size);
     }
     RecordInHistogram(stats_, BYTES_PER_READ, size);
+    RecordInHistogram(cf_stats, BYTES_PER_READ, size);
+  }
+
+  if (collapse_merge_operands) {
+    TEST_SYNC_POINT("DBImpl::GetImpl:BeforeCollapseMergeOperands");
+    WriteBatch batch;
+    Status ws = batch.Put(get_impl_options.column_family, key,
+                          *get_impl_options.value);
+    if (ws.ok()) {
+      // The value is already in the DB as merge operands, so rather skip the
+      // write-back than hold up the read in a write stall.
+      WriteOptions write_options;
+      write_options.no_slowdown = true;
+      CollapseMergeOperandsCallback callback(this, cfd, key, snapshot);
+      ws = WriteImpl(write_options, &batch, &callback);
+    }
+    if (ws.ok()) {
+      RecordTick(stats_, MERGE_OPERANDS_COLLAPSED);
+    } else {
+      RecordTick(stats_, MERGE_OPERANDS_COLLAPSE_ABORTED);
+    }
   }
   return s;
 }
 
+void DBImpl::MultiGetMergeOperands(
+    const ReadOptions& read_options, ColumnFamilyHandle* column_family,
+    const size_t num_keys, const Slice* keys, PinnableSlice* merge_operands,
+    GetMergeOperandsOptions* get_merge_operands_options,
+    int* number_of_operands, Status* statuses) {
+  assert(column_family);
+  const Comparator* ucmp = column_family->GetComparator();
+  assert(ucmp);
+  if (num_keys == 0 || ucmp->timestamp_size() > 0) {
+    // Timestamps need the visibility checks of GetImpl()
+    DB::MultiGetMergeOperands(read_options, column_family, num_keys, keys,
+                              merge_operands, get_merge_operands_options,
+                              number_of_operands, statuses);
+    return;
+  }
+
+  PERF_CPU_TIMER_GUARD(get_cpu_nanos, immutable_db_options_.clock);
+  StopWatch sw(immutable_db_options_.clock, stats_, DB_MULTIGET);
+  PERF_TIMER_GUARD(get_snapshot_time);
+
+  auto cfd = static_cast_with_check<ColumnFamilyHandleImpl>(column_family)
+                 ->cfd();
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+  SequenceNumber snapshot;
+  if (read_options.snapshot != nullptr) {
+    snapshot =
+        static_cast<const SnapshotImpl*>(read_options.snapshot)->number_;
+  } else {
+    // Assigned after referencing the super version, see GetImpl()
+    snapshot = last_seq_same_as_publish_seq_
+                   ? versions_->LastSequence()
+                   : versions_->LastPublishedSequence();
+  }
+  PERF_TIMER_STOP(get_snapshot_time);
+
+  // Visiting the keys in order keeps the memtable and block lookups local
+  std::vector<size_t> order(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return ucmp->Compare(keys[a], keys[b]) < 0;
+  });
+
+  const size_t max_operands = static_cast<size_t>(
+      get_merge_operands_options->expected_max_number_of_operands);
+  const bool skip_memtable =
+      read_options.read_tier == kPersistedTier &&
+      has_unpersisted_data_.load(std::memory_order_relaxed);
+  // Memtable operands are copied into the MergeContext with in-place updates
+  SuperVersionValuePinner sv_pinner(
+      this, &mutex_, sv,
+      read_options.background_purge_on_iterator_cleanup ||
+          immutable_db_options_.avoid_unnecessary_blocking_io,
+      read_options.min_memtable_value_size_to_pin);
+  const bool pin_memtable_operands =
+      read_options.min_memtable_value_size_to_pin !=
+          std::numeric_limits<uint64_t>::max() &&
+      !sv->mem->GetImmutableMemTableOptions()->inplace_update_support;
+  // Keeps its operand list allocated across keys
+  MergeContext merge_context;
+  uint64_t bytes_read = 0;
+  for (size_t idx : order) {
+    merge_context.Clear();
+    SequenceNumber max_covering_tombstone_seq = 0;
+    Status s;
+    LookupKey lkey(keys[idx], snapshot);
+    bool done = false;
+    number_of_operands[idx] = 0;
+    if (!skip_memtable) {
+      if (sv->mem->Get(lkey, /*value*/ nullptr, /*timestamp=*/nullptr, &s,
+                       &merge_context, &max_covering_tombstone_seq,
+                       read_options, nullptr, nullptr, false)) {
+        done = true;
+        RecordTick(stats_, MEMTABLE_HIT);
+      } else if ((s.ok() || s.IsMergeInProgress()) &&
+                 sv->imm->GetMergeOperands(lkey, &s, &merge_context,
+                                           &max_covering_tombstone_seq,
+                                           read_options)) {
+        done = true;
+        RecordTick(stats_, MEMTABLE_HIT);
+      }
+      if (!done && !s.ok() && !s.IsMergeInProgress()) {
+        statuses[idx] = s;
+        continue;
+      }
+    }
+    // The operands found so far are the newest ones
+    const size_t num_memtable_operands = merge_context.GetNumOperands();
+    if (!done) {
+      PERF_TIMER_GUARD(get_from_output_files_time);
+      sv->current->Get(read_options, lkey, nullptr, nullptr, &s,
+                       &merge_context, &max_covering_tombstone_seq, nullptr,
+                       nullptr, nullptr, nullptr, nullptr, false);
+      RecordTick(stats_, MEMTABLE_MISS);
+    }
+    if (s.ok()) {
+      const std::vector<Slice>& operands = merge_context.GetOperands();
+      number_of_operands[idx] = static_cast<int>(operands.size());
+      if (operands.size() > max_operands) {
+        s = Status::Incomplete(
+            Status::SubCode::KMergeOperandsInsufficientCapacity);
+      } else {
+        PinnableSlice* out = merge_operands + idx * max_operands;
+        const size_t first_memtable_operand =
+            operands.size() - num_memtable_operands;
+        for (size_t j = 0; j < operands.size(); ++j) {
+          if (pin_memtable_operands && j >= first_memtable_operand &&
+              operands[j].size() >= sv_pinner.min_value_size()) {
+            sv_pinner.Pin(operands[j], &out[j]);
+          } else {
+            out[j].PinSelf(operands[j]);
+          }
+          bytes_read += operands[j].size();
+        }
+      }
+    }
+    statuses[idx] = s;
+  }
+
+  PERF_TIMER_GUARD(get_post_process_time);
+  ReturnAndCleanupSuperVersion(cfd, sv);
+  RecordTick(stats_, NUMBER_MULTIGET_CALLS);
+  RecordTick(stats_, NUMBER_MULTIGET_KEYS_READ, num_keys);
+  RecordTick(stats_, NUMBER_MULTIGET_BYTES_READ, bytes_read);
+  RecordInHistogram(stats_, BYTES_PER_MULTIGET, bytes_read);
+  PERF_COUNTER_ADD(multiget_read_bytes, bytes_read);
+}
+
 std::vector<Status> DBImpl::MultiGet(
     const ReadOptions& read_options,
     const std::vector<ColumnFamilyHandle*>& column_family,
@@ -2543,6 +3091,15 @@ Status DBImpl::MultiGetImpl(
   size_t keys_left = num_keys;
   Status s;
   uint64_t curr_value_size = 0;
+  SuperVersionValuePinner sv_pinner(
+      this, &mutex_, super_version,
+      read_options.background_purge_on_iterator_cleanup ||
+          immutable_db_options_.avoid_unnecessary_blocking_io,
+      read_options.min_memtable_value_size_to_pin);
+  MemTableValuePinner* pinner = read_options.min_memtable_value_size_to_pin !=
+                                        std::numeric_limits<uint64_t>::max()
+                                    ? &sv_pinner
+                                    : nullptr;
   while (keys_left) {
     if (read_options.deadline.count() &&
         immutable_db_options_.clock->NowMicros() >
@@ -2571,9 +3128,11 @@ Status DBImpl::MultiGetImpl(
         (read_options.read_tier == kPersistedTier &&
          has_unpersisted_data_.load(std::memory_order_relaxed));
     if (!skip_memtable) {
-      super_version->mem->MultiGet(read_options, &range, callback);
+      super_version->mem->MultiGet(read_options, &range, callback,
+                                   pinner);
       if (!range.empty()) {
-        super_version->imm->MultiGet(read_options, &range, callback);
+        super_version->imm->MultiGet(read_options, &range, callback,
+                                     pinner);
       }
       if (!range.empty()) {
         lookup_current = true;
@@ -3095,33 +3654,24 @@ const Snapshot* DBImpl::GetSnapshotForWriteConflictBoundary() {
 }
 #endif  // ROCKSDB_LITE
 
-SnapshotImpl* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary,
-                                      bool lock) {
+SnapshotImpl* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary) {
+  // returns null if the underlying memtable does not support snapshot.
+  if (!is_snapshot_supported_) {
+    return nullptr;
+  }
   int64_t unix_time = 0;
   immutable_db_options_.clock->GetCurrentTime(&unix_time)
       .PermitUncheckedError();  // Ignore error
   SnapshotImpl* s = new SnapshotImpl;
 
-  if (lock) {
-    mutex_.Lock();
-  }
-  // returns null if the underlying memtable does not support snapshot.
-  if (!is_snapshot_supported_) {
-    if (lock) {
-      mutex_.Unlock();
-    }
-    delete s;
-    return nullptr;
-  }
+  // The snapshot list has a mutex of its own. A snapshot taken while a flush
+  // or compaction runs is at least as new as all of its input, so it does
+  // not need to be among the snapshots the job started with.
   auto snapshot_seq = last_seq_same_as_publish_seq_
                           ? versions_->LastSequence()
                           : versions_->LastPublishedSequence();
-  SnapshotImpl* snapshot =
-      snapshots_.New(s, snapshot_seq, unix_time, is_write_conflict_boundary);
-  if (lock) {
-    mutex_.Unlock();
-  }
-  return snapshot;
+  return snapshots_.New(s, snapshot_seq, unix_time,
+                        is_write_conflict_boundary);
 }
 
 namespace {
@@ -3138,22 +3688,25 @@ bool CfdListContains(const CfdList& list, ColumnFamilyData* cfd) {
 
 void DBImpl::ReleaseSnapshot(const Snapshot* s) {
   const SnapshotImpl* casted_s = reinterpret_cast<const SnapshotImpl*>(s);
-  {
-    InstrumentedMutexLock l(&mutex_);
-    snapshots_.Delete(casted_s);
-    uint64_t oldest_snapshot;
-    if (snapshots_.empty()) {
+  snapshots_.Delete(casted_s);
+  auto get_oldest_snapshot = [this]() {
+    SequenceNumber oldest_snapshot;
+    if (!snapshots_.GetOldest(&oldest_snapshot)) {
       if (last_seq_same_as_publish_seq_) {
         oldest_snapshot = versions_->LastSequence();
       } else {
         oldest_snapshot = versions_->LastPublishedSequence();
       }
-    } else {
-      oldest_snapshot = snapshots_.oldest()->number_;
     }
-    // Avoid to go through every column family by checking a global threshold
-    // first.
-    if (oldest_snapshot > bottommost_files_mark_threshold_) {
+    return oldest_snapshot;
+  };
+  // Avoid to go through every column family, or even take the DB mutex, by
+  // checking a global threshold first.
+  if (get_oldest_snapshot() > bottommost_files_mark_threshold_.load()) {
+    InstrumentedMutexLock l(&mutex_);
+    // Other snapshots may have come and gone since
+    SequenceNumber oldest_snapshot = get_oldest_snapshot();
+    if (oldest_snapshot > bottommost_files_mark_threshold_.load()) {
       CfdList cf_scheduled;
       for (auto* cfd : *versions_->GetColumnFamilySet()) {
         cfd->current()->storage_info()->UpdateOldestSnapshot(oldest_snapshot);
@@ -3594,6 +4147,281 @@ Status DBImpl::GetApproximateSizes(const SizeApproximationOptions& options,
   return Status::OK();
 }
 
+Status DBImpl::GetApproximateKeyCounts(const SizeApproximationOptions& options,
+                                       ColumnFamilyHandle* column_family,
+                                       const Range* range, int n,
+                                       uint64_t* counts) {
+  if (!options.include_memtabtles && !options.include_files) {
+    return Status::InvalidArgument("Invalid options");
+  }
+
+  const Comparator* const ucmp = column_family->GetComparator();
+  assert(ucmp);
+  size_t ts_sz = ucmp->timestamp_size();
+
+  auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(column_family);
+  auto cfd = cfh->cfd();
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+  Version* v = sv->current;
+
+  for (int i = 0; i < n; i++) {
+    Slice start = range[i].start;
+    Slice limit = range[i].limit;
+
+    // Add timestamp if needed
+    std::string start_with_ts, limit_with_ts;
+    if (ts_sz > 0) {
+      AppendKeyWithMaxTimestamp(&start_with_ts, start, ts_sz);
+      AppendKeyWithMaxTimestamp(&limit_with_ts, limit, ts_sz);
+      start = start_with_ts;
+      limit = limit_with_ts;
+    }
+    // Convert user_key into a corresponding internal key.
+    InternalKey k1(start, kMaxSequenceNumber, kValueTypeForSeek);
+    InternalKey k2(limit, kMaxSequenceNumber, kValueTypeForSeek);
+    counts[i] = 0;
+    if (options.include_files) {
+      counts[i] += versions_->ApproximateNumEntries(
+          v, k1.Encode(), k2.Encode(), /*start_level=*/0,
+          /*end_level=*/-1, TableReaderCaller::kUserApproximateSize);
+    }
+    if (options.include_memtabtles) {
+      counts[i] += sv->mem->ApproximateStats(k1.Encode(), k2.Encode()).count;
+      counts[i] += sv->imm->ApproximateStats(k1.Encode(), k2.Encode()).count;
+    }
+  }
+
+  ReturnAndCleanupSuperVersion(cfd, sv);
+  return Status::OK();
+}
+
+Status DBImpl::GetKeyRangeSplits(ColumnFamilyHandle* column_family,
+                                 const Slice* begin, const Slice* end,
+                                 size_t num_ranges,
+                                 std::vector<std::string>* split_keys) {
+  if (num_ranges == 0 || split_keys == nullptr) {
+    return Status::InvalidArgument("Invalid arguments");
+  }
+  split_keys->clear();
+  const Comparator* const ucmp = column_family->GetComparator();
+  assert(ucmp);
+  if (ucmp->timestamp_size() > 0) {
+    return Status::NotSupported(
+        "GetKeyRangeSplits() does not support user-defined timestamps");
+  }
+  if (num_ranges == 1) {
+    return Status::OK();
+  }
+
+  auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(column_family);
+  auto cfd = cfh->cfd();
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+  std::vector<TableReader::Anchor> anchors;
+  Status s = sv->current->GetKeyAnchors(ReadOptions(), &anchors);
+  ReturnAndCleanupSuperVersion(cfd, sv);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Anchors from different files and levels interleave; once sorted, the
+  // range sizes accumulated up to an anchor approximate the amount of data
+  // before it.
+  std::sort(anchors.begin(), anchors.end(),
+            [ucmp](const TableReader::Anchor& a, const TableReader::Anchor& b) {
+              return ucmp->Compare(a.user_key, b.user_key) < 0;
+            });
+  auto in_range = [&](const Slice& key) {
+    return (begin == nullptr || ucmp->Compare(key, *begin) > 0) &&
+           (end == nullptr || ucmp->Compare(key, *end) < 0);
+  };
+  uint64_t total_size = 0;
+  for (const auto& anchor : anchors) {
+    if (in_range(anchor.user_key)) {
+      total_size += anchor.range_size;
+    }
+  }
+  // Ranges are cut at the first anchor that brings the accumulated size to
+  // the next multiple of total_size / num_ranges, but never at one with no
+  // data after it, which would leave the last range empty.
+  uint64_t accumulated = 0;
+  for (const auto& anchor : anchors) {
+    if (split_keys->size() + 1 >= num_ranges) {
+      break;
+    }
+    if (!in_range(anchor.user_key)) {
+      continue;
+    }
+    accumulated += anchor.range_size;
+    if (accumulated < total_size &&
+        accumulated * num_ranges >= total_size * (split_keys->size() + 1) &&
+        (split_keys->empty() ||
+         ucmp->Compare(anchor.user_key, split_keys->back()) > 0)) {
+      split_keys->push_back(anchor.user_key);
+    }
+  }
+  return Status::OK();
+}
+
+Status DBImpl::ForEachLiveTableFile(
+    const std::function<Status(ColumnFamilyData* cfd, SuperVersion* sv,
+                               const FileMetaData& file)>& fn) {
+  std::vector<ColumnFamilyData*> cfd_list;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->IsDropped() && cfd->initialized()) {
+        cfd->Ref();
+        cfd_list.push_back(cfd);
+      }
+    }
+  }
+  Status s;
+  for (auto cfd : cfd_list) {
+    if (!s.ok()) {
+      break;
+    }
+    SuperVersion* sv = GetAndRefSuperVersion(cfd);
+    VersionStorageInfo* vstorage = sv->current->storage_info();
+    for (int level = 0; level < vstorage->num_non_empty_levels() && s.ok();
+         level++) {
+      for (const FileMetaData* file : vstorage->LevelFiles(level)) {
+        s = fn(cfd, sv, *file);
+        if (!s.ok()) {
+          break;
+        }
+      }
+    }
+    ReturnAndCleanupSuperVersion(cfd, sv);
+  }
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : cfd_list) {
+      cfd->UnrefAndTryDelete();
+    }
+  }
+  return s;
+}
+
+Status DBImpl::DumpBlockCacheHotSet(const std::string& dump_path) {
+  // Map the block cache key prefix of each live file to its stable ID, per
+  // block cache
+  std::unordered_map<Cache*, std::unordered_map<std::string, std::string>>
+      file_ids_by_cache;
+  std::set<size_t> prefix_sizes;
+  Status s = ForEachLiveTableFile([&](ColumnFamilyData* cfd, SuperVersion* sv,
+                                      const FileMetaData& file) {
+    Cache* block_cache = cfd->ioptions()->table_factory->GetOptions<Cache>(
+        TableFactory::kBlockCacheOpts());
+    if (block_cache == nullptr) {
+      return Status::OK();
+    }
+    std::string prefix;
+    Status st = cfd->table_cache()->GetBlockCacheKeyPrefix(
+        ReadOptions(), cfd->internal_comparator(), file.fd, &prefix,
+        sv->mutable_cf_options.prefix_extractor.get());
+    if (!st.ok() || prefix.empty()) {
+      return st;
+    }
+    std::shared_ptr<const TableProperties> props;
+    st = sv->current->GetTableProperties(&props, &file);
+    if (st.ok()) {
+      file_ids_by_cache[block_cache][prefix] =
+          BlockCacheHotSet::GetFileId(*props, file.fd.GetNumber());
+      prefix_sizes.insert(prefix.size());
+    }
+    return st;
+  });
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Collect the data blocks under those prefixes
+  BlockCacheHotSet hot_set;
+  const auto role_map = CopyCacheDeleterRoleMap();
+  for (const auto& cache_and_ids : file_ids_by_cache) {
+    const auto& file_ids = cache_and_ids.second;
+    cache_and_ids.first->ApplyToAllEntries(
+        [&](const Slice& key, void* /*value*/, size_t /*charge*/,
+            Cache::DeleterFn deleter) {
+          auto role = role_map.find(deleter);
+          if (role == role_map.end() ||
+              role->second != CacheEntryRole::kDataBlock) {
+            return;
+          }
+          for (size_t prefix_size : prefix_sizes) {
+            if (key.size() <= prefix_size) {
+              continue;
+            }
+            auto it = file_ids.find(std::string(key.data(), prefix_size));
+            if (it == file_ids.end()) {
+              continue;
+            }
+            Slice rest(key.data() + prefix_size, key.size() - prefix_size);
+            uint64_t offset;
+            if (GetVarint64(&rest, &offset) && rest.empty()) {
+              hot_set.AddBlock(it->second, offset);
+              return;
+            }
+          }
+        },
+        {});
+  }
+
+  std::string data;
+  hot_set.EncodeTo(&data);
+  s = WriteStringToFile(env_, data, dump_path, /*should_sync=*/true);
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Dumped block cache hot set of %" ROCKSDB_PRIszt
+                   " files to %s",
+                   hot_set.NumFiles(), dump_path.c_str());
+  }
+  return s;
+}
+
+Status DBImpl::WarmUpBlockCache(const ReadOptions& read_options,
+                                const std::string& dump_path) {
+  std::string data;
+  Status s = ReadFileToString(env_, dump_path, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  BlockCacheHotSet hot_set;
+  s = hot_set.DecodeFrom(data);
+  if (!s.ok()) {
+    return s;
+  }
+  size_t num_files = 0;
+  s = ForEachLiveTableFile([&](ColumnFamilyData* cfd, SuperVersion* sv,
+                               const FileMetaData& file) {
+    if (shutting_down_.load(std::memory_order_acquire)) {
+      return Status::ShutdownInProgress();
+    }
+    std::shared_ptr<const TableProperties> props;
+    Status st = sv->current->GetTableProperties(&props, &file);
+    if (!st.ok()) {
+      return st;
+    }
+    const std::vector<uint64_t>* offsets = hot_set.GetBlockOffsets(
+        BlockCacheHotSet::GetFileId(*props, file.fd.GetNumber()));
+    if (offsets == nullptr) {
+      return Status::OK();
+    }
+    ++num_files;
+    st = cfd->table_cache()->WarmUpBlockCache(
+        read_options, cfd->internal_comparator(), file.fd, *offsets,
+        sv->mutable_cf_options.prefix_extractor.get());
+    // Table formats without a block cache have nothing to warm up
+    return st.IsNotSupported() ? Status::OK() : st;
+  });
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Warmed up block cache for %" ROCKSDB_PRIszt
+                 " of %" ROCKSDB_PRIszt " files from %s: %s",
+                 num_files, hot_set.NumFiles(), dump_path.c_str(),
+                 s.ToString().c_str());
+  return s;
+}
+
 std::list<uint64_t>::iterator
 DBImpl::CaptureCurrentFileNumberInPendingOutputs() {
   // We need to remember the iterator of our insert, because after the
@@ -3814,6 +4642,92 @@ Status DBImpl::DeleteFilesInRanges(ColumnFamilyHandle* column_family,
   return status;
 }
 
+Status DBImpl::DeleteFilesIf(
+    ColumnFamilyHandle* column_family,
+    const std::function<bool(const TableProperties&)>& predicate) {
+  auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(column_family);
+  ColumnFamilyData* cfd = cfh->cfd();
+
+  // Check the properties, which may have to be read, without the mutex
+  Version* version;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    version = cfd->current();
+    version->Ref();
+  }
+  Status status;
+  std::set<uint64_t> matching_files;
+  const auto* version_storage = version->storage_info();
+  for (int i = 0; status.ok() && i < version_storage->num_levels(); i++) {
+    for (const auto* level_file : version_storage->LevelFiles(i)) {
+      std::shared_ptr<const TableProperties> tp;
+      status = version->GetTableProperties(&tp, level_file);
+      if (!status.ok()) {
+        break;
+      }
+      if (predicate(*tp)) {
+        matching_files.insert(level_file->fd.GetNumber());
+      }
+    }
+  }
+
+  VersionEdit edit;
+  std::set<FileMetaData*> deleted_files;
+  JobContext job_context(next_job_id_.fetch_add(1), true);
+  {
+    InstrumentedMutexLock l(&mutex_);
+    version->Unref();
+    if (!status.ok() || matching_files.empty()) {
+      job_context.Clean();
+      return status;
+    }
+    Version* input_version = cfd->current();
+    auto* vstorage = input_version->storage_info();
+    for (int i = 0; i < vstorage->num_levels(); i++) {
+      for (auto* level_file : vstorage->LevelFiles(i)) {
+        if (level_file->being_compacted ||
+            matching_files.count(level_file->fd.GetNumber()) == 0) {
+          continue;
+        }
+        edit.SetColumnFamily(cfd->GetID());
+        edit.DeleteFile(i, level_file->fd.GetNumber());
+        deleted_files.insert(level_file);
+        level_file->being_compacted = true;
+      }
+    }
+    if (edit.GetDeletedFiles().empty()) {
+      job_context.Clean();
+      return status;
+    }
+    vstorage->ComputeCompactionScore(*cfd->ioptions(),
+                                     *cfd->GetLatestMutableCFOptions());
+    input_version->Ref();
+    status = versions_->LogAndApply(cfd, *cfd->GetLatestMutableCFOptions(),
+                                    &edit, &mutex_, directories_.GetDbDir());
+    if (status.ok()) {
+      InstallSuperVersionAndScheduleWork(cfd,
+                                         &job_context.superversion_contexts[0],
+                                         *cfd->GetLatestMutableCFOptions());
+    }
+    for (auto* deleted_file : deleted_files) {
+      deleted_file->being_compacted = false;
+    }
+    input_version->Unref();
+    FindObsoleteFiles(&job_context, false);
+  }  // lock released here
+
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "[%s] Deleted %" ROCKSDB_PRIszt " files by their properties",
+                 cfd->GetName().c_str(), deleted_files.size());
+  LogFlush(immutable_db_options_.info_log);
+  // remove files outside the db-lock
+  if (job_context.HaveSomethingToDelete()) {
+    PurgeObsoleteFiles(job_context);
+  }
+  job_context.Clean();
+  return status;
+}
+
 void DBImpl::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
   InstrumentedMutexLock l(&mutex_);
   versions_->GetLiveFilesMetaData(metadata);
@@ -4975,55 +5889,136 @@ Status DBImpl::VerifyChecksumInternal(const ReadOptions& read_options,
     sv_list.push_back(cfd->GetReferencedSuperVersion(this));
   }
 
+  // The files to verify, in the order of the column families, with the
+  // table files before the blob files. The checksums point into the file
+  // metadata, which the referenced super versions keep alive.
+  struct FileToVerify {
+    std::string fname;
+    uint64_t file_size;
+    const std::string* checksum;
+    const std::string* checksum_func_name;
+    // Into `opts_list`, for VerifyChecksum()
+    size_t opts_index;
+  };
+  std::vector<Options> opts_list;
+  std::vector<FileToVerify> files;
+  uint64_t total_bytes = 0;
   for (auto& sv : sv_list) {
     VersionStorageInfo* vstorage = sv->current->storage_info();
     ColumnFamilyData* cfd = sv->current->cfd();
-    Options opts;
     if (!use_file_checksum) {
       InstrumentedMutexLock l(&mutex_);
-      opts = Options(BuildDBOptions(immutable_db_options_, mutable_db_options_),
-                     cfd->GetLatestCFOptions());
+      opts_list.emplace_back(
+          BuildDBOptions(immutable_db_options_, mutable_db_options_),
+          cfd->GetLatestCFOptions());
     }
-    for (int i = 0; i < vstorage->num_non_empty_levels() && s.ok(); i++) {
-      for (size_t j = 0; j < vstorage->LevelFilesBrief(i).num_files && s.ok();
-           j++) {
+    const size_t opts_index = opts_list.empty() ? 0 : opts_list.size() - 1;
+    for (int i = 0; i < vstorage->num_non_empty_levels(); i++) {
+      for (size_t j = 0; j < vstorage->LevelFilesBrief(i).num_files; j++) {
         const auto& fd_with_krange = vstorage->LevelFilesBrief(i).files[j];
         const auto& fd = fd_with_krange.fd;
         const FileMetaData* fmeta = fd_with_krange.file_metadata;
         assert(fmeta);
-        std::string fname = TableFileName(cfd->ioptions()->cf_paths,
-                                          fd.GetNumber(), fd.GetPathId());
-        if (use_file_checksum) {
-          s = VerifyFullFileChecksum(fmeta->file_checksum,
-                                     fmeta->file_checksum_func_name, fname,
-                                     read_options);
-        } else {
-          s = ROCKSDB_NAMESPACE::VerifySstFileChecksum(opts, file_options_,
-                                                       read_options, fname);
-        }
+        files.push_back({TableFileName(cfd->ioptions()->cf_paths,
+                                       fd.GetNumber(), fd.GetPathId()),
+                         fd.GetFileSize(), &fmeta->file_checksum,
+                         &fmeta->file_checksum_func_name, opts_index});
+        total_bytes += fd.GetFileSize();
       }
     }
 
-    if (s.ok() && use_file_checksum) {
+    if (use_file_checksum) {
       const auto& blob_files = vstorage->GetBlobFiles();
       for (const auto& pair : blob_files) {
         const uint64_t blob_file_number = pair.first;
         const auto& meta = pair.second;
         assert(meta);
-        const std::string blob_file_name = BlobFileName(
-            cfd->ioptions()->cf_paths.front().path, blob_file_number);
-        s = VerifyFullFileChecksum(meta->GetChecksumValue(),
-                                   meta->GetChecksumMethod(), blob_file_name,
-                                   read_options);
-        if (!s.ok()) {
-          break;
-        }
+        files.push_back(
+            {BlobFileName(cfd->ioptions()->cf_paths.front().path,
+                          blob_file_number),
+             meta->GetBlobFileSize(), &meta->GetChecksumValue(),
+             &meta->GetChecksumMethod(), opts_index});
+        total_bytes += meta->GetBlobFileSize();
       }
     }
-    if (!s.ok()) {
-      break;
+  }
+
+  // Files are read from start to end, so a large readahead pays off
+  ReadOptions verify_read_options = read_options;
+  if (verify_read_options.readahead_size == 0) {
+    verify_read_options.readahead_size = kVerifyChecksumReadaheadSize;
+  }
+
+  SystemClock* const clock = immutable_db_options_.clock;
+  const uint64_t start_micros = clock->NowMicros();
+  uint64_t next_report_micros =
+      start_micros + kVerifyChecksumReportIntervalMicros;
+  std::atomic<size_t> next_file(0);
+  // Protects s and the progress below
+  std::mutex verify_mutex;
+  size_t num_files_verified = 0;
+  uint64_t bytes_verified = 0;
+  auto verify_files = [&]() {
+    while (true) {
+      const size_t i = next_file.fetch_add(1, std::memory_order_relaxed);
+      if (i >= files.size()) {
+        return;
+      }
+      const FileToVerify& file = files[i];
+      Status file_s;
+      if (use_file_checksum) {
+        file_s = VerifyFullFileChecksum(*file.checksum,
+                                        *file.checksum_func_name, file.fname,
+                                        verify_read_options);
+      } else {
+        file_s = ROCKSDB_NAMESPACE::VerifySstFileChecksum(
+            opts_list[file.opts_index], file_options_, verify_read_options,
+            file.fname);
+      }
+
+      std::lock_guard<std::mutex> lock(verify_mutex);
+      if (!file_s.ok()) {
+        if (s.ok()) {
+          s = file_s;
+        }
+        // Other threads stop after their current file
+        next_file.store(files.size(), std::memory_order_relaxed);
+        return;
+      }
+      ++num_files_verified;
+      bytes_verified += file.file_size;
+      const uint64_t now_micros = clock->NowMicros();
+      if (now_micros >= next_report_micros) {
+        ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                       "Verifying %s: %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+                       " files, %" PRIu64 " of %" PRIu64 " bytes",
+                       use_file_checksum ? "file checksums" : "checksums",
+                       num_files_verified, files.size(), bytes_verified,
+                       total_bytes);
+        next_report_micros = now_micros + kVerifyChecksumReportIntervalMicros;
+      }
     }
+  };
+  const size_t num_threads = std::min(
+      files.size(),
+      static_cast<size_t>(
+          std::max(immutable_db_options_.max_file_verification_threads, 1)));
+  std::vector<port::Thread> threads;
+  for (size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(verify_files);
+  }
+  verify_files();
+  for (auto& t : threads) {
+    t.join();
   }
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Verified %s of %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+                 " files, %" PRIu64 " bytes, with %" ROCKSDB_PRIszt
+                 " threads in %" PRIu64 " us: %s",
+                 use_file_checksum ? "file checksums" : "checksums",
+                 num_files_verified, files.size(), bytes_verified,
+                 std::max(num_threads, size_t{1}),
+                 clock->NowMicros() - start_micros, s.ToString().c_str());
 
   bool defer_purge =
           immutable_db_options().avoid_unnecessary_blocking_io;
@@ -5139,12 +6134,14 @@ Status DBImpl::EndBlockCacheTrace() {
 
 Status DBImpl::TraceIteratorSeek(const uint32_t& cf_id, const Slice& key,
                                  const Slice& lower_bound,
-                                 const Slice upper_bound) {
+                                 const Slice upper_bound, uint64_t seek_micros,
+                                 uint64_t next_count, uint64_t prev_count) {
   Status s;
   if (tracer_) {
     InstrumentedMutexLock lock(&trace_mutex_);
     if (tracer_) {
-      s = tracer_->IteratorSeek(cf_id, key, lower_bound, upper_bound);
+      s = tracer_->IteratorSeek(cf_id, key, lower_bound, upper_bound,
+                                seek_micros, next_count, prev_count);
     }
   }
   return s;
@@ -5152,12 +6149,16 @@ Status DBImpl::TraceIteratorSeek(const uint32_t& cf_id, const Slice& key,
 
 Status DBImpl::TraceIteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
                                         const Slice& lower_bound,
-                                        const Slice upper_bound) {
+                                        const Slice upper_bound,
+                                        uint64_t seek_micros,
+                                        uint64_t next_count,
+                                        uint64_t prev_count) {
   Status s;
   if (tracer_) {
     InstrumentedMutexLock lock(&trace_mutex_);
     if (tracer_) {
-      s = tracer_->IteratorSeekForPrev(cf_id, key, lower_bound, upper_bound);
+      s = tracer_->IteratorSeekForPrev(cf_id, key, lower_bound, upper_bound,
+                                       seek_micros, next_count, prev_count);
     }
   }
   return s;
@@ -70,6 +70,7 @@ class InMemoryStatsHistoryIterator;
 class MemTable;
 class PersistentStatsHistoryIterator;
 class PeriodicWorkScheduler;
+class AutoTuner;
 #ifndef NDEBUG
 class PeriodicWorkTestScheduler;
 #endif  // !NDEBUG
@@ -187,6 +188,16 @@ class DBImpl : public DB {
     return GetImpl(options, key, get_impl_options);
   }
 
+  // Looks the keys up in key order through one SuperVersion, reusing the
+  // MergeContext, and returns operands found in memtables pinned as Get()
+  // does with ReadOptions::min_memtable_value_size_to_pin.
+  using DB::MultiGetMergeOperands;
+  void MultiGetMergeOperands(
+      const ReadOptions& options, ColumnFamilyHandle* column_family,
+      const size_t num_keys, const Slice* keys, PinnableSlice* merge_operands,
+      GetMergeOperandsOptions* get_merge_operands_options,
+      int* number_of_operands, Status* statuses) override;
+
   using DB::MultiGet;
   virtual std::vector<Status> MultiGet(
       const ReadOptions& options,
@@ -290,6 +301,17 @@ class DBImpl : public DB {
                                            const Range& range,
                                            uint64_t* const count,
                                            uint64_t* const size) override;
+  Status GetApproximateKeyCounts(const SizeApproximationOptions& options,
+                                 ColumnFamilyHandle* column_family,
+                                 const Range* range, int n,
+                                 uint64_t* counts) override;
+  Status GetKeyRangeSplits(ColumnFamilyHandle* column_family,
+                           const Slice* begin, const Slice* end,
+                           size_t num_ranges,
+                           std::vector<std::string>* split_keys) override;
+  Status DumpBlockCacheHotSet(const std::string& dump_path) override;
+  Status WarmUpBlockCache(const ReadOptions& read_options,
+                          const std::string& dump_path) override;
   using DB::CompactRange;
   virtual Status CompactRange(const CompactRangeOptions& options,
                               ColumnFamilyHandle* column_family,
@@ -394,6 +416,15 @@ class DBImpl : public DB {
   Status DeleteFilesInRanges(ColumnFamilyHandle* column_family,
                              const RangePtr* ranges, size_t n,
                              bool include_end = true);
+  // Deletes the table files of the column family, on any level, whose
+  // properties satisfy `predicate`, without reading or compacting them. Like
+  // DeleteFilesInRanges(), it ignores snapshots, and it does not check for
+  // older versions of the keys in other files, so it is only meant for files
+  // whose data is obsolete as a whole, e.g. expired. Files that are being
+  // compacted are skipped.
+  Status DeleteFilesIf(
+      ColumnFamilyHandle* column_family,
+      const std::function<bool(const TableProperties&)>& predicate);
 
   virtual void GetLiveFilesMetaData(
       std::vector<LiveFileMetaData>* metadata) override;
@@ -447,6 +478,9 @@ class DBImpl : public DB {
   //                    with the MANIFEST. Currently, file checksums are
   //                    recomputed by reading all table files.
   //
+  // Files are verified by max_file_verification_threads threads, and the
+  // progress is logged.
+  //
   // Returns: OK if there is no file whose file or block checksum mismatches.
   Status VerifyChecksumInternal(const ReadOptions& read_options,
                                 bool use_file_checksum);
@@ -598,11 +632,21 @@ class DBImpl : public DB {
                                  bool* found_record_for_key,
                                  bool* is_blob_index = nullptr);
 
+  // Whether queries are being traced. Not synchronized with StartTrace()
+  // and EndTrace(), as iterators only use it to skip work when not tracing.
+  bool IsTracing() const { return tracer_ != nullptr; }
+
+  // Trace a Seek() or SeekForPrev() made at `seek_micros`, followed by
+  // `next_count` calls to Next() and `prev_count` calls to Prev()
   Status TraceIteratorSeek(const uint32_t& cf_id, const Slice& key,
-                           const Slice& lower_bound, const Slice upper_bound);
+                           const Slice& lower_bound, const Slice upper_bound,
+                           uint64_t seek_micros, uint64_t next_count,
+                           uint64_t prev_count);
   Status TraceIteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
                                   const Slice& lower_bound,
-                                  const Slice upper_bound);
+                                  const Slice upper_bound,
+                                  uint64_t seek_micros, uint64_t next_count,
+                                  uint64_t prev_count);
 #endif  // ROCKSDB_LITE
 
   // Similar to GetSnapshot(), but also lets the db know that this snapshot
@@ -689,6 +733,10 @@ class DBImpl : public DB {
   // Schedule a background job to actually delete obsolete files.
   void SchedulePurge();
 
+  // Schedule a background job to open the table files of the current
+  // versions. See DBOptions::open_table_files_in_background.
+  void ScheduleOpenTableFiles();
+
   const SnapshotList& snapshots() const { return snapshots_; }
 
   // load list of snapshots to `snap_vector` that is no newer than `max_seq`
@@ -698,7 +746,6 @@ class DBImpl : public DB {
   void LoadSnapshots(std::vector<SequenceNumber>* snap_vector,
                      SequenceNumber* oldest_write_conflict_snapshot,
                      const SequenceNumber& max_seq) const {
-    InstrumentedMutexLock l(mutex());
     snapshots().GetAll(snap_vector, oldest_write_conflict_snapshot, max_seq);
   }
 
@@ -1053,6 +1100,9 @@ class DBImpl : public DB {
   // flush LOG out of application buffer
   void FlushInfoLog();
 
+  // adjust mutable options to the load, see DBOptions::auto_tune_period_sec
+  void AutoTune();
+
   // Interface to block and signal the DB in case of stalling writes by
   // WriteBufferManager. Each DBImpl object contains ptr to WBMStallInterface.
   // When DB needs to be blocked or signalled by WriteBufferManager,
@@ -1217,6 +1267,18 @@ class DBImpl : public DB {
 #ifndef ROCKSDB_LITE
   void NotifyOnExternalFileIngested(
       ColumnFamilyData* cfd, const ExternalSstFileIngestionJob& ingestion_job);
+
+  // Whether the calling thread's request is to be run by SampleRequest(),
+  // see DBOptions::perf_context_sample_one_in
+  bool ShouldSampleRequest() const;
+
+  // Runs `request` with PerfContext and IOStatsContext timing enabled,
+  // records the breakdown in the SAMPLED_GET_* histograms and passes it to
+  // EventListener::OnRequestSampled(). The thread's contexts are restored
+  // afterwards.
+  Status SampleRequest(SampledRequestType type,
+                       ColumnFamilyHandle* column_family,
+                       const std::function<Status()>& request);
 #endif  // !ROCKSDB_LITE
 
   void NewThreadStatusCfInfo(ColumnFamilyData* cfd) const;
@@ -1247,6 +1309,13 @@ class DBImpl : public DB {
                    size_t batch_cnt = 0,
                    PreReleaseCallback* pre_release_callback = nullptr);
 
+  // Writes a disableWAL batch to the memtables without joining the write
+  // thread (see DBOptions::enable_no_wal_write_fast_path). Returns false,
+  // without writing, if the batch has to go through the write thread.
+  bool FastPathWriteImpl(const WriteOptions& write_options,
+                         WriteBatch* my_batch, uint64_t* seq_used,
+                         Status* status);
+
   Status PipelinedWriteImpl(const WriteOptions& options, WriteBatch* updates,
                             WriteCallback* callback = nullptr,
                             uint64_t* log_used = nullptr, uint64_t log_ref = 0,
@@ -1356,6 +1425,13 @@ class DBImpl : public DB {
   struct PrepickedCompaction;
   struct PurgeFileInfo;
 
+  // Calls fn for each table file of the current Version of each live column
+  // family, until it returns a non-OK status. Used by DumpBlockCacheHotSet()
+  // and WarmUpBlockCache().
+  Status ForEachLiveTableFile(
+      const std::function<Status(ColumnFamilyData* cfd, SuperVersion* sv,
+                                 const FileMetaData& file)>& fn);
+
   struct WriteContext {
     SuperVersionContext superversion_context;
     autovector<MemTable*> memtables_to_free_;
@@ -1444,6 +1520,8 @@ class DBImpl : public DB {
     DBImpl* db_;
 
     Env::Priority thread_pri_;
+    // When the flush was scheduled, for FLUSH_QUEUE_WAIT_MICROS
+    uint64_t schedule_time_us_;
   };
 
   // Information for a manual compaction
@@ -1481,6 +1559,8 @@ class DBImpl : public DB {
     // background compaction takes ownership of `prepicked_compaction`.
     PrepickedCompaction* prepicked_compaction;
     Env::Priority compaction_pri_;
+    // When the compaction was scheduled, for COMPACTION_QUEUE_WAIT_MICROS
+    uint64_t schedule_time_us_;
   };
 
   // Initialize the built-in column family for persistent stats. Depending on
@@ -1755,13 +1835,17 @@ class DBImpl : public DB {
   // separate, bottom-pri thread pool.
   static void BGWorkBottomCompaction(void* arg);
   static void BGWorkFlush(void* arg);
+  // Records how long a background job waited in the thread pool queue
+  void RecordQueueWait(Histograms histogram, uint64_t schedule_time_us);
   static void BGWorkPurge(void* arg);
+  static void BGWorkOpenTableFiles(void* arg);
   static void UnscheduleCompactionCallback(void* arg);
   static void UnscheduleFlushCallback(void* arg);
   void BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
                                 Env::Priority thread_pri);
   void BackgroundCallFlush(Env::Priority thread_pri);
   void BackgroundCallPurge();
+  void BackgroundCallOpenTableFiles();
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
                               LogBuffer* log_buffer,
                               PrepickedCompaction* prepicked_compaction,
@@ -1812,8 +1896,7 @@ class DBImpl : public DB {
   // WALs with log number up to up_to are not synced successfully.
   void MarkLogsNotSynced(uint64_t up_to);
 
-  SnapshotImpl* GetSnapshotImpl(bool is_write_conflict_boundary,
-                                bool lock = true);
+  SnapshotImpl* GetSnapshotImpl(bool is_write_conflict_boundary);
 
   uint64_t GetMaxTotalWalSize() const;
 
@@ -1980,7 +2063,8 @@ class DBImpl : public DB {
   // * if AnyManualCompaction, whenever a compaction finishes, even if it hasn't
   // made any progress
   // * whenever a compaction made any progress
-  // * whenever bg_flush_scheduled_ or bg_purge_scheduled_ value decreases
+  // * whenever bg_flush_scheduled_, bg_purge_scheduled_ or
+  // bg_open_table_files_scheduled_ value decreases
   // (i.e. whenever a flush is done, even if it didn't make any progress)
   // * whenever there is an error in background purge, flush or compaction
   // * whenever num_running_ingest_file_ goes to 0.
@@ -2005,6 +2089,12 @@ class DBImpl : public DB {
   // expesnive mutex_ lock during WAL write, which update log_empty_.
   bool log_empty_;
 
+  // LastSequence() and VersionSet::current_version_number() when
+  // SwitchMemtable() last made sure the empty column families' memtables
+  // have the latest creation sequence. Protected by mutex_.
+  SequenceNumber empty_cfs_updated_seq_ = kMaxSequenceNumber;
+  uint64_t empty_cfs_updated_version_number_ = 0;
+
   ColumnFamilyHandleImpl* persist_stats_cf_handle_;
 
   bool persistent_stats_cfd_exists_ = true;
@@ -2047,7 +2137,8 @@ class DBImpl : public DB {
   // threads. Protected by db mutex.
   autovector<log::Writer*> logs_to_free_;
 
-  bool is_snapshot_supported_;
+  // Changed under the DB mutex, read by GetSnapshotImpl() without it
+  std::atomic<bool> is_snapshot_supported_;
 
   std::map<uint64_t, std::map<std::string, uint64_t>> stats_history_;
 
@@ -2055,6 +2146,10 @@ class DBImpl : public DB {
 
   bool stats_slice_initialized_ = false;
 
+  // The id of the last schema written to the persistent stats column family
+  // by this DB instance, or 0
+  uint64_t persist_stats_schema_id_ = 0;
+
   Directories directories_;
 
   WriteBufferManager* write_buffer_manager_;
@@ -2147,6 +2242,9 @@ class DBImpl : public DB {
   // number of background obsolete file purge jobs, submitted to the HIGH pool
   int bg_purge_scheduled_;
 
+  // number of background jobs opening table files, submitted to the LOW pool
+  int bg_open_table_files_scheduled_;
+
   std::deque<ManualCompactionState*> manual_compaction_dequeue_;
 
   // shall we disable deletion of obsolete files
@@ -2193,6 +2291,11 @@ class DBImpl : public DB {
   // MSVC version 1800 still does not have constexpr for ::max()
   static const uint64_t kNoTimeOut = port::kMaxUint64;
 
+  // Readahead of VerifyChecksumInternal() if ReadOptions::readahead_size is
+  // not set, and how often it logs its progress
+  static const size_t kVerifyChecksumReadaheadSize = 2 << 20;
+  static const uint64_t kVerifyChecksumReportIntervalMicros = 10 * 1000000;
+
   std::string db_absolute_path_;
 
   // Number of running IngestExternalFile() or CreateColumnFamilyWithImport()
@@ -2217,8 +2320,10 @@ class DBImpl : public DB {
   bool opened_successfully_;
 
   // The min threshold to triggere bottommost compaction for removing
-  // garbages, among all column families.
-  SequenceNumber bottommost_files_mark_threshold_ = kMaxSequenceNumber;
+  // garbages, among all column families. Changed under the DB mutex, read by
+  // ReleaseSnapshot() without it.
+  std::atomic<SequenceNumber> bottommost_files_mark_threshold_{
+      kMaxSequenceNumber};
 
   LogsWithPrepTracker logs_with_prep_tracker_;
 
@@ -2236,6 +2341,9 @@ class DBImpl : public DB {
   // PeriodicWorkScheduler::Default(). Only in unittest, it can be overrided by
   // PeriodicWorkTestScheduler.
   PeriodicWorkScheduler* periodic_work_scheduler_;
+
+  // Only used by AutoTune(), on the scheduler's thread
+  std::unique_ptr<AutoTuner> auto_tuner_;
 #endif
 
   // When set, we use a separate queue for writes that don't write to memtable.
@@ -23,6 +23,39 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// How close pending compactions bring a column family to a write stall, as
+// the largest fraction of a slowdown trigger reached.
+double CompactionUrgency(ColumnFamilyData* cfd) {
+  const MutableCFOptions* mutable_cf_options =
+      cfd->GetCurrentMutableCFOptions();
+  const VersionStorageInfo* vstorage = cfd->current()->storage_info();
+  double urgency = 0;
+  if (mutable_cf_options->level0_slowdown_writes_trigger > 0) {
+    urgency = static_cast<double>(vstorage->l0_delay_trigger_count()) /
+              mutable_cf_options->level0_slowdown_writes_trigger;
+  }
+  if (mutable_cf_options->soft_pending_compaction_bytes_limit > 0) {
+    urgency = std::max(
+        urgency,
+        static_cast<double>(vstorage->estimated_compaction_needed_bytes()) /
+            mutable_cf_options->soft_pending_compaction_bytes_limit);
+  }
+  return urgency;
+}
+
+// How close pending flushes bring a column family to a write stall, as the
+// fraction of its write buffers waiting to be flushed.
+double FlushUrgency(ColumnFamilyData* cfd) {
+  const int max_write_buffer_number =
+      cfd->GetCurrentMutableCFOptions()->max_write_buffer_number;
+  return max_write_buffer_number > 0
+             ? static_cast<double>(cfd->imm()->NumNotFlushed()) /
+                   max_write_buffer_number
+             : 0;
+}
+}  // namespace
+
 bool DBImpl::EnoughRoomForCompaction(
     ColumnFamilyData* cfd, const std::vector<CompactionInputFiles>& inputs,
     bool* sfm_reserved_compact_space, LogBuffer* log_buffer) {
@@ -157,8 +190,9 @@ Status DBImpl::FlushMemTableToOutputFile(
       versions_.get(), &mutex_, &shutting_down_, snapshot_seqs,
       earliest_write_conflict_snapshot, snapshot_checker, job_context,
       log_buffer, directories_.GetDbDir(), GetDataDir(cfd, 0U),
-      GetCompressionFlush(*cfd->ioptions(), mutable_cf_options), stats_,
-      &event_logger_, mutable_cf_options.report_bg_io_stats,
+      GetCompressionFlush(*cfd->ioptions(), mutable_cf_options),
+      cfd->ioptions()->stats, &event_logger_,
+      mutable_cf_options.report_bg_io_stats,
       true /* sync_output_directory */, true /* write_manifest */, thread_pri,
       io_tracer_, db_id_, db_session_id_, cfd->GetFullHistoryTsLow(),
       &blob_callback_);
@@ -297,6 +331,11 @@ Status DBImpl::FlushMemTableToOutputFile(
       // exists. Otherwise, some tests may fail.  Ignore the error in the
       // interim.
       sfm->OnAddFile(file_path).PermitUncheckedError();
+      for (const auto& meta : flush_job.GetPartitionOutputs()) {
+        sfm->OnAddFile(MakeTableFileName(cfd->ioptions()->cf_paths[0].path,
+                                         meta.fd.GetNumber()))
+            .PermitUncheckedError();
+      }
       if (sfm->IsMaxAllowedSpaceReached()) {
         Status new_bg_error =
             Status::SpaceLimit("Max allowed space was reached");
@@ -404,7 +443,8 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         &shutting_down_, snapshot_seqs, earliest_write_conflict_snapshot,
         snapshot_checker, job_context, log_buffer, directories_.GetDbDir(),
         data_dir, GetCompressionFlush(*cfd->ioptions(), mutable_cf_options),
-        stats_, &event_logger_, mutable_cf_options.report_bg_io_stats,
+        cfd->ioptions()->stats, &event_logger_,
+        mutable_cf_options.report_bg_io_stats,
         false /* sync_output_directory */, false /* write_manifest */,
         thread_pri, io_tracer_, db_id_, db_session_id_,
         cfd->GetFullHistoryTsLow()));
@@ -661,6 +701,12 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         // exists. Otherwise, some tests may fail.  Ignore the error in the
         // interim.
         sfm->OnAddFile(file_path).PermitUncheckedError();
+        for (const auto& meta : jobs[i]->GetPartitionOutputs()) {
+          sfm->OnAddFile(
+                 MakeTableFileName(cfds[i]->ioptions()->cf_paths[0].path,
+                                   meta.fd.GetNumber()))
+              .PermitUncheckedError();
+        }
         if (sfm->IsMaxAllowedSpaceReached() &&
             error_handler_.GetBGError().ok()) {
           Status new_bg_error =
@@ -1250,7 +1296,8 @@ Status DBImpl::CompactFilesImpl(
       file_options_for_compaction_, versions_.get(), &shutting_down_,
       preserve_deletes_seqnum_.load(), log_buffer, directories_.GetDbDir(),
       GetDataDir(c->column_family_data(), c->output_path_id()),
-      GetDataDir(c->column_family_data(), 0), stats_, &mutex_, &error_handler_,
+      GetDataDir(c->column_family_data(), 0),
+      c->column_family_data()->ioptions()->stats, &mutex_, &error_handler_,
       snapshot_seqs, earliest_write_conflict_snapshot, snapshot_checker,
       table_cache_, &event_logger_,
       c->mutable_cf_options()->paranoid_file_checks,
@@ -1753,6 +1800,7 @@ Status DBImpl::RunManualCompaction(
       ca = new CompactionArg;
       ca->db = this;
       ca->compaction_pri_ = Env::Priority::LOW;
+      ca->schedule_time_us_ = immutable_db_options_.clock->NowMicros();
       ca->prepicked_compaction = new PrepickedCompaction;
       ca->prepicked_compaction->manual_compaction_state = &manual;
       ca->prepicked_compaction->compaction = compaction;
@@ -2238,6 +2286,7 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     FlushThreadArg* fta = new FlushThreadArg;
     fta->db_ = this;
     fta->thread_pri_ = Env::Priority::HIGH;
+    fta->schedule_time_us_ = immutable_db_options_.clock->NowMicros();
     env_->Schedule(&DBImpl::BGWorkFlush, fta, Env::Priority::HIGH, this,
                    &DBImpl::UnscheduleFlushCallback);
     --unscheduled_flushes_;
@@ -2256,6 +2305,7 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
       FlushThreadArg* fta = new FlushThreadArg;
       fta->db_ = this;
       fta->thread_pri_ = Env::Priority::LOW;
+      fta->schedule_time_us_ = immutable_db_options_.clock->NowMicros();
       env_->Schedule(&DBImpl::BGWorkFlush, fta, Env::Priority::LOW, this,
                      &DBImpl::UnscheduleFlushCallback);
       --unscheduled_flushes_;
@@ -2285,6 +2335,7 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     CompactionArg* ca = new CompactionArg;
     ca->db = this;
     ca->compaction_pri_ = Env::Priority::LOW;
+    ca->schedule_time_us_ = immutable_db_options_.clock->NowMicros();
     ca->prepicked_compaction = nullptr;
     bg_compaction_scheduled_++;
     unscheduled_compactions_--;
@@ -2342,6 +2393,25 @@ ColumnFamilyData* DBImpl::PopFirstFromCompactionQueue() {
 
 DBImpl::FlushRequest DBImpl::PopFirstFromFlushQueue() {
   assert(!flush_queue_.empty());
+  if (immutable_db_options_.prioritize_stall_relieving_work &&
+      !immutable_db_options_.atomic_flush) {
+    // Serve the most urgent request first, the earliest queued among equals
+    auto most_urgent = flush_queue_.begin();
+    double max_urgency = FlushUrgency(most_urgent->front().first);
+    for (auto it = std::next(flush_queue_.begin()); it != flush_queue_.end();
+         ++it) {
+      const double urgency = FlushUrgency(it->front().first);
+      if (urgency > max_urgency) {
+        most_urgent = it;
+        max_urgency = urgency;
+      }
+    }
+    if (most_urgent != flush_queue_.begin()) {
+      FlushRequest flush_req = std::move(*most_urgent);
+      flush_queue_.erase(most_urgent);
+      flush_queue_.push_front(std::move(flush_req));
+    }
+  }
   FlushRequest flush_req = flush_queue_.front();
   flush_queue_.pop_front();
   if (!immutable_db_options_.atomic_flush) {
@@ -2363,6 +2433,14 @@ ColumnFamilyData* DBImpl::PickCompactionFromQueue(
     std::unique_ptr<TaskLimiterToken>* token, LogBuffer* log_buffer) {
   assert(!compaction_queue_.empty());
   assert(*token == nullptr);
+  if (immutable_db_options_.prioritize_stall_relieving_work) {
+    // Consider column families from the most urgent down, the earliest queued
+    // first among equals
+    std::stable_sort(compaction_queue_.begin(), compaction_queue_.end(),
+                     [](ColumnFamilyData* a, ColumnFamilyData* b) {
+                       return CompactionUrgency(a) > CompactionUrgency(b);
+                     });
+  }
   autovector<ColumnFamilyData*> throttled_candidates;
   ColumnFamilyData* cfd = nullptr;
   while (!compaction_queue_.empty()) {
@@ -2446,6 +2524,7 @@ void DBImpl::BGWorkFlush(void* arg) {
   delete reinterpret_cast<FlushThreadArg*>(arg);
 
   IOSTATS_SET_THREAD_POOL_ID(fta.thread_pri_);
+  fta.db_->RecordQueueWait(FLUSH_QUEUE_WAIT_MICROS, fta.schedule_time_us_);
   TEST_SYNC_POINT("DBImpl::BGWorkFlush");
   static_cast_with_check<DBImpl>(fta.db_)->BackgroundCallFlush(fta.thread_pri_);
   TEST_SYNC_POINT("DBImpl::BGWorkFlush:done");
@@ -2455,6 +2534,7 @@ void DBImpl::BGWorkCompaction(void* arg) {
   CompactionArg ca = *(reinterpret_cast<CompactionArg*>(arg));
   delete reinterpret_cast<CompactionArg*>(arg);
   IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+  ca.db->RecordQueueWait(COMPACTION_QUEUE_WAIT_MICROS, ca.schedule_time_us_);
   TEST_SYNC_POINT("DBImpl::BGWorkCompaction");
   auto prepicked_compaction =
       static_cast<PrepickedCompaction*>(ca.prepicked_compaction);
@@ -2467,6 +2547,7 @@ void DBImpl::BGWorkBottomCompaction(void* arg) {
   CompactionArg ca = *(static_cast<CompactionArg*>(arg));
   delete static_cast<CompactionArg*>(arg);
   IOSTATS_SET_THREAD_POOL_ID(Env::Priority::BOTTOM);
+  ca.db->RecordQueueWait(COMPACTION_QUEUE_WAIT_MICROS, ca.schedule_time_us_);
   TEST_SYNC_POINT("DBImpl::BGWorkBottomCompaction");
   auto* prepicked_compaction = ca.prepicked_compaction;
   assert(prepicked_compaction && prepicked_compaction->compaction &&
@@ -2475,6 +2556,12 @@ void DBImpl::BGWorkBottomCompaction(void* arg) {
   delete prepicked_compaction;
 }
 
+void DBImpl::RecordQueueWait(Histograms histogram, uint64_t schedule_time_us) {
+  const uint64_t now = immutable_db_options_.clock->NowMicros();
+  RecordInHistogram(stats_, histogram,
+                    now > schedule_time_us ? now - schedule_time_us : 0);
+}
+
 void DBImpl::BGWorkPurge(void* db) {
   IOSTATS_SET_THREAD_POOL_ID(Env::Priority::HIGH);
   TEST_SYNC_POINT("DBImpl::BGWorkPurge:start");
@@ -2482,6 +2569,11 @@ void DBImpl::BGWorkPurge(void* db) {
   TEST_SYNC_POINT("DBImpl::BGWorkPurge:end");
 }
 
+void DBImpl::BGWorkOpenTableFiles(void* db) {
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+  reinterpret_cast<DBImpl*>(db)->BackgroundCallOpenTableFiles();
+}
+
 void DBImpl::UnscheduleCompactionCallback(void* arg) {
   CompactionArg* ca_ptr = reinterpret_cast<CompactionArg*>(arg);
   Env::Priority compaction_pri = ca_ptr->compaction_pri_;
@@ -2602,6 +2694,7 @@ Status DBImpl::BackgroundFlush(bool* made_progress, JobContext* job_context,
 }
 
 void DBImpl::BackgroundCallFlush(Env::Priority thread_pri) {
+  IOActivityGuard io_activity(IOActivity::kFlush);
   bool made_progress = false;
   JobContext job_context(next_job_id_.fetch_add(1), true);
 
@@ -2612,7 +2705,7 @@ void DBImpl::BackgroundCallFlush(Env::Priority thread_pri) {
   TEST_SYNC_POINT("DBImpl::BackgroundCallFlush:Start:1");
   TEST_SYNC_POINT("DBImpl::BackgroundCallFlush:Start:2");
   {
-    InstrumentedMutexLock l(&mutex_);
+    InstrumentedMutexLock l(&mutex_, DB_MUTEX_WAIT_BG_JOB_MICROS);
     assert(bg_flush_scheduled_);
     num_running_flushes_++;
 
@@ -2685,13 +2778,14 @@ void DBImpl::BackgroundCallFlush(Env::Priority thread_pri) {
 
 void DBImpl::BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
                                       Env::Priority bg_thread_pri) {
+  IOActivityGuard io_activity(IOActivity::kCompaction);
   bool made_progress = false;
   JobContext job_context(next_job_id_.fetch_add(1), true);
   TEST_SYNC_POINT("BackgroundCallCompaction:0");
   LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
                        immutable_db_options_.info_log.get());
   {
-    InstrumentedMutexLock l(&mutex_);
+    InstrumentedMutexLock l(&mutex_, DB_MUTEX_WAIT_BG_JOB_MICROS);
 
     // This call will unlock/lock the mutex to wait for current running
     // IngestExternalFile() calls to finish.
@@ -2960,8 +3054,12 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
       // compaction is not necessary. Need to make sure mutex is held
       // until we make a copy in the following code
       TEST_SYNC_POINT("DBImpl::BackgroundCompaction():BeforePickCompaction");
-      c.reset(cfd->PickCompaction(*mutable_cf_options, mutable_db_options_,
-                                  log_buffer));
+      {
+        StopWatch sw(immutable_db_options_.clock, stats_,
+                     COMPACTION_PICK_MICROS);
+        c.reset(cfd->PickCompaction(*mutable_cf_options, mutable_db_options_,
+                                    log_buffer));
+      }
       TEST_SYNC_POINT("DBImpl::BackgroundCompaction():AfterPickCompaction");
 
       if (c != nullptr) {
@@ -3135,6 +3233,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     CompactionArg* ca = new CompactionArg;
     ca->db = this;
     ca->compaction_pri_ = Env::Priority::BOTTOM;
+    ca->schedule_time_us_ = immutable_db_options_.clock->NowMicros();
     ca->prepicked_compaction = new PrepickedCompaction;
     ca->prepicked_compaction->compaction = c.release();
     ca->prepicked_compaction->manual_compaction_state = nullptr;
@@ -3162,9 +3261,10 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         &shutting_down_, preserve_deletes_seqnum_.load(), log_buffer,
         directories_.GetDbDir(),
         GetDataDir(c->column_family_data(), c->output_path_id()),
-        GetDataDir(c->column_family_data(), 0), stats_, &mutex_,
-        &error_handler_, snapshot_seqs, earliest_write_conflict_snapshot,
-        snapshot_checker, table_cache_, &event_logger_,
+        GetDataDir(c->column_family_data(), 0),
+        c->column_family_data()->ioptions()->stats, &mutex_, &error_handler_,
+        snapshot_seqs, earliest_write_conflict_snapshot, snapshot_checker,
+        table_cache_, &event_logger_,
         c->mutable_cf_options()->paranoid_file_checks,
         c->mutable_cf_options()->report_bg_io_stats, dbname_,
         &compaction_job_stats, thread_pri, io_tracer_,
@@ -3475,12 +3575,13 @@ void DBImpl::InstallSuperVersionAndScheduleWork(
   // compaction may already be released here. But assuming there will always be
   // newer snapshot created and released frequently, the compaction will be
   // triggered soon anyway.
-  bottommost_files_mark_threshold_ = kMaxSequenceNumber;
+  SequenceNumber new_bottommost_files_mark_threshold = kMaxSequenceNumber;
   for (auto* my_cfd : *versions_->GetColumnFamilySet()) {
-    bottommost_files_mark_threshold_ = std::min(
-        bottommost_files_mark_threshold_,
+    new_bottommost_files_mark_threshold = std::min(
+        new_bottommost_files_mark_threshold,
         my_cfd->current()->storage_info()->bottommost_files_mark_threshold());
   }
+  bottommost_files_mark_threshold_ = new_bottommost_files_mark_threshold;
 
   // Whenever we install new SuperVersion, we might need to issue new flushes or
   // compactions.
@@ -3540,7 +3641,7 @@ void DBImpl::GetSnapshotContext(
     // in snapshot_seqs and force compaction iterator to consider such
     // snapshots.
     const Snapshot* job_snapshot =
-        GetSnapshotImpl(false /*write_conflict_boundary*/, false /*lock*/);
+        GetSnapshotImpl(false /*write_conflict_boundary*/);
     job_context->job_snapshot.reset(new ManagedSnapshot(this, job_snapshot));
   }
   *snapshot_seqs = snapshots_.GetAll(earliest_write_conflict_snapshot);
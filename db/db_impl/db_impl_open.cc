@@ -6,7 +6,10 @@
 // Copyright (c) 2011 The LevelDB Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
+#include <atomic>
 #include <cinttypes>
+#include <condition_variable>
+#include <mutex>
 
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
@@ -21,6 +24,7 @@
 #include "rocksdb/table.h"
 #include "rocksdb/wal_filter.h"
 #include "test_util/sync_point.h"
+#include "util/compression.h"
 #include "util/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -140,6 +144,11 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src,
     result.compaction_readahead_size = 1024 * 1024 * 2;
   }
 
+  if (result.pipelined_compaction_io && result.compaction_readahead_size == 0) {
+    // Asynchronous prefetching needs a readahead window to work with
+    result.compaction_readahead_size = 1024 * 1024 * 2;
+  }
+
   if (result.compaction_readahead_size > 0 || result.use_direct_reads) {
     result.new_table_reader_for_compaction_inputs = true;
   }
@@ -251,6 +260,18 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "be disabled. ");
   }
 
+  if (db_options.allow_mmap_writes && db_options.use_direct_io_for_wal) {
+    return Status::NotSupported(
+        "If memory mapped writes (allow_mmap_writes) are enabled "
+        "then direct I/O WAL writes (use_direct_io_for_wal) must be "
+        "disabled. ");
+  }
+
+  if (db_options.use_pmem_for_wal && db_options.use_direct_io_for_wal) {
+    return Status::NotSupported(
+        "use_pmem_for_wal and use_direct_io_for_wal cannot both be enabled");
+  }
+
   if (db_options.keep_log_file_num == 0) {
     return Status::InvalidArgument("keep_log_file_num must be greater than 0");
   }
@@ -266,6 +287,20 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "unordered_write is incompatible with enable_pipelined_write");
   }
 
+  if (db_options.enable_no_wal_write_fast_path &&
+      !db_options.allow_concurrent_memtable_write) {
+    return Status::InvalidArgument(
+        "enable_no_wal_write_fast_path is incompatible with "
+        "!allow_concurrent_memtable_write");
+  }
+
+  if (db_options.enable_no_wal_write_fast_path &&
+      (db_options.enable_pipelined_write || db_options.unordered_write)) {
+    return Status::InvalidArgument(
+        "enable_no_wal_write_fast_path is incompatible with "
+        "enable_pipelined_write and unordered_write");
+  }
+
   if (db_options.atomic_flush && db_options.enable_pipelined_write) {
     return Status::InvalidArgument(
         "atomic_flush is incompatible with enable_pipelined_write");
@@ -277,6 +312,18 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "atomic_flush is currently incompatible with best-efforts recovery");
   }
 
+  if (db_options.wal_compression != kNoCompression) {
+    if (!StreamingCompressionTypeSupported(db_options.wal_compression)) {
+      return Status::NotSupported(
+          "wal_compression type is not supported for streaming compression: " +
+          CompressionTypeToString(db_options.wal_compression));
+    }
+    if (db_options.recycle_log_file_num > 0) {
+      return Status::InvalidArgument(
+          "wal_compression is incompatible with recycle_log_file_num");
+    }
+  }
+
   return Status::OK();
 }
 
@@ -735,6 +782,11 @@ Status DBImpl::PersistentStatsProcessFormatVersion() {
         // should also persist version here because old stats CF is discarded
         should_persist_format_version = true;
       }
+    } else if (format_version_recovered < kStatsCFCurrentFormatVersion) {
+      // The stats CF keeps the snapshots of the older format, which are
+      // still readable, but the new snapshots are not readable by the
+      // releases of the older format
+      should_persist_format_version = true;
     }
   }
   if (should_persist_format_version) {
@@ -788,6 +840,177 @@ Status DBImpl::InitPersistStatsColumnFamily() {
   return s;
 }
 
+namespace {
+// Inserts the write batches replayed from a WAL into the memtables on
+// DBOptions::wal_recovery_threads threads while the recovering thread reads
+// ahead. Batches are collected into groups; the batches of a group are
+// inserted concurrently, and a group is only started once the recovering
+// thread has waited for the previous one and flushed the memtables it filled
+// up. Where an entry ends up in a memtable does not depend on the order of
+// insertion, so the memtables are the same as with a single thread.
+class WalRecoveryInserter {
+ public:
+  // The number of batches collected per thread before a group is started
+  static constexpr size_t kBatchesPerThread = 64;
+
+  WalRecoveryInserter(ColumnFamilySet* column_family_set,
+                      FlushScheduler* flush_scheduler,
+                      TrimHistoryScheduler* trim_history_scheduler, DB* db,
+                      bool batch_per_txn, uint32_t num_threads)
+      : column_family_set_(column_family_set),
+        flush_scheduler_(flush_scheduler),
+        trim_history_scheduler_(trim_history_scheduler),
+        db_(db),
+        batch_per_txn_(batch_per_txn),
+        group_size_(kBatchesPerThread * num_threads) {
+    threads_.reserve(num_threads);
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      threads_.emplace_back(&WalRecoveryInserter::InsertThread, this);
+    }
+  }
+
+  ~WalRecoveryInserter() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  WalRecoveryInserter(const WalRecoveryInserter&) = delete;
+  WalRecoveryInserter& operator=(const WalRecoveryInserter&) = delete;
+
+  // Adds a batch of WAL `wal_number`, read from a record of `record_size`
+  // bytes, to the group being collected. Returns true if the group is full.
+  bool Add(WriteBatch&& batch, size_t record_size, uint64_t wal_number) {
+    collected_.emplace_back();
+    Batch& b = collected_.back();
+    b.batch = std::move(batch);
+    b.record_size = record_size;
+    b.wal_number = wal_number;
+    return collected_.size() >= group_size_;
+  }
+
+  bool HasCollected() const { return !collected_.empty(); }
+
+  // Drops the batches collected so far.
+  void Clear() { collected_.clear(); }
+
+  // Starts inserting the batches collected so far.
+  // REQUIRES: Wait() was called after the previous Start()
+  void Start() {
+    assert(inserting_.empty());
+    inserting_.swap(collected_);
+    next_batch_.store(0, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++round_;
+      num_busy_ = threads_.size();
+    }
+    work_cv_.notify_all();
+  }
+
+  // Waits for the batches started last, if any, to be inserted. Returns the
+  // status of the first one that failed, and sets `*record_size` to the
+  // size of its record. Then `*next_sequence` is the sequence number after
+  // the last batch, and `*has_valid_writes` tells whether any batch wrote
+  // to a memtable. Batches after a failed one are inserted all the same.
+  Status Wait(SequenceNumber* next_sequence, bool* has_valid_writes,
+              size_t* record_size) {
+    *has_valid_writes = false;
+    if (inserting_.empty()) {
+      return Status::OK();
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_cv_.wait(lock, [this] { return num_busy_ == 0; });
+    }
+    Status s;
+    for (Batch& b : inserting_) {
+      if (s.ok() && !b.status.ok()) {
+        s = b.status;
+        *record_size = b.record_size;
+      }
+      b.status.PermitUncheckedError();
+      *has_valid_writes |= b.has_valid_writes;
+    }
+    *next_sequence = inserting_.back().next_sequence;
+    inserting_.clear();
+    return s;
+  }
+
+ private:
+  struct Batch {
+    WriteBatch batch;
+    size_t record_size = 0;
+    uint64_t wal_number = 0;
+    Status status;
+    SequenceNumber next_sequence = 0;
+    bool has_valid_writes = false;
+  };
+
+  void InsertThread() {
+    uint64_t round = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_cv_.wait(lock, [&] { return stop_ || round_ != round; });
+        if (stop_) {
+          return;
+        }
+        round = round_;
+      }
+      InsertBatches();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--num_busy_ == 0) {
+          done_cv_.notify_one();
+        }
+      }
+    }
+  }
+
+  void InsertBatches() {
+    // Column families are not created or dropped during recovery, but each
+    // thread needs its own cursor into them
+    ColumnFamilyMemTablesImpl column_family_memtables(column_family_set_);
+    for (size_t i = next_batch_.fetch_add(1, std::memory_order_relaxed);
+         i < inserting_.size();
+         i = next_batch_.fetch_add(1, std::memory_order_relaxed)) {
+      Batch& b = inserting_[i];
+      b.status = WriteBatchInternal::InsertInto(
+          &b.batch, &column_family_memtables, flush_scheduler_,
+          trim_history_scheduler_, true /* ignore_missing_column_families */,
+          b.wal_number, db_, true /* concurrent_memtable_writes */,
+          &b.next_sequence, &b.has_valid_writes, false /* seq_per_batch */,
+          batch_per_txn_);
+    }
+  }
+
+  ColumnFamilySet* const column_family_set_;
+  FlushScheduler* const flush_scheduler_;
+  TrimHistoryScheduler* const trim_history_scheduler_;
+  DB* const db_;
+  const bool batch_per_txn_;
+  const size_t group_size_;
+
+  std::vector<Batch> collected_;
+  std::vector<Batch> inserting_;
+  std::atomic<size_t> next_batch_{0};
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  uint64_t round_ = 0;
+  size_t num_busy_ = 0;
+  bool stop_ = false;
+  std::vector<port::Thread> threads_;
+};
+}  // namespace
+
 // REQUIRES: wal_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
@@ -849,6 +1072,20 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   bool flushed = false;
   uint64_t corrupted_wal_number = kMaxSequenceNumber;
   uint64_t min_wal_number = MinLogNumberToKeep();
+
+  std::unique_ptr<WalRecoveryInserter> inserter;
+  if (immutable_db_options_.wal_recovery_threads > 1 &&
+      immutable_db_options_.allow_concurrent_memtable_write &&
+      !immutable_db_options_.allow_2pc && !seq_per_batch_) {
+    inserter.reset(new WalRecoveryInserter(
+        versions_->GetColumnFamilySet(), &flush_scheduler_,
+        &trim_history_scheduler_, this, batch_per_txn_,
+        immutable_db_options_.wal_recovery_threads));
+  }
+  const uint64_t start_micros = immutable_db_options_.clock->NowMicros();
+  uint64_t total_records = 0;
+  uint64_t total_bytes = 0;
+
   for (auto wal_number : wal_numbers) {
     if (wal_number < min_wal_number) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
@@ -927,6 +1164,58 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     Slice record;
     WriteBatch batch;
 
+    // Flushes the memtables that filled up
+    auto flush_scheduled = [&]() -> Status {
+      // we can do this because this is called before client has access to the
+      // DB and there is only a single thread operating on DB
+      ColumnFamilyData* cfd;
+
+      while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+        cfd->UnrefAndTryDelete();
+        // If this asserts, it means that InsertInto failed in
+        // filtering updates to already-flushed column families
+        assert(cfd->GetLogNumber() <= wal_number);
+        auto iter = version_edits.find(cfd->GetID());
+        assert(iter != version_edits.end());
+        VersionEdit* edit = &iter->second;
+        Status s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+        if (!s.ok()) {
+          return s;
+        }
+        flushed = true;
+
+        cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                               *next_sequence);
+      }
+      return Status::OK();
+    };
+
+    // Waits for the batches being inserted by `inserter`, and handles their
+    // result like that of a single batch below. Returns false if a flush
+    // failed, with the error in `status`.
+    auto wait_for_inserter = [&]() -> bool {
+      bool has_valid_writes = false;
+      size_t record_size = 0;
+      Status s =
+          inserter->Wait(next_sequence, &has_valid_writes, &record_size);
+      MaybeIgnoreError(&s);
+      if (!s.ok()) {
+        reporter.Corruption(record_size, s);
+      }
+      if (has_valid_writes && !read_only) {
+        s = flush_scheduled();
+        if (!s.ok()) {
+          status = s;
+          return false;
+        }
+      }
+      return true;
+    };
+
+    const uint64_t wal_start_micros = immutable_db_options_.clock->NowMicros();
+    uint64_t num_records = 0;
+    uint64_t num_bytes = 0;
+
     TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
                              /*arg=*/nullptr);
     while (!stop_replay_by_wal_filter &&
@@ -938,6 +1227,8 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                             Status::Corruption("log record too small"));
         continue;
       }
+      ++num_records;
+      num_bytes += record.size();
 
       status = WriteBatchInternal::SetContents(&batch, record);
       if (!status.ok()) {
@@ -1038,6 +1329,19 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       }
 #endif  // ROCKSDB_LITE
 
+      if (inserter != nullptr) {
+        if (inserter->Add(std::move(batch), record.size(), wal_number)) {
+          // Read the next group while this one is inserted
+          if (!wait_for_inserter()) {
+            return status;
+          }
+          if (status.ok()) {
+            inserter->Start();
+          }
+        }
+        continue;
+      }
+
       // If column family was not found, it might mean that the WAL write
       // batch references to the column family that was dropped after the
       // insert. We don't want to fail the whole write batch in that case --
@@ -1058,32 +1362,38 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       }
 
       if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->UnrefAndTryDelete();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= wal_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
+        status = flush_scheduled();
+        if (!status.ok()) {
+          // Reflect errors immediately so that conditions like full
+          // file-systems cause the DB::Open() to fail.
+          return status;
+        }
+      }
+    }
 
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
+    if (inserter != nullptr) {
+      // Insert the rest of the WAL, unless replay stopped at an error
+      if (!wait_for_inserter()) {
+        return status;
+      }
+      if (status.ok() && inserter->HasCollected()) {
+        inserter->Start();
+        if (!wait_for_inserter()) {
+          return status;
         }
       }
+      inserter->Clear();
     }
 
+    const uint64_t wal_micros =
+        immutable_db_options_.clock->NowMicros() - wal_start_micros;
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Recovered log #%" PRIu64 ": %" PRIu64 " records, %" PRIu64
+                   " bytes in %" PRIu64 " us",
+                   wal_number, num_records, num_bytes, wal_micros);
+    total_records += num_records;
+    total_bytes += num_bytes;
+
     if (!status.ok()) {
       if (status.IsNotSupported()) {
         // We should not treat NotSupported as corruption. It is rather a clear
@@ -1280,7 +1590,14 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   }
 
   event_logger_.Log() << "job" << job_id << "event"
-                      << "recovery_finished";
+                      << "recovery_finished"
+                      << "wal_records" << total_records << "wal_bytes"
+                      << total_bytes << "wal_recovery_micros"
+                      << immutable_db_options_.clock->NowMicros() - start_micros
+                      << "wal_recovery_threads"
+                      << (inserter != nullptr
+                              ? immutable_db_options_.wal_recovery_threads
+                              : 1);
 
   return status;
 }
@@ -1553,12 +1870,19 @@ IOStatus DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
     FileTypeSet tmp_set = immutable_db_options_.checksum_handoff_file_types;
     std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
         std::move(lfile), log_fname, opt_file_options,
-        immutable_db_options_.clock, io_tracer_, nullptr /* stats */, listeners,
-        nullptr, tmp_set.Contains(FileType::kWalFile),
+        immutable_db_options_.clock, io_tracer_, stats_, listeners, nullptr,
+        tmp_set.Contains(FileType::kWalFile),
         tmp_set.Contains(FileType::kWalFile)));
     *new_log = new log::Writer(std::move(file_writer), log_file_num,
                                immutable_db_options_.recycle_log_file_num > 0,
-                               immutable_db_options_.manual_wal_flush);
+                               immutable_db_options_.manual_wal_flush,
+                               immutable_db_options_.wal_compression, stats_,
+                               immutable_db_options_.clock);
+    io_s = (*new_log)->AddCompressionTypeRecord();
+    if (!io_s.ok()) {
+      delete *new_log;
+      *new_log = nullptr;
+    }
   }
   return io_s;
 }
@@ -1760,6 +2084,9 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
     *dbptr = impl;
     impl->opened_successfully_ = true;
     impl->MaybeScheduleFlushOrCompaction();
+    if (impl->immutable_db_options_.open_table_files_in_background) {
+      impl->ScheduleOpenTableFiles();
+    }
   } else {
     persist_options_status.PermitUncheckedError();
   }
@@ -21,13 +21,19 @@ DBImplSecondary::DBImplSecondary(const DBOptions& db_options,
                                  const std::string& dbname,
                                  std::string secondary_path)
     : DBImpl(db_options, dbname, false, true, true),
+      catch_up_cv_(&mutex_),
       secondary_path_(std::move(secondary_path)) {
   ROCKS_LOG_INFO(immutable_db_options_.info_log,
                  "Opening the db in secondary mode");
   LogFlush(immutable_db_options_.info_log);
 }
 
-DBImplSecondary::~DBImplSecondary() {}
+DBImplSecondary::~DBImplSecondary() { StopCatchUpThread(); }
+
+Status DBImplSecondary::Close() {
+  StopCatchUpThread();
+  return DBImpl::Close();
+}
 
 Status DBImplSecondary::Recover(
     const std::vector<ColumnFamilyDescriptor>& column_families,
@@ -82,12 +88,17 @@ Status DBImplSecondary::Recover(
 // find new WAL and apply them in order to the secondary instance
 Status DBImplSecondary::FindAndRecoverLogFiles(
     std::unordered_set<ColumnFamilyData*>* cfds_changed,
-    JobContext* job_context) {
+    JobContext* job_context, bool find_new_logs) {
   assert(nullptr != cfds_changed);
   assert(nullptr != job_context);
   Status s;
   std::vector<uint64_t> logs;
-  s = FindNewLogNumbers(&logs);
+  if (find_new_logs || log_readers_.empty()) {
+    s = FindNewLogNumbers(&logs);
+  } else {
+    // Only the last WAL replayed is kept open
+    logs.push_back(log_readers_.rbegin()->first);
+  }
   if (s.ok() && !logs.empty()) {
     SequenceNumber next_sequence(kMaxSequenceNumber);
     s = RecoverLogFiles(logs, &next_sequence, cfds_changed, job_context);
@@ -517,8 +528,15 @@ Status DBImplSecondary::CheckConsistency() {
 }
 
 Status DBImplSecondary::TryCatchUpWithPrimary() {
+  bool manifest_changed = false;
+  return CatchUpWithPrimary(true /* find_new_logs */, &manifest_changed);
+}
+
+Status DBImplSecondary::CatchUpWithPrimary(bool find_new_logs,
+                                           bool* manifest_changed) {
   assert(versions_.get() != nullptr);
   assert(manifest_reader_.get() != nullptr);
+  assert(manifest_changed != nullptr);
   Status s;
   // read the manifest and apply new changes to the secondary instance
   std::unordered_set<ColumnFamilyData*> cfds_changed;
@@ -528,6 +546,7 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
     s = static_cast_with_check<ReactiveVersionSet>(versions_.get())
             ->ReadAndApply(&mutex_, &manifest_reader_,
                            manifest_reader_status_.get(), &cfds_changed);
+    *manifest_changed = !cfds_changed.empty();
 
     ROCKS_LOG_INFO(immutable_db_options_.info_log, "Last sequence is %" PRIu64,
                    static_cast<uint64_t>(versions_->LastSequence()));
@@ -546,7 +565,7 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
     // list wal_dir to discover new WALs and apply new changes to the secondary
     // instance
     if (s.ok()) {
-      s = FindAndRecoverLogFiles(&cfds_changed, &job_context);
+      s = FindAndRecoverLogFiles(&cfds_changed, &job_context, find_new_logs);
     }
     if (s.IsPathNotFound()) {
       ROCKS_LOG_INFO(
@@ -567,7 +586,10 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
   }
   job_context.Clean();
 
-  // Cleanup unused, obsolete files.
+  // Cleanup unused, obsolete files. Only new versions make files obsolete.
+  if (!*manifest_changed) {
+    return s;
+  }
   JobContext purge_files_job_context(0);
   {
     InstrumentedMutexLock lock_guard(&mutex_);
@@ -582,6 +604,61 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
   return s;
 }
 
+void DBImplSecondary::BackgroundCatchUp() {
+  const uint64_t period =
+      immutable_db_options_.secondary_catch_up_period_micros;
+  SystemClock* clock = immutable_db_options_.clock;
+  bool find_new_logs = true;
+  while (true) {
+    {
+      InstrumentedMutexLock l(&mutex_);
+      if (!stop_catch_up_) {
+        catch_up_cv_.TimedWait(clock->NowMicros() + period);
+      }
+      if (stop_catch_up_) {
+        break;
+      }
+    }
+    const SequenceNumber prev_last_sequence = versions_->LastSequence();
+    CatchUpWithPrimaryInfo info;
+    info.status = CatchUpWithPrimary(find_new_logs, &info.manifest_changed);
+    info.last_sequence = versions_->LastSequence();
+    TEST_SYNC_POINT_CALLBACK("DBImplSecondary::BackgroundCatchUp:Done", &info);
+    // The primary only starts a new WAL once it stops writing to the last one,
+    // so the WAL directory is listed once that WAL has no new records.
+    const bool wal_progress = info.last_sequence != prev_last_sequence;
+    find_new_logs = !wal_progress || info.manifest_changed;
+    if (!info.status.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Failed to catch up with primary: %s",
+                     info.status.ToString().c_str());
+      find_new_logs = true;
+    }
+    if (!info.status.ok() || wal_progress || info.manifest_changed) {
+      NotifyOnCaughtUpWithPrimary(info);
+    }
+  }
+}
+
+void DBImplSecondary::StopCatchUpThread() {
+  if (!catch_up_thread_.joinable()) {
+    return;
+  }
+  {
+    InstrumentedMutexLock l(&mutex_);
+    stop_catch_up_ = true;
+    catch_up_cv_.SignalAll();
+  }
+  catch_up_thread_.join();
+}
+
+void DBImplSecondary::NotifyOnCaughtUpWithPrimary(
+    const CatchUpWithPrimaryInfo& info) {
+  for (const auto& listener : immutable_db_options_.listeners) {
+    listener->OnCaughtUpWithPrimary(this, info);
+  }
+}
+
 Status DB::OpenAsSecondary(const Options& options, const std::string& dbname,
                            const std::string& secondary_path, DB** dbptr) {
   *dbptr = nullptr;
@@ -661,6 +738,10 @@ Status DB::OpenAsSecondary(
       impl->NewThreadStatusCfInfo(
           static_cast_with_check<ColumnFamilyHandleImpl>(h)->cfd());
     }
+    if (impl->immutable_db_options_.secondary_catch_up_period_micros > 0) {
+      impl->catch_up_thread_ =
+          port::Thread(&DBImplSecondary::BackgroundCatchUp, impl);
+    }
   } else {
     for (auto h : *handles) {
       delete h;
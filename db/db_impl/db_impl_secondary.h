@@ -211,6 +211,9 @@ class DBImplSecondary : public DBImpl {
   // method can take long time due to all the I/O and CPU costs.
   Status TryCatchUpWithPrimary() override;
 
+  // Stops catching up in the background before closing.
+  Status Close() override;
+
 
   // Try to find log reader using log_number from log_readers_ map, initialize
   // if it doesn't exist
@@ -324,9 +327,11 @@ class DBImplSecondary : public DBImpl {
 
   using DBImpl::Recover;
 
+  // Replays the WALs that have readers in log_readers_, and the WALs found by
+  // listing wal_dir too if `find_new_logs`.
   Status FindAndRecoverLogFiles(
       std::unordered_set<ColumnFamilyData*>* cfds_changed,
-      JobContext* job_context);
+      JobContext* job_context, bool find_new_logs = true);
   Status FindNewLogNumbers(std::vector<uint64_t>* logs);
   // After manifest recovery, replay WALs and refresh log_readers_ if necessary
   // REQUIRES: log_numbers are sorted in ascending order
@@ -342,6 +347,18 @@ class DBImplSecondary : public DBImpl {
                                     const CompactionServiceInput& input,
                                     CompactionServiceResult* result);
 
+  // Applies the new MANIFEST and WAL records of the primary. Sets
+  // *manifest_changed if MANIFEST records were applied.
+  Status CatchUpWithPrimary(bool find_new_logs, bool* manifest_changed);
+
+  // Catches up with the primary every secondary_catch_up_period_micros until
+  // StopCatchUpThread() is called. Runs on catch_up_thread_.
+  void BackgroundCatchUp();
+
+  void StopCatchUpThread();
+
+  void NotifyOnCaughtUpWithPrimary(const CatchUpWithPrimaryInfo& info);
+
   std::unique_ptr<log::FragmentBufferedReader> manifest_reader_;
   std::unique_ptr<log::Reader::Reporter> manifest_reporter_;
   std::unique_ptr<Status> manifest_reader_status_;
@@ -353,6 +370,13 @@ class DBImplSecondary : public DBImpl {
   // Current WAL number replayed for each column family.
   std::unordered_map<ColumnFamilyData*, uint64_t> cfd_to_current_log_;
 
+  // Background catching up, if secondary_catch_up_period_micros is set.
+  // stop_catch_up_ is protected by mutex_, and catch_up_cv_ is signaled when
+  // it is set.
+  port::Thread catch_up_thread_;
+  InstrumentedCondVar catch_up_cv_;
+  bool stop_catch_up_ = false;
+
   const std::string secondary_path_;
 };
 
@@ -50,6 +50,13 @@ void DBImpl::SetRecoverableStatePreReleaseCallback(
 }
 
 Status DBImpl::Write(const WriteOptions& write_options, WriteBatch* my_batch) {
+#ifndef ROCKSDB_LITE
+  if (UNLIKELY(ShouldSampleRequest())) {
+    return SampleRequest(SampledRequestType::kWrite, nullptr, [&]() {
+      return WriteImpl(write_options, my_batch, nullptr, nullptr);
+    });
+  }
+#endif  // !ROCKSDB_LITE
   return WriteImpl(write_options, my_batch, nullptr, nullptr);
 }
 
@@ -152,6 +159,16 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                               log_ref, disable_memtable, seq_used);
   }
 
+  if (write_thread_.fast_path_enabled() && write_options.disableWAL &&
+      callback == nullptr && log_used == nullptr && log_ref == 0 &&
+      !disable_memtable && pre_release_callback == nullptr &&
+      !seq_per_batch_) {
+    Status status;
+    if (FastPathWriteImpl(write_options, my_batch, seq_used, &status)) {
+      return status;
+    }
+  }
+
   PERF_TIMER_GUARD(write_pre_and_post_process_time);
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable, batch_cnt, pre_release_callback);
@@ -216,7 +233,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   bool in_parallel_group = false;
   uint64_t last_sequence = kMaxSequenceNumber;
 
-  mutex_.Lock();
+  mutex_.Lock(DB_MUTEX_WAIT_WRITE_MICROS);
 
   bool need_log_sync = write_options.sync;
   bool need_log_dir_sync = need_log_sync && !log_dir_synced_;
@@ -256,7 +273,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   if (status.ok()) {
     // Rules for when we can update the memtable concurrently
     // 1. supported by memtable
-    // 2. Puts are not okay if inplace_update_support
+    // 2. Puts are not okay if inplace_callback
     // 3. Merges are not okay
     //
     // Rules 1..2 are enforced by checking the options
@@ -466,6 +483,83 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   return status;
 }
 
+bool DBImpl::FastPathWriteImpl(const WriteOptions& write_options,
+                               WriteBatch* my_batch, uint64_t* seq_used,
+                               Status* status) {
+  // Merges cannot be inserted concurrently, and anything PreprocessWrite()
+  // would act on needs a write group leader
+  if (my_batch->HasMerge() || error_handler_.IsDBStoppedUnlocked() ||
+      !flush_scheduler_.Empty() || !trim_history_scheduler_.Empty() ||
+      write_buffer_manager_->ShouldFlush() ||
+      write_buffer_manager_->ShouldStall() || write_controller_.IsStopped() ||
+      write_controller_.NeedsDelay() || !write_thread_.EnterFastPath()) {
+    RecordTick(stats_, WRITE_FAST_PATH_FALLBACK);
+    return false;
+  }
+  TEST_SYNC_POINT("DBImpl::FastPathWriteImpl:Entered");
+
+  PERF_TIMER_GUARD(write_pre_and_post_process_time);
+  StopWatch write_sw(immutable_db_options_.clock, immutable_db_options_.stats,
+                     DB_WRITE);
+
+  WriteThread::Writer w(write_options, my_batch, nullptr /*callback*/,
+                        0 /*log_ref*/, false /*disable_memtable*/);
+  const size_t count = WriteBatchInternal::Count(my_batch);
+  const SequenceNumber last_sequence = write_thread_.AllocateFastPathSequences(
+      count, versions_->LastSequence());
+  w.sequence = last_sequence + 1;
+
+  auto stats = default_cf_internal_stats_;
+  stats->AddDBStats(InternalStats::kIntStatsNumKeysWritten, count,
+                    true /*concurrent*/);
+  RecordTick(stats_, NUMBER_KEYS_WRITTEN, count);
+  const size_t byte_size = WriteBatchInternal::ByteSize(my_batch);
+  stats->AddDBStats(InternalStats::kIntStatsBytesWritten, byte_size,
+                    true /*concurrent*/);
+  RecordTick(stats_, BYTES_WRITTEN, byte_size);
+  stats->AddDBStats(InternalStats::kIntStatsWriteDoneBySelf, 1,
+                    true /*concurrent*/);
+  RecordTick(stats_, WRITE_DONE_BY_SELF);
+  RecordInHistogram(stats_, BYTES_PER_WRITE, byte_size);
+  has_unpersisted_data_.store(true, std::memory_order_relaxed);
+
+  PERF_TIMER_STOP(write_pre_and_post_process_time);
+  {
+    PERF_TIMER_GUARD(write_memtable_time);
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    w.status = WriteBatchInternal::InsertInto(
+        &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+        &trim_history_scheduler_, write_options.ignore_missing_column_families,
+        0 /*log_number*/, this, true /*concurrent_memtable_writes*/,
+        false /*seq_per_batch*/, 0 /*batch_cnt*/, true /*batch_per_txn*/,
+        write_options.memtable_insert_hint_per_batch);
+  }
+  PERF_TIMER_START(write_pre_and_post_process_time);
+
+  // Make the sequences visible in allocation order, so that a reader never
+  // sees a write without the earlier ones. The sequences are published even
+  // if the insert failed, since later writes wait for them.
+  TEST_SYNC_POINT("DBImpl::FastPathWriteImpl:BeforePublish");
+  for (int spins = 0; versions_->LastSequence() != last_sequence; ++spins) {
+    if (spins < 100) {
+      port::AsmVolatilePause();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  versions_->SetLastSequence(last_sequence + count);
+  write_thread_.ExitFastPath();
+  RecordTick(stats_, WRITE_FAST_PATH);
+
+  if (seq_used != nullptr) {
+    *seq_used = w.sequence;
+  }
+  MemTableInsertStatusCheck(w.status);
+  *status = w.FinalStatus();
+  return true;
+}
+
 Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
                                   WriteBatch* my_batch, WriteCallback* callback,
                                   uint64_t* log_used, uint64_t log_ref,
@@ -485,7 +579,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     if (w.callback && !w.callback->AllowWriteBatching()) {
       write_thread_.WaitForMemTableWriters();
     }
-    mutex_.Lock();
+    mutex_.Lock(DB_MUTEX_WAIT_WRITE_MICROS);
     bool need_log_sync = !write_options.disableWAL && write_options.sync;
     bool need_log_dir_sync = need_log_sync && !log_dir_synced_;
     // PreprocessWrite does its own perf timing.
@@ -1390,10 +1484,15 @@ Status DBImpl::HandleWriteBufferManagerFlush(WriteContext* write_context) {
   // thread is writing to another DB with the same write buffer, they may also
   // be flushed. We may end up with flushing much more DBs than needed. It's
   // suboptimal but still correct.
+  const bool weighted_share =
+      write_buffer_manager_->flush_victim_policy() ==
+      WriteBufferManager::FlushVictimPolicy::kWeightedShare;
   ROCKS_LOG_INFO(
       immutable_db_options_.info_log,
-      "Flushing column family with oldest memtable entry. Write buffers are "
+      "Flushing column family with %s. Write buffers are "
       "using %" ROCKSDB_PRIszt " bytes out of a total of %" ROCKSDB_PRIszt ".",
+      weighted_share ? "largest weighted memtable usage"
+                     : "oldest memtable entry",
       write_buffer_manager_->memory_usage(),
       write_buffer_manager_->buffer_size());
   // no need to refcount because drop is happening in write thread, so can't
@@ -1401,6 +1500,39 @@ Status DBImpl::HandleWriteBufferManagerFlush(WriteContext* write_context) {
   autovector<ColumnFamilyData*> cfds;
   if (immutable_db_options_.atomic_flush) {
     SelectColumnFamiliesForAtomicFlush(&cfds);
+  } else if (weighted_share) {
+    // A column family's share of the budget is proportional to its weight,
+    // so the one whose memtables use the most memory per unit of weight is
+    // the furthest over its share. Column families still within their
+    // guaranteed minimum are only picked when no other one can be.
+    ColumnFamilyData* cfd_picked = nullptr;
+    double score_for_cf_picked = 0.0;
+    bool cf_picked_above_min = false;
+
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || cfd->mem()->IsEmpty()) {
+        continue;
+      }
+      const MutableCFOptions* mutable_cf_options =
+          cfd->GetLatestMutableCFOptions();
+      const size_t usage =
+          cfd->mem()->ApproximateMemoryUsageFast() +
+          cfd->imm()->ApproximateUnflushedMemTablesMemoryUsage();
+      const bool above_min =
+          usage > mutable_cf_options->write_buffer_min_share_bytes;
+      const double score = static_cast<double>(usage) /
+                           mutable_cf_options->write_buffer_share_weight;
+      if (cfd_picked == nullptr || (above_min && !cf_picked_above_min) ||
+          (above_min == cf_picked_above_min && score > score_for_cf_picked)) {
+        cfd_picked = cfd;
+        score_for_cf_picked = score;
+        cf_picked_above_min = above_min;
+      }
+    }
+    if (cfd_picked != nullptr) {
+      cfds.push_back(cfd_picked);
+    }
+    MaybeFlushStatsCF(&cfds);
   } else {
     ColumnFamilyData* cfd_picked = nullptr;
     SequenceNumber seq_num_for_cf_picked = kMaxSequenceNumber;
@@ -1773,7 +1905,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   }
   uint64_t new_log_number =
       creating_new_log ? versions_->NewFileNumber() : logfile_number_;
-  const MutableCFOptions mutable_cf_options = *cfd->GetLatestMutableCFOptions();
+  MutableCFOptions mutable_cf_options = *cfd->GetLatestMutableCFOptions();
+  mutable_cf_options.write_buffer_size =
+      cfd->NextWriteBufferSize(mutable_cf_options);
 
   // Set memtable_info for memtable sealed callback
 #ifndef ROCKSDB_LITE
@@ -1803,6 +1937,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
     SequenceNumber seq = versions_->LastSequence();
     new_mem = cfd->ConstructNewMemtable(mutable_cf_options, seq);
     context->superversion_context.NewSuperVersion();
+    // Writes to the memtable are over, so its range tombstones can be
+    // fragmented once for all the reads of the immutable memtable.
+    cfd->mem()->ConstructFragmentedRangeTombstones();
   }
   ROCKS_LOG_INFO(immutable_db_options_.info_log,
                  "[%s] New memtable created with log file: #%" PRIu64
@@ -1919,7 +2056,23 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       empty_cf_updated = true;
     }
   }
+  // Without a new log, the pass below only moves the creation sequence of
+  // the empty memtables up to LastSequence(). That is already done if
+  // neither LastSequence() nor any version changed since the last pass: new
+  // memtables start at LastSequence(), and only installing a flush can
+  // empty a column family. Switching the memtables of many column families
+  // in a row then does not scan all column families for each of them.
+  const SequenceNumber last_sequence = versions_->LastSequence();
+  const uint64_t version_number = versions_->current_version_number();
+  if (!empty_cf_updated && !creating_new_log &&
+      last_sequence == empty_cfs_updated_seq_ &&
+      version_number == empty_cfs_updated_version_number_) {
+    empty_cf_updated = true;
+  }
   if (!empty_cf_updated) {
+    empty_cfs_updated_seq_ = last_sequence;
+    empty_cfs_updated_version_number_ = version_number;
+    TEST_SYNC_POINT("DBImpl::SwitchMemtable:UpdateEmptyColumnFamilies");
     for (auto cf : *versions_->GetColumnFamilySet()) {
       // all this is just optimization to delete logs that
       // are no longer needed -- if CF is empty, that means it
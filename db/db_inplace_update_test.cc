@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
+#include "util/coding.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -169,6 +171,113 @@ TEST_F(DBTestInPlaceUpdate, InPlaceUpdateCallbackNoAction) {
     ASSERT_EQ(Get(1, "key"), "NOT_FOUND");
   } while (ChangeCompactOptions());
 }
+
+TEST_F(DBTestInPlaceUpdate, InPlaceMerge) {
+  do {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    options.inplace_update_support = true;
+    options.env = env_;
+    options.write_buffer_size = 100000;
+    options.allow_concurrent_memtable_write = false;
+    options.merge_operator = MergeOperators::CreateUInt64AddOperator();
+    Reopen(options);
+    CreateAndReopenWithCF({"pikachu"}, options);
+
+    // Operands of the same size are combined with the latest one
+    std::string one;
+    PutFixed64(&one, 1);
+    int numValues = 10;
+    for (int i = 1; i <= numValues; i++) {
+      ASSERT_OK(Merge(1, "key", one));
+      std::string expected;
+      PutFixed64(&expected, i);
+      ASSERT_EQ(expected, Get(1, "key"));
+    }
+    validateNumberOfEntries(1, 1);
+
+    // But not with an operand that a newer range deletion covers
+    ASSERT_OK(db_->DeleteRange(WriteOptions(), handles_[1], "key", "kez"));
+    ASSERT_OK(Merge(1, "key", one));
+    ASSERT_OK(Merge(1, "key", one));
+    std::string expected;
+    PutFixed64(&expected, 2);
+    ASSERT_EQ(expected, Get(1, "key"));
+  } while (ChangeCompactOptions());
+}
+
+TEST_F(DBTestInPlaceUpdate, InPlaceMergeLargerOperand) {
+  do {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    options.inplace_update_support = true;
+    options.env = env_;
+    options.write_buffer_size = 100000;
+    options.allow_concurrent_memtable_write = false;
+    options.merge_operator = MergeOperators::CreateStringAppendOperator();
+    Reopen(options);
+    CreateAndReopenWithCF({"pikachu"}, options);
+
+    // Combined operands would grow, so all are added out-of-place
+    int numValues = 10;
+    std::string expected;
+    for (int i = 0; i < numValues; i++) {
+      ASSERT_OK(Merge(1, "key", "a"));
+      expected += i == 0 ? "a" : ",a";
+      ASSERT_EQ(expected, Get(1, "key"));
+    }
+    validateNumberOfEntries(numValues, 1);
+  } while (ChangeCompactOptions());
+}
+
+TEST_F(DBTestInPlaceUpdate, InPlaceUpdateConcurrentWriters) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.inplace_update_support = true;
+  options.env = env_;
+  options.allow_concurrent_memtable_write = true;
+  options.enable_write_thread_adaptive_yield = true;
+  Reopen(options);
+
+  const int kNumThreads = 8;
+  const int kNumKeys = 16;
+  const uint64_t kNumWrites = 1000;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (uint64_t i = 1; i <= kNumWrites; i++) {
+        std::string value;
+        PutFixed64(&value, i);
+        WriteBatch batch;
+        for (int k = 0; k < kNumKeys; k++) {
+          ASSERT_OK(batch.Put("key" + ToString(t) + "_" + ToString(k), value));
+        }
+        ASSERT_OK(db_->Write(WriteOptions(), &batch));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int k = 0; k < kNumKeys; k++) {
+      std::string value = Get("key" + ToString(t) + "_" + ToString(k));
+      ASSERT_EQ(8U, value.size());
+      ASSERT_EQ(kNumWrites, DecodeFixed64(value.data()));
+    }
+  }
+  // Only 1 instance for each key.
+  uint64_t num_entries = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kNumEntriesActiveMemTable,
+                                  &num_entries));
+  ASSERT_EQ(static_cast<uint64_t>(kNumThreads * kNumKeys), num_entries);
+
+  // An inplace_callback is not supported with concurrent writes
+  options.inplace_callback =
+      ROCKSDB_NAMESPACE::DBTestInPlaceUpdate::updateInPlaceSmallerSize;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
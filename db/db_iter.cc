@@ -27,6 +27,7 @@
 #include "rocksdb/options.h"
 #include "rocksdb/system_clock.h"
 #include "table/internal_iterator.h"
+#include "table/iterator_batch.h"
 #include "table/iterator_wrapper.h"
 #include "trace_replay/trace_replay.h"
 #include "util/mutexlock.h"
@@ -71,7 +72,9 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
                                      read_options.total_order_seek ||
                                      read_options.auto_prefix_mode),
       read_tier_(read_options.read_tier),
+      fill_cache_(read_options.fill_cache),
       verify_checksums_(read_options.verify_checksums),
+      blob_prefetcher_(ioptions, read_options),
       expose_blob_index_(expose_blob_index),
       is_blob_(false),
       arena_mode_(arena_mode),
@@ -153,6 +156,11 @@ void DBIter::Next() {
   }
 
   local_stats_.next_count_++;
+#ifndef ROCKSDB_LITE
+  if (pending_seek_trace_.pending) {
+    pending_seek_trace_.next_count++;
+  }
+#endif  // ROCKSDB_LITE
   if (ok && iter_.Valid()) {
     if (prefix_same_as_start_) {
       assert(prefix_extractor_ != nullptr);
@@ -171,6 +179,28 @@ void DBIter::Next() {
   }
 }
 
+Status DBIter::NextBatch(size_t max_entries, size_t max_bytes,
+                         std::vector<Slice>* keys, std::vector<Slice>* values,
+                         std::string* buf) {
+  assert(max_entries > 0);
+  IteratorBatchCollector batch(max_entries, max_bytes, keys, values, buf);
+  // Calls are qualified so that the loop does not go through the vtable.
+  while (valid_ && !batch.Full()) {
+    // With pin_thru_lifetime_ the blocks behind saved_key_ and iter_.value()
+    // stay pinned after we move on. Merge results, blob values and values
+    // saved while moving backwards are owned by this iterator.
+    bool key_pinned = pin_thru_lifetime_ && saved_key_.IsKeyPinned();
+    bool value_pinned = pin_thru_lifetime_ && direction_ == kForward &&
+                        !current_entry_is_merged_ &&
+                        (expose_blob_index_ || !is_blob_) &&
+                        iter_.iter()->IsValuePinned();
+    batch.Add(DBIter::key(), key_pinned, DBIter::value(), value_pinned);
+    DBIter::Next();
+  }
+  batch.Finish();
+  return DBIter::status();
+}
+
 bool DBIter::SetBlobValueIfNeeded(const Slice& user_key,
                                   const Slice& blob_index) {
   assert(!is_blob_);
@@ -190,12 +220,14 @@ bool DBIter::SetBlobValueIfNeeded(const Slice& user_key,
   // avoid having to copy options back and forth.
   ReadOptions read_options;
   read_options.read_tier = read_tier_;
+  read_options.fill_cache = fill_cache_;
   read_options.verify_checksums = verify_checksums_;
 
   constexpr uint64_t* bytes_read = nullptr;
 
   const Status s = version_->GetBlob(read_options, user_key, blob_index,
-                                     &blob_value_, bytes_read);
+                                     &blob_prefetcher_, &blob_value_,
+                                     bytes_read);
 
   if (!s.ok()) {
     status_ = s;
@@ -650,6 +682,11 @@ void DBIter::Prev() {
   assert(status_.ok());
 
   PERF_CPU_TIMER_GUARD(iter_prev_cpu_nanos, clock_);
+#ifndef ROCKSDB_LITE
+  if (pending_seek_trace_.pending) {
+    pending_seek_trace_.prev_count++;
+  }
+#endif  // ROCKSDB_LITE
   ReleaseTempPinnedData();
   ResetInternalKeysSkippedCounter();
   bool ok = true;
@@ -1338,27 +1375,63 @@ void DBIter::SetSavedKeyToSeekForPrevTarget(const Slice& target) {
   }
 }
 
+#ifndef ROCKSDB_LITE
+void DBIter::TraceSeek(const Slice& target, bool for_prev) {
+  WritePendingSeekTrace();
+  if (db_impl_ == nullptr || cfd_ == nullptr || !db_impl_->IsTracing()) {
+    return;
+  }
+  PendingSeekTrace& trace = pending_seek_trace_;
+  trace.pending = true;
+  trace.for_prev = for_prev;
+  trace.seek_micros = clock_->NowMicros();
+  trace.target.assign(target.data(), target.size());
+  if (iterate_lower_bound_ != nullptr) {
+    trace.lower_bound.assign(iterate_lower_bound_->data(),
+                             iterate_lower_bound_->size());
+  } else {
+    trace.lower_bound.clear();
+  }
+  if (iterate_upper_bound_ != nullptr) {
+    trace.upper_bound.assign(iterate_upper_bound_->data(),
+                             iterate_upper_bound_->size());
+  } else {
+    trace.upper_bound.clear();
+  }
+  trace.next_count = 0;
+  trace.prev_count = 0;
+}
+
+void DBIter::WritePendingSeekTrace() {
+  PendingSeekTrace& trace = pending_seek_trace_;
+  if (!trace.pending) {
+    return;
+  }
+  trace.pending = false;
+  // TODO: What do we do if this returns an error?
+  if (trace.for_prev) {
+    db_impl_
+        ->TraceIteratorSeekForPrev(cfd_->GetID(), trace.target,
+                                   trace.lower_bound, trace.upper_bound,
+                                   trace.seek_micros, trace.next_count,
+                                   trace.prev_count)
+        .PermitUncheckedError();
+  } else {
+    db_impl_
+        ->TraceIteratorSeek(cfd_->GetID(), trace.target, trace.lower_bound,
+                            trace.upper_bound, trace.seek_micros,
+                            trace.next_count, trace.prev_count)
+        .PermitUncheckedError();
+  }
+}
+#endif  // ROCKSDB_LITE
+
 void DBIter::Seek(const Slice& target) {
   PERF_CPU_TIMER_GUARD(iter_seek_cpu_nanos, clock_);
   StopWatch sw(clock_, statistics_, DB_SEEK);
 
 #ifndef ROCKSDB_LITE
-  if (db_impl_ != nullptr && cfd_ != nullptr) {
-    // TODO: What do we do if this returns an error?
-    Slice lower_bound, upper_bound;
-    if (iterate_lower_bound_ != nullptr) {
-      lower_bound = *iterate_lower_bound_;
-    } else {
-      lower_bound = Slice("");
-    }
-    if (iterate_upper_bound_ != nullptr) {
-      upper_bound = *iterate_upper_bound_;
-    } else {
-      upper_bound = Slice("");
-    }
-    db_impl_->TraceIteratorSeek(cfd_->GetID(), target, lower_bound, upper_bound)
-        .PermitUncheckedError();
-  }
+  TraceSeek(target, false /* for_prev */);
 #endif  // ROCKSDB_LITE
 
   status_ = Status::OK();
@@ -1417,24 +1490,7 @@ void DBIter::SeekForPrev(const Slice& target) {
   StopWatch sw(clock_, statistics_, DB_SEEK);
 
 #ifndef ROCKSDB_LITE
-  if (db_impl_ != nullptr && cfd_ != nullptr) {
-    // TODO: What do we do if this returns an error?
-    Slice lower_bound, upper_bound;
-    if (iterate_lower_bound_ != nullptr) {
-      lower_bound = *iterate_lower_bound_;
-    } else {
-      lower_bound = Slice("");
-    }
-    if (iterate_upper_bound_ != nullptr) {
-      upper_bound = *iterate_upper_bound_;
-    } else {
-      upper_bound = Slice("");
-    }
-    db_impl_
-        ->TraceIteratorSeekForPrev(cfd_->GetID(), target, lower_bound,
-                                   upper_bound)
-        .PermitUncheckedError();
-  }
+  TraceSeek(target, true /* for_prev */);
 #endif  // ROCKSDB_LITE
 
   status_ = Status::OK();
@@ -1487,6 +1543,9 @@ void DBIter::SeekToFirst() {
     Seek(*iterate_lower_bound_);
     return;
   }
+#ifndef ROCKSDB_LITE
+  WritePendingSeekTrace();
+#endif  // ROCKSDB_LITE
   PERF_CPU_TIMER_GUARD(iter_seek_cpu_nanos, clock_);
   // Don't use iter_::Seek() if we set a prefix extractor
   // because prefix seek will be used.
@@ -1531,6 +1590,9 @@ void DBIter::SeekToFirst() {
 }
 
 void DBIter::SeekToLast() {
+#ifndef ROCKSDB_LITE
+  WritePendingSeekTrace();
+#endif  // ROCKSDB_LITE
   if (iterate_upper_bound_ != nullptr) {
     // Seek to last key strictly less than ReadOptions.iterate_upper_bound.
     SeekForPrev(*iterate_upper_bound_);
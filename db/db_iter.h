@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <string>
 
+#include "db/blob/blob_prefetcher.h"
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
 #include "db/range_del_aggregator.h"
@@ -126,6 +127,9 @@ class DBIter final : public Iterator {
   void operator=(const DBIter&) = delete;
 
   ~DBIter() override {
+#ifndef ROCKSDB_LITE
+    WritePendingSeekTrace();
+#endif  // ROCKSDB_LITE
     // Release pinned data if any
     if (pinned_iters_mgr_.PinningEnabled()) {
       pinned_iters_mgr_.ReleasePinnedData();
@@ -201,6 +205,9 @@ class DBIter final : public Iterator {
 
   void Next() final override;
   void Prev() final override;
+  Status NextBatch(size_t max_entries, size_t max_bytes,
+                   std::vector<Slice>* keys, std::vector<Slice>* values,
+                   std::string* buf) override;
   // 'target' does not contain timestamp, even if user timestamp feature is
   // enabled.
   void Seek(const Slice& target) final override;
@@ -353,7 +360,11 @@ class DBIter final : public Iterator {
   // prefix_extractor_ must be non-NULL if the value is false.
   const bool expect_total_order_inner_iter_;
   ReadTier read_tier_;
+  bool fill_cache_;
   bool verify_checksums_;
+  // Reads ahead in blob files when the blobs of consecutive keys follow each
+  // other in the file
+  BlobPrefetcher blob_prefetcher_;
   // Whether the iterator is allowed to expose blob references. Set to true when
   // the stacked BlobDB implementation is used, false otherwise.
   bool expose_blob_index_;
@@ -379,6 +390,27 @@ class DBIter final : public Iterator {
   const Slice* const timestamp_lb_;
   const size_t timestamp_size_;
   std::string saved_timestamp_;
+
+#ifndef ROCKSDB_LITE
+  // A Seek() or SeekForPrev() made while tracing. Its trace record is only
+  // written once the iterator is positioned again or destroyed, so that it
+  // can tell how many times Next() and Prev() were called after it.
+  struct PendingSeekTrace {
+    bool pending = false;
+    bool for_prev = false;
+    uint64_t seek_micros = 0;
+    std::string target;
+    std::string lower_bound;
+    std::string upper_bound;
+    uint64_t next_count = 0;
+    uint64_t prev_count = 0;
+  };
+  // Writes out the trace record of pending_seek_trace_, if any
+  void WritePendingSeekTrace();
+  // Makes `target` the pending seek if tracing
+  void TraceSeek(const Slice& target, bool for_prev);
+  PendingSeekTrace pending_seek_trace_;
+#endif  // ROCKSDB_LITE
 };
 
 // Return a new iterator that converts internal keys (yielded by
@@ -2373,6 +2373,32 @@ TEST_P(DBIteratorTest, Refresh) {
   iter.reset();
 }
 
+TEST_P(DBIteratorTest, RefreshRebuildsRepeatedly) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  std::unique_ptr<Iterator> iter(NewIterator(ReadOptions()));
+  // Each round adds an L0 file overlapping the others, so that every
+  // Refresh() rebuilds the iterator, with one more table iterator in it.
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 10; i++) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(round)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(iter->Refresh());
+
+    int num_keys = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(num_keys), iter->key());
+      ASSERT_EQ("v" + ToString(round), iter->value());
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(10, num_keys);
+  }
+}
+
 TEST_P(DBIteratorTest, RefreshWithSnapshot) {
   ASSERT_OK(Put("x", "y"));
   const Snapshot* snapshot = db_->GetSnapshot();
@@ -2932,6 +2958,120 @@ TEST_P(DBIteratorTest, IterateWithLowerBoundAcrossFileBoundary) {
   ASSERT_OK(iter->status());
 }
 
+#ifndef ROCKSDB_LITE
+TEST_P(DBIteratorTest, IterateBoundsSkipFiles) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Three L1 files: [a1, a2], [c1, c2] and [e1, e2]
+  for (const char* prefix : {"a", "c", "e"}) {
+    ASSERT_OK(Put(std::string(prefix) + "1", "v"));
+    ASSERT_OK(Put(std::string(prefix) + "2", "v"));
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(1);
+  }
+  ASSERT_EQ("0,3", FilesPerLevel());
+
+  SetPerfLevel(kEnableCount);
+
+  // The file found by the seek starts past the upper bound
+  {
+    Slice upper_bound("b");
+    ReadOptions read_opts;
+    read_opts.iterate_upper_bound = &upper_bound;
+    std::unique_ptr<Iterator> iter(NewIterator(read_opts));
+    get_perf_context()->Reset();
+    iter->Seek("a3");
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(0, get_perf_context()->block_read_count);
+  }
+
+  // All files start past the upper bound
+  {
+    Slice upper_bound("a");
+    ReadOptions read_opts;
+    read_opts.iterate_upper_bound = &upper_bound;
+    std::unique_ptr<Iterator> iter(NewIterator(read_opts));
+    get_perf_context()->Reset();
+    iter->SeekToFirst();
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(0, get_perf_context()->block_read_count);
+  }
+
+  // A backward scan stops before the file ending below the lower bound
+  {
+    Slice lower_bound("d");
+    ReadOptions read_opts;
+    read_opts.iterate_lower_bound = &lower_bound;
+    std::unique_ptr<Iterator> iter(NewIterator(read_opts));
+    get_perf_context()->Reset();
+    iter->SeekToLast();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("e2", iter->key());
+    iter->Prev();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("e1", iter->key());
+    iter->Prev();
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(1, get_perf_context()->block_read_count);
+  }
+
+  SetPerfLevel(kDisable);
+}
+#endif  // !ROCKSDB_LITE
+
+TEST_P(DBIteratorTest, PartitionedIndexUpperBound) {
+  int partition_out_of_bound = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "PartitionedIndexIterator:out_of_bound",
+      [&](void*) { partition_out_of_bound++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+  table_options.block_size = 256;
+  // One data block per index partition
+  table_options.metadata_block_size = 1;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Even keys only, so that the index keys of the data blocks, shortened
+  // separators, fall between the keys.
+  const int kNumKeys = 50;
+  Random rnd(301);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(2 * i), rnd.RandomString(100)));
+  }
+  ASSERT_OK(Flush());
+
+  for (int i = 0; i < kNumKeys; i++) {
+    std::string upper_bound = Key(2 * i + 1);
+    Slice ub(upper_bound);
+    ReadOptions read_opts;
+    read_opts.iterate_upper_bound = &ub;
+    std::unique_ptr<Iterator> iter(NewIterator(read_opts));
+    int num_keys = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(2 * num_keys), iter->key());
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(i + 1, num_keys);
+  }
+  ASSERT_GT(partition_out_of_bound, 0);
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_P(DBIteratorTest, Blob) {
   Options options = CurrentOptions();
   options.enable_blob_files = true;
@@ -3053,6 +3193,109 @@ TEST_P(DBIteratorTest, Blob) {
   ASSERT_EQ(IterStatus(iter), "b->vb3");
 }
 
+TEST_P(DBIteratorTest, NextBatch) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  BlockBasedTableOptions table_options;
+  // Lets pin_data pin every key, not just those at restart points.
+  table_options.use_delta_encoding = false;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; i += 7) {
+    ASSERT_OK(Merge(Key(i), "m" + ToString(i)));
+  }
+  ASSERT_OK(Delete(Key(3)));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(40), Key(50)));
+  ASSERT_OK(Flush());
+  const Snapshot* snapshot = db_->GetSnapshot();
+  // Not visible through the snapshot.
+  ASSERT_OK(Put(Key(3), "after_snapshot"));
+  ASSERT_OK(Delete(Key(60)));
+
+  for (bool pin_data : {false, true}) {
+    ReadOptions ro;
+    ro.snapshot = snapshot;
+    ro.pin_data = pin_data;
+    std::string upper_bound = Key(90);
+    Slice ub(upper_bound);
+    ro.iterate_upper_bound = &ub;
+
+    std::vector<std::pair<std::string, std::string>> expected;
+    {
+      std::unique_ptr<Iterator> iter(NewIterator(ro));
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        expected.emplace_back(iter->key().ToString(),
+                              iter->value().ToString());
+      }
+      ASSERT_OK(iter->status());
+    }
+    ASSERT_EQ(79U, expected.size());
+
+    for (size_t max_bytes : {0, 1, 100}) {
+      std::unique_ptr<Iterator> iter(NewIterator(ro));
+      std::vector<Slice> keys;
+      std::vector<Slice> values;
+      std::string buf;
+      // Slices that do not point into buf must stay valid after the iterator
+      // has moved on; they are checked at the end.
+      std::vector<std::pair<Slice, Slice>> pinned;
+      std::vector<std::pair<std::string, std::string>> actual;
+      auto in_buf = [&](const Slice& s) {
+        return s.data() >= buf.data() && s.data() + s.size() <= buf.data() +
+                                                                   buf.size();
+      };
+      // Start off in the reverse direction.
+      iter->Seek(Key(1));
+      iter->Prev();
+      while (iter->Valid()) {
+        ASSERT_OK(iter->NextBatch(7, max_bytes, &keys, &values, &buf));
+        ASSERT_EQ(keys.size(), values.size());
+        ASSERT_GT(keys.size(), 0U);
+        ASSERT_LE(keys.size(), 7U);
+        if (max_bytes == 1) {
+          ASSERT_EQ(1U, keys.size());
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+          actual.emplace_back(keys[i].ToString(), values[i].ToString());
+          if (in_buf(keys[i]) != in_buf(values[i])) {
+            // Mixed entry, e.g. pinned key with a merged value.
+            continue;
+          }
+          if (!in_buf(keys[i])) {
+            ASSERT_TRUE(pin_data);
+            pinned.emplace_back(keys[i], values[i]);
+          }
+        }
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_OK(iter->NextBatch(7, max_bytes, &keys, &values, &buf));
+      ASSERT_TRUE(keys.empty());
+
+      ASSERT_EQ(expected, actual);
+      if (pin_data) {
+        // Only merge results and the entry read in reverse had to be copied.
+        ASSERT_GT(pinned.size(), expected.size() / 2);
+      }
+      for (const auto& kv : pinned) {
+        auto it = std::find_if(
+            expected.begin(), expected.end(),
+            [&](const std::pair<std::string, std::string>& e) {
+              return e.first == kv.first.ToString();
+            });
+        ASSERT_TRUE(it != expected.end());
+        ASSERT_EQ(it->second, kv.second.ToString());
+      }
+    }
+  }
+  db_->ReleaseSnapshot(snapshot);
+}
+
 INSTANTIATE_TEST_CASE_P(DBIteratorTestInstance, DBIteratorTest,
                         testing::Values(true, false));
 
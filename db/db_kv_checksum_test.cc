@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include "db/db_test_util.h"
+#include "db/kv_checksum.h"
 #include "rocksdb/rocksdb_namespace.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -191,6 +192,32 @@ TEST_P(DbKvChecksumTest, MemTableAddWithColumnFamilyCorrupted) {
   }
 }
 
+TEST(ProtectionInfoTest, FixedWidthFieldChanges) {
+  // A change to the op type, CF ID or seqno is always caught, not just with
+  // a high probability
+  const SequenceNumber kSeq = 100;
+  auto kvot = ProtectionInfo64().ProtectKVOT("key", "value", kTypeValue, "");
+  auto kvots = kvot.ProtectC(3).StripCProtectS(3, kSeq);
+  ASSERT_OK(
+      kvots.StripS(kSeq).StripKVOT("key", "value", kTypeValue, "").GetStatus());
+  for (int bit = 0; bit < 56; bit++) {
+    SequenceNumber seq = kSeq ^ (SequenceNumber{1} << bit);
+    ASSERT_TRUE(kvots.StripS(seq)
+                    .StripKVOT("key", "value", kTypeValue, "")
+                    .GetStatus()
+                    .IsCorruption());
+  }
+  ASSERT_TRUE(kvots.StripS(kSeq)
+                  .StripKVOT("key", "value", kTypeMerge, "")
+                  .GetStatus()
+                  .IsCorruption());
+  ASSERT_TRUE(kvot.ProtectC(3)
+                  .StripC(4)
+                  .StripKVOT("key", "value", kTypeValue, "")
+                  .GetStatus()
+                  .IsCorruption());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -12,6 +12,8 @@
 #include "port/stack_trace.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/slice_transform.h"
+#include "util/random.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -209,6 +211,42 @@ TEST_F(DBMemTableTest, DuplicateSeq) {
   delete mem;
 }
 
+#ifndef ROCKSDB_LITE
+TEST_F(DBMemTableTest, VectorRepParallelSort) {
+  const int kNumKeys = 300000;
+  Options options;
+  InternalKeyComparator cmp(BytewiseComparator());
+  // Three runs, so that one waits out the first merge round
+  options.memtable_factory = std::make_shared<VectorRepFactory>(
+      0 /* count */, 3 /* sort_threads */);
+  ImmutableOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+
+  // Insert in a scrambled order
+  for (int i = 0; i < kNumKeys; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "%08d", (i * 7919) % kNumKeys);
+    ASSERT_OK(mem->Add(i + 1, kTypeValue, key, "value",
+                       nullptr /* kv_prot_info */));
+  }
+  mem->MarkImmutable();
+
+  Arena arena;
+  ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    char key[16];
+    snprintf(key, sizeof(key), "%08d", count);
+    ASSERT_EQ(key, ExtractUserKey(iter->key()).ToString());
+    count++;
+  }
+  ASSERT_EQ(kNumKeys, count);
+  delete mem;
+}
+#endif  // ROCKSDB_LITE
+
 // A simple test to verify that the concurrent merge writes is functional
 TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   int num_ops = 1000;
@@ -276,6 +314,72 @@ TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   delete mem;
 }
 
+TEST_F(DBMemTableTest, ConcurrentInplaceUpdateOutOfOrder) {
+  Options options;
+  options.inplace_update_support = true;
+  InternalKeyComparator cmp(BytewiseComparator());
+  options.memtable_factory = std::make_shared<SkipListFactory>();
+  ImmutableOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+  MemTablePostProcessInfo post_process_info;
+
+  auto get = [&](const Slice& key) {
+    std::string value;
+    Status status;
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    LookupKey lkey(key, kMaxSequenceNumber);
+    if (!mem->Get(lkey, &value, /*timestamp=*/nullptr, &status,
+                  &merge_context, &max_covering_tombstone_seq, ReadOptions())) {
+      return std::string("NOT_FOUND");
+    }
+    return status.ok() ? value : status.ToString();
+  };
+
+  ASSERT_OK(mem->Add(5, kTypeValue, "key", "v5", nullptr /* kv_prot_info */));
+  ASSERT_OK(mem->Add(5, kTypeValue, "key2", "v5", nullptr /* kv_prot_info */));
+
+  // A writer of the group starting at sequence number 10 updates the entry
+  // in-place, then an older writer of the same group arrives.
+  ASSERT_OK(mem->UpdateConcurrently(11, kTypeValue, "key", "vb",
+                                    nullptr /* kv_prot_info */, 10,
+                                    &post_process_info));
+  ASSERT_EQ("vb", get("key"));
+  ASSERT_OK(mem->UpdateConcurrently(10, kTypeValue, "key", "va",
+                                    nullptr /* kv_prot_info */, 10,
+                                    &post_process_info));
+  ASSERT_EQ("vb", get("key"));
+  ASSERT_OK(mem->UpdateConcurrently(10, kTypeDeletion, "key", "",
+                                    nullptr /* kv_prot_info */, 10,
+                                    &post_process_info));
+  ASSERT_EQ("vb", get("key"));
+  // A newer one still updates it
+  ASSERT_OK(mem->UpdateConcurrently(12, kTypeValue, "key", "vc",
+                                    nullptr /* kv_prot_info */, 10,
+                                    &post_process_info));
+  ASSERT_EQ("vc", get("key"));
+  // as does any write of a later group
+  ASSERT_OK(mem->UpdateConcurrently(13, kTypeValue, "key", "vd",
+                                    nullptr /* kv_prot_info */, 13,
+                                    &post_process_info));
+  ASSERT_EQ("vd", get("key"));
+
+  // Larger values and other types are added out-of-place
+  ASSERT_OK(mem->UpdateConcurrently(12, kTypeValue, "key2", "value12",
+                                    nullptr /* kv_prot_info */, 10,
+                                    &post_process_info));
+  ASSERT_EQ("value12", get("key2"));
+  ASSERT_OK(mem->UpdateConcurrently(11, kTypeDeletion, "key2", "",
+                                    nullptr /* kv_prot_info */, 10,
+                                    &post_process_info));
+  ASSERT_EQ("value12", get("key2"));
+  ASSERT_EQ(2, post_process_info.num_entries);
+
+  delete mem;
+}
+
 TEST_F(DBMemTableTest, InsertWithHint) {
   Options options;
   options.allow_concurrent_memtable_write = false;
@@ -334,6 +438,58 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+TEST_F(DBMemTableTest, LargeValuesOutOfLine) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_large_value_threshold = 100;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.memtable_whole_key_filtering = true;
+  options.memtable_prefix_bloom_size_ratio = 0.1;
+  DestroyAndReopen(options);
+
+  std::map<std::string, std::string> expected;
+  Random rnd(301);
+  for (int i = 0; i < 200; i++) {
+    std::string key = Key(i);
+    // Sizes on both sides of the threshold
+    std::string value = rnd.RandomString(i % 2 == 0 ? 10 : 100 + i * 10);
+    ASSERT_OK(Put(key, value));
+    expected[key] = value;
+  }
+  std::string operand = rnd.RandomString(200);
+  ASSERT_OK(Merge(Key(1), operand));
+  expected[Key(1)] += "," + operand;
+  ASSERT_OK(Delete(Key(3)));
+  expected.erase(Key(3));
+
+  auto verify = [&]() {
+    for (int i = 0; i < 200; i++) {
+      auto it = expected.find(Key(i));
+      ASSERT_EQ(it == expected.end() ? "NOT_FOUND" : it->second, Get(Key(i)));
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+  };
+  verify();
+  uint64_t mem_size = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kCurSizeActiveMemTable,
+                                  &mem_size));
+  ASSERT_GT(mem_size, 100 * 100);
+
+  // Flush writes the values out
+  ASSERT_OK(Flush());
+  verify();
+  Reopen(options);
+  verify();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
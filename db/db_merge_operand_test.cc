@@ -322,6 +322,72 @@ TEST_F(DBMergeOperandTest, BlobDBGetMergeOperandsBasic) {
   ASSERT_EQ(values[3], "ed");
 }
 
+TEST_F(DBMergeOperandTest, MultiGetMergeOperands) {
+  Options options;
+  options.create_if_missing = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.env = env_;
+  Reopen(options);
+
+  // k1 operands span a file and the memtable, k2 has a base value, k3 has
+  // too many operands and k4 does not exist
+  ASSERT_OK(Merge("k1", "a"));
+  ASSERT_OK(Put("k2", "x"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Merge("k1", "b"));
+  ASSERT_OK(Merge("k2", "y"));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK(Merge("k3", ToString(i)));
+  }
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Merge("k1", "c"));
+
+  const int kMaxOperands = 3;
+  GetMergeOperandsOptions merge_operands_info;
+  merge_operands_info.expected_max_number_of_operands = kMaxOperands;
+  std::vector<Slice> keys = {"k3", "k1", "k4", "k2"};
+  for (uint64_t min_size_to_pin : {std::numeric_limits<uint64_t>::max(),
+                                   static_cast<uint64_t>(0)}) {
+    ReadOptions read_options;
+    read_options.min_memtable_value_size_to_pin = min_size_to_pin;
+    std::vector<PinnableSlice> operands(keys.size() * kMaxOperands);
+    std::vector<int> number_of_operands(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGetMergeOperands(read_options, db_->DefaultColumnFamily(),
+                               keys.size(), keys.data(), operands.data(),
+                               &merge_operands_info, number_of_operands.data(),
+                               statuses.data());
+    ASSERT_TRUE(statuses[0].IsIncomplete());
+    ASSERT_EQ(4, number_of_operands[0]);
+    ASSERT_OK(statuses[1]);
+    ASSERT_EQ(3, number_of_operands[1]);
+    ASSERT_EQ("a", operands[kMaxOperands]);
+    ASSERT_EQ("b", operands[kMaxOperands + 1]);
+    ASSERT_EQ("c", operands[kMaxOperands + 2]);
+    ASSERT_EQ(min_size_to_pin == 0, operands[kMaxOperands + 2].IsPinned());
+    ASSERT_TRUE(statuses[2].IsNotFound());
+    ASSERT_OK(statuses[3]);
+    ASSERT_EQ(2, number_of_operands[3]);
+    ASSERT_EQ("x", operands[3 * kMaxOperands]);
+    ASSERT_EQ("y", operands[3 * kMaxOperands + 1]);
+  }
+
+  // All keys are read at the snapshot
+  ReadOptions read_options;
+  read_options.snapshot = snapshot;
+  std::vector<PinnableSlice> operands(keys.size() * kMaxOperands);
+  std::vector<int> number_of_operands(keys.size());
+  std::vector<Status> statuses(keys.size());
+  db_->MultiGetMergeOperands(read_options, db_->DefaultColumnFamily(),
+                             keys.size(), keys.data(), operands.data(),
+                             &merge_operands_info, number_of_operands.data(),
+                             statuses.data());
+  ASSERT_OK(statuses[1]);
+  ASSERT_EQ(2, number_of_operands[1]);
+  ASSERT_EQ("b", operands[kMaxOperands + 1]);
+  db_->ReleaseSnapshot(snapshot);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -163,6 +163,60 @@ TEST_F(DBMergeOperatorTest, MergeErrorOnWrite) {
   VerifyDBInternal({{"k1", "corrupted"}, {"k1", "v2"}, {"k1", "v1"}});
 }
 
+TEST_F(DBMergeOperatorTest, CollapseMergeOperandsOnRead) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.merge_operands_collapse_threshold = 3;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("k1", "a"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Merge("k1", "b"));
+  ASSERT_OK(Merge("k1", "c"));
+  ASSERT_OK(Merge("k1", "d"));
+  ASSERT_EQ("a,b,c,d", Get("k1"));
+  ASSERT_EQ(0, TestGetTickerCount(options, MERGE_OPERANDS_COLLAPSED));
+
+  // Reads at a snapshot are not written back
+  ASSERT_OK(Merge("k1", "e"));
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_EQ("a,b,c,d,e", Get("k1", snapshot));
+  db_->ReleaseSnapshot(snapshot);
+  ASSERT_EQ(0, TestGetTickerCount(options, MERGE_OPERANDS_COLLAPSED));
+
+  ASSERT_EQ("a,b,c,d,e", Get("k1"));
+  ASSERT_EQ(1, TestGetTickerCount(options, MERGE_OPERANDS_COLLAPSED));
+  VerifyDBInternal({{"k1", "a,b,c,d,e"},
+                    {"k1", "e"},
+                    {"k1", "d"},
+                    {"k1", "c"},
+                    {"k1", "b"},
+                    {"k1", "a"}});
+  ASSERT_EQ("a,b,c,d,e", Get("k1"));
+  ASSERT_EQ(1, TestGetTickerCount(options, MERGE_OPERANDS_COLLAPSED));
+
+  // A merge between the read and the write-back aborts the latter
+  for (char c = 'f'; c <= 'i'; c++) {
+    ASSERT_OK(Merge("k2", std::string(1, c)));
+  }
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::GetImpl:BeforeCollapseMergeOperands",
+      [&](void* /*arg*/) { ASSERT_OK(Merge("k2", "j")); });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_EQ("f,g,h,i", Get("k2"));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(1, TestGetTickerCount(options, MERGE_OPERANDS_COLLAPSED));
+  ASSERT_EQ(1, TestGetTickerCount(options, MERGE_OPERANDS_COLLAPSE_ABORTED));
+  ASSERT_EQ("f,g,h,i,j", Get("k2"));
+  ASSERT_EQ(2, TestGetTickerCount(options, MERGE_OPERANDS_COLLAPSED));
+
+  Reopen(options);
+  ASSERT_EQ("a,b,c,d,e", Get("k1"));
+  ASSERT_EQ("f,g,h,i,j", Get("k2"));
+}
+
 TEST_F(DBMergeOperatorTest, MergeErrorOnIteration) {
   Options options;
   options.create_if_missing = true;
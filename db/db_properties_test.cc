@@ -1269,6 +1269,45 @@ TEST_F(DBPropertiesTest, GetUserDefinedTableProperties) {
   ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
   ASSERT_GT(collector_factory->num_created_, 0U);
 }
+
+TEST_F(DBPropertiesTest, UserDefinedTablePropertiesParallelCompression) {
+  Options options = CurrentOptions();
+  options.statistics = CreateDBStatistics();
+  options.compression_opts.parallel_threads = 4;
+  options.table_properties_collector_factories.push_back(
+      std::make_shared<CountingUserTblPropCollectorFactory>(0));
+  BlockBasedTableOptions table_options;
+  // The keys of many blocks pass through the key thread
+  table_options.block_size = 256;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_OK(Put(Key(i * 2), "val" + ToString(i)));
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(2000), Key(2010)));
+  ASSERT_OK(Flush());
+
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(1U, props.size());
+  const auto& user_collected = props.begin()->second->user_collected_properties;
+  ASSERT_TRUE(user_collected.find("Count") != user_collected.end());
+  Slice count_slice(user_collected.at("Count"));
+  uint32_t count = 0;
+  ASSERT_TRUE(GetVarint32(&count_slice, &count));
+  // Including the range deletion
+  ASSERT_EQ(1001U, count);
+
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ("val" + ToString(i), Get(Key(i * 2)));
+    ASSERT_EQ("NOT_FOUND", Get(Key(i * 2 + 1)));
+  }
+  // The filter has all keys, and leaves out most of the others
+  ASSERT_GT(options.statistics->getTickerCount(BLOOM_FILTER_USEFUL), 900);
+}
 #endif  // ROCKSDB_LITE
 
 TEST_F(DBPropertiesTest, UserDefinedTablePropertiesContext) {
@@ -1678,6 +1717,46 @@ TEST_F(DBPropertiesTest, EstimateOldestKeyTime) {
                                         &oldest_key_time));
 }
 
+TEST_F(DBPropertiesTest, CompactionDebtForecast) {
+  Options options = CurrentOptions();
+  SetTimeElapseOnlySleepOnReopen(&options);
+  options.level0_file_num_compaction_trigger = 100;
+  options.level0_slowdown_writes_trigger = 20;
+  options.level0_stop_writes_trigger = 30;
+  DestroyAndReopen(options);
+
+  std::map<std::string, std::string> forecast;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kCompactionDebtForecast,
+                                  &forecast));
+  // Nothing ingested yet, so no stall in sight
+  ASSERT_EQ("0", forecast["ingest-bytes-per-sec"]);
+  ASSERT_EQ("-1", forecast["seconds-to-stall"]);
+
+  // L0 files pile up without being compacted
+  for (int i = 0; i < 5; ++i) {
+    env_->MockSleepForSeconds(10);
+    ASSERT_OK(Put("key" + ToString(i), std::string(1000, 'v')));
+    ASSERT_OK(Flush());
+  }
+  env_->MockSleepForSeconds(10);
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kCompactionDebtForecast,
+                                  &forecast));
+  ASSERT_NE("0", forecast["ingest-bytes-per-sec"]);
+  ASSERT_EQ("0", forecast["compaction-bytes-per-sec"]);
+  const int64_t seconds_to_l0_slowdown =
+      std::stoll(forecast["seconds-to-l0-slowdown"]);
+  ASSERT_GT(seconds_to_l0_slowdown, 0);
+  ASSERT_LT(seconds_to_l0_slowdown, std::stoll(forecast["seconds-to-l0-stop"]));
+  ASSERT_EQ(forecast["seconds-to-l0-slowdown"], forecast["seconds-to-stall"]);
+
+  std::string value;
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kCompactionDebtForecast, &value));
+  ASSERT_NE(std::string::npos, value.find("seconds-to-stall: "));
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kCFStats, &value));
+  ASSERT_NE(std::string::npos, value.find("Compaction debt: "));
+}
+
 TEST_F(DBPropertiesTest, SstFilesSize) {
   struct TestListener : public EventListener {
     void OnCompactionCompleted(DB* db,
@@ -555,6 +555,101 @@ TEST_F(DBRangeDelTest, PutDeleteRangeMergeFlush) {
   ASSERT_EQ(expected, actual);
 }
 
+TEST_F(DBRangeDelTest, MemtableTombstonesAfterNewDeleteRange) {
+  // The fragmented range tombstones of a memtable are cached across reads, so
+  // make sure a new DeleteRange is seen by the next read but not by readers
+  // with an older snapshot.
+  ASSERT_OK(Put("a", "va"));
+  ASSERT_OK(Put("b", "vb"));
+  ASSERT_OK(Put("d", "vd"));
+  ASSERT_OK(
+      db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "b", "c"));
+  ASSERT_EQ("va", Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("b"));
+  ASSERT_EQ("vd", Get("d"));
+
+  const Snapshot* snapshot = db_->GetSnapshot();
+  std::unique_ptr<Iterator> old_iter(db_->NewIterator(ReadOptions()));
+  ASSERT_OK(
+      db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a", "b"));
+  ASSERT_OK(
+      db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "c", "e"));
+  ASSERT_EQ("NOT_FOUND", Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("d"));
+  ASSERT_EQ("va", Get("a", snapshot));
+  ASSERT_EQ("vd", Get("d", snapshot));
+  old_iter->SeekToFirst();
+  ASSERT_TRUE(old_iter->Valid());
+  ASSERT_EQ("a", old_iter->key());
+  old_iter->Next();
+  ASSERT_TRUE(old_iter->Valid());
+  ASSERT_EQ("d", old_iter->key());
+  old_iter->Next();
+  ASSERT_FALSE(old_iter->Valid());
+  ASSERT_OK(old_iter->status());
+  old_iter.reset();
+
+#ifndef ROCKSDB_LITE
+  // Same once the memtable is immutable.
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_EQ("NOT_FOUND", Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("b"));
+  ASSERT_EQ("NOT_FOUND", Get("d"));
+  ASSERT_EQ("va", Get("a", snapshot));
+  ASSERT_EQ("vd", Get("d", snapshot));
+#endif  // ROCKSDB_LITE
+  db_->ReleaseSnapshot(snapshot);
+}
+
+TEST_F(DBRangeDelTest, ManyMemtableTombstonesInterleavedWithReads) {
+  // Point lookups check the newest range tombstones of a memtable one by one
+  // and index the older ones in several sorted runs, which must all be
+  // consulted.
+  const int kNumKeys = 200;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), "val"));
+  }
+  const Snapshot* snapshot = nullptr;
+  for (int i = 0; i < kNumKeys / 2; i++) {
+    if (i == kNumKeys / 4) {
+      snapshot = db_->GetSnapshot();
+    }
+    // Deletes the odd keys, in a scattered order.
+    int k = (i * 37) % (kNumKeys / 2) * 2 + 1;
+    ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                               Key(k), Key(k + 1)));
+    ASSERT_EQ("NOT_FOUND", Get(Key(k)));
+    ASSERT_EQ("val", Get(Key(k - 1)));
+  }
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumKeys; i++) {
+    keys.push_back(Key(i));
+  }
+  std::vector<std::string> values = MultiGet(keys, nullptr /* snapshot */);
+  std::vector<std::string> snapshot_values = MultiGet(keys, snapshot);
+  int num_deleted_at_snapshot = 0;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 1 ? "NOT_FOUND" : "val", values[i]);
+    if (snapshot_values[i] == "NOT_FOUND") {
+      ASSERT_EQ(1, i % 2);
+      num_deleted_at_snapshot++;
+    } else {
+      ASSERT_EQ("val", snapshot_values[i]);
+    }
+  }
+  ASSERT_EQ(kNumKeys / 4, num_deleted_at_snapshot);
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int num_keys = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(num_keys * 2), iter->key());
+    num_keys++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys / 2, num_keys);
+  db_->ReleaseSnapshot(snapshot);
+}
+
 // NumTableFilesAtLevel() is not supported in ROCKSDB_LITE
 #ifndef ROCKSDB_LITE
 TEST_F(DBRangeDelTest, ObsoleteTombstoneCleanup) {
@@ -1530,6 +1625,69 @@ TEST_F(DBRangeDelTest, SnapshotPreventsDroppedKeysInImmMemTables) {
   ASSERT_FALSE(iter->Valid());
 }
 
+TEST_F(DBRangeDelTest, CompactionSkipsFilesCoveredByRangeTombstone) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  size_t num_skipped_files = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::SkipInputFilesCoveredByRangeTombstones:NumFiles",
+      [&](void* arg) {
+        num_skipped_files =
+            static_cast<std::unordered_set<uint64_t>*>(arg)->size();
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // One L2 file entirely covered by a newer tombstone in L1, and one that is
+  // only partially covered.
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 20; i < 30; i++) {
+    ASSERT_OK(Put(Key(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  ASSERT_EQ(2, NumTableFilesAtLevel(2));
+
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), Key(0),
+                             Key(25)));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  ASSERT_EQ(1, num_skipped_files);
+  ASSERT_EQ(0, NumTableFilesAtLevel(1));
+  for (int i = 0; i < 30; i++) {
+    ASSERT_EQ(i >= 25 ? "val" : "NOT_FOUND", Get(Key(i)));
+  }
+
+  // A snapshot taken before the tombstone still needs the covered keys.
+  for (int i = 40; i < 50; i++) {
+    ASSERT_OK(Put(Key(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  ManagedSnapshot snapshot(db_);
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(40), Key(60)));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+
+  num_skipped_files = 0;
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  ASSERT_EQ(0, num_skipped_files);
+  for (int i = 40; i < 50; i++) {
+    ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+    ASSERT_EQ("val", Get(Key(i), snapshot.snapshot()));
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBRangeDelTest, RangeTombstoneWrittenToMinimalSsts) {
   // Adapted from
   // https://github.com/cockroachdb/cockroach/blob/de8b3ea603dd1592d9dc26443c2cc92c356fbc2f/pkg/storage/engine/rocksdb_test.go#L1267-L1398.
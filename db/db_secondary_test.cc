@@ -971,6 +971,63 @@ TEST_F(DBSecondaryTest, DISABLED_SwitchWALMultiColumnFamilies) {
   }
 }
 
+TEST_F(DBSecondaryTest, CatchUpInBackground) {
+  class CatchUpListener : public EventListener {
+   public:
+    void OnCaughtUpWithPrimary(DB* /*db*/,
+                               const CatchUpWithPrimaryInfo& info) override {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last_sequence_ = info.last_sequence;
+      cv_.notify_all();
+    }
+
+    // Returns true once the secondary has applied the writes up to `seq`
+    bool WaitFor(SequenceNumber seq) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      return cv_.wait_for(lock, std::chrono::seconds(30),
+                          [&] { return last_sequence_ >= seq; });
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    SequenceNumber last_sequence_ = 0;
+  };
+
+  Options options;
+  options.env = env_;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "v0"));
+
+  auto listener = std::make_shared<CatchUpListener>();
+  Options options1;
+  options1.env = env_;
+  options1.max_open_files = -1;
+  options1.secondary_catch_up_period_micros = 1000;
+  options1.listeners.push_back(listener);
+  OpenSecondary(options1);
+
+  std::string value;
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_OK(Put("foo", "v" + ToString(i)));
+    ASSERT_TRUE(listener->WaitFor(dbfull()->GetLatestSequenceNumber()));
+    ASSERT_OK(db_secondary_->Get(ReadOptions(), "foo", &value));
+    ASSERT_EQ("v" + ToString(i), value);
+  }
+
+  // A flush switches the primary to a new WAL
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("bar", "v4"));
+  ASSERT_TRUE(listener->WaitFor(dbfull()->GetLatestSequenceNumber()));
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "bar", &value));
+  ASSERT_EQ("v4", value);
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ("v3", value);
+
+  // Closing stops the background thread
+  ASSERT_OK(db_secondary_->Close());
+}
+
 TEST_F(DBSecondaryTest, CatchUpAfterFlush) {
   const int kNumKeysPerMemtable = 16;
   Options options;
@@ -117,6 +117,62 @@ TEST_F(DBStatisticsTest, MutexWaitStats) {
   ThreadStatusUtil::TEST_SetStateDelay(ThreadStatus::STATE_MUTEX_WAIT, 0);
 }
 
+TEST_F(DBStatisticsTest, QueueWaitStats) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("hello", "rocksdb"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  HistogramData flush_wait;
+  options.statistics->histogramData(FLUSH_QUEUE_WAIT_MICROS, &flush_wait);
+  ASSERT_GE(flush_wait.count, 1U);
+  HistogramData compaction_wait;
+  options.statistics->histogramData(COMPACTION_QUEUE_WAIT_MICROS,
+                                    &compaction_wait);
+  ASSERT_GE(compaction_wait.count, 1U);
+}
+
+TEST_F(DBStatisticsTest, FileIOLatencyStats) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  // So that Get() reads the data block from the file
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+  auto count = [&](Histograms type) {
+    HistogramData data;
+    options.statistics->histogramData(type, &data);
+    return data.count;
+  };
+  ASSERT_GE(count(MANIFEST_FILE_WRITE_MICROS), 1U);
+
+  ASSERT_OK(Put("a", "1"));
+  ASSERT_OK(Put("b", "1"));
+  ASSERT_OK(Flush());
+  ASSERT_GE(count(WAL_FILE_WRITE_MICROS), 2U);
+  ASSERT_GE(count(FILE_WRITE_USER_MICROS), 2U);
+  ASSERT_GE(count(SST_FILE_WRITE_MICROS), 1U);
+  ASSERT_GE(count(FILE_WRITE_FLUSH_MICROS), 1U);
+  ASSERT_EQ(0U, count(FILE_WRITE_COMPACTION_MICROS));
+
+  ASSERT_OK(Put("a", "2"));
+  ASSERT_OK(Put("b", "2"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GE(count(FILE_READ_COMPACTION_MICROS), 1U);
+  ASSERT_GE(count(FILE_WRITE_COMPACTION_MICROS), 1U);
+
+  Reopen(options);
+  const uint64_t user_reads = count(FILE_READ_USER_MICROS);
+  ASSERT_EQ("2", Get("a"));
+  ASSERT_GT(count(FILE_READ_USER_MICROS), user_reads);
+}
+
 TEST_F(DBStatisticsTest, ResetStats) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -155,6 +211,40 @@ TEST_F(DBStatisticsTest, ExcludeTickers) {
   ASSERT_GT(options.statistics->getTickerCount(BYTES_READ), 0);
 }
 
+TEST_F(DBStatisticsTest, ColumnFamilyStats) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  Options cf_options = options;
+  cf_options.cf_statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  ReopenWithColumnFamilies({kDefaultColumnFamilyName, "pikachu"},
+                           std::vector<Options>{options, cf_options});
+  ASSERT_OK(Put(0, "foo", "v0"));
+  ASSERT_OK(Put(1, "foo", "v1"));
+  ASSERT_OK(Put(1, "bar", "v2"));
+  ASSERT_OK(Flush(1));
+  ASSERT_EQ("v0", Get(0, "foo"));
+  ASSERT_EQ("v1", Get(1, "foo"));
+
+  Statistics* cf_stats = cf_options.cf_statistics.get();
+  ASSERT_EQ(2U, cf_stats->getTickerCount(NUMBER_KEYS_WRITTEN));
+  ASSERT_EQ(8U, cf_stats->getTickerCount(BYTES_WRITTEN));
+  ASSERT_EQ(1U, cf_stats->getTickerCount(NUMBER_KEYS_READ));
+  ASSERT_EQ(2U, cf_stats->getTickerCount(BYTES_READ));
+  ASSERT_GT(cf_stats->getTickerCount(FLUSH_WRITE_BYTES), 0U);
+  HistogramData get_hist;
+  cf_stats->histogramData(DB_GET, &get_hist);
+  ASSERT_EQ(1U, get_hist.count);
+
+  // Still recorded DB-wide
+  ASSERT_EQ(3U, options.statistics->getTickerCount(NUMBER_KEYS_WRITTEN));
+  ASSERT_EQ(2U, options.statistics->getTickerCount(NUMBER_KEYS_READ));
+  ASSERT_EQ(options.statistics->getTickerCount(FLUSH_WRITE_BYTES),
+            cf_stats->getTickerCount(FLUSH_WRITE_BYTES));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -276,6 +276,61 @@ TEST_F(DBTablePropertiesTest, GetDbIdentifiersProperty) {
   }
 }
 
+TEST_F(DBTablePropertiesTest, CompactTableReader) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      ASSERT_OK(Put(Key(i * 100 + j), "val"));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  // Index and filter blocks are held by the table readers
+  std::vector<LiveFileMetaData> metadata;
+  db_->GetLiveFilesMetaData(&metadata);
+  ASSERT_EQ(3U, metadata.size());
+  for (const auto& file : metadata) {
+    ASSERT_GT(file.table_reader_memory_usage, 0U);
+  }
+
+  table_options.compact_table_reader = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  metadata.clear();
+  db_->GetLiveFilesMetaData(&metadata);
+  ASSERT_EQ(3U, metadata.size());
+  for (const auto& file : metadata) {
+    ASSERT_EQ(0U, file.table_reader_memory_usage);
+  }
+  for (int i = 0; i < 300; ++i) {
+    ASSERT_EQ("val", Get(Key(i)));
+  }
+  ASSERT_EQ("NOT_FOUND", Get("missing"));
+
+  // The complete properties are still available, read back through the
+  // block cache
+  std::string id;
+  ASSERT_OK(db_->GetDbIdentity(id));
+  for (int round = 0; round < 2; ++round) {
+    TablePropertiesCollection props;
+    ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+    ASSERT_EQ(3U, props.size());
+    for (const auto& item : props) {
+      ASSERT_EQ(100U, item.second->num_entries);
+      ASSERT_EQ(id, item.second->db_id);
+      ASSERT_EQ(1U, item.second->user_collected_properties.count(
+                        BlockBasedTablePropertyNames::kIndexType));
+    }
+  }
+}
+
 class DBTableHostnamePropertyTest
     : public DBTestBase,
       public ::testing::WithParamInterface<std::tuple<int, std::string>> {
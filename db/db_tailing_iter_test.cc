@@ -550,6 +550,61 @@ TEST_F(DBTestTailingIterator, SeekToFirstWithUpperBoundBug) {
   ASSERT_EQ(iter->key().ToString(), "aa");
 }
 
+TEST_F(DBTestTailingIterator, TailingIteratorKeepsUnchangedLevels) {
+  // level 1: [10, 20, 30, 40]
+  // level 2: [15, 25, 35]
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("15", "15"));
+  ASSERT_OK(Put("25", "25"));
+  ASSERT_OK(Put("35", "35"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  ASSERT_OK(Put("10", "10"));
+  ASSERT_OK(Put("20", "20"));
+  ASSERT_OK(Put("30", "30"));
+  ASSERT_OK(Put("40", "40"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_EQ("0,1,1", FilesPerLevel());
+
+  int num_kept_levels = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "ForwardIterator::RenewIterators:KeepLevel",
+      [&](void* /*arg*/) { num_kept_levels++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  ReadOptions read_options;
+  read_options.tailing = true;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  iter->Seek("10");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("10", iter->key().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("15", iter->key().ToString());
+
+  // A flush changes the SuperVersion in the middle of the scan. Both levels
+  // keep their iterators and positions, and the new L0 file is merged in.
+  ASSERT_OK(Put("22", "22"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1,1,1", FilesPerLevel());
+
+  std::vector<std::string> keys;
+  for (iter->Next(); iter->Valid(); iter->Next()) {
+    keys.push_back(iter->key().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(std::vector<std::string>({"20", "22", "25", "30", "35", "40"}),
+            keys);
+  ASSERT_EQ(2, num_kept_levels);
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 #endif  // !defined(ROCKSDB_LITE)
@@ -1701,6 +1701,72 @@ TEST_F(DBTest, GetApproximateMemTableStats) {
   ASSERT_GT(size, 6000);
 }
 
+TEST_F(DBTest, ApproximateSizesWithKeyPositionSummary) {
+  Options options = CurrentOptions();
+  options.write_buffer_size = 100000000;
+  options.compression = kNoCompression;
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.key_position_samples = 16;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // One entry per data block
+  const int N = 1000;
+  Random rnd(301);
+  for (int i = 0; i < N; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+  }
+  ASSERT_OK(Flush());
+
+  uint64_t index_reads =
+      options.statistics->getTickerCount(BLOCK_CACHE_INDEX_MISS) +
+      options.statistics->getTickerCount(BLOCK_CACHE_INDEX_HIT);
+  std::string start = Key(100);
+  std::string end = Key(300);
+  Range r(start, end);
+  uint64_t size;
+  ASSERT_OK(db_->GetApproximateSizes(&r, 1, &size));
+  // Within the spacing of the samples of the 200 blocks in range
+  ASSERT_GT(size, 100 * 1000);
+  ASSERT_LT(size, 300 * 1000);
+
+  SizeApproximationOptions size_approx_options;
+  size_approx_options.include_memtabtles = true;
+  size_approx_options.include_files = true;
+  uint64_t count;
+  ASSERT_OK(db_->GetApproximateKeyCounts(
+      size_approx_options, db_->DefaultColumnFamily(), &r, 1, &count));
+  ASSERT_GT(count, 100);
+  ASSERT_LT(count, 300);
+  // Neither estimate seeks the index
+  ASSERT_EQ(index_reads,
+            options.statistics->getTickerCount(BLOCK_CACHE_INDEX_MISS) +
+                options.statistics->getTickerCount(BLOCK_CACHE_INDEX_HIT));
+
+  // The whole file, plus keys in the memtable
+  for (int i = N; i < N + 10; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+  }
+  start = Key(0);
+  end = Key(2 * N);
+  r = Range(start, end);
+  ASSERT_OK(db_->GetApproximateKeyCounts(
+      size_approx_options, db_->DefaultColumnFamily(), &r, 1, &count));
+  ASSERT_GE(count, N);
+  ASSERT_LE(count, N + 20);
+
+  start = Key(2 * N);
+  end = Key(3 * N);
+  r = Range(start, end);
+  ASSERT_OK(db_->GetApproximateKeyCounts(
+      size_approx_options, db_->DefaultColumnFamily(), &r, 1, &count));
+  ASSERT_EQ(count, 0);
+}
+
 TEST_F(DBTest, ApproximateSizes) {
   do {
     Options options = CurrentOptions();
@@ -3849,6 +3915,55 @@ TEST_F(DBTest, FIFOCompactionWithTTLTest) {
               options.compaction_options_fifo.max_table_files_size);
   }
 }
+
+TEST_F(DBTest, FIFOCompactionWithTimeWindowTest) {
+  Options options;
+  options.compaction_style = kCompactionStyleFIFO;
+  options.write_buffer_size = 10 << 10;  // 10KB
+  options.arena_block_size = 4096;
+  options.compression = kNoCompression;
+  options.create_if_missing = true;
+  // Do not merge the flushed files of the current window
+  options.level0_file_num_compaction_trigger = 100;
+  options.compaction_options_fifo.time_window_seconds = 60 * 60;  // 1 hour
+  options.ttl = 2 * 60 * 60;                                      // 2 hours
+  env_->SetMockSleep();
+  options.env = env_;
+  options = CurrentOptions(options);
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  auto generate_file = [&](int i) {
+    // Generate and flush a file about 10KB.
+    for (int j = 0; j < 10; j++) {
+      ASSERT_OK(Put(ToString(i * 20 + j), rnd.RandomString(980)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  };
+
+  for (int i = 0; i < 4; i++) {
+    generate_file(i);
+  }
+  ASSERT_EQ(NumTableFilesAtLevel(0), 4);
+
+  // Once its window has passed, the next flush merges the four files.
+  env_->MockSleepForSeconds(60 * 60);
+  generate_file(4);
+  ASSERT_EQ(NumTableFilesAtLevel(0), 2);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 10; j++) {
+      ASSERT_NE("NOT_FOUND", Get(ToString(i * 20 + j)));
+    }
+  }
+
+  // Both windows end more than ttl ago, so they are dropped as a whole.
+  env_->MockSleepForSeconds(4 * 60 * 60);
+  generate_file(5);
+  ASSERT_EQ(NumTableFilesAtLevel(0), 1);
+  ASSERT_EQ("NOT_FOUND", Get(ToString(0)));
+  ASSERT_NE("NOT_FOUND", Get(ToString(5 * 20)));
+}
 #endif  // ROCKSDB_LITE
 
 #ifndef ROCKSDB_LITE
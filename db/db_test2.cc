@@ -16,10 +16,13 @@
 #include "options/options_helper.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
+#include "rocksdb/compressor.h"
 #include "rocksdb/persistent_cache.h"
+#include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/wal_filter.h"
 #include "util/random.h"
 #include "utilities/fault_injection_env.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -1408,6 +1411,191 @@ TEST_F(DBTest2, PresetCompressionDictLocality) {
   }
 }
 
+TEST_F(DBTest2, PresetCompressionDictReuse) {
+  if (!ZSTD_Supported()) {
+    return;
+  }
+  // Like PresetCompressionDictLocality, but all the output SSTs of the
+  // compaction reuse the dictionary built for the first one
+  const int kNumEntriesPerFile = 1 << 10;
+  const int kNumBytesPerEntry = 1 << 10;
+  const int kNumFiles = 4;
+  Options options = CurrentOptions();
+  options.compression = kZSTD;
+  options.compression_opts.max_dict_bytes = 1 << 14;
+  options.compression_opts.zstd_max_train_bytes = 1 << 18;
+  options.compression_opts.max_dict_reuse_seconds = 3600;
+  options.target_file_size_base = kNumEntriesPerFile * kNumBytesPerEntry;
+  Reopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumFiles; ++i) {
+    for (int j = 0; j < kNumEntriesPerFile; ++j) {
+      values.push_back(rnd.RandomString(kNumBytesPerEntry));
+      ASSERT_OK(Put(Key(i * kNumEntriesPerFile + j), values.back()));
+    }
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(1);
+  }
+
+  std::vector<std::string> compression_dicts;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::WriteCompressionDictBlock:RawDict",
+      [&](void* arg) {
+        compression_dicts.emplace_back(static_cast<Slice*>(arg)->ToString());
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+  CompactRangeOptions compact_range_opts;
+  compact_range_opts.bottommost_level_compaction =
+      BottommostLevelCompaction::kForceOptimized;
+  ASSERT_OK(db_->CompactRange(compact_range_opts, nullptr, nullptr));
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+  ASSERT_EQ(NumTableFilesAtLevel(1),
+            static_cast<int>(compression_dicts.size()));
+  for (size_t i = 1; i < compression_dicts.size(); ++i) {
+    ASSERT_EQ(compression_dicts[0], compression_dicts[i]);
+  }
+
+  // Every file decompresses with the dictionary it stores
+  Reopen(options);
+  for (int i = 0; i < kNumFiles * kNumEntriesPerFile; ++i) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
+#ifndef ROCKSDB_LITE
+namespace {
+// Stores runs of the same byte as (length, byte) pairs
+class RunLengthCompressor : public Compressor {
+ public:
+  static const char* kClassName() { return "RunLengthCompressor"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status Compress(const Slice& input, std::string* output) override {
+    for (size_t i = 0; i < input.size();) {
+      size_t run = 1;
+      while (i + run < input.size() && run < 255 &&
+             input[i + run] == input[i]) {
+        run++;
+      }
+      output->push_back(static_cast<char>(run));
+      output->push_back(input[i]);
+      i += run;
+    }
+    num_compressed_++;
+    return Status::OK();
+  }
+
+  Status Uncompress(const Slice& input, char* output,
+                    size_t uncompressed_size) override {
+    size_t pos = 0;
+    for (size_t i = 0; i + 1 < input.size(); i += 2) {
+      const size_t run = static_cast<unsigned char>(input[i]);
+      if (pos + run > uncompressed_size) {
+        return Status::Corruption("Too long");
+      }
+      memset(output + pos, input[i + 1], run);
+      pos += run;
+    }
+    num_uncompressed_++;
+    return pos == uncompressed_size ? Status::OK()
+                                    : Status::Corruption("Too short");
+  }
+
+  std::atomic<int> num_compressed_{0};
+  std::atomic<int> num_uncompressed_{0};
+};
+}  // namespace
+
+TEST_F(DBTest2, CustomCompressor) {
+  ObjectLibrary::Default()->Register<Compressor>(
+      RunLengthCompressor::kClassName(),
+      [](const std::string& /*uri*/, std::unique_ptr<Compressor>* guard,
+         std::string* /*errmsg*/) {
+        guard->reset(new RunLengthCompressor());
+        return guard->get();
+      });
+
+  Options options = CurrentOptions();
+  options.compression = kCustomCompression;
+  options.enable_blob_files = true;
+  options.min_blob_size = 1000;
+  options.blob_compression_type = kCustomCompression;
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+
+  ASSERT_OK(GetColumnFamilyOptionsFromString(
+      ConfigOptions(), options,
+      std::string("compressor=") + RunLengthCompressor::kClassName(),
+      &options));
+  auto compressor =
+      static_cast<RunLengthCompressor*>(options.compressor.get());
+  ASSERT_NE(nullptr, compressor);
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; i++) {
+    // Every other value goes to a blob file
+    ASSERT_OK(Put(Key(i), std::string(i % 2 == 0 ? 100 : 2000, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_GT(compressor->num_compressed_.load(), 1);
+
+  Reopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(std::string(i % 2 == 0 ? 100 : 2000, 'a' + i % 26), Get(Key(i)));
+  }
+  ASSERT_GT(compressor->num_uncompressed_.load(), 1);
+}
+#endif  // ROCKSDB_LITE
+
+TEST_F(DBTest2, AdaptiveCompression) {
+  if (!ZSTD_Supported() || !LZ4_Supported()) {
+    ROCKSDB_GTEST_SKIP("Test requires ZSTD and LZ4 support");
+    return;
+  }
+  Options options = CurrentOptions();
+  options.compression = kZSTD;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.adaptive_compression = true;
+  table_options.verify_compression = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 90; i++) {
+    if (i < 30) {
+      // Incompressible
+      values.push_back(rnd.RandomBinaryString(1000));
+    } else if (i < 60) {
+      // Only compressible by matches
+      std::string part = rnd.RandomString(200);
+      values.push_back(part + part + part + part + part);
+    } else {
+      values.push_back(std::string(1000, 'a' + i % 26));
+    }
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_GT(options.statistics->getTickerCount(ADAPTIVE_COMPRESSION_SKIPPED),
+            0);
+  ASSERT_GT(options.statistics->getTickerCount(ADAPTIVE_COMPRESSION_FAST), 0);
+  ASSERT_GT(
+      options.statistics->getTickerCount(ADAPTIVE_COMPRESSION_CONFIGURED), 0);
+
+  Reopen(options);
+  for (int i = 0; i < 90; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
 class PresetCompressionDictTest
     : public DBTestBase,
       public testing::WithParamInterface<std::tuple<CompressionType, bool>> {
@@ -4421,6 +4609,81 @@ TEST_F(DBTest2, TraceWithSampling) {
   ASSERT_OK(DestroyDB(dbname2, options));
 }
 
+TEST_F(DBTest2, TraceReplayRemapAndIteratorSteps) {
+  Options options = CurrentOptions();
+  ReadOptions ro;
+  TraceOptions trace_opts;
+  EnvOptions env_opts;
+  Reopen(options);
+  ASSERT_OK(Put("a", "1"));
+  ASSERT_OK(Put("b", "2"));
+  ASSERT_OK(Put("c", "3"));
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, env_opts, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(trace_opts, std::move(trace_writer)));
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    iter->Seek("a");
+    iter->Next();
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("c", iter->key().ToString());
+  }
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(db_->EndTrace());
+
+  // The Seek record carries the steps taken after it
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, env_opts, trace_filename, &trace_reader));
+  int num_seeks = 0;
+  std::string encoded_trace;
+  while (trace_reader->Read(&encoded_trace).ok()) {
+    Trace trace;
+    ASSERT_OK(TracerHelper::DecodeTrace(encoded_trace, &trace));
+    if (trace.type == kTraceIteratorSeek) {
+      IterPayload iter_payload;
+      TracerHelper::DecodeIterPayload(&trace, &iter_payload);
+      ASSERT_EQ("a", iter_payload.iter_key.ToString());
+      ASSERT_EQ(2U, iter_payload.next_count);
+      ASSERT_EQ(0U, iter_payload.prev_count);
+      num_seeks++;
+    }
+  }
+  ASSERT_EQ(1, num_seeks);
+
+  std::string dbname2 = test::PerThreadDBPath(env_, "/db_replay_remap");
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2 = nullptr;
+  options.create_if_missing = true;
+  ASSERT_OK(DB::Open(options, dbname2, &db2));
+  std::vector<ColumnFamilyHandle*> handles = {db2->DefaultColumnFamily()};
+
+  ASSERT_OK(NewFileTraceReader(env_, env_opts, trace_filename, &trace_reader));
+  Replayer replayer(db2, handles, std::move(trace_reader));
+  ASSERT_TRUE(replayer.SetReplaySpeed(0).IsInvalidArgument());
+  ASSERT_OK(replayer.SetReplaySpeed(1000.5));
+  ASSERT_TRUE(replayer.SetKeyspaceMultiplier(0).IsInvalidArgument());
+  ASSERT_OK(replayer.SetKeyspaceMultiplier(2));
+  replayer.SetKeyPrefixRewrite("k", "t");
+  ASSERT_OK(replayer.Replay());
+
+  std::string value;
+  ASSERT_TRUE(db2->Get(ro, "k1", &value).IsNotFound());
+  ASSERT_OK(db2->Get(ro, "t1", &value));
+  ASSERT_EQ("v1", value);
+  ASSERT_OK(db2->Get(ro, std::string("\0\0\0\1t1", 6), &value));
+  ASSERT_EQ("v1", value);
+
+  const std::string report = replayer.GetLatencyReport();
+  ASSERT_NE(std::string::npos, report.find("Replay latency of Write"));
+  ASSERT_NE(std::string::npos, report.find("Replay latency of IteratorSeek"));
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+}
+
 TEST_F(DBTest2, TraceWithFilter) {
   Options options = CurrentOptions();
   options.merge_operator = MergeOperators::CreatePutOperator();
@@ -4646,6 +4909,82 @@ TEST_F(DBTest2, PinnableSliceAndMmapReads) {
 #endif
 }
 
+TEST_F(DBTest2, PinnableSliceAndMemtableValues) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+
+  const std::string large_value(1000, 'v');
+  ASSERT_OK(Put("large", large_value));
+  ASSERT_OK(Put("small", "s"));
+  ASSERT_OK(Merge("merged", "a"));
+  ASSERT_OK(Merge("merged", "b"));
+
+  ReadOptions ro;
+  ro.min_memtable_value_size_to_pin = 100;
+
+  PinnableSlice large;
+  ASSERT_OK(db_->Get(ro, db_->DefaultColumnFamily(), "large", &large));
+  ASSERT_TRUE(large.IsPinned());
+  ASSERT_EQ(large.ToString(), large_value);
+
+  PinnableSlice small;
+  ASSERT_OK(db_->Get(ro, db_->DefaultColumnFamily(), "small", &small));
+  ASSERT_FALSE(small.IsPinned());
+  ASSERT_EQ(small.ToString(), "s");
+
+  PinnableSlice merged;
+  ASSERT_OK(db_->Get(ro, db_->DefaultColumnFamily(), "merged", &merged));
+  ASSERT_FALSE(merged.IsPinned());
+  ASSERT_EQ(merged.ToString(), "a,b");
+
+  // The value stays readable after its memtable is flushed and the data is
+  // overwritten.
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("large", "new"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(large.ToString(), large_value);
+  large.Reset();
+
+  // Values of immutable memtables and MultiGet are pinned as well.
+  ASSERT_OK(Put("large", large_value));
+  ASSERT_OK(Put("large2", large_value));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put("large3", large_value));
+  ASSERT_OK(db_->Get(ro, db_->DefaultColumnFamily(), "large", &large));
+  ASSERT_TRUE(large.IsPinned());
+  ASSERT_EQ(large.ToString(), large_value);
+
+  std::vector<Slice> keys{"large2", "large3", "small"};
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+  db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                values.data(), statuses.data());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_OK(statuses[i]);
+  }
+  ASSERT_TRUE(values[0].IsPinned());
+  ASSERT_TRUE(values[1].IsPinned());
+  ASSERT_OK(Flush());
+  ASSERT_EQ(values[0].ToString(), large_value);
+  ASSERT_EQ(values[1].ToString(), large_value);
+  ASSERT_EQ(values[2].ToString(), "s");
+
+  // Values are copied by default.
+  PinnableSlice copied;
+  ASSERT_OK(Put("large", large_value));
+  ASSERT_OK(db_->Get(ReadOptions(), db_->DefaultColumnFamily(), "large",
+                     &copied));
+  ASSERT_FALSE(copied.IsPinned());
+  ASSERT_EQ(copied.ToString(), large_value);
+
+  // The pinned values hold references on super versions, which must be
+  // released before the DB is closed.
+  large.Reset();
+  values.clear();
+}
+
 TEST_F(DBTest2, DISABLED_IteratorPinnedMemory) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -5898,6 +6237,43 @@ TEST_F(DBTest2, BottommostTemperature) {
   ASSERT_EQ(1, metadata.file_count);
   ASSERT_EQ(Temperature::kWarm, metadata.levels[1].files[0].temperature);
 }
+
+TEST_F(DBTest2, BottommostHotFileReadRate) {
+  Options options = CurrentOptions();
+  options.bottommost_temperature = Temperature::kWarm;
+  options.bottommost_hot_file_read_rate = 1000;
+  options.level0_file_num_compaction_trigger = 2;
+  Reopen(options);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Put("bar", "bar"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Put("bar", "bar"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  ColumnFamilyMetaData metadata;
+  db_->GetColumnFamilyMetaData(&metadata);
+  ASSERT_EQ(1, metadata.levels[1].files.size());
+  ASSERT_EQ(Temperature::kWarm, metadata.levels[1].files[0].temperature);
+
+  // One in kFileReadSampleRate reads is sampled, and each sample counts for
+  // more reads per hour per MB than the threshold
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_EQ("bar", Get("foo"));
+  }
+
+  // Files are checked for hotness when a new version is installed
+  ASSERT_OK(Put("baz", "bar"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  db_->GetColumnFamilyMetaData(&metadata);
+  ASSERT_EQ(1, metadata.levels[1].files.size());
+  ASSERT_EQ(Temperature::kUnknown, metadata.levels[1].files[0].temperature);
+  ASSERT_EQ("bar", Get("foo"));
+}
 #endif  // ROCKSDB_LITE
 
 // WAL recovery mode is WALRecoveryMode::kPointInTimeRecovery.
@@ -5969,6 +6345,123 @@ TEST_F(DBTest2, RenameDirectory) {
   Destroy(options);
   dbname_ = old_dbname;
 }
+
+TEST_F(DBTest2, MemtableHotKeyCache) {
+  Options options = CurrentOptions();
+  options.memtable_hot_key_cache_size = 16;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(2, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // Writes to the key invalidate the cached result, including when they are
+  // older than a snapshot being read.
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ("v1", Get("foo", snapshot));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ(3, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  db_->ReleaseSnapshot(snapshot);
+
+  // Not found results are cached too.
+  ASSERT_OK(Delete("foo"));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_EQ(4, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_OK(Put("foo", "v3"));
+  ASSERT_EQ("v3", Get("foo"));
+  ASSERT_EQ("v3", Get("foo"));
+  ASSERT_EQ(5, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // So do range deletions of any key.
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "z"));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_OK(Put("foo", "v4"));
+
+  // A flush installs a new SuperVersion with an empty cache.
+  ASSERT_OK(Flush());
+  uint64_t misses = TestGetTickerCount(options, HOT_KEY_CACHE_MISS);
+  ASSERT_EQ("v4", Get("foo"));
+  ASSERT_EQ(misses + 1, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+  ASSERT_EQ("v4", Get("foo"));
+  ASSERT_EQ(6, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_OK(Put("foo", "v5"));
+  ASSERT_EQ("v5", Get("foo"));
+}
+
+TEST_F(DBTest2, Level0SublevelReads) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.level0_file_num_compaction_trigger = 100;
+  options.level0_slowdown_writes_trigger = 100;
+  options.level0_stop_writes_trigger = 100;
+  Reopen(options);
+
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%04d", i);
+    return std::string(buf);
+  };
+  // Files over four ranges, each overlapping the next one, so that L0 falls
+  // into fewer sublevels than files
+  std::map<std::string, std::string> expected;
+  const int kNumFiles = 12;
+  for (int f = 0; f < kNumFiles; ++f) {
+    int base = (f % 4) * 25;
+    for (int i = base + f % 3; i < base + 30; i += 3) {
+      std::string value = "v" + ToString(f) + "_" + ToString(i);
+      ASSERT_OK(Put(key(i), value));
+      expected[key(i)] = value;
+    }
+    if (f % 5 == 4) {
+      ASSERT_OK(Delete(key(base + 10)));
+      expected.erase(key(base + 10));
+    }
+    if (f == 9) {
+      ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                                 key(20), key(40)));
+      expected.erase(expected.lower_bound(key(20)),
+                     expected.lower_bound(key(40)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(0));
+
+  for (int i = 0; i < 110; ++i) {
+    auto it = expected.find(key(i));
+    ASSERT_EQ(it == expected.end() ? "NOT_FOUND" : it->second, Get(key(i)));
+  }
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  auto expected_it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected_it) {
+    ASSERT_TRUE(expected_it != expected.end());
+    ASSERT_EQ(expected_it->first, iter->key().ToString());
+    ASSERT_EQ(expected_it->second, iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(expected_it == expected.end());
+
+  auto expected_rit = expected.rbegin();
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++expected_rit) {
+    ASSERT_TRUE(expected_rit != expected.rend());
+    ASSERT_EQ(expected_rit->first, iter->key().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(expected_rit == expected.rend());
+
+  iter->Seek(key(21));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(expected.lower_bound(key(21))->first, iter->key().ToString());
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 #ifdef ROCKSDB_UNITTESTS_WITH_CUSTOM_OBJECTS_FROM_STATIC_LIBS
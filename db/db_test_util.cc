@@ -131,7 +131,8 @@ bool DBTestBase::ShouldSkipOptions(int option_config, int skip_mask) {
         option_config == kUniversalCompactionMultiLevel ||
         option_config == kUniversalSubcompactions ||
         option_config == kFIFOCompaction ||
-        option_config == kConcurrentSkipList) {
+        option_config == kConcurrentSkipList ||
+        option_config == kHashIndexedSkipList) {
       return true;
     }
 #endif
@@ -408,6 +409,10 @@ Options DBTestBase::GetOptions(
       options.allow_concurrent_memtable_write = false;
       options.unordered_write = false;
       break;
+    case kHashIndexedSkipList:
+      options.memtable_factory.reset(NewHashIndexedSkipListRepFactory(64));
+      options.allow_concurrent_memtable_write = true;
+      break;
       case kDirectIO: {
         options.use_direct_reads = true;
         options.use_direct_io_for_flush_and_compaction = true;
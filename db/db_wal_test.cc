@@ -216,6 +216,93 @@ TEST_F(DBWALTest, RollLog) {
   } while (ChangeWalOptions());
 }
 
+#if !defined(ROCKSDB_LITE) && !defined(OS_MACOSX) && !defined(OS_WIN) && \
+    !defined(OS_SOLARIS) && !defined(OS_AIX) && !defined(OS_OPENBSD)
+TEST_F(DBWALTest, DirectIOForWAL) {
+  if (!IsDirectIOSupported()) {
+    ROCKSDB_GTEST_SKIP("Direct IO not supported");
+    return;
+  }
+  Options options = CurrentOptions();
+  options.use_direct_io_for_wal = true;
+  options.allow_mmap_writes = false;
+  options.recycle_log_file_num = 2;
+
+  std::atomic<int> direct_writable_files{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "NewWritableFile:O_DIRECT", [&](void* arg) {
+        int* val = static_cast<int*>(arg);
+        ASSERT_NE(0, *val & O_DIRECT);
+        direct_writable_files.fetch_add(1);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  DestroyAndReopen(options);
+  // Only the WAL is written with direct I/O
+  ASSERT_GT(direct_writable_files.load(), 0);
+
+  WriteOptions sync_write;
+  sync_write.sync = true;
+  // Records of odd sizes leave the tail of the WAL unaligned, so every write
+  // is padded and its last block rewritten by the next one
+  for (int i = 0; i < 100; i++) {
+    std::string value(i * 37 + 1, static_cast<char>('a' + i % 26));
+    ASSERT_OK(db_->Put(i % 2 ? sync_write : WriteOptions(), Key(i), value));
+  }
+  ASSERT_OK(db_->FlushWAL(true /* sync */));
+  ASSERT_OK(Flush());
+  // The next WAL recycles the previous one
+  ASSERT_OK(Put("recycled", "wal"));
+
+  Reopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(std::string(i * 37 + 1, static_cast<char>('a' + i % 26)),
+              Get(Key(i)));
+  }
+  ASSERT_EQ("wal", Get("recycled"));
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  options.allow_mmap_writes = true;
+  ASSERT_TRUE(TryReopen(options).IsNotSupported());
+}
+#endif  // !ROCKSDB_LITE && !OS_MACOSX && !OS_WIN && !OS_SOLARIS && !OS_AIX &&
+        // !OS_OPENBSD
+
+TEST_F(DBWALTest, PmemWAL) {
+  if (!IsMemoryMappedAccessSupported()) {
+    ROCKSDB_GTEST_SKIP("Memory mapped writes not supported");
+    return;
+  }
+  Options options = CurrentOptions();
+  options.use_pmem_for_wal = true;
+  options.recycle_log_file_num = 2;
+  DestroyAndReopen(options);
+
+  // Outside DAX file systems the WAL is memory mapped without MAP_SYNC and
+  // synced with msync()
+  WriteOptions sync_write;
+  sync_write.sync = true;
+  for (int i = 0; i < 200; i++) {
+    // Large enough values to map several regions of the WAL
+    std::string value(i * 1000 + 1, static_cast<char>('a' + i % 26));
+    ASSERT_OK(db_->Put(i % 2 ? sync_write : WriteOptions(), Key(i), value));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("recycled", "wal", sync_write));
+
+  Reopen(options);
+  for (int i = 0; i < 200; i++) {
+    ASSERT_EQ(std::string(i * 1000 + 1, static_cast<char>('a' + i % 26)),
+              Get(Key(i)));
+  }
+  ASSERT_EQ("wal", Get("recycled"));
+
+  options.use_direct_io_for_wal = true;
+  ASSERT_TRUE(TryReopen(options).IsNotSupported());
+}
+
 TEST_F(DBWALTest, SyncWALNotBlockWrite) {
   Options options = CurrentOptions();
   options.max_write_buffer_number = 4;
@@ -1045,6 +1132,56 @@ TEST_F(DBWALTest, RecoverWithLargeLog) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, RecoverWithParallelInserts) {
+  Options options = CurrentOptions();
+  options.avoid_flush_during_recovery = true;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  // Overwrite keys in both column families, so the values recovered depend
+  // on the batches being applied in sequence number order
+  constexpr int kNumBatches = 1000;
+  for (int i = 0; i < kNumBatches; ++i) {
+    WriteBatch batch;
+    ASSERT_OK(batch.Put(handles_[0], Key(i % 100), "v" + ToString(i)));
+    ASSERT_OK(batch.Put(handles_[1], Key(i % 37), "v" + ToString(i)));
+    if (i % 10 == 0) {
+      ASSERT_OK(batch.Delete(handles_[1], Key(i % 37)));
+    }
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  }
+  std::map<std::string, std::string> expected[2];
+  for (int cf = 0; cf < 2; ++cf) {
+    std::unique_ptr<Iterator> iter(
+        db_->NewIterator(ReadOptions(), handles_[cf]));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      expected[cf][iter->key().ToString()] = iter->value().ToString();
+    }
+    ASSERT_OK(iter->status());
+  }
+
+  // Recover without flushing first, then with memtables filling up in the
+  // middle of recovery
+  options.wal_recovery_threads = 4;
+  for (size_t write_buffer_size : {size_t{64 << 20}, size_t{16 << 10}}) {
+    options.write_buffer_size = write_buffer_size;
+    options.avoid_flush_during_recovery = write_buffer_size >= (1 << 20);
+    ReopenWithColumnFamilies({"default", "pikachu"}, options);
+
+    ASSERT_EQ(dbfull()->GetLatestSequenceNumber(),
+              static_cast<SequenceNumber>(kNumBatches * 2 + kNumBatches / 10));
+    for (int cf = 0; cf < 2; ++cf) {
+      std::map<std::string, std::string> actual;
+      std::unique_ptr<Iterator> iter(
+          db_->NewIterator(ReadOptions(), handles_[cf]));
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        actual[iter->key().ToString()] = iter->value().ToString();
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(expected[cf], actual);
+    }
+  }
+}
+
 // In https://reviews.facebook.net/D20661 we change
 // recovery behavior: previously for each log file each column family
 // memtable was flushed, even it was empty. Now it's changed:
@@ -1172,6 +1172,67 @@ TEST_F(DBBasicTestWithTimestamp, MultiGetWithFastLocalBloom) {
   Close();
 }
 
+TEST_F(DBBasicTestWithTimestamp, SkipFilesNewerThanReadTimestamp) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  const size_t kTimestampSize = Timestamp(0, 0).size();
+  TestComparator test_cmp(kTimestampSize);
+  options.comparator = &test_cmp;
+  DestroyAndReopen(options);
+
+  WriteOptions write_opts;
+  for (uint64_t i = 1; i <= 2; i++) {
+    std::string ts_str = Timestamp(10 * i, 0);
+    Slice ts = ts_str;
+    write_opts.timestamp = &ts;
+    ASSERT_OK(db_->Put(write_opts, "foo", "v" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+
+#ifndef ROCKSDB_LITE
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(2U, props.size());
+  for (const auto& item : props) {
+    const auto& user_props = item.second->user_collected_properties;
+    ASSERT_EQ(1U, user_props.count(TablePropertiesNames::kTimestampMin));
+    ASSERT_EQ(1U, user_props.count(TablePropertiesNames::kTimestampMax));
+  }
+#endif  // !ROCKSDB_LITE
+
+  // Both files are newer than the read, so none of their blocks is read
+  SetPerfLevel(kEnableCount);
+  std::string ts_str = Timestamp(5, 0);
+  Slice ts = ts_str;
+  ReadOptions read_opts;
+  read_opts.timestamp = &ts;
+  get_perf_context()->Reset();
+  std::string value;
+  ASSERT_TRUE(db_->Get(read_opts, "foo", &value).IsNotFound());
+  std::vector<Slice> keys{"foo"};
+  std::vector<std::string> values;
+  ASSERT_TRUE(db_->MultiGet(read_opts, keys, &values)[0].IsNotFound());
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_opts));
+  iter->SeekToFirst();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+  iter.reset();
+  ASSERT_EQ(0, get_perf_context()->block_read_count);
+
+  ts_str = Timestamp(15, 0);
+  ts = ts_str;
+  ASSERT_OK(db_->Get(read_opts, "foo", &value));
+  ASSERT_EQ("v1", value);
+  ts_str = Timestamp(25, 0);
+  ts = ts_str;
+  ASSERT_OK(db_->Get(read_opts, "foo", &value));
+  ASSERT_EQ("v2", value);
+  SetPerfLevel(kDisable);
+  Close();
+}
+
 TEST_P(DBBasicTestWithTimestampTableOptions, MultiGetWithPrefix) {
   Options options = CurrentOptions();
   options.env = env_;
@@ -110,6 +110,58 @@ TEST_F(TimestampCompatibleCompactionTest, UserKeyCrossFileBoundary) {
   SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(TimestampCompatibleCompactionTest, Subcompactions) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.compaction_style = kCompactionStyleLevel;
+  options.comparator = test::ComparatorWithU64Ts();
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = 4;
+  options.target_file_size_base = 32 << 10;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  // Several versions of every key, in files that each cover all keys, so
+  // that subcompaction boundaries fall between versions of a user key
+  // unless all of them are kept together.
+  constexpr uint64_t kNumKeys = 500;
+  constexpr uint64_t kNumVersions = 4;
+  WriteOptions write_opts;
+  uint64_t ts = 100;
+  for (uint64_t v = 0; v < kNumVersions; ++v, ++ts) {
+    std::string ts_str = Timestamp(ts);
+    Slice ts_slice = ts_str;
+    write_opts.timestamp = &ts_slice;
+    for (uint64_t key = 0; key < kNumKeys; ++key) {
+      ASSERT_OK(db_->Put(write_opts, Key1(key),
+                         "v" + std::to_string(v) + std::string(100, 'x')));
+    }
+    ASSERT_OK(Flush());
+    if (v == 1) {
+      // Subcompactions of L0 files need a non-empty output level
+      MoveFilesToLevel(1);
+    }
+  }
+  ASSERT_OK(options.statistics->Reset());
+  std::string ts_str = Timestamp(ts);
+  Slice ts_slice = ts_str;
+  CompactRangeOptions cro;
+  cro.full_history_ts_low = &ts_slice;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+
+  HistogramData subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &subcompactions);
+  ASSERT_GT(subcompactions.max, 1);
+  // With full_history_ts_low past all versions only the newest one of each
+  // key remains, which requires all versions of a key to be seen together.
+  for (uint64_t key = 0; key < kNumKeys; ++key) {
+    ASSERT_EQ("v" + std::to_string(kNumVersions - 1) + std::string(100, 'x'),
+              Get(Key1(key), ts));
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -780,6 +780,56 @@ TEST_P(DBWriteBufferManagerTest, MixedSlowDownOptionsMultipleDB) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_P(DBWriteBufferManagerTest, WeightedShareFlushVictim) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  options.write_buffer_size = 500000;  // this is never hit
+  std::shared_ptr<Cache> cache = NewLRUCache(4 * 1024 * 1024, 2);
+  cost_cache_ = GetParam();
+  options.write_buffer_manager.reset(new WriteBufferManager(
+      100000, cost_cache_ ? cache : nullptr, false /* allow_stall */,
+      WriteBufferManager::FlushVictimPolicy::kWeightedShare));
+
+  WriteOptions wo;
+  wo.disableWAL = true;
+
+  CreateAndReopenWithCF({"cold", "hot"}, options);
+  auto wait_flush = [&]() {
+    for (auto* handle : handles_) {
+      ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable(handle));
+    }
+  };
+
+  // "cold" has the oldest memtable, but "hot" uses most of the buffer and
+  // is the one flushed.
+  ASSERT_OK(Put(1, Key(1), DummyString(1), wo));
+  ASSERT_OK(Put(2, Key(1), DummyString(50000), wo));
+  ASSERT_OK(Put(2, Key(2), DummyString(50000), wo));
+  // The buffer is full, so this write triggers a flush.
+  ASSERT_OK(Put(1, Key(2), DummyString(1), wo));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cold"),
+            static_cast<uint64_t>(0));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "hot"),
+            static_cast<uint64_t>(1));
+
+  // With a minimum share covering its usage, "hot" is left alone and "cold"
+  // is flushed instead.
+  ASSERT_OK(db_->SetOptions(handles_[2],
+                            {{"write_buffer_min_share_bytes", "1000000"}}));
+  ASSERT_OK(Put(2, Key(3), DummyString(50000), wo));
+  ASSERT_OK(Put(2, Key(4), DummyString(50000), wo));
+  ASSERT_OK(Put(1, Key(3), DummyString(1), wo));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cold"),
+            static_cast<uint64_t>(1));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "hot"),
+            static_cast<uint64_t>(1));
+
+  ASSERT_NOK(
+      db_->SetOptions(handles_[1], {{"write_buffer_share_weight", "0"}}));
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteBufferManagerTest, DBWriteBufferManagerTest,
                         testing::Bool());
 
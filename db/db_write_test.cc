@@ -451,6 +451,168 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
     ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, SpinBudgetLimitsSpinningWriters) {
+  Options options = GetOptions();
+  options.write_thread_spinners_per_core = 1;
+  Reopen(options);
+
+  const uint32_t max_spinners =
+      std::max(1u, std::thread::hardware_concurrency());
+  std::atomic<uint32_t> spin_budget_exceeded(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::AwaitState:SpinBudgetExceeded",
+      [&](void*) { spin_budget_exceeded.fetch_add(1); });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  const int kNumThreads = static_cast<int>(max_spinners) * 4;
+  const int kNumKeysPerThread = 100;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        ASSERT_OK(Put("key" + ToString(t) + "_" + ToString(i), "value"));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Whether the budget was hit depends on scheduling, but every write must
+  // have been applied regardless of how its writer waited.
+  fprintf(stderr, "Spin budget exceeded %u times\n",
+          spin_budget_exceeded.load());
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeysPerThread; i++) {
+      ASSERT_EQ("value", Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+}
+
+TEST_P(DBWriteTest, SortedBatchInsert) {
+  Options options = GetOptions();
+  options.memtable_batch_sort_threshold = 8;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  // Unsorted keys, repeated keys, and deletes of keys written earlier in the
+  // same batch must resolve exactly as they would in batch order.
+  WriteBatch batch;
+  for (int i = 99; i >= 0; i--) {
+    ASSERT_OK(batch.Put("key" + ToString(i % 37), "v" + ToString(i)));
+    ASSERT_OK(batch.Put(handles_[1], "cf_key" + ToString(i % 11),
+                        "v" + ToString(i)));
+  }
+  ASSERT_OK(batch.Delete("key3"));
+  ASSERT_OK(batch.SingleDelete(handles_[1], "cf_key5"));
+  ASSERT_OK(batch.Put("key4", "last"));
+  const SequenceNumber seq_before = dbfull()->GetLatestSequenceNumber();
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  ASSERT_EQ(seq_before + batch.Count(), dbfull()->GetLatestSequenceNumber());
+
+  for (int k = 0; k < 37; k++) {
+    // The last write of key<k> in the batch is the smallest i with i % 37 == k
+    std::string expected = "v" + ToString(k);
+    if (k == 3) {
+      expected = "NOT_FOUND";
+    } else if (k == 4) {
+      expected = "last";
+    }
+    ASSERT_EQ(expected, Get("key" + ToString(k)));
+  }
+  for (int k = 0; k < 11; k++) {
+    ASSERT_EQ(k == 5 ? "NOT_FOUND" : "v" + ToString(k),
+              Get(1, "cf_key" + ToString(k)));
+  }
+
+  // Recovery from the WAL goes through the same path.
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ("NOT_FOUND", Get("key3"));
+  ASSERT_EQ("last", Get("key4"));
+  ASSERT_EQ("v10", Get("key10"));
+  ASSERT_EQ("v10", Get(1, "cf_key10"));
+}
+
+TEST_P(DBWriteTest, NoWALWriteFastPath) {
+  Options options = GetOptions();
+  options.enable_no_wal_write_fast_path = true;
+  options.enable_pipelined_write = false;
+  options.two_write_queues = false;
+  options.write_buffer_size = 64 << 10;
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+
+  WriteOptions no_wal;
+  no_wal.disableWAL = true;
+
+  // A fast path write is not visible before the earlier ones are
+  std::atomic<int> publishing(0);
+  std::atomic<bool> release_first(false);
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FastPathWriteImpl:BeforePublish", [&](void*) {
+        if (publishing.fetch_add(1) == 0) {
+          while (!release_first.load()) {
+            std::this_thread::yield();
+          }
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  const SequenceNumber seq_before = dbfull()->GetLatestSequenceNumber();
+  port::Thread first([&] { ASSERT_OK(db_->Put(no_wal, "first", "v1")); });
+  while (publishing.load() < 1) {
+    std::this_thread::yield();
+  }
+  port::Thread second([&] { ASSERT_OK(db_->Put(no_wal, "second", "v2")); });
+  while (publishing.load() < 2) {
+    std::this_thread::yield();
+  }
+  ASSERT_EQ("NOT_FOUND", Get("second"));
+  ASSERT_EQ(seq_before, dbfull()->GetLatestSequenceNumber());
+  release_first.store(true);
+  first.join();
+  second.join();
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ("v1", Get("first"));
+  ASSERT_EQ("v2", Get("second"));
+  ASSERT_EQ(seq_before + 2, dbfull()->GetLatestSequenceNumber());
+
+  // Concurrent fast path writes, WAL writes and merges that take the write
+  // thread, and memtable switches that block the fast path
+  const int kNumThreads = 8;
+  const int kNumKeysPerThread = 500;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        std::string key = "key" + ToString(t) + "_" + ToString(i);
+        if (t == 0) {
+          ASSERT_OK(db_->Put(WriteOptions(), key, std::string(100, 'w')));
+        } else {
+          ASSERT_OK(db_->Put(no_wal, key, std::string(100, 'x')));
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeysPerThread; i++) {
+      ASSERT_EQ(std::string(100, t == 0 ? 'w' : 'x'),
+                Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+  ASSERT_EQ(seq_before + 2 + kNumThreads * kNumKeysPerThread,
+            dbfull()->GetLatestSequenceNumber());
+  ASSERT_GT(options.statistics->getTickerCount(WRITE_FAST_PATH), 0);
+  ASSERT_GT(options.statistics->getTickerCount(FLUSH_WRITE_BYTES), 0);
+
+  options.enable_pipelined_write = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
@@ -337,7 +337,7 @@ const Status& ErrorHandler::SetBGError(const Status& bg_err,
     EventHelpers::NotifyOnBackgroundError(db_options_.listeners, reason, &s,
                                           db_mutex_, &auto_recovery);
     if (!s.ok() && (s.severity() > bg_error_.severity())) {
-      bg_error_ = s;
+      SetBGErrorStatus(s);
     } else {
       // This error is less severe than previously encountered error. Don't
       // take any further action
@@ -406,7 +406,7 @@ const Status& ErrorHandler::SetBGError(const IOStatus& bg_io_err,
     // it can directly overwrite any existing bg_error_.
     bool auto_recovery = false;
     Status bg_err(new_bg_io_err, Status::Severity::kUnrecoverableError);
-    bg_error_ = bg_err;
+    SetBGErrorStatus(bg_err);
     if (recovery_in_prog_ && recovery_error_.ok()) {
       recovery_error_ = bg_err;
     }
@@ -472,7 +472,7 @@ const Status& ErrorHandler::SetBGError(const IOStatus& bg_io_err,
         recovery_error_ = bg_err;
       }
       if (bg_err.severity() > bg_error_.severity()) {
-        bg_error_ = bg_err;
+        SetBGErrorStatus(bg_err);
       }
       soft_error_no_bg_work_ = true;
       context.flush_reason = FlushReason::kErrorRecoveryRetryFlush;
@@ -484,7 +484,7 @@ const Status& ErrorHandler::SetBGError(const IOStatus& bg_io_err,
         recovery_error_ = bg_err;
       }
       if (bg_err.severity() > bg_error_.severity()) {
-        bg_error_ = bg_err;
+        SetBGErrorStatus(bg_err);
       }
       recover_context_ = context;
       return StartRecoverFromRetryableBGIOError(bg_io_err);
@@ -554,7 +554,7 @@ Status ErrorHandler::ClearBGError() {
   if (recovery_error_.ok()) {
     Status old_bg_error = bg_error_;
     // Clear and check the recovery IO and BG error
-    bg_error_ = Status::OK();
+    SetBGErrorStatus(Status::OK());
     recovery_io_error_ = IOStatus::OK();
     bg_error_.PermitUncheckedError();
     recovery_io_error_.PermitUncheckedError();
@@ -735,7 +735,7 @@ void ErrorHandler::RecoverFromRetryableBGIOError() {
         // the bg_error and notify user.
         TEST_SYNC_POINT("RecoverFromRetryableBGIOError:RecoverSuccess");
         Status old_bg_error = bg_error_;
-        bg_error_ = Status::OK();
+        SetBGErrorStatus(Status::OK());
         bg_error_.PermitUncheckedError();
         EventHelpers::NotifyOnErrorRecoveryCompleted(db_options_.listeners,
                                                      old_bg_error, db_mutex_);
@@ -38,6 +38,7 @@ class ErrorHandler {
          auto_recovery_(false),
          recovery_in_prog_(false),
          soft_error_no_bg_work_(false),
+         db_stopped_(false),
          bg_error_stats_(db_options.statistics) {
      // Clear the checked flag for uninitialized errors
      bg_error_.PermitUncheckedError();
@@ -75,6 +76,12 @@ class ErrorHandler {
 
     bool IsSoftErrorNoBGWork() { return soft_error_no_bg_work_; }
 
+    // Same as IsDBStopped(), but does not require the DB mutex. Used by
+    // writes that do not take it.
+    bool IsDBStoppedUnlocked() const {
+      return db_stopped_.load(std::memory_order_relaxed);
+    }
+
     bool IsRecoveryInProgress() { return recovery_in_prog_; }
 
     Status RecoverFromBGError(bool is_manual = false);
@@ -105,6 +112,8 @@ class ErrorHandler {
     // A flag to indicate that for the soft error, we should not allow any
     // background work except the work is from recovery.
     bool soft_error_no_bg_work_;
+    // IsDBStopped(), updated with bg_error_
+    std::atomic<bool> db_stopped_;
 
     // Used to store the context for recover, such as flush reason.
     DBRecoverContext recover_context_;
@@ -112,6 +121,11 @@ class ErrorHandler {
     // The pointer of DB statistics.
     std::shared_ptr<Statistics> bg_error_stats_;
 
+    void SetBGErrorStatus(const Status& bg_err) {
+      bg_error_ = bg_err;
+      db_stopped_.store(IsDBStopped(), std::memory_order_relaxed);
+    }
+
     Status OverrideNoSpaceError(const Status& bg_error, bool* auto_recovery);
     void RecoverFromNoSpace();
     const Status& StartRecoverFromRetryableBGIOError(const IOStatus& io_error);
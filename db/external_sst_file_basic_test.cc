@@ -648,6 +648,46 @@ TEST_F(ExternalSSTFileBasicTest, NoCopy) {
   }
 }
 
+TEST_F(ExternalSSTFileBasicTest, IngestWithPrepareThreads) {
+  Options options = CurrentOptions();
+  options.file_checksum_gen_factory = GetFileChecksumGenCrc32cFactory();
+  DestroyAndReopen(options);
+
+  SstFileWriter sst_file_writer(EnvOptions(), options);
+  const int kNumFiles = 20;
+  std::vector<std::string> files;
+  for (int i = 0; i < kNumFiles; i++) {
+    files.push_back(sst_files_dir_ + "file" + ToString(i) + ".sst");
+    ASSERT_OK(sst_file_writer.Open(files.back()));
+    for (int k = i * 10; k < (i + 1) * 10; k++) {
+      ASSERT_OK(sst_file_writer.Put(Key(k), Key(k) + "_val"));
+    }
+    ASSERT_OK(sst_file_writer.Finish());
+  }
+
+  IngestExternalFileOptions ifo;
+  ifo.verify_checksums_before_ingest = true;
+  // The file checksums are then generated in Prepare()
+  ifo.write_global_seqno = false;
+  ifo.max_prepare_threads = 4;
+  // One of the files is missing: nothing is ingested
+  ASSERT_TRUE(db_->IngestExternalFile({files[0], sst_files_dir_ + "missing"},
+                                      ifo)
+                  .IsNotFound());
+  ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+
+  ASSERT_OK(db_->IngestExternalFile(files, ifo));
+  for (int k = 0; k < kNumFiles * 10; k++) {
+    ASSERT_EQ(Key(k) + "_val", Get(Key(k)));
+  }
+  std::vector<LiveFileMetaData> live_files;
+  db_->GetLiveFilesMetaData(&live_files);
+  ASSERT_EQ(static_cast<size_t>(kNumFiles), live_files.size());
+  for (const auto& f : live_files) {
+    ASSERT_EQ(kStandardDbFileChecksumFuncName, f.file_checksum_func_name);
+  }
+}
+
 TEST_P(ExternalSSTFileBasicTest, IngestFileWithGlobalSeqnoPickedSeqno) {
   bool write_global_seqno = std::get<0>(GetParam());
   bool verify_checksums_before_ingest = std::get<1>(GetParam());
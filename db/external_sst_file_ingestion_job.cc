@@ -8,7 +8,9 @@
 #include "db/external_sst_file_ingestion_job.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <functional>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -17,6 +19,7 @@
 #include "db/version_edit.h"
 #include "file/file_util.h"
 #include "file/random_access_file_reader.h"
+#include "port/port.h"
 #include "table/merging_iterator.h"
 #include "table/scoped_arena_iterator.h"
 #include "table/sst_file_writer_collectors.h"
@@ -26,17 +29,51 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// Calls `func` for 0 to `n` - 1 on up to `max_threads` threads, counting the
+// current one.
+void ForEachInParallel(size_t n, int max_threads,
+                       const std::function<void(size_t)>& func) {
+  std::atomic<size_t> next_idx(0);
+  std::function<void()> worker([&]() {
+    while (true) {
+      size_t idx = next_idx.fetch_add(1);
+      if (idx >= n) {
+        break;
+      }
+      func(idx);
+    }
+  });
+
+  std::vector<port::Thread> threads;
+  for (int i = 1; i < max_threads && static_cast<size_t>(i) < n; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+}  // namespace
+
 Status ExternalSstFileIngestionJob::Prepare(
     const std::vector<std::string>& external_files_paths,
     const std::vector<std::string>& files_checksums,
     const std::vector<std::string>& files_checksum_func_names,
     uint64_t next_file_number, SuperVersion* sv) {
   Status status;
+  const int max_threads = std::max(ingestion_options_.max_prepare_threads, 1);
 
   // Read the information of files we are ingesting
-  for (const std::string& file_path : external_files_paths) {
-    IngestedFileInfo file_to_ingest;
-    status = GetIngestedFileInfo(file_path, &file_to_ingest, sv);
+  std::vector<IngestedFileInfo> files_info(external_files_paths.size());
+  std::vector<Status> files_status(external_files_paths.size());
+  ForEachInParallel(external_files_paths.size(), max_threads, [&](size_t i) {
+    files_status[i] =
+        GetIngestedFileInfo(external_files_paths[i], &files_info[i], sv);
+  });
+  for (size_t i = 0; i < files_info.size(); i++) {
+    IngestedFileInfo& file_to_ingest = files_info[i];
+    status = files_status[i];
     if (!status.ok()) {
       return status;
     }
@@ -96,15 +133,25 @@ Status ExternalSstFileIngestionJob::Prepare(
   std::unordered_set<size_t> ingestion_path_ids;
   for (IngestedFileInfo& f : files_to_ingest_) {
     f.fd = FileDescriptor(next_file_number++, 0, f.file_size);
+    ingestion_path_ids.insert(f.fd.GetPathId());
+  }
+  files_status.assign(files_to_ingest_.size(), Status::OK());
+  std::atomic<bool> add_failed(false);
+  ForEachInParallel(files_to_ingest_.size(), max_threads, [&](size_t i) {
+    if (add_failed.load(std::memory_order_relaxed)) {
+      return;
+    }
+    IngestedFileInfo& f = files_to_ingest_[i];
+    Status& file_status = files_status[i];
     f.copy_file = false;
     const std::string path_outside_db = f.external_file_path;
     const std::string path_inside_db =
         TableFileName(cfd_->ioptions()->cf_paths, f.fd.GetNumber(),
                       f.fd.GetPathId());
     if (ingestion_options_.move_files) {
-      status =
+      file_status =
           fs_->LinkFile(path_outside_db, path_inside_db, IOOptions(), nullptr);
-      if (status.ok()) {
+      if (file_status.ok()) {
         // It is unsafe to assume application had sync the file and file
         // directory before ingest the file. For integrity of RocksDB we need
         // to sync the file.
@@ -117,21 +164,22 @@ Status ExternalSstFileIngestionJob::Prepare(
         // reopening a file for writing and don't require reopening and
         // syncing the file. Ignore the NotSupported error in that case.
         if (!s.IsNotSupported()) {
-          status = s;
-          if (status.ok()) {
+          file_status = s;
+          if (file_status.ok()) {
             TEST_SYNC_POINT(
                 "ExternalSstFileIngestionJob::BeforeSyncIngestedFile");
-            status = SyncIngestedFile(file_to_sync.get());
+            file_status = SyncIngestedFile(file_to_sync.get());
             TEST_SYNC_POINT(
                 "ExternalSstFileIngestionJob::AfterSyncIngestedFile");
-            if (!status.ok()) {
+            if (!file_status.ok()) {
               ROCKS_LOG_WARN(db_options_.info_log,
                              "Failed to sync ingested file %s: %s",
-                             path_inside_db.c_str(), status.ToString().c_str());
+                             path_inside_db.c_str(),
+                             file_status.ToString().c_str());
             }
           }
         }
-      } else if (status.IsNotSupported() &&
+      } else if (file_status.IsNotSupported() &&
                  ingestion_options_.failed_move_fall_back_to_copy) {
         // Original file is on a different FS, use copy instead of hard linking.
         f.copy_file = true;
@@ -144,18 +192,24 @@ Status ExternalSstFileIngestionJob::Prepare(
       TEST_SYNC_POINT_CALLBACK("ExternalSstFileIngestionJob::Prepare:CopyFile",
                                nullptr);
       // CopyFile also sync the new file.
-      status = CopyFile(fs_.get(), path_outside_db, path_inside_db, 0,
-                        db_options_.use_fsync, io_tracer_);
+      file_status = CopyFile(fs_.get(), path_outside_db, path_inside_db, 0,
+                             db_options_.use_fsync, io_tracer_);
     }
     TEST_SYNC_POINT("ExternalSstFileIngestionJob::Prepare:FileAdded");
-    if (!status.ok()) {
-      break;
+    if (!file_status.ok()) {
+      add_failed.store(true, std::memory_order_relaxed);
+      return;
     }
     f.internal_file_path = path_inside_db;
     // Initialize the checksum information of ingested files.
     f.file_checksum = kUnknownFileChecksum;
     f.file_checksum_func_name = kUnknownFileChecksumFuncName;
-    ingestion_path_ids.insert(f.fd.GetPathId());
+  });
+  for (const Status& s : files_status) {
+    if (!s.ok()) {
+      status = s;
+      break;
+    }
   }
 
   TEST_SYNC_POINT("ExternalSstFileIngestionJob::BeforeSyncDir");
@@ -199,20 +253,23 @@ Status ExternalSstFileIngestionJob::Prepare(
     std::vector<std::string> generated_checksum_func_names;
     // Step 1: generate the checksum for ingested sst file.
     if (need_generate_file_checksum_) {
-      for (size_t i = 0; i < files_to_ingest_.size(); i++) {
-        std::string generated_checksum;
-        std::string generated_checksum_func_name;
+      generated_checksums.resize(files_to_ingest_.size());
+      generated_checksum_func_names.resize(files_to_ingest_.size());
+      files_status.assign(files_to_ingest_.size(), Status::OK());
+      ForEachInParallel(files_to_ingest_.size(), max_threads, [&](size_t i) {
         std::string requested_checksum_func_name;
-        IOStatus io_s = GenerateOneFileChecksum(
+        files_status[i] = GenerateOneFileChecksum(
             fs_.get(), files_to_ingest_[i].internal_file_path,
             db_options_.file_checksum_gen_factory.get(),
-            requested_checksum_func_name, &generated_checksum,
-            &generated_checksum_func_name,
+            requested_checksum_func_name, &generated_checksums[i],
+            &generated_checksum_func_names[i],
             ingestion_options_.verify_checksums_readahead_size,
             db_options_.allow_mmap_reads, io_tracer_,
             db_options_.rate_limiter.get());
-        if (!io_s.ok()) {
-          status = io_s;
+      });
+      for (size_t i = 0; i < files_to_ingest_.size(); i++) {
+        if (!files_status[i].ok()) {
+          status = files_status[i];
           ROCKS_LOG_WARN(db_options_.info_log,
                          "Sst file checksum generation of file: %s failed: %s",
                          files_to_ingest_[i].internal_file_path.c_str(),
@@ -220,12 +277,10 @@ Status ExternalSstFileIngestionJob::Prepare(
           break;
         }
         if (ingestion_options_.write_global_seqno == false) {
-          files_to_ingest_[i].file_checksum = generated_checksum;
+          files_to_ingest_[i].file_checksum = generated_checksums[i];
           files_to_ingest_[i].file_checksum_func_name =
-              generated_checksum_func_name;
+              generated_checksum_func_names[i];
         }
-        generated_checksums.push_back(generated_checksum);
-        generated_checksum_func_names.push_back(generated_checksum_func_name);
       }
     }
 
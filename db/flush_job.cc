@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "db/builder.h"
+#include "db/compaction/clipping_iterator.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
@@ -212,6 +213,7 @@ void FlushJob::PickMemTable() {
 Status FlushJob::Run(LogsWithPrepTracker* prep_tracker,
                      FileMetaData* file_meta) {
   TEST_SYNC_POINT("FlushJob::Start");
+  IOActivityGuard io_activity(IOActivity::kFlush);
   db_mutex_->AssertHeld();
   assert(pick_memtable_called);
   AutoThreadOperationStageUpdater stage_run(
@@ -637,6 +639,155 @@ bool FlushJob::MemPurgeDecider() {
   return false;
 }
 
+void FlushJob::PickFlushPartitionBoundaries(
+    InternalIterator* iter, uint64_t total_num_entries,
+    uint64_t total_data_size, std::vector<std::string>* boundaries) {
+  assert(boundaries != nullptr && boundaries->empty());
+  // Partitions smaller than this are not worth a thread and an extra file.
+  uint64_t min_partition_bytes = 8 << 20;
+  TEST_SYNC_POINT_CALLBACK(
+      "FlushJob::PickFlushPartitionBoundaries:MinPartitionBytes",
+      &min_partition_bytes);
+  const Comparator* ucmp = cfd_->user_comparator();
+  if (mutable_cf_options_.max_flush_partitions <= 1 ||
+      cfd_->ioptions()->compaction_style != kCompactionStyleLevel ||
+      ucmp->timestamp_size() > 0 || min_partition_bytes == 0) {
+    return;
+  }
+  const uint64_t num_partitions =
+      std::min(static_cast<uint64_t>(mutable_cf_options_.max_flush_partitions),
+               std::min(total_data_size / min_partition_bytes,
+                        total_num_entries));
+  if (num_partitions <= 1) {
+    return;
+  }
+
+  // With align_flush_partitions_to_base_level, the only places to cut are
+  // the smallest keys of the base level files but the first. base_ is
+  // finalized, so its files can be read without the DB mutex.
+  std::vector<Slice> cut_keys;
+  if (mutable_cf_options_.align_flush_partitions_to_base_level) {
+    const VersionStorageInfo* vstorage = base_->storage_info();
+    const int base_level = vstorage->base_level();
+    if (base_level > 0 && base_level < vstorage->num_levels()) {
+      const auto& files = vstorage->LevelFiles(base_level);
+      for (size_t i = 1; i < files.size(); ++i) {
+        cut_keys.push_back(files[i]->smallest.user_key());
+      }
+    }
+  }
+
+  // The memtable reps have no cheap way to sample their key distribution, so
+  // count entries in one pass over the merged memtable iterator. A boundary
+  // is placed at the first user key change after each 1/num_partitions of
+  // the entries, which keeps all versions of a user key in one partition.
+  // When aligned, it is placed at the last cut key passed over by that
+  // change instead, and only if there is one.
+  const uint64_t entries_per_partition = total_num_entries / num_partitions;
+  uint64_t next_boundary = entries_per_partition;
+  uint64_t num_entries = 0;
+  size_t next_cut = 0;
+  std::string prev_user_key;
+  for (iter->SeekToFirst();
+       iter->Valid() && boundaries->size() + 1 < num_partitions;
+       iter->Next()) {
+    const Slice user_key = ExtractUserKey(iter->key());
+    if (cut_keys.empty()) {
+      if (num_entries >= next_boundary &&
+          ucmp->Compare(user_key, prev_user_key) != 0) {
+        boundaries->emplace_back(user_key.data(), user_key.size());
+        next_boundary += entries_per_partition;
+      }
+    } else {
+      // The cut keys in (prev_user_key, user_key]
+      const size_t first_cut = next_cut;
+      while (next_cut < cut_keys.size() &&
+             ucmp->Compare(cut_keys[next_cut], user_key) <= 0) {
+        next_cut++;
+      }
+      if (num_entries >= next_boundary && next_cut > first_cut &&
+          num_entries > 0) {
+        const Slice& cut = cut_keys[next_cut - 1];
+        boundaries->emplace_back(cut.data(), cut.size());
+        // The next share counts from this cut
+        next_boundary = num_entries + entries_per_partition;
+      }
+    }
+    prev_user_key.assign(user_key.data(), user_key.size());
+    num_entries++;
+  }
+}
+
+int FlushJob::PickOutputLevel() const {
+  db_mutex_->AssertHeld();
+  if (!mutable_cf_options_.flush_to_lowest_nonoverlapping_level ||
+      cfd_->ioptions()->compaction_style != kCompactionStyleLevel ||
+      !write_manifest_ || mems_.empty() ||
+      cfd_->imm()->GetEarliestMemTableID() != mems_.front()->GetID()) {
+    // An older memtable that is still being flushed would end up in L0 on
+    // top of newer data placed below it.
+    return 0;
+  }
+
+  const Comparator* ucmp = cfd_->user_comparator();
+  Slice smallest_user_key;
+  Slice largest_user_key;
+  bool has_output = false;
+  auto extend_range = [&](const FileMetaData& meta) {
+    if (meta.fd.GetFileSize() == 0) {
+      return;
+    }
+    if (!has_output ||
+        ucmp->Compare(meta.smallest.user_key(), smallest_user_key) < 0) {
+      smallest_user_key = meta.smallest.user_key();
+    }
+    if (!has_output ||
+        ucmp->Compare(meta.largest.user_key(), largest_user_key) > 0) {
+      largest_user_key = meta.largest.user_key();
+    }
+    has_output = true;
+  };
+  extend_range(meta_);
+  for (const auto& meta : partition_metas_) {
+    extend_range(meta);
+  }
+  if (!has_output) {
+    return 0;
+  }
+
+  // Same rule as ExternalSstFileIngestionJob: go down until the first level
+  // with an overlapping file, skipping levels that a running compaction is
+  // writing an overlapping range into.
+  VersionStorageInfo* vstorage = cfd_->current()->storage_info();
+  int last_level = cfd_->NumberLevels() - 1;
+  if (db_options_.allow_ingest_behind) {
+    // The last level is reserved for ingested files.
+    last_level--;
+  }
+  int output_level = 0;
+  for (int level = 0; level <= last_level; level++) {
+    if (level > 0 && level < vstorage->base_level()) {
+      continue;
+    }
+    if (vstorage->OverlapInLevel(level, &smallest_user_key,
+                                 &largest_user_key)) {
+      break;
+    }
+    if (!cfd_->RangeOverlapWithCompaction(smallest_user_key, largest_user_key,
+                                          level)) {
+      output_level = level;
+    }
+  }
+  TEST_SYNC_POINT_CALLBACK("FlushJob::PickOutputLevel", &output_level);
+  if (output_level > 0) {
+    ROCKS_LOG_INFO(db_options_.info_log,
+                   "[%s] [JOB %d] Flush output placed directly in level %d",
+                   cfd_->GetName().c_str(), job_context_->job_id,
+                   output_level);
+  }
+  return output_level;
+}
+
 Status FlushJob::WriteLevel0Table() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_FLUSH_WRITE_L0);
@@ -733,31 +884,180 @@ Status FlushJob::WriteLevel0Table() {
                                    ? current_time
                                    : meta_.oldest_ancester_time;
 
+      // Shape of the LSM tree once this flush is installed, for filter
+      // policies that adapt to it. The new file is estimated to be the
+      // size of existing L0 files, or of the memtable data if none.
+      std::vector<uint64_t> level_bytes;
+      int num_level0_files = 0;
+      base_->storage_info()->GetLsmShape(&level_bytes, &num_level0_files);
+      if (!level_bytes.empty()) {
+        level_bytes[0] += num_level0_files > 0
+                              ? level_bytes[0] / num_level0_files
+                              : total_data_size;
+        num_level0_files++;
+      }
+
       uint64_t num_input_entries = 0;
       uint64_t memtable_payload_bytes = 0;
       uint64_t memtable_garbage_bytes = 0;
       IOStatus io_s;
       const std::string* const full_history_ts_low =
           (full_history_ts_low_.empty()) ? nullptr : &full_history_ts_low_;
-      TableBuilderOptions tboptions(
-          *cfd_->ioptions(), mutable_cf_options_, cfd_->internal_comparator(),
-          cfd_->int_tbl_prop_collector_factories(), output_compression_,
-          mutable_cf_options_.compression_opts, cfd_->GetID(), cfd_->GetName(),
-          0 /* level */, false /* is_bottommost */,
-          TableFileCreationReason::kFlush, creation_time, oldest_key_time,
-          current_time, db_id_, db_session_id_, 0 /* target_file_size */,
-          meta_.fd.GetNumber());
-      s = BuildTable(
-          dbname_, versions_, db_options_, tboptions, file_options_,
-          cfd_->table_cache(), iter.get(), std::move(range_del_iters), &meta_,
-          &blob_file_additions, existing_snapshots_,
-          earliest_write_conflict_snapshot_, snapshot_checker_,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          &io_s, io_tracer_, event_logger_, job_context_->job_id, Env::IO_HIGH,
-          &table_properties_, write_hint, full_history_ts_low, blob_callback_,
-          &num_input_entries, &memtable_payload_bytes, &memtable_garbage_bytes);
-      if (!io_s.ok()) {
-        io_status_ = io_s;
+      auto build_table =
+          [&](InternalIterator* input,
+              std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>>
+                  input_range_del_iters,
+              FileMetaData* meta, std::vector<BlobFileAddition>* blob_additions,
+              TableProperties* table_properties, IOStatus* table_io_s,
+              uint64_t* table_num_input_entries, uint64_t* table_payload_bytes,
+              uint64_t* table_garbage_bytes) {
+            TableBuilderOptions tboptions(
+                *cfd_->ioptions(), mutable_cf_options_,
+                cfd_->internal_comparator(),
+                cfd_->int_tbl_prop_collector_factories(), output_compression_,
+                mutable_cf_options_.compression_opts, cfd_->GetID(),
+                cfd_->GetName(), 0 /* level */, false /* is_bottommost */,
+                TableFileCreationReason::kFlush, creation_time, oldest_key_time,
+                current_time, db_id_, db_session_id_,
+                0 /* target_file_size */, meta->fd.GetNumber());
+            tboptions.level_bytes = level_bytes;
+            tboptions.num_level0_files = num_level0_files;
+            return BuildTable(
+                dbname_, versions_, db_options_, tboptions, file_options_,
+                cfd_->table_cache(), input, std::move(input_range_del_iters),
+                meta, blob_additions, existing_snapshots_,
+                earliest_write_conflict_snapshot_, snapshot_checker_,
+                mutable_cf_options_.paranoid_file_checks,
+                cfd_->internal_stats(), table_io_s, io_tracer_, event_logger_,
+                job_context_->job_id, Env::IO_HIGH, table_properties,
+                write_hint, full_history_ts_low, blob_callback_,
+                table_num_input_entries, table_payload_bytes,
+                table_garbage_bytes);
+          };
+
+      std::vector<std::string> partition_boundaries;
+      if (range_del_iters.empty()) {
+        PickFlushPartitionBoundaries(iter.get(), total_num_entries,
+                                     total_data_size, &partition_boundaries);
+      }
+
+      if (partition_boundaries.empty()) {
+        s = build_table(iter.get(), std::move(range_del_iters), &meta_,
+                        &blob_file_additions, &table_properties_, &io_s,
+                        &num_input_entries, &memtable_payload_bytes,
+                        &memtable_garbage_bytes);
+        if (!io_s.ok()) {
+          io_status_ = io_s;
+        }
+      } else {
+        // Partition i covers user keys in [boundaries[i - 1], boundaries[i]).
+        // The first partition is built into meta_ on this thread, the others
+        // on threads of their own, the same way subcompactions are run.
+        struct PartitionState {
+          FileMetaData* meta = nullptr;
+          std::vector<BlobFileAddition> blob_file_additions;
+          TableProperties table_properties;
+          Status status;
+          IOStatus io_status;
+          uint64_t num_input_entries = 0;
+          uint64_t payload_bytes = 0;
+          uint64_t garbage_bytes = 0;
+        };
+        const size_t num_partitions = partition_boundaries.size() + 1;
+        partition_metas_.resize(num_partitions - 1);
+        std::vector<PartitionState> partitions(num_partitions);
+        partitions[0].meta = &meta_;
+        for (size_t i = 1; i < num_partitions; i++) {
+          FileMetaData* meta = &partition_metas_[i - 1];
+          meta->fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+          meta->oldest_ancester_time = meta_.oldest_ancester_time;
+          meta->file_creation_time = meta_.file_creation_time;
+          partitions[i].meta = meta;
+        }
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Level-0 flush split into %" ROCKSDB_PRIszt
+                       " partitions",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       num_partitions);
+
+        auto build_partition = [&](size_t i) {
+          PartitionState* state = &partitions[i];
+          Arena partition_arena;
+          std::vector<InternalIterator*> partition_memtables;
+          for (MemTable* m : mems_) {
+            partition_memtables.push_back(m->NewIterator(ro, &partition_arena));
+          }
+          ScopedArenaIterator partition_iter(NewMergingIterator(
+              &cfd_->internal_comparator(), partition_memtables.data(),
+              static_cast<int>(partition_memtables.size()), &partition_arena));
+          IterKey start_ikey;
+          IterKey end_ikey;
+          Slice start_slice;
+          Slice end_slice;
+          if (i > 0) {
+            start_ikey.SetInternalKey(partition_boundaries[i - 1],
+                                      kMaxSequenceNumber, kValueTypeForSeek);
+            start_slice = start_ikey.GetInternalKey();
+          }
+          if (i + 1 < num_partitions) {
+            end_ikey.SetInternalKey(partition_boundaries[i], kMaxSequenceNumber,
+                                    kValueTypeForSeek);
+            end_slice = end_ikey.GetInternalKey();
+          }
+          ClippingIterator clip(partition_iter.get(),
+                                i > 0 ? &start_slice : nullptr,
+                                i + 1 < num_partitions ? &end_slice : nullptr,
+                                &cfd_->internal_comparator());
+          state->status = build_table(
+              &clip, {}, state->meta, &state->blob_file_additions,
+              &state->table_properties, &state->io_status,
+              &state->num_input_entries, &state->payload_bytes,
+              &state->garbage_bytes);
+        };
+
+        std::vector<port::Thread> thread_pool;
+        thread_pool.reserve(num_partitions - 1);
+        for (size_t i = 1; i < num_partitions; i++) {
+          thread_pool.emplace_back(build_partition, i);
+        }
+        build_partition(0);
+        for (auto& thread : thread_pool) {
+          thread.join();
+        }
+
+        table_properties_ = partitions[0].table_properties;
+        SequenceNumber smallest_seqno = kMaxSequenceNumber;
+        SequenceNumber largest_seqno = 0;
+        for (auto& state : partitions) {
+          if (s.ok() && !state.status.ok()) {
+            s = state.status;
+          }
+          if (io_status_.ok() && !state.io_status.ok()) {
+            io_status_ = state.io_status;
+          }
+          num_input_entries += state.num_input_entries;
+          memtable_payload_bytes += state.payload_bytes;
+          memtable_garbage_bytes += state.garbage_bytes;
+          for (auto& blob : state.blob_file_additions) {
+            blob_file_additions.emplace_back(std::move(blob));
+          }
+          if (state.meta->fd.GetFileSize() > 0) {
+            smallest_seqno =
+                std::min(smallest_seqno, state.meta->fd.smallest_seqno);
+            largest_seqno =
+                std::max(largest_seqno, state.meta->fd.largest_seqno);
+          }
+        }
+        // The partitions interleave in sequence number space. Giving all of
+        // them the sequence number range of the whole flush keeps the L0
+        // ordering invariants intact: they sort next to each other and, as
+        // their key ranges are disjoint, in any order among themselves.
+        for (auto& state : partitions) {
+          if (state.meta->fd.GetFileSize() > 0) {
+            state.meta->fd.smallest_seqno = smallest_seqno;
+            state.meta->fd.largest_seqno = largest_seqno;
+          }
+        }
       }
       if (num_input_entries != total_num_entries && s.ok()) {
         std::string msg = "Expected " + ToString(total_num_entries) +
@@ -770,13 +1070,11 @@ Status FlushJob::WriteLevel0Table() {
           s = Status::Corruption(msg);
         }
       }
-      if (tboptions.reason == TableFileCreationReason::kFlush) {
-        TEST_SYNC_POINT("DBImpl::FlushJob:Flush");
-        RecordTick(stats_, MEMTABLE_PAYLOAD_BYTES_AT_FLUSH,
-                   memtable_payload_bytes);
-        RecordTick(stats_, MEMTABLE_GARBAGE_BYTES_AT_FLUSH,
-                   memtable_garbage_bytes);
-      }
+      TEST_SYNC_POINT("DBImpl::FlushJob:Flush");
+      RecordTick(stats_, MEMTABLE_PAYLOAD_BYTES_AT_FLUSH,
+                 memtable_payload_bytes);
+      RecordTick(stats_, MEMTABLE_GARBAGE_BYTES_AT_FLUSH,
+                 memtable_garbage_bytes);
       LogFlush(db_options_.info_log);
     }
     ROCKS_LOG_INFO(db_options_.info_log,
@@ -787,6 +1085,14 @@ Status FlushJob::WriteLevel0Table() {
                    meta_.fd.GetNumber(), meta_.fd.GetFileSize(),
                    s.ToString().c_str(),
                    meta_.marked_for_compaction ? " (needs compaction)" : "");
+    for (const auto& meta : partition_metas_) {
+      ROCKS_LOG_INFO(db_options_.info_log,
+                     "[%s] [JOB %d] Level-0 flush partition table #%" PRIu64
+                     ": %" PRIu64 " bytes%s",
+                     cfd_->GetName().c_str(), job_context_->job_id,
+                     meta.fd.GetNumber(), meta.fd.GetFileSize(),
+                     meta.marked_for_compaction ? " (needs compaction)" : "");
+    }
 
     if (s.ok() && output_file_directory_ != nullptr && sync_output_directory_) {
       s = output_file_directory_->Fsync(IOOptions(), nullptr);
@@ -799,20 +1105,37 @@ Status FlushJob::WriteLevel0Table() {
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
   const bool has_output = meta_.fd.GetFileSize() > 0;
+  uint64_t bytes_written = meta_.fd.GetFileSize();
+  int num_output_files = has_output ? 1 : 0;
+  for (const auto& meta : partition_metas_) {
+    if (meta.fd.GetFileSize() > 0) {
+      bytes_written += meta.fd.GetFileSize();
+      num_output_files++;
+    }
+  }
 
-  if (s.ok() && has_output) {
+  int output_level = 0;
+  if (s.ok() && num_output_files > 0) {
     TEST_SYNC_POINT("DBImpl::FlushJob:SSTFileCreated");
     // if we have more than 1 background thread, then we cannot
     // insert files directly into higher levels because some other
     // threads could be concurrently producing compacted files for
-    // that key range.
-    // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
-                   meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
-                   meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
-                   meta_.marked_for_compaction, meta_.oldest_blob_file_number,
-                   meta_.oldest_ancester_time, meta_.file_creation_time,
-                   meta_.file_checksum, meta_.file_checksum_func_name);
+    // that key range, unless PickOutputLevel() has verified that none
+    // of them can overlap the output.
+    output_level = PickOutputLevel();
+    if (has_output) {
+      edit_->AddFile(output_level, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
+                     meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
+                     meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
+                     meta_.marked_for_compaction, meta_.oldest_blob_file_number,
+                     meta_.oldest_ancester_time, meta_.file_creation_time,
+                     meta_.file_checksum, meta_.file_checksum_func_name);
+    }
+    for (const auto& meta : partition_metas_) {
+      if (meta.fd.GetFileSize() > 0) {
+        edit_->AddFile(output_level, meta);
+      }
+    }
 
     edit_->SetBlobFileAdditions(std::move(blob_file_additions));
   }
@@ -834,10 +1157,8 @@ Status FlushJob::WriteLevel0Table() {
                  cfd_->GetName().c_str(), job_context_->job_id, micros,
                  cpu_micros);
 
-  if (has_output) {
-    stats.bytes_written = meta_.fd.GetFileSize();
-    stats.num_output_files = 1;
-  }
+  stats.bytes_written = bytes_written;
+  stats.num_output_files = num_output_files;
 
   const auto& blobs = edit_->GetBlobFileAdditions();
   for (const auto& blob : blobs) {
@@ -856,7 +1177,7 @@ Status FlushJob::WriteLevel0Table() {
   }
 
   RecordTimeToHistogram(stats_, FLUSH_TIME, stats.micros);
-  cfd_->internal_stats()->AddCompactionStats(0 /* level */, thread_pri_, stats);
+  cfd_->internal_stats()->AddCompactionStats(output_level, thread_pri_, stats);
   cfd_->internal_stats()->AddCFStats(
       InternalStats::BYTES_FLUSHED,
       stats.bytes_written + stats.bytes_written_blob);
@@ -87,6 +87,12 @@ class FlushJob {
   void Cancel();
   const autovector<MemTable*>& GetMemTables() const { return mems_; }
 
+  // Output files of a partitioned flush other than the one returned through
+  // Run()'s file_meta. Empty unless max_flush_partitions split the flush.
+  const std::vector<FileMetaData>& GetPartitionOutputs() const {
+    return partition_metas_;
+  }
+
 #ifndef ROCKSDB_LITE
   std::list<std::unique_ptr<FlushJobInfo>>* GetCommittedFlushJobsInfo() {
     return &committed_flush_jobs_info_;
@@ -101,6 +107,19 @@ class FlushJob {
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Picks user keys that split the flushed memtables into partitions with
+  // roughly equal numbers of entries, only where a base level file starts
+  // with align_flush_partitions_to_base_level. Leaves boundaries empty when
+  // the flush should produce a single file.
+  void PickFlushPartitionBoundaries(InternalIterator* iter,
+                                    uint64_t total_num_entries,
+                                    uint64_t total_data_size,
+                                    std::vector<std::string>* boundaries);
+  // Returns the level the flush output is added to: L0, or with
+  // flush_to_lowest_nonoverlapping_level the lowest level the output can be
+  // placed in without overlapping existing or in-flight files. Requires
+  // db_mutex held.
+  int PickOutputLevel() const;
 
   // Memtable Garbage Collection algorithm: a MemPurge takes the list
   // of immutable memtables and filters out (or "purge") the outdated bytes
@@ -179,6 +198,9 @@ class FlushJob {
 
   // Variables below are set by PickMemTable():
   FileMetaData meta_;
+  // Outputs of partitions 1..K-1 of a partitioned flush; meta_ holds the
+  // first partition.
+  std::vector<FileMetaData> partition_metas_;
   autovector<MemTable*> mems_;
   VersionEdit* edit_;
   Version* base_;
@@ -6,6 +6,7 @@
 #ifndef ROCKSDB_LITE
 #include "db/forward_iterator.h"
 
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <utility>
@@ -40,7 +41,7 @@ class ForwardLevelIterator : public InternalIterator {
                        bool allow_unprepared_value)
       : cfd_(cfd),
         read_options_(read_options),
-        files_(files),
+        files_(&files),
         valid_(false),
         file_index_(std::numeric_limits<uint32_t>::max()),
         file_iter_(nullptr),
@@ -59,8 +60,15 @@ class ForwardLevelIterator : public InternalIterator {
     }
   }
 
+  // Points to the same files in the storage of a newer version, so that the
+  // iterator can outlive the version it was built for.
+  void SetFiles(const std::vector<FileMetaData*>& files) {
+    assert(files == *files_);
+    files_ = &files;
+  }
+
   void SetFileIndex(uint32_t file_index) {
-    assert(file_index < files_.size());
+    assert(file_index < files_->size());
     status_ = Status::OK();
     if (file_index != file_index_) {
       file_index_ = file_index;
@@ -68,7 +76,7 @@ class ForwardLevelIterator : public InternalIterator {
     }
   }
   void Reset() {
-    assert(file_index_ < files_.size());
+    assert(file_index_ < files_->size());
 
     // Reset current pointer
     if (pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled()) {
@@ -81,7 +89,7 @@ class ForwardLevelIterator : public InternalIterator {
                                          kMaxSequenceNumber /* upper_bound */);
     file_iter_ = cfd_->table_cache()->NewIterator(
         read_options_, *(cfd_->soptions()), cfd_->internal_comparator(),
-        *files_[file_index_],
+        *(*files_)[file_index_],
         read_options_.ignore_range_deletions ? nullptr : &range_del_agg,
         prefix_extractor_, /*table_reader_ptr=*/nullptr,
         /*file_read_hist=*/nullptr, TableReaderCaller::kUserIterator,
@@ -148,7 +156,7 @@ class ForwardLevelIterator : public InternalIterator {
       if (valid_) {
         return;
       }
-      if (file_index_ + 1 >= files_.size()) {
+      if (file_index_ + 1 >= files_->size()) {
         valid_ = false;
         return;
       }
@@ -204,7 +212,7 @@ class ForwardLevelIterator : public InternalIterator {
  private:
   const ColumnFamilyData* const cfd_;
   const ReadOptions& read_options_;
-  const std::vector<FileMetaData*>& files_;
+  const std::vector<FileMetaData*>* files_;
 
   bool valid_;
   uint32_t file_index_;
@@ -313,6 +321,7 @@ void ForwardIterator::SVCleanup() {
 }
 
 void ForwardIterator::Cleanup(bool release_sv) {
+  iters_kept_in_place_.clear();
   if (mutable_iter_ != nullptr) {
     DeleteIterator(mutable_iter_, true /* is_arena */);
   }
@@ -346,7 +355,7 @@ void ForwardIterator::SeekToFirst() {
   if (sv_ == nullptr) {
     RebuildIterators(true);
   } else if (sv_->version_number != cfd_->GetSuperVersionNumber()) {
-    RenewIterators();
+    RenewIterators(/*keep_positions=*/false);
   } else if (immutable_status_.IsIncomplete()) {
     ResetIncompleteIterators();
   }
@@ -364,7 +373,7 @@ void ForwardIterator::Seek(const Slice& internal_key) {
   if (sv_ == nullptr) {
     RebuildIterators(true);
   } else if (sv_->version_number != cfd_->GetSuperVersionNumber()) {
-    RenewIterators();
+    RenewIterators(/*keep_positions=*/false);
   } else if (immutable_status_.IsIncomplete()) {
     ResetIncompleteIterators();
   }
@@ -425,6 +434,8 @@ void ForwardIterator::SeekInternal(const Slice& internal_key,
       }
       if (seek_to_first) {
         l0_iters_[i]->SeekToFirst();
+      } else if (IsKeptInPlace(l0_iters_[i])) {
+        // Already at the first entry at or after internal_key
       } else {
         // If the target key passes over the largest key, we are sure Next()
         // won't go over this file.
@@ -461,6 +472,11 @@ void ForwardIterator::SeekInternal(const Slice& internal_key,
       if (level_iters_[level - 1] == nullptr) {
         continue;
       }
+      if (!seek_to_first && IsKeptInPlace(level_iters_[level - 1])) {
+        // Already at the first entry at or after internal_key
+        immutable_min_heap_.push(level_iters_[level - 1]);
+        continue;
+      }
       uint32_t f_idx = 0;
       if (!seek_to_first) {
         f_idx = FindFileInRange(level_files, internal_key, 0,
@@ -494,6 +510,7 @@ void ForwardIterator::SeekInternal(const Slice& internal_key,
       is_prev_set_ = true;
       is_prev_inclusive_ = true;
     }
+    iters_kept_in_place_.clear();
 
     TEST_SYNC_POINT_CALLBACK("ForwardIterator::SeekInternal:Immutable", this);
   } else if (current_ && current_ != mutable_iter_) {
@@ -517,7 +534,9 @@ void ForwardIterator::Next() {
     if (sv_ == nullptr) {
       RebuildIterators(true);
     } else {
-      RenewIterators();
+      // The table iterators kept are at the first entry after the ones
+      // returned, which is where seeking to old_key would put them.
+      RenewIterators(/*keep_positions=*/true);
     }
     SeekInternal(old_key, false);
     if (!valid_ || key().compare(old_key) != 0) {
@@ -712,7 +731,7 @@ void ForwardIterator::RebuildIterators(bool refresh_sv) {
   }
 }
 
-void ForwardIterator::RenewIterators() {
+void ForwardIterator::RenewIterators(bool keep_positions) {
   SuperVersion* svnew;
   assert(sv_);
   svnew = cfd_->GetReferencedSuperVersion(db_);
@@ -763,6 +782,9 @@ void ForwardIterator::RenewIterators() {
         TEST_SYNC_POINT_CALLBACK("ForwardIterator::RenewIterators:Null", this);
       } else {
         l0_iters_new.push_back(l0_iters_[iold]);
+        if (keep_positions) {
+          KeepInPlace(l0_iters_[iold]);
+        }
         l0_iters_[iold] = nullptr;
         TEST_SYNC_POINT_CALLBACK("ForwardIterator::RenewIterators:Copy", this);
       }
@@ -787,11 +809,37 @@ void ForwardIterator::RenewIterators() {
   l0_iters_.clear();
   l0_iters_ = l0_iters_new;
 
+  // The iterator of a level whose files are unchanged is kept, along with
+  // the table iterator of its current file. Its prefix extractor must be
+  // the same, as the old SuperVersion may own it.
+  const bool same_prefix_extractor =
+      sv_->mutable_cf_options.prefix_extractor ==
+      svnew->mutable_cf_options.prefix_extractor;
+  std::vector<ForwardLevelIterator*> level_iters_new;
+  level_iters_new.reserve(vstorage_new->num_levels() - 1);
+  for (int32_t level = 1; level < vstorage_new->num_levels(); ++level) {
+    const auto& level_files_new = vstorage_new->LevelFiles(level);
+    if (!same_prefix_extractor ||
+        vstorage->LevelFiles(level) != level_files_new) {
+      level_iters_new.push_back(NewLevelIterator(level_files_new));
+      continue;
+    }
+    ForwardLevelIterator* level_iter = level_iters_[level - 1];
+    level_iters_[level - 1] = nullptr;
+    if (level_iter != nullptr) {
+      level_iter->SetFiles(level_files_new);
+      if (keep_positions) {
+        KeepInPlace(level_iter);
+      }
+      TEST_SYNC_POINT_CALLBACK("ForwardIterator::RenewIterators:KeepLevel",
+                               this);
+    }
+    level_iters_new.push_back(level_iter);
+  }
   for (auto* l : level_iters_) {
     DeleteIterator(l);
   }
-  level_iters_.clear();
-  BuildLevelIterators(vstorage_new);
+  level_iters_ = level_iters_new;
   current_ = nullptr;
   is_prev_set_ = false;
   SVCleanup();
@@ -808,23 +856,35 @@ void ForwardIterator::RenewIterators() {
 void ForwardIterator::BuildLevelIterators(const VersionStorageInfo* vstorage) {
   level_iters_.reserve(vstorage->num_levels() - 1);
   for (int32_t level = 1; level < vstorage->num_levels(); ++level) {
-    const auto& level_files = vstorage->LevelFiles(level);
-    if ((level_files.empty()) ||
-        ((read_options_.iterate_upper_bound != nullptr) &&
-         (user_comparator_->Compare(*read_options_.iterate_upper_bound,
-                                    level_files[0]->smallest.user_key()) <
-          0))) {
-      level_iters_.push_back(nullptr);
-      if (!level_files.empty()) {
-        has_iter_trimmed_for_upper_bound_ = true;
-      }
-    } else {
-      level_iters_.push_back(new ForwardLevelIterator(
-          cfd_, read_options_, level_files,
-          sv_->mutable_cf_options.prefix_extractor.get(),
-          allow_unprepared_value_));
+    level_iters_.push_back(NewLevelIterator(vstorage->LevelFiles(level)));
+  }
+}
+
+ForwardLevelIterator* ForwardIterator::NewLevelIterator(
+    const std::vector<FileMetaData*>& level_files) {
+  if ((level_files.empty()) ||
+      ((read_options_.iterate_upper_bound != nullptr) &&
+       (user_comparator_->Compare(*read_options_.iterate_upper_bound,
+                                  level_files[0]->smallest.user_key()) < 0))) {
+    if (!level_files.empty()) {
+      has_iter_trimmed_for_upper_bound_ = true;
     }
+    return nullptr;
   }
+  return new ForwardLevelIterator(
+      cfd_, read_options_, level_files,
+      sv_->mutable_cf_options.prefix_extractor.get(), allow_unprepared_value_);
+}
+
+void ForwardIterator::KeepInPlace(InternalIterator* iter) {
+  if (iter->Valid() && iter->status().ok() && !IsOverUpperBound(iter->key())) {
+    iters_kept_in_place_.push_back(iter);
+  }
+}
+
+bool ForwardIterator::IsKeptInPlace(InternalIterator* iter) const {
+  return std::find(iters_kept_in_place_.begin(), iters_kept_in_place_.end(),
+                   iter) != iters_kept_in_place_.end();
 }
 
 void ForwardIterator::ResetIncompleteIterators() {
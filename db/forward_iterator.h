@@ -96,8 +96,16 @@ class ForwardIterator : public InternalIterator {
   static void DeferredSVCleanup(void* arg);
 
   void RebuildIterators(bool refresh_sv);
-  void RenewIterators();
+  // Moves to the current SuperVersion, keeping the iterators of the L0 files
+  // and levels left unchanged. With keep_positions, the next SeekInternal()
+  // doesn't move the valid ones kept, so it must seek to the current key.
+  void RenewIterators(bool keep_positions);
   void BuildLevelIterators(const VersionStorageInfo* vstorage);
+  // Returns nullptr if no file of the level is within the iterate bound
+  ForwardLevelIterator* NewLevelIterator(
+      const std::vector<FileMetaData*>& level_files);
+  void KeepInPlace(InternalIterator* iter);
+  bool IsKeptInPlace(InternalIterator* iter) const;
   void ResetIncompleteIterators();
   void SeekInternal(const Slice& internal_key, bool seek_to_first);
   void UpdateCurrent();
@@ -130,6 +138,9 @@ class ForwardIterator : public InternalIterator {
   std::vector<InternalIterator*> imm_iters_;
   std::vector<InternalIterator*> l0_iters_;
   std::vector<ForwardLevelIterator*> level_iters_;
+  // Iterators kept by RenewIterators() that the next SeekInternal() doesn't
+  // need to move
+  std::vector<InternalIterator*> iters_kept_in_place_;
   InternalIterator* current_;
   bool valid_;
 
@@ -0,0 +1,67 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/hot_key_cache.h"
+
+#include <cassert>
+#include <mutex>
+
+namespace ROCKSDB_NAMESPACE {
+
+size_t HotKeyCache::NumSlots(size_t capacity) {
+  size_t num_slots = 1;
+  while (num_slots < capacity) {
+    num_slots <<= 1;
+  }
+  return num_slots;
+}
+
+HotKeyCache::HotKeyCache(size_t num_slots)
+    : mask_(num_slots - 1), slots_(new Slot[num_slots]) {
+  assert(num_slots > 0 && (num_slots & mask_) == 0);
+}
+
+bool HotKeyCache::Lookup(const Slice& user_key, uint64_t hash,
+                         SequenceNumber read_seq,
+                         SequenceNumber last_write_seq, std::string* value,
+                         bool* found) {
+  Slot& slot = slots_[hash & mask_];
+  std::lock_guard<SpinMutex> l(slot.mutex);
+  // The result is the same at any sequence number from slot.seq on until
+  // the next write.
+  if (!slot.valid || slot.seq > read_seq || last_write_seq > slot.seq ||
+      user_key != slot.key) {
+    return false;
+  }
+  *found = slot.found;
+  if (slot.found) {
+    value->assign(slot.value);
+  }
+  return true;
+}
+
+void HotKeyCache::Insert(const Slice& user_key, uint64_t hash,
+                         SequenceNumber read_seq, const Slice* value) {
+  if (value != nullptr && value->size() > kMaxValueSize) {
+    return;
+  }
+  Slot& slot = slots_[hash & mask_];
+  std::lock_guard<SpinMutex> l(slot.mutex);
+  if (slot.valid && slot.seq > read_seq && user_key == slot.key) {
+    // Keep the more recent result.
+    return;
+  }
+  slot.valid = true;
+  slot.found = value != nullptr;
+  slot.seq = read_seq;
+  slot.key.assign(user_key.data(), user_key.size());
+  if (value != nullptr) {
+    slot.value.assign(value->data(), value->size());
+  } else {
+    slot.value.clear();
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
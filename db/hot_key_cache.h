@@ -0,0 +1,76 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/types.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A small direct-mapped cache of recent Get() results, one per SuperVersion,
+// enabled by ColumnFamilyOptions::memtable_hot_key_cache_size. A hit returns
+// the value of a hot key without looking it up in the memtables and table
+// files again.
+//
+// A cached result is read at some sequence number and stays valid for later
+// reads until a newer write may change it. The memtable of the SuperVersion
+// receives all such writes, and tracks the largest sequence number written
+// per slot (MemTable::HotKeyLastWriteSeq()). Writes are tracked before their
+// sequence numbers are published, so a reader that sees a write also sees
+// its sequence number in the tracker. Changes that bypass the memtable, like
+// file ingestion, install a new SuperVersion and thus a new, empty cache.
+//
+// Each slot has its own spin lock, held only to copy a result in or out.
+class HotKeyCache {
+ public:
+  // Values larger than this are not cached.
+  static const size_t kMaxValueSize = 4096;
+
+  // Returns the number of slots used for a cache of `capacity` entries, a
+  // power of two.
+  static size_t NumSlots(size_t capacity);
+
+  static uint64_t Hash(const Slice& user_key) {
+    return GetSliceNPHash64(user_key);
+  }
+
+  // `num_slots` must be a power of two.
+  explicit HotKeyCache(size_t num_slots);
+
+  // Returns true if the result of reading `user_key` at `read_seq` is cached,
+  // setting `*found` and, if found, `*value`. `last_write_seq` is the largest
+  // sequence number of the writes that may have changed `user_key` as
+  // returned by MemTable::HotKeyLastWriteSeq().
+  bool Lookup(const Slice& user_key, uint64_t hash, SequenceNumber read_seq,
+              SequenceNumber last_write_seq, std::string* value, bool* found);
+
+  // Caches the result of reading `user_key` at `read_seq`: `*value`, or not
+  // found if `value` is nullptr.
+  void Insert(const Slice& user_key, uint64_t hash, SequenceNumber read_seq,
+              const Slice* value);
+
+ private:
+  struct Slot {
+    SpinMutex mutex;
+    bool valid = false;
+    bool found = false;
+    SequenceNumber seq = 0;
+    std::string key;
+    std::string value;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
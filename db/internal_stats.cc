@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <sstream>
 #include <string>
@@ -21,10 +22,12 @@
 
 #include "cache/cache_entry_roles.h"
 #include "cache/cache_entry_stats.h"
+#include "cache/lru_cache.h"
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/table.h"
+#include "rocksdb/utilities/sim_cache.h"
 #include "table/block_based/cachable_entry.h"
 #include "util/string_util.h"
 
@@ -210,6 +213,29 @@ std::pair<Slice, Slice> GetPropertyNameAndArg(const Slice& property) {
   arg.remove_prefix(property.size() - sfx_len);
   return {name, arg};
 }
+
+// Seconds until `current` reaches `limit` growing by `rate` per second, 0 if
+// it already has, or -1 if it is not growing towards it
+double SecondsToLimit(double current, double limit, double rate) {
+  if (current >= limit) {
+    return 0;
+  }
+  if (rate <= 0) {
+    return -1;
+  }
+  return (limit - current) / rate;
+}
+
+// The earlier of two SecondsToLimit() results
+double EarlierLimit(double a, double b) {
+  if (a < 0) {
+    return b;
+  }
+  if (b < 0) {
+    return a;
+  }
+  return std::min(a, b);
+}
 }  // anonymous namespace
 
 static const std::string rocksdb_prefix = "rocksdb.";
@@ -273,11 +299,17 @@ static const std::string num_running_flushes = "num-running-flushes";
 static const std::string actual_delayed_write_rate =
     "actual-delayed-write-rate";
 static const std::string is_write_stopped = "is-write-stopped";
+static const std::string estimated_sustainable_write_rate =
+    "estimated-sustainable-write-rate";
 static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string block_cache_miss_ratio_curve =
+    "block-cache-miss-ratio-curve";
 static const std::string options_statistics = "options-statistics";
+static const std::string compaction_debt_forecast = "compaction-debt-forecast";
+static const std::string filter_stats = "filter-stats";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -359,6 +391,8 @@ const std::string DB::Properties::kActualDelayedWriteRate =
     rocksdb_prefix + actual_delayed_write_rate;
 const std::string DB::Properties::kIsWriteStopped =
     rocksdb_prefix + is_write_stopped;
+const std::string DB::Properties::kEstimatedSustainableWriteRate =
+    rocksdb_prefix + estimated_sustainable_write_rate;
 const std::string DB::Properties::kEstimateOldestKeyTime =
     rocksdb_prefix + estimate_oldest_key_time;
 const std::string DB::Properties::kBlockCacheCapacity =
@@ -367,8 +401,13 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheMissRatioCurve =
+    rocksdb_prefix + block_cache_miss_ratio_curve;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
+const std::string DB::Properties::kCompactionDebtForecast =
+    rocksdb_prefix + compaction_debt_forecast;
+const std::string DB::Properties::kFilterStats = rocksdb_prefix + filter_stats;
 
 const std::unordered_map<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
@@ -497,6 +536,9 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kIsWriteStopped,
          {false, nullptr, &InternalStats::HandleIsWriteStopped, nullptr,
           nullptr}},
+        {DB::Properties::kEstimatedSustainableWriteRate,
+         {false, nullptr, &InternalStats::HandleEstimatedSustainableWriteRate,
+          nullptr, nullptr}},
         {DB::Properties::kEstimateOldestKeyTime,
          {false, nullptr, &InternalStats::HandleEstimateOldestKeyTime, nullptr,
           nullptr}},
@@ -509,9 +551,18 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kBlockCacheMissRatioCurve,
+         {false, &InternalStats::HandleBlockCacheMissRatioCurve, nullptr,
+          &InternalStats::HandleBlockCacheMissRatioCurveMap, nullptr}},
         {DB::Properties::kOptionsStatistics,
          {true, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
+        {DB::Properties::kCompactionDebtForecast,
+         {false, &InternalStats::HandleCompactionDebtForecast, nullptr,
+          &InternalStats::HandleCompactionDebtForecastMap, nullptr}},
+        {DB::Properties::kFilterStats,
+         {false, &InternalStats::HandleFilterStats, nullptr,
+          &InternalStats::HandleFilterStatsMap, nullptr}},
 };
 
 InternalStats::InternalStats(int num_levels, SystemClock* clock,
@@ -521,12 +572,16 @@ InternalStats::InternalStats(int num_levels, SystemClock* clock,
       cf_stats_count_{},
       comp_stats_(num_levels),
       comp_stats_by_pri_(Env::Priority::TOTAL),
-      file_read_latency_(num_levels),
+      file_read_latency_(new std::atomic<HistogramImpl*>[num_levels]),
+      filter_stats_(new LevelFilterStats[num_levels]),
       bg_error_count_(0),
       number_levels_(num_levels),
       clock_(clock),
       cfd_(cfd),
       started_at_(clock->NowMicros()) {
+  for (int level = 0; level < num_levels; level++) {
+    file_read_latency_[level].store(nullptr, std::memory_order_relaxed);
+  }
   Cache* block_cache = nullptr;
   bool ok = GetBlockCacheForStats(&block_cache);
   if (ok) {
@@ -544,6 +599,82 @@ InternalStats::InternalStats(int num_levels, SystemClock* clock,
   }
 }
 
+InternalStats::~InternalStats() {
+  for (int level = 0; level < number_levels_; level++) {
+    delete file_read_latency_[level].load(std::memory_order_relaxed);
+  }
+}
+
+HistogramImpl* InternalStats::GetFileReadHist(int level) {
+  assert(level >= 0 && level < number_levels_);
+  HistogramImpl* h = file_read_latency_[level].load(std::memory_order_acquire);
+  if (h != nullptr) {
+    return h;
+  }
+  std::unique_ptr<HistogramImpl> created(new HistogramImpl());
+  if (file_read_latency_[level].compare_exchange_strong(
+          h, created.get(), std::memory_order_acq_rel)) {
+    return created.release();
+  }
+  // Another thread created it first
+  return h;
+}
+
+void InternalStats::RecordFilterChecks(int level,
+                                       const GetContextStats& before,
+                                       const GetContextStats& after) {
+  assert(level >= 0 && level < number_levels_);
+  const uint64_t whole_key_checked =
+      after.num_whole_key_filter_checked - before.num_whole_key_filter_checked;
+  const uint64_t prefix_checked =
+      after.num_prefix_filter_checked - before.num_prefix_filter_checked;
+  if (whole_key_checked == 0 && prefix_checked == 0) {
+    return;
+  }
+  const uint64_t whole_key_useful =
+      after.num_whole_key_filter_useful - before.num_whole_key_filter_useful;
+  const uint64_t prefix_useful =
+      after.num_prefix_filter_useful - before.num_prefix_filter_useful;
+  LevelFilterStats& stats = filter_stats_[level];
+  if (whole_key_checked > 0) {
+    stats.whole_key_checked.fetch_add(whole_key_checked,
+                                      std::memory_order_relaxed);
+    stats.whole_key_useful.fetch_add(whole_key_useful,
+                                     std::memory_order_relaxed);
+  }
+  if (prefix_checked > 0) {
+    stats.prefix_checked.fetch_add(prefix_checked, std::memory_order_relaxed);
+    stats.prefix_useful.fetch_add(prefix_useful, std::memory_order_relaxed);
+  }
+  if (whole_key_useful > 0 || prefix_useful > 0) {
+    stats.unhelpful_checks.store(0, std::memory_order_relaxed);
+  } else {
+    stats.unhelpful_checks.fetch_add(whole_key_checked + prefix_checked,
+                                     std::memory_order_relaxed);
+  }
+}
+
+bool InternalStats::ShouldSkipUnhelpfulFilters(int level,
+                                               uint64_t max_unhelpful_checks) {
+  assert(level >= 0 && level < number_levels_);
+  assert(max_unhelpful_checks > 0);
+  LevelFilterStats& stats = filter_stats_[level];
+  if (stats.unhelpful_checks.load(std::memory_order_relaxed) <
+      max_unhelpful_checks) {
+    return false;
+  }
+  stats.skipped.fetch_add(1, std::memory_order_relaxed);
+  if (stats.skipped_since_check.fetch_add(1, std::memory_order_relaxed) + 1 >=
+      max_unhelpful_checks) {
+    // Let the next lookup check the filters again. One more check without
+    // ruling out a key skips them for as many lookups again.
+    stats.skipped_since_check.store(0, std::memory_order_relaxed);
+    stats.unhelpful_checks.store(max_unhelpful_checks - 1,
+                                 std::memory_order_relaxed);
+  }
+  return true;
+}
+
 void InternalStats::TEST_GetCacheEntryRoleStats(CacheEntryRoleStats* stats,
                                                 bool foreground) {
   CollectCacheEntryStats(foreground);
@@ -598,6 +729,10 @@ void InternalStats::CacheEntryRoleStats::BeginCollection(
   str << cache->Name() << "@" << static_cast<void*>(cache);
   cache_id = str.str();
   cache_capacity = cache->GetCapacity();
+  if (strcmp(cache->Name(), "LRUCache") == 0) {
+    static_cast<LRUCache*>(cache)->GetAdmissionCounts(&admitted_counts,
+                                                      &rejected_counts);
+  }
 }
 
 void InternalStats::CacheEntryRoleStats::EndCollection(
@@ -636,6 +771,20 @@ std::string InternalStats::CacheEntryRoleStats::ToString(
     }
   }
   str << "\n";
+  bool any_admission = false;
+  for (size_t i = 0; i < kNumCacheEntryRoles; ++i) {
+    if (admitted_counts[i] > 0 || rejected_counts[i] > 0) {
+      if (!any_admission) {
+        str << "Block cache admission(admitted,rejected):";
+        any_admission = true;
+      }
+      str << " " << kCacheEntryRoleToCamelString[i] << "("
+          << admitted_counts[i] << "," << rejected_counts[i] << ")";
+    }
+  }
+  if (any_admission) {
+    str << "\n";
+  }
   return str.str();
 }
 
@@ -655,6 +804,8 @@ void InternalStats::CacheEntryRoleStats::ToMap(
     v["bytes." + role] = ROCKSDB_NAMESPACE::ToString(total_charges[i]);
     v["percent." + role] =
         ROCKSDB_NAMESPACE::ToString(100.0 * total_charges[i] / cache_capacity);
+    v["admitted." + role] = ROCKSDB_NAMESPACE::ToString(admitted_counts[i]);
+    v["rejected." + role] = ROCKSDB_NAMESPACE::ToString(rejected_counts[i]);
   }
 }
 
@@ -1108,6 +1259,13 @@ bool InternalStats::HandleIsWriteStopped(uint64_t* value, DBImpl* db,
   return true;
 }
 
+bool InternalStats::HandleEstimatedSustainableWriteRate(uint64_t* value,
+                                                        DBImpl* /*db*/,
+                                                        Version* /*version*/) {
+  *value = cfd_->GetSustainableWriteRate();
+  return true;
+}
+
 bool InternalStats::HandleEstimateOldestKeyTime(uint64_t* value, DBImpl* /*db*/,
                                                 Version* /*version*/) {
   // TODO(yiwu): The property is currently available for fifo compaction
@@ -1180,6 +1338,247 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+namespace {
+MissRatioCurveCache* AsMissRatioCurveCache(Cache* block_cache) {
+  if (strcmp(block_cache->Name(), MissRatioCurveCache::kClassName()) != 0) {
+    return nullptr;
+  }
+  return static_cast<MissRatioCurveCache*>(block_cache);
+}
+}  // namespace
+
+bool InternalStats::HandleBlockCacheMissRatioCurve(std::string* value,
+                                                   Slice /*suffix*/) {
+  Cache* block_cache;
+  if (!GetBlockCacheForStats(&block_cache)) {
+    return false;
+  }
+  MissRatioCurveCache* mrc_cache = AsMissRatioCurveCache(block_cache);
+  if (mrc_cache == nullptr) {
+    return false;
+  }
+  *value = mrc_cache->ToString();
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheMissRatioCurveMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  Cache* block_cache;
+  if (!GetBlockCacheForStats(&block_cache)) {
+    return false;
+  }
+  MissRatioCurveCache* mrc_cache = AsMissRatioCurveCache(block_cache);
+  if (mrc_cache == nullptr) {
+    return false;
+  }
+  values->clear();
+  (*values)["sampled-accesses"] =
+      ROCKSDB_NAMESPACE::ToString(mrc_cache->GetSampledAccesses());
+  for (const auto& point : mrc_cache->GetMissRatioCurve()) {
+    (*values)["miss-ratio." + ROCKSDB_NAMESPACE::ToString(point.capacity)] =
+        ROCKSDB_NAMESPACE::ToString(point.miss_ratio);
+  }
+  return true;
+}
+
+void InternalStats::UpdateCompactionDebtRates() {
+  const VersionStorageInfo* vstorage = cfd_->current()->storage_info();
+  const uint64_t now = clock_->NowMicros();
+  const uint64_t bytes_ingested =
+      cf_stats_value_[BYTES_FLUSHED] + cf_stats_value_[BYTES_INGESTED_ADD_FILE];
+  const uint64_t bytes_compacted = GetBytesWritten() - GetBytesFlushed();
+  const uint64_t pending_compaction_bytes =
+      vstorage->estimated_compaction_needed_bytes();
+  const int l0_files = vstorage->l0_delay_trigger_count();
+  if (debt_sample_.valid) {
+    if (now < debt_sample_.micros + kDebtSampleMinIntervalMicros) {
+      return;
+    }
+    const double elapsed_sec =
+        static_cast<double>(now - debt_sample_.micros) / kMicrosInSec;
+    const double ingest = static_cast<double>(
+        bytes_ingested - debt_sample_.bytes_ingested);
+    const double compacted = static_cast<double>(
+        bytes_compacted - debt_sample_.bytes_compacted);
+    const double debt_growth =
+        static_cast<double>(pending_compaction_bytes) -
+        static_cast<double>(debt_sample_.pending_compaction_bytes);
+    const double l0_growth = l0_files - debt_sample_.l0_files;
+    // Same smoothing as the sustainable write rate, so that a single long
+    // compaction does not swing the forecast
+    const double kSmoothing = 0.3;
+    const double w = debt_rates_.valid ? kSmoothing : 1.0;
+    debt_rates_.ingest_bytes =
+        w * ingest / elapsed_sec + (1 - w) * debt_rates_.ingest_bytes;
+    debt_rates_.compaction_bytes =
+        w * compacted / elapsed_sec + (1 - w) * debt_rates_.compaction_bytes;
+    debt_rates_.pending_compaction_bytes =
+        w * debt_growth / elapsed_sec +
+        (1 - w) * debt_rates_.pending_compaction_bytes;
+    debt_rates_.l0_files =
+        w * l0_growth / elapsed_sec + (1 - w) * debt_rates_.l0_files;
+    debt_rates_.valid = true;
+  }
+  debt_sample_.valid = true;
+  debt_sample_.micros = now;
+  debt_sample_.bytes_ingested = bytes_ingested;
+  debt_sample_.bytes_compacted = bytes_compacted;
+  debt_sample_.pending_compaction_bytes = pending_compaction_bytes;
+  debt_sample_.l0_files = l0_files;
+}
+
+void InternalStats::GetCompactionDebtForecast(
+    CompactionDebtForecast* forecast) {
+  UpdateCompactionDebtRates();
+  const VersionStorageInfo* vstorage = cfd_->current()->storage_info();
+  const MutableCFOptions* mutable_cf_options =
+      cfd_->GetCurrentMutableCFOptions();
+  *forecast = CompactionDebtForecast();
+  forecast->pending_compaction_bytes =
+      vstorage->estimated_compaction_needed_bytes();
+  forecast->ingest_bytes_per_sec = debt_rates_.ingest_bytes;
+  forecast->compaction_bytes_per_sec = debt_rates_.compaction_bytes;
+  forecast->pending_compaction_bytes_per_sec =
+      debt_rates_.pending_compaction_bytes;
+  const double pending =
+      static_cast<double>(forecast->pending_compaction_bytes);
+  const double debt_rate = debt_rates_.pending_compaction_bytes;
+  const int kHorizonMinutes[] = {1, 5, 15};
+  for (size_t i = 0; i < 3; ++i) {
+    forecast->projected_pending_compaction_bytes[i] = static_cast<uint64_t>(
+        std::max(0.0, pending + debt_rate * 60 * kHorizonMinutes[i]));
+  }
+  forecast->required_compaction_bytes_per_sec =
+      std::max(0.0, debt_rates_.compaction_bytes + debt_rate);
+
+  // Mirrors the stall conditions of GetWriteStallConditionAndCause()
+  if (mutable_cf_options->disable_auto_compactions) {
+    return;
+  }
+  if (mutable_cf_options->soft_pending_compaction_bytes_limit > 0) {
+    forecast->seconds_to_soft_pending_limit = SecondsToLimit(
+        pending,
+        static_cast<double>(
+            mutable_cf_options->soft_pending_compaction_bytes_limit),
+        debt_rate);
+  }
+  if (mutable_cf_options->hard_pending_compaction_bytes_limit > 0) {
+    forecast->seconds_to_hard_pending_limit = SecondsToLimit(
+        pending,
+        static_cast<double>(
+            mutable_cf_options->hard_pending_compaction_bytes_limit),
+        debt_rate);
+  }
+  const double l0_files = vstorage->l0_delay_trigger_count();
+  if (mutable_cf_options->level0_slowdown_writes_trigger >= 0) {
+    forecast->seconds_to_l0_slowdown = SecondsToLimit(
+        l0_files, mutable_cf_options->level0_slowdown_writes_trigger,
+        debt_rates_.l0_files);
+  }
+  forecast->seconds_to_l0_stop =
+      SecondsToLimit(l0_files, mutable_cf_options->level0_stop_writes_trigger,
+                     debt_rates_.l0_files);
+  forecast->seconds_to_stall = EarlierLimit(
+      EarlierLimit(forecast->seconds_to_soft_pending_limit,
+                   forecast->seconds_to_hard_pending_limit),
+      EarlierLimit(forecast->seconds_to_l0_slowdown,
+                   forecast->seconds_to_l0_stop));
+}
+
+bool InternalStats::HandleCompactionDebtForecast(std::string* value,
+                                                 Slice suffix) {
+  std::map<std::string, std::string> values;
+  if (!HandleCompactionDebtForecastMap(&values, suffix)) {
+    return false;
+  }
+  value->clear();
+  for (const auto& kv : values) {
+    value->append(kv.first);
+    value->append(": ");
+    value->append(kv.second);
+    value->append("\n");
+  }
+  return true;
+}
+
+bool InternalStats::HandleCompactionDebtForecastMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  CompactionDebtForecast forecast;
+  GetCompactionDebtForecast(&forecast);
+  auto to_int = [](double v) {
+    return ROCKSDB_NAMESPACE::ToString(static_cast<int64_t>(v));
+  };
+  values->clear();
+  (*values)["pending-compaction-bytes"] =
+      ROCKSDB_NAMESPACE::ToString(forecast.pending_compaction_bytes);
+  (*values)["ingest-bytes-per-sec"] = to_int(forecast.ingest_bytes_per_sec);
+  (*values)["compaction-bytes-per-sec"] =
+      to_int(forecast.compaction_bytes_per_sec);
+  (*values)["pending-compaction-bytes-per-sec"] =
+      to_int(forecast.pending_compaction_bytes_per_sec);
+  (*values)["projected-pending-compaction-bytes.1m"] =
+      ROCKSDB_NAMESPACE::ToString(
+          forecast.projected_pending_compaction_bytes[0]);
+  (*values)["projected-pending-compaction-bytes.5m"] =
+      ROCKSDB_NAMESPACE::ToString(
+          forecast.projected_pending_compaction_bytes[1]);
+  (*values)["projected-pending-compaction-bytes.15m"] =
+      ROCKSDB_NAMESPACE::ToString(
+          forecast.projected_pending_compaction_bytes[2]);
+  (*values)["seconds-to-soft-pending-compaction-bytes-limit"] =
+      to_int(forecast.seconds_to_soft_pending_limit);
+  (*values)["seconds-to-hard-pending-compaction-bytes-limit"] =
+      to_int(forecast.seconds_to_hard_pending_limit);
+  (*values)["seconds-to-l0-slowdown"] = to_int(forecast.seconds_to_l0_slowdown);
+  (*values)["seconds-to-l0-stop"] = to_int(forecast.seconds_to_l0_stop);
+  (*values)["seconds-to-stall"] = to_int(forecast.seconds_to_stall);
+  (*values)["required-compaction-bytes-per-sec"] =
+      to_int(forecast.required_compaction_bytes_per_sec);
+  return true;
+}
+
+bool InternalStats::HandleFilterStats(std::string* value, Slice /*suffix*/) {
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%5s %16s %16s %16s %16s %16s\n", "Level",
+           "WholeKeyChecked", "WholeKeyUseful", "PrefixChecked",
+           "PrefixUseful", "Skipped");
+  value->assign(buf);
+  for (int level = 0; level < number_levels_; level++) {
+    const LevelFilterStats& stats = filter_stats_[level];
+    snprintf(buf, sizeof(buf),
+             "%5s %16" PRIu64 " %16" PRIu64 " %16" PRIu64 " %16" PRIu64
+             " %16" PRIu64 "\n",
+             ("L" + ToString(level)).c_str(),
+             stats.whole_key_checked.load(std::memory_order_relaxed),
+             stats.whole_key_useful.load(std::memory_order_relaxed),
+             stats.prefix_checked.load(std::memory_order_relaxed),
+             stats.prefix_useful.load(std::memory_order_relaxed),
+             stats.skipped.load(std::memory_order_relaxed));
+    value->append(buf);
+  }
+  return true;
+}
+
+bool InternalStats::HandleFilterStatsMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  values->clear();
+  for (int level = 0; level < number_levels_; level++) {
+    const LevelFilterStats& stats = filter_stats_[level];
+    const std::string prefix = "L" + ToString(level) + ".";
+    (*values)[prefix + "whole-key-checked"] =
+        ToString(stats.whole_key_checked.load(std::memory_order_relaxed));
+    (*values)[prefix + "whole-key-useful"] =
+        ToString(stats.whole_key_useful.load(std::memory_order_relaxed));
+    (*values)[prefix + "prefix-checked"] =
+        ToString(stats.prefix_checked.load(std::memory_order_relaxed));
+    (*values)[prefix + "prefix-useful"] =
+        ToString(stats.prefix_useful.load(std::memory_order_relaxed));
+    (*values)[prefix + "skipped"] =
+        ToString(stats.skipped.load(std::memory_order_relaxed));
+  }
+  return true;
+}
+
 void InternalStats::DumpDBStats(std::string* value) {
   char buf[1000];
   // DB-level stats, only available from default column family
@@ -1424,6 +1823,8 @@ void InternalStats::DumpCFMapStatsIOStalls(
       std::to_string(cf_stats_count_[PENDING_COMPACTION_BYTES_LIMIT_STOPS]);
   (*cf_stats)["io_stalls.slowdown_for_pending_compaction_bytes"] =
       std::to_string(cf_stats_count_[PENDING_COMPACTION_BYTES_LIMIT_SLOWDOWNS]);
+  (*cf_stats)["io_stalls.smooth_slowdown_for_pending_compaction_bytes"] =
+      std::to_string(cf_stats_count_[PENDING_COMPACTION_BYTES_SMOOTH_SLOWDOWNS]);
   (*cf_stats)["io_stalls.memtable_compaction"] =
       std::to_string(cf_stats_count_[MEMTABLE_LIMIT_STOPS]);
   (*cf_stats)["io_stalls.memtable_slowdown"] =
@@ -1626,6 +2027,21 @@ void InternalStats::DumpCFStatsNoFileHistogram(std::string* value) {
            total_stall_count - cf_stats_snapshot_.stall_count);
   value->append(buf);
 
+  CompactionDebtForecast forecast;
+  GetCompactionDebtForecast(&forecast);
+  snprintf(buf, sizeof(buf),
+           "Compaction debt: %.3f GB pending, %.2f MB/s growth, "
+           "%.2f MB/s ingest, %.2f MB/s compaction, %.2f MB/s needed, "
+           "%.3f GB in 15m, %.0f seconds to stall\n",
+           forecast.pending_compaction_bytes / kGB,
+           forecast.pending_compaction_bytes_per_sec / kMB,
+           forecast.ingest_bytes_per_sec / kMB,
+           forecast.compaction_bytes_per_sec / kMB,
+           forecast.required_compaction_bytes_per_sec / kMB,
+           forecast.projected_pending_compaction_bytes[2] / kGB,
+           forecast.seconds_to_stall);
+  value->append(buf);
+
   cf_stats_snapshot_.seconds_up = seconds_up;
   cf_stats_snapshot_.ingest_bytes_flush = flush_ingest;
   cf_stats_snapshot_.ingest_bytes_addfile = add_file_ingest;
@@ -1661,9 +2077,11 @@ void InternalStats::DumpCFFileHistogram(std::string* value) {
       << "] **\n";
 
   for (int level = 0; level < number_levels_; level++) {
-    if (!file_read_latency_[level].Empty()) {
+    const HistogramImpl* h =
+        file_read_latency_[level].load(std::memory_order_acquire);
+    if (h != nullptr && !h->Empty()) {
       oss << "** Level " << level << " read latency histogram (micros):\n"
-          << file_read_latency_[level].ToString() << '\n';
+          << h->ToString() << '\n';
     }
   }
 
@@ -109,6 +109,7 @@ class InternalStats {
     LOCKED_L0_FILE_COUNT_LIMIT_STOPS,
     PENDING_COMPACTION_BYTES_LIMIT_SLOWDOWNS,
     PENDING_COMPACTION_BYTES_LIMIT_STOPS,
+    PENDING_COMPACTION_BYTES_SMOOTH_SLOWDOWNS,
     WRITE_STALLS_ENUM_MAX,
     BYTES_FLUSHED,
     BYTES_INGESTED_ADD_FILE,
@@ -131,6 +132,10 @@ class InternalStats {
   };
 
   InternalStats(int num_levels, SystemClock* clock, ColumnFamilyData* cfd);
+  ~InternalStats();
+
+  InternalStats(const InternalStats&) = delete;
+  InternalStats& operator=(const InternalStats&) = delete;
 
   // Per level compaction stats.  comp_stats_[level] stores the stats for
   // compactions that produced data for the specified "level".
@@ -357,6 +362,10 @@ class InternalStats {
     std::string cache_id;
     std::array<uint64_t, kNumCacheEntryRoles> total_charges;
     std::array<size_t, kNumCacheEntryRoles> entry_counts;
+    // Cumulative decisions of the LRUCache frequency admission filter, if
+    // enabled
+    std::array<uint64_t, kNumCacheEntryRoles> admitted_counts;
+    std::array<uint64_t, kNumCacheEntryRoles> rejected_counts;
     uint32_t collection_count = 0;
     uint32_t copies_of_last_collection = 0;
     uint64_t last_start_time_micros_ = 0;
@@ -395,8 +404,13 @@ class InternalStats {
     for (auto& comp_stat : comp_stats_) {
       comp_stat.Clear();
     }
-    for (auto& h : file_read_latency_) {
-      h.Clear();
+    for (int level = 0; level < number_levels_; level++) {
+      HistogramImpl* h =
+          file_read_latency_[level].load(std::memory_order_acquire);
+      if (h != nullptr) {
+        h->Clear();
+      }
+      filter_stats_[level].Clear();
     }
     blob_file_read_latency_.Clear();
     cf_stats_snapshot_.Clear();
@@ -420,6 +434,23 @@ class InternalStats {
     ++cf_stats_count_[type];
   }
 
+  uint64_t GetBytesFlushed() const { return cf_stats_value_[BYTES_FLUSHED]; }
+
+  // Total bytes written by flushes and compactions
+  uint64_t GetBytesWritten() const {
+    uint64_t bytes_written = 0;
+    for (const auto& comp_stat : comp_stats_) {
+      bytes_written += comp_stat.bytes_written;
+    }
+    return bytes_written;
+  }
+
+  // Folds the ingest, compaction and pending compaction bytes progress since
+  // the previous sample into the rates the compaction debt forecast
+  // extrapolates. Samples less than kDebtSampleMinIntervalMicros apart are
+  // skipped. REQUIRE: DB mutex held
+  void UpdateCompactionDebtRates();
+
   void AddDBStats(InternalDBStatsType type, uint64_t value,
                   bool concurrent = false) {
     auto& v = db_stats_[type];
@@ -435,12 +466,24 @@ class InternalStats {
     return db_stats_[type].load(std::memory_order_relaxed);
   }
 
-  HistogramImpl* GetFileReadHist(int level) {
-    return &file_read_latency_[level];
-  }
+  // The histograms are created by the first call for a level, so that the
+  // many levels and column families that are never read from do not hold one
+  HistogramImpl* GetFileReadHist(int level);
 
   HistogramImpl* GetBlobFileReadHist() { return &blob_file_read_latency_; }
 
+  // Adds the full filter checks that a Get() made in a table file of the
+  // level, the difference between the stats of its GetContext before and
+  // after the lookup in the file.
+  void RecordFilterChecks(int level, const GetContextStats& before,
+                          const GetContextStats& after);
+
+  // Returns true if a Get() should skip the filters of the level, because
+  // they were checked at least max_unhelpful_checks times in a row without
+  // ruling out a key (see skip_filters_after_unhelpful_checks). Once every
+  // max_unhelpful_checks skipped lookups, returns false to check them again.
+  bool ShouldSkipUnhelpfulFilters(int level, uint64_t max_unhelpful_checks);
+
   uint64_t GetBackgroundErrorCount() const { return bg_error_count_; }
 
   uint64_t BumpAndGetBackgroundErrorCount() { return ++bg_error_count_; }
@@ -465,6 +508,26 @@ class InternalStats {
   // This should only be called while NOT holding the DB mutex.
   void CollectCacheEntryStats(bool foreground);
 
+  // The current debt extrapolated with the smoothed rates. The seconds until
+  // a stall are 0 when already stalled, and -1 when not expected to stall.
+  // Requires the DB mutex.
+  struct CompactionDebtForecast {
+    uint64_t pending_compaction_bytes = 0;
+    double ingest_bytes_per_sec = 0;
+    double compaction_bytes_per_sec = 0;
+    double pending_compaction_bytes_per_sec = 0;
+    // Pending compaction bytes in 1, 5 and 15 minutes
+    uint64_t projected_pending_compaction_bytes[3] = {0, 0, 0};
+    double seconds_to_soft_pending_limit = -1;
+    double seconds_to_hard_pending_limit = -1;
+    double seconds_to_l0_slowdown = -1;
+    double seconds_to_l0_stop = -1;
+    double seconds_to_stall = -1;
+    // Compaction throughput at which the debt stops growing
+    double required_compaction_bytes_per_sec = 0;
+  };
+  void GetCompactionDebtForecast(CompactionDebtForecast* forecast);
+
   const uint64_t* TEST_GetCFStatsValue() const { return cf_stats_value_; }
 
   const std::vector<CompactionStats>& TEST_GetCompactionStats() const {
@@ -508,9 +571,32 @@ class InternalStats {
   // Per-ColumnFamily/level compaction stats
   std::vector<CompactionStats> comp_stats_;
   std::vector<CompactionStats> comp_stats_by_pri_;
-  std::vector<HistogramImpl> file_read_latency_;
+  std::unique_ptr<std::atomic<HistogramImpl*>[]> file_read_latency_;
   HistogramImpl blob_file_read_latency_;
 
+  // Full filter checks of Get() in the table files of a level
+  struct LevelFilterStats {
+    std::atomic<uint64_t> whole_key_checked{0};
+    std::atomic<uint64_t> whole_key_useful{0};
+    std::atomic<uint64_t> prefix_checked{0};
+    std::atomic<uint64_t> prefix_useful{0};
+    // Lookups that skipped the filters
+    std::atomic<uint64_t> skipped{0};
+    // Checks since the last one that ruled out a key, and lookups that
+    // skipped the filters since the last check
+    std::atomic<uint64_t> unhelpful_checks{0};
+    std::atomic<uint64_t> skipped_since_check{0};
+
+    void Clear() {
+      whole_key_checked.store(0, std::memory_order_relaxed);
+      whole_key_useful.store(0, std::memory_order_relaxed);
+      prefix_checked.store(0, std::memory_order_relaxed);
+      prefix_useful.store(0, std::memory_order_relaxed);
+      skipped.store(0, std::memory_order_relaxed);
+    }
+  };
+  std::unique_ptr<LevelFilterStats[]> filter_stats_;
+
   // Used to compute per-interval statistics
   struct CFStatsSnapshot {
     // ColumnFamily-level stats
@@ -599,6 +685,28 @@ class InternalStats {
     }
   } db_stats_snapshot_;
 
+  static constexpr uint64_t kDebtSampleMinIntervalMicros = 1000000;
+
+  // Cumulative counters at the previous compaction debt sample
+  struct CompactionDebtSample {
+    bool valid = false;
+    uint64_t micros = 0;
+    uint64_t bytes_ingested = 0;
+    uint64_t bytes_compacted = 0;
+    uint64_t pending_compaction_bytes = 0;
+    int l0_files = 0;
+  } debt_sample_;
+
+  // Smoothed per-second rates, see UpdateCompactionDebtRates()
+  struct CompactionDebtRates {
+    bool valid = false;
+    double ingest_bytes = 0;
+    double compaction_bytes = 0;
+    // Negative while compaction pays off the debt faster than it accrues
+    double pending_compaction_bytes = 0;
+    double l0_files = 0;
+  } debt_rates_;
+
   // Handler functions for getting property values. They use "value" as a value-
   // result argument, and return true upon successfully setting "value".
   bool HandleNumFilesAtLevel(std::string* value, Slice suffix);
@@ -666,6 +774,8 @@ class InternalStats {
   bool HandleActualDelayedWriteRate(uint64_t* value, DBImpl* db,
                                     Version* version);
   bool HandleIsWriteStopped(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleEstimatedSustainableWriteRate(uint64_t* value, DBImpl* db,
+                                           Version* version);
   bool HandleEstimateOldestKeyTime(uint64_t* value, DBImpl* db,
                                    Version* version);
   bool HandleBlockCacheCapacity(uint64_t* value, DBImpl* db, Version* version);
@@ -675,6 +785,15 @@ class InternalStats {
   bool HandleBlockCacheEntryStats(std::string* value, Slice suffix);
   bool HandleBlockCacheEntryStatsMap(std::map<std::string, std::string>* values,
                                      Slice suffix);
+  bool HandleBlockCacheMissRatioCurve(std::string* value, Slice suffix);
+  bool HandleBlockCacheMissRatioCurveMap(
+      std::map<std::string, std::string>* values, Slice suffix);
+  bool HandleCompactionDebtForecast(std::string* value, Slice suffix);
+  bool HandleCompactionDebtForecastMap(
+      std::map<std::string, std::string>* values, Slice suffix);
+  bool HandleFilterStats(std::string* value, Slice suffix);
+  bool HandleFilterStatsMap(std::map<std::string, std::string>* values,
+                            Slice suffix);
   // Total number of background errors encountered. Every time a flush task
   // or compaction task fails, this counter is incremented. The failure can
   // be caused by any possible reason, including file system errors, out of
@@ -701,6 +820,7 @@ class InternalStats {
     LOCKED_L0_FILE_COUNT_LIMIT_STOPS,
     PENDING_COMPACTION_BYTES_LIMIT_SLOWDOWNS,
     PENDING_COMPACTION_BYTES_LIMIT_STOPS,
+    PENDING_COMPACTION_BYTES_SMOOTH_SLOWDOWNS,
     WRITE_STALLS_ENUM_MAX,
     BYTES_FLUSHED,
     BYTES_INGESTED_ADD_FILE,
@@ -760,6 +880,12 @@ class InternalStats {
 
   void AddCFStats(InternalCFStatsType /*type*/, uint64_t /*value*/) {}
 
+  uint64_t GetBytesFlushed() const { return 0; }
+
+  uint64_t GetBytesWritten() const { return 0; }
+
+  void UpdateCompactionDebtRates() {}
+
   void AddDBStats(InternalDBStatsType /*type*/, uint64_t /*value*/,
                   bool /*concurrent */ = false) {}
 
@@ -767,6 +893,14 @@ class InternalStats {
 
   HistogramImpl* GetBlobFileReadHist() { return nullptr; }
 
+  void RecordFilterChecks(int /*level*/, const GetContextStats& /*before*/,
+                          const GetContextStats& /*after*/) {}
+
+  bool ShouldSkipUnhelpfulFilters(int /*level*/,
+                                  uint64_t /*max_unhelpful_checks*/) {
+    return false;
+  }
+
   uint64_t GetBackgroundErrorCount() const { return 0; }
 
   uint64_t BumpAndGetBackgroundErrorCount() { return 0; }
@@ -86,6 +86,45 @@ class ProtectionInfo {
   static const uint64_t kSeedS = 0x4A2AB5CBD26F542C;
   static const uint64_t kSeedC = 0x1CB5633EC70B2937;
 
+  static uint64_t HashK(const Slice& key) {
+    return GetSliceNPHash64(key, kSeedK);
+  }
+  static uint64_t HashK(const SliceParts& key) {
+    return GetSlicePartsNPHash64(key, kSeedK);
+  }
+  static uint64_t HashV(const Slice& value) {
+    return GetSliceNPHash64(value, kSeedV);
+  }
+  static uint64_t HashV(const SliceParts& value) {
+    return GetSlicePartsNPHash64(value, kSeedV);
+  }
+  static uint64_t HashT(const Slice& timestamp) {
+    // Most entries have no timestamp
+    static const uint64_t kEmptyHash = GetSliceNPHash64(Slice(), kSeedT);
+    return timestamp.empty() ? kEmptyHash
+                             : GetSliceNPHash64(timestamp, kSeedT);
+  }
+  // The op type, CF ID and seqno are fixed-width integers, for which an
+  // inline mix does in a few cycles what the out-of-line hash of the
+  // variable-length fields does in tens, and changing any bit of them always
+  // changes the result, as the mix is a bijection.
+  static uint64_t HashO(ValueType op_type) {
+    return MixInt(static_cast<uint64_t>(op_type), kSeedO);
+  }
+  static uint64_t HashC(ColumnFamilyId column_family_id) {
+    return MixInt(column_family_id, kSeedC);
+  }
+  static uint64_t HashS(SequenceNumber sequence_number) {
+    return MixInt(sequence_number, kSeedS);
+  }
+  static uint64_t MixInt(uint64_t v, uint64_t seed) {
+    // The finalizer of SplitMix64
+    v = (v ^ seed) + 0x9E3779B97F4A7C15;
+    v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9;
+    v = (v ^ (v >> 27)) * 0x94D049BB133111EB;
+    return v ^ (v >> 31);
+  }
+
   ProtectionInfo<T>(T val) : val_(val) {
     static_assert(sizeof(ProtectionInfo<T>) == sizeof(T), "");
   }
@@ -137,6 +176,10 @@ class ProtectionInfoKVOTC {
   ProtectionInfoKVOTC<T>() = default;
 
   ProtectionInfoKVOT<T> StripC(ColumnFamilyId column_family_id) const;
+  // Same as StripC(column_family_id).ProtectS(sequence_number), which the
+  // memtable insert of every WriteBatch entry does
+  ProtectionInfoKVOTS<T> StripCProtectS(ColumnFamilyId column_family_id,
+                                        SequenceNumber sequence_number) const;
 
   void UpdateK(const Slice& old_key, const Slice& new_key) {
     kvot_.UpdateK(old_key, new_key);
@@ -202,6 +245,7 @@ class ProtectionInfoKVOTS {
 
  private:
   friend class ProtectionInfoKVOT<T>;
+  friend class ProtectionInfoKVOTC<T>;
 
   ProtectionInfoKVOTS<T>(T val) : kvot_(val) {
     static_assert(sizeof(ProtectionInfoKVOTS<T>) == sizeof(T), "");
@@ -225,200 +269,134 @@ template <typename T>
 ProtectionInfoKVOT<T> ProtectionInfo<T>::ProtectKVOT(
     const Slice& key, const Slice& value, ValueType op_type,
     const Slice& timestamp) const {
-  T val = GetVal();
-  val = val ^ static_cast<T>(GetSliceNPHash64(key, ProtectionInfo<T>::kSeedK));
-  val =
-      val ^ static_cast<T>(GetSliceNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(timestamp, ProtectionInfo<T>::kSeedT));
-  return ProtectionInfoKVOT<T>(val);
+  return ProtectionInfoKVOT<T>(
+      GetVal() ^ static_cast<T>(HashK(key) ^ HashV(value) ^ HashO(op_type) ^
+                                HashT(timestamp)));
 }
 
 template <typename T>
 ProtectionInfoKVOT<T> ProtectionInfo<T>::ProtectKVOT(
     const SliceParts& key, const SliceParts& value, ValueType op_type,
     const Slice& timestamp) const {
-  T val = GetVal();
-  val = val ^
-        static_cast<T>(GetSlicePartsNPHash64(key, ProtectionInfo<T>::kSeedK));
-  val = val ^
-        static_cast<T>(GetSlicePartsNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(timestamp, ProtectionInfo<T>::kSeedT));
-  return ProtectionInfoKVOT<T>(val);
+  return ProtectionInfoKVOT<T>(
+      GetVal() ^ static_cast<T>(HashK(key) ^ HashV(value) ^ HashO(op_type) ^
+                                HashT(timestamp)));
 }
 
 template <typename T>
 void ProtectionInfoKVOT<T>::UpdateK(const Slice& old_key,
                                     const Slice& new_key) {
-  T val = GetVal();
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(old_key, ProtectionInfo<T>::kSeedK));
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(new_key, ProtectionInfo<T>::kSeedK));
-  SetVal(val);
+  SetVal(GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashK(old_key) ^
+                                   ProtectionInfo<T>::HashK(new_key)));
 }
 
 template <typename T>
 void ProtectionInfoKVOT<T>::UpdateK(const SliceParts& old_key,
                                     const SliceParts& new_key) {
-  T val = GetVal();
-  val = val ^ static_cast<T>(
-                  GetSlicePartsNPHash64(old_key, ProtectionInfo<T>::kSeedK));
-  val = val ^ static_cast<T>(
-                  GetSlicePartsNPHash64(new_key, ProtectionInfo<T>::kSeedK));
-  SetVal(val);
+  SetVal(GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashK(old_key) ^
+                                   ProtectionInfo<T>::HashK(new_key)));
 }
 
 template <typename T>
 void ProtectionInfoKVOT<T>::UpdateV(const Slice& old_value,
                                     const Slice& new_value) {
-  T val = GetVal();
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(old_value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(new_value, ProtectionInfo<T>::kSeedV));
-  SetVal(val);
+  SetVal(GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashV(old_value) ^
+                                   ProtectionInfo<T>::HashV(new_value)));
 }
 
 template <typename T>
 void ProtectionInfoKVOT<T>::UpdateV(const SliceParts& old_value,
                                     const SliceParts& new_value) {
-  T val = GetVal();
-  val = val ^ static_cast<T>(
-                  GetSlicePartsNPHash64(old_value, ProtectionInfo<T>::kSeedV));
-  val = val ^ static_cast<T>(
-                  GetSlicePartsNPHash64(new_value, ProtectionInfo<T>::kSeedV));
-  SetVal(val);
+  SetVal(GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashV(old_value) ^
+                                   ProtectionInfo<T>::HashV(new_value)));
 }
 
 template <typename T>
 void ProtectionInfoKVOT<T>::UpdateO(ValueType old_op_type,
                                     ValueType new_op_type) {
-  T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&old_op_type),
-                                      sizeof(old_op_type),
-                                      ProtectionInfo<T>::kSeedO));
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&new_op_type),
-                                      sizeof(new_op_type),
-                                      ProtectionInfo<T>::kSeedO));
-  SetVal(val);
+  SetVal(GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashO(old_op_type) ^
+                                   ProtectionInfo<T>::HashO(new_op_type)));
 }
 
 template <typename T>
 void ProtectionInfoKVOT<T>::UpdateT(const Slice& old_timestamp,
                                     const Slice& new_timestamp) {
-  T val = GetVal();
-  val = val ^ static_cast<T>(
-                  GetSliceNPHash64(old_timestamp, ProtectionInfo<T>::kSeedT));
-  val = val ^ static_cast<T>(
-                  GetSliceNPHash64(new_timestamp, ProtectionInfo<T>::kSeedT));
-  SetVal(val);
+  SetVal(GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashT(old_timestamp) ^
+                                   ProtectionInfo<T>::HashT(new_timestamp)));
 }
 
 template <typename T>
 ProtectionInfo<T> ProtectionInfoKVOT<T>::StripKVOT(
     const Slice& key, const Slice& value, ValueType op_type,
     const Slice& timestamp) const {
-  T val = GetVal();
-  val = val ^ static_cast<T>(GetSliceNPHash64(key, ProtectionInfo<T>::kSeedK));
-  val =
-      val ^ static_cast<T>(GetSliceNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(timestamp, ProtectionInfo<T>::kSeedT));
-  return ProtectionInfo<T>(val);
+  return ProtectionInfo<T>(
+      GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashK(key) ^
+                                ProtectionInfo<T>::HashV(value) ^
+                                ProtectionInfo<T>::HashO(op_type) ^
+                                ProtectionInfo<T>::HashT(timestamp)));
 }
 
 template <typename T>
 ProtectionInfo<T> ProtectionInfoKVOT<T>::StripKVOT(
     const SliceParts& key, const SliceParts& value, ValueType op_type,
     const Slice& timestamp) const {
-  T val = GetVal();
-  val = val ^
-        static_cast<T>(GetSlicePartsNPHash64(key, ProtectionInfo<T>::kSeedK));
-  val = val ^
-        static_cast<T>(GetSlicePartsNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
-  val = val ^
-        static_cast<T>(GetSliceNPHash64(timestamp, ProtectionInfo<T>::kSeedT));
-  return ProtectionInfo<T>(val);
+  return ProtectionInfo<T>(
+      GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashK(key) ^
+                                ProtectionInfo<T>::HashV(value) ^
+                                ProtectionInfo<T>::HashO(op_type) ^
+                                ProtectionInfo<T>::HashT(timestamp)));
 }
 
 template <typename T>
 ProtectionInfoKVOTC<T> ProtectionInfoKVOT<T>::ProtectC(
     ColumnFamilyId column_family_id) const {
-  T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&column_family_id),
-                  sizeof(column_family_id), ProtectionInfo<T>::kSeedC));
-  return ProtectionInfoKVOTC<T>(val);
+  return ProtectionInfoKVOTC<T>(
+      GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashC(column_family_id)));
 }
 
 template <typename T>
 ProtectionInfoKVOT<T> ProtectionInfoKVOTC<T>::StripC(
     ColumnFamilyId column_family_id) const {
-  T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&column_family_id),
-                  sizeof(column_family_id), ProtectionInfo<T>::kSeedC));
-  return ProtectionInfoKVOT<T>(val);
+  return ProtectionInfoKVOT<T>(
+      GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashC(column_family_id)));
+}
+
+template <typename T>
+ProtectionInfoKVOTS<T> ProtectionInfoKVOTC<T>::StripCProtectS(
+    ColumnFamilyId column_family_id, SequenceNumber sequence_number) const {
+  return ProtectionInfoKVOTS<T>(
+      GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashC(column_family_id) ^
+                                ProtectionInfo<T>::HashS(sequence_number)));
 }
 
 template <typename T>
 void ProtectionInfoKVOTC<T>::UpdateC(ColumnFamilyId old_column_family_id,
                                      ColumnFamilyId new_column_family_id) {
-  T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&old_column_family_id),
-                  sizeof(old_column_family_id), ProtectionInfo<T>::kSeedC));
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&new_column_family_id),
-                  sizeof(new_column_family_id), ProtectionInfo<T>::kSeedC));
-  SetVal(val);
+  SetVal(GetVal() ^
+         static_cast<T>(ProtectionInfo<T>::HashC(old_column_family_id) ^
+                        ProtectionInfo<T>::HashC(new_column_family_id)));
 }
 
 template <typename T>
 ProtectionInfoKVOTS<T> ProtectionInfoKVOT<T>::ProtectS(
     SequenceNumber sequence_number) const {
-  T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&sequence_number),
-                                      sizeof(sequence_number),
-                                      ProtectionInfo<T>::kSeedS));
-  return ProtectionInfoKVOTS<T>(val);
+  return ProtectionInfoKVOTS<T>(
+      GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashS(sequence_number)));
 }
 
 template <typename T>
 ProtectionInfoKVOT<T> ProtectionInfoKVOTS<T>::StripS(
     SequenceNumber sequence_number) const {
-  T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&sequence_number),
-                                      sizeof(sequence_number),
-                                      ProtectionInfo<T>::kSeedS));
-  return ProtectionInfoKVOT<T>(val);
+  return ProtectionInfoKVOT<T>(
+      GetVal() ^ static_cast<T>(ProtectionInfo<T>::HashS(sequence_number)));
 }
 
 template <typename T>
 void ProtectionInfoKVOTS<T>::UpdateS(SequenceNumber old_sequence_number,
                                      SequenceNumber new_sequence_number) {
-  T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&old_sequence_number),
-                  sizeof(old_sequence_number), ProtectionInfo<T>::kSeedS));
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&new_sequence_number),
-                  sizeof(new_sequence_number), ProtectionInfo<T>::kSeedS));
-  SetVal(val);
+  SetVal(GetVal() ^
+         static_cast<T>(ProtectionInfo<T>::HashS(old_sequence_number) ^
+                        ProtectionInfo<T>::HashS(new_sequence_number)));
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -1108,6 +1108,57 @@ TEST_F(EventListenerTest, OnFileOperationTest) {
   }
 }
 
+class RequestSampledListener : public EventListener {
+ public:
+  void OnRequestSampled(const SampledRequestInfo& info) override {
+    MutexLock l(&mutex_);
+    infos_.push_back(info);
+  }
+
+  port::Mutex mutex_;
+  std::vector<SampledRequestInfo> infos_;
+};
+
+TEST_F(EventListenerTest, OnRequestSampledTest) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  options.perf_context_sample_one_in = 1;
+  auto listener = std::make_shared<RequestSampledListener>();
+  options.listeners.push_back(listener);
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_EQ("bar", Get("foo"));
+  {
+    MutexLock l(&listener->mutex_);
+    ASSERT_EQ(2U, listener->infos_.size());
+    const SampledRequestInfo& write_info = listener->infos_[0];
+    ASSERT_EQ(SampledRequestType::kWrite, write_info.type);
+    ASSERT_OK(write_info.status);
+    ASSERT_TRUE(write_info.cf_name.empty());
+    const SampledRequestInfo& get_info = listener->infos_[1];
+    ASSERT_EQ(SampledRequestType::kGet, get_info.type);
+    ASSERT_OK(get_info.status);
+    ASSERT_EQ(kDefaultColumnFamilyName, get_info.cf_name);
+    ASSERT_EQ(1U, get_info.perf_context.get_from_memtable_count);
+  }
+  HistogramData memtable_hist;
+  options.statistics->histogramData(SAMPLED_GET_MEMTABLE_NANOS,
+                                    &memtable_hist);
+  ASSERT_EQ(1U, memtable_hist.count);
+
+  // The thread's own perf level and context are left alone
+  ASSERT_EQ(PerfLevel::kDisable, GetPerfLevel());
+  get_perf_context()->Reset();
+  SetPerfLevel(PerfLevel::kEnableCount);
+  ASSERT_EQ("bar", Get("foo"));
+  ASSERT_EQ(1U, get_perf_context()->get_from_memtable_count);
+  SetPerfLevel(PerfLevel::kDisable);
+  MutexLock l(&listener->mutex_);
+  ASSERT_EQ(2U, listener->infos_.size());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 #endif  // ROCKSDB_LITE
@@ -15,6 +15,7 @@
 #include "rocksdb/env.h"
 #include "test_util/sync_point.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -38,7 +39,8 @@ Reader::Reader(std::shared_ptr<Logger> info_log,
       last_record_offset_(0),
       end_of_buffer_offset_(0),
       log_number_(log_num),
-      recycled_(false) {}
+      recycled_(false),
+      compression_type_(kNoCompression) {}
 
 Reader::~Reader() {
   delete[] backing_store_;
@@ -78,6 +80,10 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         prospective_record_offset = physical_record_offset;
         scratch->clear();
         *record = fragment;
+        if (!MaybeUncompressRecord(record)) {
+          in_fragmented_record = false;
+          break;
+        }
         last_record_offset_ = prospective_record_offset;
         return true;
 
@@ -113,11 +119,25 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         } else {
           scratch->append(fragment.data(), fragment.size());
           *record = Slice(*scratch);
+          if (!MaybeUncompressRecord(record)) {
+            in_fragmented_record = false;
+            scratch->clear();
+            break;
+          }
           last_record_offset_ = prospective_record_offset;
           return true;
         }
         break;
 
+      case kSetCompressionType:
+        if (in_fragmented_record) {
+          ReportCorruption(scratch->size(), "partial record without end(3)");
+          in_fragmented_record = false;
+          scratch->clear();
+        }
+        InitCompression(fragment);
+        break;
+
       case kBadHeader:
         if (wal_recovery_mode == WALRecoveryMode::kAbsoluteConsistency ||
             wal_recovery_mode == WALRecoveryMode::kPointInTimeRecovery) {
@@ -299,6 +319,43 @@ void Reader::UnmarkEOFInternal() {
   }
 }
 
+void Reader::InitCompression(const Slice& record) {
+  if (uncompress_) {
+    ReportCorruption(record.size(), "multiple SetCompressionType records");
+    return;
+  }
+  Slice input = record;
+  uint32_t val = 0;
+  if (!GetFixed32(&input, &val)) {
+    ReportCorruption(record.size(), "malformed SetCompressionType record");
+    return;
+  }
+  const CompressionType type = static_cast<CompressionType>(val);
+  if (type != kNoCompression) {
+    uncompress_ = StreamingUncompress::Create(type);
+    if (!uncompress_) {
+      ReportDrop(record.size(),
+                 Status::NotSupported("WAL compression type not supported",
+                                      CompressionTypeToString(type)));
+      return;
+    }
+  }
+  compression_type_ = type;
+}
+
+bool Reader::MaybeUncompressRecord(Slice* record) {
+  if (!uncompress_) {
+    return true;
+  }
+  uncompressed_record_.clear();
+  if (!uncompress_->Uncompress(*record, &uncompressed_record_)) {
+    ReportCorruption(record->size(), "failed to uncompress record");
+    return false;
+  }
+  *record = Slice(uncompressed_record_);
+  return true;
+}
+
 void Reader::ReportCorruption(size_t bytes, const char* reason) {
   ReportDrop(bytes, Status::Corruption(reason));
 }
@@ -447,9 +504,12 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
         }
         fragments_.clear();
         *record = fragment;
+        in_fragmented_record_ = false;
+        if (!MaybeUncompressRecord(record)) {
+          break;
+        }
         prospective_record_offset = physical_record_offset;
         last_record_offset_ = prospective_record_offset;
-        in_fragmented_record_ = false;
         return true;
 
       case kFirstType:
@@ -482,12 +542,24 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
           scratch->assign(fragments_.data(), fragments_.size());
           fragments_.clear();
           *record = Slice(*scratch);
-          last_record_offset_ = prospective_record_offset;
           in_fragmented_record_ = false;
+          if (!MaybeUncompressRecord(record)) {
+            break;
+          }
+          last_record_offset_ = prospective_record_offset;
           return true;
         }
         break;
 
+      case kSetCompressionType:
+        if (in_fragmented_record_) {
+          ReportCorruption(fragments_.size(), "partial record without end(3)");
+          in_fragmented_record_ = false;
+          fragments_.clear();
+        }
+        InitCompression(fragment);
+        break;
+
       case kBadHeader:
       case kBadRecord:
       case kEof:
@@ -19,6 +19,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 class Logger;
+class StreamingUncompress;
 
 namespace log {
 
@@ -101,6 +102,10 @@ class Reader {
     return static_cast<size_t>(end_of_buffer_offset_);
   }
 
+  // Compression type of the records read so far, as announced by a
+  // kSetCompressionType record.
+  CompressionType GetCompressionType() const { return compression_type_; }
+
  protected:
   std::shared_ptr<Logger> info_log_;
   const std::unique_ptr<SequentialFileReader> file_;
@@ -128,6 +133,12 @@ class Reader {
   // Whether this is a recycled log file
   bool recycled_;
 
+  // Set up by a kSetCompressionType record for compressed logs.
+  CompressionType compression_type_;
+  std::unique_ptr<StreamingUncompress> uncompress_;
+  // Holds the uncompressed contents of the last record returned.
+  std::string uncompressed_record_;
+
   // Extend record types with the following special values
   enum {
     kEof = kMaxRecordType + 1,
@@ -158,6 +169,16 @@ class Reader {
   // buffer_ must be updated to remove the dropped bytes prior to invocation.
   void ReportCorruption(size_t bytes, const char* reason);
   void ReportDrop(size_t bytes, const Status& reason);
+
+  // Handles the payload of a kSetCompressionType record. Reports a drop if
+  // the record is malformed, repeated or names an unsupported compression
+  // type.
+  void InitCompression(const Slice& record);
+
+  // If the log is compressed, replaces *record by its uncompressed contents
+  // (owned by uncompressed_record_). Returns false and reports a corruption
+  // if the record cannot be uncompressed.
+  bool MaybeUncompressRecord(Slice* record);
 };
 
 class FragmentBufferedReader : public Reader {
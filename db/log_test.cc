@@ -15,6 +15,7 @@
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/random.h"
 
@@ -892,6 +893,146 @@ TEST_P(RetriableLogTest, NonBlockingReadFullRecord) {
 
 INSTANTIATE_TEST_CASE_P(bool, RetriableLogTest, ::testing::Values(0, 2));
 
+// Param type is tuple<CompressionType, bool>
+// get<0>(tuple): WAL compression type
+// get<1>(tuple): true to read with FragmentBufferedReader
+class CompressionLogTest
+    : public ::testing::TestWithParam<std::tuple<CompressionType, bool>> {
+ protected:
+  class ReportCollector : public Reader::Reporter {
+   public:
+    size_t dropped_bytes_ = 0;
+    std::string message_;
+
+    void Corruption(size_t bytes, const Status& status) override {
+      dropped_bytes_ += bytes;
+      message_.append(status.ToString());
+    }
+  };
+
+  CompressionLogTest()
+      : fs_(Env::Default()->GetFileSystem()),
+        test_dir_(test::PerThreadDBPath("compression_log_test")),
+        log_file_(test_dir_ + "/log") {}
+
+  CompressionType compression_type() const { return std::get<0>(GetParam()); }
+
+  bool Supported() const {
+    return StreamingCompressionTypeSupported(compression_type());
+  }
+
+  // Writes `records` to a new log and returns the log file size.
+  uint64_t WriteLog(const std::vector<std::string>& records,
+                    CompressionType type) {
+    EXPECT_OK(fs_->CreateDirIfMissing(test_dir_, IOOptions(), nullptr));
+    std::unique_ptr<FSWritableFile> file;
+    EXPECT_OK(fs_->NewWritableFile(log_file_, FileOptions(), &file, nullptr));
+    std::unique_ptr<WritableFileWriter> file_writer(
+        new WritableFileWriter(std::move(file), log_file_, FileOptions()));
+    Writer writer(std::move(file_writer), 123, false /* recycle_log_files */,
+                  false /* manual_flush */, type);
+    EXPECT_OK(writer.AddCompressionTypeRecord());
+    for (const auto& record : records) {
+      EXPECT_OK(writer.AddRecord(record));
+    }
+    uint64_t size = writer.file()->GetFileSize();
+    EXPECT_OK(writer.Close());
+    return size;
+  }
+
+  std::unique_ptr<Reader> NewReader() {
+    std::unique_ptr<FSSequentialFile> file;
+    EXPECT_OK(
+        fs_->NewSequentialFile(log_file_, FileOptions(), &file, nullptr));
+    std::unique_ptr<SequentialFileReader> file_reader(
+        new SequentialFileReader(std::move(file), log_file_));
+    if (std::get<1>(GetParam())) {
+      return std::unique_ptr<Reader>(new FragmentBufferedReader(
+          nullptr, std::move(file_reader), &report_, true /* checksum */,
+          123 /* log_number */));
+    }
+    return std::unique_ptr<Reader>(new Reader(nullptr, std::move(file_reader),
+                                              &report_, true /* checksum */,
+                                              123 /* log_number */));
+  }
+
+  std::shared_ptr<FileSystem> fs_;
+  const std::string test_dir_;
+  const std::string log_file_;
+  ReportCollector report_;
+};
+
+TEST_P(CompressionLogTest, ReadWrite) {
+  if (!Supported()) {
+    ROCKSDB_GTEST_SKIP("WAL compression type not supported");
+    return;
+  }
+  Random rnd(301);
+  std::vector<std::string> records;
+  records.push_back("foo");
+  records.push_back("");
+  // Larger than a block, and highly compressible
+  records.push_back(BigString("bar", 3 * kBlockSize + 17));
+  for (int i = 0; i < 1000; i++) {
+    records.push_back(RandomSkewedString(i, &rnd));
+  }
+  // Incompressible records expand, and still span several blocks
+  records.push_back(rnd.RandomString(2 * kBlockSize));
+  records.push_back("baz");
+
+  uint64_t compressed_size = WriteLog(records, compression_type());
+  std::unique_ptr<Reader> reader = NewReader();
+  std::string scratch;
+  Slice record;
+  for (const auto& expected : records) {
+    ASSERT_TRUE(reader->ReadRecord(&record, &scratch));
+    ASSERT_EQ(expected, record.ToString());
+  }
+  ASSERT_FALSE(reader->ReadRecord(&record, &scratch));
+  ASSERT_EQ(compression_type(), reader->GetCompressionType());
+  ASSERT_EQ(0, report_.dropped_bytes_);
+  ASSERT_EQ("", report_.message_);
+
+  uint64_t uncompressed_size = WriteLog(records, kNoCompression);
+  ASSERT_LT(compressed_size, uncompressed_size);
+}
+
+TEST_P(CompressionLogTest, UnknownCompressionType) {
+  std::vector<std::string> records = {"foo", "bar"};
+  WriteLog(records, kNoCompression);
+
+  // Rewrite the log with a kSetCompressionType record naming a compression
+  // type that has no streaming support.
+  EXPECT_OK(fs_->CreateDirIfMissing(test_dir_, IOOptions(), nullptr));
+  std::unique_ptr<FSWritableFile> file;
+  ASSERT_OK(fs_->NewWritableFile(log_file_, FileOptions(), &file, nullptr));
+  std::unique_ptr<WritableFileWriter> file_writer(
+      new WritableFileWriter(std::move(file), log_file_, FileOptions()));
+  std::string payload;
+  PutFixed32(&payload, static_cast<uint32_t>(kBZip2Compression));
+  std::string header(kHeaderSize, '\0');
+  header[4] = static_cast<char>(payload.size() & 0xff);
+  header[5] = static_cast<char>(payload.size() >> 8);
+  header[6] = static_cast<char>(kSetCompressionType);
+  uint32_t crc = crc32c::Value(&header[6], 1);
+  crc = crc32c::Extend(crc, payload.data(), payload.size());
+  EncodeFixed32(&header[0], crc32c::Mask(crc));
+  ASSERT_OK(file_writer->Append(header));
+  ASSERT_OK(file_writer->Append(payload));
+  ASSERT_OK(file_writer->Close());
+
+  std::unique_ptr<Reader> reader = NewReader();
+  std::string scratch;
+  Slice record;
+  ASSERT_FALSE(reader->ReadRecord(&record, &scratch));
+  ASSERT_NE(std::string::npos, report_.message_.find("Not implemented"));
+}
+
+INSTANTIATE_TEST_CASE_P(
+    CompressionLogTest, CompressionLogTest,
+    ::testing::Combine(::testing::Values(kZlibCompression, kZSTD),
+                       ::testing::Bool()));
+
 }  // namespace log
 }  // namespace ROCKSDB_NAMESPACE
 
@@ -11,20 +11,29 @@
 
 #include <stdint.h>
 #include "file/writable_file_writer.h"
+#include "monitoring/statistics.h"
 #include "rocksdb/env.h"
+#include "rocksdb/system_clock.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
+#include "util/stop_watch.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace log {
 
 Writer::Writer(std::unique_ptr<WritableFileWriter>&& dest, uint64_t log_number,
-               bool recycle_log_files, bool manual_flush)
+               bool recycle_log_files, bool manual_flush,
+               CompressionType compression_type, Statistics* stats,
+               SystemClock* clock)
     : dest_(std::move(dest)),
       block_offset_(0),
       log_number_(log_number),
       recycle_log_files_(recycle_log_files),
-      manual_flush_(manual_flush) {
+      manual_flush_(manual_flush),
+      compression_type_(compression_type),
+      stats_(stats),
+      clock_(clock) {
   for (int i = 0; i <= kMaxRecordType; i++) {
     char t = static_cast<char>(i);
     type_crc_[i] = crc32c::Value(&t, 1);
@@ -52,6 +61,27 @@ IOStatus Writer::AddRecord(const Slice& slice) {
   const char* ptr = slice.data();
   size_t left = slice.size();
 
+  if (compress_) {
+    compressed_buffer_.clear();
+    StopWatchNano timer(clock_, stats_ != nullptr && clock_ != nullptr);
+    if (!compress_->Compress(slice, &compressed_buffer_)) {
+      IOStatus s = IOStatus::IOError("Failed to compress WAL record");
+      s.SetDataLoss(true);
+      return s;
+    }
+    if (stats_ != nullptr) {
+      if (clock_ != nullptr) {
+        RecordTimeToHistogram(stats_, WAL_COMPRESSION_TIMES_NANOS,
+                              timer.ElapsedNanos());
+      }
+      RecordTick(stats_, WAL_COMPRESSION_INPUT_BYTES, slice.size());
+      RecordTick(stats_, WAL_COMPRESSION_OUTPUT_BYTES,
+                 compressed_buffer_.size());
+    }
+    ptr = compressed_buffer_.data();
+    left = compressed_buffer_.size();
+  }
+
   // Header size varies depending on whether we are recycling or not.
   const int header_size =
       recycle_log_files_ ? kRecyclableHeaderSize : kHeaderSize;
@@ -112,6 +142,31 @@ IOStatus Writer::AddRecord(const Slice& slice) {
   return s;
 }
 
+IOStatus Writer::AddCompressionTypeRecord() {
+  // Should be the first record
+  assert(block_offset_ == 0);
+  assert(!compress_);
+  if (compression_type_ == kNoCompression) {
+    return IOStatus::OK();
+  }
+  compress_ = StreamingCompress::Create(compression_type_, CompressionOptions());
+  if (!compress_) {
+    return IOStatus::NotSupported("WAL compression type not supported");
+  }
+
+  std::string encoded;
+  PutFixed32(&encoded, static_cast<uint32_t>(compression_type_));
+  IOStatus s =
+      EmitPhysicalRecord(kSetCompressionType, encoded.data(), encoded.size());
+  if (s.ok() && !manual_flush_) {
+    s = dest_->Flush();
+  }
+  if (!s.ok()) {
+    compress_.reset();
+  }
+  return s;
+}
+
 bool Writer::TEST_BufferIsEmpty() { return dest_->TEST_BufferIsEmpty(); }
 
 IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
@@ -126,7 +181,7 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   buf[6] = static_cast<char>(t);
 
   uint32_t crc = type_crc_[t];
-  if (t < kRecyclableFullType) {
+  if (t < kRecyclableFullType || t == kSetCompressionType) {
     // Legacy record format
     assert(block_offset_ + kHeaderSize + n <= kBlockSize);
     header_size = kHeaderSize;
@@ -10,14 +10,19 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include "db/log_format.h"
+#include "rocksdb/compression_type.h"
 #include "rocksdb/io_status.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class Statistics;
+class StreamingCompress;
+class SystemClock;
 class WritableFileWriter;
 
 namespace log {
@@ -64,15 +69,31 @@ namespace log {
  * Same as above, with the addition of
  * Log number = 32bit log file number, so that we can distinguish between
  * records written by the most recent log writer vs a previous one.
+ *
+ * Compressed logs:
+ *
+ * A log written with a compression type starts with a kSetCompressionType
+ * record holding the compression type (fixed32). The payload of every
+ * following logical record is compressed with one streaming compression
+ * context shared by the whole file, and then fragmented as usual. Readers
+ * that do not know kSetCompressionType report a corruption instead of
+ * misinterpreting the compressed records.
  */
 class Writer {
  public:
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
+  //
+  // If "compression_type" is not kNoCompression, the writer starts the log
+  // with a kSetCompressionType record and compresses subsequent records.
+  // Compression statistics are reported to "stats" if it is non-nullptr,
+  // timed with "clock".
   explicit Writer(std::unique_ptr<WritableFileWriter>&& dest,
                   uint64_t log_number, bool recycle_log_files,
-                  bool manual_flush = false);
+                  bool manual_flush = false,
+                  CompressionType compression_type = kNoCompression,
+                  Statistics* stats = nullptr, SystemClock* clock = nullptr);
   // No copying allowed
   Writer(const Writer&) = delete;
   void operator=(const Writer&) = delete;
@@ -81,6 +102,13 @@ class Writer {
 
   IOStatus AddRecord(const Slice& slice);
 
+  // Writes the kSetCompressionType record and enables compression for all
+  // records added afterwards. Must be called before the first AddRecord().
+  // A no-op if the writer was created with kNoCompression.
+  IOStatus AddCompressionTypeRecord();
+
+  CompressionType GetCompressionType() const { return compression_type_; }
+
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
 
@@ -108,6 +136,14 @@ class Writer {
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
   bool manual_flush_;
+
+  // Compression of the record payloads. compress_ is only set once the
+  // kSetCompressionType record has been written.
+  CompressionType compression_type_;
+  std::unique_ptr<StreamingCompress> compress_;
+  std::string compressed_buffer_;
+  Statistics* stats_;
+  SystemClock* clock_;
 };
 
 }  // namespace log
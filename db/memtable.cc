@@ -15,6 +15,7 @@
 #include <memory>
 
 #include "db/dbformat.h"
+#include "db/hot_key_cache.h"
 #include "db/kv_checksum.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
@@ -42,6 +43,25 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// The value length of an entry whose value is stored out of line. It is
+// followed by the actual value length and a pointer to the value.
+const uint32_t kOutOfLineValueLength = port::kMaxUint32;
+
+// Returns the value of the entry whose value length starts at `p`
+inline Slice GetEntryValue(const char* p) {
+  uint32_t len = 0;
+  p = GetVarint32Ptr(p, p + 5, &len);
+  if (UNLIKELY(len == kOutOfLineValueLength)) {
+    p = GetVarint32Ptr(p, p + 5, &len);
+    const char* data;
+    memcpy(&data, p, sizeof(data));
+    return Slice(data, len);
+  }
+  return Slice(p, len);
+}
+}  // namespace
+
 ImmutableMemTableOptions::ImmutableMemTableOptions(
     const ImmutableOptions& ioptions,
     const MutableCFOptions& mutable_cf_options)
@@ -58,7 +78,13 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       inplace_callback(ioptions.inplace_callback),
       max_successive_merges(mutable_cf_options.max_successive_merges),
+      // Values updated in-place must stay in their entries
+      large_value_threshold(ioptions.inplace_update_support
+                                ? 0
+                                : mutable_cf_options
+                                      .memtable_large_value_threshold),
       statistics(ioptions.stats),
+      cf_statistics(ioptions.cf_statistics.get()),
       merge_operator(ioptions.merge_operator.get()),
       info_log(ioptions.logger),
       allow_data_in_errors(ioptions.allow_data_in_errors) {}
@@ -79,7 +105,24 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                write_buffer_manager->cost_to_cache()))
                  ? &mem_tracker_
                  : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
+             mutable_cf_options.memtable_huge_page_size,
+             write_buffer_manager != nullptr
+                 ? write_buffer_manager->arena_block_pool()
+                 : nullptr),
+      large_value_arena_(
+          moptions_.large_value_threshold == 0
+              ? nullptr
+              : new ConcurrentArena(
+                    moptions_.arena_block_size,
+                    (write_buffer_manager != nullptr &&
+                     (write_buffer_manager->enabled() ||
+                      write_buffer_manager->cost_to_cache()))
+                        ? &mem_tracker_
+                        : nullptr,
+                    mutable_cf_options.memtable_huge_page_size,
+                    write_buffer_manager != nullptr
+                        ? write_buffer_manager->arena_block_pool()
+                        : nullptr)),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
           ioptions.logger, column_family_id)),
@@ -87,6 +130,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
           comparator_, &arena_, nullptr /* transform */, ioptions.logger,
           column_family_id)),
       is_range_del_table_empty_(true),
+      newest_range_del_(nullptr),
       data_size_(0),
       num_entries_(0),
       num_deletes_(0),
@@ -102,18 +146,38 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       locks_(moptions_.inplace_update_support
                  ? moptions_.inplace_update_num_locks
                  : 0),
+      concurrent_inplace_updates_(locks_.size()),
       prefix_extractor_(mutable_cf_options.prefix_extractor.get()),
       flush_state_(FLUSH_NOT_REQUESTED),
       clock_(ioptions.clock),
       insert_with_hint_prefix_extractor_(
           ioptions.memtable_insert_with_hint_prefix_extractor.get()),
       oldest_key_time_(std::numeric_limits<uint64_t>::max()),
+      // The cache relies on writes being tracked before their sequence
+      // numbers are published, and on values not changing in place.
+      hot_key_cache_slots_(
+          mutable_cf_options.memtable_hot_key_cache_size == 0 ||
+                  cmp.user_comparator()->timestamp_size() > 0 ||
+                  moptions_.inplace_update_support ||
+                  ioptions.unordered_write || ioptions.two_write_queues
+              ? 0
+              : HotKeyCache::NumSlots(
+                    mutable_cf_options.memtable_hot_key_cache_size)),
+      hot_key_range_del_seq_(0),
       atomic_flush_seqno_(kMaxSequenceNumber),
       approximate_memory_usage_(0) {
   UpdateFlushState();
   // something went wrong if we need to flush before inserting anything
   assert(!ShouldScheduleFlush());
 
+  if (hot_key_cache_slots_ > 0) {
+    hot_key_write_seqs_.reset(
+        new std::atomic<SequenceNumber>[hot_key_cache_slots_]);
+    for (size_t i = 0; i < hot_key_cache_slots_; i++) {
+      hot_key_write_seqs_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
   // use bloom_filter_ for both whole key and prefix bloom filter
   if ((prefix_extractor_ || moptions_.memtable_whole_key_filtering) &&
       moptions_.memtable_prefix_bloom_bits > 0) {
@@ -133,7 +197,8 @@ size_t MemTable::ApproximateMemoryUsage() {
   autovector<size_t> usages = {
       arena_.ApproximateMemoryUsage(), table_->ApproximateMemoryUsage(),
       range_del_table_->ApproximateMemoryUsage(),
-      ROCKSDB_NAMESPACE::ApproximateMemoryUsage(insert_hints_)};
+      ROCKSDB_NAMESPACE::ApproximateMemoryUsage(insert_hints_),
+      large_value_arena_ ? large_value_arena_->ApproximateMemoryUsage() : 0};
   size_t total_usage = 0;
   for (size_t usage : usages) {
     // If usage + total_usage >= kMaxSizet, return kMaxSizet.
@@ -163,6 +228,9 @@ bool MemTable::ShouldFlushNow() {
   auto allocated_memory = table_->ApproximateMemoryUsage() +
                           range_del_table_->ApproximateMemoryUsage() +
                           arena_.MemoryAllocatedBytes();
+  if (large_value_arena_) {
+    allocated_memory += large_value_arena_->MemoryAllocatedBytes();
+  }
 
   approximate_memory_usage_.store(allocated_memory, std::memory_order_relaxed);
 
@@ -281,7 +349,7 @@ const char* EncodeKey(std::string* scratch, const Slice& target) {
 class MemTableIterator : public InternalIterator {
  public:
   MemTableIterator(const MemTable& mem, const ReadOptions& read_options,
-                   Arena* arena, bool use_range_del_table = false)
+                   Arena* arena)
       : bloom_(nullptr),
         prefix_extractor_(mem.prefix_extractor_),
         comparator_(mem.comparator_),
@@ -289,10 +357,8 @@ class MemTableIterator : public InternalIterator {
         arena_mode_(arena != nullptr),
         value_pinned_(
             !mem.GetImmutableMemTableOptions()->inplace_update_support) {
-    if (use_range_del_table) {
-      iter_ = mem.range_del_table_->GetIterator(arena);
-    } else if (prefix_extractor_ != nullptr && !read_options.total_order_seek &&
-               !read_options.auto_prefix_mode) {
+    if (prefix_extractor_ != nullptr && !read_options.total_order_seek &&
+        !read_options.auto_prefix_mode) {
       // Auto prefix mode is not implemented in memtable yet.
       bloom_ = mem.bloom_filter_.get();
       iter_ = mem.table_->GetDynamicPrefixIterator(arena);
@@ -408,7 +474,7 @@ class MemTableIterator : public InternalIterator {
   Slice value() const override {
     assert(Valid());
     Slice key_slice = GetLengthPrefixedSlice(iter_->key());
-    return GetLengthPrefixedSlice(key_slice.data() + key_slice.size());
+    return GetEntryValue(key_slice.data() + key_slice.size());
   }
 
   Status status() const override { return Status::OK(); }
@@ -440,29 +506,214 @@ InternalIterator* MemTable::NewIterator(const ReadOptions& read_options,
   return new (mem) MemTableIterator(*this, read_options, arena);
 }
 
+namespace {
+// Iterates over range_del_table_ entries sorted by MemTable::KeyComparator.
+class RangeDelEntryIterator : public InternalIterator {
+ public:
+  RangeDelEntryIterator(const std::vector<const char*>* entries,
+                        const MemTable::KeyComparator& comparator)
+      : entries_(entries), comparator_(comparator), pos_(entries->size()) {}
+
+  bool Valid() const override { return pos_ < entries_->size(); }
+  void SeekToFirst() override { pos_ = 0; }
+  void SeekToLast() override {
+    pos_ = entries_->empty() ? 0 : entries_->size() - 1;
+  }
+  void Seek(const Slice& target) override {
+    pos_ = std::lower_bound(entries_->begin(), entries_->end(), target,
+                            [this](const char* entry, const Slice& key) {
+                              return comparator_(entry, key) < 0;
+                            }) -
+           entries_->begin();
+  }
+  void SeekForPrev(const Slice& target) override {
+    size_t end = std::upper_bound(entries_->begin(), entries_->end(), target,
+                                  [this](const Slice& key, const char* entry) {
+                                    return comparator_(entry, key) > 0;
+                                  }) -
+                 entries_->begin();
+    pos_ = end == 0 ? entries_->size() : end - 1;
+  }
+  void Next() override {
+    assert(Valid());
+    pos_++;
+  }
+  void Prev() override {
+    assert(Valid());
+    pos_ = pos_ == 0 ? entries_->size() : pos_ - 1;
+  }
+  Slice key() const override {
+    assert(Valid());
+    return GetLengthPrefixedSlice((*entries_)[pos_]);
+  }
+  Slice value() const override {
+    Slice key_slice = key();
+    return GetLengthPrefixedSlice(key_slice.data() + key_slice.size());
+  }
+  Status status() const override { return Status::OK(); }
+  bool IsKeyPinned() const override { return true; }
+  bool IsValuePinned() const override { return true; }
+
+ private:
+  const std::vector<const char*>* entries_;
+  const MemTable::KeyComparator& comparator_;
+  size_t pos_;
+};
+}  // namespace
+
+MemTable::RangeTombstoneRun::RangeTombstoneRun(
+    std::vector<const char*>&& _entries, const KeyComparator& cmp)
+    : entries(std::move(_entries)),
+      list(std::unique_ptr<InternalIterator>(
+               new RangeDelEntryIterator(&entries, cmp)),
+           cmp.comparator) {}
+
 FragmentedRangeTombstoneIterator* MemTable::NewRangeTombstoneIterator(
     const ReadOptions& read_options, SequenceNumber read_seq) {
   if (read_options.ignore_range_deletions ||
       is_range_del_table_empty_.load(std::memory_order_relaxed)) {
     return nullptr;
   }
-  auto* unfragmented_iter = new MemTableIterator(
-      *this, read_options, nullptr /* arena */, true /* use_range_del_table */);
-  if (unfragmented_iter == nullptr) {
+  const RangeDelEntry* newest;
+  std::shared_ptr<const RangeTombstoneIndex> index =
+      GetRangeTombstoneIndex(&newest, true /* merge_all */);
+  if (index == nullptr || index->runs.empty()) {
     return nullptr;
   }
-  auto fragmented_tombstone_list =
-      std::make_shared<FragmentedRangeTombstoneList>(
-          std::unique_ptr<InternalIterator>(unfragmented_iter),
-          comparator_.comparator);
-
+  assert(index->runs.size() == 1);
+  // Shares the ownership of the run.
+  std::shared_ptr<const FragmentedRangeTombstoneList> fragmented_list(
+      index->runs[0], &index->runs[0]->list);
   auto* fragmented_iter = new FragmentedRangeTombstoneIterator(
-      fragmented_tombstone_list, comparator_.comparator, read_seq);
+      fragmented_list, comparator_.comparator, read_seq);
   return fragmented_iter;
 }
 
+void MemTable::ConstructFragmentedRangeTombstones() {
+  if (!is_range_del_table_empty_.load(std::memory_order_relaxed)) {
+    const RangeDelEntry* newest;
+    GetRangeTombstoneIndex(&newest, true /* merge_all */);
+  }
+}
+
+SequenceNumber MemTable::MaxCoveringTombstoneSeqnum(const Slice& user_key,
+                                                    SequenceNumber read_seq) {
+  const RangeDelEntry* newest;
+  std::shared_ptr<const RangeTombstoneIndex> index =
+      GetRangeTombstoneIndex(&newest);
+  return MaxCoveringTombstoneSeqnum(index.get(), newest, user_key, read_seq);
+}
+
+SequenceNumber MemTable::MaxCoveringTombstoneSeqnum(
+    const RangeTombstoneIndex* index, const RangeDelEntry* newest,
+    const Slice& user_key, SequenceNumber read_seq) const {
+  const Comparator* ucmp = comparator_.comparator.user_comparator();
+  uint64_t num_indexed = index == nullptr || index->newest == nullptr
+                             ? 0
+                             : index->newest->num_range_deletes;
+  SequenceNumber max_seq = 0;
+  for (const RangeDelEntry* e = newest;
+       e != nullptr && e->num_range_deletes > num_indexed; e = e->prev) {
+    Slice start_key = GetLengthPrefixedSlice(e->entry);
+    SequenceNumber seq = GetInternalKeySeqno(start_key);
+    if (seq <= max_seq || seq > read_seq) {
+      continue;
+    }
+    Slice end_key = GetLengthPrefixedSlice(start_key.data() + start_key.size());
+    if (ucmp->Compare(ExtractUserKey(start_key), user_key) <= 0 &&
+        ucmp->Compare(user_key, end_key) < 0) {
+      max_seq = seq;
+    }
+  }
+  if (index != nullptr) {
+    for (const auto& run : index->runs) {
+      FragmentedRangeTombstoneIterator iter(&run->list, comparator_.comparator,
+                                            read_seq);
+      max_seq = std::max(max_seq, iter.MaxCoveringTombstoneSeqnum(user_key));
+    }
+  }
+  return max_seq;
+}
+
+std::shared_ptr<const MemTable::RangeTombstoneIndex>
+MemTable::GetRangeTombstoneIndex(const RangeDelEntry** newest,
+                                 bool merge_all) {
+  // Every range deletion up to this one is in range_del_table_. Newer ones
+  // may be in the index too, which readers skip by sequence number.
+  *newest = newest_range_del_.load(std::memory_order_acquire);
+  std::shared_ptr<const RangeTombstoneIndex> index;
+  {
+    std::lock_guard<SpinMutex> l(range_tombstone_index_mutex_);
+    index = range_tombstone_index_;
+  }
+  uint64_t num_range_deletes =
+      *newest == nullptr ? 0 : (*newest)->num_range_deletes;
+  uint64_t num_indexed = index == nullptr || index->newest == nullptr
+                             ? 0
+                             : index->newest->num_range_deletes;
+  size_t num_runs = index == nullptr ? 0 : index->runs.size();
+  if (merge_all ? num_indexed >= num_range_deletes && num_runs <= 1
+                : num_indexed + kMaxUnindexedRangeDeletes >= num_range_deletes) {
+    return index;
+  }
+
+  // Concurrent readers may both index the same range deletions; the index
+  // holding the most of them is kept.
+  auto less = [this](const char* a, const char* b) {
+    return comparator_(a, b) < 0;
+  };
+  std::vector<const char*> entries;
+  for (const RangeDelEntry* e = *newest;
+       e != nullptr && e->num_range_deletes > num_indexed; e = e->prev) {
+    entries.push_back(e->entry);
+  }
+  std::sort(entries.begin(), entries.end(), less);
+  auto new_index = std::make_shared<RangeTombstoneIndex>();
+  new_index->newest = num_indexed >= num_range_deletes ? index->newest : *newest;
+  if (index != nullptr) {
+    new_index->runs = index->runs;
+  }
+  while (!new_index->runs.empty() &&
+         (merge_all ? new_index->runs.size() + !entries.empty() > 1
+                    : new_index->runs.back()->entries.size() <=
+                          entries.size())) {
+    const std::vector<const char*>& run = new_index->runs.back()->entries;
+    std::vector<const char*> merged;
+    merged.reserve(run.size() + entries.size());
+    std::merge(run.begin(), run.end(), entries.begin(), entries.end(),
+               std::back_inserter(merged), less);
+    entries = std::move(merged);
+    new_index->runs.pop_back();
+  }
+  if (!entries.empty()) {
+    new_index->runs.push_back(std::make_shared<const RangeTombstoneRun>(
+        std::move(entries), comparator_));
+  }
+  uint64_t num_newly_indexed = new_index->newest == nullptr
+                                   ? 0
+                                   : new_index->newest->num_range_deletes;
+  {
+    std::lock_guard<SpinMutex> l(range_tombstone_index_mutex_);
+    const RangeTombstoneIndex* current = range_tombstone_index_.get();
+    uint64_t num_currently_indexed =
+        current == nullptr || current->newest == nullptr
+            ? 0
+            : current->newest->num_range_deletes;
+    if (current == nullptr || num_currently_indexed < num_newly_indexed ||
+        (num_currently_indexed == num_newly_indexed &&
+         current->runs.size() > new_index->runs.size())) {
+      range_tombstone_index_ = new_index;
+    }
+  }
+  return new_index;
+}
+
 port::RWMutex* MemTable::GetLock(const Slice& key) {
-  return &locks_[GetSliceRangedNPHash(key, locks_.size())];
+  return &locks_[GetLockIndex(key)];
+}
+
+size_t MemTable::GetLockIndex(const Slice& key) const {
+  return GetSliceRangedNPHash(key, locks_.size());
 }
 
 MemTable::MemTableStats MemTable::ApproximateStats(const Slice& start_ikey,
@@ -516,6 +767,17 @@ Status MemTable::VerifyEncodedEntry(Slice encoded,
   if (!GetVarint32(&encoded, &value_len)) {
     return Status::Corruption("Unable to parse value length");
   }
+  if (value_len == kOutOfLineValueLength) {
+    if (!GetVarint32(&encoded, &value_len)) {
+      return Status::Corruption("Unable to parse value length");
+    }
+    if (encoded.size() != sizeof(const char*)) {
+      return Status::Corruption("Invalid out-of-line value");
+    }
+    const char* data;
+    memcpy(&data, encoded.data(), sizeof(data));
+    encoded = Slice(data, value_len);
+  }
   if (value_len < encoded.size()) {
     return Status::Corruption("Value length too short");
   }
@@ -540,12 +802,24 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   //  key bytes    : char[internal_key.size()]
   //  value_size   : varint32 of value.size()
   //  value bytes  : char[value.size()]
+  // or, for a value stored out of line:
+  //  marker       : varint32 of kOutOfLineValueLength
+  //  value_size   : varint32 of value.size()
+  //  value ptr    : const char*
   uint32_t key_size = static_cast<uint32_t>(key.size());
   uint32_t val_size = static_cast<uint32_t>(value.size());
   uint32_t internal_key_size = key_size + 8;
-  const uint32_t encoded_len = VarintLength(internal_key_size) +
-                               internal_key_size + VarintLength(val_size) +
-                               val_size;
+  // kOutOfLineValueLength itself must not be an inline value length
+  const bool out_of_line =
+      type != kTypeRangeDeletion &&
+      ((large_value_arena_ && val_size >= moptions_.large_value_threshold) ||
+       val_size == kOutOfLineValueLength);
+  const uint32_t encoded_len =
+      VarintLength(internal_key_size) + internal_key_size +
+      (out_of_line ? VarintLength(kOutOfLineValueLength) +
+                         VarintLength(val_size) +
+                         static_cast<uint32_t>(sizeof(const char*))
+                   : VarintLength(val_size) + val_size);
   char* buf = nullptr;
   std::unique_ptr<MemTableRep>& table =
       type == kTypeRangeDeletion ? range_del_table_ : table_;
@@ -558,9 +832,22 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   uint64_t packed = PackSequenceAndType(s, type);
   EncodeFixed64(p, packed);
   p += 8;
-  p = EncodeVarint32(p, val_size);
-  memcpy(p, value.data(), val_size);
-  assert((unsigned)(p + val_size - buf) == (unsigned)encoded_len);
+  if (out_of_line) {
+    char* data = large_value_arena_ ? large_value_arena_->Allocate(val_size)
+                                    : arena_.Allocate(val_size);
+    memcpy(data, value.data(), val_size);
+    p = EncodeVarint32(p, kOutOfLineValueLength);
+    p = EncodeVarint32(p, val_size);
+    memcpy(p, &data, sizeof(data));
+    assert((unsigned)(p + sizeof(data) - buf) == (unsigned)encoded_len);
+  } else {
+    p = EncodeVarint32(p, val_size);
+    memcpy(p, value.data(), val_size);
+    assert((unsigned)(p + val_size - buf) == (unsigned)encoded_len);
+  }
+  // Includes out-of-line values
+  const uint64_t data_len =
+      out_of_line ? uint64_t{encoded_len} + val_size : encoded_len;
   if (kv_prot_info != nullptr) {
     Slice encoded(buf, encoded_len);
     TEST_SYNC_POINT_CALLBACK("MemTable::Add:Encoded", &encoded);
@@ -573,6 +860,24 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   size_t ts_sz = GetInternalKeyComparator().user_comparator()->timestamp_size();
   Slice key_without_ts = StripTimestampFromUserKey(key, ts_sz);
 
+  // Hash for the bloom filter ahead of the insertion, so that the cache lines
+  // to set bits in are fetched in the meantime.
+  bool bloom_add_prefix = false;
+  uint32_t bloom_prefix_hash = 0;
+  uint32_t bloom_key_hash = 0;
+  if (bloom_filter_) {
+    if (prefix_extractor_ && prefix_extractor_->InDomain(key_without_ts)) {
+      bloom_add_prefix = true;
+      bloom_prefix_hash =
+          BloomHash(prefix_extractor_->Transform(key_without_ts));
+      bloom_filter_->Prefetch(bloom_prefix_hash);
+    }
+    if (moptions_.memtable_whole_key_filtering) {
+      bloom_key_hash = BloomHash(key_without_ts);
+      bloom_filter_->Prefetch(bloom_key_hash);
+    }
+  }
+
   if (!allow_concurrent) {
     // Extract prefix for insert with hint.
     if (insert_with_hint_prefix_extractor_ != nullptr &&
@@ -593,19 +898,18 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
     // when incrementing an atomic
     num_entries_.store(num_entries_.load(std::memory_order_relaxed) + 1,
                        std::memory_order_relaxed);
-    data_size_.store(data_size_.load(std::memory_order_relaxed) + encoded_len,
+    data_size_.store(data_size_.load(std::memory_order_relaxed) + data_len,
                      std::memory_order_relaxed);
     if (type == kTypeDeletion) {
       num_deletes_.store(num_deletes_.load(std::memory_order_relaxed) + 1,
                          std::memory_order_relaxed);
     }
 
-    if (bloom_filter_ && prefix_extractor_ &&
-        prefix_extractor_->InDomain(key_without_ts)) {
-      bloom_filter_->Add(prefix_extractor_->Transform(key_without_ts));
+    if (bloom_add_prefix) {
+      bloom_filter_->AddHash(bloom_prefix_hash);
     }
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
-      bloom_filter_->Add(key_without_ts);
+      bloom_filter_->AddHash(bloom_key_hash);
     }
 
     // The first sequence number inserted into the memtable
@@ -631,18 +935,16 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
 
     assert(post_process_info != nullptr);
     post_process_info->num_entries++;
-    post_process_info->data_size += encoded_len;
+    post_process_info->data_size += data_len;
     if (type == kTypeDeletion) {
       post_process_info->num_deletes++;
     }
 
-    if (bloom_filter_ && prefix_extractor_ &&
-        prefix_extractor_->InDomain(key_without_ts)) {
-      bloom_filter_->AddConcurrently(
-          prefix_extractor_->Transform(key_without_ts));
+    if (bloom_add_prefix) {
+      bloom_filter_->AddHashConcurrently(bloom_prefix_hash);
     }
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
-      bloom_filter_->AddConcurrently(key_without_ts);
+      bloom_filter_->AddHashConcurrently(bloom_key_hash);
     }
 
     // atomically update first_seqno_ and earliest_seqno_.
@@ -657,7 +959,34 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
         !first_seqno_.compare_exchange_weak(cur_earliest_seqno, s)) {
     }
   }
+  // DB-wide, these are recorded per write batch
+  RecordTick(moptions_.cf_statistics, NUMBER_KEYS_WRITTEN);
+  RecordTick(moptions_.cf_statistics, BYTES_WRITTEN, key_size + val_size);
+  if (hot_key_cache_slots_ > 0) {
+    std::atomic<SequenceNumber>& write_seq =
+        type == kTypeRangeDeletion
+            ? hot_key_range_del_seq_
+            : hot_key_write_seqs_[HotKeyCache::Hash(key) &
+                                  (hot_key_cache_slots_ - 1)];
+    SequenceNumber cur_write_seq = write_seq.load(std::memory_order_relaxed);
+    while (cur_write_seq < s &&
+           !write_seq.compare_exchange_weak(cur_write_seq, s,
+                                            std::memory_order_relaxed)) {
+    }
+  }
   if (type == kTypeRangeDeletion) {
+    auto* range_del = reinterpret_cast<RangeDelEntry*>(
+        arena_.AllocateAligned(sizeof(RangeDelEntry)));
+    range_del->entry = buf;
+    const RangeDelEntry* prev =
+        newest_range_del_.load(std::memory_order_relaxed);
+    do {
+      range_del->prev = prev;
+      range_del->num_range_deletes =
+          prev == nullptr ? 1 : prev->num_range_deletes + 1;
+    } while (!newest_range_del_.compare_exchange_weak(
+        prev, range_del, std::memory_order_release,
+        std::memory_order_relaxed));
     is_range_del_table_empty_.store(false, std::memory_order_relaxed);
   }
   UpdateOldestKeyTime();
@@ -689,6 +1018,10 @@ struct Saver {
   ReadCallback* callback_;
   bool* is_blob_index;
   bool allow_data_in_errors;
+  // Non-null if a found value may be pinned in `pinnable_value` rather than
+  // copied into `value`.
+  PinnableSlice* pinnable_value;
+  MemTableValuePinner* pinner;
   bool CheckCallback(SequenceNumber _seq) {
     if (callback_) {
       return callback_->IsVisible(_seq);
@@ -761,7 +1094,7 @@ static bool SaveValue(void* arg, const char* entry) {
         if (s->inplace_update_support) {
           s->mem->GetLock(s->key->user_key())->ReadLock();
         }
-        Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
+        Slice v = GetEntryValue(key_ptr + key_length);
         *(s->status) = Status::OK();
         if (*(s->merge_in_progress)) {
           if (s->do_merge) {
@@ -782,6 +1115,12 @@ static bool SaveValue(void* arg, const char* entry) {
           // raw merge operands to the user
           merge_context->PushOperand(
               v, s->inplace_update_support == false /* operand_pinned */);
+        } else if (s->pinner != nullptr && type == kTypeValue &&
+                   v.size() >= s->pinner->min_value_size()) {
+          // The arena outlives the pin, and without in-place updates the
+          // value is never modified.
+          assert(!s->inplace_update_support);
+          s->pinner->Pin(v, s->pinnable_value);
         } else if (s->value != nullptr) {
           s->value->assign(v.data(), v.size());
         }
@@ -827,10 +1166,17 @@ static bool SaveValue(void* arg, const char* entry) {
           *(s->found_final_value) = true;
           return false;
         }
-        Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
         *(s->merge_in_progress) = true;
+        if (s->inplace_update_support) {
+          // The operand may be combined with newer ones in-place
+          s->mem->GetLock(s->key->user_key())->ReadLock();
+        }
+        Slice v = GetEntryValue(key_ptr + key_length);
         merge_context->PushOperand(
             v, s->inplace_update_support == false /* operand_pinned */);
+        if (s->inplace_update_support) {
+          s->mem->GetLock(s->key->user_key())->ReadUnlock();
+        }
         if (s->do_merge && merge_operator->ShouldMerge(
                                merge_context->GetOperandsDirectionBackward())) {
           *(s->status) = MergeHelper::TimedFullMerge(
@@ -866,7 +1212,9 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
                    MergeContext* merge_context,
                    SequenceNumber* max_covering_tombstone_seq,
                    SequenceNumber* seq, const ReadOptions& read_opts,
-                   ReadCallback* callback, bool* is_blob_index, bool do_merge) {
+                   ReadCallback* callback, bool* is_blob_index, bool do_merge,
+                   PinnableSlice* pinnable_value,
+                   MemTableValuePinner* pinner) {
   // The sequence number is updated synchronously in version_set.h
   if (IsEmpty()) {
     // Avoiding recording stats for speed.
@@ -874,13 +1222,12 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
   }
   PERF_TIMER_GUARD(get_from_memtable_time);
 
-  std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
-      NewRangeTombstoneIterator(read_opts,
-                                GetInternalKeySeqno(key.internal_key())));
-  if (range_del_iter != nullptr) {
-    *max_covering_tombstone_seq =
-        std::max(*max_covering_tombstone_seq,
-                 range_del_iter->MaxCoveringTombstoneSeqnum(key.user_key()));
+  if (!read_opts.ignore_range_deletions &&
+      !is_range_del_table_empty_.load(std::memory_order_relaxed)) {
+    *max_covering_tombstone_seq = std::max(
+        *max_covering_tombstone_seq,
+        MaxCoveringTombstoneSeqnum(key.user_key(),
+                                   GetInternalKeySeqno(key.internal_key())));
   }
 
   bool found_final_value = false;
@@ -901,9 +1248,13 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
     }
   }
 
+  if (bloom_filter_) {
+    RecordTick(moptions_.statistics, MEMTABLE_BLOOM_CHECKED);
+  }
   if (bloom_filter_ && !may_contain) {
     // iter is null if prefix bloom says the key does not exist
     PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
+    RecordTick(moptions_.statistics, MEMTABLE_BLOOM_USEFUL);
     *seq = kMaxSequenceNumber;
   } else {
     if (bloom_filter_) {
@@ -911,7 +1262,8 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
     }
     GetFromTable(key, *max_covering_tombstone_seq, do_merge, callback,
                  is_blob_index, value, timestamp, s, merge_context, seq,
-                 &found_final_value, &merge_in_progress);
+                 &found_final_value, &merge_in_progress, pinnable_value,
+                 pinner);
   }
 
   // No change to value, since we have not yet found a Put/Delete
@@ -928,7 +1280,9 @@ void MemTable::GetFromTable(const LookupKey& key,
                             bool* is_blob_index, std::string* value,
                             std::string* timestamp, Status* s,
                             MergeContext* merge_context, SequenceNumber* seq,
-                            bool* found_final_value, bool* merge_in_progress) {
+                            bool* found_final_value, bool* merge_in_progress,
+                            PinnableSlice* pinnable_value,
+                            MemTableValuePinner* pinner) {
   Saver saver;
   saver.status = s;
   saver.found_final_value = found_final_value;
@@ -949,12 +1303,21 @@ void MemTable::GetFromTable(const LookupKey& key,
   saver.is_blob_index = is_blob_index;
   saver.do_merge = do_merge;
   saver.allow_data_in_errors = moptions_.allow_data_in_errors;
+  if (pinner != nullptr && !moptions_.inplace_update_support) {
+    assert(pinnable_value != nullptr && !pinnable_value->IsPinned());
+    assert(value == pinnable_value->GetSelf());
+    saver.pinnable_value = pinnable_value;
+    saver.pinner = pinner;
+  } else {
+    saver.pinnable_value = nullptr;
+    saver.pinner = nullptr;
+  }
   table_->Get(key, &saver, SaveValue);
   *seq = saver.seq;
 }
 
 void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
-                        ReadCallback* callback) {
+                        ReadCallback* callback, MemTableValuePinner* pinner) {
   // The sequence number is updated synchronously in version_set.h
   if (IsEmpty()) {
     // Avoiding recording stats for speed.
@@ -964,12 +1327,17 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
 
   MultiGetRange temp_range(*range, range->begin(), range->end());
   if (bloom_filter_) {
+    // As in Get(), the whole key is checked when it is in the filter, as
+    // that is more selective than its prefix. The keys of the batch are all
+    // hashed, and their cache lines fetched, before the first is probed.
+    const bool whole_key = moptions_.memtable_whole_key_filtering;
+    assert(whole_key || prefix_extractor_);
     std::array<Slice*, MultiGetContext::MAX_BATCH_SIZE> keys;
     std::array<bool, MultiGetContext::MAX_BATCH_SIZE> may_match = {{true}};
     autovector<Slice, MultiGetContext::MAX_BATCH_SIZE> prefixes;
     int num_keys = 0;
     for (auto iter = temp_range.begin(); iter != temp_range.end(); ++iter) {
-      if (!prefix_extractor_) {
+      if (whole_key) {
         keys[num_keys++] = &iter->ukey_without_ts;
       } else if (prefix_extractor_->InDomain(iter->ukey_without_ts)) {
         prefixes.emplace_back(
@@ -979,44 +1347,60 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
     }
     bloom_filter_->MayContain(num_keys, &keys[0], &may_match[0]);
     int idx = 0;
+    uint64_t num_checked = 0;
+    uint64_t num_useful = 0;
     for (auto iter = temp_range.begin(); iter != temp_range.end(); ++iter) {
-      if (prefix_extractor_ &&
-          !prefix_extractor_->InDomain(iter->ukey_without_ts)) {
+      num_checked++;
+      if (!whole_key && !prefix_extractor_->InDomain(iter->ukey_without_ts)) {
         PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
         continue;
       }
       if (!may_match[idx]) {
         temp_range.SkipKey(iter);
         PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
+        num_useful++;
       } else {
         PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
       }
       idx++;
     }
+    RecordTick(moptions_.statistics, MEMTABLE_BLOOM_CHECKED, num_checked);
+    RecordTick(moptions_.statistics, MEMTABLE_BLOOM_USEFUL, num_useful);
+  }
+  // All the keys of the batch are looked up in the same range tombstones.
+  bool has_range_deletions =
+      !read_options.ignore_range_deletions &&
+      !is_range_del_table_empty_.load(std::memory_order_relaxed);
+  const RangeDelEntry* newest_range_del = nullptr;
+  std::shared_ptr<const RangeTombstoneIndex> range_tombstone_index;
+  if (has_range_deletions) {
+    range_tombstone_index = GetRangeTombstoneIndex(&newest_range_del);
   }
   for (auto iter = temp_range.begin(); iter != temp_range.end(); ++iter) {
     SequenceNumber seq = kMaxSequenceNumber;
     bool found_final_value{false};
     bool merge_in_progress = iter->s->IsMergeInProgress();
-    std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
-        NewRangeTombstoneIterator(
-            read_options, GetInternalKeySeqno(iter->lkey->internal_key())));
-    if (range_del_iter != nullptr) {
+    if (has_range_deletions) {
       iter->max_covering_tombstone_seq = std::max(
           iter->max_covering_tombstone_seq,
-          range_del_iter->MaxCoveringTombstoneSeqnum(iter->lkey->user_key()));
+          MaxCoveringTombstoneSeqnum(
+              range_tombstone_index.get(), newest_range_del,
+              iter->lkey->user_key(),
+              GetInternalKeySeqno(iter->lkey->internal_key())));
     }
     GetFromTable(*(iter->lkey), iter->max_covering_tombstone_seq, true,
                  callback, &iter->is_blob_index, iter->value->GetSelf(),
                  iter->timestamp, iter->s, &(iter->merge_context), &seq,
-                 &found_final_value, &merge_in_progress);
+                 &found_final_value, &merge_in_progress, iter->value, pinner);
 
     if (!found_final_value && merge_in_progress) {
       *(iter->s) = Status::MergeInProgress();
     }
 
     if (found_final_value) {
-      iter->value->PinSelf();
+      if (!iter->value->IsPinned()) {
+        iter->value->PinSelf();
+      }
       range->AddValueSize(iter->value->size());
       range->MarkKeyDone(iter);
       RecordTick(moptions_.statistics, MEMTABLE_HIT);
@@ -1097,6 +1481,63 @@ Status MemTable::Update(SequenceNumber seq, const Slice& key,
   return Add(seq, kTypeValue, key, value, kv_prot_info);
 }
 
+Status MemTable::UpdateMerge(SequenceNumber seq, const Slice& key,
+                             const Slice& value,
+                             const ProtectionInfoKVOTS64* kv_prot_info) {
+  LookupKey lkey(key, seq);
+  Slice mem_key = lkey.memtable_key();
+
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), mem_key.data());
+
+  // A range deletion newer than the existing operand could cover it, but
+  // must not cover the new one.
+  if (iter->Valid() && moptions_.merge_operator != nullptr &&
+      is_range_del_table_empty_.load(std::memory_order_relaxed)) {
+    // See Update() for the entry format
+    const char* entry = iter->key();
+    uint32_t key_length = 0;
+    const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+    if (comparator_.comparator.user_comparator()->Equal(
+            Slice(key_ptr, key_length - 8), lkey.user_key())) {
+      const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
+      ValueType type;
+      SequenceNumber existing_seq;
+      UnPackSequenceAndType(tag, &existing_seq, &type);
+      assert(existing_seq != seq);
+      if (type == kTypeMerge) {
+        // Only this thread writes to the memtable, so the existing operand
+        // can be read without the lock.
+        Slice prev_operand = GetLengthPrefixedSlice(key_ptr + key_length);
+        std::string new_operand;
+        if (moptions_.merge_operator->PartialMerge(
+                lkey.user_key(), prev_operand, value, &new_operand,
+                moptions_.info_log) &&
+            new_operand.size() <= prev_operand.size()) {
+          WriteLock wl(GetLock(lkey.user_key()));
+          char* p = EncodeVarint32(const_cast<char*>(key_ptr) + key_length,
+                                   static_cast<uint32_t>(new_operand.size()));
+          memcpy(p, new_operand.data(), new_operand.size());
+          RecordTick(moptions_.statistics, NUMBER_KEYS_UPDATED);
+          if (kv_prot_info != nullptr) {
+            ProtectionInfoKVOTS64 updated_kv_prot_info(*kv_prot_info);
+            // `seq` is swallowed and `existing_seq` prevails, with the
+            // combined operand.
+            updated_kv_prot_info.UpdateV(value, new_operand);
+            updated_kv_prot_info.UpdateS(seq, existing_seq);
+            Slice encoded(entry, p + new_operand.size() - entry);
+            return VerifyEncodedEntry(encoded, updated_kv_prot_info);
+          }
+          return Status::OK();
+        }
+      }
+    }
+  }
+
+  return Add(seq, kTypeMerge, key, value, kv_prot_info);
+}
+
 Status MemTable::UpdateCallback(SequenceNumber seq, const Slice& key,
                                 const Slice& delta,
                                 const ProtectionInfoKVOTS64* kv_prot_info) {
@@ -1193,6 +1634,89 @@ Status MemTable::UpdateCallback(SequenceNumber seq, const Slice& key,
   return Status::NotFound();
 }
 
+Status MemTable::UpdateConcurrently(SequenceNumber seq, ValueType type,
+                                    const Slice& key, const Slice& value,
+                                    const ProtectionInfoKVOTS64* kv_prot_info,
+                                    SequenceNumber oldest_unpublished_seq,
+                                    MemTablePostProcessInfo* post_process_info) {
+  assert(moptions_.inplace_update_support);
+  LookupKey lkey(key, seq);
+  Slice mem_key = lkey.memtable_key();
+  const size_t lock_index = GetLockIndex(lkey.user_key());
+  WriteLock wl(&locks_[lock_index]);
+
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), mem_key.data());
+
+  if (iter->Valid()) {
+    // See Update() for the entry format
+    const char* entry = iter->key();
+    uint32_t key_length = 0;
+    const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+    if (comparator_.comparator.user_comparator()->Equal(
+            Slice(key_ptr, key_length - 8), lkey.user_key())) {
+      // Forget the updates that no pending write can be older than
+      auto& updates = concurrent_inplace_updates_[lock_index];
+      SequenceNumber updated_seq = 0;
+      size_t kept = 0;
+      for (size_t i = 0; i < updates.size(); i++) {
+        if (updates[i].second < oldest_unpublished_seq) {
+          continue;
+        }
+        if (updates[i].first == entry) {
+          updated_seq = updates[i].second;
+        }
+        updates[kept++] = updates[i];
+      }
+      updates.resize(kept);
+      if (updated_seq > seq) {
+        // A newer write has already overwritten this entry in-place, and
+        // would have hidden this one.
+        RecordTick(moptions_.statistics, NUMBER_KEYS_UPDATED);
+        return Status::OK();
+      }
+
+      const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
+      ValueType existing_type;
+      SequenceNumber existing_seq;
+      UnPackSequenceAndType(tag, &existing_seq, &existing_type);
+      assert(existing_seq != seq);
+      if (type == kTypeValue && existing_type == kTypeValue &&
+          is_range_del_table_empty_.load(std::memory_order_relaxed)) {
+        Slice prev_value = GetLengthPrefixedSlice(key_ptr + key_length);
+        if (value.size() <= prev_value.size()) {
+          char* p =
+              EncodeVarint32(const_cast<char*>(key_ptr) + key_length,
+                             static_cast<uint32_t>(value.size()));
+          memcpy(p, value.data(), value.size());
+          if (updated_seq == 0) {
+            updates.emplace_back(entry, seq);
+          } else {
+            for (auto& update : updates) {
+              if (update.first == entry) {
+                update.second = seq;
+              }
+            }
+          }
+          RecordTick(moptions_.statistics, NUMBER_KEYS_UPDATED);
+          if (kv_prot_info != nullptr) {
+            ProtectionInfoKVOTS64 updated_kv_prot_info(*kv_prot_info);
+            // `seq` is swallowed and `existing_seq` prevails.
+            updated_kv_prot_info.UpdateS(seq, existing_seq);
+            Slice encoded(entry, p + value.size() - entry);
+            return VerifyEncodedEntry(encoded, updated_kv_prot_info);
+          }
+          return Status::OK();
+        }
+      }
+    }
+  }
+
+  return Add(seq, type, key, value, kv_prot_info, true /* allow_concurrent */,
+             post_process_info);
+}
+
 size_t MemTable::CountSuccessiveMergeEntries(const LookupKey& key) {
   Slice memkey = key.memtable_key();
 
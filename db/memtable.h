@@ -30,6 +30,7 @@
 #include "table/multiget_context.h"
 #include "util/dynamic_bloom.h"
 #include "util/hash.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -53,7 +54,11 @@ struct ImmutableMemTableOptions {
                                    Slice delta_value,
                                    std::string* merged_value);
   size_t max_successive_merges;
+  // 0 if values are never stored out of line
+  size_t large_value_threshold;
   Statistics* statistics;
+  // Only the column family's statistics, nullptr if not set
+  Statistics* cf_statistics;
   MergeOperator* merge_operator;
   Logger* info_log;
   bool allow_data_in_errors;
@@ -69,6 +74,26 @@ struct MemTablePostProcessInfo {
 };
 
 using MultiGetRange = MultiGetContext::Range;
+
+// Lets MemTable::Get() and MultiGet() point a PinnableSlice at a value in the
+// memtable arena instead of copying it. Pin() registers a cleanup on the
+// result that holds a reference keeping the memtable alive, e.g. one on the
+// SuperVersion the lookup goes through. Only values found with no merge in
+// progress and at least min_value_size() bytes long are pinned.
+class MemTableValuePinner {
+ public:
+  explicit MemTableValuePinner(uint64_t min_value_size)
+      : min_value_size_(min_value_size) {}
+  virtual ~MemTableValuePinner() {}
+
+  uint64_t min_value_size() const { return min_value_size_; }
+
+  virtual void Pin(const Slice& value, PinnableSlice* result) = 0;
+
+ private:
+  const uint64_t min_value_size_;
+};
+
 // Note:  Many of the methods in this class have comments indicating that
 // external synchronization is required as these methods are not thread-safe.
 // It is up to higher layers of code to decide how to prevent concurrent
@@ -151,6 +176,16 @@ class MemTable {
     return flush_state_.load(std::memory_order_relaxed) == FLUSH_REQUESTED;
   }
 
+  // Returns true if the memtable has reached its write buffer size, whether or
+  // not its flush has been scheduled since.
+  bool IsFull() const {
+    return flush_state_.load(std::memory_order_relaxed) != FLUSH_NOT_REQUESTED;
+  }
+
+  size_t GetWriteBufferSize() const {
+    return write_buffer_size_.load(std::memory_order_relaxed);
+  }
+
   // Returns true if a flush should be scheduled and the caller should
   // be the one to schedule it
   bool MarkFlushScheduled() {
@@ -174,9 +209,23 @@ class MemTable {
   //        those allocated in arena.
   InternalIterator* NewIterator(const ReadOptions& read_options, Arena* arena);
 
+  // The range tombstones are fragmented once and the result is shared by all
+  // the iterators created until the next range deletion is added.
   FragmentedRangeTombstoneIterator* NewRangeTombstoneIterator(
       const ReadOptions& read_options, SequenceNumber read_seq);
 
+  // Fragments the range tombstones ahead of the first read. Meant for a
+  // memtable that is about to become immutable, so that the reads of it
+  // never pay for the fragmentation.
+  void ConstructFragmentedRangeTombstones();
+
+  // Returns the largest sequence number at most `read_seq` of the range
+  // tombstones covering `user_key`, or 0 if there is none. Unlike
+  // NewRangeTombstoneIterator(), it does not need to fragment all the range
+  // tombstones after each new range deletion.
+  SequenceNumber MaxCoveringTombstoneSeqnum(const Slice& user_key,
+                                            SequenceNumber read_seq);
+
   Status VerifyEncodedEntry(Slice encoded,
                             const ProtectionInfoKVOTS64& kv_prot_info);
 
@@ -226,25 +275,35 @@ class MemTable {
                is_blob_index, do_merge);
   }
 
+  //
+  // If `pinner` is not null, `value` must be the buffer of `pinnable_value`,
+  // which may instead be pinned to the value in the memtable arena (see
+  // MemTableValuePinner). Callers check pinnable_value->IsPinned().
   bool Get(const LookupKey& key, std::string* value, std::string* timestamp,
            Status* s, MergeContext* merge_context,
            SequenceNumber* max_covering_tombstone_seq, SequenceNumber* seq,
            const ReadOptions& read_opts, ReadCallback* callback = nullptr,
-           bool* is_blob_index = nullptr, bool do_merge = true);
+           bool* is_blob_index = nullptr, bool do_merge = true,
+           PinnableSlice* pinnable_value = nullptr,
+           MemTableValuePinner* pinner = nullptr);
 
   bool Get(const LookupKey& key, std::string* value, std::string* timestamp,
            Status* s, MergeContext* merge_context,
            SequenceNumber* max_covering_tombstone_seq,
            const ReadOptions& read_opts, ReadCallback* callback = nullptr,
-           bool* is_blob_index = nullptr, bool do_merge = true) {
+           bool* is_blob_index = nullptr, bool do_merge = true,
+           PinnableSlice* pinnable_value = nullptr,
+           MemTableValuePinner* pinner = nullptr) {
     SequenceNumber seq;
     return Get(key, value, timestamp, s, merge_context,
                max_covering_tombstone_seq, &seq, read_opts, callback,
-               is_blob_index, do_merge);
+               is_blob_index, do_merge, pinnable_value, pinner);
   }
 
+  // With a `pinner`, found values may be pinned to the memtable arena rather
+  // than copied into the PinnableSlice buffers, as in Get().
   void MultiGet(const ReadOptions& read_options, MultiGetRange* range,
-                ReadCallback* callback);
+                ReadCallback* callback, MemTableValuePinner* pinner = nullptr);
 
   // If `key` exists in current memtable with type `kTypeValue` and the existing
   // value is at least as large as the new value, updates it in-place. Otherwise
@@ -259,6 +318,20 @@ class MemTable {
   Status Update(SequenceNumber seq, const Slice& key, const Slice& value,
                 const ProtectionInfoKVOTS64* kv_prot_info);
 
+  // If the latest entry of `key` in current memtable is a merge operand, and
+  // the merge operator's PartialMerge() combines it with the new operand
+  // `value` into an operand no larger than the existing one, replaces the
+  // existing operand with the combined one in-place. Otherwise adds `value`
+  // to the memtable out-of-place as a merge operand. Always out-of-place once
+  // the memtable has range deletions.
+  //
+  // Returns `Status::TryAgain` as Update() does.
+  //
+  // REQUIRES: external synchronization to prevent simultaneous
+  // operations on the same MemTable.
+  Status UpdateMerge(SequenceNumber seq, const Slice& key, const Slice& value,
+                     const ProtectionInfoKVOTS64* kv_prot_info);
+
   // If `key` exists in current memtable with type `kTypeValue` and the existing
   // value is at least as large as the new value, updates it in-place. Otherwise
   // if `key` exists in current memtable with type `kTypeValue`, adds the new
@@ -277,6 +350,26 @@ class MemTable {
                         const Slice& delta,
                         const ProtectionInfoKVOTS64* kv_prot_info);
 
+  // Like Update() for `type == kTypeValue`, or Add() for other value types,
+  // for a writer inserting into the memtable concurrently with others. The
+  // user key is locked for the whole operation, so writers of the same key
+  // are serialized, though not in sequence number order. Since an in-place
+  // update keeps the sequence number of the entry it overwrites, each one is
+  // remembered until no writer with a smaller sequence number than
+  // `oldest_unpublished_seq` remains, and an older write of the same key that
+  // arrives after it is dropped as overwritten. No value is updated in-place
+  // once the memtable has range deletions.
+  //
+  // `oldest_unpublished_seq` must not exceed the sequence number of any write
+  // still in progress, and is 0 if unknown.
+  //
+  // REQUIRES: inplace_update_support and not unordered_write.
+  Status UpdateConcurrently(SequenceNumber seq, ValueType type,
+                            const Slice& key, const Slice& value,
+                            const ProtectionInfoKVOTS64* kv_prot_info,
+                            SequenceNumber oldest_unpublished_seq,
+                            MemTablePostProcessInfo* post_process_info);
+
   // Returns the number of successive merge entries starting from the newest
   // entry for the key up to the last non-merge entry or last entry for the
   // key in the memtable.
@@ -433,6 +526,7 @@ class MemTable {
 
   // Get the lock associated for the key
   port::RWMutex* GetLock(const Slice& key);
+  size_t GetLockIndex(const Slice& key) const;
 
   const InternalKeyComparator& GetInternalKeyComparator() const {
     return comparator_.comparator;
@@ -446,6 +540,21 @@ class MemTable {
     return oldest_key_time_.load(std::memory_order_relaxed);
   }
 
+  // The number of slots of the hot key caches of the SuperVersions with
+  // this memtable, or 0 if they have none (see
+  // ColumnFamilyOptions::memtable_hot_key_cache_size).
+  size_t hot_key_cache_slots() const { return hot_key_cache_slots_; }
+
+  // Returns the largest sequence number of the writes to this memtable that
+  // may have changed the user key whose HotKeyCache::Hash() is `hash`.
+  // REQUIRES: hot_key_cache_slots() > 0
+  SequenceNumber HotKeyLastWriteSeq(uint64_t hash) const {
+    return std::max(
+        hot_key_write_seqs_[hash & (hot_key_cache_slots_ - 1)].load(
+            std::memory_order_relaxed),
+        hot_key_range_del_seq_.load(std::memory_order_relaxed));
+  }
+
   // REQUIRES: db_mutex held.
   void SetID(uint64_t id) { id_ = id; }
 
@@ -487,10 +596,62 @@ class MemTable {
   const size_t kArenaBlockSize;
   AllocTracker mem_tracker_;
   ConcurrentArena arena_;
+  // Values of at least moptions_.large_value_threshold bytes, if set
+  std::unique_ptr<ConcurrentArena> large_value_arena_;
   std::unique_ptr<MemTableRep> table_;
   std::unique_ptr<MemTableRep> range_del_table_;
   std::atomic_bool is_range_del_table_empty_;
 
+  // An entry of range_del_table_, linked to the one inserted before it.
+  // Allocated from arena_.
+  struct RangeDelEntry {
+    const char* entry;
+    // The number of range deletions up to and including this one.
+    uint64_t num_range_deletes;
+    const RangeDelEntry* prev;
+  };
+  // The most recently inserted range deletion. Set after the insertion into
+  // range_del_table_.
+  std::atomic<const RangeDelEntry*> newest_range_del_;
+
+  // The range tombstones, kept with the logarithmic method: sorted runs of
+  // range deletions with sizes decreasing roughly geometrically, each
+  // fragmented on its own. New range deletions are checked one by one until
+  // there are kMaxUnindexedRangeDeletes of them, then they form a new run
+  // that is merged with the runs no larger than it. A range deletion is thus
+  // fragmented O(log n) times however reads and writes interleave, and a
+  // point lookup searches O(log n) runs. Iterators need a single run, which
+  // all the runs are merged into on demand.
+  struct RangeTombstoneRun {
+    RangeTombstoneRun(std::vector<const char*>&& _entries,
+                      const KeyComparator& cmp);
+
+    const std::vector<const char*> entries;  // sorted by cmp
+    const FragmentedRangeTombstoneList list;
+  };
+  struct RangeTombstoneIndex {
+    // The newest range deletion in `runs`, or nullptr if there is none.
+    const RangeDelEntry* newest = nullptr;
+    std::vector<std::shared_ptr<const RangeTombstoneRun>> runs;
+  };
+  static const uint64_t kMaxUnindexedRangeDeletes = 16;
+
+  SpinMutex range_tombstone_index_mutex_;
+  std::shared_ptr<const RangeTombstoneIndex>
+      range_tombstone_index_;  // guarded by the mutex above
+
+  // Returns an index holding all but at most kMaxUnindexedRangeDeletes of the
+  // range deletions up to `*newest`, which is set to the newest one. If
+  // `merge_all`, the index holds all of them in at most one run.
+  std::shared_ptr<const RangeTombstoneIndex> GetRangeTombstoneIndex(
+      const RangeDelEntry** newest, bool merge_all = false);
+
+  // Checks the range deletions of `index` and those newer up to `newest`.
+  SequenceNumber MaxCoveringTombstoneSeqnum(const RangeTombstoneIndex* index,
+                                            const RangeDelEntry* newest,
+                                            const Slice& user_key,
+                                            SequenceNumber read_seq) const;
+
   // Total data size of all data inserted
   std::atomic<uint64_t> data_size_;
   std::atomic<uint64_t> num_entries_;
@@ -527,6 +688,11 @@ class MemTable {
   // rw locks for inplace updates
   std::vector<port::RWMutex> locks_;
 
+  // Entries updated in-place by UpdateConcurrently() with the sequence number
+  // of the update, per lock of `locks_`, guarded by that lock.
+  std::vector<std::vector<std::pair<const char*, SequenceNumber>>>
+      concurrent_inplace_updates_;
+
   const SliceTransform* const prefix_extractor_;
   std::unique_ptr<DynamicBloom> bloom_filter_;
 
@@ -543,6 +709,12 @@ class MemTable {
   // Timestamp of oldest key
   std::atomic<uint64_t> oldest_key_time_;
 
+  // The largest sequence number written per hot key cache slot, and by any
+  // range deletion. Set before the sequence numbers are published.
+  const size_t hot_key_cache_slots_;
+  std::unique_ptr<std::atomic<SequenceNumber>[]> hot_key_write_seqs_;
+  std::atomic<SequenceNumber> hot_key_range_del_seq_;
+
   // Memtable id to track flush.
   uint64_t id_ = 0;
 
@@ -571,7 +743,9 @@ class MemTable {
                     ReadCallback* callback, bool* is_blob_index,
                     std::string* value, std::string* timestamp, Status* s,
                     MergeContext* merge_context, SequenceNumber* seq,
-                    bool* found_final_value, bool* merge_in_progress);
+                    bool* found_final_value, bool* merge_in_progress,
+                    PinnableSlice* pinnable_value,
+                    MemTableValuePinner* pinner);
 };
 
 extern const char* EncodeKey(std::string* scratch, const Slice& target);
@@ -106,17 +106,19 @@ bool MemTableListVersion::Get(const LookupKey& key, std::string* value,
                               MergeContext* merge_context,
                               SequenceNumber* max_covering_tombstone_seq,
                               SequenceNumber* seq, const ReadOptions& read_opts,
-                              ReadCallback* callback, bool* is_blob_index) {
+                              ReadCallback* callback, bool* is_blob_index,
+                              PinnableSlice* pinnable_value,
+                              MemTableValuePinner* pinner) {
   return GetFromList(&memlist_, key, value, timestamp, s, merge_context,
                      max_covering_tombstone_seq, seq, read_opts, callback,
-                     is_blob_index);
+                     is_blob_index, pinnable_value, pinner);
 }
 
 void MemTableListVersion::MultiGet(const ReadOptions& read_options,
-                                   MultiGetRange* range,
-                                   ReadCallback* callback) {
+                                   MultiGetRange* range, ReadCallback* callback,
+                                   MemTableValuePinner* pinner) {
   for (auto memtable : memlist_) {
-    memtable->MultiGet(read_options, range, callback);
+    memtable->MultiGet(read_options, range, callback, pinner);
     if (range->empty()) {
       return;
     }
@@ -150,7 +152,8 @@ bool MemTableListVersion::GetFromList(
     std::list<MemTable*>* list, const LookupKey& key, std::string* value,
     std::string* timestamp, Status* s, MergeContext* merge_context,
     SequenceNumber* max_covering_tombstone_seq, SequenceNumber* seq,
-    const ReadOptions& read_opts, ReadCallback* callback, bool* is_blob_index) {
+    const ReadOptions& read_opts, ReadCallback* callback, bool* is_blob_index,
+    PinnableSlice* pinnable_value, MemTableValuePinner* pinner) {
   *seq = kMaxSequenceNumber;
 
   for (auto& memtable : *list) {
@@ -158,7 +161,8 @@ bool MemTableListVersion::GetFromList(
 
     bool done = memtable->Get(key, value, timestamp, s, merge_context,
                               max_covering_tombstone_seq, &current_seq,
-                              read_opts, callback, is_blob_index);
+                              read_opts, callback, is_blob_index,
+                              true /* do_merge */, pinnable_value, pinner);
     if (*seq == kMaxSequenceNumber) {
       // Store the most recent sequence number of any operation on this key.
       // Since we only care about the most recent change, we only need to
@@ -18,7 +18,8 @@ PeriodicWorkScheduler::PeriodicWorkScheduler(
 
 void PeriodicWorkScheduler::Register(DBImpl* dbi,
                                      unsigned int stats_dump_period_sec,
-                                     unsigned int stats_persist_period_sec) {
+                                     unsigned int stats_persist_period_sec,
+                                     unsigned int auto_tune_period_sec) {
   MutexLock l(&timer_mu_);
   static std::atomic<uint64_t> initial_delay(0);
   timer->Start();
@@ -36,6 +37,13 @@ void PeriodicWorkScheduler::Register(DBImpl* dbi,
             static_cast<uint64_t>(stats_persist_period_sec) * kMicrosInSecond,
         static_cast<uint64_t>(stats_persist_period_sec) * kMicrosInSecond);
   }
+  if (auto_tune_period_sec > 0) {
+    timer->Add(
+        [dbi]() { dbi->AutoTune(); }, GetTaskName(dbi, "auto_tune"),
+        initial_delay.fetch_add(1) %
+            static_cast<uint64_t>(auto_tune_period_sec) * kMicrosInSecond,
+        static_cast<uint64_t>(auto_tune_period_sec) * kMicrosInSecond);
+  }
   timer->Add([dbi]() { dbi->FlushInfoLog(); },
              GetTaskName(dbi, "flush_info_log"),
              initial_delay.fetch_add(1) % kDefaultFlushInfoLogPeriodSec *
@@ -48,6 +56,7 @@ void PeriodicWorkScheduler::Unregister(DBImpl* dbi) {
   timer->Cancel(GetTaskName(dbi, "dump_st"));
   timer->Cancel(GetTaskName(dbi, "pst_st"));
   timer->Cancel(GetTaskName(dbi, "flush_info_log"));
+  timer->Cancel(GetTaskName(dbi, "auto_tune"));
   if (!timer->HasPendingTask()) {
     timer->Shutdown();
   }
@@ -5,6 +5,7 @@
 
 #include "db/periodic_work_scheduler.h"
 
+#include "db/auto_tuner.h"
 #include "db/db_test_util.h"
 #include "env/composite_env_wrapper.h"
 #include "test_util/mock_time_env.h"
@@ -226,6 +227,131 @@ TEST_F(PeriodicWorkSchedulerTest, MultiEnv) {
   delete db;
   Close();
 }
+
+TEST_F(PeriodicWorkSchedulerTest, AutoTune) {
+  constexpr unsigned int kPeriodSec = 5;
+  Close();
+  Options options;
+  options.stats_dump_period_sec = 0;
+  options.stats_persist_period_sec = 0;
+  options.auto_tune_period_sec = kPeriodSec;
+  options.create_if_missing = true;
+  options.env = mock_env_.get();
+
+  int auto_tune_counter = 0;
+  SyncPoint::GetInstance()->SetCallBack("DBImpl::AutoTune:Done",
+                                        [&](void*) { auto_tune_counter++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Reopen(options);
+  auto scheduler = dbfull()->TEST_GetPeriodicWorkScheduler();
+  ASSERT_NE(nullptr, scheduler);
+  // The info log flush and the tuning
+  ASSERT_EQ(2, scheduler->TEST_GetValidTaskNum());
+
+  dbfull()->TEST_WaitForStatsDumpRun(
+      [&] { mock_clock_->MockSleepForSeconds(static_cast<int>(kPeriodSec)); });
+  ASSERT_GE(auto_tune_counter, 1);
+  // An idle DB keeps its options
+  ASSERT_EQ(options.max_background_jobs,
+            dbfull()->GetDBOptions().max_background_jobs);
+  Close();
+}
+
+namespace {
+void ApplyDecision(const AutoTuner::Decision& decision,
+                   AutoTuner::Signals* signals) {
+  auto it = decision.db_options.find("max_background_jobs");
+  if (it != decision.db_options.end()) {
+    signals->max_background_jobs = std::stoi(it->second);
+  }
+  it = decision.db_options.find("compaction_readahead_size");
+  if (it != decision.db_options.end()) {
+    signals->compaction_readahead_size = std::stoll(it->second);
+  }
+  if (decision.rate_limiter_bytes_per_sec > 0) {
+    signals->rate_limiter_bytes_per_sec = decision.rate_limiter_bytes_per_sec;
+  }
+  for (auto& cf : signals->column_families) {
+    auto cf_it = decision.cf_options.find(cf.id);
+    if (cf_it != decision.cf_options.end()) {
+      cf.level0_slowdown_writes_trigger =
+          std::stoi(cf_it->second.at("level0_slowdown_writes_trigger"));
+    }
+  }
+}
+
+void RunAutoTuner(AutoTuner* tuner, int periods, AutoTuner::Signals* signals) {
+  for (int i = 0; i < periods; ++i) {
+    AutoTuner::Decision decision;
+    tuner->Tune(*signals, &decision);
+    ApplyDecision(decision, signals);
+  }
+}
+}  // namespace
+
+TEST_F(PeriodicWorkSchedulerTest, AutoTunerSteps) {
+  AutoTuner tuner(0 /* target_write_p99_micros */, nullptr /* info_log */);
+  AutoTuner::Signals signals;
+  signals.max_background_jobs = 2;
+  signals.compaction_readahead_size = 0;
+  signals.rate_limiter_bytes_per_sec = 1000;
+  AutoTuner::ColumnFamilySignals cf;
+  cf.name = "default";
+  cf.l0_files = 36;
+  cf.level0_slowdown_writes_trigger = 20;
+  cf.level0_stop_writes_trigger = 36;
+  cf.seconds_to_stall = 0;
+  signals.column_families.push_back(cf);
+
+  // Falling behind: one step per period, up to the caps
+  AutoTuner::Decision decision;
+  tuner.Tune(signals, &decision);
+  ASSERT_EQ("3", decision.db_options.at("max_background_jobs"));
+  ApplyDecision(decision, &signals);
+  RunAutoTuner(&tuner, 10, &signals);
+  ASSERT_EQ(4, signals.max_background_jobs);
+  ASSERT_EQ(2 << 20, signals.compaction_readahead_size);
+  ASSERT_EQ(4000, signals.rate_limiter_bytes_per_sec);
+  ASSERT_EQ(35, signals.column_families[0].level0_slowdown_writes_trigger);
+
+  // Keeping up: back down to the configured values, and no further
+  signals.column_families[0].l0_files = 0;
+  signals.column_families[0].seconds_to_stall = -1;
+  decision = AutoTuner::Decision();
+  tuner.Tune(signals, &decision);
+  ASSERT_TRUE(decision.db_options.empty());
+  RunAutoTuner(&tuner, 100, &signals);
+  ASSERT_EQ(2, signals.max_background_jobs);
+  ASSERT_EQ(0, signals.compaction_readahead_size);
+  ASSERT_EQ(1000, signals.rate_limiter_bytes_per_sec);
+  ASSERT_EQ(20, signals.column_families[0].level0_slowdown_writes_trigger);
+
+  // A value set by the user becomes the configured value
+  signals.max_background_jobs = 3;
+  signals.stall_micros = 1000;
+  RunAutoTuner(&tuner, 1, &signals);
+  ASSERT_EQ(4, signals.max_background_jobs);
+  signals.stall_micros = 0;
+  RunAutoTuner(&tuner, 100, &signals);
+  ASSERT_EQ(3, signals.max_background_jobs);
+}
+
+TEST_F(PeriodicWorkSchedulerTest, AutoTunerLatencyTarget) {
+  AutoTuner tuner(1000 /* target_write_p99_micros */, nullptr /* info_log */);
+  AutoTuner::Signals signals;
+  signals.max_background_jobs = 2;
+  signals.stall_micros = 1000;
+  RunAutoTuner(&tuner, 2, &signals);
+  ASSERT_EQ(4, signals.max_background_jobs);
+  // Missing the target with compaction keeping up steps down right away
+  signals.stall_micros = 0;
+  signals.write_p99_micros = 2000;
+  RunAutoTuner(&tuner, 1, &signals);
+  ASSERT_EQ(3, signals.max_background_jobs);
+  RunAutoTuner(&tuner, 1, &signals);
+  ASSERT_EQ(2, signals.max_background_jobs);
+}
 #endif  // !ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
 
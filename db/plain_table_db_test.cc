@@ -675,6 +675,50 @@ TEST_P(PlainTableDBTest, Immortal) {
   }
 }
 
+TEST_P(PlainTableDBTest, CopyDataToHugePages) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.max_open_files = -1;
+  PlainTableOptions plain_table_options;
+  plain_table_options.user_key_len = kPlainTableVariableLength;
+  plain_table_options.bloom_bits_per_key = 10;
+  plain_table_options.huge_page_tlb_size = 2 * 1024 * 1024;
+  plain_table_options.copy_data_to_huge_pages = true;
+  options.table_factory.reset(NewPlainTableFactory(plain_table_options));
+
+  DestroyAndReopen(&options);
+  ASSERT_OK(Put("0000000000000bar", "b"));
+  ASSERT_OK(Put("1000000000000foo", "v1"));
+  ASSERT_OK(Put("1000000000000goo", "v2"));
+  ASSERT_OK(dbfull()->TEST_FlushMemTable());
+  Close();
+  ASSERT_OK(ReopenForReadOnly(&options));
+
+  // Whether or not huge pages are reserved, the copy is kept for the life
+  // of the table, so values are pinned rather than copied
+  int copied = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "GetContext::SaveValue::PinSelf", [&](void* /*arg*/) { copied++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_EQ("b", Get("0000000000000bar"));
+  ASSERT_EQ("v1", Get("1000000000000foo"));
+  ASSERT_EQ("v2", Get("1000000000000goo"));
+  ASSERT_EQ("NOT_FOUND", Get("1000000000000bar"));
+  ASSERT_EQ(0, copied);
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+
+  std::unique_ptr<Iterator> iter(dbfull()->NewIterator(ReadOptions()));
+  iter->Seek("1000000000000foo");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("v1", iter->value().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("v2", iter->value().ToString());
+  iter->Next();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+}
+
 TEST_P(PlainTableDBTest, Iterator) {
   for (size_t huge_page_tlb_size = 0; huge_page_tlb_size <= 2 * 1024 * 1024;
        huge_page_tlb_size += 2 * 1024 * 1024) {
@@ -19,10 +19,13 @@ int main() {
 #include <string>
 #include <vector>
 
+#include "db/memtable.h"
 #include "db/range_del_aggregator.h"
 #include "db/range_tombstone_fragmenter.h"
+#include "options/cf_options.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/system_clock.h"
+#include "rocksdb/write_buffer_manager.h"
 #include "test_util/testutil.h"
 #include "util/coding.h"
 #include "util/gflags_compat.h"
@@ -53,6 +56,11 @@ DEFINE_int32(should_deletes_per_run, 1, "number of ShouldDelete calls per run");
 DEFINE_int32(add_tombstones_per_run, 1,
              "number of AddTombstones calls per run");
 
+DEFINE_bool(use_memtable, false,
+            "add each set of range tombstones to a memtable once, and time "
+            "getting them with MemTable::NewRangeTombstoneIterator() as part "
+            "of AddTombstones in every run, like memtable reads do");
+
 namespace {
 
 struct Stats {
@@ -177,15 +185,44 @@ int main(int argc, char** argv) {
   std::default_random_engine random_gen(FLAGS_seed);
   std::normal_distribution<double> normal_dist(FLAGS_tombstone_width_mean,
                                                FLAGS_tombstone_width_stddev);
+  // With --use_memtable, the tombstones are in `memtables` instead.
   std::vector<std::vector<ROCKSDB_NAMESPACE::PersistentRangeTombstone> >
-      all_persistent_range_tombstones(FLAGS_add_tombstones_per_run);
-  for (int i = 0; i < FLAGS_add_tombstones_per_run; i++) {
+      all_persistent_range_tombstones(
+          FLAGS_use_memtable ? 0 : FLAGS_add_tombstones_per_run);
+  for (size_t i = 0; i < all_persistent_range_tombstones.size(); i++) {
     all_persistent_range_tombstones[i] =
         std::vector<ROCKSDB_NAMESPACE::PersistentRangeTombstone>(
             FLAGS_num_range_tombstones);
   }
   auto mode = ROCKSDB_NAMESPACE::RangeDelPositioningMode::kForwardTraversal;
 
+  ROCKSDB_NAMESPACE::Options options;
+  ROCKSDB_NAMESPACE::ImmutableOptions ioptions(options);
+  ROCKSDB_NAMESPACE::MutableCFOptions mutable_cf_options(options);
+  ROCKSDB_NAMESPACE::WriteBufferManager write_buffer_manager(
+      options.db_write_buffer_size);
+  std::vector<ROCKSDB_NAMESPACE::MemTable*> memtables;
+  if (FLAGS_use_memtable) {
+    for (int i = 0; i < FLAGS_add_tombstones_per_run; i++) {
+      auto* mem = new ROCKSDB_NAMESPACE::MemTable(
+          icmp, ioptions, mutable_cf_options, &write_buffer_manager,
+          ROCKSDB_NAMESPACE::kMaxSequenceNumber, 0 /* column_family_id */);
+      mem->Ref();
+      for (int j = 0; j < FLAGS_num_range_tombstones; j++) {
+        uint64_t start = rnd.Uniform(FLAGS_tombstone_start_upper_bound);
+        uint64_t end = static_cast<uint64_t>(
+            std::round(start + std::max(1.0, normal_dist(random_gen))));
+        ROCKSDB_NAMESPACE::Status s =
+            mem->Add(j, ROCKSDB_NAMESPACE::kTypeRangeDeletion,
+                     ROCKSDB_NAMESPACE::Key(start), ROCKSDB_NAMESPACE::Key(end),
+                     nullptr /* kv_prot_info */);
+        assert(s.ok());
+        s.PermitUncheckedError();
+      }
+      memtables.push_back(mem);
+    }
+  }
+
   for (int i = 0; i < FLAGS_num_runs; i++) {
     ROCKSDB_NAMESPACE::ReadRangeDelAggregator range_del_agg(
         &icmp, ROCKSDB_NAMESPACE::kMaxSequenceNumber /* upper_bound */);
@@ -194,6 +231,17 @@ int main(int argc, char** argv) {
         std::unique_ptr<ROCKSDB_NAMESPACE::FragmentedRangeTombstoneList> >
         fragmented_range_tombstone_lists(FLAGS_add_tombstones_per_run);
 
+    for (auto* mem : memtables) {
+      ROCKSDB_NAMESPACE::StopWatchNano stop_watch_add_tombstones(
+          clock, true /* auto_start */);
+      std::unique_ptr<ROCKSDB_NAMESPACE::FragmentedRangeTombstoneIterator>
+          fragmented_range_del_iter(mem->NewRangeTombstoneIterator(
+              ROCKSDB_NAMESPACE::ReadOptions(),
+              ROCKSDB_NAMESPACE::kMaxSequenceNumber));
+      range_del_agg.AddTombstones(std::move(fragmented_range_del_iter));
+      stats.time_add_tombstones += stop_watch_add_tombstones.ElapsedNanos();
+    }
+
     for (auto& persistent_range_tombstones : all_persistent_range_tombstones) {
       // TODO(abhimadan): consider whether creating the range tombstones right
       // before AddTombstones is artificially warming the cache compared to
@@ -250,6 +298,10 @@ int main(int argc, char** argv) {
     }
   }
 
+  for (auto* mem : memtables) {
+    delete mem->Unref();
+  }
+
   std::cout << "=========================\n"
             << "Results:\n"
             << "=========================\n"
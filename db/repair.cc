@@ -36,7 +36,11 @@
 // (2) largest sequence number in the table
 // (3) oldest blob file referred to by the table (if applicable)
 //
-// If we are unable to scan the file, then we ignore the table.
+// If we are unable to scan the file, then we ignore the table. Tables are
+// scanned on up to max_file_opening_threads threads. The metadata of every
+// scanned table is saved to a checkpoint file, which is deleted once the
+// repair succeeds; a repair that was interrupted loads it and does not scan
+// those tables again.
 //
 // (d) Write Descriptor
 //
@@ -61,7 +65,10 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <cinttypes>
+#include <functional>
+
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
@@ -72,14 +79,18 @@
 #include "db/version_edit.h"
 #include "db/write_batch_internal.h"
 #include "file/filename.h"
+#include "file/read_write_util.h"
+#include "file/sequence_file_reader.h"
 #include "file/writable_file_writer.h"
 #include "options/cf_options.h"
+#include "port/port.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/write_buffer_manager.h"
 #include "table/scoped_arena_iterator.h"
+#include "test_util/sync_point.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -212,6 +223,7 @@ class Repairer {
           vset_.Recover({{kDefaultColumnFamilyName, default_cf_opts_}}, false);
     }
     if (status.ok()) {
+      OpenCheckpoint();
       // Need to scan existing SST files first so the column families are
       // created before we process WAL files
       ExtractMetaData();
@@ -222,9 +234,16 @@ class Repairer {
       table_fds_.clear();
       ConvertLogFilesToTables();
       ExtractMetaData();
+      TEST_SYNC_POINT_CALLBACK("Repairer::Run:AfterExtractMetaData", &status);
+    }
+    if (status.ok()) {
       status = AddTables();
     }
     if (status.ok()) {
+      // The checkpoint is kept if the repair fails, for the next attempt
+      checkpoint_.reset();
+      env_->DeleteFile(RepairCheckpointFileName(dbname_))
+          .PermitUncheckedError();
       uint64_t bytes = 0;
       for (size_t i = 0; i < tables_.size(); i++) {
         bytes += tables_[i].meta.fd.GetFileSize();
@@ -270,6 +289,10 @@ class Repairer {
   std::vector<FileDescriptor> table_fds_;
   std::vector<uint64_t> logs_;
   std::vector<TableInfo> tables_;
+  // Tables scanned by an earlier, interrupted repair, by file number
+  std::unordered_map<uint64_t, TableInfo> checkpointed_tables_;
+  port::Mutex checkpoint_mutex_;
+  std::unique_ptr<log::Writer> checkpoint_;
   uint64_t next_file_number_;
   // Lock over the persistent DB state. Non-nullptr iff successfully
   // acquired.
@@ -476,11 +499,147 @@ class Repairer {
     return status;
   }
 
+  // Loads the tables saved by an earlier repair, and starts a new checkpoint
+  // holding them. Checkpoint errors only cost scanning tables again, so they
+  // are logged and otherwise ignored.
+  void OpenCheckpoint() {
+    const std::string fname = RepairCheckpointFileName(dbname_);
+    const auto& fs = env_->GetFileSystem();
+    if (env_->FileExists(fname).ok()) {
+      std::unique_ptr<SequentialFileReader> file_reader;
+      Status s = SequentialFileReader::Create(fs, fname, file_options_,
+                                              &file_reader, nullptr);
+      if (s.ok()) {
+        // A record torn by the interruption is dropped
+        log::Reader reader(db_options_.info_log, std::move(file_reader),
+                           nullptr /* reporter */, true /* checksum */,
+                           0 /* log_num */);
+        std::string scratch;
+        Slice record;
+        while (reader.ReadRecord(&record, &scratch)) {
+          VersionEdit edit;
+          if (!edit.DecodeFrom(record).ok() ||
+              edit.GetNewFiles().size() != 1) {
+            continue;
+          }
+          TableInfo t;
+          t.meta = edit.GetNewFiles()[0].second;
+          t.column_family_id = edit.GetColumnFamily();
+          checkpointed_tables_[t.meta.fd.GetNumber()] = t;
+        }
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "Loaded %" ROCKSDB_PRIszt " tables from %s",
+                       checkpointed_tables_.size(), fname.c_str());
+      } else {
+        ROCKS_LOG_WARN(db_options_.info_log, "Cannot read %s: %s",
+                       fname.c_str(), s.ToString().c_str());
+      }
+    }
+
+    std::unique_ptr<FSWritableFile> file;
+    IOStatus io_s = NewWritableFile(fs.get(), fname, &file, file_options_);
+    if (!io_s.ok()) {
+      ROCKS_LOG_WARN(db_options_.info_log, "Cannot create %s: %s",
+                     fname.c_str(), io_s.ToString().c_str());
+      return;
+    }
+    std::unique_ptr<WritableFileWriter> file_writer(
+        new WritableFileWriter(std::move(file), fname, file_options_));
+    checkpoint_.reset(new log::Writer(std::move(file_writer), 0, false));
+    for (const auto& table : checkpointed_tables_) {
+      SaveToCheckpoint(table.second);
+    }
+  }
+
+  // Thread-safe
+  void SaveToCheckpoint(const TableInfo& t) {
+    if (!t.meta.smallest.Valid() || !t.meta.largest.Valid()) {
+      // A table without entries is cheap to scan again
+      return;
+    }
+    VersionEdit edit;
+    edit.SetColumnFamily(t.column_family_id);
+    edit.AddFile(0, t.meta);
+    std::string record;
+    if (!edit.EncodeTo(&record)) {
+      return;
+    }
+    MutexLock l(&checkpoint_mutex_);
+    if (checkpoint_ == nullptr) {
+      return;
+    }
+    IOStatus io_s = checkpoint_->AddRecord(record);
+    if (!io_s.ok()) {
+      ROCKS_LOG_WARN(db_options_.info_log, "Stop writing checkpoint: %s",
+                     io_s.ToString().c_str());
+      checkpoint_.reset();
+    }
+  }
+
+  // Takes the boundaries of `t` from the checkpoint if they were saved for
+  // the same file. Returns true if so.
+  bool LoadFromCheckpoint(TableInfo* t) const {
+    auto it = checkpointed_tables_.find(t->meta.fd.GetNumber());
+    if (it == checkpointed_tables_.end()) {
+      return false;
+    }
+    const TableInfo& saved = it->second;
+    if (saved.meta.fd.GetFileSize() != t->meta.fd.GetFileSize() ||
+        saved.column_family_id != t->column_family_id) {
+      return false;
+    }
+    t->meta.smallest = saved.meta.smallest;
+    t->meta.largest = saved.meta.largest;
+    t->meta.fd.smallest_seqno = saved.meta.fd.smallest_seqno;
+    t->meta.fd.largest_seqno = saved.meta.fd.largest_seqno;
+    t->meta.oldest_blob_file_number = saved.meta.oldest_blob_file_number;
+    ROCKS_LOG_INFO(db_options_.info_log,
+                   "Table #%" PRIu64 ": loaded from checkpoint",
+                   t->meta.fd.GetNumber());
+    return true;
+  }
+
   void ExtractMetaData() {
+    std::vector<TableInfo> tables(table_fds_.size());
+    std::vector<Status> statuses(table_fds_.size());
+    // Column families are looked up, and created, one table at a time
     for (size_t i = 0; i < table_fds_.size(); i++) {
-      TableInfo t;
-      t.meta.fd = table_fds_[i];
-      Status status = ScanTable(&t);
+      tables[i].meta.fd = table_fds_[i];
+      statuses[i] = GetTableColumnFamily(&tables[i]);
+    }
+
+    std::atomic<size_t> next_table_idx(0);
+    std::function<void()> scan_tables_func([&]() {
+      while (true) {
+        size_t table_idx = next_table_idx.fetch_add(1);
+        if (table_idx >= tables.size()) {
+          break;
+        }
+        TableInfo* t = &tables[table_idx];
+        if (!statuses[table_idx].ok() || LoadFromCheckpoint(t)) {
+          continue;
+        }
+        statuses[table_idx] = ScanTable(t);
+        if (statuses[table_idx].ok()) {
+          SaveToCheckpoint(*t);
+        }
+      }
+    });
+
+    const size_t max_threads = static_cast<size_t>(
+        std::max(db_options_.max_file_opening_threads, 1));
+    std::vector<port::Thread> threads;
+    for (size_t i = 1; i < std::min(max_threads, tables.size()); i++) {
+      threads.emplace_back(scan_tables_func);
+    }
+    scan_tables_func();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < tables.size(); i++) {
+      const TableInfo& t = tables[i];
+      const Status& status = statuses[i];
       if (!status.ok()) {
         std::string fname = TableFileName(
             db_options_.db_paths, t.meta.fd.GetNumber(), t.meta.fd.GetPathId());
@@ -496,10 +655,11 @@ class Repairer {
     }
   }
 
-  Status ScanTable(TableInfo* t) {
+  // Sets the size and column family of `t`, creating the column family if
+  // needed.
+  Status GetTableColumnFamily(TableInfo* t) {
     std::string fname = TableFileName(
         db_options_.db_paths, t->meta.fd.GetNumber(), t->meta.fd.GetPathId());
-    int counter = 0;
     uint64_t file_size;
     Status status = env_->GetFileSize(fname, &file_size);
     t->meta.fd = FileDescriptor(t->meta.fd.GetNumber(), t->meta.fd.GetPathId(),
@@ -529,9 +689,9 @@ class Repairer {
       }
       t->meta.oldest_ancester_time = props->creation_time;
     }
-    ColumnFamilyData* cfd = nullptr;
     if (status.ok()) {
-      cfd = vset_.GetColumnFamilySet()->GetColumnFamily(t->column_family_id);
+      ColumnFamilyData* cfd =
+          vset_.GetColumnFamilySet()->GetColumnFamily(t->column_family_id);
       if (cfd->GetName() != props->column_family_name) {
         ROCKS_LOG_ERROR(
             db_options_.info_log,
@@ -543,7 +703,18 @@ class Repairer {
         status = Status::Corruption(dbname_, "inconsistent column family name");
       }
     }
-    if (status.ok()) {
+    return status;
+  }
+
+  // Computes the boundaries of `t`, whose column family exists. Thread-safe.
+  Status ScanTable(TableInfo* t) {
+    TEST_SYNC_POINT_CALLBACK("Repairer::ScanTable", t);
+    ColumnFamilyData* cfd =
+        vset_.GetColumnFamilySet()->GetColumnFamily(t->column_family_id);
+    assert(cfd != nullptr);
+    int counter = 0;
+    Status status;
+    {
       ReadOptions ropts;
       ropts.total_order_seek = true;
       InternalIterator* iter = table_cache_->NewIterator(
@@ -401,6 +401,50 @@ TEST_F(RepairTest, DbNameContainsTrailingSlash) {
   Reopen(CurrentOptions());
   ASSERT_EQ(Get("key"), "val");
 }
+
+TEST_F(RepairTest, ResumeInterruptedRepair) {
+  // Scan the tables on several threads, fail the repair after the scan, and
+  // verify the next repair takes the tables from the checkpoint.
+  Options options = CurrentOptions();
+  options.max_file_opening_threads = 4;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_OK(Put("key" + ToString(i), "val" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+  std::string manifest_path =
+      DescriptorFileName(dbname_, dbfull()->TEST_Current_Manifest_FileNo());
+  Close();
+  ASSERT_OK(env_->DeleteFile(manifest_path));
+
+  std::atomic<int> num_scans(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "Repairer::ScanTable", [&](void* /*arg*/) { ++num_scans; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "Repairer::Run:AfterExtractMetaData", [&](void* arg) {
+        *static_cast<Status*>(arg) = Status::IOError("injected");
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_NOK(RepairDB(dbname_, options));
+  ASSERT_EQ(8, num_scans.load());
+  ASSERT_OK(env_->FileExists(RepairCheckpointFileName(dbname_)));
+
+  num_scans = 0;
+  SyncPoint::GetInstance()->ClearCallBack(
+      "Repairer::Run:AfterExtractMetaData");
+  ASSERT_OK(RepairDB(dbname_, options));
+  ASSERT_EQ(0, num_scans.load());
+  ASSERT_TRUE(
+      env_->FileExists(RepairCheckpointFileName(dbname_)).IsNotFound());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  Reopen(options);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_EQ(Get("key" + ToString(i)), "val" + ToString(i));
+  }
+}
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
 
@@ -10,13 +10,17 @@
 #pragma once
 #include <vector>
 
+#include "port/port.h"
 #include "rocksdb/db.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 class SnapshotList;
 
-// Snapshots are kept in a doubly-linked list in the DB.
+// Snapshots are kept in a doubly-linked list in the DB, under a mutex of its
+// own rather than the DB mutex, so that taking and releasing snapshots does
+// not contend with flushes, compactions and other work under the DB mutex.
 // Each SnapshotImpl corresponds to a particular sequence number.
 class SnapshotImpl : public Snapshot {
  public:
@@ -59,12 +63,14 @@ class SnapshotList {
   // No copy-construct.
   SnapshotList(const SnapshotList&) = delete;
 
-  bool empty() const { return list_.next_ == &list_; }
-  SnapshotImpl* oldest() const { assert(!empty()); return list_.next_; }
-  SnapshotImpl* newest() const { assert(!empty()); return list_.prev_; }
+  bool empty() const {
+    MutexLock l(&mutex_);
+    return EmptyLocked();
+  }
 
   SnapshotImpl* New(SnapshotImpl* s, SequenceNumber seq, uint64_t unix_time,
                     bool is_write_conflict_boundary) {
+    MutexLock l(&mutex_);
     s->number_ = seq;
     s->unix_time_ = unix_time;
     s->is_write_conflict_boundary_ = is_write_conflict_boundary;
@@ -79,6 +85,7 @@ class SnapshotList {
 
   // Do not responsible to free the object.
   void Delete(const SnapshotImpl* s) {
+    MutexLock l(&mutex_);
     assert(s->list_ == this);
     s->prev_->next_ = s->next_;
     s->next_->prev_ = s->prev_;
@@ -106,7 +113,8 @@ class SnapshotList {
       *oldest_write_conflict_snapshot = kMaxSequenceNumber;
     }
 
-    if (empty()) {
+    MutexLock l(&mutex_);
+    if (EmptyLocked()) {
       return;
     }
     const SnapshotImpl* s = &list_;
@@ -134,31 +142,51 @@ class SnapshotList {
 
   // get the sequence number of the most recent snapshot
   SequenceNumber GetNewest() {
-    if (empty()) {
+    MutexLock l(&mutex_);
+    if (EmptyLocked()) {
       return 0;
     }
-    return newest()->number_;
+    return list_.prev_->number_;
   }
 
   int64_t GetOldestSnapshotTime() const {
-    if (empty()) {
+    MutexLock l(&mutex_);
+    if (EmptyLocked()) {
       return 0;
     } else {
-      return oldest()->unix_time_;
+      return list_.next_->unix_time_;
     }
   }
 
   int64_t GetOldestSnapshotSequence() const {
-    if (empty()) {
+    MutexLock l(&mutex_);
+    if (EmptyLocked()) {
       return 0;
     } else {
-      return oldest()->GetSequenceNumber();
+      return list_.next_->GetSequenceNumber();
+    }
+  }
+
+  // Sets *seq to the sequence number of the oldest snapshot. Returns false,
+  // leaving *seq alone, if there is none.
+  bool GetOldest(SequenceNumber* seq) const {
+    MutexLock l(&mutex_);
+    if (EmptyLocked()) {
+      return false;
     }
+    *seq = list_.next_->number_;
+    return true;
   }
 
-  uint64_t count() const { return count_; }
+  uint64_t count() const {
+    MutexLock l(&mutex_);
+    return count_;
+  }
 
  private:
+  bool EmptyLocked() const { return list_.next_ == &list_; }
+
+  mutable port::Mutex mutex_;
   // Dummy head of doubly-linked list of snapshots
   SnapshotImpl list_;
   uint64_t count_;
@@ -385,10 +385,7 @@ bool TableCache::GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
                                  ioptions_.row_cache.get(), row_handle);
     replayGetContextLog(*found_row_cache_entry, user_key, get_context,
                         &value_pinner);
-    RecordTick(ioptions_.stats, ROW_CACHE_HIT);
     found = true;
-  } else {
-    RecordTick(ioptions_.stats, ROW_CACHE_MISS);
   }
   return found;
 }
@@ -415,7 +412,10 @@ Status TableCache::Get(const ReadOptions& options,
     CreateRowCacheKeyPrefix(options, fd, k, get_context, row_cache_key);
     done = GetFromRowCache(user_key, row_cache_key, row_cache_key.Size(),
                            get_context);
-    if (!done) {
+    if (done) {
+      RecordTick(ioptions_.stats, ROW_CACHE_HIT);
+    } else {
+      RecordTick(ioptions_.stats, ROW_CACHE_MISS);
       row_cache_entry = &row_cache_entry_buffer;
     }
   }
@@ -510,6 +510,9 @@ Status TableCache::MultiGet(const ReadOptions& options,
                             row_cache_key);
     row_cache_key_prefix_size = row_cache_key.Size();
 
+    // Keys found in the row cache are skipped below, so only the misses
+    // reach the table reader. Tickers are recorded once for the batch.
+    uint64_t num_hits = 0;
     for (auto miter = table_range.begin(); miter != table_range.end();
          ++miter) {
       const Slice& user_key = miter->ukey_with_ts;
@@ -519,11 +522,14 @@ Status TableCache::MultiGet(const ReadOptions& options,
       if (GetFromRowCache(user_key, row_cache_key, row_cache_key_prefix_size,
                           get_context)) {
         table_range.SkipKey(miter);
+        num_hits++;
       } else {
         row_cache_entries.emplace_back();
         get_context->SetReplayLog(&(row_cache_entries.back()));
       }
     }
+    RecordTick(ioptions_.stats, ROW_CACHE_HIT, num_hits);
+    RecordTick(ioptions_.stats, ROW_CACHE_MISS, row_cache_entries.size());
   }
 #endif  // ROCKSDB_LITE
 
@@ -577,15 +583,14 @@ Status TableCache::MultiGet(const ReadOptions& options,
          ++miter) {
       std::string& row_cache_entry = row_cache_entries[row_idx++];
       const Slice& user_key = miter->ukey_with_ts;
-      ;
       GetContext* get_context = miter->get_context;
 
       get_context->SetReplayLog(nullptr);
-      // Compute row cache key.
-      row_cache_key.TrimAppend(row_cache_key_prefix_size, user_key.data(),
-                               user_key.size());
       // Put the replay log in row cache only if something was found.
       if (s.ok() && !row_cache_entry.empty()) {
+        // Compute row cache key.
+        row_cache_key.TrimAppend(row_cache_key_prefix_size, user_key.data(),
+                                 user_key.size());
         size_t charge =
             row_cache_key.Size() + row_cache_entry.size() + sizeof(std::string);
         void* row_ptr = new std::string(std::move(row_cache_entry));
@@ -605,6 +610,33 @@ Status TableCache::MultiGet(const ReadOptions& options,
   return s;
 }
 
+void TableCache::PrefetchForMultiGet(
+    const ReadOptions& options,
+    const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, const MultiGetContext::Range* mget_range,
+    const SliceTransform* prefix_extractor, HistogramImpl* file_read_hist,
+    bool skip_filters, int level) {
+  auto& fd = file_meta.fd;
+  TableReader* t = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (t == nullptr) {
+    Status s = FindTable(
+        options, file_options_, internal_comparator, fd, &handle,
+        prefix_extractor, options.read_tier == kBlockCacheTier /* no_io */,
+        true /* record_read_stats */, file_read_hist, skip_filters, level);
+    if (!s.ok()) {
+      // The following MultiGet() will run into and report the same error.
+      s.PermitUncheckedError();
+      return;
+    }
+    t = GetTableReaderFromHandle(handle);
+  }
+  t->PrefetchForMultiGet(options, mget_range, prefix_extractor, skip_filters);
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
+}
+
 Status TableCache::GetTableProperties(
     const FileOptions& file_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
@@ -711,4 +743,114 @@ uint64_t TableCache::ApproximateSize(
 
   return result;
 }
+
+uint64_t TableCache::ApproximateNumEntries(
+    const Slice& start, const Slice& end, const FileDescriptor& fd,
+    TableReaderCaller caller, const InternalKeyComparator& internal_comparator,
+    const SliceTransform* prefix_extractor) {
+  uint64_t result = 0;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* table_handle = nullptr;
+  if (table_reader == nullptr) {
+    const bool for_compaction = (caller == TableReaderCaller::kCompaction);
+    Status s = FindTable(ReadOptions(), file_options_, internal_comparator, fd,
+                         &table_handle, prefix_extractor, false /* no_io */,
+                         !for_compaction /* record_read_stats */);
+    if (s.ok()) {
+      table_reader = GetTableReaderFromHandle(table_handle);
+    }
+  }
+
+  if (table_reader != nullptr) {
+    Status s =
+        table_reader->ApproximateNumEntries(start, end, caller, &result);
+    if (s.IsNotSupported()) {
+      result = 0;
+      auto props = table_reader->GetTableProperties();
+      if (props != nullptr && fd.GetFileSize() > 0) {
+        double size_ratio =
+            static_cast<double>(
+                table_reader->ApproximateSize(start, end, caller)) /
+            static_cast<double>(fd.GetFileSize());
+        result = static_cast<uint64_t>(
+            std::min(size_ratio, 1.0) *
+            static_cast<double>(props->num_entries));
+      }
+    }
+  }
+  if (table_handle != nullptr) {
+    ReleaseHandle(table_handle);
+  }
+
+  return result;
+}
+
+Status TableCache::ApproximateKeyAnchors(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileDescriptor& fd, std::vector<TableReader::Anchor>* anchors,
+    const SliceTransform* prefix_extractor) {
+  Status s;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* table_handle = nullptr;
+  if (table_reader == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, fd, &table_handle,
+                  prefix_extractor, ro.read_tier == kBlockCacheTier /* no_io */);
+    if (s.ok()) {
+      table_reader = GetTableReaderFromHandle(table_handle);
+    }
+  }
+  if (s.ok()) {
+    s = table_reader->ApproximateKeyAnchors(ro, anchors);
+  }
+  if (table_handle != nullptr) {
+    ReleaseHandle(table_handle);
+  }
+  return s;
+}
+
+Status TableCache::GetBlockCacheKeyPrefix(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileDescriptor& fd, std::string* prefix,
+    const SliceTransform* prefix_extractor) {
+  Status s;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* table_handle = nullptr;
+  if (table_reader == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, fd, &table_handle,
+                  prefix_extractor, ro.read_tier == kBlockCacheTier /* no_io */);
+    if (s.ok()) {
+      table_reader = GetTableReaderFromHandle(table_handle);
+    }
+  }
+  if (s.ok()) {
+    *prefix = table_reader->GetBlockCacheKeyPrefix().ToString();
+  }
+  if (table_handle != nullptr) {
+    ReleaseHandle(table_handle);
+  }
+  return s;
+}
+
+Status TableCache::WarmUpBlockCache(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileDescriptor& fd, const std::vector<uint64_t>& block_offsets,
+    const SliceTransform* prefix_extractor) {
+  Status s;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* table_handle = nullptr;
+  if (table_reader == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, fd, &table_handle,
+                  prefix_extractor);
+    if (s.ok()) {
+      table_reader = GetTableReaderFromHandle(table_handle);
+    }
+  }
+  if (s.ok()) {
+    s = table_reader->WarmUpBlockCache(ro, block_offsets);
+  }
+  if (table_handle != nullptr) {
+    ReleaseHandle(table_handle);
+  }
+  return s;
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -122,6 +122,17 @@ class TableCache {
                   HistogramImpl* file_read_hist = nullptr,
                   bool skip_filters = false, int level = -1);
 
+  // Starts asynchronous reads of the blocks that a subsequent MultiGet() of
+  // mget_range in this file would need, without waiting for them. Errors are
+  // ignored; the MultiGet() will hit and report them.
+  void PrefetchForMultiGet(const ReadOptions& options,
+                           const InternalKeyComparator& internal_comparator,
+                           const FileMetaData& file_meta,
+                           const MultiGetContext::Range* mget_range,
+                           const SliceTransform* prefix_extractor = nullptr,
+                           HistogramImpl* file_read_hist = nullptr,
+                           bool skip_filters = false, int level = -1);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
@@ -179,6 +190,39 @@ class TableCache {
                            const InternalKeyComparator& internal_comparator,
                            const SliceTransform* prefix_extractor = nullptr);
 
+  // Returns the approximate number of entries between start and end keys in
+  // a file represented by fd (the start key must not be greater than the
+  // end key). Pro-rates the entries of the file by ApproximateSize() if the
+  // table reader cannot estimate the number itself.
+  uint64_t ApproximateNumEntries(
+      const Slice& start, const Slice& end, const FileDescriptor& fd,
+      TableReaderCaller caller,
+      const InternalKeyComparator& internal_comparator,
+      const SliceTransform* prefix_extractor = nullptr);
+
+  // Appends the key anchors of the file represented by fd to *anchors. See
+  // TableReader::ApproximateKeyAnchors().
+  Status ApproximateKeyAnchors(const ReadOptions& ro,
+                               const InternalKeyComparator& internal_comparator,
+                               const FileDescriptor& fd,
+                               std::vector<TableReader::Anchor>* anchors,
+                               const SliceTransform* prefix_extractor = nullptr);
+
+  // Sets *prefix to the block cache key prefix of the file represented by
+  // fd. See TableReader::GetBlockCacheKeyPrefix().
+  Status GetBlockCacheKeyPrefix(
+      const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+      const FileDescriptor& fd, std::string* prefix,
+      const SliceTransform* prefix_extractor = nullptr);
+
+  // Loads the given data blocks of the file represented by fd into the block
+  // cache. See TableReader::WarmUpBlockCache().
+  Status WarmUpBlockCache(const ReadOptions& ro,
+                          const InternalKeyComparator& internal_comparator,
+                          const FileDescriptor& fd,
+                          const std::vector<uint64_t>& block_offsets,
+                          const SliceTransform* prefix_extractor = nullptr);
+
   // Release the handle from a cache
   void ReleaseHandle(Cache::Handle* handle);
 
@@ -217,7 +261,8 @@ class TableCache {
                                GetContext* get_context, IterKey& row_cache_key);
 
   // Helper function to lookup the row cache for a key. It appends the
-  // user key to row_cache_key at offset prefix_size
+  // user key to row_cache_key at offset prefix_size. The caller records the
+  // ROW_CACHE_HIT/ROW_CACHE_MISS tickers.
   bool GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
                        size_t prefix_size, GetContext* get_context);
 
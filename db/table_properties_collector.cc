@@ -59,6 +59,45 @@ UserKeyTablePropertiesCollector::GetReadableProperties() const {
   return collector_->GetReadableProperties();
 }
 
+Status TimestampTablePropertiesCollector::InternalAdd(
+    const Slice& key, const Slice& /* value */, uint64_t /* file_size */) {
+  const size_t ts_sz = ucmp_->timestamp_size();
+  if (key.size() < kNumInternalBytes + ts_sz) {
+    return Status::Corruption("Key too short for its timestamp");
+  }
+  Slice ts = ExtractTimestampFromUserKey(ExtractUserKey(key), ts_sz);
+  if (min_timestamp_.empty() ||
+      ucmp_->CompareTimestamp(ts, min_timestamp_) < 0) {
+    min_timestamp_.assign(ts.data(), ts.size());
+  }
+  if (max_timestamp_.empty() ||
+      ucmp_->CompareTimestamp(ts, max_timestamp_) > 0) {
+    max_timestamp_.assign(ts.data(), ts.size());
+  }
+  return Status::OK();
+}
+
+Status TimestampTablePropertiesCollector::Finish(
+    UserCollectedProperties* properties) {
+  if (!min_timestamp_.empty()) {
+    properties->emplace(TablePropertiesNames::kTimestampMin, min_timestamp_);
+    properties->emplace(TablePropertiesNames::kTimestampMax, max_timestamp_);
+  }
+  return Status::OK();
+}
+
+UserCollectedProperties
+TimestampTablePropertiesCollector::GetReadableProperties() const {
+  if (min_timestamp_.empty()) {
+    return UserCollectedProperties{};
+  }
+  return UserCollectedProperties{
+      {TablePropertiesNames::kTimestampMin,
+       Slice(min_timestamp_).ToString(true /* hex */)},
+      {TablePropertiesNames::kTimestampMax,
+       Slice(max_timestamp_).ToString(true /* hex */)}};
+}
+
 uint64_t GetDeletedKeys(
     const UserCollectedProperties& props) {
   bool property_present_ignored;
@@ -6,6 +6,7 @@
 // This file defines a collection of statistics collectors.
 #pragma once
 
+#include "rocksdb/comparator.h"
 #include "rocksdb/table_properties.h"
 
 #include <memory>
@@ -107,4 +108,51 @@ class UserKeyTablePropertiesCollectorFactory
   std::shared_ptr<TablePropertiesCollectorFactory> user_collector_factory_;
 };
 
+// Records the oldest and newest user-defined timestamps of a table, so that
+// reads at an older timestamp can skip it.
+class TimestampTablePropertiesCollector : public IntTblPropCollector {
+ public:
+  explicit TimestampTablePropertiesCollector(const Comparator* ucmp)
+      : ucmp_(ucmp) {}
+
+  virtual Status InternalAdd(const Slice& key, const Slice& value,
+                             uint64_t file_size) override;
+
+  virtual void BlockAdd(uint64_t /* block_raw_bytes */,
+                        uint64_t /* block_compressed_bytes_fast */,
+                        uint64_t /* block_compressed_bytes_slow */) override {}
+
+  virtual Status Finish(UserCollectedProperties* properties) override;
+
+  virtual const char* Name() const override {
+    return "TimestampTablePropertiesCollector";
+  }
+
+  UserCollectedProperties GetReadableProperties() const override;
+
+ private:
+  const Comparator* ucmp_;
+  std::string min_timestamp_;
+  std::string max_timestamp_;
+};
+
+class TimestampTablePropertiesCollectorFactory
+    : public IntTblPropCollectorFactory {
+ public:
+  explicit TimestampTablePropertiesCollectorFactory(const Comparator* ucmp)
+      : ucmp_(ucmp) {}
+
+  virtual IntTblPropCollector* CreateIntTblPropCollector(
+      uint32_t /* column_family_id */) override {
+    return new TimestampTablePropertiesCollector(ucmp_);
+  }
+
+  virtual const char* Name() const override {
+    return "TimestampTablePropertiesCollectorFactory";
+  }
+
+ private:
+  const Comparator* ucmp_;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -189,6 +189,10 @@ class VersionBuilder::Rep {
   // Metadata delta for all blob files affected by the series of version edits.
   std::map<uint64_t, BlobFileMetaDataDelta> blob_file_meta_deltas_;
 
+  // The result of checking the base version, which does not change, once
+  bool base_checked_ = false;
+  Status base_check_status_;
+
  public:
   Rep(const FileOptions& file_options, const ImmutableCFOptions* ioptions,
       TableCache* table_cache, VersionStorageInfo* base_vstorage,
@@ -270,6 +274,14 @@ class VersionBuilder::Rep {
     (*expected_linked_ssts)[blob_file_number].emplace(table_file_number);
   }
 
+  static bool FilesOverlap(VersionStorageInfo* vstorage, const FileMetaData* f1,
+                           const FileMetaData* f2) {
+    const Comparator* ucmp = vstorage->InternalComparator()->user_comparator();
+    return ucmp->Compare(f1->smallest.user_key(), f2->largest.user_key()) <=
+               0 &&
+           ucmp->Compare(f2->smallest.user_key(), f1->largest.user_key()) <= 0;
+  }
+
   Status CheckConsistencyDetails(VersionStorageInfo* vstorage) {
     // Make sure the files are sorted correctly and that the links between
     // table files and blob files are consistent. The latter is checked using
@@ -306,7 +318,12 @@ class VersionBuilder::Rep {
             return Status::Corruption("L0 files are not sorted properly");
           }
 
-          if (f2->fd.smallest_seqno == f2->fd.largest_seqno) {
+          if (f1->fd.smallest_seqno == f2->fd.smallest_seqno &&
+              f1->fd.largest_seqno == f2->fd.largest_seqno &&
+              !FilesOverlap(vstorage, f1, f2)) {
+            // Outputs of a partitioned flush share the sequence number range
+            // of the flush and cover disjoint key ranges.
+          } else if (f2->fd.smallest_seqno == f2->fd.largest_seqno) {
             // This is an external file that we ingested
             SequenceNumber external_file_seqno = f2->fd.smallest_seqno;
             if (!(external_file_seqno < f1->fd.largest_seqno ||
@@ -412,6 +429,17 @@ class VersionBuilder::Rep {
     return s;
   }
 
+  // Checks the base version the first time it is called, and returns the
+  // same result afterwards, so that applying an edit does not take time
+  // linear in the number of files.
+  Status CheckBaseConsistency() {
+    if (!base_checked_) {
+      base_check_status_ = CheckConsistency(base_vstorage_);
+      base_checked_ = true;
+    }
+    return base_check_status_;
+  }
+
   bool CheckConsistencyForNumLevels() const {
     // Make sure there are no files on or beyond num_levels().
     if (has_invalid_levels_) {
@@ -655,7 +683,7 @@ class VersionBuilder::Rep {
   // Apply all of the edits in *edit to the current state.
   Status Apply(VersionEdit* edit) {
     {
-      const Status s = CheckConsistency(base_vstorage_);
+      const Status s = CheckBaseConsistency();
       if (!s.ok()) {
         return s;
       }
@@ -858,7 +886,7 @@ class VersionBuilder::Rep {
 
   // Save the current state in *vstorage.
   Status SaveTo(VersionStorageInfo* vstorage) {
-    Status s = CheckConsistency(base_vstorage_);
+    Status s = CheckBaseConsistency();
     if (!s.ok()) {
       return s;
     }
@@ -868,6 +896,13 @@ class VersionBuilder::Rep {
       return s;
     }
 
+    size_t max_num_files = 0;
+    for (int level = 0; level < num_levels_; level++) {
+      max_num_files += base_vstorage_->LevelFiles(level).size() +
+                       levels_[level].added_files.size();
+    }
+    vstorage->ReserveFileLocations(max_num_files);
+
     for (int level = 0; level < num_levels_; level++) {
       const auto& cmp = (level == 0) ? level_zero_cmp_ : level_nonzero_cmp_;
       // Merge the set of added files with the set of pre-existing files.
@@ -877,6 +912,16 @@ class VersionBuilder::Rep {
       vstorage->Reserve(level,
                         base_files.size() + unordered_added_files.size());
 
+      // Most edits only touch a level or two; the other levels are taken
+      // over as they are
+      if (unordered_added_files.empty() &&
+          levels_[level].deleted_files.empty()) {
+        for (FileMetaData* f : base_files) {
+          vstorage->AddFile(level, f);
+        }
+        continue;
+      }
+
       // Sort added files for the level.
       std::vector<FileMetaData*> added_files;
       added_files.reserve(unordered_added_files.size());
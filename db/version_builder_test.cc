@@ -346,6 +346,57 @@ TEST_F(VersionBuilderTest, ApplyMultipleAndSaveTo) {
   UnrefFilesInVersion(&new_vstorage);
 }
 
+TEST_F(VersionBuilderTest, ApplyMultipleEditsToOneLevel) {
+  Add(0, 1U, "150", "200", 100U);
+  Add(4, 6U, "150", "179", 100U);
+  Add(4, 7U, "180", "220", 100U);
+  Add(5, 26U, "150", "170", 100U);
+  UpdateVersionStorageInfo();
+
+  int num_checks = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "VersionBuilder::CheckConsistencyBeforeReturn",
+      [&](void* /* arg */) { ++num_checks; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  EnvOptions env_options;
+  constexpr TableCache* table_cache = nullptr;
+  constexpr VersionSet* version_set = nullptr;
+
+  VersionBuilder version_builder(env_options, &ioptions_, table_cache,
+                                 &vstorage_, version_set);
+
+  for (uint64_t i = 0; i < 3; ++i) {
+    const std::string smallest = ToString(300 + i * 10);
+    const std::string largest = ToString(305 + i * 10);
+    VersionEdit version_edit;
+    version_edit.AddFile(3, 666 + i, 0, 100U, GetInternalKey(smallest.c_str()),
+                         GetInternalKey(largest.c_str()), 200, 200, false,
+                         kInvalidBlobFileNumber, kUnknownOldestAncesterTime,
+                         kUnknownFileCreationTime, kUnknownFileChecksum,
+                         kUnknownFileChecksumFuncName);
+    ASSERT_OK(version_builder.Apply(&version_edit));
+  }
+
+  VersionStorageInfo new_vstorage(&icmp_, ucmp_, options_.num_levels,
+                                  kCompactionStyleLevel, nullptr, false);
+  ASSERT_OK(version_builder.SaveTo(&new_vstorage));
+
+  // The base version is checked once, and the new one once
+  ASSERT_EQ(num_checks, 2);
+
+  ASSERT_EQ(300U, new_vstorage.NumLevelBytes(3));
+  for (int level : {0, 4, 5}) {
+    ASSERT_EQ(vstorage_.LevelFiles(level), new_vstorage.LevelFiles(level));
+  }
+  ASSERT_EQ(new_vstorage.GetFileLocation(7U).GetLevel(), 4);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  UnrefFilesInVersion(&new_vstorage);
+}
+
 TEST_F(VersionBuilderTest, ApplyDeleteAndSaveTo) {
   UpdateVersionStorageInfo();
 
@@ -147,15 +147,18 @@ struct FileDescriptor {
 };
 
 struct FileSampledStats {
-  FileSampledStats() : num_reads_sampled(0) {}
+  FileSampledStats() : num_reads_sampled(0), bytes_read_sampled(0) {}
   FileSampledStats(const FileSampledStats& other) { *this = other; }
   FileSampledStats& operator=(const FileSampledStats& other) {
     num_reads_sampled = other.num_reads_sampled.load();
+    bytes_read_sampled = other.bytes_read_sampled.load();
     return *this;
   }
 
   // number of user reads to this file.
   mutable std::atomic<uint64_t> num_reads_sampled;
+  // number of bytes user reads read from this file.
+  mutable std::atomic<uint64_t> bytes_read_sampled;
 };
 
 struct FileMetaData {
@@ -510,6 +510,11 @@ Status VersionEditHandler::LoadTables(ColumnFamilyData* cfd,
   if (skip_load_table_files_) {
     return Status::OK();
   }
+  if (is_initial_load &&
+      version_set_->db_options_->open_table_files_in_background) {
+    // DBImpl opens them once the DB is open
+    return Status::OK();
+  }
   assert(cfd != nullptr);
   assert(!cfd->IsDropped());
   auto builder_iter = builders_.find(cfd->GetID());
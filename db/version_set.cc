@@ -18,12 +18,15 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "cache/cache_entry_roles.h"
 #include "compaction/compaction.h"
 #include "db/blob/blob_fetcher.h"
 #include "db/blob/blob_file_cache.h"
 #include "db/blob/blob_file_reader.h"
+#include "db/blob/blob_prefetcher.h"
 #include "db/blob/blob_index.h"
 #include "db/internal_stats.h"
 #include "db/log_reader.h"
@@ -40,6 +43,7 @@
 #include "file/read_write_util.h"
 #include "file/writable_file_writer.h"
 #include "monitoring/file_read_sample.h"
+#include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
 #include "options/options_helper.h"
@@ -66,6 +70,12 @@ namespace ROCKSDB_NAMESPACE {
 
 namespace {
 
+void ReleaseBlobCacheHandle(void* arg1, void* arg2) {
+  Cache* const cache = static_cast<Cache*>(arg1);
+  Cache::Handle* const handle = static_cast<Cache::Handle*>(arg2);
+  cache->Release(handle);
+}
+
 // Find File in LevelFilesBrief data structure
 // Within an index range defined by left and right
 int FindFileInRange(const InternalKeyComparator& icmp,
@@ -121,7 +131,8 @@ class FilePicker {
              const Slice& ikey, autovector<LevelFilesBrief>* file_levels,
              unsigned int num_levels, FileIndexer* file_indexer,
              const Comparator* user_comparator,
-             const InternalKeyComparator* internal_comparator)
+             const InternalKeyComparator* internal_comparator,
+             const std::vector<LevelFilesBrief>* level0_sublevels = nullptr)
       : num_levels_(num_levels),
         curr_level_(static_cast<unsigned int>(-1)),
         returned_file_level_(static_cast<unsigned int>(-1)),
@@ -132,6 +143,8 @@ class FilePicker {
         files_(files),
 #endif
         level_files_brief_(file_levels),
+        level0_sublevels_(level0_sublevels),
+        use_level0_sublevels_(false),
         is_hit_file_last_in_level_(false),
         curr_file_level_(nullptr),
         user_key_(user_key),
@@ -159,12 +172,14 @@ class FilePicker {
 
   FdWithKeyRange* GetNextFile() {
     while (!search_ended_) {  // Loops over different levels.
-      while (curr_index_in_curr_level_ < curr_file_level_->num_files) {
+      while (curr_index_in_curr_level_ < NumFilesInCurrLevel()) {
         // Loops over all files in current level.
-        FdWithKeyRange* f = &curr_file_level_->files[curr_index_in_curr_level_];
+        FdWithKeyRange* f = FileInCurrLevel(curr_index_in_curr_level_);
         hit_file_level_ = curr_level_;
         is_hit_file_last_in_level_ =
-            curr_index_in_curr_level_ == curr_file_level_->num_files - 1;
+            f->file_metadata ==
+            curr_file_level_->files[curr_file_level_->num_files - 1]
+                .file_metadata;
         int cmp_largest = -1;
 
         // Do key range filtering of files or/and fractional cascading if:
@@ -218,6 +233,9 @@ class FilePicker {
             int comp_sign = internal_comparator_->Compare(
                 prev_file_->largest_key, f->smallest_key);
             assert(comp_sign < 0);
+          } else if (use_level0_sublevels_) {
+            assert(!NewestFirstBySeqNo(f->file_metadata,
+                                       prev_file_->file_metadata));
           } else {
             // level == 0, the current file cannot be newer than the previous
             // one. Use compressed data structure, has no attribute seqNo
@@ -263,6 +281,12 @@ class FilePicker {
   std::vector<FileMetaData*>* files_;
 #endif
   autovector<LevelFilesBrief>* level_files_brief_;
+  const std::vector<LevelFilesBrief>* level0_sublevels_;
+  // Whether L0 is searched through level0_candidates_
+  bool use_level0_sublevels_;
+  // The L0 files that may hold the key, one per sublevel at most, newest
+  // first
+  autovector<FdWithKeyRange*> level0_candidates_;
   bool search_ended_;
   bool is_hit_file_last_in_level_;
   LevelFilesBrief* curr_file_level_;
@@ -277,6 +301,34 @@ class FilePicker {
   FdWithKeyRange* prev_file_;
 #endif
 
+  size_t NumFilesInCurrLevel() const {
+    return curr_level_ == 0 && use_level0_sublevels_
+               ? level0_candidates_.size()
+               : curr_file_level_->num_files;
+  }
+
+  FdWithKeyRange* FileInCurrLevel(size_t index) const {
+    return curr_level_ == 0 && use_level0_sublevels_
+               ? level0_candidates_[index]
+               : &curr_file_level_->files[index];
+  }
+
+  // Collect into level0_candidates_ the file of each L0 sublevel that may
+  // hold the key, found by binary search
+  void PrepareLevel0Candidates() {
+    level0_candidates_.clear();
+    for (const LevelFilesBrief& sublevel : *level0_sublevels_) {
+      size_t index =
+          static_cast<size_t>(FindFile(*internal_comparator_, sublevel, ikey_));
+      if (index < sublevel.num_files &&
+          user_comparator_->CompareWithoutTimestamp(
+              user_key_, ExtractUserKey(sublevel.files[index].smallest_key)) >=
+              0) {
+        level0_candidates_.push_back(&sublevel.files[index]);
+      }
+    }
+  }
+
   // Setup local variables to search next level.
   // Returns false if there are no more levels to search.
   bool PrepareNextLevel() {
@@ -305,8 +357,16 @@ class FilePicker {
       // are always compacted into a single entry).
       int32_t start_index;
       if (curr_level_ == 0) {
-        // On Level-0, we read through all files to check for overlap.
+        // On Level-0, we read through all files to check for overlap, unless
+        // they fall into fewer sublevels of disjoint files: then only the
+        // file of each sublevel that may hold the key is read.
         start_index = 0;
+        use_level0_sublevels_ =
+            level0_sublevels_ != nullptr && !level0_sublevels_->empty() &&
+            level0_sublevels_->size() < curr_file_level_->num_files;
+        if (use_level0_sublevels_) {
+          PrepareLevel0Candidates();
+        }
       } else {
         // On Level-n (n>=1), files are sorted. Binary search to find the
         // earliest file whose largest key >= ikey. Search left bound and
@@ -891,7 +951,8 @@ class LevelIterator final : public InternalIterator {
                 bool skip_filters, int level, RangeDelAggregator* range_del_agg,
                 const std::vector<AtomicCompactionUnitBoundary>*
                     compaction_boundaries = nullptr,
-                bool allow_unprepared_value = false)
+                bool allow_unprepared_value = false,
+                size_t max_file_size_for_l0_meta_pin = 0)
       : table_cache_(table_cache),
         read_options_(read_options),
         file_options_(file_options),
@@ -908,7 +969,8 @@ class LevelIterator final : public InternalIterator {
         level_(level),
         range_del_agg_(range_del_agg),
         pinned_iters_mgr_(nullptr),
-        compaction_boundaries_(compaction_boundaries) {
+        compaction_boundaries_(compaction_boundaries),
+        max_file_size_for_l0_meta_pin_(max_file_size_for_l0_meta_pin) {
     // Empty level is not supported.
     assert(flevel_ != nullptr && flevel_->num_files > 0);
   }
@@ -978,6 +1040,9 @@ class LevelIterator final : public InternalIterator {
   void SkipEmptyFileBackward();
   void SetFileIterator(InternalIterator* iter);
   void InitFileIterator(size_t new_file_index);
+  // When a scan crosses into a file, hints the table reader of the file after
+  // it, if already open, to read ahead its start in the background.
+  void PrepareNextFileScan(const ReadaheadFileInfo& readahead_info);
 
   const Slice& file_smallest_key(size_t file_index) {
     assert(file_index < flevel_->num_files);
@@ -991,6 +1056,20 @@ class LevelIterator final : public InternalIterator {
                *read_options_.iterate_upper_bound, /*b_has_ts=*/false) >= 0;
   }
 
+  bool KeyBeforeLowerBound(const Slice& internal_key) {
+    return read_options_.iterate_lower_bound != nullptr &&
+           user_comparator_.CompareWithoutTimestamp(
+               ExtractUserKey(internal_key), /*a_has_ts=*/true,
+               *read_options_.iterate_lower_bound, /*b_has_ts=*/false) < 0;
+  }
+
+  // Leaves the iterator invalid at file_index without opening the file, as
+  // no key of it is within the iterate bounds.
+  void SkipFileOutOfBound(size_t file_index) {
+    file_index_ = file_index;
+    SetFileIterator(nullptr);
+  }
+
   InternalIterator* NewFileIterator() {
     assert(file_index_ < flevel_->num_files);
     auto file_meta = flevel_->files[file_index_];
@@ -1010,7 +1089,7 @@ class LevelIterator final : public InternalIterator {
         range_del_agg_, prefix_extractor_,
         nullptr /* don't need reference to table */, file_read_hist_, caller_,
         /*arena=*/nullptr, skip_filters_, level_,
-        /*max_file_size_for_l0_meta_pin=*/0, smallest_compaction_key,
+        max_file_size_for_l0_meta_pin_, smallest_compaction_key,
         largest_compaction_key, allow_unprepared_value_);
   }
 
@@ -1055,6 +1134,9 @@ class LevelIterator final : public InternalIterator {
   // To be propagated to RangeDelAggregator in order to safely truncate range
   // tombstones.
   const std::vector<AtomicCompactionUnitBoundary>* compaction_boundaries_;
+
+  // Passed to TableCache::NewIterator() for the files of an L0 sublevel
+  size_t max_file_size_for_l0_meta_pin_;
 };
 
 void LevelIterator::Seek(const Slice& target) {
@@ -1074,6 +1156,12 @@ void LevelIterator::Seek(const Slice& target) {
   if (need_to_reseek) {
     TEST_SYNC_POINT("LevelIterator::Seek:BeforeFindFile");
     size_t new_file_index = FindFile(icomparator_, *flevel_, target);
+    if (new_file_index < flevel_->num_files &&
+        KeyReachedUpperBound(file_smallest_key(new_file_index))) {
+      // This file and the ones after it start at or past the upper bound
+      SkipFileOutOfBound(new_file_index);
+      return;
+    }
     InitFileIterator(new_file_index);
   }
 
@@ -1119,6 +1207,11 @@ void LevelIterator::SeekForPrev(const Slice& target) {
   if (new_file_index >= flevel_->num_files) {
     new_file_index = flevel_->num_files - 1;
   }
+  if (KeyBeforeLowerBound(flevel_->files[new_file_index].largest_key)) {
+    // This file and the ones before it end before the lower bound
+    SkipFileOutOfBound(new_file_index);
+    return;
+  }
 
   InitFileIterator(new_file_index);
   if (file_iter_.iter() != nullptr) {
@@ -1129,6 +1222,10 @@ void LevelIterator::SeekForPrev(const Slice& target) {
 }
 
 void LevelIterator::SeekToFirst() {
+  if (KeyReachedUpperBound(file_smallest_key(0))) {
+    SkipFileOutOfBound(0);
+    return;
+  }
   InitFileIterator(0);
   if (file_iter_.iter() != nullptr) {
     file_iter_.SeekToFirst();
@@ -1138,6 +1235,10 @@ void LevelIterator::SeekToFirst() {
 }
 
 void LevelIterator::SeekToLast() {
+  if (KeyBeforeLowerBound(flevel_->files[flevel_->num_files - 1].largest_key)) {
+    SkipFileOutOfBound(flevel_->num_files - 1);
+    return;
+  }
   InitFileIterator(flevel_->num_files - 1);
   if (file_iter_.iter() != nullptr) {
     file_iter_.SeekToLast();
@@ -1193,14 +1294,39 @@ bool LevelIterator::SkipEmptyFileForward() {
       SetFileIterator(nullptr);
       break;
     }
+    // Keep the readahead of a scan going in the next file
+    ReadaheadFileInfo readahead_info;
+    if (file_iter_.iter() != nullptr) {
+      file_iter_.iter()->GetReadaheadState(&readahead_info);
+    }
     InitFileIterator(file_index_ + 1);
     if (file_iter_.iter() != nullptr) {
+      file_iter_.iter()->SetReadaheadState(readahead_info);
       file_iter_.SeekToFirst();
     }
+    PrepareNextFileScan(readahead_info);
   }
   return seen_empty_file;
 }
 
+void LevelIterator::PrepareNextFileScan(
+    const ReadaheadFileInfo& readahead_info) {
+  size_t readahead_size = read_options_.readahead_size > 0
+                              ? read_options_.readahead_size
+                              : readahead_info.readahead_size;
+  if (readahead_size == 0 || file_index_ + 1 >= flevel_->num_files ||
+      KeyReachedUpperBound(file_smallest_key(file_index_ + 1))) {
+    return;
+  }
+  TEST_SYNC_POINT_CALLBACK("LevelIterator::PrepareNextFileScan",
+                           &readahead_size);
+  // Opening the table could block, so only tables kept open are hinted
+  TableReader* table_reader = flevel_->files[file_index_ + 1].fd.table_reader;
+  if (table_reader != nullptr) {
+    table_reader->PrepareScanStart(readahead_size);
+  }
+}
+
 void LevelIterator::SkipEmptyFileBackward() {
   while (file_iter_.iter() == nullptr ||
          (!file_iter_.Valid() && file_iter_.status().ok())) {
@@ -1210,6 +1336,10 @@ void LevelIterator::SkipEmptyFileBackward() {
       SetFileIterator(nullptr);
       return;
     }
+    if (KeyBeforeLowerBound(flevel_->files[file_index_ - 1].largest_key)) {
+      SetFileIterator(nullptr);
+      return;
+    }
     InitFileIterator(file_index_ - 1);
     if (file_iter_.iter() != nullptr) {
       file_iter_.SeekToLast();
@@ -1460,6 +1590,25 @@ size_t Version::GetMemoryUsageByTableReaders() {
   return total_usage;
 }
 
+Status Version::GetKeyAnchors(const ReadOptions& read_options,
+                              std::vector<TableReader::Anchor>* anchors) {
+  assert(anchors != nullptr);
+  for (int level = 0; level < storage_info_.num_non_empty_levels(); level++) {
+    for (const auto& file : storage_info_.LevelFiles(level)) {
+      Status s = table_cache_->ApproximateKeyAnchors(
+          read_options, cfd_->internal_comparator(), file->fd, anchors,
+          mutable_cf_options_.prefix_extractor.get());
+      if (s.IsNotSupported()) {
+        anchors->emplace_back(file->largest.user_key(),
+                              file->fd.GetFileSize());
+      } else if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  return Status::OK();
+}
+
 void Version::GetColumnFamilyMetaData(ColumnFamilyMetaData* cf_meta) {
   assert(cf_meta);
   assert(cfd_);
@@ -1500,6 +1649,8 @@ void Version::GetColumnFamilyMetaData(ColumnFamilyMetaData* cf_meta) {
           file->oldest_blob_file_number, file->TryGetOldestAncesterTime(),
           file->TryGetFileCreationTime(), file->file_checksum,
           file->file_checksum_func_name);
+      files.back().bytes_read_sampled =
+          file->stats.bytes_read_sampled.load(std::memory_order_relaxed);
       files.back().num_entries = file->num_entries;
       files.back().num_deletions = file->num_deletions;
       level_size += file->fd.GetFileSize();
@@ -1516,6 +1667,9 @@ void Version::GetColumnFamilyMetaData(ColumnFamilyMetaData* cf_meta) {
         meta->GetTotalBlobCount(), meta->GetTotalBlobBytes(),
         meta->GetGarbageBlobCount(), meta->GetGarbageBlobBytes(),
         meta->GetChecksumMethod(), meta->GetChecksumValue());
+    cf_meta->blob_files.back().num_reads_sampled = meta->GetNumReadsSampled();
+    cf_meta->blob_files.back().bytes_read_sampled =
+        meta->GetBytesReadSampled();
     cf_meta->blob_file_count++;
     cf_meta->blob_file_size += meta->GetBlobFileSize();
   }
@@ -1628,9 +1782,24 @@ void Version::AddIteratorsForLevel(const ReadOptions& read_options,
 
   auto* arena = merge_iter_builder->GetArena();
   if (level == 0) {
-    // Merge all level zero files together since they may overlap
-    for (size_t i = 0; i < storage_info_.LevelFilesBrief(0).num_files; i++) {
-      const auto& file = storage_info_.LevelFilesBrief(0).files[i];
+    // Merge the level zero sublevels together since they may overlap. The
+    // files of a sublevel do not, so they are walked through like those of
+    // a level > 0, opening them lazily.
+    for (const auto& sublevel : storage_info_.Level0Sublevels()) {
+      if (sublevel.num_files > 1) {
+        auto* mem = arena->AllocateAligned(sizeof(LevelIterator));
+        merge_iter_builder->AddIterator(new (mem) LevelIterator(
+            cfd_->table_cache(), read_options, soptions,
+            cfd_->internal_comparator(), &sublevel,
+            mutable_cf_options_.prefix_extractor.get(),
+            /*should_sample=*/false, cfd_->internal_stats()->GetFileReadHist(0),
+            TableReaderCaller::kUserIterator, /*skip_filters=*/false,
+            /*level=*/0, range_del_agg,
+            /*compaction_boundaries=*/nullptr, allow_unprepared_value,
+            max_file_size_for_l0_meta_pin_));
+        continue;
+      }
+      const auto& file = sublevel.files[0];
       merge_iter_builder->AddIterator(cfd_->table_cache()->NewIterator(
           read_options, soptions, cfd_->internal_comparator(),
           *file.file_metadata, range_del_agg,
@@ -1808,12 +1977,9 @@ Version::Version(ColumnFamilyData* column_family_data, VersionSet* vset,
       io_tracer_(io_tracer) {}
 
 Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
-                        const Slice& blob_index_slice, PinnableSlice* value,
+                        const Slice& blob_index_slice,
+                        BlobPrefetcher* prefetcher, PinnableSlice* value,
                         uint64_t* bytes_read) const {
-  if (read_options.read_tier == kBlockCacheTier) {
-    return Status::Incomplete("Cannot read blob: no disk I/O allowed");
-  }
-
   BlobIndex blob_index;
 
   {
@@ -1823,11 +1989,13 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
     }
   }
 
-  return GetBlob(read_options, user_key, blob_index, value, bytes_read);
+  return GetBlob(read_options, user_key, blob_index, prefetcher, value,
+                 bytes_read);
 }
 
 Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
-                        const BlobIndex& blob_index, PinnableSlice* value,
+                        const BlobIndex& blob_index,
+                        BlobPrefetcher* prefetcher, PinnableSlice* value,
                         uint64_t* bytes_read) const {
   assert(value);
 
@@ -1844,6 +2012,23 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
     return Status::Corruption("Invalid blob file number");
   }
 
+  Cache* const blob_cache =
+      cfd_ != nullptr ? cfd_->ioptions()->blob_cache.get() : nullptr;
+  std::string cache_key;
+  if (blob_cache != nullptr) {
+    cache_key = GetBlobCacheKey(blob_file_number, blob_index.offset());
+    if (LookupBlobCache(blob_cache, cache_key, value)) {
+      if (bytes_read) {
+        *bytes_read = 0;
+      }
+      return Status::OK();
+    }
+  }
+
+  if (read_options.read_tier == kBlockCacheTier) {
+    return Status::Incomplete("Cannot read blob: no disk I/O allowed");
+  }
+
   CacheHandleGuard<BlobFileReader> blob_file_reader;
 
   {
@@ -1856,13 +2041,168 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
   }
 
   assert(blob_file_reader.GetValue());
+
+  FilePrefetchBuffer* const prefetch_buffer =
+      prefetcher ? prefetcher->GetPrefetchBuffer(
+                       blob_file_number, blob_index.offset(), blob_file_reader)
+                 : nullptr;
+
+  uint64_t blob_bytes_read = 0;
   const Status s = blob_file_reader.GetValue()->GetBlob(
       read_options, user_key, blob_index.offset(), blob_index.size(),
-      blob_index.compression(), value, bytes_read);
+      blob_index.compression(), prefetch_buffer, value, &blob_bytes_read);
+
+  if (bytes_read) {
+    *bytes_read = blob_bytes_read;
+  }
+
+  if (should_sample_file_read()) {
+    sample_blob_file_read_inc(it->second->GetSharedMeta().get(),
+                              1 /* num_reads */, blob_bytes_read);
+  }
+
+  if (s.ok() && blob_cache != nullptr && read_options.fill_cache) {
+    AddToBlobCache(blob_cache, cache_key, *value);
+  }
 
   return s;
 }
 
+void Version::MultiGetBlob(const ReadOptions& read_options,
+                           const BlobReads& blob_reads) const {
+  Cache* const blob_cache =
+      cfd_ != nullptr ? cfd_->ioptions()->blob_cache.get() : nullptr;
+  const auto& blob_files = storage_info_.GetBlobFiles();
+
+  for (const auto& file_reads : blob_reads) {
+    const uint64_t blob_file_number = file_reads.first;
+
+    std::vector<BlobFileReader::BlobReadRequest> requests;
+    std::vector<std::string> cache_keys;
+    requests.reserve(file_reads.second.size());
+
+    for (const auto& read : file_reads.second) {
+      const BlobIndex& blob_index = read.first;
+      KeyContext* const key_context = read.second;
+
+      if (blob_index.HasTTL() || blob_index.IsInlined()) {
+        *key_context->s =
+            Status::Corruption("Unexpected TTL/inlined blob index");
+        continue;
+      }
+
+      if (blob_files.find(blob_file_number) == blob_files.end()) {
+        *key_context->s = Status::Corruption("Invalid blob file number");
+        continue;
+      }
+
+      std::string cache_key;
+      if (blob_cache != nullptr) {
+        cache_key = GetBlobCacheKey(blob_file_number, blob_index.offset());
+        if (LookupBlobCache(blob_cache, cache_key, key_context->value)) {
+          continue;
+        }
+      }
+
+      if (read_options.read_tier == kBlockCacheTier) {
+        *key_context->s =
+            Status::Incomplete("Cannot read blob: no disk I/O allowed");
+        key_context->get_context->MarkKeyMayExist();
+        continue;
+      }
+
+      BlobFileReader::BlobReadRequest request;
+      request.user_key = key_context->ukey_with_ts;
+      request.offset = blob_index.offset();
+      request.value_size = blob_index.size();
+      request.compression_type = blob_index.compression();
+      request.value = key_context->value;
+      request.status = key_context->s;
+      requests.push_back(request);
+      cache_keys.push_back(std::move(cache_key));
+    }
+
+    if (requests.empty()) {
+      continue;
+    }
+
+    CacheHandleGuard<BlobFileReader> blob_file_reader;
+
+    assert(blob_file_cache_);
+    const Status s = blob_file_cache_->GetBlobFileReader(blob_file_number,
+                                                         &blob_file_reader);
+    if (!s.ok()) {
+      for (const auto& request : requests) {
+        *request.status = s;
+      }
+      continue;
+    }
+
+    assert(blob_file_reader.GetValue());
+    uint64_t bytes_read = 0;
+    blob_file_reader.GetValue()->MultiGetBlob(read_options, requests,
+                                              &bytes_read);
+
+    if (should_sample_file_read()) {
+      const auto it = blob_files.find(blob_file_number);
+      assert(it != blob_files.end());
+      sample_blob_file_read_inc(it->second->GetSharedMeta().get(),
+                                requests.size(), bytes_read);
+    }
+
+    if (blob_cache != nullptr && read_options.fill_cache) {
+      for (size_t i = 0; i < requests.size(); ++i) {
+        if (requests[i].status->ok()) {
+          AddToBlobCache(blob_cache, cache_keys[i], *requests[i].value);
+        }
+      }
+    }
+  }
+}
+
+// Blobs are cached uncompressed, keyed by the DB session, the blob file
+// number and the blob's offset in the file
+std::string Version::GetBlobCacheKey(uint64_t blob_file_number,
+                                     uint64_t offset) const {
+  assert(vset_);
+  std::string cache_key = vset_->db_session_id_;
+  PutVarint64(&cache_key, blob_file_number);
+  PutVarint64(&cache_key, offset);
+  return cache_key;
+}
+
+bool Version::LookupBlobCache(Cache* blob_cache, const std::string& cache_key,
+                              PinnableSlice* value) const {
+  assert(blob_cache);
+  assert(value);
+
+  Cache::Handle* const handle = blob_cache->Lookup(cache_key);
+  if (handle == nullptr) {
+    RecordTick(db_statistics_, BLOB_DB_CACHE_MISS);
+    return false;
+  }
+
+  RecordTick(db_statistics_, BLOB_DB_CACHE_HIT);
+  const std::string* const blob =
+      static_cast<const std::string*>(blob_cache->Value(handle));
+  value->Reset();
+  value->PinSlice(*blob, &ReleaseBlobCacheHandle, blob_cache, handle);
+  return true;
+}
+
+void Version::AddToBlobCache(Cache* blob_cache, const std::string& cache_key,
+                             const Slice& blob) const {
+  assert(blob_cache);
+
+  std::string* const copy = new std::string(blob.data(), blob.size());
+  const Status s = blob_cache->Insert(
+      cache_key, copy, copy->size(),
+      GetCacheEntryDeleterForRole<std::string, CacheEntryRole::kBlobValue>());
+  // On failure the cache has already deleted the copy
+  RecordTick(db_statistics_,
+             s.ok() ? BLOB_DB_CACHE_ADD : BLOB_DB_CACHE_ADD_FAILURES);
+}
+
 void Version::Get(const ReadOptions& read_options, const LookupKey& k,
                   PinnableSlice* value, std::string* timestamp, Status* status,
                   MergeContext* merge_context,
@@ -1909,7 +2249,8 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   FilePicker fp(
       storage_info_.files_, user_key, ikey, &storage_info_.level_files_brief_,
       storage_info_.num_non_empty_levels_, &storage_info_.file_indexer_,
-      user_comparator(), internal_comparator());
+      user_comparator(), internal_comparator(),
+      &storage_info_.level0_sublevels_);
   FdWithKeyRange* f = fp.GetNextFile();
 
   while (f != nullptr) {
@@ -1918,21 +2259,38 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       // stop here.
       break;
     }
-    if (get_context.sample()) {
+    const bool sample = get_context.sample();
+    uint64_t bytes_read_before = 0;
+    if (sample) {
       sample_file_read_inc(f->file_metadata);
+      bytes_read_before = IOSTATS(bytes_read);
     }
 
     bool timer_enabled =
         GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
         get_perf_context()->per_level_perf_context_enabled;
+    const int level = static_cast<int>(fp.GetHitFileLevel());
+    InternalStats* const internal_stats = cfd_->internal_stats();
+    bool skip_filters = IsFilterSkipped(level, fp.IsHitFileLastInLevel());
+    if (!skip_filters &&
+        mutable_cf_options_.skip_filters_after_unhelpful_checks > 0) {
+      skip_filters = internal_stats->ShouldSkipUnhelpfulFilters(
+          level, mutable_cf_options_.skip_filters_after_unhelpful_checks);
+    }
+    const GetContextStats stats_before = get_context.get_context_stats_;
     StopWatchNano timer(clock_, timer_enabled /* auto_start */);
     *status = table_cache_->Get(
         read_options, *internal_comparator(), *f->file_metadata, ikey,
         &get_context, mutable_cf_options_.prefix_extractor.get(),
-        cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
-        IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
-                        fp.IsHitFileLastInLevel()),
-        fp.GetHitFileLevel(), max_file_size_for_l0_meta_pin_);
+        internal_stats->GetFileReadHist(level), skip_filters, level,
+        max_file_size_for_l0_meta_pin_);
+    internal_stats->RecordFilterChecks(level, stats_before,
+                                       get_context.get_context_stats_);
+    if (sample) {
+      sample_file_bytes_read_inc(f->file_metadata,
+                                 IOSTATS(bytes_read) - bytes_read_before);
+    }
+    get_context.get_context_stats_.num_levels_read++;
     // TODO: examine the behavior for corrupted key
     if (timer_enabled) {
       PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos, timer.ElapsedNanos(),
@@ -1972,10 +2330,11 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
 
         if (is_blob_index) {
           if (do_merge && value) {
+            constexpr BlobPrefetcher* prefetcher = nullptr;
             constexpr uint64_t* bytes_read = nullptr;
 
-            *status =
-                GetBlob(read_options, user_key, *value, value, bytes_read);
+            *status = GetBlob(read_options, user_key, *value, prefetcher, value,
+                              bytes_read);
             if (!status->ok()) {
               if (status->IsIncomplete()) {
                 get_context.MarkKeyMayExist();
@@ -2033,6 +2392,64 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   }
 }
 
+void Version::PrefetchLevelForMultiGet(const ReadOptions& read_options,
+                                       MultiGetRange* range, int level) {
+  const LevelFilesBrief& files = storage_info_.LevelFilesBrief(level);
+  const Comparator* ucmp = user_comparator();
+  auto prefetch_file = [&](size_t file_index, MultiGetRange* file_range) {
+    const FdWithKeyRange& f = files.files[file_index];
+    for (auto iter = file_range->begin(); iter != file_range->end(); ++iter) {
+      const Slice user_key = ExtractUserKey(iter->ikey);
+      if (ucmp->CompareWithoutTimestamp(
+              user_key, ExtractUserKey(f.smallest_key)) < 0 ||
+          ucmp->CompareWithoutTimestamp(
+              user_key, ExtractUserKey(f.largest_key)) > 0) {
+        file_range->SkipKey(iter);
+      }
+    }
+    if (file_range->empty()) {
+      return;
+    }
+    table_cache_->PrefetchForMultiGet(
+        read_options, *internal_comparator(), *f.file_metadata, file_range,
+        mutable_cf_options_.prefix_extractor.get(),
+        cfd_->internal_stats()->GetFileReadHist(level),
+        IsFilterSkipped(level, file_index + 1 == files.num_files), level);
+  };
+
+  if (level == 0) {
+    // L0 files may overlap each other, check every one of them.
+    for (size_t i = 0; i < files.num_files; ++i) {
+      MultiGetRange file_range(*range, range->begin(), range->end());
+      prefetch_file(i, &file_range);
+    }
+    return;
+  }
+
+  // Both the keys and the files are sorted, so the keys that map to the same
+  // file form a contiguous sub-range.
+  auto group_begin = range->begin();
+  size_t group_file = files.num_files;
+  for (auto iter = range->begin();; ++iter) {
+    size_t file_index = files.num_files;
+    if (iter != range->end()) {
+      file_index = static_cast<size_t>(
+          FindFile(*internal_comparator(), files, iter->ikey));
+    }
+    if (file_index != group_file) {
+      if (group_file < files.num_files) {
+        MultiGetRange file_range(*range, group_begin, iter);
+        prefetch_file(group_file, &file_range);
+      }
+      group_begin = iter;
+      group_file = file_index;
+    }
+    if (iter == range->end()) {
+      break;
+    }
+  }
+}
+
 void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
                        ReadCallback* callback) {
   PinnedIteratorsManager pinned_iters_mgr;
@@ -2085,12 +2502,25 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
   uint64_t num_data_read = 0;
   uint64_t num_sst_read = 0;
 
+  int prefetched_level = -1;
+  BlobReads blob_reads;
+
   while (f != nullptr) {
+    if (read_options.async_io &&
+        static_cast<int>(fp.GetHitFileLevel()) != prefetched_level) {
+      prefetched_level = static_cast<int>(fp.GetHitFileLevel());
+      PrefetchLevelForMultiGet(read_options, &file_picker_range,
+                               prefetched_level);
+    }
     MultiGetRange file_range = fp.CurrentFileRange();
     bool timer_enabled =
         GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
         get_perf_context()->per_level_perf_context_enabled;
     StopWatchNano timer(clock_, timer_enabled /* auto_start */);
+    // The keys of the batch are sampled one by one below, but the bytes
+    // they read from the file together can only be sampled per batch
+    const bool sample_bytes_read = should_sample_file_read();
+    const uint64_t bytes_read_before = IOSTATS(bytes_read);
     s = table_cache_->MultiGet(
         read_options, *internal_comparator(), *f->file_metadata, &file_range,
         mutable_cf_options_.prefix_extractor.get(),
@@ -2098,6 +2528,10 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
         IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
                         fp.IsHitFileLastInLevel()),
         fp.GetHitFileLevel());
+    if (sample_bytes_read) {
+      sample_file_bytes_read_inc(f->file_metadata,
+                                 IOSTATS(bytes_read) - bytes_read_before);
+    }
     // TODO: examine the behavior for corrupted key
     if (timer_enabled) {
       PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos, timer.ElapsedNanos(),
@@ -2109,6 +2543,7 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
         *iter->s = s;
         file_range.MarkKeyDone(iter);
       }
+      MultiGetBlob(read_options, blob_reads);
       return;
     }
     uint64_t batch_size = 0;
@@ -2170,17 +2605,23 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
 
           if (iter->is_blob_index) {
             if (iter->value) {
-              constexpr uint64_t* bytes_read = nullptr;
-
-              *status = GetBlob(read_options, iter->ukey_with_ts, *iter->value,
-                                iter->value, bytes_read);
+              BlobIndex blob_index;
+              *status = blob_index.DecodeFrom(*iter->value);
               if (!status->ok()) {
-                if (status->IsIncomplete()) {
-                  get_context.MarkKeyMayExist();
-                }
-
                 continue;
               }
+
+              // The blob is read below along with the others of the batch;
+              // its stored size stands in for the value size
+              blob_reads[blob_index.file_number()].emplace_back(blob_index,
+                                                                &*iter);
+              file_range.AddValueSize(blob_index.size());
+              if (file_range.GetValueSize() >
+                  read_options.value_size_soft_limit) {
+                s = Status::Aborted();
+                break;
+              }
+              continue;
             }
           }
 
@@ -2233,6 +2674,10 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
     f = fp.GetNextFile();
   }
 
+  if (!blob_reads.empty()) {
+    MultiGetBlob(read_options, blob_reads);
+  }
+
   // Process any left over keys
   for (auto iter = range->begin(); s.ok() && iter != range->end(); ++iter) {
     GetContext& get_context = *iter->get_context;
@@ -2307,6 +2752,7 @@ void Version::PrepareApply(
   storage_info_.GenerateFileIndexer();
   storage_info_.GenerateLevelFilesBrief();
   storage_info_.GenerateLevel0NonOverlapping();
+  storage_info_.GenerateLevel0Sublevels();
   storage_info_.GenerateBottommostFiles();
 }
 
@@ -2557,11 +3003,18 @@ uint32_t GetExpiredTtlFilesCount(const ImmutableOptions& ioptions,
   auto status = ioptions.clock->GetCurrentTime(&_current_time);
   if (status.ok()) {
     const uint64_t current_time = static_cast<uint64_t>(_current_time);
+    const uint64_t time_window =
+        mutable_cf_options.compaction_options_fifo.time_window_seconds;
     for (FileMetaData* f : files) {
       if (!f->being_compacted) {
         uint64_t oldest_ancester_time = f->TryGetOldestAncesterTime();
+        // With time windows, the file expires with the end of its window
+        uint64_t expiration_time =
+            time_window > 0
+                ? (oldest_ancester_time / time_window + 1) * time_window
+                : oldest_ancester_time;
         if (oldest_ancester_time != 0 &&
-            oldest_ancester_time < (current_time - mutable_cf_options.ttl)) {
+            expiration_time < (current_time - mutable_cf_options.ttl)) {
           ttl_expired_files_count++;
         }
       }
@@ -2569,11 +3022,139 @@ uint32_t GetExpiredTtlFilesCount(const ImmutableOptions& ioptions,
   }
   return ttl_expired_files_count;
 }
+
+// Compaction score of FIFO time window compaction: 1 if adjacent L0 files of
+// a past window can be merged, and for the current window the number of its
+// newest files up to about the memtable size relative to
+// level0_file_num_compaction_trigger. Follows
+// FIFOCompactionPicker::PickTimeWindowCompaction().
+double GetTimeWindowCompactionScore(const ImmutableOptions& ioptions,
+                                    const MutableCFOptions& mutable_cf_options,
+                                    const std::vector<FileMetaData*>& files) {
+  const uint64_t time_window =
+      mutable_cf_options.compaction_options_fifo.time_window_seconds;
+  int64_t _current_time;
+  if (!ioptions.clock->GetCurrentTime(&_current_time).ok()) {
+    return 0;
+  }
+  const uint64_t current_window =
+      static_cast<uint64_t>(_current_time) / time_window;
+  const uint64_t max_flushed_file_size = MultiplyCheckOverflow(
+      static_cast<uint64_t>(mutable_cf_options.write_buffer_size), 1.1);
+  double score = 0;
+  size_t start = 0;
+  while (start < files.size()) {
+    const uint64_t oldest_ancester_time = files[start]->TryGetOldestAncesterTime();
+    size_t end = start + 1;
+    if (oldest_ancester_time == kUnknownOldestAncesterTime) {
+      start = end;
+      continue;
+    }
+    const uint64_t window = oldest_ancester_time / time_window;
+    while (end < files.size() &&
+           files[end]->TryGetOldestAncesterTime() !=
+               kUnknownOldestAncesterTime &&
+           files[end]->TryGetOldestAncesterTime() / time_window == window) {
+      end++;
+    }
+    if (window < current_window) {
+      if (end - start >= 2) {
+        score = std::max(score, 1.0);
+      }
+    } else {
+      size_t num_flushed_files = 0;
+      while (start + num_flushed_files < end &&
+             files[start + num_flushed_files]->fd.GetFileSize() <=
+                 max_flushed_file_size) {
+        num_flushed_files++;
+      }
+      if (num_flushed_files >= 2) {
+        score = std::max(
+            score,
+            static_cast<double>(num_flushed_files) /
+                std::max(2, mutable_cf_options.level0_file_num_compaction_trigger));
+      }
+    }
+    start = end;
+  }
+  return score;
+}
 }  // anonymous namespace
 
 void VersionStorageInfo::ComputeCompactionScore(
     const ImmutableOptions& immutable_options,
     const MutableCFOptions& mutable_cf_options) {
+  ComputeLevelCompactionScores(immutable_options, mutable_cf_options);
+  ComputeFilesMarkedForCompaction();
+  ComputeBottommostFilesMarkedForCompaction();
+  if (mutable_cf_options.enable_blob_garbage_collection &&
+      mutable_cf_options.blob_garbage_collection_force_threshold < 1.0) {
+    ComputeFilesMarkedForForcedBlobGC(
+        mutable_cf_options.blob_garbage_collection_age_cutoff,
+        mutable_cf_options.blob_garbage_collection_force_threshold);
+  } else {
+    files_marked_for_forced_blob_gc_.clear();
+  }
+  ComputeTimeBasedFilesMarkedForCompaction(immutable_options,
+                                           mutable_cf_options);
+  EstimateCompactionBytesNeeded(mutable_cf_options);
+}
+
+namespace {
+void RemoveFilesBeingCompacted(
+    autovector<std::pair<int, FileMetaData*>>* level_and_files) {
+  size_t num_kept = 0;
+  for (size_t i = 0; i < level_and_files->size(); ++i) {
+    if (!(*level_and_files)[i].second->being_compacted) {
+      (*level_and_files)[num_kept++] = (*level_and_files)[i];
+    }
+  }
+  level_and_files->resize(num_kept);
+}
+}  // anonymous namespace
+
+void VersionStorageInfo::UpdateCompactionScoreAfterPick(
+    const ImmutableOptions& immutable_options,
+    const MutableCFOptions& mutable_cf_options) {
+  ComputeLevelCompactionScores(immutable_options, mutable_cf_options);
+  RemoveFilesBeingCompacted(&files_marked_for_compaction_);
+  // bottommost_files_mark_threshold_ may now be lower than it would be
+  // computed, which only makes UpdateOldestSnapshot() recompute it sooner
+  RemoveFilesBeingCompacted(&bottommost_files_marked_for_compaction_);
+  if (mutable_cf_options.enable_blob_garbage_collection &&
+      mutable_cf_options.blob_garbage_collection_force_threshold < 1.0) {
+    RemoveFilesBeingCompacted(&files_marked_for_forced_blob_gc_);
+  } else {
+    files_marked_for_forced_blob_gc_.clear();
+  }
+  ComputeTimeBasedFilesMarkedForCompaction(immutable_options,
+                                           mutable_cf_options);
+  EstimateCompactionBytesNeeded(mutable_cf_options);
+}
+
+void VersionStorageInfo::ComputeTimeBasedFilesMarkedForCompaction(
+    const ImmutableOptions& immutable_options,
+    const MutableCFOptions& mutable_cf_options) {
+  if (mutable_cf_options.ttl > 0) {
+    ComputeExpiredTtlFiles(immutable_options, mutable_cf_options.ttl);
+  }
+  if (mutable_cf_options.periodic_compaction_seconds > 0) {
+    ComputeFilesMarkedForPeriodicCompaction(
+        immutable_options, mutable_cf_options.periodic_compaction_seconds);
+  }
+  if (mutable_cf_options.bottommost_temperature != Temperature::kUnknown &&
+      mutable_cf_options.bottommost_hot_file_read_rate > 0) {
+    ComputeFilesMarkedForTemperatureChange(
+        immutable_options, mutable_cf_options.bottommost_temperature,
+        mutable_cf_options.bottommost_hot_file_read_rate);
+  } else {
+    files_marked_for_temperature_change_.clear();
+  }
+}
+
+void VersionStorageInfo::ComputeLevelCompactionScores(
+    const ImmutableOptions& immutable_options,
+    const MutableCFOptions& mutable_cf_options) {
   for (int level = 0; level <= MaxInputLevel(); level++) {
     double score;
     if (level == 0) {
@@ -2615,7 +3196,14 @@ void VersionStorageInfo::ComputeCompactionScore(
       if (compaction_style_ == kCompactionStyleFIFO) {
         score = static_cast<double>(total_size) /
                 mutable_cf_options.compaction_options_fifo.max_table_files_size;
-        if (mutable_cf_options.compaction_options_fifo.allow_compaction) {
+        if (mutable_cf_options.compaction_options_fifo.time_window_seconds >
+            0) {
+          score = std::max(
+              GetTimeWindowCompactionScore(immutable_options,
+                                           mutable_cf_options, files_[level]),
+              score);
+        } else if (mutable_cf_options.compaction_options_fifo
+                       .allow_compaction) {
           score = std::max(
               static_cast<double>(num_sorted_runs) /
                   mutable_cf_options.level0_file_num_compaction_trigger,
@@ -2681,16 +3269,6 @@ void VersionStorageInfo::ComputeCompactionScore(
       }
     }
   }
-  ComputeFilesMarkedForCompaction();
-  ComputeBottommostFilesMarkedForCompaction();
-  if (mutable_cf_options.ttl > 0) {
-    ComputeExpiredTtlFiles(immutable_options, mutable_cf_options.ttl);
-  }
-  if (mutable_cf_options.periodic_compaction_seconds > 0) {
-    ComputeFilesMarkedForPeriodicCompaction(
-        immutable_options, mutable_cf_options.periodic_compaction_seconds);
-  }
-  EstimateCompactionBytesNeeded(mutable_cf_options);
 }
 
 void VersionStorageInfo::ComputeFilesMarkedForCompaction() {
@@ -2799,6 +3377,105 @@ void VersionStorageInfo::ComputeFilesMarkedForPeriodicCompaction(
   }
 }
 
+void VersionStorageInfo::ComputeFilesMarkedForForcedBlobGC(
+    double blob_garbage_collection_age_cutoff,
+    double blob_garbage_collection_force_threshold) {
+  files_marked_for_forced_blob_gc_.clear();
+
+  // Only the oldest blob files, up to the age cutoff, have their blobs
+  // relocated by compactions (see CompactionIterator)
+  const size_t cutoff_count = static_cast<size_t>(
+      blob_garbage_collection_age_cutoff * blob_files_.size());
+
+  std::unordered_set<uint64_t> marked;
+  size_t count = 0;
+  for (const auto& pair : blob_files_) {
+    if (count++ >= cutoff_count) {
+      break;
+    }
+
+    const auto& meta = pair.second;
+    assert(meta);
+
+    const uint64_t total_bytes = meta->GetTotalBlobBytes();
+    if (total_bytes == 0 ||
+        static_cast<double>(meta->GetGarbageBlobBytes()) <
+            blob_garbage_collection_force_threshold *
+                static_cast<double>(total_bytes)) {
+      continue;
+    }
+
+    for (uint64_t sst_file_number : meta->GetLinkedSsts()) {
+      const FileLocation location = GetFileLocation(sst_file_number);
+      if (!location.IsValid() || !marked.insert(sst_file_number).second) {
+        continue;
+      }
+
+      const int level = location.GetLevel();
+      FileMetaData* const f = files_[level][location.GetPosition()];
+      assert(f);
+
+      if (!f->being_compacted) {
+        files_marked_for_forced_blob_gc_.emplace_back(level, f);
+      }
+    }
+  }
+}
+
+void VersionStorageInfo::ComputeFilesMarkedForTemperatureChange(
+    const ImmutableOptions& ioptions, Temperature bottommost_temperature,
+    uint64_t hot_file_read_rate) {
+  assert(bottommost_temperature != Temperature::kUnknown);
+  assert(hot_file_read_rate > 0);
+
+  files_marked_for_temperature_change_.clear();
+
+  int64_t temp_current_time;
+  auto status = ioptions.clock->GetCurrentTime(&temp_current_time);
+  if (!status.ok()) {
+    return;
+  }
+  const uint64_t current_time = static_cast<uint64_t>(temp_current_time);
+
+  constexpr uint64_t kSecondsPerHour = 3600;
+  constexpr uint64_t kBytesPerMB = 1 << 20;
+
+  for (const auto& level_and_file : bottommost_files_) {
+    const int level = level_and_file.first;
+    FileMetaData* const f = level_and_file.second;
+    if (level == 0 || f->being_compacted) {
+      continue;
+    }
+
+    const uint64_t file_creation_time = f->TryGetFileCreationTime();
+    if (file_creation_time == kUnknownFileCreationTime ||
+        file_creation_time > current_time) {
+      continue;
+    }
+
+    // Reads per hour per MB since the file was written. Files younger than an
+    // hour are rated by their reads so far.
+    const uint64_t age_seconds = current_time - file_creation_time;
+    const double hours =
+        std::max(static_cast<double>(age_seconds) / kSecondsPerHour, 1.0);
+    const double mbs = std::max(
+        static_cast<double>(f->fd.GetFileSize()) / kBytesPerMB, 1.0);
+    const double read_rate =
+        static_cast<double>(
+            f->stats.num_reads_sampled.load(std::memory_order_relaxed)) /
+        hours / mbs;
+
+    if (f->temperature == bottommost_temperature) {
+      if (read_rate >= static_cast<double>(hot_file_read_rate)) {
+        files_marked_for_temperature_change_.emplace_back(level, f);
+      }
+    } else if (age_seconds >= kSecondsPerHour &&
+               read_rate < static_cast<double>(hot_file_read_rate) / 2) {
+      files_marked_for_temperature_change_.emplace_back(level, f);
+    }
+  }
+}
+
 namespace {
 
 // used to sort files by size
@@ -2849,7 +3526,8 @@ void VersionStorageInfo::AddBlobFile(
 // 4. GenerateFileIndexer();
 // 5. GenerateLevelFilesBrief();
 // 6. GenerateLevel0NonOverlapping();
-// 7. GenerateBottommostFiles();
+// 7. GenerateLevel0Sublevels();
+// 8. GenerateBottommostFiles();
 void VersionStorageInfo::SetFinalized() {
   finalized_ = true;
 #ifndef NDEBUG
@@ -2937,6 +3615,29 @@ void SortFileByOverlappingRatio(
                      file_to_order[f2.file->fd.GetNumber()];
             });
 }
+
+// Sort `temp` by sampled reads per MB of file, most read first. Files read
+// equally often keep the order of SortFileByOverlappingRatio().
+void SortFileByReadHotness(const InternalKeyComparator& icmp,
+                           const std::vector<FileMetaData*>& files,
+                           const std::vector<FileMetaData*>& next_level_files,
+                           std::vector<Fsize>* temp) {
+  // Reads keep being sampled while sorting, so take a snapshot
+  std::unordered_map<uint64_t, uint64_t> file_to_hotness;
+  for (auto& file : files) {
+    uint64_t reads =
+        file->stats.num_reads_sampled.load(std::memory_order_relaxed);
+    file_to_hotness[file->fd.GetNumber()] =
+        reads / std::max(file->compensated_file_size >> 20, uint64_t{1});
+  }
+
+  SortFileByOverlappingRatio(icmp, files, next_level_files, temp);
+  std::stable_sort(temp->begin(), temp->end(),
+                   [&](const Fsize& f1, const Fsize& f2) -> bool {
+                     return file_to_hotness[f1.file->fd.GetNumber()] >
+                            file_to_hotness[f2.file->fd.GetNumber()];
+                   });
+}
 }  // namespace
 
 void VersionStorageInfo::UpdateFilesByCompactionPri(
@@ -2988,6 +3689,10 @@ void VersionStorageInfo::UpdateFilesByCompactionPri(
         SortFileByOverlappingRatio(*internal_comparator_, files_[level],
                                    files_[level + 1], &temp);
         break;
+      case kHotnessAware:
+        SortFileByReadHotness(*internal_comparator_, files_[level],
+                              files_[level + 1], &temp);
+        break;
       default:
         assert(false);
     }
@@ -3029,6 +3734,64 @@ void VersionStorageInfo::GenerateLevel0NonOverlapping() {
   }
 }
 
+void VersionStorageInfo::GenerateLevel0Sublevels() {
+  assert(!finalized_);
+  level0_sublevels_.clear();
+  if (level_files_brief_.size() == 0) {
+    return;
+  }
+
+  // Place the files from the oldest one on, each in the sublevel above the
+  // newest one holding an older file it overlaps. Files sharing a user key
+  // overlap, so that the sublevels order the versions of a key.
+  const ROCKSDB_NAMESPACE::LevelFilesBrief& level0 = level_files_brief_[0];
+  std::vector<std::vector<const FdWithKeyRange*>> sublevels;
+  for (size_t i = level0.num_files; i > 0; --i) {
+    const FdWithKeyRange* f = &level0.files[i - 1];
+    size_t sublevel = sublevels.size();
+    for (; sublevel > 0; --sublevel) {
+      bool overlap = false;
+      for (const FdWithKeyRange* other : sublevels[sublevel - 1]) {
+        if (user_comparator_->CompareWithoutTimestamp(
+                ExtractUserKey(f->smallest_key),
+                ExtractUserKey(other->largest_key)) <= 0 &&
+            user_comparator_->CompareWithoutTimestamp(
+                ExtractUserKey(other->smallest_key),
+                ExtractUserKey(f->largest_key)) <= 0) {
+          overlap = true;
+          break;
+        }
+      }
+      if (overlap) {
+        break;
+      }
+    }
+    if (sublevel == sublevels.size()) {
+      sublevels.emplace_back();
+    }
+    sublevels[sublevel].push_back(f);
+  }
+
+  level0_sublevels_.resize(sublevels.size());
+  for (size_t i = 0; i < sublevels.size(); ++i) {
+    auto& files = sublevels[i];
+    std::sort(files.begin(), files.end(),
+              [this](const FdWithKeyRange* f1, const FdWithKeyRange* f2) {
+                return internal_comparator_->Compare(f1->smallest_key,
+                                                     f2->smallest_key) < 0;
+              });
+    // The key slices stay in arena_ with level_files_brief_
+    ROCKSDB_NAMESPACE::LevelFilesBrief& sublevel =
+        level0_sublevels_[sublevels.size() - 1 - i];
+    sublevel.num_files = files.size();
+    char* mem = arena_.AllocateAligned(files.size() * sizeof(FdWithKeyRange));
+    sublevel.files = new (mem) FdWithKeyRange[files.size()];
+    for (size_t j = 0; j < files.size(); ++j) {
+      sublevel.files[j] = *files[j];
+    }
+  }
+}
+
 void VersionStorageInfo::GenerateBottommostFiles() {
   assert(!finalized_);
   assert(bottommost_files_.empty());
@@ -3334,6 +4097,15 @@ uint64_t VersionStorageInfo::NumLevelBytes(int level) const {
   return TotalFileSize(files_[level]);
 }
 
+void VersionStorageInfo::GetLsmShape(std::vector<uint64_t>* level_bytes,
+                                     int* num_level0_files) const {
+  level_bytes->resize(num_levels());
+  for (int level = 0; level < num_levels(); level++) {
+    (*level_bytes)[level] = NumLevelBytes(level);
+  }
+  *num_level0_files = NumLevelFiles(0);
+}
+
 const char* VersionStorageInfo::LevelSummary(
     LevelSummaryStorage* scratch) const {
   int len = 0;
@@ -3822,6 +4594,7 @@ VersionSet::VersionSet(const std::string& dbname,
       prev_log_number_(0),
       current_version_number_(0),
       manifest_file_size_(0),
+      manifest_snapshot_size_(0),
       file_options_(storage_options),
       block_cache_tracer_(block_cache_tracer),
       io_tracer_(io_tracer),
@@ -3864,6 +4637,7 @@ void VersionSet::Reset() {
   current_version_number_ = 0;
   manifest_writers_.clear();
   manifest_file_size_ = 0;
+  manifest_snapshot_size_ = 0;
   obsolete_files_.clear();
   obsolete_manifests_.clear();
   wals_.Reset();
@@ -4067,8 +4841,23 @@ Status VersionSet::ProcessManifestWrites(
 #endif  // NDEBUG
 
   assert(pending_manifest_file_number_ == 0);
-  if (!descriptor_log_ ||
-      manifest_file_size_ > db_options_->max_manifest_file_size) {
+  uint64_t max_manifest_file_size = db_options_->max_manifest_file_size;
+  if (db_options_->max_manifest_space_amp_pct > 0 &&
+      manifest_snapshot_size_ > 0) {
+    // Replaying the edits since the snapshot should not take much longer
+    // than loading the snapshot
+    uint64_t min_size = kMinManifestFileSizeForSpaceAmp;
+    TEST_SYNC_POINT_CALLBACK(
+        "VersionSet::ProcessManifestWrites:MinManifestFileSizeForSpaceAmp",
+        &min_size);
+    max_manifest_file_size = std::min(
+        max_manifest_file_size,
+        std::max(min_size, manifest_snapshot_size_ +
+                               manifest_snapshot_size_ *
+                                   db_options_->max_manifest_space_amp_pct /
+                                   100));
+  }
+  if (!descriptor_log_ || manifest_file_size_ > max_manifest_file_size) {
     TEST_SYNC_POINT("VersionSet::ProcessManifestWrites:BeforeNewManifest");
     new_descriptor_log = true;
   } else {
@@ -4103,6 +4892,7 @@ Status VersionSet::ProcessManifestWrites(
   }
 
   uint64_t new_manifest_file_size = 0;
+  uint64_t new_manifest_snapshot_size = 0;
   Status s;
   IOStatus io_s;
   IOStatus manifest_io_status;
@@ -4150,13 +4940,14 @@ Status VersionSet::ProcessManifestWrites(
         FileTypeSet tmp_set = db_options_->checksum_handoff_file_types;
         std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
             std::move(descriptor_file), descriptor_fname, opt_file_opts, clock_,
-            io_tracer_, nullptr, db_options_->listeners, nullptr,
+            io_tracer_, db_options_->stats, db_options_->listeners, nullptr,
             tmp_set.Contains(FileType::kDescriptorFile),
             tmp_set.Contains(FileType::kDescriptorFile)));
         descriptor_log_.reset(
             new log::Writer(std::move(file_writer), 0, false));
         s = WriteCurrentStateToManifest(curr_state, wal_additions,
                                         descriptor_log_.get(), io_s);
+        new_manifest_snapshot_size = descriptor_log_->file()->GetFileSize();
       } else {
         manifest_io_status = io_s;
         s = io_s;
@@ -4320,6 +5111,9 @@ Status VersionSet::ProcessManifestWrites(
     }
     manifest_file_number_ = pending_manifest_file_number_;
     manifest_file_size_ = new_manifest_file_size;
+    if (new_descriptor_log) {
+      manifest_snapshot_size_ = new_manifest_snapshot_size;
+    }
     prev_log_number_ = first_writer.edit_list.front()->prev_log_number_;
   } else {
     std::string version_edits;
@@ -5399,6 +6193,84 @@ uint64_t VersionSet::ApproximateSize(Version* v, const FdWithKeyRange& f,
       v->GetMutableCFOptions().prefix_extractor.get());
 }
 
+uint64_t VersionSet::ApproximateNumEntries(Version* v, const Slice& start,
+                                           const Slice& end, int start_level,
+                                           int end_level,
+                                           TableReaderCaller caller) {
+  const auto& icmp = v->cfd_->internal_comparator();
+
+  // pre-condition
+  assert(icmp.Compare(start, end) <= 0);
+
+  uint64_t total_num_entries = 0;
+  const auto* vstorage = v->storage_info();
+  const int num_non_empty_levels = vstorage->num_non_empty_levels();
+  end_level = (end_level == -1) ? num_non_empty_levels
+                                : std::min(end_level, num_non_empty_levels);
+
+  assert(start_level <= end_level);
+
+  for (int level = start_level; level < end_level; ++level) {
+    const LevelFilesBrief& files_brief = vstorage->LevelFilesBrief(level);
+    if (files_brief.num_files == 0) {
+      continue;
+    }
+
+    size_t idx_start = 0;
+    size_t idx_end = files_brief.num_files - 1;
+    if (level > 0) {
+      // Files are sorted, so only those from the one holding start to the
+      // one holding end can overlap the range
+      idx_start = FindFileInRange(
+          icmp, files_brief, start, 0,
+          static_cast<uint32_t>(files_brief.num_files - 1));
+      idx_end = idx_start;
+      if (icmp.Compare(files_brief.files[idx_end].largest_key, end) < 0) {
+        idx_end = FindFileInRange(
+            icmp, files_brief, end, static_cast<uint32_t>(idx_start),
+            static_cast<uint32_t>(files_brief.num_files - 1));
+      }
+    }
+    for (size_t i = idx_start; i <= idx_end; ++i) {
+      total_num_entries +=
+          ApproximateNumEntries(v, files_brief.files[i], start, end, caller);
+    }
+  }
+
+  return total_num_entries;
+}
+
+uint64_t VersionSet::ApproximateNumEntries(Version* v, const FdWithKeyRange& f,
+                                           const Slice& start,
+                                           const Slice& end,
+                                           TableReaderCaller caller) {
+  // pre-condition
+  assert(v);
+  const auto& icmp = v->cfd_->internal_comparator();
+  assert(icmp.Compare(start, end) <= 0);
+
+  if (icmp.Compare(f.largest_key, start) < 0 ||
+      icmp.Compare(f.smallest_key, end) >= 0) {
+    // Entire file is before or after the start/end keys range
+    return 0;
+  }
+
+  const FileMetaData* meta = f.file_metadata;
+  if (icmp.Compare(f.smallest_key, start) >= 0 &&
+      icmp.Compare(f.largest_key, end) < 0 && meta->num_entries > 0) {
+    // Entire file is in the range
+    return meta->num_entries;
+  }
+
+  TableCache* table_cache = v->cfd_->table_cache();
+  if (table_cache == nullptr) {
+    return 0;
+  }
+  return table_cache->ApproximateNumEntries(
+      start, end, meta->fd, caller, icmp,
+      v->GetMutableCFOptions().prefix_extractor.get());
+}
+
 void VersionSet::AddLiveFiles(std::vector<uint64_t>* live_table_files,
                               std::vector<uint64_t>* live_blob_files) const {
   assert(live_table_files);
@@ -5514,9 +6386,10 @@ InternalIterator* VersionSet::MakeInputIterator(
     }
   }
   assert(num <= space);
-  InternalIterator* result =
-      NewMergingIterator(&c->column_family_data()->internal_comparator(), list,
-                         static_cast<int>(num));
+  InternalIterator* result = NewMergingIterator(
+      &c->column_family_data()->internal_comparator(), list,
+      static_cast<int>(num), /*arena=*/nullptr, /*prefix_seek_mode=*/false,
+      c->mutable_cf_options()->use_loser_tree_merging_iterator);
   delete[] list;
   return result;
 }
@@ -5572,6 +6445,8 @@ void VersionSet::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
         filemetadata.largest_seqno = file->fd.largest_seqno;
         filemetadata.num_reads_sampled = file->stats.num_reads_sampled.load(
             std::memory_order_relaxed);
+        filemetadata.bytes_read_sampled = file->stats.bytes_read_sampled.load(
+            std::memory_order_relaxed);
         filemetadata.being_compacted = file->being_compacted;
         filemetadata.num_entries = file->num_entries;
         filemetadata.num_deletions = file->num_deletions;
@@ -5581,6 +6456,10 @@ void VersionSet::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
         filemetadata.temperature = file->temperature;
         filemetadata.oldest_ancester_time = file->TryGetOldestAncesterTime();
         filemetadata.file_creation_time = file->TryGetFileCreationTime();
+        filemetadata.table_reader_memory_usage =
+            cfd->table_cache()->GetMemoryUsageByTableReader(
+                file_options_, cfd->internal_comparator(), file->fd,
+                cfd->current()->GetMutableCFOptions().prefix_extractor.get());
         metadata->push_back(filemetadata);
       }
     }
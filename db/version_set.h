@@ -61,6 +61,7 @@ class Writer;
 }
 
 class BlobIndex;
+class BlobPrefetcher;
 class Compaction;
 class LogBuffer;
 class LookupKey;
@@ -125,6 +126,10 @@ class VersionStorageInfo {
 
   void Reserve(int level, size_t size) { files_[level].reserve(size); }
 
+  void ReserveFileLocations(size_t num_files) {
+    file_locations_.reserve(num_files);
+  }
+
   void AddFile(int level, FileMetaData* f);
 
   void AddBlobFile(std::shared_ptr<BlobFileMetaData> blob_file_meta);
@@ -153,10 +158,31 @@ class VersionStorageInfo {
   void ComputeCompactionScore(const ImmutableOptions& immutable_options,
                               const MutableCFOptions& mutable_cf_options);
 
+  // Like ComputeCompactionScore(), after files of this version were picked
+  // for a compaction (marked being_compacted). The lists of marked files that
+  // do not depend on the time are only pruned of the picked files instead of
+  // being computed again from all files, as they would come out the same.
+  // REQUIRES: db_mutex held!!
+  void UpdateCompactionScoreAfterPick(
+      const ImmutableOptions& immutable_options,
+      const MutableCFOptions& mutable_cf_options);
+
   // Estimate est_comp_needed_bytes_
   void EstimateCompactionBytesNeeded(
       const MutableCFOptions& mutable_cf_options);
 
+  // Computes compaction_score_ and compaction_level_. Called by
+  // ComputeCompactionScore() and UpdateCompactionScoreAfterPick().
+  void ComputeLevelCompactionScores(const ImmutableOptions& immutable_options,
+                                    const MutableCFOptions& mutable_cf_options);
+
+  // Computes the lists of files marked for compaction that depend on the
+  // current time: expired_ttl_files_, files_marked_for_periodic_compaction_
+  // and files_marked_for_temperature_change_.
+  void ComputeTimeBasedFilesMarkedForCompaction(
+      const ImmutableOptions& immutable_options,
+      const MutableCFOptions& mutable_cf_options);
+
   // This computes files_marked_for_compaction_ and is called by
   // ComputeCompactionScore()
   void ComputeFilesMarkedForCompaction();
@@ -172,6 +198,27 @@ class VersionStorageInfo {
       const ImmutableOptions& ioptions,
       const uint64_t periodic_compaction_seconds);
 
+  // This computes files_marked_for_forced_blob_gc_ and is called by
+  // ComputeCompactionScore()
+  //
+  // Among the blob files that garbage collection may relocate blobs from,
+  // finds those whose garbage ratio has reached the threshold, and marks the
+  // SST files linked to them, which reference their oldest blobs.
+  void ComputeFilesMarkedForForcedBlobGC(
+      double blob_garbage_collection_age_cutoff,
+      double blob_garbage_collection_force_threshold);
+
+  // This computes files_marked_for_temperature_change_ and is called by
+  // ComputeCompactionScore()
+  //
+  // Among bottommost files below level 0, marks the ones with
+  // bottommost_temperature that are read at least hot_file_read_rate times
+  // per hour per MB, and the ones without it that are at least an hour old
+  // and read less than half as often (see bottommost_hot_file_read_rate).
+  void ComputeFilesMarkedForTemperatureChange(
+      const ImmutableOptions& ioptions, Temperature bottommost_temperature,
+      uint64_t hot_file_read_rate);
+
   // This computes bottommost_files_marked_for_compaction_ and is called by
   // ComputeCompactionScore() or UpdateOldestSnapshot().
   //
@@ -196,6 +243,16 @@ class VersionStorageInfo {
     return level0_non_overlapping_;
   }
 
+  // Split the L0 files into sublevels of files with disjoint key ranges, so
+  // that of any two overlapping files the newer one is in a newer sublevel.
+  // REQUIRES: GenerateLevelFilesBrief() was called.
+  void GenerateLevel0Sublevels();
+  // The L0 sublevels, newest first, each sorted by key. Empty if L0 is.
+  const std::vector<ROCKSDB_NAMESPACE::LevelFilesBrief>& Level0Sublevels()
+      const {
+    return level0_sublevels_;
+  }
+
   // Check whether each file in this version is bottommost (i.e., nothing in its
   // key-range could possibly exist in an older file/level).
   // REQUIRES: This version has not been saved
@@ -284,6 +341,13 @@ class VersionStorageInfo {
   // Return the combined file size of all files at the specified level.
   uint64_t NumLevelBytes(int level) const;
 
+  // Sets level_bytes to the combined file size of each level, and
+  // num_level0_files, describing the shape of the LSM tree for
+  // FilterBuildingContext.
+  // REQUIRES: This version has been saved (see VersionSet::SaveTo)
+  void GetLsmShape(std::vector<uint64_t>* level_bytes,
+                   int* num_level0_files) const;
+
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
   const std::vector<FileMetaData*>& LevelFiles(int level) const {
     return files_[level];
@@ -396,6 +460,22 @@ class VersionStorageInfo {
     files_marked_for_periodic_compaction_.emplace_back(level, f);
   }
 
+  // REQUIRES: This version has been saved (see VersionSet::SaveTo)
+  // REQUIRES: DB mutex held during access
+  const autovector<std::pair<int, FileMetaData*>>&
+  FilesMarkedForForcedBlobGC() const {
+    assert(finalized_);
+    return files_marked_for_forced_blob_gc_;
+  }
+
+  // REQUIRES: This version has been saved (see VersionSet::SaveTo)
+  // REQUIRES: DB mutex held during access
+  const autovector<std::pair<int, FileMetaData*>>&
+  FilesMarkedForTemperatureChange() const {
+    assert(finalized_);
+    return files_marked_for_temperature_change_;
+  }
+
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
   // REQUIRES: DB mutex held during access
   const autovector<std::pair<int, FileMetaData*>>&
@@ -523,6 +603,8 @@ class VersionStorageInfo {
 
   // A short brief metadata of files per level
   autovector<ROCKSDB_NAMESPACE::LevelFilesBrief> level_files_brief_;
+  // The files of level_files_brief_[0] split into sublevels
+  std::vector<ROCKSDB_NAMESPACE::LevelFilesBrief> level0_sublevels_;
   FileIndexer file_indexer_;
   Arena arena_;  // Used to allocate space for file_levels_
 
@@ -576,6 +658,11 @@ class VersionStorageInfo {
   autovector<std::pair<int, FileMetaData*>>
       files_marked_for_periodic_compaction_;
 
+  autovector<std::pair<int, FileMetaData*>> files_marked_for_forced_blob_gc_;
+
+  autovector<std::pair<int, FileMetaData*>>
+      files_marked_for_temperature_change_;
+
   // These files are considered bottommost because none of their keys can exist
   // at lower levels. They are not necessarily all in the same level. The marked
   // ones are eligible for compaction because they contain duplicate key
@@ -701,17 +788,18 @@ class Version {
 
   // Interprets blob_index_slice as a blob reference, and (assuming the
   // corresponding blob file is part of this Version) retrieves the blob and
-  // saves it in *value.
+  // saves it in *value. Blobs not found in the blob cache are read through
+  // the buffers of prefetcher, if not nullptr.
   // REQUIRES: blob_index_slice stores an encoded blob reference
   Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
-                 const Slice& blob_index_slice, PinnableSlice* value,
-                 uint64_t* bytes_read) const;
+                 const Slice& blob_index_slice, BlobPrefetcher* prefetcher,
+                 PinnableSlice* value, uint64_t* bytes_read) const;
 
   // Retrieves a blob using a blob reference and saves it in *value,
   // assuming the corresponding blob file is part of this Version.
   Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
-                 const BlobIndex& blob_index, PinnableSlice* value,
-                 uint64_t* bytes_read) const;
+                 const BlobIndex& blob_index, BlobPrefetcher* prefetcher,
+                 PinnableSlice* value, uint64_t* bytes_read) const;
 
   // Loads some stats information from files. Call without mutex held. It needs
   // to be called before applying the version to the version set.
@@ -784,6 +872,13 @@ class Version {
 
   void GetColumnFamilyMetaData(ColumnFamilyMetaData* cf_meta);
 
+  // Appends the key anchors (see TableReader::ApproximateKeyAnchors()) of
+  // every SST file in this version to *anchors, in no particular order.
+  // Files whose table format provides no anchors contribute a single one,
+  // at their largest key, covering the whole file.
+  Status GetKeyAnchors(const ReadOptions& read_options,
+                       std::vector<TableReader::Anchor>* anchors);
+
   uint64_t GetSstFilesSize();
 
   // Retrieves the file_creation_time of the oldest file in the DB.
@@ -814,6 +909,35 @@ class Version {
   // that it eventually expires from the cache.
   bool IsFilterSkipped(int level, bool is_file_last_in_level = false);
 
+  // Used by MultiGet() with ReadOptions::async_io. Issues prefetch requests
+  // for the keys in range to every file of the given level that may contain
+  // them, so that the reads of the whole level are in flight before MultiGet
+  // looks up the first file.
+  void PrefetchLevelForMultiGet(const ReadOptions& read_options,
+                                MultiGetRange* range, int level);
+
+  // The blob references MultiGet() found, with the keys they were found
+  // for, by blob file number
+  using BlobReads =
+      std::map<uint64_t, std::vector<std::pair<BlobIndex, KeyContext*>>>;
+
+  // Used by MultiGet(). Retrieves the blobs of blob_reads into the values of
+  // their keys, with one BlobFileReader::MultiGetBlob() per blob file.
+  void MultiGetBlob(const ReadOptions& read_options,
+                    const BlobReads& blob_reads) const;
+
+  // The key of a blob in ColumnFamilyOptions::blob_cache
+  std::string GetBlobCacheKey(uint64_t blob_file_number,
+                              uint64_t offset) const;
+
+  // Pins the blob of cache_key in *value and returns true if it is in
+  // blob_cache.
+  bool LookupBlobCache(Cache* blob_cache, const std::string& cache_key,
+                       PinnableSlice* value) const;
+
+  void AddToBlobCache(Cache* blob_cache, const std::string& cache_key,
+                      const Slice& blob) const;
+
   // The helper function of UpdateAccumulatedStats, which may fill the missing
   // fields of file_meta from its associated TableProperties.
   // Returns true if it does initialize FileMetaData.
@@ -930,6 +1054,10 @@ class AtomicGroupReadBuffer {
 // column families via ColumnFamilySet, i.e. set of the column families.
 class VersionSet {
  public:
+  // With DBOptions::max_manifest_space_amp_pct, the manifest file is not
+  // rolled over before reaching this size
+  static constexpr uint64_t kMinManifestFileSizeForSpaceAmp = 1 << 20;
+
   VersionSet(const std::string& dbname, const ImmutableDBOptions* db_options,
              const FileOptions& file_options, Cache* table_cache,
              WriteBufferManager* write_buffer_manager,
@@ -1074,6 +1202,10 @@ class VersionSet {
 
   uint64_t current_next_file_number() const { return next_file_number_.load(); }
 
+  // Incremented whenever a new Version is installed in any column family.
+  // REQUIRES: DB mutex held
+  uint64_t current_version_number() const { return current_version_number_; }
+
   uint64_t min_log_number_to_keep_2pc() const {
     return min_log_number_to_keep_2pc_.load();
   }
@@ -1220,6 +1352,13 @@ class VersionSet {
                            int start_level, int end_level,
                            TableReaderCaller caller);
 
+  // Return the approximate number of entries in files for range [start, end)
+  // in levels [start_level, end_level). If end_level == -1 it will search
+  // through all non-empty levels
+  uint64_t ApproximateNumEntries(Version* v, const Slice& start,
+                                 const Slice& end, int start_level,
+                                 int end_level, TableReaderCaller caller);
+
   // Return the size of the current manifest file
   uint64_t manifest_file_size() const { return manifest_file_size_; }
 
@@ -1308,6 +1447,12 @@ class VersionSet {
                            const Slice& start, const Slice& end,
                            TableReaderCaller caller);
 
+  // Returns approximated number of entries between start and end keys in a
+  // file for a given version.
+  uint64_t ApproximateNumEntries(Version* v, const FdWithKeyRange& f,
+                                 const Slice& start, const Slice& end,
+                                 TableReaderCaller caller);
+
   struct MutableCFState {
     uint64_t log_number;
     std::string full_history_ts_low;
@@ -1378,6 +1523,10 @@ class VersionSet {
   // Current size of manifest file
   uint64_t manifest_file_size_;
 
+  // Size of the snapshot of the DB state the current manifest file starts
+  // with, or 0 if it was not written by this VersionSet
+  uint64_t manifest_snapshot_size_;
+
   std::vector<ObsoleteFileInfo> obsolete_files_;
   std::vector<ObsoleteBlobFileInfo> obsolete_blob_files_;
   std::vector<std::string> obsolete_manifests_;
@@ -445,6 +445,33 @@ TEST_F(VersionStorageInfoTest, FileLocationAndMetaDataByNumber) {
   ASSERT_EQ(vstorage_.GetFileMetaDataByNumber(999U), nullptr);
 }
 
+TEST_F(VersionStorageInfoTest, Level0Sublevels) {
+  // L0 files are added newest first
+  Add(0, 5U, "a", "b");
+  Add(0, 4U, "c", "d");
+  Add(0, 3U, "a", "c");
+  Add(0, 2U, "e", "f");
+  Add(0, 1U, "b", "e");
+  vstorage_.UpdateNumNonEmptyLevels();
+  vstorage_.GenerateLevelFilesBrief();
+  vstorage_.GenerateLevel0Sublevels();
+
+  std::string result;
+  for (const auto& sublevel : vstorage_.Level0Sublevels()) {
+    if (!result.empty()) {
+      result += ";";
+    }
+    for (size_t i = 0; i < sublevel.num_files; ++i) {
+      if (i > 0) {
+        result += ",";
+      }
+      AppendNumberTo(&result, sublevel.files[i].fd.GetNumber());
+    }
+  }
+  // 2 and 3 only overlap 1; 4 and 5 overlap 3 as well
+  ASSERT_EQ("5,4;3,2;1", result);
+}
+
 class VersionStorageInfoTimestampTest : public VersionStorageInfoTestBase {
  public:
   VersionStorageInfoTimestampTest()
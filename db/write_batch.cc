@@ -35,6 +35,7 @@
 
 #include "rocksdb/write_batch.h"
 
+#include <algorithm>
 #include <map>
 #include <stack>
 #include <stdexcept>
@@ -1353,6 +1354,46 @@ Status WriteBatch::AssignTimestamps(const std::vector<Slice>& ts_list) {
   return Iterate(&ts_assigner);
 }
 
+// Collects the point records of a write batch so that they can be inserted
+// into the memtable in key order. Any other record type makes Iterate() fail,
+// which means the batch is not eligible for sorted insertion.
+class SortedBatchCollector : public WriteBatch::Handler {
+ public:
+  struct Record {
+    uint32_t column_family_id;
+    ValueType type;
+    // Position in the batch, i.e. offset from the batch sequence number
+    uint32_t index;
+    Slice key;
+    Slice value;
+  };
+
+  Status PutCF(uint32_t column_family_id, const Slice& key,
+               const Slice& value) override {
+    return Add(column_family_id, kTypeValue, key, value);
+  }
+
+  Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+    return Add(column_family_id, kTypeDeletion, key, Slice());
+  }
+
+  Status SingleDeleteCF(uint32_t column_family_id, const Slice& key) override {
+    return Add(column_family_id, kTypeSingleDeletion, key, Slice());
+  }
+
+  std::vector<Record>& records() { return records_; }
+
+ private:
+  Status Add(uint32_t column_family_id, ValueType type, const Slice& key,
+             const Slice& value) {
+    records_.push_back({column_family_id, type,
+                        static_cast<uint32_t>(records_.size()), key, value});
+    return Status::OK();
+  }
+
+  std::vector<Record> records_;
+};
+
 class MemTableInserter : public WriteBatch::Handler {
 
   SequenceNumber sequence_;
@@ -1531,6 +1572,103 @@ class MemTableInserter : public WriteBatch::Handler {
 
   SequenceNumber sequence() const { return sequence_; }
 
+  // Inserts the records of `batch` in key order rather than batch order when
+  // DBOptions::memtable_batch_sort_threshold allows it. Each record keeps the
+  // sequence number of its position in the batch. Returns false, without
+  // inserting anything, if the batch has to be inserted via Iterate().
+  bool MaybeInsertSorted(const WriteBatch* batch, Status* s) {
+    size_t threshold =
+        db_ != nullptr
+            ? db_->immutable_db_options().memtable_batch_sort_threshold
+            : 0;
+    if (threshold == 0 || WriteBatchInternal::Count(batch) < threshold ||
+        seq_per_batch_ || prot_info_ != nullptr ||
+        rebuilding_trx_ != nullptr) {
+      return false;
+    }
+    SortedBatchCollector collector;
+    if (!batch->Iterate(&collector).ok()) {
+      return false;
+    }
+    auto& records = collector.records();
+    if (records.empty()) {
+      return false;
+    }
+
+    // Every column family must exist and allow out-of-order inserts.
+    uint32_t last_cf = records.front().column_family_id;
+    const Comparator* ucmp = nullptr;
+    std::unordered_map<uint32_t, const Comparator*> comparators;
+    for (const auto& record : records) {
+      if (ucmp != nullptr && record.column_family_id == last_cf) {
+        continue;
+      }
+      last_cf = record.column_family_id;
+      auto it = comparators.find(last_cf);
+      if (it != comparators.end()) {
+        ucmp = it->second;
+        continue;
+      }
+      if (!cf_mems_->Seek(last_cf)) {
+        return false;
+      }
+      MemTable* mem = cf_mems_->GetMemTable();
+      if (mem->GetImmutableMemTableOptions()->inplace_update_support) {
+        return false;
+      }
+      ucmp = mem->GetInternalKeyComparator().user_comparator();
+      comparators.emplace(last_cf, ucmp);
+    }
+
+    // Memtable order: by key ascending, then by sequence number descending.
+    std::sort(records.begin(), records.end(),
+              [&comparators](const SortedBatchCollector::Record& a,
+                             const SortedBatchCollector::Record& b) {
+                if (a.column_family_id != b.column_family_id) {
+                  return a.column_family_id < b.column_family_id;
+                }
+                int cmp =
+                    comparators[a.column_family_id]->Compare(a.key, b.key);
+                return cmp < 0 || (cmp == 0 && a.index > b.index);
+              });
+
+    // Let consecutive concurrent inserts reuse the previous search path.
+    bool saved_hint_per_batch = hint_per_batch_;
+    hint_per_batch_ = concurrent_memtable_writes_;
+    const SequenceNumber base = sequence_;
+    // The memtable expects the first sequence number it sees to be its
+    // smallest one, so start with the oldest record of the batch.
+    size_t first = 0;
+    while (records[first].index != 0) {
+      first++;
+    }
+    *s = InsertSortedRecord(base, records[first]);
+    for (size_t i = 0; i < records.size() && s->ok(); i++) {
+      if (i != first) {
+        *s = InsertSortedRecord(base, records[i]);
+      }
+    }
+    hint_per_batch_ = saved_hint_per_batch;
+    sequence_ = base + records.size();
+    return true;
+  }
+
+  Status InsertSortedRecord(SequenceNumber base,
+                            const SortedBatchCollector::Record& record) {
+    sequence_ = base + record.index;
+    switch (record.type) {
+      case kTypeValue:
+        return PutCF(record.column_family_id, record.key, record.value);
+      case kTypeDeletion:
+        return DeleteCF(record.column_family_id, record.key);
+      case kTypeSingleDeletion:
+        return SingleDeleteCF(record.column_family_id, record.key);
+      default:
+        assert(false);
+        return Status::Corruption("unexpected record type in sorted batch");
+    }
+  }
+
   void PostProcess() {
     assert(concurrent_memtable_writes_);
     // If post info was not created there is nothing
@@ -1622,8 +1760,13 @@ class MemTableInserter : public WriteBatch::Handler {
           mem->Add(sequence_, value_type, key, value, kv_prot_info,
                    concurrent_memtable_writes_, get_post_process_info(mem),
                    hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+    } else if (concurrent_memtable_writes_) {
+      // Checked by CheckConcurrentWritesSupported()
+      assert(moptions->inplace_callback == nullptr);
+      ret_status = mem->UpdateConcurrently(
+          sequence_, value_type, key, value, kv_prot_info,
+          OldestUnpublishedSequence(), get_post_process_info(mem));
     } else if (moptions->inplace_callback == nullptr) {
-      assert(!concurrent_memtable_writes_);
       ret_status = mem->Update(sequence_, key, value, kv_prot_info);
     } else {
       assert(!concurrent_memtable_writes_);
@@ -1733,7 +1876,7 @@ class MemTableInserter : public WriteBatch::Handler {
     if (kv_prot_info != nullptr) {
       // Memtable needs seqno, doesn't need CF ID
       auto mem_kv_prot_info =
-          kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+          kv_prot_info->StripCProtectS(column_family_id, sequence_);
       return PutCFImpl(column_family_id, key, value, kTypeValue,
                        &mem_kv_prot_info);
     }
@@ -1746,10 +1889,18 @@ class MemTableInserter : public WriteBatch::Handler {
                     const ProtectionInfoKVOTS64* kv_prot_info) {
     Status ret_status;
     MemTable* mem = cf_mems_->GetMemTable();
-    ret_status =
-        mem->Add(sequence_, delete_type, key, value, kv_prot_info,
-                 concurrent_memtable_writes_, get_post_process_info(mem),
-                 hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+    if (concurrent_memtable_writes_ &&
+        mem->GetImmutableMemTableOptions()->inplace_update_support) {
+      // Must not hide a newer value written in-place by another writer
+      ret_status = mem->UpdateConcurrently(
+          sequence_, delete_type, key, value, kv_prot_info,
+          OldestUnpublishedSequence(), get_post_process_info(mem));
+    } else {
+      ret_status =
+          mem->Add(sequence_, delete_type, key, value, kv_prot_info,
+                   concurrent_memtable_writes_, get_post_process_info(mem),
+                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+    }
     if (UNLIKELY(ret_status.IsTryAgain())) {
       assert(seq_per_batch_);
       const bool kBatchBoundary = true;
@@ -1797,7 +1948,7 @@ class MemTableInserter : public WriteBatch::Handler {
         (0 == ts_sz) ? kTypeDeletion : kTypeDeletionWithTimestamp;
     if (kv_prot_info != nullptr) {
       auto mem_kv_prot_info =
-          kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+          kv_prot_info->StripCProtectS(column_family_id, sequence_);
       mem_kv_prot_info.UpdateO(kTypeDeletion, delete_type);
       ret_status = DeleteImpl(column_family_id, key, Slice(), delete_type,
                               &mem_kv_prot_info);
@@ -1850,7 +2001,7 @@ class MemTableInserter : public WriteBatch::Handler {
 
     if (kv_prot_info != nullptr) {
       auto mem_kv_prot_info =
-          kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+          kv_prot_info->StripCProtectS(column_family_id, sequence_);
       ret_status = DeleteImpl(column_family_id, key, Slice(),
                               kTypeSingleDeletion, &mem_kv_prot_info);
     } else {
@@ -1933,7 +2084,7 @@ class MemTableInserter : public WriteBatch::Handler {
 
     if (kv_prot_info != nullptr) {
       auto mem_kv_prot_info =
-          kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+          kv_prot_info->StripCProtectS(column_family_id, sequence_);
       ret_status = DeleteImpl(column_family_id, begin_key, end_key,
                               kTypeRangeDeletion, &mem_kv_prot_info);
     } else {
@@ -2053,7 +2204,7 @@ class MemTableInserter : public WriteBatch::Handler {
           assert(!concurrent_memtable_writes_);
           if (kv_prot_info != nullptr) {
             auto merged_kv_prot_info =
-                kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+                kv_prot_info->StripCProtectS(column_family_id, sequence_);
             merged_kv_prot_info.UpdateV(value, new_value);
             merged_kv_prot_info.UpdateO(kTypeMerge, kTypeValue);
             ret_status = mem->Add(sequence_, kTypeValue, key, new_value,
@@ -2066,12 +2217,24 @@ class MemTableInserter : public WriteBatch::Handler {
       }
     }
 
-    if (!perform_merge) {
+    if (!perform_merge && moptions->inplace_update_support) {
+      assert(ret_status.ok());
+      assert(!concurrent_memtable_writes_);
+      // Combine with the latest merge operand of the key in place if possible
+      if (kv_prot_info != nullptr) {
+        auto mem_kv_prot_info =
+            kv_prot_info->StripCProtectS(column_family_id, sequence_);
+        ret_status = mem->UpdateMerge(sequence_, key, value, &mem_kv_prot_info);
+      } else {
+        ret_status =
+            mem->UpdateMerge(sequence_, key, value, nullptr /* kv_prot_info */);
+      }
+    } else if (!perform_merge) {
       assert(ret_status.ok());
       // Add merge operand to memtable
       if (kv_prot_info != nullptr) {
         auto mem_kv_prot_info =
-            kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+            kv_prot_info->StripCProtectS(column_family_id, sequence_);
         ret_status =
             mem->Add(sequence_, kTypeMerge, key, value, &mem_kv_prot_info,
                      concurrent_memtable_writes_, get_post_process_info(mem));
@@ -2110,7 +2273,7 @@ class MemTableInserter : public WriteBatch::Handler {
     if (kv_prot_info != nullptr) {
       // Memtable needs seqno, doesn't need CF ID
       auto mem_kv_prot_info =
-          kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+          kv_prot_info->StripCProtectS(column_family_id, sequence_);
       // Same as PutCF except for value type.
       return PutCFImpl(column_family_id, key, value, kTypeBlobIndex,
                        &mem_kv_prot_info);
@@ -2307,6 +2470,12 @@ class MemTableInserter : public WriteBatch::Handler {
     }
     return &GetPostMap()[mem];
   }
+
+  // Writes still in progress, including this one, all have larger sequence
+  // numbers than the last published one.
+  SequenceNumber OldestUnpublishedSequence() const {
+    return db_ == nullptr ? 0 : db_->GetLastPublishedSequence() + 1;
+  }
 };
 
 // This function can only be called in these conditions:
@@ -2338,7 +2507,9 @@ Status WriteBatchInternal::InsertInto(
     SetSequence(w->batch, inserter.sequence());
     inserter.set_log_number_ref(w->log_ref);
     inserter.set_prot_info(w->batch->prot_info_.get());
-    w->status = w->batch->Iterate(&inserter);
+    if (!inserter.MaybeInsertSorted(w->batch, &w->status)) {
+      w->status = w->batch->Iterate(&inserter);
+    }
     if (!w->status.ok()) {
       return w->status;
     }
@@ -2368,7 +2539,10 @@ Status WriteBatchInternal::InsertInto(
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
   inserter.set_prot_info(writer->batch->prot_info_.get());
-  Status s = writer->batch->Iterate(&inserter);
+  Status s;
+  if (!inserter.MaybeInsertSorted(writer->batch, &s)) {
+    s = writer->batch->Iterate(&inserter);
+  }
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
   if (concurrent_memtable_writes) {
@@ -2389,7 +2563,10 @@ Status WriteBatchInternal::InsertInto(
                             ignore_missing_column_families, log_number, db,
                             concurrent_memtable_writes, batch->prot_info_.get(),
                             has_valid_writes, seq_per_batch, batch_per_txn);
-  Status s = batch->Iterate(&inserter);
+  Status s;
+  if (!inserter.MaybeInsertSorted(batch, &s)) {
+    s = batch->Iterate(&inserter);
+  }
   if (next_seq != nullptr) {
     *next_seq = inserter.sequence();
   }
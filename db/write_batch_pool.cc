@@ -0,0 +1,54 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/write_batch_pool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+WriteBatchPool::WriteBatchPool(size_t reserved_bytes, size_t max_bytes,
+                               size_t max_cached_batches,
+                               size_t max_cached_capacity)
+    : reserved_bytes_(reserved_bytes),
+      max_bytes_(max_bytes),
+      max_cached_batches_(max_cached_batches),
+      max_cached_capacity_(max_cached_capacity) {}
+
+WriteBatchPool::~WriteBatchPool() {}
+
+WriteBatch* WriteBatchPool::Acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!cached_.empty()) {
+      WriteBatch* batch = cached_.back().release();
+      cached_.pop_back();
+      return batch;
+    }
+  }
+  return new WriteBatch(reserved_bytes_, max_bytes_);
+}
+
+void WriteBatchPool::Release(WriteBatch* batch) {
+  if (batch == nullptr) {
+    return;
+  }
+  std::unique_ptr<WriteBatch> holder(batch);
+  if (max_cached_capacity_ > 0 &&
+      batch->Data().capacity() > max_cached_capacity_) {
+    return;
+  }
+  // Clear outside the lock; it only touches the batch itself.
+  batch->Clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cached_.size() < max_cached_batches_) {
+    cached_.push_back(std::move(holder));
+  }
+}
+
+size_t WriteBatchPool::NumCached() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cached_.size();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
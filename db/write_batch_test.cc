@@ -17,6 +17,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/utilities/write_batch_with_index.h"
+#include "rocksdb/write_batch_pool.h"
 #include "rocksdb/write_buffer_manager.h"
 #include "table/scoped_arena_iterator.h"
 #include "test_util/testharness.h"
@@ -899,6 +900,51 @@ TEST_F(WriteBatchTest, MemoryLimitTest) {
   ASSERT_TRUE(s.IsMemoryLimit());
 }
 
+TEST_F(WriteBatchTest, ClearRetainsCapacity) {
+  WriteBatch batch;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(batch.Put("key" + ToString(i), std::string(100, 'v')));
+  }
+  size_t capacity = batch.Data().capacity();
+  batch.Clear();
+  ASSERT_EQ(0, batch.Count());
+  ASSERT_EQ(WriteBatchInternal::kHeader, batch.GetDataSize());
+  ASSERT_EQ(capacity, batch.Data().capacity());
+}
+
+TEST_F(WriteBatchTest, PoolReusesBatches) {
+  WriteBatchPool pool(1024 /* reserved_bytes */, 0 /* max_bytes */,
+                      2 /* max_cached_batches */,
+                      64 << 10 /* max_cached_capacity */);
+  WriteBatch* batch = pool.Acquire();
+  ASSERT_GE(batch->Data().capacity(), 1024);
+  ASSERT_OK(batch->Put("foo", "bar"));
+  pool.Release(batch);
+  ASSERT_EQ(1, pool.NumCached());
+
+  // The same batch comes back, cleared.
+  WriteBatch* reused = pool.Acquire();
+  ASSERT_EQ(batch, reused);
+  ASSERT_EQ(0, pool.NumCached());
+  ASSERT_EQ(0, reused->Count());
+  ASSERT_EQ(WriteBatchInternal::kHeader, reused->GetDataSize());
+
+  // Batches that grew too large are freed instead of cached.
+  ASSERT_OK(reused->Put("big", std::string(128 << 10, 'v')));
+  pool.Release(reused);
+  ASSERT_EQ(0, pool.NumCached());
+
+  // At most max_cached_batches are kept.
+  std::vector<WriteBatch*> batches;
+  for (int i = 0; i < 3; i++) {
+    batches.push_back(pool.Acquire());
+  }
+  for (auto* b : batches) {
+    pool.Release(b);
+  }
+  ASSERT_EQ(2, pool.NumCached());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include "db/write_thread.h"
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include "db/column_family.h"
@@ -19,9 +20,20 @@ WriteThread::WriteThread(const ImmutableDBOptions& db_options)
                           ? db_options.write_thread_max_yield_usec
                           : 0),
       slow_yield_usec_(db_options.write_thread_slow_yield_usec),
+      max_spinning_writers_(db_options.write_thread_spinners_per_core *
+                            std::max(1u, std::thread::hardware_concurrency())),
+      spinning_writers_(0),
       allow_concurrent_memtable_write_(
           db_options.allow_concurrent_memtable_write),
       enable_pipelined_write_(db_options.enable_pipelined_write),
+      enable_fast_path_(db_options.enable_no_wal_write_fast_path &&
+                        db_options.allow_concurrent_memtable_write &&
+                        !db_options.enable_pipelined_write &&
+                        !db_options.unordered_write &&
+                        !db_options.two_write_queues),
+      fast_path_blocked_(false),
+      fast_path_writers_(0),
+      fast_path_last_allocated_(kMaxSequenceNumber),
       max_write_batch_group_size_bytes(
           db_options.max_write_batch_group_size_bytes),
       newest_writer_(nullptr),
@@ -59,24 +71,51 @@ uint8_t WriteThread::BlockingAwaitState(Writer* w, uint8_t goal_mask) {
   return state;
 }
 
+bool WriteThread::TryBeginSpinning() {
+  if (max_spinning_writers_ == 0) {
+    return true;
+  }
+  uint32_t spinning = spinning_writers_.load(std::memory_order_relaxed);
+  while (spinning < max_spinning_writers_) {
+    if (spinning_writers_.compare_exchange_weak(spinning, spinning + 1,
+                                                std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WriteThread::EndSpinning() {
+  if (max_spinning_writers_ != 0) {
+    assert(spinning_writers_.load(std::memory_order_relaxed) > 0);
+    spinning_writers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
 uint8_t WriteThread::AwaitState(Writer* w, uint8_t goal_mask,
                                 AdaptationContext* ctx) {
   uint8_t state = 0;
 
+  // 0. Skip spinning entirely if too many writers are already spinning
   // 1. Busy loop using "pause" for 1 micro sec
   // 2. Else SOMETIMES busy loop using "yield" for 100 micro sec (default)
   // 3. Else blocking wait
-
-  // On a modern Xeon each loop takes about 7 nanoseconds (most of which
-  // is the effect of the pause instruction), so 200 iterations is a bit
-  // more than a microsecond.  This is long enough that waits longer than
-  // this can amortize the cost of accessing the clock and yielding.
-  for (uint32_t tries = 0; tries < 200; ++tries) {
-    state = w->state.load(std::memory_order_acquire);
-    if ((state & goal_mask) != 0) {
-      return state;
+  const bool may_spin = TryBeginSpinning();
+  if (!may_spin) {
+    TEST_SYNC_POINT_CALLBACK("WriteThread::AwaitState:SpinBudgetExceeded", w);
+  } else {
+    // On a modern Xeon each loop takes about 7 nanoseconds (most of which
+    // is the effect of the pause instruction), so 200 iterations is a bit
+    // more than a microsecond.  This is long enough that waits longer than
+    // this can amortize the cost of accessing the clock and yielding.
+    for (uint32_t tries = 0; tries < 200; ++tries) {
+      state = w->state.load(std::memory_order_acquire);
+      if ((state & goal_mask) != 0) {
+        EndSpinning();
+        return state;
+      }
+      port::AsmVolatilePause();
     }
-    port::AsmVolatilePause();
   }
 
   // This is below the fast path, so that the stat is zero when all writes are
@@ -139,7 +178,7 @@ uint8_t WriteThread::AwaitState(Writer* w, uint8_t goal_mask,
   // 1/sampling_base.
   const int sampling_base = 256;
 
-  if (max_yield_usec_ > 0) {
+  if (may_spin && max_yield_usec_ > 0) {
     update_ctx = Random::GetTLSInstance()->OneIn(sampling_base);
 
     if (update_ctx || yield_credit.load(std::memory_order_relaxed) >= 0) {
@@ -182,6 +221,10 @@ uint8_t WriteThread::AwaitState(Writer* w, uint8_t goal_mask,
     }
   }
 
+  if (may_spin) {
+    EndSpinning();
+  }
+
   if ((state & goal_mask) == 0) {
     TEST_SYNC_POINT_CALLBACK("WriteThread::AwaitState:BlockingWaiting", w);
     state = BlockingAwaitState(w, goal_mask);
@@ -410,6 +453,24 @@ void WriteThread::JoinBatchGroup(Writer* w) {
                &jbg_ctx);
     TEST_SYNC_POINT_CALLBACK("WriteThread::JoinBatchGroup:DoneWaiting", w);
   }
+
+  if (w->state.load(std::memory_order_acquire) == STATE_GROUP_LEADER) {
+    BlockFastPath();
+  }
+}
+
+void WriteThread::BlockFastPath() {
+  if (!enable_fast_path_) {
+    return;
+  }
+  fast_path_blocked_.store(true, std::memory_order_seq_cst);
+  while (fast_path_writers_.load(std::memory_order_seq_cst) > 0) {
+    port::AsmVolatilePause();
+  }
+  // Fast path writes have published their sequences, and the leader may
+  // now advance the last sequence on its own
+  fast_path_last_allocated_.store(kMaxSequenceNumber,
+                                  std::memory_order_seq_cst);
 }
 
 size_t WriteThread::EnterAsBatchGroupLeader(Writer* leader,
@@ -649,6 +710,9 @@ void WriteThread::ExitAsBatchGroupLeader(WriteGroup& write_group,
     status = write_group.status;
   }
 
+  // The caller has published the sequences of the group
+  UnblockFastPath();
+
   if (enable_pipelined_write_) {
     // Notify writers don't write to memtable to exit.
     for (Writer* w = last_writer; w != leader;) {
@@ -768,6 +832,7 @@ void WriteThread::EnterUnbatched(Writer* w, InstrumentedMutex* mu) {
     // Last leader will not pick us as a follower since our batch is nullptr
     AwaitState(w, STATE_GROUP_LEADER, &eu_ctx);
   }
+  BlockFastPath();
   if (enable_pipelined_write_) {
     WaitForMemTableWriters();
   }
@@ -776,6 +841,7 @@ void WriteThread::EnterUnbatched(Writer* w, InstrumentedMutex* mu) {
 
 void WriteThread::ExitUnbatched(Writer* w) {
   assert(w != nullptr);
+  UnblockFastPath();
   Writer* newest_writer = w;
   if (!newest_writer_.compare_exchange_strong(newest_writer, nullptr)) {
     CreateMissingNewerLinks(newest_writer);
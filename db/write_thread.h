@@ -347,6 +347,49 @@ class WriteThread {
     return last_sequence_;
   }
 
+  // Fast path for writes that skip the writer queue (see
+  // DBOptions::enable_no_wal_write_fast_path). A fast path write allocates
+  // its own sequence numbers, inserts into the memtables concurrently with
+  // other fast path writes and publishes its last sequence in allocation
+  // order. Becoming the leader of a batch group, or entering unbatched,
+  // blocks the fast path and waits for the fast path writes in progress, so
+  // the leader keeps exclusive access to the memtables and the last
+  // sequence until it exits.
+
+  // EnterFastPath() returns false if the fast path is blocked, in which case
+  // the write has to join a batch group. Otherwise the caller must call
+  // ExitFastPath() once its write is published.
+  bool fast_path_enabled() const { return enable_fast_path_; }
+
+  bool EnterFastPath() {
+    fast_path_writers_.fetch_add(1, std::memory_order_seq_cst);
+    if (fast_path_blocked_.load(std::memory_order_seq_cst)) {
+      fast_path_writers_.fetch_sub(1, std::memory_order_seq_cst);
+      return false;
+    }
+    return true;
+  }
+
+  void ExitFastPath() {
+    fast_path_writers_.fetch_sub(1, std::memory_order_seq_cst);
+  }
+
+  // Allocates count sequence numbers to a fast path write and returns the
+  // sequence number preceding them. last_sequence is the last published
+  // sequence, which only fast path writes advance while the fast path is
+  // not blocked; it is used by the first allocation after the fast path
+  // was blocked.
+  SequenceNumber AllocateFastPathSequences(size_t count,
+                                           SequenceNumber last_sequence) {
+    SequenceNumber allocated = fast_path_last_allocated_.load();
+    SequenceNumber base;
+    do {
+      base = allocated == kMaxSequenceNumber ? last_sequence : allocated;
+    } while (!fast_path_last_allocated_.compare_exchange_weak(allocated,
+                                                             base + count));
+    return base;
+  }
+
   // Insert a dummy writer at the tail of the write queue to indicate a write
   // stall, and fail any writers in the queue with no_slowdown set to true
   void BeginWriteStall();
@@ -359,12 +402,34 @@ class WriteThread {
   const uint64_t max_yield_usec_;
   const uint64_t slow_yield_usec_;
 
+  // Maximum number of writers allowed to spin in AwaitState at the same
+  // time, derived from write_thread_spinners_per_core. 0 means no limit.
+  const uint32_t max_spinning_writers_;
+
+  // Number of writers currently spinning in AwaitState. Only maintained
+  // when max_spinning_writers_ is non-zero.
+  std::atomic<uint32_t> spinning_writers_;
+
   // Allow multiple writers write to memtable concurrently.
   const bool allow_concurrent_memtable_write_;
 
   // Enable pipelined write to WAL and memtable.
   const bool enable_pipelined_write_;
 
+  // Writes may take the fast path, so leaders have to block it.
+  const bool enable_fast_path_;
+
+  // Set while a leader or an unbatched writer holds the write thread.
+  std::atomic<bool> fast_path_blocked_;
+
+  // Number of fast path writes in progress, including ones about to find the
+  // fast path blocked.
+  std::atomic<uint32_t> fast_path_writers_;
+
+  // Last sequence allocated to a fast path write, or kMaxSequenceNumber if
+  // none was since the fast path was last blocked.
+  std::atomic<SequenceNumber> fast_path_last_allocated_;
+
   // The maximum limit of number of bytes that are written in a single batch
   // of WAL or memtable write. It is followed when the leader write size
   // is larger than 1/8 of this limit.
@@ -403,9 +468,27 @@ class WriteThread {
   // a context-dependent static.
   uint8_t AwaitState(Writer* w, uint8_t goal_mask, AdaptationContext* ctx);
 
+  // Reserves a slot in the spinning budget. Returns false if the caller
+  // should skip spinning and block right away.
+  bool TryBeginSpinning();
+
+  // Releases a slot reserved by a successful TryBeginSpinning().
+  void EndSpinning();
+
   // Set writer state and wake the writer up if it is waiting.
   void SetState(Writer* w, uint8_t new_state);
 
+  // Blocks new fast path writes and waits for the ones in progress. Called
+  // by a writer that became leader.
+  void BlockFastPath();
+
+  // Lets writes take the fast path again.
+  void UnblockFastPath() {
+    if (enable_fast_path_) {
+      fast_path_blocked_.store(false, std::memory_order_seq_cst);
+    }
+  }
+
   // Links w into the newest_writer list. Return true if w was linked directly
   // into the leader position.  Safe to call from multiple threads without
   // external locking.
@@ -433,6 +433,12 @@ DEFINE_bool(
     ROCKSDB_NAMESPACE::BlockBasedTableOptions().optimize_filters_for_memory,
     "Minimize memory footprint of filters");
 
+DEFINE_bool(
+    reserve_table_builder_memory,
+    ROCKSDB_NAMESPACE::BlockBasedTableOptions().reserve_table_builder_memory,
+    "Charge memory used by table builders (filter construction) to the "
+    "block cache");
+
 DEFINE_int32(
     index_type,
     static_cast<int32_t>(
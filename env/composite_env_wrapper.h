@@ -322,6 +322,10 @@ class CompositeEnvWrapper : public CompositeEnv {
     return env_target_->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolNumaNode(Priority pool, int node) override {
+    return env_target_->SetThreadPoolNumaNode(pool, node);
+  }
+
   Status GetThreadList(std::vector<ThreadStatus>* thread_list) override {
     return env_target_->GetThreadList(thread_list);
   }
@@ -1013,6 +1013,15 @@ EnvOptions Env::OptimizeForLogWrite(const EnvOptions& env_options,
   optimized_env_options.bytes_per_sync = db_options.wal_bytes_per_sync;
   optimized_env_options.writable_file_max_buffer_size =
       db_options.writable_file_max_buffer_size;
+  if (db_options.use_direct_io_for_wal) {
+    optimized_env_options.use_mmap_writes = false;
+    optimized_env_options.use_direct_writes = true;
+    optimized_env_options.use_dsync_writes = true;
+  }
+  if (db_options.use_pmem_for_wal) {
+    optimized_env_options.use_mmap_writes = true;
+    optimized_env_options.use_pmem_writes = true;
+  }
   return optimized_env_options;
 }
 
@@ -1037,6 +1046,8 @@ EnvOptions Env::OptimizeForCompactionTableWrite(
   EnvOptions optimized_env_options(env_options);
   optimized_env_options.use_direct_writes =
       db_options.use_direct_io_for_flush_and_compaction;
+  optimized_env_options.use_async_writes =
+      db_options.use_async_writes_for_flush_and_compaction;
   return optimized_env_options;
 }
 
@@ -12,6 +12,10 @@
 #include <cctype>
 #include <iostream>
 
+#ifdef ROCKSDB_OPENSSL_PRESENT
+#include <openssl/evp.h>
+#endif
+
 #include "env/composite_env_wrapper.h"
 #include "env/env_encryption_ctr.h"
 #include "monitoring/perf_context_imp.h"
@@ -1054,6 +1058,109 @@ class ROT13BlockCipher : public BlockCipher {
   // Length of data is equal to BlockSize().
   Status Decrypt(char* data) override { return Encrypt(data); }
 };
+
+#ifdef ROCKSDB_OPENSSL_PRESENT
+// Implements a BlockCipher using AES with OpenSSL, which uses the AES-NI or
+// ARMv8 crypto instructions where available and pipelines runs of blocks.
+//
+// The key is not part of the options of the cipher, so it is never written
+// to an options file.
+class AESBlockCipher : public BlockCipher {
+ public:
+  static const size_t kBlockSize = 16;
+
+  static const char* kClassName() { return "AES"; }
+  const char* Name() const override { return kClassName(); }
+
+  static Status Create(const std::string& key,
+                       std::unique_ptr<BlockCipher>* result) {
+    const EVP_CIPHER* type = nullptr;
+    switch (key.size()) {
+      case 16:
+        type = EVP_aes_128_ecb();
+        break;
+      case 24:
+        type = EVP_aes_192_ecb();
+        break;
+      case 32:
+        type = EVP_aes_256_ecb();
+        break;
+      default:
+        return Status::InvalidArgument("AES key must be 16, 24 or 32 bytes");
+    }
+    std::unique_ptr<AESBlockCipher> cipher(new AESBlockCipher());
+    cipher->encrypt_ctx_ = EVP_CIPHER_CTX_new();
+    cipher->decrypt_ctx_ = EVP_CIPHER_CTX_new();
+    const unsigned char* k = reinterpret_cast<const unsigned char*>(key.data());
+    if (cipher->encrypt_ctx_ == nullptr || cipher->decrypt_ctx_ == nullptr ||
+        EVP_CipherInit_ex(cipher->encrypt_ctx_, type, nullptr, k, nullptr,
+                          1 /* enc */) != 1 ||
+        EVP_CipherInit_ex(cipher->decrypt_ctx_, type, nullptr, k, nullptr,
+                          0 /* enc */) != 1) {
+      return Status::Aborted("Failed to initialize the AES cipher");
+    }
+    EVP_CIPHER_CTX_set_padding(cipher->encrypt_ctx_, 0);
+    EVP_CIPHER_CTX_set_padding(cipher->decrypt_ctx_, 0);
+    result->reset(cipher.release());
+    return Status::OK();
+  }
+
+  ~AESBlockCipher() override {
+    EVP_CIPHER_CTX_free(encrypt_ctx_);
+    EVP_CIPHER_CTX_free(decrypt_ctx_);
+  }
+
+  // BlockSize returns the size of each block supported by this cipher stream.
+  size_t BlockSize() override { return kBlockSize; }
+
+  // Encrypt a block of data.
+  // Length of data is equal to BlockSize().
+  Status Encrypt(char* data) override { return Run(encrypt_ctx_, data, 1); }
+
+  // Decrypt a block of data.
+  // Length of data is equal to BlockSize().
+  Status Decrypt(char* data) override { return Run(decrypt_ctx_, data, 1); }
+
+  Status EncryptBlocks(char* data, size_t num_blocks) override {
+    return Run(encrypt_ctx_, data, num_blocks);
+  }
+
+ private:
+  AESBlockCipher() = default;
+
+  // The cipher is shared by all the files of a FileSystem, so the contexts
+  // holding the expanded keys are only copied, never used directly.
+  static Status Run(const EVP_CIPHER_CTX* proto, char* data,
+                    size_t num_blocks) {
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (ctx == nullptr || EVP_CIPHER_CTX_copy(ctx, proto) != 1) {
+      EVP_CIPHER_CTX_free(ctx);
+      return Status::Aborted("Failed to copy the AES cipher context");
+    }
+    // EVP_CipherUpdate() takes an int length
+    static const size_t kMaxBlocksPerCall = (1 << 20) / kBlockSize;
+    unsigned char* p = reinterpret_cast<unsigned char*>(data);
+    while (num_blocks > 0) {
+      const size_t n = std::min<size_t>(num_blocks, kMaxBlocksPerCall);
+      const int len = static_cast<int>(n * kBlockSize);
+      int out_len = 0;
+      if (EVP_CipherUpdate(ctx, p, &out_len, p, len) != 1 ||
+          out_len != len) {
+        EVP_CIPHER_CTX_free(ctx);
+        return Status::Aborted("AES cipher operation failed");
+      }
+      p += len;
+      num_blocks -= n;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return Status::OK();
+  }
+
+  EVP_CIPHER_CTX* encrypt_ctx_ = nullptr;
+  EVP_CIPHER_CTX* decrypt_ctx_ = nullptr;
+};
+#endif  // ROCKSDB_OPENSSL_PRESENT
+
 static const std::unordered_map<std::string, OptionTypeInfo>
     ctr_encryption_provider_type_info = {
         {"cipher",
@@ -1063,6 +1170,84 @@ static const std::unordered_map<std::string, OptionTypeInfo>
 };
 }  // anonymous namespace
 
+Status BlockCipher::EncryptBlocks(char* data, size_t num_blocks) {
+  const size_t block_size = BlockSize();
+  for (size_t i = 0; i < num_blocks; ++i) {
+    Status status = Encrypt(data + i * block_size);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return Status::OK();
+}
+
+// Encrypt one or more (partial) blocks of data at the file offset.
+Status CTRCipherStream::Encrypt(uint64_t fileOffset, char* data,
+                                size_t dataSize) {
+  if (dataSize == 0) {
+    return Status::OK();
+  }
+  const size_t blockSize = cipher_->BlockSize();
+  if (blockSize == 0) {
+    return Status::NotSupported("BlockSize() must be > 0");
+  }
+  // The key stream is generated this many bytes at a time
+  static constexpr size_t kKeyStreamSize = 4096;
+  const size_t chunkBlocks = std::max<size_t>(1, kKeyStreamSize / blockSize);
+  char stackBuf[kKeyStreamSize];
+  std::unique_ptr<char[]> heapBuf;
+  char* keyStream = stackBuf;
+  if (chunkBlocks * blockSize > kKeyStreamSize) {
+    heapBuf.reset(new char[chunkBlocks * blockSize]);
+    keyStream = heapBuf.get();
+  }
+
+  uint64_t blockIndex = fileOffset / blockSize;
+  size_t blockOffset = fileOffset % blockSize;
+  while (dataSize > 0) {
+    const size_t numBlocks = std::min(
+        chunkBlocks, (blockOffset + dataSize + blockSize - 1) / blockSize);
+    // Nonce + counter of every block, laid out as in EncryptBlock()
+    for (size_t b = 0; b < numBlocks; ++b) {
+      char* counter = keyStream + b * blockSize;
+      memcpy(counter, iv_.data(), blockSize);
+      EncodeFixed64(counter, blockIndex + b + initialCounter_);
+    }
+    Status status = cipher_->EncryptBlocks(keyStream, numBlocks);
+    if (!status.ok()) {
+      return status;
+    }
+
+    // XOR data with the key stream
+    const size_t n = std::min(numBlocks * blockSize - blockOffset, dataSize);
+    const char* ks = keyStream + blockOffset;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+      uint64_t d;
+      uint64_t k;
+      memcpy(&d, data + i, sizeof(d));
+      memcpy(&k, ks + i, sizeof(k));
+      d ^= k;
+      memcpy(data + i, &d, sizeof(d));
+    }
+    for (; i < n; ++i) {
+      data[i] = data[i] ^ ks[i];
+    }
+    data += n;
+    dataSize -= n;
+    blockIndex += numBlocks;
+    blockOffset = 0;
+  }
+  return Status::OK();
+}
+
+// Decrypt one or more (partial) blocks of data at the file offset.
+Status CTRCipherStream::Decrypt(uint64_t fileOffset, char* data,
+                                size_t dataSize) {
+  // For CTR decryption & encryption are the same
+  return Encrypt(fileOffset, data, dataSize);
+}
+
 // Allocate scratch space which is passed to EncryptBlock/DecryptBlock.
 void CTRCipherStream::AllocateScratch(std::string& scratch) {
   auto blockSize = cipher_->BlockSize();
@@ -1280,10 +1465,44 @@ static void RegisterEncryptionBuiltins() {
 
           return guard->get();
         });
+
+#ifdef ROCKSDB_OPENSSL_PRESENT
+    lib->Register<BlockCipher>(
+        std::string(AESBlockCipher::kClassName()) + ":.*",
+        [](const std::string& uri, std::unique_ptr<BlockCipher>* guard,
+           std::string* errmsg) {
+          std::string key;
+          if (!Slice(uri.substr(uri.find(':') + 1)).DecodeHex(&key)) {
+            *errmsg = "Invalid AES key: " + uri;
+            return static_cast<BlockCipher*>(nullptr);
+          }
+          Status s = AESBlockCipher::Create(key, guard);
+          if (!s.ok()) {
+            *errmsg = s.ToString();
+          }
+          return guard->get();
+        });
+#endif  // ROCKSDB_OPENSSL_PRESENT
   });
 }
 }  // namespace
 
+Status BlockCipher::NewAESCipher(const std::string& key,
+                                 std::shared_ptr<BlockCipher>* result) {
+#ifdef ROCKSDB_OPENSSL_PRESENT
+  std::unique_ptr<BlockCipher> cipher;
+  Status s = AESBlockCipher::Create(key, &cipher);
+  if (s.ok()) {
+    result->reset(cipher.release());
+  }
+  return s;
+#else
+  (void)key;
+  (void)result;
+  return Status::NotSupported("AES cipher requires building with OpenSSL");
+#endif  // ROCKSDB_OPENSSL_PRESENT
+}
+
 Status BlockCipher::CreateFromString(const ConfigOptions& config_options,
                                      const std::string& value,
                                      std::shared_ptr<BlockCipher>* result) {
@@ -31,6 +31,15 @@ class CTRCipherStream final : public BlockAccessCipherStream {
   // BlockSize returns the size of each block supported by this cipher stream.
   size_t BlockSize() override { return cipher_->BlockSize(); }
 
+  // Encrypt one or more (partial) blocks of data at the file offset.
+  // The key stream for a run of blocks is generated with a single
+  // BlockCipher::EncryptBlocks() call and XOR-ed into the data.
+  Status Encrypt(uint64_t fileOffset, char* data, size_t dataSize) override;
+
+  // Decrypt one or more (partial) blocks of data at the file offset.
+  // For CTR decryption & encryption are the same.
+  Status Decrypt(uint64_t fileOffset, char* data, size_t dataSize) override;
+
  protected:
   // Allocate scratch space which is passed to EncryptBlock/DecryptBlock.
   void AllocateScratch(std::string&) override;
@@ -372,6 +372,11 @@ class PosixEnv : public CompositeEnv {
     return Status::OK();
   }
 
+  Status SetThreadPoolNumaNode(Priority pool, int node) override {
+    assert(pool >= Priority::BOTTOM && pool <= Priority::HIGH);
+    return thread_pools_[pool].SetNumaNode(node);
+  }
+
  private:
   friend Env* Env::Default();
   // Constructs the default Env, a singleton
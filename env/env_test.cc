@@ -35,6 +35,10 @@
 #include <errno.h>
 #endif
 
+#ifdef NUMA
+#include <numa.h>
+#endif
+
 #include "env/env_chroot.h"
 #include "env/env_encryption_ctr.h"
 #include "logging/log_buffer.h"
@@ -296,6 +300,51 @@ TEST_F(EnvPosixTest, LowerThreadPoolCpuPriority) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
+
+TEST_F(EnvPosixTest, SetThreadPoolNumaNode) {
+#ifdef NUMA
+  if (numa_available() < 0) {
+    ROCKSDB_GTEST_SKIP("NUMA is not available");
+    return;
+  }
+  std::atomic<int> numa_node(-2);
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "ThreadPoolImpl::BGThread::AfterSetNumaNode",
+      [&](void* node) { numa_node.store(*static_cast<int*>(node)); });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  env_->SetBackgroundThreads(1, Env::BOTTOM);
+  auto RunTask = [&]() {
+    std::atomic<bool> called(false);
+    env_->Schedule(&SetBool, &called, Env::Priority::BOTTOM);
+    for (int i = 0; i < kDelayMicros; i++) {
+      if (called.load()) {
+        break;
+      }
+      Env::Default()->SleepForMicroseconds(1);
+    }
+    ASSERT_TRUE(called.load());
+  };
+
+  ASSERT_OK(env_->SetThreadPoolNumaNode(Env::Priority::BOTTOM, 0));
+  RunTask();
+  ASSERT_EQ(0, numa_node.load());
+
+  ASSERT_OK(env_->SetThreadPoolNumaNode(Env::Priority::BOTTOM, -1));
+  RunTask();
+  ASSERT_EQ(-1, numa_node.load());
+
+  ASSERT_TRUE(env_->SetThreadPoolNumaNode(Env::Priority::BOTTOM,
+                                          numa_max_node() + 1)
+                  .IsInvalidArgument());
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+#else
+  ASSERT_TRUE(
+      env_->SetThreadPoolNumaNode(Env::Priority::BOTTOM, 0).IsNotSupported());
+#endif  // NUMA
+}
 #endif
 
 TEST_F(EnvPosixTest, MemoryMappedFileBuffer) {
@@ -1372,6 +1421,73 @@ TEST_F(EnvPosixTest, MultiReadNonAlignedLargeNum) {
   }
 }
 
+#ifndef OS_WIN
+TEST_F(EnvPosixTest, MultiReadIOUringOptions) {
+  IOUringOptions io_uring_options;
+  // Fewer file table entries than files, and fewer fixed buffers than
+  // requests
+  io_uring_options.queue_depth = 8;
+  io_uring_options.register_files = true;
+  io_uring_options.num_registered_files = 2;
+  io_uring_options.fixed_buffer_size = 4096;
+  io_uring_options.num_fixed_buffers = 3;
+  std::shared_ptr<FileSystem> fs = NewPosixFileSystem(io_uring_options);
+
+  const int kNumFiles = 3;
+  const size_t kFileSize = 65536;
+  Random rnd(301);
+  std::vector<std::string> fnames;
+  std::vector<std::string> contents;
+  for (int i = 0; i < kNumFiles; i++) {
+    fnames.push_back(
+        test::PerThreadDBPath(env_, "testfile" + ToString(i)));
+    contents.push_back(rnd.RandomString(kFileSize));
+    ASSERT_OK(WriteStringToFile(fs.get(), contents.back(), fnames.back()));
+  }
+
+  // Cut some reads short
+  SyncPoint::GetInstance()->SetCallBack(
+      "PosixRandomAccessFile::MultiRead:io_uring_result", [&](void* arg) {
+        size_t& bytes_read = *static_cast<size_t*>(arg);
+        if (bytes_read > 1 && rnd.OneIn(4)) {
+          bytes_read = rnd.Uniform(static_cast<int>(bytes_read)) + 1;
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (int round = 0; round < 3; round++) {
+    for (int f = 0; f < kNumFiles; f++) {
+      std::unique_ptr<FSRandomAccessFile> file;
+      ASSERT_OK(fs->NewRandomAccessFile(fnames[f], FileOptions(), &file,
+                                        nullptr));
+      // Some requests fit a fixed buffer, some do not
+      const size_t kNumReads = 20;
+      std::vector<std::string> scratches(kNumReads);
+      std::vector<FSReadRequest> reqs(kNumReads);
+      for (size_t i = 0; i < kNumReads; i++) {
+        reqs[i].offset = i * (kFileSize / kNumReads);
+        reqs[i].len = i % 2 == 0 ? 1000 : 3000 + 1000 * (i % 4);
+        scratches[i].assign(reqs[i].len, ' ');
+        reqs[i].scratch = &scratches[i][0];
+      }
+      ASSERT_OK(file->MultiRead(reqs.data(), reqs.size(), IOOptions(),
+                                nullptr));
+      for (size_t i = 0; i < kNumReads; i++) {
+        ASSERT_OK(reqs[i].status);
+        ASSERT_EQ(Slice(contents[f].data() + reqs[i].offset, reqs[i].len),
+                  reqs[i].result);
+      }
+    }
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  for (const auto& fname : fnames) {
+    ASSERT_OK(fs->DeleteFile(fname, IOOptions(), nullptr));
+  }
+}
+#endif  // !OS_WIN
+
 #if defined(ROCKSDB_IOURING_PRESENT)
 void GenerateFilesAndRequest(Env* env, const std::string& fname,
                              std::vector<ReadRequest>* ret_reqs,
@@ -2456,6 +2572,99 @@ TEST_F(EncryptionProviderTest, LoadROT13Cipher) {
   ASSERT_STREQ(cipher->Name(), "ROT13");
 }
 
+namespace {
+// Encrypts data at the file offset one block at a time, as
+// CTRCipherStream::EncryptBlock() does.
+void ReferenceCTREncrypt(BlockCipher* cipher, const std::string& iv,
+                         uint64_t initial_counter, uint64_t offset,
+                         std::string* data) {
+  const size_t block_size = cipher->BlockSize();
+  std::string block;
+  for (size_t i = 0; i < data->size(); ++i) {
+    const uint64_t pos = offset + i;
+    if (i == 0 || pos % block_size == 0) {
+      block = iv;
+      EncodeFixed64(&block[0], pos / block_size + initial_counter);
+      ASSERT_OK(cipher->Encrypt(&block[0]));
+    }
+    (*data)[i] ^= block[pos % block_size];
+  }
+}
+
+void VerifyCTRCipherStream(const std::shared_ptr<BlockCipher>& cipher) {
+  Random rnd(301);
+  const size_t block_size = cipher->BlockSize();
+  const std::string iv = rnd.RandomString(static_cast<int>(block_size));
+  const uint64_t initial_counter = (uint64_t{rnd.Next()} << 32) | rnd.Next();
+  CTRCipherStream stream(cipher, iv.data(), initial_counter);
+  const std::string plain = rnd.RandomString(20000);
+  for (uint64_t offset : {0, 1, 15, 16, 4095, 4096, 12345}) {
+    for (size_t len : {1, 7, 16, 33, 4096, 4100, 20000}) {
+      std::string expected = plain.substr(0, len);
+      ReferenceCTREncrypt(cipher.get(), iv, initial_counter, offset,
+                          &expected);
+      std::string data = plain.substr(0, len);
+      ASSERT_OK(stream.Encrypt(offset, &data[0], data.size()));
+      ASSERT_EQ(expected, data);
+      ASSERT_OK(stream.Decrypt(offset, &data[0], data.size()));
+      ASSERT_EQ(plain.substr(0, len), data);
+    }
+  }
+}
+}  // namespace
+
+TEST_F(EncryptionProviderTest, CTRCipherStreamBulk) {
+  std::shared_ptr<BlockCipher> cipher;
+  ASSERT_OK(
+      BlockCipher::CreateFromString(ConfigOptions(), "ROT13:32", &cipher));
+  VerifyCTRCipherStream(cipher);
+  // Larger than the key stream buffer
+  ASSERT_OK(
+      BlockCipher::CreateFromString(ConfigOptions(), "ROT13:5000", &cipher));
+  VerifyCTRCipherStream(cipher);
+}
+
+TEST_F(EncryptionProviderTest, AESCipher) {
+  std::string key;
+  ASSERT_TRUE(Slice("000102030405060708090A0B0C0D0E0F").DecodeHex(&key));
+  std::shared_ptr<BlockCipher> cipher;
+#ifdef ROCKSDB_OPENSSL_PRESENT
+  ASSERT_OK(BlockCipher::NewAESCipher(key, &cipher));
+  ASSERT_STREQ(cipher->Name(), "AES");
+  ASSERT_EQ(cipher->BlockSize(), 16U);
+
+  // FIPS-197 Appendix C.1
+  std::string block;
+  ASSERT_TRUE(Slice("00112233445566778899AABBCCDDEEFF").DecodeHex(&block));
+  ASSERT_OK(cipher->Encrypt(&block[0]));
+  ASSERT_EQ(Slice(block).ToString(true), "69C4E0D86A7B0430D8CDB78070B4C55A");
+  ASSERT_OK(cipher->Decrypt(&block[0]));
+  ASSERT_EQ(Slice(block).ToString(true), "00112233445566778899AABBCCDDEEFF");
+
+  Random rnd(301);
+  const std::string blocks = rnd.RandomString(16 * 100);
+  std::string bulk = blocks;
+  ASSERT_OK(cipher->EncryptBlocks(&bulk[0], 100));
+  std::string single = blocks;
+  for (size_t i = 0; i < 100; ++i) {
+    ASSERT_OK(cipher->Encrypt(&single[i * 16]));
+  }
+  ASSERT_EQ(single, bulk);
+
+  VerifyCTRCipherStream(cipher);
+
+  cipher.reset();
+  ASSERT_OK(BlockCipher::CreateFromString(
+      ConfigOptions(), "AES:000102030405060708090A0B0C0D0E0F", &cipher));
+  ASSERT_NE(cipher, nullptr);
+  ASSERT_STREQ(cipher->Name(), "AES");
+  ASSERT_TRUE(
+      BlockCipher::NewAESCipher("short", &cipher).IsInvalidArgument());
+#else
+  ASSERT_TRUE(BlockCipher::NewAESCipher(key, &cipher).IsNotSupported());
+#endif  // ROCKSDB_OPENSSL_PRESENT
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -68,6 +68,15 @@ FileOptions FileSystem::OptimizeForLogWrite(const FileOptions& file_options,
   optimized_file_options.bytes_per_sync = db_options.wal_bytes_per_sync;
   optimized_file_options.writable_file_max_buffer_size =
       db_options.writable_file_max_buffer_size;
+  if (db_options.use_direct_io_for_wal) {
+    optimized_file_options.use_mmap_writes = false;
+    optimized_file_options.use_direct_writes = true;
+    optimized_file_options.use_dsync_writes = true;
+  }
+  if (db_options.use_pmem_for_wal) {
+    optimized_file_options.use_mmap_writes = true;
+    optimized_file_options.use_pmem_writes = true;
+  }
   return optimized_file_options;
 }
 
@@ -82,6 +91,8 @@ FileOptions FileSystem::OptimizeForCompactionTableWrite(
   FileOptions optimized_file_options(file_options);
   optimized_file_options.use_direct_writes =
       db_options.use_direct_io_for_flush_and_compaction;
+  optimized_file_options.use_async_writes =
+      db_options.use_async_writes_for_flush_and_compaction;
   return optimized_file_options;
 }
 
@@ -127,7 +127,8 @@ int cloexec_flags(int flags, const EnvOptions* options) {
 
 class PosixFileSystem : public FileSystem {
  public:
-  PosixFileSystem();
+  PosixFileSystem() : PosixFileSystem(IOUringOptions()) {}
+  explicit PosixFileSystem(const IOUringOptions& io_uring_options);
 
   const char* Name() const override { return "Posix File System"; }
 
@@ -257,7 +258,8 @@ class PosixFileSystem : public FileSystem {
           options
 #if defined(ROCKSDB_IOURING_PRESENT)
           ,
-          thread_local_io_urings_.get()
+          thread_local_io_urings_.get(), &io_uring_options_,
+          thread_local_async_read_io_urings_.get()
 #endif
               ));
     }
@@ -298,6 +300,11 @@ class PosixFileSystem : public FileSystem {
     }
 
     flags = cloexec_flags(flags, &options);
+#ifdef O_DSYNC
+    if (options.use_dsync_writes && !options.use_mmap_writes) {
+      flags |= O_DSYNC;
+    }
+#endif
 
     do {
       IOSTATS_TIMER_GUARD(open_nanos);
@@ -397,6 +404,11 @@ class PosixFileSystem : public FileSystem {
     }
 
     flags = cloexec_flags(flags, &options);
+#ifdef O_DSYNC
+    if (options.use_dsync_writes && !options.use_mmap_writes) {
+      flags |= O_DSYNC;
+    }
+#endif
 
     do {
       IOSTATS_TIMER_GUARD(open_nanos);
@@ -944,11 +956,25 @@ class PosixFileSystem : public FileSystem {
     return io_s;
   }
 
+  // Waits for all of io_handles regardless of min_completions.
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t /*min_completions*/) override {
+    return PosixWaitForAsyncReads(io_handles, false /* abort */);
+  }
+
+  // Reads already submitted cannot be recalled, so this waits for them to
+  // complete without invoking their callbacks.
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    return PosixWaitForAsyncReads(io_handles, true /* abort */);
+  }
+
   FileOptions OptimizeForLogWrite(const FileOptions& file_options,
                                   const DBOptions& db_options) const override {
     FileOptions optimized = file_options;
-    optimized.use_mmap_writes = false;
-    optimized.use_direct_writes = false;
+    optimized.use_mmap_writes = db_options.use_pmem_for_wal;
+    optimized.use_pmem_writes = db_options.use_pmem_for_wal;
+    optimized.use_direct_writes = db_options.use_direct_io_for_wal;
+    optimized.use_dsync_writes = db_options.use_direct_io_for_wal;
     optimized.bytes_per_sync = db_options.wal_bytes_per_sync;
     // TODO(icanadi) it's faster if fallocate_with_keep_size is false, but it
     // breaks TransactionLogIteratorStallAtLastRecord unit test. Fix the unit
@@ -1011,9 +1037,12 @@ class PosixFileSystem : public FileSystem {
 #endif
   }
 
+  const IOUringOptions io_uring_options_;
 #if defined(ROCKSDB_IOURING_PRESENT)
-  // io_uring instance
+  // io_uring instance for MultiRead()
   std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+  // io_uring instance for ReadAsync()
+  std::unique_ptr<ThreadLocalPtr> thread_local_async_read_io_urings_;
 #endif
 
   size_t page_size_;
@@ -1063,9 +1092,10 @@ size_t PosixFileSystem::GetLogicalBlockSizeForWriteIfNeeded(
              : kDefaultPageSize;
 }
 
-PosixFileSystem::PosixFileSystem()
+PosixFileSystem::PosixFileSystem(const IOUringOptions& io_uring_options)
     : checkedDiskForMmap_(false),
       forceMmapOff_(false),
+      io_uring_options_(io_uring_options),
       page_size_(getpagesize()),
       allow_non_owner_access_(true) {
 #if defined(ROCKSDB_IOURING_PRESENT)
@@ -1074,7 +1104,10 @@ PosixFileSystem::PosixFileSystem()
   // io_uring can be created.
   struct io_uring* new_io_uring = CreateIOUring();
   if (new_io_uring != nullptr) {
-    thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
+    thread_local_io_urings_.reset(
+        new ThreadLocalPtr(DeletePosixMultiReadIOUring));
+    thread_local_async_read_io_urings_.reset(
+        new ThreadLocalPtr(DeleteIOUring));
     delete new_io_uring;
   }
 #endif
@@ -1092,6 +1125,11 @@ std::shared_ptr<FileSystem> FileSystem::Default() {
   return default_fs_ptr;
 }
 
+std::shared_ptr<FileSystem> NewPosixFileSystem(
+    const IOUringOptions& options) {
+  return std::make_shared<PosixFileSystem>(options);
+}
+
 #ifndef ROCKSDB_LITE
 static FactoryFunc<FileSystem> posix_filesystem_reg =
     ObjectLibrary::Default()->Register<FileSystem>(
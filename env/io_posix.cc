@@ -33,9 +33,11 @@
 #include "port/port.h"
 #include "rocksdb/slice.h"
 #include "test_util/sync_point.h"
+#include "util/aligned_buffer.h"
 #include "util/autovector.h"
 #include "util/coding.h"
 #include "util/string_util.h"
+#include "util/threadpool_imp.h"
 
 #if defined(OS_LINUX) && !defined(F_SET_RW_HINT)
 #define F_LINUX_SPECIFIC_BASE 1024
@@ -534,6 +536,124 @@ size_t PosixHelper::GetLogicalBlockSizeOfFd(int fd) {
   return kDefaultPageSize;
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+PosixMultiReadIOUring* PosixMultiReadIOUring::Create(
+    const IOUringOptions& options) {
+  std::unique_ptr<PosixMultiReadIOUring> iu(new PosixMultiReadIOUring);
+  iu->depth_ = std::max(options.queue_depth, 1U);
+  int ret = -1;
+  if (options.sqpoll) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = options.sq_thread_idle_ms;
+    ret = io_uring_queue_init_params(iu->depth_, &iu->ring_, &params);
+    if (ret == 0) {
+      // Older kernels only poll for reads of registered files
+      iu->RegisterFiles(options.num_registered_files);
+    }
+    if (ret == 0 && iu->file_ids_.empty()) {
+      io_uring_queue_exit(&iu->ring_);
+      ret = -1;
+    }
+  }
+  if (ret != 0) {
+    ret = io_uring_queue_init(iu->depth_, &iu->ring_, 0);
+    if (ret != 0) {
+      return nullptr;
+    }
+    if (options.register_files) {
+      iu->RegisterFiles(options.num_registered_files);
+    }
+  }
+
+  if (options.fixed_buffer_size > 0 && options.num_fixed_buffers > 0) {
+    const size_t page_size = static_cast<size_t>(getpagesize());
+    const size_t buffer_size = Roundup(options.fixed_buffer_size, page_size);
+    void* buffers = nullptr;
+    if (posix_memalign(&buffers, page_size,
+                       buffer_size * options.num_fixed_buffers) == 0) {
+      std::vector<struct iovec> iovs(options.num_fixed_buffers);
+      for (size_t i = 0; i < iovs.size(); i++) {
+        iovs[i].iov_base = static_cast<char*>(buffers) + i * buffer_size;
+        iovs[i].iov_len = buffer_size;
+      }
+      if (io_uring_register_buffers(&iu->ring_, iovs.data(),
+                                    static_cast<unsigned>(iovs.size())) ==
+          0) {
+        iu->buffers_ = static_cast<char*>(buffers);
+        iu->buffer_size_ = buffer_size;
+        for (int i = static_cast<int>(iovs.size()) - 1; i >= 0; i--) {
+          iu->free_buffers_.push_back(i);
+        }
+      } else {
+        free(buffers);
+      }
+    }
+  }
+  return iu.release();
+}
+
+PosixMultiReadIOUring::~PosixMultiReadIOUring() {
+  // Also drops the registered files and buffers
+  io_uring_queue_exit(&ring_);
+  free(buffers_);
+}
+
+void PosixMultiReadIOUring::RegisterFiles(unsigned int num_files) {
+  if (num_files == 0) {
+    return;
+  }
+  // Entries are filled in as files are read
+  std::vector<int> fds(num_files, -1);
+  if (io_uring_register_files(&ring_, fds.data(), num_files) == 0) {
+    file_ids_.assign(num_files, 0);
+    file_last_use_.assign(num_files, 0);
+  }
+}
+
+int PosixMultiReadIOUring::GetFileIndex(uint64_t file_id, int fd) {
+  if (file_ids_.empty()) {
+    return -1;
+  }
+  ++num_file_lookups_;
+  size_t lru = 0;
+  for (size_t i = 0; i < file_ids_.size(); i++) {
+    if (file_ids_[i] == file_id) {
+      file_last_use_[i] = num_file_lookups_;
+      return static_cast<int>(i);
+    }
+    if (file_last_use_[i] < file_last_use_[lru]) {
+      lru = i;
+    }
+  }
+  if (io_uring_register_files_update(&ring_, static_cast<unsigned>(lru), &fd,
+                                     1) != 1) {
+    return -1;
+  }
+  file_ids_[lru] = file_id;
+  file_last_use_[lru] = num_file_lookups_;
+  return static_cast<int>(lru);
+}
+
+int PosixMultiReadIOUring::AcquireBuffer(size_t len) {
+  if (len > buffer_size_ || free_buffers_.empty()) {
+    return -1;
+  }
+  int index = free_buffers_.back();
+  free_buffers_.pop_back();
+  return index;
+}
+
+void DeletePosixMultiReadIOUring(void* p) {
+  delete static_cast<PosixMultiReadIOUring*>(p);
+}
+
+namespace {
+std::atomic<uint64_t> next_file_id{1};
+}  // namespace
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
 /*
  * PosixRandomAccessFile
  *
@@ -544,7 +664,9 @@ PosixRandomAccessFile::PosixRandomAccessFile(
     const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
     ,
-    ThreadLocalPtr* thread_local_io_urings
+    ThreadLocalPtr* thread_local_io_urings,
+    const IOUringOptions* io_uring_options,
+    ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
     )
     : filename_(fname),
@@ -553,7 +675,10 @@ PosixRandomAccessFile::PosixRandomAccessFile(
       logical_sector_size_(logical_block_size)
 #if defined(ROCKSDB_IOURING_PRESENT)
       ,
-      thread_local_io_urings_(thread_local_io_urings)
+      file_id_(next_file_id.fetch_add(1, std::memory_order_relaxed)),
+      thread_local_io_urings_(thread_local_io_urings),
+      io_uring_options_(io_uring_options),
+      thread_local_async_read_io_urings_(thread_local_async_read_io_urings)
 #endif
 {
   assert(!options.use_direct_reads || !options.use_mmap_reads);
@@ -616,22 +741,26 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
   }
 
 #if defined(ROCKSDB_IOURING_PRESENT)
-  struct io_uring* iu = nullptr;
+  PosixMultiReadIOUring* multi_read_iu = nullptr;
   if (thread_local_io_urings_) {
-    iu = static_cast<struct io_uring*>(thread_local_io_urings_->Get());
-    if (iu == nullptr) {
-      iu = CreateIOUring();
-      if (iu != nullptr) {
-        thread_local_io_urings_->Reset(iu);
+    multi_read_iu =
+        static_cast<PosixMultiReadIOUring*>(thread_local_io_urings_->Get());
+    if (multi_read_iu == nullptr) {
+      multi_read_iu = PosixMultiReadIOUring::Create(*io_uring_options_);
+      if (multi_read_iu != nullptr) {
+        thread_local_io_urings_->Reset(multi_read_iu);
       }
     }
   }
 
   // Init failed, platform doesn't support io_uring. Fall back to
   // serialized reads
-  if (iu == nullptr) {
+  if (multi_read_iu == nullptr) {
     return FSRandomAccessFile::MultiRead(reqs, num_reqs, options, dbg);
   }
+  struct io_uring* iu = multi_read_iu->ring();
+  const size_t depth = multi_read_iu->depth();
+  const int file_index = multi_read_iu->GetFileIndex(file_id_, fd_);
 
   IOStatus ios = IOStatus::OK();
 
@@ -639,7 +768,10 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
     FSReadRequest* req;
     struct iovec iov;
     size_t finished_len;
-    explicit WrappedReadRequest(FSReadRequest* r) : req(r), finished_len(0) {}
+    // The fixed buffer read into, or -1
+    int buffer_index;
+    explicit WrappedReadRequest(FSReadRequest* r)
+        : req(r), finished_len(0), buffer_index(-1) {}
   };
 
   autovector<WrappedReadRequest, 32> req_wraps;
@@ -648,13 +780,22 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
   for (size_t i = 0; i < num_reqs; i++) {
     req_wraps.emplace_back(&reqs[i]);
   }
+  // Returns the fixed buffers of requests an error left behind
+  auto release_buffers = [&]() {
+    for (auto& req_wrap : req_wraps) {
+      if (req_wrap.buffer_index >= 0) {
+        multi_read_iu->ReleaseBuffer(req_wrap.buffer_index);
+        req_wrap.buffer_index = -1;
+      }
+    }
+  };
 
   size_t reqs_off = 0;
   while (num_reqs > reqs_off || !incomplete_rq_list.empty()) {
     size_t this_reqs = (num_reqs - reqs_off) + incomplete_rq_list.size();
 
     // If requests exceed depth, split it into batches
-    if (this_reqs > kIoUringDepth) this_reqs = kIoUringDepth;
+    if (this_reqs > depth) this_reqs = depth;
 
     assert(incomplete_rq_list.size() <= this_reqs);
     for (size_t i = 0; i < this_reqs; i++) {
@@ -670,11 +811,29 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
       rep_to_submit->iov.iov_len =
           rep_to_submit->req->len - rep_to_submit->finished_len;
 
+      if (rep_to_submit->finished_len == 0) {
+        rep_to_submit->buffer_index =
+            multi_read_iu->AcquireBuffer(rep_to_submit->req->len);
+      }
+
       struct io_uring_sqe* sqe;
       sqe = io_uring_get_sqe(iu);
-      io_uring_prep_readv(
-          sqe, fd_, &rep_to_submit->iov, 1,
-          rep_to_submit->req->offset + rep_to_submit->finished_len);
+      const int fd = file_index >= 0 ? file_index : fd_;
+      const uint64_t offset =
+          rep_to_submit->req->offset + rep_to_submit->finished_len;
+      if (rep_to_submit->buffer_index >= 0) {
+        io_uring_prep_read_fixed(
+            sqe, fd,
+            multi_read_iu->buffer(rep_to_submit->buffer_index) +
+                rep_to_submit->finished_len,
+            static_cast<unsigned>(rep_to_submit->iov.iov_len), offset,
+            rep_to_submit->buffer_index);
+      } else {
+        io_uring_prep_readv(sqe, fd, &rep_to_submit->iov, 1, offset);
+      }
+      if (file_index >= 0) {
+        sqe->flags |= IOSQE_FIXED_FILE;
+      }
       io_uring_sqe_set_data(sqe, rep_to_submit);
     }
     incomplete_rq_list.clear();
@@ -700,6 +859,7 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
           io_uring_cqe_seen(iu, cqe);
         }
       }
+      release_buffers();
       return IOStatus::IOError("io_uring_submit_and_wait() requested " +
                                ToString(this_reqs) + " but returned " +
                                ToString(ret));
@@ -725,6 +885,14 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
 
       req_wrap = static_cast<WrappedReadRequest*>(io_uring_cqe_get_data(cqe));
       FSReadRequest* req = req_wrap->req;
+      if (req_wrap->buffer_index >= 0) {
+        if (cqe->res > 0) {
+          memcpy(req->scratch + req_wrap->finished_len,
+                 multi_read_iu->buffer(req_wrap->buffer_index) +
+                     req_wrap->finished_len,
+                 static_cast<size_t>(cqe->res));
+        }
+      }
       if (cqe->res < 0) {
         req->result = Slice(req->scratch, 0);
         req->status = IOError("Req failed", filename_, cqe->res);
@@ -767,9 +935,16 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
                                 filename_, cqe->res);
         }
       }
+      if (req_wrap->buffer_index >= 0 &&
+          (incomplete_rq_list.empty() ||
+           incomplete_rq_list.back() != req_wrap)) {
+        multi_read_iu->ReleaseBuffer(req_wrap->buffer_index);
+        req_wrap->buffer_index = -1;
+      }
       io_uring_cqe_seen(iu, cqe);
     }
   }
+  release_buffers();
   return ios;
 #else
   return FSRandomAccessFile::MultiRead(reqs, num_reqs, options, dbg);
@@ -800,6 +975,141 @@ IOStatus PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n,
   return s;
 }
 
+namespace {
+// Number of threads serving ReadAsync() and AppendAsync() where io_uring is
+// not available.
+const int kAsyncIOThreads = 8;
+
+ThreadPoolImpl* AsyncIOThreadPool() {
+  // Intentionally leaked: requests may still be in flight during static
+  // destruction.
+  static ThreadPoolImpl* const pool = [] {
+    ThreadPoolImpl* p = new ThreadPoolImpl();
+    p->SetBackgroundThreads(kAsyncIOThreads);
+    return p;
+  }();
+  return pool;
+}
+}  // namespace
+
+IOStatus PosixRandomAccessFile::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* /*dbg*/) {
+  if (use_direct_io()) {
+    assert(IsSectorAligned(req.offset, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.len, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.scratch, GetRequiredBufferAlignment()));
+  }
+  Posix_IOHandle* posix_handle =
+      new Posix_IOHandle(req, &filename_, std::move(cb), cb_arg);
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  struct io_uring* iu = nullptr;
+  if (thread_local_async_read_io_urings_) {
+    iu = static_cast<struct io_uring*>(
+        thread_local_async_read_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring();
+      if (iu != nullptr) {
+        thread_local_async_read_io_urings_->Reset(iu);
+      }
+    }
+  }
+  struct io_uring_sqe* sqe = iu != nullptr ? io_uring_get_sqe(iu) : nullptr;
+  if (sqe != nullptr) {
+    posix_handle->iu = iu;
+    posix_handle->iov.iov_base = posix_handle->req.scratch;
+    posix_handle->iov.iov_len = posix_handle->req.len;
+    io_uring_prep_readv(sqe, fd_, &posix_handle->iov, 1,
+                        posix_handle->req.offset);
+    io_uring_sqe_set_data(sqe, posix_handle);
+    int ret = io_uring_submit(iu);
+    if (ret < 0) {
+      // The prepared entry may still be submitted by a later call, so the
+      // handle cannot be freed here.
+      return IOStatus::IOError("io_uring_submit() returns " + ToString(ret));
+    }
+    *io_handle = posix_handle;
+    *del_fn = DeletePosixIOHandle;
+    return IOStatus::OK();
+  }
+  // No io_uring, or its submission queue is full: use the thread pool.
+#endif
+
+  AsyncIOThreadPool()->SubmitJob([this, posix_handle, opts]() {
+    FSReadRequest& r = posix_handle->req;
+    r.status = Read(r.offset, r.len, opts, &r.result, r.scratch, nullptr);
+    MutexLock l(&posix_handle->mu);
+    posix_handle->is_finished = true;
+    posix_handle->cv.SignalAll();
+  });
+  *io_handle = posix_handle;
+  *del_fn = DeletePosixIOHandle;
+  return IOStatus::OK();
+}
+
+IOStatus PosixWaitForAsyncReads(std::vector<void*>& io_handles, bool abort) {
+  IOStatus ios;
+  for (void* io_handle : io_handles) {
+    Posix_IOHandle* posix_handle = static_cast<Posix_IOHandle*>(io_handle);
+    if (posix_handle == nullptr) {
+      continue;
+    }
+#if defined(ROCKSDB_IOURING_PRESENT)
+    if (posix_handle->iu != nullptr) {
+      // Completions of other requests on the same ring may arrive first; mark
+      // them finished so that their own Poll() does not wait for them again.
+      while (!posix_handle->is_finished) {
+        struct io_uring_cqe* cqe = nullptr;
+        int ret = io_uring_wait_cqe(posix_handle->iu, &cqe);
+        if (ret == -EINTR) {
+          continue;
+        }
+        if (ret) {
+          return IOStatus::IOError("io_uring_wait_cqe() returns " +
+                                   ToString(ret));
+        }
+        Posix_IOHandle* done =
+            static_cast<Posix_IOHandle*>(io_uring_cqe_get_data(cqe));
+        FSReadRequest& r = done->req;
+        if (cqe->res >= 0) {
+          r.result = Slice(r.scratch, static_cast<size_t>(cqe->res));
+          r.status = IOStatus::OK();
+        } else {
+          r.result = Slice(r.scratch, 0);
+          r.status = IOError("While reading asynchronously offset " +
+                                 ToString(r.offset) + " len " +
+                                 ToString(r.len),
+                             *done->filename, -cqe->res);
+        }
+        done->is_finished = true;
+        io_uring_cqe_seen(posix_handle->iu, cqe);
+      }
+    } else
+#endif
+    {
+      MutexLock l(&posix_handle->mu);
+      while (!posix_handle->is_finished) {
+        posix_handle->cv.Wait();
+      }
+    }
+    if (abort) {
+      posix_handle->cb_invoked = true;
+    } else if (!posix_handle->cb_invoked) {
+      posix_handle->cb_invoked = true;
+      posix_handle->cb(posix_handle->req, posix_handle->cb_arg);
+    }
+  }
+  return ios;
+}
+
+void DeletePosixIOHandle(void* io_handle) {
+  std::vector<void*> io_handles{io_handle};
+  PosixWaitForAsyncReads(io_handles, true /* abort */).PermitUncheckedError();
+  delete static_cast<Posix_IOHandle*>(io_handle);
+}
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
 size_t PosixRandomAccessFile::GetUniqueId(char* id, size_t max_size) const {
   return PosixHelper::GetUniqueIdFromFile(fd_, id, max_size);
@@ -925,6 +1235,11 @@ IOStatus PosixMmapReadableFile::InvalidateCache(size_t offset, size_t length) {
 IOStatus PosixMmapFile::UnmapCurrentRegion() {
   TEST_KILL_RANDOM("PosixMmapFile::UnmapCurrentRegion:0");
   if (base_ != nullptr) {
+    if (map_sync_) {
+      // A later Sync() only covers the next region
+      port::PersistCacheLines(last_sync_, dst_ - last_sync_);
+      map_sync_ = false;
+    }
     int munmap_status = munmap(base_, limit_ - base_);
     if (munmap_status != 0) {
       return IOError("While munmap", filename_, munmap_status);
@@ -962,8 +1277,23 @@ IOStatus PosixMmapFile::MapNewRegion() {
   }
 
   TEST_KILL_RANDOM("PosixMmapFile::Append:1");
-  void* ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
-                   file_offset_);
+  void* ptr = MAP_FAILED;
+#if defined(MAP_SYNC) && defined(MAP_SHARED_VALIDATE)
+  if (pmem_writes_) {
+    ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED_VALIDATE | MAP_SYNC, fd_, file_offset_);
+    if (ptr == MAP_FAILED) {
+      // Not a DAX file system. Sync with msync() and fdatasync() instead.
+      pmem_writes_ = false;
+    } else {
+      map_sync_ = true;
+    }
+  }
+#endif
+  if (ptr == MAP_FAILED) {
+    ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+               file_offset_);
+  }
   if (ptr == MAP_FAILED) {
     return IOStatus::IOError("MMap failed on " + filename_);
   }
@@ -985,6 +1315,11 @@ IOStatus PosixMmapFile::Msync() {
   }
   // Find the beginnings of the pages that contain the first and last
   // bytes to be synced.
+  if (map_sync_) {
+    port::PersistCacheLines(last_sync_, dst_ - last_sync_);
+    last_sync_ = dst_;
+    return IOStatus::OK();
+  }
   size_t p1 = TruncateToPageBoundary(last_sync_ - base_);
   size_t p2 = TruncateToPageBoundary(dst_ - base_ - 1);
   last_sync_ = dst_;
@@ -1005,7 +1340,9 @@ PosixMmapFile::PosixMmapFile(const std::string& fname, int fd, size_t page_size,
       limit_(nullptr),
       dst_(nullptr),
       last_sync_(nullptr),
-      file_offset_(0) {
+      file_offset_(0),
+      pmem_writes_(options.use_pmem_writes && port::CanPersistCacheLines()),
+      map_sync_(false) {
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   allow_fallocate_ = options.allow_fallocate;
   fallocate_with_keep_size_ = options.fallocate_with_keep_size;
@@ -1088,6 +1425,11 @@ IOStatus PosixMmapFile::Flush(const IOOptions& /*opts*/,
 
 IOStatus PosixMmapFile::Sync(const IOOptions& /*opts*/,
                              IODebugContext* /*dbg*/) {
+  if (map_sync_) {
+    // MAP_SYNC makes the file system persist the metadata of a mapped page
+    // when it is first written, so only the data needs to be written back
+    return Msync();
+  }
   if (fdatasync(fd_) < 0) {
     return IOError("While fdatasync mmapped file", filename_, errno);
   }
@@ -1169,7 +1511,11 @@ PosixWritableFile::PosixWritableFile(const std::string& fname, int fd,
       use_direct_io_(options.use_direct_writes),
       fd_(fd),
       filesize_(0),
-      logical_sector_size_(logical_block_size) {
+      logical_sector_size_(logical_block_size),
+      positioned_appends_(false) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  async_write_io_uring_ = nullptr;
+#endif
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   allow_fallocate_ = options.allow_fallocate;
   fallocate_with_keep_size_ = options.fallocate_with_keep_size;
@@ -1196,7 +1542,13 @@ IOStatus PosixWritableFile::Append(const Slice& data, const IOOptions& /*opts*/,
   const char* src = data.data();
   size_t nbytes = data.size();
 
-  if (!PosixWrite(fd_, src, nbytes)) {
+  if (positioned_appends_) {
+    if (!PosixPositionedWrite(fd_, src, nbytes,
+                              static_cast<off_t>(filesize_))) {
+      return IOError("While pwrite to file at offset " + ToString(filesize_),
+                     filename_, errno);
+    }
+  } else if (!PosixWrite(fd_, src, nbytes)) {
     return IOError("While appending to file", filename_, errno);
   }
 
@@ -1204,6 +1556,135 @@ IOStatus PosixWritableFile::Append(const Slice& data, const IOOptions& /*opts*/,
   return IOStatus::OK();
 }
 
+IOStatus PosixWritableFile::AppendAsync(
+    const Slice& data, const IOOptions& opts,
+    std::function<void(const IOStatus&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+  if (use_direct_io()) {
+    return FSWritableFile::AppendAsync(data, opts, std::move(cb), cb_arg,
+                                       io_handle, del_fn, dbg);
+  }
+  positioned_appends_ = true;
+  Posix_WriteIOHandle* posix_handle = new Posix_WriteIOHandle(
+      data, filesize_, fd_, &filename_, std::move(cb), cb_arg);
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (async_write_io_uring_ == nullptr) {
+    async_write_io_uring_ = CreateIOUring();
+  }
+  struct io_uring* iu = async_write_io_uring_;
+  struct io_uring_sqe* sqe = iu != nullptr ? io_uring_get_sqe(iu) : nullptr;
+  if (sqe != nullptr) {
+    posix_handle->iu = iu;
+    posix_handle->iov.iov_base = const_cast<char*>(posix_handle->data.data());
+    posix_handle->iov.iov_len = posix_handle->data.size();
+    io_uring_prep_writev(sqe, fd_, &posix_handle->iov, 1,
+                         posix_handle->offset);
+    io_uring_sqe_set_data(sqe, posix_handle);
+    int ret = io_uring_submit(iu);
+    if (ret < 0) {
+      // The prepared entry may still be submitted by a later call, so the
+      // handle cannot be freed here.
+      return IOStatus::IOError("io_uring_submit() returns " + ToString(ret));
+    }
+    filesize_ += data.size();
+    *io_handle = posix_handle;
+    *del_fn = DeletePosixWriteIOHandle;
+    return IOStatus::OK();
+  }
+  // No io_uring, or its submission queue is full: use the thread pool.
+#endif
+
+  AsyncIOThreadPool()->SubmitJob([posix_handle]() {
+    Posix_WriteIOHandle* h = posix_handle;
+    IOStatus s;
+    if (!PosixPositionedWrite(h->fd, h->data.data(), h->data.size(),
+                              static_cast<off_t>(h->offset))) {
+      s = IOError("While pwrite to file at offset " + ToString(h->offset),
+                  *h->filename, errno);
+    }
+    MutexLock l(&h->mu);
+    h->status = s;
+    h->is_finished = true;
+    h->cv.SignalAll();
+  });
+  filesize_ += data.size();
+  *io_handle = posix_handle;
+  *del_fn = DeletePosixWriteIOHandle;
+  return IOStatus::OK();
+}
+
+IOStatus PosixWritableFile::Poll(std::vector<void*>& io_handles,
+                                 size_t /*min_completions*/) {
+  return PosixWaitForAsyncWrites(io_handles, false /* abort */);
+}
+
+IOStatus PosixWaitForAsyncWrites(std::vector<void*>& io_handles, bool abort) {
+  for (void* io_handle : io_handles) {
+    Posix_WriteIOHandle* posix_handle =
+        static_cast<Posix_WriteIOHandle*>(io_handle);
+    if (posix_handle == nullptr) {
+      continue;
+    }
+#if defined(ROCKSDB_IOURING_PRESENT)
+    if (posix_handle->iu != nullptr) {
+      while (!posix_handle->is_finished) {
+        struct io_uring_cqe* cqe = nullptr;
+        int ret = io_uring_wait_cqe(posix_handle->iu, &cqe);
+        if (ret == -EINTR) {
+          continue;
+        }
+        if (ret) {
+          return IOStatus::IOError("io_uring_wait_cqe() returns " +
+                                   ToString(ret));
+        }
+        Posix_WriteIOHandle* done =
+            static_cast<Posix_WriteIOHandle*>(io_uring_cqe_get_data(cqe));
+        if (cqe->res < 0) {
+          done->status = IOError("While writing asynchronously at offset " +
+                                     ToString(done->offset) + " len " +
+                                     ToString(done->data.size()),
+                                 *done->filename, -cqe->res);
+        } else if (static_cast<size_t>(cqe->res) < done->data.size()) {
+          // Short write: write the rest here
+          const size_t written = static_cast<size_t>(cqe->res);
+          if (!PosixPositionedWrite(
+                  done->fd, done->data.data() + written,
+                  done->data.size() - written,
+                  static_cast<off_t>(done->offset + written))) {
+            done->status =
+                IOError("While pwrite to file at offset " +
+                            ToString(done->offset + written),
+                        *done->filename, errno);
+          }
+        }
+        done->is_finished = true;
+        io_uring_cqe_seen(posix_handle->iu, cqe);
+      }
+    } else
+#endif
+    {
+      MutexLock l(&posix_handle->mu);
+      while (!posix_handle->is_finished) {
+        posix_handle->cv.Wait();
+      }
+    }
+    if (abort) {
+      posix_handle->cb_invoked = true;
+    } else if (!posix_handle->cb_invoked) {
+      posix_handle->cb_invoked = true;
+      posix_handle->cb(posix_handle->status, posix_handle->cb_arg);
+    }
+  }
+  return IOStatus::OK();
+}
+
+void DeletePosixWriteIOHandle(void* io_handle) {
+  std::vector<void*> io_handles{io_handle};
+  PosixWaitForAsyncWrites(io_handles, true /* abort */).PermitUncheckedError();
+  delete static_cast<Posix_WriteIOHandle*>(io_handle);
+}
+
 IOStatus PosixWritableFile::PositionedAppend(const Slice& data, uint64_t offset,
                                              const IOOptions& /*opts*/,
                                              IODebugContext* /*dbg*/) {
@@ -1289,6 +1770,13 @@ IOStatus PosixWritableFile::Close(const IOOptions& /*opts*/,
     s = IOError("While closing file after writing", filename_, errno);
   }
   fd_ = -1;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (async_write_io_uring_ != nullptr) {
+    io_uring_queue_exit(async_write_io_uring_);
+    DeleteIOUring(async_write_io_uring_);
+    async_write_io_uring_ = nullptr;
+  }
+#endif
   return s;
 }
 
@@ -17,6 +17,8 @@
 #include <functional>
 #include <map>
 #include <string>
+#include <vector>
+
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/file_system.h"
@@ -167,8 +169,142 @@ inline struct io_uring* CreateIOUring() {
   }
   return new_io_uring;
 }
+
+// The io_uring a thread reads through in PosixRandomAccessFile::MultiRead(),
+// set up as IOUringOptions asks.
+class PosixMultiReadIOUring {
+ public:
+  // Returns nullptr if io_uring is not available
+  static PosixMultiReadIOUring* Create(const IOUringOptions& options);
+
+  ~PosixMultiReadIOUring();
+
+  PosixMultiReadIOUring(const PosixMultiReadIOUring&) = delete;
+  PosixMultiReadIOUring& operator=(const PosixMultiReadIOUring&) = delete;
+
+  struct io_uring* ring() { return &ring_; }
+  unsigned int depth() const { return depth_; }
+
+  // Returns the index of the registered file table entry holding `fd`,
+  // registering it first if needed, or -1 if files are not registered.
+  // `file_id` tells files apart when a file descriptor is reused.
+  int GetFileIndex(uint64_t file_id, int fd);
+
+  // Returns the index of a free fixed buffer that fits `len` bytes, or -1
+  int AcquireBuffer(size_t len);
+  void ReleaseBuffer(int index) { free_buffers_.push_back(index); }
+  char* buffer(int index) { return buffers_ + index * buffer_size_; }
+
+ private:
+  PosixMultiReadIOUring() {}
+
+  // Registers an empty file table of num_files entries, if possible
+  void RegisterFiles(unsigned int num_files);
+
+  struct io_uring ring_;
+  unsigned int depth_ = 0;
+
+  // The file registered in each table entry, 0 if none, and when it was
+  // last read
+  std::vector<uint64_t> file_ids_;
+  std::vector<uint64_t> file_last_use_;
+  uint64_t num_file_lookups_ = 0;
+
+  char* buffers_ = nullptr;
+  size_t buffer_size_ = 0;
+  std::vector<int> free_buffers_;
+};
+
+// ThreadLocalPtr cleanup function for PosixMultiReadIOUring
+void DeletePosixMultiReadIOUring(void* p);
 #endif  // defined(ROCKSDB_IOURING_PRESENT)
 
+// The io_handle that PosixRandomAccessFile::ReadAsync() hands out. The read
+// is submitted to the calling thread's io_uring when one is available, and
+// otherwise runs on a small thread pool shared by all files.
+struct Posix_IOHandle {
+  Posix_IOHandle(const FSReadRequest& _req, const std::string* _filename,
+                 std::function<void(const FSReadRequest&, void*)> _cb,
+                 void* _cb_arg)
+      : req(_req),
+        filename(_filename),
+        cb(std::move(_cb)),
+        cb_arg(_cb_arg),
+        cv(&mu),
+        is_finished(false),
+        cb_invoked(false) {}
+
+  FSReadRequest req;
+  const std::string* filename;
+  std::function<void(const FSReadRequest&, void*)> cb;
+  void* cb_arg;
+  port::Mutex mu;
+  port::CondVar cv;
+  // Set once the read has completed. Protected by mu for reads running on
+  // the thread pool; io_uring completions are reaped by the submitting thread.
+  bool is_finished;
+  // Only accessed by the thread that submitted the read.
+  bool cb_invoked;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  // nullptr if the read runs on the thread pool.
+  struct io_uring* iu = nullptr;
+  struct iovec iov;
+#endif
+};
+
+// Waits until the reads behind io_handles have completed. Unless abort is
+// set, invokes the callback of each of them that has not been invoked yet.
+// Must be called by the thread that submitted the reads.
+IOStatus PosixWaitForAsyncReads(std::vector<void*>& io_handles, bool abort);
+
+// IOHandleDeleter for Posix_IOHandle. Waits for the read to complete first.
+void DeletePosixIOHandle(void* io_handle);
+
+// The io_handle that PosixWritableFile::AppendAsync() hands out. The write
+// is submitted to an io_uring of the file when one is available, and
+// otherwise runs on the thread pool that serves ReadAsync().
+struct Posix_WriteIOHandle {
+  Posix_WriteIOHandle(const Slice& _data, uint64_t _offset, int _fd,
+                      const std::string* _filename,
+                      std::function<void(const IOStatus&, void*)> _cb,
+                      void* _cb_arg)
+      : data(_data),
+        offset(_offset),
+        fd(_fd),
+        filename(_filename),
+        cb(std::move(_cb)),
+        cb_arg(_cb_arg),
+        cv(&mu),
+        is_finished(false),
+        cb_invoked(false) {}
+
+  Slice data;
+  uint64_t offset;
+  int fd;
+  const std::string* filename;
+  std::function<void(const IOStatus&, void*)> cb;
+  void* cb_arg;
+  IOStatus status;
+  port::Mutex mu;
+  port::CondVar cv;
+  // As in Posix_IOHandle
+  bool is_finished;
+  bool cb_invoked;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  // nullptr if the write runs on the thread pool.
+  struct io_uring* iu = nullptr;
+  struct iovec iov;
+#endif
+};
+
+// Waits until the writes behind io_handles have completed. Unless abort is
+// set, invokes the callback of each of them that has not been invoked yet.
+IOStatus PosixWaitForAsyncWrites(std::vector<void*>& io_handles, bool abort);
+
+// IOHandleDeleter for Posix_WriteIOHandle. Waits for the write to complete
+// first.
+void DeletePosixWriteIOHandle(void* io_handle);
+
 class PosixRandomAccessFile : public FSRandomAccessFile {
  protected:
   std::string filename_;
@@ -176,7 +312,14 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   bool use_direct_io_;
   size_t logical_sector_size_;
 #if defined(ROCKSDB_IOURING_PRESENT)
+  // Identifies the file in registered file tables
+  const uint64_t file_id_;
+  // Holds PosixMultiReadIOUring, created as io_uring_options_ asks
   ThreadLocalPtr* thread_local_io_urings_;
+  const IOUringOptions* io_uring_options_;
+  // Kept apart from thread_local_io_urings_ so that MultiRead(), which reaps
+  // every completion of its ring, never sees a ReadAsync() completion.
+  ThreadLocalPtr* thread_local_async_read_io_urings_;
 #endif
 
  public:
@@ -185,7 +328,9 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
                         const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
                         ,
-                        ThreadLocalPtr* thread_local_io_urings
+                        ThreadLocalPtr* thread_local_io_urings,
+                        const IOUringOptions* io_uring_options,
+                        ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
   );
   virtual ~PosixRandomAccessFile();
@@ -201,6 +346,11 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   virtual IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& opts,
                             IODebugContext* dbg) override;
 
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& opts,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) override;
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
@@ -228,6 +378,13 @@ class PosixWritableFile : public FSWritableFile {
   // support it, so we need to do a dynamic check too.
   bool sync_file_range_supported_;
 #endif  // ROCKSDB_RANGESYNC_PRESENT
+  // Set by the first AppendAsync(). Its writes do not move the file offset,
+  // so Append() then writes at filesize_ instead.
+  bool positioned_appends_;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  // Created by the first AppendAsync(), destroyed by Close().
+  struct io_uring* async_write_io_uring_;
+#endif
 
  public:
   explicit PosixWritableFile(const std::string& fname, int fd,
@@ -256,6 +413,13 @@ class PosixWritableFile : public FSWritableFile {
       IODebugContext* dbg) override {
     return PositionedAppend(data, offset, opts, dbg);
   }
+  virtual IOStatus AppendAsync(const Slice& data, const IOOptions& opts,
+                               std::function<void(const IOStatus&, void*)> cb,
+                               void* cb_arg, void** io_handle,
+                               IOHandleDeleter* del_fn,
+                               IODebugContext* dbg) override;
+  virtual IOStatus Poll(std::vector<void*>& io_handles,
+                        size_t min_completions) override;
   virtual IOStatus Flush(const IOOptions& opts, IODebugContext* dbg) override;
   virtual IOStatus Sync(const IOOptions& opts, IODebugContext* dbg) override;
   virtual IOStatus Fsync(const IOOptions& opts, IODebugContext* dbg) override;
@@ -310,6 +474,11 @@ class PosixMmapFile : public FSWritableFile {
   char* dst_;             // Where to write next  (in range [base_,limit_])
   char* last_sync_;       // Where have we synced up to
   uint64_t file_offset_;  // Offset of base_ in file
+  // Map new regions with MAP_SYNC, until the file system refuses it
+  bool pmem_writes_;
+  // The current region is mapped with MAP_SYNC, so syncing it only needs to
+  // write back the CPU cache lines of the new data
+  bool map_sync_;
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   bool allow_fallocate_;  // If false, fallocate calls are bypassed
   bool fallocate_with_keep_size_;
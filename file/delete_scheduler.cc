@@ -303,7 +303,8 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
   TEST_SYNC_POINT("DeleteScheduler::DeleteTrashFile:DeleteFile");
   if (s.ok()) {
     bool need_full_delete = true;
-    if (bytes_max_delete_chunk_ != 0 && file_size > bytes_max_delete_chunk_) {
+    const uint64_t bytes_max_delete_chunk = bytes_max_delete_chunk_.load();
+    if (bytes_max_delete_chunk != 0 && file_size > bytes_max_delete_chunk) {
       uint64_t num_hard_links = 2;
       // We don't have to worry aobut data race between linking a new
       // file after the number of file link check and ftruncte because
@@ -317,7 +318,7 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
           my_status = fs_->ReopenWritableFile(path_in_trash, FileOptions(),
                                               &wf, nullptr);
           if (my_status.ok()) {
-            my_status = wf->Truncate(file_size - bytes_max_delete_chunk_,
+            my_status = wf->Truncate(file_size - bytes_max_delete_chunk,
                                      IOOptions(), nullptr);
             if (my_status.ok()) {
               TEST_SYNC_POINT("DeleteScheduler::DeleteTrashFile:Fsync");
@@ -325,7 +326,7 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
             }
           }
           if (my_status.ok()) {
-            *deleted_bytes = bytes_max_delete_chunk_;
+            *deleted_bytes = bytes_max_delete_chunk;
             need_full_delete = false;
             *is_complete = false;
           } else {
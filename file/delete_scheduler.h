@@ -7,6 +7,7 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <map>
 #include <queue>
 #include <string>
@@ -77,6 +78,15 @@ class DeleteScheduler {
     max_trash_db_ratio_.store(r);
   }
 
+  // Return the size of the chunks large trash files are deleted in
+  uint64_t GetBytesMaxDeleteChunk() { return bytes_max_delete_chunk_.load(); }
+
+  // Update the size of the chunks large trash files are deleted in. Zero
+  // means to always delete whole files.
+  void SetBytesMaxDeleteChunk(uint64_t bytes_max_delete_chunk) {
+    bytes_max_delete_chunk_.store(bytes_max_delete_chunk);
+  }
+
   static const std::string kTrashExtension;
   static bool IsTrashFile(const std::string& file_path);
 
@@ -121,7 +131,7 @@ class DeleteScheduler {
   std::queue<FileAndDir> queue_;
   // Number of trash files that are waiting to be deleted
   int32_t pending_files_;
-  uint64_t bytes_max_delete_chunk_;
+  std::atomic<uint64_t> bytes_max_delete_chunk_;
   // Errors that happened in BackgroundEmptyTrash (file_path => error)
   std::map<std::string, Status> bg_errors_;
 
@@ -499,6 +499,42 @@ TEST_F(DeleteSchedulerTest, DeletePartialFile) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
 }
 
+TEST_F(DeleteSchedulerTest, DynamicDeleteChunk) {
+  int bg_delete_file = 0;
+  int bg_fsync = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:DeleteFile",
+      [&](void*) { bg_delete_file++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:Fsync", [&](void*) { bg_fsync++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 1024 * 1024;  // 1 MB / sec
+  NewDeleteScheduler();
+  ASSERT_EQ(128 * 1024U, sst_file_mgr_->GetBytesMaxDeleteChunk());
+
+  // Should delete in 2 batches
+  sst_file_mgr_->SetBytesMaxDeleteChunk(256 * 1024);
+  ASSERT_EQ(256 * 1024U, sst_file_mgr_->GetBytesMaxDeleteChunk());
+  ASSERT_OK(
+      delete_scheduler_->DeleteFile(NewDummyFile("data_1", 500 * 1024), ""));
+  delete_scheduler_->WaitForEmptyTrash();
+  ASSERT_EQ(2, bg_delete_file);
+  ASSERT_EQ(1, bg_fsync);
+
+  // Should delete the whole file at once
+  sst_file_mgr_->SetBytesMaxDeleteChunk(0);
+  ASSERT_OK(
+      delete_scheduler_->DeleteFile(NewDummyFile("data_2", 500 * 1024), ""));
+  delete_scheduler_->WaitForEmptyTrash();
+  ASSERT_EQ(3, bg_delete_file);
+  ASSERT_EQ(1, bg_fsync);
+
+  auto bg_errors = delete_scheduler_->GetBackgroundErrors();
+  ASSERT_EQ(bg_errors.size(), 0);
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 #ifdef OS_LINUX
 TEST_F(DeleteSchedulerTest, NoPartialDeleteWithLink) {
   int bg_delete_file = 0;
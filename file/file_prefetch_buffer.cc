@@ -128,8 +128,8 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
       assert(max_readahead_size_ >= readahead_size_);
       Status s;
       if (for_compaction) {
-        s = Prefetch(opts, file_reader_, offset, std::max(n, readahead_size_),
-                     for_compaction);
+        s = ReadWindow(opts, offset, n, std::max(n, readahead_size_),
+                       for_compaction);
       } else {
         if (implicit_auto_readahead_) {
           // Prefetch only if this read is sequential otherwise reset
@@ -149,8 +149,7 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
             return false;
           }
         }
-        s = Prefetch(opts, file_reader_, offset, n + readahead_size_,
-                     for_compaction);
+        s = ReadWindow(opts, offset, n, n + readahead_size_, for_compaction);
       }
       if (!s.ok()) {
         if (status) {
@@ -171,4 +170,133 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
   *result = Slice(buffer_.BufferStart() + offset_in_buffer, n);
   return true;
 }
+
+Status FilePrefetchBuffer::ReadWindow(const IOOptions& opts, uint64_t offset,
+                                      size_t n, size_t readahead_len,
+                                      bool for_compaction) {
+  if (async_read_in_progress_) {
+    ConsumeAsyncReadahead(offset);
+  }
+  Status s;
+  if (offset < buffer_offset_ ||
+      offset + n > buffer_offset_ + buffer_.CurrentSize()) {
+    s = Prefetch(opts, file_reader_, offset, readahead_len, for_compaction);
+  }
+  if (s.ok()) {
+    ScheduleAsyncReadahead(opts);
+  }
+  return s;
+}
+
+void FilePrefetchBuffer::ScheduleAsyncReadahead(const IOOptions& opts) {
+  if (!async_io_ || async_read_in_progress_ || readahead_size_ == 0 ||
+      buffer_.CurrentSize() == 0) {
+    return;
+  }
+  size_t alignment = file_reader_->file()->GetRequiredBufferAlignment();
+  uint64_t start = buffer_offset_ + buffer_.CurrentSize();
+  if (start % alignment != 0) {
+    // The last read came up short, i.e. buffer_ reaches the end of the file.
+    return;
+  }
+  size_t len = Roundup(readahead_size_, alignment);
+  async_buffer_.Alignment(alignment);
+  if (async_buffer_.Capacity() < len) {
+    async_buffer_.AllocateNewBuffer(len);
+  }
+  async_buffer_.Clear();
+  async_buffer_offset_ = start;
+
+  async_req_ = FSReadRequest();
+  async_req_.offset = start;
+  async_req_.len = len;
+  async_req_.scratch = async_buffer_.BufferStart();
+  async_read_done_ = false;
+  async_read_in_progress_ = true;
+  IOStatus s = file_reader_->ReadAsync(
+      async_req_, opts,
+      [this](const FSReadRequest& req, void* /*cb_arg*/) {
+        async_req_.result = req.result;
+        async_req_.status = req.status;
+        async_read_done_ = true;
+      },
+      nullptr /* cb_arg */, &io_handle_, &del_fn_);
+  TEST_SYNC_POINT_CALLBACK("FilePrefetchBuffer::ScheduleAsyncReadahead", &s);
+  if (!s.ok()) {
+    s.PermitUncheckedError();
+    async_read_in_progress_ = false;
+    io_handle_ = nullptr;
+    del_fn_ = nullptr;
+  }
+}
+
+void FilePrefetchBuffer::ConsumeAsyncReadahead(uint64_t offset) {
+  assert(async_read_in_progress_);
+  if (!async_read_done_ && io_handle_ != nullptr) {
+    std::vector<void*> io_handles{io_handle_};
+    fs_->Poll(io_handles, 1).PermitUncheckedError();
+  }
+  if (io_handle_ != nullptr && del_fn_) {
+    del_fn_(io_handle_);
+  }
+  io_handle_ = nullptr;
+  del_fn_ = nullptr;
+  async_read_in_progress_ = false;
+
+  if (!async_read_done_ || !async_req_.status.ok()) {
+    // Reading synchronously will surface the error, if it persists.
+    async_req_.status.PermitUncheckedError();
+    return;
+  }
+  const Slice& data = async_req_.result;
+  if (data.size() > 0 && data.data() != async_buffer_.BufferStart()) {
+    memmove(async_buffer_.BufferStart(), data.data(), data.size());
+  }
+  async_buffer_.Size(data.size());
+  TEST_SYNC_POINT_CALLBACK("FilePrefetchBuffer::ConsumeAsyncReadahead",
+                           &async_buffer_offset_);
+  if (async_buffer_offset_ != buffer_offset_ + buffer_.CurrentSize() ||
+      offset < buffer_offset_) {
+    // buffer_ has been refilled from somewhere else in the meantime.
+    return;
+  }
+  if (offset >= async_buffer_offset_) {
+    std::swap(buffer_, async_buffer_);
+    buffer_offset_ = async_buffer_offset_;
+    return;
+  }
+  // The read straddles both buffers. Keep the tail of buffer_ that it needs
+  // and append the new data.
+  size_t alignment = buffer_.Alignment();
+  size_t chunk_offset_in_buffer =
+      Rounddown(static_cast<size_t>(offset - buffer_offset_), alignment);
+  size_t chunk_len = buffer_.CurrentSize() - chunk_offset_in_buffer;
+  assert(chunk_len > 0);
+  size_t new_size = chunk_len + async_buffer_.CurrentSize();
+  if (buffer_.Capacity() < new_size) {
+    buffer_.AllocateNewBuffer(new_size, true /* copy_data */,
+                              chunk_offset_in_buffer, chunk_len);
+  } else {
+    buffer_.RefitTail(chunk_offset_in_buffer, chunk_len);
+  }
+  buffer_.Append(async_buffer_.BufferStart(), async_buffer_.CurrentSize());
+  buffer_offset_ += chunk_offset_in_buffer;
+}
+
+void FilePrefetchBuffer::AbortAsyncReadahead() {
+  if (!async_read_in_progress_) {
+    return;
+  }
+  if (!async_read_done_ && io_handle_ != nullptr) {
+    std::vector<void*> io_handles{io_handle_};
+    fs_->AbortIO(io_handles).PermitUncheckedError();
+  }
+  if (io_handle_ != nullptr && del_fn_) {
+    del_fn_(io_handle_);
+  }
+  io_handle_ = nullptr;
+  del_fn_ = nullptr;
+  async_read_in_progress_ = false;
+  async_req_.status.PermitUncheckedError();
+}
 }  // namespace ROCKSDB_NAMESPACE
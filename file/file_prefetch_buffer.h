@@ -41,6 +41,11 @@ class FilePrefetchBuffer {
   //   it. Used for adaptable readahead of the file footer/metadata.
   // implicit_auto_readahead : Readahead is enabled implicitly by rocksdb after
   //   doing sequential scans for two times.
+  // fs : the file system of file_reader, used to wait for asynchronous reads.
+  // async_io : if true (and fs is set), while the buffer is being consumed the
+  //   next readahead window is read into a second buffer in the background
+  //   through RandomAccessFileReader::ReadAsync(). The buffer must then be
+  //   used by a single thread, the one that polls for the reads.
   //
   // Automatic readhead is enabled for a file if file_reader, readahead_size,
   // and max_readahead_size are passed in.
@@ -51,7 +56,8 @@ class FilePrefetchBuffer {
   FilePrefetchBuffer(RandomAccessFileReader* file_reader = nullptr,
                      size_t readahead_size = 0, size_t max_readahead_size = 0,
                      bool enable = true, bool track_min_offset = false,
-                     bool implicit_auto_readahead = false)
+                     bool implicit_auto_readahead = false,
+                     FileSystem* fs = nullptr, bool async_io = false)
       : buffer_offset_(0),
         file_reader_(file_reader),
         readahead_size_(readahead_size),
@@ -63,7 +69,15 @@ class FilePrefetchBuffer {
         implicit_auto_readahead_(implicit_auto_readahead),
         prev_offset_(0),
         prev_len_(0),
-        num_file_reads_(kMinNumFileReadsToStartAutoReadahead + 1) {}
+        num_file_reads_(kMinNumFileReadsToStartAutoReadahead + 1),
+        fs_(fs),
+        async_io_(async_io && fs != nullptr),
+        async_buffer_offset_(0),
+        async_read_in_progress_(false),
+        async_read_done_(false),
+        io_handle_(nullptr) {}
+
+  ~FilePrefetchBuffer() { AbortAsyncReadahead(); }
 
   // Load data into the buffer from a file.
   // reader : the file reader.
@@ -104,7 +118,33 @@ class FilePrefetchBuffer {
     readahead_size_ = initial_readahead_size_;
   }
 
+  // The size of the next readahead
+  size_t readahead_size() const { return readahead_size_; }
+
+  // Whether [offset, offset + n) can be read from the buffer without a read
+  bool IsDataInBuffer(uint64_t offset, size_t n) const {
+    return enable_ && offset >= buffer_offset_ &&
+           offset + n <= buffer_offset_ + buffer_.CurrentSize();
+  }
+
  private:
+  // Makes [offset, offset + n) available in buffer_, from the background
+  // read if possible and otherwise by reading readahead_len bytes, then
+  // starts the background read of the window that follows.
+  Status ReadWindow(const IOOptions& opts, uint64_t offset, size_t n,
+                    size_t readahead_len, bool for_compaction);
+
+  // Starts reading the readahead_size_ bytes that follow buffer_ into
+  // async_buffer_, unless such a read is already in flight.
+  void ScheduleAsyncReadahead(const IOOptions& opts);
+
+  // Waits for the background read and, if it continues buffer_, moves its
+  // data into buffer_, keeping the part of buffer_ from offset on.
+  void ConsumeAsyncReadahead(uint64_t offset);
+
+  // Cancels the background read, if any, and drops its data.
+  void AbortAsyncReadahead();
+
   AlignedBuffer buffer_;
   uint64_t buffer_offset_;
   RandomAccessFileReader* file_reader_;
@@ -126,5 +166,17 @@ class FilePrefetchBuffer {
   size_t prev_offset_;
   size_t prev_len_;
   int num_file_reads_;
+
+  FileSystem* fs_;
+  bool async_io_;
+  // Second buffer, filled in the background while buffer_ is consumed.
+  AlignedBuffer async_buffer_;
+  uint64_t async_buffer_offset_;
+  bool async_read_in_progress_;
+  // Set by the completion callback of the background read.
+  bool async_read_done_;
+  FSReadRequest async_req_;
+  void* io_handle_;
+  IOHandleDeleter del_fn_;
 };
 }  // namespace ROCKSDB_NAMESPACE
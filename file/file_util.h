@@ -83,6 +83,11 @@ inline IOStatus PrepareIOFromReadOptions(const ReadOptions& ro,
       (!opts.timeout.count() || ro.io_timeout < opts.timeout)) {
     opts.timeout = ro.io_timeout;
   }
+  opts.coalesce_max_gap = ro.multiread_coalesce_max_gap;
+  opts.coalesce_max_size = ro.multiread_coalesce_max_size;
+  opts.hedge_percentile = ro.hedged_read_percentile;
+  opts.hedge_min_delay = ro.hedged_read_min_delay;
+  opts.rate_limiter_priority = ro.rate_limiter_priority;
   return IOStatus::OK();
 }
 
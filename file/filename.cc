@@ -239,6 +239,10 @@ std::string IdentityFileName(const std::string& dbname) {
   return dbname + "/IDENTITY";
 }
 
+std::string RepairCheckpointFileName(const std::string& dbname) {
+  return dbname + "/REPAIR-CHECKPOINT";
+}
+
 // Owned filenames have the form:
 //    dbname/IDENTITY
 //    dbname/CURRENT
@@ -145,6 +145,10 @@ extern std::string MetaDatabaseName(const std::string& dbname,
 // either from a backup-image or empty
 extern std::string IdentityFileName(const std::string& dbname);
 
+// Return the name of the file RepairDB() saves the metadata of the tables it
+// has scanned to, so that an interrupted repair does not scan them again.
+extern std::string RepairCheckpointFileName(const std::string& dbname);
+
 // If filename is a rocksdb file, store the type of the file in *type.
 // The number encoded in the filename is stored in *number.  If the
 // filename was successfully parsed, returns true.  Else return false.
@@ -320,8 +320,154 @@ TEST_P(PrefetchTest, ConfigureAutoMaxReadaheadSize) {
   SyncPoint::GetInstance()->ClearAllCallBacks();
   Close();
 }
+
+TEST_P(PrefetchTest, MaxCompactionReadaheadSize) {
+  // Second param is if directIO is enabled or not
+  bool use_direct_io = std::get<1>(GetParam());
+
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), false);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.env = env.get();
+  options.disable_auto_compactions = true;
+  options.compaction_readahead_size = 16 * 1024;
+  if (use_direct_io) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+
+  int buff_prefetch_count = 0;
+  SyncPoint::GetInstance()->SetCallBack("FilePrefetchBuffer::Prefetch:Start",
+                                        [&](void*) { buff_prefetch_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  Random rnd(309);
+  for (int i = 0; i < 2000; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(500)));
+  }
+  ASSERT_OK(Flush());
+
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  buff_prefetch_count = 0;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  int fixed_readahead_count = buff_prefetch_count;
+
+  // The readahead now doubles up to 256KB, so the same data is read in
+  // fewer, larger reads
+  ASSERT_OK(
+      db_->SetDBOptions({{"max_compaction_readahead_size", "262144"}}));
+  buff_prefetch_count = 0;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_GT(buff_prefetch_count, 0);
+  ASSERT_LT(buff_prefetch_count, fixed_readahead_count);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
 #endif  // !ROCKSDB_LITE
 
+TEST_P(PrefetchTest, AsyncReadaheadDoubleBuffer) {
+  // First param is if the mockFS support_prefetch or not
+  bool support_prefetch =
+      std::get<0>(GetParam()) &&
+      test::IsPrefetchSupported(env_->GetFileSystem(), dbname_);
+
+  // Second param is if directIO is enabled or not
+  bool use_direct_io = std::get<1>(GetParam());
+
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), support_prefetch);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.env = env.get();
+  options.disable_auto_compactions = true;
+  if (use_direct_io) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  const int kNumKeys = 4000;
+  Random rnd(309);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumKeys; ++i) {
+    values.push_back(rnd.RandomString(500));
+    ASSERT_OK(Put(BuildKey(i), values.back()));
+  }
+  ASSERT_OK(Flush());
+
+  int buff_prefetch_count = 0;
+  int async_consume_count = 0;
+  SyncPoint::GetInstance()->SetCallBack("FilePrefetchBuffer::Prefetch:Start",
+                                        [&](void*) { buff_prefetch_count++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::ConsumeAsyncReadahead",
+      [&](void*) { async_consume_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < kNumKeys; ++i) {
+    expected[BuildKey(i)] = values[i];
+  }
+
+  int sync_reads[2] = {0, 0};
+  for (int async_io = 0; async_io < 2; ++async_io) {
+    buff_prefetch_count = 0;
+    async_consume_count = 0;
+    ReadOptions ro;
+    ro.async_io = async_io;
+    ro.readahead_size = 16 * 1024;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+    sync_reads[async_io] = buff_prefetch_count;
+    if (async_io) {
+      ASSERT_GT(async_consume_count, 0);
+    } else {
+      ASSERT_EQ(async_consume_count, 0);
+    }
+  }
+  // With double buffering most windows come from the background reads.
+  ASSERT_LT(sync_reads[1], sync_reads[0]);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
 TEST_P(PrefetchTest, PrefetchWhenReseek) {
   // First param is if the mockFS support_prefetch or not
   bool support_prefetch =
@@ -669,6 +815,181 @@ TEST_P(PrefetchTest, PrefetchWhenReseekwithCache) {
   Close();
 }
 
+#ifndef ROCKSDB_LITE
+TEST_P(PrefetchTest, ReadaheadAcrossFiles) {
+  // First param is if the mockFS support_prefetch or not
+  bool support_prefetch =
+      std::get<0>(GetParam()) &&
+      test::IsPrefetchSupported(env_->GetFileSystem(), dbname_);
+
+  // Second param is if directIO is enabled or not
+  bool use_direct_io = std::get<1>(GetParam());
+
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), support_prefetch);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.env = env.get();
+  options.disable_auto_compactions = true;
+  options.max_open_files = -1;
+  if (use_direct_io) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  // Four L1 files with disjoint key ranges, about 50 blocks each
+  const int kNumFiles = 4;
+  const int kNumKeysPerFile = 200;
+  Random rnd(309);
+  for (int f = 0; f < kNumFiles; f++) {
+    for (int i = 0; i < kNumKeysPerFile; i++) {
+      ASSERT_OK(Put(BuildKey(f * kNumKeysPerFile + i), rnd.RandomString(1000)));
+    }
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(1);
+  }
+  ASSERT_EQ("0,4", FilesPerLevel());
+
+  std::vector<size_t> hinted_sizes;
+  SyncPoint::GetInstance()->SetCallBack(
+      "LevelIterator::PrepareNextFileScan", [&](void* arg) {
+        hinted_sizes.push_back(*static_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  {
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+    int num_keys = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumFiles * kNumKeysPerFile, num_keys);
+  }
+
+  // Each file switch but the last one, which has no file after it, hints the
+  // next file with the readahead grown past its initial 8KB in the previous
+  // files.
+  ASSERT_EQ(kNumFiles - 2, static_cast<int>(hinted_sizes.size()));
+  for (size_t readahead_size : hinted_sizes) {
+    ASSERT_GT(readahead_size, static_cast<size_t>(8 * 1024));
+  }
+
+  // An explicit readahead_size is used as is
+  const size_t kReadaheadSize = 16 * 1024;
+  hinted_sizes.clear();
+  {
+    ReadOptions ro;
+    ro.readahead_size = kReadaheadSize;
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    }
+    ASSERT_OK(iter->status());
+  }
+  ASSERT_EQ(kNumFiles - 2, static_cast<int>(hinted_sizes.size()));
+  for (size_t readahead_size : hinted_sizes) {
+    ASSERT_EQ(kReadaheadSize, readahead_size);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+#endif  // !ROCKSDB_LITE
+
+TEST_P(PrefetchTest, NoReadaheadPastUpperBound) {
+  // First param is if the mockFS support_prefetch or not
+  bool support_prefetch =
+      std::get<0>(GetParam()) &&
+      test::IsPrefetchSupported(env_->GetFileSystem(), dbname_);
+
+  // Second param is if directIO is enabled or not
+  bool use_direct_io = std::get<1>(GetParam());
+
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), support_prefetch);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.env = env.get();
+  if (use_direct_io) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  int buff_prefetch_count = 0;
+  SyncPoint::GetInstance()->SetCallBack("FilePrefetchBuffer::Prefetch:Start",
+                                        [&](void*) { buff_prefetch_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  Random rnd(309);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(500)));
+  }
+  ASSERT_OK(Flush());
+
+  ReadOptions ro;
+  ro.readahead_size = 64 * 1024;
+
+  // The first data block holds the upper bound, so nothing after it is read
+  buff_prefetch_count = 0;
+  {
+    std::string upper_bound = Key(2);
+    Slice ub(upper_bound);
+    ro.iterate_upper_bound = &ub;
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    int num_keys = 0;
+    for (iter->Seek(Key(0)); iter->Valid(); iter->Next()) {
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(2, num_keys);
+  }
+  ASSERT_EQ(0, buff_prefetch_count);
+
+  // Without the bound, the same scan reads ahead
+  ro.iterate_upper_bound = nullptr;
+  {
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    iter->Seek(Key(0));
+    ASSERT_TRUE(iter->Valid());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+  }
+  ASSERT_GT(buff_prefetch_count, 0);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -10,18 +10,205 @@
 #include "file/random_access_file_reader.h"
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 
 #include "file/file_util.h"
 #include "monitoring/histogram.h"
 #include "monitoring/iostats_context_imp.h"
+#include "monitoring/statistics.h"
 #include "port/port.h"
 #include "table/format.h"
 #include "test_util/sync_point.h"
 #include "util/random.h"
 #include "util/rate_limiter.h"
+#include "util/threadpool_imp.h"
 
 namespace ROCKSDB_NAMESPACE {
+namespace {
+// The FILE_READ_*_MICROS histogram of the reads done for `activity`
+uint32_t ReadHistogram(IOActivity activity) {
+  switch (activity) {
+    case IOActivity::kFlush:
+      return FILE_READ_FLUSH_MICROS;
+    case IOActivity::kCompaction:
+      return FILE_READ_COMPACTION_MICROS;
+    case IOActivity::kUser:
+      break;
+  }
+  return FILE_READ_USER_MICROS;
+}
+
+// Threads the reads of hedged reads run on. A hedged read occupies one or
+// two of them until its reads complete.
+const int kHedgedReadThreads = 32;
+
+ThreadPoolImpl* HedgedReadThreadPool() {
+  // Intentionally leaked: reads may still be in flight during static
+  // destruction.
+  static ThreadPoolImpl* const pool = [] {
+    ThreadPoolImpl* p = new ThreadPoolImpl();
+    p->SetBackgroundThreads(kHedgedReadThreads);
+    return p;
+  }();
+  return pool;
+}
+
+// Latencies of the latest reads of hedged reads of all files, the
+// percentiles of which decide when to hedge.
+class HedgedReadLatencies {
+ public:
+  static HedgedReadLatencies* Get() {
+    static HedgedReadLatencies* const latencies = new HedgedReadLatencies;
+    return latencies;
+  }
+
+  void Add(uint64_t micros) {
+    std::lock_guard<std::mutex> l(mu_);
+    samples_[num_samples_ % kMaxSamples] = micros;
+    ++num_samples_;
+  }
+
+  // Returns false if too few reads have been seen yet
+  bool Percentile(double percentile, uint64_t* micros) {
+    std::lock_guard<std::mutex> l(mu_);
+    const size_t num = static_cast<size_t>(
+        std::min(num_samples_, static_cast<uint64_t>(kMaxSamples)));
+    if (num < kMinSamples) {
+      return false;
+    }
+    // Sorting a copy on every read would cost more than the reads
+    if (percentile != cached_percentile_ ||
+        num_samples_ - cached_at_ >= kRecomputeInterval) {
+      std::vector<uint64_t> sorted(samples_, samples_ + num);
+      size_t pos = static_cast<size_t>(percentile / 100.0 * num);
+      pos = std::min(pos, num - 1);
+      std::nth_element(sorted.begin(), sorted.begin() + pos, sorted.end());
+      cached_micros_ = sorted[pos];
+      cached_percentile_ = percentile;
+      cached_at_ = num_samples_;
+    }
+    *micros = cached_micros_;
+    return true;
+  }
+
+ private:
+  static const size_t kMaxSamples = 1024;
+  static const size_t kMinSamples = 100;
+  static const uint64_t kRecomputeInterval = 64;
+
+  std::mutex mu_;
+  uint64_t samples_[kMaxSamples];
+  uint64_t num_samples_ = 0;
+  double cached_percentile_ = 0;
+  uint64_t cached_micros_ = 0;
+  uint64_t cached_at_ = 0;
+};
+
+// Shared by a hedged read and the reads it issued, which may outlive it
+struct HedgedReadState {
+  std::mutex mu;
+  std::condition_variable cv;
+  std::unique_ptr<char[]> bufs[2];
+  Slice results[2];
+  IOStatus statuses[2];
+  bool finished[2] = {false, false};
+  int num_issued = 0;
+  // The first read to succeed, or -1
+  int winner = -1;
+};
+}  // namespace
+
+RandomAccessFileReader::~RandomAccessFileReader() {
+  MutexLock l(&hedged_reads_mu_);
+  while (num_hedged_reads_ > 0) {
+    hedged_reads_cv_.Wait();
+  }
+}
+
+IOStatus RandomAccessFileReader::HedgedRead(const IOOptions& opts,
+                                            uint64_t offset, size_t n,
+                                            Slice* result,
+                                            char* scratch) const {
+  uint64_t delay_micros = static_cast<uint64_t>(opts.hedge_min_delay.count());
+  uint64_t percentile_micros = 0;
+  if (HedgedReadLatencies::Get()->Percentile(opts.hedge_percentile,
+                                             &percentile_micros)) {
+    delay_micros = std::max(delay_micros, percentile_micros);
+  }
+
+  std::shared_ptr<HedgedReadState> state(new HedgedReadState);
+  auto issue = [&](int i, const IOOptions& read_opts) {
+    state->bufs[i].reset(new char[n]);
+    state->num_issued++;
+    {
+      MutexLock l(&hedged_reads_mu_);
+      ++num_hedged_reads_;
+    }
+    HedgedReadThreadPool()->SubmitJob([this, state, i, read_opts, offset,
+                                       n]() {
+      const auto start = std::chrono::steady_clock::now();
+      Slice r;
+      IOStatus s =
+          file_->Read(offset, n, read_opts, &r, state->bufs[i].get(), nullptr);
+      HedgedReadLatencies::Get()->Add(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count()));
+      {
+        std::lock_guard<std::mutex> l(state->mu);
+        state->results[i] = r;
+        state->statuses[i] = s;
+        state->statuses[i].PermitUncheckedError();
+        state->finished[i] = true;
+        if (s.ok() && state->winner < 0) {
+          state->winner = i;
+        }
+      }
+      state->cv.notify_all();
+      MutexLock l(&hedged_reads_mu_);
+      --num_hedged_reads_;
+      hedged_reads_cv_.SignalAll();
+    });
+  };
+  // Done once a read succeeded or all of them failed
+  auto done = [&]() {
+    return state->winner >= 0 ||
+           (state->finished[0] &&
+            (state->num_issued == 1 || state->finished[1]));
+  };
+
+  std::unique_lock<std::mutex> lock(state->mu);
+  issue(0, opts);
+  if (delay_micros == 0) {
+    // Nothing to tell a slow read by yet
+    state->cv.wait(lock, done);
+  } else if (!state->cv.wait_for(lock,
+                                 std::chrono::microseconds(delay_micros),
+                                 done)) {
+    IOOptions hedge_opts = opts;
+    hedge_opts.is_hedged_read = true;
+    issue(1, hedge_opts);
+    RecordTick(stats_, HEDGED_READS_ISSUED);
+    state->cv.wait(lock, done);
+  }
+
+  const int winner = state->winner;
+  if (winner < 0) {
+    *result = Slice();
+    return state->statuses[0];
+  }
+  if (winner == 1) {
+    RecordTick(stats_, HEDGED_READS_WON);
+  }
+  // The buffer of the winner is not written to anymore
+  const Slice& r = state->results[winner];
+  memcpy(scratch, r.data(), r.size());
+  *result = Slice(scratch, r.size());
+  return IOStatus::OK();
+}
+
 IOStatus RandomAccessFileReader::Create(
     const std::shared_ptr<FileSystem>& fs, const std::string& fname,
     const FileOptions& file_opts,
@@ -41,6 +228,12 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
   (void)aligned_buf;
 
   TEST_SYNC_POINT_CALLBACK("RandomAccessFileReader::Read", nullptr);
+  // Compaction reads are low-pri. Reads with a timeout are not rate limited,
+  // so that they are issued in one piece.
+  const Env::IOPriority rate_limiter_priority =
+      for_compaction ? Env::IO_LOW
+                     : (opts.timeout.count() ? Env::IO_TOTAL
+                                             : opts.rate_limiter_priority);
   IOStatus io_s;
   uint64_t elapsed = 0;
   {
@@ -62,10 +255,11 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
       buf.AllocateNewBuffer(read_size);
       while (buf.CurrentSize() < read_size) {
         size_t allowed;
-        if (for_compaction && rate_limiter_ != nullptr) {
+        if (rate_limiter_priority != Env::IO_TOTAL &&
+            rate_limiter_ != nullptr) {
           allowed = rate_limiter_->RequestToken(
               buf.Capacity() - buf.CurrentSize(), buf.Alignment(),
-              Env::IOPriority::IO_LOW, stats_, RateLimiter::OpType::kRead);
+              rate_limiter_priority, stats_, RateLimiter::OpType::kRead);
         } else {
           assert(buf.CurrentSize() == 0);
           allowed = read_size;
@@ -81,7 +275,7 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
 
         {
           IOSTATS_CPU_TIMER_GUARD(cpu_read_nanos, clock_);
-          // Only user reads are expected to specify a timeout. And user reads
+          // Only user reads are expected to specify a timeout. And such reads
           // are not subjected to rate_limiter and should go through only
           // one iteration of this loop, so we don't need to check and adjust
           // the opts.timeout before calling file_->Read
@@ -117,12 +311,13 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
       const char* res_scratch = nullptr;
       while (pos < n) {
         size_t allowed;
-        if (for_compaction && rate_limiter_ != nullptr) {
+        if (rate_limiter_priority != Env::IO_TOTAL &&
+            rate_limiter_ != nullptr) {
           if (rate_limiter_->IsRateLimited(RateLimiter::OpType::kRead)) {
             sw.DelayStart();
           }
           allowed = rate_limiter_->RequestToken(n - pos, 0 /* alignment */,
-                                                Env::IOPriority::IO_LOW, stats_,
+                                                rate_limiter_priority, stats_,
                                                 RateLimiter::OpType::kRead);
           if (rate_limiter_->IsRateLimited(RateLimiter::OpType::kRead)) {
             sw.DelayStop();
@@ -141,13 +336,19 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
 
         {
           IOSTATS_CPU_TIMER_GUARD(cpu_read_nanos, clock_);
-          // Only user reads are expected to specify a timeout. And user reads
+          // Only user reads are expected to specify a timeout. And such reads
           // are not subjected to rate_limiter and should go through only
           // one iteration of this loop, so we don't need to check and adjust
           // the opts.timeout before calling file_->Read
           assert(!opts.timeout.count() || allowed == n);
-          io_s = file_->Read(offset + pos, allowed, opts, &tmp_result,
-                             scratch + pos, nullptr);
+          if (opts.hedge_percentile > 0 && !for_compaction &&
+              scratch != nullptr) {
+            io_s = HedgedRead(opts, offset + pos, allowed, &tmp_result,
+                              scratch + pos);
+          } else {
+            io_s = file_->Read(offset + pos, allowed, opts, &tmp_result,
+                               scratch + pos, nullptr);
+          }
         }
 #ifndef ROCKSDB_LITE
         if (ShouldNotifyListeners()) {
@@ -175,6 +376,13 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
     IOSTATS_ADD_IF_POSITIVE(bytes_read, result->size());
     SetPerfLevel(prev_perf_level);
   }
+  if (stats_ != nullptr) {
+    RecordTimeToHistogram(
+        stats_,
+        ReadHistogram(for_compaction ? IOActivity::kCompaction
+                                     : GetThreadIOActivity()),
+        elapsed);
+  }
   if (stats_ != nullptr && file_read_hist_ != nullptr) {
     file_read_hist_->Add(elapsed);
   }
@@ -271,6 +479,81 @@ IOStatus RandomAccessFileReader::MultiRead(const IOOptions& opts,
     }
 #endif  // ROCKSDB_LITE
 
+    // Merge nearby buffered reads into requests of their own and copy the
+    // results back afterwards
+    std::vector<FSReadRequest> coalesced_reqs;
+    std::vector<size_t> coalesced_req_idx;
+    std::unique_ptr<char[]> coalesced_buf;
+    if (!use_direct_io() && opts.coalesce_max_size > 0) {
+      coalesced_reqs.reserve(num_reqs);
+      coalesced_req_idx.reserve(num_reqs);
+      for (size_t i = 0; i < num_reqs; i++) {
+        const FSReadRequest& r = read_reqs[i];
+        if (!coalesced_reqs.empty()) {
+          FSReadRequest& last = coalesced_reqs.back();
+          const size_t last_end = End(last);
+          if (r.offset >= last_end &&
+              r.offset - last_end <= opts.coalesce_max_gap &&
+              End(r) - last.offset <= opts.coalesce_max_size) {
+            last.len = End(r) - last.offset;
+            coalesced_req_idx.push_back(coalesced_reqs.size() - 1);
+            continue;
+          }
+        }
+        FSReadRequest req;
+        req.offset = r.offset;
+        req.len = r.len;
+        req.scratch = nullptr;
+        coalesced_reqs.push_back(req);
+        coalesced_req_idx.push_back(coalesced_reqs.size() - 1);
+      }
+      if (coalesced_reqs.size() < num_reqs) {
+        // Requests left on their own are read into their own scratch
+        for (size_t i = 0; i < num_reqs; i++) {
+          FSReadRequest& fs_r = coalesced_reqs[coalesced_req_idx[i]];
+          if (fs_r.len == read_reqs[i].len) {
+            fs_r.scratch = read_reqs[i].scratch;
+          }
+        }
+        size_t total_len = 0;
+        for (const auto& r : coalesced_reqs) {
+          if (r.scratch == nullptr) {
+            total_len += r.len;
+          }
+        }
+        coalesced_buf.reset(new char[total_len]);
+        char* scratch = coalesced_buf.get();
+        for (auto& r : coalesced_reqs) {
+          if (r.scratch == nullptr) {
+            r.scratch = scratch;
+            scratch += r.len;
+          }
+        }
+        fs_reqs = coalesced_reqs.data();
+        num_fs_reqs = coalesced_reqs.size();
+      } else {
+        coalesced_reqs.clear();
+      }
+      TEST_SYNC_POINT_CALLBACK(
+          "RandomAccessFileReader::MultiRead:CoalescedReqs", &coalesced_reqs);
+    }
+
+    if (opts.rate_limiter_priority != Env::IO_TOTAL && !opts.timeout.count() &&
+        rate_limiter_ != nullptr &&
+        rate_limiter_->IsRateLimited(RateLimiter::OpType::kRead)) {
+      // All the requests are issued at once, so wait for all of their bytes
+      sw.DelayStart();
+      for (size_t i = 0; i < num_fs_reqs; ++i) {
+        size_t remaining = fs_reqs[i].len;
+        while (remaining > 0) {
+          remaining -= rate_limiter_->RequestToken(
+              remaining, 0 /* alignment */, opts.rate_limiter_priority, stats_,
+              RateLimiter::OpType::kRead);
+        }
+      }
+      sw.DelayStop();
+    }
+
 #ifndef ROCKSDB_LITE
     FileOperationInfo::StartTimePoint start_ts;
     if (ShouldNotifyListeners()) {
@@ -305,6 +588,29 @@ IOStatus RandomAccessFileReader::MultiRead(const IOOptions& opts,
     }
 #endif  // ROCKSDB_LITE
 
+    if (!coalesced_reqs.empty()) {
+      for (size_t i = 0; i < num_reqs; i++) {
+        auto& r = read_reqs[i];
+        const auto& fs_r = coalesced_reqs[coalesced_req_idx[i]];
+        r.status = fs_r.status;
+        if (fs_r.scratch == r.scratch) {
+          r.result = r.status.ok() ? fs_r.result : Slice();
+        } else if (r.status.ok()) {
+          const size_t offset = static_cast<size_t>(r.offset - fs_r.offset);
+          const size_t len =
+              fs_r.result.size() > offset
+                  ? std::min(r.len, fs_r.result.size() - offset)
+                  : 0;
+          if (len > 0) {
+            memcpy(r.scratch, fs_r.result.data() + offset, len);
+          }
+          r.result = Slice(r.scratch, len);
+        } else {
+          r.result = Slice();
+        }
+      }
+    }
+
     for (size_t i = 0; i < num_reqs; ++i) {
 #ifndef ROCKSDB_LITE
       if (ShouldNotifyListeners()) {
@@ -317,6 +623,10 @@ IOStatus RandomAccessFileReader::MultiRead(const IOOptions& opts,
     }
     SetPerfLevel(prev_perf_level);
   }
+  if (stats_ != nullptr) {
+    RecordTimeToHistogram(stats_, ReadHistogram(GetThreadIOActivity()),
+                          elapsed);
+  }
   if (stats_ != nullptr && file_read_hist_ != nullptr) {
     file_read_hist_->Add(elapsed);
   }
@@ -324,6 +634,77 @@ IOStatus RandomAccessFileReader::MultiRead(const IOOptions& opts,
   return io_s;
 }
 
+IOStatus RandomAccessFileReader::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn) {
+  assert(io_handle != nullptr);
+  assert(del_fn != nullptr);
+  *io_handle = nullptr;
+  if (use_direct_io()) {
+    req.status = Read(opts, req.offset, req.len, &req.result, req.scratch,
+                      nullptr /* aligned_buf */);
+    cb(req, cb_arg);
+    return IOStatus::OK();
+  }
+
+  ReadAsyncInfo* read_async_info = new ReadAsyncInfo;
+  read_async_info->cb_ = std::move(cb);
+  read_async_info->cb_arg_ = cb_arg;
+  read_async_info->start_time_ = clock_ != nullptr ? clock_->NowMicros() : 0;
+  read_async_info->io_activity_ = GetThreadIOActivity();
+#ifndef ROCKSDB_LITE
+  if (ShouldNotifyListeners()) {
+    read_async_info->fs_start_ts_ = FileOperationInfo::StartNow();
+  }
+#endif
+
+  auto read_async_callback =
+      std::bind(&RandomAccessFileReader::ReadAsyncCallback, this,
+                std::placeholders::_1, std::placeholders::_2);
+  IOStatus s = file_->ReadAsync(req, opts, read_async_callback,
+                                read_async_info, io_handle, del_fn,
+                                nullptr /* dbg */);
+  if (!s.ok() || *io_handle == nullptr) {
+    // Either not submitted or already completed.
+    delete read_async_info;
+  } else {
+    IOHandleDeleter fs_del_fn = *del_fn;
+    *del_fn = [fs_del_fn, read_async_info](void* handle) {
+      if (fs_del_fn) {
+        fs_del_fn(handle);
+      }
+      delete read_async_info;
+    };
+  }
+  return s;
+}
+
+void RandomAccessFileReader::ReadAsyncCallback(const FSReadRequest& req,
+                                               void* cb_arg) {
+  ReadAsyncInfo* read_async_info = static_cast<ReadAsyncInfo*>(cb_arg);
+  assert(read_async_info != nullptr);
+  if (clock_ != nullptr && stats_ != nullptr) {
+    uint64_t elapsed = clock_->NowMicros() - read_async_info->start_time_;
+    RecordInHistogram(stats_, hist_type_, elapsed);
+    RecordTimeToHistogram(stats_, ReadHistogram(read_async_info->io_activity_),
+                          elapsed);
+    if (file_read_hist_ != nullptr) {
+      file_read_hist_->Add(elapsed);
+    }
+  }
+#ifndef ROCKSDB_LITE
+  if (ShouldNotifyListeners()) {
+    auto finish_ts = FileOperationInfo::FinishNow();
+    NotifyOnFileReadFinish(req.offset, req.result.size(),
+                           read_async_info->fs_start_ts_, finish_ts,
+                           req.status);
+  }
+#endif
+  IOSTATS_ADD_IF_POSITIVE(bytes_read, req.result.size());
+  read_async_info->cb_(req, read_async_info->cb_arg_);
+}
+
 IOStatus RandomAccessFileReader::PrepareIOOptions(const ReadOptions& ro,
                                                   IOOptions& opts) {
   if (clock_ != nullptr) {
@@ -24,6 +24,7 @@ namespace ROCKSDB_NAMESPACE {
 class Statistics;
 class HistogramImpl;
 class SystemClock;
+enum class IOActivity : uint8_t;
 
 using AlignedBuf = std::unique_ptr<char[]>;
 
@@ -65,6 +66,26 @@ class RandomAccessFileReader {
 
   bool ShouldNotifyListeners() const { return !listeners_.empty(); }
 
+  // State of one ReadAsync() request, owned by the deleter of its io_handle
+  // or, for requests completed inline, by ReadAsync() itself.
+  struct ReadAsyncInfo {
+    std::function<void(const FSReadRequest&, void*)> cb_;
+    void* cb_arg_;
+    uint64_t start_time_;
+    IOActivity io_activity_;
+#ifndef ROCKSDB_LITE
+    FileOperationInfo::StartTimePoint fs_start_ts_;
+#endif
+  };
+
+  void ReadAsyncCallback(const FSReadRequest& req, void* cb_arg);
+
+  // Reads through file_ on a thread pool, issuing a second read if the
+  // first one is slow; see ReadOptions::hedged_read_percentile. The result
+  // is copied to scratch.
+  IOStatus HedgedRead(const IOOptions& opts, uint64_t offset, size_t n,
+                      Slice* result, char* scratch) const;
+
   FSRandomAccessFilePtr file_;
   std::string file_name_;
   SystemClock* clock_;
@@ -74,6 +95,12 @@ class RandomAccessFileReader {
   RateLimiter* rate_limiter_;
   std::vector<std::shared_ptr<EventListener>> listeners_;
 
+  // Reads of HedgedRead() still running, possibly after it returned. The
+  // destructor waits for them.
+  mutable port::Mutex hedged_reads_mu_;
+  mutable port::CondVar hedged_reads_cv_;
+  mutable int num_hedged_reads_;
+
  public:
   explicit RandomAccessFileReader(
       std::unique_ptr<FSRandomAccessFile>&& raf, const std::string& _file_name,
@@ -90,7 +117,9 @@ class RandomAccessFileReader {
         hist_type_(hist_type),
         file_read_hist_(file_read_hist),
         rate_limiter_(rate_limiter),
-        listeners_() {
+        listeners_(),
+        hedged_reads_cv_(&hedged_reads_mu_),
+        num_hedged_reads_(0) {
 #ifndef ROCKSDB_LITE
     std::for_each(listeners.begin(), listeners.end(),
                   [this](const std::shared_ptr<EventListener>& e) {
@@ -110,6 +139,8 @@ class RandomAccessFileReader {
   RandomAccessFileReader(const RandomAccessFileReader&) = delete;
   RandomAccessFileReader& operator=(const RandomAccessFileReader&) = delete;
 
+  ~RandomAccessFileReader();
+
   // In non-direct IO mode,
   // 1. if using mmap, result is stored in a buffer other than scratch;
   // 2. if not using mmap, result is stored in the buffer starting from scratch.
@@ -132,6 +163,16 @@ class RandomAccessFileReader {
   IOStatus MultiRead(const IOOptions& opts, FSReadRequest* reqs,
                      size_t num_reqs, AlignedBuf* aligned_buf) const;
 
+  // EXPERIMENTAL
+  // Submits req through FSRandomAccessFile::ReadAsync() and returns without
+  // waiting for it; see there for the meaning of the arguments. IO stats,
+  // histograms and listeners are updated when the read completes, just
+  // before cb is invoked. In direct IO mode the read is done synchronously
+  // through Read(), which takes care of the alignment.
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn);
+
   IOStatus Prefetch(uint64_t offset, size_t n) const {
     return file_->Prefetch(offset, n, IOOptions(), nullptr);
   }
@@ -11,6 +11,7 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/file_system.h"
+#include "rocksdb/statistics.h"
 #include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
@@ -288,6 +289,203 @@ TEST_F(RandomAccessFileReaderTest, MultiReadDirectIO) {
 
 #endif  // ROCKSDB_LITE
 
+TEST_F(RandomAccessFileReaderTest, MultiReadCoalesced) {
+  std::vector<FSReadRequest> coalesced_reqs;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "RandomAccessFileReader::MultiRead:CoalescedReqs", [&](void* reqs) {
+        coalesced_reqs = *reinterpret_cast<std::vector<FSReadRequest>*>(reqs);
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  std::string fname = "multi-read-coalesced";
+  Random rand(0);
+  std::string content = rand.RandomString(4 * kDefaultPageSize);
+  Write(fname, content);
+
+  std::unique_ptr<RandomAccessFileReader> r;
+  Read(fname, FileOptions(), &r);
+
+  // {offset, len}; the last one goes past the end of the file
+  const std::vector<std::pair<uint64_t, size_t>> ranges = {
+      {0, 100},    {150, 150},   {1000, 100},
+      {1150, 450}, {16300, 50}, {16360, 40}};
+  std::vector<FSReadRequest> reqs(ranges.size());
+  std::vector<std::string> scratches(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    reqs[i].offset = ranges[i].first;
+    reqs[i].len = ranges[i].second;
+    scratches[i].assign(reqs[i].len, ' ');
+    reqs[i].scratch = &scratches[i][0];
+  }
+
+  IOOptions opts;
+  opts.coalesce_max_gap = 100;
+  opts.coalesce_max_size = 512;
+  ASSERT_OK(r->MultiRead(opts, reqs.data(), reqs.size(), nullptr));
+
+  // The third and fourth would make a read larger than 512 bytes
+  ASSERT_EQ(4U, coalesced_reqs.size());
+  ASSERT_EQ(0U, coalesced_reqs[0].offset);
+  ASSERT_EQ(300U, coalesced_reqs[0].len);
+  ASSERT_EQ(1000U, coalesced_reqs[1].offset);
+  ASSERT_EQ(100U, coalesced_reqs[1].len);
+  ASSERT_EQ(1150U, coalesced_reqs[2].offset);
+  ASSERT_EQ(450U, coalesced_reqs[2].len);
+  ASSERT_EQ(16300U, coalesced_reqs[3].offset);
+  ASSERT_EQ(100U, coalesced_reqs[3].len);
+
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    ASSERT_OK(reqs[i].status);
+    // Results are in the scratch of each request
+    ASSERT_EQ(reqs[i].scratch, reqs[i].result.data());
+    ASSERT_EQ(content.substr(reqs[i].offset, reqs[i].len),
+              reqs[i].result.ToString());
+  }
+  ASSERT_EQ(content.size() - 16360, reqs.back().result.size());
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+namespace {
+// Serves reads from memory. Reads other than hedged ones take delay_micros.
+class SlowRandomAccessFile : public FSRandomAccessFile {
+ public:
+  SlowRandomAccessFile(const std::string& content, uint64_t delay_micros)
+      : content_(content), delay_micros_(delay_micros) {}
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& opts,
+                Slice* result, char* scratch,
+                IODebugContext* /*dbg*/) const override {
+    if (!opts.is_hedged_read) {
+      SystemClock::Default()->SleepForMicroseconds(
+          static_cast<int>(delay_micros_));
+    }
+    n = std::min(n, content_.size() - static_cast<size_t>(offset));
+    memcpy(scratch, content_.data() + offset, n);
+    *result = Slice(scratch, n);
+    return IOStatus::OK();
+  }
+
+ private:
+  std::string content_;
+  uint64_t delay_micros_;
+};
+}  // namespace
+
+TEST_F(RandomAccessFileReaderTest, HedgedRead) {
+  Random rand(0);
+  std::string content = rand.RandomString(kDefaultPageSize);
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+
+  for (uint64_t delay_micros : {uint64_t{0}, uint64_t{200000}}) {
+    stats->Reset();
+    std::unique_ptr<RandomAccessFileReader> r(new RandomAccessFileReader(
+        std::unique_ptr<FSRandomAccessFile>(
+            new SlowRandomAccessFile(content, delay_micros)),
+        "slow", SystemClock::Default().get(), nullptr /* io_tracer */,
+        stats.get()));
+
+    IOOptions opts;
+    opts.hedge_percentile = 99.0;
+    opts.hedge_min_delay = std::chrono::milliseconds(20);
+    std::string scratch(100, ' ');
+    Slice result;
+    ASSERT_OK(r->Read(opts, 100, 100, &result, &scratch[0],
+                      nullptr /* aligned_buf */));
+    ASSERT_EQ(content.substr(100, 100), result.ToString());
+    ASSERT_EQ(scratch.data(), result.data());
+
+    // A slow read is hedged, and the hedge wins
+    const uint64_t expected = delay_micros > 0 ? 1 : 0;
+    ASSERT_EQ(expected, stats->getTickerCount(HEDGED_READS_ISSUED));
+    ASSERT_EQ(expected, stats->getTickerCount(HEDGED_READS_WON));
+    // Waits for the slow read still running
+    r.reset();
+  }
+}
+
+TEST_F(RandomAccessFileReaderTest, ReadAsync) {
+  std::string fname = "read-async";
+  Random rand(0);
+  std::string content = rand.RandomString(16 * kDefaultPageSize);
+  Write(fname, content);
+
+  std::unique_ptr<RandomAccessFileReader> r;
+  Read(fname, FileOptions(), &r);
+
+  const size_t kNumReqs = 4;
+  std::vector<FSReadRequest> reqs(kNumReqs);
+  std::vector<std::unique_ptr<char[]>> bufs(kNumReqs);
+  std::vector<FSReadRequest> results(kNumReqs);
+  std::vector<int> num_callbacks(kNumReqs, 0);
+  auto cb = [&](const FSReadRequest& req, void* cb_arg) {
+    size_t i = reinterpret_cast<size_t>(cb_arg);
+    results[i] = req;
+    num_callbacks[i]++;
+  };
+
+  std::vector<void*> io_handles(kNumReqs, nullptr);
+  std::vector<IOHandleDeleter> del_fns(kNumReqs);
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    reqs[i].offset = i * 3 * kDefaultPageSize + 100;
+    reqs[i].len = kDefaultPageSize + i;
+    bufs[i].reset(new char[reqs[i].len]);
+    reqs[i].scratch = bufs[i].get();
+    ASSERT_OK(r->ReadAsync(reqs[i], IOOptions(), cb,
+                           reinterpret_cast<void*>(i), &io_handles[i],
+                           &del_fns[i]));
+  }
+  std::vector<void*> pending;
+  for (void* h : io_handles) {
+    if (h != nullptr) {
+      pending.push_back(h);
+    }
+  }
+  ASSERT_OK(FileSystem::Default()->Poll(pending, pending.size()));
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    ASSERT_EQ(1, num_callbacks[i]);
+    if (io_handles[i] != nullptr) {
+      del_fns[i](io_handles[i]);
+    }
+  }
+  AssertResult(content, results);
+}
+
+TEST_F(RandomAccessFileReaderTest, ReadAsyncAbort) {
+  std::string fname = "read-async-abort";
+  Random rand(0);
+  std::string content = rand.RandomString(4 * kDefaultPageSize);
+  Write(fname, content);
+
+  std::unique_ptr<RandomAccessFileReader> r;
+  Read(fname, FileOptions(), &r);
+
+  FSReadRequest req;
+  req.offset = 0;
+  req.len = content.size();
+  std::unique_ptr<char[]> buf(new char[req.len]);
+  req.scratch = buf.get();
+  int num_callbacks = 0;
+  void* io_handle = nullptr;
+  IOHandleDeleter del_fn;
+  ASSERT_OK(r->ReadAsync(
+      req, IOOptions(),
+      [&](const FSReadRequest&, void*) { num_callbacks++; }, nullptr,
+      &io_handle, &del_fn));
+  if (io_handle == nullptr) {
+    // Completed inline, nothing left to abort.
+    ASSERT_EQ(1, num_callbacks);
+    return;
+  }
+  std::vector<void*> io_handles{io_handle};
+  ASSERT_OK(FileSystem::Default()->AbortIO(io_handles));
+  // Polling an aborted request does not invoke its callback either.
+  ASSERT_OK(FileSystem::Default()->Poll(io_handles, 1));
+  ASSERT_EQ(0, num_callbacks);
+  del_fn(io_handle);
+}
+
 TEST(FSReadRequest, Align) {
   FSReadRequest r;
   r.offset = 2000;
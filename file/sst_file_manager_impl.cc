@@ -237,6 +237,15 @@ void SstFileManagerImpl::SetMaxTrashDBRatio(double r) {
   return delete_scheduler_.SetMaxTrashDBRatio(r);
 }
 
+uint64_t SstFileManagerImpl::GetBytesMaxDeleteChunk() {
+  return delete_scheduler_.GetBytesMaxDeleteChunk();
+}
+
+void SstFileManagerImpl::SetBytesMaxDeleteChunk(
+    uint64_t bytes_max_delete_chunk) {
+  return delete_scheduler_.SetBytesMaxDeleteChunk(bytes_max_delete_chunk);
+}
+
 uint64_t SstFileManagerImpl::GetTotalTrashSize() {
   return delete_scheduler_.GetTotalTrashSize();
 }
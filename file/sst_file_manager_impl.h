@@ -101,6 +101,12 @@ class SstFileManagerImpl : public SstFileManager {
   // Update trash/DB size ratio where new files will be deleted immediately
   virtual void SetMaxTrashDBRatio(double ratio) override;
 
+  // Return the size of the chunks large trash files are deleted in
+  uint64_t GetBytesMaxDeleteChunk() override;
+
+  // Update the size of the chunks large trash files are deleted in
+  void SetBytesMaxDeleteChunk(uint64_t bytes_max_delete_chunk) override;
+
   // Return the total size of trash files
   uint64_t GetTotalTrashSize() override;
 
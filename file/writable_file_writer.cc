@@ -13,9 +13,11 @@
 #include <mutex>
 
 #include "db/version_edit.h"
+#include "file/filename.h"
 #include "monitoring/histogram.h"
 #include "monitoring/iostats_context_imp.h"
 #include "port/port.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/system_clock.h"
 #include "test_util/sync_point.h"
 #include "util/crc32c.h"
@@ -23,6 +25,84 @@
 #include "util/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
+constexpr size_t WritableFileWriter::kChecksumChunkSize;
+constexpr size_t WritableFileWriter::kMaxAsyncWrites;
+
+namespace {
+bool ShouldTimeWrites(SystemClock* clock, Statistics* stats) {
+  return clock != nullptr && stats != nullptr &&
+         stats->get_stats_level() >= StatsLevel::kExceptTimers;
+}
+
+// Records the latency of a write in the histograms of the I/O activity of
+// the current thread and, unless HISTOGRAM_ENUM_MAX, of the file type
+void RecordWriteLatency(Statistics* stats, uint32_t file_write_hist,
+                        uint64_t elapsed) {
+  uint32_t activity_hist = FILE_WRITE_USER_MICROS;
+  switch (GetThreadIOActivity()) {
+    case IOActivity::kFlush:
+      activity_hist = FILE_WRITE_FLUSH_MICROS;
+      break;
+    case IOActivity::kCompaction:
+      activity_hist = FILE_WRITE_COMPACTION_MICROS;
+      break;
+    case IOActivity::kUser:
+      break;
+  }
+  stats->reportTimeToHistogram(activity_hist, elapsed);
+  if (file_write_hist != HISTOGRAM_ENUM_MAX) {
+    stats->reportTimeToHistogram(file_write_hist, elapsed);
+  }
+}
+
+// Records the time until destroyed with RecordWriteLatency()
+class WriteStopWatch {
+ public:
+  WriteStopWatch(SystemClock* clock, Statistics* stats,
+                 uint32_t file_write_hist)
+      : clock_(ShouldTimeWrites(clock, stats) ? clock : nullptr),
+        stats_(stats),
+        file_write_hist_(file_write_hist),
+        start_micros_(clock_ != nullptr ? clock_->NowMicros() : 0) {}
+
+  ~WriteStopWatch() {
+    if (clock_ != nullptr) {
+      RecordWriteLatency(stats_, file_write_hist_,
+                         clock_->NowMicros() - start_micros_);
+    }
+  }
+
+ private:
+  SystemClock* const clock_;
+  Statistics* const stats_;
+  const uint32_t file_write_hist_;
+  const uint64_t start_micros_;
+};
+}  // anonymous namespace
+
+uint32_t WritableFileWriter::FileWriteHistogram(const std::string& file_name) {
+  const size_t sep = file_name.find_last_of('/');
+  uint64_t number;
+  FileType type;
+  if (!ParseFileName(
+          sep == std::string::npos ? file_name : file_name.substr(sep + 1),
+          &number, &type)) {
+    return HISTOGRAM_ENUM_MAX;
+  }
+  switch (type) {
+    case kWalFile:
+      return WAL_FILE_WRITE_MICROS;
+    case kDescriptorFile:
+      return MANIFEST_FILE_WRITE_MICROS;
+    case kTableFile:
+      return SST_FILE_WRITE_MICROS;
+    case kBlobFile:
+      return BLOB_FILE_WRITE_MICROS;
+    default:
+      return HISTOGRAM_ENUM_MAX;
+  }
+}
+
 Status WritableFileWriter::Create(const std::shared_ptr<FileSystem>& fs,
                                   const std::string& fname,
                                   const FileOptions& file_opts,
@@ -45,9 +125,6 @@ IOStatus WritableFileWriter::Append(const Slice& data,
 
   TEST_KILL_RANDOM_WITH_WEIGHT("WritableFileWriter::Append:0", REDUCE_ODDS2);
 
-  // Calculate the checksum of appended data
-  UpdateFileChecksum(data);
-
   {
     IOSTATS_TIMER_GUARD(prepare_write_nanos);
     TEST_SYNC_POINT("WritableFileWriter::Append:BeforePrepareWrite");
@@ -89,7 +166,7 @@ IOStatus WritableFileWriter::Append(const Slice& data,
     // size is enough. Otherwise, we will directly write it down.
     if (use_direct_io() || (buf_.Capacity() - buf_.CurrentSize()) >= left) {
       if ((buf_.Capacity() - buf_.CurrentSize()) >= left) {
-        size_t appended = buf_.Append(src, left);
+        size_t appended = AppendToBuffer(src, left, false /* update_crc32c */);
         if (appended != left) {
           s = IOStatus::Corruption("Write buffer append failure");
         }
@@ -97,9 +174,7 @@ IOStatus WritableFileWriter::Append(const Slice& data,
             buffered_data_crc32c_checksum_, crc32c_checksum, appended);
       } else {
         while (left > 0) {
-          size_t appended = buf_.Append(src, left);
-          buffered_data_crc32c_checksum_ =
-              crc32c::Extend(buffered_data_crc32c_checksum_, src, appended);
+          size_t appended = AppendToBuffer(src, left, true /* update_crc32c */);
           left -= appended;
           src += appended;
 
@@ -113,6 +188,7 @@ IOStatus WritableFileWriter::Append(const Slice& data,
       }
     } else {
       assert(buf_.CurrentSize() == 0);
+      UpdateChecksums(src, left, false /* update_crc32c */);
       buffered_data_crc32c_checksum_ = crc32c_checksum;
       s = WriteBufferedWithChecksum(src, left);
     }
@@ -123,13 +199,11 @@ IOStatus WritableFileWriter::Append(const Slice& data,
     // We never write directly to disk with direct I/O on.
     // or we simply use it for its original purpose to accumulate many small
     // chunks
+    const bool update_crc32c =
+        perform_data_verification_ && buffered_data_with_checksum_;
     if (use_direct_io() || (buf_.Capacity() >= left)) {
       while (left > 0) {
-        size_t appended = buf_.Append(src, left);
-        if (perform_data_verification_ && buffered_data_with_checksum_) {
-          buffered_data_crc32c_checksum_ =
-              crc32c::Extend(buffered_data_crc32c_checksum_, src, appended);
-        }
+        size_t appended = AppendToBuffer(src, left, update_crc32c);
         left -= appended;
         src += appended;
 
@@ -143,8 +217,8 @@ IOStatus WritableFileWriter::Append(const Slice& data,
     } else {
       // Writing directly to file bypassing the buffer
       assert(buf_.CurrentSize() == 0);
-      if (perform_data_verification_ && buffered_data_with_checksum_) {
-        buffered_data_crc32c_checksum_ = crc32c::Value(src, left);
+      UpdateChecksums(src, left, update_crc32c);
+      if (update_crc32c) {
         s = WriteBufferedWithChecksum(src, left);
       } else {
         s = WriteBuffered(src, left);
@@ -204,7 +278,12 @@ IOStatus WritableFileWriter::Close() {
 
   s = Flush();  // flush cache to OS
 
-  IOStatus interim;
+  // Async writes must complete before the file is truncated, synced or
+  // closed
+  IOStatus interim = WaitForAsyncWrites();
+  if (!interim.ok() && s.ok()) {
+    s = interim;
+  }
   // In direct I/O mode we write whole pages so
   // we need to let the file know where data ends.
   if (use_direct_io()) {
@@ -283,6 +362,10 @@ IOStatus WritableFileWriter::Flush() {
   IOStatus s;
   TEST_KILL_RANDOM_WITH_WEIGHT("WritableFileWriter::Flush:0", REDUCE_ODDS2);
 
+  if (!async_write_status_.ok()) {
+    return async_write_status_;
+  }
+
   if (buf_.CurrentSize() > 0) {
     if (use_direct_io()) {
 #ifndef ROCKSDB_LITE
@@ -295,7 +378,9 @@ IOStatus WritableFileWriter::Flush() {
       }
 #endif  // !ROCKSDB_LITE
     } else {
-      if (perform_data_verification_ && buffered_data_with_checksum_) {
+      if (UseAsyncWrites()) {
+        s = WriteBufferedAsync();
+      } else if (perform_data_verification_ && buffered_data_with_checksum_) {
         s = WriteBufferedWithChecksum(buf_.BufferStart(), buf_.CurrentSize());
       } else {
         s = WriteBuffered(buf_.BufferStart(), buf_.CurrentSize());
@@ -347,6 +432,11 @@ IOStatus WritableFileWriter::Flush() {
       assert(offset_sync_to >= last_sync_size_);
       if (offset_sync_to > 0 &&
           offset_sync_to - last_sync_size_ >= bytes_per_sync_) {
+        // The range must have been written to be synced
+        s = WaitForAsyncWrites(offset_sync_to);
+        if (!s.ok()) {
+          return s;
+        }
         s = RangeSync(last_sync_size_, offset_sync_to - last_sync_size_);
         last_sync_size_ = offset_sync_to;
       }
@@ -378,6 +468,10 @@ IOStatus WritableFileWriter::Sync(bool use_fsync) {
   if (!s.ok()) {
     return s;
   }
+  s = WaitForAsyncWrites();
+  if (!s.ok()) {
+    return s;
+  }
   TEST_KILL_RANDOM("WritableFileWriter::Sync:0");
   if (!use_direct_io() && pending_sync_) {
     s = SyncInternal(use_fsync);
@@ -396,6 +490,11 @@ IOStatus WritableFileWriter::SyncWithoutFlush(bool use_fsync) {
         "Can't WritableFileWriter::SyncWithoutFlush() because "
         "WritableFile::IsSyncThreadSafe() is false");
   }
+  if (UseAsyncWrites()) {
+    // Flushed data may still be in flight
+    return IOStatus::NotSupported(
+        "Can't WritableFileWriter::SyncWithoutFlush() with async writes");
+  }
   TEST_SYNC_POINT("WritableFileWriter::SyncWithoutFlush:1");
   IOStatus s = SyncInternal(use_fsync);
   TEST_SYNC_POINT("WritableFileWriter::SyncWithoutFlush:2");
@@ -486,6 +585,7 @@ IOStatus WritableFileWriter::WriteBuffered(const char* data, size_t size) {
         auto prev_perf_level = GetPerfLevel();
 
         IOSTATS_CPU_TIMER_GUARD(cpu_write_nanos, clock_);
+        WriteStopWatch sw(clock_, stats_, file_write_hist_);
         if (perform_data_verification_) {
           Crc32cHandoffChecksumCalculation(src, allowed, checksum_buf);
           v_info.checksum = Slice(checksum_buf, sizeof(uint32_t));
@@ -510,6 +610,7 @@ IOStatus WritableFileWriter::WriteBuffered(const char* data, size_t size) {
     IOSTATS_ADD(bytes_written, allowed);
     TEST_KILL_RANDOM("WritableFileWriter::WriteBuffered:0");
 
+    next_buffered_write_offset_ += allowed;
     left -= allowed;
     src += allowed;
   }
@@ -559,6 +660,7 @@ IOStatus WritableFileWriter::WriteBufferedWithChecksum(const char* data,
       auto prev_perf_level = GetPerfLevel();
 
       IOSTATS_CPU_TIMER_GUARD(cpu_write_nanos, clock_);
+      WriteStopWatch sw(clock_, stats_, file_write_hist_);
 
       EncodeFixed32(checksum_buf, buffered_data_crc32c_checksum_);
       v_info.checksum = Slice(checksum_buf, sizeof(uint32_t));
@@ -579,6 +681,7 @@ IOStatus WritableFileWriter::WriteBufferedWithChecksum(const char* data,
 
   IOSTATS_ADD(bytes_written, left);
   TEST_KILL_RANDOM("WritableFileWriter::WriteBuffered:0");
+  next_buffered_write_offset_ += left;
 
   // Buffer write is successful, reset the buffer current size to 0 and reset
   // the corresponding checksum value
@@ -587,10 +690,152 @@ IOStatus WritableFileWriter::WriteBufferedWithChecksum(const char* data,
   return s;
 }
 
-void WritableFileWriter::UpdateFileChecksum(const Slice& data) {
-  if (checksum_generator_ != nullptr) {
-    checksum_generator_->Update(data.data(), data.size());
+IOStatus WritableFileWriter::WriteBufferedAsync() {
+  assert(UseAsyncWrites());
+  IOStatus s;
+  if (async_writes_.size() >= kMaxAsyncWrites) {
+    s = WaitForAsyncWrites(async_writes_.front()->offset + 1);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  const size_t size = buf_.CurrentSize();
+  if (rate_limiter_ != nullptr) {
+    // The buffer is written at once, so it waits for all of its tokens
+    size_t left = size;
+    while (left > 0) {
+      left -= rate_limiter_->RequestToken(left, 0 /* alignment */,
+                                          writable_file_->GetIOPriority(),
+                                          stats_, RateLimiter::OpType::kWrite);
+    }
+  }
+
+  // The write takes buf_ along, and appends continue in a spare buffer
+  std::unique_ptr<AsyncWrite> write(new AsyncWrite());
+  write->offset = next_buffered_write_offset_;
+  AlignedBuffer next_buf;
+  if (!spare_buffers_.empty()) {
+    next_buf = std::move(spare_buffers_.back());
+    spare_buffers_.pop_back();
+  } else {
+    next_buf.Alignment(buf_.Alignment());
+    next_buf.AllocateNewBuffer(buf_.Capacity());
+  }
+  write->buf = std::move(buf_);
+  buf_ = std::move(next_buf);
+
+  {
+    IOSTATS_TIMER_GUARD(write_nanos);
+    TEST_SYNC_POINT("WritableFileWriter::Flush:BeforeAppend");
+#ifndef ROCKSDB_LITE
+    if (ShouldNotifyListeners()) {
+      write->start_ts = FileOperationInfo::StartNow();
+    }
+#endif
+    auto prev_perf_level = GetPerfLevel();
+    IOSTATS_CPU_TIMER_GUARD(cpu_write_nanos, clock_);
+    AsyncWrite* w = write.get();
+    if (ShouldTimeWrites(clock_, stats_)) {
+      w->start_micros = clock_->NowMicros();
+    }
+    s = writable_file_->AppendAsync(
+        Slice(w->buf.BufferStart(), size), IOOptions(),
+        [](const IOStatus& status, void* arg) {
+          static_cast<AsyncWrite*>(arg)->status = status;
+        },
+        w, &w->io_handle, &w->del_fn, nullptr);
+    SetPerfLevel(prev_perf_level);
+  }
+  if (!s.ok()) {
+    // Not submitted; the data stays in buf_
+    spare_buffers_.push_back(std::move(buf_));
+    buf_ = std::move(write->buf);
+    return s;
+  }
+
+  IOSTATS_ADD(bytes_written, size);
+  TEST_KILL_RANDOM("WritableFileWriter::WriteBuffered:0");
+  next_buffered_write_offset_ += size;
+  const bool completed = write->io_handle == nullptr;
+  async_writes_.push_back(std::move(write));
+  if (completed) {
+    // AppendAsync() wrote the data synchronously
+    s = WaitForAsyncWrites();
+  }
+  return s;
+}
+
+IOStatus WritableFileWriter::WaitForAsyncWrites(uint64_t offset) {
+  while (!async_writes_.empty() && async_writes_.front()->offset < offset) {
+    AsyncWrite* w = async_writes_.front().get();
+    if (w->io_handle != nullptr) {
+      std::vector<void*> io_handles{w->io_handle};
+      IOStatus s = writable_file_->Poll(io_handles, 1 /* min_completions */);
+      if (!s.ok() && w->status.ok()) {
+        w->status = s;
+      }
+      w->del_fn(w->io_handle);
+    }
+    if (ShouldTimeWrites(clock_, stats_)) {
+      RecordWriteLatency(stats_, file_write_hist_,
+                         clock_->NowMicros() - w->start_micros);
+    }
+#ifndef ROCKSDB_LITE
+    if (ShouldNotifyListeners()) {
+      NotifyOnFileWriteFinish(w->offset, w->buf.CurrentSize(), w->start_ts,
+                              FileOperationInfo::FinishNow(), w->status);
+    }
+#endif
+    if (!w->status.ok() && async_write_status_.ok()) {
+      async_write_status_ = w->status;
+      async_write_status_.PermitUncheckedError();
+    }
+    w->status.PermitUncheckedError();
+    w->buf.Clear();
+    spare_buffers_.push_back(std::move(w->buf));
+    async_writes_.pop_front();
+  }
+  return async_write_status_;
+}
+
+void WritableFileWriter::UpdateChecksums(const char* data, size_t size,
+                                         bool update_crc32c) {
+  if (!update_crc32c && checksum_generator_ == nullptr) {
+    return;
+  }
+  // Both checksums read each piece while it is still in the CPU cache,
+  // instead of each streaming through all of the data from memory
+  for (size_t offset = 0; offset < size; offset += kChecksumChunkSize) {
+    const char* chunk = data + offset;
+    size_t chunk_size = std::min(kChecksumChunkSize, size - offset);
+    if (update_crc32c) {
+      buffered_data_crc32c_checksum_ = crc32c::Extend(
+          buffered_data_crc32c_checksum_, chunk, chunk_size);
+    }
+    if (checksum_generator_ != nullptr) {
+      checksum_generator_->Update(chunk, chunk_size);
+    }
+  }
+}
+
+size_t WritableFileWriter::AppendToBuffer(const char* data, size_t size,
+                                          bool update_crc32c) {
+  // The checksums are computed over the copy in the buffer one piece at a
+  // time, right after the piece is copied, so that the data is only read
+  // from memory once
+  size_t appended = 0;
+  while (appended < size) {
+    size_t chunk_size = buf_.Append(
+        data + appended, std::min(kChecksumChunkSize, size - appended));
+    if (chunk_size == 0) {
+      break;
+    }
+    UpdateChecksums(buf_.BufferStart() + buf_.CurrentSize() - chunk_size,
+                    chunk_size, update_crc32c);
+    appended += chunk_size;
   }
+  return appended;
 }
 
 // Currently, crc32c checksum is used to calculate the checksum value of the
@@ -657,6 +902,7 @@ IOStatus WritableFileWriter::WriteDirect() {
       if (ShouldNotifyListeners()) {
         start_ts = FileOperationInfo::StartNow();
       }
+      WriteStopWatch sw(clock_, stats_, file_write_hist_);
       // direct writes must be positional
       if (perform_data_verification_) {
         Crc32cHandoffChecksumCalculation(src, size, checksum_buf);
@@ -752,6 +998,7 @@ IOStatus WritableFileWriter::WriteDirectWithChecksum() {
     if (ShouldNotifyListeners()) {
       start_ts = FileOperationInfo::StartNow();
     }
+    WriteStopWatch sw(clock_, stats_, file_write_hist_);
     // direct writes must be positional
     EncodeFixed32(checksum_buf, buffered_data_crc32c_checksum_);
     v_info.checksum = Slice(checksum_buf, sizeof(uint32_t));
@@ -9,7 +9,10 @@
 
 #pragma once
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "db/version_edit.h"
 #include "env/file_system_tracer.h"
@@ -33,6 +36,8 @@ class SystemClock;
 // - Flush and Sync the data to the underlying filesystem.
 // - Notify any interested listeners on the completion of a write.
 // - Update IO stats.
+// - Keep buffered writes in flight with FSWritableFile::AppendAsync() when
+//   FileOptions::use_async_writes is set.
 class WritableFileWriter {
  private:
 #ifndef ROCKSDB_LITE
@@ -117,9 +122,21 @@ class WritableFileWriter {
 #endif  // ROCKSDB_LITE
 
   bool ShouldNotifyListeners() const { return !listeners_.empty(); }
-  void UpdateFileChecksum(const Slice& data);
+  // The size of the pieces checksums are computed on, small enough for a
+  // piece to stay in the L1 cache between the copy and the checksums
+  static constexpr size_t kChecksumChunkSize = 16 << 10;
+
+  // Updates the file checksum, and buffered_data_crc32c_checksum_ if
+  // `update_crc32c`, with `size` bytes of `data`.
+  void UpdateChecksums(const char* data, size_t size, bool update_crc32c);
+  // Copies as much of `data` into buf_ as fits, updating the checksums as
+  // UpdateChecksums() does, and returns the number of bytes copied.
+  size_t AppendToBuffer(const char* data, size_t size, bool update_crc32c);
   void Crc32cHandoffChecksumCalculation(const char* data, size_t size,
                                         char* buf);
+  // The *_FILE_WRITE_MICROS histogram of the type of file `file_name` is,
+  // or HISTOGRAM_ENUM_MAX if none
+  static uint32_t FileWriteHistogram(const std::string& file_name);
 
   std::string file_name_;
   FSWritableFilePtr writable_file_;
@@ -140,6 +157,7 @@ class WritableFileWriter {
   uint64_t bytes_per_sync_;
   RateLimiter* rate_limiter_;
   Statistics* stats_;
+  uint32_t file_write_hist_;
   std::vector<std::shared_ptr<EventListener>> listeners_;
   std::unique_ptr<FileChecksumGenerator> checksum_generator_;
   bool checksum_finalized_;
@@ -147,6 +165,34 @@ class WritableFileWriter {
   uint32_t buffered_data_crc32c_checksum_;
   bool buffered_data_with_checksum_;
 
+  // A write submitted with FSWritableFile::AppendAsync(), and the buffer it
+  // writes from
+  struct AsyncWrite {
+    AlignedBuffer buf;
+    uint64_t offset = 0;
+    void* io_handle = nullptr;
+    IOHandleDeleter del_fn;
+    IOStatus status;
+    // When submitted, if write latencies are recorded
+    uint64_t start_micros = 0;
+#ifndef ROCKSDB_LITE
+    FileOperationInfo::StartTimePoint start_ts;
+#endif
+  };
+  // The most writes a writer keeps in flight
+  static constexpr size_t kMaxAsyncWrites = 4;
+
+  bool use_async_writes_;
+  // Where the next write of buffered I/O starts
+  uint64_t next_buffered_write_offset_;
+  // Oldest first
+  std::deque<std::unique_ptr<AsyncWrite>> async_writes_;
+  // Buffers of completed async writes, for buf_ to continue in
+  std::vector<AlignedBuffer> spare_buffers_;
+  // The first error of an async write. Returned by every later Flush(),
+  // Sync() and Close().
+  IOStatus async_write_status_;
+
  public:
   WritableFileWriter(
       std::unique_ptr<FSWritableFile>&& file, const std::string& _file_name,
@@ -171,12 +217,15 @@ class WritableFileWriter {
         bytes_per_sync_(options.bytes_per_sync),
         rate_limiter_(options.rate_limiter),
         stats_(stats),
+        file_write_hist_(FileWriteHistogram(_file_name)),
         listeners_(),
         checksum_generator_(nullptr),
         checksum_finalized_(false),
         perform_data_verification_(perform_data_verification),
         buffered_data_crc32c_checksum_(0),
-        buffered_data_with_checksum_(buffered_data_with_checksum) {
+        buffered_data_with_checksum_(buffered_data_with_checksum),
+        use_async_writes_(options.use_async_writes),
+        next_buffered_write_offset_(0) {
     TEST_SYNC_POINT_CALLBACK("WritableFileWriter::WritableFileWriter:0",
                              reinterpret_cast<void*>(max_buffer_size_));
     buf_.Alignment(writable_file_->GetRequiredBufferAlignment());
@@ -263,6 +312,17 @@ class WritableFileWriter {
   // Normal write
   IOStatus WriteBuffered(const char* data, size_t size);
   IOStatus WriteBufferedWithChecksum(const char* data, size_t size);
+  // Async writes are only used for buffered I/O without checksum handoff,
+  // which AppendAsync() does not take.
+  bool UseAsyncWrites() {
+    return use_async_writes_ && !use_direct_io() && !perform_data_verification_;
+  }
+  // Submits the contents of buf_ with AppendAsync() and moves buf_ on to a
+  // spare buffer.
+  IOStatus WriteBufferedAsync();
+  // Waits for the async writes that start before `offset`, and recycles
+  // their buffers.
+  IOStatus WaitForAsyncWrites(uint64_t offset = port::kMaxUint64);
   IOStatus RangeSync(uint64_t offset, uint64_t nbytes);
   IOStatus SyncInternal(bool use_fsync);
 };
@@ -16,8 +16,10 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class Cache;
 class Slice;
 class SliceTransform;
+class Statistics;
 class TablePropertiesCollectorFactory;
 class TableFactory;
 struct Options;
@@ -54,6 +56,11 @@ enum CompactionPri : char {
   // and its size is the smallest. It in many cases can optimize write
   // amplification.
   kMinOverlappingRatio = 0x3,
+  // First compact files that the most reads per byte had to look up, as
+  // sampled in FileMetaData::stats, so that frequently read key ranges move
+  // down and reads of them go through fewer levels. Files read equally often
+  // are ordered as with kMinOverlappingRatio.
+  kHotnessAware = 0x4,
 };
 
 struct CompactionOptionsFIFO {
@@ -70,6 +77,20 @@ struct CompactionOptionsFIFO {
   // Default: false;
   bool allow_compaction = false;
 
+  // If non-zero, compact files by time window, for time series data. Each
+  // file is bucketed into the window of this many seconds that holds the
+  // time of its oldest data (see TableProperties::creation_time), and
+  // compactions only merge L0 files of the same window: the files of a past
+  // window are merged into one file, and the newest files of the current
+  // window are merged once there are options.level0_file_num_compaction_trigger
+  // of them no larger than about write_buffer_size. With a
+  // ttl, a file is only dropped once its whole window is older than the ttl,
+  // so windows are dropped as a whole. This keeps the number of files about
+  // the number of windows within the ttl, without rewriting old data again.
+  // Replaces the intra-L0 compactions of allow_compaction.
+  // Default: 0 (disabled)
+  uint64_t time_window_seconds = 0;
+
   CompactionOptionsFIFO() : max_table_files_size(1 * 1024 * 1024 * 1024) {}
   CompactionOptionsFIFO(uint64_t _max_table_files_size, bool _allow_compaction)
       : max_table_files_size(_max_table_files_size),
@@ -164,6 +185,17 @@ struct CompressionOptions {
   // Default: 0 (unlimited)
   uint64_t max_dict_buffer_bytes;
 
+  // If non-zero, the dictionary built for an SST file of the block-based
+  // table format is reused by the following files of the same column family
+  // and output level for this many seconds, instead of each file buffering
+  // data and training its own. Every file still stores the dictionary it is
+  // compressed with. Readers share one digested ZSTD dictionary among the
+  // files with the same dictionary, so this also saves memory and CPU at
+  // table open.
+  //
+  // Default: 0 (a dictionary per file)
+  uint64_t max_dict_reuse_seconds;
+
   CompressionOptions()
       : window_bits(-14),
         level(kDefaultCompressionLevel),
@@ -172,7 +204,8 @@ struct CompressionOptions {
         zstd_max_train_bytes(0),
         parallel_threads(1),
         enabled(false),
-        max_dict_buffer_bytes(0) {}
+        max_dict_buffer_bytes(0),
+        max_dict_reuse_seconds(0) {}
   CompressionOptions(int wbits, int _lev, int _strategy,
                      uint32_t _max_dict_bytes, uint32_t _zstd_max_train_bytes,
                      uint32_t _parallel_threads, bool _enabled,
@@ -184,7 +217,8 @@ struct CompressionOptions {
         zstd_max_train_bytes(_zstd_max_train_bytes),
         parallel_threads(_parallel_threads),
         enabled(_enabled),
-        max_dict_buffer_bytes(_max_dict_buffer_bytes) {}
+        max_dict_buffer_bytes(_max_dict_buffer_bytes),
+        max_dict_reuse_seconds(0) {}
 };
 
 // Temperature of a file. Used to pass to FileSystem for a different
@@ -279,6 +313,16 @@ struct AdvancedColumnFamilyOptions {
   //   * new sizeof(new_value) <= sizeof(existing_value)
   //   * existing_value for that key is a put i.e. kTypeValue
   // If inplace_callback function is set, check doc for inplace_callback.
+  // Merge(key, operand) will combine operand inplace with the existing
+  // operand, using MergeOperator::PartialMerge() (e.g. of an
+  // AssociativeMergeOperator), iff
+  //   * the latest entry of key in the current memtable is a merge operand
+  //   * the combined operand is no larger than the existing one
+  //   * the current memtable has no range deletions
+  // which keeps a single entry per key in the memtable for e.g. counters.
+  // With allow_concurrent_memtable_write, writers of different keys update the
+  // memtable in parallel, Merge() is always out-of-place, and inplace_callback
+  // and unordered_write are not supported.
   // Default: false.
   bool inplace_update_support = false;
 
@@ -361,6 +405,51 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t memtable_huge_page_size = 0;
 
+  // If non-zero, Get() keeps up to about this many recent results in a small
+  // cache of the column family's current memtables and files, and returns a
+  // cached result instead of looking the key up again until a write to the
+  // key (or a range deletion) or a flush or compaction invalidates it. Helps
+  // read workloads where a few hot keys are read much more often than they
+  // are written. Results with values larger than 4KB are not cached.
+  //
+  // Not used with user-defined timestamps, inplace_update_support,
+  // unordered_write or two_write_queues, nor for reads with a ReadCallback
+  // (e.g. transactions), ignore_range_deletions or a read_tier other than
+  // kReadAllTier. A new value takes effect from the next memtable.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t memtable_hot_key_cache_size = 0;
+
+  // If non-zero, memtable values of at least this many bytes are stored apart
+  // from the memtable entries (skip list nodes) holding their keys, in arena
+  // blocks of their own. Memtable lookups and iteration then only touch the
+  // values they return, and entries stay packed in fewer cache lines and
+  // pages. Each such value costs about 14 bytes more.
+  //
+  // Not used with inplace_update_support. A new value takes effect from the
+  // next memtable.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t memtable_large_value_threshold = 0;
+
+  // If larger than write_buffer_size, the size of each new memtable adapts to
+  // the write rate of the column family, between write_buffer_size and this
+  // size. A memtable that filled up is followed by one twice as large, so
+  // that a busy column family flushes fewer and larger L0 files. A memtable
+  // switched while less than half full (e.g. by the write buffer manager, by
+  // max_total_wal_size or by a manual flush) is followed by one half as large.
+  // With a write buffer manager, memtables grow to at most half of its
+  // buffer size.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t max_adaptive_write_buffer_size = 0;
+
   // If non-nullptr, memtable will use the specified function to extract
   // prefixes for keys, and for each prefix maintain a hint of insert location
   // to reduce CPU usage for inserting keys with the prefix. Keys out of
@@ -575,6 +664,19 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   uint64_t max_compaction_bytes = 0;
 
+  // If true, leveled compaction also cuts output files where the key range
+  // moves past a file of the level below the output level, once the output
+  // file is at least half of its target size. The threshold rises by 5% of
+  // the target size for every such boundary the output file already spans,
+  // up to 90%. Files then end where the files they will be compacted with
+  // end, so that fewer of them overlap each future compaction, at the cost
+  // of output files between half and the whole of the target size.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool level_compaction_dynamic_file_size = false;
+
   // All writes will be slowed down to at least delayed_write_rate if estimated
   // bytes needed to be compaction exceed this threshold.
   //
@@ -591,6 +693,22 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   uint64_t hard_pending_compaction_bytes_limit = 256 * 1073741824ull;
 
+  // If positive, writes are throttled gradually once the estimated pending
+  // compaction bytes exceed this fraction of
+  // soft_pending_compaction_bytes_limit, instead of running at full speed until
+  // the soft limit is hit. The delayed write rate follows the ingest rate that
+  // the recently observed compaction throughput can sustain without growing
+  // the debt, and is lowered further the closer the debt gets to the soft
+  // limit. The estimate is available via the
+  // "rocksdb.estimated-sustainable-write-rate" property. Has no effect when
+  // soft_pending_compaction_bytes_limit is 0 or disable_auto_compactions is
+  // true. Values >= 1 disable it.
+  //
+  // Dynamically changeable through SetOptions() API
+  //
+  // Default: 0 (disabled)
+  double pending_compaction_bytes_slowdown_start_ratio = 0.0;
+
   // The compaction style. Default: kCompactionStyleLevel
   CompactionStyle compaction_style = kCompactionStyleLevel;
 
@@ -663,6 +781,110 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t max_successive_merges = 0;
 
+  // If non-zero, a Get() without a snapshot that has to fold more than this
+  // many merge operands into the value of a key writes the result back as a
+  // Put, so that later reads of the key (and compactions) stop at it instead
+  // of merging the same operands again. This bounds the read cost of keys,
+  // e.g. counters, that receive merges faster than compaction collapses
+  // them. The write-back is skipped if the key was written since it was read,
+  // and never waits for a write stall. As any write, it counts as a conflict
+  // for transactions that read the key.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t merge_operands_collapse_threshold = 0;
+
+  // If true, the merging iterator that combines memtables and SST files
+  // for DB iterators and compaction inputs picks the next key during
+  // forward iteration with a tournament (loser) tree instead of a binary
+  // heap. Each step then costs exactly one comparison per tree level,
+  // which tends to win when many children interleave, e.g. iterators
+  // over many L0 files or many levels. The heap stays faster when long
+  // runs of consecutive keys come from the same child, since it needs
+  // a single comparison to confirm the top is unchanged. Reverse
+  // iteration always uses the heap.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API. Applies to
+  // iterators and compactions created afterwards.
+  bool use_loser_tree_merging_iterator = false;
+
+  // If true, a flush whose key range overlaps no file in L0 writes its
+  // output directly into the lowest level it can be placed in, the way
+  // IngestExternalFile() places ingested files: the level above the
+  // first level with an overlapping file, or the last level if there
+  // is none. This avoids the L0 build-up and the L0->L1 rewrite for
+  // workloads whose keys do not overlap older data, such as
+  // monotonically increasing keys.
+  //
+  // Only applied with kCompactionStyleLevel, and only when the flush
+  // includes the oldest unflushed memtable of the column family. Output
+  // files are built with the L0 table and compression settings even
+  // when they are placed in a lower level.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool flush_to_lowest_nonoverlapping_level = false;
+
+  // Weight of this column family in the memory budget of a
+  // WriteBufferManager created with FlushVictimPolicy::kWeightedShare.
+  // Each column family of a DB is entitled to the fraction
+  // weight / (sum of the weights) of the budget. When the budget is
+  // exceeded, the column family whose memtables use the most memory
+  // relative to that share is flushed, instead of the one with the
+  // oldest memtable. Must be positive.
+  //
+  // Default: 1.0
+  //
+  // Dynamically changeable through SetOptions() API
+  double write_buffer_share_weight = 1.0;
+
+  // Memtable memory this column family is guaranteed before the write
+  // buffer manager picks it as a flush victim. Only used when the
+  // WriteBufferManager is created with FlushVictimPolicy::kWeightedShare.
+  // A column family using less than this is only flushed for the write
+  // buffer manager when no other column family can be.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t write_buffer_min_share_bytes = 0;
+
+  // Maximum number of key-range partitions a single flush is split into.
+  // When greater than 1, a large flush divides the key range of its
+  // memtables into partitions holding roughly equal numbers of entries
+  // and builds one L0 file per partition in parallel. All output files
+  // are installed in the same version edit and do not overlap each other.
+  // Each partition holds at least 8MB of memtable data, so small flushes
+  // still produce a single file.
+  //
+  // Partitioning is only applied with kCompactionStyleLevel and is
+  // skipped for flushes that contain range deletions. Note that every
+  // partition counts as a separate file toward the L0 compaction and
+  // write stall triggers.
+  //
+  // Default: 1 (no partitioning)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t max_flush_partitions = 1;
+
+  // If true, a flush split by max_flush_partitions only cuts its key range
+  // where a file of the base level (usually L1) starts, so that no output
+  // file partially overlaps a base level file. L0 compactions into the base
+  // level then pick fewer files and are more often trivial moves. Each cut
+  // is made at the first base level file boundary past an equal share of
+  // the entries, so partitions may be uneven, and fewer than planned if the
+  // base level has few files. Without base level files, the flush is split
+  // as if this were false.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool align_flush_partitions_to_base_level = false;
+
   // This flag specifies that the implementation should optimize the filters
   // mainly for cases where keys are found rather than also optimize for keys
   // missed. This would be used in cases where the application knows that
@@ -679,6 +901,20 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool optimize_filters_for_hits = false;
 
+  // If non-zero, Get() stops checking the full filters of the table files in
+  // a level after they were checked this many times in a row without ruling
+  // out a key, for example because the key of nearly every lookup exists in
+  // the level, or because its prefixes are all in the prefix filters. The
+  // filters of the level are checked again once every this many lookups, so
+  // that they are used again as soon as they rule out a key. The checks and
+  // keys ruled out by the filters of each kind in each level are reported
+  // by the "rocksdb.filter-stats" property.
+  //
+  // Default: 0 (filters are always checked)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint64_t skip_filters_after_unhelpful_checks = 0;
+
   // During flush or compaction, check whether keys inserted to output files
   // are in order.
   //
@@ -778,6 +1014,22 @@ struct AdvancedColumnFamilyOptions {
   // and users need to plug in their own FileSystem to take advantage of it.
   Temperature bottommost_temperature = Temperature::kUnknown;
 
+  // EXPERIMENTAL
+  // If non-zero, and bottommost_temperature is set, bottommost files are
+  // moved between bottommost_temperature and the temperature of the other
+  // files (kUnknown) according to how often they are read. A file read at
+  // least this many times per hour per MB of its size since it was written,
+  // as estimated from sampled reads (see SstFileMetaData::num_reads_sampled),
+  // is rewritten without bottommost_temperature by a compaction with
+  // CompactionReason::kChangeTemperature. A bottommost file without
+  // bottommost_temperature that is at least an hour old and read less than
+  // half as often is rewritten with it. Only supported by level compaction.
+  //
+  // Default: 0 (files keep the temperature they were written with)
+  //
+  // Dynamically changeable through the SetOptions() API
+  uint64_t bottommost_hot_file_read_rate = 0;
+
   // When set, large values (blobs) are written to separate blob files, and
   // only pointers to them are stored in SST files. This can reduce write
   // amplification for large-value use cases at the cost of introducing a level
@@ -820,6 +1072,34 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   CompressionType blob_compression_type = kNoCompression;
 
+  // If non-zero, blob files are compressed with a dictionary of up to this
+  // many bytes, which makes compression effective for values too small to
+  // compress well on their own. The dictionary is built from the first blobs
+  // written to the blob files of a flush or compaction (about 100 times its
+  // size); for ZSTD it is trained on them with ZSTD's dictionary trainer if
+  // available. It is stored in each blob file it is used for, so blob files
+  // written with this option cannot be read by RocksDB versions that do not
+  // support it. Only has an effect for compression types that support
+  // dictionaries. Note that enable_blob_files has to be set in order for
+  // this option to have any effect.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through the SetOptions() API
+  uint32_t blob_compression_max_dict_bytes = 0;
+
+  // If greater than 1, flushes and compactions compress the values they
+  // write to blob files on this many worker threads, reading ahead in their
+  // input to compress the upcoming values while earlier ones are written.
+  // The blob files are the same as with a single thread. Not used together
+  // with blob_compression_max_dict_bytes. Note that enable_blob_files has to
+  // be set in order for this option to have any effect.
+  //
+  // Default: 1
+  //
+  // Dynamically changeable through the SetOptions() API
+  uint32_t blob_compression_parallel_threads = 1;
+
   // Enables garbage collection of blobs. Blob GC is performed as part of
   // compaction. Valid blobs residing in blob files older than a cutoff get
   // relocated to new files as they are encountered during compaction, which
@@ -842,6 +1122,75 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   double blob_garbage_collection_age_cutoff = 0.25;
 
+  // If the ratio of garbage in a blob file that garbage collection may
+  // relocate blobs from (see blob_garbage_collection_age_cutoff) reaches this
+  // threshold, the SST files that reference the blob file are compacted in
+  // place, so that its remaining live blobs are relocated and the file can
+  // be deleted. Such compactions are scheduled even if the key range of the
+  // files sees no writes. Their I/O is limited by DBOptions::rate_limiter,
+  // like that of other compactions. A value of 1.0 disables these
+  // compactions. Note that enable_blob_garbage_collection has to be set in
+  // order for this option to have any effect. This option is currently only
+  // supported with leveled compaction.
+  //
+  // Default: 1.0
+  //
+  // Dynamically changeable through the SetOptions() API
+  double blob_garbage_collection_force_threshold = 1.0;
+
+  // If non-zero, the blobs that garbage collection relocates are written to
+  // separate "cold" blob files of up to this size, apart from the values a
+  // compaction stores in blob files for the first time. Relocated blobs have
+  // outlived the blob files they were written to, and are likely to live on,
+  // while new blobs include many that are soon overwritten. Keeping them in
+  // separate files makes the cold files accumulate little garbage, so
+  // garbage collection rewrites the long-lived blobs less often. Note that
+  // enable_blob_garbage_collection has to be set in order for this option to
+  // have any effect.
+  //
+  // Default: 0 (relocated blobs share blob files with new ones)
+  //
+  // Dynamically changeable through the SetOptions() API
+  uint64_t cold_blob_file_size = 0;
+
+  // EXPERIMENTAL
+  // The temperature passed to the FileSystem for the cold blob files written
+  // with cold_blob_file_size set. Should be no-op for default FileSystem.
+  Temperature cold_blob_file_temperature = Temperature::kUnknown;
+
+  // If non-nullptr, blobs read from blob files are kept in this cache,
+  // uncompressed, and later reads of the same blobs are served from it. It
+  // can be the block cache (BlockBasedTableOptions::block_cache), so that
+  // blobs and blocks compete for the same memory; the blobs are then
+  // accounted as their own CacheEntryRole in the block cache entry
+  // statistics. Reads with ReadOptions::fill_cache = false, and compactions,
+  // use the cache but do not add to it.
+  //
+  // Default: nullptr (disabled)
+  std::shared_ptr<Cache> blob_cache = nullptr;
+
+  // If non-nullptr, the tickers and histograms of this column family's
+  // operations are recorded here in addition to DBOptions::statistics:
+  // Get() latency, keys and bytes read and written, block cache hits and
+  // misses, and flush and compaction I/O. This shows which column family
+  // drives DB-wide numbers. Operations that span column families, such as
+  // DB::Write() latency and write stalls, are only recorded DB-wide. Can be
+  // shared by several column families, and can be set without
+  // DBOptions::statistics.
+  //
+  // Default: nullptr (disabled)
+  std::shared_ptr<Statistics> cf_statistics = nullptr;
+
+  // If true, blob files are read with direct I/O, bypassing the OS page
+  // cache, even if DBOptions::use_direct_reads is false. Blob values are
+  // usually large and read once, so caching them in the page cache mostly
+  // evicts the SST blocks and metadata kept there. Blob files are written
+  // with direct I/O if DBOptions::use_direct_io_for_flush_and_compaction is
+  // set. Not compatible with DBOptions::allow_mmap_reads.
+  //
+  // Default: false
+  bool use_direct_reads_for_blob_files = false;
+
   // Create ColumnFamilyOptions with default values for all fields
   AdvancedColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
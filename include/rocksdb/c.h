@@ -438,6 +438,18 @@ extern ROCKSDB_LIBRARY_API void rocksdb_multi_get_cf(
     const size_t* keys_list_sizes, char** values_list,
     size_t* values_list_sizes, char** errs);
 
+// Looks up keys of one column family through the batched lookup path of
+// DB::MultiGet(), without copying the values: values[i] is set to a
+// rocksdb_pinnableslice_t, to be freed with rocksdb_pinnableslice_destroy(),
+// or to NULL if keys_list[i] is not found or on error. errs[i] is set as for
+// rocksdb_multi_get(). sorted_input tells that keys_list is sorted already.
+extern ROCKSDB_LIBRARY_API void rocksdb_batched_multi_get_cf(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, size_t num_keys,
+    const char* const* keys_list, const size_t* keys_list_sizes,
+    rocksdb_pinnableslice_t** values, char** errs,
+    unsigned char sorted_input);
+
 // The value is only allocated (using malloc) and returned if it is found and
 // value_found isn't NULL. In that case the user is responsible for freeing it.
 extern ROCKSDB_LIBRARY_API unsigned char rocksdb_key_may_exist(
@@ -577,6 +589,15 @@ extern ROCKSDB_LIBRARY_API const char* rocksdb_iter_value(
     const rocksdb_iterator_t*, size_t* vlen);
 extern ROCKSDB_LIBRARY_API void rocksdb_iter_get_error(
     const rocksdb_iterator_t*, char** errptr);
+// Copies the entries from the current one on back to back into keys_buf and
+// values_buf, with their sizes in key_sizes and value_sizes, and moves the
+// iterator past them. Stops at the end of the iteration, after max_entries
+// entries or at the first entry that does not fit. Returns the number of
+// entries copied.
+extern ROCKSDB_LIBRARY_API size_t rocksdb_iter_next_batch(
+    rocksdb_iterator_t*, size_t max_entries, char* keys_buf,
+    size_t keys_buf_size, size_t* key_sizes, char* values_buf,
+    size_t values_buf_size, size_t* value_sizes);
 
 extern ROCKSDB_LIBRARY_API void rocksdb_wal_iter_next(rocksdb_wal_iterator_t* iter);
 extern ROCKSDB_LIBRARY_API unsigned char rocksdb_wal_iter_valid(
@@ -26,7 +26,9 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "rocksdb/compression_type.h"
 #include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
@@ -93,6 +95,33 @@ struct LRUCacheOptions {
   // A SecondaryCache instance to use a the non-volatile tier
   std::shared_ptr<SecondaryCache> secondary_cache;
 
+  // If true, each shard keeps a small TinyLFU-style frequency sketch of
+  // recently accessed keys, and once the shard is full a new low-priority
+  // entry is only admitted if it was accessed more often than the LRU entry
+  // it would evict. This keeps one-time scans from flushing the working set.
+  // A rejected insert still succeeds; with a handle, the caller gets a
+  // private entry that is freed on release. Per-role admitted/rejected counts
+  // are reported in the "rocksdb.block-cache-entry-stats" DB property.
+  bool use_frequency_admission = false;
+
+  // If true, lookups of entries in the cache and the release of their
+  // handles do not take the shard mutex, so that readers of hot blocks do
+  // not contend on it. Instead of moving an entry to the MRU end of the LRU
+  // list on every lookup, a lookup marks the entry accessed, and eviction
+  // moves marked entries there before considering them again. Capacity and
+  // strict_capacity_limit are enforced as before, except that releasing the
+  // last handle of an entry in an over-capacity cache no longer frees it
+  // right away; the next insert does. Has no effect with a secondary_cache
+  // or use_frequency_admission, which need the mutex.
+  bool lock_free_lookup = false;
+
+  // With num_shard_bits = -1, the cache has as many shards as it can give
+  // at least min_shard_size bytes each, up to 64 or, on machines with more
+  // than 32 cores, twice the number of cores. A smaller value spreads
+  // smaller caches over more shards, so that threads contend less on the
+  // shard mutexes; each shard has a fixed overhead of under 1KB.
+  size_t min_shard_size = 512 * 1024;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -116,7 +145,8 @@ struct LRUCacheOptions {
 // set percentage of the cache reserves for high priority entries via
 // high_pri_pool_pct.
 // num_shard_bits = -1 means it is automatically determined: every shard
-// will be at least 512KB and number of shard bits will not exceed 6.
+// will be at least 512KB and number of shard bits will not exceed 6 (or
+// more on machines with many cores, see LRUCacheOptions::min_shard_size).
 extern std::shared_ptr<Cache> NewLRUCache(
     size_t capacity, int num_shard_bits = -1,
     bool strict_capacity_limit = false, double high_pri_pool_ratio = 0.5,
@@ -127,19 +157,89 @@ extern std::shared_ptr<Cache> NewLRUCache(
 
 extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
 
-// Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
-// better concurrent performance in some cases. See util/clock_cache.cc for
-// more detail.
-//
-// Return nullptr if it is not supported.
+struct CompressedSecondaryCacheOptions : LRUCacheOptions {
+  // The compression method (if any) that is used to compress data.
+  CompressionType compression_type = CompressionType::kLZ4Compression;
+
+  // compress_format_version can have two values:
+  // compress_format_version == 1 -- decompressed size is not included in the
+  // block header.
+  // compress_format_version == 2 -- decompressed size is included in the block
+  // header in varint32 format.
+  uint32_t compress_format_version = 2;
+
+  CompressedSecondaryCacheOptions() {}
+  CompressedSecondaryCacheOptions(
+      size_t _capacity, int _num_shard_bits, bool _strict_capacity_limit,
+      double _high_pri_pool_ratio,
+      std::shared_ptr<MemoryAllocator> _memory_allocator = nullptr,
+      bool _use_adaptive_mutex = kDefaultToAdaptiveMutex,
+      CacheMetadataChargePolicy _metadata_charge_policy =
+          kDefaultCacheMetadataChargePolicy,
+      CompressionType _compression_type = CompressionType::kLZ4Compression,
+      uint32_t _compress_format_version = 2)
+      : LRUCacheOptions(_capacity, _num_shard_bits, _strict_capacity_limit,
+                        _high_pri_pool_ratio, std::move(_memory_allocator),
+                        _use_adaptive_mutex, _metadata_charge_policy),
+        compression_type(_compression_type),
+        compress_format_version(_compress_format_version) {}
+};
+
+// Create a new SecondaryCache that keeps the entries demoted from a block
+// cache compressed in memory, in an LRU cache of the given capacity. Lookups
+// decompress the entry, which is usually much cheaper than reading the block
+// from storage, and remove it from this cache, since it is then promoted to
+// the block cache. Entries that do not compress (or whose compression type
+// is not supported in this build) are kept uncompressed.
+// The other parameters are the same as for NewLRUCache().
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    size_t capacity, int num_shard_bits = -1,
+    bool strict_capacity_limit = false, double high_pri_pool_ratio = 0.5,
+    std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+    bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+    CacheMetadataChargePolicy metadata_charge_policy =
+        kDefaultCacheMetadataChargePolicy,
+    CompressionType compression_type = CompressionType::kLZ4Compression,
+    uint32_t compress_format_version = 2);
+
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts);
+
+// Similar to NewLRUCache, but create a cache based on the CLOCK algorithm,
+// without any locks, which scales better than LRUCache with many threads
+// reading from the cache concurrently. See cache/clock_cache.cc for more
+// detail.
 //
-// BROKEN: ClockCache is known to have bugs that could lead to crash or
-// corruption, so should not be used until fixed. Use NewLRUCache instead.
+// Each shard keeps its entries in a fixed-size hash table, sized for its
+// capacity divided by `estimated_entry_charge`. If the entries are much
+// smaller than estimated, the table fills up and entries are evicted before
+// the cache reaches its capacity; if they are much larger, memory is wasted
+// on unused table slots. For a block cache, the block size is a reasonable
+// estimate.
 extern std::shared_ptr<Cache> NewClockCache(
     size_t capacity, int num_shard_bits = -1,
     bool strict_capacity_limit = false,
     CacheMetadataChargePolicy metadata_charge_policy =
-        kDefaultCacheMetadataChargePolicy);
+        kDefaultCacheMetadataChargePolicy,
+    size_t estimated_entry_charge = 4 * 1024);
+
+// Activity of one shard of a cache, since the cache was created.
+struct CacheShardStats {
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
+  uint64_t inserts = 0;
+  // Operations that had to wait for the shard mutex held by another thread
+  uint64_t lock_contentions = 0;
+  size_t usage = 0;
+  size_t capacity = 0;
+};
+
+// Returns the indexes of the shards with at least `min_ratio` times the
+// mean number of lookups or lock contentions of all the shards. Keys that
+// are looked up much more often than others make their shards hot, which
+// more shards (num_shard_bits) only partly helps.
+extern std::vector<size_t> FindHotCacheShards(
+    const std::vector<CacheShardStats>& shard_stats, double min_ratio = 2.0);
 
 class Cache {
  public:
@@ -385,6 +485,12 @@ class Cache {
 
   virtual std::string GetPrintableOptions() const { return ""; }
 
+  // Replaces *stats with the activity of each shard of the cache, for caches
+  // that are split into shards by key hash, or clears it.
+  virtual void GetShardStats(std::vector<CacheShardStats>* stats) const {
+    stats->clear();
+  }
+
   MemoryAllocator* memory_allocator() const { return memory_allocator_.get(); }
 
   // EXPERIMENTAL
@@ -14,11 +14,11 @@
 #include <vector>
 
 #include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
 #include "rocksdb/types.h"
 
 namespace ROCKSDB_NAMESPACE {
 
-class Slice;
 class SliceTransform;
 
 // CompactionFilter allows an application to modify/delete a key-value during
@@ -177,6 +177,40 @@ class CompactionFilter {
     return Decision::kKeep;
   }
 
+  // A key-value FilterBatch() decides on, with the arguments and the results
+  // of the FilterV2() call it stands for.
+  struct BatchEntry {
+    Slice key;
+    ValueType value_type = ValueType::kValue;
+    Slice existing_value;
+    Decision decision = Decision::kKeep;
+    std::string new_value;
+    std::string skip_until;
+  };
+
+  // The number of key-values the table file creation process reads ahead to
+  // have FilterBatch() decide on the values among them at once, or 0 to
+  // invoke FilterV2() on each value. A filter with a costly lookup per key
+  // can amortize it over a batch.
+  virtual size_t GetFilterBatchSize() const { return 0; }
+
+  // Decides on a batch of key-values as FilterV2() would on each of them, by
+  // setting their `decision`, `new_value` and `skip_until`. The entries are
+  // in key order and have ValueType::kValue. They are the ones FilterV2()
+  // would be invoked on, except that a decision may go unused, e.g. for a
+  // key skipped by an earlier kRemoveAndSkipUntil of the batch. Merge
+  // operands, blob references, and values of keys with user-defined
+  // timestamps or not yet committed in a TransactionDB still go through
+  // FilterV2(), so the two must decide alike.
+  // The default implementation invokes FilterV2() on each entry.
+  virtual void FilterBatch(int level, std::vector<BatchEntry>* entries) const {
+    for (BatchEntry& entry : *entries) {
+      entry.decision =
+          FilterV2(level, entry.key, entry.value_type, entry.existing_value,
+                   &entry.new_value, &entry.skip_until);
+    }
+  }
+
   // Internal (BlobDB) use only. Do not override in application code.
   virtual BlobDecision PrepareBlobOutput(const Slice& /* key */,
                                          const Slice& /* existing_value */,
@@ -90,6 +90,14 @@ struct CompactionJobStats {
   // Time spent on preparing file write (fallocate, etc)
   uint64_t file_prepare_write_nanos;
 
+  // Time spent reading from files. With file_read_bytes it gives the
+  // compaction's read throughput.
+  uint64_t file_read_nanos;
+
+  // The number of bytes read from files (table and blob files, including
+  // readahead). Populated regardless of report_bg_io_stats.
+  uint64_t file_read_bytes;
+
   // 0-terminated strings storing the first 8 bytes of the smallest and
   // largest key in the output.
   static const size_t kMaxPrefixLength = 8;
@@ -33,6 +33,10 @@ enum CompressionType : unsigned char {
   // eventually remove the option from the public API.
   kZSTDNotFinalCompression = 0x40,
 
+  // Compressed with ColumnFamilyOptions::compressor, see
+  // rocksdb/compressor.h
+  kCustomCompression = 0x41,
+
   // kDisableCompressionOption is used to disable some compression options.
   kDisableCompressionOption = 0xff,
 };
@@ -0,0 +1,50 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/customizable.h"
+#include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct ConfigOptions;
+
+// A compression algorithm provided by the application, e.g. one offloading
+// the work to a hardware accelerator. The SST blocks and blobs of a column
+// family whose compression type is kCustomCompression are compressed with
+// ColumnFamilyOptions::compressor. The files only record that a custom
+// compressor was used, so every process reading them must be configured
+// with a compressor of the same format.
+//
+// Compress() and Uncompress() are called concurrently from many threads.
+// With CompressionOptions::parallel_threads > 1 the data blocks of one SST
+// file are compressed by several threads at once, so that an accelerator
+// can have that many requests in flight for every file being written.
+class Compressor : public Customizable {
+ public:
+  ~Compressor() override {}
+
+  static const char* Type() { return "Compressor"; }
+  static Status CreateFromString(const ConfigOptions& config_options,
+                                 const std::string& id,
+                                 std::shared_ptr<Compressor>* result);
+
+  // Appends the compressed `input` to `*output`. On failure the data is
+  // stored uncompressed.
+  virtual Status Compress(const Slice& input, std::string* output) = 0;
+
+  // Uncompresses `input`, which Compress() produced from `uncompressed_size`
+  // bytes, into `output`, which has room for exactly that many bytes.
+  virtual Status Uncompress(const Slice& input, char* output,
+                            size_t uncompressed_size) = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -495,6 +495,27 @@ class DB {
       GetMergeOperandsOptions* get_merge_operands_options,
       int* number_of_operands) = 0;
 
+  // GetMergeOperands() of num_keys keys of one column family, all read at
+  // the same point in time. The merge operands of keys[i] are returned in
+  // merge_operands[i * expected_max_number_of_operands] onwards, their number
+  // in number_of_operands[i] and the status in statuses[i], as
+  // GetMergeOperands() would return them.
+  // merge_operands- Points to an array of at least num_keys *
+  //             merge_operands_options.expected_max_number_of_operands.
+  virtual void MultiGetMergeOperands(
+      const ReadOptions& options, ColumnFamilyHandle* column_family,
+      const size_t num_keys, const Slice* keys, PinnableSlice* merge_operands,
+      GetMergeOperandsOptions* get_merge_operands_options,
+      int* number_of_operands, Status* statuses) {
+    const size_t max_operands = static_cast<size_t>(
+        get_merge_operands_options->expected_max_number_of_operands);
+    for (size_t i = 0; i < num_keys; ++i) {
+      statuses[i] = GetMergeOperands(
+          options, column_family, keys[i], merge_operands + i * max_operands,
+          get_merge_operands_options, number_of_operands + i);
+    }
+  }
+
   // Consistent Get of many keys across column families without the need
   // for an explicit snapshot. NOTE: the implementation of this MultiGet API
   // does not have the performance benefits of the void-returning MultiGet
@@ -936,6 +957,13 @@ class DB {
     //  "rocksdb.is-write-stopped" - Return 1 if write has been stopped.
     static const std::string kIsWriteStopped;
 
+    //  "rocksdb.estimated-sustainable-write-rate" - returns the estimated
+    //      ingest rate in bytes/sec that compaction of the column family
+    //      can keep up with without growing the pending compaction bytes,
+    //      based on recent flushes and compactions. 0 means no estimate yet.
+    //      See pending_compaction_bytes_slowdown_start_ratio.
+    static const std::string kEstimatedSustainableWriteRate;
+
     //  "rocksdb.estimate-oldest-key-time" - returns an estimation of
     //      oldest key timestamp in the DB. Currently only available for
     //      FIFO compaction with
@@ -953,9 +981,38 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    //  "rocksdb.block-cache-miss-ratio-curve" - returns a multi-line string
+    //      or map with the miss ratios estimated for each capacity simulated
+    //      by the block cache, if it is a MissRatioCurveCache (see
+    //      NewMissRatioCurveCache()).
+    static const std::string kBlockCacheMissRatioCurve;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
+
+    //  "rocksdb.compaction-debt-forecast" - returns a multi-line string or
+    //      map forecasting the pending compaction bytes of the column family
+    //      from the ingest and compaction throughput of its recent flushes
+    //      and compactions: the current "pending-compaction-bytes", the
+    //      "ingest-bytes-per-sec", "compaction-bytes-per-sec" and
+    //      "pending-compaction-bytes-per-sec" rates, the
+    //      "projected-pending-compaction-bytes.{1m,5m,15m}", the
+    //      "seconds-to-{soft,hard}-pending-compaction-bytes-limit",
+    //      "seconds-to-l0-{slowdown,stop}" and their minimum
+    //      "seconds-to-stall" (0 if already reached, -1 if not approaching),
+    //      and the "required-compaction-bytes-per-sec" at which the pending
+    //      compaction bytes would stop growing.
+    static const std::string kCompactionDebtForecast;
+
+    //  "rocksdb.filter-stats" - returns a multi-line string or map with, for
+    //      each level of the column family, how many times Get() checked the
+    //      whole key filters ("L<n>.whole-key-checked") and the prefix
+    //      filters ("L<n>.prefix-checked") of its table files, how many of
+    //      these checks ruled out the key ("L<n>.whole-key-useful",
+    //      "L<n>.prefix-useful"), and how many lookups skipped the filters
+    //      because of skip_filters_after_unhelpful_checks ("L<n>.skipped").
+    static const std::string kFilterStats;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -1012,6 +1069,7 @@ class DB {
   //  "rocksdb.num-running-flushes"
   //  "rocksdb.actual-delayed-write-rate"
   //  "rocksdb.is-write-stopped"
+  //  "rocksdb.estimated-sustainable-write-rate"
   //  "rocksdb.estimate-oldest-key-time"
   //  "rocksdb.block-cache-capacity"
   //  "rocksdb.block-cache-usage"
@@ -1087,6 +1145,62 @@ class DB {
     GetApproximateMemTableStats(DefaultColumnFamily(), range, count, size);
   }
 
+  // For each i in [0,n-1], store in "counts[i]" the approximate number of
+  // entries with keys in "[range[i].start .. range[i].limit)" in a single
+  // column family. Entries include overwritten and deleted versions of keys
+  // that compaction has not dropped yet, so the count is an upper bound of
+  // the number of live keys in the range.
+  //
+  // SST files whose table has a key position summary (see
+  // BlockBasedTableOptions::key_position_samples) are estimated from it in
+  // memory; other files pro-rate their number of entries by the approximate
+  // size of the range in the file.
+  virtual Status GetApproximateKeyCounts(
+      const SizeApproximationOptions& /*options*/,
+      ColumnFamilyHandle* /*column_family*/, const Range* /*ranges*/,
+      int /*n*/, uint64_t* /*counts*/) {
+    return Status::NotSupported("GetApproximateKeyCounts() is not implemented.");
+  }
+
+  // Splits the user keys in [*begin, *end) of a column family into up to
+  // num_ranges ranges holding about the same amount of SST data, e.g. to
+  // scan them in parallel (see rocksdb/utilities/parallel_scan.h). A null
+  // begin or end means the start or end of the key space.
+  //
+  // On success, *split_keys holds fewer than num_ranges user keys, in
+  // increasing order and strictly inside (*begin, *end). Range i is then
+  // [split_keys[i - 1], split_keys[i]), with *begin and *end standing in
+  // for the missing ends of the first and last range. The estimate samples
+  // the SST files' index blocks, which may cause I/O; memtable data is not
+  // taken into account. Fewer splits are returned when there is too little
+  // data to tell ranges apart.
+  virtual Status GetKeyRangeSplits(ColumnFamilyHandle* /*column_family*/,
+                                   const Slice* /*begin*/,
+                                   const Slice* /*end*/, size_t /*num_ranges*/,
+                                   std::vector<std::string>* /*split_keys*/) {
+    return Status::NotSupported("GetKeyRangeSplits() is not implemented.");
+  }
+
+  // Writes the locations of the data blocks of this DB's live SST files that
+  // are currently in the block cache to the file `dump_path`, so that
+  // WarmUpBlockCache() can load the same blocks again, e.g. after a restart.
+  // Files are identified by an ID that is stable across DB instances, and
+  // blocks by their offset; block contents are not saved.
+  virtual Status DumpBlockCacheHotSet(const std::string& /*dump_path*/) {
+    return Status::NotSupported("DumpBlockCacheHotSet() is not implemented.");
+  }
+
+  // Loads the data blocks listed in a file written by DumpBlockCacheHotSet()
+  // into the block cache, skipping those of files that are no longer live.
+  // The blocks of each file are read in file order, and nearby blocks with a
+  // single read of up to read_options.readahead_size bytes (2MB if 0), so
+  // the cache can quickly reach its steady state right after DB::Open(). It
+  // may be called from another thread while the DB serves requests.
+  virtual Status WarmUpBlockCache(const ReadOptions& /*read_options*/,
+                                  const std::string& /*dump_path*/) {
+    return Status::NotSupported("WarmUpBlockCache() is not implemented.");
+  }
+
   // Deprecated versions of GetApproximateSizes
   ROCKSDB_DEPRECATED_FUNC virtual void GetApproximateSizes(
       const Range* range, int n, uint64_t* sizes, bool include_memtable) {
@@ -95,6 +95,20 @@ struct EnvOptions {
   // If true, then use O_DIRECT for writing data
   bool use_direct_writes = false;
 
+  // If true, then the file's writer may submit writes with
+  // FSWritableFile::AppendAsync() and keep several of them in flight
+  bool use_async_writes = false;
+
+  // If true, open the file with O_DSYNC, so that every write reaches stable
+  // storage before it returns and the file does not need to be synced
+  bool use_dsync_writes = false;
+
+  // If true together with use_mmap_writes, map the file with MAP_SYNC where
+  // the file system supports it (persistent memory mounted with DAX), and
+  // sync written data by writing back CPU cache lines instead of calling
+  // msync() and fdatasync()
+  bool use_pmem_writes = false;
+
   // If false, fallocate() calls are bypassed
   bool allow_fallocate = true;
 
@@ -433,8 +447,11 @@ class Env {
 
   static std::string PriorityToString(Priority priority);
 
-  // Priority for requesting bytes in rate limiter scheduler
-  enum IOPriority { IO_LOW = 0, IO_HIGH = 1, IO_TOTAL = 2 };
+  // Priority for requesting bytes in rate limiter scheduler. IO_USER is for
+  // user reads (see ReadOptions::rate_limiter_priority), which are granted
+  // bytes before requests of the other priorities. IO_TOTAL means not rate
+  // limited.
+  enum IOPriority { IO_LOW = 0, IO_HIGH = 1, IO_USER = 2, IO_TOTAL = 3 };
 
   // Arrange to run "(*function)(arg)" once in a background thread, in
   // the thread pool specified by pri. By default, jobs go to the 'LOW'
@@ -556,6 +573,15 @@ class Env {
   // Lower CPU priority for threads from the specified pool.
   virtual void LowerThreadPoolCPUPriority(Priority /*pool*/ = LOW) {}
 
+  // Make threads from the specified pool run on the CPUs of the given NUMA
+  // node, and allocate memory from it when they can. The flushes or
+  // compactions they run then keep their buffers on that node. -1 lets the
+  // threads run on any node again.
+  virtual Status SetThreadPoolNumaNode(Priority /*pool*/, int /*node*/) {
+    return Status::NotSupported(
+        "Env::SetThreadPoolNumaNode(Priority, int) not supported");
+  }
+
   // Converts seconds-since-Jan-01-1970 to a printable string
   virtual std::string TimeToString(uint64_t time) = 0;
 
@@ -1510,6 +1536,10 @@ class EnvWrapper : public Env {
     return target_->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolNumaNode(Priority pool, int node) override {
+    return target_->SetThreadPoolNumaNode(pool, node);
+  }
+
   std::string TimeToString(uint64_t time) override {
     return target_->TimeToString(time);
   }
@@ -73,6 +73,8 @@ class BlockCipher : public Customizable {
   // @param value  The value might be:
   //   - ROT13         Create a ROT13 Cipher
   //   - ROT13:nn      Create a ROT13 Cipher with block size of nn
+  //   - AES:<hex key> Create an AES Cipher with the given 16, 24 or 32 byte
+  //                   key (requires building with OpenSSL)
   // @param result The new cipher object
   // @return OK if the cipher was successfully created
   // @return NotFound if an invalid name was specified in the value
@@ -87,6 +89,15 @@ class BlockCipher : public Customizable {
   // production!!!
   static std::shared_ptr<BlockCipher> NewROT13Cipher(size_t block_size);
 
+  // Short-cut method to create an AES BlockCipher. The key must be 16, 24 or
+  // 32 bytes long, selecting AES-128, AES-192 or AES-256. The cipher is
+  // implemented with OpenSSL, which uses the AES-NI or ARMv8 crypto
+  // instructions where available.
+  // @return NotSupported if RocksDB was built without OpenSSL
+  // @return InvalidArgument if the key length is not valid
+  static Status NewAESCipher(const std::string& key,
+                             std::shared_ptr<BlockCipher>* result);
+
   // BlockSize returns the size of each block supported by this cipher stream.
   virtual size_t BlockSize() = 0;
 
@@ -97,6 +108,13 @@ class BlockCipher : public Customizable {
   // Decrypt a block of data.
   // Length of data is equal to BlockSize().
   virtual Status Decrypt(char* data) = 0;
+
+  // Encrypt num_blocks consecutive blocks of data in place, each of them
+  // independently of the others. Length of data is equal to
+  // num_blocks * BlockSize(). Ciphers that can process several blocks at
+  // once (e.g. pipelined AES instructions) should override this; the
+  // default calls Encrypt() for every block.
+  virtual Status EncryptBlocks(char* data, size_t num_blocks);
 };
 
 // The encryption provider is used to create a cipher stream for a specific
@@ -51,6 +51,11 @@ struct ConfigOptions;
 using AccessPattern = RandomAccessFile::AccessPattern;
 using FileAttributes = Env::FileAttributes;
 
+// Deleter for the opaque io_handle a FileSystem returns from
+// FSRandomAccessFile::ReadAsync(). The caller owns io_handle and destroys it
+// with this function once the request has completed or has been aborted.
+using IOHandleDeleter = std::function<void(void*)>;
+
 // Priority of an IO request. This is a hint and does not guarantee any
 // particular QoS.
 // IO_LOW - Typically background reads/writes such as compaction/flush
@@ -90,7 +95,34 @@ struct IOOptions {
   // Type of data being read/written
   IOType type;
 
-  IOOptions() : timeout(0), prio(IOPriority::kIOLow), type(IOType::kUnknown) {}
+  // How far apart, and up to what size, RandomAccessFileReader::MultiRead()
+  // merges buffered reads; see ReadOptions::multiread_coalesce_max_size
+  size_t coalesce_max_gap;
+  size_t coalesce_max_size;
+
+  // When RandomAccessFileReader::Read() issues a second read if the first
+  // one is slow; see ReadOptions::hedged_read_percentile
+  double hedge_percentile;
+  std::chrono::microseconds hedge_min_delay;
+
+  // Set on the second read of a hedged read. A FileSystem may serve it from
+  // another replica than the first one.
+  bool is_hedged_read;
+
+  // Priority of the read in the rate limiter of the reader, if any; see
+  // ReadOptions::rate_limiter_priority
+  Env::IOPriority rate_limiter_priority;
+
+  IOOptions()
+      : timeout(0),
+        prio(IOPriority::kIOLow),
+        type(IOType::kUnknown),
+        coalesce_max_gap(0),
+        coalesce_max_size(0),
+        hedge_percentile(0),
+        hedge_min_delay(0),
+        is_hedged_read(false),
+        rate_limiter_priority(Env::IO_TOTAL) {}
 };
 
 // File scope options that control how a file is opened/created and accessed
@@ -598,6 +630,34 @@ class FileSystem {
                                const IOOptions& options, bool* is_dir,
                                IODebugContext* /*dgb*/) = 0;
 
+  // EXPERIMENTAL
+  // Waits for the reads submitted through FSRandomAccessFile::ReadAsync()
+  // that returned the given io_handles, and invokes their callbacks. Returns
+  // only after the callbacks of at least min_completions of them have run;
+  // implementations may choose to wait for all of them. Poll() must be called
+  // from the thread that submitted the requests.
+  //
+  // A read may complete with fewer bytes than requested; it is up to the
+  // caller to issue another read for the rest.
+  //
+  // Default implementation returns OK, which matches the default
+  // ReadAsync() that completes every request before returning.
+  virtual IOStatus Poll(std::vector<void*>& /*io_handles*/,
+                        size_t /*min_completions*/) {
+    return IOStatus::OK();
+  }
+
+  // EXPERIMENTAL
+  // Aborts the reads submitted through FSRandomAccessFile::ReadAsync() that
+  // returned the given io_handles. When it returns, the file system no
+  // longer touches the requests' buffers, and their callbacks are not
+  // invoked.
+  //
+  // Default implementation returns OK.
+  virtual IOStatus AbortIO(std::vector<void*>& /*io_handles*/) {
+    return IOStatus::OK();
+  }
+
   // If you're adding methods here, remember to add them to EnvWrapper too.
 
  private:
@@ -736,6 +796,33 @@ class FSRandomAccessFile {
     return IOStatus::OK();
   }
 
+  // EXPERIMENTAL
+  // Submits the read described by req (offset, len and scratch) and returns
+  // without waiting for it. Once the read has completed, cb is invoked with
+  // the request, its result and status filled in, and cb_arg. The data must
+  // be read into req.scratch, which, like the file, has to stay alive until
+  // the request has completed or has been aborted.
+  //
+  // An implementation that completes the read asynchronously stores the
+  // context it needs in *io_handle and the function that destroys it in
+  // *del_fn. The caller then passes io_handle to FileSystem::Poll() to wait
+  // for the callback, or to FileSystem::AbortIO() to cancel the read, and
+  // destroys it with del_fn afterwards. If *io_handle is left null the
+  // callback has already run by the time ReadAsync() returns. If a non-OK
+  // status is returned, the request was not submitted and cb is not invoked.
+  //
+  // Default implementation reads the data synchronously and invokes cb
+  // before returning.
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& options,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** /*io_handle*/, IOHandleDeleter* /*del_fn*/, IODebugContext* dbg) {
+    req.status =
+        Read(req.offset, req.len, options, &(req.result), req.scratch, dbg);
+    cb(req, cb_arg);
+    return IOStatus::OK();
+  }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
@@ -870,6 +957,41 @@ class FSWritableFile {
     return IOStatus::NotSupported("PositionedAppend");
   }
 
+  // EXPERIMENTAL
+  // Submits the append of data to the end of the file and returns without
+  // waiting for it. Appends made through AppendAsync() and Append() are
+  // applied in the order they are made. Once the append has completed, cb is
+  // invoked with its status and cb_arg. data has to stay alive until then.
+  //
+  // io_handle and del_fn work as in FSRandomAccessFile::ReadAsync(), except
+  // that the caller waits for the append with Poll() of this file. All
+  // appends must have completed before Sync(), Fsync(), Truncate() or
+  // Close() is called, and before the file is destroyed. If a non-OK status
+  // is returned, the append was not submitted and cb is not invoked.
+  //
+  // Default implementation appends the data synchronously and invokes cb
+  // before returning.
+  virtual IOStatus AppendAsync(const Slice& data, const IOOptions& options,
+                               std::function<void(const IOStatus&, void*)> cb,
+                               void* cb_arg, void** /*io_handle*/,
+                               IOHandleDeleter* /*del_fn*/,
+                               IODebugContext* dbg) {
+    cb(Append(data, options, dbg), cb_arg);
+    return IOStatus::OK();
+  }
+
+  // EXPERIMENTAL
+  // Waits for the appends submitted through AppendAsync() that returned the
+  // given io_handles, and invokes their callbacks, as FileSystem::Poll()
+  // does for reads.
+  //
+  // Default implementation returns OK, which matches the default
+  // AppendAsync() that completes every append before returning.
+  virtual IOStatus Poll(std::vector<void*>& /*io_handles*/,
+                        size_t /*min_completions*/) {
+    return IOStatus::OK();
+  }
+
   // Truncate is necessary to trim the file to the correct size
   // before closing. It is not always possible to keep track of the file
   // size due to whole pages writes. The behavior is undefined if called
@@ -1333,6 +1455,13 @@ class FileSystemWrapper : public FileSystem {
                        bool* is_dir, IODebugContext* dbg) override {
     return target_->IsDirectory(path, options, is_dir, dbg);
   }
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override {
+    return target_->Poll(io_handles, min_completions);
+  }
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    return target_->AbortIO(io_handles);
+  }
 
  private:
   std::shared_ptr<FileSystem> target_;
@@ -1385,6 +1514,13 @@ class FSRandomAccessFileWrapper : public FSRandomAccessFile {
                     IODebugContext* dbg) override {
     return target_->Prefetch(offset, n, options, dbg);
   }
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& options,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override {
+    return target_->ReadAsync(req, options, cb, cb_arg, io_handle, del_fn,
+                              dbg);
+  }
   size_t GetUniqueId(char* id, size_t max_size) const override {
     return target_->GetUniqueId(id, max_size);
   };
@@ -1428,6 +1564,17 @@ class FSWritableFileWrapper : public FSWritableFile {
     return target_->PositionedAppend(data, offset, options, verification_info,
                                      dbg);
   }
+  IOStatus AppendAsync(const Slice& data, const IOOptions& options,
+                       std::function<void(const IOStatus&, void*)> cb,
+                       void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                       IODebugContext* dbg) override {
+    return target_->AppendAsync(data, options, std::move(cb), cb_arg,
+                                io_handle, del_fn, dbg);
+  }
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override {
+    return target_->Poll(io_handles, min_completions);
+  }
   IOStatus Truncate(uint64_t size, const IOOptions& options,
                     IODebugContext* dbg) override {
     return target_->Truncate(size, options, dbg);
@@ -1551,6 +1698,44 @@ class FSDirectoryWrapper : public FSDirectory {
   FSDirectory* target_;
 };
 
+// How the Posix FileSystem sets up the io_uring that MultiRead() reads
+// through where io_uring is available. Each thread calling MultiRead() gets
+// its own ring.
+struct IOUringOptions {
+  // Submission queue entries of each ring. Larger MultiRead() batches are
+  // split.
+  unsigned int queue_depth = 256;
+
+  // If true, the files read are registered with the ring, so that the kernel
+  // does not look up and reference the file for every read. A ring holds up
+  // to num_registered_files files and replaces the least recently read one
+  // when full. A registered file stays open in the kernel until it is
+  // replaced, which may delay freeing the space of a deleted file.
+  bool register_files = false;
+  unsigned int num_registered_files = 64;
+
+  // If both are non-zero, each ring registers num_fixed_buffers buffers of
+  // fixed_buffer_size bytes with the kernel. Requests of up to
+  // fixed_buffer_size bytes are read into one of them and copied to their
+  // scratch, which saves mapping the scratch pages for every read. Mostly
+  // useful with direct reads.
+  size_t fixed_buffer_size = 0;
+  unsigned int num_fixed_buffers = 0;
+
+  // If true, a kernel thread polls the submission queue of each ring
+  // (IORING_SETUP_SQPOLL), so that submitting reads takes no system call
+  // while it is awake. It goes to sleep after sq_thread_idle_ms without
+  // submissions. Implies register_files. A regular ring is used if the
+  // kernel refuses to create one.
+  bool sqpoll = false;
+  unsigned int sq_thread_idle_ms = 1000;
+};
+
+// Returns a Posix FileSystem whose MultiRead() uses io_uring as `options`
+// asks. Only available on Posix platforms.
+extern std::shared_ptr<FileSystem> NewPosixFileSystem(
+    const IOUringOptions& options);
+
 // A utility routine: write "data" to the named file.
 extern IOStatus WriteStringToFile(FileSystem* fs, const Slice& data,
                                   const std::string& fname,
@@ -139,6 +139,15 @@ struct FilterBuildingContext {
 
   // Reason for creating the file with the filter
   TableFileCreationReason reason = TableFileCreationReason::kMisc;
+
+  // Estimated total size in bytes of the SST files in each level of the
+  // column family's LSM tree once the flush or compaction creating the
+  // table is installed, or empty if unknown or N/A as in SstFileWriter.
+  // Each level 0 file is a sorted run of its own; see num_level0_files.
+  std::vector<uint64_t> level_bytes;
+
+  // Estimated number of level 0 files, along with level_bytes
+  int num_level0_files = 0;
 };
 
 // We add a new format of filter block called full filter block
@@ -261,13 +270,33 @@ extern const FilterPolicy* NewBloomFilterPolicy(
 // keys in a single filter (one SST file without partitioned filters),
 // 3GB of temporary, untracked memory is used, vs. 1GB for Bloom.
 // However, the savings in filter space from just ~60 open SST files
-// makes up for the additional temporary memory use.
+// makes up for the additional temporary memory use. That temporary memory
+// can be charged to the block cache with
+// BlockBasedTableOptions::reserve_table_builder_memory.
 //
 // Also consider using optimize_filters_for_memory to save filter
 // memory.
 extern const FilterPolicy* NewRibbonFilterPolicy(
     double bloom_equivalent_bits_per_key);
 
+// Like NewBloomFilterPolicy(average_bits_per_key), or
+// NewRibbonFilterPolicy(average_bits_per_key) with use_ribbon, but chooses
+// bits per key for each new SST file from the shape of the LSM tree at the
+// time, rather than using the same for all files. For the same total
+// filter memory, this minimizes the sum of FP rates over all sorted runs,
+// i.e. the expected number of unnecessary reads for a key not in the DB
+// (as in the "Monkey" paper). Files in small sorted runs (level 0 and
+// upper levels) get more bits per key and files in the largest levels
+// fewer, so that the average over all of the data stays about
+// average_bits_per_key. The allocation follows the tree as it grows, as
+// compaction rewrites files. Where the shape is unknown (e.g.
+// SstFileWriter), average_bits_per_key is used.
+//
+// Requires format_version >= 5 for fractional bits per key; otherwise
+// each file's bits per key is rounded to a whole number.
+extern const FilterPolicy* NewLevelOptimizedFilterPolicy(
+    double average_bits_per_key, bool use_ribbon = false);
+
 // Old name
 inline const FilterPolicy* NewExperimentalRibbonFilterPolicy(
     double bloom_equivalent_bits_per_key) {
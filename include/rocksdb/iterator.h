@@ -19,6 +19,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "rocksdb/cleanable.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
@@ -89,6 +90,23 @@ class Iterator : public Cleanable {
   // satisfied without doing some IO, then this returns Status::Incomplete().
   virtual Status status() const = 0;
 
+  // Reads up to max_entries consecutive entries starting at the current one
+  // and moves past them, with the same results as calling key(), value()
+  // and Next() in a loop, but without a trip through the whole iterator
+  // stack for each entry. Stops early once the keys and values read add up
+  // to at least max_bytes (0 means no limit), or when the iterator becomes
+  // invalid.
+  //
+  // *keys and *values are cleared and then receive one slice per entry.
+  // Entries that the iterator has pinned (see ReadOptions::pin_data) are
+  // returned in place; the others are copied into *buf, which is overwritten.
+  // The slices stay valid until *buf is modified or the iterator is deleted.
+  // Returns status() as of the end of the batch.
+  // REQUIRES: max_entries > 0
+  virtual Status NextBatch(size_t max_entries, size_t max_bytes,
+                           std::vector<Slice>* keys,
+                           std::vector<Slice>* values, std::string* buf);
+
   // If supported, renew the iterator to represent the latest state. The
   // iterator will be invalidated after the call. Not supported if
   // ReadOptions.snapshot is given when creating the iterator.
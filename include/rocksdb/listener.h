@@ -15,6 +15,8 @@
 #include "rocksdb/compaction_job_stats.h"
 #include "rocksdb/compression_type.h"
 #include "rocksdb/customizable.h"
+#include "rocksdb/iostats_context.h"
+#include "rocksdb/perf_context.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table_properties.h"
 #include "rocksdb/types.h"
@@ -93,6 +95,15 @@ enum class CompactionReason : int {
   kExternalSstIngestion,
   // Compaction due to SST file being too old
   kPeriodicCompaction,
+  // Compaction of the SST files referencing blob files with too much garbage
+  // (see blob_garbage_collection_force_threshold)
+  kForcedBlobGC,
+  // Rewrite of a bottommost file read more or less often than
+  // bottommost_hot_file_read_rate, to change its temperature
+  kChangeTemperature,
+  // [FIFO] merge the files of a time window (see
+  // CompactionOptionsFIFO::time_window_seconds)
+  kFIFOTimeWindow,
   // total number of compaction reasons, new reasons must be added above this.
   kNumOfReasons,
 };
@@ -329,6 +340,36 @@ struct ExternalFileIngestionInfo {
   TableProperties table_properties;
 };
 
+struct CatchUpWithPrimaryInfo {
+  // The result of this round of catching up
+  Status status;
+  // The last sequence number visible to reads afterwards
+  SequenceNumber last_sequence;
+  // Whether new MANIFEST records were applied, changing the LSM tree
+  bool manifest_changed;
+};
+
+enum class SampledRequestType {
+  kGet,
+  kWrite,
+};
+
+struct SampledRequestInfo {
+  // The kind of request
+  SampledRequestType type;
+  // The column family read by a Get(). Empty for a Write(), whose batch can
+  // span column families.
+  std::string cf_name;
+  // The result of the request
+  Status status;
+  // Time the request took
+  uint64_t latency_micros;
+  // The request's counters and timings, collected at
+  // PerfLevel::kEnableTimeExceptForMutex
+  PerfContext perf_context;
+  IOStatsContext iostats_context;
+};
+
 // EventListener class contains a set of callback functions that will
 // be called when specific RocksDB event happens such as flush.  It can
 // be used as a building block for developing custom features such as
@@ -484,6 +525,24 @@ class EventListener : public Customizable {
   virtual void OnExternalFileIngested(
       DB* /*db*/, const ExternalFileIngestionInfo& /*info*/) {}
 
+  // A callback function for RocksDB which will be called when a secondary
+  // instance catching up with the primary in the background (see
+  // DBOptions::secondary_catch_up_period_micros) finishes a round that
+  // applied new changes or failed.
+  //
+  // Note that this function runs on the catching up thread; the next round
+  // starts once it returns.
+  virtual void OnCaughtUpWithPrimary(DB* /*db*/,
+                                     const CatchUpWithPrimaryInfo& /*info*/) {}
+
+  // A callback function for RocksDB which will be called when a request
+  // sampled with DBOptions::perf_context_sample_one_in completes, for
+  // example to export its breakdown as a trace span.
+  //
+  // Note that this function runs on the thread that issued the request,
+  // which waits for it to return, so it should be fast.
+  virtual void OnRequestSampled(const SampledRequestInfo& /*info*/) {}
+
   // A callback function for RocksDB which will be called before setting the
   // background error status to a non-OK value. The new background error status
   // is provided in `bg_error` and can be modified by the callback. E.g., a
@@ -74,4 +74,64 @@ extern Status NewJemallocNodumpAllocator(
     JemallocAllocatorOptions& options,
     std::shared_ptr<MemoryAllocator>* memory_allocator);
 
+struct SlabAllocatorOptions {
+  // Allocations are rounded up to one of this many size classes per
+  // doubling of size, so that at most about 1/size_classes_per_doubling of
+  // an allocation is wasted. Must be between 1 and 16.
+  int size_classes_per_doubling = 8;
+
+  // Allocations (plus a 16 byte header) larger than this are passed to
+  // malloc. Should be somewhat larger than the block size, as blocks are
+  // read with their trailer and some exceed the target size.
+  size_t max_slab_allocation_size = 256 * 1024;
+
+  // Bytes requested from the system at a time for a size class. Each slab
+  // holds at least 8 allocations of its class.
+  size_t slab_size = 2 * 1024 * 1024;
+
+  // Upper bound, approximately, on the freed memory each CPU core keeps for
+  // reuse without synchronizing with the other cores.
+  size_t per_core_cache_size = 1024 * 1024;
+};
+
+struct SlabAllocatorStats {
+  // Sum of the sizes requested by live allocations.
+  uint64_t requested_bytes = 0;
+  // Sum of the sizes actually taken by live allocations, including headers
+  // and rounding up to size classes.
+  uint64_t allocated_bytes = 0;
+  // Memory obtained from the system, for slabs and for allocations larger
+  // than max_slab_allocation_size.
+  uint64_t reserved_bytes = 0;
+
+  // Memory lost to rounding up allocations (internal fragmentation).
+  uint64_t internal_fragmentation_bytes() const {
+    return allocated_bytes - requested_bytes;
+  }
+  // Memory in slabs not taken by live allocations, i.e. kept free for reuse.
+  uint64_t free_bytes() const { return reserved_bytes - allocated_bytes; }
+};
+
+// A MemoryAllocator that serves allocations from slabs, each dedicated to a
+// size class, instead of from the general purpose heap. Freed memory is only
+// reused for allocations of the same size class, so memory of long-lived
+// blocks is not interleaved with that of short-lived allocations of other
+// sizes, which keeps the memory used by the block cache close to its
+// charged usage. UsableSize() includes the rounding up to the size class, so
+// block cache charges do too. Slabs are kept until the allocator is
+// destroyed. Recently freed allocations are cached per CPU core.
+//
+// Typical use is LRUCacheOptions::memory_allocator, through which blocks read
+// by the block-based table reader are allocated.
+class SlabAllocator : public MemoryAllocator {
+ public:
+  const char* Name() const override { return "SlabAllocator"; }
+
+  virtual SlabAllocatorStats GetStats() const = 0;
+};
+
+// Returns nullptr if the options are invalid.
+extern std::shared_ptr<SlabAllocator> NewSlabAllocator(
+    const SlabAllocatorOptions& options = SlabAllocatorOptions());
+
 }  // namespace ROCKSDB_NAMESPACE
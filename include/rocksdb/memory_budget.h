@@ -0,0 +1,96 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// MemoryBudget puts the main memory consumers of one or more DBs under a
+// single limit, a block cache that memtables, table readers' index and
+// filter blocks and table builders' filter construction are all charged
+// to, and moves memory between write buffers and cached blocks as the
+// workload changes.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Statistics;
+class WriteBufferManager;
+struct BlockBasedTableOptions;
+struct DBOptions;
+
+struct MemoryBudgetOptions {
+  // Total memory, in bytes, shared by all the consumers.
+  size_t total_bytes = 0;
+
+  // The cache everything is charged to. Its capacity is set to total_bytes.
+  // If nullptr, an LRU cache is created.
+  std::shared_ptr<Cache> cache = nullptr;
+
+  // The share of total_bytes that memtables may use before flushes are
+  // triggered, initially and at least and at most. Memory that memtables do
+  // not use stays available to the block cache.
+  double initial_write_buffer_ratio = 0.25;
+  double min_write_buffer_ratio = 0.05;
+  double max_write_buffer_ratio = 0.5;
+
+  // The share of total_bytes the write buffer limit moves by in one
+  // Rebalance().
+  double adjustment_ratio = 0.05;
+
+  // How often Rebalance() runs in the background, or 0 to only run it when
+  // called.
+  uint64_t rebalance_period_sec = 60;
+
+  // Statistics of the DBs using the budget. The block cache hit and miss
+  // tickers tell Rebalance() when reads need the memory more than writes;
+  // without them the write buffer limit only grows.
+  std::shared_ptr<Statistics> statistics = nullptr;
+
+  // Above this block cache miss ratio, the write buffer limit is lowered
+  // unless writes are stalling.
+  double max_block_cache_miss_ratio = 0.1;
+
+  // Stall writes rather than letting memtables grow past the write buffer
+  // limit. See WriteBufferManager.
+  bool allow_stall = false;
+};
+
+class MemoryBudget {
+ public:
+  virtual ~MemoryBudget() {}
+
+  // The shared cache, to be used as the block cache of every DB.
+  virtual std::shared_ptr<Cache> cache() const = 0;
+
+  // The manager that memtables of every DB are charged through.
+  virtual std::shared_ptr<WriteBufferManager> write_buffer_manager() const = 0;
+
+  // Uses the shared cache as the block cache and charges index and filter
+  // blocks, and filter construction, to it.
+  virtual void ApplyTo(BlockBasedTableOptions* table_options) const = 0;
+
+  // Charges the memtables of a DB to the budget.
+  virtual void ApplyTo(DBOptions* db_options) const = 0;
+
+  // The current write buffer limit, in bytes.
+  virtual size_t GetWriteBufferLimit() const = 0;
+
+  // Moves adjustment_ratio of the budget towards write buffers if writes
+  // stalled or memtables came close to their limit since the last call, or
+  // towards the block cache if its miss ratio is above
+  // max_block_cache_miss_ratio. Returns the new write buffer limit.
+  virtual size_t Rebalance() = 0;
+};
+
+// Returns nullptr if total_bytes is 0 or the ratios are not in
+// 0 < min <= initial <= max <= 1.
+extern std::shared_ptr<MemoryBudget> NewMemoryBudget(
+    const MemoryBudgetOptions& options);
+
+}  // namespace ROCKSDB_NAMESPACE
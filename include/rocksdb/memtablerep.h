@@ -335,11 +335,18 @@ class SkipListFactory : public MemTableRepFactory {
 //   count: Passed to the constructor of the underlying std::vector of each
 //     VectorRep. On initialization, the underlying array will be at least count
 //     bytes reserved for usage.
+//   sort_threads: Up to how many threads sort the entries when the first
+//     iterator is positioned, e.g. on flush. Each thread sorts a run of at
+//     least 64K entries, and the runs are then merged pairwise in parallel,
+//     so that only large memtables use all of them. 1 sorts on the calling
+//     thread only.
 class VectorRepFactory : public MemTableRepFactory {
   const size_t count_;
+  const size_t sort_threads_;
 
  public:
-  explicit VectorRepFactory(size_t count = 0) : count_(count) {}
+  explicit VectorRepFactory(size_t count = 0, size_t sort_threads = 1)
+      : count_(count), sort_threads_(sort_threads) {}
 
   using MemTableRepFactory::CreateMemTableRep;
   virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
@@ -381,5 +388,18 @@ extern MemTableRepFactory* NewHashLinkListRepFactory(
     bool if_log_bucket_dist_when_flash = true,
     uint32_t threshold_use_skiplist = 256);
 
+// This uses a skip list to store keys, plus a lock-free hash index from each
+// user key to its newest entry. Point lookups start at the indexed entry
+// instead of descending the skip list, and a lookup of a key that is not in
+// the memtable touches only its hash bucket. Concurrent inserts, hinted
+// inserts and ordered iteration are supported as in SkipListFactory. The
+// index costs one pointer per bucket plus 16 bytes per distinct user key,
+// all charged to the memtable.
+// Not compatible with user-defined timestamps or with comparators under
+// which keys that are not bytewise equal compare equal.
+// @bucket_count: number of fixed array buckets of the hash index
+extern MemTableRepFactory* NewHashIndexedSkipListRepFactory(
+    size_t bucket_count = 1000000);
+
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
@@ -68,13 +68,15 @@ struct SstFileMetaData {
         smallest_seqno(0),
         largest_seqno(0),
         num_reads_sampled(0),
+        bytes_read_sampled(0),
         being_compacted(false),
         num_entries(0),
         num_deletions(0),
         temperature(Temperature::kUnknown),
         oldest_blob_file_number(0),
         oldest_ancester_time(0),
-        file_creation_time(0) {}
+        file_creation_time(0),
+        table_reader_memory_usage(0) {}
 
   SstFileMetaData(const std::string& _file_name, uint64_t _file_number,
                   const std::string& _path, size_t _size,
@@ -95,6 +97,7 @@ struct SstFileMetaData {
         smallestkey(_smallestkey),
         largestkey(_largestkey),
         num_reads_sampled(_num_reads_sampled),
+        bytes_read_sampled(0),
         being_compacted(_being_compacted),
         num_entries(0),
         num_deletions(0),
@@ -103,7 +106,8 @@ struct SstFileMetaData {
         oldest_ancester_time(_oldest_ancester_time),
         file_creation_time(_file_creation_time),
         file_checksum(_file_checksum),
-        file_checksum_func_name(_file_checksum_func_name) {}
+        file_checksum_func_name(_file_checksum_func_name),
+        table_reader_memory_usage(0) {}
 
   // File size in bytes.
   size_t size;
@@ -119,6 +123,7 @@ struct SstFileMetaData {
   std::string smallestkey;        // Smallest user defined key in the file.
   std::string largestkey;         // Largest user defined key in the file.
   uint64_t num_reads_sampled;     // How many times the file is read.
+  uint64_t bytes_read_sampled;    // How many bytes reads read from the file.
   bool being_compacted;  // true if the file is currently being compacted.
 
   uint64_t num_entries;
@@ -152,6 +157,12 @@ struct SstFileMetaData {
   // null), file_checksum_func_name is UnknownFileChecksumFuncName, which is
   // "Unknown".
   std::string file_checksum_func_name;
+
+  // Approximate memory held outside the block cache by the open table reader
+  // of this file, i.e. this file's share of
+  // "rocksdb.estimate-table-readers-mem". 0 if the file has no open table
+  // reader. Only filled in by DB::GetLiveFilesMetaData().
+  size_t table_reader_memory_usage;
 };
 
 // The full set of metadata associated with each SST file.
@@ -197,6 +208,11 @@ struct BlobMetaData {
   uint64_t garbage_blob_bytes;
   std::string checksum_method;
   std::string checksum_value;
+  // How many times blobs are read from the file, and how many bytes these
+  // reads read. Like SstFileMetaData::num_reads_sampled, these are estimates
+  // from sampled reads.
+  uint64_t num_reads_sampled = 0;
+  uint64_t bytes_read_sampled = 0;
 };
 
 // Metadata returned as output from ExportColumnFamily() and used as input to
@@ -41,6 +41,7 @@ class Cache;
 class CompactionFilter;
 class CompactionFilterFactory;
 class Comparator;
+class Compressor;
 class ConcurrentTaskLimiter;
 class Env;
 enum InfoLogLevel : unsigned char;
@@ -228,6 +229,14 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // different options for compression algorithms
   CompressionOptions compression_opts;
 
+  // The compressor of kCustomCompression, which must be set if that is the
+  // type chosen by `compression`, `compression_per_level`,
+  // `bottommost_compression` or `blob_compression_type`. Also needed to read
+  // the files written with it. See rocksdb/compressor.h.
+  //
+  // Default: nullptr
+  std::shared_ptr<Compressor> compressor = nullptr;
+
   // Number of files to trigger level-0 compaction. A value <0 means that
   // level-0 compaction will not be triggered by number of files at all.
   //
@@ -377,7 +386,15 @@ enum class MemPurgePolicy : char {
 enum class CompactionServiceJobStatus : char {
   kSuccess,
   kFailure,
-  kUseLocal,  // TODO: Add support for use local compaction
+  // The service cannot run the job, which the primary then runs locally.
+  kUseLocal,
+};
+
+// How far a remote compaction job got, as reported by its CompactionService.
+struct CompactionServiceJobProgress {
+  // Bytes read from the input files and written to the output files so far.
+  uint64_t bytes_read = 0;
+  uint64_t bytes_written = 0;
 };
 
 class CompactionService : public Customizable {
@@ -390,8 +407,11 @@ class CompactionService : public Customizable {
   // Start the compaction with input information, which can be passed to
   // `DB::OpenAndCompact()`.
   // job_id is pre-assigned, it will be reset after DB re-open.
-  // TODO: sub-compaction is not supported, as they will have the same job_id, a
-  // sub-compaction id might be added
+  // A compaction split into subcompactions (see
+  // DBOptions::max_subcompactions) starts one job per key range, with only
+  // the input files overlapping that range. The jobs run in parallel and
+  // their outputs are installed together. The compaction's job id is in the
+  // upper 32 bits of job_id and the subcompaction's index in the lower 32.
   virtual CompactionServiceJobStatus Start(
       const std::string& compaction_service_input, uint64_t job_id) = 0;
 
@@ -400,6 +420,20 @@ class CompactionService : public Customizable {
   virtual CompactionServiceJobStatus WaitForComplete(
       uint64_t job_id, std::string* compaction_service_result) = 0;
 
+  // Reports the progress of a started job. While WaitForComplete() runs, it
+  // is polled as a heartbeat if DBOptions::compaction_service_timeout_ms is
+  // set. The progress is published in the compacting thread's status (see
+  // ThreadStatus). The default reports nothing, which counts as no progress.
+  virtual Status GetProgress(uint64_t /*job_id*/,
+                             CompactionServiceJobProgress* /*progress*/) {
+    return Status::NotSupported();
+  }
+
+  // Asks the service to abandon a job that timed out. WaitForComplete() for
+  // the job has to return soon after; its result is ignored and the
+  // compaction runs locally.
+  virtual void Cancel(uint64_t /*job_id*/) {}
+
   virtual ~CompactionService() {}
 };
 
@@ -516,9 +550,43 @@ struct DBOptions {
 
   // If max_open_files is -1, DB will open all files on DB::Open(). You can
   // use this option to increase the number of threads used to open the files.
+  // RepairDB() also scans table files on this many threads.
   // Default: 16
   int max_file_opening_threads = 16;
 
+  // If true, DB::Open does not open the table files (reading their footers,
+  // index and filter blocks) up front, even if max_open_files is -1. A file
+  // is opened on first access instead, and a background job submitted to the
+  // LOW priority pool opens the files after DB::Open returns: level 0 first,
+  // then the other levels from the top down, until the table cache is full.
+  // Read-only and secondary instances only open files on first access.
+  // This makes DB::Open fast on DBs with many files. Errors opening files,
+  // such as missing or corrupted files, then surface on access rather than
+  // failing DB::Open, and table readers opened this way are not pinned to
+  // the file metadata as those opened by DB::Open are.
+  //
+  // Default: false
+  bool open_table_files_in_background = false;
+
+  // The number of threads DB::VerifyChecksum() and DB::VerifyFileChecksums()
+  // verify files with. Each thread reads whole files sequentially, with a
+  // large readahead unless ReadOptions::readahead_size is set, through
+  // `rate_limiter` if it limits reads.
+  //
+  // Default: 1
+  int max_file_verification_threads = 1;
+
+  // If non-zero, a secondary instance (see DB::OpenAsSecondary()) catches up
+  // with the primary on a background thread this often, in microseconds,
+  // instead of only when TryCatchUpWithPrimary() is called. The thread keeps
+  // reading the WAL the primary writes to, and only lists the WAL directory
+  // for a new one once that WAL has no new records. Listeners are notified
+  // of each round that applies changes or fails through
+  // EventListener::OnCaughtUpWithPrimary(). Ignored by primary instances.
+  //
+  // Default: 0 (disabled)
+  uint64_t secondary_catch_up_period_micros = 0;
+
   // Once write-ahead logs exceed this size, we will start forcing the flush of
   // column families whose memtables are backed by the oldest live WAL file
   // (i.e. the ones that are causing all the space amplification). If set to 0
@@ -675,6 +743,13 @@ struct DBOptions {
   // Default: 1000
   size_t keep_log_file_num = 1000;
 
+  // If true, and info_log is not set, messages are written to the info log
+  // file by a background thread, so that logging threads never wait for it.
+  // Should the file fall behind by several MB, messages below WARN_LEVEL are
+  // dropped, and the number dropped is logged.
+  // Default: false
+  bool async_info_log = false;
+
   // Recycle log files.
   // If non-zero, we will reuse previously written log files for new
   // logs, overwriting the old data.  The value indicates how many
@@ -691,6 +766,18 @@ struct DBOptions {
   // reach the limit of storage capacity.
   uint64_t max_manifest_file_size = 1024 * 1024 * 1024;
 
+  // If non-zero, the manifest file is also rolled over once it has grown
+  // past the snapshot of the DB state it starts with by more than this
+  // percentage, but not before reaching 1MB. Recovery replays the whole
+  // manifest file, so this bounds the time it takes to the time it takes to
+  // load that many times the current state, however often files are added
+  // and removed. Rolling over writes a new snapshot of the state while the
+  // DB mutex is released; version edits logged meanwhile wait for it and are
+  // then written to the new manifest file together.
+  //
+  // Default: 0 (only max_manifest_file_size applies)
+  uint32_t max_manifest_space_amp_pct = 0;
+
   // Number of shards used for table cache.
   int table_cache_numshardbits = 6;
 
@@ -745,6 +832,46 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   bool use_direct_io_for_flush_and_compaction = false;
 
+  // EXPERIMENTAL
+  // Write the table files of background flushes and compactions without
+  // waiting for each write. A file's writer submits its full buffer with
+  // FSWritableFile::AppendAsync() and continues filling another one, with up
+  // to 4 writes in flight, and only waits for them when it needs to: on
+  // Sync(), Close() and before syncing a range of the file (see
+  // bytes_per_sync). The POSIX file system submits the writes through
+  // io_uring where it is available. Not used with direct I/O writes or
+  // `checksum_handoff_file_types` including table files, and has no effect
+  // with file systems that do not implement AppendAsync().
+  //
+  // Default: false
+  bool use_async_writes_for_flush_and_compaction = false;
+
+  // Write WAL files with O_DIRECT and O_DSYNC. Each group commit is written
+  // with a single aligned write, padded to the logical block size, that
+  // reaches stable storage before it returns, so a WAL write bypasses the
+  // page cache and a synced write needs no separate fsync/fdatasync. Best
+  // combined with `recycle_log_file_num`, so the WAL is overwritten in place
+  // without file size metadata updates. Not compatible with
+  // `allow_mmap_writes`. The file system must honor
+  // EnvOptions::use_dsync_writes for synced writes to be durable.
+  //
+  // Default: false
+  bool use_direct_io_for_wal = false;
+
+  // EXPERIMENTAL
+  // Memory map WAL files and append records with memcpy. Meant for a
+  // `wal_dir` on a persistent memory device mounted with DAX: WAL files are
+  // then mapped with MAP_SYNC, and a synced write only writes back the CPU
+  // cache lines it stored to (clwb/clflushopt on x86-64) instead of calling
+  // fdatasync(), which brings the latency of `WriteOptions::sync` writes down
+  // to a few microseconds. Where MAP_SYNC is not supported, synced writes fall
+  // back to msync() and fdatasync(). Use `max_total_wal_size` to keep the WAL
+  // within the capacity of the persistent memory device. Not compatible with
+  // `use_direct_io_for_wal`.
+  //
+  // Default: false
+  bool use_pmem_for_wal = false;
+
   // If false, fallocate() calls are bypassed
   bool allow_fallocate = true;
 
@@ -777,6 +904,29 @@ struct DBOptions {
   // Default: false
   bool persist_stats_to_disk = false;
 
+  // If not zero, every auto_tune_period_sec seconds the DB adjusts
+  // max_background_jobs, compaction_readahead_size, the rate of
+  // `rate_limiter` and the level0_slowdown_writes_trigger of its column
+  // families to its load. When compaction falls behind, they are raised a
+  // step at a time, up to twice the configured values (four times for the
+  // rate limiter); once the DB has kept up for a few periods, they step back
+  // down, never below the configured values. Values changed with
+  // SetOptions() or SetDBOptions() become the new configured values. Every
+  // change is logged to the info log with its reason. A `rate_limiter`
+  // shared with other DBs is adjusted for all of them.
+  // Not supported in ROCKSDB_LITE mode!
+  //
+  // Default: 0 (disabled)
+  unsigned int auto_tune_period_sec = 0;
+
+  // If not zero, the auto-tuner targets a P99 DB::Write() latency under this
+  // many microseconds instead of the highest throughput: while the latency
+  // is above the target and compaction keeps up, background work is stepped
+  // back down right away, as it competes with writes. Needs `statistics`.
+  //
+  // Default: 0 (highest throughput)
+  uint64_t auto_tune_write_p99_micros = 0;
+
   // if not zero, periodically take stats snapshots and store in memory, the
   // memory size for stats snapshots is capped at stats_history_buffer_size
   // Default: 1MB
@@ -856,6 +1006,18 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   size_t compaction_readahead_size = 0;
 
+  // If greater than compaction_readahead_size, the readahead of compaction
+  // input files starts at compaction_readahead_size and doubles with every
+  // read, up to the size of the file and to an equal share of this many bytes
+  // among the compactions reading their inputs at the same time. Large files
+  // read by few compactions then get large reads, without the total
+  // readahead memory growing with the number of compactions.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through SetDBOptions() API.
+  size_t max_compaction_readahead_size = 0;
+
   // This is a maximum buffer size that is used by WinMmapReadableFile in
   // unbuffered disk I/O mode. We need to maintain an aligned buffer for
   // reads. We allow the buffer to grow until the specified value and then
@@ -1013,10 +1175,27 @@ struct DBOptions {
   // Default: false
   bool unordered_write = false;
 
+  // If true, writes with WriteOptions::disableWAL that need no write callback
+  // and contain no Merge skip the write thread: each one allocates its own
+  // sequence numbers, inserts into the memtables concurrently with other such
+  // writes, and waits only to make its sequence numbers visible in order, so
+  // reads keep seeing a consistent point in time. This avoids joining a write
+  // group and the DB mutex on every write of a cache-like workload. A write
+  // falls back to the write thread whenever the DB needs to flush, switch
+  // memtables or stall writes, and other writes block the fast path while
+  // they are being written.
+  //
+  // Requires allow_concurrent_memtable_write, and is incompatible with
+  // enable_pipelined_write and unordered_write. Has no effect with
+  // two_write_queues.
+  //
+  // Default: false
+  bool enable_no_wal_write_fast_path = false;
+
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
   // is implemented only for SkipListFactory.  Concurrent memtable writes
-  // are not compatible with inplace_update_support or filter_deletes.
+  // are not compatible with inplace_callback or filter_deletes.
   // It is strongly recommended to set enable_write_thread_adaptive_yield
   // if you are going to use this feature.
   //
@@ -1057,6 +1236,49 @@ struct DBOptions {
   // Default: 3
   uint64_t write_thread_slow_yield_usec = 3;
 
+  // If non-zero, limits the number of writer threads that may busy-wait
+  // (pause or yield spin) at the same time while synchronizing with the
+  // write batch group leader to this many per CPU core. Writers beyond the
+  // budget block on their mutex right away instead of competing with the
+  // leader for CPU. This mostly helps when the number of writer threads is
+  // much larger than the number of cores.
+  //
+  // Default: 0 (no limit)
+  uint32_t write_thread_spinners_per_core = 0;
+
+  // If non-zero, write batches with at least this many entries are sorted
+  // by key before being inserted into the memtable, so consecutive inserts
+  // reuse the skip list search path of the previous one instead of
+  // descending from the head. Sequence numbers are assigned in batch order
+  // as usual, so the result is identical to unsorted insertion. Batches
+  // containing merges, range deletions or transaction markers, batches with
+  // protection info, and writes with seq_per_batch are inserted unsorted.
+  //
+  // Default: 0 (disabled)
+  size_t memtable_batch_sort_threshold = 0;
+
+  // If true, compactions overlap their I/O with merging. Input files are
+  // read ahead asynchronously (see ReadOptions::async_io), and each finished
+  // output file is synced and closed on a helper thread while the next ones
+  // are being written. Up to 8 output files per subcompaction are synced
+  // concurrently; all of them are durable before the compaction result is
+  // installed. If compaction_readahead_size is 0, it is set to 2MB.
+  //
+  // Default: false
+  bool pipelined_compaction_io = false;
+
+  // If true, compactions copy data blocks of their input files that they
+  // would write out unchanged into their output as they are stored, instead
+  // of decoding, merging and encoding their entries one by one. A block is
+  // copied when no other input file overlaps it and all its entries are
+  // plain values of distinct user keys that merging cannot change. Output
+  // blocks then keep the size and compression of the input blocks. Not used
+  // with compaction filters, blob files, user-defined timestamps, SST
+  // partitioners or a snapshot checker (WritePrepared transactions).
+  //
+  // Default: false
+  bool compaction_copy_unchanged_blocks = false;
+
   // If true, then DB::Open() will not update the statistics used to optimize
   // compaction decision by loading table properties from many files.
   // Turning off this feature will improve DBOpen time especially in
@@ -1079,6 +1301,17 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // If greater than 1, the write batches replayed from the WAL during
+  // recovery are inserted into the memtables by this many threads, in groups,
+  // while the WAL is read ahead on the recovering thread. The memtables end
+  // up the same as with a single thread. Only used with
+  // allow_concurrent_memtable_write, and not with allow_2pc or write-prepared
+  // and write-unprepared transactions. A memtable that fills up during
+  // recovery may grow by up to a group of batches before it is flushed.
+  //
+  // Default: 1
+  uint32_t wal_recovery_threads = 1;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -1163,6 +1396,16 @@ struct DBOptions {
   // file.
   bool manual_wal_flush = false;
 
+  // If not kNoCompression, the payload of WAL records is compressed with a
+  // streaming compression context that is shared by all records of a WAL
+  // file, so that small records benefit from the data of earlier ones.
+  // Supported types are kZSTD (ZSTD 1.4.0+) and kZlibCompression. WAL files
+  // written this way cannot be read by RocksDB versions without WAL
+  // compression support. Not compatible with recycle_log_file_num.
+  //
+  // Default: kNoCompression
+  CompressionType wal_compression = kNoCompression;
+
   // If true, RocksDB supports flushing multiple column families and committing
   // their results atomically to MANIFEST. Note that it is not
   // necessary to set atomic_flush to true if WAL is always enabled since WAL
@@ -1185,6 +1428,19 @@ struct DBOptions {
   // ReadOptions::background_purge_on_iterator_cleanup.
   bool avoid_unnecessary_blocking_io = false;
 
+  // If true, background threads take queued flushes and compactions in order
+  // of how close their column family is to a write stall, instead of in the
+  // order they were queued. Flushes go to the column family with the largest
+  // fraction of max_write_buffer_number unflushed; compactions to the one
+  // with the largest fraction of level0_slowdown_writes_trigger L0 files or
+  // of soft_pending_compaction_bytes_limit pending compaction bytes. Helps
+  // when many column families share the background threads and one of them
+  // would otherwise stall writes while long compactions of the others run.
+  // Has no effect with atomic_flush on flushes.
+  //
+  // Default: false
+  bool prioritize_stall_relieving_work = false;
+
   // Historically DB ID has always been stored in Identity File in DB folder.
   // If this flag is true, the DB ID is written to Manifest file in addition
   // to the Identity file. By doing this 2 problems are solved
@@ -1279,6 +1535,30 @@ struct DBOptions {
   // backward/forward compatibility support for now. Some known issues are still
   // under development.
   std::shared_ptr<CompactionService> compaction_service = nullptr;
+
+  // EXPERIMENTAL
+  // If non-zero, a remote compaction whose progress, as reported by
+  // CompactionService::GetProgress(), does not change for this many
+  // milliseconds is cancelled and run locally instead, so that a stuck or
+  // unavailable worker does not hold up compactions indefinitely.
+  //
+  // Default: 0 (wait for remote compactions to complete)
+  uint64_t compaction_service_timeout_ms = 0;
+
+  // If non-zero, one in this many Get() and Write() requests, picked at
+  // random, is run with PerfContext and IOStatsContext timing enabled. The
+  // breakdown is passed to EventListener::OnRequestSampled(), and the time
+  // sampled Get() requests spent in memtables, filter, index and data
+  // blocks, decompression and file reads is recorded in the SAMPLED_GET_*
+  // histograms of `statistics`. This gives a picture of where requests
+  // spend their time at a fraction of the cost of enabling PerfContext for
+  // all of them. Requests of threads whose PerfLevel is not kDisable are
+  // not sampled, so that their own PerfContext is left alone.
+  //
+  // Not supported in ROCKSDB_LITE mode.
+  //
+  // Default: 0 (disabled)
+  uint32_t perf_context_sample_one_in = 0;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1518,6 +1798,75 @@ struct ReadOptions {
   // Default: std::numeric_limits<uint64_t>::max()
   uint64_t value_size_soft_limit;
 
+  // If true, MultiGet issues asynchronous readahead requests for the data
+  // blocks that the remaining keys need from all the candidate files of a
+  // level before reading any of them, so that the reads of one level overlap
+  // instead of paying one round of storage latency per file. Only blocks
+  // that are not in the block cache are requested, and only index and filter
+  // blocks that are already cached are consulted to find them. This part has
+  // no effect with direct I/O reads or if the FileSystem does not support
+  // Prefetch().
+  //
+  // Iterators that do readahead (explicit readahead_size or the automatic
+  // one) read the next readahead window into a second buffer in the
+  // background, through FSRandomAccessFile::ReadAsync(), while the current
+  // one is consumed. Such an iterator has to be used from the thread that
+  // created it.
+  //
+  // Default: false
+  bool async_io;
+
+  // Get() and MultiGet() return values found in memtables that are at least
+  // this large pinned to the memtable memory, like values pinned to the block
+  // cache, instead of copying them into the PinnableSlice buffer. Until the
+  // PinnableSlice is reset or destroyed it holds a reference that keeps the
+  // memtable, and the files of the version it was read through, alive, so
+  // pinned values should not be held for long and, like iterators, must be
+  // released before the DB is closed. Values that need merging are
+  // always copied, and nothing is pinned with inplace_update_support.
+  //
+  // Default: std::numeric_limits<uint64_t>::max() (values are always copied)
+  uint64_t min_memtable_value_size_to_pin;
+
+  // If multiread_coalesce_max_size is non-zero, the reads MultiGet() issues
+  // for a file without direct I/O are merged when no more than
+  // multiread_coalesce_max_gap bytes lie between them and the merged read is
+  // at most multiread_coalesce_max_size bytes. The bytes in between are read
+  // and discarded. This trades bandwidth for fewer requests, which pays off
+  // on FileSystems where every request has a high fixed cost, such as remote
+  // storage. Direct I/O reads are always merged where their aligned ranges
+  // meet.
+  //
+  // Default: 0 (disabled)
+  size_t multiread_coalesce_max_gap;
+  size_t multiread_coalesce_max_size;
+
+  // If greater than 0, a buffered read of a table file that has not
+  // completed after a delay is issued a second time, and the result of
+  // whichever read completes first is used. The delay is this percentile
+  // (e.g. 99.0) of the latencies of recent such reads in the process, and at
+  // least hedged_read_min_delay. Until enough reads have been seen, the
+  // delay is hedged_read_min_delay, and no read is hedged if that is 0. The
+  // second read is marked with IOOptions::is_hedged_read, so that a
+  // FileSystem may serve it from a replica. Both reads run on a thread pool
+  // shared by the process. Meant for storage with rare, very slow reads,
+  // such as network-attached block storage. Not used with direct I/O or for
+  // compaction reads.
+  //
+  // Default: 0 (disabled)
+  double hedged_read_percentile;
+  std::chrono::microseconds hedged_read_min_delay;
+
+  // The priority the table and blob file reads of this request are charged
+  // at to `DBOptions::rate_limiter`, if it also limits reads (see
+  // RateLimiter::Mode). Env::IO_USER requests are granted before flush and
+  // compaction ones, so background reads and writes yield to foreground
+  // reads when the limit is reached. Env::IO_TOTAL means the reads are not
+  // charged. Reads with a `deadline` or `io_timeout` are never charged.
+  //
+  // Default: Env::IO_TOTAL
+  Env::IOPriority rate_limiter_priority;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -1752,6 +2101,13 @@ struct IngestExternalFileOptions {
   // ingestion. However, if no checksum information is provided with the
   // ingested files, DB will generate the checksum and store in the Manifest.
   bool verify_file_checksum = true;
+  // The number of threads, including the calling one, over which the
+  // per-file work of the ingestion is spread: opening the files and reading
+  // their properties (and block checksums with
+  // verify_checksums_before_ingest), moving or copying them into the DB and
+  // generating their file checksums. Only helps when ingesting many files at
+  // once. Values below 1 are treated as 1.
+  int max_prepare_threads = 1;
 };
 
 enum TraceFilterType : uint64_t {
@@ -1773,6 +2129,13 @@ struct TraceOptions {
   uint64_t sampling_frequency = 1;
   // Note: The filtering happens before sampling.
   uint64_t filter = kTraceFilterNone;
+  // Only used by the IO tracer and the block cache tracer. If true, records
+  // are buffered per thread and written out by a background thread, so that
+  // traced operations do not serialize on a mutex. Records then reach the
+  // trace file in batches and, across threads, out of timestamp order; a
+  // thread's buffered records are written out at least once a second, and
+  // dropped if the background thread falls far behind.
+  bool buffered_write = false;
 };
 
 // ImportColumnFamilyOptions is used by ImportColumnFamily()
@@ -76,6 +76,14 @@ struct PerfContext {
                                                // dictionary block reads
   uint64_t block_checksum_time;    // total nanos spent on block checksum
   uint64_t block_decompress_time;  // total nanos spent on block decompression
+  // total number of lookups that found the entry in the secondary cache
+  uint64_t secondary_cache_hit_count;
+  // total number of entries the compressed secondary cache stored
+  uint64_t compressed_sec_cache_insert_count;
+  // total bytes of the entries stored by the compressed secondary cache,
+  // before and after compression
+  uint64_t compressed_sec_cache_uncompressed_bytes;
+  uint64_t compressed_sec_cache_compressed_bytes;
 
   uint64_t get_read_bytes;       // bytes for vals returned by Get
   uint64_t multiget_read_bytes;  // bytes for vals returned by MultiGet
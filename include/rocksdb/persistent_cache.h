@@ -18,6 +18,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class SecondaryCache;
+
 // PersistentCache
 //
 // Persistent cache interface for caching IO pages on a persistent medium. The
@@ -70,4 +72,12 @@ Status NewPersistentCache(Env* const env, const std::string& path,
                           const std::shared_ptr<Logger>& log,
                           const bool optimized_for_nvm,
                           std::shared_ptr<PersistentCache>* cache);
+
+// Returns a SecondaryCache that spills the entries evicted from a block cache
+// into `cache`, e.g. one created by NewPersistentCache() on local flash, and
+// promotes them back to the block cache when they are looked up again. Set it
+// as LRUCacheOptions::secondary_cache of the block cache, instead of setting
+// `cache` as BlockBasedTableOptions::persistent_cache.
+extern std::shared_ptr<SecondaryCache> NewPersistentCacheSecondaryCache(
+    const std::shared_ptr<PersistentCache>& cache);
 }  // namespace ROCKSDB_NAMESPACE
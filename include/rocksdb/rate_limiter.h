@@ -125,7 +125,8 @@ class RateLimiter {
 // from flush. Low-pri requests can get blocked if flush requests come in
 // continuously. This fairness parameter grants low-pri requests permission by
 // 1/fairness chance even though high-pri requests exist to avoid starvation.
-// You should be good by leaving it at default 10.
+// You should be good by leaving it at default 10. Requests of user reads
+// (Env::IO_USER) always go before both.
 // @mode: Mode indicates which types of operations count against the limit.
 // @auto_tuned: Enables dynamic adjustment of rate limit within the range
 //              `[rate_bytes_per_sec / 20, rate_bytes_per_sec]`, according to
@@ -77,6 +77,16 @@ class SstFileManager {
   // thread-safe
   virtual void SetMaxTrashDBRatio(double ratio) = 0;
 
+  // Return the size of the chunks large trash files are deleted in
+  // thread-safe
+  virtual uint64_t GetBytesMaxDeleteChunk() = 0;
+
+  // Update the size of the chunks large trash files are deleted in, see
+  // `bytes_max_delete_chunk` in NewSstFileManager(). Zero means to always
+  // delete whole files. Applies from the next chunk deleted.
+  // thread-safe
+  virtual void SetBytesMaxDeleteChunk(uint64_t bytes_max_delete_chunk) = 0;
+
   // Return the total size of trash files
   // thread-safe
   virtual uint64_t GetTotalTrashSize() = 0;
@@ -389,6 +389,70 @@ enum Tickers : uint32_t {
   // Outdated bytes of data present on memtable at flush time.
   MEMTABLE_GARBAGE_BYTES_AT_FLUSH,
 
+  // Bytes of WAL records before and after streaming compression when
+  // DBOptions::wal_compression is enabled. Their ratio is the WAL
+  // compression ratio.
+  WAL_COMPRESSION_INPUT_BYTES,
+  WAL_COMPRESSION_OUTPUT_BYTES,
+
+  // # of table file seeks skipped by the range filter, for having no keys
+  // before ReadOptions::iterate_upper_bound.
+  RANGE_FILTER_USEFUL,
+
+  // # of Get() calls answered by, and looked up in vain in, the hot key
+  // cache of ColumnFamilyOptions::memtable_hot_key_cache_size.
+  HOT_KEY_CACHE_HIT,
+  HOT_KEY_CACHE_MISS,
+
+  // # of data blocks compactions copied into their output as they were
+  // stored, with DBOptions::compaction_copy_unchanged_blocks.
+  COMPACT_COPIED_DATA_BLOCKS,
+
+  // # of blob lookups in ColumnFamilyOptions::blob_cache that found, and
+  // did not find, the blob, and of blobs added to it, or that could not be.
+  BLOB_DB_CACHE_HIT,
+  BLOB_DB_CACHE_MISS,
+  BLOB_DB_CACHE_ADD,
+  BLOB_DB_CACHE_ADD_FAILURES,
+
+  // # of second reads issued for slow reads (ReadOptions::
+  // hedged_read_percentile), and of those that completed first.
+  HEDGED_READS_ISSUED,
+  HEDGED_READS_WON,
+
+  // # of WritePrepared visibility checks of a prepare sequence number that
+  // was already evicted from the commit cache. If high, consider a larger
+  // TransactionDBOptions::wp_commit_cache_bits.
+  TXN_COMMIT_CACHE_EVICTED_LOOKUP,
+  // # of times prepare_mutex_ was not acquired in the fast path, despite
+  // lingering prepared transactions, as the sequence number was outside of
+  // their range.
+  TXN_PREPARE_MUTEX_SKIPPED,
+
+  // With BlockBasedTableOptions::adaptive_compression, # of data blocks
+  // stored uncompressed as they looked incompressible, compressed with the
+  // fast compression instead of the configured one as they looked only
+  // moderately compressible, and compressed as configured.
+  ADAPTIVE_COMPRESSION_SKIPPED,
+  ADAPTIVE_COMPRESSION_FAST,
+  ADAPTIVE_COMPRESSION_CONFIGURED,
+
+  // With merge_operands_collapse_threshold, # of Get()s that wrote the value
+  // they merged back, and that could not, mostly as the key was written since
+  // the read or writes were stalled.
+  MERGE_OPERANDS_COLLAPSED,
+  MERGE_OPERANDS_COLLAPSE_ABORTED,
+
+  // # of keys Get() and MultiGet() looked up in memtables with a bloom filter
+  // (memtable_prefix_bloom_size_ratio), and # of those the filter ruled out.
+  MEMTABLE_BLOOM_CHECKED,
+  MEMTABLE_BLOOM_USEFUL,
+
+  // With enable_no_wal_write_fast_path, # of writes that took the fast path,
+  // and # of eligible writes that went through the write thread instead.
+  WRITE_FAST_PATH,
+  WRITE_FAST_PATH_FALLBACK,
+
   TICKER_ENUM_MAX
 };
 
@@ -490,6 +554,59 @@ enum Histograms : uint32_t {
   // Error handler statistics
   ERROR_HANDLER_AUTORESUME_RETRY_COUNT,
 
+  // Time spent compressing WAL records.
+  WAL_COMPRESSION_TIMES_NANOS,
+
+  // Number of table files a Get() looked the key up in, once it was not
+  // found in memtables. Each level after L0 counts at most once.
+  NUM_LEVELS_READ_PER_GET,
+
+  // Time waited for the DB mutex (when the stats level records mutex
+  // timings) by the leader of a write group, and by background flushes and
+  // compactions before starting. DB_MUTEX_WAIT_GET_SNAPSHOT_MICROS is no
+  // longer recorded, as GetSnapshot() does not take the DB mutex.
+  DB_MUTEX_WAIT_GET_SNAPSHOT_MICROS,
+  DB_MUTEX_WAIT_WRITE_MICROS,
+  DB_MUTEX_WAIT_BG_JOB_MICROS,
+
+  // Time a background compaction held the DB mutex to pick a compaction.
+  COMPACTION_PICK_MICROS,
+
+  // Time a background flush or compaction waited in the thread pool queue
+  // between being scheduled and starting to run.
+  FLUSH_QUEUE_WAIT_MICROS,
+  COMPACTION_QUEUE_WAIT_MICROS,
+
+  // Time the Get() requests sampled with DBOptions::perf_context_sample_one_in
+  // spent on each stage, taken from their PerfContext and IOStatsContext
+  SAMPLED_GET_MEMTABLE_NANOS,
+  SAMPLED_GET_FILTER_NANOS,
+  SAMPLED_GET_INDEX_NANOS,
+  SAMPLED_GET_DATA_BLOCK_NANOS,
+  SAMPLED_GET_DECOMPRESS_NANOS,
+  SAMPLED_GET_IO_NANOS,
+
+  // Latency of the file reads and writes done for user requests (and
+  // anything else not a flush or compaction), for flushes and for
+  // compactions
+  FILE_READ_USER_MICROS,
+  FILE_READ_FLUSH_MICROS,
+  FILE_READ_COMPACTION_MICROS,
+  FILE_WRITE_USER_MICROS,
+  FILE_WRITE_FLUSH_MICROS,
+  FILE_WRITE_COMPACTION_MICROS,
+  // Latency of the writes to each type of file. See WAL_FILE_SYNC_MICROS,
+  // MANIFEST_FILE_SYNC_MICROS, TABLE_SYNC_MICROS and
+  // BLOB_DB_BLOB_FILE_SYNC_MICROS for syncs, and SST_READ_MICROS and
+  // BLOB_DB_BLOB_FILE_READ_MICROS for reads.
+  WAL_FILE_WRITE_MICROS,
+  MANIFEST_FILE_WRITE_MICROS,
+  SST_FILE_WRITE_MICROS,
+  BLOB_FILE_WRITE_MICROS,
+
+  // Time spent by Checkpoint::CreateCheckpoint()
+  CHECKPOINT_MICROS,
+
   HISTOGRAM_ENUM_MAX,
 };
 
@@ -551,6 +668,16 @@ class Statistics {
   virtual void histogramData(uint32_t type,
                              HistogramData* const data) const = 0;
   virtual std::string getHistogramString(uint32_t /*type*/) const { return ""; }
+  // Fills `data` with the distribution of the values recorded into histogram
+  // `type` since the previous call for it, or since the object was created
+  // or Reset(). Unlike Reset(), this leaves the cumulative data returned by
+  // histogramData() alone, so that a monitoring thread can export, e.g.,
+  // per-minute percentiles. Meant for a single such caller. Returns false if
+  // not supported.
+  virtual bool histogramDataInterval(uint32_t /*type*/,
+                                     HistogramData* const /*data*/) {
+    return false;
+  }
   virtual void recordTick(uint32_t tickerType, uint64_t count = 0) = 0;
   virtual void setTickerCount(uint32_t tickerType, uint64_t count) = 0;
   virtual uint64_t getAndResetTickerCount(uint32_t tickerType) = 0;
@@ -607,4 +734,13 @@ class Statistics {
 // Create a concrete DBStatistics object
 std::shared_ptr<Statistics> CreateDBStatistics();
 
+// Create a concrete DBStatistics object whose histograms use log-linear
+// (HDR-style) buckets: every power of two is split into
+// 2^histogram_precision_bits buckets, so that percentiles are within a
+// relative error of 2^-histogram_precision_bits, e.g. under 1% with 7 bits.
+// The default histograms' buckets are 1.5x apart. Bucket counters are
+// allocated per core for the ranges of values actually recorded, at
+// 8 * 2^histogram_precision_bits bytes per power of two. Clamped to [1, 10].
+std::shared_ptr<Statistics> CreateDBStatistics(int histogram_precision_bits);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -49,6 +49,10 @@ enum ChecksumType : char {
   kCRC32c = 0x1,
   kxxHash = 0x2,
   kxxHash64 = 0x3,
+  // XXH3 (preview), which uses SIMD instructions where available (SSE2,
+  // AVX2, NEON). Much faster than kCRC32c on CPUs without CRC instructions.
+  // Not readable by RocksDB versions before it was added.
+  kXXH3 = 0x4,
 };
 
 // `PinningTier` is used to specify which tier of block-based tables should
@@ -73,6 +77,11 @@ enum class PinningTier {
 
   // This tier contains all block-based tables.
   kAll,
+
+  // This tier contains block-based tables in the levels up to
+  // `MetadataCacheOptions::max_upper_level`, which hold the most recently
+  // written and so usually the hottest data.
+  kUpperLevels,
 };
 
 // `MetadataCacheOptions` contains members indicating the desired caching
@@ -98,6 +107,10 @@ struct MetadataCacheOptions {
   // any effect. Otherwise the unpartitioned meta-blocks would be held in table
   // reader memory, outside the block cache.
   PinningTier unpartitioned_pinning = PinningTier::kFallback;
+
+  // The last level whose tables are in `PinningTier::kUpperLevels`. With the
+  // default, only the tables of L0 are.
+  int max_upper_level = 0;
 };
 
 // For advanced user only
@@ -179,6 +192,19 @@ struct BlockBasedTableOptions {
   // overflowing block cache.
   MetadataCacheOptions metadata_cache_options;
 
+  // If true and a block cache is configured, each open table reader keeps
+  // only a minimal handle in memory: the index, filter and compression
+  // dictionary blocks are always served from the block cache, unpinned, as if
+  // cache_index_and_filter_blocks were true and nothing were pinned; range
+  // filter and key position summary blocks are not loaded; and the table
+  // properties kept with the reader omit user collected properties and
+  // descriptive strings. GetTableProperties() still returns the complete
+  // properties, which are read back on demand and cached in the block cache.
+  //
+  // Meant for databases with very many files open at once, where the memory
+  // held by table readers outside the block cache is otherwise unbounded.
+  bool compact_table_reader = false;
+
   // The index type that will be used for this table.
   enum IndexType : char {
     // A space efficient index block that is optimized for
@@ -204,6 +230,28 @@ struct BlockBasedTableOptions {
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
     kBinarySearchWithFirstKey = 0x03,
+
+    // Like kBinarySearch, but each table file also stores a small piecewise
+    // linear model that predicts where a key falls in the index block, so a
+    // lookup binary searches only a few index entries around the prediction.
+    // Keeps a single flat index (no partition lookups) cheap for files with
+    // many data blocks. Works best with keys that are numbers in big-endian
+    // encoding (optionally behind a common prefix); for other keys, or with a
+    // non-bytewise comparator, the model is left out and it reads like
+    // kBinarySearch.
+    kLearned = 0x04,
+
+    // For tables whose user keys all have the same size, e.g. fixed-width
+    // integers or hashes, under the bytewise comparator. Besides the index
+    // block (kept for older versions and as the fallback), each table file
+    // stores the shortest separators that tell its data blocks apart and
+    // the block offsets in Elias-Fano coding, which readers keep in memory
+    // and search instead of the index block, usually in a few bits per data
+    // block rather than bytes. The index does not go through the block
+    // cache. When the keys are not fixed-size, a user key spans two data
+    // blocks, the data blocks are padded (block_align) or format_version < 3,
+    // it is left out and the table reads like kBinarySearch.
+    kEliasFano = 0x05,
   };
 
   IndexType index_type = kBinarySearch;
@@ -220,6 +268,43 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // If true, data blocks with more than 253 restart intervals, e.g. 32KB
+  // blocks with a small block_restart_interval, also get a hash index, with
+  // 16-bit buckets. Otherwise they are only searched with binary search. It
+  // is valid only when data_block_index_type is kDataBlockBinaryAndHash.
+  //
+  // Blocks written with this option cannot be read by older versions of
+  // RocksDB.
+  //
+  // Default: false
+  bool wide_data_block_hash_index = false;
+
+  // If true, data blocks store all their (delta encoded) keys together,
+  // followed by all their values, instead of storing each value right after
+  // its key. Seeking within a block then scans only key bytes, which touches
+  // far fewer cache lines when values are large. Iterating all entries of a
+  // block reads keys and values from two sequential streams instead of one.
+  //
+  // Blocks written with this option cannot be read by older versions of
+  // RocksDB.
+  //
+  // Default: false
+  bool separate_key_value_in_data_block = false;
+
+  // If true, data blocks also store the first 8 bytes of the user key of
+  // each restart point, as fixed-width integers that compare in the same
+  // order as the keys. Seeking within a block then finds the restart
+  // interval by comparing these integers, and only decodes and compares full
+  // keys for restart points whose first 8 bytes equal those of the target.
+  // This costs 8 bytes per restart point.
+  //
+  // Only used with BytewiseComparator; ignored with other comparators.
+  // Blocks written with this option cannot be read by older versions of
+  // RocksDB.
+  //
+  // Default: false
+  bool restart_key_prefixes_in_data_block = false;
+
   // This option is now deprecated. No matter what value it is set to,
   // it will behave as if hash_index_allow_collision=true.
   bool hash_index_allow_collision = true;
@@ -323,6 +408,55 @@ struct BlockBasedTableOptions {
   // unless malloc_usable_size is buggy or broken.
   bool optimize_filters_for_memory = false;
 
+  // If true, and block_cache is set, the memory that table builders use to
+  // collect key hashes for full and partitioned filters (format_version >= 5
+  // Bloom and Ribbon), and the banding that Ribbon filter construction needs
+  // on top of that, is charged to block_cache with dummy entries while the
+  // filter is built. This can be large for big files: about 8 bytes per key
+  // for the hashes plus about 24 bytes per solution slot for Ribbon banding.
+  // If block_cache has strict_capacity_limit set and cannot fit the Ribbon
+  // banding, the filter is built as a format_version=5 Bloom filter instead,
+  // which needs no extra memory.
+  //
+  // Default: false
+  bool reserve_table_builder_memory = false;
+
+  // If > 0, each table file gets a range filter: the distinct prefixes of
+  // this many bytes (at most 255) of its user keys. Iterators with
+  // ReadOptions::iterate_upper_bound set use it to skip files that have no
+  // keys in the range of a Seek() or SeekToFirst(), without reading their
+  // index or data blocks. Such files are common for short range scans in a
+  // large, fragmented key space. Longer prefixes give fewer false positives
+  // and need more space: prefix length + 1 bytes for each distinct prefix.
+  // The filter is held in memory by the table reader.
+  //
+  // Only built with BytewiseComparator and without user-defined timestamps.
+  //
+  // Default: 0 (no range filter)
+  size_t range_filter_prefix_len = 0;
+
+  // If > 0, the compressed data blocks a MultiGet() reads from a file are
+  // decompressed by up to this many threads of a process-wide pool, shared
+  // by all DBs, along with the calling thread. This lowers the latency of
+  // MultiGet() batches that miss the block cache on many compressed blocks,
+  // at the cost of more threads and handoffs. Decompression time of the pool
+  // threads is not counted in the PerfContext of the caller.
+  //
+  // Default: 0 (decompress on the calling thread)
+  int multiget_decompression_threads = 0;
+
+  // If > 0, each table file stores a summary of the positions of about this
+  // many of its data blocks, evenly spaced: the last key of the block, the
+  // file offset where the block ends and the number of entries up to it.
+  // The summary is held in memory by the table reader, and
+  // DB::GetApproximateSizes() and DB::GetApproximateKeyCounts() binary
+  // search it instead of seeking the index, so estimates need no index
+  // block reads. The estimates are accurate to about 1 / this of the file.
+  // The summary takes about (key size + 12) bytes per sample.
+  //
+  // Default: 0 (no summary)
+  uint32_t key_position_samples = 0;
+
   // Use delta encoding to compress keys in blocks.
   // ReadOptions::pin_data requires this option to be disabled.
   //
@@ -343,6 +477,19 @@ struct BlockBasedTableOptions {
   // algorithms.
   bool verify_compression = false;
 
+  // If true, the compression of each data block is chosen from a cheap
+  // estimate of its compressibility: the entropy of the byte values of a
+  // sample of up to 4KB of the block. Blocks that look incompressible, e.g.
+  // of values that are compressed already, are stored uncompressed without
+  // trying to compress them. Blocks that look only moderately compressible
+  // are compressed with LZ4 (or Snappy) when the configured compression is
+  // a slower one such as ZSTD, unless a compression dictionary is used. All
+  // other blocks get the configured compression. The tickers
+  // ADAPTIVE_COMPRESSION_* count the choices made.
+  //
+  // Has no effect if the configured compression is kNoCompression.
+  bool adaptive_compression = false;
+
   // If used, For every data block we load into memory, we will create a bitmap
   // of size ((block_size / `read_amp_bytes_per_bit`) / 8) bytes. This bitmap
   // will be used to figure out the percentage we actually read of the blocks.
@@ -580,6 +727,15 @@ struct PlainTableOptions {
   //                       file building and store it in file. When reading
   //                       file, index will be mapped instead of recomputation.
   bool store_index_in_file = false;
+
+  // @copy_data_to_huge_pages: if huge_page_tlb_size > 0, read the whole file
+  //                           into memory from huge pages when opening it and
+  //                           serve all reads from there, so that lookups in
+  //                           large in-memory tables do not miss the TLB on
+  //                           every 4KB page of the file. Costs memory the
+  //                           size of the file for every open table. Falls
+  //                           back to malloc if no huge pages are available.
+  bool copy_data_to_huge_pages = false;
 };
 
 // -- Plain Table with prefix-only seek
@@ -47,6 +47,10 @@ struct TablePropertiesNames {
   static const std::string kNumFilterEntries;
   static const std::string kDeletedKeys;
   static const std::string kMergeOperands;
+  // The oldest and newest user-defined timestamps in the table, as stored
+  // in the keys. Only recorded if Comparator::timestamp_size() > 0.
+  static const std::string kTimestampMin;
+  static const std::string kTimestampMax;
   static const std::string kNumRangeDeletions;
   static const std::string kFormatVersion;
   static const std::string kFixedKeyLen;
@@ -72,6 +72,18 @@ class CompactionOptionsUniversal {
   // Default: false
   bool allow_trivial_move;
 
+  // When size amplification calls for compacting every sorted run into the
+  // oldest one, compact only a key range of the two oldest sorted runs (and
+  // the files of newer non-L0 sorted runs within it) at a time, if one can
+  // be found that is not much less efficient. The files of a sorted run,
+  // cut by target_file_size_base and the SstPartitioner if any, make up the
+  // key ranges, and a compaction takes about max_compaction_bytes of them,
+  // so the extra space and I/O of reducing size amplification stay bounded.
+  // Only has an effect with num_levels > 1, once the data has moved out of
+  // L0.
+  // Default: false
+  bool incremental;
+
   // Default set of parameters
   CompactionOptionsUniversal()
       : size_ratio(1),
@@ -80,7 +92,8 @@ class CompactionOptionsUniversal {
         max_size_amplification_percent(200),
         compression_size_percent(-1),
         stop_style(kCompactionStopStyleTotalSize),
-        allow_trivial_move(false) {}
+        allow_trivial_move(false),
+        incremental(false) {}
 };
 
 }  // namespace ROCKSDB_NAMESPACE
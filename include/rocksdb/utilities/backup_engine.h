@@ -112,6 +112,15 @@ struct BackupEngineOptions {
   // Default: 1
   int max_background_operations;
 
+  // Size of the reads, and so of the buffer of every background thread, used
+  // to copy files and compute their checksums. Larger reads suit storage
+  // with high per-request latency, such as a remote backup_env, or direct
+  // I/O. If 0, the burst size of the rate limiter, if any, or 5MB is used.
+  // A buffer larger than the burst size is charged to the rate limiter in
+  // bursts.
+  // Default: 0
+  uint64_t io_buffer_size;
+
   // During backup user can get callback every time next
   // callback_trigger_interval_size bytes being copied.
   // Default: 4194304
@@ -219,6 +228,7 @@ struct BackupEngineOptions {
         restore_rate_limit(_restore_rate_limit),
         share_files_with_checksum(true),
         max_background_operations(_max_background_operations),
+        io_buffer_size(0),
         callback_trigger_interval_size(_callback_trigger_interval_size),
         max_valid_backups_to_open(_max_valid_backups_to_open),
         share_files_with_checksum_naming(_share_files_with_checksum_naming) {
@@ -272,8 +282,20 @@ struct RestoreOptions {
   // Default: false
   bool keep_log_files;
 
+  // If true, table and blob files are hard-linked into the DB directory
+  // instead of copied, when the backup is on the same Env as the DB
+  // (BackupEngineOptions::backup_env is unset or the DB's Env). Files that
+  // cannot be linked, e.g. as they are on another file system, are copied.
+  // This is safe as the DB never modifies these files, and makes a restore
+  // take about as long as copying its WAL and metadata files. Linked files
+  // are not verified against their checksums during the restore; call
+  // VerifyBackup() with verify_with_checksum, which may run while the
+  // restored DB is open.
+  // Default: false
+  bool link_table_files;
+
   explicit RestoreOptions(bool _keep_log_files = false)
-      : keep_log_files(_keep_log_files) {}
+      : keep_log_files(_keep_log_files), link_table_files(false) {}
 };
 
 struct BackupFileInfo {
@@ -0,0 +1,72 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct BulkLoaderOptions {
+  // The directory for the sorted runs spilled while loading and for the
+  // table files built by Finish(). Created if missing. Its files are removed
+  // once they are no longer needed; the directory itself is left behind.
+  std::string work_dir;
+
+  // The number of threads sorting and spilling the buffered entries while
+  // they are added, and building the table files in Finish().
+  int num_threads = 4;
+
+  // The entries added are buffered up to about this many bytes of keys and
+  // values before they are sorted and spilled as a run.
+  size_t sort_buffer_size = 64 << 20;
+
+  // The size at which Finish() moves on to a new table file. 0 stands for
+  // the target_file_size_base of the column family.
+  uint64_t target_file_size = 0;
+
+  // For the ingestion of the table files by Finish(). move_files is always
+  // set, as the files are built for the ingestion alone.
+  IngestExternalFileOptions ingest_options;
+};
+
+// Loads a large number of entries, in any order, into a column family as
+// table files, bypassing the memtables, WAL and compactions.
+//
+// The entries are buffered and, once sort_buffer_size is reached, sorted and
+// spilled to work_dir on a background thread. Finish() splits the key range
+// into num_threads parts, merges the runs of each part on a thread of its
+// own into non-overlapping table files of about target_file_size and ingests
+// them with IngestExternalFile(). Unless they overlap existing data, the
+// files go to the bottommost level.
+//
+// Of several entries with the same key, the one added last is kept.
+//
+// Put() is thread-safe, so that several input streams can be loaded at
+// once; the order of their entries with the same key is then unspecified.
+class BulkLoader {
+ public:
+  static Status Open(DB* db, ColumnFamilyHandle* column_family,
+                     const BulkLoaderOptions& options,
+                     std::unique_ptr<BulkLoader>* loader);
+
+  virtual ~BulkLoader() {}
+
+  virtual Status Put(const Slice& key, const Slice& value) = 0;
+
+  // Writes and ingests the entries added. The loader cannot be used
+  // afterwards.
+  virtual Status Finish() = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
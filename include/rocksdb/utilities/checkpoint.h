@@ -35,8 +35,12 @@ class Checkpoint {
   // this value, then a flush is triggered for all the column families. The
   // default value is 0, which means flush is always triggered. If you move
   // away from the default, the checkpoint may not contain up-to-date data
-  // if WAL writing is not always enabled.
+  // if WAL writing is not always enabled. port::kMaxUint64 never flushes, so
+  // that frequent checkpoints do not stall writes: the table files are
+  // hard-linked and only the WALs still needed for recovery are linked, with
+  // the last one copied up to its current size.
   // Flush will always trigger if it is 2PC.
+  // The time taken is recorded in the CHECKPOINT_MICROS histogram.
   // sequence_number_ptr: if it is not nullptr, the value it points to will be
   // set to the DB's sequence number. The default value of this parameter is
   // nullptr.
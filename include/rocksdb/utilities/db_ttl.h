@@ -28,6 +28,9 @@ namespace ROCKSDB_NAMESPACE {
 // (int32_t)Timestamp(creation) is suffixed to values in Put internally
 // Expired TTL values deleted in compaction only:(Timestamp+ttl<time_now)
 // Get/Iterator may return expired entries(compaction not run on them yet)
+// A table file holding only Puts that have all expired is dropped as a whole,
+//  without reading it, by DropExpiredFiles() and CompactRange(), and is
+//  skipped by iterators
 // Different TTL may be used during different Opens
 // Example: Open1 at t=0 with ttl=4 and insert k1,k2, close at t=2
 //          Open2 at t=3 with ttl=5. Now k1,k2 should be deleted at t>=5
@@ -64,6 +67,12 @@ class DBWithTTL : public StackableDB {
 
   virtual void SetTtl(ColumnFamilyHandle* h, int32_t ttl) = 0;
 
+  // Deletes the table files of the column family whose Puts have all
+  // expired, going by the timestamps recorded in their properties. Files
+  // with deletions or merges, or written before this feature, are kept and
+  // left to compaction. Snapshots do not keep the files alive.
+  virtual Status DropExpiredFiles(ColumnFamilyHandle* column_family) = 0;
+
  protected:
   explicit DBWithTTL(DB* db) : StackableDB(db) {}
 };
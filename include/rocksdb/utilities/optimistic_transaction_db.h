@@ -49,6 +49,13 @@ struct OptimisticTransactionDBOptions {
 
   // works only if validate_policy == OccValidationPolicy::kValidateParallel
   uint32_t occ_lock_buckets = (1 << 20);
+
+  // The number of threads a commit may check its keys for conflicts with.
+  // Only a column family with at least 256 tracked keys per thread is split
+  // over threads, which are started for that commit, so this pays off only
+  // for large transactions.
+  // works only if validate_policy == OccValidationPolicy::kValidateParallel
+  uint32_t max_validation_threads = 1;
 };
 
 // Range deletions (including those in `WriteBatch`es passed to `Write()`) are
@@ -0,0 +1,41 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <functional>
+
+#include "rocksdb/db.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Called once per range by ParallelScan(), from the thread scanning that
+// range. `iter` is positioned at the first entry of the range (or is not
+// Valid() if the range is empty) and is bounded to the range, so a plain
+// loop of Next() calls visits all of it. The iterator is owned by
+// ParallelScan() and deleted when scan_fn returns.
+using ParallelScanFunc =
+    std::function<Status(size_t range_index, Iterator* iter)>;
+
+// Scans a column family with up to num_ranges threads. The key space,
+// limited by read_options.iterate_lower_bound and iterate_upper_bound if
+// set, is split with DB::GetKeyRangeSplits() and each range is read by its
+// own iterator. Every key of range i sorts before every key of range i + 1.
+// All iterators read from read_options.snapshot, or from a snapshot taken
+// for the duration of the call if none is given, so the scan as a whole
+// sees the same consistent view as a single iterator would.
+//
+// Runs num_ranges - 1 threads plus the calling thread and returns once all
+// of them are done. Returns the first non-OK status, in range order,
+// returned by scan_fn or left in an iterator after scan_fn returned.
+Status ParallelScan(DB* db, const ReadOptions& read_options,
+                    ColumnFamilyHandle* column_family, size_t num_ranges,
+                    const ParallelScanFunc& scan_fn);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
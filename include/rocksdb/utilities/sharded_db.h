@@ -0,0 +1,101 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct ShardedDBOptions {
+  // The number of DBs the keys are partitioned over. Must not change once
+  // the sharded DB is created.
+  size_t num_shards = 16;
+
+  // If empty, keys are hash-partitioned. Otherwise keys are range-partitioned
+  // and this holds the num_shards - 1 keys, in increasing order of
+  // Options::comparator, that start shards 1 to num_shards - 1: shard i
+  // holds the keys in [range_boundaries[i - 1], range_boundaries[i]).
+  std::vector<std::string> range_boundaries;
+};
+
+// Partitions the keys of the default column family over several DBs, to
+// scale writes past the single write queue and WAL of one DB. Shard i is a
+// DB of its own in the directory <path>/shard-<i>.
+//
+// All shards are opened with the same Options, so they share its Env (and
+// with it the background thread pools), block cache, rate limiter,
+// SstFileManager and statistics. Unless Options::write_buffer_manager is
+// set, one WriteBufferManager of Options::db_write_buffer_size, if non-zero,
+// is created for all shards, so that the limit holds for the total memtable
+// memory and not that of every shard.
+//
+// A WriteBatch spanning several shards is written to each of them
+// separately: it is atomic with respect to the snapshots and iterators of
+// the ShardedDB, but not across a crash. Writes to a single shard are
+// atomic as for any DB.
+//
+// Thread-safe.
+class ShardedDB {
+ public:
+  // Opens, and with Options::create_if_missing creates, the sharded DB at
+  // `path`. Fails if it was created with a different number of shards or
+  // range boundaries.
+  static Status Open(const Options& options,
+                     const ShardedDBOptions& sharded_options,
+                     const std::string& path,
+                     std::unique_ptr<ShardedDB>* sharded_db);
+
+  virtual ~ShardedDB() {}
+
+  virtual size_t num_shards() const = 0;
+  // The shard that holds `key`
+  virtual size_t ShardForKey(const Slice& key) const = 0;
+  // For the operations not offered here, e.g. compaction or properties
+  virtual DB* GetShard(size_t shard) const = 0;
+
+  virtual Status Put(const WriteOptions& options, const Slice& key,
+                     const Slice& value) = 0;
+  virtual Status Delete(const WriteOptions& options, const Slice& key) = 0;
+  virtual Status SingleDelete(const WriteOptions& options,
+                              const Slice& key) = 0;
+  virtual Status Merge(const WriteOptions& options, const Slice& key,
+                       const Slice& value) = 0;
+  // Only for the default column family. A DeleteRange() is written to every
+  // shard.
+  virtual Status Write(const WriteOptions& options, WriteBatch* updates) = 0;
+
+  // `options.snapshot`, if set, must come from GetSnapshot() of this
+  // ShardedDB
+  virtual Status Get(const ReadOptions& options, const Slice& key,
+                     std::string* value) = 0;
+  // Groups the keys by shard, with one MultiGet() per shard. Without a
+  // snapshot the shards are not read at the same point in time.
+  virtual std::vector<Status> MultiGet(const ReadOptions& options,
+                                       const std::vector<Slice>& keys,
+                                       std::vector<std::string>* values) = 0;
+  // Merges the iterators of all shards. Without a snapshot, one is taken
+  // for the lifetime of the iterator, so that it sees every shard at the
+  // same point in time.
+  virtual Iterator* NewIterator(const ReadOptions& options) = 0;
+
+  // Takes a snapshot of every shard at the same point in time, between
+  // writes of the ShardedDB. Its GetSequenceNumber() is that of shard 0.
+  virtual const Snapshot* GetSnapshot() = 0;
+  virtual void ReleaseSnapshot(const Snapshot* snapshot) = 0;
+
+  virtual Status Flush(const FlushOptions& options) = 0;
+  virtual Status Close() = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
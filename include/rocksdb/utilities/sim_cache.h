@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <memory>
 #include <string>
+#include <vector>
 #include "rocksdb/cache.h"
 #include "rocksdb/env.h"
 #include "rocksdb/slice.h"
@@ -91,4 +92,69 @@ class SimCache : public Cache {
   SimCache& operator=(const SimCache&);
 };
 
+class MissRatioCurveCache;
+
+struct MissRatioCurveCacheOptions {
+  // The cache capacities, in bytes, to estimate miss ratios for. If empty,
+  // 1/8, 1/4, 1/2, 1, 2 and 4 times the capacity of the wrapped cache are
+  // used.
+  std::vector<size_t> capacities;
+
+  // The fraction of cache keys, chosen by hash, whose accesses are simulated
+  // (SHARDS-style spatial sampling). The simulated caches are scaled down by
+  // the same factor, so lower rates cost less CPU and memory at the expense
+  // of accuracy. Must be in (0, 1].
+  double sampling_rate = 0.01;
+};
+
+// NewMissRatioCurveCache returns a wrapper of `cache` that estimates online,
+// from a hash-sampled subset of the lookups and inserts it sees, the miss
+// ratio an LRU cache of each of several capacities would have for the same
+// accesses. All capacities are simulated at once in a single pass, by
+// tracking the LRU stack distance (in bytes) of each sampled access. When
+// used as the block cache, the curve is also available through the DB
+// property "rocksdb.block-cache-miss-ratio-curve".
+//
+// Like SimCache, the wrapper does not forward secondary cache lookups.
+// Returns nullptr if the options are invalid.
+extern std::shared_ptr<MissRatioCurveCache> NewMissRatioCurveCache(
+    std::shared_ptr<Cache> cache,
+    const MissRatioCurveCacheOptions& options = MissRatioCurveCacheOptions());
+
+class MissRatioCurveCache : public Cache {
+ public:
+  MissRatioCurveCache() {}
+
+  ~MissRatioCurveCache() override {}
+
+  static const char* kClassName() { return "MissRatioCurveCache"; }
+  const char* Name() const override { return kClassName(); }
+
+  struct Point {
+    size_t capacity;
+    // Estimated fraction of accesses that miss in an LRU cache of this
+    // capacity
+    double miss_ratio;
+  };
+
+  // Returns the estimated miss ratio of each simulated capacity, in
+  // increasing order of capacity. Miss ratios are 0 until an access has
+  // been sampled.
+  virtual std::vector<Point> GetMissRatioCurve() const = 0;
+
+  // Returns the number of accesses sampled since creation or the last
+  // ResetCounters().
+  virtual uint64_t GetSampledAccesses() const = 0;
+
+  // Restarts the hit and miss counts. The simulated cache contents are kept.
+  virtual void ResetCounters() = 0;
+
+  // String representation of the miss ratio curve
+  virtual std::string ToString() const = 0;
+
+ private:
+  MissRatioCurveCache(const MissRatioCurveCache&);
+  MissRatioCurveCache& operator=(const MissRatioCurveCache&);
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -99,6 +99,17 @@ class StackableDB : public DB {
                                  number_of_operands);
   }
 
+  using DB::MultiGetMergeOperands;
+  virtual void MultiGetMergeOperands(
+      const ReadOptions& options, ColumnFamilyHandle* column_family,
+      const size_t num_keys, const Slice* keys, PinnableSlice* merge_operands,
+      GetMergeOperandsOptions* get_merge_operands_options,
+      int* number_of_operands, Status* statuses) override {
+    db_->MultiGetMergeOperands(options, column_family, num_keys, keys,
+                               merge_operands, get_merge_operands_options,
+                               number_of_operands, statuses);
+  }
+
   using DB::MultiGet;
   virtual std::vector<Status> MultiGet(
       const ReadOptions& options,
@@ -244,6 +255,29 @@ class StackableDB : public DB {
     return db_->GetApproximateMemTableStats(column_family, range, count, size);
   }
 
+  virtual Status GetApproximateKeyCounts(
+      const SizeApproximationOptions& options,
+      ColumnFamilyHandle* column_family, const Range* r, int n,
+      uint64_t* counts) override {
+    return db_->GetApproximateKeyCounts(options, column_family, r, n, counts);
+  }
+
+  virtual Status GetKeyRangeSplits(
+      ColumnFamilyHandle* column_family, const Slice* begin, const Slice* end,
+      size_t num_ranges, std::vector<std::string>* split_keys) override {
+    return db_->GetKeyRangeSplits(column_family, begin, end, num_ranges,
+                                  split_keys);
+  }
+
+  virtual Status DumpBlockCacheHotSet(const std::string& dump_path) override {
+    return db_->DumpBlockCacheHotSet(dump_path);
+  }
+
+  virtual Status WarmUpBlockCache(const ReadOptions& read_options,
+                                  const std::string& dump_path) override {
+    return db_->WarmUpBlockCache(read_options, dump_path);
+  }
+
   using DB::CompactRange;
   virtual Status CompactRange(const CompactRangeOptions& options,
                               ColumnFamilyHandle* column_family,
@@ -29,6 +29,19 @@ enum TxnDBWritePolicy {
   WRITE_UNPREPARED  // write data before the prepare phase of 2pc
 };
 
+// How the default point lock manager keeps the locked keys of a stripe, see
+// TransactionDBOptions::point_lock_table
+enum class PointLockTable {
+  // A std::unordered_map. Every unlock wakes up all the transactions waiting
+  // for a key of the stripe.
+  kHashMap,
+  // An open-addressing table whose entries, condition variables included,
+  // are allocated up front and reused, so that locking a key does not
+  // allocate. Every key has its own condition variable, so an unlock only
+  // wakes up the transactions waiting for that key.
+  kOpenAddressing,
+};
+
 const uint32_t kInitialMaxDeadlocks = 5;
 
 class LockManager;
@@ -127,6 +140,24 @@ class RangeLockManagerHandle : public LockManagerHandle {
 RangeLockManagerHandle* NewRangeLockManager(
     std::shared_ptr<TransactionDBMutexFactory> mutex_factory);
 
+// A factory function to create a Range Lock Manager for workloads of short
+// transactions locking mostly disjoint ranges. It is used the same way as
+// the one returned by NewRangeLockManager().
+//
+// The locks of a column family are split over num_shards shards by the
+// first prefix_length bytes of the range, so that transactions locking keys
+// with different prefixes do not contend. A range whose endpoints differ
+// within the first prefix_length bytes is checked against all shards. This
+// relies on the keys with a common prefix being adjacent, as with
+// BytewiseComparator() and ReverseBytewiseComparator(); with any other
+// comparator, prefix_length must be 0, which keeps all locks in one shard.
+//
+// There is no lock escalation, and no deadlock detection: a transaction in
+// a deadlock waits until its lock timeout.
+RangeLockManagerHandle* NewShardedRangeLockManager(
+    std::shared_ptr<TransactionDBMutexFactory> mutex_factory,
+    size_t num_shards = 16, size_t prefix_length = 8);
+
 struct TransactionDBOptions {
   // Specifies the maximum number of keys that can be locked at the same time
   // per column family.
@@ -144,6 +175,14 @@ struct TransactionDBOptions {
   // mutex.
   size_t num_stripes = 16;
 
+  // The table of locked keys of every stripe. kOpenAddressing does better
+  // when many transactions contend for the locks of a stripe.
+  PointLockTable point_lock_table = PointLockTable::kHashMap;
+
+  // With PointLockTable::kOpenAddressing, the number of lock entries
+  // allocated up front for every stripe. The table grows past it as needed.
+  size_t point_lock_entries_per_stripe = 64;
+
   // If positive, specifies the default wait timeout in milliseconds when
   // a transaction attempts to lock a key if not specified by
   // TransactionOptions::lock_timeout.
@@ -204,11 +243,19 @@ struct TransactionDBOptions {
   // pending writes into the database. A value of 0 or less means no limit.
   int64_t default_write_batch_flush_threshold = 0;
 
+  // Only for WRITE_PREPARED and WRITE_UNPREPARED. The commit cache holds
+  // 2^wp_commit_cache_bits entries of 8 bytes, indexed by prepare sequence
+  // number. Telling whether a transaction whose entry was evicted is visible
+  // to a read takes slower paths under a mutex while long-running prepared
+  // transactions or old snapshots exist, so a larger cache helps workloads
+  // that have them. Ticker TXN_COMMIT_CACHE_EVICTED_LOOKUP counts the
+  // lookups of evicted entries.
+  // Default: 23, i.e. 8m entries and 64MB
+  size_t wp_commit_cache_bits = static_cast<size_t>(23);
+
  private:
   // 128 entries
   size_t wp_snapshot_cache_bits = static_cast<size_t>(7);
-  // 8m entry, 64MB size
-  size_t wp_commit_cache_bits = static_cast<size_t>(23);
 
   // For testing, whether transaction name should be auto-generated or not. This
   // is useful for write unprepared which requires named transactions.
@@ -260,6 +307,14 @@ struct TransactionOptions {
   // The number of traversals to make during deadlock detection.
   int64_t deadlock_detect_depth = 50;
 
+  // With deadlock_detect, how long in microseconds a lock wait goes on
+  // before the transaction is added to the wait-for graph and checked for a
+  // deadlock. Most lock waits end sooner, and skip the graph and the global
+  // mutex guarding it. A deadlock is still found, only this much later: the
+  // last transaction of the cycle to reach the delay sees the whole cycle.
+  // If 0, every lock wait is checked right away.
+  int64_t deadlock_detect_delay_micros = 0;
+
   // The maximum number of bytes used for the write batch. 0 means no limit.
   size_t max_write_batch_size = 0;
 
@@ -251,6 +251,9 @@ class WriteBatchWithIndex : public WriteBatchBase {
 
   void SetMaxBytes(size_t max_bytes) override;
   size_t GetDataSize() const;
+  // Approximate memory used by the index, on top of GetDataSize() for the
+  // batch itself
+  size_t GetIndexMemoryUsage() const;
 
  private:
   friend class PessimisticTransactionDB;
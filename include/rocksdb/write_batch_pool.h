@@ -0,0 +1,74 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// WriteBatchPool keeps cleared WriteBatch objects around so that their
+// buffers can be reused, avoiding an allocation per batch (and per
+// reallocation while the batch grows) for applications that create and
+// destroy many batches:
+//
+//    WriteBatchPool pool(4096 /* reserved_bytes */);
+//    ...
+//    WriteBatch* batch = pool.Acquire();
+//    batch->Put("key", "value");
+//    Status s = db->Write(WriteOptions(), batch);
+//    pool.Release(batch);
+//
+// A batch may be released as soon as DB::Write() returns, since the DB does
+// not keep references to it. WriteBatch::Clear() retains the buffer
+// capacity, so a batch that is reused directly without a pool also avoids
+// reallocations.
+//
+// All methods are thread-safe.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rocksdb/write_batch.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class WriteBatchPool {
+ public:
+  // reserved_bytes: buffer capacity reserved by batches the pool creates.
+  // max_bytes: passed to the WriteBatch constructor, 0 means no limit.
+  // max_cached_batches: released batches beyond this many are freed.
+  // max_cached_capacity: released batches whose buffer has grown beyond
+  //   this many bytes are freed instead of cached, so that one very large
+  //   batch does not pin its memory in the pool. 0 means no limit.
+  explicit WriteBatchPool(size_t reserved_bytes = 0, size_t max_bytes = 0,
+                          size_t max_cached_batches = 64,
+                          size_t max_cached_capacity = 1 << 20);
+  ~WriteBatchPool();
+
+  WriteBatchPool(const WriteBatchPool&) = delete;
+  WriteBatchPool& operator=(const WriteBatchPool&) = delete;
+
+  // Returns an empty batch, reusing a released one when available. The
+  // caller owns the batch until it is passed to Release() or deleted.
+  WriteBatch* Acquire();
+
+  // Clears `batch` and keeps it for a later Acquire(). `batch` must not be
+  // used by the caller afterwards. It need not come from Acquire(), but it
+  // must have been constructed with this pool's max_bytes and without
+  // timestamps or protection info, since Acquire() hands it out as such.
+  void Release(WriteBatch* batch);
+
+  // Number of batches currently cached
+  size_t NumCached() const;
+
+ private:
+  const size_t reserved_bytes_;
+  const size_t max_bytes_;
+  const size_t max_cached_batches_;
+  const size_t max_cached_capacity_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<WriteBatch>> cached_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -22,6 +22,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class ArenaBlockPool;
+
 // Interface to block and signal DB instances.
 // Each DB instance contains ptr to StallInterface.
 class StallInterface {
@@ -35,6 +37,18 @@ class StallInterface {
 
 class WriteBufferManager {
  public:
+  // How a DB chooses the column family to flush when ShouldFlush() returns
+  // true.
+  enum class FlushVictimPolicy : char {
+    // Flush the column family with the oldest active memtable.
+    kOldestMemtable,
+    // Flush the column family whose memtables use the most memory relative
+    // to its share of the budget, as set by the column family options
+    // write_buffer_share_weight and write_buffer_min_share_bytes. Each DB
+    // sharing this manager applies the policy to its own column families.
+    kWeightedShare,
+  };
+
   // Parameters:
   // _buffer_size: _buffer_size = 0 indicates no limit. Memory won't be capped.
   // memory_usage() won't be valid and ShouldFlush() will always return true.
@@ -46,9 +60,14 @@ class WriteBufferManager {
   // allow_stall: if set true, it will enable stalling of writes when
   // memory_usage() exceeds buffer_size. It will wait for flush to complete and
   // memory usage to drop down.
-  explicit WriteBufferManager(size_t _buffer_size,
-                              std::shared_ptr<Cache> cache = {},
-                              bool allow_stall = false);
+  //
+  // flush_victim_policy: how the column family to flush is picked once the
+  // buffer is full. See FlushVictimPolicy.
+  explicit WriteBufferManager(
+      size_t _buffer_size, std::shared_ptr<Cache> cache = {},
+      bool allow_stall = false,
+      FlushVictimPolicy flush_victim_policy =
+          FlushVictimPolicy::kOldestMemtable);
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
   WriteBufferManager& operator=(const WriteBufferManager&) = delete;
@@ -62,6 +81,8 @@ class WriteBufferManager {
   // Returns true if pointer to cache is passed.
   bool cost_to_cache() const { return cache_rep_ != nullptr; }
 
+  FlushVictimPolicy flush_victim_policy() const { return flush_victim_policy_; }
+
   // Returns the total memory used by memtables.
   // Only valid if enabled()
   size_t memory_usage() const {
@@ -77,6 +98,22 @@ class WriteBufferManager {
     return dummy_size_.load(std::memory_order_relaxed);
   }
 
+  // Returns the highest memory_usage() since creation or the last call to
+  // ResetPeakMemoryUsage(). Only valid if enabled()
+  size_t peak_memory_usage() const {
+    return peak_memory_used_.load(std::memory_order_relaxed);
+  }
+
+  void ResetPeakMemoryUsage() {
+    peak_memory_used_.store(memory_usage(), std::memory_order_relaxed);
+  }
+
+  // Returns how many times writes were stalled because memory_usage()
+  // exceeded buffer_size().
+  uint64_t stall_count() const {
+    return stall_count_.load(std::memory_order_relaxed);
+  }
+
   // Returns the buffer_size.
   size_t buffer_size() const {
     return buffer_size_.load(std::memory_order_relaxed);
@@ -91,8 +128,24 @@ class WriteBufferManager {
     }
   }
 
+  // Keeps up to `max_bytes` of the arena blocks of freed memtables, to be
+  // reused by the memtables created next, in any DB or column family sharing
+  // this manager. Reused blocks are already faulted in (and mapped with huge
+  // pages if memtable_huge_page_size is set). When enabled(), blocks are only
+  // kept while they fit into buffer_size() together with memory_usage().
+  // Only memtables created after a non-zero size is set use the pool.
+  // 0 (the default) disables it and frees the blocks kept.
+  void SetArenaBlockPoolSize(size_t max_bytes);
+
+  // Returns the bytes in arena blocks kept for reuse.
+  size_t arena_block_pool_usage() const;
+
   // Below functions should be called by RocksDB internally.
 
+  // Returns the pool arena blocks come from, or nullptr if the pool is
+  // disabled.
+  ArenaBlockPool* arena_block_pool() const;
+
   // Should only be called from write thread
   bool ShouldFlush() const {
     if (enabled()) {
@@ -126,6 +179,7 @@ class WriteBufferManager {
       }
       if (IsStallThresholdExceeded()) {
         stall_active_.store(true, std::memory_order_relaxed);
+        stall_count_.fetch_add(1, std::memory_order_relaxed);
         return true;
       }
     }
@@ -164,6 +218,8 @@ class WriteBufferManager {
   // Memory that hasn't been scheduled to free.
   std::atomic<size_t> memory_active_;
   std::atomic<size_t> dummy_size_;
+  std::atomic<size_t> peak_memory_used_;
+  std::atomic<uint64_t> stall_count_;
   struct CacheRep;
   std::unique_ptr<CacheRep> cache_rep_;
   std::list<StallInterface*> queue_;
@@ -171,8 +227,11 @@ class WriteBufferManager {
   std::mutex mu_;
   bool allow_stall_;
   std::atomic<bool> stall_active_;
+  const FlushVictimPolicy flush_victim_policy_;
+  std::unique_ptr<ArenaBlockPool> arena_block_pool_;
 
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
+  void UpdatePeakMemoryUsage(size_t mem_used);
 };
 }  // namespace ROCKSDB_NAMESPACE
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <vector>
 
 #include "include/org_rocksdb_RocksIterator.h"
 #include "rocksdb/iterator.h"
@@ -267,3 +268,61 @@ jint Java_org_rocksdb_RocksIterator_valueDirect0(JNIEnv* env, jobject /*jobj*/,
   return ROCKSDB_NAMESPACE::JniUtil::copyToDirect(env, value_slice, jtarget,
                                                   jtarget_off, jtarget_len);
 }
+
+/*
+ * Class:     org_rocksdb_RocksIterator
+ * Method:    nextBatch0
+ * Signature: (JLjava/nio/ByteBuffer;II[ILjava/nio/ByteBuffer;II[I)I
+ */
+jint Java_org_rocksdb_RocksIterator_nextBatch0(
+    JNIEnv* env, jobject /*jobj*/, jlong handle, jobject jkeys, jint jkeys_off,
+    jint jkeys_len, jintArray jkey_lens, jobject jvals, jint jvals_off,
+    jint jvals_len, jintArray jval_lens) {
+  char* keys = reinterpret_cast<char*>(env->GetDirectBufferAddress(jkeys));
+  char* vals = reinterpret_cast<char*>(env->GetDirectBufferAddress(jvals));
+  if (keys == nullptr ||
+      env->GetDirectBufferCapacity(jkeys) < (jkeys_off + jkeys_len) ||
+      vals == nullptr ||
+      env->GetDirectBufferCapacity(jvals) < (jvals_off + jvals_len)) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(env,
+                                                     "Invalid target argument");
+    return 0;
+  }
+  const jsize max_entries = std::min(env->GetArrayLength(jkey_lens),
+                                     env->GetArrayLength(jval_lens));
+
+  // Copies the entries one after the other, for as long as they fit
+  auto* it = reinterpret_cast<ROCKSDB_NAMESPACE::Iterator*>(handle);
+  std::vector<jint> key_lens;
+  std::vector<jint> val_lens;
+  jint keys_used = 0;
+  jint vals_used = 0;
+  while (static_cast<jsize>(key_lens.size()) < max_entries && it->Valid()) {
+    ROCKSDB_NAMESPACE::Slice key = it->key();
+    ROCKSDB_NAMESPACE::Slice value = it->value();
+    if (static_cast<jint>(key.size()) > jkeys_len - keys_used ||
+        static_cast<jint>(value.size()) > jvals_len - vals_used) {
+      break;
+    }
+    memcpy(keys + jkeys_off + keys_used, key.data(), key.size());
+    memcpy(vals + jvals_off + vals_used, value.data(), value.size());
+    keys_used += static_cast<jint>(key.size());
+    vals_used += static_cast<jint>(value.size());
+    key_lens.push_back(static_cast<jint>(key.size()));
+    val_lens.push_back(static_cast<jint>(value.size()));
+    it->Next();
+  }
+
+  const jsize num_entries = static_cast<jsize>(key_lens.size());
+  env->SetIntArrayRegion(jkey_lens, 0, num_entries, key_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+  env->SetIntArrayRegion(jval_lens, 0, num_entries, val_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+  return num_entries;
+}
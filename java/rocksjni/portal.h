@@ -4568,6 +4568,8 @@ class CompactionPriorityJni {
         return 0x2;
       case ROCKSDB_NAMESPACE::CompactionPri::kMinOverlappingRatio:
         return 0x3;
+      case ROCKSDB_NAMESPACE::CompactionPri::kHotnessAware:
+        return 0x4;
       default:
         return 0x0;  // undefined
     }
@@ -4586,6 +4588,8 @@ class CompactionPriorityJni {
         return ROCKSDB_NAMESPACE::CompactionPri::kOldestSmallestSeqFirst;
       case 0x3:
         return ROCKSDB_NAMESPACE::CompactionPri::kMinOverlappingRatio;
+      case 0x4:
+        return ROCKSDB_NAMESPACE::CompactionPri::kHotnessAware;
       default:
         // undefined/default
         return ROCKSDB_NAMESPACE::CompactionPri::kByCompensatedSize;
@@ -5000,6 +5004,52 @@ class TickerTypeJni {
         return -0x1C;
       case ROCKSDB_NAMESPACE::Tickers::MEMTABLE_GARBAGE_BYTES_AT_FLUSH:
         return -0x1D;
+      case ROCKSDB_NAMESPACE::Tickers::WAL_COMPRESSION_INPUT_BYTES:
+        return -0x1E;
+      case ROCKSDB_NAMESPACE::Tickers::WAL_COMPRESSION_OUTPUT_BYTES:
+        return -0x1F;
+      case ROCKSDB_NAMESPACE::Tickers::RANGE_FILTER_USEFUL:
+        return -0x20;
+      case ROCKSDB_NAMESPACE::Tickers::HOT_KEY_CACHE_HIT:
+        return -0x21;
+      case ROCKSDB_NAMESPACE::Tickers::HOT_KEY_CACHE_MISS:
+        return -0x22;
+      case ROCKSDB_NAMESPACE::Tickers::COMPACT_COPIED_DATA_BLOCKS:
+        return -0x23;
+      case ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_HIT:
+        return -0x24;
+      case ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_MISS:
+        return -0x25;
+      case ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_ADD:
+        return -0x26;
+      case ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_ADD_FAILURES:
+        return -0x27;
+      case ROCKSDB_NAMESPACE::Tickers::HEDGED_READS_ISSUED:
+        return -0x28;
+      case ROCKSDB_NAMESPACE::Tickers::HEDGED_READS_WON:
+        return -0x29;
+      case ROCKSDB_NAMESPACE::Tickers::TXN_COMMIT_CACHE_EVICTED_LOOKUP:
+        return -0x2A;
+      case ROCKSDB_NAMESPACE::Tickers::TXN_PREPARE_MUTEX_SKIPPED:
+        return -0x2B;
+      case ROCKSDB_NAMESPACE::Tickers::ADAPTIVE_COMPRESSION_SKIPPED:
+        return -0x2C;
+      case ROCKSDB_NAMESPACE::Tickers::ADAPTIVE_COMPRESSION_FAST:
+        return -0x2D;
+      case ROCKSDB_NAMESPACE::Tickers::ADAPTIVE_COMPRESSION_CONFIGURED:
+        return -0x2E;
+      case ROCKSDB_NAMESPACE::Tickers::MERGE_OPERANDS_COLLAPSED:
+        return -0x2F;
+      case ROCKSDB_NAMESPACE::Tickers::MERGE_OPERANDS_COLLAPSE_ABORTED:
+        return -0x30;
+      case ROCKSDB_NAMESPACE::Tickers::MEMTABLE_BLOOM_CHECKED:
+        return -0x31;
+      case ROCKSDB_NAMESPACE::Tickers::MEMTABLE_BLOOM_USEFUL:
+        return -0x32;
+      case ROCKSDB_NAMESPACE::Tickers::WRITE_FAST_PATH:
+        return -0x33;
+      case ROCKSDB_NAMESPACE::Tickers::WRITE_FAST_PATH_FALLBACK:
+        return -0x34;
       case ROCKSDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
         // 0x5F for backwards compatibility on current minor version.
         return 0x5F;
@@ -5330,6 +5380,52 @@ class TickerTypeJni {
         return ROCKSDB_NAMESPACE::Tickers::MEMTABLE_PAYLOAD_BYTES_AT_FLUSH;
       case -0x1D:
         return ROCKSDB_NAMESPACE::Tickers::MEMTABLE_GARBAGE_BYTES_AT_FLUSH;
+      case -0x1E:
+        return ROCKSDB_NAMESPACE::Tickers::WAL_COMPRESSION_INPUT_BYTES;
+      case -0x1F:
+        return ROCKSDB_NAMESPACE::Tickers::WAL_COMPRESSION_OUTPUT_BYTES;
+      case -0x20:
+        return ROCKSDB_NAMESPACE::Tickers::RANGE_FILTER_USEFUL;
+      case -0x21:
+        return ROCKSDB_NAMESPACE::Tickers::HOT_KEY_CACHE_HIT;
+      case -0x22:
+        return ROCKSDB_NAMESPACE::Tickers::HOT_KEY_CACHE_MISS;
+      case -0x23:
+        return ROCKSDB_NAMESPACE::Tickers::COMPACT_COPIED_DATA_BLOCKS;
+      case -0x24:
+        return ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_HIT;
+      case -0x25:
+        return ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_MISS;
+      case -0x26:
+        return ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_ADD;
+      case -0x27:
+        return ROCKSDB_NAMESPACE::Tickers::BLOB_DB_CACHE_ADD_FAILURES;
+      case -0x28:
+        return ROCKSDB_NAMESPACE::Tickers::HEDGED_READS_ISSUED;
+      case -0x29:
+        return ROCKSDB_NAMESPACE::Tickers::HEDGED_READS_WON;
+      case -0x2A:
+        return ROCKSDB_NAMESPACE::Tickers::TXN_COMMIT_CACHE_EVICTED_LOOKUP;
+      case -0x2B:
+        return ROCKSDB_NAMESPACE::Tickers::TXN_PREPARE_MUTEX_SKIPPED;
+      case -0x2C:
+        return ROCKSDB_NAMESPACE::Tickers::ADAPTIVE_COMPRESSION_SKIPPED;
+      case -0x2D:
+        return ROCKSDB_NAMESPACE::Tickers::ADAPTIVE_COMPRESSION_FAST;
+      case -0x2E:
+        return ROCKSDB_NAMESPACE::Tickers::ADAPTIVE_COMPRESSION_CONFIGURED;
+      case -0x2F:
+        return ROCKSDB_NAMESPACE::Tickers::MERGE_OPERANDS_COLLAPSED;
+      case -0x30:
+        return ROCKSDB_NAMESPACE::Tickers::MERGE_OPERANDS_COLLAPSE_ABORTED;
+      case -0x31:
+        return ROCKSDB_NAMESPACE::Tickers::MEMTABLE_BLOOM_CHECKED;
+      case -0x32:
+        return ROCKSDB_NAMESPACE::Tickers::MEMTABLE_BLOOM_USEFUL;
+      case -0x33:
+        return ROCKSDB_NAMESPACE::Tickers::WRITE_FAST_PATH;
+      case -0x34:
+        return ROCKSDB_NAMESPACE::Tickers::WRITE_FAST_PATH_FALLBACK;
       case 0x5F:
         // 0x5F for backwards compatibility on current minor version.
         return ROCKSDB_NAMESPACE::Tickers::TICKER_ENUM_MAX;
@@ -5451,6 +5547,56 @@ class HistogramTypeJni {
         return 0x31;
       case ROCKSDB_NAMESPACE::Histograms::ERROR_HANDLER_AUTORESUME_RETRY_COUNT:
         return 0x31;
+      case ROCKSDB_NAMESPACE::Histograms::WAL_COMPRESSION_TIMES_NANOS:
+        return 0x33;
+      case ROCKSDB_NAMESPACE::Histograms::NUM_LEVELS_READ_PER_GET:
+        return 0x34;
+      case ROCKSDB_NAMESPACE::Histograms::DB_MUTEX_WAIT_GET_SNAPSHOT_MICROS:
+        return 0x35;
+      case ROCKSDB_NAMESPACE::Histograms::DB_MUTEX_WAIT_WRITE_MICROS:
+        return 0x36;
+      case ROCKSDB_NAMESPACE::Histograms::DB_MUTEX_WAIT_BG_JOB_MICROS:
+        return 0x37;
+      case ROCKSDB_NAMESPACE::Histograms::COMPACTION_PICK_MICROS:
+        return 0x38;
+      case ROCKSDB_NAMESPACE::Histograms::FLUSH_QUEUE_WAIT_MICROS:
+        return 0x39;
+      case ROCKSDB_NAMESPACE::Histograms::COMPACTION_QUEUE_WAIT_MICROS:
+        return 0x3A;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_MEMTABLE_NANOS:
+        return 0x3B;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_FILTER_NANOS:
+        return 0x3C;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_INDEX_NANOS:
+        return 0x3D;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_DATA_BLOCK_NANOS:
+        return 0x3E;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_DECOMPRESS_NANOS:
+        return 0x3F;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_IO_NANOS:
+        return 0x40;
+      case ROCKSDB_NAMESPACE::Histograms::FILE_READ_USER_MICROS:
+        return 0x41;
+      case ROCKSDB_NAMESPACE::Histograms::FILE_READ_FLUSH_MICROS:
+        return 0x42;
+      case ROCKSDB_NAMESPACE::Histograms::FILE_READ_COMPACTION_MICROS:
+        return 0x43;
+      case ROCKSDB_NAMESPACE::Histograms::FILE_WRITE_USER_MICROS:
+        return 0x44;
+      case ROCKSDB_NAMESPACE::Histograms::FILE_WRITE_FLUSH_MICROS:
+        return 0x45;
+      case ROCKSDB_NAMESPACE::Histograms::FILE_WRITE_COMPACTION_MICROS:
+        return 0x46;
+      case ROCKSDB_NAMESPACE::Histograms::WAL_FILE_WRITE_MICROS:
+        return 0x47;
+      case ROCKSDB_NAMESPACE::Histograms::MANIFEST_FILE_WRITE_MICROS:
+        return 0x48;
+      case ROCKSDB_NAMESPACE::Histograms::SST_FILE_WRITE_MICROS:
+        return 0x49;
+      case ROCKSDB_NAMESPACE::Histograms::BLOB_FILE_WRITE_MICROS:
+        return 0x4A;
+      case ROCKSDB_NAMESPACE::Histograms::CHECKPOINT_MICROS:
+        return 0x4B;
       case ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX:
         // 0x1F for backwards compatibility on current minor version.
         return 0x1F;
@@ -5568,6 +5714,56 @@ class HistogramTypeJni {
       case 0x32:
         return ROCKSDB_NAMESPACE::Histograms::
             ERROR_HANDLER_AUTORESUME_RETRY_COUNT;
+      case 0x33:
+        return ROCKSDB_NAMESPACE::Histograms::WAL_COMPRESSION_TIMES_NANOS;
+      case 0x34:
+        return ROCKSDB_NAMESPACE::Histograms::NUM_LEVELS_READ_PER_GET;
+      case 0x35:
+        return ROCKSDB_NAMESPACE::Histograms::DB_MUTEX_WAIT_GET_SNAPSHOT_MICROS;
+      case 0x36:
+        return ROCKSDB_NAMESPACE::Histograms::DB_MUTEX_WAIT_WRITE_MICROS;
+      case 0x37:
+        return ROCKSDB_NAMESPACE::Histograms::DB_MUTEX_WAIT_BG_JOB_MICROS;
+      case 0x38:
+        return ROCKSDB_NAMESPACE::Histograms::COMPACTION_PICK_MICROS;
+      case 0x39:
+        return ROCKSDB_NAMESPACE::Histograms::FLUSH_QUEUE_WAIT_MICROS;
+      case 0x3A:
+        return ROCKSDB_NAMESPACE::Histograms::COMPACTION_QUEUE_WAIT_MICROS;
+      case 0x3B:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_MEMTABLE_NANOS;
+      case 0x3C:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_FILTER_NANOS;
+      case 0x3D:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_INDEX_NANOS;
+      case 0x3E:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_DATA_BLOCK_NANOS;
+      case 0x3F:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_DECOMPRESS_NANOS;
+      case 0x40:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_IO_NANOS;
+      case 0x41:
+        return ROCKSDB_NAMESPACE::Histograms::FILE_READ_USER_MICROS;
+      case 0x42:
+        return ROCKSDB_NAMESPACE::Histograms::FILE_READ_FLUSH_MICROS;
+      case 0x43:
+        return ROCKSDB_NAMESPACE::Histograms::FILE_READ_COMPACTION_MICROS;
+      case 0x44:
+        return ROCKSDB_NAMESPACE::Histograms::FILE_WRITE_USER_MICROS;
+      case 0x45:
+        return ROCKSDB_NAMESPACE::Histograms::FILE_WRITE_FLUSH_MICROS;
+      case 0x46:
+        return ROCKSDB_NAMESPACE::Histograms::FILE_WRITE_COMPACTION_MICROS;
+      case 0x47:
+        return ROCKSDB_NAMESPACE::Histograms::WAL_FILE_WRITE_MICROS;
+      case 0x48:
+        return ROCKSDB_NAMESPACE::Histograms::MANIFEST_FILE_WRITE_MICROS;
+      case 0x49:
+        return ROCKSDB_NAMESPACE::Histograms::SST_FILE_WRITE_MICROS;
+      case 0x4A:
+        return ROCKSDB_NAMESPACE::Histograms::BLOB_FILE_WRITE_MICROS;
+      case 0x4B:
+        return ROCKSDB_NAMESPACE::Histograms::CHECKPOINT_MICROS;
       case 0x1F:
         // 0x1F for backwards compatibility on current minor version.
         return ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX;
@@ -6453,6 +6649,8 @@ class ChecksumTypeJni {
         return 0x2;
       case ROCKSDB_NAMESPACE::ChecksumType::kxxHash64:
         return 0x3;
+      case ROCKSDB_NAMESPACE::ChecksumType::kXXH3:
+        return 0x4;
       default:
         return 0x7F;  // undefined
     }
@@ -6471,6 +6669,8 @@ class ChecksumTypeJni {
         return ROCKSDB_NAMESPACE::ChecksumType::kxxHash;
       case 0x3:
         return ROCKSDB_NAMESPACE::ChecksumType::kxxHash64;
+      case 0x4:
+        return ROCKSDB_NAMESPACE::ChecksumType::kXXH3;
       default:
         // undefined/default
         return ROCKSDB_NAMESPACE::ChecksumType::kCRC32c;
@@ -1887,6 +1887,105 @@ jobjectArray Java_org_rocksdb_RocksDB_multiGet__JJ_3_3B_3I_3I_3J(
       jkey_offs, jkey_lens, jcolumn_family_handles);
 }
 
+/*
+ * Class:     org_rocksdb_RocksDB
+ * Method:    multiGetDirect
+ * Signature: (JJJLjava/nio/ByteBuffer;I[ILjava/nio/ByteBuffer;II)[I
+ */
+jintArray Java_org_rocksdb_RocksDB_multiGetDirect(
+    JNIEnv* env, jobject /*jdb*/, jlong jdb_handle, jlong jropt_handle,
+    jlong jcf_handle, jobject jkeys, jint jkeys_off, jintArray jkey_lens,
+    jobject jvals, jint jvals_off, jint jvals_len) {
+  static const int kNotFound = -1;
+  auto* db = reinterpret_cast<ROCKSDB_NAMESPACE::DB*>(jdb_handle);
+  auto* ro_opt =
+      reinterpret_cast<ROCKSDB_NAMESPACE::ReadOptions*>(jropt_handle);
+  auto* cf_handle =
+      reinterpret_cast<ROCKSDB_NAMESPACE::ColumnFamilyHandle*>(jcf_handle);
+  if (cf_handle == nullptr) {
+    cf_handle = db->DefaultColumnFamily();
+  }
+
+  const jsize num_keys = env->GetArrayLength(jkey_lens);
+  std::vector<jint> key_lens(num_keys);
+  env->GetIntArrayRegion(jkey_lens, 0, num_keys, key_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return nullptr;
+  }
+
+  char* keys = reinterpret_cast<char*>(env->GetDirectBufferAddress(jkeys));
+  if (keys == nullptr) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env,
+        "Invalid keys argument (argument is not a valid direct ByteBuffer)");
+    return nullptr;
+  }
+  char* vals = reinterpret_cast<char*>(env->GetDirectBufferAddress(jvals));
+  if (vals == nullptr ||
+      env->GetDirectBufferCapacity(jvals) < (jvals_off + jvals_len)) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env,
+        "Invalid values argument (argument is not a valid direct ByteBuffer)");
+    return nullptr;
+  }
+
+  // The keys are packed one after the other
+  std::vector<ROCKSDB_NAMESPACE::Slice> key_slices;
+  key_slices.reserve(num_keys);
+  jlong keys_end = jkeys_off;
+  for (jint key_len : key_lens) {
+    key_slices.emplace_back(keys + keys_end, key_len);
+    keys_end += key_len;
+  }
+  if (env->GetDirectBufferCapacity(jkeys) < keys_end) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env, "Invalid keys argument (the key lengths exceed the buffer)");
+    return nullptr;
+  }
+
+  std::vector<ROCKSDB_NAMESPACE::PinnableSlice> values(num_keys);
+  std::vector<ROCKSDB_NAMESPACE::Status> statuses(num_keys);
+  db->MultiGet(ro_opt == nullptr ? ROCKSDB_NAMESPACE::ReadOptions() : *ro_opt,
+               cf_handle, num_keys, key_slices.data(), values.data(),
+               statuses.data());
+
+  // The values are packed one after the other, for as long as they fit
+  std::vector<jint> val_lens(num_keys);
+  jint vals_used = 0;
+  bool vals_full = false;
+  for (jsize i = 0; i < num_keys; i++) {
+    if (statuses[i].IsNotFound()) {
+      val_lens[i] = kNotFound;
+      continue;
+    }
+    if (!statuses[i].ok()) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(env, statuses[i]);
+      return nullptr;
+    }
+    val_lens[i] = static_cast<jint>(values[i].size());
+    if (!vals_full && val_lens[i] <= jvals_len - vals_used) {
+      memcpy(vals + jvals_off + vals_used, values[i].data(), values[i].size());
+      vals_used += val_lens[i];
+    } else {
+      vals_full = true;
+    }
+  }
+
+  jintArray jval_lens = env->NewIntArray(num_keys);
+  if (jval_lens == nullptr) {
+    // exception thrown: OutOfMemoryError
+    return nullptr;
+  }
+  env->SetIntArrayRegion(jval_lens, 0, num_keys, val_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    env->DeleteLocalRef(jval_lens);
+    return nullptr;
+  }
+  return jval_lens;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // ROCKSDB_NAMESPACE::DB::KeyMayExist
 bool key_may_exist_helper(JNIEnv* env, jlong jdb_handle, jlong jcf_handle,
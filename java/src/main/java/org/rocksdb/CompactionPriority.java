@@ -33,7 +33,15 @@ public enum CompactionPriority {
    * and its size is the smallest. It in many cases can optimize write
    * amplification.
    */
-  MinOverlappingRatio((byte)0x3);
+  MinOverlappingRatio((byte)0x3),
+
+  /**
+   * First compact files that the most reads per byte had to look up, so
+   * that frequently read key ranges move down and reads of them go through
+   * fewer levels. Files read equally often are ordered as with
+   * MinOverlappingRatio.
+   */
+  HotnessAware((byte)0x4);
 
 
   private final byte value;
@@ -180,6 +180,131 @@ public enum HistogramType {
    */
   ERROR_HANDLER_AUTORESUME_RETRY_COUNT((byte) 0x32),
 
+  /**
+   * Time spent compressing WAL records.
+   */
+  WAL_COMPRESSION_TIMES_NANOS((byte) 0x33),
+
+  /**
+   * Number of table files a Get() looked the key up in.
+   */
+  NUM_LEVELS_READ_PER_GET((byte) 0x34),
+
+  /**
+   * Time GetSnapshot() waited for the DB mutex.
+   */
+  DB_MUTEX_WAIT_GET_SNAPSHOT_MICROS((byte) 0x35),
+
+  /**
+   * Time the leader of a write group waited for the DB mutex.
+   */
+  DB_MUTEX_WAIT_WRITE_MICROS((byte) 0x36),
+
+  /**
+   * Time a background flush or compaction waited for the DB mutex to start.
+   */
+  DB_MUTEX_WAIT_BG_JOB_MICROS((byte) 0x37),
+
+  /**
+   * Time spent picking a compaction, with the DB mutex held.
+   */
+  COMPACTION_PICK_MICROS((byte) 0x38),
+
+  /**
+   * Time a background flush waited in the thread pool queue to start.
+   */
+  FLUSH_QUEUE_WAIT_MICROS((byte) 0x39),
+
+  /**
+   * Time a background compaction waited in the thread pool queue to start.
+   */
+  COMPACTION_QUEUE_WAIT_MICROS((byte) 0x3A),
+
+  /**
+   * Time a sampled Get() spent on memtables.
+   */
+  SAMPLED_GET_MEMTABLE_NANOS((byte) 0x3B),
+
+  /**
+   * Time a sampled Get() spent on filter blocks.
+   */
+  SAMPLED_GET_FILTER_NANOS((byte) 0x3C),
+
+  /**
+   * Time a sampled Get() spent on index blocks.
+   */
+  SAMPLED_GET_INDEX_NANOS((byte) 0x3D),
+
+  /**
+   * Time a sampled Get() spent on data blocks.
+   */
+  SAMPLED_GET_DATA_BLOCK_NANOS((byte) 0x3E),
+
+  /**
+   * Time a sampled Get() spent on decompressing blocks.
+   */
+  SAMPLED_GET_DECOMPRESS_NANOS((byte) 0x3F),
+
+  /**
+   * Time a sampled Get() spent on file reads.
+   */
+  SAMPLED_GET_IO_NANOS((byte) 0x40),
+
+  /**
+   * Latency of the file reads done for user requests.
+   */
+  FILE_READ_USER_MICROS((byte) 0x41),
+
+  /**
+   * Latency of the file reads done for flushes.
+   */
+  FILE_READ_FLUSH_MICROS((byte) 0x42),
+
+  /**
+   * Latency of the file reads done for compactions.
+   */
+  FILE_READ_COMPACTION_MICROS((byte) 0x43),
+
+  /**
+   * Latency of the file writes done for user requests.
+   */
+  FILE_WRITE_USER_MICROS((byte) 0x44),
+
+  /**
+   * Latency of the file writes done for flushes.
+   */
+  FILE_WRITE_FLUSH_MICROS((byte) 0x45),
+
+  /**
+   * Latency of the file writes done for compactions.
+   */
+  FILE_WRITE_COMPACTION_MICROS((byte) 0x46),
+
+  /**
+   * Latency of the WAL file writes.
+   */
+  WAL_FILE_WRITE_MICROS((byte) 0x47),
+
+  /**
+   * Latency of the MANIFEST file writes.
+   */
+  MANIFEST_FILE_WRITE_MICROS((byte) 0x48),
+
+  /**
+   * Latency of the SST file writes.
+   */
+  SST_FILE_WRITE_MICROS((byte) 0x49),
+
+  /**
+   * Latency of the blob file writes.
+   */
+  BLOB_FILE_WRITE_MICROS((byte) 0x4A),
+
+  /**
+   * Time spent creating checkpoints.
+   */
+  CHECKPOINT_MICROS((byte) 0x4B),
+
   // 0x1F for backwards compatibility on current minor version.
   HISTOGRAM_ENUM_MAX((byte) 0x1F);
 
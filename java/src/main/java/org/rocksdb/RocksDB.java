@@ -2544,6 +2544,79 @@ public class RocksDB extends RocksObject {
         keysArray, keyOffsets, keyLengths, cfHandles));
   }
 
+  /**
+   * Looks up a batch of keys in the default column family without copying
+   * them into Java arrays or allocating an array per value.
+   *
+   * @param opt Read options.
+   * @param keys the keys, one after the other from the position of the
+   *     buffer. Supports direct buffer only.
+   * @param keyLengths the length of every key in {@code keys}.
+   * @param values the out-value to receive the values found, one after the
+   *     other from the position of the buffer, for as long as they fit: once
+   *     a value does not fit, neither it nor any of the following values are
+   *     copied. Its limit is set to the end of the values copied.
+   *     Supports direct buffer only.
+   * @return the length of the value of every key, which may be more than
+   *     was copied into {@code values}, or RocksDB.NOT_FOUND if the key was
+   *     not found.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   */
+  public int[] multiGetDirect(final ReadOptions opt, final ByteBuffer keys,
+      final int[] keyLengths, final ByteBuffer values)
+      throws RocksDBException {
+    return multiGetDirect(opt, null, keys, keyLengths, values);
+  }
+
+  /**
+   * Looks up a batch of keys in a column family without copying them into
+   * Java arrays or allocating an array per value.
+   *
+   * @param opt Read options.
+   * @param columnFamilyHandle {@link org.rocksdb.ColumnFamilyHandle}
+   *     instance, or null for the default column family.
+   * @param keys the keys, one after the other from the position of the
+   *     buffer. Supports direct buffer only.
+   * @param keyLengths the length of every key in {@code keys}.
+   * @param values the out-value to receive the values found, one after the
+   *     other from the position of the buffer, for as long as they fit: once
+   *     a value does not fit, neither it nor any of the following values are
+   *     copied. Its limit is set to the end of the values copied.
+   *     Supports direct buffer only.
+   * @return the length of the value of every key, which may be more than
+   *     was copied into {@code values}, or RocksDB.NOT_FOUND if the key was
+   *     not found.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   */
+  public int[] multiGetDirect(final ReadOptions opt,
+      final ColumnFamilyHandle columnFamilyHandle, final ByteBuffer keys,
+      final int[] keyLengths, final ByteBuffer values)
+      throws RocksDBException {
+    assert keys.isDirect() && values.isDirect();
+    final int[] valueLengths = multiGetDirect(nativeHandle_,
+        opt == null ? 0 : opt.nativeHandle_,
+        columnFamilyHandle == null ? 0 : columnFamilyHandle.nativeHandle_,
+        keys, keys.position(), keyLengths, values, values.position(),
+        values.remaining());
+    int valuesCopied = 0;
+    for (final int valueLength : valueLengths) {
+      if (valueLength == NOT_FOUND) {
+        continue;
+      }
+      if (valueLength > values.remaining() - valuesCopied) {
+        break;
+      }
+      valuesCopied += valueLength;
+    }
+    values.limit(values.position() + valuesCopied);
+    keys.position(keys.limit());
+    return valueLengths;
+  }
+
   /**
    * If the key definitely does not exist in the database, then this method
    * returns false, otherwise it returns true if the key might exist.
@@ -4645,6 +4718,11 @@ public class RocksDB extends RocksObject {
   private native byte[][] multiGet(final long dbHandle, final long rOptHandle,
       final byte[][] keys, final int[] keyOffsets, final int[] keyLengths,
       final long[] columnFamilyHandles);
+  private native int[] multiGetDirect(final long dbHandle,
+      final long rOptHandle, final long cfHandle, final ByteBuffer keys,
+      final int keysOffset, final int[] keyLengths, final ByteBuffer values,
+      final int valuesOffset, final int valuesLength)
+      throws RocksDBException;
   private native boolean keyMayExist(
       final long handle, final long cfHandle, final long readOptHandle,
       final byte[] key, final int keyOffset, final int keyLength);
@@ -96,6 +96,42 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
     return result;
   }
 
+  /**
+   * <p>Copies the entries from the current one on into the given buffers and
+   * moves the iterator past them, stopping at the end of the iteration, after
+   * {@code keyLengths.length} entries or at the first entry that does not
+   * fit.</p>
+   *
+   * @param keys the out-value to receive the keys, one after the other from
+   *     the position of the buffer. Limit is set to the end of the keys
+   *     copied. Supports direct buffer only.
+   * @param keyLengths the out-value to receive the length of every key.
+   * @param values the out-value to receive the values, one after the other
+   *     from the position of the buffer. Limit is set to the end of the values
+   *     copied. Supports direct buffer only.
+   * @param valueLengths the out-value to receive the length of every value.
+   *     Must be as long as {@code keyLengths}.
+   * @return the number of entries copied. 0 while {@link #isValid()} means
+   *     that the current entry does not fit into the buffers.
+   */
+  public int nextBatch(final ByteBuffer keys, final int[] keyLengths,
+      final ByteBuffer values, final int[] valueLengths) {
+    assert (isOwningHandle() && keys.isDirect() && values.isDirect());
+    assert (keyLengths.length == valueLengths.length);
+    final int count = nextBatch0(nativeHandle_, keys, keys.position(),
+        keys.remaining(), keyLengths, values, values.position(),
+        values.remaining(), valueLengths);
+    int keysCopied = 0;
+    int valuesCopied = 0;
+    for (int i = 0; i < count; i++) {
+      keysCopied += keyLengths[i];
+      valuesCopied += valueLengths[i];
+    }
+    keys.limit(keys.position() + keysCopied);
+    values.limit(values.position() + valuesCopied);
+    return count;
+  }
+
   @Override protected final native void disposeInternal(final long handle);
   @Override final native boolean isValid0(long handle);
   @Override final native void seekToFirst0(long handle);
@@ -116,4 +152,7 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
   private native byte[] value0(long handle);
   private native int keyDirect0(long handle, ByteBuffer buffer, int bufferOffset, int bufferLen);
   private native int valueDirect0(long handle, ByteBuffer buffer, int bufferOffset, int bufferLen);
+  private native int nextBatch0(long handle, ByteBuffer keys, int keysOffset,
+      int keysLen, int[] keyLengths, ByteBuffer values, int valuesOffset,
+      int valuesLen, int[] valueLengths);
 }
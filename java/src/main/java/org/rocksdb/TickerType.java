@@ -763,6 +763,125 @@ public enum TickerType {
      * Outdated bytes of data present on memtable at flush time.
      */
     MEMTABLE_GARBAGE_BYTES_AT_FLUSH((byte) -0x1D),
+    /**
+     * Bytes of WAL records passed to streaming compression.
+     */
+    WAL_COMPRESSION_INPUT_BYTES((byte) -0x1E),
+    /**
+     * Bytes of WAL records produced by streaming compression.
+     */
+    WAL_COMPRESSION_OUTPUT_BYTES((byte) -0x1F),
+    /**
+     * Number of table file seeks skipped by the range filter.
+     */
+    RANGE_FILTER_USEFUL((byte) -0x20),
+    /**
+     * Number of Get() calls answered by the hot key cache.
+     */
+    HOT_KEY_CACHE_HIT((byte) -0x21),
+    /**
+     * Number of Get() calls not found in the hot key cache.
+     */
+    HOT_KEY_CACHE_MISS((byte) -0x22),
+
+    /**
+     * Number of data blocks compactions copied into their output as they
+     * were stored.
+     */
+    COMPACT_COPIED_DATA_BLOCKS((byte) -0x23),
+
+    /**
+     * Number of blob lookups in the blob cache that found the blob.
+     */
+    BLOB_DB_CACHE_HIT((byte) -0x24),
+
+    /**
+     * Number of blob lookups in the blob cache that did not find the blob.
+     */
+    BLOB_DB_CACHE_MISS((byte) -0x25),
+
+    /**
+     * Number of blobs added to the blob cache.
+     */
+    BLOB_DB_CACHE_ADD((byte) -0x26),
+
+    /**
+     * Number of blobs that could not be added to the blob cache.
+     */
+    BLOB_DB_CACHE_ADD_FAILURES((byte) -0x27),
+
+    /**
+     * Number of second reads issued for slow reads.
+     */
+    HEDGED_READS_ISSUED((byte) -0x28),
+
+    /**
+     * Number of second reads that completed before the first read.
+     */
+    HEDGED_READS_WON((byte) -0x29),
+
+    /**
+     * # of WritePrepared visibility checks of a prepare sequence number
+     * already evicted from the commit cache.
+     */
+    TXN_COMMIT_CACHE_EVICTED_LOOKUP((byte) -0x2A),
+
+    /**
+     * # of times prepare_mutex_ was not acquired despite lingering prepared
+     * transactions.
+     */
+    TXN_PREPARE_MUTEX_SKIPPED((byte) -0x2B),
+
+    /**
+     * # of data blocks adaptive compression stored uncompressed as they
+     * looked incompressible.
+     */
+    ADAPTIVE_COMPRESSION_SKIPPED((byte) -0x2C),
+
+    /**
+     * # of data blocks adaptive compression compressed with the fast
+     * compression instead of the configured one.
+     */
+    ADAPTIVE_COMPRESSION_FAST((byte) -0x2D),
+
+    /**
+     * # of data blocks adaptive compression compressed as configured.
+     */
+    ADAPTIVE_COMPRESSION_CONFIGURED((byte) -0x2E),
+
+    /**
+     * # of Get()s that wrote the value they merged back.
+     */
+    MERGE_OPERANDS_COLLAPSED((byte) -0x2F),
+
+    /**
+     * # of Get()s that could not write the value they merged back, mostly as
+     * the key was written since the read or writes were stalled.
+     */
+    MERGE_OPERANDS_COLLAPSE_ABORTED((byte) -0x30),
+
+    /**
+     * # of keys Get() and MultiGet() looked up in memtables with a bloom
+     * filter.
+     */
+    MEMTABLE_BLOOM_CHECKED((byte) -0x31),
+
+    /**
+     * # of keys looked up in memtables that their bloom filter ruled out.
+     */
+    MEMTABLE_BLOOM_USEFUL((byte) -0x32),
+
+    /**
+     * # of writes that skipped the write thread with
+     * enable_no_wal_write_fast_path.
+     */
+    WRITE_FAST_PATH((byte) -0x33),
+
+    /**
+     * # of writes eligible for the no-WAL write fast path that went through
+     * the write thread.
+     */
+    WRITE_FAST_PATH_FALLBACK((byte) -0x34),
 
     TICKER_ENUM_MAX((byte) 0x5F);
 
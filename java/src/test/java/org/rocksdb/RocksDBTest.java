@@ -433,6 +433,40 @@ public class RocksDBTest {
     }
   }
 
+  @Test
+  public void multiGetDirect() throws RocksDBException {
+    try (final RocksDB db = RocksDB.open(dbFolder.getRoot().getAbsolutePath());
+         final ReadOptions rOpt = new ReadOptions()) {
+      db.put("key1".getBytes(), "value".getBytes());
+      db.put("key3".getBytes(), "12345678".getBytes());
+
+      final ByteBuffer keys = ByteBuffer.allocateDirect(12);
+      keys.put("key1key2key3".getBytes());
+      keys.flip();
+      final int[] keyLengths = {4, 4, 4};
+      ByteBuffer values = ByteBuffer.allocateDirect(16);
+      int[] valueLengths = db.multiGetDirect(rOpt, keys, keyLengths, values);
+      assertThat(valueLengths).isEqualTo(new int[] {5, RocksDB.NOT_FOUND, 8});
+      assertThat(keys.position()).isEqualTo(12);
+      assertThat(values.position()).isEqualTo(0);
+      assertThat(values.limit()).isEqualTo(13);
+      byte[] tmp = new byte[13];
+      values.get(tmp);
+      assertThat(tmp).isEqualTo("value12345678".getBytes());
+
+      // The second value does not fit
+      keys.flip();
+      values = ByteBuffer.allocateDirect(8);
+      valueLengths = db.multiGetDirect(rOpt, db.getDefaultColumnFamily(),
+          keys, keyLengths, values);
+      assertThat(valueLengths).isEqualTo(new int[] {5, RocksDB.NOT_FOUND, 8});
+      assertThat(values.limit()).isEqualTo(5);
+      tmp = new byte[5];
+      values.get(tmp);
+      assertThat(tmp).isEqualTo("value".getBytes());
+    }
+  }
+
   @Test
   public void multiGetAsList() throws RocksDBException {
     try (final RocksDB db = RocksDB.open(dbFolder.getRoot().getAbsolutePath());
@@ -106,6 +106,38 @@ public class RocksIteratorTest {
         assertThat(key.limit()).isEqualTo(4);
       }
 
+      try (final RocksIterator iterator = db.newIterator()) {
+        iterator.seekToFirst();
+        ByteBuffer keys = ByteBuffer.allocateDirect(4);
+        ByteBuffer values = ByteBuffer.allocateDirect(16);
+        final int[] keyLengths = new int[4];
+        final int[] valueLengths = new int[4];
+        // Only the first entry fits
+        assertThat(iterator.nextBatch(keys, keyLengths, values, valueLengths))
+            .isEqualTo(1);
+        assertThat(keyLengths[0]).isEqualTo(4);
+        assertThat(valueLengths[0]).isEqualTo(6);
+        assertThat(keys.limit()).isEqualTo(4);
+        assertThat(values.limit()).isEqualTo(6);
+        byte[] tmp = new byte[6];
+        values.get(tmp);
+        assertThat(tmp).isEqualTo("value1".getBytes());
+        assertThat(iterator.isValid()).isTrue();
+        assertThat(iterator.key()).isEqualTo("key2".getBytes());
+
+        iterator.seekToFirst();
+        keys = ByteBuffer.allocateDirect(16);
+        values.clear();
+        assertThat(iterator.nextBatch(keys, keyLengths, values, valueLengths))
+            .isEqualTo(2);
+        assertThat(keys.limit()).isEqualTo(8);
+        assertThat(values.limit()).isEqualTo(12);
+        tmp = new byte[8];
+        keys.get(tmp);
+        assertThat(tmp).isEqualTo("key1key2".getBytes());
+        assertThat(iterator.isValid()).isFalse();
+      }
+
       try (final RocksIterator iterator = db.newIterator()) {
         iterator.seek("key0".getBytes());
         assertThat(iterator.isValid()).isTrue();
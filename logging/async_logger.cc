@@ -0,0 +1,145 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "logging/async_logger.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Like PosixLogger, tries a stack buffer first and truncates at 64KB
+std::string FormatMessage(const char* format, va_list ap) {
+  char buffer[500];
+  va_list backup_ap;
+  va_copy(backup_ap, ap);
+  int n = vsnprintf(buffer, sizeof(buffer), format, backup_ap);
+  va_end(backup_ap);
+  if (n < 0) {
+    return std::string();
+  }
+  if (static_cast<size_t>(n) < sizeof(buffer)) {
+    return std::string(buffer, n);
+  }
+  const size_t kMaxSize = 65536;
+  std::string result(std::min(static_cast<size_t>(n) + 1, kMaxSize), '\0');
+  va_copy(backup_ap, ap);
+  vsnprintf(&result[0], result.size(), format, backup_ap);
+  va_end(backup_ap);
+  result.resize(result.size() - 1);
+  return result;
+}
+}  // namespace
+
+AsyncLogger::AsyncLogger(const std::shared_ptr<Logger>& target)
+    : Logger(target->GetInfoLogLevel()),
+      target_(target),
+      num_dropped_(0),
+      cv_(&mu_),
+      pending_bytes_(0),
+      flush_requested_(false),
+      stop_(false) {
+  thread_ = port::Thread(&AsyncLogger::BackgroundThread, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+  if (!closed_) {
+    closed_ = true;
+    CloseImpl().PermitUncheckedError();
+  }
+}
+
+void AsyncLogger::Logv(const char* format, va_list ap) {
+  Logv(InfoLogLevel::INFO_LEVEL, format, ap);
+}
+
+void AsyncLogger::Logv(const InfoLogLevel log_level, const char* format,
+                       va_list ap) {
+  if (log_level < GetInfoLogLevel()) {
+    return;
+  }
+  Enqueue(log_level, format, ap);
+}
+
+void AsyncLogger::LogHeader(const char* format, va_list ap) {
+  Enqueue(InfoLogLevel::HEADER_LEVEL, format, ap);
+}
+
+void AsyncLogger::Enqueue(InfoLogLevel log_level, const char* format,
+                          va_list ap) {
+  Message message{log_level, FormatMessage(format, ap)};
+  const size_t size = message.text.size();
+  MutexLock l(&mu_);
+  if (stop_ || (log_level < InfoLogLevel::WARN_LEVEL &&
+                pending_bytes_ + size > kMaxPendingBytes)) {
+    num_dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  pending_.push_back(std::move(message));
+  pending_bytes_ += size;
+  cv_.Signal();
+}
+
+void AsyncLogger::Flush() {
+  MutexLock l(&mu_);
+  flush_requested_ = true;
+  cv_.Signal();
+}
+
+void AsyncLogger::BackgroundThread() {
+  uint64_t num_dropped_reported = 0;
+  MutexLock l(&mu_);
+  while (true) {
+    while (!pending_.empty()) {
+      Message message = std::move(pending_.front());
+      pending_.pop_front();
+      pending_bytes_ -= message.text.size();
+      mu_.Unlock();
+      if (message.log_level == InfoLogLevel::HEADER_LEVEL) {
+        Header(target_.get(), "%s", message.text.c_str());
+      } else {
+        Log(message.log_level, target_.get(), "%s", message.text.c_str());
+      }
+      mu_.Lock();
+    }
+    const uint64_t num_dropped = num_dropped_.load(std::memory_order_relaxed);
+    if (num_dropped != num_dropped_reported) {
+      mu_.Unlock();
+      Log(InfoLogLevel::WARN_LEVEL, target_.get(),
+          "Dropped %" PRIu64 " log messages while the LOG file fell behind",
+          num_dropped - num_dropped_reported);
+      mu_.Lock();
+      num_dropped_reported = num_dropped;
+      continue;
+    }
+    if (flush_requested_) {
+      flush_requested_ = false;
+      mu_.Unlock();
+      target_->Flush();
+      mu_.Lock();
+      continue;
+    }
+    if (stop_) {
+      break;
+    }
+    cv_.Wait();
+  }
+}
+
+Status AsyncLogger::CloseImpl() {
+  {
+    MutexLock l(&mu_);
+    stop_ = true;
+    cv_.Signal();
+  }
+  thread_.join();
+  return target_->Close();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
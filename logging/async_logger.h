@@ -0,0 +1,78 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A Logger that formats messages on the calling thread and writes them to a
+// wrapped logger, e.g. an AutoRollLogger, from a background thread, so that
+// logging never waits for the LOG file. Flush() only asks the background
+// thread to flush once it has caught up.
+//
+// Messages queued beyond kMaxPendingBytes are dropped, except for warnings,
+// errors and headers; the number dropped is logged as a warning once the
+// background thread catches up. As the wrapped logger stamps messages when
+// it writes them, their times lag behind under backpressure, and carry the
+// id of the background thread.
+class AsyncLogger : public Logger {
+ public:
+  static constexpr size_t kMaxPendingBytes = 4 << 20;
+
+  explicit AsyncLogger(const std::shared_ptr<Logger>& target);
+  ~AsyncLogger() override;
+
+  using Logger::Logv;
+  void Logv(const char* format, va_list ap) override;
+  void Logv(const InfoLogLevel log_level, const char* format,
+            va_list ap) override;
+  void LogHeader(const char* format, va_list ap) override;
+
+  size_t GetLogFileSize() const override { return target_->GetLogFileSize(); }
+  void Flush() override;
+  void SetInfoLogLevel(const InfoLogLevel log_level) override {
+    Logger::SetInfoLogLevel(log_level);
+    target_->SetInfoLogLevel(log_level);
+  }
+
+  // The number of messages dropped so far
+  uint64_t GetDroppedMessages() const {
+    return num_dropped_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  // Writes out all queued messages and closes the wrapped logger
+  Status CloseImpl() override;
+
+ private:
+  struct Message {
+    InfoLogLevel log_level;
+    std::string text;
+  };
+
+  void Enqueue(InfoLogLevel log_level, const char* format, va_list ap);
+  void BackgroundThread();
+
+  std::shared_ptr<Logger> target_;
+  std::atomic<uint64_t> num_dropped_;
+
+  port::Mutex mu_;
+  port::CondVar cv_;
+  std::deque<Message> pending_;  // protected by mu_
+  size_t pending_bytes_;         // protected by mu_
+  bool flush_requested_;         // protected by mu_
+  bool stop_;                    // protected by mu_
+  port::Thread thread_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "file/filename.h"
+#include "logging/async_logger.h"
 #include "logging/logging.h"
 #include "rocksdb/env.h"
 #include "rocksdb/file_system.h"
@@ -291,6 +292,9 @@ Status CreateLoggerFromOptions(const std::string& dbname,
       delete result;
     } else {
       logger->reset(result);
+      if (options.async_info_log) {
+        logger->reset(new AsyncLogger(*logger));
+      }
     }
     return s;
   }
@@ -303,6 +307,9 @@ Status CreateLoggerFromOptions(const std::string& dbname,
   s = env->NewLogger(fname, logger);
   if (logger->get() != nullptr) {
     (*logger)->SetInfoLogLevel(options.info_log_level);
+    if (s.ok() && options.async_info_log) {
+      logger->reset(new AsyncLogger(*logger));
+    }
   }
   return s;
 }
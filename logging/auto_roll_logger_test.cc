@@ -19,6 +19,7 @@
 #include <thread>
 #include <vector>
 
+#include "logging/async_logger.h"
 #include "logging/logging.h"
 #include "port/port.h"
 #include "rocksdb/db.h"
@@ -577,6 +578,48 @@ TEST_F(AutoRollLoggerTest, Close) {
   inFile.close();
 }
 
+TEST_F(AutoRollLoggerTest, AsyncLogger) {
+  InitTestDb();
+  DBOptions options;
+  options.max_log_file_size = 1024 * 1024;
+  options.async_info_log = true;
+  std::shared_ptr<Logger> logger;
+  ASSERT_OK(CreateLoggerFromOptions(kTestDir, options, &logger));
+  AsyncLogger* async_logger = dynamic_cast<AsyncLogger*>(logger.get());
+  ASSERT_TRUE(async_logger);
+
+  const int kNumThreads = 4;
+  const int kNumLinesPerThread = 1000;
+  ROCKS_LOG_HEADER(logger, "%s", "header");
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kNumLinesPerThread; ++i) {
+        LogMessage(logger.get(), kSampleMessage.c_str());
+        if (i % 100 == 0) {
+          ROCKS_LOG_WARN(logger, "%s", kSampleMessage.c_str());
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Not logged at the default level
+  ROCKS_LOG_DEBUG(logger, "%s", kSampleMessage.c_str());
+  ASSERT_OK(logger->Close());
+  // Dropped after Close()
+  LogMessage(logger.get(), kSampleMessage.c_str());
+  ASSERT_EQ(1U, async_logger->GetDroppedMessages());
+
+  std::ifstream in_file(kLogFile.c_str());
+  size_t lines = std::count(std::istreambuf_iterator<char>(in_file),
+                            std::istreambuf_iterator<char>(), '\n');
+  ASSERT_EQ(static_cast<size_t>(1 + kNumThreads * (kNumLinesPerThread +
+                                                    kNumLinesPerThread / 100)),
+            lines);
+}
+
 // Test the logger Header function for roll over logs
 // We expect the new logs creates as roll over to carry the headers specified
 static std::vector<std::string> GetOldFileNames(const std::string& path) {
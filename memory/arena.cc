@@ -44,8 +44,11 @@ size_t OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             ArenaBlockPool* block_pool)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      block_pool_(block_pool),
+      tracker_(tracker) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -74,6 +77,11 @@ Arena::~Arena() {
   for (const auto& block : blocks_) {
     delete[] block;
   }
+  for (const auto& block : pooled_blocks_) {
+    if (block.addr_ != nullptr) {
+      block_pool_->Release(block.addr_, block.size_, block.huge_);
+    }
+  }
 
 #ifdef MAP_HUGETLB
   for (const auto& mmap_info : huge_blocks_) {
@@ -102,12 +110,14 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
 #ifdef MAP_HUGETLB
   if (hugetlb_size_) {
     size = hugetlb_size_;
-    block_head = AllocateFromHugePage(size);
+    block_head = block_pool_ != nullptr ? AllocateFromPool(size, true)
+                                        : AllocateFromHugePage(size);
   }
 #endif
   if (!block_head) {
     size = kBlockSize;
-    block_head = AllocateNewBlock(size);
+    block_head = block_pool_ != nullptr ? AllocateFromPool(size, false)
+                                        : AllocateNewBlock(size);
   }
   alloc_bytes_remaining_ = size - bytes;
 
@@ -200,6 +210,101 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
   return result;
 }
 
+char* Arena::AllocateFromPool(size_t block_bytes, bool huge) {
+  // Reserve space first, as in AllocateNewBlock()
+  pooled_blocks_.push_back({nullptr, block_bytes, huge});
+  char* block = block_pool_->Allocate(block_bytes, huge);
+  if (block == nullptr) {
+    pooled_blocks_.pop_back();
+    return nullptr;
+  }
+  pooled_blocks_.back().addr_ = block;
+  blocks_memory_ += block_bytes;
+  if (tracker_ != nullptr) {
+    tracker_->Allocate(block_bytes);
+  }
+  return block;
+}
+
+char* ArenaBlockPool::Allocate(size_t size, bool huge) {
+  {
+    MutexLock l(&mutex_);
+    auto it = free_blocks_.find(std::make_pair(size, huge));
+    if (it != free_blocks_.end() && !it->second.empty()) {
+      char* block = it->second.back();
+      it->second.pop_back();
+      usage_.fetch_sub(size, std::memory_order_relaxed);
+      return block;
+    }
+  }
+  if (!huge) {
+    return new char[size];
+  }
+#ifdef MAP_HUGETLB
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_POPULATE
+  // The block is to be filled right away
+  flags |= MAP_POPULATE;
+#endif
+  void* addr = mmap(nullptr, size, (PROT_READ | PROT_WRITE), flags, -1, 0);
+  if (addr != MAP_FAILED) {
+    return reinterpret_cast<char*>(addr);
+  }
+#endif  // MAP_HUGETLB
+  return nullptr;
+}
+
+void ArenaBlockPool::Release(char* block, size_t size, bool huge) {
+  {
+    MutexLock l(&mutex_);
+    size_t new_usage = usage_.load(std::memory_order_relaxed) + size;
+    bool keep = new_usage <= capacity();
+    if (keep && write_buffer_manager_ != nullptr &&
+        write_buffer_manager_->enabled()) {
+      keep = write_buffer_manager_->memory_usage() + new_usage <=
+             write_buffer_manager_->buffer_size();
+    }
+    if (keep) {
+      free_blocks_[std::make_pair(size, huge)].push_back(block);
+      usage_.store(new_usage, std::memory_order_relaxed);
+      return;
+    }
+  }
+  Free(block, size, huge);
+}
+
+void ArenaBlockPool::SetCapacity(size_t capacity) {
+  std::vector<std::pair<char*, std::pair<size_t, bool>>> to_free;
+  {
+    MutexLock l(&mutex_);
+    capacity_.store(capacity, std::memory_order_relaxed);
+    for (auto& blocks : free_blocks_) {
+      while (!blocks.second.empty() &&
+             usage_.load(std::memory_order_relaxed) > capacity) {
+        to_free.emplace_back(blocks.second.back(), blocks.first);
+        blocks.second.pop_back();
+        usage_.fetch_sub(blocks.first.first, std::memory_order_relaxed);
+      }
+    }
+  }
+  for (const auto& block : to_free) {
+    Free(block.first, block.second.first, block.second.second);
+  }
+}
+
+void ArenaBlockPool::Free(char* block, size_t size, bool huge) {
+  if (!huge) {
+    delete[] block;
+    return;
+  }
+#ifdef MAP_HUGETLB
+  munmap(block, size);
+#else
+  (void)size;
+  assert(false);
+#endif
+}
+
 char* Arena::AllocateNewBlock(size_t block_bytes) {
   // Reserve space in `blocks_` before allocating memory via new.
   // Use `emplace_back()` instead of `reserve()` to let std::vector manage its
@@ -17,14 +17,63 @@
 #endif
 #include <assert.h>
 #include <stdint.h>
+#include <atomic>
 #include <cerrno>
 #include <cstddef>
+#include <map>
+#include <utility>
 #include <vector>
 #include "memory/allocator.h"
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// The arena blocks of freed memtables, kept for the memtables that come
+// next, so that their memory is neither handed back to the allocator nor
+// faulted in again. Blocks are kept by size and by whether they are backed
+// by huge pages. Owned by a WriteBufferManager; see
+// WriteBufferManager::SetArenaBlockPoolSize(). Thread-safe.
+class ArenaBlockPool {
+ public:
+  explicit ArenaBlockPool(const WriteBufferManager* write_buffer_manager)
+      : write_buffer_manager_(write_buffer_manager),
+        capacity_(0),
+        usage_(0) {}
+  // No copying allowed
+  ArenaBlockPool(const ArenaBlockPool&) = delete;
+  void operator=(const ArenaBlockPool&) = delete;
+
+  ~ArenaBlockPool() { SetCapacity(0); }
+
+  // Returns a block of `size` bytes, a kept one if there is any. A new huge
+  // page block is mapped with its pages populated; returns nullptr if that
+  // fails.
+  char* Allocate(size_t size, bool huge);
+
+  // Takes back a block returned by Allocate(). Keeps it if that stays within
+  // capacity() and, when the write buffer manager is enabled(), keeps the
+  // blocks plus its memory_usage() within its buffer_size(). Frees it
+  // otherwise.
+  void Release(char* block, size_t size, bool huge);
+
+  // Frees the blocks kept beyond the new capacity
+  void SetCapacity(size_t capacity);
+
+  size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+  // The bytes in blocks kept
+  size_t usage() const { return usage_.load(std::memory_order_relaxed); }
+
+ private:
+  static void Free(char* block, size_t size, bool huge);
+
+  const WriteBufferManager* const write_buffer_manager_;
+  std::atomic<size_t> capacity_;
+  std::atomic<size_t> usage_;
+  port::Mutex mutex_;
+  std::map<std::pair<size_t, bool>, std::vector<char*>> free_blocks_;
+};
+
 class Arena : public Allocator {
  public:
   // No copying allowed
@@ -38,8 +87,11 @@ class Arena : public Allocator {
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // block_pool: if not null, the regular blocks come from and go back to
+  // it. Must outlive the arena.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 ArenaBlockPool* block_pool = nullptr);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -98,6 +150,15 @@ class Arena : public Allocator {
   std::vector<MmapInfo> huge_blocks_;
   size_t irregular_block_num = 0;
 
+  struct PooledBlock {
+    char* addr_;
+    size_t size_;
+    bool huge_;
+  };
+  ArenaBlockPool* const block_pool_;
+  // The blocks from block_pool_, given back to it on destruction
+  std::vector<PooledBlock> pooled_blocks_;
+
   // Stats for current active block.
   // For each block, we allocate aligned memory chucks from one end and
   // allocate unaligned memory chucks from the other end. Otherwise the
@@ -114,6 +175,7 @@ class Arena : public Allocator {
   char* AllocateFromHugePage(size_t bytes);
   char* AllocateFallback(size_t bytes, bool aligned);
   char* AllocateNewBlock(size_t block_bytes);
+  char* AllocateFromPool(size_t block_bytes, bool huge);
 
   // Bytes of memory in blocks allocated so far
   size_t blocks_memory_ = 0;
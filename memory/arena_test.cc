@@ -196,6 +196,64 @@ TEST_F(ArenaTest, Simple) {
   SimpleTest(0);
   SimpleTest(kHugePageSize);
 }
+
+TEST_F(ArenaTest, BlockPool) {
+  const size_t kBlockSize = 4096;
+  WriteBufferManager wbm(0);
+  ASSERT_EQ(nullptr, wbm.arena_block_pool());
+  wbm.SetArenaBlockPoolSize(2 * kBlockSize);
+  ArenaBlockPool* pool = wbm.arena_block_pool();
+  ASSERT_NE(nullptr, pool);
+
+  std::vector<char*> blocks;
+  {
+    Arena arena(kBlockSize, nullptr, 0, pool);
+    // Fill the inline block, then three regular ones
+    while (arena.MemoryAllocatedBytes() < Arena::kInlineSize + 3 * kBlockSize) {
+      arena.Allocate(kBlockSize / 8);
+    }
+    ASSERT_EQ(0U, wbm.arena_block_pool_usage());
+  }
+  // Only two blocks fit
+  ASSERT_EQ(2 * kBlockSize, wbm.arena_block_pool_usage());
+
+  {
+    Arena arena(kBlockSize, nullptr, 0, pool);
+    while (arena.MemoryAllocatedBytes() < Arena::kInlineSize + kBlockSize) {
+      arena.Allocate(kBlockSize / 8);
+    }
+    ASSERT_EQ(kBlockSize, wbm.arena_block_pool_usage());
+    // Irregular blocks do not come from the pool
+    arena.Allocate(kBlockSize);
+    ASSERT_EQ(kBlockSize, wbm.arena_block_pool_usage());
+  }
+  ASSERT_EQ(2 * kBlockSize, wbm.arena_block_pool_usage());
+
+  wbm.SetArenaBlockPoolSize(kBlockSize);
+  ASSERT_EQ(kBlockSize, wbm.arena_block_pool_usage());
+  wbm.SetArenaBlockPoolSize(0);
+  ASSERT_EQ(0U, wbm.arena_block_pool_usage());
+  ASSERT_EQ(nullptr, wbm.arena_block_pool());
+}
+
+TEST_F(ArenaTest, BlockPoolWithinBufferSize) {
+  const size_t kBlockSize = 4096;
+  WriteBufferManager wbm(4 * kBlockSize);
+  wbm.SetArenaBlockPoolSize(4 * kBlockSize);
+  ArenaBlockPool* pool = wbm.arena_block_pool();
+  ASSERT_NE(nullptr, pool);
+
+  // Other memtables use half of the buffer
+  wbm.ReserveMem(2 * kBlockSize);
+  {
+    Arena arena(kBlockSize, nullptr, 0, pool);
+    while (arena.MemoryAllocatedBytes() < Arena::kInlineSize + 3 * kBlockSize) {
+      arena.Allocate(kBlockSize / 8);
+    }
+  }
+  ASSERT_EQ(2 * kBlockSize, wbm.arena_block_pool_usage());
+  wbm.FreeMem(2 * kBlockSize);
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,301 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+#include "util/core_local.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Precedes every allocation. Keeps the allocations 16-byte aligned, as
+// malloc() does.
+struct AllocationHeader {
+  uint32_t size_class;
+  uint32_t reserved;
+  uint64_t requested_size;
+};
+static_assert(sizeof(AllocationHeader) == 16, "");
+
+// Free allocations are linked through their first bytes after the header.
+struct FreeAllocation {
+  FreeAllocation* next;
+};
+
+// A singly linked list of free allocations of one size class.
+struct FreeList {
+  FreeAllocation* head = nullptr;
+  size_t count = 0;
+
+  void Push(FreeAllocation* a) {
+    a->next = head;
+    head = a;
+    ++count;
+  }
+
+  FreeAllocation* Pop() {
+    FreeAllocation* a = head;
+    if (a != nullptr) {
+      head = a->next;
+      --count;
+    }
+    return a;
+  }
+};
+
+class SlabAllocatorImpl : public SlabAllocator {
+ public:
+  explicit SlabAllocatorImpl(const SlabAllocatorOptions& options)
+      : options_(options) {
+    // Size classes from 64 bytes, with size_classes_per_doubling steps
+    // between powers of two, rounded up to keep the header alignment
+    const size_t kAlignment = sizeof(AllocationHeader);
+    size_t max_class_size =
+        options_.max_slab_allocation_size & ~(kAlignment - 1);
+    for (size_t base = 64; class_sizes_.empty() ||
+                           class_sizes_.back() < max_class_size;
+         base *= 2) {
+      for (int i = 0; i < options_.size_classes_per_doubling; ++i) {
+        size_t size = base + base * i / options_.size_classes_per_doubling;
+        size = std::min((size + kAlignment - 1) & ~(kAlignment - 1),
+                        max_class_size);
+        if (class_sizes_.empty() || size > class_sizes_.back()) {
+          class_sizes_.push_back(size);
+        }
+      }
+    }
+    size_classes_.reset(new SizeClass[class_sizes_.size()]);
+    for (size_t c = 0; c < class_sizes_.size(); ++c) {
+      size_classes_[c].allocations_per_slab =
+          std::max(options_.slab_size / class_sizes_[c], size_t{8});
+      // Keep up to a quarter of the per-core cache in one batch
+      size_classes_[c].batch_size = std::min(
+          std::max(options_.per_core_cache_size / 4 / class_sizes_[c],
+                   size_t{1}),
+          size_t{64});
+    }
+    cores_.reset(new CoreLocalArray<CoreCache>());
+    for (size_t i = 0; i < cores_->Size(); ++i) {
+      cores_->AccessAtCore(i)->lists.resize(class_sizes_.size());
+    }
+  }
+
+  ~SlabAllocatorImpl() override {
+    for (size_t c = 0; c < class_sizes_.size(); ++c) {
+      for (char* slab : size_classes_[c].slabs) {
+        free(slab);
+      }
+    }
+  }
+
+  void* Allocate(size_t size) override {
+    size_t total = size + sizeof(AllocationHeader);
+    if (total < size) {
+      throw std::bad_alloc();
+    }
+    AllocationHeader* header;
+    size_t allocated;
+    if (total > class_sizes_.back()) {
+      header = static_cast<AllocationHeader*>(malloc(total));
+      if (header == nullptr) {
+        throw std::bad_alloc();
+      }
+      header->size_class = kLargeAllocation;
+      allocated = total;
+      reserved_bytes_.fetch_add(total, std::memory_order_relaxed);
+    } else {
+      uint32_t size_class = static_cast<uint32_t>(
+          std::lower_bound(class_sizes_.begin(), class_sizes_.end(), total) -
+          class_sizes_.begin());
+      header = AllocateFromClass(size_class);
+      header->size_class = size_class;
+      allocated = class_sizes_[size_class];
+    }
+    header->requested_size = size;
+    requested_bytes_.fetch_add(size, std::memory_order_relaxed);
+    allocated_bytes_.fetch_add(allocated, std::memory_order_relaxed);
+    return header + 1;
+  }
+
+  void Deallocate(void* p) override {
+    if (p == nullptr) {
+      return;
+    }
+    AllocationHeader* header = static_cast<AllocationHeader*>(p) - 1;
+    requested_bytes_.fetch_sub(header->requested_size,
+                               std::memory_order_relaxed);
+    if (header->size_class == kLargeAllocation) {
+      size_t total = header->requested_size + sizeof(AllocationHeader);
+      allocated_bytes_.fetch_sub(total, std::memory_order_relaxed);
+      reserved_bytes_.fetch_sub(total, std::memory_order_relaxed);
+      free(header);
+      return;
+    }
+    uint32_t size_class = header->size_class;
+    allocated_bytes_.fetch_sub(class_sizes_[size_class],
+                               std::memory_order_relaxed);
+    DeallocateToClass(size_class, header);
+  }
+
+  size_t UsableSize(void* p, size_t /*allocation_size*/) const override {
+    const AllocationHeader* header = static_cast<AllocationHeader*>(p) - 1;
+    if (header->size_class == kLargeAllocation) {
+      return header->requested_size;
+    }
+    return class_sizes_[header->size_class] - sizeof(AllocationHeader);
+  }
+
+  SlabAllocatorStats GetStats() const override {
+    SlabAllocatorStats stats;
+    stats.requested_bytes = requested_bytes_.load(std::memory_order_relaxed);
+    stats.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+    stats.reserved_bytes = reserved_bytes_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  static constexpr uint32_t kLargeAllocation = UINT32_MAX;
+
+  struct SizeClass {
+    SpinMutex mutex;
+    FreeList free_list;
+    // Unused end of the last slab
+    char* slab_next = nullptr;
+    char* slab_end = nullptr;
+    std::vector<char*> slabs;
+    size_t allocations_per_slab = 0;
+    // Allocations moved between the per-core and shared free lists at once
+    size_t batch_size = 0;
+  };
+
+  struct ALIGN_AS(CACHE_LINE_SIZE) CoreCache {
+    SpinMutex mutex;
+    std::vector<FreeList> lists;
+    size_t cached_bytes = 0;
+  };
+
+  static FreeAllocation* ToFree(AllocationHeader* header) {
+    return reinterpret_cast<FreeAllocation*>(header + 1);
+  }
+
+  static AllocationHeader* FromFree(FreeAllocation* a) {
+    return reinterpret_cast<AllocationHeader*>(a) - 1;
+  }
+
+  AllocationHeader* AllocateFromClass(uint32_t size_class) {
+    size_t class_size = class_sizes_[size_class];
+    CoreCache* core = cores_->Access();
+    {
+      std::lock_guard<SpinMutex> lock(core->mutex);
+      FreeAllocation* a = core->lists[size_class].Pop();
+      if (a != nullptr) {
+        core->cached_bytes -= class_size;
+        return FromFree(a);
+      }
+    }
+
+    // Refill the per-core list with a batch from the shared list or slab
+    SizeClass& sc = size_classes_[size_class];
+    FreeList batch;
+    {
+      std::lock_guard<SpinMutex> lock(sc.mutex);
+      while (batch.count < sc.batch_size) {
+        FreeAllocation* a = sc.free_list.Pop();
+        if (a == nullptr) {
+          if (sc.slab_next == sc.slab_end) {
+            if (batch.count > 0) {
+              break;
+            }
+            size_t slab_bytes = sc.allocations_per_slab * class_size;
+            char* slab = static_cast<char*>(malloc(slab_bytes));
+            if (slab == nullptr) {
+              throw std::bad_alloc();
+            }
+            sc.slabs.push_back(slab);
+            sc.slab_next = slab;
+            sc.slab_end = slab + slab_bytes;
+            reserved_bytes_.fetch_add(slab_bytes, std::memory_order_relaxed);
+          }
+          a = ToFree(reinterpret_cast<AllocationHeader*>(sc.slab_next));
+          sc.slab_next += class_size;
+        }
+        batch.Push(a);
+      }
+    }
+    FreeAllocation* result = batch.Pop();
+    if (batch.count > 0) {
+      std::lock_guard<SpinMutex> lock(core->mutex);
+      FreeList& list = core->lists[size_class];
+      while (FreeAllocation* a = batch.Pop()) {
+        list.Push(a);
+        core->cached_bytes += class_size;
+      }
+    }
+    return FromFree(result);
+  }
+
+  void DeallocateToClass(uint32_t size_class, AllocationHeader* header) {
+    size_t class_size = class_sizes_[size_class];
+    SizeClass& sc = size_classes_[size_class];
+    FreeList overflow;
+    CoreCache* core = cores_->Access();
+    {
+      std::lock_guard<SpinMutex> lock(core->mutex);
+      FreeList& list = core->lists[size_class];
+      list.Push(ToFree(header));
+      core->cached_bytes += class_size;
+      if (core->cached_bytes > options_.per_core_cache_size) {
+        // Return a batch (or half the list, if smaller) to the shared list
+        size_t n = std::max(std::min(sc.batch_size, list.count / 2),
+                            size_t{1});
+        for (size_t i = 0; i < n; ++i) {
+          overflow.Push(list.Pop());
+        }
+        core->cached_bytes -= n * class_size;
+      }
+    }
+    if (overflow.count > 0) {
+      std::lock_guard<SpinMutex> lock(sc.mutex);
+      while (FreeAllocation* a = overflow.Pop()) {
+        sc.free_list.Push(a);
+      }
+    }
+  }
+
+  const SlabAllocatorOptions options_;
+  // Total size (including the header) of each size class, increasing
+  std::vector<size_t> class_sizes_;
+  std::unique_ptr<SizeClass[]> size_classes_;
+  std::unique_ptr<CoreLocalArray<CoreCache>> cores_;
+
+  std::atomic<uint64_t> requested_bytes_{0};
+  std::atomic<uint64_t> allocated_bytes_{0};
+  std::atomic<uint64_t> reserved_bytes_{0};
+};
+
+}  // namespace
+
+std::shared_ptr<SlabAllocator> NewSlabAllocator(
+    const SlabAllocatorOptions& options) {
+  if (options.size_classes_per_doubling < 1 ||
+      options.size_classes_per_doubling > 16 ||
+      options.max_slab_allocation_size < 64 ||
+      options.max_slab_allocation_size > UINT32_MAX || options.slab_size == 0) {
+    return nullptr;
+  }
+  return std::make_shared<SlabAllocatorImpl>(options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,161 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <cstring>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/memory_allocator.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+TEST(SlabAllocatorTest, InvalidOptions) {
+  SlabAllocatorOptions options;
+  options.size_classes_per_doubling = 0;
+  ASSERT_EQ(nullptr, NewSlabAllocator(options));
+  options.size_classes_per_doubling = 4;
+  options.slab_size = 0;
+  ASSERT_EQ(nullptr, NewSlabAllocator(options));
+  options.slab_size = 1024;
+  ASSERT_NE(nullptr, NewSlabAllocator(options));
+}
+
+TEST(SlabAllocatorTest, SizeClasses) {
+  SlabAllocatorOptions options;
+  options.size_classes_per_doubling = 4;
+  options.max_slab_allocation_size = 64 * 1024;
+  std::shared_ptr<SlabAllocator> allocator = NewSlabAllocator(options);
+  ASSERT_NE(nullptr, allocator);
+
+  uint64_t requested = 0;
+  std::vector<void*> allocations;
+  for (size_t size : {1, 100, 1000, 4000, 4096, 5000, 16000, 65000, 100000}) {
+    void* p = allocator->Allocate(size);
+    ASSERT_NE(nullptr, p);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(p) % 16);
+    size_t usable = allocator->UsableSize(p, size);
+    ASSERT_GE(usable, size);
+    if (size > 64) {
+      // At most a quarter (plus header and alignment) is wasted
+      ASSERT_LE(usable, size + size / 4 + 16);
+    }
+    memset(p, 0xab, usable);
+    requested += size;
+    allocations.push_back(p);
+  }
+  SlabAllocatorStats stats = allocator->GetStats();
+  ASSERT_EQ(requested, stats.requested_bytes);
+  ASSERT_GT(stats.allocated_bytes, stats.requested_bytes);
+  ASSERT_GE(stats.reserved_bytes, stats.allocated_bytes);
+  ASSERT_EQ(stats.allocated_bytes - stats.requested_bytes,
+            stats.internal_fragmentation_bytes());
+
+  for (void* p : allocations) {
+    allocator->Deallocate(p);
+  }
+  stats = allocator->GetStats();
+  ASSERT_EQ(0, stats.requested_bytes);
+  ASSERT_EQ(0, stats.allocated_bytes);
+  // Slabs are kept, the large allocation is not
+  ASSERT_GT(stats.reserved_bytes, 0);
+  ASSERT_EQ(stats.reserved_bytes, stats.free_bytes());
+}
+
+TEST(SlabAllocatorTest, ReuseWithinSizeClass) {
+  SlabAllocatorOptions options;
+  options.slab_size = 64 * 1024;
+  // Without per-core caches, all freed memory is available to any core
+  options.per_core_cache_size = 0;
+  std::shared_ptr<SlabAllocator> allocator = NewSlabAllocator(options);
+  ASSERT_NE(nullptr, allocator);
+
+  Random rnd(301);
+  std::vector<size_t> sizes;
+  for (int i = 0; i < 200; i++) {
+    sizes.push_back(4096 + rnd.Uniform(512) + (rnd.OneIn(2) ? 0 : 12 * 1024));
+  }
+  uint64_t reserved = 0;
+  for (int round = 0; round < 3; round++) {
+    // Allocations of the same sizes reuse the freed memory, whatever the
+    // order
+    std::vector<void*> live;
+    for (size_t size : sizes) {
+      live.push_back(allocator->Allocate(size));
+      memset(live.back(), 0, size);
+    }
+    if (round == 0) {
+      reserved = allocator->GetStats().reserved_bytes;
+    } else {
+      ASSERT_EQ(reserved, allocator->GetStats().reserved_bytes);
+    }
+    for (void* p : live) {
+      allocator->Deallocate(p);
+    }
+    ASSERT_EQ(0, allocator->GetStats().allocated_bytes);
+    RandomShuffle(sizes.begin(), sizes.end(), round);
+  }
+}
+
+TEST(SlabAllocatorTest, MultiThreaded) {
+  SlabAllocatorOptions options;
+  options.per_core_cache_size = 64 * 1024;
+  std::shared_ptr<SlabAllocator> allocator = NewSlabAllocator(options);
+  ASSERT_NE(nullptr, allocator);
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(t + 1);
+      std::vector<std::pair<char*, size_t>> live;
+      for (int i = 0; i < 20000; i++) {
+        if (!live.empty() && (live.size() > 100 || rnd.OneIn(2))) {
+          size_t idx = rnd.Uniform(static_cast<int>(live.size()));
+          char* p = live[idx].first;
+          for (size_t j = 0; j < live[idx].second; j += 64) {
+            ASSERT_EQ(static_cast<char>(t), p[j]);
+          }
+          allocator->Deallocate(p);
+          live[idx] = live.back();
+          live.pop_back();
+        } else {
+          size_t size = 1 + rnd.Uniform(20000);
+          char* p = static_cast<char*>(allocator->Allocate(size));
+          memset(p, t, size);
+          live.emplace_back(p, size);
+        }
+      }
+      for (auto& a : live) {
+        allocator->Deallocate(a.first);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  SlabAllocatorStats stats = allocator->GetStats();
+  ASSERT_EQ(0, stats.requested_bytes);
+  ASSERT_EQ(0, stats.allocated_bytes);
+}
+
+TEST(SlabAllocatorTest, BlockCache) {
+  std::shared_ptr<SlabAllocator> allocator = NewSlabAllocator();
+  ASSERT_NE(nullptr, allocator);
+  LRUCacheOptions cache_options(1024 * 1024, 0 /*num_shard_bits*/,
+                                false /*strict_capacity_limit*/,
+                                0.0 /*high_pri_pool_ratio*/, allocator);
+  std::shared_ptr<Cache> cache = NewLRUCache(cache_options);
+  ASSERT_EQ(allocator.get(), cache->memory_allocator());
+  ASSERT_STREQ("SlabAllocator", cache->memory_allocator()->Name());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
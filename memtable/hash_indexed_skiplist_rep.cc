@@ -0,0 +1,285 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#ifndef ROCKSDB_LITE
+#include <atomic>
+
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/inlineskiplist.h"
+#include "rocksdb/memtablerep.h"
+#include "util/murmurhash.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// A skip list with a lock-free hash index from each user key to the node
+// holding its newest version. Iteration, seeks and hinted inserts go to the
+// skip list unchanged. Point lookups start at the indexed node and skip the
+// O(log n) descent entirely, which is where most of the cache misses of a
+// large skip list are spent. A lookup whose user key is absent from the
+// index returns without touching the skip list.
+//
+// The index relies on user keys that compare equal being bytewise equal, so
+// it must not be used with user-defined timestamps or with comparators that
+// treat distinct byte strings as the same key.
+class HashIndexedSkipListRep : public MemTableRep {
+ public:
+  HashIndexedSkipListRep(const MemTableRep::KeyComparator& compare,
+                         Allocator* allocator, size_t bucket_count)
+      : MemTableRep(allocator),
+        skip_list_(compare, allocator),
+        cmp_(compare),
+        bucket_count_(bucket_count) {
+    auto mem =
+        allocator->AllocateAligned(sizeof(std::atomic<void*>) * bucket_count);
+    buckets_ = new (mem) std::atomic<IndexEntry*>[bucket_count];
+    for (size_t i = 0; i < bucket_count_; ++i) {
+      buckets_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = skip_list_.AllocateKey(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  void Insert(KeyHandle handle) override { InsertKey(handle); }
+
+  bool InsertKey(KeyHandle handle) override {
+    const char* key = static_cast<char*>(handle);
+    if (!skip_list_.Insert(key)) {
+      return false;
+    }
+    UpdateIndex(key);
+    return true;
+  }
+
+  void InsertWithHint(KeyHandle handle, void** hint) override {
+    InsertKeyWithHint(handle, hint);
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** hint) override {
+    const char* key = static_cast<char*>(handle);
+    if (!skip_list_.InsertWithHint(key, hint)) {
+      return false;
+    }
+    UpdateIndex(key);
+    return true;
+  }
+
+  void InsertWithHintConcurrently(KeyHandle handle, void** hint) override {
+    InsertKeyWithHintConcurrently(handle, hint);
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle, void** hint) override {
+    const char* key = static_cast<char*>(handle);
+    if (!skip_list_.InsertWithHintConcurrently(key, hint)) {
+      return false;
+    }
+    UpdateIndex(key);
+    return true;
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    InsertKeyConcurrently(handle);
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    const char* key = static_cast<char*>(handle);
+    if (!skip_list_.InsertConcurrently(key)) {
+      return false;
+    }
+    UpdateIndex(key);
+    return true;
+  }
+
+  bool Contains(const char* key) const override {
+    return skip_list_.Contains(key);
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    const IndexEntry* entry = FindEntry(k.user_key());
+    if (entry == nullptr) {
+      return;
+    }
+    const char* target = k.memtable_key().data();
+    InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter(
+        &skip_list_);
+    iter.SeekToKeyHandle(entry->newest.load(std::memory_order_acquire));
+    // Skip versions newer than the lookup sequence number.
+    while (iter.Valid() && cmp_(iter.key(), target) < 0) {
+      iter.Next();
+    }
+    for (; iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                 const Slice& end_ikey) override {
+    std::string tmp;
+    uint64_t start_count =
+        skip_list_.EstimateCount(EncodeKey(&tmp, start_ikey));
+    uint64_t end_count = skip_list_.EstimateCount(EncodeKey(&tmp, end_ikey));
+    return (end_count >= start_count) ? (end_count - start_count) : 0;
+  }
+
+  ~HashIndexedSkipListRep() override {}
+
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(
+        const InlineSkipList<const MemTableRep::KeyComparator&>* list)
+        : iter_(list) {}
+
+    ~Iterator() override {}
+
+    bool Valid() const override { return iter_.Valid(); }
+
+    const char* key() const override { return iter_.key(); }
+
+    void Next() override { iter_.Next(); }
+
+    void Prev() override { iter_.Prev(); }
+
+    void Seek(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.Seek(memtable_key);
+      } else {
+        iter_.Seek(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    void SeekForPrev(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.SeekForPrev(memtable_key);
+      } else {
+        iter_.SeekForPrev(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    void SeekToFirst() override { iter_.SeekToFirst(); }
+
+    void SeekToLast() override { iter_.SeekToLast(); }
+
+   private:
+    InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(Iterator))
+                      : operator new(sizeof(Iterator));
+    return new (mem) Iterator(&skip_list_);
+  }
+
+ private:
+  // One per distinct user key. `next` is immutable once the entry is
+  // published; `newest` only ever moves to a smaller internal key.
+  struct IndexEntry {
+    IndexEntry(const char* key, IndexEntry* n) : newest(key), next(n) {}
+
+    std::atomic<const char*> newest;
+    IndexEntry* const next;
+  };
+
+  size_t GetHash(const Slice& user_key) const {
+    return MurmurHash(user_key.data(), static_cast<int>(user_key.size()), 0) %
+           bucket_count_;
+  }
+
+  const IndexEntry* FindEntry(const Slice& user_key) const {
+    const IndexEntry* entry =
+        buckets_[GetHash(user_key)].load(std::memory_order_acquire);
+    for (; entry != nullptr; entry = entry->next) {
+      if (UserKey(entry->newest.load(std::memory_order_relaxed)) == user_key) {
+        return entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // Points the index entry of key's user key at key if it is the newest
+  // version seen so far. Safe to call concurrently with other inserts and
+  // with readers.
+  void UpdateIndex(const char* key) {
+    Slice user_key = UserKey(key);
+    std::atomic<IndexEntry*>& bucket = buckets_[GetHash(user_key)];
+    IndexEntry* head = bucket.load(std::memory_order_acquire);
+    IndexEntry* created = nullptr;
+    while (true) {
+      for (IndexEntry* entry = head; entry != nullptr; entry = entry->next) {
+        const char* newest = entry->newest.load(std::memory_order_acquire);
+        if (UserKey(newest) != user_key) {
+          continue;
+        }
+        while (cmp_(key, newest) < 0 &&
+               !entry->newest.compare_exchange_weak(
+                   newest, key, std::memory_order_release,
+                   std::memory_order_acquire)) {
+        }
+        // An entry allocated by a lost race stays unreachable in the arena.
+        return;
+      }
+      if (created == nullptr) {
+        created = new (allocator_->AllocateAligned(sizeof(IndexEntry)))
+            IndexEntry(key, head);
+      } else {
+        created->~IndexEntry();
+        new (created) IndexEntry(key, head);
+      }
+      if (bucket.compare_exchange_strong(head, created,
+                                         std::memory_order_release,
+                                         std::memory_order_acquire)) {
+        return;
+      }
+      // Another writer published an entry first; rescan from the new head.
+    }
+  }
+
+  InlineSkipList<const MemTableRep::KeyComparator&> skip_list_;
+  const MemTableRep::KeyComparator& cmp_;
+  const size_t bucket_count_;
+  std::atomic<IndexEntry*>* buckets_;
+};
+
+class HashIndexedSkipListRepFactory : public MemTableRepFactory {
+ public:
+  explicit HashIndexedSkipListRepFactory(size_t bucket_count)
+      : bucket_count_(bucket_count > 0 ? bucket_count : 1) {}
+
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator& compare,
+                                 Allocator* allocator,
+                                 const SliceTransform* /*transform*/,
+                                 Logger* /*logger*/) override {
+    return new HashIndexedSkipListRep(compare, allocator, bucket_count_);
+  }
+
+  const char* Name() const override { return "HashIndexedSkipListRepFactory"; }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+
+ private:
+  const size_t bucket_count_;
+};
+
+}  // namespace
+
+MemTableRepFactory* NewHashIndexedSkipListRepFactory(size_t bucket_count) {
+  return new HashIndexedSkipListRepFactory(bucket_count);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -185,6 +185,11 @@ class InlineSkipList {
     // Final state of iterator is Valid() iff list is not empty.
     void SeekToLast();
 
+    // Position at the entry whose key is `key`, without searching.
+    // REQUIRES: key was returned by AllocateKey() on this list and has
+    // been inserted.
+    void SeekToKeyHandle(const char* key);
+
    private:
     const InlineSkipList* list_;
     Node* node_;
@@ -417,6 +422,13 @@ inline void InlineSkipList<Comparator>::Iterator::SeekToFirst() {
   node_ = list_->head_->Next(0);
 }
 
+template <class Comparator>
+inline void InlineSkipList<Comparator>::Iterator::SeekToKeyHandle(
+    const char* key) {
+  assert(key != nullptr);
+  node_ = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
+}
+
 template <class Comparator>
 inline void InlineSkipList<Comparator>::Iterator::SeekToLast() {
   node_ = list_->FindLast();
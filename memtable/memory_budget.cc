@@ -0,0 +1,161 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_budget.h"
+
+#include <algorithm>
+
+#include "port/port.h"
+#include "rocksdb/options.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/system_clock.h"
+#include "rocksdb/table.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "util/mutexlock.h"
+#include "util/timer.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Fewer block cache lookups than this between two Rebalance() calls say
+// nothing about the miss ratio.
+const uint64_t kMinBlockCacheLookups = 100;
+
+class MemoryBudgetImpl : public MemoryBudget {
+ public:
+  explicit MemoryBudgetImpl(const MemoryBudgetOptions& options)
+      : options_(options),
+        cache_(options.cache != nullptr ? options.cache
+                                        : NewLRUCache(options.total_bytes)),
+        min_limit_(ToBytes(options.min_write_buffer_ratio)),
+        max_limit_(ToBytes(options.max_write_buffer_ratio)),
+        step_(std::max(ToBytes(options.adjustment_ratio), size_t{1})) {
+    cache_->SetCapacity(options_.total_bytes);
+    write_buffer_manager_ = std::make_shared<WriteBufferManager>(
+        ToBytes(options_.initial_write_buffer_ratio), cache_,
+        options_.allow_stall);
+    last_stall_count_ = write_buffer_manager_->stall_count();
+    if (options_.statistics != nullptr) {
+      last_hits_ = options_.statistics->getTickerCount(BLOCK_CACHE_HIT);
+      last_misses_ = options_.statistics->getTickerCount(BLOCK_CACHE_MISS);
+    }
+    if (options_.rebalance_period_sec > 0) {
+      uint64_t period_us = options_.rebalance_period_sec * 1000000;
+      timer_.reset(new Timer(SystemClock::Default().get()));
+      timer_->Add([this]() { Rebalance(); }, "MemoryBudget::Rebalance",
+                  period_us, period_us);
+      timer_->Start();
+    }
+  }
+
+  ~MemoryBudgetImpl() override {
+    if (timer_ != nullptr) {
+      timer_->Shutdown();
+    }
+  }
+
+  std::shared_ptr<Cache> cache() const override { return cache_; }
+
+  std::shared_ptr<WriteBufferManager> write_buffer_manager() const override {
+    return write_buffer_manager_;
+  }
+
+  void ApplyTo(BlockBasedTableOptions* table_options) const override {
+    table_options->no_block_cache = false;
+    table_options->block_cache = cache_;
+    table_options->cache_index_and_filter_blocks = true;
+    table_options->reserve_table_builder_memory = true;
+  }
+
+  void ApplyTo(DBOptions* db_options) const override {
+    db_options->write_buffer_manager = write_buffer_manager_;
+  }
+
+  size_t GetWriteBufferLimit() const override {
+    return write_buffer_manager_->buffer_size();
+  }
+
+  size_t Rebalance() override {
+    MutexLock l(&mutex_);
+    WriteBufferManager* wbm = write_buffer_manager_.get();
+    size_t limit = wbm->buffer_size();
+
+    uint64_t stall_count = wbm->stall_count();
+    bool stalled = stall_count != last_stall_count_;
+    last_stall_count_ = stall_count;
+
+    size_t peak = wbm->peak_memory_usage();
+    wbm->ResetPeakMemoryUsage();
+    // Memtables were close enough to the limit that flushes were triggered
+    bool writes_at_limit = peak >= limit - limit / 8;
+
+    bool reads_missing = false;
+    if (options_.statistics != nullptr) {
+      uint64_t hits = options_.statistics->getTickerCount(BLOCK_CACHE_HIT);
+      uint64_t misses = options_.statistics->getTickerCount(BLOCK_CACHE_MISS);
+      uint64_t new_hits = hits - last_hits_;
+      uint64_t new_misses = misses - last_misses_;
+      last_hits_ = hits;
+      last_misses_ = misses;
+      uint64_t lookups = new_hits + new_misses;
+      reads_missing =
+          lookups >= kMinBlockCacheLookups &&
+          static_cast<double>(new_misses) / static_cast<double>(lookups) >
+              options_.max_block_cache_miss_ratio;
+    }
+
+    // Stalled writes hurt the most, then misses; memtables only take memory
+    // the block cache is not short of.
+    size_t new_limit = limit;
+    if (stalled || (writes_at_limit && !reads_missing)) {
+      new_limit = std::min(limit + step_, max_limit_);
+    } else if (reads_missing) {
+      new_limit = limit > min_limit_ + step_ ? limit - step_ : min_limit_;
+    }
+    new_limit = std::max(std::min(new_limit, max_limit_), min_limit_);
+    if (new_limit != limit) {
+      wbm->SetBufferSize(new_limit);
+    }
+    return new_limit;
+  }
+
+ private:
+  size_t ToBytes(double ratio) const {
+    return static_cast<size_t>(static_cast<double>(options_.total_bytes) *
+                               ratio);
+  }
+
+  const MemoryBudgetOptions options_;
+  std::shared_ptr<Cache> cache_;
+  std::shared_ptr<WriteBufferManager> write_buffer_manager_;
+  const size_t min_limit_;
+  const size_t max_limit_;
+  const size_t step_;
+
+  port::Mutex mutex_;
+  uint64_t last_stall_count_ = 0;
+  uint64_t last_hits_ = 0;
+  uint64_t last_misses_ = 0;
+
+  // Declared last, so it stops before the state Rebalance() uses goes away
+  std::unique_ptr<Timer> timer_;
+};
+
+}  // namespace
+
+std::shared_ptr<MemoryBudget> NewMemoryBudget(
+    const MemoryBudgetOptions& options) {
+  if (options.total_bytes == 0 || !(options.min_write_buffer_ratio > 0.0) ||
+      options.min_write_buffer_ratio > options.initial_write_buffer_ratio ||
+      options.initial_write_buffer_ratio > options.max_write_buffer_ratio ||
+      options.max_write_buffer_ratio > 1.0 ||
+      !(options.adjustment_ratio >= 0.0)) {
+    return nullptr;
+  }
+  return std::make_shared<MemoryBudgetImpl>(options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -52,7 +52,10 @@ DEFINE_string(benchmarks, "fillrandom",
               "do random\n"
               "\t                          reads\n"
               "\tseqreadwrite           -- 1 thread writes while N - 1 threads "
-              "do scans\n");
+              "do scans\n"
+              "\tflush                  -- mark the memtable read-only and "
+              "scan it once,\n"
+              "\t                          as a flush does\n");
 
 DEFINE_string(memtablerep, "skiplist",
               "Which implementation of memtablerep to use. See "
@@ -62,11 +65,14 @@ DEFINE_string(memtablerep, "skiplist",
               "\tvector              -- backed by an std::vector\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
+              "\thashindexedskiplist -- backed by a skiplist with a hash "
+              "index for\n"
+              "\t                       point lookups\n"
               "\tcuckoo              -- backed by a cuckoo hash table");
 
 DEFINE_int64(bucket_count, 1000000,
-             "bucket_count parameter to pass into NewHashSkiplistRepFactory or "
-             "NewHashLinkListRepFactory");
+             "bucket_count parameter to pass into NewHashSkiplistRepFactory, "
+             "NewHashLinkListRepFactory or NewHashIndexedSkipListRepFactory");
 
 DEFINE_int32(
     hashskiplist_height, 4,
@@ -117,6 +123,9 @@ DEFINE_int32(prefix_length, 8,
 DEFINE_int64(vectorrep_count, 0,
              "Number of entries to reserve on VectorRep initialization");
 
+DEFINE_int32(vectorrep_sort_threads, 1,
+             "Number of threads sorting a VectorRep on its first scan");
+
 DEFINE_int64(seed, 0,
              "Seed base for random number generators. "
              "When 0 it is deterministic.");
@@ -520,6 +529,23 @@ class SeqReadBenchmark : public Benchmark {
   }
 };
 
+class FlushBenchmark : public Benchmark {
+ public:
+  explicit FlushBenchmark(MemTableRep* table, uint64_t* sequence)
+      : Benchmark(table, nullptr, sequence, 1) {
+    num_read_ops_per_thread_ = 1;
+  }
+
+  void RunThreads(std::vector<port::Thread>* /*threads*/,
+                  uint64_t* bytes_written, uint64_t* bytes_read,
+                  bool /*write*/, uint64_t* read_hits) override {
+    // A VectorRep is sorted in place once read-only
+    table_->MarkReadOnly();
+    SeqReadBenchmarkThread(table_, key_gen_, bytes_written, bytes_read,
+                           sequence_, num_read_ops_per_thread_, read_hits)();
+  }
+};
+
 template <class ReadThreadType>
 class ReadWriteBenchmark : public Benchmark {
  public:
@@ -580,7 +606,9 @@ int main(int argc, char** argv) {
     factory.reset(new ROCKSDB_NAMESPACE::SkipListFactory);
 #ifndef ROCKSDB_LITE
   } else if (FLAGS_memtablerep == "vector") {
-    factory.reset(new ROCKSDB_NAMESPACE::VectorRepFactory);
+    factory.reset(new ROCKSDB_NAMESPACE::VectorRepFactory(
+        static_cast<size_t>(FLAGS_vectorrep_count),
+        static_cast<size_t>(FLAGS_vectorrep_sort_threads)));
   } else if (FLAGS_memtablerep == "hashskiplist") {
     factory.reset(ROCKSDB_NAMESPACE::NewHashSkipListRepFactory(
         FLAGS_bucket_count, FLAGS_hashskiplist_height,
@@ -594,6 +622,9 @@ int main(int argc, char** argv) {
         FLAGS_if_log_bucket_dist_when_flash, FLAGS_threshold_use_skiplist));
     options.prefix_extractor.reset(
         ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_length));
+  } else if (FLAGS_memtablerep == "hashindexedskiplist") {
+    factory.reset(ROCKSDB_NAMESPACE::NewHashIndexedSkipListRepFactory(
+        FLAGS_bucket_count));
 #endif  // ROCKSDB_LITE
   } else {
     fprintf(stdout, "Unknown memtablerep: %s\n", FLAGS_memtablerep.c_str());
@@ -663,6 +694,9 @@ int main(int argc, char** argv) {
       benchmark.reset(new ROCKSDB_NAMESPACE::ReadWriteBenchmark<
                       ROCKSDB_NAMESPACE::SeqConcurrentReadBenchmarkThread>(
           memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == ROCKSDB_NAMESPACE::Slice("flush")) {
+      benchmark.reset(new ROCKSDB_NAMESPACE::FlushBenchmark(memtablerep.get(),
+                                                            &sequence));
     } else {
       std::cout << "WARNING: skipping unknown benchmark '" << name.ToString()
                 << std::endl;
@@ -11,6 +11,7 @@
 #include <memory>
 #include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "db/memtable.h"
 #include "memory/arena.h"
@@ -25,7 +26,8 @@ using namespace stl_wrappers;
 
 class VectorRep : public MemTableRep {
  public:
-  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count);
+  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count,
+            size_t sort_threads);
 
   // Insert key into the collection. (The caller will pack key and value into a
   // single buffer and pass that in as the parameter to Insert)
@@ -52,11 +54,12 @@ class VectorRep : public MemTableRep {
     const KeyComparator& compare_;
     std::string tmp_;       // For passing to EncodeKey
     bool mutable sorted_;
+    const size_t sort_threads_;
     void DoSort() const;
    public:
     explicit Iterator(class VectorRep* vrep,
       std::shared_ptr<std::vector<const char*>> bucket,
-      const KeyComparator& compare);
+      const KeyComparator& compare, size_t sort_threads);
 
     // Initialize an iterator over the specified collection.
     // The returned iterator is not valid.
@@ -104,8 +107,64 @@ class VectorRep : public MemTableRep {
   bool immutable_;
   bool sorted_;
   const KeyComparator& compare_;
+  const size_t sort_threads_;
 };
 
+// The fewest entries worth a sort thread of their own
+const size_t kMinEntriesPerSortThread = 1 << 16;
+
+// Sorts the bucket with up to `sort_threads` threads: it is cut into as
+// many runs, which are sorted concurrently and then merged pairwise, the
+// merges of each round running concurrently as well.
+void SortBucket(std::vector<const char*>* bucket, const Compare& cmp,
+                size_t sort_threads) {
+  size_t num_runs =
+      std::min(sort_threads, bucket->size() / kMinEntriesPerSortThread);
+  if (num_runs <= 1) {
+    std::sort(bucket->begin(), bucket->end(), cmp);
+    return;
+  }
+  // The runs are [bounds[i], bounds[i + 1])
+  std::vector<size_t> bounds;
+  for (size_t i = 0; i < num_runs; ++i) {
+    bounds.push_back(bucket->size() * i / num_runs);
+  }
+  bounds.push_back(bucket->size());
+  auto it = bucket->begin();
+  {
+    std::vector<port::Thread> threads;
+    for (size_t i = 1; i < num_runs; ++i) {
+      threads.emplace_back([&, i]() {
+        std::sort(it + bounds[i], it + bounds[i + 1], cmp);
+      });
+    }
+    std::sort(it + bounds[0], it + bounds[1], cmp);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  while (bounds.size() > 2) {
+    std::vector<size_t> merged;
+    std::vector<port::Thread> threads;
+    size_t i = 0;
+    for (; i + 2 < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+      threads.emplace_back([&, i]() {
+        std::inplace_merge(it + bounds[i], it + bounds[i + 1],
+                           it + bounds[i + 2], cmp);
+      });
+    }
+    // An odd run out waits for the next round
+    for (; i < bounds.size(); ++i) {
+      merged.push_back(bounds[i]);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    bounds.swap(merged);
+  }
+}
+
 void VectorRep::Insert(KeyHandle handle) {
   auto* key = static_cast<char*>(handle);
   WriteLock l(&rwlock_);
@@ -134,37 +193,39 @@ size_t VectorRep::ApproximateMemoryUsage() {
 }
 
 VectorRep::VectorRep(const KeyComparator& compare, Allocator* allocator,
-                     size_t count)
+                     size_t count, size_t sort_threads)
     : MemTableRep(allocator),
       bucket_(new Bucket()),
       immutable_(false),
       sorted_(false),
-      compare_(compare) {
+      compare_(compare),
+      sort_threads_(sort_threads) {
   bucket_.get()->reserve(count);
 }
 
 VectorRep::Iterator::Iterator(class VectorRep* vrep,
                    std::shared_ptr<std::vector<const char*>> bucket,
-                   const KeyComparator& compare)
+                   const KeyComparator& compare, size_t sort_threads)
 : vrep_(vrep),
   bucket_(bucket),
   cit_(bucket_->end()),
   compare_(compare),
-  sorted_(false) { }
+  sorted_(false),
+  sort_threads_(sort_threads) { }
 
 void VectorRep::Iterator::DoSort() const {
   // vrep is non-null means that we are working on an immutable memtable
   if (!sorted_ && vrep_ != nullptr) {
     WriteLock l(&vrep_->rwlock_);
     if (!vrep_->sorted_) {
-      std::sort(bucket_->begin(), bucket_->end(), Compare(compare_));
+      SortBucket(bucket_.get(), Compare(compare_), sort_threads_);
       cit_ = bucket_->begin();
       vrep_->sorted_ = true;
     }
     sorted_ = true;
   }
   if (!sorted_) {
-    std::sort(bucket_->begin(), bucket_->end(), Compare(compare_));
+    SortBucket(bucket_.get(), Compare(compare_), sort_threads_);
     cit_ = bucket_->begin();
     sorted_ = true;
   }
@@ -258,7 +319,8 @@ void VectorRep::Get(const LookupKey& k, void* callback_args,
     vector_rep = nullptr;
     bucket.reset(new Bucket(*bucket_));  // make a copy
   }
-  VectorRep::Iterator iter(vector_rep, immutable_ ? bucket_ : bucket, compare_);
+  VectorRep::Iterator iter(vector_rep, immutable_ ? bucket_ : bucket, compare_,
+                           sort_threads_);
   rwlock_.ReadUnlock();
 
   for (iter.Seek(k.user_key(), k.memtable_key().data());
@@ -276,17 +338,17 @@ MemTableRep::Iterator* VectorRep::GetIterator(Arena* arena) {
   // a Seek is performed on the iterator.
   if (immutable_) {
     if (arena == nullptr) {
-      return new Iterator(this, bucket_, compare_);
+      return new Iterator(this, bucket_, compare_, sort_threads_);
     } else {
-      return new (mem) Iterator(this, bucket_, compare_);
+      return new (mem) Iterator(this, bucket_, compare_, sort_threads_);
     }
   } else {
     std::shared_ptr<Bucket> tmp;
     tmp.reset(new Bucket(*bucket_)); // make a copy
     if (arena == nullptr) {
-      return new Iterator(nullptr, tmp, compare_);
+      return new Iterator(nullptr, tmp, compare_, sort_threads_);
     } else {
-      return new (mem) Iterator(nullptr, tmp, compare_);
+      return new (mem) Iterator(nullptr, tmp, compare_, sort_threads_);
     }
   }
 }
@@ -295,7 +357,7 @@ MemTableRep::Iterator* VectorRep::GetIterator(Arena* arena) {
 MemTableRep* VectorRepFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform*, Logger* /*logger*/) {
-  return new VectorRep(compare, allocator, count_);
+  return new VectorRep(compare, allocator, count_, sort_threads_);
 }
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // ROCKSDB_LITE
@@ -11,6 +11,7 @@
 
 #include "cache/cache_entry_roles.h"
 #include "db/db_impl/db_impl.h"
+#include "memory/arena.h"
 #include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -52,15 +53,20 @@ struct WriteBufferManager::CacheRep {};
 
 WriteBufferManager::WriteBufferManager(size_t _buffer_size,
                                        std::shared_ptr<Cache> cache,
-                                       bool allow_stall)
+                                       bool allow_stall,
+                                       FlushVictimPolicy flush_victim_policy)
     : buffer_size_(_buffer_size),
       mutable_limit_(buffer_size_ * 7 / 8),
       memory_used_(0),
       memory_active_(0),
       dummy_size_(0),
+      peak_memory_used_(0),
+      stall_count_(0),
       cache_rep_(nullptr),
       allow_stall_(allow_stall),
-      stall_active_(false) {
+      stall_active_(false),
+      flush_victim_policy_(flush_victim_policy),
+      arena_block_pool_(new ArenaBlockPool(this)) {
 #ifndef ROCKSDB_LITE
   if (cache) {
     // Construct the cache key using the pointer to this.
@@ -83,17 +89,38 @@ WriteBufferManager::~WriteBufferManager() {
 #endif  // ROCKSDB_LITE
 }
 
+void WriteBufferManager::SetArenaBlockPoolSize(size_t max_bytes) {
+  arena_block_pool_->SetCapacity(max_bytes);
+}
+
+size_t WriteBufferManager::arena_block_pool_usage() const {
+  return arena_block_pool_->usage();
+}
+
+ArenaBlockPool* WriteBufferManager::arena_block_pool() const {
+  return arena_block_pool_->capacity() > 0 ? arena_block_pool_.get()
+                                           : nullptr;
+}
+
 void WriteBufferManager::ReserveMem(size_t mem) {
   if (cache_rep_ != nullptr) {
     ReserveMemWithCache(mem);
   } else if (enabled()) {
-    memory_used_.fetch_add(mem, std::memory_order_relaxed);
+    UpdatePeakMemoryUsage(
+        memory_used_.fetch_add(mem, std::memory_order_relaxed) + mem);
   }
   if (enabled()) {
     memory_active_.fetch_add(mem, std::memory_order_relaxed);
   }
 }
 
+void WriteBufferManager::UpdatePeakMemoryUsage(size_t mem_used) {
+  size_t peak = peak_memory_used_.load(std::memory_order_relaxed);
+  while (mem_used > peak && !peak_memory_used_.compare_exchange_weak(
+                                peak, mem_used, std::memory_order_relaxed)) {
+  }
+}
+
 // Should only be called from write thread
 void WriteBufferManager::ReserveMemWithCache(size_t mem) {
 #ifndef ROCKSDB_LITE
@@ -104,6 +131,7 @@ void WriteBufferManager::ReserveMemWithCache(size_t mem) {
 
   size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) + mem;
   memory_used_.store(new_mem_used, std::memory_order_relaxed);
+  UpdatePeakMemoryUsage(new_mem_used);
   while (new_mem_used > cache_rep_->cache_allocated_size_) {
     // Expand size by at least 256KB.
     // Add a dummy record to the cache
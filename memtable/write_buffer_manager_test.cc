@@ -8,6 +8,11 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+
+#include "rocksdb/memory_budget.h"
+#include "rocksdb/options.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/table.h"
 #include "test_util/testharness.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -221,6 +226,145 @@ TEST_F(WriteBufferManagerTest, CacheFull) {
   ASSERT_EQ(wbf->dummy_entries_in_cache_usage(), 95 * kSizeDummyEntry);
 }
 
+TEST_F(WriteBufferManagerTest, PeakMemoryUsage) {
+  std::shared_ptr<Cache> cache = NewLRUCache(4 * 1024 * 1024);
+  for (bool with_cache : {false, true}) {
+    WriteBufferManager wbf(10 * 1024 * 1024, with_cache ? cache : nullptr);
+    wbf.ReserveMem(3 * 1024 * 1024);
+    wbf.ReserveMem(2 * 1024 * 1024);
+    wbf.FreeMem(4 * 1024 * 1024);
+    ASSERT_EQ(wbf.memory_usage(), 1 * 1024 * 1024);
+    ASSERT_EQ(wbf.peak_memory_usage(), 5 * 1024 * 1024);
+
+    wbf.ResetPeakMemoryUsage();
+    ASSERT_EQ(wbf.peak_memory_usage(), 1 * 1024 * 1024);
+    wbf.ReserveMem(1 * 1024 * 1024);
+    ASSERT_EQ(wbf.peak_memory_usage(), 2 * 1024 * 1024);
+    wbf.FreeMem(2 * 1024 * 1024);
+  }
+}
+
+TEST_F(WriteBufferManagerTest, StallCount) {
+  WriteBufferManager wbf(1024 * 1024, nullptr, true /* allow_stall */);
+  ASSERT_FALSE(wbf.ShouldStall());
+  ASSERT_EQ(wbf.stall_count(), 0);
+  wbf.ReserveMem(2 * 1024 * 1024);
+  ASSERT_TRUE(wbf.ShouldStall());
+  ASSERT_EQ(wbf.stall_count(), 1);
+  wbf.FreeMem(2 * 1024 * 1024);
+}
+
+class MemoryBudgetTest : public testing::Test {
+ protected:
+  static constexpr size_t kTotal = 100 * 1024 * 1024;
+
+  MemoryBudgetOptions Options() {
+    MemoryBudgetOptions options;
+    options.total_bytes = kTotal;
+    options.initial_write_buffer_ratio = 0.2;
+    options.min_write_buffer_ratio = 0.1;
+    options.max_write_buffer_ratio = 0.4;
+    options.adjustment_ratio = 0.1;
+    options.rebalance_period_sec = 0;
+    options.statistics = statistics_;
+    return options;
+  }
+
+  void RecordLookups(uint64_t hits, uint64_t misses) {
+    statistics_->recordTick(BLOCK_CACHE_HIT, hits);
+    statistics_->recordTick(BLOCK_CACHE_MISS, misses);
+  }
+
+  std::shared_ptr<Statistics> statistics_ = CreateDBStatistics();
+};
+
+TEST_F(MemoryBudgetTest, InvalidOptions) {
+  MemoryBudgetOptions options = Options();
+  options.total_bytes = 0;
+  ASSERT_EQ(NewMemoryBudget(options), nullptr);
+  options = Options();
+  options.min_write_buffer_ratio = 0.3;
+  ASSERT_EQ(NewMemoryBudget(options), nullptr);
+  options = Options();
+  options.max_write_buffer_ratio = 1.5;
+  ASSERT_EQ(NewMemoryBudget(options), nullptr);
+  ASSERT_NE(NewMemoryBudget(Options()), nullptr);
+}
+
+TEST_F(MemoryBudgetTest, ApplyTo) {
+  std::shared_ptr<MemoryBudget> budget = NewMemoryBudget(Options());
+  ASSERT_EQ(budget->cache()->GetCapacity(), kTotal);
+  ASSERT_EQ(budget->GetWriteBufferLimit(), kTotal / 5);
+
+  BlockBasedTableOptions table_options;
+  budget->ApplyTo(&table_options);
+  ASSERT_EQ(table_options.block_cache, budget->cache());
+  ASSERT_TRUE(table_options.cache_index_and_filter_blocks);
+  ASSERT_TRUE(table_options.reserve_table_builder_memory);
+
+  DBOptions db_options;
+  budget->ApplyTo(&db_options);
+  ASSERT_EQ(db_options.write_buffer_manager, budget->write_buffer_manager());
+
+  // Memtables are charged to the shared cache
+  WriteBufferManager* wbm = budget->write_buffer_manager().get();
+  ASSERT_TRUE(wbm->cost_to_cache());
+  wbm->ReserveMem(10 * 1024 * 1024);
+  ASSERT_GE(budget->cache()->GetPinnedUsage(), 10 * 1024 * 1024);
+  wbm->FreeMem(10 * 1024 * 1024);
+}
+
+TEST_F(MemoryBudgetTest, Rebalance) {
+  std::shared_ptr<MemoryBudget> budget = NewMemoryBudget(Options());
+  WriteBufferManager* wbm = budget->write_buffer_manager().get();
+  const size_t kStep = kTotal / 10;
+
+  // Nothing happened
+  ASSERT_EQ(budget->Rebalance(), 2 * kStep);
+
+  // Memtables reached their limit while reads hit: grow, up to the max
+  wbm->ReserveMem(2 * kStep);
+  wbm->FreeMem(2 * kStep);
+  RecordLookups(1000, 10);
+  ASSERT_EQ(budget->Rebalance(), 3 * kStep);
+  wbm->ReserveMem(3 * kStep);
+  wbm->FreeMem(3 * kStep);
+  ASSERT_EQ(budget->Rebalance(), 4 * kStep);
+  wbm->ReserveMem(4 * kStep);
+  wbm->FreeMem(4 * kStep);
+  ASSERT_EQ(budget->Rebalance(), 4 * kStep);
+  ASSERT_EQ(wbm->buffer_size(), 4 * kStep);
+
+  // Reads miss: shrink, down to the min, even if memtables are at the limit
+  RecordLookups(500, 500);
+  ASSERT_EQ(budget->Rebalance(), 3 * kStep);
+  wbm->ReserveMem(3 * kStep);
+  wbm->FreeMem(3 * kStep);
+  RecordLookups(500, 500);
+  ASSERT_EQ(budget->Rebalance(), 2 * kStep);
+  RecordLookups(500, 500);
+  ASSERT_EQ(budget->Rebalance(), 1 * kStep);
+  RecordLookups(500, 500);
+  ASSERT_EQ(budget->Rebalance(), 1 * kStep);
+
+  // Too few lookups to tell
+  RecordLookups(5, 50);
+  ASSERT_EQ(budget->Rebalance(), 1 * kStep);
+}
+
+TEST_F(MemoryBudgetTest, StallsOutweighMisses) {
+  MemoryBudgetOptions options = Options();
+  options.allow_stall = true;
+  std::shared_ptr<MemoryBudget> budget = NewMemoryBudget(options);
+  WriteBufferManager* wbm = budget->write_buffer_manager().get();
+
+  wbm->ReserveMem(3 * kTotal / 10);
+  ASSERT_TRUE(wbm->ShouldStall());
+  RecordLookups(500, 500);
+  ASSERT_EQ(budget->Rebalance(), 3 * kTotal / 10);
+  wbm->FreeMem(3 * kTotal / 10);
+}
+
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
 
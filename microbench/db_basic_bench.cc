@@ -0,0 +1,334 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmarks for the read and write paths of a DB: Get and MultiGet
+// from the memtable, L0 or a lower level, iterator Seek and Next, and
+// WriteBatch encoding and DB::Write. All data comes from fixed seeds, so
+// that runs are comparable across commits; pass --benchmark_format=json (or
+// --benchmark_out=<file>) for machine-readable results.
+#include <benchmark/benchmark.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/table.h"
+#include "rocksdb/write_batch.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+constexpr int kValueSize = 100;
+
+enum Layout : int64_t {
+  // All keys in the memtable
+  kMemTable = 0,
+  // All keys in a single L0 file
+  kL0 = 1,
+  // All keys compacted to the bottommost level
+  kLn = 2,
+};
+
+std::string MakeKey(int64_t i) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "key%016" PRId64, i);
+  return buf;
+}
+
+// A DB holding keys [0, num_keys) laid out as `layout`, with a block cache
+// large enough that every read after the first is served from it
+class BenchDB {
+ public:
+  BenchDB(int64_t layout, int64_t num_keys) : num_keys_(num_keys) {
+    Env::Default()->GetTestDirectory(&path_).PermitUncheckedError();
+    path_ += "/db_basic_bench";
+    DestroyDB(path_, Options()).PermitUncheckedError();
+
+    Options options;
+    options.create_if_missing = true;
+    options.disable_auto_compactions = true;
+    // Large enough to hold every key in the memtable
+    options.write_buffer_size = 256 << 20;
+    BlockBasedTableOptions table_options;
+    table_options.block_cache = NewLRUCache(256 << 20);
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+    DB* db = nullptr;
+    status_ = DB::Open(options, path_, &db);
+    if (!status_.ok()) {
+      return;
+    }
+    db_.reset(db);
+
+    Random rnd(301);
+    WriteOptions write_options;
+    write_options.disableWAL = true;
+    for (int64_t i = 0; i < num_keys_ && status_.ok(); i++) {
+      status_ =
+          db_->Put(write_options, MakeKey(i), rnd.RandomString(kValueSize));
+    }
+    if (status_.ok() && layout != kMemTable) {
+      status_ = db_->Flush(FlushOptions());
+    }
+    if (status_.ok() && layout == kLn) {
+      CompactRangeOptions compact_options;
+      compact_options.bottommost_level_compaction =
+          BottommostLevelCompaction::kForce;
+      status_ = db_->CompactRange(compact_options, nullptr, nullptr);
+    }
+    // Warms up the block cache
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    for (iter->SeekToFirst(); status_.ok() && iter->Valid(); iter->Next()) {
+    }
+    if (status_.ok()) {
+      status_ = iter->status();
+    }
+  }
+
+  ~BenchDB() {
+    if (db_ != nullptr) {
+      db_->Close().PermitUncheckedError();
+      db_.reset();
+    }
+    DestroyDB(path_, Options()).PermitUncheckedError();
+  }
+
+  // Skips the benchmark and returns false if the DB could not be set up
+  bool Check(benchmark::State& state) {
+    if (!status_.ok()) {
+      state.SkipWithError(status_.ToString().c_str());
+      return false;
+    }
+    return true;
+  }
+
+  DB* db() const { return db_.get(); }
+  int64_t num_keys() const { return num_keys_; }
+
+ private:
+  std::string path_;
+  int64_t num_keys_;
+  std::unique_ptr<DB> db_;
+  Status status_;
+};
+
+}  // namespace
+
+// benchmark arguments:
+// 0. layout
+// 1. number of keys
+static void LayoutArguments(benchmark::internal::Benchmark* b) {
+  for (int64_t layout : {kMemTable, kL0, kLn}) {
+    for (int64_t num_keys : {1 << 10, 1 << 17}) {
+      b->Args({layout, num_keys});
+    }
+  }
+  b->ArgNames({"layout", "num_keys"});
+}
+
+static void DBGet(benchmark::State& state) {
+  BenchDB bench_db(state.range(0), state.range(1));
+  if (!bench_db.Check(state)) {
+    return;
+  }
+  Random rnd(12345);
+  ReadOptions read_options;
+  PinnableSlice value;
+  uint64_t not_found = 0;
+  for (auto _ : state) {
+    const std::string key = MakeKey(rnd.Uniform(
+        static_cast<int>(bench_db.num_keys())));
+    value.Reset();
+    Status s = bench_db.db()->Get(read_options,
+                                  bench_db.db()->DefaultColumnFamily(), key,
+                                  &value);
+    if (!s.ok()) {
+      not_found++;
+    }
+  }
+  state.counters["not_found"] = static_cast<double>(not_found);
+}
+
+BENCHMARK(DBGet)->Apply(LayoutArguments);
+
+static void DBGetNotFound(benchmark::State& state) {
+  BenchDB bench_db(state.range(0), state.range(1));
+  if (!bench_db.Check(state)) {
+    return;
+  }
+  Random rnd(12345);
+  ReadOptions read_options;
+  PinnableSlice value;
+  for (auto _ : state) {
+    // Sorts right after an existing key, so that the lookup gets as far as
+    // the data blocks
+    const std::string key =
+        MakeKey(rnd.Uniform(static_cast<int>(bench_db.num_keys()))) + "-";
+    value.Reset();
+    Status s = bench_db.db()->Get(read_options,
+                                  bench_db.db()->DefaultColumnFamily(), key,
+                                  &value);
+    benchmark::DoNotOptimize(s);
+  }
+}
+
+BENCHMARK(DBGetNotFound)->Apply(LayoutArguments);
+
+// benchmark arguments:
+// 0. layout
+// 1. keys per MultiGet
+static void MultiGetArguments(benchmark::internal::Benchmark* b) {
+  for (int64_t layout : {kMemTable, kL0, kLn}) {
+    for (int64_t batch_size : {8, 64}) {
+      b->Args({layout, batch_size});
+    }
+  }
+  b->ArgNames({"layout", "batch_size"});
+}
+
+static void DBMultiGet(benchmark::State& state) {
+  BenchDB bench_db(state.range(0), 1 << 17);
+  if (!bench_db.Check(state)) {
+    return;
+  }
+  const size_t batch_size = static_cast<size_t>(state.range(1));
+  Random rnd(12345);
+  ReadOptions read_options;
+  std::vector<std::string> key_data(batch_size);
+  std::vector<Slice> keys(batch_size);
+  std::vector<PinnableSlice> values(batch_size);
+  std::vector<Status> statuses(batch_size);
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < batch_size; i++) {
+      key_data[i] =
+          MakeKey(rnd.Uniform(static_cast<int>(bench_db.num_keys())));
+      keys[i] = key_data[i];
+      values[i].Reset();
+    }
+    state.ResumeTiming();
+    bench_db.db()->MultiGet(read_options, bench_db.db()->DefaultColumnFamily(),
+                            batch_size, keys.data(), values.data(),
+                            statuses.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(1));
+}
+
+BENCHMARK(DBMultiGet)->Apply(MultiGetArguments);
+
+static void IteratorSeek(benchmark::State& state) {
+  BenchDB bench_db(state.range(0), state.range(1));
+  if (!bench_db.Check(state)) {
+    return;
+  }
+  Random rnd(12345);
+  std::unique_ptr<Iterator> iter(bench_db.db()->NewIterator(ReadOptions()));
+  for (auto _ : state) {
+    const std::string key = MakeKey(rnd.Uniform(
+        static_cast<int>(bench_db.num_keys())));
+    iter->Seek(key);
+    benchmark::DoNotOptimize(iter->Valid());
+  }
+}
+
+BENCHMARK(IteratorSeek)->Apply(LayoutArguments);
+
+static void IteratorNext(benchmark::State& state) {
+  BenchDB bench_db(state.range(0), state.range(1));
+  if (!bench_db.Check(state)) {
+    return;
+  }
+  std::unique_ptr<Iterator> iter(bench_db.db()->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  for (auto _ : state) {
+    if (!iter->Valid()) {
+      state.PauseTiming();
+      iter->SeekToFirst();
+      state.ResumeTiming();
+    }
+    iter->Next();
+  }
+}
+
+BENCHMARK(IteratorNext)->Apply(LayoutArguments);
+
+// benchmark arguments:
+// 0. keys per batch
+static void WriteBatchEncode(benchmark::State& state) {
+  const int64_t batch_size = state.range(0);
+  Random rnd(12345);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (int64_t i = 0; i < batch_size; i++) {
+    keys.push_back(MakeKey(i));
+    values.push_back(rnd.RandomString(kValueSize));
+  }
+  WriteBatch batch;
+  for (auto _ : state) {
+    batch.Clear();
+    for (int64_t i = 0; i < batch_size; i++) {
+      batch.Put(keys[i], values[i]).PermitUncheckedError();
+    }
+    benchmark::DoNotOptimize(batch.Data().data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          batch_size);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(batch.GetDataSize()));
+}
+
+BENCHMARK(WriteBatchEncode)->Arg(1)->Arg(16)->Arg(256);
+
+// benchmark arguments:
+// 0. keys per batch
+// 1. whether the WAL is written
+static void DBWrite(benchmark::State& state) {
+  BenchDB bench_db(kMemTable, 0);
+  if (!bench_db.Check(state)) {
+    return;
+  }
+  const int64_t batch_size = state.range(0);
+  WriteOptions write_options;
+  write_options.disableWAL = state.range(1) == 0;
+  Random rnd(12345);
+  const std::string value = rnd.RandomString(kValueSize);
+  WriteBatch batch;
+  int64_t next_key = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    batch.Clear();
+    for (int64_t i = 0; i < batch_size; i++) {
+      batch.Put(MakeKey(next_key++), value).PermitUncheckedError();
+    }
+    state.ResumeTiming();
+    Status s = bench_db.db()->Write(write_options, &batch);
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          batch_size);
+}
+
+BENCHMARK(DBWrite)
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Args({16, 0})
+    ->Args({16, 1})
+    ->ArgNames({"batch_size", "wal"});
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
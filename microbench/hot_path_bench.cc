@@ -0,0 +1,203 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmarks for the building blocks under the read path, without a
+// DB: seeks within a data block, a merging iterator over data blocks, and
+// block cache lookups. All data comes from fixed seeds; pass
+// --benchmark_format=json for machine-readable results.
+#include <benchmark/benchmark.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/cache.h"
+#include "table/block_based/block.h"
+#include "table/block_based/block_builder.h"
+#include "table/merging_iterator.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+constexpr int kValueSize = 100;
+
+std::string MakeUserKey(int64_t i) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "key%016" PRId64, i);
+  return buf;
+}
+
+std::string MakeInternalKey(int64_t i) {
+  std::string key = MakeUserKey(i);
+  AppendInternalKeyFooter(&key, 0 /* seqno */, kTypeValue);
+  return key;
+}
+
+// Builds a data block of the keys i * stride + offset, for i in
+// [0, num_keys)
+std::unique_ptr<Block> BuildBlock(int64_t num_keys, int64_t stride,
+                                  int64_t offset, Random* rnd) {
+  BlockBuilder builder(16 /* block_restart_interval */);
+  for (int64_t i = 0; i < num_keys; i++) {
+    builder.Add(MakeInternalKey(i * stride + offset),
+                rnd->RandomString(kValueSize));
+  }
+  const Slice raw = builder.Finish();
+  BlockContents contents;
+  contents.allocation.reset(new char[raw.size()]);
+  memcpy(contents.allocation.get(), raw.data(), raw.size());
+  contents.data = Slice(contents.allocation.get(), raw.size());
+  return std::unique_ptr<Block>(new Block(std::move(contents)));
+}
+
+}  // namespace
+
+// benchmark arguments:
+// 0. keys in the block
+static void BlockIterSeek(benchmark::State& state) {
+  const int64_t num_keys = state.range(0);
+  Random rnd(12345);
+  std::unique_ptr<Block> block = BuildBlock(num_keys, 1, 0, &rnd);
+  std::vector<std::string> targets;
+  for (int i = 0; i < 1024; i++) {
+    targets.push_back(
+        MakeInternalKey(rnd.Uniform(static_cast<int>(num_keys))));
+  }
+  std::unique_ptr<DataBlockIter> iter(block->NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber));
+  size_t i = 0;
+  for (auto _ : state) {
+    iter->Seek(targets[i++ % targets.size()]);
+    benchmark::DoNotOptimize(iter->Valid());
+  }
+}
+
+BENCHMARK(BlockIterSeek)->Arg(32)->Arg(256);
+
+// benchmark arguments:
+// 0. number of children
+// 1. whether to merge with a loser tree rather than a heap
+static void MergingIteratorArguments(benchmark::internal::Benchmark* b) {
+  for (int64_t num_children : {2, 8, 32}) {
+    for (int64_t use_loser_tree : {0, 1}) {
+      b->Args({num_children, use_loser_tree});
+    }
+  }
+  b->ArgNames({"num_children", "loser_tree"});
+}
+
+// Interleaves the keys of the children, so that every step of the merge
+// switches to another child
+class MergingIteratorFixture {
+ public:
+  explicit MergingIteratorFixture(benchmark::State& state)
+      : num_children_(state.range(0)),
+        icmp_(BytewiseComparator()),
+        rnd_(12345) {
+    std::vector<InternalIterator*> children;
+    for (int64_t c = 0; c < num_children_; c++) {
+      blocks_.push_back(
+          BuildBlock(kKeysPerChild, num_children_, c, &rnd_));
+      children.push_back(blocks_.back()->NewDataIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber));
+    }
+    iter_.reset(NewMergingIterator(&icmp_, children.data(),
+                                   static_cast<int>(children.size()),
+                                   nullptr /* arena */,
+                                   false /* prefix_seek_mode */,
+                                   state.range(1) != 0));
+  }
+
+  static constexpr int64_t kKeysPerChild = 256;
+
+  InternalIterator* iter() { return iter_.get(); }
+  int64_t num_keys() const { return num_children_ * kKeysPerChild; }
+  Random* rnd() { return &rnd_; }
+
+ private:
+  const int64_t num_children_;
+  InternalKeyComparator icmp_;
+  Random rnd_;
+  std::vector<std::unique_ptr<Block>> blocks_;
+  std::unique_ptr<InternalIterator> iter_;
+};
+
+static void MergingIteratorSeek(benchmark::State& state) {
+  MergingIteratorFixture fixture(state);
+  std::vector<std::string> targets;
+  for (int i = 0; i < 1024; i++) {
+    targets.push_back(MakeInternalKey(
+        fixture.rnd()->Uniform(static_cast<int>(fixture.num_keys()))));
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    fixture.iter()->Seek(targets[i++ % targets.size()]);
+    benchmark::DoNotOptimize(fixture.iter()->Valid());
+  }
+}
+
+BENCHMARK(MergingIteratorSeek)->Apply(MergingIteratorArguments);
+
+static void MergingIteratorNext(benchmark::State& state) {
+  MergingIteratorFixture fixture(state);
+  InternalIterator* iter = fixture.iter();
+  iter->SeekToFirst();
+  for (auto _ : state) {
+    if (!iter->Valid()) {
+      state.PauseTiming();
+      iter->SeekToFirst();
+      state.ResumeTiming();
+    }
+    iter->Next();
+  }
+}
+
+BENCHMARK(MergingIteratorNext)->Apply(MergingIteratorArguments);
+
+// benchmark arguments:
+// 0. number of shard bits
+// 1. percentage of lookups that hit
+static void LRUCacheLookup(benchmark::State& state) {
+  const int kNumEntries = 1 << 16;
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(kNumEntries * kValueSize, static_cast<int>(state.range(0)));
+  for (int i = 0; i < kNumEntries; i++) {
+    Status s = cache->Insert(MakeUserKey(i), nullptr, kValueSize,
+                             [](const Slice& /*key*/, void* /*value*/) {});
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      return;
+    }
+  }
+  Random rnd(12345);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1024; i++) {
+    const bool hit = static_cast<int64_t>(rnd.Uniform(100)) < state.range(1);
+    keys.push_back(MakeUserKey(rnd.Uniform(kNumEntries) +
+                               (hit ? 0 : kNumEntries)));
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    Cache::Handle* handle = cache->Lookup(keys[i++ % keys.size()]);
+    if (handle != nullptr) {
+      cache->Release(handle);
+    }
+  }
+}
+
+BENCHMARK(LRUCacheLookup)
+    ->Args({0, 100})
+    ->Args({6, 100})
+    ->Args({6, 50})
+    ->ArgNames({"shard_bits", "hit_percent"});
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -9,6 +9,7 @@
 
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/mock_block_based_table.h"
+#include "table/multiget_context.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -151,6 +152,69 @@ static void FilterQueryNegative(benchmark::State &state) {
 }
 BENCHMARK(FilterQueryNegative)->Apply(CustomArguments);
 
+// Batched queries, as done for MultiGet. Each iteration queries one batch of
+// MultiGetContext::MAX_BATCH_SIZE keys.
+static void FilterQueryBatch(benchmark::State &state, bool positive) {
+  // setup data
+  auto filter = new BloomFilterPolicy(
+      static_cast<double>(state.range(1)),
+      static_cast<BloomFilterPolicy::Mode>(state.range(0)));
+  auto tester = new mock::MockBlockBasedTableTester(filter);
+  const int64_t kEntryNum = state.range(3);
+  auto rnd = Random32(12345);
+  uint32_t filter_num = rnd.Next();
+  std::unique_ptr<const char[]> owner;
+  std::unique_ptr<FilterBitsBuilder> builder(tester->GetBuilder());
+  {
+    KeyMaker km(state.range(2));
+    for (uint32_t i = 0; i < kEntryNum; i++) {
+      builder->AddKey(km.Get(filter_num, i));
+    }
+  }
+  auto data = builder->Finish(&owner);
+  auto reader = filter->GetFilterBitsReader(data);
+
+  // KeyMaker returns keys in its own buffer, so one per batch slot
+  constexpr int kBatchSize = MultiGetContext::MAX_BATCH_SIZE;
+  std::vector<std::unique_ptr<KeyMaker>> kms;
+  std::array<Slice, kBatchSize> keys;
+  std::array<Slice *, kBatchSize> key_ptrs;
+  std::array<bool, kBatchSize> may_match;
+  for (int j = 0; j < kBatchSize; j++) {
+    kms.emplace_back(new KeyMaker(state.range(2)));
+    key_ptrs[j] = &keys[j];
+  }
+
+  // run test
+  uint32_t i = 0;
+  double match_cnt = 0;
+  for (auto _ : state) {
+    for (int j = 0; j < kBatchSize; j++) {
+      i++;
+      if (positive) {
+        i = i % kEntryNum;
+      }
+      keys[j] = kms[j]->Get(positive ? filter_num : filter_num + 1, i);
+    }
+    reader->MayMatch(kBatchSize, key_ptrs.data(), may_match.data());
+    for (int j = 0; j < kBatchSize; j++) {
+      match_cnt += may_match[j] ? 1 : 0;
+    }
+  }
+  state.counters[positive ? "Match %" : "FP %"] = benchmark::Counter(
+      match_cnt * 100 / kBatchSize, benchmark::Counter::kAvgIterations);
+}
+
+static void FilterQueryPositiveBatch(benchmark::State &state) {
+  FilterQueryBatch(state, /*positive=*/true);
+}
+BENCHMARK(FilterQueryPositiveBatch)->Apply(CustomArguments);
+
+static void FilterQueryNegativeBatch(benchmark::State &state) {
+  FilterQueryBatch(state, /*positive=*/false);
+}
+BENCHMARK(FilterQueryNegativeBatch)->Apply(CustomArguments);
+
 }  // namespace ROCKSDB_NAMESPACE
 
 BENCHMARK_MAIN();
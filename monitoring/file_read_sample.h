@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 //
 #pragma once
+#include "db/blob/blob_file_meta.h"
 #include "db/version_edit.h"
 #include "util/random.h"
 
@@ -20,4 +21,17 @@ inline void sample_file_read_inc(FileMetaData* meta) {
   meta->stats.num_reads_sampled.fetch_add(kFileReadSampleRate,
                                           std::memory_order_relaxed);
 }
+
+inline void sample_file_bytes_read_inc(FileMetaData* meta,
+                                       uint64_t bytes_read) {
+  meta->stats.bytes_read_sampled.fetch_add(bytes_read * kFileReadSampleRate,
+                                           std::memory_order_relaxed);
+}
+
+inline void sample_blob_file_read_inc(const SharedBlobFileMetaData* meta,
+                                      uint64_t num_reads,
+                                      uint64_t bytes_read) {
+  meta->AddReadsSampled(num_reads * kFileReadSampleRate,
+                        bytes_read * kFileReadSampleRate);
+}
 }  // namespace ROCKSDB_NAMESPACE
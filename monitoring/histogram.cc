@@ -10,6 +10,8 @@
 #include "monitoring/histogram.h"
 
 #include <stdio.h>
+
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cmath>
@@ -130,6 +132,28 @@ void HistogramStat::Merge(const HistogramStat& other) {
   }
 }
 
+void HistogramStat::Subtract(const HistogramStat& earlier) {
+  num_.fetch_sub(earlier.num(), std::memory_order_relaxed);
+  sum_.fetch_sub(earlier.sum(), std::memory_order_relaxed);
+  sum_squares_.fetch_sub(earlier.sum_squares(), std::memory_order_relaxed);
+  uint64_t new_min = bucketMapper.LastValue();
+  uint64_t new_max = 0;
+  bool found_min = false;
+  for (unsigned int b = 0; b < num_buckets_; b++) {
+    buckets_[b].fetch_sub(earlier.bucket_at(b), std::memory_order_relaxed);
+    if (bucket_at(b) > 0) {
+      if (!found_min) {
+        uint64_t left = (b == 0) ? 0 : bucketMapper.BucketLimit(b - 1) + 1;
+        new_min = std::max(left, min());
+        found_min = true;
+      }
+      new_max = std::min(bucketMapper.BucketLimit(b), max());
+    }
+  }
+  min_.store(new_min, std::memory_order_relaxed);
+  max_.store(new_max, std::memory_order_relaxed);
+}
+
 double HistogramStat::Median() const {
   return Percentile(50.0);
 }
@@ -260,6 +284,11 @@ void HistogramImpl::Merge(const HistogramImpl& other) {
   stats_.Merge(other.stats_);
 }
 
+void HistogramImpl::Subtract(const HistogramImpl& earlier) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.Subtract(earlier.stats_);
+}
+
 double HistogramImpl::Median() const {
   return stats_.Median();
 }
@@ -62,6 +62,10 @@ struct HistogramStat {
   bool Empty() const;
   void Add(uint64_t value);
   void Merge(const HistogramStat& other);
+  // Removes the values of `earlier`, a copy of this histogram taken earlier,
+  // leaving the values recorded since. min() and max() are then only known
+  // to the precision of their buckets.
+  void Subtract(const HistogramStat& earlier);
 
   inline uint64_t min() const { return min_.load(std::memory_order_relaxed); }
   inline uint64_t max() const { return max_.load(std::memory_order_relaxed); }
@@ -127,6 +131,7 @@ class HistogramImpl : public Histogram {
   virtual void Add(uint64_t value) override;
   virtual void Merge(const Histogram& other) override;
   void Merge(const HistogramImpl& other);
+  void Subtract(const HistogramImpl& earlier);
 
   virtual std::string ToString() const override;
   virtual const char* Name() const override { return "HistogramImpl"; }
@@ -0,0 +1,327 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/histogram_log_linear.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "port/port.h"
+#include "util/cast_util.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+LogLinearHistogram::LogLinearHistogram() : LogLinearHistogram(0) {}
+
+LogLinearHistogram::LogLinearHistogram(int precision_bits)
+    : precision_bits_(precision_bits) {
+  for (auto& group : groups_) {
+    group.store(nullptr, std::memory_order_relaxed);
+  }
+  Clear();
+}
+
+LogLinearHistogram::~LogLinearHistogram() {
+  for (auto& group : groups_) {
+    delete[] group.load(std::memory_order_relaxed);
+  }
+}
+
+void LogLinearHistogram::SetPrecisionBits(int precision_bits) {
+  assert(precision_bits >= kMinPrecisionBits &&
+         precision_bits <= kMaxPrecisionBits);
+  assert(Empty());
+  for (auto& group : groups_) {
+    delete[] group.exchange(nullptr, std::memory_order_relaxed);
+  }
+  precision_bits_ = precision_bits;
+}
+
+void LogLinearHistogram::Clear() {
+  min_.store(port::kMaxUint64, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+  num_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  sum_squares_.store(0, std::memory_order_relaxed);
+  for (int g = 0; g < kMaxGroups; ++g) {
+    std::atomic<uint64_t>* counts = groups_[g].load(std::memory_order_acquire);
+    if (counts == nullptr) {
+      continue;
+    }
+    for (uint64_t i = 0; i < GroupSize(); ++i) {
+      counts[i].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void LogLinearHistogram::Locate(uint64_t value, int* group,
+                                uint64_t* index) const {
+  if (value < GroupSize()) {
+    *group = 0;
+    *index = value;
+    return;
+  }
+  const int shift = FloorLog2(value) - precision_bits_;
+  *group = shift + 1;
+  *index = (value >> shift) - GroupSize();
+}
+
+uint64_t LogLinearHistogram::BucketLow(int group, uint64_t index) const {
+  if (group == 0) {
+    return index;
+  }
+  return (GroupSize() + index) << (group - 1);
+}
+
+uint64_t LogLinearHistogram::BucketHigh(int group, uint64_t index) const {
+  if (group == 0) {
+    return index;
+  }
+  return BucketLow(group, index) + ((uint64_t{1} << (group - 1)) - 1);
+}
+
+std::atomic<uint64_t>* LogLinearHistogram::GetOrAllocateGroup(int group) {
+  assert(group < NumGroups());
+  std::atomic<uint64_t>* counts =
+      groups_[group].load(std::memory_order_acquire);
+  if (counts != nullptr) {
+    return counts;
+  }
+  std::atomic<uint64_t>* fresh = new std::atomic<uint64_t>[GroupSize()]();
+  if (groups_[group].compare_exchange_strong(counts, fresh,
+                                             std::memory_order_acq_rel)) {
+    return fresh;
+  }
+  // Another thread allocated it first
+  delete[] fresh;
+  return counts;
+}
+
+uint64_t LogLinearHistogram::BucketCount(int group, uint64_t index) const {
+  const std::atomic<uint64_t>* counts =
+      groups_[group].load(std::memory_order_acquire);
+  return counts == nullptr ? 0 : counts[index].load(std::memory_order_relaxed);
+}
+
+void LogLinearHistogram::Add(uint64_t value) {
+  assert(precision_bits_ >= kMinPrecisionBits);
+  int group;
+  uint64_t index;
+  Locate(value, &group, &index);
+  std::atomic<uint64_t>* counts = GetOrAllocateGroup(group);
+  counts[index].store(counts[index].load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+
+  if (value < min()) {
+    min_.store(value, std::memory_order_relaxed);
+  }
+  if (value > max()) {
+    max_.store(value, std::memory_order_relaxed);
+  }
+  num_.store(num_.load(std::memory_order_relaxed) + 1,
+             std::memory_order_relaxed);
+  sum_.store(sum_.load(std::memory_order_relaxed) + value,
+             std::memory_order_relaxed);
+  sum_squares_.store(
+      sum_squares_.load(std::memory_order_relaxed) + value * value,
+      std::memory_order_relaxed);
+}
+
+void LogLinearHistogram::Merge(const Histogram& other) {
+  if (strcmp(Name(), other.Name()) == 0) {
+    Merge(*static_cast_with_check<const LogLinearHistogram>(&other));
+  }
+}
+
+void LogLinearHistogram::Merge(const LogLinearHistogram& other) {
+  assert(precision_bits_ == other.precision_bits_);
+  if (precision_bits_ != other.precision_bits_) {
+    return;
+  }
+  uint64_t old_min = min();
+  const uint64_t other_min = other.min();
+  while (other_min < old_min &&
+         !min_.compare_exchange_weak(old_min, other_min)) {
+  }
+  uint64_t old_max = max();
+  const uint64_t other_max = other.max();
+  while (other_max > old_max &&
+         !max_.compare_exchange_weak(old_max, other_max)) {
+  }
+  num_.fetch_add(other.num(), std::memory_order_relaxed);
+  sum_.fetch_add(other.sum(), std::memory_order_relaxed);
+  sum_squares_.fetch_add(
+      other.sum_squares_.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  for (int g = 0; g < NumGroups(); ++g) {
+    const std::atomic<uint64_t>* other_counts =
+        other.groups_[g].load(std::memory_order_acquire);
+    if (other_counts == nullptr) {
+      continue;
+    }
+    std::atomic<uint64_t>* counts = GetOrAllocateGroup(g);
+    for (uint64_t i = 0; i < GroupSize(); ++i) {
+      counts[i].fetch_add(other_counts[i].load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    }
+  }
+}
+
+void LogLinearHistogram::Subtract(const LogLinearHistogram& earlier) {
+  assert(precision_bits_ == earlier.precision_bits_);
+  if (precision_bits_ != earlier.precision_bits_) {
+    return;
+  }
+  num_.fetch_sub(earlier.num(), std::memory_order_relaxed);
+  sum_.fetch_sub(earlier.sum(), std::memory_order_relaxed);
+  sum_squares_.fetch_sub(
+      earlier.sum_squares_.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  bool found_min = false;
+  uint64_t new_min = port::kMaxUint64;
+  uint64_t new_max = 0;
+  for (int g = 0; g < NumGroups(); ++g) {
+    std::atomic<uint64_t>* counts = groups_[g].load(std::memory_order_acquire);
+    if (counts == nullptr) {
+      continue;
+    }
+    const std::atomic<uint64_t>* earlier_counts =
+        earlier.groups_[g].load(std::memory_order_acquire);
+    for (uint64_t i = 0; i < GroupSize(); ++i) {
+      if (earlier_counts != nullptr) {
+        counts[i].fetch_sub(earlier_counts[i].load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+      }
+      if (counts[i].load(std::memory_order_relaxed) > 0) {
+        if (!found_min) {
+          new_min = std::max(BucketLow(g, i), min());
+          found_min = true;
+        }
+        new_max = std::min(BucketHigh(g, i), max());
+      }
+    }
+  }
+  min_.store(new_min, std::memory_order_relaxed);
+  max_.store(new_max, std::memory_order_relaxed);
+}
+
+double LogLinearHistogram::Percentile(double p) const {
+  const double threshold = num() * (p / 100.0);
+  uint64_t cumulative_sum = 0;
+  for (int g = 0; g < NumGroups(); ++g) {
+    if (groups_[g].load(std::memory_order_acquire) == nullptr) {
+      continue;
+    }
+    for (uint64_t i = 0; i < GroupSize(); ++i) {
+      const uint64_t bucket_value = BucketCount(g, i);
+      if (bucket_value == 0) {
+        continue;
+      }
+      cumulative_sum += bucket_value;
+      if (cumulative_sum >= threshold) {
+        // Scale linearly within this bucket, taken as (low - 1, high] like
+        // HistogramStat's
+        const uint64_t left_sum = cumulative_sum - bucket_value;
+        const double pos = (threshold - left_sum) / bucket_value;
+        const uint64_t low = BucketLow(g, i);
+        const uint64_t left_point = low == 0 ? 0 : low - 1;
+        double r = left_point + (BucketHigh(g, i) - left_point) * pos;
+        r = std::max(r, static_cast<double>(min()));
+        r = std::min(r, static_cast<double>(max()));
+        return r;
+      }
+    }
+  }
+  return static_cast<double>(max());
+}
+
+double LogLinearHistogram::Average() const {
+  const uint64_t cur_num = num();
+  if (cur_num == 0) {
+    return 0;
+  }
+  return static_cast<double>(sum()) / static_cast<double>(cur_num);
+}
+
+double LogLinearHistogram::StandardDeviation() const {
+  const uint64_t cur_num = num();
+  if (cur_num == 0) {
+    return 0;
+  }
+  const double mean = Average();
+  const double variance =
+      static_cast<double>(sum_squares_.load(std::memory_order_relaxed)) /
+          static_cast<double>(cur_num) -
+      mean * mean;
+  return variance > 0 ? std::sqrt(variance) : 0;
+}
+
+std::string LogLinearHistogram::ToString() const {
+  const uint64_t cur_num = num();
+  std::string r;
+  char buf[200];
+  snprintf(buf, sizeof(buf),
+           "Count: %" PRIu64 " Average: %.4f  StdDev: %.2f\n", cur_num,
+           Average(), StandardDeviation());
+  r.append(buf);
+  snprintf(buf, sizeof(buf),
+           "Min: %" PRIu64 "  Median: %.4f  Max: %" PRIu64 "\n",
+           (cur_num == 0 ? 0 : min()), Median(), (cur_num == 0 ? 0 : max()));
+  r.append(buf);
+  snprintf(buf, sizeof(buf),
+           "Percentiles: "
+           "P50: %.2f P75: %.2f P99: %.2f P99.9: %.2f P99.99: %.2f\n",
+           Percentile(50), Percentile(75), Percentile(99), Percentile(99.9),
+           Percentile(99.99));
+  r.append(buf);
+  r.append("------------------------------------------------------\n");
+  if (cur_num == 0) {
+    return r;
+  }
+  const double mult = 100.0 / cur_num;
+  uint64_t cumulative_sum = 0;
+  for (int g = 0; g < NumGroups(); ++g) {
+    if (groups_[g].load(std::memory_order_acquire) == nullptr) {
+      continue;
+    }
+    for (uint64_t i = 0; i < GroupSize(); ++i) {
+      const uint64_t bucket_value = BucketCount(g, i);
+      if (bucket_value == 0) {
+        continue;
+      }
+      cumulative_sum += bucket_value;
+      snprintf(buf, sizeof(buf),
+               "[ %7" PRIu64 ", %7" PRIu64 " ] %8" PRIu64 " %7.3f%% %7.3f%% ",
+               BucketLow(g, i), BucketHigh(g, i), bucket_value,
+               mult * bucket_value, mult * cumulative_sum);
+      r.append(buf);
+      // Add hash marks based on percentage; 20 marks for 100%.
+      size_t marks = static_cast<size_t>(mult * bucket_value / 5 + 0.5);
+      r.append(marks, '#');
+      r.push_back('\n');
+    }
+  }
+  return r;
+}
+
+void LogLinearHistogram::Data(HistogramData* const data) const {
+  assert(data);
+  data->median = Median();
+  data->percentile95 = Percentile(95);
+  data->percentile99 = Percentile(99);
+  data->max = static_cast<double>(max());
+  data->average = Average();
+  data->standard_deviation = StandardDeviation();
+  data->count = num();
+  data->sum = sum();
+  data->min = static_cast<double>(Empty() ? 0 : min());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
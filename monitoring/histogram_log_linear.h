@@ -0,0 +1,90 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "monitoring/histogram.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A histogram with log-linear (HDR-style) buckets. Values below
+// 2^precision_bits get a bucket each; above that, every power of two is
+// split into 2^precision_bits buckets of equal width. A value is thus
+// bucketed with a relative error of at most 2^-precision_bits, e.g. under 1%
+// with 7 bits, where HistogramImpl's buckets are 1.5x apart.
+//
+// The 2^precision_bits counters of a power of two are allocated the first
+// time a value falls into it, so only the range of values actually recorded
+// costs memory. Like HistogramStat, Add() takes no lock and uses no locked
+// instructions except when allocating counters; it is meant to be used
+// core-locally, and concurrent Add()s on the same object may lose updates.
+class LogLinearHistogram : public Histogram {
+ public:
+  static constexpr int kMinPrecisionBits = 1;
+  static constexpr int kMaxPrecisionBits = 10;
+
+  // SetPrecisionBits() must be called before use
+  LogLinearHistogram();
+  explicit LogLinearHistogram(int precision_bits);
+  ~LogLinearHistogram() override;
+
+  LogLinearHistogram(const LogLinearHistogram&) = delete;
+  LogLinearHistogram& operator=(const LogLinearHistogram&) = delete;
+
+  // Only valid while nothing has been recorded
+  void SetPrecisionBits(int precision_bits);
+  int precision_bits() const { return precision_bits_; }
+
+  void Clear() override;
+  bool Empty() const override { return num() == 0; }
+  void Add(uint64_t value) override;
+  // Only merges histograms of the same precision
+  void Merge(const Histogram& other) override;
+  void Merge(const LogLinearHistogram& other);
+  // Removes the values of `earlier`, a copy of this histogram taken earlier
+  // (with Merge()), leaving the values recorded since. min() and max() are
+  // then only known to the precision of their buckets.
+  void Subtract(const LogLinearHistogram& earlier);
+
+  std::string ToString() const override;
+  const char* Name() const override { return "LogLinearHistogram"; }
+  uint64_t min() const override { return min_.load(std::memory_order_relaxed); }
+  uint64_t max() const override { return max_.load(std::memory_order_relaxed); }
+  uint64_t num() const override { return num_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  double Median() const override { return Percentile(50.0); }
+  double Percentile(double p) const override;
+  double Average() const override;
+  double StandardDeviation() const override;
+  void Data(HistogramData* const data) const override;
+
+ private:
+  // Group 0 holds the values below 2^precision_bits_, group g > 0 those
+  // in [2^(precision_bits_ + g - 1), 2^(precision_bits_ + g))
+  static constexpr int kMaxGroups = 64 - kMinPrecisionBits + 1;
+
+  int NumGroups() const { return 64 - precision_bits_ + 1; }
+  uint64_t GroupSize() const { return uint64_t{1} << precision_bits_; }
+  void Locate(uint64_t value, int* group, uint64_t* index) const;
+  // The smallest and largest value of a bucket
+  uint64_t BucketLow(int group, uint64_t index) const;
+  uint64_t BucketHigh(int group, uint64_t index) const;
+  std::atomic<uint64_t>* GetOrAllocateGroup(int group);
+  uint64_t BucketCount(int group, uint64_t index) const;
+
+  int precision_bits_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+  std::atomic<uint64_t> num_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> sum_squares_;
+  std::atomic<std::atomic<uint64_t>*> groups_[kMaxGroups];
+};
+
+}  // namespace ROCKSDB_NAMESPACE
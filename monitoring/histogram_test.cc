@@ -7,6 +7,7 @@
 
 #include <cmath>
 
+#include "monitoring/histogram_log_linear.h"
 #include "monitoring/histogram_windowing.h"
 #include "rocksdb/system_clock.h"
 #include "test_util/mock_time_env.h"
@@ -93,6 +94,9 @@ TEST_F(HistogramTest, BasicOperation) {
 
   HistogramWindowingImpl histogramWindowing;
   BasicOperation(histogramWindowing);
+
+  LogLinearHistogram logLinear(7);
+  BasicOperation(logLinear);
 }
 
 TEST_F(HistogramTest, BoundaryValue) {
@@ -116,6 +120,10 @@ TEST_F(HistogramTest, MergeHistogram) {
   HistogramWindowingImpl histogramWindowing;
   HistogramWindowingImpl otherWindowing;
   MergeHistogram(histogramWindowing, otherWindowing);
+
+  LogLinearHistogram logLinear(7);
+  LogLinearHistogram otherLogLinear(7);
+  MergeHistogram(logLinear, otherLogLinear);
 }
 
 TEST_F(HistogramTest, EmptyHistogram) {
@@ -132,6 +140,9 @@ TEST_F(HistogramTest, ClearHistogram) {
 
   HistogramWindowingImpl histogramWindowing;
   ClearHistogram(histogramWindowing);
+
+  LogLinearHistogram logLinear(7);
+  ClearHistogram(logLinear);
 }
 
 TEST_F(HistogramTest, HistogramWindowingExpire) {
@@ -225,6 +236,41 @@ TEST_F(HistogramTest, HistogramWindowingMerge) {
   ASSERT_EQ(histogramWindowing.max(), 5);
 }
 
+TEST_F(HistogramTest, LogLinearPrecision) {
+  for (int bits : {3, 7}) {
+    LogLinearHistogram histogram(bits);
+    for (uint64_t i = 1; i <= 1000; i++) {
+      histogram.Add(i * 1000);
+    }
+    const double max_error = std::ldexp(1.0, -bits);
+    ASSERT_LE(fabs(histogram.Median() - 500000.0), 500000.0 * max_error);
+    ASSERT_LE(fabs(histogram.Percentile(99.0) - 990000.0),
+              990000.0 * max_error);
+    ASSERT_LE(fabs(histogram.Percentile(99.9) - 999000.0),
+              999000.0 * max_error);
+    ASSERT_EQ(histogram.min(), 1000U);
+    ASSERT_EQ(histogram.max(), 1000000U);
+  }
+}
+
+TEST_F(HistogramTest, LogLinearSubtract) {
+  LogLinearHistogram histogram(7);
+  PopulateHistogram(histogram, 1, 100);
+  LogLinearHistogram earlier(7);
+  earlier.Merge(histogram);
+  PopulateHistogram(histogram, 1001, 1100);
+
+  histogram.Subtract(earlier);
+  ASSERT_EQ(histogram.num(), 100U);
+  ASSERT_EQ(histogram.Average(), 1050.5);
+  // Only known to the precision of their buckets, 8 wide here
+  ASSERT_GE(histogram.min(), 1000U);
+  ASSERT_LE(histogram.min(), 1001U);
+  ASSERT_GE(histogram.max(), 1100U);
+  ASSERT_LE(histogram.max(), 1103U);
+  ASSERT_LE(fabs(histogram.Median() - 1050.0), 8.0);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -12,7 +12,6 @@
 
 namespace ROCKSDB_NAMESPACE {
 namespace {
-#ifndef NPERF_CONTEXT
 Statistics* stats_for_report(SystemClock* clock, Statistics* stats) {
   if (clock != nullptr && stats != nullptr &&
       stats->get_stats_level() > kExceptTimeForMutex) {
@@ -21,7 +20,6 @@ Statistics* stats_for_report(SystemClock* clock, Statistics* stats) {
     return nullptr;
   }
 }
-#endif  // NPERF_CONTEXT
 }  // namespace
 
 void InstrumentedMutex::Lock() {
@@ -31,6 +29,12 @@ void InstrumentedMutex::Lock() {
   LockInternal();
 }
 
+void InstrumentedMutex::Lock(uint32_t wait_histogram) {
+  Statistics* const stats = stats_for_report(clock_, stats_);
+  StopWatch sw(clock_, stats, wait_histogram);
+  Lock();
+}
+
 void InstrumentedMutex::LockInternal() {
 #ifndef NDEBUG
   ThreadStatusUtil::TEST_StateDelay(ThreadStatus::STATE_MUTEX_WAIT);
@@ -34,6 +34,10 @@ class InstrumentedMutex {
 
   void Lock();
 
+  // Like Lock(), also recording the time waited for the mutex into histogram
+  // `wait_histogram`, to tell apart the callers that wait.
+  void Lock(uint32_t wait_histogram);
+
   void Unlock() {
     mutex_.Unlock();
   }
@@ -58,6 +62,11 @@ class InstrumentedMutexLock {
     mutex_->Lock();
   }
 
+  InstrumentedMutexLock(InstrumentedMutex* mutex, uint32_t wait_histogram)
+      : mutex_(mutex) {
+    mutex_->Lock(wait_histogram);
+  }
+
   ~InstrumentedMutexLock() {
     mutex_->Unlock();
   }
@@ -24,6 +24,26 @@ IOStatsContext* get_iostats_context() {
   return &iostats_context;
 }
 
+#ifndef NIOSTATS_CONTEXT
+static __thread IOActivity thread_io_activity = IOActivity::kUser;
+
+IOActivity GetThreadIOActivity() { return thread_io_activity; }
+
+IOActivityGuard::IOActivityGuard(IOActivity activity)
+    : prev_activity_(thread_io_activity) {
+  thread_io_activity = activity;
+}
+
+IOActivityGuard::~IOActivityGuard() { thread_io_activity = prev_activity_; }
+#else
+IOActivity GetThreadIOActivity() { return IOActivity::kUser; }
+
+IOActivityGuard::IOActivityGuard(IOActivity /*activity*/)
+    : prev_activity_(IOActivity::kUser) {}
+
+IOActivityGuard::~IOActivityGuard() {}
+#endif  // NIOSTATS_CONTEXT
+
 void IOStatsContext::Reset() {
 #ifndef NIOSTATS_CONTEXT
   thread_pool_id = Env::Priority::TOTAL;
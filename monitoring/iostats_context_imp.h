@@ -7,6 +7,31 @@
 #include "monitoring/perf_step_timer.h"
 #include "rocksdb/iostats_context.h"
 
+namespace ROCKSDB_NAMESPACE {
+// What the file I/O of the current thread is done for, which picks the
+// FILE_{READ,WRITE}_*_MICROS histogram it is recorded in
+enum class IOActivity : uint8_t {
+  kUser,
+  kFlush,
+  kCompaction,
+};
+
+IOActivity GetThreadIOActivity();
+
+// Sets the IOActivity of the current thread until destroyed
+class IOActivityGuard {
+ public:
+  explicit IOActivityGuard(IOActivity activity);
+  ~IOActivityGuard();
+
+  IOActivityGuard(const IOActivityGuard&) = delete;
+  IOActivityGuard& operator=(const IOActivityGuard&) = delete;
+
+ private:
+  IOActivity prev_activity_;
+};
+}  // namespace ROCKSDB_NAMESPACE
+
 #if defined(ROCKSDB_SUPPORT_THREAD_LOCAL) && !defined(NIOSTATS_CONTEXT)
 namespace ROCKSDB_NAMESPACE {
 extern __thread IOStatsContext iostats_context;
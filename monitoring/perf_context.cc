@@ -49,6 +49,10 @@ PerfContext::PerfContext(const PerfContext& other) {
   compression_dict_block_read_count = other.compression_dict_block_read_count;
   block_checksum_time = other.block_checksum_time;
   block_decompress_time = other.block_decompress_time;
+  secondary_cache_hit_count = other.secondary_cache_hit_count;
+  compressed_sec_cache_insert_count = other.compressed_sec_cache_insert_count;
+  compressed_sec_cache_uncompressed_bytes = other.compressed_sec_cache_uncompressed_bytes;
+  compressed_sec_cache_compressed_bytes = other.compressed_sec_cache_compressed_bytes;
   get_read_bytes = other.get_read_bytes;
   multiget_read_bytes = other.multiget_read_bytes;
   iter_read_bytes = other.iter_read_bytes;
@@ -146,6 +150,10 @@ PerfContext::PerfContext(PerfContext&& other) noexcept {
   compression_dict_block_read_count = other.compression_dict_block_read_count;
   block_checksum_time = other.block_checksum_time;
   block_decompress_time = other.block_decompress_time;
+  secondary_cache_hit_count = other.secondary_cache_hit_count;
+  compressed_sec_cache_insert_count = other.compressed_sec_cache_insert_count;
+  compressed_sec_cache_uncompressed_bytes = other.compressed_sec_cache_uncompressed_bytes;
+  compressed_sec_cache_compressed_bytes = other.compressed_sec_cache_compressed_bytes;
   get_read_bytes = other.get_read_bytes;
   multiget_read_bytes = other.multiget_read_bytes;
   iter_read_bytes = other.iter_read_bytes;
@@ -245,6 +253,10 @@ PerfContext& PerfContext::operator=(const PerfContext& other) {
   compression_dict_block_read_count = other.compression_dict_block_read_count;
   block_checksum_time = other.block_checksum_time;
   block_decompress_time = other.block_decompress_time;
+  secondary_cache_hit_count = other.secondary_cache_hit_count;
+  compressed_sec_cache_insert_count = other.compressed_sec_cache_insert_count;
+  compressed_sec_cache_uncompressed_bytes = other.compressed_sec_cache_uncompressed_bytes;
+  compressed_sec_cache_compressed_bytes = other.compressed_sec_cache_compressed_bytes;
   get_read_bytes = other.get_read_bytes;
   multiget_read_bytes = other.multiget_read_bytes;
   iter_read_bytes = other.iter_read_bytes;
@@ -341,6 +353,10 @@ void PerfContext::Reset() {
   compression_dict_block_read_count = 0;
   block_checksum_time = 0;
   block_decompress_time = 0;
+  secondary_cache_hit_count = 0;
+  compressed_sec_cache_insert_count = 0;
+  compressed_sec_cache_uncompressed_bytes = 0;
+  compressed_sec_cache_compressed_bytes = 0;
   get_read_bytes = 0;
   multiget_read_bytes = 0;
   iter_read_bytes = 0;
@@ -461,6 +477,10 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(compression_dict_block_read_count);
   PERF_CONTEXT_OUTPUT(block_checksum_time);
   PERF_CONTEXT_OUTPUT(block_decompress_time);
+  PERF_CONTEXT_OUTPUT(secondary_cache_hit_count);
+  PERF_CONTEXT_OUTPUT(compressed_sec_cache_insert_count);
+  PERF_CONTEXT_OUTPUT(compressed_sec_cache_uncompressed_bytes);
+  PERF_CONTEXT_OUTPUT(compressed_sec_cache_compressed_bytes);
   PERF_CONTEXT_OUTPUT(get_read_bytes);
   PERF_CONTEXT_OUTPUT(multiget_read_bytes);
   PERF_CONTEXT_OUTPUT(iter_read_bytes);
@@ -8,10 +8,13 @@
 
 #include "monitoring/persistent_stats_history.h"
 
+#include <cinttypes>
 #include <cstring>
 #include <string>
 #include <utility>
 #include "db/db_impl/db_impl.h"
+#include "util/coding.h"
+#include "util/hash.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -21,13 +24,16 @@ const std::string kFormatVersionKeyString =
     "__persistent_stats_format_version__";
 const std::string kCompatibleVersionKeyString =
     "__persistent_stats_compatible_version__";
+const std::string kStatsSchemaKeyPrefix = "__persistent_stats_schema__";
 // Every release maintains two versions numbers for persistents stats: Current
 // format version and compatible format version. Current format version
 // designates what type of encoding will be used when writing to stats CF;
 // compatible format version designates the minimum format version that
 // can decode the stats CF encoded using the current format version.
-const uint64_t kStatsCFCurrentFormatVersion = 1;
-const uint64_t kStatsCFCompatibleFormatVersion = 1;
+// Format version 2 writes a single record per snapshot, which format
+// version 1 cannot read.
+const uint64_t kStatsCFCurrentFormatVersion = 2;
+const uint64_t kStatsCFCompatibleFormatVersion = 2;
 
 Status DecodePersistentStatsVersionNumber(DBImpl* db, StatsVersionKeyType type,
                                           uint64_t* version_number) {
@@ -64,6 +70,49 @@ int EncodePersistentStatsKey(uint64_t now_seconds, const std::string& key,
   return snprintf(buf, size, "%s#%s", timestamp, key.c_str());
 }
 
+std::string PersistentStatsRecordKey(uint64_t timestamp) {
+  char buf[kNowSecondsStringLength + 1];
+  snprintf(buf, sizeof(buf), "%010d", static_cast<int>(timestamp));
+  return std::string(buf, kNowSecondsStringLength);
+}
+
+std::string PersistentStatsSchemaKey(uint64_t schema_id) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016" PRIx64, schema_id);
+  return kStatsSchemaKeyPrefix + buf;
+}
+
+uint64_t EncodePersistentStatsSchema(
+    const std::map<std::string, uint64_t>& stats, std::string* schema) {
+  schema->clear();
+  PutVarint32(schema, static_cast<uint32_t>(stats.size()));
+  for (const auto& stat : stats) {
+    PutLengthPrefixedSlice(schema, stat.first);
+  }
+  return GetSliceNPHash64(*schema);
+}
+
+void EncodePersistentStatsRecord(uint64_t schema_id,
+                                 const std::map<std::string, uint64_t>& stats,
+                                 std::string* record) {
+  record->clear();
+  PutFixed64(record, schema_id);
+  uint32_t num_non_zero = 0;
+  for (const auto& stat : stats) {
+    num_non_zero += stat.second != 0;
+  }
+  PutVarint32(record, num_non_zero);
+  uint32_t index = 0;
+  uint32_t next_index = 0;
+  for (const auto& stat : stats) {
+    if (stat.second != 0) {
+      PutVarint32Varint64(record, index - next_index, stat.second);
+      next_index = index + 1;
+    }
+    ++index;
+  }
+}
+
 void OptimizeForPersistentStats(ColumnFamilyOptions* cfo) {
   cfo->write_buffer_size = 2 << 20;
   cfo->target_file_size_base = 2 * 1048576;
@@ -96,6 +145,11 @@ std::pair<uint64_t, std::string> parseKey(const Slice& key,
   std::pair<uint64_t, std::string> result;
   std::string key_str = key.ToString();
   std::string::size_type pos = key_str.find("#");
+  if (pos == std::string::npos && key_str.size() == kNowSecondsStringLength &&
+      isdigit(key_str[0])) {
+    // The key of a record, with an empty stats key
+    pos = key_str.size();
+  }
   // TODO(Zhongyi): add counters to track parse failures?
   if (pos == std::string::npos) {
     result.first = port::kMaxUint64;
@@ -108,8 +162,9 @@ std::pair<uint64_t, std::string> parseKey(const Slice& key,
       result.second = "";
     } else {
       result.first = parsed_time;
-      std::string key_resize = key_str.substr(pos + 1);
-      result.second = key_resize;
+      if (pos < key_str.size()) {
+        result.second = key_str.substr(pos + 1);
+      }
     }
   }
   return result;
@@ -120,50 +175,117 @@ std::pair<uint64_t, std::string> parseKey(const Slice& key,
 void PersistentStatsHistoryIterator::AdvanceIteratorByTime(uint64_t start_time,
                                                            uint64_t end_time) {
   // try to find next entry in stats_history_ map
-  if (db_impl_ != nullptr) {
+  if (db_impl_ == nullptr) {
+    valid_ = false;
+    return;
+  }
+  ReadOptions ro;
+  std::unique_ptr<Iterator> iter(
+      db_impl_->NewIterator(ro, db_impl_->PersistentStatsColumnFamily()));
+  iter->Seek(PersistentStatsRecordKey(std::max(time_, start_time)));
+  // no more entries with timestamp >= start_time is found or version key
+  // is found to be incompatible
+  if (!iter->Valid()) {
+    status_ = iter->status();
+    valid_ = false;
+    return;
+  }
+  time_ = parseKey(iter->key(), start_time).first;
+  valid_ = true;
+  // check parsed time and invalid if it exceeds end_time
+  if (time_ > end_time) {
+    valid_ = false;
+    return;
+  }
+  // find all entries with timestamp equal to time_
+  std::map<std::string, uint64_t> new_stats_map;
+  std::pair<uint64_t, std::string> kv;
+  for (; iter->Valid(); iter->Next()) {
+    kv = parseKey(iter->key(), start_time);
+    if (kv.first != time_) {
+      break;
+    }
+    if (kv.second.empty()) {
+      // A record of format version 2
+      Status s = DecodeRecord(iter->value(), &new_stats_map);
+      if (!s.ok()) {
+        status_ = s;
+        valid_ = false;
+        return;
+      }
+      continue;
+    }
+    if (kv.second.compare(kFormatVersionKeyString) == 0) {
+      continue;
+    }
+    new_stats_map[kv.second] = ParseUint64(iter->value().ToString());
+  }
+  if (!iter->status().ok()) {
+    status_ = iter->status();
+    valid_ = false;
+    return;
+  }
+  stats_map_.swap(new_stats_map);
+}
+
+Status PersistentStatsHistoryIterator::DecodeRecord(
+    const Slice& record, std::map<std::string, uint64_t>* stats_map) {
+  Slice input = record;
+  uint64_t schema_id = 0;
+  uint32_t num_non_zero = 0;
+  if (!GetFixed64(&input, &schema_id) || !GetVarint32(&input, &num_non_zero)) {
+    return Status::Corruption("Truncated persistent stats record");
+  }
+  auto it = schemas_.find(schema_id);
+  if (it == schemas_.end()) {
     ReadOptions ro;
-    Iterator* iter =
-        db_impl_->NewIterator(ro, db_impl_->PersistentStatsColumnFamily());
-
-    char timestamp[kNowSecondsStringLength + 1];
-    snprintf(timestamp, sizeof(timestamp), "%010d",
-             static_cast<int>(std::max(time_, start_time)));
-    timestamp[kNowSecondsStringLength] = '\0';
-
-    iter->Seek(timestamp);
-    // no more entries with timestamp >= start_time is found or version key
-    // is found to be incompatible
-    if (!iter->Valid()) {
-      valid_ = false;
-      delete iter;
-      return;
+    ro.verify_checksums = true;
+    std::string value;
+    Status s = db_impl_->Get(ro, db_impl_->PersistentStatsColumnFamily(),
+                             PersistentStatsSchemaKey(schema_id), &value);
+    if (!s.ok()) {
+      return s.IsNotFound() ? Status::Corruption(
+                                  "Missing persistent stats schema " +
+                                  PersistentStatsSchemaKey(schema_id))
+                            : s;
     }
-    time_ = parseKey(iter->key(), start_time).first;
-    valid_ = true;
-    // check parsed time and invalid if it exceeds end_time
-    if (time_ > end_time) {
-      valid_ = false;
-      delete iter;
-      return;
+    Slice schema = value;
+    uint32_t num_names = 0;
+    if (!GetVarint32(&schema, &num_names)) {
+      return Status::Corruption("Truncated persistent stats schema");
     }
-    // find all entries with timestamp equal to time_
-    std::map<std::string, uint64_t> new_stats_map;
-    std::pair<uint64_t, std::string> kv;
-    for (; iter->Valid(); iter->Next()) {
-      kv = parseKey(iter->key(), start_time);
-      if (kv.first != time_) {
-        break;
-      }
-      if (kv.second.compare(kFormatVersionKeyString) == 0) {
-        continue;
+    std::vector<std::string> names;
+    names.reserve(num_names);
+    for (uint32_t i = 0; i < num_names; ++i) {
+      Slice name;
+      if (!GetLengthPrefixedSlice(&schema, &name)) {
+        return Status::Corruption("Truncated persistent stats schema");
       }
-      new_stats_map[kv.second] = ParseUint64(iter->value().ToString());
+      names.push_back(name.ToString());
     }
-    stats_map_.swap(new_stats_map);
-    delete iter;
-  } else {
-    valid_ = false;
+    it = schemas_.emplace(schema_id, std::move(names)).first;
+  }
+  const std::vector<std::string>& names = it->second;
+  // The values left out are zero
+  for (const std::string& name : names) {
+    stats_map->emplace(name, 0);
   }
+  size_t index = 0;
+  for (uint32_t i = 0; i < num_non_zero; ++i) {
+    uint32_t zeros_skipped = 0;
+    uint64_t value = 0;
+    if (!GetVarint32(&input, &zeros_skipped) ||
+        !GetVarint64(&input, &value)) {
+      return Status::Corruption("Truncated persistent stats record");
+    }
+    index += zeros_skipped;
+    if (index >= names.size()) {
+      return Status::Corruption("Persistent stats record exceeds its schema");
+    }
+    (*stats_map)[names[index]] = value;
+    ++index;
+  }
+  return Status::OK();
 }
 
 }  // namespace ROCKSDB_NAMESPACE
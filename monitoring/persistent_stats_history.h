@@ -8,6 +8,10 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "db/db_impl/db_impl.h"
 #include "rocksdb/stats_history.h"
 
@@ -33,9 +37,41 @@ Status DecodePersistentStatsVersionNumber(DBImpl* db, StatsVersionKeyType type,
 // Encode timestamp and stats key into buf
 // Format: timestamp(10 digit) + '#' + key
 // Total length of encoded key will be capped at 100 bytes
+// Format version 1 wrote every stat of a snapshot under such a key. It is
+// still read, but no longer written.
 int EncodePersistentStatsKey(uint64_t timestamp, const std::string& key,
                              int size, char* buf);
 
+// Since format version 2, each stats snapshot is a single record whose key
+// is the timestamp (10 digits), sorting before the format version 1 keys of
+// the same timestamp. The record holds the values of the stats in the order
+// of their names in a schema, which is stored once under its own key:
+//   schema key: kStatsSchemaKeyPrefix + schema id (16 hex digits)
+//   schema:     [num names: varint32] [name: length prefixed slice]*
+//   record:     [schema id: fixed64] [num non-zero values: varint32]
+//               ([zeros skipped: varint32] [value: varint64])*
+// where the schema id is a hash of the schema, and zeros skipped is the
+// number of stats with a zero value between the stat and the previous
+// non-zero one in the schema. Stats are persisted as deltas from the
+// previous snapshot, so that most values are zero and left out.
+extern const std::string kStatsSchemaKeyPrefix;
+
+// Returns the key of a stats snapshot record
+std::string PersistentStatsRecordKey(uint64_t timestamp);
+
+// Returns the key of a schema
+std::string PersistentStatsSchemaKey(uint64_t schema_id);
+
+// Encodes the names of stats into *schema and returns its schema id
+uint64_t EncodePersistentStatsSchema(
+    const std::map<std::string, uint64_t>& stats, std::string* schema);
+
+// Encodes the values of stats into *record. The names of stats must be
+// those of the schema.
+void EncodePersistentStatsRecord(uint64_t schema_id,
+                                 const std::map<std::string, uint64_t>& stats,
+                                 std::string* record);
+
 void OptimizeForPersistentStats(ColumnFamilyOptions* cfo);
 
 class PersistentStatsHistoryIterator final : public StatsHistoryIterator {
@@ -63,6 +99,10 @@ class PersistentStatsHistoryIterator final : public StatsHistoryIterator {
   // between [start_time, end_time)
   void AdvanceIteratorByTime(uint64_t start_time, uint64_t end_time);
 
+  // Adds the stats of a format version 2 record to *stats_map
+  Status DecodeRecord(const Slice& record,
+                      std::map<std::string, uint64_t>* stats_map);
+
   // No copying allowed
   PersistentStatsHistoryIterator(const PersistentStatsHistoryIterator&) =
       delete;
@@ -78,6 +118,8 @@ class PersistentStatsHistoryIterator final : public StatsHistoryIterator {
   Status status_;
   bool valid_;
   DBImpl* db_impl_;
+  // Names of the stats of each schema read so far, by schema id
+  std::unordered_map<uint64_t, std::vector<std::string>> schemas_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
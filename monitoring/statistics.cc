@@ -9,6 +9,7 @@
 #include <cinttypes>
 #include <cstdio>
 #include "rocksdb/statistics.h"
+#include "util/cast_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -205,6 +206,32 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
      "rocksdb.memtable.payload.bytes.at.flush"},
     {MEMTABLE_GARBAGE_BYTES_AT_FLUSH,
      "rocksdb.memtable.garbage.bytes.at.flush"},
+    {WAL_COMPRESSION_INPUT_BYTES, "rocksdb.wal.compression.input.bytes"},
+    {WAL_COMPRESSION_OUTPUT_BYTES, "rocksdb.wal.compression.output.bytes"},
+    {RANGE_FILTER_USEFUL, "rocksdb.range.filter.useful"},
+    {HOT_KEY_CACHE_HIT, "rocksdb.hot.key.cache.hit"},
+    {HOT_KEY_CACHE_MISS, "rocksdb.hot.key.cache.miss"},
+    {COMPACT_COPIED_DATA_BLOCKS, "rocksdb.compact.copied.data.blocks"},
+    {BLOB_DB_CACHE_HIT, "rocksdb.blobdb.cache.hit"},
+    {BLOB_DB_CACHE_MISS, "rocksdb.blobdb.cache.miss"},
+    {BLOB_DB_CACHE_ADD, "rocksdb.blobdb.cache.add"},
+    {BLOB_DB_CACHE_ADD_FAILURES, "rocksdb.blobdb.cache.add.failures"},
+    {HEDGED_READS_ISSUED, "rocksdb.hedged.reads.issued"},
+    {HEDGED_READS_WON, "rocksdb.hedged.reads.won"},
+    {TXN_COMMIT_CACHE_EVICTED_LOOKUP,
+     "rocksdb.txn.commit.cache.evicted.lookup"},
+    {TXN_PREPARE_MUTEX_SKIPPED, "rocksdb.txn.overhead.mutex.prepare.skipped"},
+    {ADAPTIVE_COMPRESSION_SKIPPED, "rocksdb.adaptive.compression.skipped"},
+    {ADAPTIVE_COMPRESSION_FAST, "rocksdb.adaptive.compression.fast"},
+    {ADAPTIVE_COMPRESSION_CONFIGURED,
+     "rocksdb.adaptive.compression.configured"},
+    {MERGE_OPERANDS_COLLAPSED, "rocksdb.merge.operands.collapsed"},
+    {MERGE_OPERANDS_COLLAPSE_ABORTED,
+     "rocksdb.merge.operands.collapse.aborted"},
+    {MEMTABLE_BLOOM_CHECKED, "rocksdb.memtable.bloom.checked"},
+    {MEMTABLE_BLOOM_USEFUL, "rocksdb.memtable.bloom.useful"},
+    {WRITE_FAST_PATH, "rocksdb.write.fast.path"},
+    {WRITE_FAST_PATH_FALLBACK, "rocksdb.write.fast.path.fallback"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -262,14 +289,139 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {NUM_SST_READ_PER_LEVEL, "rocksdb.num.sst.read.per.level"},
     {ERROR_HANDLER_AUTORESUME_RETRY_COUNT,
      "rocksdb.error.handler.autoresume.retry.count"},
+    {WAL_COMPRESSION_TIMES_NANOS, "rocksdb.wal.compression.times.nanos"},
+    {NUM_LEVELS_READ_PER_GET, "rocksdb.num.levels.read.per.get"},
+    {DB_MUTEX_WAIT_GET_SNAPSHOT_MICROS,
+     "rocksdb.db.mutex.wait.get.snapshot.micros"},
+    {DB_MUTEX_WAIT_WRITE_MICROS, "rocksdb.db.mutex.wait.write.micros"},
+    {DB_MUTEX_WAIT_BG_JOB_MICROS, "rocksdb.db.mutex.wait.bg.job.micros"},
+    {COMPACTION_PICK_MICROS, "rocksdb.compaction.pick.micros"},
+    {FLUSH_QUEUE_WAIT_MICROS, "rocksdb.flush.queue.wait.micros"},
+    {COMPACTION_QUEUE_WAIT_MICROS, "rocksdb.compaction.queue.wait.micros"},
+    {SAMPLED_GET_MEMTABLE_NANOS, "rocksdb.sampled.get.memtable.nanos"},
+    {SAMPLED_GET_FILTER_NANOS, "rocksdb.sampled.get.filter.nanos"},
+    {SAMPLED_GET_INDEX_NANOS, "rocksdb.sampled.get.index.nanos"},
+    {SAMPLED_GET_DATA_BLOCK_NANOS, "rocksdb.sampled.get.data.block.nanos"},
+    {SAMPLED_GET_DECOMPRESS_NANOS, "rocksdb.sampled.get.decompress.nanos"},
+    {SAMPLED_GET_IO_NANOS, "rocksdb.sampled.get.io.nanos"},
+    {FILE_READ_USER_MICROS, "rocksdb.file.read.user.micros"},
+    {FILE_READ_FLUSH_MICROS, "rocksdb.file.read.flush.micros"},
+    {FILE_READ_COMPACTION_MICROS, "rocksdb.file.read.compaction.micros"},
+    {FILE_WRITE_USER_MICROS, "rocksdb.file.write.user.micros"},
+    {FILE_WRITE_FLUSH_MICROS, "rocksdb.file.write.flush.micros"},
+    {FILE_WRITE_COMPACTION_MICROS, "rocksdb.file.write.compaction.micros"},
+    {WAL_FILE_WRITE_MICROS, "rocksdb.wal.file.write.micros"},
+    {MANIFEST_FILE_WRITE_MICROS, "rocksdb.manifest.file.write.micros"},
+    {SST_FILE_WRITE_MICROS, "rocksdb.sst.file.write.micros"},
+    {BLOB_FILE_WRITE_MICROS, "rocksdb.blob.file.write.micros"},
+    {CHECKPOINT_MICROS, "rocksdb.checkpoint.micros"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
   return std::make_shared<StatisticsImpl>(nullptr);
 }
 
-StatisticsImpl::StatisticsImpl(std::shared_ptr<Statistics> stats)
-    : stats_(std::move(stats)) {}
+std::shared_ptr<Statistics> CreateDBStatistics(int histogram_precision_bits) {
+  return std::make_shared<StatisticsImpl>(nullptr, histogram_precision_bits);
+}
+
+TeeStatistics::TeeStatistics(std::shared_ptr<Statistics> primary,
+                             std::shared_ptr<Statistics> secondary)
+    : primary_(std::move(primary)), secondary_(std::move(secondary)) {
+  assert(primary_ != nullptr && secondary_ != nullptr);
+  SyncStatsLevel();
+}
+
+uint64_t TeeStatistics::getTickerCount(uint32_t ticker_type) const {
+  return primary_->getTickerCount(ticker_type);
+}
+
+void TeeStatistics::histogramData(uint32_t histogram_type,
+                                  HistogramData* const data) const {
+  primary_->histogramData(histogram_type, data);
+}
+
+bool TeeStatistics::histogramDataInterval(uint32_t histogram_type,
+                                          HistogramData* const data) {
+  return primary_->histogramDataInterval(histogram_type, data);
+}
+
+std::string TeeStatistics::getHistogramString(uint32_t histogram_type) const {
+  return primary_->getHistogramString(histogram_type);
+}
+
+void TeeStatistics::setTickerCount(uint32_t ticker_type, uint64_t count) {
+  primary_->setTickerCount(ticker_type, count);
+  secondary_->setTickerCount(ticker_type, count);
+}
+
+uint64_t TeeStatistics::getAndResetTickerCount(uint32_t ticker_type) {
+  secondary_->getAndResetTickerCount(ticker_type);
+  return primary_->getAndResetTickerCount(ticker_type);
+}
+
+void TeeStatistics::recordTick(uint32_t ticker_type, uint64_t count) {
+  SyncStatsLevel();
+  primary_->recordTick(ticker_type, count);
+  secondary_->recordTick(ticker_type, count);
+}
+
+void TeeStatistics::reportTimeToHistogram(uint32_t histogram_type,
+                                          uint64_t time) {
+  SyncStatsLevel();
+  primary_->reportTimeToHistogram(histogram_type, time);
+  secondary_->reportTimeToHistogram(histogram_type, time);
+}
+
+void TeeStatistics::recordInHistogram(uint32_t histogram_type,
+                                      uint64_t value) {
+  SyncStatsLevel();
+  primary_->recordInHistogram(histogram_type, value);
+  secondary_->recordInHistogram(histogram_type, value);
+}
+
+Status TeeStatistics::Reset() {
+  Status s = primary_->Reset();
+  Status s2 = secondary_->Reset();
+  if (s.ok()) {
+    return s2;
+  }
+  s2.PermitUncheckedError();
+  return s;
+}
+
+std::string TeeStatistics::ToString() const { return primary_->ToString(); }
+
+bool TeeStatistics::getTickerMap(
+    std::map<std::string, uint64_t>* stats_map) const {
+  return primary_->getTickerMap(stats_map);
+}
+
+bool TeeStatistics::HistEnabledForType(uint32_t type) const {
+  return primary_->HistEnabledForType(type) ||
+         secondary_->HistEnabledForType(type);
+}
+
+StatisticsImpl::StatisticsImpl(std::shared_ptr<Statistics> stats,
+                               int histogram_precision_bits)
+    : stats_(std::move(stats)),
+      histogram_precision_bits_(
+          histogram_precision_bits == 0
+              ? 0
+              : std::min(std::max(histogram_precision_bits,
+                                  LogLinearHistogram::kMinPrecisionBits),
+                         LogLinearHistogram::kMaxPrecisionBits)) {
+  if (histogram_precision_bits_ > 0) {
+    per_core_log_linear_.reset(new CoreLocalArray<LogLinearHistograms>());
+    for (size_t core_idx = 0; core_idx < per_core_log_linear_->Size();
+         ++core_idx) {
+      LogLinearHistograms* core = per_core_log_linear_->AccessAtCore(core_idx);
+      for (auto& h : core->histograms_) {
+        h.SetPrecisionBits(histogram_precision_bits_);
+      }
+    }
+  }
+}
 
 StatisticsImpl::~StatisticsImpl() {}
 
@@ -290,13 +442,59 @@ uint64_t StatisticsImpl::getTickerCountLocked(uint32_t tickerType) const {
 void StatisticsImpl::histogramData(uint32_t histogramType,
                                    HistogramData* const data) const {
   MutexLock lock(&aggregate_lock_);
-  getHistogramImplLocked(histogramType)->Data(data);
+  getHistogramLocked(histogramType)->Data(data);
+}
+
+bool StatisticsImpl::histogramDataInterval(uint32_t histogramType,
+                                           HistogramData* const data) {
+  assert(histogramType < HISTOGRAM_ENUM_MAX);
+  histogramDataSince(histogramType, &interval_base_[histogramType], data);
+  return true;
+}
+
+void StatisticsImpl::histogramDataSince(uint32_t histogramType,
+                                        std::unique_ptr<Histogram>* base_ptr,
+                                        HistogramData* const data) {
+  assert(histogramType < HISTOGRAM_ENUM_MAX);
+  MutexLock lock(&aggregate_lock_);
+  std::unique_ptr<Histogram> current = getHistogramLocked(histogramType);
+  std::unique_ptr<Histogram> interval = NewHistogram();
+  interval->Merge(*current);
+  const Histogram* base = base_ptr->get();
+  // A base kept by the caller may predate a Reset()
+  if (base != nullptr && base->num() <= current->num()) {
+    if (histogram_precision_bits_ > 0) {
+      static_cast_with_check<LogLinearHistogram>(interval.get())
+          ->Subtract(*static_cast_with_check<const LogLinearHistogram>(base));
+    } else {
+      static_cast_with_check<HistogramImpl>(interval.get())
+          ->Subtract(*static_cast_with_check<const HistogramImpl>(base));
+    }
+  }
+  interval->Data(data);
+  *base_ptr = std::move(current);
 }
 
-std::unique_ptr<HistogramImpl> StatisticsImpl::getHistogramImplLocked(
+std::unique_ptr<Histogram> StatisticsImpl::NewHistogram() const {
+  if (histogram_precision_bits_ > 0) {
+    return std::unique_ptr<Histogram>(
+        new LogLinearHistogram(histogram_precision_bits_));
+  }
+  return std::unique_ptr<Histogram>(new HistogramImpl());
+}
+
+std::unique_ptr<Histogram> StatisticsImpl::getHistogramLocked(
     uint32_t histogramType) const {
   assert(histogramType < HISTOGRAM_ENUM_MAX);
-  std::unique_ptr<HistogramImpl> res_hist(new HistogramImpl());
+  std::unique_ptr<Histogram> res_hist = NewHistogram();
+  if (per_core_log_linear_ != nullptr) {
+    for (size_t core_idx = 0; core_idx < per_core_log_linear_->Size();
+         ++core_idx) {
+      res_hist->Merge(per_core_log_linear_->AccessAtCore(core_idx)
+                          ->histograms_[histogramType]);
+    }
+    return res_hist;
+  }
   for (size_t core_idx = 0; core_idx < per_core_stats_.Size(); ++core_idx) {
     res_hist->Merge(
         per_core_stats_.AccessAtCore(core_idx)->histograms_[histogramType]);
@@ -306,7 +504,7 @@ std::unique_ptr<HistogramImpl> StatisticsImpl::getHistogramImplLocked(
 
 std::string StatisticsImpl::getHistogramString(uint32_t histogramType) const {
   MutexLock lock(&aggregate_lock_);
-  return getHistogramImplLocked(histogramType)->ToString();
+  return getHistogramLocked(histogramType)->ToString();
 }
 
 void StatisticsImpl::setTickerCount(uint32_t tickerType, uint64_t count) {
@@ -367,7 +565,11 @@ void StatisticsImpl::recordInHistogram(uint32_t histogramType, uint64_t value) {
   if (get_stats_level() <= StatsLevel::kExceptHistogramOrTimers) {
     return;
   }
-  per_core_stats_.Access()->histograms_[histogramType].Add(value);
+  if (per_core_log_linear_ != nullptr) {
+    per_core_log_linear_->Access()->histograms_[histogramType].Add(value);
+  } else {
+    per_core_stats_.Access()->histograms_[histogramType].Add(value);
+  }
   if (stats_ && histogramType < HISTOGRAM_ENUM_MAX) {
     stats_->recordInHistogram(histogramType, value);
   }
@@ -382,6 +584,13 @@ Status StatisticsImpl::Reset() {
     for (size_t core_idx = 0; core_idx < per_core_stats_.Size(); ++core_idx) {
       per_core_stats_.AccessAtCore(core_idx)->histograms_[i].Clear();
     }
+    if (per_core_log_linear_ != nullptr) {
+      for (size_t core_idx = 0; core_idx < per_core_log_linear_->Size();
+           ++core_idx) {
+        per_core_log_linear_->AccessAtCore(core_idx)->histograms_[i].Clear();
+      }
+    }
+    interval_base_[i].reset();
   }
   return Status::OK();
 }
@@ -408,7 +617,7 @@ std::string StatisticsImpl::ToString() const {
     assert(h.first < HISTOGRAM_ENUM_MAX);
     char buffer[kTmpStrBufferSize];
     HistogramData hData;
-    getHistogramImplLocked(h.first)->Data(&hData);
+    getHistogramLocked(h.first)->Data(&hData);
     // don't handle failures - buffer should always be big enough and arguments
     // should be provided correctly
     int ret =
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "monitoring/histogram.h"
+#include "monitoring/histogram_log_linear.h"
 #include "port/likely.h"
 #include "port/port.h"
 #include "util/core_local.h"
@@ -42,12 +43,23 @@ enum HistogramsInternal : uint32_t {
 
 class StatisticsImpl : public Statistics {
  public:
-  StatisticsImpl(std::shared_ptr<Statistics> stats);
+  // With a non-zero `histogram_precision_bits`, histograms are kept as
+  // LogLinearHistograms of that precision instead of HistogramImpls.
+  explicit StatisticsImpl(std::shared_ptr<Statistics> stats,
+                          int histogram_precision_bits = 0);
   virtual ~StatisticsImpl();
 
   virtual uint64_t getTickerCount(uint32_t ticker_type) const override;
   virtual void histogramData(uint32_t histogram_type,
                              HistogramData* const data) const override;
+  bool histogramDataInterval(uint32_t histogram_type,
+                             HistogramData* const data) override;
+  // Like histogramDataInterval(), but with the histogram as of the previous
+  // call kept by the caller in `*base`, so that internal users do not take
+  // the intervals of the user's calls
+  void histogramDataSince(uint32_t histogram_type,
+                          std::unique_ptr<Histogram>* base,
+                          HistogramData* const data);
   std::string getHistogramString(uint32_t histogram_type) const override;
 
   virtual void setTickerCount(uint32_t ticker_type, uint64_t count) override;
@@ -100,12 +112,75 @@ class StatisticsImpl : public Statistics {
 
   CoreLocalArray<StatisticsData> per_core_stats_;
 
+  // Used instead of StatisticsData::histograms_ with a non-zero
+  // histogram_precision_bits_
+  struct ALIGN_AS(CACHE_LINE_SIZE) LogLinearHistograms {
+    LogLinearHistogram histograms_[INTERNAL_HISTOGRAM_ENUM_MAX];
+    void *operator new(size_t s) { return port::cacheline_aligned_alloc(s); }
+    void *operator new[](size_t s) { return port::cacheline_aligned_alloc(s); }
+    void operator delete(void *p) { port::cacheline_aligned_free(p); }
+    void operator delete[](void *p) { port::cacheline_aligned_free(p); }
+  };
+
+  const int histogram_precision_bits_;
+  std::unique_ptr<CoreLocalArray<LogLinearHistograms>> per_core_log_linear_;
+
+  // The histograms as of the last histogramDataInterval() call for them
+  std::unique_ptr<Histogram> interval_base_[INTERNAL_HISTOGRAM_ENUM_MAX];
+
   uint64_t getTickerCountLocked(uint32_t ticker_type) const;
-  std::unique_ptr<HistogramImpl> getHistogramImplLocked(
-      uint32_t histogram_type) const;
+  // Merges the histogram of all cores into a new object
+  std::unique_ptr<Histogram> getHistogramLocked(uint32_t histogram_type) const;
+  std::unique_ptr<Histogram> NewHistogram() const;
   void setTickerCountLocked(uint32_t ticker_type, uint64_t count);
 };
 
+// Records every update into two Statistics objects, the DB-wide one and the
+// one of a column family (ColumnFamilyOptions::statistics), so that the
+// column family's reads, writes, flushes and compactions show up in both.
+// Queries are answered by the DB-wide one, whose stats level this object
+// follows.
+class TeeStatistics : public Statistics {
+ public:
+  TeeStatistics(std::shared_ptr<Statistics> primary,
+                std::shared_ptr<Statistics> secondary);
+
+  uint64_t getTickerCount(uint32_t ticker_type) const override;
+  void histogramData(uint32_t histogram_type,
+                     HistogramData* const data) const override;
+  std::string getHistogramString(uint32_t histogram_type) const override;
+
+  bool histogramDataInterval(uint32_t histogram_type,
+                             HistogramData* const data) override;
+
+  void setTickerCount(uint32_t ticker_type, uint64_t count) override;
+  uint64_t getAndResetTickerCount(uint32_t ticker_type) override;
+  void recordTick(uint32_t ticker_type, uint64_t count) override;
+  void reportTimeToHistogram(uint32_t histogram_type,
+                             uint64_t time) override;
+  void measureTime(uint32_t histogram_type, uint64_t time) override {
+    recordInHistogram(histogram_type, time);
+  }
+  void recordInHistogram(uint32_t histogram_type, uint64_t value) override;
+
+  Status Reset() override;
+  std::string ToString() const override;
+  bool getTickerMap(std::map<std::string, uint64_t>*) const override;
+  bool HistEnabledForType(uint32_t type) const override;
+
+ private:
+  // Callers check get_stats_level() on this object before timing things
+  void SyncStatsLevel() {
+    StatsLevel level = primary_->get_stats_level();
+    if (get_stats_level() != level) {
+      set_stats_level(level);
+    }
+  }
+
+  std::shared_ptr<Statistics> primary_;
+  std::shared_ptr<Statistics> secondary_;
+};
+
 // Utility functions
 inline void RecordInHistogram(Statistics* statistics, uint32_t histogram_type,
                               uint64_t value) {
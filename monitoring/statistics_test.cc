@@ -38,6 +38,38 @@ TEST_F(StatisticsTest, SanityHistograms) {
   }
 }
 
+TEST_F(StatisticsTest, HistogramDataInterval) {
+  for (int precision_bits : {0, 7}) {
+    std::shared_ptr<Statistics> stats =
+        precision_bits == 0 ? CreateDBStatistics()
+                            : CreateDBStatistics(precision_bits);
+    for (uint64_t i = 1; i <= 100; ++i) {
+      stats->recordInHistogram(DB_GET, i);
+    }
+    HistogramData data;
+    ASSERT_TRUE(stats->histogramDataInterval(DB_GET, &data));
+    ASSERT_EQ(100U, data.count);
+    ASSERT_EQ(100.0, data.max);
+
+    for (uint64_t i = 1001; i <= 1100; ++i) {
+      stats->recordInHistogram(DB_GET, i);
+    }
+    ASSERT_TRUE(stats->histogramDataInterval(DB_GET, &data));
+    ASSERT_EQ(100U, data.count);
+    ASSERT_EQ(105050U, data.sum);
+    // Only known to the precision of its bucket
+    ASSERT_GT(data.min, 100.0);
+    ASSERT_LE(data.min, 1001.0);
+    ASSERT_EQ(1100.0, data.max);
+
+    // The cumulative data is left alone
+    stats->histogramData(DB_GET, &data);
+    ASSERT_EQ(200U, data.count);
+    ASSERT_TRUE(stats->histogramDataInterval(DB_GET, &data));
+    ASSERT_EQ(0U, data.count);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -325,9 +325,9 @@ TEST_F(StatsHistoryTest, GetStatsHistoryFromDisk) {
       db_->NewIterator(ReadOptions(), dbfull()->PersistentStatsColumnFamily());
   int key_count3 = countkeys(iter);
   delete iter;
-  ASSERT_GE(key_count2, key_count1);
-  ASSERT_GE(key_count3, key_count2);
-  ASSERT_EQ(key_count3 - key_count2, key_count2 - key_count1);
+  // One record per snapshot
+  ASSERT_EQ(key_count2 - key_count1, 1);
+  ASSERT_EQ(key_count3 - key_count2, 1);
   std::unique_ptr<StatsHistoryIterator> stats_iter;
   ASSERT_OK(
       db_->GetStatsHistory(0, mock_clock_->NowSeconds() + 1, &stats_iter));
@@ -347,8 +347,11 @@ TEST_F(StatsHistoryTest, GetStatsHistoryFromDisk) {
     stats_count += stats_map.size();
   }
   ASSERT_EQ(slice_count, 3);
-  // 2 extra keys for format version
-  ASSERT_EQ(stats_count, key_count3 - 2);
+  // 2 extra keys for format version and 1 for the schema
+  ASSERT_EQ(slice_count, key_count3 - 3);
+  std::map<std::string, uint64_t> tickers;
+  ASSERT_TRUE(options.statistics->getTickerMap(&tickers));
+  ASSERT_EQ(stats_count, slice_count * tickers.size());
   // verify reopen will not cause data loss
   ReopenWithColumnFamilies({"default", "pikachu"}, options);
   ASSERT_OK(
@@ -462,7 +465,86 @@ TEST_F(StatsHistoryTest, PersitentStatsVerifyValue) {
   Close();
 }
 
-// TODO(Zhongyi): add test for different format versions
+TEST_F(StatsHistoryTest, PersistentStatsRecordFormat) {
+  std::map<std::string, uint64_t> stats = {
+      {"rocksdb.a", 0}, {"rocksdb.b", 7}, {"rocksdb.c", 0},
+      {"rocksdb.d", 0}, {"rocksdb.e", 1ull << 40}};
+  std::string schema;
+  const uint64_t schema_id = EncodePersistentStatsSchema(stats, &schema);
+  std::string record;
+  EncodePersistentStatsRecord(schema_id, stats, &record);
+  // schema id, number of non-zero values, and (zeros skipped, value) pairs
+  ASSERT_EQ(record.size(), 8 + 1 + (1 + 1) + (1 + 6));
+
+  std::map<std::string, uint64_t> other = stats;
+  other["rocksdb.f"] = 1;
+  std::string other_schema;
+  ASSERT_NE(EncodePersistentStatsSchema(other, &other_schema), schema_id);
+}
+
+// Snapshots of format version 1, one key per stat, are still read, and
+// snapshots of format version 2 are read along with them
+TEST_F(StatsHistoryTest, PersistentStatsReadFormatVersion1) {
+  constexpr int kPeriodSec = 5;
+  Options options;
+  options.create_if_missing = true;
+  options.stats_persist_period_sec = kPeriodSec;
+  options.statistics = CreateDBStatistics();
+  options.persist_stats_to_disk = true;
+  options.env = mock_env_.get();
+  ASSERT_OK(TryReopen(options));
+
+  ColumnFamilyHandle* stats_cf = dbfull()->PersistentStatsColumnFamily();
+  for (uint64_t time : {1, 2}) {
+    for (const char* name : {"rocksdb.legacy.a", "rocksdb.legacy.b"}) {
+      char key[100];
+      int length = EncodePersistentStatsKey(time, name, 100, key);
+      ASSERT_OK(db_->Put(WriteOptions(), stats_cf, Slice(key, length),
+                         ToString(time * 10)));
+    }
+  }
+
+  // Wait for the first stats persist to finish, as the initial delay could be
+  // different.
+  dbfull()->TEST_WaitForStatsDumpRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec - 1); });
+  dbfull()->TEST_WaitForStatsDumpRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec); });
+  dbfull()->TEST_WaitForStatsDumpRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec); });
+
+  std::map<std::string, uint64_t> tickers;
+  ASSERT_TRUE(options.statistics->getTickerMap(&tickers));
+  std::vector<uint64_t> times;
+  std::unique_ptr<StatsHistoryIterator> stats_iter;
+  ASSERT_OK(
+      db_->GetStatsHistory(0, mock_clock_->NowSeconds() + 1, &stats_iter));
+  for (; stats_iter->Valid(); stats_iter->Next()) {
+    const uint64_t time = stats_iter->GetStatsTime();
+    times.push_back(time);
+    const auto& stats_map = stats_iter->GetStatsMap();
+    if (time < kPeriodSec) {
+      ASSERT_EQ(stats_map.size(), 2);
+      ASSERT_EQ(stats_map.at("rocksdb.legacy.a"), time * 10);
+      ASSERT_EQ(stats_map.at("rocksdb.legacy.b"), time * 10);
+    } else {
+      ASSERT_EQ(stats_map.size(), tickers.size());
+    }
+  }
+  ASSERT_OK(stats_iter->status());
+  ASSERT_EQ(times, std::vector<uint64_t>({1, 2, 2 * kPeriodSec - 1,
+                                          3 * kPeriodSec - 1}));
+
+  // A time range starting after the old snapshots
+  ASSERT_OK(db_->GetStatsHistory(kPeriodSec, 2 * kPeriodSec, &stats_iter));
+  ASSERT_TRUE(stats_iter->Valid());
+  ASSERT_EQ(stats_iter->GetStatsTime(), 2 * kPeriodSec - 1);
+  stats_iter->Next();
+  ASSERT_FALSE(stats_iter->Valid());
+  ASSERT_OK(stats_iter->status());
+  stats_iter.reset();
+  Close();
+}
 
 TEST_F(StatsHistoryTest, PersistentStatsCreateColumnFamilies) {
   constexpr int kPeriodSec = 5;
@@ -10,11 +10,13 @@
 #include <limits>
 #include <string>
 
+#include "monitoring/statistics.h"
 #include "options/configurable_helper.h"
 #include "options/db_options.h"
 #include "options/options_helper.h"
 #include "options/options_parser.h"
 #include "port/port.h"
+#include "rocksdb/compressor.h"
 #include "rocksdb/concurrent_task_limiter.h"
 #include "rocksdb/configurable.h"
 #include "rocksdb/convenience.h"
@@ -123,6 +125,15 @@ static Status ParseCompressionOptions(const std::string& value,
     compression_opts.max_dict_buffer_bytes = ParseUint64(field);
   }
 
+  // max_dict_reuse_seconds is optional for backwards compatibility
+  if (!field_stream.eof()) {
+    if (!std::getline(field_stream, field, kDelimiter)) {
+      return Status::InvalidArgument(
+          "unable to parse the specified CF option " + name);
+    }
+    compression_opts.max_dict_reuse_seconds = ParseUint64(field);
+  }
+
   if (!field_stream.eof()) {
     return Status::InvalidArgument("unable to parse the specified CF option " +
                                    name);
@@ -163,6 +174,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct CompressionOptions, max_dict_buffer_bytes),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"max_dict_reuse_seconds",
+         {offsetof(struct CompressionOptions, max_dict_reuse_seconds),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo>
@@ -178,6 +193,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct CompactionOptionsFIFO, allow_compaction),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"time_window_seconds",
+         {offsetof(struct CompactionOptionsFIFO, time_window_seconds),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo>
@@ -209,6 +228,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
           OptionTypeFlags::kMutable}},
         {"allow_trivial_move",
          {offsetof(class CompactionOptionsUniversal, allow_trivial_move),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"incremental",
+         {offsetof(class CompactionOptionsUniversal, incremental),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}}};
 
@@ -233,6 +256,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, paranoid_file_checks),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"skip_filters_after_unhelpful_checks",
+         {offsetof(struct MutableCFOptions,
+                   skip_filters_after_unhelpful_checks),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"verify_checksums_in_compaction",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -246,6 +274,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    hard_pending_compaction_bytes_limit),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"pending_compaction_bytes_slowdown_start_ratio",
+         {offsetof(struct MutableCFOptions,
+                   pending_compaction_bytes_slowdown_start_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"hard_rate_limit",
          {0, OptionType::kDouble, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -256,6 +289,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, max_compaction_bytes),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"level_compaction_dynamic_file_size",
+         {offsetof(struct MutableCFOptions,
+                   level_compaction_dynamic_file_size),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"expanded_compaction_factor",
          {0, OptionType::kInt, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -297,10 +335,52 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, max_successive_merges),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"merge_operands_collapse_threshold",
+         {offsetof(struct MutableCFOptions, merge_operands_collapse_threshold),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"use_loser_tree_merging_iterator",
+         {offsetof(struct MutableCFOptions, use_loser_tree_merging_iterator),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"flush_to_lowest_nonoverlapping_level",
+         {offsetof(struct MutableCFOptions,
+                   flush_to_lowest_nonoverlapping_level),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"write_buffer_share_weight",
+         {offsetof(struct MutableCFOptions, write_buffer_share_weight),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"write_buffer_min_share_bytes",
+         {offsetof(struct MutableCFOptions, write_buffer_min_share_bytes),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"max_flush_partitions",
+         {offsetof(struct MutableCFOptions, max_flush_partitions),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"align_flush_partitions_to_base_level",
+         {offsetof(struct MutableCFOptions,
+                   align_flush_partitions_to_base_level),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_huge_page_size",
          {offsetof(struct MutableCFOptions, memtable_huge_page_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"memtable_hot_key_cache_size",
+         {offsetof(struct MutableCFOptions, memtable_hot_key_cache_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"memtable_large_value_threshold",
+         {offsetof(struct MutableCFOptions, memtable_large_value_threshold),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"max_adaptive_write_buffer_size",
+         {offsetof(struct MutableCFOptions, max_adaptive_write_buffer_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_prefix_bloom_huge_page_tlb_size",
          {0, OptionType::kSizeT, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -410,6 +490,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, blob_compression_type),
           OptionType::kCompressionType, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"blob_compression_max_dict_bytes",
+         {offsetof(struct MutableCFOptions, blob_compression_max_dict_bytes),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"blob_compression_parallel_threads",
+         {offsetof(struct MutableCFOptions, blob_compression_parallel_threads),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"enable_blob_garbage_collection",
          {offsetof(struct MutableCFOptions, enable_blob_garbage_collection),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -418,10 +506,23 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, blob_garbage_collection_age_cutoff),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"blob_garbage_collection_force_threshold",
+         {offsetof(struct MutableCFOptions,
+                   blob_garbage_collection_force_threshold),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"cold_blob_file_size",
+         {offsetof(struct MutableCFOptions, cold_blob_file_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"sample_for_compression",
          {offsetof(struct MutableCFOptions, sample_for_compression),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"bottommost_hot_file_read_rate",
+         {offsetof(struct MutableCFOptions, bottommost_hot_file_read_rate),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"bottommost_compression",
          {offsetof(struct MutableCFOptions, bottommost_compression),
           OptionType::kCompressionType, OptionVerificationType::kNormal,
@@ -501,6 +602,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offset_of(&ImmutableCFOptions::force_consistency_checks),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"use_direct_reads_for_blob_files",
+         {offset_of(&ImmutableCFOptions::use_direct_reads_for_blob_files),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"compressor", OptionTypeInfo::AsCustomSharedPtr<Compressor>(
+                           offset_of(&ImmutableCFOptions::compressor),
+                           OptionVerificationType::kByNameAllowNull,
+                           OptionTypeFlags::kAllowNull)},
         {"purge_redundant_kvs_while_flush",
          {offset_of(&ImmutableCFOptions::purge_redundant_kvs_while_flush),
           OptionType::kBoolean, OptionVerificationType::kDeprecated,
@@ -829,7 +938,12 @@ ImmutableCFOptions::ImmutableCFOptions(const ColumnFamilyOptions& cf_options)
           cf_options.memtable_insert_with_hint_prefix_extractor),
       cf_paths(cf_options.cf_paths),
       compaction_thread_limiter(cf_options.compaction_thread_limiter),
-      sst_partitioner_factory(cf_options.sst_partitioner_factory) {}
+      sst_partitioner_factory(cf_options.sst_partitioner_factory),
+      blob_cache(cf_options.blob_cache),
+      compressor(cf_options.compressor),
+      cf_statistics(cf_options.cf_statistics),
+      use_direct_reads_for_blob_files(
+          cf_options.use_direct_reads_for_blob_files) {}
 
 ImmutableOptions::ImmutableOptions() : ImmutableOptions(Options()) {}
 
@@ -838,19 +952,39 @@ ImmutableOptions::ImmutableOptions(const Options& options)
 
 ImmutableOptions::ImmutableOptions(const DBOptions& db_options,
                                    const ColumnFamilyOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  InitStats();
+}
 
 ImmutableOptions::ImmutableOptions(const DBOptions& db_options,
                                    const ImmutableCFOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  InitStats();
+}
 
 ImmutableOptions::ImmutableOptions(const ImmutableDBOptions& db_options,
                                    const ColumnFamilyOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  InitStats();
+}
 
 ImmutableOptions::ImmutableOptions(const ImmutableDBOptions& db_options,
                                    const ImmutableCFOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  InitStats();
+}
+
+void ImmutableOptions::InitStats() {
+  if (cf_statistics == nullptr) {
+    return;
+  }
+  if (statistics == nullptr) {
+    stats = cf_statistics.get();
+  } else if (statistics != cf_statistics) {
+    tee_stats_ = std::make_shared<TeeStatistics>(statistics, cf_statistics);
+    stats = tee_stats_.get();
+  }
+}
 
 // Multiple two operands. If they overflow, return op1.
 uint64_t MultiplyCheckOverflow(uint64_t op1, double op2) {
@@ -924,9 +1058,34 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(log,
                  "                  memtable_huge_page_size: %" ROCKSDB_PRIszt,
                  memtable_huge_page_size);
+  ROCKS_LOG_INFO(log,
+                 "              memtable_hot_key_cache_size: %" ROCKSDB_PRIszt,
+                 memtable_hot_key_cache_size);
+  ROCKS_LOG_INFO(log,
+                 "           memtable_large_value_threshold: %" ROCKSDB_PRIszt,
+                 memtable_large_value_threshold);
+  ROCKS_LOG_INFO(log,
+                 "           max_adaptive_write_buffer_size: %" ROCKSDB_PRIszt,
+                 max_adaptive_write_buffer_size);
   ROCKS_LOG_INFO(log,
                  "                    max_successive_merges: %" ROCKSDB_PRIszt,
                  max_successive_merges);
+  ROCKS_LOG_INFO(log,
+                 "        merge_operands_collapse_threshold: %" ROCKSDB_PRIszt,
+                 merge_operands_collapse_threshold);
+  ROCKS_LOG_INFO(log, "          use_loser_tree_merging_iterator: %d",
+                 use_loser_tree_merging_iterator);
+  ROCKS_LOG_INFO(log, "     flush_to_lowest_nonoverlapping_level: %d",
+                 flush_to_lowest_nonoverlapping_level);
+  ROCKS_LOG_INFO(log, "                write_buffer_share_weight: %f",
+                 write_buffer_share_weight);
+  ROCKS_LOG_INFO(log,
+                 "             write_buffer_min_share_bytes: %" ROCKSDB_PRIszt,
+                 write_buffer_min_share_bytes);
+  ROCKS_LOG_INFO(log, "                     max_flush_partitions: %" PRIu32,
+                 max_flush_partitions);
+  ROCKS_LOG_INFO(log, "     align_flush_partitions_to_base_level: %d",
+                 align_flush_partitions_to_base_level);
   ROCKS_LOG_INFO(log,
                  "                 inplace_update_num_locks: %" ROCKSDB_PRIszt,
                  inplace_update_num_locks);
@@ -939,6 +1098,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  soft_pending_compaction_bytes_limit);
   ROCKS_LOG_INFO(log, "      hard_pending_compaction_bytes_limit: %" PRIu64,
                  hard_pending_compaction_bytes_limit);
+  ROCKS_LOG_INFO(log, "pending_compaction_bytes_slowdown_start_ratio: %f",
+                 pending_compaction_bytes_slowdown_start_ratio);
   ROCKS_LOG_INFO(log, "       level0_file_num_compaction_trigger: %d",
                  level0_file_num_compaction_trigger);
   ROCKS_LOG_INFO(log, "           level0_slowdown_writes_trigger: %d",
@@ -947,6 +1108,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  level0_stop_writes_trigger);
   ROCKS_LOG_INFO(log, "                     max_compaction_bytes: %" PRIu64,
                  max_compaction_bytes);
+  ROCKS_LOG_INFO(log, "       level_compaction_dynamic_file_size: %d",
+                 level_compaction_dynamic_file_size);
   ROCKS_LOG_INFO(log, "                    target_file_size_base: %" PRIu64,
                  target_file_size_base);
   ROCKS_LOG_INFO(log, "              target_file_size_multiplier: %d",
@@ -959,6 +1122,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  ttl);
   ROCKS_LOG_INFO(log, "              periodic_compaction_seconds: %" PRIu64,
                  periodic_compaction_seconds);
+  ROCKS_LOG_INFO(log, "            bottommost_hot_file_read_rate: %" PRIu64,
+                 bottommost_hot_file_read_rate);
   std::string result;
   char buf[10];
   for (const auto m : max_bytes_for_level_multiplier_additional) {
@@ -981,6 +1146,9 @@ void MutableCFOptions::Dump(Logger* log) const {
                  paranoid_file_checks);
   ROCKS_LOG_INFO(log, "                       report_bg_io_stats: %d",
                  report_bg_io_stats);
+  ROCKS_LOG_INFO(log,
+                 "      skip_filters_after_unhelpful_checks: %" PRIu64,
+                 skip_filters_after_unhelpful_checks);
   ROCKS_LOG_INFO(log, "                              compression: %d",
                  static_cast<int>(compression));
 
@@ -1002,12 +1170,17 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(
       log, "compaction_options_universal.allow_trivial_move : %d",
       static_cast<int>(compaction_options_universal.allow_trivial_move));
+  ROCKS_LOG_INFO(log, "compaction_options_universal.incremental : %d",
+                 static_cast<int>(compaction_options_universal.incremental));
 
   // FIFO Compaction Options
   ROCKS_LOG_INFO(log, "compaction_options_fifo.max_table_files_size : %" PRIu64,
                  compaction_options_fifo.max_table_files_size);
   ROCKS_LOG_INFO(log, "compaction_options_fifo.allow_compaction : %d",
                  compaction_options_fifo.allow_compaction);
+  ROCKS_LOG_INFO(log,
+                 "compaction_options_fifo.time_window_seconds : %" PRIu64,
+                 compaction_options_fifo.time_window_seconds);
 
   // Blob file related options
   ROCKS_LOG_INFO(log, "                        enable_blob_files: %s",
@@ -1018,10 +1191,18 @@ void MutableCFOptions::Dump(Logger* log) const {
                  blob_file_size);
   ROCKS_LOG_INFO(log, "                    blob_compression_type: %s",
                  CompressionTypeToString(blob_compression_type).c_str());
+  ROCKS_LOG_INFO(log, "          blob_compression_max_dict_bytes: %" PRIu32,
+                 blob_compression_max_dict_bytes);
+  ROCKS_LOG_INFO(log, "        blob_compression_parallel_threads: %" PRIu32,
+                 blob_compression_parallel_threads);
   ROCKS_LOG_INFO(log, "           enable_blob_garbage_collection: %s",
                  enable_blob_garbage_collection ? "true" : "false");
   ROCKS_LOG_INFO(log, "       blob_garbage_collection_age_cutoff: %f",
                  blob_garbage_collection_age_cutoff);
+  ROCKS_LOG_INFO(log, "  blob_garbage_collection_force_threshold: %f",
+                 blob_garbage_collection_force_threshold);
+  ROCKS_LOG_INFO(log, "                      cold_blob_file_size: %" PRIu64,
+                 cold_blob_file_size);
 }
 
 MutableCFOptions::MutableCFOptions(const Options& options)
@@ -82,6 +82,14 @@ struct ImmutableCFOptions {
   std::shared_ptr<ConcurrentTaskLimiter> compaction_thread_limiter;
 
   std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory;
+
+  std::shared_ptr<Cache> blob_cache;
+
+  std::shared_ptr<Compressor> compressor;
+
+  std::shared_ptr<Statistics> cf_statistics;
+
+  bool use_direct_reads_for_blob_files;
 };
 
 struct ImmutableOptions : public ImmutableDBOptions, public ImmutableCFOptions {
@@ -99,6 +107,13 @@ struct ImmutableOptions : public ImmutableDBOptions, public ImmutableCFOptions {
 
   ImmutableOptions(const ImmutableDBOptions& db_options,
                    const ColumnFamilyOptions& cf_options);
+
+ private:
+  // Points `stats` at the column family's statistics as well
+  void InitStats();
+
+  // Records into both statistics when both are set
+  std::shared_ptr<Statistics> tee_stats_;
 };
 
 struct MutableCFOptions {
@@ -111,7 +126,21 @@ struct MutableCFOptions {
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
         memtable_huge_page_size(options.memtable_huge_page_size),
+        memtable_hot_key_cache_size(options.memtable_hot_key_cache_size),
+        memtable_large_value_threshold(options.memtable_large_value_threshold),
+        max_adaptive_write_buffer_size(options.max_adaptive_write_buffer_size),
         max_successive_merges(options.max_successive_merges),
+        merge_operands_collapse_threshold(
+            options.merge_operands_collapse_threshold),
+        use_loser_tree_merging_iterator(
+            options.use_loser_tree_merging_iterator),
+        flush_to_lowest_nonoverlapping_level(
+            options.flush_to_lowest_nonoverlapping_level),
+        write_buffer_share_weight(options.write_buffer_share_weight),
+        write_buffer_min_share_bytes(options.write_buffer_min_share_bytes),
+        max_flush_partitions(options.max_flush_partitions),
+        align_flush_partitions_to_base_level(
+            options.align_flush_partitions_to_base_level),
         inplace_update_num_locks(options.inplace_update_num_locks),
         prefix_extractor(options.prefix_extractor),
         disable_auto_compactions(options.disable_auto_compactions),
@@ -119,11 +148,15 @@ struct MutableCFOptions {
             options.soft_pending_compaction_bytes_limit),
         hard_pending_compaction_bytes_limit(
             options.hard_pending_compaction_bytes_limit),
+        pending_compaction_bytes_slowdown_start_ratio(
+            options.pending_compaction_bytes_slowdown_start_ratio),
         level0_file_num_compaction_trigger(
             options.level0_file_num_compaction_trigger),
         level0_slowdown_writes_trigger(options.level0_slowdown_writes_trigger),
         level0_stop_writes_trigger(options.level0_stop_writes_trigger),
         max_compaction_bytes(options.max_compaction_bytes),
+        level_compaction_dynamic_file_size(
+            options.level_compaction_dynamic_file_size),
         target_file_size_base(options.target_file_size_base),
         target_file_size_multiplier(options.target_file_size_multiplier),
         max_bytes_for_level_base(options.max_bytes_for_level_base),
@@ -138,20 +171,31 @@ struct MutableCFOptions {
         min_blob_size(options.min_blob_size),
         blob_file_size(options.blob_file_size),
         blob_compression_type(options.blob_compression_type),
+        blob_compression_max_dict_bytes(
+            options.blob_compression_max_dict_bytes),
+        blob_compression_parallel_threads(
+            options.blob_compression_parallel_threads),
         enable_blob_garbage_collection(options.enable_blob_garbage_collection),
         blob_garbage_collection_age_cutoff(
             options.blob_garbage_collection_age_cutoff),
+        blob_garbage_collection_force_threshold(
+            options.blob_garbage_collection_force_threshold),
+        cold_blob_file_size(options.cold_blob_file_size),
+        cold_blob_file_temperature(options.cold_blob_file_temperature),
         max_sequential_skip_in_iterations(
             options.max_sequential_skip_in_iterations),
         check_flush_compaction_key_order(
             options.check_flush_compaction_key_order),
         paranoid_file_checks(options.paranoid_file_checks),
         report_bg_io_stats(options.report_bg_io_stats),
+        skip_filters_after_unhelpful_checks(
+            options.skip_filters_after_unhelpful_checks),
         compression(options.compression),
         bottommost_compression(options.bottommost_compression),
         compression_opts(options.compression_opts),
         bottommost_compression_opts(options.bottommost_compression_opts),
         bottommost_temperature(options.bottommost_temperature),
+        bottommost_hot_file_read_rate(options.bottommost_hot_file_read_rate),
         sample_for_compression(
             options.sample_for_compression) {  // TODO: is 0 fine here?
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
@@ -164,16 +208,28 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
         memtable_huge_page_size(0),
+        memtable_hot_key_cache_size(0),
+        memtable_large_value_threshold(0),
+        max_adaptive_write_buffer_size(0),
         max_successive_merges(0),
+        merge_operands_collapse_threshold(0),
+        use_loser_tree_merging_iterator(false),
+        flush_to_lowest_nonoverlapping_level(false),
+        write_buffer_share_weight(1.0),
+        write_buffer_min_share_bytes(0),
+        max_flush_partitions(1),
+        align_flush_partitions_to_base_level(false),
         inplace_update_num_locks(0),
         prefix_extractor(nullptr),
         disable_auto_compactions(false),
         soft_pending_compaction_bytes_limit(0),
         hard_pending_compaction_bytes_limit(0),
+        pending_compaction_bytes_slowdown_start_ratio(0.0),
         level0_file_num_compaction_trigger(0),
         level0_slowdown_writes_trigger(0),
         level0_stop_writes_trigger(0),
         max_compaction_bytes(0),
+        level_compaction_dynamic_file_size(false),
         target_file_size_base(0),
         target_file_size_multiplier(0),
         max_bytes_for_level_base(0),
@@ -185,15 +241,22 @@ struct MutableCFOptions {
         min_blob_size(0),
         blob_file_size(0),
         blob_compression_type(kNoCompression),
+        blob_compression_max_dict_bytes(0),
+        blob_compression_parallel_threads(1),
         enable_blob_garbage_collection(false),
         blob_garbage_collection_age_cutoff(0.0),
+        blob_garbage_collection_force_threshold(0.0),
+        cold_blob_file_size(0),
+        cold_blob_file_temperature(Temperature::kUnknown),
         max_sequential_skip_in_iterations(0),
         check_flush_compaction_key_order(true),
         paranoid_file_checks(false),
         report_bg_io_stats(false),
+        skip_filters_after_unhelpful_checks(0),
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
         bottommost_compression(kDisableCompressionOption),
         bottommost_temperature(Temperature::kUnknown),
+        bottommost_hot_file_read_rate(0),
         sample_for_compression(0) {}
 
   explicit MutableCFOptions(const Options& options);
@@ -222,7 +285,17 @@ struct MutableCFOptions {
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
   size_t memtable_huge_page_size;
+  size_t memtable_hot_key_cache_size;
+  size_t memtable_large_value_threshold;
+  size_t max_adaptive_write_buffer_size;
   size_t max_successive_merges;
+  size_t merge_operands_collapse_threshold;
+  bool use_loser_tree_merging_iterator;
+  bool flush_to_lowest_nonoverlapping_level;
+  double write_buffer_share_weight;
+  size_t write_buffer_min_share_bytes;
+  uint32_t max_flush_partitions;
+  bool align_flush_partitions_to_base_level;
   size_t inplace_update_num_locks;
   std::shared_ptr<const SliceTransform> prefix_extractor;
 
@@ -230,10 +303,12 @@ struct MutableCFOptions {
   bool disable_auto_compactions;
   uint64_t soft_pending_compaction_bytes_limit;
   uint64_t hard_pending_compaction_bytes_limit;
+  double pending_compaction_bytes_slowdown_start_ratio;
   int level0_file_num_compaction_trigger;
   int level0_slowdown_writes_trigger;
   int level0_stop_writes_trigger;
   uint64_t max_compaction_bytes;
+  bool level_compaction_dynamic_file_size;
   uint64_t target_file_size_base;
   int target_file_size_multiplier;
   uint64_t max_bytes_for_level_base;
@@ -249,14 +324,22 @@ struct MutableCFOptions {
   uint64_t min_blob_size;
   uint64_t blob_file_size;
   CompressionType blob_compression_type;
+  uint32_t blob_compression_max_dict_bytes;
+  uint32_t blob_compression_parallel_threads;
   bool enable_blob_garbage_collection;
   double blob_garbage_collection_age_cutoff;
+  double blob_garbage_collection_force_threshold;
+  uint64_t cold_blob_file_size;
+  // TODO this experimental option isn't made configurable
+  // through strings yet.
+  Temperature cold_blob_file_temperature;
 
   // Misc options
   uint64_t max_sequential_skip_in_iterations;
   bool check_flush_compaction_key_order;
   bool paranoid_file_checks;
   bool report_bg_io_stats;
+  uint64_t skip_filters_after_unhelpful_checks;
   CompressionType compression;
   CompressionType bottommost_compression;
   CompressionOptions compression_opts;
@@ -264,6 +347,7 @@ struct MutableCFOptions {
   // TODO this experimental option isn't made configurable
   // through strings yet.
   Temperature bottommost_temperature;
+  uint64_t bottommost_hot_file_read_rate;
 
   uint64_t sample_for_compression;
 
@@ -126,6 +126,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableDBOptions, compaction_readahead_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"max_compaction_readahead_size",
+         {offsetof(struct MutableDBOptions, max_compaction_readahead_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"max_background_flushes",
          {offsetof(struct MutableDBOptions, max_background_flushes),
           OptionType::kInt, OptionVerificationType::kNormal,
@@ -172,6 +176,19 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    use_direct_io_for_flush_and_compaction),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"use_async_writes_for_flush_and_compaction",
+         {offsetof(struct ImmutableDBOptions,
+                   use_async_writes_for_flush_and_compaction),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"use_direct_io_for_wal",
+         {offsetof(struct ImmutableDBOptions, use_direct_io_for_wal),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"use_pmem_for_wal",
+         {offsetof(struct ImmutableDBOptions, use_pmem_for_wal),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_2pc",
          {offsetof(struct ImmutableDBOptions, allow_2pc), OptionType::kBoolean,
           OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
@@ -254,6 +271,19 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, max_file_opening_threads),
           OptionType::kInt, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"open_table_files_in_background",
+         {offsetof(struct ImmutableDBOptions, open_table_files_in_background),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"max_file_verification_threads",
+         {offsetof(struct ImmutableDBOptions, max_file_verification_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"secondary_catch_up_period_micros",
+         {offsetof(struct ImmutableDBOptions,
+                   secondary_catch_up_period_micros),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"table_cache_numshardbits",
          {offsetof(struct ImmutableDBOptions, table_cache_numshardbits),
           OptionType::kInt, OptionVerificationType::kNormal,
@@ -266,6 +296,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, keep_log_file_num),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"async_info_log",
+         {offsetof(struct ImmutableDBOptions, async_info_log),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"recycle_log_file_num",
          {offsetof(struct ImmutableDBOptions, recycle_log_file_num),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -300,10 +334,22 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, max_manifest_file_size),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"max_manifest_space_amp_pct",
+         {offsetof(struct ImmutableDBOptions, max_manifest_space_amp_pct),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"persist_stats_to_disk",
          {offsetof(struct ImmutableDBOptions, persist_stats_to_disk),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"auto_tune_period_sec",
+         {offsetof(struct ImmutableDBOptions, auto_tune_period_sec),
+          OptionType::kUInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"auto_tune_write_p99_micros",
+         {offsetof(struct ImmutableDBOptions, auto_tune_write_p99_micros),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"fail_if_options_file_error",
          {offsetof(struct ImmutableDBOptions, fail_if_options_file_error),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -316,6 +362,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, unordered_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"enable_no_wal_write_fast_path",
+         {offsetof(struct ImmutableDBOptions, enable_no_wal_write_fast_path),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_concurrent_memtable_write",
          {offsetof(struct ImmutableDBOptions, allow_concurrent_memtable_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -324,6 +374,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          OptionTypeInfo::Enum<WALRecoveryMode>(
              offsetof(struct ImmutableDBOptions, wal_recovery_mode),
              &wal_recovery_mode_string_map)},
+        {"wal_recovery_threads",
+         {offsetof(struct ImmutableDBOptions, wal_recovery_threads),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"enable_write_thread_adaptive_yield",
          {offsetof(struct ImmutableDBOptions,
                    enable_write_thread_adaptive_yield),
@@ -333,6 +387,31 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, write_thread_slow_yield_usec),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"write_thread_spinners_per_core",
+         {offsetof(struct ImmutableDBOptions, write_thread_spinners_per_core),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"pipelined_compaction_io",
+         {offsetof(struct ImmutableDBOptions, pipelined_compaction_io),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"compaction_copy_unchanged_blocks",
+         {offsetof(struct ImmutableDBOptions,
+                   compaction_copy_unchanged_blocks),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"compaction_service_timeout_ms",
+         {offsetof(struct ImmutableDBOptions, compaction_service_timeout_ms),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"perf_context_sample_one_in",
+         {offsetof(struct ImmutableDBOptions, perf_context_sample_one_in),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"memtable_batch_sort_threshold",
+         {offsetof(struct ImmutableDBOptions, memtable_batch_sort_threshold),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"max_write_batch_group_size_bytes",
          {offsetof(struct ImmutableDBOptions, max_write_batch_group_size_bytes),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -377,6 +456,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, manual_wal_flush),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wal_compression",
+         {offsetof(struct ImmutableDBOptions, wal_compression),
+          OptionType::kCompressionType, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"seq_per_batch",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kNone}},
@@ -388,6 +471,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, avoid_unnecessary_blocking_io),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"prioritize_stall_relieving_work",
+         {offsetof(struct ImmutableDBOptions, prioritize_stall_relieving_work),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"write_dbid_to_manifest",
          {offsetof(struct ImmutableDBOptions, write_dbid_to_manifest),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -591,6 +678,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       info_log(options.info_log),
       info_log_level(options.info_log_level),
       max_file_opening_threads(options.max_file_opening_threads),
+      open_table_files_in_background(options.open_table_files_in_background),
+      max_file_verification_threads(options.max_file_verification_threads),
+      secondary_catch_up_period_micros(
+          options.secondary_catch_up_period_micros),
       statistics(options.statistics),
       use_fsync(options.use_fsync),
       db_paths(options.db_paths),
@@ -599,8 +690,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       max_log_file_size(options.max_log_file_size),
       log_file_time_to_roll(options.log_file_time_to_roll),
       keep_log_file_num(options.keep_log_file_num),
+      async_info_log(options.async_info_log),
       recycle_log_file_num(options.recycle_log_file_num),
       max_manifest_file_size(options.max_manifest_file_size),
+      max_manifest_space_amp_pct(options.max_manifest_space_amp_pct),
       table_cache_numshardbits(options.table_cache_numshardbits),
       WAL_ttl_seconds(options.WAL_ttl_seconds),
       WAL_size_limit_MB(options.WAL_size_limit_MB),
@@ -612,6 +705,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       use_direct_reads(options.use_direct_reads),
       use_direct_io_for_flush_and_compaction(
           options.use_direct_io_for_flush_and_compaction),
+      use_async_writes_for_flush_and_compaction(
+          options.use_async_writes_for_flush_and_compaction),
+      use_direct_io_for_wal(options.use_direct_io_for_wal),
+      use_pmem_for_wal(options.use_pmem_for_wal),
       allow_fallocate(options.allow_fallocate),
       is_fd_close_on_exec(options.is_fd_close_on_exec),
       advise_random_on_open(options.advise_random_on_open),
@@ -628,15 +725,24 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       enable_thread_tracking(options.enable_thread_tracking),
       enable_pipelined_write(options.enable_pipelined_write),
       unordered_write(options.unordered_write),
+      enable_no_wal_write_fast_path(options.enable_no_wal_write_fast_path),
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
       enable_write_thread_adaptive_yield(
           options.enable_write_thread_adaptive_yield),
       write_thread_max_yield_usec(options.write_thread_max_yield_usec),
       write_thread_slow_yield_usec(options.write_thread_slow_yield_usec),
+      write_thread_spinners_per_core(options.write_thread_spinners_per_core),
+      memtable_batch_sort_threshold(options.memtable_batch_sort_threshold),
+      pipelined_compaction_io(options.pipelined_compaction_io),
+      compaction_copy_unchanged_blocks(
+          options.compaction_copy_unchanged_blocks),
+      compaction_service_timeout_ms(options.compaction_service_timeout_ms),
+      perf_context_sample_one_in(options.perf_context_sample_one_in),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       skip_checking_sst_file_sizes_on_db_open(
           options.skip_checking_sst_file_sizes_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
+      wal_recovery_threads(options.wal_recovery_threads),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
 #ifndef ROCKSDB_LITE
@@ -649,9 +755,13 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       preserve_deletes(options.preserve_deletes),
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
+      wal_compression(options.wal_compression),
       atomic_flush(options.atomic_flush),
       avoid_unnecessary_blocking_io(options.avoid_unnecessary_blocking_io),
+      prioritize_stall_relieving_work(options.prioritize_stall_relieving_work),
       persist_stats_to_disk(options.persist_stats_to_disk),
+      auto_tune_period_sec(options.auto_tune_period_sec),
+      auto_tune_write_p99_micros(options.auto_tune_write_p99_micros),
       write_dbid_to_manifest(options.write_dbid_to_manifest),
       log_readahead_size(options.log_readahead_size),
       file_checksum_gen_factory(options.file_checksum_gen_factory),
@@ -694,6 +804,13 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    info_log.get());
   ROCKS_LOG_HEADER(log, "               Options.max_file_opening_threads: %d",
                    max_file_opening_threads);
+  ROCKS_LOG_HEADER(log, "         Options.open_table_files_in_background: %d",
+                   open_table_files_in_background);
+  ROCKS_LOG_HEADER(log, "          Options.max_file_verification_threads: %d",
+                   max_file_verification_threads);
+  ROCKS_LOG_HEADER(log,
+                   "       Options.secondary_catch_up_period_micros: %" PRIu64,
+                   secondary_catch_up_period_micros);
   ROCKS_LOG_HEADER(log, "                             Options.statistics: %p",
                    stats);
   ROCKS_LOG_HEADER(log, "                              Options.use_fsync: %d",
@@ -704,12 +821,17 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "                 Options.max_manifest_file_size: %" PRIu64,
                    max_manifest_file_size);
+  ROCKS_LOG_HEADER(log,
+                   "             Options.max_manifest_space_amp_pct: %" PRIu32,
+                   max_manifest_space_amp_pct);
   ROCKS_LOG_HEADER(
       log, "                  Options.log_file_time_to_roll: %" ROCKSDB_PRIszt,
       log_file_time_to_roll);
   ROCKS_LOG_HEADER(
       log, "                      Options.keep_log_file_num: %" ROCKSDB_PRIszt,
       keep_log_file_num);
+  ROCKS_LOG_HEADER(log, "                         Options.async_info_log: %d",
+                   async_info_log);
   ROCKS_LOG_HEADER(
       log, "                   Options.recycle_log_file_num: %" ROCKSDB_PRIszt,
       recycle_log_file_num);
@@ -725,6 +847,14 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    "                       "
                    "Options.use_direct_io_for_flush_and_compaction: %d",
                    use_direct_io_for_flush_and_compaction);
+  ROCKS_LOG_HEADER(log,
+                   "                    "
+                   "Options.use_async_writes_for_flush_and_compaction: %d",
+                   use_async_writes_for_flush_and_compaction);
+  ROCKS_LOG_HEADER(log, "                  Options.use_direct_io_for_wal: %d",
+                   use_direct_io_for_wal);
+  ROCKS_LOG_HEADER(log, "                       Options.use_pmem_for_wal: %d",
+                   use_pmem_for_wal);
   ROCKS_LOG_HEADER(log, "         Options.create_missing_column_families: %d",
                    create_missing_column_families);
   ROCKS_LOG_HEADER(log, "                             Options.db_log_dir: %s",
@@ -777,12 +907,17 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       sst_file_manager ? sst_file_manager->GetDeleteRateBytesPerSecond() : 0);
   ROCKS_LOG_HEADER(log, "                      Options.wal_recovery_mode: %d",
                    static_cast<int>(wal_recovery_mode));
+  ROCKS_LOG_HEADER(log,
+                   "                   Options.wal_recovery_threads: %" PRIu32,
+                   wal_recovery_threads);
   ROCKS_LOG_HEADER(log, "                 Options.enable_thread_tracking: %d",
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
                    enable_pipelined_write);
   ROCKS_LOG_HEADER(log, "                 Options.unordered_write: %d",
                    unordered_write);
+  ROCKS_LOG_HEADER(log, "  Options.enable_no_wal_write_fast_path: %d",
+                   enable_no_wal_write_fast_path);
   ROCKS_LOG_HEADER(log, "        Options.allow_concurrent_memtable_write: %d",
                    allow_concurrent_memtable_write);
   ROCKS_LOG_HEADER(log, "     Options.enable_write_thread_adaptive_yield: %d",
@@ -793,6 +928,22 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "           Options.write_thread_slow_yield_usec: %" PRIu64,
                    write_thread_slow_yield_usec);
+  ROCKS_LOG_HEADER(log,
+                   "         Options.write_thread_spinners_per_core: %" PRIu32,
+                   write_thread_spinners_per_core);
+  ROCKS_LOG_HEADER(
+      log, "          Options.memtable_batch_sort_threshold: %" ROCKSDB_PRIszt,
+      memtable_batch_sort_threshold);
+  ROCKS_LOG_HEADER(log, "              Options.pipelined_compaction_io: %d",
+                   pipelined_compaction_io);
+  ROCKS_LOG_HEADER(log, "     Options.compaction_copy_unchanged_blocks: %d",
+                   compaction_copy_unchanged_blocks);
+  ROCKS_LOG_HEADER(log,
+                   "        Options.compaction_service_timeout_ms: %" PRIu64,
+                   compaction_service_timeout_ms);
+  ROCKS_LOG_HEADER(log,
+                   "           Options.perf_context_sample_one_in: %" PRIu32,
+                   perf_context_sample_one_in);
   if (row_cache) {
     ROCKS_LOG_HEADER(
         log,
@@ -817,12 +968,22 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    two_write_queues);
   ROCKS_LOG_HEADER(log, "            Options.manual_wal_flush: %d",
                    manual_wal_flush);
+  ROCKS_LOG_HEADER(log, "             Options.wal_compression: %d",
+                   static_cast<int>(wal_compression));
   ROCKS_LOG_HEADER(log, "            Options.atomic_flush: %d", atomic_flush);
   ROCKS_LOG_HEADER(log,
                    "            Options.avoid_unnecessary_blocking_io: %d",
                    avoid_unnecessary_blocking_io);
+  ROCKS_LOG_HEADER(log,
+                   "          Options.prioritize_stall_relieving_work: %d",
+                   prioritize_stall_relieving_work);
   ROCKS_LOG_HEADER(log, "                Options.persist_stats_to_disk: %u",
                    persist_stats_to_disk);
+  ROCKS_LOG_HEADER(log, "                 Options.auto_tune_period_sec: %u",
+                   auto_tune_period_sec);
+  ROCKS_LOG_HEADER(log,
+                   "           Options.auto_tune_write_p99_micros: %" PRIu64,
+                   auto_tune_write_p99_micros);
   ROCKS_LOG_HEADER(log, "                Options.write_dbid_to_manifest: %d",
                    write_dbid_to_manifest);
   ROCKS_LOG_HEADER(
@@ -897,6 +1058,7 @@ MutableDBOptions::MutableDBOptions()
       wal_bytes_per_sync(0),
       strict_bytes_per_sync(false),
       compaction_readahead_size(0),
+      max_compaction_readahead_size(0),
       max_background_flushes(-1) {}
 
 MutableDBOptions::MutableDBOptions(const DBOptions& options)
@@ -918,6 +1080,7 @@ MutableDBOptions::MutableDBOptions(const DBOptions& options)
       wal_bytes_per_sync(options.wal_bytes_per_sync),
       strict_bytes_per_sync(options.strict_bytes_per_sync),
       compaction_readahead_size(options.compaction_readahead_size),
+      max_compaction_readahead_size(options.max_compaction_readahead_size),
       max_background_flushes(options.max_background_flushes) {}
 
 void MutableDBOptions::Dump(Logger* log) const {
@@ -961,6 +1124,9 @@ void MutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "      Options.compaction_readahead_size: %" ROCKSDB_PRIszt,
                    compaction_readahead_size);
+  ROCKS_LOG_HEADER(
+      log, "  Options.max_compaction_readahead_size: %" ROCKSDB_PRIszt,
+      max_compaction_readahead_size);
   ROCKS_LOG_HEADER(log, "                 Options.max_background_flushes: %d",
                           max_background_flushes);
 }
@@ -32,6 +32,9 @@ struct ImmutableDBOptions {
   std::shared_ptr<Logger> info_log;
   InfoLogLevel info_log_level;
   int max_file_opening_threads;
+  bool open_table_files_in_background;
+  int max_file_verification_threads;
+  uint64_t secondary_catch_up_period_micros;
   std::shared_ptr<Statistics> statistics;
   bool use_fsync;
   std::vector<DbPath> db_paths;
@@ -43,8 +46,10 @@ struct ImmutableDBOptions {
   size_t max_log_file_size;
   size_t log_file_time_to_roll;
   size_t keep_log_file_num;
+  bool async_info_log;
   size_t recycle_log_file_num;
   uint64_t max_manifest_file_size;
+  uint32_t max_manifest_space_amp_pct;
   int table_cache_numshardbits;
   uint64_t WAL_ttl_seconds;
   uint64_t WAL_size_limit_MB;
@@ -54,6 +59,9 @@ struct ImmutableDBOptions {
   bool allow_mmap_writes;
   bool use_direct_reads;
   bool use_direct_io_for_flush_and_compaction;
+  bool use_async_writes_for_flush_and_compaction;
+  bool use_direct_io_for_wal;
+  bool use_pmem_for_wal;
   bool allow_fallocate;
   bool is_fd_close_on_exec;
   bool advise_random_on_open;
@@ -69,13 +77,21 @@ struct ImmutableDBOptions {
   bool enable_thread_tracking;
   bool enable_pipelined_write;
   bool unordered_write;
+  bool enable_no_wal_write_fast_path;
   bool allow_concurrent_memtable_write;
   bool enable_write_thread_adaptive_yield;
   uint64_t write_thread_max_yield_usec;
   uint64_t write_thread_slow_yield_usec;
+  uint32_t write_thread_spinners_per_core;
+  size_t memtable_batch_sort_threshold;
+  bool pipelined_compaction_io;
+  bool compaction_copy_unchanged_blocks;
+  uint64_t compaction_service_timeout_ms;
+  uint32_t perf_context_sample_one_in;
   bool skip_stats_update_on_db_open;
   bool skip_checking_sst_file_sizes_on_db_open;
   WALRecoveryMode wal_recovery_mode;
+  uint32_t wal_recovery_threads;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
 #ifndef ROCKSDB_LITE
@@ -88,9 +104,13 @@ struct ImmutableDBOptions {
   bool preserve_deletes;
   bool two_write_queues;
   bool manual_wal_flush;
+  CompressionType wal_compression;
   bool atomic_flush;
   bool avoid_unnecessary_blocking_io;
+  bool prioritize_stall_relieving_work;
   bool persist_stats_to_disk;
+  unsigned int auto_tune_period_sec;
+  uint64_t auto_tune_write_p99_micros;
   bool write_dbid_to_manifest;
   size_t log_readahead_size;
   std::shared_ptr<FileChecksumGenFactory> file_checksum_gen_factory;
@@ -138,6 +158,7 @@ struct MutableDBOptions {
   uint64_t wal_bytes_per_sync;
   bool strict_bytes_per_sync;
   size_t compaction_readahead_size;
+  size_t max_compaction_readahead_size;
   int max_background_flushes;
 };
 
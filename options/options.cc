@@ -18,6 +18,7 @@
 #include "rocksdb/cache.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/comparator.h"
+#include "rocksdb/compressor.h"
 #include "rocksdb/env.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/merge_operator.h"
@@ -52,6 +53,9 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.memtable_prefix_bloom_size_ratio),
       memtable_whole_key_filtering(options.memtable_whole_key_filtering),
       memtable_huge_page_size(options.memtable_huge_page_size),
+      memtable_hot_key_cache_size(options.memtable_hot_key_cache_size),
+      memtable_large_value_threshold(options.memtable_large_value_threshold),
+      max_adaptive_write_buffer_size(options.max_adaptive_write_buffer_size),
       memtable_insert_with_hint_prefix_extractor(
           options.memtable_insert_with_hint_prefix_extractor),
       bloom_locality(options.bloom_locality),
@@ -68,10 +72,14 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       max_bytes_for_level_multiplier_additional(
           options.max_bytes_for_level_multiplier_additional),
       max_compaction_bytes(options.max_compaction_bytes),
+      level_compaction_dynamic_file_size(
+          options.level_compaction_dynamic_file_size),
       soft_pending_compaction_bytes_limit(
           options.soft_pending_compaction_bytes_limit),
       hard_pending_compaction_bytes_limit(
           options.hard_pending_compaction_bytes_limit),
+      pending_compaction_bytes_slowdown_start_ratio(
+          options.pending_compaction_bytes_slowdown_start_ratio),
       compaction_style(options.compaction_style),
       compaction_pri(options.compaction_pri),
       compaction_options_universal(options.compaction_options_universal),
@@ -82,20 +90,43 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       table_properties_collector_factories(
           options.table_properties_collector_factories),
       max_successive_merges(options.max_successive_merges),
+      merge_operands_collapse_threshold(
+          options.merge_operands_collapse_threshold),
+      use_loser_tree_merging_iterator(options.use_loser_tree_merging_iterator),
+      flush_to_lowest_nonoverlapping_level(
+          options.flush_to_lowest_nonoverlapping_level),
+      write_buffer_share_weight(options.write_buffer_share_weight),
+      write_buffer_min_share_bytes(options.write_buffer_min_share_bytes),
+      max_flush_partitions(options.max_flush_partitions),
+      align_flush_partitions_to_base_level(
+          options.align_flush_partitions_to_base_level),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
+      skip_filters_after_unhelpful_checks(
+          options.skip_filters_after_unhelpful_checks),
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
       report_bg_io_stats(options.report_bg_io_stats),
       ttl(options.ttl),
       periodic_compaction_seconds(options.periodic_compaction_seconds),
       sample_for_compression(options.sample_for_compression),
+      bottommost_hot_file_read_rate(options.bottommost_hot_file_read_rate),
       enable_blob_files(options.enable_blob_files),
       min_blob_size(options.min_blob_size),
       blob_file_size(options.blob_file_size),
       blob_compression_type(options.blob_compression_type),
+      blob_compression_max_dict_bytes(options.blob_compression_max_dict_bytes),
+      blob_compression_parallel_threads(
+          options.blob_compression_parallel_threads),
       enable_blob_garbage_collection(options.enable_blob_garbage_collection),
       blob_garbage_collection_age_cutoff(
-          options.blob_garbage_collection_age_cutoff) {
+          options.blob_garbage_collection_age_cutoff),
+      blob_garbage_collection_force_threshold(
+          options.blob_garbage_collection_force_threshold),
+      cold_blob_file_size(options.cold_blob_file_size),
+      cold_blob_file_temperature(options.cold_blob_file_temperature),
+      blob_cache(options.blob_cache),
+      cf_statistics(options.cf_statistics),
+      use_direct_reads_for_blob_files(options.use_direct_reads_for_blob_files) {
   assert(memtable_factory.get() != nullptr);
   if (max_bytes_for_level_multiplier_additional.size() <
       static_cast<unsigned int>(num_levels)) {
@@ -133,6 +164,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, " Options.sst_partitioner_factory: %s",
       sst_partitioner_factory ? sst_partitioner_factory->Name() : "None");
+  ROCKS_LOG_HEADER(log, "              Options.compressor: %s",
+                   compressor ? compressor->Name() : "None");
   ROCKS_LOG_HEADER(log, "        Options.memtable_factory: %s",
                    memtable_factory->Name());
   ROCKS_LOG_HEADER(log, "           Options.table_factory: %s",
@@ -206,6 +239,11 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         "        Options.bottommost_compression_opts.max_dict_buffer_bytes: "
         "%" PRIu64,
         bottommost_compression_opts.max_dict_buffer_bytes);
+    ROCKS_LOG_HEADER(
+        log,
+        "        Options.bottommost_compression_opts.max_dict_reuse_seconds: "
+        "%" PRIu64,
+        bottommost_compression_opts.max_dict_reuse_seconds);
     ROCKS_LOG_HEADER(log, "           Options.compression_opts.window_bits: %d",
                      compression_opts.window_bits);
     ROCKS_LOG_HEADER(log, "                 Options.compression_opts.level: %d",
@@ -231,6 +269,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      "        Options.compression_opts.max_dict_buffer_bytes: "
                      "%" PRIu64,
                      compression_opts.max_dict_buffer_bytes);
+    ROCKS_LOG_HEADER(log,
+                     "        Options.compression_opts.max_dict_reuse_seconds: "
+                     "%" PRIu64,
+                     compression_opts.max_dict_reuse_seconds);
     ROCKS_LOG_HEADER(log, "     Options.level0_file_num_compaction_trigger: %d",
                      level0_file_num_compaction_trigger);
     ROCKS_LOG_HEADER(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -262,6 +304,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(
         log, "                   Options.max_compaction_bytes: %" PRIu64,
         max_compaction_bytes);
+    ROCKS_LOG_HEADER(log, "     Options.level_compaction_dynamic_file_size: %d",
+                     level_compaction_dynamic_file_size);
     ROCKS_LOG_HEADER(
         log,
         "                       Options.arena_block_size: %" ROCKSDB_PRIszt,
@@ -272,6 +316,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "  Options.hard_pending_compaction_bytes_limit: %" PRIu64,
                      hard_pending_compaction_bytes_limit);
+    ROCKS_LOG_HEADER(
+        log, "Options.pending_compaction_bytes_slowdown_start_ratio: %f",
+        pending_compaction_bytes_slowdown_start_ratio);
     ROCKS_LOG_HEADER(log, "      Options.rate_limit_delay_max_milliseconds: %u",
                      rate_limit_delay_max_milliseconds);
     ROCKS_LOG_HEADER(log, "               Options.disable_auto_compactions: %d",
@@ -339,6 +386,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "Options.compaction_options_fifo.allow_compaction: %d",
                      compaction_options_fifo.allow_compaction);
+    ROCKS_LOG_HEADER(
+        log, "Options.compaction_options_fifo.time_window_seconds: %" PRIu64,
+        compaction_options_fifo.time_window_seconds);
     std::ostringstream collector_info;
     for (const auto& collector_factory : table_properties_collector_factories) {
       collector_info << collector_factory->ToString() << ';';
@@ -363,6 +413,15 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
 
     ROCKS_LOG_HEADER(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
                      memtable_huge_page_size);
+    ROCKS_LOG_HEADER(log,
+                     "  Options.memtable_hot_key_cache_size: %" ROCKSDB_PRIszt,
+                     memtable_hot_key_cache_size);
+    ROCKS_LOG_HEADER(
+        log, "  Options.memtable_large_value_threshold: %" ROCKSDB_PRIszt,
+        memtable_large_value_threshold);
+    ROCKS_LOG_HEADER(
+        log, "  Options.max_adaptive_write_buffer_size: %" ROCKSDB_PRIszt,
+        max_adaptive_write_buffer_size);
     ROCKS_LOG_HEADER(log,
                      "                          Options.bloom_locality: %d",
                      bloom_locality);
@@ -371,9 +430,32 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         log,
         "                   Options.max_successive_merges: %" ROCKSDB_PRIszt,
         max_successive_merges);
+    ROCKS_LOG_HEADER(
+        log,
+        "       Options.merge_operands_collapse_threshold: %" ROCKSDB_PRIszt,
+        merge_operands_collapse_threshold);
+    ROCKS_LOG_HEADER(log, "        Options.use_loser_tree_merging_iterator: %d",
+                     use_loser_tree_merging_iterator);
+    ROCKS_LOG_HEADER(log, "   Options.flush_to_lowest_nonoverlapping_level: %d",
+                     flush_to_lowest_nonoverlapping_level);
+    ROCKS_LOG_HEADER(log, "              Options.write_buffer_share_weight: %f",
+                     write_buffer_share_weight);
+    ROCKS_LOG_HEADER(
+        log,
+        "           Options.write_buffer_min_share_bytes: %" ROCKSDB_PRIszt,
+        write_buffer_min_share_bytes);
+    ROCKS_LOG_HEADER(
+        log, "                   Options.max_flush_partitions: %" PRIu32,
+        max_flush_partitions);
+    ROCKS_LOG_HEADER(log,
+                     "   Options.align_flush_partitions_to_base_level: %d",
+                     align_flush_partitions_to_base_level);
     ROCKS_LOG_HEADER(log,
                      "               Options.optimize_filters_for_hits: %d",
                      optimize_filters_for_hits);
+    ROCKS_LOG_HEADER(
+        log, "     Options.skip_filters_after_unhelpful_checks: %" PRIu64,
+        skip_filters_after_unhelpful_checks);
     ROCKS_LOG_HEADER(log, "               Options.paranoid_file_checks: %d",
                      paranoid_file_checks);
     ROCKS_LOG_HEADER(log, "               Options.force_consistency_checks: %d",
@@ -385,6 +467,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "         Options.periodic_compaction_seconds: %" PRIu64,
                      periodic_compaction_seconds);
+    ROCKS_LOG_HEADER(log,
+                     "       Options.bottommost_hot_file_read_rate: %" PRIu64,
+                     bottommost_hot_file_read_rate);
     ROCKS_LOG_HEADER(log, "                   Options.enable_blob_files: %s",
                      enable_blob_files ? "true" : "false");
     ROCKS_LOG_HEADER(log,
@@ -395,10 +480,28 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      blob_file_size);
     ROCKS_LOG_HEADER(log, "               Options.blob_compression_type: %s",
                      CompressionTypeToString(blob_compression_type).c_str());
+    ROCKS_LOG_HEADER(log,
+                     "     Options.blob_compression_max_dict_bytes: %" PRIu32,
+                     blob_compression_max_dict_bytes);
+    ROCKS_LOG_HEADER(log,
+                     "   Options.blob_compression_parallel_threads: %" PRIu32,
+                     blob_compression_parallel_threads);
     ROCKS_LOG_HEADER(log, "      Options.enable_blob_garbage_collection: %s",
                      enable_blob_garbage_collection ? "true" : "false");
     ROCKS_LOG_HEADER(log, "  Options.blob_garbage_collection_age_cutoff: %f",
                      blob_garbage_collection_age_cutoff);
+    ROCKS_LOG_HEADER(log,
+                     "Options.blob_garbage_collection_force_threshold: %f",
+                     blob_garbage_collection_force_threshold);
+    ROCKS_LOG_HEADER(log,
+                     "                 Options.cold_blob_file_size: %" PRIu64,
+                     cold_blob_file_size);
+    ROCKS_LOG_HEADER(log, "                          Options.blob_cache: %p",
+                     static_cast<void*>(blob_cache.get()));
+    ROCKS_LOG_HEADER(log, "                       Options.cf_statistics: %p",
+                     static_cast<void*>(cf_statistics.get()));
+    ROCKS_LOG_HEADER(log, "     Options.use_direct_reads_for_blob_files: %s",
+                     use_direct_reads_for_blob_files ? "true" : "false");
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
@@ -644,7 +747,14 @@ ReadOptions::ReadOptions()
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      async_io(false),
+      min_memtable_value_size_to_pin(std::numeric_limits<uint64_t>::max()),
+      multiread_coalesce_max_gap(0),
+      multiread_coalesce_max_size(0),
+      hedged_read_percentile(0),
+      hedged_read_min_delay(std::chrono::microseconds::zero()),
+      rate_limiter_priority(Env::IO_TOTAL) {}
 
 ReadOptions::ReadOptions(bool cksum, bool cache)
     : snapshot(nullptr),
@@ -668,6 +778,13 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      async_io(false),
+      min_memtable_value_size_to_pin(std::numeric_limits<uint64_t>::max()),
+      multiread_coalesce_max_gap(0),
+      multiread_coalesce_max_size(0),
+      hedged_read_percentile(0),
+      hedged_read_min_delay(std::chrono::microseconds::zero()),
+      rate_limiter_priority(Env::IO_TOTAL) {}
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -77,6 +77,12 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.max_open_files = mutable_db_options.max_open_files;
   options.max_file_opening_threads =
       immutable_db_options.max_file_opening_threads;
+  options.open_table_files_in_background =
+      immutable_db_options.open_table_files_in_background;
+  options.max_file_verification_threads =
+      immutable_db_options.max_file_verification_threads;
+  options.secondary_catch_up_period_micros =
+      immutable_db_options.secondary_catch_up_period_micros;
   options.max_total_wal_size = mutable_db_options.max_total_wal_size;
   options.statistics = immutable_db_options.statistics;
   options.use_fsync = immutable_db_options.use_fsync;
@@ -98,8 +104,11 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.max_log_file_size = immutable_db_options.max_log_file_size;
   options.log_file_time_to_roll = immutable_db_options.log_file_time_to_roll;
   options.keep_log_file_num = immutable_db_options.keep_log_file_num;
+  options.async_info_log = immutable_db_options.async_info_log;
   options.recycle_log_file_num = immutable_db_options.recycle_log_file_num;
   options.max_manifest_file_size = immutable_db_options.max_manifest_file_size;
+  options.max_manifest_space_amp_pct =
+      immutable_db_options.max_manifest_space_amp_pct;
   options.table_cache_numshardbits =
       immutable_db_options.table_cache_numshardbits;
   options.WAL_ttl_seconds = immutable_db_options.WAL_ttl_seconds;
@@ -111,12 +120,19 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.use_direct_reads = immutable_db_options.use_direct_reads;
   options.use_direct_io_for_flush_and_compaction =
       immutable_db_options.use_direct_io_for_flush_and_compaction;
+  options.use_async_writes_for_flush_and_compaction =
+      immutable_db_options.use_async_writes_for_flush_and_compaction;
+  options.use_direct_io_for_wal = immutable_db_options.use_direct_io_for_wal;
+  options.use_pmem_for_wal = immutable_db_options.use_pmem_for_wal;
   options.allow_fallocate = immutable_db_options.allow_fallocate;
   options.is_fd_close_on_exec = immutable_db_options.is_fd_close_on_exec;
   options.stats_dump_period_sec = mutable_db_options.stats_dump_period_sec;
   options.stats_persist_period_sec =
       mutable_db_options.stats_persist_period_sec;
   options.persist_stats_to_disk = immutable_db_options.persist_stats_to_disk;
+  options.auto_tune_period_sec = immutable_db_options.auto_tune_period_sec;
+  options.auto_tune_write_p99_micros =
+      immutable_db_options.auto_tune_write_p99_micros;
   options.stats_history_buffer_size =
       mutable_db_options.stats_history_buffer_size;
   options.advise_random_on_open = immutable_db_options.advise_random_on_open;
@@ -128,6 +144,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.new_table_reader_for_compaction_inputs;
   options.compaction_readahead_size =
       mutable_db_options.compaction_readahead_size;
+  options.max_compaction_readahead_size =
+      mutable_db_options.max_compaction_readahead_size;
   options.random_access_max_buffer_size =
       immutable_db_options.random_access_max_buffer_size;
   options.writable_file_max_buffer_size =
@@ -138,6 +156,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
   options.unordered_write = immutable_db_options.unordered_write;
+  options.enable_no_wal_write_fast_path =
+      immutable_db_options.enable_no_wal_write_fast_path;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
   options.enable_write_thread_adaptive_yield =
@@ -148,11 +168,24 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.write_thread_max_yield_usec;
   options.write_thread_slow_yield_usec =
       immutable_db_options.write_thread_slow_yield_usec;
+  options.write_thread_spinners_per_core =
+      immutable_db_options.write_thread_spinners_per_core;
+  options.memtable_batch_sort_threshold =
+      immutable_db_options.memtable_batch_sort_threshold;
+  options.pipelined_compaction_io =
+      immutable_db_options.pipelined_compaction_io;
+  options.compaction_copy_unchanged_blocks =
+      immutable_db_options.compaction_copy_unchanged_blocks;
+  options.compaction_service_timeout_ms =
+      immutable_db_options.compaction_service_timeout_ms;
+  options.perf_context_sample_one_in =
+      immutable_db_options.perf_context_sample_one_in;
   options.skip_stats_update_on_db_open =
       immutable_db_options.skip_stats_update_on_db_open;
   options.skip_checking_sst_file_sizes_on_db_open =
       immutable_db_options.skip_checking_sst_file_sizes_on_db_open;
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
+  options.wal_recovery_threads = immutable_db_options.wal_recovery_threads;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
 #ifndef ROCKSDB_LITE
@@ -171,9 +204,12 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.preserve_deletes;
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
+  options.wal_compression = immutable_db_options.wal_compression;
   options.atomic_flush = immutable_db_options.atomic_flush;
   options.avoid_unnecessary_blocking_io =
       immutable_db_options.avoid_unnecessary_blocking_io;
+  options.prioritize_stall_relieving_work =
+      immutable_db_options.prioritize_stall_relieving_work;
   options.log_readahead_size = immutable_db_options.log_readahead_size;
   options.file_checksum_gen_factory =
       immutable_db_options.file_checksum_gen_factory;
@@ -209,7 +245,23 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.memtable_prefix_bloom_size_ratio;
   cf_opts->memtable_whole_key_filtering = moptions.memtable_whole_key_filtering;
   cf_opts->memtable_huge_page_size = moptions.memtable_huge_page_size;
+  cf_opts->memtable_hot_key_cache_size = moptions.memtable_hot_key_cache_size;
+  cf_opts->memtable_large_value_threshold =
+      moptions.memtable_large_value_threshold;
+  cf_opts->max_adaptive_write_buffer_size =
+      moptions.max_adaptive_write_buffer_size;
   cf_opts->max_successive_merges = moptions.max_successive_merges;
+  cf_opts->merge_operands_collapse_threshold =
+      moptions.merge_operands_collapse_threshold;
+  cf_opts->use_loser_tree_merging_iterator =
+      moptions.use_loser_tree_merging_iterator;
+  cf_opts->flush_to_lowest_nonoverlapping_level =
+      moptions.flush_to_lowest_nonoverlapping_level;
+  cf_opts->write_buffer_share_weight = moptions.write_buffer_share_weight;
+  cf_opts->write_buffer_min_share_bytes = moptions.write_buffer_min_share_bytes;
+  cf_opts->max_flush_partitions = moptions.max_flush_partitions;
+  cf_opts->align_flush_partitions_to_base_level =
+      moptions.align_flush_partitions_to_base_level;
   cf_opts->inplace_update_num_locks = moptions.inplace_update_num_locks;
   cf_opts->prefix_extractor = moptions.prefix_extractor;
 
@@ -219,12 +271,16 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.soft_pending_compaction_bytes_limit;
   cf_opts->hard_pending_compaction_bytes_limit =
       moptions.hard_pending_compaction_bytes_limit;
+  cf_opts->pending_compaction_bytes_slowdown_start_ratio =
+      moptions.pending_compaction_bytes_slowdown_start_ratio;
   cf_opts->level0_file_num_compaction_trigger =
       moptions.level0_file_num_compaction_trigger;
   cf_opts->level0_slowdown_writes_trigger =
       moptions.level0_slowdown_writes_trigger;
   cf_opts->level0_stop_writes_trigger = moptions.level0_stop_writes_trigger;
   cf_opts->max_compaction_bytes = moptions.max_compaction_bytes;
+  cf_opts->level_compaction_dynamic_file_size =
+      moptions.level_compaction_dynamic_file_size;
   cf_opts->target_file_size_base = moptions.target_file_size_base;
   cf_opts->target_file_size_multiplier = moptions.target_file_size_multiplier;
   cf_opts->max_bytes_for_level_base = moptions.max_bytes_for_level_base;
@@ -246,10 +302,18 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   cf_opts->min_blob_size = moptions.min_blob_size;
   cf_opts->blob_file_size = moptions.blob_file_size;
   cf_opts->blob_compression_type = moptions.blob_compression_type;
+  cf_opts->blob_compression_max_dict_bytes =
+      moptions.blob_compression_max_dict_bytes;
+  cf_opts->blob_compression_parallel_threads =
+      moptions.blob_compression_parallel_threads;
   cf_opts->enable_blob_garbage_collection =
       moptions.enable_blob_garbage_collection;
   cf_opts->blob_garbage_collection_age_cutoff =
       moptions.blob_garbage_collection_age_cutoff;
+  cf_opts->blob_garbage_collection_force_threshold =
+      moptions.blob_garbage_collection_force_threshold;
+  cf_opts->cold_blob_file_size = moptions.cold_blob_file_size;
+  cf_opts->cold_blob_file_temperature = moptions.cold_blob_file_temperature;
 
   // Misc options
   cf_opts->max_sequential_skip_in_iterations =
@@ -258,10 +322,14 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.check_flush_compaction_key_order;
   cf_opts->paranoid_file_checks = moptions.paranoid_file_checks;
   cf_opts->report_bg_io_stats = moptions.report_bg_io_stats;
+  cf_opts->skip_filters_after_unhelpful_checks =
+      moptions.skip_filters_after_unhelpful_checks;
   cf_opts->compression = moptions.compression;
   cf_opts->compression_opts = moptions.compression_opts;
   cf_opts->bottommost_compression = moptions.bottommost_compression;
   cf_opts->bottommost_compression_opts = moptions.bottommost_compression_opts;
+  cf_opts->bottommost_hot_file_read_rate =
+      moptions.bottommost_hot_file_read_rate;
   cf_opts->sample_for_compression = moptions.sample_for_compression;
 }
 
@@ -299,6 +367,11 @@ void UpdateColumnFamilyOptions(const ImmutableCFOptions& ioptions,
   cf_opts->cf_paths = ioptions.cf_paths;
   cf_opts->compaction_thread_limiter = ioptions.compaction_thread_limiter;
   cf_opts->sst_partitioner_factory = ioptions.sst_partitioner_factory;
+  cf_opts->blob_cache = ioptions.blob_cache;
+  cf_opts->compressor = ioptions.compressor;
+  cf_opts->cf_statistics = ioptions.cf_statistics;
+  cf_opts->use_direct_reads_for_blob_files =
+      ioptions.use_direct_reads_for_blob_files;
 
   // TODO(yhchiang): find some way to handle the following derived options
   // * max_file_size
@@ -315,7 +388,8 @@ std::map<CompactionPri, std::string> OptionsHelper::compaction_pri_to_string = {
     {kByCompensatedSize, "kByCompensatedSize"},
     {kOldestLargestSeqFirst, "kOldestLargestSeqFirst"},
     {kOldestSmallestSeqFirst, "kOldestSmallestSeqFirst"},
-    {kMinOverlappingRatio, "kMinOverlappingRatio"}};
+    {kMinOverlappingRatio, "kMinOverlappingRatio"},
+    {kHotnessAware, "kHotnessAware"}};
 
 std::map<CompactionStopStyle, std::string>
     OptionsHelper::compaction_stop_style_to_string = {
@@ -326,7 +400,8 @@ std::unordered_map<std::string, ChecksumType>
     OptionsHelper::checksum_type_string_map = {{"kNoChecksum", kNoChecksum},
                                                {"kCRC32c", kCRC32c},
                                                {"kxxHash", kxxHash},
-                                               {"kxxHash64", kxxHash64}};
+                                               {"kxxHash64", kxxHash64},
+                                               {"kXXH3", kXXH3}};
 
 std::unordered_map<std::string, CompressionType>
     OptionsHelper::compression_type_string_map = {
@@ -339,6 +414,7 @@ std::unordered_map<std::string, CompressionType>
         {"kXpressCompression", kXpressCompression},
         {"kZSTD", kZSTD},
         {"kZSTDNotFinalCompression", kZSTDNotFinalCompression},
+        {"kCustomCompression", kCustomCompression},
         {"kDisableCompressionOption", kDisableCompressionOption}};
 
 std::vector<CompressionType> GetSupportedCompressions() {
@@ -895,7 +971,8 @@ std::unordered_map<std::string, CompactionPri>
         {"kByCompensatedSize", kByCompensatedSize},
         {"kOldestLargestSeqFirst", kOldestLargestSeqFirst},
         {"kOldestSmallestSeqFirst", kOldestSmallestSeqFirst},
-        {"kMinOverlappingRatio", kMinOverlappingRatio}};
+        {"kMinOverlappingRatio", kMinOverlappingRatio},
+        {"kHotnessAware", kHotnessAware}};
 
 std::unordered_map<std::string, CompactionStopStyle>
     OptionsHelper::compaction_stop_style_string_map = {
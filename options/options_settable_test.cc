@@ -160,24 +160,34 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "cache_index_and_filter_blocks_with_high_priority=true;"
       "metadata_cache_options={top_level_index_pinning=kFallback;"
       "partition_pinning=kAll;"
-      "unpartitioned_pinning=kFlushedAndSimilar;};"
+      "unpartitioned_pinning=kFlushedAndSimilar;"
+      "max_upper_level=2;};"
       "pin_l0_filter_and_index_blocks_in_cache=1;"
       "pin_top_level_index_and_filter=1;"
+      "compact_table_reader=true;"
       "index_type=kHashSearch;"
       "data_block_index_type=kDataBlockBinaryAndHash;"
       "index_shortening=kNoShortening;"
       "data_block_hash_table_util_ratio=0.75;"
+      "wide_data_block_hash_index=true;"
+      "separate_key_value_in_data_block=true;"
+      "restart_key_prefixes_in_data_block=true;"
       "checksum=kxxHash;hash_index_allow_collision=1;no_block_cache=1;"
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;"
       "block_size_deviation=8;block_restart_interval=4; "
       "metadata_block_size=1024;"
       "partition_filters=false;"
       "optimize_filters_for_memory=true;"
+      "reserve_table_builder_memory=true;"
+      "range_filter_prefix_len=8;"
+      "multiget_decompression_threads=2;"
+      "key_position_samples=64;"
       "index_block_restart_interval=4;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;"
       "format_version=1;"
       "hash_index_allow_collision=false;"
-      "verify_compression=true;read_amp_bytes_per_bit=0;"
+      "verify_compression=true;adaptive_compression=true;"
+      "read_amp_bytes_per_bit=0;"
       "enable_index_compression=false;"
       "block_align=true;"
       "max_auto_readahead_size=0;"
@@ -272,6 +282,9 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "table_cache_numshardbits=28;"
                              "max_open_files=72;"
                              "max_file_opening_threads=35;"
+                             "open_table_files_in_background=true;"
+                             "max_file_verification_threads=7;"
+                             "secondary_catch_up_period_micros=1000;"
                              "max_background_jobs=8;"
                              "base_background_compactions=3;"
                              "max_background_compactions=33;"
@@ -279,11 +292,14 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "use_adaptive_mutex=false;"
                              "max_total_wal_size=4295005604;"
                              "compaction_readahead_size=0;"
+                             "max_compaction_readahead_size=0;"
                              "new_table_reader_for_compaction_inputs=false;"
                              "keep_log_file_num=4890;"
+                             "async_info_log=true;"
                              "skip_stats_update_on_db_open=false;"
                              "skip_checking_sst_file_sizes_on_db_open=false;"
                              "max_manifest_file_size=4295009941;"
+                             "max_manifest_space_amp_pct=500;"
                              "db_log_dir=path/to/db_log_dir;"
                              "skip_log_error_on_recovery=true;"
                              "writable_file_max_buffer_size=1048576;"
@@ -306,22 +322,35 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "stats_dump_period_sec=70127;"
                              "stats_persist_period_sec=54321;"
                              "persist_stats_to_disk=true;"
+                             "auto_tune_period_sec=33;"
+                             "auto_tune_write_p99_micros=4321;"
                              "stats_history_buffer_size=14159;"
                              "allow_fallocate=true;"
                              "allow_mmap_reads=false;"
                              "use_direct_reads=false;"
                              "use_direct_io_for_flush_and_compaction=false;"
+                             "use_async_writes_for_flush_and_compaction=true;"
+                             "use_direct_io_for_wal=false;"
+                             "use_pmem_for_wal=false;"
                              "max_log_file_size=4607;"
                              "random_access_max_buffer_size=1048576;"
                              "advise_random_on_open=true;"
                              "fail_if_options_file_error=false;"
                              "enable_pipelined_write=false;"
                              "unordered_write=false;"
+                             "enable_no_wal_write_fast_path=false;"
                              "allow_concurrent_memtable_write=true;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
+                             "wal_recovery_threads=4;"
                              "enable_write_thread_adaptive_yield=true;"
                              "write_thread_slow_yield_usec=5;"
                              "write_thread_max_yield_usec=1000;"
+                             "write_thread_spinners_per_core=2;"
+                             "memtable_batch_sort_threshold=1000;"
+                             "pipelined_compaction_io=false;"
+                             "compaction_copy_unchanged_blocks=false;"
+                             "compaction_service_timeout_ms=1000;"
+                             "perf_context_sample_one_in=100;"
                              "access_hint_on_compaction_start=NONE;"
                              "info_log_level=DEBUG_LEVEL;"
                              "dump_malloc_stats=false;"
@@ -333,9 +362,11 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "concurrent_prepare=false;"
                              "two_write_queues=false;"
                              "manual_wal_flush=false;"
+                             "wal_compression=kZSTD;"
                              "seq_per_batch=false;"
                              "atomic_flush=false;"
                              "avoid_unnecessary_blocking_io=false;"
+                             "prioritize_stall_relieving_work=false;"
                              "log_readahead_size=0;"
                              "write_dbid_to_manifest=false;"
                              "best_efforts_recovery=false;"
@@ -405,6 +436,12 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<ConcurrentTaskLimiter>)},
       {offset_of(&ColumnFamilyOptions::sst_partitioner_factory),
        sizeof(std::shared_ptr<SstPartitionerFactory>)},
+      {offset_of(&ColumnFamilyOptions::blob_cache),
+       sizeof(std::shared_ptr<Cache>)},
+      {offset_of(&ColumnFamilyOptions::compressor),
+       sizeof(std::shared_ptr<Compressor>)},
+      {offset_of(&ColumnFamilyOptions::cf_statistics),
+       sizeof(std::shared_ptr<Statistics>)},
   };
 
   char* options_ptr = new char[sizeof(ColumnFamilyOptions)];
@@ -446,6 +483,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
   options->compaction_filter = nullptr;
   options->sst_partitioner_factory = nullptr;
   options->bottommost_temperature = Temperature::kUnknown;
+  options->cold_blob_file_temperature = Temperature::kUnknown;
 
   char* new_options_ptr = new char[sizeof(ColumnFamilyOptions)];
   ColumnFamilyOptions* new_options =
@@ -467,7 +505,17 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "bloom_locality=8016;"
       "target_file_size_base=4294976376;"
       "memtable_huge_page_size=2557;"
+      "memtable_hot_key_cache_size=64;"
+      "memtable_large_value_threshold=4096;"
+      "max_adaptive_write_buffer_size=268435456;"
       "max_successive_merges=5497;"
+      "merge_operands_collapse_threshold=117;"
+      "use_loser_tree_merging_iterator=true;"
+      "flush_to_lowest_nonoverlapping_level=true;"
+      "write_buffer_share_weight=2.5;"
+      "write_buffer_min_share_bytes=1048576;"
+      "max_flush_partitions=4;"
+      "align_flush_partitions_to_base_level=true;"
       "max_sequential_skip_in_iterations=4294971408;"
       "arena_block_size=1893;"
       "target_file_size_multiplier=35;"
@@ -475,11 +523,12 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "max_write_buffer_number=84;"
       "write_buffer_size=1653;"
       "max_compaction_bytes=64;"
+      "level_compaction_dynamic_file_size=false;"
       "max_bytes_for_level_multiplier=60;"
       "memtable_factory=SkipListFactory;"
       "compression=kNoCompression;"
-      "compression_opts=5:6:7:8:9:10:true:11;"
-      "bottommost_compression_opts=4:5:6:7:8:9:true:10;"
+      "compression_opts=5:6:7:8:9:10:true:11:12;"
+      "bottommost_compression_opts=4:5:6:7:8:9:true:10:11;"
       "bottommost_compression=kDisableCompressionOption;"
       "level0_stop_writes_trigger=33;"
       "num_levels=99;"
@@ -499,24 +548,32 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "force_consistency_checks=true;"
       "inplace_update_num_locks=7429;"
       "optimize_filters_for_hits=false;"
+      "skip_filters_after_unhelpful_checks=1000;"
       "level_compaction_dynamic_level_bytes=false;"
       "inplace_update_support=false;"
       "compaction_style=kCompactionStyleFIFO;"
       "compaction_pri=kMinOverlappingRatio;"
       "hard_pending_compaction_bytes_limit=0;"
+      "pending_compaction_bytes_slowdown_start_ratio=0.5;"
       "disable_auto_compactions=false;"
       "report_bg_io_stats=true;"
       "ttl=60;"
       "periodic_compaction_seconds=3600;"
       "sample_for_compression=0;"
+      "bottommost_hot_file_read_rate=1000;"
       "enable_blob_files=true;"
       "min_blob_size=256;"
       "blob_file_size=1000000;"
       "blob_compression_type=kBZip2Compression;"
+      "blob_compression_max_dict_bytes=16384;"
+      "blob_compression_parallel_threads=4;"
       "enable_blob_garbage_collection=true;"
       "blob_garbage_collection_age_cutoff=0.5;"
+      "blob_garbage_collection_force_threshold=0.75;"
+      "cold_blob_file_size=2000000;"
+      "use_direct_reads_for_blob_files=true;"
       "compaction_options_fifo={max_table_files_size=3;allow_"
-      "compaction=false;};",
+      "compaction=false;time_window_seconds=3600;};",
       new_options));
 
   ASSERT_EQ(unset_bytes_base,
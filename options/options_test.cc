@@ -102,8 +102,14 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"min_blob_size", "1K"},
       {"blob_file_size", "1G"},
       {"blob_compression_type", "kZSTD"},
+      {"blob_compression_max_dict_bytes", "16384"},
+      {"blob_compression_parallel_threads", "4"},
       {"enable_blob_garbage_collection", "true"},
       {"blob_garbage_collection_age_cutoff", "0.5"},
+      {"blob_garbage_collection_force_threshold", "0.75"},
+      {"cold_blob_file_size", "2G"},
+      {"use_direct_reads_for_blob_files", "true"},
+      {"bottommost_hot_file_read_rate", "1000"},
   };
 
   std::unordered_map<std::string, std::string> db_options_map = {
@@ -234,8 +240,14 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.min_blob_size, 1ULL << 10);
   ASSERT_EQ(new_cf_opt.blob_file_size, 1ULL << 30);
   ASSERT_EQ(new_cf_opt.blob_compression_type, kZSTD);
+  ASSERT_EQ(new_cf_opt.blob_compression_max_dict_bytes, 16384);
+  ASSERT_EQ(new_cf_opt.blob_compression_parallel_threads, 4);
   ASSERT_EQ(new_cf_opt.enable_blob_garbage_collection, true);
   ASSERT_EQ(new_cf_opt.blob_garbage_collection_age_cutoff, 0.5);
+  ASSERT_EQ(new_cf_opt.blob_garbage_collection_force_threshold, 0.75);
+  ASSERT_EQ(new_cf_opt.cold_blob_file_size, 1ULL << 31);
+  ASSERT_EQ(new_cf_opt.use_direct_reads_for_blob_files, true);
+  ASSERT_EQ(new_cf_opt.bottommost_hot_file_read_rate, 1000);
 
   cf_options_map["write_buffer_size"] = "hello";
   ASSERT_NOK(GetColumnFamilyOptionsFromMap(exact, base_cf_opt, cf_options_map,
@@ -1069,7 +1081,8 @@ TEST_F(OptionsTest, GetPlainTableOptionsFromString) {
       config_options, table_opt,
       "user_key_len=66;bloom_bits_per_key=20;hash_table_ratio=0.5;"
       "index_sparseness=8;huge_page_tlb_size=4;encoding_type=kPrefix;"
-      "full_scan_mode=true;store_index_in_file=true",
+      "full_scan_mode=true;store_index_in_file=true;"
+      "copy_data_to_huge_pages=true",
       &new_opt));
   ASSERT_EQ(new_opt.user_key_len, 66u);
   ASSERT_EQ(new_opt.bloom_bits_per_key, 20);
@@ -1079,6 +1092,7 @@ TEST_F(OptionsTest, GetPlainTableOptionsFromString) {
   ASSERT_EQ(new_opt.encoding_type, EncodingType::kPrefix);
   ASSERT_TRUE(new_opt.full_scan_mode);
   ASSERT_TRUE(new_opt.store_index_in_file);
+  ASSERT_TRUE(new_opt.copy_data_to_huge_pages);
 
   // unknown option
   Status s = GetPlainTableOptionsFromString(
@@ -1125,6 +1139,15 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_NOK(GetMemTableRepFactoryFromString("hash_linkedlist:1000:invalid_opt",
                                              &new_mem_factory));
 
+  ASSERT_OK(GetMemTableRepFactoryFromString("hash_indexed_skip_list",
+                                            &new_mem_factory));
+  ASSERT_OK(GetMemTableRepFactoryFromString("hash_indexed_skip_list:1000",
+                                            &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()),
+            "HashIndexedSkipListRepFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString(
+      "hash_indexed_skip_list:1000:invalid_opt", &new_mem_factory));
+
   ASSERT_OK(GetMemTableRepFactoryFromString("vector", &new_mem_factory));
   ASSERT_OK(GetMemTableRepFactoryFromString("vector:1024", &new_mem_factory));
   ASSERT_EQ(std::string(new_mem_factory->Name()), "VectorRepFactory");
@@ -2013,8 +2036,14 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
       {"min_blob_size", "1K"},
       {"blob_file_size", "1G"},
       {"blob_compression_type", "kZSTD"},
+      {"blob_compression_max_dict_bytes", "16384"},
+      {"blob_compression_parallel_threads", "4"},
       {"enable_blob_garbage_collection", "true"},
       {"blob_garbage_collection_age_cutoff", "0.5"},
+      {"blob_garbage_collection_force_threshold", "0.75"},
+      {"cold_blob_file_size", "2G"},
+      {"use_direct_reads_for_blob_files", "true"},
+      {"bottommost_hot_file_read_rate", "1000"},
   };
 
   std::unordered_map<std::string, std::string> db_options_map = {
@@ -2137,8 +2166,14 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.min_blob_size, 1ULL << 10);
   ASSERT_EQ(new_cf_opt.blob_file_size, 1ULL << 30);
   ASSERT_EQ(new_cf_opt.blob_compression_type, kZSTD);
+  ASSERT_EQ(new_cf_opt.blob_compression_max_dict_bytes, 16384);
+  ASSERT_EQ(new_cf_opt.blob_compression_parallel_threads, 4);
   ASSERT_EQ(new_cf_opt.enable_blob_garbage_collection, true);
   ASSERT_EQ(new_cf_opt.blob_garbage_collection_age_cutoff, 0.5);
+  ASSERT_EQ(new_cf_opt.blob_garbage_collection_force_threshold, 0.75);
+  ASSERT_EQ(new_cf_opt.cold_blob_file_size, 1ULL << 31);
+  ASSERT_EQ(new_cf_opt.use_direct_reads_for_blob_files, true);
+  ASSERT_EQ(new_cf_opt.bottommost_hot_file_read_rate, 1000);
 
   cf_options_map["write_buffer_size"] = "hello";
   ASSERT_NOK(GetColumnFamilyOptionsFromMap(
@@ -83,6 +83,18 @@ void Mutex::Lock() {
 #endif
 }
 
+bool Mutex::TryLock() {
+  int ret = pthread_mutex_trylock(&mu_);
+  if (ret == EBUSY) {
+    return false;
+  }
+  PthreadCall("trylock", ret);
+#ifndef NDEBUG
+  locked_ = true;
+#endif
+  return true;
+}
+
 void Mutex::Unlock() {
 #ifndef NDEBUG
   locked_ = false;
@@ -221,6 +233,71 @@ void cacheline_aligned_free(void *memblock) {
   free(memblock);
 }
 
+#if defined(__x86_64__)
+namespace {
+// The cache line write-back instruction to use, from the fastest available
+enum class CacheLineFlush { kClwb, kClflushopt, kClflush };
+
+CacheLineFlush DetectCacheLineFlush() {
+  unsigned eax, ebx = 0, ecx, edx;
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    if (ebx & (1U << 24)) {
+      return CacheLineFlush::kClwb;
+    }
+    if (ebx & (1U << 23)) {
+      return CacheLineFlush::kClflushopt;
+    }
+  }
+  return CacheLineFlush::kClflush;
+}
+}  // namespace
+#endif
+
+bool CanPersistCacheLines() {
+#if defined(__x86_64__) || defined(__aarch64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void PersistCacheLines(const void* addr, size_t size) {
+  // Smallest cache line size of the supported platforms. Flushing a line
+  // twice is harmless.
+  const uintptr_t kLineSize = 64;
+  uintptr_t p = reinterpret_cast<uintptr_t>(addr) & ~(kLineSize - 1);
+  const uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+#if defined(__x86_64__)
+  static const CacheLineFlush flush = DetectCacheLineFlush();
+  for (; p < end; p += kLineSize) {
+    char* line = reinterpret_cast<char*>(p);
+    // clwb and clflushopt are encoded with prefixes, which assemblers
+    // without support for them accept
+    switch (flush) {
+      case CacheLineFlush::kClwb:
+        asm volatile(".byte 0x66; xsaveopt %0" : "+m"(*line));
+        break;
+      case CacheLineFlush::kClflushopt:
+        asm volatile(".byte 0x66; clflush %0" : "+m"(*line));
+        break;
+      case CacheLineFlush::kClflush:
+        asm volatile("clflush %0" : "+m"(*line));
+        break;
+    }
+  }
+  // clwb and clflushopt are only ordered by a fence
+  asm volatile("sfence" : : : "memory");
+#elif defined(__aarch64__)
+  for (; p < end; p += kLineSize) {
+    asm volatile("dc cvac, %0" : : "r"(p) : "memory");
+  }
+  asm volatile("dsb ish" : : : "memory");
+#else
+  (void)p;
+  (void)end;
+#endif
+}
+
 static size_t GetPageSize() {
 #if defined(OS_LINUX) || defined(_SC_PAGESIZE)
   long v = sysconf(_SC_PAGESIZE);
@@ -115,6 +115,8 @@ class Mutex {
   ~Mutex();
 
   void Lock();
+  // Locks the mutex if it is not held, and returns whether it did
+  bool TryLock();
   void Unlock();
   // this will assert if the mutex is not locked
   // it does NOT verify that mutex is held by a calling thread
@@ -207,6 +209,16 @@ extern void *cacheline_aligned_alloc(size_t size);
 
 extern void cacheline_aligned_free(void *memblock);
 
+// Returns true if PersistCacheLines() can write back CPU cache lines on this
+// platform
+extern bool CanPersistCacheLines();
+
+// Writes back the CPU cache lines holding [addr, addr + size) to memory and
+// waits for the write-backs to complete, which makes stores to a MAP_SYNC
+// mapping of persistent memory durable. No-op where CanPersistCacheLines()
+// is false.
+extern void PersistCacheLines(const void* addr, size_t size);
+
 #define PREFETCH(addr, rw, locality) __builtin_prefetch(addr, rw, locality)
 
 extern void Crash(const std::string& srcfile, int srcline);
@@ -141,6 +141,17 @@ class Mutex {
 #endif
   }
 
+  // Locks the mutex if it is not held, and returns whether it did
+  bool TryLock() {
+    if (!mutex_.try_lock()) {
+      return false;
+    }
+#ifndef NDEBUG
+    locked_ = true;
+#endif
+    return true;
+  }
+
   void Unlock() {
 #ifndef NDEBUG
     locked_ = false;
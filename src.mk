@@ -2,10 +2,13 @@
 LIB_SOURCES =                                                   \
   cache/cache.cc                                                \
   cache/cache_entry_roles.cc                                    \
+  cache/cache_reservation_manager.cc                            \
   cache/clock_cache.cc                                          \
+  cache/compressed_secondary_cache.cc                           \
   cache/lru_cache.cc                                            \
   cache/sharded_cache.cc                                        \
   db/arena_wrapped_db_iter.cc                                   \
+  db/auto_tuner.cc                                              \
   db/blob/blob_fetcher.cc                                       \
   db/blob/blob_file_addition.cc                                 \
   db/blob/blob_file_builder.cc                                  \
@@ -17,10 +20,13 @@ LIB_SOURCES =                                                   \
   db/blob/blob_log_format.cc                                    \
   db/blob/blob_log_sequential_reader.cc                         \
   db/blob/blob_log_writer.cc                                    \
+  db/blob/blob_prefetcher.cc                                    \
+  db/block_cache_hot_set.cc                                     \
   db/builder.cc                                                 \
   db/c.cc                                                       \
   db/column_family.cc                                           \
   db/compaction/compaction.cc                                   \
+  db/compaction/compaction_block_copier.cc                      \
   db/compaction/compaction_iterator.cc                          \
   db/compaction/compaction_job.cc                               \
   db/compaction/compaction_picker.cc                            \
@@ -51,6 +57,7 @@ LIB_SOURCES =                                                   \
   db/flush_job.cc                                               \
   db/flush_scheduler.cc                                         \
   db/forward_iterator.cc                                        \
+  db/hot_key_cache.cc                                           \
   db/import_column_family_job.cc                                \
   db/internal_stats.cc                                          \
   db/logs_with_prep_tracker.cc                                  \
@@ -79,6 +86,7 @@ LIB_SOURCES =                                                   \
   db/wal_manager.cc                                             \
   db/write_batch.cc                                             \
   db/write_batch_base.cc                                        \
+  db/write_batch_pool.cc                                        \
   db/write_controller.cc                                        \
   db/write_thread.cc                                            \
   env/composite_env.cc                                          \
@@ -104,6 +112,7 @@ LIB_SOURCES =                                                   \
   file/sequence_file_reader.cc                                  \
   file/sst_file_manager_impl.cc                                 \
   file/writable_file_writer.cc                                  \
+  logging/async_logger.cc                                       \
   logging/auto_roll_logger.cc                                   \
   logging/event_logger.cc                                       \
   logging/log_buffer.cc                                         \
@@ -111,13 +120,17 @@ LIB_SOURCES =                                                   \
   memory/concurrent_arena.cc                                    \
   memory/jemalloc_nodump_allocator.cc                           \
   memory/memkind_kmem_allocator.cc                              \
+  memory/slab_allocator.cc                                      \
   memtable/alloc_tracker.cc                                     \
+  memtable/hash_indexed_skiplist_rep.cc                         \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
+  memtable/memory_budget.cc                                     \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
   monitoring/histogram.cc                                       \
+  monitoring/histogram_log_linear.cc                            \
   monitoring/histogram_windowing.cc                             \
   monitoring/in_memory_stats_history.cc                         \
   monitoring/instrumented_mutex.cc                              \
@@ -159,6 +172,8 @@ LIB_SOURCES =                                                   \
   table/block_based/block_prefix_index.cc                       \
   table/block_based/data_block_hash_index.cc                    \
   table/block_based/data_block_footer.cc                        \
+  table/block_based/elias_fano_index.cc                         \
+  table/block_based/elias_fano_index_reader.cc                  \
   table/block_based/filter_block_reader_common.cc               \
   table/block_based/filter_policy.cc                            \
   table/block_based/flush_block_policy.cc                       \
@@ -166,7 +181,11 @@ LIB_SOURCES =                                                   \
   table/block_based/hash_index_reader.cc                        \
   table/block_based/index_builder.cc                            \
   table/block_based/index_reader_common.cc                      \
+  table/block_based/key_position_summary.cc                     \
+  table/block_based/learned_index.cc                            \
+  table/block_based/learned_index_reader.cc                     \
   table/block_based/parsed_full_filter_block.cc                 \
+  table/block_based/range_filter_block.cc                       \
   table/block_based/partitioned_filter_block.cc                 \
   table/block_based/partitioned_index_iterator.cc               \
   table/block_based/partitioned_index_reader.cc                 \
@@ -200,12 +219,14 @@ LIB_SOURCES =                                                   \
   tools/dump/db_dump_tool.cc                                    \
   trace_replay/trace_replay.cc                                  \
   trace_replay/block_cache_tracer.cc                            \
+  trace_replay/buffered_trace_writer.cc                         \
   trace_replay/io_tracer.cc                                     \
   util/build_version.cc                                         \
   util/coding.cc                                                \
   util/compaction_job_stats_impl.cc                             \
   util/comparator.cc                                            \
   util/compression_context_cache.cc                             \
+  util/compressor.cc                                            \
   util/concurrent_task_limiter_impl.cc                          \
   util/crc32c.cc                                                \
   util/crc32c_arm64.cc                                          \
@@ -228,6 +249,7 @@ LIB_SOURCES =                                                   \
   utilities/blob_db/blob_db_impl.cc                             \
   utilities/blob_db/blob_db_impl_filesnapshot.cc                \
   utilities/blob_db/blob_file.cc                                \
+  utilities/bulk_loader/bulk_loader.cc                          \
   utilities/cassandra/cassandra_compaction_filter.cc            \
   utilities/cassandra/format.cc                                 \
   utilities/cassandra/merge_operator.cc                         \
@@ -251,18 +273,23 @@ LIB_SOURCES =                                                   \
   utilities/object_registry.cc                                  \
   utilities/option_change_migration/option_change_migration.cc  \
   utilities/options/options_util.cc                             \
+  utilities/parallel_scan/parallel_scan.cc                      \
   utilities/persistent_cache/block_cache_tier.cc                \
   utilities/persistent_cache/block_cache_tier_file.cc           \
   utilities/persistent_cache/block_cache_tier_metadata.cc       \
+  utilities/persistent_cache/persistent_cache_secondary_cache.cc \
   utilities/persistent_cache/persistent_cache_tier.cc           \
   utilities/persistent_cache/volatile_tier_impl.cc              \
+  utilities/sharded_db/sharded_db.cc                            \
   utilities/simulator_cache/cache_simulator.cc                  \
+  utilities/simulator_cache/miss_ratio_curve_cache.cc           \
   utilities/simulator_cache/sim_cache.cc                        \
   utilities/table_properties_collectors/compact_on_deletion_collector.cc \
   utilities/trace/file_trace_reader_writer.cc                   \
   utilities/transactions/lock/lock_manager.cc                   \
   utilities/transactions/lock/point/point_lock_tracker.cc       \
   utilities/transactions/lock/point/point_lock_manager.cc       \
+  utilities/transactions/lock/range/sharded/sharded_range_lock_manager.cc \
   utilities/transactions/optimistic_transaction.cc              \
   utilities/transactions/optimistic_transaction_db_impl.cc      \
   utilities/transactions/pessimistic_transaction.cc             \
@@ -370,6 +397,7 @@ BENCH_MAIN_SOURCES =                                                    \
   cache/cache_bench.cc                                                  \
   db/range_del_aggregator_bench.cc                                      \
   memtable/memtablerep_bench.cc                                         \
+  table/merging_iterator_bench.cc                                       \
   table/table_reader_bench.cc                                           \
   tools/db_bench.cc                                                     \
   util/filter_bench.cc                                                  \
@@ -377,7 +405,9 @@ BENCH_MAIN_SOURCES =                                                    \
   #util/log_write_bench.cc                                               \
 
 TEST_MAIN_SOURCES =                                                     \
+  cache/cache_reservation_manager_test.cc                               \
   cache/cache_test.cc                                                   \
+  cache/compressed_secondary_cache_test.cc                              \
   cache/lru_cache_test.cc                                               \
   db/blob/blob_counting_iterator_test.cc                                \
   db/blob/blob_file_addition_test.cc                                    \
@@ -481,6 +511,7 @@ TEST_MAIN_SOURCES =                                                     \
   logging/event_logger_test.cc                                          \
   memory/arena_test.cc                                                  \
   memory/memkind_kmem_allocator_test.cc                                 \
+  memory/slab_allocator_test.cc                                         \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
@@ -537,6 +568,7 @@ TEST_MAIN_SOURCES =                                                     \
   util/work_queue_test.cc                                               \
   utilities/backupable/backupable_db_test.cc                            \
   utilities/blob_db/blob_db_test.cc                                     \
+  utilities/bulk_loader/bulk_loader_test.cc                             \
   utilities/cassandra/cassandra_format_test.cc                          \
   utilities/cassandra/cassandra_functional_test.cc                      \
   utilities/cassandra/cassandra_row_merge_test.cc                       \
@@ -548,8 +580,10 @@ TEST_MAIN_SOURCES =                                                     \
   utilities/object_registry_test.cc                                     \
   utilities/option_change_migration/option_change_migration_test.cc     \
   utilities/options/options_util_test.cc                                \
+  utilities/parallel_scan/parallel_scan_test.cc                         \
   utilities/persistent_cache/hash_table_test.cc                         \
   utilities/persistent_cache/persistent_cache_test.cc                   \
+  utilities/sharded_db/sharded_db_test.cc                               \
   utilities/simulator_cache/cache_simulator_test.cc                     \
   utilities/simulator_cache/sim_cache_test.cc                           \
   utilities/table_properties_collectors/compact_on_deletion_collector_test.cc  \
@@ -567,6 +601,8 @@ TEST_MAIN_SOURCES_C = \
   db/c_test.c                                                           \
 
 MICROBENCH_SOURCES =                                          \
+  microbench/db_basic_bench.cc                                \
+  microbench/hot_path_bench.cc                                \
   microbench/ribbon_bench.cc                                  \
 
 JNI_NATIVE_SOURCES =                                          \
@@ -21,6 +21,7 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 #include "util/coding.h"
 
@@ -33,10 +34,14 @@ namespace ROCKSDB_NAMESPACE {
 //
 // If any errors are detected, returns nullptr.  Otherwise, returns a
 // pointer to the key delta (just past the three decoded values).
+//
+// `value_in_entry` is false for blocks that store values apart from keys, in
+// which case "limit" only bounds the key delta.
 struct DecodeEntry {
   inline const char* operator()(const char* p, const char* limit,
                                 uint32_t* shared, uint32_t* non_shared,
-                                uint32_t* value_length) {
+                                uint32_t* value_length,
+                                bool value_in_entry = true) {
     // We need 2 bytes for shared and non_shared size. We also need one more
     // byte either for value size or the actual value in case of value delta
     // encoding.
@@ -57,7 +62,9 @@ struct DecodeEntry {
 
     // Using an assert in place of "return null" since we should not pay the
     // cost of checking for corruption on every single key decoding
-    assert(!(static_cast<uint32_t>(limit - p) < (*non_shared + *value_length)));
+    assert(!(static_cast<uint32_t>(limit - p) <
+             (*non_shared + (value_in_entry ? *value_length : 0))));
+    (void)value_in_entry;
     return p;
   }
 };
@@ -67,7 +74,8 @@ struct DecodeEntry {
 struct CheckAndDecodeEntry {
   inline const char* operator()(const char* p, const char* limit,
                                 uint32_t* shared, uint32_t* non_shared,
-                                uint32_t* value_length) {
+                                uint32_t* value_length,
+                                bool value_in_entry = true) {
     // We need 2 bytes for shared and non_shared size. We also need one more
     // byte either for value size or the actual value in case of value delta
     // encoding.
@@ -88,18 +96,64 @@ struct CheckAndDecodeEntry {
       }
     }
 
-    if (static_cast<uint32_t>(limit - p) < (*non_shared + *value_length)) {
+    if (static_cast<uint32_t>(limit - p) <
+        (*non_shared + (value_in_entry ? *value_length : 0))) {
       return nullptr;
     }
     return p;
   }
 };
 
+// Sets `*num_less` and `*num_not_greater` to the number of restart key
+// prefixes (the sorted uint64[num_restarts] array at `prefixes`) that are
+// less than, and not greater than, `target`. This is branch-free. Short
+// arrays, the common case, are counted in one pass that the compiler can
+// vectorize; longer ones are binary searched with conditional moves.
+inline void FindRestartKeyPrefixRange(const char* prefixes,
+                                      uint32_t num_restarts, uint64_t target,
+                                      uint32_t* num_less,
+                                      uint32_t* num_not_greater) {
+  const uint32_t kMaxLinearCount = 32;
+  if (num_restarts <= kMaxLinearCount) {
+    uint32_t less = 0, not_greater = 0;
+    for (uint32_t i = 0; i < num_restarts; i++) {
+      uint64_t prefix = DecodeFixed64(prefixes + i * sizeof(uint64_t));
+      less += prefix < target;
+      not_greater += prefix <= target;
+    }
+    *num_less = less;
+    *num_not_greater = not_greater;
+    return;
+  }
+  // Invariant: the result lies in [base, base + n]
+  uint32_t less_base = 0, not_greater_base = 0;
+  for (uint32_t n = num_restarts; n > 1; n -= n / 2) {
+    uint32_t half = n / 2;
+    uint64_t less_probe =
+        DecodeFixed64(prefixes + (less_base + half) * sizeof(uint64_t));
+    uint64_t not_greater_probe =
+        DecodeFixed64(prefixes + (not_greater_base + half) * sizeof(uint64_t));
+    less_base = less_probe < target ? less_base + half : less_base;
+    not_greater_base = not_greater_probe <= target ? not_greater_base + half
+                                                   : not_greater_base;
+  }
+  *num_less =
+      less_base +
+      (DecodeFixed64(prefixes + less_base * sizeof(uint64_t)) < target);
+  *num_not_greater =
+      not_greater_base +
+      (DecodeFixed64(prefixes + not_greater_base * sizeof(uint64_t)) <=
+       target);
+}
+
 struct DecodeKey {
   inline const char* operator()(const char* p, const char* limit,
                                 uint32_t* shared, uint32_t* non_shared) {
     uint32_t value_length;
-    return DecodeEntry()(p, limit, shared, non_shared, &value_length);
+    // Only the key needs to be within `limit`, so this also works for blocks
+    // that store values apart from keys.
+    return DecodeEntry()(p, limit, shared, non_shared, &value_length,
+                         false /* value_in_entry */);
   }
 };
 
@@ -181,6 +235,9 @@ void DataBlockIter::PrevImpl() {
     const Slice current_key(key_ptr, current_prev_entry.key_size);
 
     current_ = current_prev_entry.offset;
+    // Entries are contiguous, so the current entry ends where the entry we
+    // moved from starts. Only needed when values are stored apart from keys.
+    key_end_ = prev_entries_[prev_entries_idx_ + 1].offset;
     // TODO(ajkr): the copy when `raw_key_cached` is done here for convenience,
     // not necessity. It is convenient since this class treats keys as pinned
     // when `raw_key_` points to an outside buffer. So we cannot allow
@@ -242,7 +299,8 @@ void DataBlockIter::SeekImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  bool ok = BinarySeek<DecodeKey>(seek_key, -1, num_restarts_ - 1, &index,
+                                  &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -273,19 +331,59 @@ void DataBlockIter::SeekImpl(const Slice& target) {
 //    than the seek_user_key, or the block ends with a matching user_key but
 //    with a smaller [ type | seqno ] (i.e. a larger seqno, or the same seqno
 //    but larger type).
+uint32_t DataBlockIter::HashIndexOffset() const {
+  // The hash index follows the restart array, the restart key prefix array,
+  // or the value restart array when values are stored apart from keys.
+  if (value_restarts_ != 0) {
+    return value_restarts_ + num_restarts_ * sizeof(uint32_t);
+  } else if (restart_key_prefixes_ != 0) {
+    return restart_key_prefixes_ + num_restarts_ * sizeof(uint64_t);
+  } else {
+    return restarts_ + num_restarts_ * sizeof(uint32_t);
+  }
+}
+
+void DataBlockIter::PrefetchForGet(const Slice* targets, size_t n) {
+  if (!data_block_hash_index_) {
+    return;
+  }
+  const uint32_t map_offset = HashIndexOffset();
+  // In chunks, so that all the buckets of a chunk are being fetched while the
+  // first is looked up
+  constexpr size_t kChunkSize = 16;
+  uint16_t buckets[kChunkSize];
+  for (size_t begin = 0; begin < n; begin += kChunkSize) {
+    const size_t end = std::min(n, begin + kChunkSize);
+    for (size_t i = begin; i < end; i++) {
+      buckets[i - begin] =
+          data_block_hash_index_->Bucket(ExtractUserKey(targets[i]));
+      PREFETCH(data_block_hash_index_->BucketAddress(data_, map_offset,
+                                                     buckets[i - begin]),
+               0 /* rw */, 1 /* locality */);
+    }
+    for (size_t i = begin; i < end; i++) {
+      const uint16_t entry = data_block_hash_index_->LookupBucket(
+          data_, map_offset, buckets[i - begin]);
+      if (entry < num_restarts_) {
+        PREFETCH(data_ + GetRestartPoint(entry), 0 /* rw */, 1 /* locality */);
+      }
+    }
+  }
+}
+
 bool DataBlockIter::SeekForGetImpl(const Slice& target) {
   Slice target_user_key = ExtractUserKey(target);
-  uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
-  uint8_t entry =
+  uint32_t map_offset = HashIndexOffset();
+  uint16_t entry =
       data_block_hash_index_->Lookup(data_, map_offset, target_user_key);
 
-  if (entry == kCollision) {
+  if (entry == kWideCollision) {
     // HashSeek not effective, falling back
     SeekImpl(target);
     return true;
   }
 
-  if (entry == kNoEntry) {
+  if (entry == kWideNoEntry) {
     // Even if we cannot find the user_key in this block, the result may
     // exist in the next block. Consider this example:
     //
@@ -301,7 +399,7 @@ bool DataBlockIter::SeekForGetImpl(const Slice& target) {
     // The while-loop below will search the last restart interval for the
     // key. It will stop at the first key that is larger than the seek_key,
     // or to the end of the block if no one is larger.
-    entry = static_cast<uint8_t>(num_restarts_ - 1);
+    entry = static_cast<uint16_t>(num_restarts_ - 1);
   }
 
   uint32_t restart_index = entry;
@@ -396,10 +494,19 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
     // restart interval must be one when hash search is enabled so the binary
     // search simply lands at the right place.
     skip_linear_scan = true;
-  } else if (value_delta_encoded_) {
-    ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan);
   } else {
-    ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+    int64_t left = -1, right = num_restarts_ - 1;
+    if (learned_index_ != nullptr &&
+        !LearnedIndexSeekRange(seek_key, &left, &right)) {
+      return;
+    }
+    if (value_delta_encoded_) {
+      ok = BinarySeek<DecodeKeyV4>(seek_key, left, right, &index,
+                                   &skip_linear_scan);
+    } else {
+      ok = BinarySeek<DecodeKey>(seek_key, left, right, &index,
+                                 &skip_linear_scan);
+    }
   }
 
   if (!ok) {
@@ -416,7 +523,8 @@ void DataBlockIter::SeekForPrevImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  bool ok = BinarySeek<DecodeKey>(seek_key, -1, num_restarts_ - 1, &index,
+                                  &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -504,8 +612,12 @@ bool DataBlockIter::ParseNextDataKey(const char* limit) {
 
   // Decode next entry
   uint32_t shared, non_shared, value_length;
-  p = DecodeEntryFunc()(p, limit, &shared, &non_shared, &value_length);
-  if (p == nullptr || raw_key_.Size() < shared) {
+  p = DecodeEntryFunc()(p, limit, &shared, &non_shared, &value_length,
+                        value_restarts_ == 0 /* value_in_entry */);
+  if (p == nullptr || raw_key_.Size() < shared ||
+      (value_restarts_ != 0 &&
+       value_length > static_cast<uint32_t>(data_ + value_restarts_ -
+                                            (value_.data() + value_.size())))) {
     CorruptionError();
     return false;
   } else {
@@ -535,7 +647,14 @@ bool DataBlockIter::ParseNextDataKey(const char* limit) {
     }
 #endif  // NDEBUG
 
-    value_ = Slice(p + non_shared, value_length);
+    if (value_restarts_ != 0) {
+      // The value follows the value of the previous entry, or was located by
+      // SeekToRestartPoint()
+      key_end_ = static_cast<uint32_t>(p + non_shared - data_);
+      value_ = Slice(value_.data() + value_.size(), value_length);
+    } else {
+      value_ = Slice(p + non_shared, value_length);
+    }
     if (shared == 0) {
       while (restart_index_ + 1 < num_restarts_ &&
              GetRestartPoint(restart_index_ + 1) < current_) {
@@ -674,8 +793,10 @@ void BlockIter<TValue>::FindKeyAfterBinarySeek(const Slice& target,
 }
 
 // Binary searches in restart array to find the starting restart point for the
-// linear scan, and stores it in `*index`. Assumes restart array does not
-// contain duplicate keys. It is guaranteed that the restart key at `*index + 1`
+// linear scan, and stores it in `*index`. The search starts from the range
+// (`left`, `right`]; the caller must make sure the restart key at `left` (if
+// any) is less than or equal to `target` and the ones after `right` are
+// strictly greater. Assumes restart array does not contain duplicate keys. It is guaranteed that the restart key at `*index + 1`
 // is strictly greater than `target` or does not exist (this can be used to
 // elide a comparison when linear scan reaches all the way to the next restart
 // key). Furthermore, `*skip_linear_scan` is set to indicate whether the
@@ -683,7 +804,8 @@ void BlockIter<TValue>::FindKeyAfterBinarySeek(const Slice& target,
 // compared again later.
 template <class TValue>
 template <typename DecodeKeyFunc>
-bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
+bool BlockIter<TValue>::BinarySeek(const Slice& target, int64_t left,
+                                   int64_t right, uint32_t* index,
                                    bool* skip_linear_scan) {
   if (restarts_ == 0) {
     // SST files dedicated to range tombstones are written with index blocks
@@ -702,7 +824,17 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   //   keys.
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
-  int64_t left = -1, right = num_restarts_ - 1;
+  if (use_restart_key_prefixes_) {
+    // Restart keys with a smaller prefix than the target are less than the
+    // target, and those with a greater prefix are greater, so only the
+    // restart points with an equal prefix are left for the search below.
+    uint32_t num_less, num_not_greater;
+    FindRestartKeyPrefixRange(data_ + restart_key_prefixes_, num_restarts_,
+                              RestartKeyPrefix(ExtractUserKey(target)),
+                              &num_less, &num_not_greater);
+    left = std::max(left, static_cast<int64_t>(num_less) - 1);
+    right = std::min(right, static_cast<int64_t>(num_not_greater) - 1);
+  }
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -742,6 +874,35 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   return true;
 }
 
+bool IndexBlockIter::LearnedIndexSeekRange(const Slice& target,
+                                           int64_t* left, int64_t* right) {
+  assert(learned_index_ != nullptr);
+  if (restarts_ == 0) {
+    return true;
+  }
+  uint32_t first, last;
+  if (!learned_index_->Predict(
+          raw_key_.IsUserKey() ? target : ExtractUserKey(target), &first,
+          &last)) {
+    return true;
+  }
+  if (first > 0) {
+    if (CompareBlockKey(first, target) > 0) {
+      *right = static_cast<int64_t>(first) - 1;
+      return status_.ok();
+    }
+    *left = first;
+  }
+  if (static_cast<int64_t>(last) < *right) {
+    if (CompareBlockKey(last + 1, target) > 0) {
+      *right = last;
+    } else {
+      *left = static_cast<int64_t>(last) + 1;
+    }
+  }
+  return status_.ok();
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
@@ -885,7 +1046,10 @@ uint32_t Block::NumRestarts() const {
     // Such check is for backward compatibility. We can ensure legacy block
     // with a vary large num_restarts i.e. >= 0x80000000 can be interpreted
     // correctly as no HashIndex even if the MSB of num_restarts is set.
-    return num_restarts;
+    //
+    // kSeparateKeyValueBit and kRestartKeyPrefixesBit can be set regardless
+    // of the block size.
+    return num_restarts & ~(kSeparateKeyValueBit | kRestartKeyPrefixesBit);
   }
   BlockBasedTableOptions::DataBlockIndexType index_type;
   UnPackIndexTypeAndNumRestarts(block_footer, &index_type, &num_restarts);
@@ -917,6 +1081,8 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
       data_(contents_.data.data()),
       size_(contents_.data.size()),
       restart_offset_(0),
+      value_restart_offset_(0),
+      restart_key_prefixes_offset_(0),
       num_restarts_(0) {
   TEST_SYNC_POINT("Block::Block:0");
   if (size_ < sizeof(uint32_t)) {
@@ -941,13 +1107,17 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
           break;
         }
 
+        bool wide_hash_index;
+        UnPackIndexTypeAndNumRestarts(
+            DecodeFixed32(data_ + size_ - sizeof(uint32_t)), nullptr, nullptr,
+            nullptr, nullptr, &wide_hash_index);
         uint16_t map_offset;
         data_block_hash_index_.Initialize(
             contents.data.data(),
             static_cast<uint16_t>(contents.data.size() -
                                   sizeof(uint32_t)), /*chop off
                                                  NUM_RESTARTS*/
-            &map_offset);
+            &map_offset, wide_hash_index);
 
         restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t);
 
@@ -961,10 +1131,50 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
       default:
         size_ = 0;  // Error marker
     }
+    bool separate_key_value = false;
+    bool restart_key_prefixes = false;
+    if (size_ != 0) {
+      UnPackIndexTypeAndNumRestarts(
+          DecodeFixed32(data_ + size_ - sizeof(uint32_t)), nullptr, nullptr,
+          &separate_key_value, &restart_key_prefixes);
+    }
+    if ((separate_key_value || restart_key_prefixes) && num_restarts_ != 0) {
+      // So far restart_offset_ assumes that the restart array directly
+      // precedes the hash index or footer. Find where it really ends.
+      size_t restarts_end =
+          restart_offset_ + num_restarts_ * sizeof(uint32_t);
+      if (separate_key_value) {
+        // What precedes the hash index or footer is the value restart array.
+        // The values start right after the restart array (and restart key
+        // prefixes), so the first value restart tells where those end.
+        value_restart_offset_ = restart_offset_;
+        restarts_end = DecodeFixed32(data_ + value_restart_offset_);
+        if (restarts_end > value_restart_offset_) {
+          size_ = 0;
+        }
+      }
+      if (restart_key_prefixes) {
+        if (restarts_end < num_restarts_ * sizeof(uint64_t)) {
+          size_ = 0;
+        } else {
+          restarts_end -= num_restarts_ * sizeof(uint64_t);
+          restart_key_prefixes_offset_ = static_cast<uint32_t>(restarts_end);
+        }
+      }
+      if (restarts_end < num_restarts_ * sizeof(uint32_t)) {
+        size_ = 0;
+      } else {
+        restart_offset_ = static_cast<uint32_t>(
+            restarts_end - num_restarts_ * sizeof(uint32_t));
+      }
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
+    // Keys and values lie before the value restart array when values are
+    // stored apart from keys
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
-        restart_offset_, read_amp_bytes_per_bit, statistics));
+        value_restart_offset_ != 0 ? value_restart_offset_ : restart_offset_,
+        read_amp_bytes_per_bit, statistics));
   }
 }
 
@@ -988,8 +1198,8 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
     return ret_iter;
   } else {
     ret_iter->Initialize(
-        raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
-        read_amp_bitmap_.get(), block_contents_pinned,
+        raw_ucmp, data_, restart_offset_, num_restarts_, value_restart_offset_,
+        restart_key_prefixes_offset_, global_seqno, read_amp_bitmap_.get(), block_contents_pinned,
         data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
@@ -1006,7 +1216,8 @@ IndexBlockIter* Block::NewIndexIterator(
     const Comparator* raw_ucmp, SequenceNumber global_seqno,
     IndexBlockIter* iter, Statistics* /*stats*/, bool total_order_seek,
     bool have_first_key, bool key_includes_seq, bool value_is_full,
-    bool block_contents_pinned, BlockPrefixIndex* prefix_index) {
+    bool block_contents_pinned, BlockPrefixIndex* prefix_index,
+    const LearnedIndexModel* learned_index) {
   IndexBlockIter* ret_iter;
   if (iter != nullptr) {
     ret_iter = iter;
@@ -1024,9 +1235,14 @@ IndexBlockIter* Block::NewIndexIterator(
   } else {
     BlockPrefixIndex* prefix_index_ptr =
         total_order_seek ? nullptr : prefix_index;
+    if (learned_index != nullptr &&
+        learned_index->num_restarts() != num_restarts_) {
+      // Not built for this block
+      learned_index = nullptr;
+    }
     ret_iter->Initialize(raw_ucmp, data_, restart_offset_, num_restarts_,
-                         global_seqno, prefix_index_ptr, have_first_key,
-                         key_includes_seq, value_is_full,
+                         global_seqno, prefix_index_ptr, learned_index,
+                         have_first_key, key_includes_seq, value_is_full,
                          block_contents_pinned);
   }
 
@@ -16,6 +16,7 @@
 #include "db/dbformat.h"
 #include "db/pinned_iterators_manager.h"
 #include "port/malloc.h"
+#include "rocksdb/comparator.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/statistics.h"
@@ -35,6 +36,7 @@ template <class TValue>
 class BlockIter;
 class DataBlockIter;
 class IndexBlockIter;
+class LearnedIndexModel;
 class BlockPrefixIndex;
 
 // BlockReadAmpBitmap is a bitmap that map the ROCKSDB_NAMESPACE::Block data
@@ -204,6 +206,9 @@ class Block {
   // If `prefix_index` is not nullptr this block will do hash lookup for the key
   // prefix. If total_order_seek is true, prefix_index_ is ignored.
   //
+  // If `learned_index` is not nullptr it narrows down the binary search over
+  // the restart keys. It must have been built for this block.
+  //
   // `have_first_key` controls whether IndexValue will contain
   // first_internal_key. It affects data serialization format, so the same value
   // have_first_key must be used when writing and reading index.
@@ -214,7 +219,9 @@ class Block {
                                    bool total_order_seek, bool have_first_key,
                                    bool key_includes_seq, bool value_is_full,
                                    bool block_contents_pinned = false,
-                                   BlockPrefixIndex* prefix_index = nullptr);
+                                   BlockPrefixIndex* prefix_index = nullptr,
+                                   const LearnedIndexModel* learned_index =
+                                       nullptr);
 
   // Report an approximation of how much memory has been used.
   size_t ApproximateMemoryUsage() const;
@@ -224,6 +231,12 @@ class Block {
   const char* data_;         // contents_.data.data()
   size_t size_;              // contents_.data.size()
   uint32_t restart_offset_;  // Offset in data_ of restart array
+  // Offset in data_ of value restart array if values are stored apart from
+  // keys, otherwise 0
+  uint32_t value_restart_offset_;
+  // Offset in data_ of restart key prefix array if the block has one,
+  // otherwise 0
+  uint32_t restart_key_prefixes_offset_;
   uint32_t num_restarts_;
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
   DataBlockHashIndex data_block_hash_index_;
@@ -263,6 +276,10 @@ class BlockIter : public InternalIteratorBase<TValue> {
     num_restarts_ = num_restarts;
     current_ = restarts_;
     restart_index_ = num_restarts_;
+    value_restarts_ = 0;
+    restart_key_prefixes_ = 0;
+    use_restart_key_prefixes_ = false;
+    key_end_ = restarts_;
     global_seqno_ = global_seqno;
     block_contents_pinned_ = block_contents_pinned;
     cache_handle_ = nullptr;
@@ -363,8 +380,19 @@ class BlockIter : public InternalIteratorBase<TValue> {
   // Index of restart block in which current_ or current_-1 falls
   uint32_t restart_index_;
   uint32_t restarts_;  // Offset of restart array (list of fixed32)
+  // Offset of value restart array (list of fixed32) if values are stored
+  // apart from keys, otherwise 0
+  uint32_t value_restarts_;
+  // Offset of restart key prefix array (list of fixed64) if the block has
+  // one, otherwise 0
+  uint32_t restart_key_prefixes_;
+  // Whether BinarySeek() uses the restart key prefixes
+  bool use_restart_key_prefixes_;
   // current_ is offset in data_ of current entry.  >= restarts_ if !Valid
   uint32_t current_;
+  // Offset in data_ just past the key of the current entry. Only maintained
+  // when value_restarts_ != 0; otherwise the entry ends with its value.
+  uint32_t key_end_;
   // Raw key from block.
   IterKey raw_key_;
   // Buffer for key data when global seqno assignment is enabled.
@@ -442,6 +470,9 @@ class BlockIter : public InternalIteratorBase<TValue> {
  public:
   // Return the offset in data_ just past the end of the current entry.
   inline uint32_t NextEntryOffset() const {
+    if (value_restarts_ != 0) {
+      return key_end_;
+    }
     // NOTE: We don't support blocks bigger than 2GB
     return static_cast<uint32_t>((value_.data() + value_.size()) - data_);
   }
@@ -458,6 +489,12 @@ class BlockIter : public InternalIteratorBase<TValue> {
 
     // ParseNextKey() starts at the end of value_, so set value_ accordingly
     uint32_t offset = GetRestartPoint(index);
+    if (value_restarts_ != 0) {
+      // The key starts at key_end_ and the value at the end of value_
+      key_end_ = offset;
+      offset =
+          DecodeFixed32(data_ + value_restarts_ + index * sizeof(uint32_t));
+    }
     value_ = Slice(data_ + offset, 0);
   }
 
@@ -465,8 +502,8 @@ class BlockIter : public InternalIteratorBase<TValue> {
 
  protected:
   template <typename DecodeKeyFunc>
-  inline bool BinarySeek(const Slice& target, uint32_t* index,
-                         bool* is_index_key_result);
+  inline bool BinarySeek(const Slice& target, int64_t left, int64_t right,
+                         uint32_t* index, bool* is_index_key_result);
 
   void FindKeyAfterBinarySeek(const Slice& target, uint32_t index,
                               bool is_index_key_result);
@@ -477,21 +514,32 @@ class DataBlockIter final : public BlockIter<Slice> {
   DataBlockIter()
       : BlockIter(), read_amp_bitmap_(nullptr), last_bitmap_offset_(0) {}
   DataBlockIter(const Comparator* raw_ucmp, const char* data, uint32_t restarts,
-                uint32_t num_restarts, SequenceNumber global_seqno,
+                uint32_t num_restarts, uint32_t value_restarts,
+                uint32_t restart_key_prefixes, SequenceNumber global_seqno,
                 BlockReadAmpBitmap* read_amp_bitmap, bool block_contents_pinned,
                 DataBlockHashIndex* data_block_hash_index)
       : DataBlockIter() {
-    Initialize(raw_ucmp, data, restarts, num_restarts, global_seqno,
-               read_amp_bitmap, block_contents_pinned, data_block_hash_index);
+    Initialize(raw_ucmp, data, restarts, num_restarts, value_restarts,
+               restart_key_prefixes, global_seqno, read_amp_bitmap,
+               block_contents_pinned, data_block_hash_index);
   }
+  // value_restarts is the offset of the value restart array if values are
+  // stored apart from keys, otherwise 0. restart_key_prefixes is the offset
+  // of the restart key prefix array if the block has one, otherwise 0.
   void Initialize(const Comparator* raw_ucmp, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
+                  uint32_t value_restarts, uint32_t restart_key_prefixes,
                   SequenceNumber global_seqno,
                   BlockReadAmpBitmap* read_amp_bitmap,
                   bool block_contents_pinned,
                   DataBlockHashIndex* data_block_hash_index) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned);
+    value_restarts_ = value_restarts;
+    restart_key_prefixes_ = restart_key_prefixes;
+    // Restart key prefixes are only written with BytewiseComparator
+    use_restart_key_prefixes_ =
+        restart_key_prefixes != 0 && raw_ucmp == BytewiseComparator();
     raw_key_.SetIsUserKey(false);
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
@@ -504,11 +552,22 @@ class DataBlockIter final : public BlockIter<Slice> {
         current_ != last_bitmap_offset_) {
       read_amp_bitmap_->Mark(current_ /* current entry offset */,
                              NextEntryOffset() - 1);
+      if (value_restarts_ != 0 && !value_.empty()) {
+        read_amp_bitmap_->Mark(ValueOffset(),
+                               ValueOffset() +
+                                   static_cast<uint32_t>(value_.size()) - 1);
+      }
       last_bitmap_offset_ = current_;
     }
     return value_;
   }
 
+  // Prefetches the hash index buckets, and then the restart intervals, that
+  // SeekForGet() on each of `targets` will read, so that their cache misses
+  // overlap instead of being taken one after the other. A no-op without a
+  // hash index.
+  void PrefetchForGet(const Slice* targets, size_t n);
+
   inline bool SeekForGet(const Slice& target) {
     if (!data_block_hash_index_) {
       SeekImpl(target);
@@ -586,6 +645,7 @@ class DataBlockIter final : public BlockIter<Slice> {
   template <typename DecodeEntryFunc>
   inline bool ParseNextDataKey(const char* limit = nullptr);
 
+  uint32_t HashIndexOffset() const;
   bool SeekForGetImpl(const Slice& target);
   void NextOrReportImpl();
   void SeekToFirstOrReportImpl();
@@ -593,7 +653,8 @@ class DataBlockIter final : public BlockIter<Slice> {
 
 class IndexBlockIter final : public BlockIter<IndexValue> {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(), prefix_index_(nullptr), learned_index_(nullptr) {}
 
   // key_includes_seq, default true, means that the keys are in internal key
   // format.
@@ -602,12 +663,14 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   void Initialize(const Comparator* raw_ucmp, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
                   SequenceNumber global_seqno, BlockPrefixIndex* prefix_index,
-                  bool have_first_key, bool key_includes_seq,
-                  bool value_is_full, bool block_contents_pinned) {
+                  const LearnedIndexModel* learned_index, bool have_first_key,
+                  bool key_includes_seq, bool value_is_full,
+                  bool block_contents_pinned) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts,
                    kDisableGlobalSequenceNumber, block_contents_pinned);
     raw_key_.SetIsUserKey(!key_includes_seq);
     prefix_index_ = prefix_index;
+    learned_index_ = learned_index;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -675,6 +738,7 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  const LearnedIndexModel* learned_index_;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -709,6 +773,12 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                             uint32_t left, uint32_t right, uint32_t* index,
                             bool* prefix_may_exist);
   inline int CompareBlockKey(uint32_t block_index, const Slice& target);
+  // Narrows the BinarySeek() range [*left, *right] for `target` down to the
+  // restart points predicted by learned_index_. The prediction is checked
+  // against the restart keys, so it never excludes the result. Returns false
+  // on corruption.
+  bool LearnedIndexSeekRange(const Slice& target, int64_t* left,
+                             int64_t* right);
 
   inline bool ParseNextIndexKey();
 
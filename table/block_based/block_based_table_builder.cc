@@ -13,6 +13,7 @@
 #include <stdio.h>
 
 #include <atomic>
+#include <cmath>
 #include <list>
 #include <map>
 #include <memory>
@@ -39,7 +40,9 @@
 #include "table/block_based/filter_block.h"
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
+#include "table/block_based/key_position_summary.h"
 #include "table/block_based/partitioned_filter_block.h"
+#include "table/block_based/range_filter_block.h"
 #include "table/format.h"
 #include "table/table_builder.h"
 #include "util/coding.h"
@@ -54,6 +57,8 @@ namespace ROCKSDB_NAMESPACE {
 
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kRangeFilterBlock;
+extern const std::string kKeyPositionSummaryBlock;
 
 
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
@@ -104,6 +109,89 @@ bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
   return compressed_size < raw_size - (raw_size / 8u);
 }
 
+// Adaptive compression samples all of a block up to this size, and else
+// kAdaptiveSampleChunks evenly spaced chunks adding up to it
+const size_t kAdaptiveSampleSize = 4096;
+const size_t kAdaptiveSampleChunks = 16;
+// Smaller samples overestimate compressibility too much to go by
+const size_t kAdaptiveMinSampleSize = 1024;
+// Entropies, in bits per byte, from which blocks are taken as
+// incompressible, and as only moderately compressible
+const double kIncompressibleEntropy = 7.5;
+const double kModeratelyCompressibleEntropy = 5.5;
+
+// The entropy, in bits per byte, of the byte values of a sample of `raw`
+double SampledByteEntropy(const Slice& raw) {
+  uint32_t counts[256] = {};
+  size_t sampled = 0;
+  auto count = [&](const char* data, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      ++counts[static_cast<unsigned char>(data[i])];
+    }
+    sampled += n;
+  };
+  if (raw.size() <= kAdaptiveSampleSize) {
+    count(raw.data(), raw.size());
+  } else {
+    const size_t chunk_size = kAdaptiveSampleSize / kAdaptiveSampleChunks;
+    const size_t stride =
+        (raw.size() - chunk_size) / (kAdaptiveSampleChunks - 1);
+    for (size_t i = 0; i < kAdaptiveSampleChunks; ++i) {
+      count(raw.data() + i * stride, chunk_size);
+    }
+  }
+  double entropy = 0;
+  for (uint32_t c : counts) {
+    if (c > 0) {
+      const double p = static_cast<double>(c) / sampled;
+      entropy -= p * std::log2(p);
+    }
+  }
+  return entropy;
+}
+
+bool IsSlowCompression(CompressionType type) {
+  switch (type) {
+    case kZlibCompression:
+    case kBZip2Compression:
+    case kLZ4HCCompression:
+    case kXpressCompression:
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// The compression for a data block with BlockBasedTableOptions::
+// adaptive_compression, where `configured` is not kNoCompression
+CompressionType ChooseAdaptiveCompression(const Slice& raw,
+                                          CompressionType configured,
+                                          bool has_dict,
+                                          Statistics* statistics) {
+  if (raw.size() >= kAdaptiveMinSampleSize) {
+    const double entropy = SampledByteEntropy(raw);
+    if (entropy >= kIncompressibleEntropy) {
+      RecordTick(statistics, ADAPTIVE_COMPRESSION_SKIPPED);
+      return kNoCompression;
+    }
+    // The dictionary was built for the configured compression
+    if (entropy >= kModeratelyCompressibleEntropy && !has_dict &&
+        IsSlowCompression(configured)) {
+      CompressionType fast = LZ4_Supported()      ? kLZ4Compression
+                             : Snappy_Supported() ? kSnappyCompression
+                                                  : kNoCompression;
+      if (fast != kNoCompression) {
+        RecordTick(statistics, ADAPTIVE_COMPRESSION_FAST);
+        return fast;
+      }
+    }
+  }
+  RecordTick(statistics, ADAPTIVE_COMPRESSION_CONFIGURED);
+  return configured;
+}
+
 }  // namespace
 
 // format_version is the block format as defined in include/rocksdb/table.h
@@ -260,6 +348,8 @@ struct BlockBasedTableBuilder::Rep {
   // compressing any data blocks.
   std::vector<std::string> data_block_buffers;
   BlockBuilder range_del_block;
+  std::unique_ptr<RangeFilterBlockBuilder> range_filter_builder;
+  std::unique_ptr<KeyPositionSummaryBuilder> key_position_builder;
 
   InternalKeySliceTransform internal_prefix_transform;
   std::unique_ptr<IndexBuilder> index_builder;
@@ -279,6 +369,10 @@ struct BlockBasedTableBuilder::Rep {
   std::vector<std::unique_ptr<CompressionContext>> compression_ctxs;
   std::vector<std::unique_ptr<UncompressionContext>> verify_ctxs;
   std::unique_ptr<UncompressionDict> verify_dict;
+  // Where the dictionary built for this file is kept for the following
+  // files, if CompressionOptions::max_dict_reuse_seconds is set
+  CompressionDictReuseCache* dict_reuse_cache = nullptr;
+  int level_at_creation;
 
   size_t data_begin_offset = 0;
 
@@ -320,6 +414,9 @@ struct BlockBasedTableBuilder::Rep {
   size_t compressed_cache_key_prefix_size;
 
   BlockHandle pending_handle;  // Handle to add to index block
+  // The last data block was added by AddRawDataBlock() and its index entry,
+  // for pending_handle, is not added yet
+  bool raw_block_pending_index_entry = false;
 
   std::string compressed_output;
   std::unique_ptr<FlushBlockPolicy> flush_block_policy;
@@ -341,6 +438,14 @@ struct BlockBasedTableBuilder::Rep {
   uint64_t get_offset() { return offset.load(std::memory_order_relaxed); }
   void set_offset(uint64_t o) { offset.store(o, std::memory_order_relaxed); }
 
+  void SetCompressionDict(const std::string& dict) {
+    compression_dict.reset(
+        new CompressionDict(dict, compression_type, compression_opts.level));
+    verify_dict.reset(new UncompressionDict(
+        dict, compression_type == kZSTD ||
+                  compression_type == kZSTDNotFinalCompression));
+  }
+
   bool IsParallelCompressionEnabled() const {
     return compression_opts.parallel_threads > 1;
   }
@@ -419,7 +524,12 @@ struct BlockBasedTableBuilder::Rep {
                            ->CanKeysWithDifferentByteContentsBeEqual()
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
-                   table_options.data_block_hash_table_util_ratio),
+                   table_options.data_block_hash_table_util_ratio,
+                   table_options.separate_key_value_in_data_block,
+                   table_options.restart_key_prefixes_in_data_block &&
+                       tbo.internal_comparator.user_comparator() ==
+                           BytewiseComparator(),
+                   table_options.wide_data_block_hash_index),
         range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(tbo.moptions.prefix_extractor.get()),
         compression_type(tbo.compression_type),
@@ -434,6 +544,7 @@ struct BlockBasedTableBuilder::Rep {
         compression_ctxs(tbo.compression_opts.parallel_threads),
         verify_ctxs(tbo.compression_opts.parallel_threads),
         verify_dict(),
+        level_at_creation(tbo.level_at_creation),
         state((tbo.compression_opts.max_dict_bytes > 0) ? State::kBuffered
                                                         : State::kUnbuffered),
         use_delta_encoding_for_index_values(table_opt.format_version >= 4 &&
@@ -500,6 +611,8 @@ struct BlockBasedTableBuilder::Rep {
         filter_context.num_levels = ioptions.num_levels;
         filter_context.level_at_creation = tbo.level_at_creation;
         filter_context.is_bottommost = tbo.is_bottommost;
+        filter_context.level_bytes = tbo.level_bytes;
+        filter_context.num_level0_files = tbo.num_level0_files;
         assert(filter_context.level_at_creation < filter_context.num_levels);
       }
 
@@ -508,6 +621,16 @@ struct BlockBasedTableBuilder::Rep {
           use_delta_encoding_for_index_values, p_index_builder_));
     }
 
+    if (table_options.range_filter_prefix_len > 0 &&
+        internal_comparator.user_comparator() == BytewiseComparator()) {
+      range_filter_builder.reset(
+          new RangeFilterBlockBuilder(table_options.range_filter_prefix_len));
+    }
+    if (table_options.key_position_samples > 0) {
+      key_position_builder.reset(
+          new KeyPositionSummaryBuilder(table_options.key_position_samples));
+    }
+
     assert(tbo.int_tbl_prop_collector_factories);
     for (auto& factory : *tbo.int_tbl_prop_collector_factories) {
       assert(factory);
@@ -577,6 +700,8 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     size_t size_;
   };
   std::unique_ptr<Keys> curr_block_keys;
+  // The values of curr_block_keys, only with collectors_in_key_stage
+  std::unique_ptr<Keys> curr_block_values;
 
   class BlockRepSlot;
 
@@ -590,8 +715,15 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     CompressionType compression_type;
     std::unique_ptr<std::string> first_key_in_next_block;
     std::unique_ptr<Keys> keys;
+    // The values of keys, if the key stage notifies the table properties
+    // collectors of them. Empty for the blocks replayed by EnterUnbuffered(),
+    // the keys of which the collectors were notified of by Add().
+    std::unique_ptr<Keys> values;
     std::unique_ptr<BlockRepSlot> slot;
     Status status;
+    // The number of threads, the write thread and possibly the key thread,
+    // yet to be done with the block before it is recycled
+    std::atomic<int> stages_pending;
   };
   // Use a vector of BlockRep as a buffer for a determined number
   // of BlockRep structures. All data referenced by pointers in
@@ -636,6 +768,24 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
   WriteQueue write_queue;
   std::unique_ptr<port::Thread> write_thread;
 
+  // The key thread adds the keys of the blocks, in order, to the full filter
+  // and notifies the table properties collectors of them, off the thread
+  // calling Add() and the write thread. Partitioned and block-based filters
+  // stay with the write thread, as they follow the index partitions and
+  // the block offsets respectively.
+  typedef WorkQueue<BlockRep*> KeyQueue;
+  KeyQueue key_queue;
+  std::unique_ptr<port::Thread> key_thread;
+  bool filter_in_key_stage = false;
+  bool collectors_in_key_stage = false;
+  // Range deletions added while the key thread may notify the collectors,
+  // for Finish() to notify them of once it stopped
+  std::vector<std::pair<std::string, std::string>> deferred_range_dels;
+
+  bool HasKeyStage() const {
+    return filter_in_key_stage || collectors_in_key_stage;
+  }
+
   // Estimate output file size when parallel compression is enabled. This is
   // necessary because compression & flush are no longer synchronized,
   // and BlockBasedTableBuilder::FileSize() is no longer accurate.
@@ -748,10 +898,12 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
 
   explicit ParallelCompressionRep(uint32_t parallel_threads)
       : curr_block_keys(new Keys()),
+        curr_block_values(new Keys()),
         block_rep_buf(parallel_threads),
         block_rep_pool(parallel_threads),
         compress_queue(parallel_threads),
         write_queue(parallel_threads),
+        key_queue(parallel_threads),
         first_block_processed(false) {
     for (uint32_t i = 0; i < parallel_threads; i++) {
       block_rep_buf[i].contents = Slice();
@@ -761,6 +913,7 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
       block_rep_buf[i].compression_type = CompressionType();
       block_rep_buf[i].first_key_in_next_block.reset(new std::string());
       block_rep_buf[i].keys.reset(new Keys());
+      block_rep_buf[i].values.reset(new Keys());
       block_rep_buf[i].slot.reset(new BlockRepSlot());
       block_rep_buf[i].status = Status::OK();
       block_rep_pool.push(&block_rep_buf[i]);
@@ -781,6 +934,8 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     block_rep->contents = *(block_rep->data);
     std::swap(block_rep->keys, curr_block_keys);
     curr_block_keys->Clear();
+    std::swap(block_rep->values, curr_block_values);
+    curr_block_values->Clear();
     return block_rep;
   }
 
@@ -795,6 +950,7 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     std::swap(*(block_rep->data), *data_block);
     block_rep->contents = *(block_rep->data);
     block_rep->keys->SwapAssign(*keys);
+    block_rep->values->Clear();
     return block_rep;
   }
 
@@ -802,9 +958,14 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
   void EmitBlock(BlockRep* block_rep) {
     assert(block_rep != nullptr);
     assert(block_rep->status.ok());
+    block_rep->stages_pending.store(HasKeyStage() ? 2 : 1,
+                                    std::memory_order_relaxed);
     if (!write_queue.push(block_rep->slot.get())) {
       return;
     }
+    if (HasKeyStage() && !key_queue.push(block_rep)) {
+      return;
+    }
     if (!compress_queue.push(block_rep)) {
       return;
     }
@@ -817,6 +978,15 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     }
   }
 
+  // Called by the write thread and the key thread once done with a block,
+  // recycling it after the last of them
+  void FinishBlockStage(BlockRep* block_rep) {
+    if (block_rep->stages_pending.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+      ReapBlock(block_rep);
+    }
+  }
+
   // Reap a block from compression thread
   void ReapBlock(BlockRep* block_rep) {
     assert(block_rep != nullptr);
@@ -854,7 +1024,7 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
 
 BlockBasedTableBuilder::BlockBasedTableBuilder(
     const BlockBasedTableOptions& table_options, const TableBuilderOptions& tbo,
-    WritableFileWriter* file) {
+    WritableFileWriter* file, CompressionDictReuseCache* dict_reuse_cache) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   if (sanitized_table_options.format_version == 0 &&
       sanitized_table_options.checksum != kCRC32c) {
@@ -869,6 +1039,21 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
 
   rep_ = new Rep(sanitized_table_options, tbo, file);
 
+  if (rep_->state == Rep::State::kBuffered && dict_reuse_cache != nullptr &&
+      tbo.compression_opts.max_dict_reuse_seconds > 0) {
+    rep_->dict_reuse_cache = dict_reuse_cache;
+    std::string dict;
+    if (dict_reuse_cache->Lookup(
+            rep_->column_family_id, rep_->level_at_creation,
+            rep_->compression_type, tbo.compression_opts.max_dict_bytes,
+            tbo.ioptions.clock->NowMicros(),
+            tbo.compression_opts.max_dict_reuse_seconds * 1000000, &dict)) {
+      // Nothing to buffer or train
+      rep_->SetCompressionDict(dict);
+      rep_->state = Rep::State::kUnbuffered;
+    }
+  }
+
   if (rep_->filter_builder != nullptr) {
     rep_->filter_builder->StartBlock(0);
   }
@@ -898,6 +1083,12 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     }
 #endif  // !NDEBUG
 
+    if (r->raw_block_pending_index_entry) {
+      assert(r->data_block.empty());
+      r->index_builder->AddIndexEntry(&r->last_key, &key, r->pending_handle);
+      r->raw_block_pending_index_entry = false;
+    }
+
     auto should_flush = r->flush_block_policy->Update(key, value);
     if (should_flush) {
       assert(!r->data_block.empty());
@@ -929,9 +1120,15 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
 
     // Note: PartitionedFilterBlockBuilder requires key being added to filter
     // builder after being added to index builder.
+    const bool in_key_stage = r->state == Rep::State::kUnbuffered &&
+                              r->IsParallelCompressionEnabled() &&
+                              r->pc_rep->collectors_in_key_stage;
     if (r->state == Rep::State::kUnbuffered) {
       if (r->IsParallelCompressionEnabled()) {
         r->pc_rep->curr_block_keys->PushBack(key);
+        if (in_key_stage) {
+          r->pc_rep->curr_block_values->PushBack(value);
+        }
       } else {
         if (r->filter_builder != nullptr) {
           size_t ts_sz =
@@ -941,6 +1138,10 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       }
     }
 
+    if (r->range_filter_builder != nullptr) {
+      r->range_filter_builder->Add(ExtractUserKey(key));
+    }
+
     r->last_key.assign(key.data(), key.size());
     r->data_block.Add(key, value);
     if (r->state == Rep::State::kBuffered) {
@@ -952,16 +1153,25 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       }
     }
     // TODO offset passed in is not accurate for parallel compression case
-    NotifyCollectTableCollectorsOnAdd(key, value, r->get_offset(),
-                                      r->table_properties_collectors,
-                                      r->ioptions.logger);
+    if (!in_key_stage) {
+      NotifyCollectTableCollectorsOnAdd(key, value, r->get_offset(),
+                                        r->table_properties_collectors,
+                                        r->ioptions.logger);
+    }
 
   } else if (value_type == kTypeRangeDeletion) {
     r->range_del_block.Add(key, value);
-    // TODO offset passed in is not accurate for parallel compression case
-    NotifyCollectTableCollectorsOnAdd(key, value, r->get_offset(),
-                                      r->table_properties_collectors,
-                                      r->ioptions.logger);
+    if (r->state == Rep::State::kUnbuffered &&
+        r->IsParallelCompressionEnabled() &&
+        r->pc_rep->collectors_in_key_stage) {
+      r->pc_rep->deferred_range_dels.emplace_back(key.ToString(),
+                                                  value.ToString());
+    } else {
+      // TODO offset passed in is not accurate for parallel compression case
+      NotifyCollectTableCollectorsOnAdd(key, value, r->get_offset(),
+                                        r->table_properties_collectors,
+                                        r->ioptions.logger);
+    }
   } else {
     assert(false);
   }
@@ -979,11 +1189,101 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
   }
 }
 
+bool BlockBasedTableBuilder::AddRawDataBlock(
+    const Slice& contents, CompressionType type,
+    uint32_t compress_format_version,
+    const std::vector<std::pair<Slice, Slice>>& entries) {
+  Rep* r = rep_;
+  assert(r->state != Rep::State::kClosed);
+  if (!ok() || entries.empty() || r->state != Rep::State::kUnbuffered ||
+      r->IsParallelCompressionEnabled()) {
+    return false;
+  }
+  if (type != kNoCompression &&
+      (type != r->compression_type ||
+       compress_format_version !=
+           GetCompressFormatForVersion(r->table_options.format_version))) {
+    return false;
+  }
+  const Slice& first_key = entries.front().first;
+#ifndef NDEBUG
+  if (r->props.num_entries > r->props.num_range_deletions) {
+    assert(r->internal_comparator.Compare(first_key, Slice(r->last_key)) > 0);
+  }
+#endif  // !NDEBUG
+
+  // End the block being built, so that the copied one follows it
+  if (!r->data_block.empty()) {
+    r->first_key_in_next_block = &first_key;
+    Flush();
+    if (ok()) {
+      r->index_builder->AddIndexEntry(&r->last_key, &first_key,
+                                      r->pending_handle);
+    }
+  } else if (r->raw_block_pending_index_entry) {
+    r->index_builder->AddIndexEntry(&r->last_key, &first_key,
+                                    r->pending_handle);
+  }
+  r->raw_block_pending_index_entry = false;
+  if (!ok()) {
+    return true;
+  }
+
+  // Index and filter entries are rebuilt from the keys, the same way Add()
+  // does.
+  const size_t ts_sz =
+      r->internal_comparator.user_comparator()->timestamp_size();
+  for (const auto& entry : entries) {
+    const Slice& key = entry.first;
+    const Slice& value = entry.second;
+    if (r->filter_builder != nullptr) {
+      r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
+    }
+    if (r->range_filter_builder != nullptr) {
+      r->range_filter_builder->Add(ExtractUserKey(key));
+    }
+    r->index_builder->OnKeyAdded(key);
+    NotifyCollectTableCollectorsOnAdd(key, value, r->get_offset(),
+                                      r->table_properties_collectors,
+                                      r->ioptions.logger);
+    r->props.num_entries++;
+    r->props.raw_key_size += key.size();
+    r->props.raw_value_size += value.size();
+    ValueType value_type = ExtractValueType(key);
+    if (value_type == kTypeDeletion || value_type == kTypeSingleDeletion) {
+      r->props.num_deletions++;
+    } else if (value_type == kTypeMerge) {
+      r->props.num_merge_operands++;
+    }
+  }
+  r->last_key.assign(entries.back().first.data(),
+                     entries.back().first.size());
+  if (r->key_position_builder != nullptr) {
+    r->key_position_builder->AddBlockKey(
+        r->last_key, r->props.num_entries - r->props.num_range_deletions);
+  }
+
+  WriteRawBlock(contents, type, &r->pending_handle, true /* is_data_block */);
+  if (ok()) {
+    if (r->filter_builder != nullptr) {
+      r->filter_builder->StartBlock(r->get_offset());
+    }
+    r->props.data_size = r->get_offset();
+    ++r->props.num_data_blocks;
+    r->raw_block_pending_index_entry = true;
+  }
+  return true;
+}
+
 void BlockBasedTableBuilder::Flush() {
   Rep* r = rep_;
   assert(rep_->state != Rep::State::kClosed);
   if (!ok()) return;
   if (r->data_block.empty()) return;
+  if (r->key_position_builder != nullptr) {
+    r->key_position_builder->AddBlockKey(
+        r->last_key, r->props.num_entries - r->props.num_range_deletions);
+  }
   if (r->IsParallelCompressionEnabled() &&
       r->state == Rep::State::kUnbuffered) {
     r->data_block.Finish();
@@ -1092,9 +1392,20 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
       compression_dict = r->compression_dict.get();
     }
     assert(compression_dict != nullptr);
-    CompressionInfo compression_info(r->compression_opts, compression_ctx,
-                                     *compression_dict, *type,
-                                     sample_for_compression);
+    if (is_data_block && r->table_options.adaptive_compression &&
+        *type != kNoCompression) {
+      *type = ChooseAdaptiveCompression(
+          raw_block_contents, *type, !compression_dict->GetRawDict().empty(),
+          r->ioptions.stats);
+    }
+    // The fast compressions adaptive compression may pick instead of the
+    // configured one need no native context
+    CompressionContext fast_compression_ctx(kNoCompression);
+    CompressionInfo compression_info(
+        r->compression_opts,
+        *type == r->compression_type ? compression_ctx : fast_compression_ctx,
+        *compression_dict, *type, sample_for_compression,
+        r->ioptions.compressor.get());
 
     std::string sampled_output_fast;
     std::string sampled_output_slow;
@@ -1131,8 +1442,13 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
       }
       assert(verify_dict != nullptr);
       BlockContents contents;
-      UncompressionInfo uncompression_info(*verify_ctx, *verify_dict,
-                                           r->compression_type);
+      std::unique_ptr<UncompressionContext> adaptive_verify_ctx;
+      if (*type != r->compression_type) {
+        adaptive_verify_ctx.reset(new UncompressionContext(*type));
+      }
+      UncompressionInfo uncompression_info(
+          adaptive_verify_ctx ? *adaptive_verify_ctx : *verify_ctx,
+          *verify_dict, *type);
       Status stat = UncompressBlockContentsForCompressionType(
           uncompression_info, block_contents->data(), block_contents->size(),
           &contents, r->table_options.format_version, r->ioptions);
@@ -1199,7 +1515,13 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
   handle->set_size(block_contents.size());
   assert(status().ok());
   assert(io_status().ok());
-  io_s = r->file->Append(block_contents);
+  // The CRC32c of the block is also the one the file writer hands off with
+  // the data when it verifies writes, so it is computed once for both
+  uint32_t block_crc = 0;
+  if (r->table_options.checksum == kCRC32c) {
+    block_crc = crc32c::Value(block_contents.data(), block_contents.size());
+  }
+  io_s = r->file->Append(block_contents, block_crc);
   if (io_s.ok()) {
     char trailer[kBlockTrailerSize];
     trailer[0] = type;
@@ -1208,10 +1530,8 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
       case kNoChecksum:
         break;
       case kCRC32c: {
-        uint32_t crc =
-            crc32c::Value(block_contents.data(), block_contents.size());
         // Extend to cover compression type
-        crc = crc32c::Extend(crc, trailer, 1);
+        uint32_t crc = crc32c::Extend(block_crc, trailer, 1);
         checksum = crc32c::Mask(crc);
         break;
       }
@@ -1235,6 +1555,10 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
         XXH64_freeState(state);
         break;
       }
+      case kXXH3:
+        checksum = ComputeXXH3Checksum(block_contents.data(),
+                                       block_contents.size(), trailer[0]);
+        break;
       default:
         assert(false);
         break;
@@ -1283,6 +1607,9 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
           r->SetIOStatus(io_s);
         }
       }
+      if (is_data_block && r->key_position_builder != nullptr) {
+        r->key_position_builder->AddBlockEnd(r->get_offset());
+      }
       if (r->IsParallelCompressionEnabled()) {
         if (is_data_block) {
           r->pc_rep->file_size_estimator.ReapBlock(block_contents.size(),
@@ -1313,13 +1640,13 @@ void BlockBasedTableBuilder::BGWorkWriteRawBlock() {
       // Reap block so that blocked Flush() can finish
       // if there is one, and Flush() will notice !ok() next time.
       block_rep->status = Status::OK();
-      r->pc_rep->ReapBlock(block_rep);
+      r->pc_rep->FinishBlockStage(block_rep);
       continue;
     }
 
     for (size_t i = 0; i < block_rep->keys->Size(); i++) {
       auto& key = (*block_rep->keys)[i];
-      if (r->filter_builder != nullptr) {
+      if (r->filter_builder != nullptr && !r->pc_rep->filter_in_key_stage) {
         size_t ts_sz =
             r->internal_comparator.user_comparator()->timestamp_size();
         r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
@@ -1353,13 +1680,47 @@ void BlockBasedTableBuilder::BGWorkWriteRawBlock() {
                                       r->pending_handle);
     }
 
-    r->pc_rep->ReapBlock(block_rep);
+    r->pc_rep->FinishBlockStage(block_rep);
+  }
+}
+
+void BlockBasedTableBuilder::BGWorkAddKeys() {
+  Rep* r = rep_;
+  const size_t ts_sz =
+      r->internal_comparator.user_comparator()->timestamp_size();
+  ParallelCompressionRep::BlockRep* block_rep = nullptr;
+  while (r->pc_rep->key_queue.pop(block_rep)) {
+    assert(block_rep != nullptr);
+    const bool notify_collectors = block_rep->values->Size() > 0;
+    assert(!notify_collectors ||
+           block_rep->values->Size() == block_rep->keys->Size());
+    for (size_t i = 0; i < block_rep->keys->Size(); i++) {
+      const std::string& key = (*block_rep->keys)[i];
+      if (r->pc_rep->filter_in_key_stage) {
+        r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
+      }
+      if (notify_collectors) {
+        NotifyCollectTableCollectorsOnAdd(key, (*block_rep->values)[i],
+                                          r->get_offset(),
+                                          r->table_properties_collectors,
+                                          r->ioptions.logger);
+      }
+    }
+    r->pc_rep->FinishBlockStage(block_rep);
   }
 }
 
 void BlockBasedTableBuilder::StartParallelCompression() {
   rep_->pc_rep.reset(
       new ParallelCompressionRep(rep_->compression_opts.parallel_threads));
+  rep_->pc_rep->filter_in_key_stage =
+      rep_->filter_builder != nullptr &&
+      !rep_->filter_builder->IsBlockBased() &&
+      !rep_->table_options.partition_filters;
+  // Not worth copying the values for BlockBasedTablePropertiesCollector
+  // alone, which ignores them
+  rep_->pc_rep->collectors_in_key_stage =
+      rep_->table_properties_collectors.size() > 1;
   rep_->pc_rep->compress_thread_pool.reserve(
       rep_->compression_opts.parallel_threads);
   for (uint32_t i = 0; i < rep_->compression_opts.parallel_threads; i++) {
@@ -1370,6 +1731,10 @@ void BlockBasedTableBuilder::StartParallelCompression() {
   }
   rep_->pc_rep->write_thread.reset(
       new port::Thread([this] { BGWorkWriteRawBlock(); }));
+  if (rep_->pc_rep->HasKeyStage()) {
+    rep_->pc_rep->key_thread.reset(
+        new port::Thread([this] { BGWorkAddKeys(); }));
+  }
 }
 
 void BlockBasedTableBuilder::StopParallelCompression() {
@@ -1379,6 +1744,10 @@ void BlockBasedTableBuilder::StopParallelCompression() {
   }
   rep_->pc_rep->write_queue.finish();
   rep_->pc_rep->write_thread->join();
+  if (rep_->pc_rep->key_thread != nullptr) {
+    rep_->pc_rep->key_queue.finish();
+    rep_->pc_rep->key_thread->join();
+  }
 }
 
 Status BlockBasedTableBuilder::status() const { return rep_->GetStatus(); }
@@ -1716,6 +2085,28 @@ void BlockBasedTableBuilder::WriteRangeDelBlock(
   }
 }
 
+void BlockBasedTableBuilder::WriteRangeFilterBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  if (ok() && rep_->range_filter_builder != nullptr &&
+      !rep_->range_filter_builder->empty()) {
+    BlockHandle range_filter_block_handle;
+    WriteRawBlock(rep_->range_filter_builder->Finish(), kNoCompression,
+                  &range_filter_block_handle);
+    meta_index_builder->Add(kRangeFilterBlock, range_filter_block_handle);
+  }
+}
+
+void BlockBasedTableBuilder::WriteKeyPositionSummaryBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  if (ok() && rep_->key_position_builder != nullptr &&
+      !rep_->key_position_builder->empty()) {
+    BlockHandle key_position_handle;
+    WriteRawBlock(rep_->key_position_builder->Finish(), kNoCompression,
+                  &key_position_handle);
+    meta_index_builder->Add(kKeyPositionSummaryBlock, key_position_handle);
+  }
+}
+
 void BlockBasedTableBuilder::WriteFooter(BlockHandle& metaindex_block_handle,
                                          BlockHandle& index_block_handle) {
   Rep* r = rep_;
@@ -1807,11 +2198,13 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
   } else {
     dict = std::move(compression_dict_samples);
   }
-  r->compression_dict.reset(new CompressionDict(dict, r->compression_type,
-                                                r->compression_opts.level));
-  r->verify_dict.reset(new UncompressionDict(
-      dict, r->compression_type == kZSTD ||
-                r->compression_type == kZSTDNotFinalCompression));
+  r->SetCompressionDict(dict);
+  if (r->dict_reuse_cache != nullptr && !dict.empty()) {
+    r->dict_reuse_cache->Insert(r->column_family_id, r->level_at_creation,
+                                r->compression_type,
+                                r->compression_opts.max_dict_bytes,
+                                r->ioptions.clock->NowMicros(), dict);
+  }
 
   auto get_iterator_for_block = [&r](size_t i) {
     auto& data_block = r->data_block_buffers[i];
@@ -1908,10 +2301,16 @@ Status BlockBasedTableBuilder::Finish() {
       assert(br.status.ok());
     }
 #endif  // !NDEBUG
+    for (const auto& range_del : r->pc_rep->deferred_range_dels) {
+      NotifyCollectTableCollectorsOnAdd(range_del.first, range_del.second,
+                                        r->get_offset(),
+                                        r->table_properties_collectors,
+                                        r->ioptions.logger);
+    }
   } else {
     // To make sure properties block is able to keep the accurate size of index
     // block, we will finish writing all index entries first.
-    if (ok() && !empty_data_block) {
+    if (ok() && (!empty_data_block || r->raw_block_pending_index_entry)) {
       r->index_builder->AddIndexEntry(
           &r->last_key, nullptr /* no next data block */, r->pending_handle);
     }
@@ -1931,6 +2330,8 @@ Status BlockBasedTableBuilder::Finish() {
   WriteIndexBlock(&meta_index_builder, &index_block_handle);
   WriteCompressionDictBlock(&meta_index_builder);
   WriteRangeDelBlock(&meta_index_builder);
+  WriteRangeFilterBlock(&meta_index_builder);
+  WriteKeyPositionSummaryBlock(&meta_index_builder);
   WritePropertiesBlock(&meta_index_builder);
   if (ok()) {
     // flush the meta index block
@@ -27,6 +27,7 @@ namespace ROCKSDB_NAMESPACE {
 
 class BlockBuilder;
 class BlockHandle;
+class CompressionDictReuseCache;
 class WritableFile;
 struct BlockBasedTableOptions;
 
@@ -37,10 +38,13 @@ class BlockBasedTableBuilder : public TableBuilder {
  public:
   // Create a builder that will store the contents of the table it is
   // building in *file.  Does not close the file.  It is up to the
-  // caller to close the file after calling Finish().
-  BlockBasedTableBuilder(const BlockBasedTableOptions& table_options,
-                         const TableBuilderOptions& table_builder_options,
-                         WritableFileWriter* file);
+  // caller to close the file after calling Finish(). `dict_reuse_cache`, if
+  // not null, holds the compression dictionaries that may be reused.
+  BlockBasedTableBuilder(
+      const BlockBasedTableOptions& table_options,
+      const TableBuilderOptions& table_builder_options,
+      WritableFileWriter* file,
+      CompressionDictReuseCache* dict_reuse_cache = nullptr);
 
   // No copying allowed
   BlockBasedTableBuilder(const BlockBasedTableBuilder&) = delete;
@@ -54,6 +58,14 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   void Add(const Slice& key, const Slice& value) override;
 
+  // Not supported with parallel compression, while blocks are buffered for
+  // building a compression dictionary, or for blocks compressed differently
+  // from this table.
+  bool AddRawDataBlock(
+      const Slice& contents, CompressionType type,
+      uint32_t compress_format_version,
+      const std::vector<std::pair<Slice, Slice>>& entries) override;
+
   // Return non-ok iff some error has been detected.
   Status status() const override;
 
@@ -132,6 +144,8 @@ class BlockBasedTableBuilder : public TableBuilder {
   void WritePropertiesBlock(MetaIndexBuilder* meta_index_builder);
   void WriteCompressionDictBlock(MetaIndexBuilder* meta_index_builder);
   void WriteRangeDelBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteRangeFilterBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteKeyPositionSummaryBlock(MetaIndexBuilder* meta_index_builder);
   void WriteFooter(BlockHandle& metaindex_block_handle,
                    BlockHandle& index_block_handle);
 
@@ -171,11 +185,15 @@ class BlockBasedTableBuilder : public TableBuilder {
   // Get compressed blocks from BGWorkCompression and write them into SST
   void BGWorkWriteRawBlock();
 
-  // Initialize parallel compression context and
-  // start BGWorkCompression and BGWorkWriteRawBlock threads
+  // Add the keys of the blocks to the full filter and notify the table
+  // properties collectors of them
+  void BGWorkAddKeys();
+
+  // Initialize parallel compression context and start BGWorkCompression,
+  // BGWorkWriteRawBlock and, if needed, BGWorkAddKeys threads
   void StartParallelCompression();
 
-  // Stop BGWorkCompression and BGWorkWriteRawBlock threads
+  // Stop BGWorkCompression, BGWorkWriteRawBlock and BGWorkAddKeys threads
   void StopParallelCompression();
 };
 
@@ -40,6 +40,33 @@ void TailPrefetchStats::RecordEffectiveSize(size_t len) {
   }
 }
 
+bool CompressionDictReuseCache::Lookup(uint32_t column_family_id, int level,
+                                       CompressionType type,
+                                       uint32_t max_dict_bytes,
+                                       uint64_t now_micros,
+                                       uint64_t max_age_micros,
+                                       std::string* dict) {
+  MutexLock l(&mutex_);
+  auto it = dicts_.find(Key(column_family_id, level, type, max_dict_bytes));
+  if (it == dicts_.end() ||
+      now_micros - it->second.built_micros > max_age_micros) {
+    return false;
+  }
+  *dict = it->second.dict;
+  return true;
+}
+
+void CompressionDictReuseCache::Insert(uint32_t column_family_id, int level,
+                                       CompressionType type,
+                                       uint32_t max_dict_bytes,
+                                       uint64_t now_micros,
+                                       const std::string& dict) {
+  MutexLock l(&mutex_);
+  Entry& entry = dicts_[Key(column_family_id, level, type, max_dict_bytes)];
+  entry.built_micros = now_micros;
+  entry.dict = dict;
+}
+
 size_t TailPrefetchStats::GetSuggestedPrefetchSize() {
   std::vector<size_t> sorted;
   {
@@ -168,7 +195,8 @@ static std::unordered_map<std::string, PinningTier>
         {"kFallback", PinningTier::kFallback},
         {"kNone", PinningTier::kNone},
         {"kFlushedAndSimilar", PinningTier::kFlushedAndSimilar},
-        {"kAll", PinningTier::kAll}};
+        {"kAll", PinningTier::kAll},
+        {"kUpperLevels", PinningTier::kUpperLevels}};
 
 static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
     block_base_table_index_type_string_map = {
@@ -177,7 +205,9 @@ static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kTwoLevelIndexSearch",
          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
         {"kBinarySearchWithFirstKey",
-         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey}};
+         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey},
+        {"kLearned", BlockBasedTableOptions::IndexType::kLearned},
+        {"kEliasFano", BlockBasedTableOptions::IndexType::kEliasFano}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::DataBlockIndexType>
@@ -211,7 +241,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"unpartitioned_pinning",
          OptionTypeInfo::Enum<PinningTier>(
              offsetof(struct MetadataCacheOptions, unpartitioned_pinning),
-             &pinning_tier_type_string_map)}};
+             &pinning_tier_type_string_map)},
+        {"max_upper_level",
+         {offsetof(struct MetadataCacheOptions, max_upper_level),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::PrepopulateBlockCache>
@@ -269,6 +303,20 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    data_block_hash_table_util_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wide_data_block_hash_index",
+         {offsetof(struct BlockBasedTableOptions, wide_data_block_hash_index),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"separate_key_value_in_data_block",
+         {offsetof(struct BlockBasedTableOptions,
+                   separate_key_value_in_data_block),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"restart_key_prefixes_in_data_block",
+         {offsetof(struct BlockBasedTableOptions,
+                   restart_key_prefixes_in_data_block),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"checksum",
          {offsetof(struct BlockBasedTableOptions, checksum),
           OptionType::kChecksumType, OptionVerificationType::kNormal,
@@ -308,6 +356,24 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, optimize_filters_for_memory),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"reserve_table_builder_memory",
+         {offsetof(struct BlockBasedTableOptions,
+                   reserve_table_builder_memory),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"range_filter_prefix_len",
+         {offsetof(struct BlockBasedTableOptions, range_filter_prefix_len),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"multiget_decompression_threads",
+         {offsetof(struct BlockBasedTableOptions,
+                   multiget_decompression_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"key_position_samples",
+         {offsetof(struct BlockBasedTableOptions, key_position_samples),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"filter_policy",
          {offsetof(struct BlockBasedTableOptions, filter_policy),
           OptionType::kUnknown, OptionVerificationType::kByNameAllowFromNull,
@@ -362,6 +428,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, verify_compression),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"adaptive_compression",
+         {offsetof(struct BlockBasedTableOptions, adaptive_compression),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"read_amp_bytes_per_bit",
          {offsetof(struct BlockBasedTableOptions, read_amp_bytes_per_bit),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
@@ -400,6 +470,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
              kOptNameMetadataCacheOpts, &metadata_cache_options_type_info,
              offsetof(struct BlockBasedTableOptions, metadata_cache_options),
              OptionVerificationType::kNormal, OptionTypeFlags::kNone)},
+        {"compact_table_reader",
+         {offsetof(struct BlockBasedTableOptions, compact_table_reader),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"block_cache",
          {offsetof(struct BlockBasedTableOptions, block_cache),
           OptionType::kUnknown, OptionVerificationType::kNormal,
@@ -466,6 +540,9 @@ void BlockBasedTableFactory::InitializeOptions() {
   if (table_options_.index_block_restart_interval < 1) {
     table_options_.index_block_restart_interval = 1;
   }
+  if (table_options_.multiget_decompression_threads < 0) {
+    table_options_.multiget_decompression_threads = 0;
+  }
   if (table_options_.index_type == BlockBasedTableOptions::kHashSearch &&
       table_options_.index_block_restart_interval != 1) {
     // Currently kHashSearch is incompatible with index_block_restart_interval > 1
@@ -507,7 +584,7 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
     const TableBuilderOptions& table_builder_options,
     WritableFileWriter* file) const {
   return new BlockBasedTableBuilder(table_options_, table_builder_options,
-                                    file);
+                                    file, &dict_reuse_cache_);
 }
 
 Status BlockBasedTableFactory::ValidateOptions(
@@ -589,6 +666,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  pin_top_level_index_and_filter: %d\n",
            table_options_.pin_top_level_index_and_filter);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  compact_table_reader: %d\n",
+           table_options_.compact_table_reader);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  index_type: %d\n",
            table_options_.index_type);
   ret.append(buffer);
@@ -601,6 +681,15 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %lf\n",
            table_options_.data_block_hash_table_util_ratio);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  wide_data_block_hash_index: %d\n",
+           table_options_.wide_data_block_hash_index);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  separate_key_value_in_data_block: %d\n",
+           table_options_.separate_key_value_in_data_block);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  restart_key_prefixes_in_data_block: %d\n",
+           table_options_.restart_key_prefixes_in_data_block);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  hash_index_allow_collision: %d\n",
            table_options_.hash_index_allow_collision);
   ret.append(buffer);
@@ -662,6 +751,19 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  partition_filters: %d\n",
            table_options_.partition_filters);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  reserve_table_builder_memory: %d\n",
+           table_options_.reserve_table_builder_memory);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  range_filter_prefix_len: %" ROCKSDB_PRIszt
+           "\n",
+           table_options_.range_filter_prefix_len);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  multiget_decompression_threads: %d\n",
+           table_options_.multiget_decompression_threads);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  key_position_samples: %" PRIu32 "\n",
+           table_options_.key_position_samples);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  use_delta_encoding: %d\n",
            table_options_.use_delta_encoding);
   ret.append(buffer);
@@ -676,6 +778,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  verify_compression: %d\n",
            table_options_.verify_compression);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  adaptive_compression: %d\n",
+           table_options_.adaptive_compression);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  read_amp_bytes_per_bit: %d\n",
            table_options_.read_amp_bytes_per_bit);
   ret.append(buffer);
@@ -839,6 +944,10 @@ const std::string BlockBasedTablePropertyNames::kWholeKeyFiltering =
 const std::string BlockBasedTablePropertyNames::kPrefixFiltering =
     "rocksdb.block.based.table.prefix.filtering";
 const std::string kHashIndexPrefixesBlock = "rocksdb.hashindex.prefixes";
+const std::string kRangeFilterBlock = "rocksdb.range_filter";
+const std::string kKeyPositionSummaryBlock = "rocksdb.key_positions";
+const std::string kLearnedIndexBlock = "rocksdb.learned.index";
+const std::string kEliasFanoIndexBlock = "rocksdb.elias_fano.index";
 const std::string kHashIndexPrefixesMetadataBlock =
     "rocksdb.hashindex.metadata";
 const std::string kPropTrue = "1";
@@ -10,8 +10,10 @@
 #pragma once
 #include <stdint.h>
 
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 
 #include "db/dbformat.h"
 #include "rocksdb/flush_block_policy.h"
@@ -39,6 +41,32 @@ class TailPrefetchStats {
   size_t num_records_ = 0;
 };
 
+// Keeps the compression dictionary last built for each column family and
+// output level, so that the following SST files can reuse it rather than
+// buffer data and train one of their own. See
+// CompressionOptions::max_dict_reuse_seconds.
+class CompressionDictReuseCache {
+ public:
+  // Returns whether a dictionary built at most `max_age_micros` ago with the
+  // same compression type and max_dict_bytes was found
+  bool Lookup(uint32_t column_family_id, int level, CompressionType type,
+              uint32_t max_dict_bytes, uint64_t now_micros,
+              uint64_t max_age_micros, std::string* dict);
+  void Insert(uint32_t column_family_id, int level, CompressionType type,
+              uint32_t max_dict_bytes, uint64_t now_micros,
+              const std::string& dict);
+
+ private:
+  struct Entry {
+    uint64_t built_micros;
+    std::string dict;
+  };
+  typedef std::tuple<uint32_t, int, CompressionType, uint32_t> Key;
+
+  port::Mutex mutex_;
+  std::map<Key, Entry> dicts_;
+};
+
 class BlockBasedTableFactory : public TableFactory {
  public:
   explicit BlockBasedTableFactory(
@@ -86,10 +114,15 @@ class BlockBasedTableFactory : public TableFactory {
  private:
   BlockBasedTableOptions table_options_;
   mutable TailPrefetchStats tail_prefetch_stats_;
+  mutable CompressionDictReuseCache dict_reuse_cache_;
 };
 
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kRangeFilterBlock;
+extern const std::string kKeyPositionSummaryBlock;
+extern const std::string kLearnedIndexBlock;
+extern const std::string kEliasFanoIndexBlock;
 extern const std::string kPropTrue;
 extern const std::string kPropFalse;
 }  // namespace ROCKSDB_NAMESPACE
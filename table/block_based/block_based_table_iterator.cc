@@ -20,6 +20,12 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target) {
     ResetDataIter();
     return;
   }
+  if (!table_->RangeMayMatch(target, read_options_)) {
+    // No keys in [target, upper bound). The upper level moves on to the
+    // next file, if any.
+    ResetDataIter();
+    return;
+  }
 
   bool need_seek_index = true;
   if (block_iter_points_to_real_block_ && block_iter_.Valid()) {
@@ -227,20 +233,32 @@ void BlockBasedTableIterator::InitDataBlock() {
 
     bool is_for_compaction =
         lookup_context_.caller == TableReaderCaller::kCompaction;
-    // Prefetch additional data for range scans (iterators).
-    // Implicit auto readahead:
-    //   Enabled after 2 sequential IOs when ReadOptions.readahead_size == 0.
-    // Explicit user requested readahead:
-    //   Enabled from the very first IO when ReadOptions.readahead_size is set.
-    block_prefetcher_.PrefetchIfNeeded(rep, data_block_handle,
-                                       read_options_.readahead_size,
-                                       is_for_compaction);
+    FilePrefetchBuffer* prefetch_buffer = block_prefetcher_.prefetch_buffer();
+    if (!UpperBoundInCurBlock()) {
+      // Prefetch additional data for range scans (iterators).
+      // Implicit auto readahead:
+      //   Enabled after 2 sequential IOs when ReadOptions.readahead_size == 0.
+      // Explicit user requested readahead:
+      //   Enabled from the very first IO when ReadOptions.readahead_size is
+      //   set.
+      block_prefetcher_.PrefetchIfNeeded(rep, data_block_handle,
+                                         read_options_.readahead_size,
+                                         is_for_compaction,
+                                         read_options_.async_io);
+      prefetch_buffer = block_prefetcher_.prefetch_buffer();
+    } else if (prefetch_buffer != nullptr &&
+               !prefetch_buffer->IsDataInBuffer(
+                   data_block_handle.offset(),
+                   static_cast<size_t>(block_size(data_block_handle)))) {
+      // No block past this one is within iterate_upper_bound, so reading
+      // ahead of it would be wasted.
+      prefetch_buffer = nullptr;
+    }
 
     Status s;
     table_->NewDataBlockIterator<DataBlockIter>(
         read_options_, data_block_handle, &block_iter_, BlockType::kData,
-        /*get_context=*/nullptr, &lookup_context_, s,
-        block_prefetcher_.prefetch_buffer(),
+        /*get_context=*/nullptr, &lookup_context_, s, prefetch_buffer,
         /*for_compaction=*/is_for_compaction);
     block_iter_points_to_real_block_ = true;
     CheckDataBlockWithinUpperBound();
@@ -372,12 +390,17 @@ void BlockBasedTableIterator::CheckOutOfBound() {
 void BlockBasedTableIterator::CheckDataBlockWithinUpperBound() {
   if (read_options_.iterate_upper_bound != nullptr &&
       block_iter_points_to_real_block_) {
-    block_upper_bound_check_ = (user_comparator_.CompareWithoutTimestamp(
-                                    *read_options_.iterate_upper_bound,
-                                    /*a_has_ts=*/false, index_iter_->user_key(),
-                                    /*b_has_ts=*/true) > 0)
-                                   ? BlockUpperBound::kUpperBoundBeyondCurBlock
-                                   : BlockUpperBound::kUpperBoundInCurBlock;
+    block_upper_bound_check_ = UpperBoundInCurBlock()
+                                   ? BlockUpperBound::kUpperBoundInCurBlock
+                                   : BlockUpperBound::kUpperBoundBeyondCurBlock;
   }
 }
+
+bool BlockBasedTableIterator::UpperBoundInCurBlock() {
+  return read_options_.iterate_upper_bound != nullptr &&
+         user_comparator_.CompareWithoutTimestamp(
+             *read_options_.iterate_upper_bound,
+             /*a_has_ts=*/false, index_iter_->user_key(),
+             /*b_has_ts=*/true) <= 0;
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -130,6 +130,14 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
            block_iter_points_to_real_block_;
   }
 
+  void GetReadaheadState(ReadaheadFileInfo* readahead_info) override {
+    block_prefetcher_.GetReadaheadState(readahead_info);
+  }
+
+  void SetReadaheadState(const ReadaheadFileInfo& readahead_info) override {
+    block_prefetcher_.SetReadaheadState(readahead_info);
+  }
+
   void ResetDataIter() {
     if (block_iter_points_to_real_block_) {
       if (pinned_iters_mgr_ != nullptr && pinned_iters_mgr_->PinningEnabled()) {
@@ -227,6 +235,9 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   // Note MyRocks may update iterate bounds between seek. To workaround it,
   // we need to check and update data_block_within_upper_bound_ accordingly.
   void CheckDataBlockWithinUpperBound();
+  // Whether iterate_upper_bound is within the data block index_iter_ is at,
+  // so that no block after it needs to be read.
+  bool UpperBoundInCurBlock();
 
   bool CheckPrefixMayMatch(const Slice& ikey, IterDirection direction) {
     if (need_upper_bound_check_ && direction == IterDirection::kBackward) {
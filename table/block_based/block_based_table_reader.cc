@@ -10,7 +10,11 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <limits>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -44,9 +48,11 @@
 #include "table/block_based/block_like_traits.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/block_type.h"
+#include "table/block_based/elias_fano_index_reader.h"
 #include "table/block_based/filter_block.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/hash_index_reader.h"
+#include "table/block_based/learned_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
 #include "table/block_fetcher.h"
@@ -63,12 +69,17 @@
 #include "util/crc32c.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
+#include "util/threadpool_imp.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kRangeFilterBlock;
+extern const std::string kKeyPositionSummaryBlock;
+extern const std::string kLearnedIndexBlock;
+extern const std::string kEliasFanoIndexBlock;
 
 BlockBasedTable::~BlockBasedTable() {
   delete rep_;
@@ -146,6 +157,63 @@ CacheAllocationPtr CopyBufferToHeap(MemoryAllocator* allocator, Slice& buf) {
   memcpy(heap_buf.get(), buf.data(), buf.size());
   return heap_buf;
 }
+
+// Threads that decompress the data blocks of MultiGet() batches, grown to
+// the largest BlockBasedTableOptions::multiget_decompression_threads seen
+ThreadPoolImpl* MultiGetDecompressionThreadPool() {
+  // Intentionally leaked: jobs may still be queued during static
+  // destruction.
+  static ThreadPoolImpl* const pool = new ThreadPoolImpl();
+  return pool;
+}
+
+// Shared by a caller of RunInParallel() and the jobs it submitted, which
+// may only start once it returned
+struct ParallelTasksState {
+  std::mutex mu;
+  std::condition_variable cv;
+  std::atomic<size_t> next_task{0};
+  size_t num_tasks = 0;
+  size_t num_done = 0;
+  std::function<void(size_t)> task;
+};
+
+void RunParallelTasks(ParallelTasksState* state) {
+  size_t num_done = 0;
+  for (size_t i = state->next_task.fetch_add(1); i < state->num_tasks;
+       i = state->next_task.fetch_add(1)) {
+    state->task(i);
+    ++num_done;
+  }
+  if (num_done > 0) {
+    std::lock_guard<std::mutex> l(state->mu);
+    state->num_done += num_done;
+    if (state->num_done == state->num_tasks) {
+      state->cv.notify_all();
+    }
+  }
+}
+
+// Calls task(0), ..., task(num_tasks - 1) on the calling thread and up to
+// `threads` threads of MultiGetDecompressionThreadPool(), and returns once
+// all of them returned
+void RunInParallel(size_t num_tasks, int threads,
+                   const std::function<void(size_t)>& task) {
+  std::shared_ptr<ParallelTasksState> state =
+      std::make_shared<ParallelTasksState>();
+  state->num_tasks = num_tasks;
+  state->task = task;
+  const size_t num_jobs =
+      std::min(static_cast<size_t>(threads), num_tasks - 1);
+  ThreadPoolImpl* pool = MultiGetDecompressionThreadPool();
+  pool->IncBackgroundThreadsIfNeeded(threads);
+  for (size_t i = 0; i < num_jobs; ++i) {
+    pool->SubmitJob([state]() { RunParallelTasks(state.get()); });
+  }
+  RunParallelTasks(state.get());
+  std::unique_lock<std::mutex> l(state->mu);
+  state->cv.wait(l, [&] { return state->num_done == state->num_tasks; });
+}
 }  // namespace
 
 void BlockBasedTable::UpdateCacheHitMetrics(BlockType block_type,
@@ -486,6 +554,47 @@ Status GetGlobalSequenceNumber(const TableProperties& table_properties,
 
   return Status::OK();
 }
+
+size_t ApproximateTablePropertiesSize(const TableProperties& props) {
+  size_t usage = sizeof(TableProperties);
+  for (const std::string* s :
+       {&props.db_id, &props.db_session_id, &props.db_host_id,
+        &props.column_family_name, &props.filter_policy_name,
+        &props.comparator_name, &props.merge_operator_name,
+        &props.prefix_extractor_name, &props.property_collectors_names,
+        &props.compression_name, &props.compression_options}) {
+    usage += s->capacity();
+  }
+  for (const auto* m :
+       {&props.user_collected_properties, &props.readable_properties}) {
+    for (const auto& kv : *m) {
+      usage += sizeof(kv) + kv.first.capacity() + kv.second.capacity();
+    }
+  }
+  for (const auto& kv : props.properties_offsets) {
+    usage += sizeof(kv) + kv.first.capacity();
+  }
+  return usage;
+}
+
+// The table properties a compact table reader keeps in memory: everything
+// reads consult, without the user collected properties and descriptive
+// strings.
+std::shared_ptr<const TableProperties> TrimTableProperties(
+    const TableProperties& props) {
+  auto trimmed = std::make_shared<TableProperties>(props);
+  for (std::string* s :
+       {&trimmed->db_id, &trimmed->db_session_id, &trimmed->db_host_id,
+        &trimmed->filter_policy_name, &trimmed->comparator_name,
+        &trimmed->merge_operator_name, &trimmed->property_collectors_names,
+        &trimmed->compression_options}) {
+    std::string().swap(*s);
+  }
+  UserCollectedProperties().swap(trimmed->user_collected_properties);
+  UserCollectedProperties().swap(trimmed->readable_properties);
+  std::map<std::string, uint64_t>().swap(trimmed->properties_offsets);
+  return trimmed;
+}
 }  // namespace
 
 Slice BlockBasedTable::GetCacheKey(const char* cache_key_prefix,
@@ -529,9 +638,23 @@ Status BlockBasedTable::Open(
   ro.deadline = read_options.deadline;
   ro.io_timeout = read_options.io_timeout;
 
+  // A compact table reader serves index, filter and compression dictionary
+  // blocks from the block cache only, without pinning any of them.
+  std::unique_ptr<BlockBasedTableOptions> compact_table_options;
+  if (table_options.compact_table_reader &&
+      table_options.block_cache != nullptr) {
+    compact_table_options.reset(new BlockBasedTableOptions(table_options));
+    compact_table_options->cache_index_and_filter_blocks = true;
+    compact_table_options->pin_l0_filter_and_index_blocks_in_cache = false;
+    compact_table_options->pin_top_level_index_and_filter = false;
+    compact_table_options->metadata_cache_options = MetadataCacheOptions();
+  }
+  const BlockBasedTableOptions& table_opts =
+      compact_table_options ? *compact_table_options : table_options;
+
   // prefetch both index and filters, down to all partitions
   const bool prefetch_all = prefetch_index_and_filter_in_cache || level == 0;
-  const bool preload_all = !table_options.cache_index_and_filter_blocks;
+  const bool preload_all = !table_opts.cache_index_and_filter_blocks;
 
   if (!ioptions.allow_mmap_reads) {
     s = PrefetchTail(ro, file.get(), file_size, force_direct_prefetch,
@@ -575,12 +698,13 @@ Status BlockBasedTable::Open(
   // raw pointer will be used to create HashIndexReader, whose reset may
   // access a dangling pointer.
   BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
-  Rep* rep = new BlockBasedTable::Rep(ioptions, env_options, table_options,
+  Rep* rep = new BlockBasedTable::Rep(ioptions, env_options, table_opts,
                                       internal_comparator, skip_filters,
                                       file_size, level, immortal_table);
   rep->file = std::move(file);
   rep->footer = footer;
-  rep->hash_index_allow_collision = table_options.hash_index_allow_collision;
+  rep->hash_index_allow_collision = table_opts.hash_index_allow_collision;
+  rep->compact_reader = compact_table_options != nullptr;
   // We need to wrap data with internal_prefix_transform to make sure it can
   // handle prefix correctly.
   if (prefix_extractor != nullptr) {
@@ -625,11 +749,31 @@ Status BlockBasedTable::Open(
   if (!s.ok()) {
     return s;
   }
+  // Both are optional accelerators held outside the block cache, so a
+  // compact table reader goes without them.
+  if (!rep->compact_reader) {
+    s = new_table->ReadRangeFilterBlock(ro, prefetch_buffer.get(),
+                                        metaindex_iter.get());
+    if (!s.ok()) {
+      return s;
+    }
+    s = new_table->ReadKeyPositionSummaryBlock(ro, prefetch_buffer.get(),
+                                               metaindex_iter.get());
+    if (!s.ok()) {
+      return s;
+    }
+  }
   s = new_table->PrefetchIndexAndFilterBlocks(
       ro, prefetch_buffer.get(), metaindex_iter.get(), new_table.get(),
-      prefetch_all, table_options, level, file_size,
+      prefetch_all, table_opts, level, file_size,
       max_file_size_for_l0_meta_pin, &lookup_context);
 
+  if (s.ok() && rep->compact_reader && rep->table_properties &&
+      !rep->properties_handle.IsNull()) {
+    // GetTableProperties() reads the rest back on demand
+    rep->table_properties = TrimTableProperties(*rep->table_properties);
+  }
+
   if (s.ok()) {
     // Update tail prefetch stats
     assert(prefetch_buffer.get() != nullptr);
@@ -698,7 +842,7 @@ Status BlockBasedTable::PrefetchTail(
 
 Status BlockBasedTable::TryReadPropertiesWithGlobalSeqno(
     const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
-    const Slice& handle_value, TableProperties** table_properties) {
+    const Slice& handle_value, TableProperties** table_properties) const {
   assert(table_properties != nullptr);
   // If this is an external SST file ingested with write_global_seqno set to
   // true, then we expect the checksum mismatch because checksum was written
@@ -731,6 +875,24 @@ Status BlockBasedTable::TryReadPropertiesWithGlobalSeqno(
   return s;
 }
 
+Status BlockBasedTable::ReadTableProperties(
+    const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
+    const Slice& handle_value, TableProperties** table_properties) const {
+  Status s = ReadProperties(
+      ro, handle_value, rep_->file.get(), prefetch_buffer, rep_->footer,
+      rep_->ioptions, table_properties, true /* verify_checksum */,
+      nullptr /* ret_block_handle */, nullptr /* ret_block_contents */,
+      false /* compression_type_missing */, nullptr /* memory_allocator */);
+  IGNORE_STATUS_IF_ERROR(s);
+
+  if (s.IsCorruption()) {
+    s = TryReadPropertiesWithGlobalSeqno(ro, prefetch_buffer, handle_value,
+                                         table_properties);
+    IGNORE_STATUS_IF_ERROR(s);
+  }
+  return s;
+}
+
 Status BlockBasedTable::ReadPropertiesBlock(
     const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
     InternalIterator* meta_iter, const SequenceNumber largest_seqno) {
@@ -746,19 +908,12 @@ Status BlockBasedTable::ReadPropertiesBlock(
     s = meta_iter->status();
     TableProperties* table_properties = nullptr;
     if (s.ok()) {
-      s = ReadProperties(
-          ro, meta_iter->value(), rep_->file.get(), prefetch_buffer,
-          rep_->footer, rep_->ioptions, &table_properties,
-          true /* verify_checksum */, nullptr /* ret_block_handle */,
-          nullptr /* ret_block_contents */,
-          false /* compression_type_missing */, nullptr /* memory_allocator */);
+      s = ReadTableProperties(ro, prefetch_buffer, meta_iter->value(),
+                              &table_properties);
     }
-    IGNORE_STATUS_IF_ERROR(s);
-
-    if (s.IsCorruption()) {
-      s = TryReadPropertiesWithGlobalSeqno(
-          ro, prefetch_buffer, meta_iter->value(), &table_properties);
-      IGNORE_STATUS_IF_ERROR(s);
+    if (s.ok()) {
+      Slice handle_value = meta_iter->value();
+      s = rep_->properties_handle.DecodeFrom(&handle_value);
     }
     std::unique_ptr<TableProperties> props_guard;
     if (table_properties != nullptr) {
@@ -821,6 +976,13 @@ Status BlockBasedTable::ReadPropertiesBlock(
     rep_->index_has_first_key =
         rep_->index_type == BlockBasedTableOptions::kBinarySearchWithFirstKey;
 
+    pos = props.find(TablePropertiesNames::kTimestampMin);
+    if (pos != props.end() &&
+        pos->second.size() ==
+            rep_->internal_comparator.user_comparator()->timestamp_size()) {
+      rep_->min_timestamp = pos->second;
+    }
+
     s = GetGlobalSequenceNumber(*(rep_->table_properties), largest_seqno,
                                 &(rep_->global_seqno));
     if (!s.ok()) {
@@ -866,6 +1028,104 @@ Status BlockBasedTable::ReadRangeDelBlock(
   return s;
 }
 
+Status BlockBasedTable::ReadRangeFilterBlock(
+    const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_iter) {
+  BlockHandle range_filter_handle;
+  Status s = FindMetaBlock(meta_iter, kRangeFilterBlock, &range_filter_handle);
+  if (!s.ok()) {
+    // No range filter
+    return Status::OK();
+  }
+  BlockContents contents;
+  BlockFetcher block_fetcher(
+      rep_->file.get(), prefetch_buffer, rep_->footer, ro, range_filter_handle,
+      &contents, rep_->ioptions, false /* decompress */,
+      false /*maybe_compressed*/, BlockType::kRangeFilter,
+      UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options,
+      GetMemoryAllocator(rep_->table_options));
+  s = block_fetcher.ReadBlockContents();
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Encountered error while reading range filter block %s",
+                   s.ToString().c_str());
+    return s;
+  }
+  rep_->range_filter = RangeFilterBlockReader::Create(std::move(contents));
+  if (rep_->range_filter == nullptr) {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Ignoring invalid range filter block in file %s",
+                   rep_->file->file_name().c_str());
+  }
+  return Status::OK();
+}
+
+Status BlockBasedTable::PrefetchPartitions(
+    const ReadOptions& ro, uint64_t offset, uint64_t len,
+    FilePrefetchBuffer* tail_prefetch_buffer,
+    std::unique_ptr<FilePrefetchBuffer>* prefetch_buffer,
+    FilePrefetchBuffer** buffer) const {
+  IOOptions opts;
+  Status s = rep_->file->PrepareIOOptions(ro, opts);
+  if (!s.ok()) {
+    return s;
+  }
+  // This also records the partitions as read from the tail, so that the tail
+  // prefetched for the next files covers them and their metadata takes one
+  // read in all.
+  Slice unused;
+  if (tail_prefetch_buffer != nullptr &&
+      tail_prefetch_buffer->TryReadFromCache(opts, offset,
+                                             static_cast<size_t>(len), &unused,
+                                             &s)) {
+    *buffer = tail_prefetch_buffer;
+    return s;
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  rep_->CreateFilePrefetchBuffer(0, 0, prefetch_buffer,
+                                 false /* Implicit autoreadahead */);
+  s = (*prefetch_buffer)
+          ->Prefetch(opts, rep_->file.get(), offset, static_cast<size_t>(len));
+  *buffer = prefetch_buffer->get();
+  return s;
+}
+
+Status BlockBasedTable::ReadKeyPositionSummaryBlock(
+    const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_iter) {
+  BlockHandle key_positions_handle;
+  Status s =
+      FindMetaBlock(meta_iter, kKeyPositionSummaryBlock, &key_positions_handle);
+  if (!s.ok()) {
+    // No key position summary
+    return Status::OK();
+  }
+  BlockContents contents;
+  BlockFetcher block_fetcher(
+      rep_->file.get(), prefetch_buffer, rep_->footer, ro, key_positions_handle,
+      &contents, rep_->ioptions, false /* decompress */,
+      false /*maybe_compressed*/, BlockType::kKeyPositionSummary,
+      UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options,
+      GetMemoryAllocator(rep_->table_options));
+  s = block_fetcher.ReadBlockContents();
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Encountered error while reading key position block %s",
+                   s.ToString().c_str());
+    return s;
+  }
+  rep_->key_positions = KeyPositionSummaryReader::Create(
+      std::move(contents), rep_->internal_comparator);
+  if (rep_->key_positions == nullptr) {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Ignoring invalid key position block in file %s",
+                   rep_->file->file_name().c_str());
+  }
+  return Status::OK();
+}
+
 Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
     const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
     InternalIterator* meta_iter, BlockBasedTable* new_table, bool prefetch_all,
@@ -920,9 +1180,12 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
 
   const bool maybe_flushed =
       level == 0 && file_size <= max_file_size_for_l0_meta_pin;
+  const bool upper_level =
+      level >= 0 &&
+      level <= table_options.metadata_cache_options.max_upper_level;
   std::function<bool(PinningTier, PinningTier)> is_pinned =
-      [maybe_flushed, &is_pinned](PinningTier pinning_tier,
-                                  PinningTier fallback_pinning_tier) {
+      [maybe_flushed, upper_level, &is_pinned](
+          PinningTier pinning_tier, PinningTier fallback_pinning_tier) {
         // Fallback to fallback would lead to infinite recursion. Disallow it.
         assert(fallback_pinning_tier != PinningTier::kFallback);
 
@@ -936,6 +1199,8 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
             return maybe_flushed;
           case PinningTier::kAll:
             return true;
+          case PinningTier::kUpperLevels:
+            return upper_level;
         };
 
         // In GCC, this is needed to suppress `control reaches end of non-void
@@ -980,7 +1245,8 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
   // are hence follow the configuration for pin and prefetch regardless of
   // the value of cache_index_and_filter_blocks
   if (prefetch_all || pin_partition) {
-    s = rep_->index_reader->CacheDependencies(ro, pin_partition);
+    s = rep_->index_reader->CacheDependencies(ro, pin_partition,
+                                              prefetch_buffer);
   }
   if (!s.ok()) {
     return s;
@@ -1002,7 +1268,7 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
     if (filter) {
       // Refer to the comment above about paritioned indexes always being cached
       if (prefetch_all || pin_partition) {
-        s = filter->CacheDependencies(ro, pin_partition);
+        s = filter->CacheDependencies(ro, pin_partition, prefetch_buffer);
         if (!s.ok()) {
           return s;
         }
@@ -1047,9 +1313,74 @@ void BlockBasedTable::SetupForCompaction() {
 
 std::shared_ptr<const TableProperties> BlockBasedTable::GetTableProperties()
     const {
+  if (rep_->compact_reader && rep_->table_properties &&
+      !rep_->properties_handle.IsNull()) {
+    std::shared_ptr<const TableProperties> props = GetCachedTableProperties();
+    if (props) {
+      return props;
+    }
+  }
   return rep_->table_properties;
 }
 
+std::shared_ptr<const TableProperties>
+BlockBasedTable::GetCachedTableProperties() const {
+  // Keeps the cache alive for as long as the returned properties are
+  std::shared_ptr<Cache> block_cache = rep_->table_options.block_cache;
+  assert(block_cache != nullptr);
+
+  // No block is ever cached at the offset of the properties block
+  char cache_key_buf[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  Slice key =
+      GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
+                  rep_->properties_handle, cache_key_buf);
+  Cache::Handle* cache_handle = block_cache->Lookup(key, rep_->ioptions.stats);
+  if (cache_handle == nullptr) {
+    std::string handle_value;
+    rep_->properties_handle.EncodeTo(&handle_value);
+    TableProperties* table_properties = nullptr;
+    Status s = ReadTableProperties(ReadOptions(), nullptr /* prefetch_buffer */,
+                                   handle_value, &table_properties);
+    std::unique_ptr<TableProperties> props_guard(table_properties);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(rep_->ioptions.logger,
+                     "Encountered error while reading back properties of %s: "
+                     "%s",
+                     rep_->file->file_name().c_str(), s.ToString().c_str());
+      return nullptr;
+    }
+    const size_t charge = ApproximateTablePropertiesSize(*table_properties);
+    // On failure the cache frees the properties through the deleter
+    s = block_cache->Insert(
+        key, props_guard.release(), charge,
+        GetCacheEntryDeleterForRole<TableProperties,
+                                    CacheEntryRole::kOtherBlock>(),
+        &cache_handle);
+    if (!s.ok()) {
+      return nullptr;
+    }
+  }
+  assert(cache_handle != nullptr);
+  auto* props =
+      static_cast<const TableProperties*>(block_cache->Value(cache_handle));
+  return std::shared_ptr<const TableProperties>(
+      props, [block_cache, cache_handle](const TableProperties*) {
+        block_cache->Release(cache_handle);
+      });
+}
+
+void BlockBasedTable::PrepareScanStart(size_t readahead_size) {
+  if (readahead_size == 0 || rep_->file->use_direct_io()) {
+    return;
+  }
+  // Best effort: the file system may not support prefetching
+  rep_->file
+      ->Prefetch(0, static_cast<size_t>(
+                        std::min(static_cast<uint64_t>(readahead_size),
+                                 rep_->file_size)))
+      .PermitUncheckedError();
+}
+
 size_t BlockBasedTable::ApproximateMemoryUsage() const {
   size_t usage = 0;
   if (rep_->filter) {
@@ -1061,6 +1392,12 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->uncompression_dict_reader) {
     usage += rep_->uncompression_dict_reader->ApproximateMemoryUsage();
   }
+  if (rep_->range_filter) {
+    usage += rep_->range_filter->ApproximateMemoryUsage();
+  }
+  if (rep_->key_positions) {
+    usage += rep_->key_positions->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
@@ -1225,7 +1562,7 @@ Status BlockBasedTable::PutDataBlockToCache(
     CompressionType raw_block_comp_type,
     const UncompressionDict& uncompression_dict,
     MemoryAllocator* memory_allocator, BlockType block_type,
-    GetContext* get_context) const {
+    GetContext* get_context, BlockContents* uncompressed_contents) const {
   const ImmutableOptions& ioptions = rep_->ioptions;
   const uint32_t format_version = rep_->table_options.format_version;
   const size_t read_amp_bytes_per_bit =
@@ -1247,16 +1584,22 @@ Status BlockBasedTable::PutDataBlockToCache(
 
   std::unique_ptr<TBlocklike> block_holder;
   if (raw_block_comp_type != kNoCompression) {
-    // Retrieve the uncompressed contents into a new buffer
+    // Retrieve the uncompressed contents into a new buffer, unless the
+    // caller already did
     BlockContents uncompressed_block_contents;
-    UncompressionContext context(raw_block_comp_type);
-    UncompressionInfo info(context, uncompression_dict, raw_block_comp_type);
-    s = UncompressBlockContents(info, raw_block_contents->data.data(),
-                                raw_block_contents->data.size(),
-                                &uncompressed_block_contents, format_version,
-                                ioptions, memory_allocator);
-    if (!s.ok()) {
-      return s;
+    if (uncompressed_contents != nullptr) {
+      uncompressed_block_contents = std::move(*uncompressed_contents);
+    } else {
+      UncompressionContext context(raw_block_comp_type);
+      UncompressionInfo info(context, uncompression_dict,
+                             raw_block_comp_type);
+      s = UncompressBlockContents(info, raw_block_contents->data.data(),
+                                  raw_block_contents->data.size(),
+                                  &uncompressed_block_contents, format_version,
+                                  ioptions, memory_allocator);
+      if (!s.ok()) {
+        return s;
+      }
     }
 
     block_holder.reset(BlocklikeTraits<TBlocklike>::Create(
@@ -1401,7 +1744,8 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
     const BlockHandle& handle, const UncompressionDict& uncompression_dict,
     const bool wait, CachableEntry<TBlocklike>* block_entry,
     BlockType block_type, GetContext* get_context,
-    BlockCacheLookupContext* lookup_context, BlockContents* contents) const {
+    BlockCacheLookupContext* lookup_context, BlockContents* contents,
+    BlockContents* uncompressed_contents) const {
   assert(block_entry != nullptr);
   const bool no_io = (ro.read_tier == kBlockCacheTier);
   Cache* block_cache = rep_->table_options.block_cache.get();
@@ -1499,7 +1843,8 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
         s = PutDataBlockToCache(
             key, ckey, block_cache, block_cache_compressed, block_entry,
             contents, raw_block_comp_type, uncompression_dict,
-            GetMemoryAllocator(rep_->table_options), block_type, get_context);
+            GetMemoryAllocator(rep_->table_options), block_type, get_context,
+            uncompressed_contents);
       }
     }
   }
@@ -1708,6 +2053,10 @@ void BlockBasedTable::RetrieveMultipleBlocks(
     }
   }
 
+  // The raw contents of the blocks read, by index in the batch. The blocks
+  // that could not be read get their statuses set right away.
+  autovector<BlockContents, MultiGetContext::MAX_BATCH_SIZE> raw_blocks;
+  raw_blocks.resize(handles->size());
   idx_in_batch = 0;
   size_t valid_batch_idx = 0;
   for (auto mget_iter = batch->begin(); mget_iter != batch->end();
@@ -1803,55 +2152,105 @@ void BlockBasedTable::RetrieveMultipleBlocks(
         raw_block_contents.is_raw_block = true;
 #endif
       }
+      raw_blocks[idx_in_batch] = std::move(raw_block_contents);
     }
+    (*statuses)[idx_in_batch] = s;
+  }
 
-    if (s.ok()) {
-      if (options.fill_cache) {
-        BlockCacheLookupContext lookup_data_block_context(
-            TableReaderCaller::kUserMultiGet);
-        CachableEntry<Block>* block_entry = &(*results)[idx_in_batch];
-        // MaybeReadBlockAndLoadToCache will insert into the block caches if
-        // necessary. Since we're passing the raw block contents, it will
-        // avoid looking up the block cache
-        s = MaybeReadBlockAndLoadToCache(
-            nullptr, options, handle, uncompression_dict, /*wait=*/true,
-            block_entry, BlockType::kData, mget_iter->get_context,
-            &lookup_data_block_context, &raw_block_contents);
-
-        // block_entry value could be null if no block cache is present, i.e
-        // BlockBasedTableOptions::no_block_cache is true and no compressed
-        // block cache is configured. In that case, fall
-        // through and set up the block explicitly
-        if (block_entry->GetValue() != nullptr) {
-          s.PermitUncheckedError();
-          continue;
-        }
+  // With more than one compressed block, they can be uncompressed on several
+  // threads before going through the block cache one by one.
+  autovector<BlockContents, MultiGetContext::MAX_BATCH_SIZE>
+      uncompressed_blocks;
+  const int decompression_threads =
+      rep_->table_options.multiget_decompression_threads;
+  if (decompression_threads > 0) {
+    autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> compressed_blocks;
+    for (size_t i = 0; i < raw_blocks.size(); ++i) {
+      if (!(*handles)[i].IsNull() && (*statuses)[i].ok() &&
+          raw_blocks[i].get_compression_type() != kNoCompression) {
+        compressed_blocks.push_back(i);
       }
+    }
+    if (compressed_blocks.size() > 1) {
+      uncompressed_blocks.resize(raw_blocks.size());
+      RunInParallel(
+          compressed_blocks.size(), decompression_threads, [&](size_t i) {
+            const size_t idx = compressed_blocks[i];
+            const BlockContents& raw = raw_blocks[idx];
+            CompressionType compression_type = raw.get_compression_type();
+            UncompressionContext context(compression_type);
+            UncompressionInfo info(context, uncompression_dict,
+                                   compression_type);
+            (*statuses)[idx] = UncompressBlockContents(
+                info, raw.data.data(), raw.data.size(),
+                &uncompressed_blocks[idx], footer.version(), rep_->ioptions,
+                memory_allocator);
+          });
+    }
+  }
 
-      CompressionType compression_type =
-          raw_block_contents.get_compression_type();
-      BlockContents contents;
-      if (compression_type != kNoCompression) {
-        UncompressionContext context(compression_type);
-        UncompressionInfo info(context, uncompression_dict, compression_type);
-        s = UncompressBlockContents(info, req.result.data() + req_offset,
-                                    handle.size(), &contents, footer.version(),
-                                    rep_->ioptions, memory_allocator);
-      } else {
-        // There are two cases here:
-        // 1) caller uses the shared buffer (scratch or direct io buffer);
-        // 2) we use the requst buffer.
-        // If scratch buffer or direct io buffer is used, we ensure that
-        // all raw blocks are copyed to the heap as single blocks. If scratch
-        // buffer is not used, we also have no combined read, so the raw
-        // block can be used directly.
-        contents = std::move(raw_block_contents);
-      }
-      if (s.ok()) {
-        (*results)[idx_in_batch].SetOwnedValue(new Block(
-            std::move(contents), read_amp_bytes_per_bit, ioptions.stats));
+  idx_in_batch = 0;
+  for (auto mget_iter = batch->begin(); mget_iter != batch->end();
+       ++mget_iter, ++idx_in_batch) {
+    if ((*handles)[idx_in_batch].IsNull() || !(*statuses)[idx_in_batch].ok()) {
+      continue;
+    }
+    const BlockHandle& handle = (*handles)[idx_in_batch];
+    BlockContents& raw_block_contents = raw_blocks[idx_in_batch];
+    CompressionType compression_type =
+        raw_block_contents.get_compression_type();
+    BlockContents* uncompressed_contents =
+        compression_type != kNoCompression && !uncompressed_blocks.empty()
+            ? &uncompressed_blocks[idx_in_batch]
+            : nullptr;
+    Status s;
+    if (options.fill_cache) {
+      BlockCacheLookupContext lookup_data_block_context(
+          TableReaderCaller::kUserMultiGet);
+      CachableEntry<Block>* block_entry = &(*results)[idx_in_batch];
+      // MaybeReadBlockAndLoadToCache will insert into the block caches if
+      // necessary. Since we're passing the raw block contents, it will
+      // avoid looking up the block cache
+      s = MaybeReadBlockAndLoadToCache(
+          nullptr, options, handle, uncompression_dict, /*wait=*/true,
+          block_entry, BlockType::kData, mget_iter->get_context,
+          &lookup_data_block_context, &raw_block_contents,
+          uncompressed_contents);
+
+      // block_entry value could be null if no block cache is present, i.e
+      // BlockBasedTableOptions::no_block_cache is true and no compressed
+      // block cache is configured. In that case, fall
+      // through and set up the block explicitly
+      if (block_entry->GetValue() != nullptr) {
+        s.PermitUncheckedError();
+        continue;
       }
     }
+
+    BlockContents contents;
+    if (uncompressed_contents != nullptr) {
+      contents = std::move(*uncompressed_contents);
+    } else if (compression_type != kNoCompression) {
+      UncompressionContext context(compression_type);
+      UncompressionInfo info(context, uncompression_dict, compression_type);
+      s = UncompressBlockContents(info, raw_block_contents.data.data(),
+                                  raw_block_contents.data.size(), &contents,
+                                  footer.version(), rep_->ioptions,
+                                  memory_allocator);
+    } else {
+      // There are two cases here:
+      // 1) caller uses the shared buffer (scratch or direct io buffer);
+      // 2) we use the requst buffer.
+      // If scratch buffer or direct io buffer is used, we ensure that
+      // all raw blocks are copyed to the heap as single blocks. If scratch
+      // buffer is not used, we also have no combined read, so the raw
+      // block can be used directly.
+      contents = std::move(raw_block_contents);
+    }
+    if (s.ok()) {
+      (*results)[idx_in_batch].SetOwnedValue(new Block(
+          std::move(contents), read_amp_bytes_per_bit, ioptions.stats));
+    }
     (*statuses)[idx_in_batch] = s;
   }
 }
@@ -2013,6 +2412,21 @@ BlockBasedTable::PartitionedIndexIteratorState::NewSecondaryIterator(
 // cache.
 //
 // REQUIRES: this method shouldn't be called while the DB lock is held.
+bool BlockBasedTable::RangeMayMatch(const Slice* internal_key,
+                                    const ReadOptions& read_options) const {
+  if (rep_->range_filter == nullptr ||
+      read_options.iterate_upper_bound == nullptr) {
+    return true;
+  }
+  bool may_match = rep_->range_filter->RangeMayMatch(
+      internal_key ? ExtractUserKey(*internal_key) : Slice(),
+      read_options.iterate_upper_bound);
+  if (!may_match) {
+    RecordTick(rep_->ioptions.stats, RANGE_FILTER_USEFUL);
+  }
+  return may_match;
+}
+
 bool BlockBasedTable::PrefixMayMatch(
     const Slice& internal_key, const ReadOptions& read_options,
     const SliceTransform* options_prefix_extractor,
@@ -2128,6 +2542,9 @@ InternalIterator* BlockBasedTable::NewIterator(
     const ReadOptions& read_options, const SliceTransform* prefix_extractor,
     Arena* arena, bool skip_filters, TableReaderCaller caller,
     size_t compaction_readahead_size, bool allow_unprepared_value) {
+  if (!TimestampMayMatch(read_options)) {
+    return NewEmptyInternalIterator<Slice>(arena);
+  }
   BlockCacheLookupContext lookup_context{caller};
   bool need_upper_bound_check =
       read_options.auto_prefix_mode ||
@@ -2168,6 +2585,14 @@ FragmentedRangeTombstoneIterator* BlockBasedTable::NewRangeTombstoneIterator(
       rep_->fragmented_range_dels, rep_->internal_comparator, snapshot);
 }
 
+bool BlockBasedTable::TimestampMayMatch(const ReadOptions& read_options) const {
+  if (read_options.timestamp == nullptr || rep_->min_timestamp.empty()) {
+    return true;
+  }
+  return rep_->internal_comparator.user_comparator()->CompareTimestamp(
+             *read_options.timestamp, rep_->min_timestamp) >= 0;
+}
+
 bool BlockBasedTable::FullFilterKeyMayMatch(
     const ReadOptions& read_options, FilterBlockReader* filter,
     const Slice& internal_key, const bool no_io,
@@ -2176,24 +2601,34 @@ bool BlockBasedTable::FullFilterKeyMayMatch(
   if (filter == nullptr || filter->IsBlockBased()) {
     return true;
   }
+  assert(get_context != nullptr);
+  GetContextStats& stats = get_context->get_context_stats_;
   Slice user_key = ExtractUserKey(internal_key);
   const Slice* const const_ikey_ptr = &internal_key;
   bool may_match = true;
   size_t ts_sz = rep_->internal_comparator.user_comparator()->timestamp_size();
   Slice user_key_without_ts = StripTimestampFromUserKey(user_key, ts_sz);
+  Slice prefix;
   if (rep_->whole_key_filtering) {
     may_match =
         filter->KeyMayMatch(user_key_without_ts, prefix_extractor, kNotValid,
                             no_io, const_ikey_ptr, get_context, lookup_context);
+    ++stats.num_whole_key_filter_checked;
+    if (!may_match) {
+      ++stats.num_whole_key_filter_useful;
+    }
   } else if (!read_options.total_order_seek && prefix_extractor &&
              rep_->table_properties->prefix_extractor_name.compare(
                  prefix_extractor->Name()) == 0 &&
-             prefix_extractor->InDomain(user_key_without_ts) &&
-             !filter->PrefixMayMatch(
-                 prefix_extractor->Transform(user_key_without_ts),
-                 prefix_extractor, kNotValid, no_io, const_ikey_ptr,
-                 get_context, lookup_context)) {
-    may_match = false;
+             get_context->GetPrefix(prefix_extractor, user_key_without_ts,
+                                    &prefix)) {
+    may_match = filter->PrefixMayMatch(prefix, prefix_extractor, kNotValid,
+                                       no_io, const_ikey_ptr, get_context,
+                                       lookup_context);
+    ++stats.num_prefix_filter_checked;
+    if (!may_match) {
+      ++stats.num_prefix_filter_useful;
+    }
   }
   if (may_match) {
     RecordTick(rep_->ioptions.stats, BLOOM_FILTER_FULL_POSITIVE);
@@ -2249,6 +2684,9 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   assert(key.size() >= 8);  // key must be internal key
   assert(get_context != nullptr);
   Status s;
+  if (!TimestampMayMatch(read_options)) {
+    return s;
+  }
   const bool no_io = read_options.read_tier == kBlockCacheTier;
 
   FilterBlockReader* const filter =
@@ -2440,6 +2878,9 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
     assert(false);
     return;  // Nothing to do
   }
+  if (!TimestampMayMatch(read_options)) {
+    return;
+  }
 
   FilterBlockReader* const filter =
       !skip_filters ? rep_->filter.get() : nullptr;
@@ -2678,6 +3119,24 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
                 read_options, results[idx_in_batch], &first_biter,
                 statuses[idx_in_batch]);
             reusing_block = false;
+            if (first_biter.status().ok()) {
+              // The following keys without a block of their own are in this
+              // block too. Probe the hash index for all of them at once.
+              Slice block_keys[MultiGetContext::MAX_BATCH_SIZE];
+              size_t num_block_keys = 0;
+              block_keys[num_block_keys++] = key;
+              auto next = miter;
+              for (size_t j = idx_in_batch + 1;
+                   j < block_handles.size() && ++next != sst_file_range.end() &&
+                   block_handles[j].IsNull() && results[j].IsEmpty() &&
+                   num_block_keys < MultiGetContext::MAX_BATCH_SIZE;
+                   j++) {
+                block_keys[num_block_keys++] = next->ikey;
+              }
+              if (num_block_keys > 1) {
+                first_biter.PrefetchForGet(block_keys, num_block_keys);
+              }
+            }
           } else {
             // If handler is null and result is empty, then the status is never
             // set, which should be the initial value: ok().
@@ -2823,6 +3282,87 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
   }
 }
 
+void BlockBasedTable::PrefetchForMultiGet(
+    const ReadOptions& read_options, const MultiGetRange* mget_range,
+    const SliceTransform* prefix_extractor, bool skip_filters) {
+  if (mget_range->empty() || rep_->file->use_direct_io()) {
+    return;
+  }
+
+  // Never block on I/O here: the filter and index are consulted only if they
+  // are already cached, and keys we cannot locate are simply not prefetched.
+  ReadOptions ro = read_options;
+  ro.read_tier = kBlockCacheTier;
+  MultiGetRange sst_file_range(*mget_range, mget_range->begin(),
+                               mget_range->end());
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kUserMultiGet};
+
+  FilterBlockReader* const filter =
+      !skip_filters ? rep_->filter.get() : nullptr;
+  if (filter != nullptr && !filter->IsBlockBased() &&
+      rep_->whole_key_filtering) {
+    filter->KeysMayMatch(&sst_file_range, prefix_extractor, kNotValid,
+                         true /* no_io */, &lookup_context);
+    if (sst_file_range.empty()) {
+      return;
+    }
+  }
+
+  IndexBlockIter iiter_on_stack;
+  bool need_upper_bound_check = false;
+  if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
+    need_upper_bound_check = PrefixExtractorChanged(
+        rep_->table_properties.get(), prefix_extractor);
+  }
+  auto iiter = NewIndexIterator(ro, need_upper_bound_check, &iiter_on_stack,
+                                /*get_context=*/nullptr, &lookup_context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // Keys are sorted, so the blocks come in file order; coalesce adjacent
+  // blocks into a single request.
+  uint64_t last_offset = std::numeric_limits<uint64_t>::max();
+  uint64_t range_start = 0;
+  uint64_t range_end = 0;
+  size_t num_requests = 0;
+  for (auto miter = sst_file_range.begin(); miter != sst_file_range.end();
+       ++miter) {
+    iiter->Seek(miter->ikey);
+    if (!iiter->Valid()) {
+      continue;
+    }
+    const BlockHandle handle = iiter->value().handle;
+    if (handle.offset() == last_offset) {
+      continue;
+    }
+    last_offset = handle.offset();
+    if (BlockInCache(handle)) {
+      continue;
+    }
+    if (range_end > range_start && handle.offset() == range_end) {
+      range_end += block_size(handle);
+      continue;
+    }
+    if (range_end > range_start) {
+      rep_->file->Prefetch(range_start, range_end - range_start)
+          .PermitUncheckedError();
+      ++num_requests;
+    }
+    range_start = handle.offset();
+    range_end = range_start + block_size(handle);
+  }
+  if (range_end > range_start) {
+    rep_->file->Prefetch(range_start, range_end - range_start)
+        .PermitUncheckedError();
+    ++num_requests;
+  }
+  iiter->status().PermitUncheckedError();
+  TEST_SYNC_POINT_CALLBACK("BlockBasedTable::PrefetchForMultiGet:Requests",
+                           &num_requests);
+}
+
 Status BlockBasedTable::Prefetch(const Slice* const begin,
                                  const Slice* const end) {
   auto& comparator = rep_->internal_comparator;
@@ -2941,11 +3481,15 @@ Status BlockBasedTable::VerifyChecksumInBlocks(
     }
     BlockHandle handle = index_iter->value().handle;
     BlockContents contents;
+    // Reads like a compaction does, through the rate limiter if the file
+    // reader has one
     BlockFetcher block_fetcher(
         rep_->file.get(), &prefetch_buffer, rep_->footer, ReadOptions(), handle,
         &contents, rep_->ioptions, false /* decompress */,
         false /*maybe_compressed*/, BlockType::kData,
-        UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options);
+        UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options,
+        nullptr /* memory_allocator */,
+        nullptr /* memory_allocator_compressed */, true /* for_compaction */);
     s = block_fetcher.ReadBlockContents();
     if (!s.ok()) {
       break;
@@ -2988,6 +3532,22 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kHashIndexMetadata;
   }
 
+  if (meta_block_name == kRangeFilterBlock) {
+    return BlockType::kRangeFilter;
+  }
+
+  if (meta_block_name == kKeyPositionSummaryBlock) {
+    return BlockType::kKeyPositionSummary;
+  }
+
+  if (meta_block_name == kLearnedIndexBlock) {
+    return BlockType::kLearnedIndex;
+  }
+
+  if (meta_block_name == kEliasFanoIndexBlock) {
+    return BlockType::kEliasFanoIndex;
+  }
+
   assert(false);
   return BlockType::kInvalid;
 }
@@ -3028,6 +3588,10 @@ Status BlockBasedTable::VerifyChecksumInMetaBlocks(
 }
 
 bool BlockBasedTable::TEST_BlockInCache(const BlockHandle& handle) const {
+  return BlockInCache(handle);
+}
+
+bool BlockBasedTable::BlockInCache(const BlockHandle& handle) const {
   assert(rep_ != nullptr);
 
   Cache* const cache = rep_->table_options.block_cache.get();
@@ -3125,6 +3689,44 @@ Status BlockBasedTable::CreateIndexReader(
                                        pin, lookup_context, index_reader);
       }
     }
+    case BlockBasedTableOptions::kLearned: {
+      std::unique_ptr<Block> metaindex_guard;
+      std::unique_ptr<InternalIterator> metaindex_iter_guard;
+      auto meta_index_iter = preloaded_meta_index_iter;
+      if (meta_index_iter == nullptr) {
+        auto s = ReadMetaIndexBlock(ro, prefetch_buffer, &metaindex_guard,
+                                    &metaindex_iter_guard);
+        if (!s.ok()) {
+          // Without the model the index is still binary searchable.
+          ROCKS_LOG_WARN(rep_->ioptions.logger,
+                         "Unable to read the metaindex block."
+                         " Fall back to binary search index.");
+        }
+        meta_index_iter = metaindex_iter_guard.get();
+      }
+      return LearnedIndexReader::Create(this, ro, prefetch_buffer,
+                                        meta_index_iter, use_cache, prefetch,
+                                        pin, lookup_context, index_reader);
+    }
+    case BlockBasedTableOptions::kEliasFano: {
+      std::unique_ptr<Block> metaindex_guard;
+      std::unique_ptr<InternalIterator> metaindex_iter_guard;
+      auto meta_index_iter = preloaded_meta_index_iter;
+      if (meta_index_iter == nullptr) {
+        auto s = ReadMetaIndexBlock(ro, prefetch_buffer, &metaindex_guard,
+                                    &metaindex_iter_guard);
+        if (!s.ok()) {
+          // The index block is still binary searchable.
+          ROCKS_LOG_WARN(rep_->ioptions.logger,
+                         "Unable to read the metaindex block."
+                         " Fall back to binary search index.");
+        }
+        meta_index_iter = metaindex_iter_guard.get();
+      }
+      return EliasFanoIndexReader::Create(this, ro, prefetch_buffer,
+                                          meta_index_iter, use_cache, prefetch,
+                                          pin, lookup_context, index_reader);
+    }
     default: {
       std::string error_message =
           "Unrecognized index type: " + ToString(rep_->index_type);
@@ -3164,22 +3766,26 @@ uint64_t BlockBasedTable::ApproximateOffsetOf(const Slice& key,
     return rep_->file_size / 2;
   }
 
-  BlockCacheLookupContext context(caller);
-  IndexBlockIter iiter_on_stack;
-  ReadOptions ro;
-  ro.total_order_seek = true;
-  auto index_iter =
-      NewIndexIterator(ro, /*disable_prefix_seek=*/true,
-                       /*input_iter=*/&iiter_on_stack, /*get_context=*/nullptr,
-                       /*lookup_context=*/&context);
-  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
-  if (index_iter != &iiter_on_stack) {
-    iiter_unique_ptr.reset(index_iter);
-  }
-
-  index_iter->Seek(key);
+  uint64_t offset;
+  if (rep_->key_positions) {
+    offset = rep_->key_positions->ApproximatePosition(key).data_offset;
+  } else {
+    BlockCacheLookupContext context(caller);
+    IndexBlockIter iiter_on_stack;
+    ReadOptions ro;
+    ro.total_order_seek = true;
+    auto index_iter = NewIndexIterator(
+        ro, /*disable_prefix_seek=*/true,
+        /*input_iter=*/&iiter_on_stack, /*get_context=*/nullptr,
+        /*lookup_context=*/&context);
+    std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+    if (index_iter != &iiter_on_stack) {
+      iiter_unique_ptr.reset(index_iter);
+    }
 
-  uint64_t offset = ApproximateDataOffsetOf(*index_iter, data_size);
+    index_iter->Seek(key);
+    offset = ApproximateDataOffsetOf(*index_iter, data_size);
+  }
   // Pro-rate file metadata (incl filters) size-proportionally across data
   // blocks.
   double size_ratio =
@@ -3199,9 +3805,63 @@ uint64_t BlockBasedTable::ApproximateSize(const Slice& start, const Slice& end,
     return rep_->file_size;
   }
 
-  BlockCacheLookupContext context(caller);
+  uint64_t start_offset;
+  uint64_t end_offset;
+  if (rep_->key_positions) {
+    start_offset = rep_->key_positions->ApproximatePosition(start).data_offset;
+    end_offset = rep_->key_positions->ApproximatePosition(end).data_offset;
+  } else {
+    BlockCacheLookupContext context(caller);
+    IndexBlockIter iiter_on_stack;
+    ReadOptions ro;
+    ro.total_order_seek = true;
+    auto index_iter = NewIndexIterator(
+        ro, /*disable_prefix_seek=*/true,
+        /*input_iter=*/&iiter_on_stack, /*get_context=*/nullptr,
+        /*lookup_context=*/&context);
+    std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+    if (index_iter != &iiter_on_stack) {
+      iiter_unique_ptr.reset(index_iter);
+    }
+
+    index_iter->Seek(start);
+    start_offset = ApproximateDataOffsetOf(*index_iter, data_size);
+    index_iter->Seek(end);
+    end_offset = ApproximateDataOffsetOf(*index_iter, data_size);
+  }
+
+  assert(end_offset >= start_offset);
+  // Pro-rate file metadata (incl filters) size-proportionally across data
+  // blocks.
+  double size_ratio = static_cast<double>(end_offset - start_offset) /
+                      static_cast<double>(data_size);
+  return static_cast<uint64_t>(size_ratio *
+                               static_cast<double>(rep_->file_size));
+}
+
+Status BlockBasedTable::ApproximateNumEntries(const Slice& start,
+                                              const Slice& end,
+                                              TableReaderCaller /*caller*/,
+                                              uint64_t* num_entries) {
+  assert(rep_->internal_comparator.Compare(start, end) <= 0);
+  assert(num_entries != nullptr);
+  if (rep_->key_positions == nullptr) {
+    return Status::NotSupported("Table has no key position summary");
+  }
+  uint64_t start_entries =
+      rep_->key_positions->ApproximatePosition(start).num_entries;
+  uint64_t end_entries =
+      rep_->key_positions->ApproximatePosition(end).num_entries;
+  *num_entries = end_entries >= start_entries ? end_entries - start_entries : 0;
+  return Status::OK();
+}
+
+Status BlockBasedTable::ApproximateKeyAnchors(const ReadOptions& read_options,
+                                              std::vector<Anchor>* anchors) {
+  assert(anchors != nullptr);
+  BlockCacheLookupContext context(TableReaderCaller::kUserApproximateSize);
   IndexBlockIter iiter_on_stack;
-  ReadOptions ro;
+  ReadOptions ro = read_options;
   ro.total_order_seek = true;
   auto index_iter =
       NewIndexIterator(ro, /*disable_prefix_seek=*/true,
@@ -3212,18 +3872,276 @@ uint64_t BlockBasedTable::ApproximateSize(const Slice& start, const Slice& end,
     iiter_unique_ptr.reset(index_iter);
   }
 
-  index_iter->Seek(start);
-  uint64_t start_offset = ApproximateDataOffsetOf(*index_iter, data_size);
-  index_iter->Seek(end);
-  uint64_t end_offset = ApproximateDataOffsetOf(*index_iter, data_size);
+  uint64_t num_blocks = rep_->table_properties
+                            ? rep_->table_properties->num_data_blocks
+                            : 0;
+  if (num_blocks == 0) {
+    for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+      ++num_blocks;
+    }
+    if (!index_iter->status().ok()) {
+      return index_iter->status();
+    }
+  }
+  const uint64_t blocks_per_anchor =
+      std::max<uint64_t>(1, (num_blocks + kMaxNumAnchors - 1) / kMaxNumAnchors);
 
-  assert(end_offset >= start_offset);
   // Pro-rate file metadata (incl filters) size-proportionally across data
-  // blocks.
-  double size_ratio = static_cast<double>(end_offset - start_offset) /
-                      static_cast<double>(data_size);
-  return static_cast<uint64_t>(size_ratio *
-                               static_cast<double>(rep_->file_size));
+  // blocks, as ApproximateSize() does.
+  uint64_t data_size = GetApproximateDataSize();
+  double size_ratio =
+      data_size == 0 ? 1.0
+                     : static_cast<double>(rep_->file_size) /
+                           static_cast<double>(data_size);
+  uint64_t range_size = 0;
+  uint64_t blocks_in_range = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    range_size += block_size(index_iter->value().handle);
+    if (++blocks_in_range == blocks_per_anchor) {
+      anchors->emplace_back(index_iter->user_key(),
+                            static_cast<uint64_t>(range_size * size_ratio));
+      range_size = 0;
+      blocks_in_range = 0;
+    }
+  }
+  if (index_iter->status().ok() && blocks_in_range > 0) {
+    index_iter->SeekToLast();
+    if (index_iter->Valid()) {
+      anchors->emplace_back(index_iter->user_key(),
+                            static_cast<uint64_t>(range_size * size_ratio));
+    }
+  }
+  return index_iter->status();
+}
+
+Slice BlockBasedTable::GetBlockCacheKeyPrefix() const {
+  if (rep_->table_options.block_cache == nullptr) {
+    return Slice();
+  }
+  return Slice(rep_->cache_key_prefix, rep_->cache_key_prefix_size);
+}
+
+namespace {
+// Default size limit of the reads of WarmUpBlockCache()
+const size_t kDefaultWarmUpReadSize = 2 << 20;
+// Blocks at most this far apart are read together by WarmUpBlockCache(),
+// since reading the gap is cheaper than another I/O.
+const uint64_t kMaxWarmUpReadGap = 64 << 10;
+}  // namespace
+
+Status BlockBasedTable::WarmUpBlockCache(
+    const ReadOptions& read_options,
+    const std::vector<uint64_t>& block_offsets) {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  if (block_cache == nullptr || block_offsets.empty()) {
+    return Status::OK();
+  }
+  assert(std::is_sorted(block_offsets.begin(), block_offsets.end()));
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
+  IndexBlockIter iiter_on_stack;
+  ReadOptions ro = read_options;
+  ro.total_order_seek = true;
+  ro.fill_cache = true;
+  auto iiter =
+      NewIndexIterator(ro, /*disable_prefix_seek=*/true, &iiter_on_stack,
+                       /*get_context=*/nullptr, &lookup_context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // Find the requested data blocks that are not cached yet
+  std::vector<BlockHandle> handles;
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  auto next = block_offsets.begin();
+  for (iiter->SeekToFirst(); iiter->Valid() && next != block_offsets.end();
+       iiter->Next()) {
+    const BlockHandle& handle = iiter->value().handle;
+    while (next != block_offsets.end() && *next < handle.offset()) {
+      ++next;
+    }
+    if (next == block_offsets.end() || *next != handle.offset()) {
+      continue;
+    }
+    Slice key = GetCacheKey(rep_->cache_key_prefix,
+                            rep_->cache_key_prefix_size, handle, cache_key);
+    Cache::Handle* cache_handle = block_cache->Lookup(key);
+    if (cache_handle != nullptr) {
+      block_cache->Release(cache_handle);
+    } else {
+      handles.push_back(handle);
+    }
+  }
+  if (!iiter->status().ok()) {
+    return iiter->status();
+  }
+
+  // Read each run of nearby blocks into a buffer at once, then load its
+  // blocks into the cache from there.
+  const uint64_t max_read_size =
+      ro.readahead_size > 0 ? ro.readahead_size : kDefaultWarmUpReadSize;
+  IOOptions opts;
+  Status s = rep_->file->PrepareIOOptions(ro, opts);
+  size_t i = 0;
+  while (s.ok() && i < handles.size()) {
+    const uint64_t start = handles[i].offset();
+    uint64_t end = start + block_size(handles[i]);
+    size_t run_end = i + 1;
+    while (run_end < handles.size() &&
+           handles[run_end].offset() <= end + kMaxWarmUpReadGap &&
+           handles[run_end].offset() + block_size(handles[run_end]) - start <=
+               max_read_size) {
+      end = handles[run_end].offset() + block_size(handles[run_end]);
+      ++run_end;
+    }
+    FilePrefetchBuffer prefetch_buffer;
+    s = prefetch_buffer.Prefetch(opts, rep_->file.get(), start,
+                                 static_cast<size_t>(end - start));
+    for (; s.ok() && i < run_end; ++i) {
+      DataBlockIter biter;
+      NewDataBlockIterator<DataBlockIter>(
+          ro, handles[i], &biter, BlockType::kData, /*get_context=*/nullptr,
+          &lookup_context, Status(), &prefetch_buffer);
+      s = biter.status();
+    }
+  }
+  return s;
+}
+
+class BlockBasedTable::RawDataBlockIter : public RawDataBlockIterator {
+ public:
+  RawDataBlockIter(const BlockBasedTable* table,
+                   const ReadOptions& read_options)
+      : table_(table),
+        read_options_(read_options),
+        lookup_context_(TableReaderCaller::kCompaction) {
+    read_options_.total_order_seek = true;
+    read_options_.fill_cache = false;
+    const Rep* rep = table_->get_rep();
+    size_t readahead_size = read_options_.readahead_size != 0
+                                ? read_options_.readahead_size
+                                : rep->table_options.max_auto_readahead_size;
+    prefetch_buffer_.reset(new FilePrefetchBuffer(
+        rep->file.get(), readahead_size, readahead_size,
+        !rep->ioptions.allow_mmap_reads /* enable */));
+    index_iter_.reset(table_->NewIndexIterator(
+        read_options_, /*disable_prefix_seek=*/true, /*input_iter=*/nullptr,
+        /*get_context=*/nullptr, &lookup_context_));
+  }
+
+  void Seek(const Slice& target) override {
+    index_iter_->Seek(target);
+    ReadBlock();
+  }
+
+  void Next() override {
+    assert(Valid());
+    index_iter_->Next();
+    ReadBlock();
+  }
+
+  bool Valid() const override { return valid_; }
+  Status status() const override { return status_; }
+  Slice contents() const override { return stored_.data; }
+  CompressionType compression_type() const override {
+    return compression_type_;
+  }
+
+  const std::vector<std::pair<Slice, Slice>>& entries() const override {
+    return entries_;
+  }
+
+  uint32_t compress_format_version() const override {
+    return GetCompressFormatForVersion(table_->get_rep()->footer.version());
+  }
+
+ private:
+  void ReadBlock() {
+    valid_ = false;
+    entries_.clear();
+    block_.reset();
+    stored_ = BlockContents();
+    if (!index_iter_->Valid()) {
+      status_ = index_iter_->status();
+      return;
+    }
+    const Rep* rep = table_->get_rep();
+    BlockFetcher block_fetcher(
+        rep->file.get(), prefetch_buffer_.get(), rep->footer, read_options_,
+        index_iter_->value().handle, &stored_, rep->ioptions,
+        false /* do_uncompress */, true /* maybe_compressed */,
+        BlockType::kData, UncompressionDict::GetEmptyDict(),
+        rep->persistent_cache_options);
+    status_ = block_fetcher.ReadBlockContents();
+    if (!status_.ok()) {
+      return;
+    }
+    compression_type_ = block_fetcher.get_compression_type();
+    BlockContents uncompressed;
+    if (compression_type_ == kNoCompression) {
+      uncompressed = BlockContents(stored_.data);
+    } else {
+      UncompressionContext context(compression_type_);
+      UncompressionInfo info(context, UncompressionDict::GetEmptyDict(),
+                             compression_type_);
+      status_ = UncompressBlockContents(
+          info, stored_.data.data(), stored_.data.size(), &uncompressed,
+          rep->footer.version(), rep->ioptions);
+      if (!status_.ok()) {
+        return;
+      }
+    }
+    block_.reset(new Block(std::move(uncompressed)));
+
+    // Keys may be delta encoded, so they are materialized in keys_; values
+    // point into the block.
+    keys_.clear();
+    std::vector<size_t> key_ends;
+    std::vector<Slice> values;
+    std::unique_ptr<DataBlockIter> iter(block_->NewDataIterator(
+        rep->internal_comparator.user_comparator(),
+        kDisableGlobalSequenceNumber));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      keys_.append(iter->key().data(), iter->key().size());
+      key_ends.push_back(keys_.size());
+      values.push_back(iter->value());
+    }
+    status_ = iter->status();
+    if (!status_.ok()) {
+      return;
+    }
+    size_t key_start = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+      entries_.emplace_back(
+          Slice(keys_.data() + key_start, key_ends[i] - key_start),
+          values[i]);
+      key_start = key_ends[i];
+    }
+    valid_ = !entries_.empty();
+  }
+
+  const BlockBasedTable* table_;
+  ReadOptions read_options_;
+  BlockCacheLookupContext lookup_context_;
+  std::unique_ptr<FilePrefetchBuffer> prefetch_buffer_;
+  std::unique_ptr<InternalIteratorBase<IndexValue>> index_iter_;
+
+  bool valid_ = false;
+  Status status_;
+  BlockContents stored_;
+  CompressionType compression_type_ = kNoCompression;
+  std::unique_ptr<Block> block_;
+  std::string keys_;
+  std::vector<std::pair<Slice, Slice>> entries_;
+};
+
+RawDataBlockIterator* BlockBasedTable::NewRawDataBlockIterator(
+    const ReadOptions& read_options) {
+  if (!rep_->compression_dict_handle.IsNull() ||
+      rep_->global_seqno != kDisableGlobalSequenceNumber) {
+    return nullptr;
+  }
+  return new RawDataBlockIter(this, read_options);
 }
 
 bool BlockBasedTable::TEST_FilterBlockInCache() const {
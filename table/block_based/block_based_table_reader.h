@@ -15,6 +15,8 @@
 #include "table/block_based/block_type.h"
 #include "table/block_based/cachable_entry.h"
 #include "table/block_based/filter_block.h"
+#include "table/block_based/key_position_summary.h"
+#include "table/block_based/range_filter_block.h"
 #include "table/block_based/uncompression_dict_reader.h"
 #include "table/table_properties_internal.h"
 #include "table/table_reader.h"
@@ -109,6 +111,14 @@ class BlockBasedTable : public TableReader {
                       const bool need_upper_bound_check,
                       BlockCacheLookupContext* lookup_context) const;
 
+  // Returns false only if the table has no user key in the range from
+  // the user key of internal_key (or from the start if nullptr) to
+  // read_options.iterate_upper_bound, according to the range filter (see
+  // BlockBasedTableOptions::range_filter_prefix_len). Returns true if the
+  // table has no range filter or there is no upper bound.
+  bool RangeMayMatch(const Slice* internal_key,
+                     const ReadOptions& read_options) const;
+
   // Returns a new iterator over the table contents.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -136,6 +146,11 @@ class BlockBasedTable : public TableReader {
                 const SliceTransform* prefix_extractor,
                 bool skip_filters = false) override;
 
+  void PrefetchForMultiGet(const ReadOptions& readOptions,
+                           const MultiGetContext::Range* mget_range,
+                           const SliceTransform* prefix_extractor,
+                           bool skip_filters = false) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
@@ -157,6 +172,29 @@ class BlockBasedTable : public TableReader {
   uint64_t ApproximateSize(const Slice& start, const Slice& end,
                            TableReaderCaller caller) override;
 
+  // Estimated from the key position summary (see
+  // BlockBasedTableOptions::key_position_samples). Not supported for
+  // tables without one.
+  Status ApproximateNumEntries(const Slice& start, const Slice& end,
+                               TableReaderCaller caller,
+                               uint64_t* num_entries) override;
+
+  // Samples the index: every n-th data block boundary becomes an anchor.
+  Status ApproximateKeyAnchors(const ReadOptions& read_options,
+                               std::vector<Anchor>* anchors) override;
+
+  Slice GetBlockCacheKeyPrefix() const override;
+
+  // Walks the index in file order and reads runs of the requested blocks
+  // that are missing from the block cache with one read per run.
+  Status WarmUpBlockCache(const ReadOptions& read_options,
+                          const std::vector<uint64_t>& block_offsets) override;
+
+  // Not supported for tables with a compression dictionary or a global
+  // sequence number.
+  RawDataBlockIterator* NewRawDataBlockIterator(
+      const ReadOptions& read_options) override;
+
   bool TEST_BlockInCache(const BlockHandle& handle) const;
 
   // Returns true if the block for the specified key is in cache.
@@ -171,6 +209,10 @@ class BlockBasedTable : public TableReader {
 
   size_t ApproximateMemoryUsage() const override;
 
+  // Data blocks start at offset 0, so this hints the file system to read
+  // ahead from there
+  void PrepareScanStart(size_t readahead_size) override;
+
   // convert SST file to a human readable form
   Status DumpTable(WritableFile* out_file) override;
 
@@ -205,8 +247,11 @@ class BlockBasedTable : public TableReader {
     virtual size_t ApproximateMemoryUsage() const = 0;
     // Cache the dependencies of the index reader (e.g. the partitions
     // of a partitioned index).
-    virtual Status CacheDependencies(const ReadOptions& /*ro*/,
-                                     bool /* pin */) {
+    // `tail_prefetch_buffer`, if not null, holds the tail of the file read
+    // when opening it.
+    virtual Status CacheDependencies(
+        const ReadOptions& /*ro*/, bool /* pin */,
+        FilePrefetchBuffer* /* tail_prefetch_buffer */) {
       return Status::OK();
     }
   };
@@ -246,6 +291,7 @@ class BlockBasedTable : public TableReader {
                                    TBlockIter* input_iter, Status s) const;
 
   class PartitionedIndexIteratorState;
+  class RawDataBlockIter;
 
   template <typename TBlocklike>
   friend class FilterBlockReaderCommon;
@@ -296,13 +342,16 @@ class BlockBasedTable : public TableReader {
   // @param block_entry value is set to the uncompressed block if found. If
   //    in uncompressed block cache, also sets cache_handle to reference that
   //    block.
+  // @param uncompressed_contents if non-null, the already uncompressed
+  //    `contents`, which are then not uncompressed again
   template <typename TBlocklike>
   Status MaybeReadBlockAndLoadToCache(
       FilePrefetchBuffer* prefetch_buffer, const ReadOptions& ro,
       const BlockHandle& handle, const UncompressionDict& uncompression_dict,
       const bool wait, CachableEntry<TBlocklike>* block_entry,
       BlockType block_type, GetContext* get_context,
-      BlockCacheLookupContext* lookup_context, BlockContents* contents) const;
+      BlockCacheLookupContext* lookup_context, BlockContents* contents,
+      BlockContents* uncompressed_contents = nullptr) const;
 
   // Similar to the above, with one crucial difference: it will retrieve the
   // block from the file even if there are no caches configured (assuming the
@@ -367,6 +416,8 @@ class BlockBasedTable : public TableReader {
   // PutDataBlockToCache(). After the call, the object will be invalid.
   // @param uncompression_dict Data for presetting the compression library's
   //    dictionary.
+  // @param uncompressed_contents if non-null, the already uncompressed
+  //    raw_block_contents, which will be moved from as well
   template <typename TBlocklike>
   Status PutDataBlockToCache(const Slice& block_cache_key,
                              const Slice& compressed_block_cache_key,
@@ -377,7 +428,8 @@ class BlockBasedTable : public TableReader {
                              const UncompressionDict& uncompression_dict,
                              MemoryAllocator* memory_allocator,
                              BlockType block_type,
-                             GetContext* get_context) const;
+                             GetContext* get_context,
+                             BlockContents* uncompressed_contents) const;
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
@@ -396,6 +448,13 @@ class BlockBasedTable : public TableReader {
                            BlockCacheLookupContext* lookup_context,
                            std::unique_ptr<IndexReader>* index_reader);
 
+  // Returns true if the block is in the uncompressed block cache.
+  bool BlockInCache(const BlockHandle& handle) const;
+
+  // Returns false if all keys of the table have timestamps newer than
+  // read_options.timestamp, so that none of them is visible to the read
+  bool TimestampMayMatch(const ReadOptions& read_options) const;
+
   bool FullFilterKeyMayMatch(const ReadOptions& read_options,
                              FilterBlockReader* filter, const Slice& user_key,
                              const bool no_io,
@@ -420,10 +479,19 @@ class BlockBasedTable : public TableReader {
                             FilePrefetchBuffer* prefetch_buffer,
                             std::unique_ptr<Block>* metaindex_block,
                             std::unique_ptr<InternalIterator>* iter);
-  Status TryReadPropertiesWithGlobalSeqno(const ReadOptions& ro,
-                                          FilePrefetchBuffer* prefetch_buffer,
-                                          const Slice& handle_value,
-                                          TableProperties** table_properties);
+  Status TryReadPropertiesWithGlobalSeqno(
+      const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
+      const Slice& handle_value, TableProperties** table_properties) const;
+  // Reads the properties block at the encoded handle `handle_value`,
+  // tolerating the checksum mismatch of an ingested file whose global seqno
+  // was rewritten.
+  Status ReadTableProperties(const ReadOptions& ro,
+                             FilePrefetchBuffer* prefetch_buffer,
+                             const Slice& handle_value,
+                             TableProperties** table_properties) const;
+  // The complete table properties of a compact table reader, looked up in or
+  // read back into the block cache. Null on failure.
+  std::shared_ptr<const TableProperties> GetCachedTableProperties() const;
   Status ReadPropertiesBlock(const ReadOptions& ro,
                              FilePrefetchBuffer* prefetch_buffer,
                              InternalIterator* meta_iter,
@@ -433,12 +501,27 @@ class BlockBasedTable : public TableReader {
                            InternalIterator* meta_iter,
                            const InternalKeyComparator& internal_comparator,
                            BlockCacheLookupContext* lookup_context);
+  Status ReadRangeFilterBlock(const ReadOptions& ro,
+                              FilePrefetchBuffer* prefetch_buffer,
+                              InternalIterator* meta_iter);
+  Status ReadKeyPositionSummaryBlock(const ReadOptions& ro,
+                                     FilePrefetchBuffer* prefetch_buffer,
+                                     InternalIterator* meta_iter);
   Status PrefetchIndexAndFilterBlocks(
       const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
       InternalIterator* meta_iter, BlockBasedTable* new_table,
       bool prefetch_all, const BlockBasedTableOptions& table_options,
       const int level, size_t file_size, size_t max_file_size_for_l0_meta_pin,
       BlockCacheLookupContext* lookup_context);
+  // Sets `*buffer` to the buffer to read the partitions of a partitioned
+  // index or filter, in [offset, offset + len), from: `tail_prefetch_buffer`
+  // if it already holds all of them, else `prefetch_buffer`, created to read
+  // them in one IO.
+  Status PrefetchPartitions(
+      const ReadOptions& ro, uint64_t offset, uint64_t len,
+      FilePrefetchBuffer* tail_prefetch_buffer,
+      std::unique_ptr<FilePrefetchBuffer>* prefetch_buffer,
+      FilePrefetchBuffer** buffer) const;
 
   static BlockType GetBlockTypeForMetaBlockByName(const Slice& meta_block_name);
 
@@ -580,6 +663,9 @@ struct BlockBasedTable::Rep {
   BlockHandle compression_dict_handle;
 
   std::shared_ptr<const TableProperties> table_properties;
+  // Location of the properties block. Used by compact table readers, whose
+  // table_properties are trimmed, to read back the complete properties.
+  BlockHandle properties_handle;
   BlockBasedTableOptions::IndexType index_type;
   bool hash_index_allow_collision;
   bool whole_key_filtering;
@@ -594,6 +680,15 @@ struct BlockBasedTable::Rep {
 
   std::shared_ptr<const FragmentedRangeTombstoneList> fragmented_range_dels;
 
+  // The oldest user-defined timestamp in the table, empty if unknown
+  std::string min_timestamp;
+
+  // Null if the table has no range filter
+  std::unique_ptr<RangeFilterBlockReader> range_filter;
+
+  // Null if the table has no key position summary
+  std::unique_ptr<KeyPositionSummaryReader> key_positions;
+
   // If global_seqno is used, all Keys in this file will have the same
   // seqno with value `global_seqno`.
   //
@@ -625,6 +720,10 @@ struct BlockBasedTable::Rep {
 
   const bool immortal_table;
 
+  // See BlockBasedTableOptions::compact_table_reader. Only set when a block
+  // cache is available.
+  bool compact_reader = false;
+
   SequenceNumber get_global_seqno(BlockType block_type) const {
     return (block_type == BlockType::kFilter ||
             block_type == BlockType::kCompressionDictionary)
@@ -652,20 +751,21 @@ struct BlockBasedTable::Rep {
   void CreateFilePrefetchBuffer(size_t readahead_size,
                                 size_t max_readahead_size,
                                 std::unique_ptr<FilePrefetchBuffer>* fpb,
-                                bool implicit_auto_readahead) const {
+                                bool implicit_auto_readahead,
+                                bool async_io = false) const {
     fpb->reset(new FilePrefetchBuffer(
         file.get(), readahead_size, max_readahead_size,
         !ioptions.allow_mmap_reads /* enable */, false /* track_min_offset*/,
-        implicit_auto_readahead));
+        implicit_auto_readahead, ioptions.fs.get(), async_io));
   }
 
   void CreateFilePrefetchBufferIfNotExists(
       size_t readahead_size, size_t max_readahead_size,
-      std::unique_ptr<FilePrefetchBuffer>* fpb,
-      bool implicit_auto_readahead) const {
+      std::unique_ptr<FilePrefetchBuffer>* fpb, bool implicit_auto_readahead,
+      bool async_io = false) const {
     if (!(*fpb)) {
       CreateFilePrefetchBuffer(readahead_size, max_readahead_size, fpb,
-                               implicit_auto_readahead);
+                               implicit_auto_readahead, async_io);
     }
   }
 };
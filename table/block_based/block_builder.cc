@@ -30,6 +30,24 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// With separate_key_value, the values are instead stored together after the
+// restart array, in the same order as their keys, so that searching a block
+// only has to read key bytes. Each entry then only holds the key part
+// (shared_bytes, unshared_bytes, value_length, key_delta), and the trailer
+// has the form:
+//     restarts: uint32[num_restarts]
+//     values: char[]
+//     value_restarts: uint32[num_restarts]
+//     num_restarts: uint32 (with kSeparateKeyValueBit set)
+// value_restarts[i] contains the offset within the block of the value of the
+// ith restart point. The value of any other entry starts where the value of
+// the previous entry ends.
+//
+// With restart_key_prefixes, the restart array is directly followed by
+//     restart_key_prefixes: uint64[num_restarts]
+// and kRestartKeyPrefixesBit is set in num_restarts. restart_key_prefixes[i]
+// is the RestartKeyPrefix() of the user key of the ith restart point.
 
 #include "table/block_based/block_builder.h"
 
@@ -46,10 +64,13 @@ BlockBuilder::BlockBuilder(
     int block_restart_interval, bool use_delta_encoding,
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    double data_block_hash_table_util_ratio)
+    double data_block_hash_table_util_ratio, bool separate_key_value,
+    bool restart_key_prefixes, bool wide_hash_index)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
+      separate_key_value_(separate_key_value),
+      restart_key_prefixes_(restart_key_prefixes),
       restarts_(),
       counter_(0),
       finished_(false) {
@@ -58,14 +79,23 @@ BlockBuilder::BlockBuilder(
       break;
     case BlockBasedTableOptions::kDataBlockBinaryAndHash:
       data_block_hash_index_builder_.Initialize(
-          data_block_hash_table_util_ratio);
+          data_block_hash_table_util_ratio, wide_hash_index);
       break;
     default:
       assert(0);
   }
   assert(block_restart_interval_ >= 1);
+  // Values are only delta encoded in index blocks
+  assert(!use_value_delta_encoding_ || !separate_key_value_);
   restarts_.push_back(0);  // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (separate_key_value_) {
+    value_restarts_.push_back(0);
+    estimate_ += sizeof(uint32_t);
+  }
+  if (restart_key_prefixes_) {
+    estimate_ += sizeof(uint64_t);
+  }
 }
 
 void BlockBuilder::Reset() {
@@ -73,6 +103,16 @@ void BlockBuilder::Reset() {
   restarts_.clear();
   restarts_.push_back(0);  // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (separate_key_value_) {
+    values_buffer_.clear();
+    value_restarts_.clear();
+    value_restarts_.push_back(0);
+    estimate_ += sizeof(uint32_t);
+  }
+  if (restart_key_prefixes_) {
+    restart_key_prefixes_buffer_.clear();
+    estimate_ += sizeof(uint64_t);
+  }
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
@@ -101,6 +141,12 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
 
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t);  // a new restart entry.
+    if (separate_key_value_) {
+      estimate += sizeof(uint32_t);  // a new value restart entry.
+    }
+    if (restart_key_prefixes_) {
+      estimate += sizeof(uint64_t);  // a new restart key prefix.
+    }
   }
 
   estimate += sizeof(int32_t);  // varint for shared prefix length.
@@ -121,16 +167,36 @@ Slice BlockBuilder::Finish() {
   }
 
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  if (restart_key_prefixes_) {
+    // An empty block still has one restart point
+    assert(restart_key_prefixes_buffer_.size() == restarts_.size() ||
+           restart_key_prefixes_buffer_.empty());
+    restart_key_prefixes_buffer_.resize(restarts_.size());
+    for (size_t i = 0; i < restart_key_prefixes_buffer_.size(); i++) {
+      PutFixed64(&buffer_, restart_key_prefixes_buffer_[i]);
+    }
+  }
+  if (separate_key_value_) {
+    // Append values and value restart array
+    const uint32_t values_offset = static_cast<uint32_t>(buffer_.size());
+    buffer_.append(values_buffer_);
+    for (size_t i = 0; i < value_restarts_.size(); i++) {
+      PutFixed32(&buffer_, values_offset + value_restarts_[i]);
+    }
+  }
   BlockBasedTableOptions::DataBlockIndexType index_type =
       BlockBasedTableOptions::kDataBlockBinarySearch;
+  bool wide_hash_index = false;
   if (data_block_hash_index_builder_.Valid() &&
       CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex) {
-    data_block_hash_index_builder_.Finish(buffer_);
+    wide_hash_index = data_block_hash_index_builder_.Finish(buffer_);
     index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
   }
 
   // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  uint32_t block_footer =
+      PackIndexTypeAndNumRestarts(index_type, num_restarts, separate_key_value_,
+                                  restart_key_prefixes_, wide_hash_index);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -147,6 +213,10 @@ void BlockBuilder::Add(const Slice& key, const Slice& value,
     // Restart compression
     restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
     estimate_ += sizeof(uint32_t);
+    if (separate_key_value_) {
+      value_restarts_.push_back(static_cast<uint32_t>(values_buffer_.size()));
+      estimate_ += sizeof(uint32_t);
+    }
     counter_ = 0;
 
     if (use_delta_encoding_) {
@@ -164,6 +234,11 @@ void BlockBuilder::Add(const Slice& key, const Slice& value,
     last_key_.assign(key.data(), key.size());
   }
 
+  if (restart_key_prefixes_ && counter_ == 0) {
+    restart_key_prefixes_buffer_.push_back(
+        RestartKeyPrefix(ExtractUserKey(key)));
+  }
+
   const size_t non_shared = key.size() - shared;
   const size_t curr_size = buffer_.size();
 
@@ -183,7 +258,10 @@ void BlockBuilder::Add(const Slice& key, const Slice& value,
   // Use value delta encoding only when the key has shared bytes. This would
   // simplify the decoding, where it can figure which decoding to use simply by
   // looking at the shared bytes size.
-  if (shared != 0 && use_value_delta_encoding_) {
+  if (separate_key_value_) {
+    values_buffer_.append(value.data(), value.size());
+    estimate_ += value.size();
+  } else if (shared != 0 && use_value_delta_encoding_) {
     buffer_.append(delta_value->data(), delta_value->size());
   } else {
     buffer_.append(value.data(), value.size());
@@ -27,7 +27,10 @@ class BlockBuilder {
                         bool use_value_delta_encoding = false,
                         BlockBasedTableOptions::DataBlockIndexType index_type =
                             BlockBasedTableOptions::kDataBlockBinarySearch,
-                        double data_block_hash_table_util_ratio = 0.75);
+                        double data_block_hash_table_util_ratio = 0.75,
+                        bool separate_key_value = false,
+                        bool restart_key_prefixes = false,
+                        bool wide_hash_index = false);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -65,9 +68,21 @@ class BlockBuilder {
   const bool use_delta_encoding_;
   // Refer to BlockIter::DecodeCurrentValue for format of delta encoded values
   const bool use_value_delta_encoding_;
+  // Store values after all keys instead of after each key
+  const bool separate_key_value_;
+  // Store the RestartKeyPrefix() of the key of each restart point
+  const bool restart_key_prefixes_;
 
   std::string buffer_;              // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
+  // RestartKeyPrefix() of each restart point, when restart_key_prefixes_ is
+  // set
+  std::vector<uint64_t> restart_key_prefixes_buffer_;
+  // Values, when separate_key_value_ is set
+  std::string values_buffer_;
+  // Offsets in values_buffer_ of the values of restart points, when
+  // separate_key_value_ is set
+  std::vector<uint32_t> value_restarts_;
   size_t estimate_;
   int counter_;    // Number of entries emitted since restart
   bool finished_;  // Has Finish() been called?
@@ -8,22 +8,36 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based/block_prefetcher.h"
 
+#include <algorithm>
+
 namespace ROCKSDB_NAMESPACE {
 void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                                        const BlockHandle& handle,
                                        size_t readahead_size,
-                                       bool is_for_compaction) {
+                                       bool is_for_compaction, bool async_io) {
   if (is_for_compaction) {
+    // readahead_size, if larger, is how far the compaction readahead may
+    // grow (see DBOptions::max_compaction_readahead_size). Reading past the
+    // end of the file would only waste buffer space.
+    size_t max_readahead_size = compaction_readahead_size_;
+    if (readahead_size > compaction_readahead_size_) {
+      max_readahead_size = static_cast<size_t>(std::min(
+          static_cast<uint64_t>(readahead_size), rep->file_size));
+      max_readahead_size =
+          std::max(max_readahead_size, compaction_readahead_size_);
+    }
     rep->CreateFilePrefetchBufferIfNotExists(compaction_readahead_size_,
-                                             compaction_readahead_size_,
-                                             &prefetch_buffer_, false);
+                                             max_readahead_size,
+                                             &prefetch_buffer_, false,
+                                             async_io);
     return;
   }
 
   // Explicit user requested readahead.
   if (readahead_size > 0) {
     rep->CreateFilePrefetchBufferIfNotExists(readahead_size, readahead_size,
-                                             &prefetch_buffer_, false);
+                                             &prefetch_buffer_, false,
+                                             async_io);
     return;
   }
 
@@ -62,15 +76,20 @@ void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
     return;
   }
 
-  size_t initial_auto_readahead_size = BlockBasedTable::kInitAutoReadaheadSize;
+  // readahead_size_ is kInitAutoReadaheadSize unless carried over from the
+  // previous file of a scan
+  size_t initial_auto_readahead_size = readahead_size_;
   if (initial_auto_readahead_size > max_auto_readahead_size) {
     initial_auto_readahead_size = max_auto_readahead_size;
   }
 
-  if (rep->file->use_direct_io()) {
+  // With async_io, use our own buffers so that the next window can be read
+  // in the background.
+  if (rep->file->use_direct_io() || async_io) {
     rep->CreateFilePrefetchBufferIfNotExists(initial_auto_readahead_size,
                                              max_auto_readahead_size,
-                                             &prefetch_buffer_, true);
+                                             &prefetch_buffer_, true,
+                                             async_io);
     return;
   }
 
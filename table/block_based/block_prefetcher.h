@@ -16,7 +16,7 @@ class BlockPrefetcher {
       : compaction_readahead_size_(compaction_readahead_size) {}
   void PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                         const BlockHandle& handle, size_t readahead_size,
-                        bool is_for_compaction);
+                        bool is_for_compaction, bool async_io = false);
   FilePrefetchBuffer* prefetch_buffer() { return prefetch_buffer_.get(); }
 
   void UpdateReadPattern(const size_t& offset, const size_t& len) {
@@ -35,8 +35,27 @@ class BlockPrefetcher {
     return;
   }
 
+  void GetReadaheadState(ReadaheadFileInfo* readahead_info) const {
+    if (num_file_reads_ <=
+        BlockBasedTable::kMinNumFileReadsToStartAutoReadahead) {
+      readahead_info->readahead_size = 0;
+    } else if (prefetch_buffer_ != nullptr) {
+      readahead_info->readahead_size = prefetch_buffer_->readahead_size();
+    } else {
+      readahead_info->readahead_size = readahead_size_;
+    }
+  }
+
+  // Starts readahead on the first sequential read, with the size it had
+  void SetReadaheadState(const ReadaheadFileInfo& readahead_info) {
+    if (readahead_info.readahead_size > 0) {
+      num_file_reads_ = BlockBasedTable::kMinNumFileReadsToStartAutoReadahead;
+      readahead_size_ = readahead_info.readahead_size;
+    }
+  }
+
  private:
-  // Readahead size used in compaction, its value is used only if
+  // Initial readahead size used in compaction, its value is used only if
   // lookup_context_.caller = kCompaction.
   size_t compaction_readahead_size_;
 
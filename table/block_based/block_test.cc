@@ -472,6 +472,131 @@ TEST_F(BlockTest, BlockWithReadAmpBitmap) {
   }
 }
 
+TEST_F(BlockTest, SeparateKeyValue) {
+  for (auto index_type : {BlockBasedTableOptions::kDataBlockBinarySearch,
+                          BlockBasedTableOptions::kDataBlockBinaryAndHash}) {
+    for (int restart_interval : {1, 16}) {
+      std::vector<std::string> keys;
+      std::vector<std::string> values;
+      const int kNumRecords = 200;
+      // Keys 0, 2, 4, ... so that odd keys do not exist
+      GenerateRandomKVs(&keys, &values, 0, 2 * kNumRecords, 2 /* step */);
+      // Mix empty and non-empty values
+      for (int i = 0; i < kNumRecords; i += 3) {
+        values[i].clear();
+      }
+
+      BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                           false /* use_value_delta_encoding */, index_type,
+                           0.75 /* data_block_hash_table_util_ratio */,
+                           true /* separate_key_value */);
+      for (int i = 0; i < kNumRecords; i++) {
+        builder.Add(keys[i], values[i]);
+      }
+      BlockContents contents;
+      contents.data = builder.Finish();
+      Block reader(std::move(contents));
+      ASSERT_EQ(reader.IndexType(), index_type);
+
+      std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber));
+      int count = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(iter->key(), keys[count]);
+        ASSERT_EQ(iter->value(), values[count]);
+        count++;
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(count, kNumRecords);
+
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        count--;
+        ASSERT_EQ(iter->key(), keys[count]);
+        ASSERT_EQ(iter->value(), values[count]);
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(count, 0);
+
+      for (int i = 0; i < kNumRecords; i++) {
+        iter->Seek(keys[i]);
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(iter->value(), values[i]);
+
+        ASSERT_TRUE(iter->SeekForGet(keys[i]));
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(iter->value(), values[i]);
+
+        // Between keys[i] and keys[i + 1]
+        std::string missing_key = GenerateInternalKey(2 * i + 1, 0, 0, nullptr);
+        iter->SeekForPrev(missing_key);
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(iter->value(), values[i]);
+        iter->Next();
+        if (i + 1 < kNumRecords) {
+          ASSERT_TRUE(iter->Valid());
+          ASSERT_EQ(iter->key(), keys[i + 1]);
+          ASSERT_EQ(iter->value(), values[i + 1]);
+        } else {
+          ASSERT_FALSE(iter->Valid());
+        }
+      }
+    }
+  }
+}
+
+TEST_F(BlockTest, RestartKeyPrefixes) {
+  for (bool separate_key_value : {false, true}) {
+    for (int restart_interval : {1, 4}) {
+      std::vector<std::string> keys;
+      std::vector<std::string> values;
+      // Keys "%6d%4d" share their first 8 bytes in groups of 5 (forcing full
+      // comparisons), and keys with even primary key 2, 4, ... are missing.
+      GenerateRandomKVs(&keys, &values, 1 /* from */, 400 /* len */,
+                        2 /* step */, 0 /* padding_size */,
+                        5 /* keys_share_prefix */);
+
+      BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                           false /* use_value_delta_encoding */,
+                           BlockBasedTableOptions::kDataBlockBinarySearch,
+                           0.75 /* data_block_hash_table_util_ratio */,
+                           separate_key_value, true /* restart_key_prefixes */);
+      for (size_t i = 0; i < keys.size(); i++) {
+        builder.Add(keys[i], values[i]);
+      }
+      BlockContents contents;
+      contents.data = builder.Finish();
+      Block reader(std::move(contents));
+
+      std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber));
+      size_t count = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(iter->key(), keys[count]);
+        count++;
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(count, keys.size());
+
+      for (size_t i = 0; i < keys.size(); i++) {
+        iter->Seek(keys[i]);
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(iter->key(), keys[i]);
+        ASSERT_EQ(iter->value(), values[i]);
+      }
+      for (int primary = 0; primary <= 400; primary += 2) {
+        // Lands on the first key of the next group, if any
+        iter->Seek(GenerateInternalKey(primary, 0, 0, nullptr));
+        if (primary < 400) {
+          ASSERT_TRUE(iter->Valid());
+          ASSERT_EQ(iter->key(), keys[primary / 2 * 5]);
+        } else {
+          ASSERT_FALSE(iter->Valid());
+        }
+      }
+    }
+  }
+}
+
 TEST_F(BlockTest, ReadAmpBitmapPow2) {
   std::shared_ptr<Statistics> stats = ROCKSDB_NAMESPACE::CreateDBStatistics();
   ASSERT_EQ(BlockReadAmpBitmap(100, 1, stats.get()).GetBytesPerBit(), 1u);
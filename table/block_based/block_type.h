@@ -21,6 +21,10 @@ enum class BlockType : uint8_t {
   kRangeDeletion,
   kHashIndexPrefixes,
   kHashIndexMetadata,
+  kRangeFilter,
+  kKeyPositionSummary,
+  kLearnedIndex,
+  kEliasFanoIndex,
   kMetaIndex,
   kIndex,
   // Note: keep kInvalid the last value when adding new enum values.
@@ -15,15 +15,16 @@ namespace ROCKSDB_NAMESPACE {
 
 const int kDataBlockIndexTypeBitShift = 31;
 
-// 0x7FFFFFFF
-const uint32_t kMaxNumRestarts = (1u << kDataBlockIndexTypeBitShift) - 1u;
+// 0x1FFFFFFF
+const uint32_t kMaxNumRestarts = kRestartKeyPrefixesBit - 1u;
 
-// 0x7FFFFFFF
-const uint32_t kNumRestartsMask = (1u << kDataBlockIndexTypeBitShift) - 1u;
+// 0x1FFFFFFF
+const uint32_t kNumRestartsMask = kRestartKeyPrefixesBit - 1u;
 
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts) {
+    uint32_t num_restarts, bool separate_key_value, bool restart_key_prefixes,
+    bool wide_hash_index) {
   if (num_restarts > kMaxNumRestarts) {
     assert(0);  // mute travis "unused" warning
   }
@@ -31,9 +32,19 @@ uint32_t PackIndexTypeAndNumRestarts(
   uint32_t block_footer = num_restarts;
   if (index_type == BlockBasedTableOptions::kDataBlockBinaryAndHash) {
     block_footer |= 1u << kDataBlockIndexTypeBitShift;
+    if (wide_hash_index) {
+      assert(num_restarts < kWideHashIndexBit);
+      block_footer |= kWideHashIndexBit;
+    }
   } else if (index_type != BlockBasedTableOptions::kDataBlockBinarySearch) {
     assert(0);
   }
+  if (separate_key_value) {
+    block_footer |= kSeparateKeyValueBit;
+  }
+  if (restart_key_prefixes) {
+    block_footer |= kRestartKeyPrefixesBit;
+  }
 
   return block_footer;
 }
@@ -41,17 +52,35 @@ uint32_t PackIndexTypeAndNumRestarts(
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts) {
+    uint32_t* num_restarts, bool* separate_key_value,
+    bool* restart_key_prefixes, bool* wide_hash_index) {
+  const bool has_hash_index =
+      (block_footer & 1u << kDataBlockIndexTypeBitShift) != 0;
   if (index_type) {
-    if (block_footer & 1u << kDataBlockIndexTypeBitShift) {
+    if (has_hash_index) {
       *index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
     } else {
       *index_type = BlockBasedTableOptions::kDataBlockBinarySearch;
     }
   }
 
+  if (separate_key_value) {
+    *separate_key_value = (block_footer & kSeparateKeyValueBit) != 0;
+  }
+
+  if (restart_key_prefixes) {
+    *restart_key_prefixes = (block_footer & kRestartKeyPrefixesBit) != 0;
+  }
+
+  if (wide_hash_index) {
+    *wide_hash_index = has_hash_index && (block_footer & kWideHashIndexBit);
+  }
+
   if (num_restarts) {
     *num_restarts = block_footer & kNumRestartsMask;
+    if (has_hash_index) {
+      *num_restarts &= ~kWideHashIndexBit;
+    }
     assert(*num_restarts <= kMaxNumRestarts);
   }
 }
@@ -9,17 +9,50 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+
+#include "rocksdb/slice.h"
 #include "rocksdb/table.h"
+#include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// Set in the footer of data blocks whose values are stored apart from their
+// keys (BlockBasedTableOptions::separate_key_value_in_data_block). Blocks are
+// smaller than 4GiB, so blocks without this flag always have
+// num_restarts < 2^30 and never have this bit set.
+const uint32_t kSeparateKeyValueBit = 1u << 30;
+
+// Set in the footer of data blocks that store the key prefixes of their
+// restart points (BlockBasedTableOptions::restart_key_prefixes_in_data_block).
+// Blocks bigger than 2GiB are not supported, so blocks without this flag
+// always have num_restarts < 2^29 and never have this bit set.
+const uint32_t kRestartKeyPrefixesBit = 1u << 29;
+
+// Set in the footer of data blocks whose hash index has uint16_t buckets
+// (see DataBlockHashIndex). Only blocks with a hash index, which are smaller
+// than 64KiB and so have num_restarts < 2^14, have this bit set.
+const uint32_t kWideHashIndexBit = 1u << 28;
+
+// Returns the restart key prefix of `user_key`: its first 8 bytes (padded
+// with zeros) as a big-endian integer. If the prefix of key a is less than
+// the prefix of key b, then a < b with BytewiseComparator.
+inline uint64_t RestartKeyPrefix(const Slice& user_key) {
+  char buf[sizeof(uint64_t)] = {0};
+  memcpy(buf, user_key.data(), std::min(user_key.size(), sizeof(buf)));
+  return EndianSwapValue(DecodeFixed64(buf));
+}
+
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool separate_key_value = false,
+    bool restart_key_prefixes = false, bool wide_hash_index = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts);
+    uint32_t* num_restarts, bool* separate_key_value = nullptr,
+    bool* restart_key_prefixes = nullptr, bool* wide_hash_index = nullptr);
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -2,6 +2,7 @@
 //  This source code is licensed under both the GPLv2 (found in the
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -15,18 +16,21 @@ namespace ROCKSDB_NAMESPACE {
 void DataBlockHashIndexBuilder::Add(const Slice& key,
                                     const size_t restart_index) {
   assert(Valid());
-  if (restart_index > kMaxRestartSupportedByHashIndex) {
+  if (restart_index > (allow_wide_buckets_
+                           ? kMaxRestartSupportedByWideHashIndex
+                           : kMaxRestartSupportedByHashIndex)) {
     valid_ = false;
     return;
   }
 
   uint32_t hash_value = GetSliceHash(key);
   hash_and_restart_pairs_.emplace_back(hash_value,
-                                       static_cast<uint8_t>(restart_index));
+                                       static_cast<uint16_t>(restart_index));
   estimated_num_buckets_ += bucket_per_key_;
+  max_restart_index_ = std::max(max_restart_index_, restart_index);
 }
 
-void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
+bool DataBlockHashIndexBuilder::Finish(std::string& buffer) {
   assert(Valid());
   uint16_t num_buckets = static_cast<uint16_t>(estimated_num_buckets_);
 
@@ -40,54 +44,77 @@ void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
   // We made the num_buckets to be odd to avoid this issue.
   num_buckets |= 1;
 
-  std::vector<uint8_t> buckets(num_buckets, kNoEntry);
+  const bool wide = UsesWideBuckets();
+  const uint16_t no_entry = wide ? kWideNoEntry : kNoEntry;
+  const uint16_t collision = wide ? kWideCollision : kCollision;
+  std::vector<uint16_t> buckets(num_buckets, no_entry);
   // write the restart_index array
   for (auto& entry : hash_and_restart_pairs_) {
     uint32_t hash_value = entry.first;
-    uint8_t restart_index = entry.second;
+    uint16_t restart_index = entry.second;
     uint16_t buck_idx = static_cast<uint16_t>(hash_value % num_buckets);
-    if (buckets[buck_idx] == kNoEntry) {
+    if (buckets[buck_idx] == no_entry) {
       buckets[buck_idx] = restart_index;
     } else if (buckets[buck_idx] != restart_index) {
       // same bucket cannot store two different restart_index, mark collision
-      buckets[buck_idx] = kCollision;
+      buckets[buck_idx] = collision;
     }
   }
 
-  for (uint8_t restart_index : buckets) {
-    buffer.append(
-        const_cast<const char*>(reinterpret_cast<char*>(&restart_index)),
-        sizeof(restart_index));
+  for (uint16_t restart_index : buckets) {
+    if (wide) {
+      PutFixed16(&buffer, restart_index);
+    } else {
+      buffer.push_back(static_cast<char>(restart_index));
+    }
   }
 
   // write NUM_BUCK
   PutFixed16(&buffer, num_buckets);
 
   assert(buffer.size() <= kMaxBlockSizeSupportedByHashIndex);
+  return wide;
 }
 
 void DataBlockHashIndexBuilder::Reset() {
   estimated_num_buckets_ = 0;
+  max_restart_index_ = 0;
   valid_ = true;
   hash_and_restart_pairs_.clear();
 }
 
 void DataBlockHashIndex::Initialize(const char* data, uint16_t size,
-                                    uint16_t* map_offset) {
+                                    uint16_t* map_offset, bool wide_buckets) {
   assert(size >= sizeof(uint16_t));  // NUM_BUCKETS
   num_buckets_ = DecodeFixed16(data + size - sizeof(uint16_t));
+  wide_buckets_ = wide_buckets;
+  const size_t bucket_size = wide_buckets ? sizeof(uint16_t) : sizeof(uint8_t);
   assert(num_buckets_ > 0);
-  assert(size > num_buckets_ * sizeof(uint8_t));
+  assert(size > num_buckets_ * bucket_size);
   *map_offset = static_cast<uint16_t>(size - sizeof(uint16_t) -
-                                      num_buckets_ * sizeof(uint8_t));
+                                      num_buckets_ * bucket_size);
 }
 
-uint8_t DataBlockHashIndex::Lookup(const char* data, uint32_t map_offset,
-                                   const Slice& key) const {
+uint16_t DataBlockHashIndex::Bucket(const Slice& key) const {
   uint32_t hash_value = GetSliceHash(key);
-  uint16_t idx = static_cast<uint16_t>(hash_value % num_buckets_);
-  const char* bucket_table = data + map_offset;
-  return static_cast<uint8_t>(*(bucket_table + idx * sizeof(uint8_t)));
+  return static_cast<uint16_t>(hash_value % num_buckets_);
+}
+
+uint16_t DataBlockHashIndex::LookupBucket(const char* data,
+                                          uint32_t map_offset,
+                                          uint16_t bucket) const {
+  const char* bucket_address = BucketAddress(data, map_offset, bucket);
+  if (wide_buckets_) {
+    return DecodeFixed16(bucket_address);
+  }
+  uint8_t entry = static_cast<uint8_t>(*bucket_address);
+  if (entry == kNoEntry) {
+    return kWideNoEntry;
+  }
+  if (entry == kCollision) {
+    return kWideCollision;
+  }
+  return entry;
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -60,12 +60,24 @@ namespace ROCKSDB_NAMESPACE {
 // the key and will directly go to the restart interval to search the key.
 //
 // Note that we only support blocks with #restart_interval < 254. If a block
-// has more restart interval than that, hash index will not be create for it.
+// has more restart interval than that, hash index will not be create for it,
+// unless wide buckets are allowed.
+//
+// With wide buckets, each bucket is instead a little-endian uint16_t, with
+// the flags kWideNoEntry=0xFFFF and kWideCollision=0xFFFE, so that blocks
+// with up to 65533 restart intervals (e.g. 32KB blocks with a small restart
+// interval) can have a hash index too. Wide buckets are only used for blocks
+// with more than kMaxRestartSupportedByHashIndex restart intervals, and are
+// flagged with kWideHashIndexBit in the block footer.
 
 const uint8_t kNoEntry = 255;
 const uint8_t kCollision = 254;
 const uint8_t kMaxRestartSupportedByHashIndex = 253;
 
+const uint16_t kWideNoEntry = 0xFFFF;
+const uint16_t kWideCollision = 0xFFFE;
+const uint16_t kMaxRestartSupportedByWideHashIndex = 0xFFFD;
+
 // Because we use uint16_t address, we only support block no more than 64KB
 const size_t kMaxBlockSizeSupportedByHashIndex = 1u << 16;
 const double kDefaultUtilRatio = 0.75;
@@ -75,20 +87,27 @@ class DataBlockHashIndexBuilder {
   DataBlockHashIndexBuilder()
       : bucket_per_key_(-1 /*uninitialized marker*/),
         estimated_num_buckets_(0),
+        allow_wide_buckets_(false),
+        max_restart_index_(0),
         valid_(false) {}
 
-  void Initialize(double util_ratio) {
+  void Initialize(double util_ratio, bool allow_wide_buckets = false) {
     if (util_ratio <= 0) {
       util_ratio = kDefaultUtilRatio;  // sanity check
     }
     bucket_per_key_ = 1 / util_ratio;
+    allow_wide_buckets_ = allow_wide_buckets;
     valid_ = true;
   }
 
   inline bool Valid() const { return valid_ && bucket_per_key_ > 0; }
   void Add(const Slice& key, const size_t restart_index);
-  void Finish(std::string& buffer);
+  // Returns whether the index was written with wide buckets
+  bool Finish(std::string& buffer);
   void Reset();
+  inline bool UsesWideBuckets() const {
+    return max_restart_index_ > kMaxRestartSupportedByHashIndex;
+  }
   inline size_t EstimateSize() const {
     uint16_t estimated_num_buckets =
         static_cast<uint16_t>(estimated_num_buckets_);
@@ -97,29 +116,49 @@ class DataBlockHashIndexBuilder {
     estimated_num_buckets |= 1;
 
     return sizeof(uint16_t) +
-           static_cast<size_t>(estimated_num_buckets * sizeof(uint8_t));
+           static_cast<size_t>(estimated_num_buckets) *
+               (UsesWideBuckets() ? sizeof(uint16_t) : sizeof(uint8_t));
   }
 
  private:
   double bucket_per_key_;  // is the multiplicative inverse of util_ratio_
   double estimated_num_buckets_;
+  bool allow_wide_buckets_;
+  size_t max_restart_index_;
 
   // Now the only usage for `valid_` is to mark false when the inserted
   // restart_index is larger than supported. In this case HashIndex is not
   // appended to the block content.
   bool valid_;
 
-  std::vector<std::pair<uint32_t, uint8_t>> hash_and_restart_pairs_;
+  std::vector<std::pair<uint32_t, uint16_t>> hash_and_restart_pairs_;
   friend class DataBlockHashIndex_DataBlockHashTestSmall_Test;
 };
 
 class DataBlockHashIndex {
  public:
-  DataBlockHashIndex() : num_buckets_(0) {}
+  DataBlockHashIndex() : num_buckets_(0), wide_buckets_(false) {}
 
-  void Initialize(const char* data, uint16_t size, uint16_t* map_offset);
+  void Initialize(const char* data, uint16_t size, uint16_t* map_offset,
+                  bool wide_buckets = false);
 
-  uint8_t Lookup(const char* data, uint32_t map_offset, const Slice& key) const;
+  // Returns the restart index of the restart interval `key` would be in, or
+  // kWideNoEntry or kWideCollision, whatever the width of the buckets.
+  uint16_t Lookup(const char* data, uint32_t map_offset,
+                  const Slice& key) const {
+    return LookupBucket(data, map_offset, Bucket(key));
+  }
+
+  // The bucket of `key`, to look up later with LookupBucket() after
+  // prefetching it with BucketAddress()
+  uint16_t Bucket(const Slice& key) const;
+  const char* BucketAddress(const char* data, uint32_t map_offset,
+                            uint16_t bucket) const {
+    return data + map_offset +
+           bucket * (wide_buckets_ ? sizeof(uint16_t) : sizeof(uint8_t));
+  }
+  uint16_t LookupBucket(const char* data, uint32_t map_offset,
+                        uint16_t bucket) const;
 
   inline bool Valid() { return num_buckets_ != 0; }
 
@@ -131,6 +170,7 @@ class DataBlockHashIndex {
   // So in other words, DataBlockHashIndex does not support block size equal
   // or greater then 64KiB.
   uint16_t num_buckets_;
+  bool wide_buckets_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
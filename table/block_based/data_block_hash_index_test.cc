@@ -25,12 +25,12 @@ namespace ROCKSDB_NAMESPACE {
 bool SearchForOffset(DataBlockHashIndex& index, const char* data,
                      uint16_t map_offset, const Slice& key,
                      uint8_t& restart_point) {
-  uint8_t entry = index.Lookup(data, map_offset, key);
-  if (entry == kCollision) {
+  uint16_t entry = index.Lookup(data, map_offset, key);
+  if (entry == kWideCollision) {
     return true;
   }
 
-  if (entry == kNoEntry) {
+  if (entry == kWideNoEntry) {
     return false;
   }
 
@@ -309,6 +309,67 @@ TEST(DataBlockHashIndex, BlockRestartIndexExceedMax) {
   }
 }
 
+TEST(DataBlockHashIndex, BlockWideHashIndex) {
+  BlockBuilder builder(1 /* block_restart_interval */,
+                       true /* use_delta_encoding */,
+                       false /* use_value_delta_encoding */,
+                       BlockBasedTableOptions::kDataBlockBinaryAndHash,
+                       0.75 /* data_block_hash_table_util_ratio */,
+                       false /* separate_key_value */,
+                       false /* restart_key_prefixes */,
+                       true /* wide_hash_index */);
+
+  // #restarts > 253. HashIndex has wide buckets
+  const int kNumKeys = 1000;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumKeys; i++) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    keys.emplace_back(buf);
+    InternalKey ikey(keys.back(), 10, kTypeValue);
+    builder.Add(ikey.Encode().ToString(), "value" + std::to_string(i));
+  }
+
+  Slice rawblock = builder.Finish();
+  BlockContents contents;
+  contents.data = rawblock;
+  Block reader(std::move(contents));
+  ASSERT_EQ(reader.IndexType(),
+            BlockBasedTableOptions::kDataBlockBinaryAndHash);
+  ASSERT_EQ(static_cast<uint32_t>(kNumKeys), reader.NumRestarts());
+
+  std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber));
+  std::vector<std::string> seek_keys;
+  for (int i = 0; i < kNumKeys; i++) {
+    seek_keys.push_back(
+        InternalKey(keys[i], 20, kValueTypeForSeek).Encode().ToString());
+  }
+  std::vector<Slice> seek_key_slices(seek_keys.begin(), seek_keys.end());
+  iter->PrefetchForGet(seek_key_slices.data(), seek_key_slices.size());
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_TRUE(iter->SeekForGet(seek_keys[i]));
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(keys[i], ExtractUserKey(iter->key()).ToString());
+    ASSERT_EQ("value" + std::to_string(i), iter->value().ToString());
+  }
+
+  // Without wide buckets allowed, such a block gets no hash index
+  BlockBuilder narrow_builder(1 /* block_restart_interval */,
+                              true /* use_delta_encoding */,
+                              false /* use_value_delta_encoding */,
+                              BlockBasedTableOptions::kDataBlockBinaryAndHash);
+  for (int i = 0; i < kNumKeys; i++) {
+    InternalKey ikey(keys[i], 10, kTypeValue);
+    narrow_builder.Add(ikey.Encode().ToString(), "value");
+  }
+  BlockContents narrow_contents;
+  narrow_contents.data = narrow_builder.Finish();
+  Block narrow_reader(std::move(narrow_contents));
+  ASSERT_EQ(narrow_reader.IndexType(),
+            BlockBasedTableOptions::kDataBlockBinarySearch);
+}
+
 TEST(DataBlockHashIndex, BlockSizeExceedMax) {
   Options options = Options();
   std::string ukey(10, 'k');
@@ -0,0 +1,339 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/elias_fano_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "util/coding.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Words of high bits per rank sample
+const size_t kWordsPerRankSample = 8;
+const uint64_t kBitsPerRankSample = kWordsPerRankSample * 64;
+
+// The `size` bytes of `key` from `offset` on (padded with zeros) as a
+// big-endian integer
+uint64_t ReadHead(const Slice& key, size_t offset, size_t size) {
+  assert(size <= sizeof(uint64_t));
+  uint64_t head = 0;
+  for (size_t i = offset; i < offset + size; ++i) {
+    head = (head << 8) |
+           (i < key.size() ? static_cast<unsigned char>(key[i]) : 0);
+  }
+  return head;
+}
+
+// The bit position of the set bit with the given rank in `word`
+uint64_t SelectInWord(uint64_t word, uint64_t rank) {
+  for (; rank > 0; --rank) {
+    word &= word - 1;
+  }
+  return CountTrailingZeroBits(word);
+}
+}  // namespace
+
+void EliasFanoSequence::Encode(const std::vector<uint64_t>& values,
+                               std::string* dst) {
+  const uint64_t num_values = values.size();
+  const uint64_t max_value = values.empty() ? 0 : values.back();
+  uint32_t low_bits = 0;
+  if (num_values > 0 && max_value / num_values > 0) {
+    low_bits = static_cast<uint32_t>(FloorLog2(max_value / num_values));
+  }
+  const uint64_t num_high_bits = num_values + (max_value >> low_bits) + 1;
+  std::vector<uint64_t> high((num_high_bits + 63) / 64);
+  std::vector<uint64_t> low((num_values * low_bits + 63) / 64);
+  for (uint64_t i = 0; i < num_values; ++i) {
+    assert(i == 0 || values[i - 1] <= values[i]);
+    const uint64_t pos = (values[i] >> low_bits) + i;
+    high[pos / 64] |= uint64_t{1} << (pos % 64);
+    if (low_bits > 0) {
+      const uint64_t low_part = values[i] & ((uint64_t{1} << low_bits) - 1);
+      const uint64_t bit = i * low_bits;
+      low[bit / 64] |= low_part << (bit % 64);
+      if (bit % 64 + low_bits > 64) {
+        low[bit / 64 + 1] |= low_part >> (64 - bit % 64);
+      }
+    }
+  }
+  PutVarint64(dst, num_values);
+  PutVarint32(dst, low_bits);
+  PutVarint64(dst, max_value);
+  for (uint64_t word : high) {
+    PutFixed64(dst, word);
+  }
+  for (uint64_t word : low) {
+    PutFixed64(dst, word);
+  }
+}
+
+Status EliasFanoSequence::DecodeFrom(Slice* input) {
+  uint64_t num_values = 0;
+  if (!GetVarint64(input, &num_values) || !GetVarint32(input, &low_bits_) ||
+      !GetVarint64(input, &max_value_) || low_bits_ >= 64 ||
+      num_values > std::numeric_limits<uint32_t>::max()) {
+    return Status::Corruption("Corrupted Elias-Fano sequence");
+  }
+  // Bounds both sizes by the input before computing with them
+  const uint64_t input_bits = static_cast<uint64_t>(input->size()) * 8;
+  if (num_values > input_bits || (max_value_ >> low_bits_) > input_bits) {
+    return Status::Corruption("Corrupted Elias-Fano sequence");
+  }
+  num_values_ = static_cast<size_t>(num_values);
+  num_high_bits_ = num_values + (max_value_ >> low_bits_) + 1;
+  const size_t num_high_words = static_cast<size_t>((num_high_bits_ + 63) / 64);
+  const size_t num_low_words =
+      static_cast<size_t>((num_values * low_bits_ + 63) / 64);
+  if (input->size() < (num_high_words + num_low_words) * sizeof(uint64_t)) {
+    return Status::Corruption("Corrupted Elias-Fano sequence");
+  }
+
+  const char* p = input->data();
+  high_.resize(num_high_words);
+  high_ranks_.clear();
+  high_ranks_.reserve(num_high_words / kWordsPerRankSample + 1);
+  uint64_t rank = 0;
+  for (size_t i = 0; i < num_high_words; ++i) {
+    if (i % kWordsPerRankSample == 0) {
+      high_ranks_.push_back(static_cast<uint32_t>(rank));
+    }
+    high_[i] = DecodeFixed64(p);
+    rank += BitsSetToOne(high_[i]);
+    p += sizeof(uint64_t);
+  }
+  low_.resize(num_low_words);
+  for (size_t i = 0; i < num_low_words; ++i) {
+    low_[i] = DecodeFixed64(p);
+    p += sizeof(uint64_t);
+  }
+  input->remove_prefix(static_cast<size_t>(p - input->data()));
+  if (rank != num_values) {
+    return Status::Corruption("Corrupted Elias-Fano sequence");
+  }
+  return Status::OK();
+}
+
+uint64_t EliasFanoSequence::Select1(uint64_t rank) const {
+  assert(rank < num_values_);
+  // The last sample with at most `rank` set bits before it
+  const size_t sample =
+      std::upper_bound(high_ranks_.begin(), high_ranks_.end(), rank) -
+      high_ranks_.begin() - 1;
+  uint64_t remaining = rank - high_ranks_[sample];
+  for (size_t i = sample * kWordsPerRankSample;; ++i) {
+    assert(i < high_.size());
+    const uint64_t ones = BitsSetToOne(high_[i]);
+    if (remaining < ones) {
+      return i * 64 + SelectInWord(high_[i], remaining);
+    }
+    remaining -= ones;
+  }
+}
+
+uint64_t EliasFanoSequence::Select0(uint64_t rank) const {
+  // The last sample with at most `rank` zero bits before it
+  size_t left = 0;
+  size_t right = high_ranks_.size();
+  while (right - left > 1) {
+    const size_t mid = left + (right - left) / 2;
+    if (mid * kBitsPerRankSample - high_ranks_[mid] <= rank) {
+      left = mid;
+    } else {
+      right = mid;
+    }
+  }
+  uint64_t remaining = rank - (left * kBitsPerRankSample - high_ranks_[left]);
+  for (size_t i = left * kWordsPerRankSample;; ++i) {
+    assert(i < high_.size());
+    const uint64_t zeros = BitsSetToOne(~high_[i]);
+    if (remaining < zeros) {
+      return i * 64 + SelectInWord(~high_[i], remaining);
+    }
+    remaining -= zeros;
+  }
+}
+
+uint64_t EliasFanoSequence::LowPart(size_t i) const {
+  if (low_bits_ == 0) {
+    return 0;
+  }
+  const uint64_t bit = static_cast<uint64_t>(i) * low_bits_;
+  const size_t word = static_cast<size_t>(bit / 64);
+  const uint64_t shift = bit % 64;
+  uint64_t low_part = low_[word] >> shift;
+  if (shift + low_bits_ > 64) {
+    low_part |= low_[word + 1] << (64 - shift);
+  }
+  return low_part & ((uint64_t{1} << low_bits_) - 1);
+}
+
+uint64_t EliasFanoSequence::Get(size_t i) const {
+  assert(i < num_values_);
+  return ((Select1(i) - i) << low_bits_) | LowPart(i);
+}
+
+size_t EliasFanoSequence::LowerBound(uint64_t target) const {
+  if (num_values_ == 0 || target > max_value_) {
+    return num_values_;
+  }
+  const uint64_t high = target >> low_bits_;
+  // The values with these high bits are the set bits right after the
+  // high-th zero bit
+  uint64_t pos = high == 0 ? 0 : Select0(high - 1) + 1;
+  size_t i = static_cast<size_t>(pos - high);
+  for (; i < num_values_ && HighBit(pos); ++i, ++pos) {
+    if (((high << low_bits_) | LowPart(i)) >= target) {
+      return i;
+    }
+  }
+  // The next value has larger high bits
+  return i;
+}
+
+bool EliasFanoIndex::Build(const std::vector<std::string>& last_keys,
+                           const std::vector<BlockHandle>& handles,
+                           size_t separator_size, std::string* dst) {
+  assert(last_keys.size() == handles.size());
+  const size_t num_blocks = last_keys.size();
+  if (num_blocks == 0 ||
+      num_blocks >= std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  const size_t key_size = last_keys.front().size();
+  std::vector<uint64_t> offsets;
+  offsets.reserve(num_blocks + 1);
+  uint64_t end = handles.front().offset();
+  for (size_t i = 0; i < num_blocks; ++i) {
+    if (last_keys[i].size() != key_size || handles[i].offset() != end) {
+      return false;
+    }
+    offsets.push_back(end);
+    end += handles[i].size() + kBlockTrailerSize;
+  }
+  offsets.push_back(end);
+
+  separator_size = std::min(separator_size, key_size);
+  // The keys are sorted, so the first and the last separator share the
+  // prefix common to all of them.
+  const size_t common_prefix_size =
+      std::min(Slice(last_keys.front()).difference_offset(last_keys.back()),
+               separator_size);
+  const size_t head_size =
+      std::min(separator_size - common_prefix_size, sizeof(uint64_t));
+  const size_t tail_size = separator_size - common_prefix_size - head_size;
+
+  std::vector<uint64_t> heads;
+  heads.reserve(num_blocks);
+  std::string tails;
+  tails.reserve(num_blocks * tail_size);
+  const uint64_t first_head =
+      ReadHead(last_keys.front(), common_prefix_size, head_size);
+  for (const auto& key : last_keys) {
+    heads.push_back(ReadHead(key, common_prefix_size, head_size) - first_head);
+    tails.append(key, common_prefix_size + head_size, tail_size);
+  }
+
+  PutVarint32(dst, static_cast<uint32_t>(key_size));
+  PutLengthPrefixedSlice(dst,
+                         Slice(last_keys.front().data(), common_prefix_size));
+  PutVarint32(dst, static_cast<uint32_t>(head_size));
+  PutVarint32(dst, static_cast<uint32_t>(tail_size));
+  PutVarint64(dst, first_head);
+  EliasFanoSequence::Encode(heads, dst);
+  EliasFanoSequence::Encode(offsets, dst);
+  dst->append(tails);
+  return true;
+}
+
+Status EliasFanoIndex::Create(const Slice& contents,
+                              std::unique_ptr<EliasFanoIndex>* index) {
+  Slice input = contents;
+  std::unique_ptr<EliasFanoIndex> result(new EliasFanoIndex());
+  Slice common_prefix;
+  if (!GetVarint32(&input, &result->key_size_) ||
+      !GetLengthPrefixedSlice(&input, &common_prefix) ||
+      !GetVarint32(&input, &result->head_size_) ||
+      !GetVarint32(&input, &result->tail_size_) ||
+      !GetVarint64(&input, &result->first_head_) ||
+      result->head_size_ > sizeof(uint64_t) ||
+      common_prefix.size() + result->head_size_ + result->tail_size_ >
+          result->key_size_) {
+    return Status::Corruption("Corrupted Elias-Fano index block");
+  }
+  result->common_prefix_ = common_prefix.ToString();
+  Status s = result->heads_.DecodeFrom(&input);
+  if (s.ok()) {
+    s = result->offsets_.DecodeFrom(&input);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  const size_t num_blocks = result->heads_.size();
+  if (num_blocks == 0 || result->offsets_.size() != num_blocks + 1 ||
+      input.size() != static_cast<uint64_t>(num_blocks) * result->tail_size_) {
+    return Status::Corruption("Corrupted Elias-Fano index block");
+  }
+  result->tails_ = input.ToString();
+  *index = std::move(result);
+  return Status::OK();
+}
+
+size_t EliasFanoIndex::Seek(const Slice& user_key) const {
+  const size_t prefix_size = common_prefix_.size();
+  const int cmp =
+      Slice(user_key.data(), std::min(user_key.size(), prefix_size))
+          .compare(common_prefix_);
+  if (cmp < 0) {
+    return 0;
+  } else if (cmp > 0) {
+    return num_blocks();
+  }
+  const uint64_t head = ReadHead(user_key, prefix_size, head_size_);
+  if (head < first_head_) {
+    return 0;
+  }
+  size_t i = heads_.LowerBound(head - first_head_);
+  if (tail_size_ > 0) {
+    // Separators with the same head are told apart by their tails
+    std::string tail(tail_size_, '\0');
+    const size_t tail_offset = prefix_size + head_size_;
+    if (user_key.size() > tail_offset) {
+      memcpy(&tail[0], user_key.data() + tail_offset,
+             std::min<size_t>(user_key.size() - tail_offset, tail_size_));
+    }
+    while (i < num_blocks() && heads_.Get(i) == head - first_head_ &&
+           memcmp(tails_.data() + i * tail_size_, tail.data(), tail_size_) <
+               0) {
+      ++i;
+    }
+  }
+  return i;
+}
+
+BlockHandle EliasFanoIndex::GetHandle(size_t i) const {
+  assert(i < num_blocks());
+  const uint64_t offset = offsets_.Get(i);
+  return BlockHandle(offset, offsets_.Get(i + 1) - offset - kBlockTrailerSize);
+}
+
+void EliasFanoIndex::GetSeparator(size_t i, std::string* separator) const {
+  assert(i < num_blocks());
+  separator->assign(common_prefix_);
+  const uint64_t head = first_head_ + heads_.Get(i);
+  for (uint32_t shift = head_size_ * 8; shift > 0; shift -= 8) {
+    separator->push_back(static_cast<char>(head >> (shift - 8)));
+  }
+  separator->append(tails_, i * tail_size_, tail_size_);
+  // Sorts after every key of the block
+  separator->resize(key_size_, '\xff');
+}
+
+}  // namespace ROCKSDB_NAMESPACE
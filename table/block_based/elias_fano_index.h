@@ -0,0 +1,150 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A non-decreasing sequence of integers in Elias-Fano coding: the low
+// `low_bits` bits of every value are stored as is, and the high bits in
+// unary as the gaps between the set bits of a bit vector of about
+// 2 * size() bits. Takes about 2 + log2(max / size()) bits per value.
+// Values are accessed through rank/select over the high bits, with one
+// 32-bit rank sample per 512 bits.
+//
+// Serialized format:
+//
+//   num_values: varint64
+//   low_bits: varint32
+//   max_value: varint64
+//   high_bits: fixed64[(num_values + (max_value >> low_bits) + 64) / 64]
+//   low_bits: fixed64[(num_values * low_bits + 63) / 64]
+class EliasFanoSequence {
+ public:
+  // Appends the encoding of `values`, which must be non-decreasing, to *dst
+  static void Encode(const std::vector<uint64_t>& values, std::string* dst);
+
+  EliasFanoSequence() : num_values_(0), low_bits_(0), max_value_(0) {}
+
+  // Parses a sequence written by Encode() from the front of *input
+  Status DecodeFrom(Slice* input);
+
+  size_t size() const { return num_values_; }
+
+  // REQUIRES: i < size()
+  uint64_t Get(size_t i) const;
+
+  // The index of the first value >= `target`, or size() if there is none
+  size_t LowerBound(uint64_t target) const;
+
+  size_t ApproximateMemoryUsage() const {
+    return high_.capacity() * sizeof(uint64_t) +
+           low_.capacity() * sizeof(uint64_t) +
+           high_ranks_.capacity() * sizeof(uint32_t);
+  }
+
+ private:
+  // The position in high_ of the set bit with the given rank, 0-based
+  uint64_t Select1(uint64_t rank) const;
+  // The position in high_ of the zero bit with the given rank, 0-based
+  uint64_t Select0(uint64_t rank) const;
+
+  bool HighBit(uint64_t pos) const {
+    return (high_[pos / 64] >> (pos % 64)) & 1;
+  }
+  uint64_t LowPart(size_t i) const;
+
+  size_t num_values_;
+  uint32_t low_bits_;
+  uint64_t max_value_;
+  uint64_t num_high_bits_ = 0;
+  std::vector<uint64_t> high_;
+  std::vector<uint64_t> low_;
+  // high_ranks_[i] is the number of set bits before word i * 8 of high_
+  std::vector<uint32_t> high_ranks_;
+};
+
+// An index of a block-based table with fixed-size user keys, used by
+// BlockBasedTableOptions::kEliasFano in place of the index block.
+//
+// The separator of data block i is the shortest prefix of its last user key
+// that still sorts before the first key of block i + 1, cut to the same
+// length for all blocks and, when presented as a key, padded back to the
+// key size with 0xff bytes. After the prefix common to all separators, the
+// first (up to 8) bytes of every separator are read as a big-endian integer
+// and Elias-Fano coded; any bytes after those are stored as is. The data
+// blocks must be contiguous, so that the block offsets (plus the end of the
+// last block) make a second Elias-Fano sequence and the block sizes follow
+// from it.
+//
+// Serialized format (the "rocksdb.elias_fano.index" meta block):
+//
+//   key_size: varint32
+//   common_prefix_size: varint32
+//   common_prefix: char[common_prefix_size]
+//   head_size: varint32
+//   tail_size: varint32
+//   first_head: varint64
+//   heads: EliasFanoSequence (minus first_head)
+//   offsets: EliasFanoSequence (num_blocks + 1 values)
+//   tails: char[num_blocks * tail_size]
+class EliasFanoIndex {
+ public:
+  // Builds an index over data blocks with the given last user keys, which
+  // must all have the same size, and block handles, and appends it to
+  // `*dst`. `separator_size` is the number of leading bytes that tell the
+  // last key of every block apart from the first key of the next one.
+  // Returns false without touching `*dst` if the index cannot be built,
+  // e.g. because the blocks are not contiguous.
+  static bool Build(const std::vector<std::string>& last_keys,
+                    const std::vector<BlockHandle>& handles,
+                    size_t separator_size, std::string* dst);
+
+  // Parses an index written by Build().
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<EliasFanoIndex>* index);
+
+  size_t num_blocks() const { return heads_.size(); }
+
+  // The index of the first data block whose last key is not before
+  // `user_key`, or num_blocks() if there is none
+  size_t Seek(const Slice& user_key) const;
+
+  // REQUIRES: i < num_blocks()
+  BlockHandle GetHandle(size_t i) const;
+  // Sets `*separator` to the key_size bytes long separator of block i
+  // REQUIRES: i < num_blocks()
+  void GetSeparator(size_t i, std::string* separator) const;
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(EliasFanoIndex) + common_prefix_.capacity() +
+           heads_.ApproximateMemoryUsage() + offsets_.ApproximateMemoryUsage() +
+           tails_.capacity();
+  }
+
+ private:
+  EliasFanoIndex() : key_size_(0), head_size_(0), tail_size_(0),
+                     first_head_(0) {}
+
+  uint32_t key_size_;
+  std::string common_prefix_;
+  uint32_t head_size_;
+  uint32_t tail_size_;
+  uint64_t first_head_;
+  EliasFanoSequence heads_;
+  EliasFanoSequence offsets_;
+  std::string tails_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,193 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#include "table/block_based/elias_fano_index_reader.h"
+
+#include "logging/logging.h"
+#include "table/block_fetcher.h"
+#include "table/meta_blocks.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+// Iterates over the data blocks of an EliasFanoIndex. Keys are user keys,
+// as in index blocks without sequence numbers.
+class EliasFanoIndexIterator : public InternalIteratorBase<IndexValue> {
+ public:
+  explicit EliasFanoIndexIterator(const EliasFanoIndex* index)
+      : index_(index), current_(index->num_blocks()) {}
+
+  bool Valid() const override { return current_ < index_->num_blocks(); }
+
+  void SeekToFirst() override { SetCurrent(0); }
+
+  void SeekToLast() override { SetCurrent(index_->num_blocks() - 1); }
+
+  void Seek(const Slice& target) override {
+    SetCurrent(index_->Seek(ExtractUserKey(target)));
+  }
+
+  void SeekForPrev(const Slice&) override {
+    assert(false);
+    current_ = index_->num_blocks();
+    status_ = Status::InvalidArgument(
+        "RocksDB internal error: should never call SeekForPrev() on index "
+        "blocks");
+  }
+
+  void Next() override {
+    assert(Valid());
+    SetCurrent(current_ + 1);
+  }
+
+  void Prev() override {
+    assert(Valid());
+    SetCurrent(current_ == 0 ? index_->num_blocks() : current_ - 1);
+  }
+
+  Slice key() const override {
+    assert(Valid());
+    return separator_;
+  }
+
+  Slice user_key() const override { return key(); }
+
+  IndexValue value() const override {
+    assert(Valid());
+    return IndexValue(handle_, Slice());
+  }
+
+  Status status() const override { return status_; }
+
+ private:
+  void SetCurrent(size_t current) {
+    current_ = current;
+    status_ = Status::OK();
+    if (Valid()) {
+      index_->GetSeparator(current_, &separator_);
+      handle_ = index_->GetHandle(current_);
+    }
+  }
+
+  const EliasFanoIndex* const index_;
+  size_t current_;
+  std::string separator_;
+  BlockHandle handle_;
+  Status status_;
+};
+}  // namespace
+
+Status EliasFanoIndexReader::ReadEliasFanoIndex(
+    const BlockBasedTable* table, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_index_iter,
+    std::unique_ptr<EliasFanoIndex>* index) {
+  const BlockBasedTable::Rep* rep = table->get_rep();
+  // The builder leaves out the index if the keys are not suitable for it.
+  BlockHandle handle;
+  Status s = FindMetaBlock(meta_index_iter, kEliasFanoIndexBlock, &handle);
+  if (!s.ok()) {
+    return s;
+  }
+
+  BlockContents contents;
+  BlockFetcher block_fetcher(
+      rep->file.get(), prefetch_buffer, rep->footer, ReadOptions(), handle,
+      &contents, rep->ioptions, true /*decompress*/, true /*maybe_compressed*/,
+      BlockType::kEliasFanoIndex, UncompressionDict::GetEmptyDict(),
+      rep->persistent_cache_options, GetMemoryAllocator(rep->table_options));
+  s = block_fetcher.ReadBlockContents();
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep->ioptions.logger,
+                   "Unable to read the Elias-Fano index block: %s",
+                   s.ToString().c_str());
+    return s;
+  }
+
+  s = EliasFanoIndex::Create(contents.data, index);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep->ioptions.logger, "%s", s.ToString().c_str());
+  }
+  return s;
+}
+
+Status EliasFanoIndexReader::Create(
+    const BlockBasedTable* table, const ReadOptions& ro,
+    FilePrefetchBuffer* prefetch_buffer, InternalIterator* meta_index_iter,
+    bool use_cache, bool prefetch, bool pin,
+    BlockCacheLookupContext* lookup_context,
+    std::unique_ptr<IndexReader>* index_reader) {
+  assert(table != nullptr);
+  assert(index_reader != nullptr);
+  assert(!pin || prefetch);
+
+  const BlockBasedTable::Rep* rep = table->get_rep();
+  assert(rep != nullptr);
+
+  // With the Elias-Fano index the index block is never read. A missing or
+  // unreadable one only costs the savings.
+  std::unique_ptr<EliasFanoIndex> index;
+  if (meta_index_iter != nullptr && !rep->index_key_includes_seq &&
+      !rep->index_has_first_key &&
+      ReadEliasFanoIndex(table, prefetch_buffer, meta_index_iter, &index)
+          .ok()) {
+    index_reader->reset(new EliasFanoIndexReader(
+        table, CachableEntry<Block>(), std::move(index)));
+    return Status::OK();
+  }
+
+  CachableEntry<Block> index_block;
+  if (prefetch || !use_cache) {
+    const Status s =
+        ReadIndexBlock(table, prefetch_buffer, ro, use_cache,
+                       /*get_context=*/nullptr, lookup_context, &index_block);
+    if (!s.ok()) {
+      return s;
+    }
+
+    if (use_cache && !pin) {
+      index_block.Reset();
+    }
+  }
+
+  index_reader->reset(
+      new EliasFanoIndexReader(table, std::move(index_block), nullptr));
+
+  return Status::OK();
+}
+
+InternalIteratorBase<IndexValue>* EliasFanoIndexReader::NewIterator(
+    const ReadOptions& read_options, bool /* disable_prefix_seek */,
+    IndexBlockIter* iter, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context) {
+  if (index_) {
+    return new EliasFanoIndexIterator(index_.get());
+  }
+
+  const BlockBasedTable::Rep* rep = table()->get_rep();
+  const bool no_io = (read_options.read_tier == kBlockCacheTier);
+  CachableEntry<Block> index_block;
+  const Status s =
+      GetOrReadIndexBlock(no_io, get_context, lookup_context, &index_block);
+  if (!s.ok()) {
+    if (iter != nullptr) {
+      iter->Invalidate(s);
+      return iter;
+    }
+
+    return NewErrorInternalIterator<IndexValue>(s);
+  }
+
+  Statistics* kNullStats = nullptr;
+  // We don't return pinned data from index blocks, so no need
+  // to set `block_contents_pinned`.
+  auto it = index_block.GetValue()->NewIndexIterator(
+      internal_comparator()->user_comparator(),
+      rep->get_global_seqno(BlockType::kIndex), iter, kNullStats, true,
+      index_has_first_key(), index_key_includes_seq(), index_value_is_full());
+
+  assert(it != nullptr);
+  index_block.TransferTo(it);
+
+  return it;
+}
+}  // namespace ROCKSDB_NAMESPACE
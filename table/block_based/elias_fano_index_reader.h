@@ -0,0 +1,57 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include "table/block_based/elias_fano_index.h"
+#include "table/block_based/index_reader_common.h"
+
+namespace ROCKSDB_NAMESPACE {
+// Index of fixed-size keys in Elias-Fano coding
+// (BlockBasedTableOptions::kEliasFano), held by the reader itself. Without a
+// usable Elias-Fano index it behaves like BinarySearchIndexReader, and only
+// then reads the index block.
+class EliasFanoIndexReader : public BlockBasedTable::IndexReaderCommon {
+ public:
+  static Status Create(const BlockBasedTable* table, const ReadOptions& ro,
+                       FilePrefetchBuffer* prefetch_buffer,
+                       InternalIterator* meta_index_iter, bool use_cache,
+                       bool prefetch, bool pin,
+                       BlockCacheLookupContext* lookup_context,
+                       std::unique_ptr<IndexReader>* index_reader);
+
+  InternalIteratorBase<IndexValue>* NewIterator(
+      const ReadOptions& read_options, bool /* disable_prefix_seek */,
+      IndexBlockIter* iter, GetContext* get_context,
+      BlockCacheLookupContext* lookup_context) override;
+
+  size_t ApproximateMemoryUsage() const override {
+    size_t usage = ApproximateIndexBlockMemoryUsage();
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+    usage += malloc_usable_size(const_cast<EliasFanoIndexReader*>(this));
+#else
+    usage += sizeof(*this);
+#endif  // ROCKSDB_MALLOC_USABLE_SIZE
+    if (index_) {
+      usage += index_->ApproximateMemoryUsage();
+    }
+    return usage;
+  }
+
+ private:
+  EliasFanoIndexReader(const BlockBasedTable* t,
+                       CachableEntry<Block>&& index_block,
+                       std::unique_ptr<EliasFanoIndex>&& index)
+      : IndexReaderCommon(t, std::move(index_block)),
+        index_(std::move(index)) {}
+
+  // Reads the Elias-Fano index, if the table has one
+  static Status ReadEliasFanoIndex(const BlockBasedTable* table,
+                                   FilePrefetchBuffer* prefetch_buffer,
+                                   InternalIterator* meta_index_iter,
+                                   std::unique_ptr<EliasFanoIndex>* index);
+
+  std::unique_ptr<EliasFanoIndex> index_;
+};
+}  // namespace ROCKSDB_NAMESPACE
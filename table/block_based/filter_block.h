@@ -156,7 +156,11 @@ class FilterBlockReader {
     return error_msg;
   }
 
-  virtual Status CacheDependencies(const ReadOptions& /*ro*/, bool /*pin*/) {
+  // `tail_prefetch_buffer`, if not null, holds the tail of the file read when
+  // opening it
+  virtual Status CacheDependencies(
+      const ReadOptions& /*ro*/, bool /*pin*/,
+      FilePrefetchBuffer* /*tail_prefetch_buffer*/) {
     return Status::OK();
   }
 
@@ -10,9 +10,12 @@
 #include "rocksdb/filter_policy.h"
 
 #include <array>
+#include <cmath>
 #include <deque>
 #include <limits>
 
+#include "cache/cache_entry_roles.h"
+#include "cache/cache_reservation_manager.h"
 #include "rocksdb/slice.h"
 #include "table/block_based/block_based_filter_block.h"
 #include "table/block_based/filter_policy_internal.h"
@@ -47,8 +50,10 @@ Slice FinishAlwaysFalse(std::unique_ptr<const char[]>* /*buf*/) {
 class XXH3pFilterBitsBuilder : public BuiltinFilterBitsBuilder {
  public:
   explicit XXH3pFilterBitsBuilder(
-      std::atomic<int64_t>* aggregate_rounding_balance)
-      : aggregate_rounding_balance_(aggregate_rounding_balance) {}
+      std::atomic<int64_t>* aggregate_rounding_balance,
+      std::shared_ptr<CacheReservationManager> cache_res_mgr)
+      : aggregate_rounding_balance_(aggregate_rounding_balance),
+        cache_res_mgr_(std::move(cache_res_mgr)) {}
 
   ~XXH3pFilterBitsBuilder() override {}
 
@@ -60,6 +65,10 @@ class XXH3pFilterBitsBuilder : public BuiltinFilterBitsBuilder {
     // requirements.
     if (hash_entries_.empty() || hash != hash_entries_.back()) {
       hash_entries_.push_back(hash);
+      if (cache_res_mgr_ &&
+          hash_entries_.size() * sizeof(uint64_t) > next_reservation_bytes_) {
+        ReserveForHashEntries();
+      }
     }
   }
 
@@ -73,10 +82,32 @@ class XXH3pFilterBitsBuilder : public BuiltinFilterBitsBuilder {
   // For delegating between XXH3pFilterBitsBuilders
   void SwapEntriesWith(XXH3pFilterBitsBuilder* other) {
     std::swap(hash_entries_, other->hash_entries_);
+    // The cache reservation (shared manager) follows the entries
+    std::swap(next_reservation_bytes_, other->next_reservation_bytes_);
   }
 
   virtual size_t RoundDownUsableSpace(size_t available_size) = 0;
 
+  // With reserve_table_builder_memory, charges mem_used bytes of builder
+  // memory to the block cache, replacing the previous charge. Returns
+  // non-OK if the block cache (with strict_capacity_limit) is full.
+  Status UpdateCacheReservation(size_t mem_used) {
+    if (!cache_res_mgr_) {
+      return Status::OK();
+    }
+    Status s =
+        cache_res_mgr_
+            ->UpdateCacheReservation<CacheEntryRole::kFilterConstruction>(
+                mem_used);
+    next_reservation_bytes_ = cache_res_mgr_->GetTotalReservedCacheSize();
+    return s;
+  }
+
+  // Releases any block cache charge, at the end of Finish()
+  void ReleaseCacheReservation() {
+    UpdateCacheReservation(0).PermitUncheckedError();
+  }
+
   // To choose size using malloc_usable_size, we have to actually allocate.
   size_t AllocateMaybeRounding(size_t target_len_with_metadata,
                                size_t num_entries,
@@ -182,6 +213,26 @@ class XXH3pFilterBitsBuilder : public BuiltinFilterBitsBuilder {
   // See BloomFilterPolicy::aggregate_rounding_balance_. If nullptr,
   // always "round up" like historic behavior.
   std::atomic<int64_t>* aggregate_rounding_balance_;
+
+  // Non-null iff reserve_table_builder_memory is in effect. Shared with
+  // any delegate builder (e.g. Ribbon's Bloom fallback).
+  std::shared_ptr<CacheReservationManager> cache_res_mgr_;
+
+ private:
+  void ReserveForHashEntries() {
+    size_t bytes = hash_entries_.size() * sizeof(uint64_t);
+    Status s = UpdateCacheReservation(bytes);
+    if (!s.ok()) {
+      // Full cache. Not acted on until Finish(), where the larger
+      // allocations happen, but defer the next attempt so that a full
+      // cache is not probed on every key.
+      next_reservation_bytes_ =
+          bytes + CacheReservationManager::kSizeDummyEntry;
+    }
+  }
+
+  // Size of hash_entries_ (in bytes) beyond which to grow the reservation
+  size_t next_reservation_bytes_ = 0;
 };
 
 // #################### FastLocalBloom implementation ################## //
@@ -193,8 +244,10 @@ class FastLocalBloomBitsBuilder : public XXH3pFilterBitsBuilder {
   // Non-null aggregate_rounding_balance implies optimize_filters_for_memory
   explicit FastLocalBloomBitsBuilder(
       const int millibits_per_key,
-      std::atomic<int64_t>* aggregate_rounding_balance)
-      : XXH3pFilterBitsBuilder(aggregate_rounding_balance),
+      std::atomic<int64_t>* aggregate_rounding_balance,
+      std::shared_ptr<CacheReservationManager> cache_res_mgr)
+      : XXH3pFilterBitsBuilder(aggregate_rounding_balance,
+                               std::move(cache_res_mgr)),
         millibits_per_key_(millibits_per_key) {
     assert(millibits_per_key >= 1000);
   }
@@ -228,6 +281,7 @@ class FastLocalBloomBitsBuilder : public XXH3pFilterBitsBuilder {
     }
 
     assert(hash_entries_.empty());
+    ReleaseCacheReservation();
 
     // See BloomFilterPolicy::GetBloomBitsReader re: metadata
     // -1 = Marker for newer Bloom implementations
@@ -385,10 +439,9 @@ class FastLocalBloomBitsReader : public FilterBitsReader {
                                       /*out*/ &byte_offsets[i]);
       hashes[i] = Upper32of64(h);
     }
-    for (int i = 0; i < num_keys; ++i) {
-      may_match[i] = FastLocalBloomImpl::HashMayMatchPrepared(
-          hashes[i], num_probes_, data_ + byte_offsets[i]);
-    }
+    FastLocalBloomImpl::HashesMayMatchPrepared(num_keys, hashes.data(),
+                                               byte_offsets.data(),
+                                               num_probes_, data_, may_match);
   }
 
  private:
@@ -425,11 +478,14 @@ class Standard128RibbonBitsBuilder : public XXH3pFilterBitsBuilder {
  public:
   explicit Standard128RibbonBitsBuilder(
       double desired_one_in_fp_rate, int bloom_millibits_per_key,
-      std::atomic<int64_t>* aggregate_rounding_balance, Logger* info_log)
-      : XXH3pFilterBitsBuilder(aggregate_rounding_balance),
+      std::atomic<int64_t>* aggregate_rounding_balance,
+      std::shared_ptr<CacheReservationManager> cache_res_mgr,
+      Logger* info_log)
+      : XXH3pFilterBitsBuilder(aggregate_rounding_balance, cache_res_mgr),
         desired_one_in_fp_rate_(desired_one_in_fp_rate),
         info_log_(info_log),
-        bloom_fallback_(bloom_millibits_per_key, aggregate_rounding_balance) {
+        bloom_fallback_(bloom_millibits_per_key, aggregate_rounding_balance,
+                        cache_res_mgr) {
     assert(desired_one_in_fp_rate >= 1.0);
   }
 
@@ -465,6 +521,23 @@ class Standard128RibbonBitsBuilder : public XXH3pFilterBitsBuilder {
       return bloom_fallback_.Finish(buf);
     }
 
+    // Banding is the memory-hungry part of Ribbon construction, so charge
+    // it (with entries and the final filter) before it starts. If the
+    // block cache can't take it, Bloom is a better outcome than going
+    // over the memory budget.
+    Status s = UpdateCacheReservation(
+        hash_entries_.size() * sizeof(uint64_t) +
+        size_t{num_slots} * kBandingBytesPerSlot + len_with_metadata);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(info_log_,
+                     "Block cache reservation for Ribbon filter failed (%s), "
+                     "using Bloom filter",
+                     s.ToString().c_str());
+      SwapEntriesWith(&bloom_fallback_);
+      assert(hash_entries_.empty());
+      return bloom_fallback_.Finish(buf);
+    }
+
     uint32_t entropy = 0;
     if (!hash_entries_.empty()) {
       entropy = Lower32of64(hash_entries_.front());
@@ -516,6 +589,8 @@ class Standard128RibbonBitsBuilder : public XXH3pFilterBitsBuilder {
     mutable_buf[len_with_metadata - 1] =
         static_cast<char>((num_blocks >> 16) & 255);
 
+    ReleaseCacheReservation();
+
     Slice rv(mutable_buf.get(), len_with_metadata);
     *buf = std::move(mutable_buf);
     return rv;
@@ -691,6 +766,11 @@ class Standard128RibbonBitsBuilder : public XXH3pFilterBitsBuilder {
   // (for filter metadata).
   static constexpr uint32_t kMaxRibbonEntries = 950000000;  // ~ 1 billion
 
+  // Banding memory per slot: coefficient row, result row, and (up to)
+  // backtracking index, for reserve_table_builder_memory
+  static constexpr size_t kBandingBytesPerSlot =
+      sizeof(TS::CoeffRow) + sizeof(TS::ResultRow) + sizeof(uint32_t);
+
   // A desired value for 1/fp_rate. For example, 100 -> 1% fp rate.
   double desired_one_in_fp_rate_;
 
@@ -726,23 +806,12 @@ class Standard128RibbonBitsReader : public FilterBitsReader {
   }
 
   virtual void MayMatch(int num_keys, Slice** keys, bool* may_match) override {
-    struct SavedData {
-      uint64_t seeded_hash;
-      uint32_t segment_num;
-      uint32_t num_columns;
-      uint32_t start_bits;
-    };
-    std::array<SavedData, MultiGetContext::MAX_BATCH_SIZE> saved;
-    for (int i = 0; i < num_keys; ++i) {
-      ribbon::InterleavedPrepareQuery(
-          GetSliceHash64(*keys[i]), hasher_, soln_, &saved[i].seeded_hash,
-          &saved[i].segment_num, &saved[i].num_columns, &saved[i].start_bits);
-    }
+    std::array<uint64_t, MultiGetContext::MAX_BATCH_SIZE> hashes;
     for (int i = 0; i < num_keys; ++i) {
-      may_match[i] = ribbon::InterleavedFilterQuery(
-          saved[i].seeded_hash, saved[i].segment_num, saved[i].num_columns,
-          saved[i].start_bits, hasher_, soln_);
+      hashes[i] = GetSliceHash64(*keys[i]);
     }
+    soln_.FilterQueries(static_cast<size_t>(num_keys), hashes.data(), hasher_,
+                        may_match);
   }
 
  private:
@@ -1031,8 +1100,12 @@ const std::vector<BloomFilterPolicy::Mode> BloomFilterPolicy::kAllUserModes = {
     kStandard128Ribbon,
 };
 
-BloomFilterPolicy::BloomFilterPolicy(double bits_per_key, Mode mode)
-    : mode_(mode), warned_(false), aggregate_rounding_balance_(0) {
+namespace {
+// Derives the bits per key settings of BloomFilterPolicy from a
+// configured bits_per_key
+void ComputeBitsPerKeySettings(double bits_per_key, int* millibits_per_key,
+                               int* whole_bits_per_key,
+                               double* desired_one_in_fp_rate) {
   // Sanitize bits_per_key
   if (bits_per_key < 1.0) {
     bits_per_key = 1.0;
@@ -1043,21 +1116,108 @@ BloomFilterPolicy::BloomFilterPolicy(double bits_per_key, Mode mode)
   // Includes a nudge toward rounding up, to ensure on all platforms
   // that doubles specified with three decimal digits after the decimal
   // point are interpreted accurately.
-  millibits_per_key_ = static_cast<int>(bits_per_key * 1000.0 + 0.500001);
+  *millibits_per_key = static_cast<int>(bits_per_key * 1000.0 + 0.500001);
 
   // For now configure Ribbon filter to match Bloom FP rate and save
   // memory. (Ribbon bits per key will be ~30% less than Bloom bits per key
   // for same FP rate.)
-  desired_one_in_fp_rate_ =
+  *desired_one_in_fp_rate =
       1.0 / BloomMath::CacheLocalFpRate(
                 bits_per_key,
-                FastLocalBloomImpl::ChooseNumProbes(millibits_per_key_),
+                FastLocalBloomImpl::ChooseNumProbes(*millibits_per_key),
                 /*cache_line_bits*/ 512);
 
   // For better or worse, this is a rounding up of a nudged rounding up,
   // e.g. 7.4999999999999 will round up to 8, but that provides more
   // predictability against small arithmetic errors in floating point.
-  whole_bits_per_key_ = (millibits_per_key_ + 500) / 1000;
+  *whole_bits_per_key = (*millibits_per_key + 500) / 1000;
+}
+}  // namespace
+
+BloomFilterPolicy::BloomFilterPolicy(double bits_per_key, Mode mode,
+                                     bool optimize_per_level)
+    : mode_(mode),
+      optimize_per_level_(optimize_per_level),
+      warned_(false),
+      aggregate_rounding_balance_(0) {
+  ComputeBitsPerKeySettings(bits_per_key, &millibits_per_key_,
+                            &whole_bits_per_key_, &desired_one_in_fp_rate_);
+}
+
+double BloomFilterPolicy::GetLevelOptimizedBitsPerKey(
+    double average_bits_per_key, const FilterBuildingContext& context) {
+  const std::vector<uint64_t>& level_bytes = context.level_bytes;
+  const int level = context.level_at_creation;
+  if (level < 0 || static_cast<size_t>(level) >= level_bytes.size()) {
+    return average_bits_per_key;
+  }
+
+  // Sizes of the sorted runs: each L0 file, then each non-empty level
+  std::vector<double> run_bytes;
+  const int num_level0_files = context.num_level0_files;
+  if (level_bytes[0] > 0 && num_level0_files > 0) {
+    run_bytes.assign(static_cast<size_t>(num_level0_files),
+                     static_cast<double>(level_bytes[0]) / num_level0_files);
+  }
+  for (size_t i = 1; i < level_bytes.size(); ++i) {
+    if (level_bytes[i] > 0) {
+      run_bytes.push_back(static_cast<double>(level_bytes[i]));
+    }
+  }
+  double this_run_bytes = static_cast<double>(level_bytes[level]);
+  if (level == 0) {
+    this_run_bytes /= std::max(num_level0_files, 1);
+  }
+  if (!(this_run_bytes > 0.0)) {
+    return average_bits_per_key;
+  }
+
+  // Approximating the FP rate of each run with b bits/key as
+  // exp(-b * ln(2)^2), the sum of FP rates for a total number of bits is
+  // minimized when each run's FP rate is proportional to its size, i.e.
+  //   b_i = c - ln(n_i) / ln(2)^2
+  // with c set by the budget. Runs for which that is below the minimum
+  // take the minimum, and the rest of the budget is spread over the other
+  // runs, until no more runs need the minimum. (Only the relative sizes
+  // of the runs matter, so bytes work in place of numbers of keys.)
+  constexpr double kMinBitsPerKey = 1.0;
+  const double kLn2Squared = std::log(2.0) * std::log(2.0);
+  double total_bytes = 0.0;
+  for (double bytes : run_bytes) {
+    total_bytes += bytes;
+  }
+  double remaining_bits = average_bits_per_key * total_bytes;
+  std::vector<bool> at_min(run_bytes.size(), false);
+  double c = average_bits_per_key;
+  for (;;) {
+    // Solve for c under the current set of runs at the minimum
+    double free_bytes = 0.0;
+    double free_bytes_log_bytes = 0.0;
+    for (size_t i = 0; i < run_bytes.size(); ++i) {
+      if (!at_min[i]) {
+        free_bytes += run_bytes[i];
+        free_bytes_log_bytes += run_bytes[i] * std::log(run_bytes[i]);
+      }
+    }
+    if (!(free_bytes > 0.0)) {
+      // Budget too small for all; everything is at the minimum
+      return kMinBitsPerKey;
+    }
+    c = (remaining_bits + free_bytes_log_bytes / kLn2Squared) / free_bytes;
+    bool changed = false;
+    for (size_t i = 0; i < run_bytes.size(); ++i) {
+      if (!at_min[i] &&
+          c - std::log(run_bytes[i]) / kLn2Squared < kMinBitsPerKey) {
+        at_min[i] = true;
+        remaining_bits -= kMinBitsPerKey * run_bytes[i];
+        changed = true;
+      }
+    }
+    if (!changed) {
+      break;
+    }
+  }
+  return std::max(kMinBitsPerKey, c - std::log(this_run_bytes) / kLn2Squared);
 }
 
 BloomFilterPolicy::~BloomFilterPolicy() {}
@@ -1134,6 +1294,20 @@ FilterBitsBuilder* BloomFilterPolicy::GetBuilderWithContext(
     const FilterBuildingContext& context) const {
   Mode cur = mode_;
   bool offm = context.table_options.optimize_filters_for_memory;
+  int millibits_per_key = millibits_per_key_;
+  int whole_bits_per_key = whole_bits_per_key_;
+  double desired_one_in_fp_rate = desired_one_in_fp_rate_;
+  if (optimize_per_level_) {
+    ComputeBitsPerKeySettings(
+        GetLevelOptimizedBitsPerKey(millibits_per_key_ / 1000.0, context),
+        &millibits_per_key, &whole_bits_per_key, &desired_one_in_fp_rate);
+  }
+  std::shared_ptr<CacheReservationManager> cache_res_mgr;
+  if (context.table_options.reserve_table_builder_memory &&
+      context.table_options.block_cache) {
+    cache_res_mgr = std::make_shared<CacheReservationManager>(
+        context.table_options.block_cache);
+  }
   // Unusual code construction so that we can have just
   // one exhaustive switch without (risky) recursion
   for (int i = 0; i < 2; ++i) {
@@ -1149,13 +1323,14 @@ FilterBitsBuilder* BloomFilterPolicy::GetBuilderWithContext(
         return nullptr;
       case kFastLocalBloom:
         return new FastLocalBloomBitsBuilder(
-            millibits_per_key_, offm ? &aggregate_rounding_balance_ : nullptr);
+            millibits_per_key, offm ? &aggregate_rounding_balance_ : nullptr,
+            cache_res_mgr);
       case kLegacyBloom:
-        if (whole_bits_per_key_ >= 14 && context.info_log &&
+        if (whole_bits_per_key >= 14 && context.info_log &&
             !warned_.load(std::memory_order_relaxed)) {
           warned_ = true;
           const char* adjective;
-          if (whole_bits_per_key_ >= 20) {
+          if (whole_bits_per_key >= 20) {
             adjective = "Dramatic";
           } else {
             adjective = "Significant";
@@ -1167,14 +1342,15 @@ FilterBitsBuilder* BloomFilterPolicy::GetBuilderWithContext(
               "Using legacy Bloom filter with high (%d) bits/key. "
               "%s filter space and/or accuracy improvement is available "
               "with format_version>=5.",
-              whole_bits_per_key_, adjective);
+              whole_bits_per_key, adjective);
         }
-        return new LegacyBloomBitsBuilder(whole_bits_per_key_,
+        return new LegacyBloomBitsBuilder(whole_bits_per_key,
                                           context.info_log);
       case kStandard128Ribbon:
         return new Standard128RibbonBitsBuilder(
-            desired_one_in_fp_rate_, millibits_per_key_,
-            offm ? &aggregate_rounding_balance_ : nullptr, context.info_log);
+            desired_one_in_fp_rate, millibits_per_key,
+            offm ? &aggregate_rounding_balance_ : nullptr, cache_res_mgr,
+            context.info_log);
     }
   }
   assert(false);
@@ -1376,6 +1552,15 @@ extern const FilterPolicy* NewRibbonFilterPolicy(
                                BloomFilterPolicy::kStandard128Ribbon);
 }
 
+const FilterPolicy* NewLevelOptimizedFilterPolicy(double average_bits_per_key,
+                                                  bool use_ribbon) {
+  return new BloomFilterPolicy(average_bits_per_key,
+                               use_ribbon
+                                   ? BloomFilterPolicy::kStandard128Ribbon
+                                   : BloomFilterPolicy::kAutoBloom,
+                               /*optimize_per_level*/ true);
+}
+
 FilterBuildingContext::FilterBuildingContext(
     const BlockBasedTableOptions& _table_options)
     : table_options(_table_options) {}
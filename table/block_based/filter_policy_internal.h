@@ -84,7 +84,11 @@ class BloomFilterPolicy : public FilterPolicy {
   // tests should prefer using NewBloomFilterPolicy (user-exposed).
   static const std::vector<Mode> kAllUserModes;
 
-  explicit BloomFilterPolicy(double bits_per_key, Mode mode);
+  // With optimize_per_level, bits_per_key is the average over the LSM tree
+  // and each filter gets bits per key from
+  // GetLevelOptimizedBitsPerKey(). See NewLevelOptimizedFilterPolicy.
+  explicit BloomFilterPolicy(double bits_per_key, Mode mode,
+                             bool optimize_per_level = false);
 
   ~BloomFilterPolicy() override;
 
@@ -123,6 +127,19 @@ class BloomFilterPolicy : public FilterPolicy {
   // Testing only
   Mode GetMode() const { return mode_; }
 
+  // Testing only
+  bool GetOptimizePerLevel() const { return optimize_per_level_; }
+
+  // Returns the bits per key for a new filter in the sorted run of
+  // context.level_at_creation, such that with the same choice for the
+  // rest of the LSM tree described by context.level_bytes, the sum of
+  // (standard Bloom filter) FP rates over the sorted runs is minimized for
+  // an average of average_bits_per_key over all the data. No run gets
+  // fewer than 1 bit per key. Returns average_bits_per_key if the LSM
+  // tree shape or level is unknown.
+  static double GetLevelOptimizedBitsPerKey(
+      double average_bits_per_key, const FilterBuildingContext& context);
+
  private:
   // Bits per key settings are for configuring Bloom filters.
 
@@ -144,6 +161,10 @@ class BloomFilterPolicy : public FilterPolicy {
   // implementation) for building new SST filters.
   Mode mode_;
 
+  // Whether millibits_per_key_ etc. are an average to be distributed over
+  // the levels of the LSM tree (see GetLevelOptimizedBitsPerKey())
+  bool optimize_per_level_;
+
   // Whether relevant warnings have been logged already. (Remember so we
   // only report once per BloomFilterPolicy instance, to keep the noise down.)
   mutable std::atomic<bool> warned_;
@@ -267,8 +267,19 @@ void FullFilterBlockReader::MayMatch(
   for (auto iter = filter_range.begin(); iter != filter_range.end(); ++iter) {
     if (!prefix_extractor) {
       keys[num_keys++] = &iter->ukey_without_ts;
-    } else if (prefix_extractor->InDomain(iter->ukey_without_ts)) {
-      prefixes.emplace_back(prefix_extractor->Transform(iter->ukey_without_ts));
+      continue;
+    }
+    Slice prefix;
+    const bool in_domain =
+        iter->get_context != nullptr
+            ? iter->get_context->GetPrefix(prefix_extractor,
+                                           iter->ukey_without_ts, &prefix)
+            : prefix_extractor->InDomain(iter->ukey_without_ts);
+    if (in_domain) {
+      if (iter->get_context == nullptr) {
+        prefix = prefix_extractor->Transform(iter->ukey_without_ts);
+      }
+      prefixes.emplace_back(prefix);
       keys[num_keys++] = &prefixes.back();
     } else {
       filter_range.SkipKey(iter);
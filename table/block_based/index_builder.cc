@@ -54,6 +54,20 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
           comparator, use_value_delta_encoding, table_opt);
       break;
     }
+    case BlockBasedTableOptions::kLearned: {
+      result = new LearnedIndexBuilder(
+          comparator, table_opt.index_block_restart_interval,
+          table_opt.format_version, use_value_delta_encoding,
+          table_opt.index_shortening);
+      break;
+    }
+    case BlockBasedTableOptions::kEliasFano: {
+      result = new EliasFanoIndexBuilder(
+          comparator, table_opt.index_block_restart_interval,
+          table_opt.format_version, use_value_delta_encoding,
+          table_opt.index_shortening);
+      break;
+    }
     case BlockBasedTableOptions::kBinarySearchWithFirstKey: {
       result = new ShortenedIndexBuilder(
           comparator, table_opt.index_block_restart_interval,
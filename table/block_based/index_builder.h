@@ -15,10 +15,13 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/elias_fano_index.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -353,6 +356,147 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// LearnedIndexBuilder contains a binary-searchable primary index and a
+// metablock with a piecewise linear model of its restart keys (see
+// learned_index.h), which readers use to narrow down the binary search. The
+// model is left out when the keys are not suitable for it, e.g. when they are
+// not ordered bytewise, in which case the index reads as kBinarySearch.
+class LearnedIndexBuilder : public IndexBuilder {
+ public:
+  explicit LearnedIndexBuilder(
+      const InternalKeyComparator* comparator,
+      int index_block_restart_interval, int format_version,
+      bool use_value_delta_encoding,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode)
+      : IndexBuilder(comparator),
+        primary_index_builder_(comparator, index_block_restart_interval,
+                               format_version, use_value_delta_encoding,
+                               shortening_mode, /* include_first_key */ false),
+        index_block_restart_interval_(index_block_restart_interval),
+        bytewise_(comparator->user_comparator() == BytewiseComparator()) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override {
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+    // `last_key_in_current_block` now holds the index key
+    if (bytewise_ && num_entries_ % index_block_restart_interval_ == 0) {
+      restart_keys_.push_back(
+          ExtractUserKey(*last_key_in_current_block).ToString());
+    }
+    ++num_entries_;
+  }
+
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override {
+    Status s = primary_index_builder_.Finish(index_blocks,
+                                             last_partition_block_handle);
+    if (bytewise_ && LearnedIndexModel::Build(restart_keys_, &model_block_)) {
+      index_blocks->meta_blocks.insert(
+          {kLearnedIndexBlock.c_str(), model_block_});
+    }
+    restart_keys_.clear();
+    return s;
+  }
+
+  virtual size_t IndexSize() const override {
+    return primary_index_builder_.IndexSize() + model_block_.size();
+  }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
+ private:
+  ShortenedIndexBuilder primary_index_builder_;
+  const int index_block_restart_interval_;
+  const bool bytewise_;
+  uint64_t num_entries_ = 0;
+  // user keys at the restart points of the primary index
+  std::vector<std::string> restart_keys_;
+  std::string model_block_;
+};
+
+// EliasFanoIndexBuilder contains a binary-searchable primary index and a
+// metablock with a compact index of fixed-size separators and block offsets
+// (see elias_fano_index.h), which readers use instead of the primary index.
+// The metablock is left out when the keys or the block layout do not allow
+// it, in which case the index reads as kBinarySearch.
+class EliasFanoIndexBuilder : public IndexBuilder {
+ public:
+  explicit EliasFanoIndexBuilder(
+      const InternalKeyComparator* comparator,
+      int index_block_restart_interval, int format_version,
+      bool use_value_delta_encoding,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode)
+      : IndexBuilder(comparator),
+        primary_index_builder_(comparator, index_block_restart_interval,
+                               format_version, use_value_delta_encoding,
+                               shortening_mode, /* include_first_key */ false),
+        usable_(comparator->user_comparator() == BytewiseComparator()) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override {
+    if (usable_) {
+      // Before the primary index shortens it
+      const Slice last_key = ExtractUserKey(*last_key_in_current_block);
+      if (first_key_in_next_block != nullptr) {
+        const Slice next_key = ExtractUserKey(*first_key_in_next_block);
+        const size_t diff = last_key.difference_offset(next_key);
+        if (diff < last_key.size()) {
+          separator_size_ = std::max(separator_size_, diff + 1);
+        } else {
+          // The user key continues in the next block
+          usable_ = false;
+        }
+      }
+      last_keys_.push_back(last_key.ToString());
+      handles_.push_back(block_handle);
+    }
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+  }
+
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override {
+    Status s = primary_index_builder_.Finish(index_blocks,
+                                             last_partition_block_handle);
+    // Readers of older format versions expect separators with sequence
+    // numbers, which this index does not have
+    if (usable_ && !primary_index_builder_.seperator_is_key_plus_seq() &&
+        EliasFanoIndex::Build(last_keys_, handles_, separator_size_,
+                              &elias_fano_block_)) {
+      index_blocks->meta_blocks.insert(
+          {kEliasFanoIndexBlock.c_str(), elias_fano_block_});
+    }
+    last_keys_.clear();
+    handles_.clear();
+    return s;
+  }
+
+  virtual size_t IndexSize() const override {
+    return primary_index_builder_.IndexSize() + elias_fano_block_.size();
+  }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
+ private:
+  ShortenedIndexBuilder primary_index_builder_;
+  bool usable_;
+  // Bytes of the user keys needed to tell the data blocks apart
+  size_t separator_size_ = 0;
+  // user keys at the ends of the data blocks
+  std::vector<std::string> last_keys_;
+  std::vector<BlockHandle> handles_;
+  std::string elias_fano_block_;
+};
+
 /**
  * IndexBuilder for two-level indexing. Internally it creates a new index for
  * each partition and Finish then in order when Finish is called on it
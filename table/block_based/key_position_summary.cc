@@ -0,0 +1,148 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/key_position_summary.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+KeyPositionSummaryBuilder::KeyPositionSummaryBuilder(uint32_t max_samples)
+    : max_samples_(std::max<uint32_t>(max_samples, 1)) {}
+
+void KeyPositionSummaryBuilder::AddBlockKey(const Slice& last_key,
+                                            uint64_t num_entries) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t block = num_blocks_++;
+  last_block_.key.assign(last_key.data(), last_key.size());
+  last_block_.block = block;
+  last_block_.end_offset = 0;
+  last_block_.num_entries = num_entries;
+  if (block % stride_ != 0) {
+    return;
+  }
+  samples_.push_back(last_block_);
+  if (samples_.size() > 2 * max_samples_) {
+    // Keep every other sample
+    stride_ *= 2;
+    auto end = std::remove_if(
+        samples_.begin(), samples_.end(),
+        [this](const Sample& sample) { return sample.block % stride_ != 0; });
+    samples_.erase(end, samples_.end());
+  }
+}
+
+void KeyPositionSummaryBuilder::AddBlockEnd(uint64_t end_offset) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t block = num_blocks_written_++;
+  assert(block < num_blocks_);
+  if (block == last_block_.block) {
+    last_block_.end_offset = end_offset;
+  }
+  auto it = std::lower_bound(
+      samples_.begin(), samples_.end(), block,
+      [](const Sample& sample, uint64_t b) { return sample.block < b; });
+  if (it != samples_.end() && it->block == block) {
+    it->end_offset = end_offset;
+  }
+}
+
+Slice KeyPositionSummaryBuilder::Finish() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert(num_blocks_written_ == num_blocks_);
+  if (!samples_.empty() && samples_.back().block != last_block_.block) {
+    samples_.push_back(last_block_);
+  }
+  for (const Sample& sample : samples_) {
+    PutLengthPrefixedSlice(&buffer_, sample.key);
+    PutVarint64Varint64(&buffer_, sample.block, sample.end_offset);
+    PutVarint64(&buffer_, sample.num_entries);
+  }
+  PutFixed32(&buffer_, static_cast<uint32_t>(samples_.size()));
+  return buffer_;
+}
+
+std::unique_ptr<KeyPositionSummaryReader> KeyPositionSummaryReader::Create(
+    BlockContents&& contents, const InternalKeyComparator& icmp) {
+  if (contents.data.size() < sizeof(uint32_t)) {
+    return nullptr;
+  }
+  std::unique_ptr<KeyPositionSummaryReader> reader(
+      new KeyPositionSummaryReader(std::move(contents), icmp));
+  Slice input = reader->contents_.data;
+  const uint32_t num_samples =
+      DecodeFixed32(input.data() + input.size() - sizeof(uint32_t));
+  input.remove_suffix(sizeof(uint32_t));
+  reader->samples_.reserve(num_samples);
+  for (uint32_t i = 0; i < num_samples; ++i) {
+    Sample sample;
+    if (!GetLengthPrefixedSlice(&input, &sample.key) ||
+        !GetVarint64(&input, &sample.block) ||
+        !GetVarint64(&input, &sample.end_offset) ||
+        !GetVarint64(&input, &sample.num_entries)) {
+      return nullptr;
+    }
+    if (!reader->samples_.empty()) {
+      const Sample& prev = reader->samples_.back();
+      if (sample.block <= prev.block || sample.end_offset < prev.end_offset ||
+          sample.num_entries < prev.num_entries) {
+        return nullptr;
+      }
+    }
+    reader->samples_.push_back(sample);
+  }
+  if (!input.empty() || reader->samples_.empty()) {
+    return nullptr;
+  }
+  return reader;
+}
+
+namespace {
+// The middle of the possible starts of the blocks between two samples,
+// when `num_blocks` blocks end between `prev` and `curr`: the first of them
+// starts at `prev`, the last at about `curr` minus an average block.
+uint64_t MiddleOfBlocks(uint64_t prev, uint64_t curr, uint64_t num_blocks) {
+  const uint64_t last_start = curr - (curr - prev) / num_blocks;
+  return prev + (last_start - prev) / 2;
+}
+}  // namespace
+
+KeyPositionSummaryReader::Position
+KeyPositionSummaryReader::ApproximatePosition(const Slice& key) const {
+  // Find the first sample whose last key is >= key
+  auto it = std::lower_bound(samples_.begin(), samples_.end(), key,
+                             [this](const Sample& sample, const Slice& k) {
+                               return icmp_.Compare(sample.key, k) < 0;
+                             });
+  if (it == samples_.end()) {
+    // Past the last key of the table
+    return Position{data_size(), num_entries()};
+  }
+  uint64_t prev_blocks = 0;
+  uint64_t prev_end_offset = 0;
+  uint64_t prev_num_entries = 0;
+  if (it != samples_.begin()) {
+    auto prev = it - 1;
+    prev_blocks = prev->block + 1;
+    prev_end_offset = prev->end_offset;
+    prev_num_entries = prev->num_entries;
+  }
+  // The key is in one of the blocks after the previous sample, up to and
+  // including the block of this sample
+  const uint64_t num_blocks = it->block + 1 - prev_blocks;
+  return Position{
+      MiddleOfBlocks(prev_end_offset, it->end_offset, num_blocks),
+      MiddleOfBlocks(prev_num_entries, it->num_entries, num_blocks)};
+}
+
+size_t KeyPositionSummaryReader::ApproximateMemoryUsage() const {
+  return contents_.ApproximateMemoryUsage() + sizeof(*this) +
+         samples_.capacity() * sizeof(Sample);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
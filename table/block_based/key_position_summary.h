@@ -0,0 +1,122 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/slice.h"
+#include "table/format.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A key position summary samples the data blocks of a table file, so that
+// the file offset and the number of entries before a key can be estimated
+// with a binary search in memory instead of an index seek (see
+// BlockBasedTableOptions::key_position_samples).
+//
+// Each sample is a data block: its last internal key, its index among the
+// data blocks, the file offset where it ends and the number of entries in
+// it and all the blocks before it. The blocks sampled are every stride-th
+// one, starting with the first, plus the last one; the stride doubles
+// whenever there would be more than twice the requested number of samples.
+//
+// Format of the block:
+//   [sample 0] ... [sample N-1] [N: fixed32]
+// where each sample is
+//   [key length: varint32] [key] [block index: varint64]
+//   [end offset: varint64] [num entries: varint64]
+class KeyPositionSummaryBuilder {
+ public:
+  explicit KeyPositionSummaryBuilder(uint32_t max_samples);
+  // No copying allowed
+  KeyPositionSummaryBuilder(const KeyPositionSummaryBuilder&) = delete;
+  void operator=(const KeyPositionSummaryBuilder&) = delete;
+
+  // Called when a data block is cut, in block order. num_entries counts the
+  // entries of the table up to and including the block.
+  void AddBlockKey(const Slice& last_key, uint64_t num_entries);
+
+  // Called when a data block has been written, in block order, with the
+  // file offset where it ends. May be called from another thread than
+  // AddBlockKey().
+  void AddBlockEnd(uint64_t end_offset);
+
+  bool empty() const { return samples_.empty(); }
+
+  // Returns the contents of the block. The returned slice remains valid
+  // for the lifetime of this builder.
+  // REQUIRES: AddBlockEnd() was called for every block
+  Slice Finish();
+
+ private:
+  struct Sample {
+    std::string key;
+    uint64_t block;
+    uint64_t end_offset;
+    uint64_t num_entries;
+  };
+
+  const size_t max_samples_;
+  std::mutex mutex_;
+  std::vector<Sample> samples_;
+  uint64_t stride_ = 1;
+  uint64_t num_blocks_ = 0;
+  uint64_t num_blocks_written_ = 0;
+  // The last block, which is always sampled
+  Sample last_block_;
+  std::string buffer_;
+};
+
+class KeyPositionSummaryReader {
+ public:
+  // Returns nullptr if contents is not a valid key position summary
+  static std::unique_ptr<KeyPositionSummaryReader> Create(
+      BlockContents&& contents, const InternalKeyComparator& icmp);
+
+  // An estimate of the data blocks before a key
+  struct Position {
+    // File offset where the data of the key begins
+    uint64_t data_offset;
+    // Number of entries before the key
+    uint64_t num_entries;
+  };
+
+  // Estimates the position of internal key `key`: the middle of the data
+  // blocks that the key may be in, given the surrounding samples. Exact at
+  // block granularity when every block is sampled.
+  Position ApproximatePosition(const Slice& key) const;
+
+  // The end of the data blocks and the total number of entries
+  uint64_t data_size() const { return samples_.back().end_offset; }
+  uint64_t num_entries() const { return samples_.back().num_entries; }
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  struct Sample {
+    Slice key;
+    uint64_t block;
+    uint64_t end_offset;
+    uint64_t num_entries;
+  };
+
+  KeyPositionSummaryReader(BlockContents&& contents,
+                           const InternalKeyComparator& icmp)
+      : contents_(std::move(contents)), icmp_(icmp) {}
+
+  BlockContents contents_;
+  const InternalKeyComparator& icmp_;
+  // Pointing into contents_
+  std::vector<Sample> samples_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,184 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Restart points a segment may be off by. Keeps the binary search that
+// follows a prediction at about five comparisons.
+const uint32_t kLearnedIndexMaxError = 8;
+
+// The point of `key`: the 8 bytes after the common prefix (padded with
+// zeros) as a big-endian integer.
+uint64_t KeyToPoint(const Slice& key, size_t common_prefix_size) {
+  assert(key.size() >= common_prefix_size);
+  char buf[sizeof(uint64_t)] = {0};
+  memcpy(buf, key.data() + common_prefix_size,
+         std::min(key.size() - common_prefix_size, sizeof(buf)));
+  return EndianSwapValue(DecodeFixed64(buf));
+}
+
+void PutDouble(std::string* dst, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  PutFixed64(dst, bits);
+}
+
+double DecodeDouble(const char* ptr) {
+  uint64_t bits = DecodeFixed64(ptr);
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+const size_t kSegmentSize = 2 * sizeof(uint64_t) + sizeof(uint32_t);
+}  // namespace
+
+bool LearnedIndexModel::Build(const std::vector<std::string>& restart_keys,
+                              std::string* dst) {
+  if (restart_keys.size() < 2 ||
+      restart_keys.size() > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  // The keys are sorted, so the first and the last key share the prefix
+  // common to all of them.
+  const Slice first_key = restart_keys.front();
+  const Slice last_key = restart_keys.back();
+  size_t common_prefix_size = first_key.difference_offset(last_key);
+
+  // Restart keys that map to the same point keep only their first restart
+  // index; the remaining ones are left to the binary search.
+  std::vector<std::pair<uint64_t, uint32_t>> points;
+  points.reserve(restart_keys.size());
+  for (size_t i = 0; i < restart_keys.size(); i++) {
+    uint64_t point = KeyToPoint(restart_keys[i], common_prefix_size);
+    if (points.empty() || point != points.back().first) {
+      points.emplace_back(point, static_cast<uint32_t>(i));
+    }
+  }
+  if (points.size() < restart_keys.size() / 2) {
+    // The keys differ mostly after their first 8 distinguishing bytes, e.g.
+    // strings with varying-length prefixes. Plain binary search is as good.
+    return false;
+  }
+
+  // Greedy "shrinking cone" segmentation: a segment grows while some slope
+  // through its first point keeps every point within the error bound.
+  std::vector<Segment> segments;
+  const double max_error = kLearnedIndexMaxError;
+  size_t start = 0;
+  double min_slope = 0;
+  double max_slope = std::numeric_limits<double>::infinity();
+  for (size_t i = 1; i <= points.size(); i++) {
+    if (i < points.size()) {
+      double dx = static_cast<double>(points[i].first - points[start].first);
+      double dy =
+          static_cast<double>(points[i].second - points[start].second);
+      double lo = std::max(min_slope, (dy - max_error) / dx);
+      double hi = std::min(max_slope, (dy + max_error) / dx);
+      if (lo <= hi) {
+        min_slope = lo;
+        max_slope = hi;
+        continue;
+      }
+    }
+    Segment segment;
+    segment.first_point = points[start].first;
+    segment.first_restart = points[start].second;
+    segment.slope = max_slope == std::numeric_limits<double>::infinity()
+                        ? min_slope
+                        : (min_slope + max_slope) / 2;
+    segments.push_back(segment);
+    start = i;
+    min_slope = 0;
+    max_slope = std::numeric_limits<double>::infinity();
+  }
+  if (segments.size() * 4 > restart_keys.size()) {
+    // The keys are too irregular for the model to be much smaller than the
+    // index itself.
+    return false;
+  }
+
+  PutVarint32(dst, static_cast<uint32_t>(common_prefix_size));
+  dst->append(first_key.data(), common_prefix_size);
+  PutVarint32(dst, kLearnedIndexMaxError);
+  PutVarint32(dst, static_cast<uint32_t>(restart_keys.size()));
+  PutVarint32(dst, static_cast<uint32_t>(segments.size()));
+  for (const auto& segment : segments) {
+    PutFixed64(dst, segment.first_point);
+    PutFixed32(dst, segment.first_restart);
+    PutDouble(dst, segment.slope);
+  }
+  return true;
+}
+
+Status LearnedIndexModel::Create(const Slice& contents,
+                                 std::unique_ptr<LearnedIndexModel>* model) {
+  Slice input = contents;
+  std::unique_ptr<LearnedIndexModel> result(new LearnedIndexModel());
+  Slice common_prefix;
+  uint32_t num_segments = 0;
+  if (!GetLengthPrefixedSlice(&input, &common_prefix) ||
+      !GetVarint32(&input, &result->max_error_) ||
+      !GetVarint32(&input, &result->num_restarts_) ||
+      !GetVarint32(&input, &num_segments) || num_segments == 0 ||
+      input.size() != static_cast<size_t>(num_segments) * kSegmentSize) {
+    return Status::Corruption("Corrupted learned index block");
+  }
+  result->common_prefix_ = common_prefix.ToString();
+  result->segments_.resize(num_segments);
+  const char* p = input.data();
+  for (auto& segment : result->segments_) {
+    segment.first_point = DecodeFixed64(p);
+    segment.first_restart = DecodeFixed32(p + sizeof(uint64_t));
+    segment.slope = DecodeDouble(p + sizeof(uint64_t) + sizeof(uint32_t));
+    p += kSegmentSize;
+    if (segment.first_restart >= result->num_restarts_) {
+      return Status::Corruption("Corrupted learned index block");
+    }
+  }
+  *model = std::move(result);
+  return Status::OK();
+}
+
+bool LearnedIndexModel::Predict(const Slice& user_key, uint32_t* first,
+                                uint32_t* last) const {
+  if (!user_key.starts_with(common_prefix_)) {
+    return false;
+  }
+  uint64_t point = KeyToPoint(user_key, common_prefix_.size());
+  auto next = std::upper_bound(
+      segments_.begin(), segments_.end(), point,
+      [](uint64_t p, const Segment& segment) { return p < segment.first_point; });
+  if (next == segments_.begin()) {
+    // Smaller than every restart key.
+    *first = *last = 0;
+    return true;
+  }
+  const Segment& segment = *(next - 1);
+  double predicted =
+      segment.first_restart +
+      segment.slope * static_cast<double>(point - segment.first_point);
+  // Keys past the last point of a segment belong before the next segment.
+  double limit = next == segments_.end() ? num_restarts_ - 1
+                                         : next->first_restart;
+  uint32_t restart = static_cast<uint32_t>(
+      std::max(static_cast<double>(segment.first_restart),
+               std::min(predicted, limit)));
+  *first = restart > max_error_ + 1 ? restart - max_error_ - 1 : 0;
+  *last = std::min(static_cast<uint64_t>(restart) + max_error_ + 1,
+                   static_cast<uint64_t>(num_restarts_ - 1));
+  return true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
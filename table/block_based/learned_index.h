@@ -0,0 +1,79 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A piecewise linear model of an index block (in the spirit of the PGM-index)
+// that maps a user key to the approximate restart point holding it, used by
+// BlockBasedTableOptions::kLearned.
+//
+// Keys are turned into points by stripping the prefix shared by all restart
+// keys and reading the next 8 bytes as a big-endian integer, which preserves
+// bytewise order. Each segment predicts the restart index of the keys between
+// its first point and the next segment within `max_error` restart points. The
+// prediction only narrows the binary search over the index block: readers
+// check the predicted bounds against the restart keys, so a mispredicted key
+// is still found, just without the speedup.
+//
+// Serialized format (the "rocksdb.learned.index" meta block):
+//
+//   common_prefix_size: varint32
+//   common_prefix: char[common_prefix_size]
+//   max_error: varint32
+//   num_restarts: varint32
+//   num_segments: varint32
+//   segments: {first_point: fixed64, first_restart: fixed32,
+//              slope: fixed64 (IEEE 754 double)}[num_segments]
+class LearnedIndexModel {
+ public:
+  // Builds a model over `restart_keys`, the user keys at the restart points
+  // of an index block in BytewiseComparator order, and appends it to `*dst`.
+  // Returns false without touching `*dst` when a model would not pay off,
+  // e.g. for non-numeric keys that mostly map to the same point.
+  static bool Build(const std::vector<std::string>& restart_keys,
+                    std::string* dst);
+
+  // Parses a model written by Build().
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<LearnedIndexModel>* model);
+
+  // Sets [*first, *last] to the range of restart indexes that the restart
+  // point at or before `user_key` is predicted to lie in. Returns false if
+  // the model cannot predict it (keys without the common prefix).
+  bool Predict(const Slice& user_key, uint32_t* first, uint32_t* last) const;
+
+  uint32_t num_restarts() const { return num_restarts_; }
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(LearnedIndexModel) + common_prefix_.capacity() +
+           segments_.capacity() * sizeof(Segment);
+  }
+
+ private:
+  struct Segment {
+    uint64_t first_point;
+    uint32_t first_restart;
+    double slope;
+  };
+
+  LearnedIndexModel() : max_error_(0), num_restarts_(0) {}
+
+  std::string common_prefix_;
+  uint32_t max_error_;
+  uint32_t num_restarts_;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
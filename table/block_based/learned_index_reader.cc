@@ -0,0 +1,114 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#include "table/block_based/learned_index_reader.h"
+
+#include "logging/logging.h"
+#include "table/block_fetcher.h"
+#include "table/meta_blocks.h"
+
+namespace ROCKSDB_NAMESPACE {
+Status LearnedIndexReader::Create(const BlockBasedTable* table,
+                                  const ReadOptions& ro,
+                                  FilePrefetchBuffer* prefetch_buffer,
+                                  InternalIterator* meta_index_iter,
+                                  bool use_cache, bool prefetch, bool pin,
+                                  BlockCacheLookupContext* lookup_context,
+                                  std::unique_ptr<IndexReader>* index_reader) {
+  assert(table != nullptr);
+  assert(index_reader != nullptr);
+  assert(!pin || prefetch);
+
+  const BlockBasedTable::Rep* rep = table->get_rep();
+  assert(rep != nullptr);
+
+  CachableEntry<Block> index_block;
+  if (prefetch || !use_cache) {
+    const Status s =
+        ReadIndexBlock(table, prefetch_buffer, ro, use_cache,
+                       /*get_context=*/nullptr, lookup_context, &index_block);
+    if (!s.ok()) {
+      return s;
+    }
+
+    if (use_cache && !pin) {
+      index_block.Reset();
+    }
+  }
+
+  // A missing or unreadable model only costs the speedup, so Create will
+  // succeed regardless from this point on.
+  index_reader->reset(new LearnedIndexReader(table, std::move(index_block)));
+
+  if (meta_index_iter == nullptr) {
+    return Status::OK();
+  }
+  // The builder leaves out the model if the keys are not suitable for it.
+  BlockHandle model_handle;
+  Status s = FindMetaBlock(meta_index_iter, kLearnedIndexBlock, &model_handle);
+  if (!s.ok()) {
+    return Status::OK();
+  }
+
+  BlockContents model_contents;
+  BlockFetcher model_block_fetcher(
+      rep->file.get(), prefetch_buffer, rep->footer, ReadOptions(),
+      model_handle, &model_contents, rep->ioptions, true /*decompress*/,
+      true /*maybe_compressed*/, BlockType::kLearnedIndex,
+      UncompressionDict::GetEmptyDict(), rep->persistent_cache_options,
+      GetMemoryAllocator(rep->table_options));
+  s = model_block_fetcher.ReadBlockContents();
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep->ioptions.logger,
+                   "Unable to read the learned index block: %s",
+                   s.ToString().c_str());
+    return Status::OK();
+  }
+
+  std::unique_ptr<LearnedIndexModel> model;
+  s = LearnedIndexModel::Create(model_contents.data, &model);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep->ioptions.logger, "%s", s.ToString().c_str());
+    return Status::OK();
+  }
+  static_cast<LearnedIndexReader*>(index_reader->get())->model_ =
+      std::move(model);
+
+  return Status::OK();
+}
+
+InternalIteratorBase<IndexValue>* LearnedIndexReader::NewIterator(
+    const ReadOptions& read_options, bool /* disable_prefix_seek */,
+    IndexBlockIter* iter, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context) {
+  const BlockBasedTable::Rep* rep = table()->get_rep();
+  const bool no_io = (read_options.read_tier == kBlockCacheTier);
+  CachableEntry<Block> index_block;
+  const Status s =
+      GetOrReadIndexBlock(no_io, get_context, lookup_context, &index_block);
+  if (!s.ok()) {
+    if (iter != nullptr) {
+      iter->Invalidate(s);
+      return iter;
+    }
+
+    return NewErrorInternalIterator<IndexValue>(s);
+  }
+
+  Statistics* kNullStats = nullptr;
+  // We don't return pinned data from index blocks, so no need
+  // to set `block_contents_pinned`.
+  auto it = index_block.GetValue()->NewIndexIterator(
+      internal_comparator()->user_comparator(),
+      rep->get_global_seqno(BlockType::kIndex), iter, kNullStats, true,
+      index_has_first_key(), index_key_includes_seq(), index_value_is_full(),
+      false /* block_contents_pinned */, nullptr /* prefix_index */,
+      model_.get());
+
+  assert(it != nullptr);
+  index_block.TransferTo(it);
+
+  return it;
+}
+}  // namespace ROCKSDB_NAMESPACE
@@ -8,12 +8,15 @@
 #include <utility>
 
 #include "file/random_access_file_reader.h"
+#include "memory/memory_allocator.h"
 #include "monitoring/perf_context_imp.h"
 #include "port/malloc.h"
 #include "port/port.h"
 #include "rocksdb/filter_policy.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_reader.h"
+#include "table/block_based/reader_common.h"
+#include "test_util/sync_point.h"
 #include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -356,63 +359,231 @@ void PartitionedFilterBlockReader::MayMatch(
     return;  // Any/all may match
   }
 
-  auto start_iter_same_handle = range->begin();
-  BlockHandle prev_filter_handle = BlockHandle::NullBlockHandle();
-
-  // For all keys mapping to same partition (must be adjacent in sorted order)
-  // share block cache lookup and use full filter multiget on the partition
-  // filter.
-  for (auto iter = start_iter_same_handle; iter != range->end(); ++iter) {
+  // Find the partition of each key. Keys mapping to the same partition are
+  // adjacent in sorted order.
+  autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE> partition_handles;
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> key_partitions;
+  for (auto iter = range->begin(); iter != range->end(); ++iter) {
     // TODO: re-use one top-level index iterator
     BlockHandle this_filter_handle =
         GetFilterPartitionHandle(filter_block, iter->ikey);
-    if (!prev_filter_handle.IsNull() &&
-        this_filter_handle != prev_filter_handle) {
-      MultiGetRange subrange(*range, start_iter_same_handle, iter);
-      MayMatchPartition(&subrange, prefix_extractor, block_offset,
-                        prev_filter_handle, no_io, lookup_context,
-                        filter_function);
-      range->AddSkipsFrom(subrange);
-      start_iter_same_handle = iter;
-    }
     if (UNLIKELY(this_filter_handle.size() == 0)) {  // key is out of range
       // Not reachable with current behavior of GetFilterPartitionHandle
       assert(false);
       range->SkipKey(iter);
-      prev_filter_handle = BlockHandle::NullBlockHandle();
-    } else {
-      prev_filter_handle = this_filter_handle;
+      continue;
     }
+    if (partition_handles.empty() ||
+        this_filter_handle != partition_handles.back()) {
+      partition_handles.push_back(this_filter_handle);
+    }
+    key_partitions.push_back(partition_handles.size() - 1);
+  }
+  if (partition_handles.empty()) {
+    return;
   }
-  if (!prev_filter_handle.IsNull()) {
-    MultiGetRange subrange(*range, start_iter_same_handle, range->end());
-    MayMatchPartition(&subrange, prefix_extractor, block_offset,
-                      prev_filter_handle, no_io, lookup_context,
-                      filter_function);
-    range->AddSkipsFrom(subrange);
+
+  // Load all the partitions before probing any, so that the ones not in the
+  // block cache are read together
+  autovector<CachableEntry<ParsedFullFilterBlock>,
+             MultiGetContext::MAX_BATCH_SIZE>
+      partitions;
+  autovector<Status, MultiGetContext::MAX_BATCH_SIZE> statuses;
+  partitions.resize(partition_handles.size());
+  statuses.resize(partition_handles.size());
+  GetFilterPartitionBlocks(partition_handles, no_io,
+                           range->begin()->get_context, lookup_context,
+                           &partitions, &statuses);
+
+  // For all keys mapping to same partition, use full filter multiget on the
+  // partition filter
+  auto start_iter_same_partition = range->begin();
+  size_t key_idx = 0;
+  for (auto iter = range->begin(); iter != range->end(); ++key_idx) {
+    auto next_iter = iter;
+    ++next_iter;
+    assert(key_idx < key_partitions.size());
+    const size_t partition = key_partitions[key_idx];
+    if (key_idx + 1 == key_partitions.size() ||
+        key_partitions[key_idx + 1] != partition) {
+      MultiGetRange subrange(*range, start_iter_same_partition, next_iter);
+      if (LIKELY(statuses[partition].ok())) {
+        MayMatchPartition(&subrange, prefix_extractor, block_offset,
+                          std::move(partitions[partition]), no_io,
+                          lookup_context, filter_function);
+      } else {
+        IGNORE_STATUS_IF_ERROR(statuses[partition]);
+        // Any/all may match
+      }
+      range->AddSkipsFrom(subrange);
+      start_iter_same_partition = next_iter;
+    }
+    iter = next_iter;
   }
 }
 
 void PartitionedFilterBlockReader::MayMatchPartition(
     MultiGetRange* range, const SliceTransform* prefix_extractor,
-    uint64_t block_offset, BlockHandle filter_handle, bool no_io,
+    uint64_t block_offset,
+    CachableEntry<ParsedFullFilterBlock>&& filter_partition_block, bool no_io,
     BlockCacheLookupContext* lookup_context,
     FilterManyFunction filter_function) const {
-  CachableEntry<ParsedFullFilterBlock> filter_partition_block;
-  Status s = GetFilterPartitionBlock(
-      nullptr /* prefetch_buffer */, filter_handle, no_io,
-      range->begin()->get_context, lookup_context, &filter_partition_block);
-  if (UNLIKELY(!s.ok())) {
-    IGNORE_STATUS_IF_ERROR(s);
-    return;  // Any/all may match
-  }
-
   FullFilterBlockReader filter_partition(table(),
                                          std::move(filter_partition_block));
   (filter_partition.*filter_function)(range, prefix_extractor, block_offset,
                                       no_io, lookup_context);
 }
 
+void PartitionedFilterBlockReader::GetFilterPartitionBlocks(
+    const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>& handles,
+    bool no_io, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context,
+    autovector<CachableEntry<ParsedFullFilterBlock>,
+               MultiGetContext::MAX_BATCH_SIZE>* filter_blocks,
+    autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses) const {
+  assert(table());
+  assert(filter_blocks->size() == handles.size());
+  assert(statuses->size() == handles.size());
+
+  // With more than one partition, look them all up without I/O first, then
+  // read the ones missing with a single MultiRead. With mmap reads, reading
+  // them one by one costs no extra I/O.
+  const bool read_together = !no_io && handles.size() > 1 &&
+                             !table()->get_rep()->ioptions.allow_mmap_reads;
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> to_read;
+  for (size_t i = 0; i < handles.size(); ++i) {
+    (*statuses)[i] = GetFilterPartitionBlock(
+        nullptr /* prefetch_buffer */, handles[i], no_io || read_together,
+        get_context, lookup_context, &(*filter_blocks)[i]);
+    if (read_together && (*statuses)[i].IsIncomplete()) {
+      to_read.push_back(i);
+    }
+  }
+  if (!to_read.empty()) {
+    ReadFilterPartitions(handles, to_read, get_context, filter_blocks,
+                         statuses);
+  }
+}
+
+void PartitionedFilterBlockReader::ReadFilterPartitions(
+    const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>& handles,
+    const autovector<size_t, MultiGetContext::MAX_BATCH_SIZE>& to_read,
+    GetContext* get_context,
+    autovector<CachableEntry<ParsedFullFilterBlock>,
+               MultiGetContext::MAX_BATCH_SIZE>* filter_blocks,
+    autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses) const {
+  const BlockBasedTable::Rep* const rep = table()->get_rep();
+  assert(rep);
+  RandomAccessFileReader* const file = rep->file.get();
+
+  // Partitions adjacent in the file (the handles are in file order) are
+  // read with one request
+  autovector<FSReadRequest, MultiGetContext::MAX_BATCH_SIZE> read_reqs;
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_idx_for_block;
+  size_t total_len = 0;
+  for (size_t i : to_read) {
+    const BlockHandle& handle = handles[i];
+    if (!read_reqs.empty() &&
+        read_reqs.back().offset + read_reqs.back().len == handle.offset()) {
+      read_reqs.back().len += block_size(handle);
+    } else {
+      FSReadRequest req;
+      req.offset = handle.offset();
+      req.len = block_size(handle);
+      req.scratch = nullptr;
+      read_reqs.emplace_back(req);
+    }
+    req_idx_for_block.emplace_back(read_reqs.size() - 1);
+    total_len += block_size(handle);
+  }
+  size_t num_blocks = to_read.size();
+  TEST_SYNC_POINT_CALLBACK(
+      "PartitionedFilterBlockReader::ReadFilterPartitions:NumBlocks",
+      &num_blocks);
+
+  // In direct IO mode, the requests share the direct IO buffer. Otherwise,
+  // they share the scratch buffer.
+  std::unique_ptr<char[]> scratch;
+  if (!file->use_direct_io()) {
+    scratch.reset(new char[total_len]);
+    size_t buf_offset = 0;
+    for (FSReadRequest& req : read_reqs) {
+      req.scratch = scratch.get() + buf_offset;
+      buf_offset += req.len;
+    }
+  }
+
+  ReadOptions read_options;
+  AlignedBuf direct_io_buf;
+  {
+    IOOptions opts;
+    IOStatus io_s = file->PrepareIOOptions(read_options, opts);
+    if (io_s.ok()) {
+      io_s = file->MultiRead(opts, &read_reqs[0], read_reqs.size(),
+                             &direct_io_buf);
+    }
+    if (!io_s.ok()) {
+      for (FSReadRequest& req : read_reqs) {
+        req.status = io_s;
+      }
+    }
+  }
+
+  Cache* const block_cache = rep->table_options.block_cache.get();
+  for (size_t j = 0; j < to_read.size(); ++j) {
+    const size_t i = to_read[j];
+    const BlockHandle& handle = handles[i];
+    const FSReadRequest& req = read_reqs[req_idx_for_block[j]];
+    const size_t req_offset = static_cast<size_t>(handle.offset() - req.offset);
+    if (get_context) {
+      ++get_context->get_context_stats_.num_filter_read;
+    }
+
+    Status s = req.status;
+    if (s.ok() && req.result.size() != req.len) {
+      s = Status::Corruption(
+          "truncated block read from " + file->file_name() + " offset " +
+          ROCKSDB_NAMESPACE::ToString(handle.offset()) + ", expected " +
+          ROCKSDB_NAMESPACE::ToString(req.len) + " bytes, got " +
+          ROCKSDB_NAMESPACE::ToString(req.result.size()));
+    }
+    const char* const data = req.result.data() + req_offset;
+    if (s.ok() && read_options.verify_checksums) {
+      PERF_TIMER_GUARD(block_checksum_time);
+      s = VerifyBlockChecksum(rep->footer.checksum(), data, handle.size(),
+                              file->file_name(), handle.offset());
+    }
+    if (!s.ok()) {
+      (*statuses)[i] = s;
+      continue;
+    }
+
+    // Copy the partition out of the shared buffer, with its trailer
+    CacheAllocationPtr buf = AllocateBlock(
+        block_size(handle), GetMemoryAllocator(rep->table_options));
+    memcpy(buf.get(), data, block_size(handle));
+    BlockContents contents(std::move(buf), handle.size());
+#ifndef NDEBUG
+    contents.is_raw_block = true;
+#endif
+
+    CachableEntry<ParsedFullFilterBlock>* filter_block = &(*filter_blocks)[i];
+    if (block_cache != nullptr) {
+      // Since the raw contents are passed, this inserts them into the block
+      // cache without looking it up again. The lookup was already traced.
+      s = table()->MaybeReadBlockAndLoadToCache(
+          nullptr /* prefetch_buffer */, read_options, handle,
+          UncompressionDict::GetEmptyDict(), /* wait */ true, filter_block,
+          BlockType::kFilter, get_context, nullptr /* lookup_context */,
+          &contents);
+    } else {
+      filter_block->SetOwnedValue(new ParsedFullFilterBlock(
+          rep->table_options.filter_policy.get(), std::move(contents)));
+    }
+    (*statuses)[i] = s;
+  }
+}
+
 size_t PartitionedFilterBlockReader::ApproximateMemoryUsage() const {
   size_t usage = ApproximateFilterBlockMemoryUsage();
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
@@ -425,8 +596,8 @@ size_t PartitionedFilterBlockReader::ApproximateMemoryUsage() const {
 }
 
 // TODO(myabandeh): merge this with the same function in IndexReader
-Status PartitionedFilterBlockReader::CacheDependencies(const ReadOptions& ro,
-                                                       bool pin) {
+Status PartitionedFilterBlockReader::CacheDependencies(
+    const ReadOptions& ro, bool pin, FilePrefetchBuffer* tail_prefetch_buffer) {
   assert(table());
 
   const BlockBasedTable::Rep* const rep = table()->get_rep();
@@ -468,16 +639,11 @@ Status PartitionedFilterBlockReader::CacheDependencies(const ReadOptions& ro,
   handle = biter.value().handle;
   uint64_t last_off = handle.offset() + handle.size() + kBlockTrailerSize;
   uint64_t prefetch_len = last_off - prefetch_off;
-  std::unique_ptr<FilePrefetchBuffer> prefetch_buffer;
-  rep->CreateFilePrefetchBuffer(0, 0, &prefetch_buffer,
-                                false /* Implicit autoreadahead */);
-
-  IOOptions opts;
-  s = rep->file->PrepareIOOptions(ro, opts);
-  if (s.ok()) {
-    s = prefetch_buffer->Prefetch(opts, rep->file.get(), prefetch_off,
-                                  static_cast<size_t>(prefetch_len));
-  }
+  std::unique_ptr<FilePrefetchBuffer> own_prefetch_buffer;
+  FilePrefetchBuffer* prefetch_buffer = nullptr;
+  s = table()->PrefetchPartitions(ro, prefetch_off, prefetch_len,
+                                  tail_prefetch_buffer, &own_prefetch_buffer,
+                                  &prefetch_buffer);
   if (!s.ok()) {
     return s;
   }
@@ -490,7 +656,7 @@ Status PartitionedFilterBlockReader::CacheDependencies(const ReadOptions& ro,
     // TODO: Support counter batch update for partitioned index and
     // filter blocks
     s = table()->MaybeReadBlockAndLoadToCache(
-        prefetch_buffer.get(), ro, handle, UncompressionDict::GetEmptyDict(),
+        prefetch_buffer, ro, handle, UncompressionDict::GetEmptyDict(),
         /* wait */ true, &block, BlockType::kFilter, nullptr /* get_context */,
         &lookup_context, nullptr /* contents */);
     if (!s.ok()) {
@@ -130,12 +130,31 @@ class PartitionedFilterBlockReader : public FilterBlockReaderCommon<Block> {
                 uint64_t block_offset, bool no_io,
                 BlockCacheLookupContext* lookup_context,
                 FilterManyFunction filter_function) const;
-  void MayMatchPartition(MultiGetRange* range,
-                         const SliceTransform* prefix_extractor,
-                         uint64_t block_offset, BlockHandle filter_handle,
-                         bool no_io, BlockCacheLookupContext* lookup_context,
-                         FilterManyFunction filter_function) const;
-  Status CacheDependencies(const ReadOptions& ro, bool pin) override;
+  void MayMatchPartition(
+      MultiGetRange* range, const SliceTransform* prefix_extractor,
+      uint64_t block_offset,
+      CachableEntry<ParsedFullFilterBlock>&& filter_partition_block,
+      bool no_io, BlockCacheLookupContext* lookup_context,
+      FilterManyFunction filter_function) const;
+  // Loads the partitions at `handles`, in file order, from the pinned
+  // partitions or the block cache, reading all those missing with one
+  // MultiRead (adjacent partitions coalesced into one request).
+  void GetFilterPartitionBlocks(
+      const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>& handles,
+      bool no_io, GetContext* get_context,
+      BlockCacheLookupContext* lookup_context,
+      autovector<CachableEntry<ParsedFullFilterBlock>,
+                 MultiGetContext::MAX_BATCH_SIZE>* filter_blocks,
+      autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses) const;
+  void ReadFilterPartitions(
+      const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>& handles,
+      const autovector<size_t, MultiGetContext::MAX_BATCH_SIZE>& to_read,
+      GetContext* get_context,
+      autovector<CachableEntry<ParsedFullFilterBlock>,
+                 MultiGetContext::MAX_BATCH_SIZE>* filter_blocks,
+      autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses) const;
+  Status CacheDependencies(const ReadOptions& ro, bool pin,
+                           FilePrefetchBuffer* tail_prefetch_buffer) override;
 
   const InternalKeyComparator* internal_comparator() const;
   bool index_key_includes_seq() const;
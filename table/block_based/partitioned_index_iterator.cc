@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based/partitioned_index_iterator.h"
 
+#include "test_util/sync_point.h"
+
 namespace ROCKSDB_NAMESPACE {
 void PartitionedIndexIterator::Seek(const Slice& target) { SeekImpl(&target); }
 
@@ -91,7 +93,8 @@ void PartitionedIndexIterator::InitPartitionedIndexBlock() {
     //   Enabled from the very first IO when ReadOptions.readahead_size is set.
     block_prefetcher_.PrefetchIfNeeded(rep, partitioned_index_handle,
                                        read_options_.readahead_size,
-                                       is_for_compaction);
+                                       is_for_compaction,
+                                       read_options_.async_io);
 
     Status s;
     table_->NewDataBlockIterator<IndexBlockIter>(
@@ -132,6 +135,18 @@ void PartitionedIndexIterator::FindBlockForward() {
       return;
     }
     ResetPartitionedIndexIter();
+    // The entries of the next partitions are past the key of this one. When
+    // that key reaches the upper bound, end the iteration here rather than
+    // read a partition of no use. The table iterator then takes its current
+    // data block as the last one, and the next file of the level is checked
+    // against the bound.
+    if (read_options_.iterate_upper_bound != nullptr &&
+        user_comparator_.CompareWithoutTimestamp(
+            *read_options_.iterate_upper_bound, /*a_has_ts=*/false,
+            index_iter_->user_key(), /*b_has_ts=*/true) <= 0) {
+      TEST_SYNC_POINT("PartitionedIndexIterator:out_of_bound");
+      return;
+    }
     index_iter_->Next();
 
     if (!index_iter_->Valid()) {
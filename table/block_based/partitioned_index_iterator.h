@@ -15,9 +15,10 @@
 
 namespace ROCKSDB_NAMESPACE {
 // Iterator that iterates over partitioned index.
-// Some upper and lower bound tricks played in block based table iterators
-// could be played here, but it's too complicated to reason about index
-// keys with upper or lower bound, so we skip it for simplicity.
+// Only the forward iteration stops at iterate_upper_bound, before reading a
+// partition past it. Other upper and lower bound tricks played in block based
+// table iterators could be played here, but it's too complicated to reason
+// about index keys with upper or lower bound, so we skip it for simplicity.
 class PartitionedIndexIterator : public InternalIteratorBase<IndexValue> {
   // compaction_readahead_size: its value will only be used if for_compaction =
   // true
@@ -0,0 +1,82 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/range_filter_block.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ROCKSDB_NAMESPACE {
+
+RangeFilterBlockBuilder::RangeFilterBlockBuilder(size_t prefix_len)
+    : prefix_len_(std::min(prefix_len, size_t{255})) {
+  assert(prefix_len_ > 0);
+}
+
+void RangeFilterBlockBuilder::Add(const Slice& user_key) {
+  Slice prefix(user_key.data(), std::min(user_key.size(), prefix_len_));
+  if (num_entries_ > 0) {
+    assert(prefix.compare(last_prefix_) >= 0);
+    if (prefix == last_prefix_) {
+      return;
+    }
+  }
+  last_prefix_.assign(prefix.data(), prefix.size());
+  buffer_.push_back(static_cast<char>(prefix.size()));
+  buffer_.append(prefix.data(), prefix.size());
+  buffer_.append(prefix_len_ - prefix.size(), '\0');
+  ++num_entries_;
+}
+
+Slice RangeFilterBlockBuilder::Finish() {
+  buffer_.push_back(static_cast<char>(prefix_len_));
+  return buffer_;
+}
+
+std::unique_ptr<RangeFilterBlockReader> RangeFilterBlockReader::Create(
+    BlockContents&& contents) {
+  const Slice& data = contents.data;
+  if (data.empty()) {
+    return nullptr;
+  }
+  size_t prefix_len = static_cast<uint8_t>(data[data.size() - 1]);
+  if (prefix_len == 0 || (data.size() - 1) % (prefix_len + 1) != 0) {
+    return nullptr;
+  }
+  size_t num_entries = (data.size() - 1) / (prefix_len + 1);
+  for (size_t i = 0; i < num_entries; ++i) {
+    if (static_cast<uint8_t>(data[i * (prefix_len + 1)]) > prefix_len) {
+      return nullptr;
+    }
+  }
+  return std::unique_ptr<RangeFilterBlockReader>(new RangeFilterBlockReader(
+      std::move(contents), prefix_len, num_entries));
+}
+
+bool RangeFilterBlockReader::RangeMayMatch(const Slice& start,
+                                           const Slice* upper_bound) const {
+  Slice start_prefix(start.data(), std::min(start.size(), prefix_len_));
+  // Find the first entry >= start_prefix
+  size_t left = 0;
+  size_t right = num_entries_;
+  while (left < right) {
+    size_t mid = left + (right - left) / 2;
+    if (Entry(mid).compare(start_prefix) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  if (left == num_entries_) {
+    return false;
+  }
+  return upper_bound == nullptr || Entry(left).compare(*upper_bound) < 0;
+}
+
+size_t RangeFilterBlockReader::ApproximateMemoryUsage() const {
+  return contents_.ApproximateMemoryUsage() + sizeof(*this);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
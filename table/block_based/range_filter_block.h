@@ -0,0 +1,89 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/slice.h"
+#include "table/format.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A range filter answers whether a table file might have any user key in
+// a range [start, upper_bound), so that bounded scans can skip files that
+// have none. It is stored as a meta block holding the distinct prefixes of
+// a fixed length (prefix_len bytes, or the whole key if shorter) of the
+// user keys in the file, in order, like a trie of the keys truncated to
+// that depth.
+//
+// Since truncation preserves bytewise order, a key k in [start, upper_bound)
+// has a prefix p = truncate(k) with truncate(start) <= p < upper_bound, so
+// the filter has no false negatives. False positives come from keys that
+// share a prefix with the range without being in it; longer prefixes mean
+// fewer false positives and a bigger filter. Only valid for user keys in
+// bytewise order without timestamps.
+//
+// Format of the block, searched with a binary search in place:
+//   [entry 0] ... [entry N-1] [prefix_len: uint8]
+// where each entry is prefix_len + 1 bytes: the length of the prefix
+// (uint8), then the prefix, zero padded to prefix_len bytes.
+class RangeFilterBlockBuilder {
+ public:
+  explicit RangeFilterBlockBuilder(size_t prefix_len);
+  // No copying allowed
+  RangeFilterBlockBuilder(const RangeFilterBlockBuilder&) = delete;
+  void operator=(const RangeFilterBlockBuilder&) = delete;
+
+  // REQUIRES: user_key is >= all keys added before, in bytewise order
+  void Add(const Slice& user_key);
+
+  bool empty() const { return num_entries_ == 0; }
+
+  // Returns the contents of the block. The returned slice remains valid
+  // for the lifetime of this builder.
+  Slice Finish();
+
+ private:
+  const size_t prefix_len_;
+  std::string buffer_;
+  std::string last_prefix_;
+  size_t num_entries_ = 0;
+};
+
+class RangeFilterBlockReader {
+ public:
+  // Returns nullptr if contents is not a valid range filter block
+  static std::unique_ptr<RangeFilterBlockReader> Create(
+      BlockContents&& contents);
+
+  // Returns false only if the table has no user key k with start <= k and,
+  // if upper_bound is not null, k < *upper_bound
+  bool RangeMayMatch(const Slice& start, const Slice* upper_bound) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  RangeFilterBlockReader(BlockContents&& contents, size_t prefix_len,
+                         size_t num_entries)
+      : contents_(std::move(contents)),
+        prefix_len_(prefix_len),
+        num_entries_(num_entries) {}
+
+  // Returns the prefix of entry i
+  Slice Entry(size_t i) const {
+    const char* entry = contents_.data.data() + i * (prefix_len_ + 1);
+    return Slice(entry + 1, static_cast<uint8_t>(entry[0]));
+  }
+
+  BlockContents contents_;
+  const size_t prefix_len_;
+  const size_t num_entries_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
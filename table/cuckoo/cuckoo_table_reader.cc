@@ -143,61 +143,119 @@ CuckooTableReader::CuckooTableReader(
                         &file_data_, nullptr, nullptr);
 }
 
+uint64_t CuckooTableReader::CuckooBlockOffset(const Slice& user_key,
+                                              uint32_t hash_cnt) const {
+  return bucket_length_ * CuckooHash(user_key, hash_cnt, use_module_hash_,
+                                     table_size_, identity_as_first_hash_,
+                                     get_slice_hash_);
+}
+
+void CuckooTableReader::PrefetchCuckooBlock(uint64_t offset) const {
+  uint64_t addr = reinterpret_cast<uint64_t>(file_data_.data()) + offset;
+  uint64_t end_addr = addr + cuckoo_block_bytes_minus_one_;
+  for (addr &= CACHE_LINE_MASK; addr < end_addr; addr += CACHE_LINE_SIZE) {
+    PREFETCH(reinterpret_cast<const char*>(addr), 0, 3);
+  }
+}
+
+bool CuckooTableReader::SearchCuckooBlock(const Slice& user_key,
+                                          uint64_t offset,
+                                          GetContext* get_context,
+                                          Status* s) const {
+  const char* bucket = &file_data_.data()[offset];
+  for (uint32_t block_idx = 0; block_idx < cuckoo_block_size_;
+       ++block_idx, bucket += bucket_length_) {
+    if (ucomp_->Equal(Slice(unused_key_.data(), user_key.size()),
+                      Slice(bucket, user_key.size()))) {
+      return true;
+    }
+    // Here, we compare only the user key part as we support only one entry
+    // per user key and we don't support snapshot.
+    if (ucomp_->Equal(user_key, Slice(bucket, user_key.size()))) {
+      Slice value(bucket + key_length_, value_length_);
+      if (is_last_level_) {
+        // Sequence number is not stored at the last level, so we will use
+        // kMaxSequenceNumber since it is unknown.  This could cause some
+        // transactions to fail to lock a key due to known sequence number.
+        // However, it is expected for anyone to use a CuckooTable in a
+        // TransactionDB.
+        get_context->SaveValue(value, kMaxSequenceNumber);
+      } else {
+        Slice full_key(bucket, key_length_);
+        ParsedInternalKey found_ikey;
+        *s = ParseInternalKey(full_key, &found_ikey,
+                              false /* log_err_key */);  // TODO
+        if (!s->ok()) {
+          return true;
+        }
+        bool dont_care __attribute__((__unused__));
+        get_context->SaveValue(found_ikey, value, &dont_care);
+      }
+      // We don't support merge operations. So, we return here.
+      return true;
+    }
+  }
+  return false;
+}
+
 Status CuckooTableReader::Get(const ReadOptions& /*readOptions*/,
                               const Slice& key, GetContext* get_context,
                               const SliceTransform* /* prefix_extractor */,
                               bool /*skip_filters*/) {
   assert(key.size() == key_length_ + (is_last_level_ ? 8 : 0));
   Slice user_key = ExtractUserKey(key);
+  Status s;
   for (uint32_t hash_cnt = 0; hash_cnt < num_hash_func_; ++hash_cnt) {
-    uint64_t offset = bucket_length_ * CuckooHash(
-        user_key, hash_cnt, use_module_hash_, table_size_,
-        identity_as_first_hash_, get_slice_hash_);
-    const char* bucket = &file_data_.data()[offset];
-    for (uint32_t block_idx = 0; block_idx < cuckoo_block_size_;
-         ++block_idx, bucket += bucket_length_) {
-      if (ucomp_->Equal(Slice(unused_key_.data(), user_key.size()),
-                        Slice(bucket, user_key.size()))) {
-        return Status::OK();
-      }
-      // Here, we compare only the user key part as we support only one entry
-      // per user key and we don't support snapshot.
-      if (ucomp_->Equal(user_key, Slice(bucket, user_key.size()))) {
-        Slice value(bucket + key_length_, value_length_);
-        if (is_last_level_) {
-          // Sequence number is not stored at the last level, so we will use
-          // kMaxSequenceNumber since it is unknown.  This could cause some
-          // transactions to fail to lock a key due to known sequence number.
-          // However, it is expected for anyone to use a CuckooTable in a
-          // TransactionDB.
-          get_context->SaveValue(value, kMaxSequenceNumber);
-        } else {
-          Slice full_key(bucket, key_length_);
-          ParsedInternalKey found_ikey;
-          Status s = ParseInternalKey(full_key, &found_ikey,
-                                      false /* log_err_key */);  // TODO
-          if (!s.ok()) return s;
-          bool dont_care __attribute__((__unused__));
-          get_context->SaveValue(found_ikey, value, &dont_care);
-        }
-        // We don't support merge operations. So, we return here.
-        return Status::OK();
+    if (SearchCuckooBlock(user_key, CuckooBlockOffset(user_key, hash_cnt),
+                          get_context, &s)) {
+      break;
+    }
+  }
+  return s;
+}
+
+void CuckooTableReader::MultiGet(const ReadOptions& /*readOptions*/,
+                                 const MultiGetContext::Range* mget_range,
+                                 const SliceTransform* /*prefix_extractor*/,
+                                 bool /*skip_filters*/) {
+  struct PendingKey {
+    Slice user_key;
+    GetContext* get_context;
+    Status* s;
+    uint64_t offset;
+  };
+  PendingKey pending[MultiGetContext::MAX_BATCH_SIZE];
+  size_t num_pending = 0;
+  for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+    assert(iter->ikey.size() == key_length_ + (is_last_level_ ? 8 : 0));
+    *iter->s = Status::OK();
+    pending[num_pending++] = {ExtractUserKey(iter->ikey), iter->get_context,
+                              iter->s, 0};
+  }
+  for (uint32_t hash_cnt = 0; hash_cnt < num_hash_func_ && num_pending > 0;
+       ++hash_cnt) {
+    for (size_t i = 0; i < num_pending; ++i) {
+      pending[i].offset = CuckooBlockOffset(pending[i].user_key, hash_cnt);
+      PrefetchCuckooBlock(pending[i].offset);
+    }
+    // Keeps the keys whose lookup is not over for the next hash function
+    size_t num_left = 0;
+    for (size_t i = 0; i < num_pending; ++i) {
+      if (!SearchCuckooBlock(pending[i].user_key, pending[i].offset,
+                             pending[i].get_context, pending[i].s)) {
+        pending[num_left++] = pending[i];
       }
     }
+    num_pending = num_left;
   }
-  return Status::OK();
 }
 
 void CuckooTableReader::Prepare(const Slice& key) {
   // Prefetch the first Cuckoo Block.
   Slice user_key = ExtractUserKey(key);
-  uint64_t addr = reinterpret_cast<uint64_t>(file_data_.data()) +
-    bucket_length_ * CuckooHash(user_key, 0, use_module_hash_, table_size_,
-                                identity_as_first_hash_, nullptr);
-  uint64_t end_addr = addr + cuckoo_block_bytes_minus_one_;
-  for (addr &= CACHE_LINE_MASK; addr < end_addr; addr += CACHE_LINE_SIZE) {
-    PREFETCH(reinterpret_cast<const char*>(addr), 0, 3);
-  }
+  PrefetchCuckooBlock(bucket_length_ *
+                      CuckooHash(user_key, 0, use_module_hash_, table_size_,
+                                 identity_as_first_hash_, nullptr));
 }
 
 class CuckooTableIterator : public InternalIterator {
@@ -45,6 +45,14 @@ class CuckooTableReader: public TableReader {
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // Looks up the keys of the batch together, one hash function at a time:
+  // the cuckoo blocks of all the keys still being looked up are prefetched
+  // before any of them is searched, so that their cache misses overlap.
+  void MultiGet(const ReadOptions& readOptions,
+                const MultiGetContext::Range* mget_range,
+                const SliceTransform* prefix_extractor,
+                bool skip_filters = false) override;
+
   // Returns a new iterator over table contents
   // compaction_readahead_size: its value will only be used if for_compaction =
   // true
@@ -76,6 +84,16 @@ class CuckooTableReader: public TableReader {
  private:
   friend class CuckooTableIterator;
   void LoadAllKeys(std::vector<std::pair<Slice, uint32_t>>* key_to_bucket_id);
+  // The offset in the file of the cuckoo block of `user_key` for hash
+  // function `hash_cnt`
+  uint64_t CuckooBlockOffset(const Slice& user_key, uint32_t hash_cnt) const;
+  void PrefetchCuckooBlock(uint64_t offset) const;
+  // Searches the cuckoo block at `offset` for `user_key`, saving its value to
+  // `get_context` if found. Returns true if the lookup is over: the key was
+  // found, an empty bucket shows that it is not in the table, or an error is
+  // returned in `*s`.
+  bool SearchCuckooBlock(const Slice& user_key, uint64_t offset,
+                         GetContext* get_context, Status* s) const;
   std::unique_ptr<RandomAccessFileReader> file_;
   Slice file_data_;
   bool is_last_level_;
@@ -13,6 +13,7 @@ int main() {
 }
 #else
 
+#include <algorithm>
 #include <cinttypes>
 #include <map>
 #include <string>
@@ -123,6 +124,44 @@ class CuckooReaderTest : public testing::Test {
           reader.Get(ReadOptions(), Slice(keys[i]), &get_context, nullptr));
       ASSERT_STREQ(values[i].c_str(), value.data());
     }
+    CheckMultiGet(&reader, ucomp);
+  }
+
+  // Looks up all the keys with MultiGet(), in batches
+  void CheckMultiGet(CuckooTableReader* reader, const Comparator* ucomp) {
+    for (uint32_t begin = 0; begin < num_items;
+         begin += MultiGetContext::MAX_BATCH_SIZE) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(num_items),
+          begin + static_cast<uint32_t>(MultiGetContext::MAX_BATCH_SIZE));
+      std::vector<Slice> batch_keys(user_keys.begin() + begin,
+                                    user_keys.begin() + end);
+      std::vector<PinnableSlice> batch_values(end - begin);
+      std::vector<Status> statuses(end - begin);
+      autovector<GetContext, MultiGetContext::MAX_BATCH_SIZE> get_contexts;
+      autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_contexts;
+      autovector<KeyContext*, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
+      for (size_t i = 0; i < batch_keys.size(); ++i) {
+        get_contexts.emplace_back(ucomp, nullptr, nullptr, nullptr,
+                                  GetContext::kNotFound, batch_keys[i],
+                                  &batch_values[i], nullptr, nullptr, true,
+                                  nullptr, nullptr);
+        key_contexts.emplace_back(nullptr, batch_keys[i], &batch_values[i],
+                                  nullptr, &statuses[i]);
+        key_contexts.back().get_context = &get_contexts.back();
+      }
+      for (auto& key_context : key_contexts) {
+        sorted_keys.emplace_back(&key_context);
+      }
+      MultiGetContext ctx(&sorted_keys, 0, sorted_keys.size(), 0,
+                          ReadOptions());
+      MultiGetContext::Range range = ctx.GetMultiGetRange();
+      reader->MultiGet(ReadOptions(), &range, nullptr);
+      for (uint32_t i = begin; i < end; ++i) {
+        ASSERT_OK(statuses[i - begin]);
+        ASSERT_EQ(values[i], batch_values[i - begin].ToString());
+      }
+    }
   }
   void UpdateKeys(bool with_zero_seqno) {
     for (uint32_t i = 0; i < num_items; i++) {
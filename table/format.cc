@@ -25,6 +25,7 @@
 #include "util/coding.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
+#include "util/hash.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 
@@ -43,6 +44,14 @@ const uint64_t kPlainTableMagicNumber = 0;
 #endif
 const char* kHostnameForDbHostId = "__hostname__";
 
+uint32_t ComputeXXH3Checksum(const char* data, size_t size, char last_byte) {
+  // XXH3 is fastest on contiguous input and its streaming state is large, so
+  // the last byte is mixed into the hash of the rest instead.
+  constexpr uint32_t kRandomPrime = 0x6b9083d9;
+  return Lower32of64(Hash64(data, size)) ^
+         (static_cast<uint8_t>(last_byte) * kRandomPrime);
+}
+
 bool ShouldReportDetailedTime(Env* env, Statistics* stats) {
   return env != nullptr && stats != nullptr &&
          stats->get_stats_level() > kExceptDetailedTimers;
@@ -352,12 +361,20 @@ Status UncompressBlockContentsForCompressionType(
 
   assert(uncompression_info.type() != kNoCompression &&
          "Invalid compression type");
+  // The readers of blocks leave the compressor of kCustomCompression to the
+  // options of the column family
+  const UncompressionInfo info(uncompression_info.context(),
+                               uncompression_info.dict(),
+                               uncompression_info.type(),
+                               uncompression_info.compressor() != nullptr
+                                   ? uncompression_info.compressor()
+                                   : ioptions.compressor.get());
 
   StopWatchNano timer(ioptions.clock,
                       ShouldReportDetailedTime(ioptions.env, ioptions.stats));
   size_t uncompressed_size = 0;
   CacheAllocationPtr ubuf =
-      UncompressData(uncompression_info, data, n, &uncompressed_size,
+      UncompressData(info, data, n, &uncompressed_size,
                      GetCompressFormatForVersion(format_version), allocator);
   if (!ubuf) {
     return Status::Corruption(
@@ -225,6 +225,11 @@ inline CompressionType get_block_compression_type(const char* block_data,
   return static_cast<CompressionType>(block_data[block_size]);
 }
 
+// The kXXH3 checksum of `size` bytes of `data` followed by `last_byte` (the
+// block's compression type in its trailer)
+extern uint32_t ComputeXXH3Checksum(const char* data, size_t size,
+                                    char last_byte);
+
 // Represents the contents of a block read from an SST file. Depending on how
 // it's created, it may or may not own the actual block bytes. As an example,
 // BlockContents objects representing data read from mmapped files only point
@@ -12,6 +12,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/slice_transform.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/system_clock.h"
 
@@ -214,6 +215,10 @@ void GetContext::ReportCounters() {
     RecordTick(statistics_, BLOCK_CACHE_COMPRESSION_DICT_BYTES_INSERT,
                get_context_stats_.num_cache_compression_dict_bytes_insert);
   }
+  if (get_context_stats_.num_levels_read > 0) {
+    RecordInHistogram(statistics_, NUM_LEVELS_READ_PER_GET,
+                      get_context_stats_.num_levels_read);
+  }
 }
 
 bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
@@ -404,6 +409,25 @@ void GetContext::push_operand(const Slice& value, Cleanable* value_pinner) {
   }
 }
 
+bool GetContext::GetPrefix(const SliceTransform* prefix_extractor,
+                           const Slice& user_key_without_ts, Slice* prefix) {
+  assert(prefix_extractor != nullptr);
+  // The key of a lookup is the same buffer for every table file, so that
+  // comparing the pointers is enough
+  if (prefix_extractor != prefix_extractor_ ||
+      user_key_without_ts.data() != prefix_key_.data() ||
+      user_key_without_ts.size() != prefix_key_.size()) {
+    prefix_extractor_ = prefix_extractor;
+    prefix_key_ = user_key_without_ts;
+    prefix_in_domain_ = prefix_extractor->InDomain(user_key_without_ts);
+    if (prefix_in_domain_) {
+      prefix_ = prefix_extractor->Transform(user_key_without_ts);
+    }
+  }
+  *prefix = prefix_;
+  return prefix_in_domain_;
+}
+
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
                          GetContext* get_context, Cleanable* value_pinner) {
 #ifndef ROCKSDB_LITE
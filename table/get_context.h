@@ -17,6 +17,7 @@
 namespace ROCKSDB_NAMESPACE {
 class MergeContext;
 class PinnedIteratorsManager;
+class SliceTransform;
 class SystemClock;
 
 // Data structure for accumulating statistics during a point lookup. At the
@@ -54,6 +55,15 @@ struct GetContextStats {
   uint64_t num_index_read = 0;
   uint64_t num_data_read = 0;
   uint64_t num_sst_read = 0;
+  // Get stats.
+  uint64_t num_levels_read = 0;
+  // Full filter checks of Get by the kind of filter, and how many of them
+  // ruled out the key. Also reported by the BLOOM_FILTER_* tickers, so they
+  // are not reported by ReportCounters().
+  uint64_t num_whole_key_filter_checked = 0;
+  uint64_t num_whole_key_filter_useful = 0;
+  uint64_t num_prefix_filter_checked = 0;
+  uint64_t num_prefix_filter_useful = 0;
 };
 
 // A class to hold context about a point lookup, such as pointer to value
@@ -171,6 +181,14 @@ class GetContext {
 
   void push_operand(const Slice& value, Cleanable* value_pinner);
 
+  // Sets *prefix to the prefix of user_key_without_ts under prefix_extractor
+  // and returns true, or returns false if the key is not in the domain of
+  // prefix_extractor. The result for the last extractor and key is cached,
+  // so that checking the prefix filters of many table files for the key of
+  // a lookup extracts its prefix only once.
+  bool GetPrefix(const SliceTransform* prefix_extractor,
+                 const Slice& user_key_without_ts, Slice* prefix);
+
  private:
   void Merge(const Slice* value);
   bool GetBlobValue(const Slice& blob_index, PinnableSlice* blob_value);
@@ -206,6 +224,11 @@ class GetContext {
   // Get or a MultiGet.
   const uint64_t tracing_get_id_;
   BlobFetcher* blob_fetcher_;
+  // Cached result of GetPrefix()
+  const SliceTransform* prefix_extractor_ = nullptr;
+  Slice prefix_key_;
+  Slice prefix_;
+  bool prefix_in_domain_ = false;
 };
 
 // Call this to replay a log and bring the get_context up to date. The replay
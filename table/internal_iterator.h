@@ -30,6 +30,14 @@ struct IterateResult {
   bool value_prepared = true;
 };
 
+// The implicit readahead state of a table iterator, handed over to the
+// iterator of the next file of a level so that a scan keeps its readahead
+// going across files instead of starting over.
+struct ReadaheadFileInfo {
+  // The size of the next readahead, 0 if readahead has not started.
+  size_t readahead_size = 0;
+};
+
 template <class TValue>
 class InternalIteratorBase : public Cleanable {
  public:
@@ -172,6 +180,14 @@ class InternalIteratorBase : public Cleanable {
     return Status::NotSupported("");
   }
 
+  // Get the implicit readahead state of the file read, see ReadaheadFileInfo.
+  virtual void GetReadaheadState(ReadaheadFileInfo* /*readahead_info*/) {}
+
+  // Continue the implicit readahead of a previous file, see
+  // ReadaheadFileInfo. Called before the iterator is positioned.
+  virtual void SetReadaheadState(const ReadaheadFileInfo& /*readahead_info*/) {
+  }
+
  protected:
   void SeekForPrevImpl(const Slice& target, const Comparator* cmp) {
     Seek(target);
@@ -10,6 +10,7 @@
 #include "rocksdb/iterator.h"
 #include "memory/arena.h"
 #include "table/internal_iterator.h"
+#include "table/iterator_batch.h"
 #include "table/iterator_wrapper.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -106,6 +107,19 @@ Status Iterator::GetProperty(std::string prop_name, std::string* prop) {
   return Status::InvalidArgument("Unidentified property.");
 }
 
+Status Iterator::NextBatch(size_t max_entries, size_t max_bytes,
+                           std::vector<Slice>* keys, std::vector<Slice>* values,
+                           std::string* buf) {
+  assert(max_entries > 0);
+  IteratorBatchCollector batch(max_entries, max_bytes, keys, values, buf);
+  while (Valid() && !batch.Full()) {
+    batch.Add(key(), /*key_pinned=*/false, value(), /*value_pinned=*/false);
+    Next();
+  }
+  batch.Finish();
+  return status();
+}
+
 namespace {
 class EmptyIterator : public Iterator {
  public:
@@ -0,0 +1,78 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Collects the entries returned by one Iterator::NextBatch() call. Data the
+// iterator keeps pinned is referenced in place; everything else is copied
+// into the caller's buffer. Since the buffer may be reallocated while it
+// grows, copied entries are only pointed at it by Finish().
+class IteratorBatchCollector {
+ public:
+  IteratorBatchCollector(size_t max_entries, size_t max_bytes,
+                         std::vector<Slice>* keys, std::vector<Slice>* values,
+                         std::string* buf)
+      : max_entries_(max_entries),
+        max_bytes_(max_bytes),
+        keys_(keys),
+        values_(values),
+        buf_(buf) {
+    keys_->clear();
+    values_->clear();
+    buf_->clear();
+  }
+
+  bool Full() const {
+    return keys_->size() >= max_entries_ ||
+           (max_bytes_ > 0 && bytes_ >= max_bytes_);
+  }
+
+  void Add(const Slice& key, bool key_pinned, const Slice& value,
+           bool value_pinned) {
+    keys_->push_back(key_pinned ? key : Copy(key));
+    values_->push_back(value_pinned ? value : Copy(value));
+    bytes_ += key.size() + value.size();
+  }
+
+  void Finish() {
+    size_t offset = 0;
+    for (size_t i = 0; i < keys_->size(); ++i) {
+      Relocate(&(*keys_)[i], &offset);
+      Relocate(&(*values_)[i], &offset);
+    }
+    assert(offset == buf_->size());
+  }
+
+ private:
+  // Copied slices are marked by a null data pointer until Finish().
+  Slice Copy(const Slice& s) {
+    buf_->append(s.data(), s.size());
+    return Slice(nullptr, s.size());
+  }
+
+  void Relocate(Slice* s, size_t* offset) {
+    if (s->data() == nullptr) {
+      *s = Slice(buf_->data() + *offset, s->size());
+      *offset += s->size();
+    }
+  }
+
+  const size_t max_entries_;
+  const size_t max_bytes_;
+  std::vector<Slice>* const keys_;
+  std::vector<Slice>* const values_;
+  std::string* const buf_;
+  size_t bytes_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -97,7 +97,7 @@ class MergerTest : public testing::Test {
   }
 
   void Generate(size_t num_iterators, size_t strings_per_iterator,
-                int letters_per_string) {
+                int letters_per_string, bool use_loser_tree = false) {
     std::vector<InternalIterator*> small_iterators;
     for (size_t i = 0; i < num_iterators; ++i) {
       auto strings = GenerateStrings(strings_per_iterator, letters_per_string);
@@ -107,7 +107,9 @@ class MergerTest : public testing::Test {
 
     merging_iterator_.reset(
         NewMergingIterator(&icomp_, &small_iterators[0],
-                           static_cast<int>(small_iterators.size())));
+                           static_cast<int>(small_iterators.size()),
+                           /*arena=*/nullptr, /*prefix_seek_mode=*/false,
+                           use_loser_tree));
     single_iterator_.reset(new test::VectorIterator(all_keys_));
   }
 
@@ -172,6 +174,45 @@ TEST_F(MergerTest, SeekToLastTest) {
   }
 }
 
+TEST_F(MergerTest, LoserTreeSeekToFirstTest) {
+  Generate(1000, 50, 50, /*use_loser_tree=*/true);
+  for (int i = 0; i < 10; ++i) {
+    SeekToFirst();
+    AssertEquivalence();
+    Next(50000);
+  }
+}
+
+TEST_F(MergerTest, LoserTreeSeekToRandomNextSmallStringsTest) {
+  // Non-power-of-two child count, and many duplicate keys across children.
+  Generate(777, 50, 2, /*use_loser_tree=*/true);
+  for (int i = 0; i < 10; ++i) {
+    SeekToRandom();
+    AssertEquivalence();
+    Next(50000);
+  }
+}
+
+TEST_F(MergerTest, LoserTreeSeekToRandomRandomTest) {
+  Generate(200, 50, 50, /*use_loser_tree=*/true);
+  for (int i = 0; i < 3; ++i) {
+    SeekToRandom();
+    AssertEquivalence();
+    NextAndPrev(5000);
+  }
+}
+
+TEST_F(MergerTest, LoserTreeFewChildrenTest) {
+  for (size_t num_iterators : {2, 3, 5}) {
+    all_keys_.clear();
+    Generate(num_iterators, 20, 3, /*use_loser_tree=*/true);
+    SeekToFirst();
+    Next(1000);
+    SeekToLast();
+    NextAndPrev(1000);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
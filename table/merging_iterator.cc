@@ -23,6 +23,7 @@
 #include "test_util/sync_point.h"
 #include "util/autovector.h"
 #include "util/heap.h"
+#include "util/loser_tree.h"
 #include "util/stop_watch.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -30,6 +31,7 @@ namespace ROCKSDB_NAMESPACE {
 namespace {
 typedef BinaryHeap<IteratorWrapper*, MaxIteratorComparator> MergerMaxIterHeap;
 typedef BinaryHeap<IteratorWrapper*, MinIteratorComparator> MergerMinIterHeap;
+typedef LoserTree<IteratorWrapper*, MinIteratorComparator> MergerMinIterTree;
 }  // namespace
 
 const size_t kNumIterReserve = 4;
@@ -38,12 +40,14 @@ class MergingIterator : public InternalIterator {
  public:
   MergingIterator(const InternalKeyComparator* comparator,
                   InternalIterator** children, int n, bool is_arena_mode,
-                  bool prefix_seek_mode)
+                  bool prefix_seek_mode, bool use_loser_tree)
       : is_arena_mode_(is_arena_mode),
         comparator_(comparator),
         current_(nullptr),
         direction_(kForward),
         minHeap_(comparator_),
+        minTree_(comparator_),
+        use_loser_tree_(use_loser_tree),
         prefix_seek_mode_(prefix_seek_mode),
         pinned_iters_mgr_(nullptr) {
     children_.resize(n);
@@ -181,11 +185,19 @@ class MergingIterator : public InternalIterator {
       // replace_top() to restore the heap property.  When the same child
       // iterator yields a sequence of keys, this is cheap.
       assert(current_->status().ok());
-      minHeap_.replace_top(current_);
+      if (use_loser_tree_) {
+        minTree_.replace_top(current_);
+      } else {
+        minHeap_.replace_top(current_);
+      }
     } else {
       // current stopped being valid, remove it from the heap.
       considerStatus(current_->status());
-      minHeap_.pop();
+      if (use_loser_tree_) {
+        minTree_.pop();
+      } else {
+        minHeap_.pop();
+      }
     }
     current_ = CurrentForward();
   }
@@ -310,6 +322,9 @@ class MergingIterator : public InternalIterator {
   };
   Direction direction_;
   MergerMinIterHeap minHeap_;
+  // Replaces minHeap_ for forward iteration when use_loser_tree_ is set.
+  MergerMinIterTree minTree_;
+  const bool use_loser_tree_;
   bool prefix_seek_mode_;
 
   // Max heap is used for reverse iteration, which is way less common than
@@ -333,6 +348,9 @@ class MergingIterator : public InternalIterator {
 
   IteratorWrapper* CurrentForward() const {
     assert(direction_ == kForward);
+    if (use_loser_tree_) {
+      return !minTree_.empty() ? minTree_.top() : nullptr;
+    }
     return !minHeap_.empty() ? minHeap_.top() : nullptr;
   }
 
@@ -346,7 +364,11 @@ class MergingIterator : public InternalIterator {
 void MergingIterator::AddToMinHeapOrCheckStatus(IteratorWrapper* child) {
   if (child->Valid()) {
     assert(child->status().ok());
-    minHeap_.push(child);
+    if (use_loser_tree_) {
+      minTree_.push(child);
+    } else {
+      minHeap_.push(child);
+    }
   } else {
     considerStatus(child->status());
   }
@@ -407,6 +429,7 @@ void MergingIterator::SwitchToBackward() {
 
 void MergingIterator::ClearHeaps() {
   minHeap_.clear();
+  minTree_.clear();
   if (maxHeap_) {
     maxHeap_->clear();
   }
@@ -420,7 +443,8 @@ void MergingIterator::InitMaxHeap() {
 
 InternalIterator* NewMergingIterator(const InternalKeyComparator* cmp,
                                      InternalIterator** list, int n,
-                                     Arena* arena, bool prefix_seek_mode) {
+                                     Arena* arena, bool prefix_seek_mode,
+                                     bool use_loser_tree) {
   assert(n >= 0);
   if (n == 0) {
     return NewEmptyInternalIterator<Slice>(arena);
@@ -428,20 +452,23 @@ InternalIterator* NewMergingIterator(const InternalKeyComparator* cmp,
     return list[0];
   } else {
     if (arena == nullptr) {
-      return new MergingIterator(cmp, list, n, false, prefix_seek_mode);
+      return new MergingIterator(cmp, list, n, false, prefix_seek_mode,
+                                 use_loser_tree);
     } else {
       auto mem = arena->AllocateAligned(sizeof(MergingIterator));
-      return new (mem) MergingIterator(cmp, list, n, true, prefix_seek_mode);
+      return new (mem) MergingIterator(cmp, list, n, true, prefix_seek_mode,
+                                       use_loser_tree);
     }
   }
 }
 
 MergeIteratorBuilder::MergeIteratorBuilder(
-    const InternalKeyComparator* comparator, Arena* a, bool prefix_seek_mode)
+    const InternalKeyComparator* comparator, Arena* a, bool prefix_seek_mode,
+    bool use_loser_tree)
     : first_iter(nullptr), use_merging_iter(false), arena(a) {
   auto mem = arena->AllocateAligned(sizeof(MergingIterator));
-  merge_iter =
-      new (mem) MergingIterator(comparator, nullptr, 0, true, prefix_seek_mode);
+  merge_iter = new (mem) MergingIterator(comparator, nullptr, 0, true,
+                                         prefix_seek_mode, use_loser_tree);
 }
 
 MergeIteratorBuilder::~MergeIteratorBuilder() {
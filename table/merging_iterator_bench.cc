@@ -0,0 +1,137 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/system_clock.h"
+#include "table/merging_iterator.h"
+#include "test_util/testutil.h"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+#include "util/stop_watch.h"
+#include "util/string_util.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+
+DEFINE_string(num_children, "2,4,8,16,32,64,128,256",
+              "comma-separated list of child iterator counts to benchmark");
+
+DEFINE_int32(keys_per_child, 10000, "average number of keys per child");
+
+DEFINE_int32(run_length, 1,
+             "number of consecutive keys (in merged order) that come from "
+             "the same child; 1 interleaves children at random");
+
+DEFINE_int32(num_runs, 5, "number of full scans per configuration");
+
+DEFINE_int32(seed, 0, "random number generator seed");
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Fixed-width big-endian user keys, so that test::VectorIterator's bytewise
+// sort agrees with the internal key comparator.
+std::string Key(uint64_t val) {
+  std::string user_key(sizeof(val), '\0');
+  for (size_t i = 0; i < sizeof(val); ++i) {
+    user_key[sizeof(val) - 1 - i] = static_cast<char>(val & 0xff);
+    val >>= 8;
+  }
+  return InternalKey(user_key, 0, kTypeValue).Encode().ToString();
+}
+
+// Distributes num_children * keys_per_child consecutive keys over the
+// children in runs of run_length keys each.
+std::vector<std::vector<std::string>> GenerateChildKeys(size_t num_children,
+                                                        Random64* rnd) {
+  std::vector<std::vector<std::string>> child_keys(num_children);
+  uint64_t total = static_cast<uint64_t>(num_children) * FLAGS_keys_per_child;
+  uint64_t run_length = std::max(FLAGS_run_length, 1);
+  size_t child = 0;
+  for (uint64_t k = 0; k < total; ++k) {
+    if (k % run_length == 0) {
+      child = static_cast<size_t>(rnd->Uniform(num_children));
+    }
+    child_keys[child].push_back(Key(k));
+  }
+  return child_keys;
+}
+
+// Returns the average number of nanoseconds per Next() over a full scan.
+double TimeScan(const InternalKeyComparator& icmp,
+                const std::vector<std::vector<std::string>>& child_keys,
+                bool use_loser_tree, SystemClock* clock) {
+  uint64_t elapsed = 0;
+  uint64_t steps = 0;
+  for (int run = 0; run < FLAGS_num_runs; ++run) {
+    std::vector<InternalIterator*> children;
+    for (const auto& keys : child_keys) {
+      children.push_back(new test::VectorIterator(keys));
+    }
+    std::unique_ptr<InternalIterator> iter(NewMergingIterator(
+        &icmp, children.data(), static_cast<int>(children.size()),
+        /*arena=*/nullptr, /*prefix_seek_mode=*/false, use_loser_tree));
+
+    StopWatchNano timer(clock, true /* auto_start */);
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ++steps;
+    }
+    elapsed += timer.ElapsedNanos();
+  }
+  return steps == 0 ? 0.0 : static_cast<double>(elapsed) / steps;
+}
+
+}  // anonymous namespace
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ParseCommandLineFlags(&argc, &argv, true);
+
+  ROCKSDB_NAMESPACE::InternalKeyComparator icmp(
+      ROCKSDB_NAMESPACE::BytewiseComparator());
+  ROCKSDB_NAMESPACE::SystemClock* clock =
+      ROCKSDB_NAMESPACE::SystemClock::Default().get();
+  ROCKSDB_NAMESPACE::Random64 rnd(FLAGS_seed);
+
+  std::cout << std::left << std::setw(12) << "children" << std::setw(18)
+            << "heap (ns/key)" << "loser tree (ns/key)\n";
+  auto counts = ROCKSDB_NAMESPACE::StringSplit(FLAGS_num_children, ',');
+  for (const auto& count : counts) {
+    size_t num_children = static_cast<size_t>(std::stoul(count));
+    if (num_children == 0) {
+      continue;
+    }
+    auto child_keys = ROCKSDB_NAMESPACE::GenerateChildKeys(num_children, &rnd);
+    double heap_ns = ROCKSDB_NAMESPACE::TimeScan(icmp, child_keys,
+                                                 /*use_loser_tree=*/false,
+                                                 clock);
+    double tree_ns = ROCKSDB_NAMESPACE::TimeScan(icmp, child_keys,
+                                                 /*use_loser_tree=*/true,
+                                                 clock);
+    std::cout << std::setw(12) << num_children << std::setw(18) << heap_ns
+              << tree_ns << "\n";
+  }
+
+  return 0;
+}
+
+#endif  // GFLAGS
@@ -48,6 +48,10 @@ static std::unordered_map<std::string, OptionTypeInfo> plain_table_type_info = {
      {offsetof(struct PlainTableOptions, store_index_in_file),
       OptionType::kBoolean, OptionVerificationType::kNormal,
       OptionTypeFlags::kNone}},
+    {"copy_data_to_huge_pages",
+     {offsetof(struct PlainTableOptions, copy_data_to_huge_pages),
+      OptionType::kBoolean, OptionVerificationType::kNormal,
+      OptionTypeFlags::kNone}},
 };
 
 PlainTableFactory::PlainTableFactory(const PlainTableOptions& options)
@@ -65,7 +69,8 @@ Status PlainTableFactory::NewTableReader(
       table_reader_options.internal_comparator, std::move(file), file_size,
       table, table_options_.bloom_bits_per_key, table_options_.hash_table_ratio,
       table_options_.index_sparseness, table_options_.huge_page_tlb_size,
-      table_options_.full_scan_mode, table_reader_options.immortal,
+      table_options_.full_scan_mode, table_options_.copy_data_to_huge_pages,
+      table_reader_options.immortal,
       table_reader_options.prefix_extractor);
 }
 
@@ -118,6 +123,9 @@ std::string PlainTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  store_index_in_file: %d\n",
            table_options_.store_index_in_file);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  copy_data_to_huge_pages: %d\n",
+           table_options_.copy_data_to_huge_pages);
+  ret.append(buffer);
   return ret;
 }
 
@@ -194,6 +202,16 @@ Status GetMemTableRepFactoryFromString(
     } else if (1 == len) {
       mem_factory = NewHashLinkListRepFactory();
     }
+  } else if (opts_list[0] == "hash_indexed_skip_list" ||
+             opts_list[0] == "HashIndexedSkipListRepFactory") {
+    // Expecting format
+    // hash_indexed_skip_list:<hash_bucket_count>
+    if (2 == len) {
+      size_t hash_bucket_count = ParseSizeT(opts_list[1]);
+      mem_factory = NewHashIndexedSkipListRepFactory(hash_bucket_count);
+    } else if (1 == len) {
+      mem_factory = NewHashIndexedSkipListRepFactory();
+    }
   } else if (opts_list[0] == "vector" || opts_list[0] == "VectorRepFactory") {
     // Expecting format
     // vector:<count>
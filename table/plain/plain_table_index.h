@@ -86,6 +86,9 @@ class PlainTableIndex {
   IndexSearchResult GetOffset(uint32_t prefix_hash,
                               uint32_t* bucket_value) const;
 
+  // Prefetches the hash bucket that GetOffset() reads for `prefix_hash`
+  void Prefetch(uint32_t prefix_hash) const;
+
   // Initialize data from `index_data`, which points to raw data for
   // index stored in the SST file.
   Status InitFromRawData(Slice index_data);
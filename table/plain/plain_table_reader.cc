@@ -98,7 +98,7 @@ PlainTableReader::PlainTableReader(
     const EnvOptions& storage_options, const InternalKeyComparator& icomparator,
     EncodingType encoding_type, uint64_t file_size,
     const TableProperties* table_properties,
-    const SliceTransform* prefix_extractor)
+    const SliceTransform* prefix_extractor, size_t huge_page_tlb_size)
     : internal_comparator_(icomparator),
       encoding_type_(encoding_type),
       full_scan_mode_(false),
@@ -108,6 +108,7 @@ PlainTableReader::PlainTableReader(
       bloom_(6),
       file_info_(std::move(file), storage_options,
                  static_cast<uint32_t>(table_properties->data_size)),
+      arena_(Arena::kMinBlockSize, nullptr /* tracker */, huge_page_tlb_size),
       ioptions_(ioptions),
       file_size_(file_size),
       table_properties_(nullptr) {}
@@ -123,8 +124,8 @@ Status PlainTableReader::Open(
     std::unique_ptr<RandomAccessFileReader>&& file, uint64_t file_size,
     std::unique_ptr<TableReader>* table_reader, const int bloom_bits_per_key,
     double hash_table_ratio, size_t index_sparseness, size_t huge_page_tlb_size,
-    bool full_scan_mode, const bool immortal_table,
-    const SliceTransform* prefix_extractor) {
+    bool full_scan_mode, bool copy_data_to_huge_pages,
+    const bool immortal_table, const SliceTransform* prefix_extractor) {
   if (file_size > PlainTableIndex::kMaxFileSize) {
     return Status::NotSupported("File is too large for PlainTableReader!");
   }
@@ -167,9 +168,14 @@ Status PlainTableReader::Open(
 
   std::unique_ptr<PlainTableReader> new_reader(new PlainTableReader(
       ioptions, std::move(file), env_options, internal_comparator,
-      encoding_type, file_size, props.get(), prefix_extractor));
+      encoding_type, file_size, props.get(), prefix_extractor,
+      huge_page_tlb_size));
 
-  s = new_reader->MmapDataIfNeeded();
+  if (copy_data_to_huge_pages && huge_page_tlb_size > 0) {
+    s = new_reader->CopyDataToHugePages(huge_page_tlb_size);
+  } else {
+    s = new_reader->MmapDataIfNeeded();
+  }
   if (!s.ok()) {
     return s;
   }
@@ -298,6 +304,29 @@ Status PlainTableReader::MmapDataIfNeeded() {
   return Status::OK();
 }
 
+Status PlainTableReader::CopyDataToHugePages(size_t huge_page_tlb_size) {
+  const size_t size = static_cast<size_t>(file_size_);
+  char* data = arena_.AllocateAligned(size, huge_page_tlb_size,
+                                      ioptions_.logger);
+  Slice result;
+  // In mmap mode the result points to the mapping rather than `data`
+  Status s = file_info_.file->Read(IOOptions(), 0, size, &result, data,
+                                   nullptr /* aligned_buf */);
+  if (!s.ok()) {
+    return s;
+  }
+  if (result.size() != size) {
+    return Status::Corruption("Truncated PlainTable file",
+                              file_info_.file->file_name());
+  }
+  if (result.data() != data) {
+    memcpy(data, result.data(), size);
+  }
+  file_info_.file_data = Slice(data, size);
+  file_info_.is_mmap_mode = true;
+  return Status::OK();
+}
+
 Status PlainTableReader::PopulateIndex(TableProperties* props,
                                        int bloom_bits_per_key,
                                        double hash_table_ratio,
@@ -578,6 +607,10 @@ Status PlainTableReader::Get(const ReadOptions& /*ro*/, const Slice& target,
   } else {
     prefix_slice = GetPrefix(target);
     prefix_hash = GetSliceHash(prefix_slice);
+    if (enable_bloom_) {
+      // Overlaps the cache miss on the index bucket with the bloom probe
+      index_.Prefetch(prefix_hash);
+    }
     if (!MatchBloom(prefix_hash)) {
       return Status::OK();
     }
@@ -74,7 +74,8 @@ class PlainTableReader: public TableReader {
                      uint64_t file_size, std::unique_ptr<TableReader>* table,
                      const int bloom_bits_per_key, double hash_table_ratio,
                      size_t index_sparseness, size_t huge_page_tlb_size,
-                     bool full_scan_mode, const bool immortal_table = false,
+                     bool full_scan_mode, bool copy_data_to_huge_pages,
+                     const bool immortal_table = false,
                      const SliceTransform* prefix_extractor = nullptr);
 
   // Returns new iterator over table contents
@@ -116,7 +117,8 @@ class PlainTableReader: public TableReader {
                    const InternalKeyComparator& internal_comparator,
                    EncodingType encoding_type, uint64_t file_size,
                    const TableProperties* table_properties,
-                   const SliceTransform* prefix_extractor);
+                   const SliceTransform* prefix_extractor,
+                   size_t huge_page_tlb_size = 0);
   virtual ~PlainTableReader();
 
  protected:
@@ -138,6 +140,10 @@ class PlainTableReader: public TableReader {
 
   Status MmapDataIfNeeded();
 
+  // Reads the whole file into memory allocated from huge pages, falling back
+  // to malloc, and serves all reads from there as in mmap mode.
+  Status CopyDataToHugePages(size_t huge_page_tlb_size);
+
  private:
   const InternalKeyComparator internal_comparator_;
   EncodingType encoding_type_;
@@ -228,6 +228,11 @@ Status SstFileWriter::Open(const std::string& file_path) {
         new UserKeyTablePropertiesCollectorFactory(
             user_collector_factories[i]));
   }
+  if (r->ioptions.user_comparator->timestamp_size() > 0) {
+    int_tbl_prop_collector_factories.emplace_back(
+        new TimestampTablePropertiesCollectorFactory(
+            r->ioptions.user_comparator));
+  }
   int unknown_level = -1;
   uint32_t cf_id;
 
@@ -264,7 +269,8 @@ Status SstFileWriter::Open(const std::string& file_path) {
       std::move(sst_file), file_path, r->env_options, r->ioptions.clock,
       nullptr /* io_tracer */, nullptr /* stats */, r->ioptions.listeners,
       r->ioptions.file_checksum_gen_factory.get(),
-      tmp_set.Contains(FileType::kTableFile), false));
+      tmp_set.Contains(FileType::kTableFile),
+      tmp_set.Contains(FileType::kTableFile)));
 
   // TODO(tec) : If table_factory is using compressed block cache, we will
   // be adding the external sst file blocks into it, which is wasteful.
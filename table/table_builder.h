@@ -151,6 +151,10 @@ struct TableBuilderOptions {
   const int level_at_creation;
   const bool is_bottommost;
   const TableFileCreationReason reason;
+  // Set afterwards by flush and compaction, for the same fields of
+  // FilterBuildingContext
+  std::vector<uint64_t> level_bytes;
+  int num_level0_files = 0;
   // END for FilterBuildingContext
 
   // XXX: only used by BlockBasedTableBuilder for SstFileWriter. If you
@@ -177,6 +181,20 @@ class TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   virtual void Add(const Slice& key, const Slice& value) = 0;
 
+  // Appends a data block copied from another table without re-encoding it,
+  // if the table format allows. `contents` is the block as stored, with
+  // compression `type` in `compress_format_version`, and `entries` are its
+  // entries, which must sort after any previously added key.
+  // Returns false, having added nothing, if the block cannot be taken as it
+  // is; the entries then have to be Add()ed one by one.
+  // REQUIRES: Finish(), Abandon() have not been called
+  virtual bool AddRawDataBlock(
+      const Slice& /*contents*/, CompressionType /*type*/,
+      uint32_t /*compress_format_version*/,
+      const std::vector<std::pair<Slice, Slice>>& /*entries*/) {
+    return false;
+  }
+
   // Return non-ok iff some error has been detected.
   virtual Status status() const = 0;
 
@@ -260,6 +260,10 @@ const std::string TablePropertiesNames::kNumFilterEntries =
 const std::string TablePropertiesNames::kDeletedKeys = "rocksdb.deleted.keys";
 const std::string TablePropertiesNames::kMergeOperands =
     "rocksdb.merge.operands";
+const std::string TablePropertiesNames::kTimestampMin =
+    "rocksdb.timestamp.min";
+const std::string TablePropertiesNames::kTimestampMax =
+    "rocksdb.timestamp.max";
 const std::string TablePropertiesNames::kNumRangeDeletions =
     "rocksdb.num.range-deletions";
 const std::string TablePropertiesNames::kFilterPolicy =
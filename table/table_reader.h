@@ -9,7 +9,11 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include "db/range_tombstone_fragmenter.h"
+#include "rocksdb/compression_type.h"
 #include "rocksdb/slice_transform.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
@@ -32,6 +36,34 @@ class MultiGetContext;
 // multiple threads without external synchronization. Table readers are used
 // for reading various types of table formats supported by rocksdb including
 // BlockBasedTable, PlainTable and CuckooTable format.
+// Iterates the data blocks of a table as they are stored, together with
+// their decoded entries, so that blocks can be copied into another table
+// without being re-encoded. See TableReader::NewRawDataBlockIterator().
+class RawDataBlockIterator {
+ public:
+  virtual ~RawDataBlockIterator() {}
+
+  // Positions at the first block whose last key is at or after the internal
+  // key `target`.
+  virtual void Seek(const Slice& target) = 0;
+  virtual void Next() = 0;
+  virtual bool Valid() const = 0;
+  virtual Status status() const = 0;
+
+  // The current block as stored in the file, without its trailer, and the
+  // compression it is stored with.
+  virtual Slice contents() const = 0;
+  virtual CompressionType compression_type() const = 0;
+
+  // The entries of the current block, in order. Valid until the iterator
+  // moves.
+  virtual const std::vector<std::pair<Slice, Slice>>& entries() const = 0;
+
+  // The compress_format_version compressed blocks of the table are encoded
+  // with (see GetCompressFormatForVersion()).
+  virtual uint32_t compress_format_version() const = 0;
+};
+
 class TableReader {
  public:
   virtual ~TableReader() {}
@@ -82,6 +114,59 @@ class TableReader {
   virtual uint64_t ApproximateSize(const Slice& start, const Slice& end,
                                    TableReaderCaller caller) = 0;
 
+  // Given start and end keys, set *num_entries to the approximate number of
+  // entries in the table between the keys. Returns NotSupported if the
+  // table cannot estimate it more cheaply than from ApproximateSize() and
+  // the table properties.
+  virtual Status ApproximateNumEntries(const Slice& /*start*/,
+                                       const Slice& /*end*/,
+                                       TableReaderCaller /*caller*/,
+                                       uint64_t* /*num_entries*/) {
+    return Status::NotSupported("ApproximateNumEntries() not supported");
+  }
+
+  // A user key in the table, together with the approximate number of file
+  // bytes between the previous anchor (or the start of the table) and it.
+  struct Anchor {
+    Anchor(const Slice& _user_key, uint64_t _range_size)
+        : user_key(_user_key.ToString()), range_size(_range_size) {}
+    std::string user_key;
+    uint64_t range_size;
+  };
+
+  // Appends to *anchors up to about kMaxNumAnchors keys, in increasing
+  // order, that split the table into ranges of similar size. The last
+  // anchor is at or past the largest key of the table, so the range sizes
+  // add up to about the file size.
+  static constexpr size_t kMaxNumAnchors = 128;
+  virtual Status ApproximateKeyAnchors(const ReadOptions& /*read_options*/,
+                                       std::vector<Anchor>* /*anchors*/) {
+    return Status::NotSupported("ApproximateKeyAnchors() not supported");
+  }
+
+  // Returns the prefix of the block cache keys of this table's blocks, which
+  // is followed by the varint64-encoded block offset, or an empty slice if
+  // the table does not use a block cache. Valid while the table is open.
+  virtual Slice GetBlockCacheKeyPrefix() const { return Slice(); }
+
+  // Loads the data blocks starting at the given file offsets, in increasing
+  // order, into the block cache. Offsets that are not the start of a data
+  // block are ignored. Nearby blocks are read together, with reads of up to
+  // read_options.readahead_size bytes (or a default if 0).
+  virtual Status WarmUpBlockCache(
+      const ReadOptions& /*read_options*/,
+      const std::vector<uint64_t>& /*block_offsets*/) {
+    return Status::NotSupported("WarmUpBlockCache() not supported");
+  }
+
+  // Returns an iterator over the data blocks as stored, or nullptr if the
+  // blocks cannot be used outside of this table, e.g. because they depend on
+  // a compression dictionary or a global sequence number.
+  virtual RawDataBlockIterator* NewRawDataBlockIterator(
+      const ReadOptions& /*read_options*/) {
+    return nullptr;
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -91,6 +176,11 @@ class TableReader {
   // Prepare work that can be done before the real Get()
   virtual void Prepare(const Slice& /*target*/) {}
 
+  // Hint that a scan is about to read the table from its start, so that up
+  // to `readahead_size` bytes there can be fetched in the background. Must
+  // not wait for I/O.
+  virtual void PrepareScanStart(size_t /*readahead_size*/) {}
+
   // Report an approximation of how much memory has been used.
   virtual size_t ApproximateMemoryUsage() const = 0;
 
@@ -120,6 +210,15 @@ class TableReader {
     }
   }
 
+  // Asks the underlying file to start reading, without waiting for it, the
+  // data that a later MultiGet() of the same keys is going to need. Must not
+  // block on I/O itself; implementations should only consult metadata that
+  // is already in memory or cache. Default implementation is a no-op.
+  virtual void PrefetchForMultiGet(const ReadOptions& /*readOptions*/,
+                                   const MultiGetContext::Range* /*mget_range*/,
+                                   const SliceTransform* /*prefix_extractor*/,
+                                   bool /*skip_filters*/ = false) {}
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
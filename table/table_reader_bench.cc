@@ -54,6 +54,43 @@ static std::string MakeKey(int i, int j, bool through_db) {
 uint64_t Now(SystemClock* clock, bool measured_by_nanosecond) {
   return measured_by_nanosecond ? clock->NowNanos() : clock->NowMicros();
 }
+
+// Looks up the internal keys `keys` with one TableReader::MultiGet() and
+// returns how long the call took
+uint64_t TimeMultiGet(TableReader* table_reader,
+                      const ImmutableOptions& ioptions,
+                      const ReadOptions& read_options,
+                      const std::vector<std::string>& keys, SystemClock* clock,
+                      bool measured_by_nanosecond) {
+  std::vector<Slice> user_keys;
+  for (const std::string& key : keys) {
+    user_keys.push_back(ExtractUserKey(key));
+  }
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+  autovector<GetContext, MultiGetContext::MAX_BATCH_SIZE> get_contexts;
+  autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_contexts;
+  autovector<KeyContext*, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    get_contexts.emplace_back(ioptions.user_comparator,
+                              ioptions.merge_operator.get(), ioptions.logger,
+                              ioptions.stats, GetContext::kNotFound,
+                              user_keys[i], &values[i], nullptr, nullptr, true,
+                              nullptr, clock);
+    key_contexts.emplace_back(nullptr, user_keys[i], &values[i], nullptr,
+                              &statuses[i]);
+    key_contexts.back().get_context = &get_contexts.back();
+  }
+  for (auto& key_context : key_contexts) {
+    sorted_keys.emplace_back(&key_context);
+  }
+  MultiGetContext ctx(&sorted_keys, 0, sorted_keys.size(), kMaxSequenceNumber,
+                      read_options);
+  MultiGetContext::Range range = ctx.GetMultiGetRange();
+  uint64_t start_time = Now(clock, measured_by_nanosecond);
+  table_reader->MultiGet(read_options, &range, nullptr);
+  return Now(clock, measured_by_nanosecond) - start_time;
+}
 }  // namespace
 
 // A very simple benchmark that.
@@ -69,12 +106,17 @@ uint64_t Now(SystemClock* clock, bool measured_by_nanosecond) {
 //
 // If for_terator=true, instead of just query one key each time, it queries
 // a range sharing the same prefix.
+//
+// If multiget_batch_size > 0 and through_db=false, keys are instead queried
+// with TableReader::MultiGet() in batches of that many keys, and the time
+// per key is reported.
 namespace {
 void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
                           ReadOptions& read_options, int num_keys1,
                           int num_keys2, int num_iter, int /*prefix_len*/,
                           bool if_query_empty_keys, bool for_iterator,
-                          bool through_db, bool measured_by_nanosecond) {
+                          bool through_db, bool measured_by_nanosecond,
+                          int value_size, int multiget_batch_size) {
   ROCKSDB_NAMESPACE::InternalKeyComparator ikc(opts.comparator);
 
   std::string file_name =
@@ -110,13 +152,16 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
     ASSERT_TRUE(db != nullptr);
   }
   // Populate slightly more than 1M keys
+  Random value_rnd(302);
   for (int i = 0; i < num_keys1; i++) {
     for (int j = 0; j < num_keys2; j++) {
       std::string key = MakeKey(i * 2, j, through_db);
+      std::string value =
+          value_size > 0 ? value_rnd.RandomString(value_size) : key;
       if (!through_db) {
-        tb->Add(key, key);
+        tb->Add(key, value);
       } else {
-        db->Put(wo, key, key);
+        db->Put(wo, key, value);
       }
     }
   }
@@ -155,6 +200,10 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
   Random rnd(301);
   std::string result;
   HistogramImpl hist;
+  const size_t batch_size = static_cast<size_t>(
+      std::min(multiget_batch_size,
+               static_cast<int>(MultiGetContext::MAX_BATCH_SIZE)));
+  std::vector<std::string> batch_keys;
 
   for (int it = 0; it < num_iter; it++) {
     for (int i = 0; i < num_keys1; i++) {
@@ -166,7 +215,15 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
           r2 = num_keys2 * 2 - r2;
         }
 
-        if (!for_iterator) {
+        if (!for_iterator && batch_size > 0 && !through_db) {
+          batch_keys.push_back(MakeKey(r1, r2, through_db));
+          if (batch_keys.size() == batch_size) {
+            hist.Add(TimeMultiGet(table_reader.get(), ioptions, read_options,
+                                  batch_keys, clock, measured_by_nanosecond) /
+                     batch_size);
+            batch_keys.clear();
+          }
+        } else if (!for_iterator) {
           // Query one existing key;
           std::string key = MakeKey(r1, r2, through_db);
           uint64_t start_time = Now(clock, measured_by_nanosecond);
@@ -275,6 +332,16 @@ DEFINE_bool(mmap_read, true, "Whether use mmap read");
 DEFINE_string(table_factory, "block_based",
               "Table factory to use: `block_based` (default), `plain_table` or "
               "`cuckoo_hash`.");
+DEFINE_int32(value_size, 0,
+             "Size of the values. If 0, each value is a copy of its key.");
+DEFINE_bool(separate_key_value_in_data_block, false,
+            "Store values apart from keys in data blocks (block_based only)");
+DEFINE_bool(restart_key_prefixes_in_data_block, false,
+            "Store restart key prefixes in data blocks (block_based only)");
+DEFINE_int32(multiget_batch_size, 0,
+             "If > 0, query the keys with MultiGet in batches of this many "
+             "keys (at most 32), directly against the table reader, and "
+             "report the time per key.");
 DEFINE_string(time_unit, "microsecond",
               "The time unit used for measuring performance. User can specify "
               "`microsecond` (default) or `nanosecond`");
@@ -324,7 +391,12 @@ int main(int argc, char** argv) {
     exit(1);
 #endif  // ROCKSDB_LITE
   } else if (FLAGS_table_factory == "block_based") {
-    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory());
+    ROCKSDB_NAMESPACE::BlockBasedTableOptions table_options;
+    table_options.separate_key_value_in_data_block =
+        FLAGS_separate_key_value_in_data_block;
+    table_options.restart_key_prefixes_in_data_block =
+        FLAGS_restart_key_prefixes_in_data_block;
+    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory(table_options));
   } else {
     fprintf(stderr, "Invalid table type %s\n", FLAGS_table_factory.c_str());
   }
@@ -337,7 +409,7 @@ int main(int argc, char** argv) {
     ROCKSDB_NAMESPACE::TableReaderBenchmark(
         options, env_options, ro, FLAGS_num_keys1, FLAGS_num_keys2, FLAGS_iter,
         FLAGS_prefix_len, FLAGS_query_empty, FLAGS_iterator, FLAGS_through_db,
-        measured_by_nanosecond);
+        measured_by_nanosecond, FLAGS_value_size, FLAGS_multiget_batch_size);
   } else {
     return 1;
   }
@@ -2212,6 +2212,186 @@ TEST_P(BlockBasedTableTest, BinaryIndexWithFirstKey1) {
   IndexTest(table_options);
 }
 
+TEST_P(BlockBasedTableTest, LearnedIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kLearned;
+  IndexTest(table_options);
+}
+
+// kLearned must find the same keys as binary search both when the keys suit
+// the model and when the model is left out.
+TEST_P(BlockBasedTableTest, LearnedIndexSeek) {
+  for (int numeric = 0; numeric < 2; ++numeric) {
+    SCOPED_TRACE("numeric = " + std::to_string(numeric));
+    Random rnd(301);
+    auto make_key = [&](uint64_t n) {
+      if (numeric) {
+        // Big-endian integers behind a common prefix
+        std::string key = "user";
+        PutFixed64(&key, EndianSwapValue(n));
+        return key;
+      } else {
+        // Most keys share their first 8 bytes
+        return std::string(1, static_cast<char>('a' + n % 2)) +
+               std::string(10, '_') + ToString(n);
+      }
+    };
+
+    BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+    table_options.index_type = BlockBasedTableOptions::kLearned;
+    // One key per data block
+    table_options.block_size = 1;
+    Options options;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    TableConstructor c(BytewiseComparator(),
+                       true /* convert_to_internal_key_ */);
+    std::vector<std::string> user_keys;
+    for (uint64_t i = 0; i < 2000; ++i) {
+      // Unevenly spaced numbers
+      uint64_t n = i * i * 100 + rnd.Uniform(100);
+      user_keys.push_back(make_key(n));
+      c.Add(user_keys.back(), "v");
+    }
+    std::sort(user_keys.begin(), user_keys.end());
+
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    const ImmutableOptions ioptions(options);
+    const MutableCFOptions moptions(options);
+    c.Finish(options, ioptions, moptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+    ASSERT_EQ(2000u, c.GetTableReader()->GetTableProperties()->num_data_blocks);
+
+    std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+        ReadOptions(), moptions.prefix_extractor.get(), /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    std::vector<std::string> targets = user_keys;
+    for (int i = 0; i < 2000; ++i) {
+      targets.push_back(make_key(rnd.Uniform(2000 * 2000 * 100)));
+    }
+    targets.push_back("");
+    targets.push_back("zzzz");
+    for (const auto& target : targets) {
+      iter->Seek(InternalKey(target, kMaxSequenceNumber, kValueTypeForSeek)
+                     .Encode());
+      ASSERT_OK(iter->status());
+      auto expected =
+          std::lower_bound(user_keys.begin(), user_keys.end(), target);
+      if (expected == user_keys.end()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*expected, ExtractUserKey(iter->key()).ToString());
+      }
+    }
+  }
+}
+
+TEST_P(BlockBasedTableTest, EliasFanoIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kEliasFano;
+  IndexTest(table_options);
+}
+
+// kEliasFano must find the same keys as binary search both with fixed-size
+// keys, for which it takes much less memory, and when it falls back to the
+// index block.
+TEST_P(BlockBasedTableTest, EliasFanoIndexSeek) {
+  for (int kind = 0; kind < 3; ++kind) {
+    SCOPED_TRACE("kind = " + std::to_string(kind));
+    size_t memory_usage[2] = {0, 0};
+    for (int elias_fano = 0; elias_fano < 2; ++elias_fano) {
+      Random rnd(301);
+      auto make_key = [&]() {
+        std::string key = "user";
+        if (kind == 2) {
+          // Blocks that share their first 8 bytes after the prefix
+          PutFixed64(&key, EndianSwapValue(uint64_t{rnd.Uniform(20)}));
+          key += rnd.RandomBinaryString(4);
+        } else {
+          key += rnd.RandomBinaryString(12);
+          if (kind == 0) {
+            // Not fixed-size
+            key.resize(key.size() - rnd.Uniform(4));
+          }
+        }
+        return key;
+      };
+
+      BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+      table_options.index_type = elias_fano
+                                     ? BlockBasedTableOptions::kEliasFano
+                                     : BlockBasedTableOptions::kBinarySearch;
+      table_options.cache_index_and_filter_blocks = false;
+      // A few keys per data block
+      table_options.block_size = 100;
+      Options options;
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+      TableConstructor c(BytewiseComparator(),
+                         true /* convert_to_internal_key_ */);
+      std::vector<std::string> user_keys;
+      for (int i = 0; i < 2000; ++i) {
+        user_keys.push_back(make_key());
+        c.Add(user_keys.back(), "v");
+      }
+      std::sort(user_keys.begin(), user_keys.end());
+      user_keys.erase(std::unique(user_keys.begin(), user_keys.end()),
+                      user_keys.end());
+
+      std::vector<std::string> keys;
+      stl_wrappers::KVMap kvmap;
+      const ImmutableOptions ioptions(options);
+      const MutableCFOptions moptions(options);
+      c.Finish(options, ioptions, moptions, table_options,
+               GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+      memory_usage[elias_fano] = c.GetTableReader()->ApproximateMemoryUsage();
+
+      std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+          ReadOptions(), moptions.prefix_extractor.get(), /*arena=*/nullptr,
+          /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+      std::vector<std::string> targets = user_keys;
+      for (int i = 0; i < 1000; ++i) {
+        targets.push_back(make_key());
+        targets.push_back(targets.back().substr(
+            0, rnd.Uniform(static_cast<int>(targets.back().size()))));
+      }
+      targets.push_back("");
+      targets.push_back("zzzz");
+      targets.push_back(std::string(20, '\xff'));
+      for (const auto& target : targets) {
+        iter->Seek(InternalKey(target, kMaxSequenceNumber, kValueTypeForSeek)
+                       .Encode());
+        ASSERT_OK(iter->status());
+        auto expected =
+            std::lower_bound(user_keys.begin(), user_keys.end(), target);
+        if (expected == user_keys.end()) {
+          ASSERT_FALSE(iter->Valid());
+        } else {
+          ASSERT_TRUE(iter->Valid());
+          ASSERT_EQ(*expected, ExtractUserKey(iter->key()).ToString());
+        }
+      }
+
+      // Across data blocks in both directions
+      size_t n = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(user_keys[n++], ExtractUserKey(iter->key()).ToString());
+      }
+      ASSERT_EQ(user_keys.size(), n);
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        ASSERT_EQ(user_keys[--n], ExtractUserKey(iter->key()).ToString());
+      }
+      ASSERT_EQ(0u, n);
+      ASSERT_OK(iter->status());
+    }
+    // Format versions before 3 keep sequence numbers in index keys, which
+    // the Elias-Fano index does not have
+    if (kind > 0 && GetBlockBasedTableOptions().format_version >= 3) {
+      ASSERT_LT(memory_usage[1] * 2, memory_usage[0]);
+    }
+  }
+}
+
 class CustomFlushBlockPolicy : public FlushBlockPolicyFactory,
                                public FlushBlockPolicy {
  public:
@@ -3816,6 +3996,26 @@ TEST(TableTest, FooterTests) {
     ASSERT_EQ(decoded_footer.index_handle().size(), index.size());
     ASSERT_EQ(decoded_footer.version(), 1U);
   }
+  {
+    // XXH3 block based
+    std::string encoded;
+    Footer footer(kBlockBasedTableMagicNumber, 1);
+    BlockHandle meta_index(10, 5), index(20, 15);
+    footer.set_metaindex_handle(meta_index);
+    footer.set_index_handle(index);
+    footer.set_checksum(kXXH3);
+    footer.EncodeTo(&encoded);
+    Footer decoded_footer;
+    Slice encoded_slice(encoded);
+    ASSERT_OK(decoded_footer.DecodeFrom(&encoded_slice));
+    ASSERT_EQ(decoded_footer.table_magic_number(), kBlockBasedTableMagicNumber);
+    ASSERT_EQ(decoded_footer.checksum(), kXXH3);
+    ASSERT_EQ(decoded_footer.metaindex_handle().offset(), meta_index.offset());
+    ASSERT_EQ(decoded_footer.metaindex_handle().size(), meta_index.size());
+    ASSERT_EQ(decoded_footer.index_handle().offset(), index.offset());
+    ASSERT_EQ(decoded_footer.index_handle().size(), index.size());
+    ASSERT_EQ(decoded_footer.version(), 1U);
+  }
 // Plain table is not supported in ROCKSDB_LITE
 #ifndef ROCKSDB_LITE
   {
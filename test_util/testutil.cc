@@ -264,9 +264,10 @@ BlockBasedTableOptions RandomBlockBasedTableOptions(Random* rnd) {
   opt.pin_l0_filter_and_index_blocks_in_cache = rnd->Uniform(2);
   opt.pin_top_level_index_and_filter = rnd->Uniform(2);
   using IndexType = BlockBasedTableOptions::IndexType;
-  const std::array<IndexType, 4> index_types = {
+  const std::array<IndexType, 6> index_types = {
       {IndexType::kBinarySearch, IndexType::kHashSearch,
-       IndexType::kTwoLevelIndexSearch, IndexType::kBinarySearchWithFirstKey}};
+       IndexType::kTwoLevelIndexSearch, IndexType::kBinarySearchWithFirstKey,
+       IndexType::kLearned, IndexType::kEliasFano}};
   opt.index_type =
       index_types[rnd->Uniform(static_cast<int>(index_types.size()))];
   opt.hash_index_allow_collision = rnd->Uniform(2);
@@ -417,6 +418,7 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, DBOptions& db_options,
   cf_opt->arena_block_size = rnd->Uniform(10000);
   cf_opt->inplace_update_num_locks = rnd->Uniform(10000);
   cf_opt->max_successive_merges = rnd->Uniform(10000);
+  cf_opt->merge_operands_collapse_threshold = rnd->Uniform(10000);
   cf_opt->memtable_huge_page_size = rnd->Uniform(10000);
   cf_opt->write_buffer_size = rnd->Uniform(10000);
 
@@ -55,6 +55,11 @@ DEFINE_bool(print_data_block_access_count_stats, false,
 DEFINE_int32(cache_sim_warmup_seconds, 0,
              "The number of seconds to warmup simulated caches. The hit/miss "
              "counters are reset after the warmup completes.");
+DEFINE_int32(cache_sim_threads, 0,
+             "If > 0, the simulated caches are split among this many threads, "
+             "which simulate batches of accesses while the next batch is "
+             "read. The results are the same as with 0 (simulate on the "
+             "analyzing thread).");
 DEFINE_int32(analyze_bottom_k_access_count_blocks, 0,
              "Print out detailed access information for blocks with their "
              "number of accesses are the bottom k among all blocks.");
@@ -155,6 +160,8 @@ namespace ROCKSDB_NAMESPACE {
 namespace {
 
 const std::string kMissRatioCurveFileName = "mrc";
+// Number of accesses simulated together with cache_sim_threads
+const size_t kCacheSimBatchSize = 64 * 1024;
 const std::string kGroupbyBlock = "block";
 const std::string kGroupbyTable = "table";
 const std::string kGroupbyColumnFamily = "cf";
@@ -1439,7 +1446,8 @@ BlockCacheTraceAnalyzer::BlockCacheTraceAnalyzer(
     const std::string& human_readable_trace_file_path,
     bool compute_reuse_distance, bool mrc_only,
     bool is_human_readable_trace_file,
-    std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator)
+    std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator,
+    size_t cache_sim_threads)
     : env_(ROCKSDB_NAMESPACE::Env::Default()),
       trace_file_path_(trace_file_path),
       output_dir_(output_dir),
@@ -1447,7 +1455,8 @@ BlockCacheTraceAnalyzer::BlockCacheTraceAnalyzer(
       compute_reuse_distance_(compute_reuse_distance),
       mrc_only_(mrc_only),
       is_human_readable_trace_file_(is_human_readable_trace_file),
-      cache_simulator_(std::move(cache_simulator)) {}
+      cache_simulator_(std::move(cache_simulator)),
+      cache_sim_threads_(cache_sim_threads) {}
 
 void BlockCacheTraceAnalyzer::ComputeReuseDistance(
     BlockAccessInfo* info) const {
@@ -1546,6 +1555,23 @@ Status BlockCacheTraceAnalyzer::Analyze() {
   }
   uint64_t start = clock->NowMicros();
   uint64_t time_interval = 0;
+  // With cache_sim_threads_, a background thread simulates one batch of
+  // accesses while the next one is read
+  std::vector<BlockCacheTraceRecord> sim_batch;
+  std::vector<BlockCacheTraceRecord> simulating_batch;
+  port::Thread sim_thread;
+  auto simulate_batch = [&]() {
+    if (sim_thread.joinable()) {
+      sim_thread.join();
+    }
+    simulating_batch.swap(sim_batch);
+    sim_batch.clear();
+    if (!simulating_batch.empty()) {
+      sim_thread = port::Thread([&]() {
+        cache_simulator_->Access(simulating_batch, cache_sim_threads_);
+      });
+    }
+  };
   while (s.ok()) {
     BlockCacheTraceRecord access;
     s = reader->ReadAccess(&access);
@@ -1567,7 +1593,14 @@ Status BlockCacheTraceAnalyzer::Analyze() {
                                     is_user_access(access.caller),
                                     access.is_cache_hit == Boolean::kFalse);
     if (cache_simulator_) {
-      cache_simulator_->Access(access);
+      if (cache_sim_threads_ > 0) {
+        sim_batch.push_back(std::move(access));
+        if (sim_batch.size() >= kCacheSimBatchSize) {
+          simulate_batch();
+        }
+      } else {
+        cache_simulator_->Access(access);
+      }
     }
     access_sequence_number_++;
     uint64_t now = clock->NowMicros();
@@ -1584,6 +1617,12 @@ Status BlockCacheTraceAnalyzer::Analyze() {
       time_interval++;
     }
   }
+  if (cache_simulator_ && cache_sim_threads_ > 0) {
+    simulate_batch();
+    if (sim_thread.joinable()) {
+      sim_thread.join();
+    }
+  }
   uint64_t now = clock->NowMicros();
   uint64_t duration = (now - start) / kMicrosInSecond;
   uint64_t trace_duration =
@@ -2134,7 +2173,8 @@ int block_cache_trace_analyzer_tool(int argc, char** argv) {
       FLAGS_block_cache_trace_path, FLAGS_block_cache_analysis_result_dir,
       FLAGS_human_readable_trace_file_path,
       !FLAGS_reuse_distance_labels.empty(), FLAGS_mrc_only,
-      FLAGS_is_block_cache_human_readable_trace, std::move(cache_simulator));
+      FLAGS_is_block_cache_human_readable_trace, std::move(cache_simulator),
+      static_cast<size_t>(std::max(FLAGS_cache_sim_threads, 0)));
   Status s = analyzer.Analyze();
   if (!s.IsIncomplete() && !s.ok()) {
     // Read all traces.
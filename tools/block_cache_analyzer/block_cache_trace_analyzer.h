@@ -148,7 +148,8 @@ class BlockCacheTraceAnalyzer {
       const std::string& human_readable_trace_file_path,
       bool compute_reuse_distance, bool mrc_only,
       bool is_human_readable_trace_file,
-      std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator);
+      std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator,
+      size_t cache_sim_threads = 0);
   ~BlockCacheTraceAnalyzer() = default;
   // No copy and move.
   BlockCacheTraceAnalyzer(const BlockCacheTraceAnalyzer&) = delete;
@@ -378,6 +379,9 @@ class BlockCacheTraceAnalyzer {
 
   BlockCacheTraceHeader header_;
   std::unique_ptr<BlockCacheTraceSimulator> cache_simulator_;
+  // If > 0, accesses are fed to the simulated caches in batches, with the
+  // caches split among this many threads
+  const size_t cache_sim_threads_;
   std::map<std::string, ColumnFamilyAccessInfoAggregate> cf_aggregates_map_;
   std::map<std::string, BlockAccessInfo*> block_info_map_;
   std::unordered_map<std::string, GetKeyInfo> get_key_info_map_;
@@ -28,6 +28,7 @@
 #endif
 #include <atomic>
 #include <cinttypes>
+#include <cmath>
 #include <condition_variable>
 #include <cstddef>
 #include <memory>
@@ -43,6 +44,7 @@
 #include "monitoring/histogram.h"
 #include "monitoring/statistics.h"
 #include "options/cf_options.h"
+#include "options/options_helper.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/cache.h"
@@ -67,6 +69,7 @@
 #include "rocksdb/utilities/transaction.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "rocksdb/write_batch.h"
+#include "table/format.h"
 #include "test_util/testutil.h"
 #include "test_util/transaction_test_util.h"
 #include "tools/simulated_hybrid_file_system.h"
@@ -144,6 +147,7 @@ IF_ROCKSDB_LITE("",
     "fill100K,"
     "crc32c,"
     "xxhash,"
+    "xxh3,"
     "compress,"
     "uncompress,"
     "acquireload,"
@@ -204,6 +208,7 @@ IF_ROCKSDB_LITE("",
     "merge\n"
     "\tcrc32c        -- repeated crc32c of 4K of data\n"
     "\txxhash        -- repeated xxHash of 4K of data\n"
+    "\txxh3          -- repeated kXXH3 block checksum of --block_size data\n"
     "\tacquireload   -- load N*1000 times\n"
     "\tfillseekseq   -- write N values in sequential key, then read "
     "them by seeking to each key\n"
@@ -466,6 +471,11 @@ DEFINE_int32(max_background_jobs,
              "The maximum number of concurrent background jobs that can occur "
              "in parallel.");
 
+DEFINE_bool(prioritize_stall_relieving_work,
+            ROCKSDB_NAMESPACE::Options().prioritize_stall_relieving_work,
+            "Run queued flushes and compactions of the column families "
+            "closest to a write stall first.");
+
 DEFINE_int32(num_bottom_pri_threads, 0,
              "The number of threads in the bottom-priority thread pool (used "
              "by universal compaction only).");
@@ -505,7 +515,8 @@ DEFINE_int32(compaction_style,
 static ROCKSDB_NAMESPACE::CompactionPri FLAGS_compaction_pri_e;
 DEFINE_int32(compaction_pri,
              (int32_t)ROCKSDB_NAMESPACE::Options().compaction_pri,
-             "priority of files to compaction: by size or by data age");
+             "priority of files to compaction: by size, by data age, by "
+             "overlapping ratio or by read hotness (see CompactionPri)");
 
 DEFINE_int32(universal_size_ratio, 0,
              "Percentage flexibility while comparing file size"
@@ -527,6 +538,10 @@ DEFINE_int32(universal_compression_size_percent, -1,
 DEFINE_bool(universal_allow_trivial_move, false,
             "Allow trivial move in universal compaction.");
 
+DEFINE_bool(universal_incremental, false,
+            "Reduce size amplification in universal compaction by compacting "
+            "key ranges of the oldest sorted runs.");
+
 DEFINE_int64(cache_size, 8 << 20,  // 8MB
              "Number of bytes to use as a cache of uncompressed data");
 
@@ -547,12 +562,29 @@ DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
 
+DEFINE_double(cache_miss_ratio_curve_sampling_rate, 0.0,
+              "If > 0.0, wrap the block cache in a MissRatioCurveCache that "
+              "samples this fraction of cache keys, and report the estimated "
+              "miss ratios of 1/8 to 4 times the cache size.");
+
 DEFINE_bool(cache_index_and_filter_blocks, false,
             "Cache index/filter blocks in block cache.");
 
 DEFINE_bool(use_cache_memkind_kmem_allocator, false,
             "Use memkind kmem allocator for block cache.");
 
+DEFINE_bool(use_cache_slab_allocator, false,
+            "Allocate block cache blocks with NewSlabAllocator().");
+
+DEFINE_bool(cache_frequency_admission, false,
+            "Make LRUCache reject new blocks that were accessed less often "
+            "than the entry they would evict (see "
+            "LRUCacheOptions::use_frequency_admission).");
+
+DEFINE_bool(cache_lock_free_lookup, false,
+            "Make LRUCache look up blocks without taking the shard mutex (see "
+            "LRUCacheOptions::lock_free_lookup).");
+
 DEFINE_bool(partition_index_and_filters, false,
             "Partition index and filter blocks.");
 
@@ -565,6 +597,35 @@ DEFINE_bool(
     ROCKSDB_NAMESPACE::BlockBasedTableOptions().optimize_filters_for_memory,
     "Minimize memory footprint of filters");
 
+DEFINE_bool(
+    reserve_table_builder_memory,
+    ROCKSDB_NAMESPACE::BlockBasedTableOptions().reserve_table_builder_memory,
+    "Charge memory used by table builders (filter construction) to the "
+    "block cache");
+
+DEFINE_uint64(
+    range_filter_prefix_len,
+    ROCKSDB_NAMESPACE::BlockBasedTableOptions().range_filter_prefix_len,
+    "If > 0, build per-file range filters of key prefixes of this length, "
+    "used by range scans with --max_scan_distance");
+
+DEFINE_bool(adaptive_compression,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions().adaptive_compression,
+            "Choose the compression of each data block from an estimate of "
+            "its compressibility");
+
+DEFINE_int32(multiget_decompression_threads,
+             ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                 .multiget_decompression_threads,
+             "If > 0, MultiGet decompresses the data blocks it reads on up "
+             "to this many pool threads besides the calling thread");
+
+DEFINE_uint32(key_position_samples,
+              ROCKSDB_NAMESPACE::BlockBasedTableOptions().key_position_samples,
+              "If > 0, each table file stores the positions of about this "
+              "many data blocks, used to estimate approximate sizes and key "
+              "counts without reading index blocks");
+
 DEFINE_int64(
     index_shortening_mode, 2,
     "mode to shorten index: 0 for no shortening; 1 for only shortening "
@@ -586,6 +647,11 @@ DEFINE_bool(
     pin_top_level_index_and_filter, false,
     "Pin top-level index of partitioned index/filter blocks in block cache.");
 
+DEFINE_bool(compact_table_reader,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions().compact_table_reader,
+            "Keep only a minimal per-file table reader, serving index, filter "
+            "and full table properties from the block cache.");
+
 DEFINE_int32(block_size,
              static_cast<int32_t>(
                  ROCKSDB_NAMESPACE::BlockBasedTableOptions().block_size),
@@ -596,6 +662,10 @@ DEFINE_int32(format_version,
                  ROCKSDB_NAMESPACE::BlockBasedTableOptions().format_version),
              "Format version of SST files.");
 
+DEFINE_string(checksum_type, "kCRC32c",
+              "Algorithm to checksum blocks with: kNoChecksum, kCRC32c, "
+              "kxxHash, kxxHash64 or kXXH3.");
+
 DEFINE_int32(block_restart_interval,
              ROCKSDB_NAMESPACE::BlockBasedTableOptions().block_restart_interval,
              "Number of keys between restart points "
@@ -634,6 +704,11 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(wide_data_block_hash_index, false,
+            "Also build a data block hash index, with 16-bit buckets, for "
+            "blocks with more than 253 restart intervals. This is only valid "
+            "if use_data_block_hash_index is set to true");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -650,11 +725,30 @@ DEFINE_int32(file_opening_threads,
              "If open_files is set to -1, this option set the number of "
              "threads that will be used to open files during DB::Open()");
 
+DEFINE_bool(open_table_files_in_background,
+            ROCKSDB_NAMESPACE::Options().open_table_files_in_background,
+            "Open table files after DB::Open() returns, in the background "
+            "and on first access, instead of during DB::Open()");
+
 DEFINE_bool(new_table_reader_for_compaction_inputs, true,
              "If true, uses a separate file handle for compaction inputs");
 
 DEFINE_int32(compaction_readahead_size, 0, "Compaction readahead size");
 
+DEFINE_int32(max_compaction_readahead_size, 0,
+             "Size compaction readahead may grow to, shared among concurrent "
+             "compactions");
+
+DEFINE_bool(pipelined_compaction_io,
+            ROCKSDB_NAMESPACE::Options().pipelined_compaction_io,
+            "Overlap compaction input reads and output file syncs with "
+            "merging.");
+
+DEFINE_bool(compaction_copy_unchanged_blocks,
+            ROCKSDB_NAMESPACE::Options().compaction_copy_unchanged_blocks,
+            "Copy input data blocks that a compaction would not change into "
+            "its output as they are stored.");
+
 DEFINE_int32(log_readahead_size, 0, "WAL and manifest readahead size");
 
 DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
@@ -676,6 +770,15 @@ DEFINE_bool(memtable_whole_key_filtering, false,
             "Try to use whole key bloom filter in memtables.");
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
+DEFINE_uint64(memtable_hot_key_cache_size, 0,
+              "Number of recent Get() results to cache per memtable. 0 "
+              "disables the cache.");
+DEFINE_uint64(memtable_large_value_threshold, 0,
+              "Store memtable values of at least this many bytes apart from "
+              "their entries. 0 disables it.");
+DEFINE_uint64(max_adaptive_write_buffer_size, 0,
+              "If larger than --write_buffer_size, grow memtables up to this "
+              "size while they fill up.");
 
 DEFINE_bool(use_existing_db, false, "If true, do not destroy the existing"
             " database.  If you set this flag and also specify a benchmark that"
@@ -710,6 +813,10 @@ DEFINE_bool(read_cache_direct_write, true,
 DEFINE_bool(read_cache_direct_read, true,
             "Whether to use Direct IO for reading from read cache");
 
+DEFINE_bool(read_cache_as_secondary_cache, false,
+            "If true, the read cache is used as the secondary cache of the "
+            "block cache instead of as the persistent cache of the table");
+
 DEFINE_bool(use_keep_filter, false, "Whether to use a noop compaction filter");
 
 static bool ValidateCacheNumshardbits(const char* flagname, int32_t value) {
@@ -820,6 +927,10 @@ DEFINE_bool(optimize_filters_for_hits, false,
             "a value. For now this doesn't create bloom filters for the max "
             "level of the LSM to reduce metadata that should fit in RAM. ");
 
+DEFINE_uint64(skip_filters_after_unhelpful_checks, 0,
+              "Stop checking the filters of a level after this many checks in "
+              "a row that rule out no key. 0 always checks them.");
+
 DEFINE_uint64(delete_obsolete_files_period_micros, 0,
               "Ignored. Left here for backward compatibility");
 
@@ -889,6 +1000,10 @@ DEFINE_bool(fifo_compaction_allow_compaction, true,
 
 DEFINE_uint64(fifo_compaction_ttl, 0, "TTL for the SST Files in seconds.");
 
+DEFINE_uint64(fifo_compaction_time_window_seconds,
+              ROCKSDB_NAMESPACE::CompactionOptionsFIFO().time_window_seconds,
+              "Compact FIFO files by time windows of this many seconds.");
+
 // Stacked BlobDB Options
 DEFINE_bool(use_blob_db, false, "[Stacked BlobDB] Open a BlobDB instance.");
 
@@ -961,6 +1076,18 @@ DEFINE_string(blob_compression_type, "none",
               "[Integrated BlobDB] The compression algorithm to use for large "
               "values stored in blob files.");
 
+DEFINE_uint32(blob_compression_max_dict_bytes,
+              ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                  .blob_compression_max_dict_bytes,
+              "[Integrated BlobDB] The maximum size of the compression "
+              "dictionary of blob files; 0 disables dictionary compression.");
+
+DEFINE_uint32(blob_compression_parallel_threads,
+              ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                  .blob_compression_parallel_threads,
+              "[Integrated BlobDB] The number of threads flushes and "
+              "compactions compress blobs on.");
+
 DEFINE_bool(enable_blob_garbage_collection,
             ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
                 .enable_blob_garbage_collection,
@@ -972,6 +1099,24 @@ DEFINE_double(blob_garbage_collection_age_cutoff,
               "[Integrated BlobDB] The cutoff in terms of blob file age for "
               "garbage collection.");
 
+DEFINE_double(blob_garbage_collection_force_threshold,
+              ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                  .blob_garbage_collection_force_threshold,
+              "[Integrated BlobDB] The garbage ratio at which the SST files "
+              "referencing a blob file are compacted to relocate its blobs.");
+
+DEFINE_uint64(cold_blob_file_size,
+              ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                  .cold_blob_file_size,
+              "[Integrated BlobDB] The size limit for the separate blob files "
+              "that blobs relocated by garbage collection are written to; 0 "
+              "writes them together with new blobs.");
+
+DEFINE_bool(use_direct_reads_for_blob_files,
+            ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                .use_direct_reads_for_blob_files,
+            "[Integrated BlobDB] Read blob files with direct I/O.");
+
 #ifndef ROCKSDB_LITE
 
 // Secondary DB instance Options
@@ -1011,6 +1156,18 @@ DEFINE_int64(
 DEFINE_string(block_cache_trace_file, "", "Block cache trace file path.");
 DEFINE_int32(trace_replay_threads, 1,
              "The number of threads to replay, must >=1.");
+DEFINE_double(trace_replay_speed, 0,
+              "If > 0, the rate of trace replay relative to the trace, which "
+              "may be fractional, e.g. 0.5 for half speed. Overrides "
+              "--trace_replay_fast_forward.");
+DEFINE_string(trace_replay_key_prefix_from, "",
+              "Replace this prefix of the replayed keys with "
+              "--trace_replay_key_prefix_to.");
+DEFINE_string(trace_replay_key_prefix_to, "",
+              "See --trace_replay_key_prefix_from.");
+DEFINE_int32(trace_replay_keyspace_multiplier, 1,
+             "Replay every trace record this many times, each copy against "
+             "its own keyspace, to scale the traced load up. Must be >= 1.");
 
 static enum ROCKSDB_NAMESPACE::CompressionType StringToCompressionType(
     const char* ctype) {
@@ -1094,6 +1251,11 @@ DEFINE_uint64(compression_max_dict_buffer_bytes,
               ROCKSDB_NAMESPACE::CompressionOptions().max_dict_buffer_bytes,
               "Maximum bytes to buffer to collect samples for dictionary.");
 
+DEFINE_uint64(compression_max_dict_reuse_seconds,
+              ROCKSDB_NAMESPACE::CompressionOptions().max_dict_reuse_seconds,
+              "Seconds for which a dictionary is reused by the following "
+              "SST files of the same level.");
+
 static bool ValidateTableCacheNumshardbits(const char* flagname,
                                            int32_t value) {
   if (0 >= value || value >= 20) {
@@ -1122,6 +1284,12 @@ DEFINE_string(simulate_hybrid_fs_file, "",
               "disable the feature. Now, if it is set, "
               "bottommost_temperature is set to kWarm.");
 
+DEFINE_uint64(bottommost_hot_file_read_rate,
+              ROCKSDB_NAMESPACE::Options().bottommost_hot_file_read_rate,
+              "Reads per hour per MB above which bottommost files are moved "
+              "out of bottommost_temperature. Used with "
+              "--simulate_hybrid_fs_file.");
+
 static std::shared_ptr<ROCKSDB_NAMESPACE::Env> env_guard;
 
 static ROCKSDB_NAMESPACE::Env* FLAGS_env = ROCKSDB_NAMESPACE::Env::Default();
@@ -1181,6 +1349,11 @@ DEFINE_bool(
     "Enable the unordered write feature, which provides higher throughput but "
     "relaxes the guarantees around atomic reads and immutable snapshots");
 
+DEFINE_bool(enable_no_wal_write_fast_path,
+            ROCKSDB_NAMESPACE::Options().enable_no_wal_write_fast_path,
+            "Let writes with disable_wal skip the write thread and insert "
+            "into the memtables concurrently");
+
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
@@ -1209,6 +1382,21 @@ DEFINE_uint64(write_thread_slow_yield_usec, 3,
               "The threshold at which a slow yield is considered a signal that "
               "other processes or threads want the core.");
 
+DEFINE_uint32(write_thread_spinners_per_core,
+              ROCKSDB_NAMESPACE::Options().write_thread_spinners_per_core,
+              "Maximum number of writer threads per core that may spin while "
+              "waiting for the write group leader. 0 means no limit.");
+
+DEFINE_uint64(memtable_batch_sort_threshold,
+              ROCKSDB_NAMESPACE::Options().memtable_batch_sort_threshold,
+              "Write batches with at least this many entries are sorted by "
+              "key before memtable insertion. 0 disables sorting.");
+
+DEFINE_uint32(wal_recovery_threads,
+              ROCKSDB_NAMESPACE::Options().wal_recovery_threads,
+              "Number of threads inserting the write batches replayed from "
+              "the WAL into the memtables when the DB is opened.");
+
 DEFINE_int32(rate_limit_delay_max_milliseconds, 1000,
              "When hard_rate_limit is set then this is the max time a put will"
              " be stalled.");
@@ -1313,10 +1501,47 @@ DEFINE_uint64(
     "If non-zero, db_bench will rate-limit the reads from RocksDB. This "
     "is the global rate in ops/second.");
 
+DEFINE_uint64(
+    open_loop_ops_per_sec, 0,
+    "If non-zero, runs the fill and overwrite benchmarks, readrandom, "
+    "multireadrandom, seekrandom, readrandomwriterandom and updaterandom "
+    "open-loop: operations arrive at this global rate, split evenly among "
+    "the threads, however long earlier operations took, and their latency "
+    "is measured from when they were meant to start. This avoids the "
+    "coordinated omission of the default closed loop, where a stalled DB "
+    "gets fewer requests and hides the stall from the latency histograms. "
+    "Implies --histogram.");
+
+DEFINE_string(open_loop_arrival, "poisson",
+              "How operations arrive with --open_loop_ops_per_sec: "
+              "\"poisson\" for exponentially distributed gaps between "
+              "them, or \"uniform\" for a fixed gap.");
+
+DEFINE_string(
+    open_loop_arrival_file, "",
+    "If set, runs the benchmarks listed for --open_loop_ops_per_sec "
+    "open-loop with the arrival times in this file, e.g. derived from a "
+    "production trace, rather than at a fixed rate. The file holds one "
+    "time in microseconds per line, in increasing order; the threads take "
+    "turns at them, and start over once they run out. Implies --histogram.");
+
+DEFINE_string(
+    hdr_histogram_file_prefix, "",
+    "If set, writes the latency histogram of every benchmark and operation "
+    "type to <prefix><benchmark>.<operation>.hgrm, in the percentile "
+    "distribution format of HdrHistogram, for its plotting tools. Values "
+    "are in microseconds, interpolated within the buckets of the "
+    "histogram. Requires --histogram or open-loop mode.");
+
 DEFINE_uint64(max_compaction_bytes,
               ROCKSDB_NAMESPACE::Options().max_compaction_bytes,
               "Max bytes allowed in one compaction");
 
+DEFINE_bool(level_compaction_dynamic_file_size,
+            ROCKSDB_NAMESPACE::Options().level_compaction_dynamic_file_size,
+            "Cut leveled compaction output files at boundaries of the files "
+            "in the level below the output level.");
+
 #ifndef ROCKSDB_LITE
 DEFINE_bool(readonly, false, "Run read only benchmarks.");
 
@@ -1344,6 +1569,19 @@ DEFINE_bool(use_direct_io_for_flush_and_compaction,
             ROCKSDB_NAMESPACE::Options().use_direct_io_for_flush_and_compaction,
             "Use O_DIRECT for background flush and compaction writes");
 
+DEFINE_bool(use_async_writes_for_flush_and_compaction,
+            ROCKSDB_NAMESPACE::Options()
+                .use_async_writes_for_flush_and_compaction,
+            "Keep several writes of flush and compaction output files in "
+            "flight");
+
+DEFINE_bool(use_direct_io_for_wal,
+            ROCKSDB_NAMESPACE::Options().use_direct_io_for_wal,
+            "Use O_DIRECT and O_DSYNC for WAL writes");
+
+DEFINE_bool(use_pmem_for_wal, ROCKSDB_NAMESPACE::Options().use_pmem_for_wal,
+            "Memory map WAL files, with MAP_SYNC on a DAX file system");
+
 DEFINE_bool(advise_random_on_open,
             ROCKSDB_NAMESPACE::Options().advise_random_on_open,
             "Advise random access on table file open");
@@ -1356,6 +1594,10 @@ static auto FLAGS_compaction_fadvice_e =
 DEFINE_bool(use_tailing_iterator, false,
             "Use tailing iterator to access a series of keys instead of get");
 
+DEFINE_int32(iterator_batch_size, 0,
+             "If > 0, readseq reads through Iterator::NextBatch() with up to "
+             "this many entries per call instead of calling Next()");
+
 DEFINE_bool(use_adaptive_mutex, ROCKSDB_NAMESPACE::Options().use_adaptive_mutex,
             "Use adaptive mutex");
 
@@ -1447,11 +1689,22 @@ DEFINE_int64(multiread_stride, 0,
              "Stride length for the keys in a MultiGet batch");
 DEFINE_bool(multiread_batched, false, "Use the new MultiGet API");
 
+DEFINE_bool(async_io, false,
+            "Set ReadOptions.async_io for MultiGet, which prefetches the "
+            "blocks needed from all files of a level before reading them");
+
+DEFINE_uint64(min_memtable_value_size_to_pin,
+              ROCKSDB_NAMESPACE::ReadOptions().min_memtable_value_size_to_pin,
+              "Set ReadOptions.min_memtable_value_size_to_pin for readrandom "
+              "and multireadrandom: memtable values at least this large are "
+              "pinned instead of copied");
+
 enum RepFactory {
   kSkipList,
   kPrefixHash,
   kVectorRep,
   kHashLinkedList,
+  kHashIndexedSkipList,
 };
 
 static enum RepFactory StringToRepFactory(const char* ctype) {
@@ -1465,6 +1718,8 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
     return kVectorRep;
   else if (!strcasecmp(ctype, "hash_linkedlist"))
     return kHashLinkedList;
+  else if (!strcasecmp(ctype, "hash_indexed_skip_list"))
+    return kHashIndexedSkipList;
 
   fprintf(stdout, "Cannot parse memreptable %s\n", ctype);
   return kSkipList;
@@ -1480,6 +1735,12 @@ DEFINE_double(cuckoo_hash_ratio, 0.9, "Hash ratio for Cuckoo SST table.");
 DEFINE_bool(use_hash_search, false, "if use kHashSearch "
             "instead of kBinarySearch. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(use_learned_index, false,
+            "if use kLearned instead of kBinarySearch. "
+            "This is valid if only we use BlockTable");
+DEFINE_bool(use_elias_fano_index, false,
+            "if use kEliasFano instead of kBinarySearch. "
+            "This is valid if only we use BlockTable");
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
@@ -2101,6 +2362,41 @@ static std::unordered_map<OperationType, std::string, std::hash<unsigned char>>
 };
 
 class CombinedStats;
+// Writes `hist` to `fname` in the percentile distribution format of
+// HdrHistogram, at the percentiles its tools report: five per halving of
+// the distance to 100%.
+static void WriteHdrHistogram(const std::string& fname,
+                              const HistogramImpl& hist) {
+  FILE* file = fopen(fname.c_str(), "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Failed to open %s\n", fname.c_str());
+    return;
+  }
+  const uint64_t count = hist.num();
+  fprintf(file, "%12s %14s %10s %14s\n\n", "Value", "Percentile",
+          "TotalCount", "1/(1-Percentile)");
+  const int kTicksPerHalfDistance = 5;
+  for (int i = 0; count > 0; i++) {
+    const double percentile =
+        1.0 - std::pow(0.5, static_cast<double>(i) / kTicksPerHalfDistance);
+    const uint64_t total =
+        std::min(count, static_cast<uint64_t>(std::ceil(percentile * count)));
+    if (total == count) {
+      fprintf(file, "%12.3f %2.12f %10" PRIu64 "\n",
+              static_cast<double>(hist.max()), 1.0, count);
+      break;
+    }
+    fprintf(file, "%12.3f %2.12f %10" PRIu64 " %14.2f\n",
+            hist.Percentile(percentile * 100), percentile, total,
+            1.0 / (1.0 - percentile));
+  }
+  fprintf(file, "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n",
+          hist.Average(), hist.StandardDeviation());
+  fprintf(file, "#[Max     = %12.3f, Total count    = %12" PRIu64 "]\n",
+          static_cast<double>(hist.max()), count);
+  fclose(file);
+}
+
 class Stats {
  private:
   SystemClock* clock_;
@@ -2115,6 +2411,9 @@ class Stats {
   uint64_t bytes_;
   uint64_t last_op_finish_;
   uint64_t last_report_finish_;
+  // When the next finished operation was meant to start in open-loop mode,
+  // or 0
+  uint64_t intended_start_ = 0;
   std::unordered_map<OperationType, std::shared_ptr<HistogramImpl>,
                      std::hash<unsigned char>> hist_;
   std::string message_;
@@ -2227,6 +2526,10 @@ class Stats {
     last_op_finish_ = clock_->NowMicros();
   }
 
+  // Has the latency of the next finished operation measured from `micros`,
+  // when it was meant to start, rather than from the previous one
+  void SetIntendedStart(uint64_t micros) { intended_start_ = micros; }
+
   void FinishedOps(DBWithColumnFamilies* db_with_cfh, DB* db, int64_t num_ops,
                    enum OperationType op_type = kOthers) {
     if (reporter_agent_) {
@@ -2234,7 +2537,9 @@ class Stats {
     }
     if (FLAGS_histogram) {
       uint64_t now = clock_->NowMicros();
-      uint64_t micros = now - last_op_finish_;
+      uint64_t micros =
+          now - (intended_start_ != 0 ? intended_start_ : last_op_finish_);
+      intended_start_ = 0;
 
       if (hist_.find(op_type) == hist_.end())
       {
@@ -2373,6 +2678,11 @@ class Stats {
         fprintf(stdout, "Microseconds per %s:\n%s\n",
                 OperationTypeString[it->first].c_str(),
                 it->second->ToString().c_str());
+        if (!FLAGS_hdr_histogram_file_prefix.empty()) {
+          WriteHdrHistogram(FLAGS_hdr_histogram_file_prefix + name.ToString() +
+                                "." + OperationTypeString[it->first] + ".hgrm",
+                            *it->second);
+        }
       }
     }
     if (FLAGS_report_file_operations) {
@@ -2526,15 +2836,93 @@ struct SharedState {
   SharedState() : cv(&mu), perf_level(FLAGS_perf_level) { }
 };
 
+// Decides when the operations of a thread arrive in open-loop mode, see
+// --open_loop_ops_per_sec. The arrival times only depend on the time of the
+// first arrival, so operations that are late do not delay the later ones.
+class OpenLoopArrivals {
+ public:
+  // Operations arrive at `ops_per_sec` if `trace` is empty, or else at the
+  // times `trace`[first], `trace`[first + step], ...
+  OpenLoopArrivals(SystemClock* clock, uint64_t seed, double ops_per_sec,
+                   const std::vector<uint64_t>* trace, size_t first,
+                   size_t step)
+      : clock_(clock),
+        rand_(seed),
+        poisson_(!strcasecmp(FLAGS_open_loop_arrival.c_str(), "poisson")),
+        mean_gap_micros_(ops_per_sec > 0 ? 1e6 / ops_per_sec : 0),
+        trace_(trace),
+        next_index_(first),
+        step_(step) {}
+
+  // Sleeps until the next operation arrives, if it has not already, and
+  // returns when it did
+  uint64_t Wait() {
+    const uint64_t now = clock_->NowMicros();
+    if (start_ == 0) {
+      start_ = now;
+    }
+    const uint64_t arrival = start_ + static_cast<uint64_t>(NextOffset());
+    if (arrival > now) {
+      clock_->SleepForMicroseconds(static_cast<int>(arrival - now));
+    }
+    return arrival;
+  }
+
+ private:
+  // Microseconds from the first arrival to the next one
+  double NextOffset() {
+    if (trace_ == nullptr || trace_->empty()) {
+      const double offset = offset_;
+      double gap = mean_gap_micros_;
+      if (poisson_) {
+        // Uniform in (0, 1]
+        const double u = (static_cast<double>(rand_.Next() >> 11) + 1) /
+                         9007199254740992.0;
+        gap = -std::log(u) * mean_gap_micros_;
+      }
+      offset_ += gap;
+      return offset;
+    }
+    // Replays the trace again once it runs out, shifted by its span
+    const size_t n = trace_->size();
+    const uint64_t span = trace_->back() - trace_->front() + 1;
+    const double offset =
+        static_cast<double>(next_index_ / n) * span +
+        static_cast<double>((*trace_)[next_index_ % n] - trace_->front());
+    next_index_ += step_;
+    return offset;
+  }
+
+  SystemClock* clock_;
+  Random64 rand_;
+  const bool poisson_;
+  const double mean_gap_micros_;
+  const std::vector<uint64_t>* trace_;
+  size_t next_index_;
+  const size_t step_;
+  uint64_t start_ = 0;
+  double offset_ = 0;
+};
+
 // Per-thread state for concurrent executions of the same benchmark.
 struct ThreadState {
   int tid;             // 0..n-1 when running in n threads
   Random64 rand;         // Has different seeds for different threads
   Stats stats;
   SharedState* shared;
+  // Only in open-loop mode
+  std::unique_ptr<OpenLoopArrivals> open_loop;
 
   explicit ThreadState(int index)
       : tid(index), rand((FLAGS_seed ? FLAGS_seed : 1000) + index) {}
+
+  // In open-loop mode, waits for the next operation to arrive, and has its
+  // latency measured from then
+  void WaitForArrival() {
+    if (open_loop != nullptr) {
+      stats.SetIntendedStart(open_loop->Wait());
+    }
+  }
 };
 
 class Duration {
@@ -2575,6 +2963,43 @@ class Duration {
   uint64_t start_at_;
 };
 
+#ifndef ROCKSDB_LITE
+// Opens the read cache in FLAGS_read_cache_path, exiting on failure.
+static std::shared_ptr<PersistentCache> NewReadCache() {
+  Status rc_status;
+
+  // Read cache need to be provided with a the Logger, we will put all
+  // reac cache logs in the read cache path in a file named rc_LOG
+  rc_status = FLAGS_env->CreateDirIfMissing(FLAGS_read_cache_path);
+  std::shared_ptr<Logger> read_cache_logger;
+  if (rc_status.ok()) {
+    rc_status = FLAGS_env->NewLogger(FLAGS_read_cache_path + "/rc_LOG",
+                                     &read_cache_logger);
+  }
+
+  std::shared_ptr<BlockCacheTier> pcache;
+  if (rc_status.ok()) {
+    PersistentCacheConfig rc_cfg(FLAGS_env, FLAGS_read_cache_path,
+                                 FLAGS_read_cache_size, read_cache_logger);
+
+    rc_cfg.enable_direct_reads = FLAGS_read_cache_direct_read;
+    rc_cfg.enable_direct_writes = FLAGS_read_cache_direct_write;
+    rc_cfg.writer_qdepth = 4;
+    rc_cfg.writer_dispatch_size = 4 * 1024;
+
+    pcache = std::make_shared<BlockCacheTier>(rc_cfg);
+    rc_status = pcache->Open();
+  }
+
+  if (!rc_status.ok()) {
+    fprintf(stderr, "Error initializing read cache, %s\n",
+            rc_status.ToString().c_str());
+    exit(1);
+  }
+  return pcache;
+}
+#endif  // ROCKSDB_LITE
+
 class Benchmark {
  private:
   std::shared_ptr<Cache> cache_;
@@ -2745,6 +3170,9 @@ class Benchmark {
       case kHashLinkedList:
         fprintf(stdout, "Memtablerep: hash_linkedlist\n");
         break;
+      case kHashIndexedSkipList:
+        fprintf(stdout, "Memtablerep: hash_indexed_skip_list\n");
+        break;
     }
     fprintf(stdout, "Perf Level: %d\n", FLAGS_perf_level);
 
@@ -2927,8 +3355,10 @@ class Benchmark {
       return nullptr;
     }
     if (FLAGS_use_clock_cache) {
-      auto cache = NewClockCache(static_cast<size_t>(capacity),
-                                 FLAGS_cache_numshardbits);
+      auto cache = NewClockCache(
+          static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
+          false /*strict_capacity_limit*/, kDefaultCacheMetadataChargePolicy,
+          static_cast<size_t>(FLAGS_block_size) /*estimated_entry_charge*/);
       if (!cache) {
         fprintf(stderr, "Clock cache not supported.");
         exit(1);
@@ -2946,12 +3376,23 @@ class Benchmark {
           nullptr
 #endif
       );
+      opts.use_frequency_admission = FLAGS_cache_frequency_admission;
+      opts.lock_free_lookup = FLAGS_cache_lock_free_lookup;
       if (FLAGS_use_cache_memkind_kmem_allocator) {
 #ifndef MEMKIND
         fprintf(stderr, "Memkind library is not linked with the binary.");
         exit(1);
 #endif
       }
+      if (FLAGS_use_cache_slab_allocator) {
+        if (FLAGS_use_cache_memkind_kmem_allocator) {
+          fprintf(stderr,
+                  "--use_cache_slab_allocator and "
+                  "--use_cache_memkind_kmem_allocator are exclusive\n");
+          exit(1);
+        }
+        opts.memory_allocator = NewSlabAllocator();
+      }
 #ifndef ROCKSDB_LITE
       if (!FLAGS_secondary_cache_uri.empty()) {
         Status s = SecondaryCache::CreateFromString(
@@ -2964,6 +3405,12 @@ class Benchmark {
           exit(1);
         }
         opts.secondary_cache = secondary_cache;
+      } else if (FLAGS_read_cache_as_secondary_cache &&
+                 !FLAGS_read_cache_path.empty()) {
+        if (secondary_cache == nullptr) {
+          secondary_cache = NewPersistentCacheSecondaryCache(NewReadCache());
+        }
+        opts.secondary_cache = secondary_cache;
       }
 #endif  // ROCKSDB_LITE
       return NewLRUCache(opts);
@@ -3005,6 +3452,21 @@ class Benchmark {
         cache_ = NewSimCache(cache_, FLAGS_simcache_size, 0);
       }
     }
+    if (FLAGS_cache_miss_ratio_curve_sampling_rate > 0.0 && cache_) {
+      if (FLAGS_simcache_size >= 0) {
+        fprintf(stderr,
+                "--cache_miss_ratio_curve_sampling_rate and --simcache_size "
+                "cannot be combined\n");
+        exit(1);
+      }
+      MissRatioCurveCacheOptions mrc_options;
+      mrc_options.sampling_rate = FLAGS_cache_miss_ratio_curve_sampling_rate;
+      cache_ = NewMissRatioCurveCache(cache_, mrc_options);
+      if (!cache_) {
+        fprintf(stderr, "Invalid --cache_miss_ratio_curve_sampling_rate\n");
+        exit(1);
+      }
+    }
 
     if (report_file_operations_) {
       if (!FLAGS_hdfs.empty()) {
@@ -3434,6 +3896,8 @@ class Benchmark {
         method = &Benchmark::Crc32c;
       } else if (name == "xxhash") {
         method = &Benchmark::xxHash;
+      } else if (name == "xxh3") {
+        method = &Benchmark::XXH3;
       } else if (name == "acquireload") {
         method = &Benchmark::AcquireLoad;
       } else if (name == "compress") {
@@ -3644,6 +4108,12 @@ class Benchmark {
           stdout, "SIMULATOR CACHE STATISTICS:\n%s\n",
           static_cast_with_check<SimCache>(cache_.get())->ToString().c_str());
     }
+    if (FLAGS_cache_miss_ratio_curve_sampling_rate > 0.0 && cache_) {
+      fprintf(stdout, "BLOCK CACHE MISS RATIO CURVE:\n%s\n",
+              static_cast_with_check<MissRatioCurveCache>(cache_.get())
+                  ->ToString()
+                  .c_str());
+    }
 
 #ifndef ROCKSDB_LITE
     if (FLAGS_use_secondary_db) {
@@ -3720,6 +4190,31 @@ class Benchmark {
                                              FLAGS_report_interval_seconds));
     }
 
+    std::vector<uint64_t> arrivals;
+    if (!FLAGS_open_loop_arrival_file.empty()) {
+      std::string data;
+      Status s =
+          ReadFileToString(FLAGS_env, FLAGS_open_loop_arrival_file, &data);
+      if (!s.ok()) {
+        fprintf(stderr, "Failed to read %s: %s\n",
+                FLAGS_open_loop_arrival_file.c_str(), s.ToString().c_str());
+        exit(1);
+      }
+      for (const std::string& line : StringSplit(data, '\n')) {
+        if (!line.empty()) {
+          arrivals.push_back(ParseUint64(line));
+        }
+      }
+      if (arrivals.empty() ||
+          !std::is_sorted(arrivals.begin(), arrivals.end())) {
+        fprintf(stderr, "No increasing arrival times in %s\n",
+                FLAGS_open_loop_arrival_file.c_str());
+        exit(1);
+      }
+    }
+    const bool open_loop =
+        FLAGS_open_loop_ops_per_sec > 0 || !arrivals.empty();
+
     ThreadArg* arg = new ThreadArg[n];
 
     for (int i = 0; i < n; i++) {
@@ -3746,6 +4241,13 @@ class Benchmark {
       arg[i].thread = new ThreadState(i);
       arg[i].thread->stats.SetReporterAgent(reporter_agent.get());
       arg[i].thread->shared = &shared;
+      if (open_loop) {
+        arg[i].thread->open_loop.reset(new OpenLoopArrivals(
+            FLAGS_env->GetSystemClock().get(),
+            (FLAGS_seed ? FLAGS_seed : 1000) + n + i,
+            static_cast<double>(FLAGS_open_loop_ops_per_sec) / n, &arrivals,
+            i, n));
+      }
       FLAGS_env->StartThread(ThreadBody, &arg[i]);
     }
 
@@ -3816,6 +4318,27 @@ class Benchmark {
     thread->stats.AddMessage(label);
   }
 
+  void XXH3(ThreadState* thread) {
+    // Checksum about 500MB of data total
+    const int size = FLAGS_block_size;  // use --block_size option for db_bench
+    std::string labels = "(" + ToString(FLAGS_block_size) + " per op)";
+    const char* label = labels.c_str();
+
+    std::string data(size, 'x');
+    int64_t bytes = 0;
+    uint32_t checksum = 0;
+    while (bytes < 500 * 1048576) {
+      checksum = ComputeXXH3Checksum(data.data(), size, kNoCompression);
+      thread->stats.FinishedOps(nullptr, nullptr, 1, kHash);
+      bytes += size;
+    }
+    // Print so result is not dead
+    fprintf(stderr, "... xxh3=0x%x\r", static_cast<unsigned int>(checksum));
+
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(label);
+  }
+
   void AcquireLoad(ThreadState* thread) {
     int dummy;
     std::atomic<void*> ap(&dummy);
@@ -3948,6 +4471,8 @@ class Benchmark {
     options.max_write_buffer_size_to_maintain =
         FLAGS_max_write_buffer_size_to_maintain;
     options.max_background_jobs = FLAGS_max_background_jobs;
+    options.prioritize_stall_relieving_work =
+        FLAGS_prioritize_stall_relieving_work;
     options.max_background_compactions = FLAGS_max_background_compactions;
     options.max_subcompactions = static_cast<uint32_t>(FLAGS_subcompactions);
     options.max_background_flushes = FLAGS_max_background_flushes;
@@ -3958,11 +4483,17 @@ class Benchmark {
     options.use_direct_reads = FLAGS_use_direct_reads;
     options.use_direct_io_for_flush_and_compaction =
         FLAGS_use_direct_io_for_flush_and_compaction;
+    options.use_async_writes_for_flush_and_compaction =
+        FLAGS_use_async_writes_for_flush_and_compaction;
+    options.use_direct_io_for_wal = FLAGS_use_direct_io_for_wal;
+    options.use_pmem_for_wal = FLAGS_use_pmem_for_wal;
 #ifndef ROCKSDB_LITE
     options.ttl = FLAGS_fifo_compaction_ttl;
     options.compaction_options_fifo = CompactionOptionsFIFO(
         FLAGS_fifo_compaction_max_table_files_size_mb * 1024 * 1024,
         FLAGS_fifo_compaction_allow_compaction);
+    options.compaction_options_fifo.time_window_seconds =
+        FLAGS_fifo_compaction_time_window_seconds;
 #endif  // ROCKSDB_LITE
     if (FLAGS_prefix_size != 0) {
       options.prefix_extractor.reset(
@@ -3981,6 +4512,12 @@ class Benchmark {
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
     options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
+    options.memtable_hot_key_cache_size =
+        static_cast<size_t>(FLAGS_memtable_hot_key_cache_size);
+    options.memtable_large_value_threshold =
+        static_cast<size_t>(FLAGS_memtable_large_value_threshold);
+    options.max_adaptive_write_buffer_size =
+        static_cast<size_t>(FLAGS_max_adaptive_write_buffer_size);
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
       options.memtable_insert_with_hint_prefix_extractor.reset(
           NewCappedPrefixTransform(
@@ -3988,9 +4525,16 @@ class Benchmark {
     }
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
+    options.open_table_files_in_background =
+        FLAGS_open_table_files_in_background;
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
+    options.max_compaction_readahead_size =
+        FLAGS_max_compaction_readahead_size;
+    options.pipelined_compaction_io = FLAGS_pipelined_compaction_io;
+    options.compaction_copy_unchanged_blocks =
+        FLAGS_compaction_copy_unchanged_blocks;
     options.log_readahead_size = FLAGS_log_readahead_size;
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
     options.writable_file_max_buffer_size = FLAGS_writable_file_max_buffer_size;
@@ -4023,6 +4567,10 @@ class Benchmark {
         options.memtable_factory.reset(NewHashLinkListRepFactory(
             FLAGS_hash_bucket_count));
         break;
+      case kHashIndexedSkipList:
+        options.memtable_factory.reset(
+            NewHashIndexedSkipListRepFactory(FLAGS_hash_bucket_count));
+        break;
       case kVectorRep:
         options.memtable_factory.reset(
           new VectorRepFactory
@@ -4086,6 +4634,10 @@ class Benchmark {
           exit(1);
         }
         block_based_options.index_type = BlockBasedTableOptions::kHashSearch;
+      } else if (FLAGS_use_learned_index) {
+        block_based_options.index_type = BlockBasedTableOptions::kLearned;
+      } else if (FLAGS_use_elias_fano_index) {
+        block_based_options.index_type = BlockBasedTableOptions::kEliasFano;
       } else {
         block_based_options.index_type = BlockBasedTableOptions::kBinarySearch;
       }
@@ -4130,6 +4682,14 @@ class Benchmark {
       }
       block_based_options.optimize_filters_for_memory =
           FLAGS_optimize_filters_for_memory;
+      block_based_options.reserve_table_builder_memory =
+          FLAGS_reserve_table_builder_memory;
+      block_based_options.range_filter_prefix_len =
+          static_cast<size_t>(FLAGS_range_filter_prefix_len);
+      block_based_options.multiget_decompression_threads =
+          FLAGS_multiget_decompression_threads;
+      block_based_options.key_position_samples = FLAGS_key_position_samples;
+      block_based_options.adaptive_compression = FLAGS_adaptive_compression;
       block_based_options.index_shortening = index_shortening;
       if (cache_ == nullptr) {
         block_based_options.no_block_cache = true;
@@ -4140,6 +4700,7 @@ class Benchmark {
           FLAGS_pin_l0_filter_and_index_blocks_in_cache;
       block_based_options.pin_top_level_index_and_filter =
           FLAGS_pin_top_level_index_and_filter;
+      block_based_options.compact_table_reader = FLAGS_compact_table_reader;
       if (FLAGS_cache_high_pri_pool_ratio > 1e-6) {  // > 0.0 + eps
         block_based_options.cache_index_and_filter_blocks_with_high_priority =
             true;
@@ -4152,6 +4713,14 @@ class Benchmark {
           FLAGS_index_block_restart_interval;
       block_based_options.format_version =
           static_cast<uint32_t>(FLAGS_format_version);
+      auto checksum_type_it =
+          checksum_type_string_map.find(FLAGS_checksum_type);
+      if (checksum_type_it == checksum_type_string_map.end()) {
+        fprintf(stderr, "Cannot parse checksum type '%s'\n",
+                FLAGS_checksum_type.c_str());
+        exit(1);
+      }
+      block_based_options.checksum = checksum_type_it->second;
       block_based_options.read_amp_bytes_per_bit = FLAGS_read_amp_bytes_per_bit;
       block_based_options.enable_index_compression =
           FLAGS_enable_index_compression;
@@ -4180,39 +4749,12 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
-      if (FLAGS_read_cache_path != "") {
+      block_based_options.wide_data_block_hash_index =
+          FLAGS_wide_data_block_hash_index;
+      if (FLAGS_read_cache_path != "" &&
+          !FLAGS_read_cache_as_secondary_cache) {
 #ifndef ROCKSDB_LITE
-        Status rc_status;
-
-        // Read cache need to be provided with a the Logger, we will put all
-        // reac cache logs in the read cache path in a file named rc_LOG
-        rc_status = FLAGS_env->CreateDirIfMissing(FLAGS_read_cache_path);
-        std::shared_ptr<Logger> read_cache_logger;
-        if (rc_status.ok()) {
-          rc_status = FLAGS_env->NewLogger(FLAGS_read_cache_path + "/rc_LOG",
-                                           &read_cache_logger);
-        }
-
-        if (rc_status.ok()) {
-          PersistentCacheConfig rc_cfg(FLAGS_env, FLAGS_read_cache_path,
-                                       FLAGS_read_cache_size,
-                                       read_cache_logger);
-
-          rc_cfg.enable_direct_reads = FLAGS_read_cache_direct_read;
-          rc_cfg.enable_direct_writes = FLAGS_read_cache_direct_write;
-          rc_cfg.writer_qdepth = 4;
-          rc_cfg.writer_dispatch_size = 4 * 1024;
-
-          auto pcache = std::make_shared<BlockCacheTier>(rc_cfg);
-          block_based_options.persistent_cache = pcache;
-          rc_status = pcache->Open();
-        }
-
-        if (!rc_status.ok()) {
-          fprintf(stderr, "Error initializing read cache, %s\n",
-                  rc_status.ToString().c_str());
-          exit(1);
-        }
+        block_based_options.persistent_cache = NewReadCache();
 #else
         fprintf(stderr, "Read cache is not supported in LITE\n");
         exit(1);
@@ -4242,6 +4784,7 @@ class Benchmark {
     if (FLAGS_simulate_hybrid_fs_file != "") {
       options.bottommost_temperature = Temperature::kWarm;
     }
+    options.bottommost_hot_file_read_rate = FLAGS_bottommost_hot_file_read_rate;
     options.sample_for_compression = FLAGS_sample_for_compression;
     options.WAL_ttl_seconds = FLAGS_wal_ttl_seconds;
     options.WAL_size_limit_MB = FLAGS_wal_size_limit_MB;
@@ -4276,14 +4819,24 @@ class Benchmark {
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
     options.unordered_write = FLAGS_unordered_write;
+    options.enable_no_wal_write_fast_path = FLAGS_enable_no_wal_write_fast_path;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
+    options.write_thread_spinners_per_core =
+        FLAGS_write_thread_spinners_per_core;
+    options.memtable_batch_sort_threshold =
+        static_cast<size_t>(FLAGS_memtable_batch_sort_threshold);
+    options.wal_recovery_threads = FLAGS_wal_recovery_threads;
     options.rate_limit_delay_max_milliseconds =
       FLAGS_rate_limit_delay_max_milliseconds;
     options.table_cache_numshardbits = FLAGS_table_cache_numshardbits;
     options.max_compaction_bytes = FLAGS_max_compaction_bytes;
+    options.level_compaction_dynamic_file_size =
+        FLAGS_level_compaction_dynamic_file_size;
     options.disable_auto_compactions = FLAGS_disable_auto_compactions;
     options.optimize_filters_for_hits = FLAGS_optimize_filters_for_hits;
+    options.skip_filters_after_unhelpful_checks =
+        FLAGS_skip_filters_after_unhelpful_checks;
     options.periodic_compaction_seconds = FLAGS_periodic_compaction_seconds;
 
     // fill storage options
@@ -4327,6 +4880,8 @@ class Benchmark {
     }
     options.compaction_options_universal.allow_trivial_move =
         FLAGS_universal_allow_trivial_move;
+    options.compaction_options_universal.incremental =
+        FLAGS_universal_incremental;
     if (FLAGS_thread_status_per_interval > 0) {
       options.enable_thread_tracking = true;
     }
@@ -4345,10 +4900,19 @@ class Benchmark {
     options.blob_file_size = FLAGS_blob_file_size;
     options.blob_compression_type =
         StringToCompressionType(FLAGS_blob_compression_type.c_str());
+    options.blob_compression_max_dict_bytes =
+        FLAGS_blob_compression_max_dict_bytes;
+    options.blob_compression_parallel_threads =
+        FLAGS_blob_compression_parallel_threads;
     options.enable_blob_garbage_collection =
         FLAGS_enable_blob_garbage_collection;
     options.blob_garbage_collection_age_cutoff =
         FLAGS_blob_garbage_collection_age_cutoff;
+    options.blob_garbage_collection_force_threshold =
+        FLAGS_blob_garbage_collection_force_threshold;
+    options.cold_blob_file_size = FLAGS_cold_blob_file_size;
+    options.use_direct_reads_for_blob_files =
+        FLAGS_use_direct_reads_for_blob_files;
 
 #ifndef ROCKSDB_LITE
     if (FLAGS_readonly && FLAGS_transaction_db) {
@@ -4388,6 +4952,8 @@ class Benchmark {
         FLAGS_compression_parallel_threads;
     options.compression_opts.max_dict_buffer_bytes =
         FLAGS_compression_max_dict_buffer_bytes;
+    options.compression_opts.max_dict_reuse_seconds =
+        FLAGS_compression_max_dict_reuse_seconds;
     // If this is a block based table, set some related options
     auto table_options =
         options.table_factory->GetOptions<BlockBasedTableOptions>();
@@ -5094,6 +5660,7 @@ class Benchmark {
         // once per write.
         thread->stats.ResetLastOpTime();
       }
+      thread->WaitForArrival();
       if (user_timestamp_size_ > 0) {
         Slice user_ts = mock_app_clock_->Allocate(ts_guard.get());
         s = batch.AssignTimestamp(user_ts);
@@ -5482,16 +6049,46 @@ class Benchmark {
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
     int64_t bytes = 0;
-    for (iter->SeekToFirst(); i < reads_ && iter->Valid(); iter->Next()) {
-      bytes += iter->key().size() + iter->value().size();
-      thread->stats.FinishedOps(nullptr, db, 1, kRead);
-      ++i;
+    if (FLAGS_iterator_batch_size > 0) {
+      std::vector<Slice> keys;
+      std::vector<Slice> values;
+      std::string buf;
+      iter->SeekToFirst();
+      while (i < reads_ && iter->Valid()) {
+        size_t batch_size = static_cast<size_t>(
+            std::min<int64_t>(FLAGS_iterator_batch_size, reads_ - i));
+        Status s = iter->NextBatch(batch_size, 0 /* max_bytes */, &keys,
+                                   &values, &buf);
+        if (!s.ok()) {
+          fprintf(stderr, "NextBatch failed: %s\n", s.ToString().c_str());
+          abort();
+        }
+        for (size_t j = 0; j < keys.size(); ++j) {
+          bytes += keys[j].size() + values[j].size();
+        }
+        int64_t n = static_cast<int64_t>(keys.size());
+        thread->stats.FinishedOps(nullptr, db, n, kRead);
+        int64_t prev = i;
+        i += n;
+        if (thread->shared->read_rate_limiter.get() != nullptr &&
+            i / 1024 != prev / 1024) {
+          thread->shared->read_rate_limiter->Request(
+              1024 * (i / 1024 - prev / 1024), Env::IO_HIGH,
+              nullptr /* stats */, RateLimiter::OpType::kRead);
+        }
+      }
+    } else {
+      for (iter->SeekToFirst(); i < reads_ && iter->Valid(); iter->Next()) {
+        bytes += iter->key().size() + iter->value().size();
+        thread->stats.FinishedOps(nullptr, db, 1, kRead);
+        ++i;
 
-      if (thread->shared->read_rate_limiter.get() != nullptr &&
-          i % 1024 == 1023) {
-        thread->shared->read_rate_limiter->Request(1024, Env::IO_HIGH,
-                                                   nullptr /* stats */,
-                                                   RateLimiter::OpType::kRead);
+        if (thread->shared->read_rate_limiter.get() != nullptr &&
+            i % 1024 == 1023) {
+          thread->shared->read_rate_limiter->Request(
+              1024, Env::IO_HIGH, nullptr /* stats */,
+              RateLimiter::OpType::kRead);
+        }
       }
     }
 
@@ -5686,6 +6283,8 @@ class Benchmark {
     int num_keys = 0;
     int64_t key_rand = 0;
     ReadOptions options(FLAGS_verify_checksum, true);
+    options.min_memtable_value_size_to_pin =
+        FLAGS_min_memtable_value_size_to_pin;
     std::unique_ptr<const char[]> key_guard;
     Slice key = AllocateKey(&key_guard);
     PinnableSlice pinnable_val;
@@ -5726,6 +6325,7 @@ class Benchmark {
       }
       Status s;
       pinnable_val.Reset();
+      thread->WaitForArrival();
       if (FLAGS_num_column_families > 1) {
         s = db_with_cfh->db->Get(options, db_with_cfh->GetCfh(key_rand), key,
                                  &pinnable_val, ts_ptr);
@@ -5772,6 +6372,9 @@ class Benchmark {
     int64_t num_multireads = 0;
     int64_t found = 0;
     ReadOptions options(FLAGS_verify_checksum, true);
+    options.async_io = FLAGS_async_io;
+    options.min_memtable_value_size_to_pin =
+        FLAGS_min_memtable_value_size_to_pin;
     std::vector<Slice> keys;
     std::vector<std::unique_ptr<const char[]> > key_guards;
     std::vector<std::string> values(entries_per_batch_);
@@ -5811,6 +6414,7 @@ class Benchmark {
         ts = mock_app_clock_->GetTimestampForRead(thread->rand, ts_guard.get());
         options.timestamp = &ts;
       }
+      thread->WaitForArrival();
       if (!FLAGS_multiread_batched) {
         std::vector<Status> statuses = db->MultiGet(options, keys, &values);
         assert(static_cast<int64_t>(statuses.size()) == entries_per_batch_);
@@ -6414,6 +7018,7 @@ class Benchmark {
         }
       }
 
+      thread->WaitForArrival();
       // Pick a Iterator to use
       size_t db_idx_to_use =
           (db_.db == nullptr)
@@ -6897,6 +7502,7 @@ class Benchmark {
     while (!duration.Done(1)) {
       DB* db = SelectDB(thread);
       GenerateKeyFromInt(thread->rand.Next() % FLAGS_num, FLAGS_num, &key);
+      thread->WaitForArrival();
       if (get_weight == 0 && put_weight == 0) {
         // one batch completed, reinitialize for next batch
         get_weight = FLAGS_readwritepercent;
@@ -6973,6 +7579,7 @@ class Benchmark {
         options.timestamp = &ts;
       }
 
+      thread->WaitForArrival();
       auto status = db->Get(options, key, &value);
       if (status.ok()) {
         ++found;
@@ -8005,13 +8612,31 @@ class Benchmark {
     }
     Replayer replayer(db_with_cfh->db, db_with_cfh->cfh,
                       std::move(trace_reader));
-    replayer.SetFastForward(
-        static_cast<uint32_t>(FLAGS_trace_replay_fast_forward));
+    if (FLAGS_trace_replay_speed > 0) {
+      s = replayer.SetReplaySpeed(FLAGS_trace_replay_speed);
+    } else {
+      s = replayer.SetFastForward(
+          static_cast<uint32_t>(FLAGS_trace_replay_fast_forward));
+    }
+    if (s.ok()) {
+      s = replayer.SetKeyspaceMultiplier(
+          static_cast<uint32_t>(FLAGS_trace_replay_keyspace_multiplier));
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Invalid trace replay options. Error: %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    if (!FLAGS_trace_replay_key_prefix_from.empty()) {
+      replayer.SetKeyPrefixRewrite(FLAGS_trace_replay_key_prefix_from,
+                                   FLAGS_trace_replay_key_prefix_to);
+    }
     s = replayer.MultiThreadReplay(
         static_cast<uint32_t>(FLAGS_trace_replay_threads));
     if (s.ok()) {
       fprintf(stdout, "Replay started from trace_file: %s\n",
               FLAGS_trace_file.c_str());
+      fprintf(stdout, "%s", replayer.GetLatencyReport().c_str());
     } else {
       fprintf(stderr, "Starting replay failed. Error: %s\n",
               s.ToString().c_str());
@@ -8156,6 +8781,18 @@ int db_bench_tool(int argc, char** argv) {
     exit(1);
   }
 
+  if (FLAGS_open_loop_ops_per_sec > 0 ||
+      !FLAGS_open_loop_arrival_file.empty()) {
+    if (strcasecmp(FLAGS_open_loop_arrival.c_str(), "poisson") &&
+        strcasecmp(FLAGS_open_loop_arrival.c_str(), "uniform")) {
+      fprintf(stderr, "Unknown --open_loop_arrival: %s\n",
+              FLAGS_open_loop_arrival.c_str());
+      exit(1);
+    }
+    // Open-loop latencies are only measured into the histograms
+    FLAGS_histogram = true;
+  }
+
   ROCKSDB_NAMESPACE::Benchmark benchmark;
   benchmark.Run();
 
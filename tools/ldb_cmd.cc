@@ -14,9 +14,11 @@
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
@@ -30,6 +32,7 @@
 #include "rocksdb/utilities/checkpoint.h"
 #include "rocksdb/utilities/debug.h"
 #include "rocksdb/utilities/options_util.h"
+#include "rocksdb/utilities/parallel_scan.h"
 #include "rocksdb/write_batch.h"
 #include "rocksdb/write_buffer_manager.h"
 #include "table/scoped_arena_iterator.h"
@@ -2637,6 +2640,8 @@ void BatchPutCommand::OverrideBaseOptions() {
 
 // ----------------------------------------------------------------------------
 
+const std::string ScanCommand::ARG_NUM_THREADS = "num_threads";
+
 ScanCommand::ScanCommand(const std::vector<std::string>& /*params*/,
                          const std::map<std::string, std::string>& options,
                          const std::vector<std::string>& flags)
@@ -2644,11 +2649,13 @@ ScanCommand::ScanCommand(const std::vector<std::string>& /*params*/,
           options, flags, true,
           BuildCmdLineOptions({ARG_TTL, ARG_NO_VALUE, ARG_HEX, ARG_KEY_HEX,
                                ARG_TO, ARG_VALUE_HEX, ARG_FROM, ARG_TIMESTAMP,
-                               ARG_MAX_KEYS, ARG_TTL_START, ARG_TTL_END})),
+                               ARG_MAX_KEYS, ARG_TTL_START, ARG_TTL_END,
+                               ARG_NUM_THREADS})),
       start_key_specified_(false),
       end_key_specified_(false),
       max_keys_scanned_(-1),
-      no_value_(false) {
+      no_value_(false),
+      num_threads_(1) {
   std::map<std::string, std::string>::const_iterator itr =
       options.find(ARG_FROM);
   if (itr != options.end()) {
@@ -2689,6 +2696,12 @@ ScanCommand::ScanCommand(const std::vector<std::string>& /*params*/,
           ARG_MAX_KEYS + " has a value out-of-range");
     }
   }
+
+  if (ParseIntOption(options, ARG_NUM_THREADS, num_threads_, exec_state_) &&
+      num_threads_ < 1) {
+    exec_state_ =
+        LDBCommandExecuteResult::Failed(ARG_NUM_THREADS + " must be >= 1");
+  }
 }
 
 void ScanCommand::Help(std::string& ret) {
@@ -2701,9 +2714,111 @@ void ScanCommand::Help(std::string& ret) {
   ret.append(" [--" + ARG_TTL_START + "=<N>:- is inclusive]");
   ret.append(" [--" + ARG_TTL_END + "=<N>:- is exclusive]");
   ret.append(" [--" + ARG_NO_VALUE + "]");
+  ret.append(" [--" + ARG_NUM_THREADS +
+             "=<N>:- scan N key ranges at a time unless --" + ARG_MAX_KEYS +
+             " is given]");
   ret.append("\n");
 }
 
+bool ScanCommand::AppendEntry(Iterator* it, int ttl_start, int ttl_end,
+                              std::string* out) const {
+  if (is_db_ttl_) {
+    TtlIterator* it_ttl = static_cast_with_check<TtlIterator>(it);
+    int rawtime = it_ttl->ttl_timestamp();
+    if (rawtime < ttl_start || rawtime >= ttl_end) {
+      return false;
+    }
+    if (timestamp_) {
+      out->append(TimeToHumanString(rawtime));
+      out->append(" ");
+    }
+  }
+
+  Slice key_slice = it->key();
+  if (is_key_hex_) {
+    out->append("0x" + key_slice.ToString(true /* hex */));
+  } else if (ldb_options_.key_formatter) {
+    out->append(ldb_options_.key_formatter->Format(key_slice));
+  } else {
+    out->append(key_slice.data(), key_slice.size());
+  }
+
+  if (!no_value_) {
+    out->append(" : ");
+    Slice val_slice = it->value();
+    if (is_value_hex_) {
+      out->append("0x" + val_slice.ToString(true /* hex */));
+    } else {
+      out->append(val_slice.data(), val_slice.size());
+    }
+  }
+  out->append("\n");
+  return true;
+}
+
+void ScanCommand::DoParallelScan(int ttl_start, int ttl_end) {
+  ReadOptions scan_read_opts;
+  scan_read_opts.total_order_seek = true;
+  Slice lower(start_key_);
+  Slice upper(end_key_);
+  if (start_key_specified_) {
+    scan_read_opts.iterate_lower_bound = &lower;
+  }
+  if (end_key_specified_) {
+    scan_read_opts.iterate_upper_bound = &upper;
+  }
+
+  // Output is printed in key order. The range whose turn it is prints as it
+  // goes; later ranges hold their output until every earlier range is done.
+  const size_t kFlushSize = 1 << 20;
+  const size_t num_ranges = static_cast<size_t>(num_threads_);
+  std::mutex mutex;
+  size_t next_to_print = 0;
+  std::vector<std::string> pending(num_ranges);
+  std::vector<bool> done(num_ranges, false);
+  auto print_done_ranges = [&]() {
+    while (next_to_print < num_ranges && done[next_to_print]) {
+      const std::string& out = pending[next_to_print];
+      fwrite(out.data(), 1, out.size(), stdout);
+      std::string().swap(pending[next_to_print]);
+      ++next_to_print;
+    }
+  };
+
+  Status s = ParallelScan(
+      db_, scan_read_opts, GetCfHandle(), num_ranges,
+      [&](size_t range_index, Iterator* it) {
+        std::string out;
+        bool printing = false;
+        for (; it->Valid(); it->Next()) {
+          AppendEntry(it, ttl_start, ttl_end, &out);
+          if (out.size() >= kFlushSize) {
+            if (!printing) {
+              std::lock_guard<std::mutex> lock(mutex);
+              printing = next_to_print == range_index;
+            }
+            if (printing) {
+              fwrite(out.data(), 1, out.size(), stdout);
+              out.clear();
+            }
+          }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        pending[range_index] = std::move(out);
+        done[range_index] = true;
+        print_done_ranges();
+        return Status::OK();
+      });
+  // A range that failed to start leaves the ones after it unprinted
+  for (size_t i = next_to_print; i < num_ranges; ++i) {
+    done[i] = true;
+  }
+  print_done_ranges();
+  if (!s.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(s.ToString());
+  }
+}
+
 void ScanCommand::DoCommand() {
   if (!db_) {
     assert(GetExecuteState().IsFailed());
@@ -2737,6 +2852,11 @@ void ScanCommand::DoCommand() {
             TimeToHumanString(ttl_start).c_str(),
             TimeToHumanString(ttl_end).c_str());
   }
+  if (num_threads_ > 1 && max_keys_scanned_ < 0) {
+    delete it;
+    DoParallelScan(ttl_start, ttl_end);
+    return;
+  }
   for ( ;
         it->Valid() && (!end_key_specified_ || it->key().ToString() < end_key_);
         it->Next()) {
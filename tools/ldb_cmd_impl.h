@@ -418,13 +418,23 @@ class ScanCommand : public LDBCommand {
 
   static void Help(std::string& ret);
 
+  static const std::string ARG_NUM_THREADS;
+
  private:
+  // Appends the line printed for the entry at `it` to `out`. Returns false,
+  // appending nothing, if the entry is outside [ttl_start, ttl_end).
+  bool AppendEntry(Iterator* it, int ttl_start, int ttl_end,
+                   std::string* out) const;
+  // Splits the scan over num_threads_ threads, printing in key order
+  void DoParallelScan(int ttl_start, int ttl_end);
+
   std::string start_key_;
   std::string end_key_;
   bool start_key_specified_;
   bool end_key_specified_;
   int max_keys_scanned_;
   bool no_value_;
+  int num_threads_;
 };
 
 class DeleteCommand : public LDBCommand {
@@ -127,6 +127,10 @@ class LDBTestCase(unittest.TestCase):
                 "x1 : y1\nx2 : y2\nx3 : y3")
         self.assertRunOK("scan --from=x1 --to=x2", "x1 : y1")
         self.assertRunOK("scan --from=x2 --to=x4", "x2 : y2\nx3 : y3")
+        self.assertRunOK("scan --num_threads=4", "x1 : y1\nx2 : y2\nx3 : y3")
+        self.assertRunOK("scan --from=x2 --to=x4 --num_threads=2",
+                "x2 : y2\nx3 : y3")
+        self.assertRunFAIL("scan --num_threads=0")
         self.assertRunFAIL("scan --from=x4 --to=z") # No results => FAIL
         self.assertRunFAIL("scan --from=x1 --to=z --max_keys=foo")
 
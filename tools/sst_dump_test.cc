@@ -395,6 +395,38 @@ TEST_F(SSTDumpToolTest, RawOutput) {
   }
 }
 
+TEST_F(SSTDumpToolTest, ParallelCheck) {
+  Options opts;
+  opts.env = env();
+  std::vector<std::string> files;
+  for (int i = 0; i < 3; i++) {
+    files.push_back(
+        MakeFilePath("rocksdb_sst_test" + ROCKSDB_NAMESPACE::ToString(i) +
+                     ".sst"));
+    createSST(opts, files.back());
+  }
+  files.push_back(MakeFilePath("fake_sst.sst"));
+  ASSERT_OK(WriteStringToFile(opts.env, "Not an SST file!", files.back()));
+
+  char* usage[4];
+  PopulateCommandArgs(MakeFilePath(""), "", usage);
+  snprintf(usage[3], kOptLength, "--num_threads=3");
+
+  SSTDumpTool tool;
+  for (const auto& command_arg : {"--command=check", "--command=verify"}) {
+    snprintf(usage[1], kOptLength, "%s", command_arg);
+    // The valid files are processed; the fake one is skipped
+    ASSERT_TRUE(!tool.Run(4, usage, opts));
+  }
+
+  for (const auto& file : files) {
+    ASSERT_OK(opts.env->DeleteFile(file));
+  }
+  for (int i = 0; i < 4; i++) {
+    delete[] usage[i];
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 #ifdef ROCKSDB_UNITTESTS_WITH_CUSTOM_OBJECTS_FROM_STATIC_LIBS
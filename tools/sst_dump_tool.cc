@@ -7,8 +7,11 @@
 
 #include "rocksdb/sst_dump_tool.h"
 
+#include <atomic>
 #include <cinttypes>
+#include <functional>
 #include <iostream>
+#include <mutex>
 
 #include "port/port.h"
 #include "rocksdb/utilities/ldb_cmd.h"
@@ -70,6 +73,10 @@ void print_help(bool to_stderr) {
     --read_num=<num>
       Maximum number of entries to read when executing check|scan
 
+    --num_threads=<num>
+      Number of files to process at a time when executing verify, or check
+      without --read_num, --show_properties or --show_summary
+
     --verify_checksum
       Verify file checksum when executing check|scan
 
@@ -130,6 +137,73 @@ bool ParseIntArg(const char* arg, const std::string arg_name,
   }
   return false;
 }
+
+// Runs `process_file` on the SST files among `filenames` (in `dir`, if not
+// nullptr) with `num_threads` threads, printing the results as files are
+// done: `header` before the first valid file, then per file `error_format`
+// with the file name and status on failure, or `ok_message` (if not nullptr)
+// on success. Returns the files that are valid SST files.
+std::vector<std::string> ProcessFilesInParallel(
+    const Options& options, const char* dir,
+    const std::vector<std::string>& filenames, size_t num_threads,
+    size_t readahead_size, bool verify_checksum, bool output_hex,
+    bool decode_blob_index,
+    const std::function<Status(SstFileDumper*)>& process_file,
+    const std::string& header, const char* error_format,
+    const char* ok_message) {
+  std::vector<std::string> sst_files;
+  for (const auto& filename : filenames) {
+    if (filename.length() <= 4 ||
+        filename.rfind(".sst") != filename.length() - 4) {
+      continue;
+    }
+    sst_files.push_back(dir != nullptr ? std::string(dir) + "/" + filename
+                                       : filename);
+  }
+
+  std::vector<std::string> valid_sst_files;
+  std::atomic<size_t> next_file(0);
+  std::mutex output_mutex;
+  auto process_files = [&]() {
+    for (size_t i = next_file.fetch_add(1); i < sst_files.size();
+         i = next_file.fetch_add(1)) {
+      const std::string& filename = sst_files[i];
+      SstFileDumper dumper(options, filename, readahead_size, verify_checksum,
+                           output_hex, decode_blob_index, EnvOptions(),
+                           true /* silent */);
+      Status s = dumper.getStatus();
+      const bool valid = s.ok();
+      if (valid) {
+        s = process_file(&dumper);
+      }
+
+      std::lock_guard<std::mutex> lock(output_mutex);
+      if (valid && valid_sst_files.empty()) {
+        fputs(header.c_str(), stdout);
+      }
+      fprintf(stdout, "Process %s\n", filename.c_str());
+      if (!valid) {
+        fprintf(stderr, "%s: %s\n", filename.c_str(), s.ToString().c_str());
+        continue;
+      }
+      valid_sst_files.push_back(filename);
+      if (!s.ok()) {
+        fprintf(stderr, error_format, filename.c_str(), s.ToString().c_str());
+      } else if (ok_message != nullptr) {
+        fputs(ok_message, stdout);
+      }
+    }
+  };
+  std::vector<port::Thread> threads;
+  for (size_t i = 1; i < std::min(num_threads, sst_files.size()); i++) {
+    threads.emplace_back(process_files);
+  }
+  process_files();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return valid_sst_files;
+}
 }  // namespace
 
 int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
@@ -160,6 +234,7 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   std::string compression_level_to_str;
   size_t block_size = 0;
   size_t readahead_size = 2 * 1024 * 1024;
+  size_t num_threads = 1;
   std::vector<std::pair<CompressionType, const char*>> compression_types;
   uint64_t total_num_files = 0;
   uint64_t total_num_data_blocks = 0;
@@ -217,6 +292,9 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
     } else if (ParseIntArg(argv[i], "--readahead_size=",
                            "readahead_size must be numeric", &tmp_val)) {
       readahead_size = static_cast<size_t>(tmp_val);
+    } else if (ParseIntArg(argv[i], "--num_threads=",
+                           "num_threads must be numeric", &tmp_val)) {
+      num_threads = static_cast<size_t>(std::max(tmp_val, int64_t{1}));
     } else if (strncmp(argv[i], "--compression_types=", 20) == 0) {
       std::string compression_types_csv = argv[i] + 20;
       std::istringstream iss(compression_types_csv);
@@ -386,6 +464,31 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   uint64_t total_read = 0;
   // List of RocksDB SST file without corruption
   std::vector<std::string> valid_sst_files;
+  if (command == "verify" && num_threads > 1) {
+    valid_sst_files = ProcessFilesInParallel(
+        options, dir ? dir_or_file : nullptr, filenames, num_threads,
+        readahead_size, verify_checksum, output_hex, decode_blob_index,
+        [](SstFileDumper* dumper) { return dumper->VerifyChecksum(); },
+        "" /* header */, "%s is corrupted: %s\n", "The file is ok\n");
+    // All verified, nothing left for the loop below
+    filenames.clear();
+  } else if ((command == "check" || command == "") && num_threads > 1 &&
+             read_num == std::numeric_limits<uint64_t>::max() &&
+             !show_properties && !show_summary) {
+    // Entries are not printed, so files are checked in any order
+    valid_sst_files = ProcessFilesInParallel(
+        options, dir ? dir_or_file : nullptr, filenames, num_threads,
+        readahead_size, verify_checksum, output_hex, decode_blob_index,
+        [&](SstFileDumper* dumper) {
+          return dumper->ReadSequential(
+              false /* print_kv */, read_num, has_from || use_from_as_prefix,
+              from_key, has_to, to_key, use_from_as_prefix);
+        },
+        "from [" + Slice(from_key).ToString(true) + "] to [" +
+            Slice(to_key).ToString(true) + "]\n",
+        "%s: %s\n", nullptr /* ok_message */);
+    filenames.clear();
+  }
   for (size_t i = 0; i < filenames.size(); i++) {
     std::string filename = filenames.at(i);
     if (filename.length() <= 4 ||
@@ -275,6 +275,37 @@ TEST_F(TraceAnalyzerTest, Get) {
   CheckFileContent(top_qps, file_path, true);
 }
 
+// Test analyzing of Get with the trace decoded by background threads
+TEST_F(TraceAnalyzerTest, GetWithDecodeThreads) {
+  std::string trace_path = test_path_ + "/trace";
+  std::string output_path = test_path_ + "/get_decode_threads";
+  std::string file_path;
+  std::vector<std::string> paras = {
+      "-analyze_get=true",           "-analyze_put=false",
+      "-analyze_delete=false",       "-analyze_single_delete=false",
+      "-analyze_range_delete=false", "-analyze_iterator=false",
+      "-analyze_multiget=false",     "-decode_threads=2"};
+  paras.push_back("-output_dir=" + output_path);
+  paras.push_back("-trace_path=" + trace_path);
+  paras.push_back("-key_space_dir=" + test_path_);
+  AnalyzeTrace(paras, output_path, trace_path);
+
+  // The results are the same as without the decode threads
+  std::vector<std::string> k_stats = {"0 10 0 1 1.000000", "0 10 1 1 1.000000"};
+  file_path = output_path + "/test-get-0-accessed_key_stats.txt";
+  CheckFileContent(k_stats, file_path, true);
+
+  std::vector<std::string> k_sequence = {"1", "5", "2", "3", "4", "8",
+                                         "8", "8", "8", "8", "8", "8",
+                                         "8", "8", "0", "6", "7", "0"};
+  file_path = output_path + "/test-human_readable_trace.txt";
+  CheckFileContent(k_sequence, file_path, false);
+
+  std::vector<std::string> all_qps = {"1 0 0 0 0 0 0 0 0 1"};
+  file_path = output_path + "/test-qps_stats.txt";
+  CheckFileContent(all_qps, file_path, true);
+}
+
 // Test analyzing of Put
 TEST_F(TraceAnalyzerTest, Put) {
   std::string trace_path = test_path_ + "/trace";
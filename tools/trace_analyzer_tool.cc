@@ -16,9 +16,12 @@
 
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 
@@ -166,6 +169,11 @@ DEFINE_int32(value_interval, 8,
 DEFINE_double(sample_ratio, 1.0,
               "If the trace size is extremely huge or user want to sample "
               "the trace when analyzing, sample ratio can be set (0, 1.0]");
+DEFINE_int32(decode_threads, 0,
+             "If > 0, trace records are read by a background thread and "
+             "decoded in batches by this many threads, while the analysis "
+             "consumes them in trace order. The results are the same as "
+             "with 0 (decode on the analyzing thread).");
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -467,90 +475,278 @@ Status TraceAnalyzer::StartProcessing() {
     time_series_start_ = header.ts;
   }
 
+  if (FLAGS_decode_threads > 0) {
+    s = ProcessTracesInParallel(static_cast<size_t>(FLAGS_decode_threads));
+  } else {
+    std::string encoded_trace;
+    while (s.ok()) {
+      s = trace_reader_->Read(&encoded_trace);
+      if (!s.ok()) {
+        break;
+      }
+      DecodedTrace decoded;
+      s = DecodeTraceRecord(encoded_trace, &decoded);
+      if (!s.ok()) {
+        break;
+      }
+      if (decoded.type == kTraceEnd) {
+        total_requests_++;
+        end_time_ = decoded.ts;
+        break;
+      }
+      s = ProcessDecodedTrace(decoded);
+    }
+  }
+  if (s.IsIncomplete()) {
+    // Fix it: Reaching eof returns Incomplete status at the moment.
+    //
+    return Status::OK();
+  }
+  return s;
+}
+
+// Decodes a trace record and its payload. Only reads trace_file_version_,
+// so it can run on any thread once the header is parsed.
+Status TraceAnalyzer::DecodeTraceRecord(const std::string& encoded_trace,
+                                        DecodedTrace* decoded) const {
   Trace trace;
-  while (s.ok()) {
-    trace.reset();
-    s = ReadTraceRecord(&trace);
+  Status s = TracerHelper::DecodeTrace(encoded_trace, &trace);
+  if (!s.ok()) {
+    return s;
+  }
+  decoded->ts = trace.ts;
+  decoded->type = trace.type;
+  if (trace.type == kTraceWrite) {
+    Slice batch_data;
+    if (trace_file_version_ < 2) {
+      Slice tmp_data(trace.payload);
+      batch_data = tmp_data;
+    } else {
+      WritePayload w_payload;
+      TracerHelper::DecodeWritePayload(&trace, &w_payload);
+      batch_data = w_payload.write_batch_data;
+    }
+    decoded->batch.reset(new WriteBatch(batch_data.ToString()));
+    // Note that, if the write happens in a transaction,
+    // 'Write' will be called twice, one for Prepare, one for
+    // Commit. Thus, in the trace, for the same WriteBatch, there
+    // will be two reords if it is in a transaction. Here, we only
+    // process the reord that is committed. If write is non-transaction,
+    // HasBeginPrepare()==false, so we process it normally.
+    decoded->skip_batch =
+        decoded->batch->HasBeginPrepare() && !decoded->batch->HasCommit();
+  } else if (trace.type == kTraceGet) {
+    GetPayload get_payload;
+    get_payload.get_key = 0;
+    if (trace_file_version_ < 2) {
+      DecodeCFAndKeyFromString(trace.payload, &get_payload.cf_id,
+                               &get_payload.get_key);
+    } else {
+      TracerHelper::DecodeGetPayload(&trace, &get_payload);
+    }
+    decoded->cf_id = get_payload.cf_id;
+    decoded->key = get_payload.get_key.ToString();
+  } else if (trace.type == kTraceIteratorSeek ||
+             trace.type == kTraceIteratorSeekForPrev) {
+    IterPayload iter_payload;
+    iter_payload.cf_id = 0;
+    if (trace_file_version_ < 2) {
+      DecodeCFAndKeyFromString(trace.payload, &iter_payload.cf_id,
+                               &iter_payload.iter_key);
+    } else {
+      TracerHelper::DecodeIterPayload(&trace, &iter_payload);
+    }
+    decoded->cf_id = iter_payload.cf_id;
+    decoded->key = iter_payload.iter_key.ToString();
+  } else if (trace.type == kTraceMultiGet) {
+    assert(trace_file_version_ >= 2);
+    TracerHelper::DecodeMultiGetPayload(&trace, &decoded->multiget_payload);
+  }
+  return Status::OK();
+}
+
+// Redirects a decoded trace record to the handler of its operation type
+Status TraceAnalyzer::ProcessDecodedTrace(DecodedTrace& decoded) {
+  Status s;
+  total_requests_++;
+  end_time_ = decoded.ts;
+  if (decoded.type == kTraceWrite) {
+    total_writes_++;
+    c_time_ = decoded.ts;
+    if (decoded.skip_batch) {
+      return s;
+    }
+    TraceWriteHandler write_handler(this);
+    s = decoded.batch->Iterate(&write_handler);
     if (!s.ok()) {
-      break;
+      fprintf(stderr, "Cannot process the write batch in the trace\n");
+      return s;
     }
+  } else if (decoded.type == kTraceGet) {
+    total_gets_++;
 
-    total_requests_++;
-    end_time_ = trace.ts;
-    if (trace.type == kTraceWrite) {
-      total_writes_++;
-      c_time_ = trace.ts;
-      Slice batch_data;
-      if (trace_file_version_ < 2) {
-        Slice tmp_data(trace.payload);
-        batch_data = tmp_data;
-      } else {
-        WritePayload w_payload;
-        TracerHelper::DecodeWritePayload(&trace, &w_payload);
-        batch_data = w_payload.write_batch_data;
+    s = HandleGet(decoded.cf_id, decoded.key, decoded.ts, 1);
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot process the get in the trace\n");
+      return s;
+    }
+  } else if (decoded.type == kTraceIteratorSeek ||
+             decoded.type == kTraceIteratorSeekForPrev) {
+    s = HandleIter(decoded.cf_id, decoded.key, decoded.ts, decoded.type);
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot process the iterator in the trace\n");
+      return s;
+    }
+  } else if (decoded.type == kTraceMultiGet) {
+    s = HandleMultiGet(decoded.multiget_payload, decoded.ts);
+  }
+  return s;
+}
+
+namespace {
+// Number of trace records read and decoded together with decode_threads
+const size_t kDecodeBatchSize = 1024;
+}  // namespace
+
+// A reader thread reads batches of encoded trace records, the decode
+// threads decode whole batches, and this thread analyzes the decoded
+// batches in the order they were read. The number of batches read but not
+// analyzed yet is bounded, which bounds the memory used.
+Status TraceAnalyzer::ProcessTracesInParallel(size_t num_threads) {
+  struct Batch {
+    std::vector<std::string> encoded;
+    std::vector<DecodedTrace> decoded;
+    Status status;
+  };
+  const uint64_t max_batches_in_flight = 4 * num_threads;
+  std::mutex mutex;
+  std::condition_variable cv;
+  // Read, not decoded yet
+  std::deque<std::pair<uint64_t, std::unique_ptr<Batch>>> to_decode;
+  // Decoded, keyed by read order
+  std::map<uint64_t, std::unique_ptr<Batch>> decoded_batches;
+  uint64_t num_batches_read = 0;
+  uint64_t num_batches_processed = 0;
+  bool read_done = false;
+  bool stop = false;
+  Status read_status;
+
+  auto read_traces = [&]() {
+    Status rs;
+    while (rs.ok()) {
+      std::unique_ptr<Batch> batch(new Batch());
+      while (batch->encoded.size() < kDecodeBatchSize) {
+        std::string encoded_trace;
+        rs = trace_reader_->Read(&encoded_trace);
+        if (!rs.ok()) {
+          break;
+        }
+        batch->encoded.push_back(std::move(encoded_trace));
       }
-      // Note that, if the write happens in a transaction,
-      // 'Write' will be called twice, one for Prepare, one for
-      // Commit. Thus, in the trace, for the same WriteBatch, there
-      // will be two reords if it is in a transaction. Here, we only
-      // process the reord that is committed. If write is non-transaction,
-      // HasBeginPrepare()==false, so we process it normally.
-      WriteBatch batch(batch_data.ToString());
-      if (batch.HasBeginPrepare() && !batch.HasCommit()) {
-        continue;
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&]() {
+        return stop ||
+               num_batches_read - num_batches_processed <
+                   max_batches_in_flight;
+      });
+      if (stop) {
+        break;
       }
-      TraceWriteHandler write_handler(this);
-      s = batch.Iterate(&write_handler);
-      if (!s.ok()) {
-        fprintf(stderr, "Cannot process the write batch in the trace\n");
-        return s;
+      if (!batch->encoded.empty()) {
+        to_decode.emplace_back(num_batches_read++, std::move(batch));
       }
-    } else if (trace.type == kTraceGet) {
-      GetPayload get_payload;
-      get_payload.get_key = 0;
-      if (trace_file_version_ < 2) {
-        DecodeCFAndKeyFromString(trace.payload, &get_payload.cf_id,
-                                 &get_payload.get_key);
-      } else {
-        TracerHelper::DecodeGetPayload(&trace, &get_payload);
+      cv.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    read_status = rs;
+    read_done = true;
+    cv.notify_all();
+  };
+
+  auto decode_traces = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cv.wait(lock, [&]() {
+        return stop || !to_decode.empty() || read_done;
+      });
+      if (stop || to_decode.empty()) {
+        break;
       }
-      total_gets_++;
+      uint64_t seq = to_decode.front().first;
+      std::unique_ptr<Batch> batch = std::move(to_decode.front().second);
+      to_decode.pop_front();
+      lock.unlock();
+      batch->decoded.resize(batch->encoded.size());
+      for (size_t i = 0; i < batch->encoded.size(); ++i) {
+        batch->status =
+            DecodeTraceRecord(batch->encoded[i], &batch->decoded[i]);
+        if (!batch->status.ok()) {
+          batch->decoded.resize(i);
+          break;
+        }
+      }
+      batch->encoded.clear();
+      lock.lock();
+      decoded_batches[seq] = std::move(batch);
+      cv.notify_all();
+    }
+  };
 
-      s = HandleGet(get_payload.cf_id, get_payload.get_key.ToString(), trace.ts,
-                    1);
-      if (!s.ok()) {
-        fprintf(stderr, "Cannot process the get in the trace\n");
-        return s;
+  std::vector<port::Thread> threads;
+  threads.emplace_back(read_traces);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(decode_traces);
+  }
+
+  Status s;
+  while (s.ok()) {
+    std::unique_ptr<Batch> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&]() {
+        return decoded_batches.count(num_batches_processed) > 0 ||
+               (read_done && num_batches_processed == num_batches_read);
+      });
+      auto it = decoded_batches.find(num_batches_processed);
+      if (it == decoded_batches.end()) {
+        // All batches are processed
+        s = read_status;
+        break;
       }
-    } else if (trace.type == kTraceIteratorSeek ||
-               trace.type == kTraceIteratorSeekForPrev) {
-      IterPayload iter_payload;
-      iter_payload.cf_id = 0;
-      if (trace_file_version_ < 2) {
-        DecodeCFAndKeyFromString(trace.payload, &iter_payload.cf_id,
-                                 &iter_payload.iter_key);
-      } else {
-        TracerHelper::DecodeIterPayload(&trace, &iter_payload);
+      batch = std::move(it->second);
+      decoded_batches.erase(it);
+    }
+    bool end = false;
+    for (auto& decoded : batch->decoded) {
+      if (decoded.type == kTraceEnd) {
+        total_requests_++;
+        end_time_ = decoded.ts;
+        end = true;
+        break;
       }
-      s = HandleIter(iter_payload.cf_id, iter_payload.iter_key.ToString(),
-                     trace.ts, trace.type);
+      s = ProcessDecodedTrace(decoded);
       if (!s.ok()) {
-        fprintf(stderr, "Cannot process the iterator in the trace\n");
-        return s;
+        break;
       }
-    } else if (trace.type == kTraceMultiGet) {
-      MultiGetPayload multiget_payload;
-      assert(trace_file_version_ >= 2);
-      TracerHelper::DecodeMultiGetPayload(&trace, &multiget_payload);
-      s = HandleMultiGet(multiget_payload, trace.ts);
-    } else if (trace.type == kTraceEnd) {
+    }
+    if (s.ok()) {
+      s = batch->status;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    num_batches_processed++;
+    cv.notify_all();
+    if (end) {
       break;
     }
   }
-  if (s.IsIncomplete()) {
-    // Fix it: Reaching eof returns Incomplete status at the moment.
-    //
-    return Status::OK();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+    cv.notify_all();
+  }
+  for (auto& t : threads) {
+    t.join();
   }
   return s;
 }
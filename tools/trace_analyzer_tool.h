@@ -44,6 +44,23 @@ struct TraceUnit {
   std::string key;
 };
 
+// A trace record with its payload decoded. Decoding does not touch the
+// analyzer statistics, so that it can run on other threads (see
+// -decode_threads).
+struct DecodedTrace {
+  uint64_t ts = 0;
+  TraceType type = kTraceMax;
+  // Get and iterator traces
+  uint32_t cf_id = 0;
+  std::string key;
+  // Write traces. skip_batch is set for the prepare record of a write in a
+  // transaction, which is analyzed with its commit record instead.
+  std::unique_ptr<WriteBatch> batch;
+  bool skip_batch = false;
+  // MultiGet traces
+  MultiGetPayload multiget_payload;
+};
+
 struct TypeCorrelation {
   uint64_t count;
   uint64_t total_ts;
@@ -230,6 +247,10 @@ class TraceAnalyzer {
   Status ReadTraceHeader(Trace* header);
   Status ReadTraceFooter(Trace* footer);
   Status ReadTraceRecord(Trace* trace);
+  Status DecodeTraceRecord(const std::string& encoded_trace,
+                           DecodedTrace* decoded) const;
+  Status ProcessDecodedTrace(DecodedTrace& decoded);
+  Status ProcessTracesInParallel(size_t num_threads);
   Status KeyStatsInsertion(const uint32_t& type, const uint32_t& cf_id,
                            const std::string& key, const size_t value_size,
                            const uint64_t ts);
@@ -12,6 +12,7 @@
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
 #include "rocksdb/slice.h"
+#include "trace_replay/buffered_trace_writer.h"
 #include "util/coding.h"
 #include "util/hash.h"
 #include "util/string_util.h"
@@ -149,7 +150,13 @@ Status BlockCacheTraceWriter::WriteHeader() {
   PutFixed32(&trace.payload, kMinorVersion);
   std::string encoded_trace;
   TracerHelper::EncodeTrace(trace, &encoded_trace);
-  return trace_writer_->Write(encoded_trace);
+  Status s = trace_writer_->Write(encoded_trace);
+  if (s.ok() && trace_options_.buffered_write) {
+    // Buffer only after the header, which has to come first in the file
+    std::unique_ptr<TraceWriter> target = std::move(trace_writer_);
+    trace_writer_.reset(new BufferedTraceWriter(std::move(target)));
+  }
+  return s;
 }
 
 BlockCacheTraceReader::BlockCacheTraceReader(
@@ -452,9 +459,13 @@ Status BlockCacheTracer::StartTrace(
   }
   get_id_counter_.store(1);
   trace_options_ = trace_options;
-  writer_.store(
+  // Write the header before publishing the writer, as buffered writers are
+  // written to without the mutex
+  std::unique_ptr<BlockCacheTraceWriter> writer(
       new BlockCacheTraceWriter(clock, trace_options, std::move(trace_writer)));
-  return writer_.load()->WriteHeader();
+  Status s = writer->WriteHeader();
+  writer_.store(writer.release());
+  return s;
 }
 
 void BlockCacheTracer::EndTrace() {
@@ -462,17 +473,28 @@ void BlockCacheTracer::EndTrace() {
   if (!writer_.load()) {
     return;
   }
-  delete writer_.load();
+  BlockCacheTraceWriter* writer = writer_.load();
   writer_.store(nullptr);
+  if (writer->buffered()) {
+    writer->Close().PermitUncheckedError();
+    retired_writers_.emplace_back(writer);
+  } else {
+    delete writer;
+  }
 }
 
 Status BlockCacheTracer::WriteBlockAccess(const BlockCacheTraceRecord& record,
                                           const Slice& block_key,
                                           const Slice& cf_name,
                                           const Slice& referenced_key) {
-  if (!writer_.load() || !ShouldTrace(block_key, trace_options_)) {
+  BlockCacheTraceWriter* writer = writer_.load();
+  if (!writer || !ShouldTrace(block_key, trace_options_)) {
     return Status::OK();
   }
+  if (writer->buffered()) {
+    return writer->WriteBlockAccess(record, block_key, cf_name,
+                                    referenced_key);
+  }
   InstrumentedMutexLock lock_guard(&trace_writer_mutex_);
   if (!writer_.load()) {
     return Status::OK();
@@ -7,6 +7,8 @@
 
 #include <atomic>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 #include "monitoring/instrumented_mutex.h"
 #include "rocksdb/options.h"
@@ -188,9 +190,15 @@ class BlockCacheTraceWriter {
                           const Slice& referenced_key);
 
   // Write a trace header at the beginning, typically on initiating a trace,
-  // with some metadata like a magic number and RocksDB version.
+  // with some metadata like a magic number and RocksDB version. With
+  // TraceOptions::buffered_write, the records written after the header are
+  // buffered, and WriteBlockAccess() may be called concurrently.
   Status WriteHeader();
 
+  bool buffered() const { return trace_options_.buffered_write; }
+
+  Status Close() { return trace_writer_->Close(); }
+
  private:
   SystemClock* clock_;
   TraceOptions trace_options_;
@@ -289,6 +297,9 @@ class BlockCacheTracer {
   // A mutex protects the writer_.
   InstrumentedMutex trace_writer_mutex_;
   std::atomic<BlockCacheTraceWriter*> writer_;
+  // Buffered writers are written to without the mutex, so a trace that ends
+  // keeps its writer until the tracer is destroyed. Protected by the mutex.
+  std::vector<std::unique_ptr<BlockCacheTraceWriter>> retired_writers_;
   std::atomic<uint64_t> get_id_counter_;
 };
 
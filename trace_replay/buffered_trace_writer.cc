@@ -0,0 +1,169 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "trace_replay/buffered_trace_writer.h"
+
+#include <cassert>
+
+#include "rocksdb/system_clock.h"
+#include "util/autovector.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Marks the thread-local slot of a thread that is appending to its buffer,
+// so that ScrapeThreadBuffers() leaves the buffer alone
+char in_use_marker;
+void* const kInUse = &in_use_marker;
+}  // namespace
+
+BufferedTraceWriter::BufferedTraceWriter(std::unique_ptr<TraceWriter>&& target)
+    : target_(std::move(target)),
+      initial_file_size_(target_->GetFileSize()),
+      closed_(false),
+      failed_(false),
+      submitted_bytes_(0),
+      dropped_bytes_(0),
+      cv_(&mu_),
+      pending_bytes_(0),
+      stop_(false),
+      thread_buffers_(&BufferedTraceWriter::OnThreadExit) {
+  thread_ = port::Thread(&BufferedTraceWriter::BackgroundThread, this);
+}
+
+BufferedTraceWriter::~BufferedTraceWriter() { Close().PermitUncheckedError(); }
+
+void BufferedTraceWriter::OnThreadExit(void* ptr) {
+  if (ptr == kInUse) {
+    return;
+  }
+  auto* buf = static_cast<ThreadBuffer*>(ptr);
+  buf->owner->Submit(buf);
+}
+
+Status BufferedTraceWriter::Write(const Slice& data) {
+  if (failed_.load(std::memory_order_relaxed)) {
+    return Status::IOError("Failed to write buffered trace records");
+  }
+  if (closed_.load(std::memory_order_relaxed)) {
+    dropped_bytes_.fetch_add(data.size(), std::memory_order_relaxed);
+    return Status::OK();
+  }
+  void* ptr = thread_buffers_.Swap(kInUse);
+  assert(ptr != kInUse);
+  ThreadBuffer* buf = ptr == nullptr ? new ThreadBuffer(this)
+                                     : static_cast<ThreadBuffer*>(ptr);
+  buf->data.append(data.data(), data.size());
+  if (buf->data.size() >= kThreadBufferSize) {
+    Submit(buf);
+    buf = nullptr;
+  }
+  void* expected = kInUse;
+  if (!thread_buffers_.CompareAndSwap(buf, expected)) {
+    // ScrapeThreadBuffers() emptied the slot meanwhile, so the buffer was
+    // not handed over and is still ours
+    assert(expected == nullptr);
+    if (buf != nullptr) {
+      Submit(buf);
+    }
+  }
+  return Status::OK();
+}
+
+void BufferedTraceWriter::Submit(ThreadBuffer* buf) {
+  const size_t size = buf->data.size();
+  if (size == 0) {
+    delete buf;
+    return;
+  }
+  {
+    MutexLock l(&mu_);
+    if (!stop_ && pending_bytes_ + size <= kMaxPendingBytes) {
+      pending_.push_back(buf);
+      pending_bytes_ += size;
+      submitted_bytes_.fetch_add(size, std::memory_order_relaxed);
+      cv_.Signal();
+      return;
+    }
+  }
+  dropped_bytes_.fetch_add(size, std::memory_order_relaxed);
+  delete buf;
+}
+
+void BufferedTraceWriter::ScrapeThreadBuffers() {
+  autovector<void*> ptrs;
+  thread_buffers_.Scrape(&ptrs, nullptr);
+  for (void* ptr : ptrs) {
+    if (ptr != kInUse) {
+      Submit(static_cast<ThreadBuffer*>(ptr));
+    }
+  }
+}
+
+void BufferedTraceWriter::BackgroundThread() {
+  SystemClock* clock = SystemClock::Default().get();
+  uint64_t next_scrape = clock->NowMicros() + kFlushIntervalMicros;
+  MutexLock l(&mu_);
+  while (true) {
+    while (!pending_.empty()) {
+      ThreadBuffer* buf = pending_.front();
+      pending_.pop_front();
+      pending_bytes_ -= buf->data.size();
+      mu_.Unlock();
+      Status s = target_->Write(buf->data);
+      delete buf;
+      mu_.Lock();
+      if (!s.ok() && status_.ok()) {
+        status_ = s;
+        failed_.store(true, std::memory_order_relaxed);
+      }
+    }
+    if (stop_) {
+      break;
+    }
+    const uint64_t now = clock->NowMicros();
+    if (now >= next_scrape) {
+      next_scrape = now + kFlushIntervalMicros;
+      mu_.Unlock();
+      ScrapeThreadBuffers();
+      mu_.Lock();
+      continue;
+    }
+    cv_.TimedWait(next_scrape);
+  }
+}
+
+Status BufferedTraceWriter::Close() {
+  if (closed_.exchange(true)) {
+    return Status::OK();
+  }
+  ScrapeThreadBuffers();
+  Status s;
+  {
+    MutexLock l(&mu_);
+    stop_ = true;
+    cv_.Signal();
+  }
+  thread_.join();
+  {
+    MutexLock l(&mu_);
+    s = status_;
+  }
+  Status close_status = target_->Close();
+  if (s.ok()) {
+    s = close_status;
+  } else {
+    close_status.PermitUncheckedError();
+  }
+  return s;
+}
+
+uint64_t BufferedTraceWriter::GetFileSize() {
+  return initial_file_size_ +
+         submitted_bytes_.load(std::memory_order_relaxed);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,93 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "port/port.h"
+#include "rocksdb/status.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/thread_local.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A TraceWriter that many threads can write trace records to without taking
+// a lock. Every thread appends the records it writes to a buffer of its own,
+// which is handed to a background thread once it holds kThreadBufferSize
+// bytes, when the thread exits, and at least every kFlushIntervalMicros. The
+// background thread writes the buffers to the wrapped TraceWriter, so a lock
+// is taken per buffer rather than per record. Records of different threads
+// thus reach the wrapped writer out of order; each record carries its own
+// timestamp. When the background thread falls kMaxPendingBytes behind, the
+// buffers handed to it are dropped rather than slowing down the writers.
+class BufferedTraceWriter : public TraceWriter {
+ public:
+  static constexpr size_t kThreadBufferSize = 64 << 10;
+  static constexpr size_t kMaxPendingBytes = 64 << 20;
+  static constexpr uint64_t kFlushIntervalMicros = 1000000;
+
+  explicit BufferedTraceWriter(std::unique_ptr<TraceWriter>&& target);
+  ~BufferedTraceWriter() override;
+
+  BufferedTraceWriter(const BufferedTraceWriter&) = delete;
+  BufferedTraceWriter& operator=(const BufferedTraceWriter&) = delete;
+
+  // Only fails once the background thread failed to write to the wrapped
+  // writer. Records written after Close() are dropped.
+  Status Write(const Slice& data) override;
+  // Writes out all buffered records, stops the background thread and closes
+  // the wrapped writer. Returns the first error of the background thread.
+  Status Close() override;
+  // The size of the wrapped writer's file once the records handed to the
+  // background thread so far are written
+  uint64_t GetFileSize() override;
+
+  // The number of bytes of records dropped so far
+  uint64_t GetDroppedBytes() const {
+    return dropped_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct ThreadBuffer {
+    explicit ThreadBuffer(BufferedTraceWriter* _owner) : owner(_owner) {
+      data.reserve(kThreadBufferSize);
+    }
+    BufferedTraceWriter* const owner;
+    std::string data;
+  };
+
+  static void OnThreadExit(void* ptr);
+  // Hands `buf` to the background thread, taking ownership of it
+  void Submit(ThreadBuffer* buf);
+  // Hands the buffers of all threads not writing at the moment to the
+  // background thread
+  void ScrapeThreadBuffers();
+  void BackgroundThread();
+
+  std::unique_ptr<TraceWriter> target_;
+  const uint64_t initial_file_size_;
+  std::atomic<bool> closed_;
+  std::atomic<bool> failed_;
+  std::atomic<uint64_t> submitted_bytes_;
+  std::atomic<uint64_t> dropped_bytes_;
+
+  port::Mutex mu_;
+  port::CondVar cv_;
+  std::deque<ThreadBuffer*> pending_;  // protected by mu_
+  size_t pending_bytes_;               // protected by mu_
+  bool stop_;                          // protected by mu_
+  Status status_;                      // protected by mu_
+  port::Thread thread_;
+
+  // Declared last so that it is destroyed first, while Submit() can still be
+  // called for the buffers of live threads
+  ThreadLocalPtr thread_buffers_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -5,6 +5,7 @@
 
 #include "trace_replay/io_tracer.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
@@ -14,8 +15,10 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/trace_reader_writer.h"
+#include "trace_replay/buffered_trace_writer.h"
 #include "util/coding.h"
 #include "util/hash.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -28,6 +31,11 @@ IOTraceWriter::IOTraceWriter(SystemClock* clock,
 
 Status IOTraceWriter::WriteIOOp(const IOTraceRecord& record,
                                 IODebugContext* dbg) {
+  if (trace_options_.sampling_frequency > 1 &&
+      !Random::GetTLSInstance()->OneIn(static_cast<int>(std::min<uint64_t>(
+          trace_options_.sampling_frequency, port::kMaxInt32)))) {
+    return Status::OK();
+  }
   uint64_t trace_file_size = trace_writer_->GetFileSize();
   if (trace_file_size > trace_options_.max_trace_file_size) {
     return Status::OK();
@@ -106,9 +114,17 @@ Status IOTraceWriter::WriteHeader() {
   PutFixed32(&trace.payload, kMinorVersion);
   std::string encoded_trace;
   TracerHelper::EncodeTrace(trace, &encoded_trace);
-  return trace_writer_->Write(encoded_trace);
+  Status s = trace_writer_->Write(encoded_trace);
+  if (s.ok() && trace_options_.buffered_write) {
+    // Buffer only after the header, which has to come first in the file
+    std::unique_ptr<TraceWriter> target = std::move(trace_writer_);
+    trace_writer_.reset(new BufferedTraceWriter(std::move(target)));
+  }
+  return s;
 }
 
+Status IOTraceWriter::Close() { return trace_writer_->Close(); }
+
 IOTraceReader::IOTraceReader(std::unique_ptr<TraceReader>&& reader)
     : trace_reader_(std::move(reader)) {}
 
@@ -274,10 +290,14 @@ Status IOTracer::StartIOTrace(SystemClock* clock,
     return Status::Busy();
   }
   trace_options_ = trace_options;
-  writer_.store(
+  // Write the header before publishing the writer, as buffered writers are
+  // written to without the mutex
+  std::unique_ptr<IOTraceWriter> writer(
       new IOTraceWriter(clock, trace_options, std::move(trace_writer)));
+  Status s = writer->WriteHeader();
+  writer_.store(writer.release());
   tracing_enabled = true;
-  return writer_.load()->WriteHeader();
+  return s;
 }
 
 void IOTracer::EndIOTrace() {
@@ -285,13 +305,24 @@ void IOTracer::EndIOTrace() {
   if (!writer_.load()) {
     return;
   }
-  delete writer_.load();
+  IOTraceWriter* writer = writer_.load();
   writer_.store(nullptr);
   tracing_enabled = false;
+  if (writer->buffered()) {
+    writer->Close().PermitUncheckedError();
+    retired_writers_.emplace_back(writer);
+  } else {
+    delete writer;
+  }
 }
 
 void IOTracer::WriteIOOp(const IOTraceRecord& record, IODebugContext* dbg) {
-  if (!writer_.load()) {
+  IOTraceWriter* writer = writer_.load();
+  if (!writer) {
+    return;
+  }
+  if (writer->buffered()) {
+    writer->WriteIOOp(record, dbg).PermitUncheckedError();
     return;
   }
   InstrumentedMutexLock lock_guard(&trace_writer_mutex_);
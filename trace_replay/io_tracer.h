@@ -7,6 +7,8 @@
 
 #include <atomic>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 #include "monitoring/instrumented_mutex.h"
 #include "port/lang.h"
@@ -112,9 +114,15 @@ class IOTraceWriter {
   Status WriteIOOp(const IOTraceRecord& record, IODebugContext* dbg);
 
   // Write a trace header at the beginning, typically on initiating a trace,
-  // with some metadata like a magic number and RocksDB version.
+  // with some metadata like a magic number and RocksDB version. With
+  // TraceOptions::buffered_write, the records written after the header are
+  // buffered, and WriteIOOp() may be called concurrently.
   Status WriteHeader();
 
+  bool buffered() const { return trace_options_.buffered_write; }
+
+  Status Close();
+
  private:
   SystemClock* clock_;
   TraceOptions trace_options_;
@@ -175,6 +183,9 @@ class IOTracer {
   // A mutex protects the writer_.
   InstrumentedMutex trace_writer_mutex_;
   std::atomic<IOTraceWriter*> writer_;
+  // Buffered writers are written to without the mutex, so a trace that ends
+  // keeps its writer until the tracer is destroyed. Protected by the mutex.
+  std::vector<std::unique_ptr<IOTraceWriter>> retired_writers_;
   // bool tracing_enabled is added to avoid costly operation of checking atomic
   // variable 'writer_' is nullptr or not in is_tracing_enabled().
   // is_tracing_enabled() is invoked multiple times by FileSystem classes.
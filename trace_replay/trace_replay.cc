@@ -5,11 +5,14 @@
 
 #include "trace_replay/trace_replay.h"
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
 #include <sstream>
 #include <thread>
 
 #include "db/db_impl/db_impl.h"
+#include "db/write_batch_internal.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
@@ -17,6 +20,7 @@
 #include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/write_batch.h"
 #include "util/coding.h"
+#include "util/mutexlock.h"
 #include "util/string_util.h"
 #include "util/threadpool_imp.h"
 
@@ -177,6 +181,12 @@ void TracerHelper::DecodeIterPayload(Trace* trace, IterPayload* iter_payload) {
       case TracePayloadType::kIterUpperBound:
         GetLengthPrefixedSlice(&buf, &(iter_payload->upper_bound));
         break;
+      case TracePayloadType::kIterNextCount:
+        GetFixed64(&buf, &(iter_payload->next_count));
+        break;
+      case TracePayloadType::kIterPrevCount:
+        GetFixed64(&buf, &(iter_payload->prev_count));
+        break;
       default:
         assert(false);
     }
@@ -273,49 +283,31 @@ Status Tracer::Get(ColumnFamilyHandle* column_family, const Slice& key) {
 }
 
 Status Tracer::IteratorSeek(const uint32_t& cf_id, const Slice& key,
-                            const Slice& lower_bound, const Slice upper_bound) {
-  TraceType trace_type = kTraceIteratorSeek;
-  if (ShouldSkipTrace(trace_type)) {
-    return Status::OK();
-  }
-  Trace trace;
-  trace.ts = clock_->NowMicros();
-  trace.type = trace_type;
-  // Set the payloadmap of the struct member that will be encoded in the
-  // payload.
-  TracerHelper::SetPayloadMap(trace.payload_map, TracePayloadType::kIterCFID);
-  TracerHelper::SetPayloadMap(trace.payload_map, TracePayloadType::kIterKey);
-  if (lower_bound.size() > 0) {
-    TracerHelper::SetPayloadMap(trace.payload_map,
-                                TracePayloadType::kIterLowerBound);
-  }
-  if (upper_bound.size() > 0) {
-    TracerHelper::SetPayloadMap(trace.payload_map,
-                                TracePayloadType::kIterUpperBound);
-  }
-  // Encode the Iterator struct members into payload. Make sure add them in
-  // order.
-  PutFixed64(&trace.payload, trace.payload_map);
-  PutFixed32(&trace.payload, cf_id);
-  PutLengthPrefixedSlice(&trace.payload, key);
-  if (lower_bound.size() > 0) {
-    PutLengthPrefixedSlice(&trace.payload, lower_bound);
-  }
-  if (upper_bound.size() > 0) {
-    PutLengthPrefixedSlice(&trace.payload, upper_bound);
-  }
-  return WriteTrace(trace);
+                            const Slice& lower_bound, const Slice upper_bound,
+                            uint64_t seek_micros, uint64_t next_count,
+                            uint64_t prev_count) {
+  return IteratorTrace(kTraceIteratorSeek, cf_id, key, lower_bound,
+                       upper_bound, seek_micros, next_count, prev_count);
 }
 
 Status Tracer::IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
                                    const Slice& lower_bound,
-                                   const Slice upper_bound) {
-  TraceType trace_type = kTraceIteratorSeekForPrev;
+                                   const Slice upper_bound,
+                                   uint64_t seek_micros, uint64_t next_count,
+                                   uint64_t prev_count) {
+  return IteratorTrace(kTraceIteratorSeekForPrev, cf_id, key, lower_bound,
+                       upper_bound, seek_micros, next_count, prev_count);
+}
+
+Status Tracer::IteratorTrace(TraceType trace_type, const uint32_t& cf_id,
+                             const Slice& key, const Slice& lower_bound,
+                             const Slice& upper_bound, uint64_t seek_micros,
+                             uint64_t next_count, uint64_t prev_count) {
   if (ShouldSkipTrace(trace_type)) {
     return Status::OK();
   }
   Trace trace;
-  trace.ts = clock_->NowMicros();
+  trace.ts = seek_micros != 0 ? seek_micros : clock_->NowMicros();
   trace.type = trace_type;
   // Set the payloadmap of the struct member that will be encoded in the
   // payload.
@@ -329,6 +321,14 @@ Status Tracer::IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
     TracerHelper::SetPayloadMap(trace.payload_map,
                                 TracePayloadType::kIterUpperBound);
   }
+  if (next_count > 0) {
+    TracerHelper::SetPayloadMap(trace.payload_map,
+                                TracePayloadType::kIterNextCount);
+  }
+  if (prev_count > 0) {
+    TracerHelper::SetPayloadMap(trace.payload_map,
+                                TracePayloadType::kIterPrevCount);
+  }
   // Encode the Iterator struct members into payload. Make sure add them in
   // order.
   PutFixed64(&trace.payload, trace.payload_map);
@@ -340,6 +340,12 @@ Status Tracer::IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
   if (upper_bound.size() > 0) {
     PutLengthPrefixedSlice(&trace.payload, upper_bound);
   }
+  if (next_count > 0) {
+    PutFixed64(&trace.payload, next_count);
+  }
+  if (prev_count > 0) {
+    PutFixed64(&trace.payload, prev_count);
+  }
   return WriteTrace(trace);
 }
 
@@ -471,6 +477,66 @@ Status Tracer::WriteTrace(const Trace& trace) {
 
 Status Tracer::Close() { return WriteFooter(); }
 
+namespace {
+// Whether the replayer executes records of `type`
+bool IsReplayed(TraceType type) {
+  return type == kTraceWrite || type == kTraceGet ||
+         type == kTraceIteratorSeek || type == kTraceIteratorSeekForPrev ||
+         type == kTraceMultiGet;
+}
+
+const char* TraceTypeName(TraceType type) {
+  switch (type) {
+    case kTraceWrite:
+      return "Write";
+    case kTraceGet:
+      return "Get";
+    case kTraceIteratorSeek:
+      return "IteratorSeek";
+    case kTraceIteratorSeekForPrev:
+      return "IteratorSeekForPrev";
+    case kTraceMultiGet:
+      return "MultiGet";
+    default:
+      return "Other";
+  }
+}
+
+// Rebuilds a write batch with its keys remapped
+class RemapKeysHandler : public WriteBatch::Handler {
+ public:
+  RemapKeysHandler(WriteBatch* batch,
+                   std::function<std::string(const Slice&)> remap)
+      : batch_(batch), remap_(std::move(remap)) {}
+
+  Status PutCF(uint32_t cf_id, const Slice& key, const Slice& value) override {
+    return WriteBatchInternal::Put(batch_, cf_id, remap_(key), value);
+  }
+  Status DeleteCF(uint32_t cf_id, const Slice& key) override {
+    return WriteBatchInternal::Delete(batch_, cf_id, remap_(key));
+  }
+  Status SingleDeleteCF(uint32_t cf_id, const Slice& key) override {
+    return WriteBatchInternal::SingleDelete(batch_, cf_id, remap_(key));
+  }
+  Status DeleteRangeCF(uint32_t cf_id, const Slice& begin_key,
+                       const Slice& end_key) override {
+    return WriteBatchInternal::DeleteRange(batch_, cf_id, remap_(begin_key),
+                                           remap_(end_key));
+  }
+  Status MergeCF(uint32_t cf_id, const Slice& key,
+                 const Slice& value) override {
+    return WriteBatchInternal::Merge(batch_, cf_id, remap_(key), value);
+  }
+  void LogData(const Slice& blob) override {
+    batch_->PutLogData(blob).PermitUncheckedError();
+  }
+
+ private:
+  WriteBatch* batch_;
+  std::function<std::string(const Slice&)> remap_;
+};
+}  // namespace
+
 Replayer::Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
                    std::unique_ptr<TraceReader>&& reader)
     : trace_reader_(std::move(reader)) {
@@ -480,7 +546,8 @@ Replayer::Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
   for (ColumnFamilyHandle* cfh : handles) {
     cf_map_[cfh->GetID()] = cfh;
   }
-  fast_forward_ = 1;
+  speed_ = 1;
+  keyspace_multiplier_ = 1;
 }
 
 Replayer::~Replayer() { trace_reader_.reset(); }
@@ -490,12 +557,205 @@ Status Replayer::SetFastForward(uint32_t fast_forward) {
   if (fast_forward < 1) {
     s = Status::InvalidArgument("Wrong fast forward speed!");
   } else {
-    fast_forward_ = fast_forward;
+    speed_ = fast_forward;
     s = Status::OK();
   }
   return s;
 }
 
+Status Replayer::SetReplaySpeed(double speed) {
+  if (!(speed > 0)) {
+    return Status::InvalidArgument("Wrong replay speed!");
+  }
+  speed_ = speed;
+  return Status::OK();
+}
+
+void Replayer::SetKeyPrefixRewrite(const std::string& from,
+                                   const std::string& to) {
+  key_prefix_from_ = from;
+  key_prefix_to_ = to;
+}
+
+Status Replayer::SetKeyspaceMultiplier(uint32_t multiplier) {
+  if (multiplier < 1) {
+    return Status::InvalidArgument("Wrong keyspace multiplier!");
+  }
+  keyspace_multiplier_ = multiplier;
+  return Status::OK();
+}
+
+std::string Replayer::GetLatencyReport() const {
+  std::ostringstream report;
+  MutexLock l(&latency_mutex_);
+  for (const auto& entry : latency_) {
+    report << "Replay latency of " << TraceTypeName(entry.first)
+           << " (microseconds):\n"
+           << entry.second->ToString() << "\n";
+  }
+  return report.str();
+}
+
+uint64_t Replayer::DueMicros(const Trace& trace, const Trace& header) const {
+  // Seek records are written when the iterator moves on, so they may carry
+  // a time before that of the record read ahead of them
+  if (trace.ts <= header.ts) {
+    return 0;
+  }
+  return static_cast<uint64_t>(static_cast<double>(trace.ts - header.ts) /
+                               speed_);
+}
+
+std::string Replayer::RemapKey(const Slice& key, uint32_t copy) const {
+  std::string result;
+  if (copy > 0) {
+    char buf[4];
+    buf[0] = static_cast<char>(copy >> 24);
+    buf[1] = static_cast<char>(copy >> 16);
+    buf[2] = static_cast<char>(copy >> 8);
+    buf[3] = static_cast<char>(copy);
+    result.assign(buf, sizeof(buf));
+  }
+  if (!key_prefix_from_.empty() && key.starts_with(key_prefix_from_)) {
+    result.append(key_prefix_to_);
+    result.append(key.data() + key_prefix_from_.size(),
+                  key.size() - key_prefix_from_.size());
+  } else {
+    result.append(key.data(), key.size());
+  }
+  return result;
+}
+
+Status Replayer::Execute(Trace* trace, uint32_t copy, const WriteOptions& wo,
+                         const ReadOptions& ro) {
+  const bool remap = copy > 0 || !key_prefix_from_.empty();
+  if (trace->type == kTraceWrite) {
+    Slice batch_data;
+    if (trace_file_version_ < 2) {
+      batch_data = trace->payload;
+    } else {
+      WritePayload w_payload;
+      TracerHelper::DecodeWritePayload(trace, &w_payload);
+      batch_data = w_payload.write_batch_data;
+    }
+    WriteBatch batch(batch_data.ToString());
+    if (remap) {
+      WriteBatch remapped;
+      RemapKeysHandler handler(&remapped, [this, copy](const Slice& key) {
+        return RemapKey(key, copy);
+      });
+      if (batch.Iterate(&handler).ok()) {
+        db_->Write(wo, &remapped).PermitUncheckedError();
+      }
+    } else {
+      db_->Write(wo, &batch).PermitUncheckedError();
+    }
+  } else if (trace->type == kTraceGet) {
+    GetPayload get_payload;
+    get_payload.cf_id = 0;
+    if (trace_file_version_ < 2) {
+      DecodeCFAndKey(trace->payload, &get_payload.cf_id, &get_payload.get_key);
+    } else {
+      TracerHelper::DecodeGetPayload(trace, &get_payload);
+    }
+    if (get_payload.cf_id > 0 &&
+        cf_map_.find(get_payload.cf_id) == cf_map_.end()) {
+      return Status::Corruption("Invalid Column Family ID.");
+    }
+
+    const std::string key = RemapKey(get_payload.get_key, copy);
+    std::string value;
+    if (get_payload.cf_id == 0) {
+      db_->Get(ro, key, &value).PermitUncheckedError();
+    } else {
+      db_->Get(ro, cf_map_[get_payload.cf_id], key, &value)
+          .PermitUncheckedError();
+    }
+  } else if (trace->type == kTraceIteratorSeek ||
+             trace->type == kTraceIteratorSeekForPrev) {
+    IterPayload iter_payload;
+    iter_payload.cf_id = 0;
+    if (trace_file_version_ < 2) {
+      DecodeCFAndKey(trace->payload, &iter_payload.cf_id,
+                     &iter_payload.iter_key);
+    } else {
+      TracerHelper::DecodeIterPayload(trace, &iter_payload);
+    }
+    if (iter_payload.cf_id > 0 &&
+        cf_map_.find(iter_payload.cf_id) == cf_map_.end()) {
+      return Status::Corruption("Invalid Column Family ID.");
+    }
+
+    ReadOptions iter_ro = ro;
+    const std::string lower_bound = RemapKey(iter_payload.lower_bound, copy);
+    const std::string upper_bound = RemapKey(iter_payload.upper_bound, copy);
+    Slice lower_bound_slice(lower_bound);
+    Slice upper_bound_slice(upper_bound);
+    if (!iter_payload.lower_bound.empty()) {
+      iter_ro.iterate_lower_bound = &lower_bound_slice;
+    }
+    if (!iter_payload.upper_bound.empty()) {
+      iter_ro.iterate_upper_bound = &upper_bound_slice;
+    }
+    std::unique_ptr<Iterator> iter;
+    if (iter_payload.cf_id == 0) {
+      iter.reset(db_->NewIterator(iter_ro));
+    } else {
+      iter.reset(db_->NewIterator(iter_ro, cf_map_[iter_payload.cf_id]));
+    }
+    const std::string target = RemapKey(iter_payload.iter_key, copy);
+    if (trace->type == kTraceIteratorSeek) {
+      iter->Seek(target);
+    } else {
+      iter->SeekForPrev(target);
+    }
+    // The trace only has the number of steps in either direction, so the
+    // steps forward are taken first
+    for (uint64_t i = 0; i < iter_payload.next_count && iter->Valid(); i++) {
+      iter->Next();
+    }
+    for (uint64_t i = 0; i < iter_payload.prev_count && iter->Valid(); i++) {
+      iter->Prev();
+    }
+  } else if (trace->type == kTraceMultiGet) {
+    MultiGetPayload multiget_payload;
+    if (trace_file_version_ < 2) {
+      return Status::OK();
+    }
+    TracerHelper::DecodeMultiGetPayload(trace, &multiget_payload);
+    if (multiget_payload.cf_ids.size() !=
+        multiget_payload.multiget_keys.size()) {
+      return Status::Corruption("Invalid MultiGet payload.");
+    }
+    std::vector<ColumnFamilyHandle*> v_cfd;
+    std::vector<std::string> key_data;
+    for (size_t i = 0; i < multiget_payload.cf_ids.size(); i++) {
+      if (cf_map_.find(multiget_payload.cf_ids[i]) == cf_map_.end()) {
+        return Status::Corruption("Invalid Column Family ID.");
+      }
+      v_cfd.push_back(cf_map_[multiget_payload.cf_ids[i]]);
+      key_data.push_back(RemapKey(multiget_payload.multiget_keys[i], copy));
+    }
+    std::vector<Slice> keys(key_data.begin(), key_data.end());
+    std::vector<std::string> values;
+    std::vector<Status> ss = db_->MultiGet(ro, v_cfd, keys, &values);
+    for (Status& status : ss) {
+      status.PermitUncheckedError();
+    }
+  }
+  return Status::OK();
+}
+
+void Replayer::RecordLatency(TraceType type, uint64_t start_micros) {
+  const uint64_t end_micros = env_->NowMicros();
+  MutexLock l(&latency_mutex_);
+  std::unique_ptr<HistogramImpl>& hist = latency_[type];
+  if (hist == nullptr) {
+    hist.reset(new HistogramImpl());
+  }
+  hist->Add(end_micros > start_micros ? end_micros - start_micros : 0);
+}
+
 Status Replayer::Replay() {
   Status s;
   Trace header;
@@ -511,126 +771,38 @@ Status Replayer::Replay() {
 
   std::chrono::system_clock::time_point replay_epoch =
       std::chrono::system_clock::now();
+  const uint64_t epoch_micros = env_->NowMicros();
   WriteOptions woptions;
   ReadOptions roptions;
   Trace trace;
   uint64_t ops = 0;
-  Iterator* single_iter = nullptr;
   while (s.ok()) {
     trace.reset();
     s = ReadTrace(&trace);
     if (!s.ok()) {
       break;
     }
-
-    std::this_thread::sleep_until(
-        replay_epoch +
-        std::chrono::microseconds((trace.ts - header.ts) / fast_forward_));
-    if (trace.type == kTraceWrite) {
-      if (trace_file_version_ < 2) {
-        WriteBatch batch(trace.payload);
-        db_->Write(woptions, &batch);
-      } else {
-        WritePayload w_payload;
-        TracerHelper::DecodeWritePayload(&trace, &w_payload);
-        WriteBatch batch(w_payload.write_batch_data.ToString());
-        db_->Write(woptions, &batch);
-      }
-      ops++;
-    } else if (trace.type == kTraceGet) {
-      GetPayload get_payload;
-      get_payload.cf_id = 0;
-      get_payload.get_key = 0;
-      if (trace_file_version_ < 2) {
-        DecodeCFAndKey(trace.payload, &get_payload.cf_id, &get_payload.get_key);
-      } else {
-        TracerHelper::DecodeGetPayload(&trace, &get_payload);
-      }
-      if (get_payload.cf_id > 0 &&
-          cf_map_.find(get_payload.cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
-      }
-
-      std::string value;
-      if (get_payload.cf_id == 0) {
-        db_->Get(roptions, get_payload.get_key, &value);
-      } else {
-        db_->Get(roptions, cf_map_[get_payload.cf_id], get_payload.get_key,
-                 &value);
-      }
-      ops++;
-    } else if (trace.type == kTraceIteratorSeek) {
-      // Currently, we only support to call Seek. The Next() and Prev() is not
-      // supported.
-      IterPayload iter_payload;
-      iter_payload.cf_id = 0;
-      if (trace_file_version_ < 2) {
-        DecodeCFAndKey(trace.payload, &iter_payload.cf_id,
-                       &iter_payload.iter_key);
-      } else {
-        TracerHelper::DecodeIterPayload(&trace, &iter_payload);
-      }
-      if (iter_payload.cf_id > 0 &&
-          cf_map_.find(iter_payload.cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
-      }
-
-      if (iter_payload.cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
-      } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[iter_payload.cf_id]);
-      }
-      single_iter->Seek(iter_payload.iter_key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceIteratorSeekForPrev) {
-      // Currently, we only support to call SeekForPrev. The Next() and Prev()
-      // is not supported.
-      IterPayload iter_payload;
-      iter_payload.cf_id = 0;
-      if (trace_file_version_ < 2) {
-        DecodeCFAndKey(trace.payload, &iter_payload.cf_id,
-                       &iter_payload.iter_key);
-      } else {
-        TracerHelper::DecodeIterPayload(&trace, &iter_payload);
-      }
-      if (iter_payload.cf_id > 0 &&
-          cf_map_.find(iter_payload.cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
-      }
-
-      if (iter_payload.cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
-      } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[iter_payload.cf_id]);
-      }
-      single_iter->SeekForPrev(iter_payload.iter_key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceMultiGet) {
-      MultiGetPayload multiget_payload;
-      assert(trace_file_version_ >= 2);
-      TracerHelper::DecodeMultiGetPayload(&trace, &multiget_payload);
-      std::vector<ColumnFamilyHandle*> v_cfd;
-      std::vector<Slice> keys;
-      assert(multiget_payload.cf_ids.size() ==
-             multiget_payload.multiget_keys.size());
-      for (size_t i = 0; i < multiget_payload.cf_ids.size(); i++) {
-        assert(i < multiget_payload.cf_ids.size() &&
-               i < multiget_payload.multiget_keys.size());
-        if (cf_map_.find(multiget_payload.cf_ids[i]) == cf_map_.end()) {
-          return Status::Corruption("Invalid Column Family ID.");
-        }
-        v_cfd.push_back(cf_map_[multiget_payload.cf_ids[i]]);
-        keys.push_back(Slice(multiget_payload.multiget_keys[i]));
-      }
-      std::vector<std::string> values;
-      std::vector<Status> ss = db_->MultiGet(roptions, v_cfd, keys, &values);
-    } else if (trace.type == kTraceEnd) {
+    if (trace.type == kTraceEnd) {
       // Do nothing for now.
       // TODO: Add some validations later.
       break;
     }
+    if (!IsReplayed(trace.type)) {
+      continue;
+    }
+
+    const uint64_t due_micros = DueMicros(trace, header);
+    std::this_thread::sleep_until(replay_epoch +
+                                  std::chrono::microseconds(due_micros));
+    const uint64_t start_micros =
+        std::max(epoch_micros + due_micros, env_->NowMicros());
+    for (uint32_t copy = 0; copy < keyspace_multiplier_ && s.ok(); copy++) {
+      s = Execute(&trace, copy, woptions, roptions);
+    }
+    if (s.ok()) {
+      RecordLatency(trace.type, start_micros);
+      ops++;
+    }
   }
 
   if (s.IsIncomplete()) {
@@ -646,7 +818,8 @@ Status Replayer::Replay() {
 // threads in the thread pool. Trace records are read from the trace file
 // sequentially and the corresponding queries are scheduled in the task
 // queue based on the timestamp. Currently, we support Write_batch (Put,
-// Delete, SingleDelete, DeleteRange), Get, Iterator (Seek and SeekForPrev).
+// Delete, SingleDelete, DeleteRange), Get, Iterator (Seek and SeekForPrev)
+// and MultiGet.
 Status Replayer::MultiThreadReplay(uint32_t threads_num) {
   Status s;
   Trace header;
@@ -670,53 +843,43 @@ Status Replayer::MultiThreadReplay(uint32_t threads_num) {
 
   std::chrono::system_clock::time_point replay_epoch =
       std::chrono::system_clock::now();
+  const uint64_t epoch_micros = env_->NowMicros();
   WriteOptions woptions;
   ReadOptions roptions;
   uint64_t ops = 0;
   while (s.ok()) {
-    std::unique_ptr<ReplayerWorkerArg> ra(new ReplayerWorkerArg);
-    ra->db = db_;
-    s = ReadTrace(&(ra->trace_entry));
+    Trace trace;
+    s = ReadTrace(&trace);
     if (!s.ok()) {
       break;
     }
-    ra->cf_map = &cf_map_;
-    ra->woptions = woptions;
-    ra->roptions = roptions;
-    ra->trace_file_version = trace_file_version_;
-
-    std::this_thread::sleep_until(
-        replay_epoch + std::chrono::microseconds(
-                           (ra->trace_entry.ts - header.ts) / fast_forward_));
-    if (ra->trace_entry.type == kTraceWrite) {
-      thread_pool.Schedule(&Replayer::BGWorkWriteBatch, ra.release(), nullptr,
-                           nullptr);
-      ops++;
-    } else if (ra->trace_entry.type == kTraceGet) {
-      thread_pool.Schedule(&Replayer::BGWorkGet, ra.release(), nullptr,
-                           nullptr);
-      ops++;
-    } else if (ra->trace_entry.type == kTraceIteratorSeek) {
-      thread_pool.Schedule(&Replayer::BGWorkIterSeek, ra.release(), nullptr,
-                           nullptr);
-      ops++;
-    } else if (ra->trace_entry.type == kTraceIteratorSeekForPrev) {
-      thread_pool.Schedule(&Replayer::BGWorkIterSeekForPrev, ra.release(),
-                           nullptr, nullptr);
-      ops++;
-    } else if (ra->trace_entry.type == kTraceMultiGet) {
-      thread_pool.Schedule(&Replayer::BGWorkMultiGet, ra.release(), nullptr,
-                           nullptr);
-      ops++;
-    } else if (ra->trace_entry.type == kTraceEnd) {
+    if (trace.type == kTraceEnd) {
       // Do nothing for now.
       // TODO: Add some validations later.
       break;
-    } else {
+    }
+    if (!IsReplayed(trace.type)) {
       // Other trace entry types that are not implemented for replay.
       // To finish the replay, we continue the process.
       continue;
     }
+
+    const uint64_t due_micros = DueMicros(trace, header);
+    std::this_thread::sleep_until(replay_epoch +
+                                  std::chrono::microseconds(due_micros));
+    const uint64_t start_micros =
+        std::max(epoch_micros + due_micros, env_->NowMicros());
+    for (uint32_t copy = 0; copy < keyspace_multiplier_; copy++) {
+      std::unique_ptr<ReplayerWorkerArg> ra(new ReplayerWorkerArg);
+      ra->replayer = this;
+      ra->trace_entry = trace;
+      ra->woptions = woptions;
+      ra->roptions = roptions;
+      ra->copy = copy;
+      ra->start_micros = start_micros;
+      thread_pool.Schedule(&Replayer::BGWork, ra.release(), nullptr, nullptr);
+    }
+    ops++;
   }
 
   if (s.IsIncomplete()) {
@@ -774,142 +937,15 @@ Status Replayer::ReadTrace(Trace* trace) {
   return TracerHelper::DecodeTrace(encoded_trace, trace);
 }
 
-void Replayer::BGWorkGet(void* arg) {
+void Replayer::BGWork(void* arg) {
   std::unique_ptr<ReplayerWorkerArg> ra(
       reinterpret_cast<ReplayerWorkerArg*>(arg));
   assert(ra != nullptr);
-  auto cf_map = static_cast<std::unordered_map<uint32_t, ColumnFamilyHandle*>*>(
-      ra->cf_map);
-  GetPayload get_payload;
-  get_payload.cf_id = 0;
-  if (ra->trace_file_version < 2) {
-    DecodeCFAndKey(ra->trace_entry.payload, &get_payload.cf_id,
-                   &get_payload.get_key);
-  } else {
-    TracerHelper::DecodeGetPayload(&(ra->trace_entry), &get_payload);
-  }
-  if (get_payload.cf_id > 0 &&
-      cf_map->find(get_payload.cf_id) == cf_map->end()) {
-    return;
-  }
-
-  std::string value;
-  if (get_payload.cf_id == 0) {
-    ra->db->Get(ra->roptions, get_payload.get_key, &value);
-  } else {
-    ra->db->Get(ra->roptions, (*cf_map)[get_payload.cf_id], get_payload.get_key,
-                &value);
-  }
-  return;
-}
-
-void Replayer::BGWorkWriteBatch(void* arg) {
-  std::unique_ptr<ReplayerWorkerArg> ra(
-      reinterpret_cast<ReplayerWorkerArg*>(arg));
-  assert(ra != nullptr);
-
-  if (ra->trace_file_version < 2) {
-    WriteBatch batch(ra->trace_entry.payload);
-    ra->db->Write(ra->woptions, &batch);
-  } else {
-    WritePayload w_payload;
-    TracerHelper::DecodeWritePayload(&(ra->trace_entry), &w_payload);
-    WriteBatch batch(w_payload.write_batch_data.ToString());
-    ra->db->Write(ra->woptions, &batch);
-  }
-  return;
-}
-
-void Replayer::BGWorkIterSeek(void* arg) {
-  std::unique_ptr<ReplayerWorkerArg> ra(
-      reinterpret_cast<ReplayerWorkerArg*>(arg));
-  assert(ra != nullptr);
-  auto cf_map = static_cast<std::unordered_map<uint32_t, ColumnFamilyHandle*>*>(
-      ra->cf_map);
-  IterPayload iter_payload;
-  iter_payload.cf_id = 0;
-
-  if (ra->trace_file_version < 2) {
-    DecodeCFAndKey(ra->trace_entry.payload, &iter_payload.cf_id,
-                   &iter_payload.iter_key);
-  } else {
-    TracerHelper::DecodeIterPayload(&(ra->trace_entry), &iter_payload);
-  }
-  if (iter_payload.cf_id > 0 &&
-      cf_map->find(iter_payload.cf_id) == cf_map->end()) {
-    return;
-  }
-
-  Iterator* single_iter = nullptr;
-  if (iter_payload.cf_id == 0) {
-    single_iter = ra->db->NewIterator(ra->roptions);
-  } else {
-    single_iter =
-        ra->db->NewIterator(ra->roptions, (*cf_map)[iter_payload.cf_id]);
-  }
-  single_iter->Seek(iter_payload.iter_key);
-  delete single_iter;
-  return;
-}
-
-void Replayer::BGWorkIterSeekForPrev(void* arg) {
-  std::unique_ptr<ReplayerWorkerArg> ra(
-      reinterpret_cast<ReplayerWorkerArg*>(arg));
-  assert(ra != nullptr);
-  auto cf_map = static_cast<std::unordered_map<uint32_t, ColumnFamilyHandle*>*>(
-      ra->cf_map);
-  IterPayload iter_payload;
-  iter_payload.cf_id = 0;
-
-  if (ra->trace_file_version < 2) {
-    DecodeCFAndKey(ra->trace_entry.payload, &iter_payload.cf_id,
-                   &iter_payload.iter_key);
-  } else {
-    TracerHelper::DecodeIterPayload(&(ra->trace_entry), &iter_payload);
-  }
-  if (iter_payload.cf_id > 0 &&
-      cf_map->find(iter_payload.cf_id) == cf_map->end()) {
-    return;
-  }
-
-  Iterator* single_iter = nullptr;
-  if (iter_payload.cf_id == 0) {
-    single_iter = ra->db->NewIterator(ra->roptions);
-  } else {
-    single_iter =
-        ra->db->NewIterator(ra->roptions, (*cf_map)[iter_payload.cf_id]);
-  }
-  single_iter->SeekForPrev(iter_payload.iter_key);
-  delete single_iter;
-  return;
-}
-
-void Replayer::BGWorkMultiGet(void* arg) {
-  std::unique_ptr<ReplayerWorkerArg> ra(
-      reinterpret_cast<ReplayerWorkerArg*>(arg));
-  assert(ra != nullptr);
-  auto cf_map = static_cast<std::unordered_map<uint32_t, ColumnFamilyHandle*>*>(
-      ra->cf_map);
-  MultiGetPayload multiget_payload;
-  if (ra->trace_file_version < 2) {
-    return;
-  }
-  TracerHelper::DecodeMultiGetPayload(&(ra->trace_entry), &multiget_payload);
-  std::vector<ColumnFamilyHandle*> v_cfd;
-  std::vector<Slice> keys;
-  if (multiget_payload.cf_ids.size() != multiget_payload.multiget_keys.size()) {
-    return;
-  }
-  for (size_t i = 0; i < multiget_payload.cf_ids.size(); i++) {
-    if (cf_map->find(multiget_payload.cf_ids[i]) == cf_map->end()) {
-      return;
-    }
-    v_cfd.push_back((*cf_map)[multiget_payload.cf_ids[i]]);
-    keys.push_back(Slice(multiget_payload.multiget_keys[i]));
+  Status s = ra->replayer->Execute(&ra->trace_entry, ra->copy, ra->woptions,
+                                   ra->roptions);
+  if (s.ok()) {
+    ra->replayer->RecordLatency(ra->trace_entry.type, ra->start_micros);
   }
-  std::vector<std::string> values;
-  std::vector<Status> ss = ra->db->MultiGet(ra->roptions, v_cfd, keys, &values);
-  return;
 }
 
 }  // namespace ROCKSDB_NAMESPACE
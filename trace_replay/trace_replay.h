@@ -5,10 +5,14 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <utility>
 
+#include "monitoring/histogram.h"
+#include "port/port.h"
 #include "rocksdb/options.h"
 #include "rocksdb/rocksdb_namespace.h"
 #include "rocksdb/status.h"
@@ -41,7 +45,7 @@ const unsigned int kTraceMetadataSize =
     kTraceTimestampSize + kTraceTypeSize + kTracePayloadLengthSize;
 
 static const int kTraceFileMajorVersion = 0;
-static const int kTraceFileMinorVersion = 2;
+static const int kTraceFileMinorVersion = 3;
 
 // Supported Trace types.
 enum TraceType : char {
@@ -103,6 +107,9 @@ enum TracePayloadType : char {
   kMultiGetSize = 8,
   kMultiGetCFIDs = 9,
   kMultiGetKeys = 10,
+  // Since trace version 0.3
+  kIterNextCount = 11,
+  kIterPrevCount = 12,
 };
 
 struct WritePayload {
@@ -119,6 +126,10 @@ struct IterPayload {
   Slice iter_key;
   Slice lower_bound;
   Slice upper_bound;
+  // The number of calls to Next() and Prev() after the seek, before the
+  // iterator was positioned again or destroyed
+  uint64_t next_count = 0;
+  uint64_t prev_count = 0;
 };
 
 struct MultiGetPayload {
@@ -175,11 +186,17 @@ class Tracer {
   // Trace Get operations.
   Status Get(ColumnFamilyHandle* cfname, const Slice& key);
 
-  // Trace Iterators.
+  // Trace Iterators. The trace gets the time of the seek, `seek_micros`, or
+  // the current time if 0, and is followed by `next_count` calls to Next()
+  // and `prev_count` calls to Prev().
   Status IteratorSeek(const uint32_t& cf_id, const Slice& key,
-                      const Slice& lower_bound, const Slice upper_bound);
+                      const Slice& lower_bound, const Slice upper_bound,
+                      uint64_t seek_micros = 0, uint64_t next_count = 0,
+                      uint64_t prev_count = 0);
   Status IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
-                             const Slice& lower_bound, const Slice upper_bound);
+                             const Slice& lower_bound, const Slice upper_bound,
+                             uint64_t seek_micros = 0, uint64_t next_count = 0,
+                             uint64_t prev_count = 0);
 
   // Trace MultiGet
 
@@ -212,6 +229,12 @@ class Tracer {
   // system, say, a filesystem or a streaming service.
   Status WriteTrace(const Trace& trace);
 
+  // Shared by IteratorSeek() and IteratorSeekForPrev()
+  Status IteratorTrace(TraceType trace_type, const uint32_t& cf_id,
+                       const Slice& key, const Slice& lower_bound,
+                       const Slice& upper_bound, uint64_t seek_micros,
+                       uint64_t next_count, uint64_t prev_count);
+
   // Helps in filtering and sampling of traces.
   // Returns true if a trace should be skipped, false otherwise.
   bool ShouldSkipTrace(const TraceType& type);
@@ -247,50 +270,76 @@ class Replayer {
   //   If > 1, speed up the replay by this amount.
   Status SetFastForward(uint32_t fast_forward);
 
+  // Like SetFastForward(), but also takes fractional speeds: 0.5 replays at
+  // half the traced rate.
+  Status SetReplaySpeed(double speed);
+
+  // Replaces the prefix `from` of every replayed key (and iterator bound)
+  // with `to`, e.g. to replay the trace of one tenant against another.
+  void SetKeyPrefixRewrite(const std::string& from, const std::string& to);
+
+  // Replays every record `multiplier` times, to reproduce the load of a
+  // larger keyspace. Copy 0 uses the traced keys; copy i > 0 prepends i as
+  // 4 big-endian bytes to them, so that every copy is a contiguous, ordered
+  // keyspace of its own.
+  Status SetKeyspaceMultiplier(uint32_t multiplier);
+
+  // Per operation type, the latency of the replayed operations since the
+  // replayer was created. An operation is timed from when the trace says it
+  // is due, or from when it was read from the trace if that is later, so
+  // that a replay falling behind shows as latency.
+  std::string GetLatencyReport() const;
+
  private:
   Status ReadHeader(Trace* header);
   Status ReadFooter(Trace* footer);
   Status ReadTrace(Trace* trace);
 
-  // The background function for MultiThreadReplay to execute Get query
-  // based on the trace records.
-  static void BGWorkGet(void* arg);
+  // Microseconds after the start of the replay that `trace` is due
+  uint64_t DueMicros(const Trace& trace, const Trace& header) const;
 
-  // The background function for MultiThreadReplay to execute WriteBatch
-  // (Put, Delete, SingleDelete, DeleteRange) based on the trace records.
-  static void BGWorkWriteBatch(void* arg);
+  // Applies the prefix rewrite and keyspace copy `copy` to `key`
+  std::string RemapKey(const Slice& key, uint32_t copy) const;
 
-  // The background function for MultiThreadReplay to execute Iterator (Seek)
-  // based on the trace records.
-  static void BGWorkIterSeek(void* arg);
+  // Executes one trace record against the DB, as keyspace copy `copy`.
+  // Returns Corruption if it names an unknown column family; the statuses
+  // of the operations themselves are ignored.
+  Status Execute(Trace* trace, uint32_t copy, const WriteOptions& wo,
+                 const ReadOptions& ro);
 
-  // The background function for MultiThreadReplay to execute Iterator
-  // (SeekForPrev) based on the trace records.
-  static void BGWorkIterSeekForPrev(void* arg);
+  // Times an operation that started at `start_micros`
+  void RecordLatency(TraceType type, uint64_t start_micros);
 
-  // The background function for MultiThreadReplay to execute MultiGet based on
-  // the trace records
-  static void BGWorkMultiGet(void* arg);
+  // The background function for MultiThreadReplay to execute a trace record
+  static void BGWork(void* arg);
 
   DBImpl* db_;
   Env* env_;
   std::unique_ptr<TraceReader> trace_reader_;
   std::unordered_map<uint32_t, ColumnFamilyHandle*> cf_map_;
-  uint32_t fast_forward_;
+  double speed_;
+  std::string key_prefix_from_;
+  std::string key_prefix_to_;
+  uint32_t keyspace_multiplier_;
   // When reading the trace header, the trace file version can be parsed.
   // Replayer will use different decode method to get the trace content based
   // on different trace file version.
   int trace_file_version_;
+
+  mutable port::Mutex latency_mutex_;
+  std::map<TraceType, std::unique_ptr<HistogramImpl>> latency_;
 };
 
 // The passin arg of MultiThreadRepkay for each trace record.
 struct ReplayerWorkerArg {
-  DB* db;
+  Replayer* replayer;
   Trace trace_entry;
-  std::unordered_map<uint32_t, ColumnFamilyHandle*>* cf_map;
   WriteOptions woptions;
   ReadOptions roptions;
-  int trace_file_version;
+  // Keyspace copy to replay the record as
+  uint32_t copy;
+  // When the operation starts being timed
+  uint64_t start_micros;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
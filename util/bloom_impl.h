@@ -338,6 +338,70 @@ class FastLocalBloomImpl {
     return true;
 #endif
   }
+
+  // Batched form of HashMayMatchPrepared, for (e.g.) MultiGet. All cache
+  // lines should already have been prefetched with PrepareHash, so that the
+  // memory latency of the batch overlaps. With AVX-512, the probes of two
+  // keys are checked together in one 512-bit vector, each key's cache line
+  // fitting in a single register.
+  static inline void HashesMayMatchPrepared(int num_keys, const uint32_t *h2s,
+                                            const uint32_t *byte_offsets,
+                                            int num_probes, const char *data,
+                                            bool *may_match) {
+    int i = 0;
+#if defined(HAVE_AVX2) && defined(__AVX512F__)
+#if defined(__GNUC__) && !defined(__clang__)
+    // GCC reports the deliberately undefined pass-through operands inside
+    // its own AVX-512 intrinsics as maybe-uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    if (num_probes <= 8) {
+      // Powers of 32-bit golden ratio, mod 2**32, once for each key.
+      const __m512i multipliers = _mm512_setr_epi32(
+          0x00000001, 0x9e3779b9, 0xe35e67b1, 0x734297e9, 0x35fbe861,
+          0xdeb7c719, 0x448b211, 0x3459b749, 0x00000001, 0x9e3779b9,
+          0xe35e67b1, 0x734297e9, 0x35fbe861, 0xdeb7c719, 0x448b211,
+          0x3459b749);
+      const __m512i ones = _mm512_set1_epi32(1);
+      // Lanes 0-7 are for the first key, 8-15 for the second, and only the
+      // first num_probes of each eight are used.
+      const __mmask16 probes_mask =
+          static_cast<__mmask16>(((1U << num_probes) - 1) * 0x101U);
+      for (; i + 1 < num_keys; i += 2) {
+        __m512i hash_vector =
+            _mm512_mask_blend_epi32(0xff00, _mm512_set1_epi32(h2s[i]),
+                                    _mm512_set1_epi32(h2s[i + 1]));
+        hash_vector = _mm512_mullo_epi32(hash_vector, multipliers);
+        // Same addressing as HashMayMatchPrepared: 4-bit word address, then
+        // 5-bit address within the 32-bit word.
+        const __m512i word_addresses = _mm512_srli_epi32(hash_vector, 28);
+        const __m512i line0 = _mm512_loadu_si512(data + byte_offsets[i]);
+        const __m512i line1 = _mm512_loadu_si512(data + byte_offsets[i + 1]);
+        // Each key's probed words, from its own cache line
+        const __m512i value_vector = _mm512_mask_permutexvar_epi32(
+            _mm512_permutexvar_epi32(word_addresses, line0), 0xff00,
+            word_addresses, line1);
+        const __m512i bit_addresses =
+            _mm512_srli_epi32(_mm512_slli_epi32(hash_vector, 4), 27);
+        const __m512i bit_mask = _mm512_sllv_epi32(ones, bit_addresses);
+        // Lanes with a probed bit not set
+        const __m512i missing = _mm512_andnot_si512(value_vector, bit_mask);
+        const __mmask16 misses =
+            _mm512_mask_test_epi32_mask(probes_mask, missing, missing);
+        may_match[i] = (misses & 0xff) == 0;
+        may_match[i + 1] = (misses >> 8) == 0;
+      }
+    }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+    for (; i < num_keys; ++i) {
+      may_match[i] =
+          HashMayMatchPrepared(h2s[i], num_probes, data + byte_offsets[i]);
+    }
+  }
 };
 
 // A legacy Bloom filter implementation with no locality of probes (slow).
@@ -23,6 +23,7 @@ int main() {
 #include "port/jemalloc_helper.h"
 #include "rocksdb/filter_policy.h"
 #include "table/block_based/filter_policy_internal.h"
+#include "table/multiget_context.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/gflags_compat.h"
@@ -345,6 +346,13 @@ class FullBloomTest : public testing::TestWithParam<BloomFilterPolicy::Mode> {
     return bits_reader_->MayMatch(s);
   }
 
+  void BatchMatches(int num_keys, Slice** keys, bool* may_match) {
+    if (bits_reader_ == nullptr) {
+      Build();
+    }
+    bits_reader_->MayMatch(num_keys, keys, may_match);
+  }
+
   // Provides a kind of fingerprint on the Bloom filter's
   // behavior, for reasonbly high FP rates.
   uint64_t PackedMatches() {
@@ -521,6 +529,43 @@ TEST_P(FullBloomTest, FullVaryingLengths) {
   EXPECT_LE(mediocre_filters, good_filters / 5);
 }
 
+TEST_P(FullBloomTest, BatchedMayMatch) {
+  char buffer[sizeof(int)];
+  std::array<std::string, MultiGetContext::MAX_BATCH_SIZE> keys;
+  std::array<Slice, MultiGetContext::MAX_BATCH_SIZE> key_slices;
+  std::array<Slice*, MultiGetContext::MAX_BATCH_SIZE> key_ptrs;
+  std::array<bool, MultiGetContext::MAX_BATCH_SIZE> may_match;
+
+  // Wide range of num_probes, including more than a SIMD vector's worth, and
+  // high FP rates so that batched and one-at-a-time results disagree if
+  // any probe is mishandled.
+  for (double bpk : {1.0, 2.0, 5.0, 10.0, 16.0, 24.0}) {
+    ResetPolicy(bpk);
+    const int kNumKeys = 500;
+    for (int i = 0; i < kNumKeys; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+
+    int next = 0;
+    for (int batch_size = 1; batch_size <= MultiGetContext::MAX_BATCH_SIZE;
+         ++batch_size) {
+      for (int i = 0; i < batch_size; ++i) {
+        // Alternate runs of added and not added keys
+        keys[i] = Key(next, buffer).ToString();
+        next = (next + 7) % (kNumKeys * 2);
+        key_slices[i] = keys[i];
+        key_ptrs[i] = &key_slices[i];
+      }
+      BatchMatches(batch_size, key_ptrs.data(), may_match.data());
+      for (int i = 0; i < batch_size; ++i) {
+        ASSERT_EQ(Matches(keys[i]), may_match[i])
+            << "bpk " << bpk << "; batch size " << batch_size << "; key " << i;
+      }
+    }
+  }
+}
+
 TEST_P(FullBloomTest, OptimizeForMemory) {
   char buffer[sizeof(int)];
   for (bool offm : {true, false}) {
@@ -1190,6 +1235,79 @@ TEST_P(FullBloomTest, CorruptFilters) {
   ASSERT_TRUE(Matches("world"));
 }
 
+TEST(LevelOptimizedBloomTest, BitsPerKeyByLevel) {
+  BlockBasedTableOptions table_options;
+  FilterBuildingContext context(table_options);
+  const double kAverage = 10.0;
+
+  // Unknown LSM tree shape
+  context.level_at_creation = 1;
+  ASSERT_EQ(kAverage,
+            BloomFilterPolicy::GetLevelOptimizedBitsPerKey(kAverage, context));
+
+  // Two L0 files of 1MB, then levels growing by 10x
+  context.level_bytes = {2 << 20, 10 << 20, 100 << 20, 1000 << 20};
+  context.num_level0_files = 2;
+  std::vector<double> bits_per_key;
+  for (int level = 0; level < 4; ++level) {
+    context.level_at_creation = level;
+    bits_per_key.push_back(
+        BloomFilterPolicy::GetLevelOptimizedBitsPerKey(kAverage, context));
+  }
+  // Smaller sorted runs get more bits/key, by ln(10)/ln(2)^2 per 10x
+  for (int level = 1; level < 4; ++level) {
+    ASSERT_GT(bits_per_key[level - 1], bits_per_key[level]);
+  }
+  ASSERT_NEAR(bits_per_key[2] - bits_per_key[3],
+              std::log(10.0) / (std::log(2.0) * std::log(2.0)), 1e-9);
+  ASSERT_LT(bits_per_key[3], kAverage);
+  // Same total memory as kAverage everywhere
+  double total_bits = 2 * bits_per_key[0] * (1 << 20);
+  for (int level = 1; level < 4; ++level) {
+    total_bits += bits_per_key[level] * context.level_bytes[level];
+  }
+  ASSERT_NEAR(total_bits / (1112 << 20), kAverage, 1e-9);
+  // Less total FP rate than kAverage everywhere
+  const double kLn2Squared = std::log(2.0) * std::log(2.0);
+  double fp_sum = 2 * std::exp(-bits_per_key[0] * kLn2Squared);
+  for (int level = 1; level < 4; ++level) {
+    fp_sum += std::exp(-bits_per_key[level] * kLn2Squared);
+  }
+  ASSERT_LT(fp_sum, 5 * std::exp(-kAverage * kLn2Squared));
+
+  // With a tiny budget, large levels stay at the 1 bit/key minimum and the
+  // rest is spread over the smaller sorted runs
+  context.level_at_creation = 3;
+  ASSERT_EQ(1.0, BloomFilterPolicy::GetLevelOptimizedBitsPerKey(1.5, context));
+  context.level_at_creation = 0;
+  ASSERT_GT(BloomFilterPolicy::GetLevelOptimizedBitsPerKey(1.5, context),
+            1.5);
+
+  // Filters built from the policy follow the chosen bits/key
+  table_options.format_version = 5;
+  std::unique_ptr<const FilterPolicy> policy(
+      NewLevelOptimizedFilterPolicy(kAverage));
+  auto bloom_policy = static_cast<const BloomFilterPolicy*>(policy.get());
+  ASSERT_TRUE(bloom_policy->GetOptimizePerLevel());
+  FilterBuildingContext policy_context(table_options);
+  policy_context.level_bytes = context.level_bytes;
+  policy_context.num_level0_files = context.num_level0_files;
+  size_t filter_bytes[2];
+  for (int i = 0; i < 2; ++i) {
+    policy_context.level_at_creation = i == 0 ? 0 : 3;
+    std::unique_ptr<FilterBitsBuilder> builder(
+        bloom_policy->GetBuilderWithContext(policy_context));
+    ASSERT_NE(builder, nullptr);
+    char buffer[sizeof(int)];
+    for (int key = 0; key < 10000; ++key) {
+      builder->AddKey(Key(key, buffer));
+    }
+    std::unique_ptr<const char[]> buf;
+    filter_bytes[i] = builder->Finish(&buf).size();
+  }
+  ASSERT_GT(filter_bytes[0], filter_bytes[1] * 2);
+}
+
 INSTANTIATE_TEST_CASE_P(Full, FullBloomTest,
                         testing::Values(BloomFilterPolicy::kLegacyBloom,
                                         BloomFilterPolicy::kFastLocalBloom,
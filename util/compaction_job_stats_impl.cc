@@ -44,6 +44,8 @@ void CompactionJobStats::Reset() {
   file_range_sync_nanos = 0;
   file_fsync_nanos = 0;
   file_prepare_write_nanos = 0;
+  file_read_nanos = 0;
+  file_read_bytes = 0;
 
   smallest_output_key_prefix.clear();
   largest_output_key_prefix.clear();
@@ -84,6 +86,8 @@ void CompactionJobStats::Add(const CompactionJobStats& stats) {
   file_range_sync_nanos += stats.file_range_sync_nanos;
   file_fsync_nanos += stats.file_fsync_nanos;
   file_prepare_write_nanos += stats.file_prepare_write_nanos;
+  file_read_nanos += stats.file_read_nanos;
+  file_read_bytes += stats.file_read_bytes;
 
   num_single_del_fallthru += stats.num_single_del_fallthru;
   num_single_del_mismatch += stats.num_single_del_mismatch;
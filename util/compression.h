@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
 #ifdef OS_FREEBSD
 #include <malloc_np.h>
@@ -21,6 +22,7 @@
 #include <string>
 
 #include "memory/memory_allocator.h"
+#include "rocksdb/compressor.h"
 #include "rocksdb/options.h"
 #include "rocksdb/table.h"
 #include "test_util/sync_point.h"
@@ -233,8 +235,9 @@ struct UncompressionDict {
   Slice slice_;
 
 #ifdef ROCKSDB_ZSTD_DDICT
-  // Processed version of the contents of slice_ for ZSTD compression.
-  ZSTD_DDict* zstd_ddict_ = nullptr;
+  // Processed version of the contents of slice_ for ZSTD compression, shared
+  // with the other dictionaries of the same contents.
+  std::shared_ptr<ZSTD_DDict> zstd_ddict_;
 #endif  // ROCKSDB_ZSTD_DDICT
 
 #ifdef ROCKSDB_ZSTD_DDICT
@@ -245,7 +248,8 @@ struct UncompressionDict {
       : dict_(std::move(dict)), slice_(dict_) {
 #ifdef ROCKSDB_ZSTD_DDICT
     if (!slice_.empty() && using_zstd) {
-      zstd_ddict_ = ZSTD_createDDict_byReference(slice_.data(), slice_.size());
+      zstd_ddict_ =
+          CompressionContextCache::Instance()->GetOrCreateZSTDDDict(slice_);
       assert(zstd_ddict_ != nullptr);
     }
 #endif  // ROCKSDB_ZSTD_DDICT
@@ -261,7 +265,8 @@ struct UncompressionDict {
       : allocation_(std::move(allocation)), slice_(std::move(slice)) {
 #ifdef ROCKSDB_ZSTD_DDICT
     if (!slice_.empty() && using_zstd) {
-      zstd_ddict_ = ZSTD_createDDict_byReference(slice_.data(), slice_.size());
+      zstd_ddict_ =
+          CompressionContextCache::Instance()->GetOrCreateZSTDDDict(slice_);
       assert(zstd_ddict_ != nullptr);
     }
 #endif  // ROCKSDB_ZSTD_DDICT
@@ -273,24 +278,9 @@ struct UncompressionDict {
         slice_(std::move(rhs.slice_))
 #ifdef ROCKSDB_ZSTD_DDICT
         ,
-        zstd_ddict_(rhs.zstd_ddict_)
+        zstd_ddict_(std::move(rhs.zstd_ddict_))
 #endif
-  {
-#ifdef ROCKSDB_ZSTD_DDICT
-    rhs.zstd_ddict_ = nullptr;
-#endif
-  }
-
-  ~UncompressionDict() {
-#ifdef ROCKSDB_ZSTD_DDICT
-    size_t res = 0;
-    if (zstd_ddict_ != nullptr) {
-      res = ZSTD_freeDDict(zstd_ddict_);
-    }
-    assert(res == 0);  // Last I checked they can't fail
-    (void)res;         // prevent unused var warning
-#endif                 // ROCKSDB_ZSTD_DDICT
-  }
+  {}
 
   UncompressionDict& operator=(UncompressionDict&& rhs) {
     if (this == &rhs) {
@@ -302,8 +292,7 @@ struct UncompressionDict {
     slice_ = std::move(rhs.slice_);
 
 #ifdef ROCKSDB_ZSTD_DDICT
-    zstd_ddict_ = rhs.zstd_ddict_;
-    rhs.zstd_ddict_ = nullptr;
+    zstd_ddict_ = std::move(rhs.zstd_ddict_);
 #endif
 
     return *this;
@@ -318,7 +307,7 @@ struct UncompressionDict {
   const Slice& GetRawDict() const { return slice_; }
 
 #ifdef ROCKSDB_ZSTD_DDICT
-  const ZSTD_DDict* GetDigestedZstdDDict() const { return zstd_ddict_; }
+  const ZSTD_DDict* GetDigestedZstdDDict() const { return zstd_ddict_.get(); }
 #endif  // ROCKSDB_ZSTD_DDICT
 
   static const UncompressionDict& GetEmptyDict() {
@@ -338,7 +327,7 @@ struct UncompressionDict {
       }
     }
 #ifdef ROCKSDB_ZSTD_DDICT
-    usage += ZSTD_sizeof_DDict(zstd_ddict_);
+    usage += ZSTD_sizeof_DDict(zstd_ddict_.get());
 #endif  // ROCKSDB_ZSTD_DDICT
     return usage;
   }
@@ -396,23 +385,28 @@ class CompressionInfo {
   const CompressionDict& dict_;
   const CompressionType type_;
   const uint64_t sample_for_compression_;
+  Compressor* const compressor_;
 
  public:
+  // `_compressor` is only used for kCustomCompression
   CompressionInfo(const CompressionOptions& _opts,
                   const CompressionContext& _context,
                   const CompressionDict& _dict, CompressionType _type,
-                  uint64_t _sample_for_compression)
+                  uint64_t _sample_for_compression,
+                  Compressor* _compressor = nullptr)
       : opts_(_opts),
         context_(_context),
         dict_(_dict),
         type_(_type),
-        sample_for_compression_(_sample_for_compression) {}
+        sample_for_compression_(_sample_for_compression),
+        compressor_(_compressor) {}
 
   const CompressionOptions& options() const { return opts_; }
   const CompressionContext& context() const { return context_; }
   const CompressionDict& dict() const { return dict_; }
   CompressionType type() const { return type_; }
   uint64_t SampleForCompression() const { return sample_for_compression_; }
+  Compressor* compressor() const { return compressor_; }
 };
 
 class UncompressionContext {
@@ -446,15 +440,22 @@ class UncompressionInfo {
   const UncompressionContext& context_;
   const UncompressionDict& dict_;
   const CompressionType type_;
+  Compressor* const compressor_;
 
  public:
+  // `_compressor` is only used for kCustomCompression
   UncompressionInfo(const UncompressionContext& _context,
-                    const UncompressionDict& _dict, CompressionType _type)
-      : context_(_context), dict_(_dict), type_(_type) {}
+                    const UncompressionDict& _dict, CompressionType _type,
+                    Compressor* _compressor = nullptr)
+      : context_(_context),
+        dict_(_dict),
+        type_(_type),
+        compressor_(_compressor) {}
 
   const UncompressionContext& context() const { return context_; }
   const UncompressionDict& dict() const { return dict_; }
   CompressionType type() const { return type_; }
+  Compressor* compressor() const { return compressor_; }
 };
 
 inline bool Snappy_Supported() {
@@ -577,6 +578,26 @@ inline bool DictCompressionTypeSupported(CompressionType compression_type) {
   }
 }
 
+// Streaming compression keeps its state across calls, so that a sequence of
+// small inputs (e.g. WAL records) shares one compression window.
+inline bool StreamingCompressionTypeSupported(
+    CompressionType compression_type) {
+  switch (compression_type) {
+    case kNoCompression:
+      return true;
+    case kZlibCompression:
+      return Zlib_Supported();
+    case kZSTD:
+#if ZSTD_VERSION_NUMBER >= 10400  // v1.4.0+
+      return ZSTD_Supported();
+#else
+      return false;
+#endif
+    default:
+      return false;
+  }
+}
+
 inline std::string CompressionTypeToString(CompressionType compression_type) {
   switch (compression_type) {
     case kNoCompression:
@@ -597,6 +618,8 @@ inline std::string CompressionTypeToString(CompressionType compression_type) {
       return "ZSTD";
     case kZSTDNotFinalCompression:
       return "ZSTDNotFinal";
+    case kCustomCompression:
+      return "Custom";
     case kDisableCompressionOption:
       return "DisableOption";
     default:
@@ -630,6 +653,9 @@ inline std::string CompressionOptionsToString(
   result.append("max_dict_buffer_bytes=")
       .append(ToString(compression_options.max_dict_buffer_bytes))
       .append("; ");
+  result.append("max_dict_reuse_seconds=")
+      .append(ToString(compression_options.max_dict_reuse_seconds))
+      .append("; ");
   return result;
 }
 
@@ -1451,6 +1477,41 @@ inline std::string ZSTD_TrainDictionary(const std::string& samples,
 #endif  // ZSTD_VERSION_NUMBER >= 10103
 }
 
+// The uncompressed size is always stored in front of the compressor's output,
+// so that Uncompress() can be given a buffer of the right size
+inline bool Custom_Compress(const CompressionInfo& info, const char* input,
+                            size_t length, ::std::string* output) {
+  if (info.compressor() == nullptr ||
+      length > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  output->clear();
+  compression::PutDecompressedSizeInfo(output, static_cast<uint32_t>(length));
+  return info.compressor()->Compress(Slice(input, length), output).ok();
+}
+
+inline CacheAllocationPtr Custom_Uncompress(const UncompressionInfo& info,
+                                            const char* input_data,
+                                            size_t input_length,
+                                            size_t* uncompressed_size,
+                                            MemoryAllocator* allocator) {
+  uint32_t output_len = 0;
+  if (info.compressor() == nullptr ||
+      !compression::GetDecompressedSizeInfo(&input_data, &input_length,
+                                            &output_len)) {
+    return nullptr;
+  }
+  CacheAllocationPtr output = AllocateBlock(output_len, allocator);
+  if (!info.compressor()
+           ->Uncompress(Slice(input_data, input_length), output.get(),
+                        output_len)
+           .ok()) {
+    return nullptr;
+  }
+  *uncompressed_size = output_len;
+  return output;
+}
+
 inline bool CompressData(const Slice& raw,
                          const CompressionInfo& compression_info,
                          uint32_t compress_format_version,
@@ -1488,6 +1549,10 @@ inline bool CompressData(const Slice& raw,
       ret = ZSTD_Compress(compression_info, raw.data(), raw.size(),
                           compressed_output);
       break;
+    case kCustomCompression:
+      ret = Custom_Compress(compression_info, raw.data(), raw.size(),
+                            compressed_output);
+      break;
     default:
       // Do not recognize this compression type
       break;
@@ -1524,9 +1589,251 @@ inline CacheAllocationPtr UncompressData(
     case kZSTDNotFinalCompression:
       return ZSTD_Uncompress(uncompression_info, data, n, uncompressed_size,
                              allocator);
+    case kCustomCompression:
+      return Custom_Uncompress(uncompression_info, data, n, uncompressed_size,
+                               allocator);
     default:
       return CacheAllocationPtr();
   }
 }
 
+// Compresses a stream of inputs with a single compression context. Every
+// call to Compress() ends at a flush point: the output produced so far is
+// enough to reconstruct all inputs passed so far, while the compression
+// window carries over into the next call. The matching StreamingUncompress
+// has to be fed the outputs in the same order.
+// NOTE: not thread safe.
+class StreamingCompress {
+ public:
+  virtual ~StreamingCompress() {}
+
+  // Compresses `input` and appends the compressed bytes to `*output`.
+  // Returns false if the compression library reported an error, in which
+  // case the stream is unusable.
+  virtual bool Compress(const Slice& input, std::string* output) = 0;
+
+  // Returns nullptr if `compression_type` is not supported for streaming,
+  // see StreamingCompressionTypeSupported().
+  static std::unique_ptr<StreamingCompress> Create(
+      CompressionType compression_type, const CompressionOptions& opts);
+};
+
+// Reverses StreamingCompress.
+// NOTE: not thread safe.
+class StreamingUncompress {
+ public:
+  virtual ~StreamingUncompress() {}
+
+  // Uncompresses `input`, which must be the complete output of one
+  // StreamingCompress::Compress() call, and appends the result to `*output`.
+  // Returns false on corrupted input.
+  virtual bool Uncompress(const Slice& input, std::string* output) = 0;
+
+  static std::unique_ptr<StreamingUncompress> Create(
+      CompressionType compression_type);
+};
+
+#ifdef ZLIB
+class ZlibStreamingCompress : public StreamingCompress {
+ public:
+  explicit ZlibStreamingCompress(const CompressionOptions& opts) {
+    memset(&stream_, 0, sizeof(z_stream));
+    int level = opts.level == CompressionOptions::kDefaultCompressionLevel
+                    ? Z_DEFAULT_COMPRESSION
+                    : opts.level;
+    // See Zlib_Compress() for the choice of memLevel.
+    static const int memLevel = 8;
+    ok_ = deflateInit2(&stream_, level, Z_DEFLATED, opts.window_bits,
+                       memLevel, opts.strategy) == Z_OK;
+  }
+
+  ~ZlibStreamingCompress() override {
+    if (ok_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+  bool Compress(const Slice& input, std::string* output) override {
+    if (!ok_ || input.size() > std::numeric_limits<uInt>::max()) {
+      return false;
+    }
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream_.avail_in = static_cast<uInt>(input.size());
+    // Z_SYNC_FLUSH only emits complete output once deflate leaves some room
+    // in the output buffer.
+    do {
+      const size_t old_size = output->size();
+      const size_t chunk =
+          std::max<size_t>(deflateBound(&stream_, stream_.avail_in), 64);
+      output->resize(old_size + chunk);
+      stream_.next_out = reinterpret_cast<Bytef*>(&(*output)[old_size]);
+      stream_.avail_out = static_cast<uInt>(chunk);
+      int st = deflate(&stream_, Z_SYNC_FLUSH);
+      output->resize(old_size + chunk - stream_.avail_out);
+      if (st != Z_OK && st != Z_BUF_ERROR) {
+        ok_ = false;
+        return false;
+      }
+    } while (stream_.avail_out == 0);
+    return stream_.avail_in == 0;
+  }
+
+ private:
+  z_stream stream_;
+  bool ok_;
+};
+
+class ZlibStreamingUncompress : public StreamingUncompress {
+ public:
+  ZlibStreamingUncompress() {
+    memset(&stream_, 0, sizeof(z_stream));
+    // Same raw deflate window as the default CompressionOptions::window_bits
+    // used by ZlibStreamingCompress.
+    ok_ = inflateInit2(&stream_, -14) == Z_OK;
+  }
+
+  ~ZlibStreamingUncompress() override {
+    if (ok_) {
+      inflateEnd(&stream_);
+    }
+  }
+
+  bool Uncompress(const Slice& input, std::string* output) override {
+    if (!ok_ || input.size() > std::numeric_limits<uInt>::max()) {
+      return false;
+    }
+    if (input.empty()) {
+      return true;
+    }
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream_.avail_in = static_cast<uInt>(input.size());
+    do {
+      const size_t old_size = output->size();
+      const size_t chunk = std::max<size_t>(input.size() * 4, 4096);
+      output->resize(old_size + chunk);
+      stream_.next_out = reinterpret_cast<Bytef*>(&(*output)[old_size]);
+      stream_.avail_out = static_cast<uInt>(chunk);
+      int st = inflate(&stream_, Z_SYNC_FLUSH);
+      output->resize(old_size + chunk - stream_.avail_out);
+      if (st != Z_OK && st != Z_BUF_ERROR) {
+        ok_ = false;
+        return false;
+      }
+    } while (stream_.avail_out == 0);
+    return stream_.avail_in == 0;
+  }
+
+ private:
+  z_stream stream_;
+  bool ok_;
+};
+#endif  // ZLIB
+
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10400  // v1.4.0+
+class ZSTDStreamingCompress : public StreamingCompress {
+ public:
+  explicit ZSTDStreamingCompress(const CompressionOptions& opts)
+      : cctx_(ZSTD_createCCtx()) {
+    if (cctx_ != nullptr &&
+        opts.level != CompressionOptions::kDefaultCompressionLevel) {
+      ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, opts.level);
+    }
+  }
+
+  ~ZSTDStreamingCompress() override { ZSTD_freeCCtx(cctx_); }
+
+  bool Compress(const Slice& input, std::string* output) override {
+    if (cctx_ == nullptr) {
+      return false;
+    }
+    ZSTD_inBuffer in = {input.data(), input.size(), /*pos=*/0};
+    size_t remaining;
+    do {
+      const size_t old_size = output->size();
+      const size_t chunk = ZSTD_CStreamOutSize();
+      output->resize(old_size + chunk);
+      ZSTD_outBuffer out = {&(*output)[old_size], chunk, /*pos=*/0};
+      remaining = ZSTD_compressStream2(cctx_, &out, &in, ZSTD_e_flush);
+      output->resize(old_size + out.pos);
+      if (ZSTD_isError(remaining)) {
+        return false;
+      }
+    } while (remaining != 0 || in.pos < in.size);
+    return true;
+  }
+
+ private:
+  ZSTD_CCtx* cctx_;
+};
+
+class ZSTDStreamingUncompress : public StreamingUncompress {
+ public:
+  ZSTDStreamingUncompress() : dctx_(ZSTD_createDCtx()) {}
+
+  ~ZSTDStreamingUncompress() override { ZSTD_freeDCtx(dctx_); }
+
+  bool Uncompress(const Slice& input, std::string* output) override {
+    if (dctx_ == nullptr) {
+      return false;
+    }
+    ZSTD_inBuffer in = {input.data(), input.size(), /*pos=*/0};
+    bool output_full;
+    do {
+      const size_t old_size = output->size();
+      const size_t chunk = ZSTD_DStreamOutSize();
+      output->resize(old_size + chunk);
+      ZSTD_outBuffer out = {&(*output)[old_size], chunk, /*pos=*/0};
+      size_t ret = ZSTD_decompressStream(dctx_, &out, &in);
+      output->resize(old_size + out.pos);
+      if (ZSTD_isError(ret)) {
+        return false;
+      }
+      output_full = out.pos == chunk;
+    } while (in.pos < in.size || output_full);
+    return true;
+  }
+
+ private:
+  ZSTD_DCtx* dctx_;
+};
+#endif  // ZSTD && ZSTD_VERSION_NUMBER >= 10400
+
+inline std::unique_ptr<StreamingCompress> StreamingCompress::Create(
+    CompressionType compression_type, const CompressionOptions& opts) {
+  switch (compression_type) {
+#ifdef ZLIB
+    case kZlibCompression:
+      return std::unique_ptr<StreamingCompress>(
+          new ZlibStreamingCompress(opts));
+#endif  // ZLIB
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10400
+    case kZSTD:
+      return std::unique_ptr<StreamingCompress>(
+          new ZSTDStreamingCompress(opts));
+#endif  // ZSTD && ZSTD_VERSION_NUMBER >= 10400
+    default:
+      (void)opts;
+      return nullptr;
+  }
+}
+
+inline std::unique_ptr<StreamingUncompress> StreamingUncompress::Create(
+    CompressionType compression_type) {
+  switch (compression_type) {
+#ifdef ZLIB
+    case kZlibCompression:
+      return std::unique_ptr<StreamingUncompress>(
+          new ZlibStreamingUncompress());
+#endif  // ZLIB
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10400
+    case kZSTD:
+      return std::unique_ptr<StreamingUncompress>(
+          new ZSTDStreamingUncompress());
+#endif  // ZSTD && ZSTD_VERSION_NUMBER >= 10400
+    default:
+      return nullptr;
+  }
+}
+
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -9,10 +9,14 @@
 
 #include "util/compression_context_cache.h"
 
+#include "port/port.h"
 #include "util/compression.h"
 #include "util/core_local.h"
+#include "util/mutexlock.h"
 
 #include <atomic>
+#include <string>
+#include <unordered_map>
 
 namespace ROCKSDB_NAMESPACE {
 namespace compression_cache {
@@ -81,8 +85,43 @@ class CompressionContextCache::Rep {
     cn->ReturnUncompressData();
   }
 
+#ifdef ROCKSDB_ZSTD_DDICT
+  std::shared_ptr<ZSTD_DDict> GetOrCreateZSTDDDict(const Slice& dict) {
+    std::string key = dict.ToString();
+    MutexLock l(&ddicts_mutex_);
+    std::weak_ptr<ZSTD_DDict>& entry = ddicts_[key];
+    std::shared_ptr<ZSTD_DDict> ddict = entry.lock();
+    if (ddict == nullptr) {
+      // Copies the dictionary, which need not outlive the caller's block
+      ddict.reset(ZSTD_createDDict(dict.data(), dict.size()),
+                  [](ZSTD_DDict* d) { ZSTD_freeDDict(d); });
+      assert(ddict != nullptr);
+      entry = ddict;
+      if (ddicts_.size() >= next_purge_size_) {
+        // Drops the dictionaries no longer used, in amortized O(1)
+        for (auto it = ddicts_.begin(); it != ddicts_.end();) {
+          if (it->second.expired()) {
+            it = ddicts_.erase(it);
+          } else {
+            ++it;
+          }
+        }
+        next_purge_size_ = 2 * ddicts_.size() + kMinPurgeSize;
+      }
+    }
+    return ddict;
+  }
+#endif  // ROCKSDB_ZSTD_DDICT
+
  private:
   CoreLocalArray<ZSTDCachedData> per_core_uncompr_;
+#ifdef ROCKSDB_ZSTD_DDICT
+  static const size_t kMinPurgeSize = 64;
+  // Keyed by the contents of the dictionaries
+  port::Mutex ddicts_mutex_;
+  std::unordered_map<std::string, std::weak_ptr<ZSTD_DDict>> ddicts_;
+  size_t next_purge_size_ = kMinPurgeSize;
+#endif  // ROCKSDB_ZSTD_DDICT
 };
 
 CompressionContextCache::CompressionContextCache() : rep_(new Rep()) {}
@@ -103,6 +142,16 @@ void CompressionContextCache::ReturnCachedZSTDUncompressData(int64_t idx) {
   rep_->ReturnZSTDUncompressData(idx);
 }
 
+std::shared_ptr<ZSTD_DDict_s> CompressionContextCache::GetOrCreateZSTDDDict(
+    const Slice& dict) {
+#ifdef ROCKSDB_ZSTD_DDICT
+  return rep_->GetOrCreateZSTDDDict(dict);
+#else
+  (void)dict;
+  return nullptr;
+#endif  // ROCKSDB_ZSTD_DDICT
+}
+
 CompressionContextCache::~CompressionContextCache() { delete rep_; }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -19,7 +19,13 @@
 
 #include <stdint.h>
 
+#include <memory>
+
 #include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
+
+// ZSTD_DDict of zstd.h
+struct ZSTD_DDict_s;
 
 namespace ROCKSDB_NAMESPACE {
 class ZSTDUncompressCachedData;
@@ -35,6 +41,11 @@ class CompressionContextCache {
   ZSTDUncompressCachedData GetCachedZSTDUncompressData();
   void ReturnCachedZSTDUncompressData(int64_t idx);
 
+  // Returns the digested ZSTD dictionary for `dict`, shared with every other
+  // user of a dictionary with the same contents for as long as any of them
+  // holds it. Returns null unless ROCKSDB_ZSTD_DDICT is defined.
+  std::shared_ptr<ZSTD_DDict_s> GetOrCreateZSTDDDict(const Slice& dict);
+
  private:
   // Singleton
   CompressionContextCache();
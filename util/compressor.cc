@@ -0,0 +1,18 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/compressor.h"
+
+#include "rocksdb/utilities/customizable_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+Status Compressor::CreateFromString(const ConfigOptions& config_options,
+                                    const std::string& value,
+                                    std::shared_ptr<Compressor>* result) {
+  return LoadSharedObject<Compressor>(config_options, value, nullptr, result);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
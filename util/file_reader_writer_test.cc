@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 //
 #include <algorithm>
+#include <set>
 #include <vector>
 
 #include "db/db_test_util.h"
@@ -234,6 +235,109 @@ TEST_F(WritableFileWriterTest, IncrementalBuffer) {
   }
 }
 
+TEST_F(WritableFileWriterTest, AsyncWrites) {
+  // Completes appends only when they are polled
+  class FakeWF : public FSWritableFile {
+   public:
+    FakeWF(std::string* _file_data, size_t* _max_pending)
+        : file_data_(_file_data), max_pending_(_max_pending) {}
+    ~FakeWF() override { EXPECT_TRUE(pending_.empty()); }
+
+    struct PendingAppend {
+      Slice data;
+      uint64_t offset;
+      std::function<void(const IOStatus&, void*)> cb;
+      void* cb_arg;
+    };
+
+    using FSWritableFile::Append;
+    IOStatus Append(const Slice& data, const IOOptions& /*options*/,
+                    IODebugContext* /*dbg*/) override {
+      file_data_->resize(size_);
+      file_data_->append(data.data(), data.size());
+      size_ += data.size();
+      return IOStatus::OK();
+    }
+    IOStatus AppendAsync(const Slice& data, const IOOptions& /*options*/,
+                         std::function<void(const IOStatus&, void*)> cb,
+                         void* cb_arg, void** io_handle,
+                         IOHandleDeleter* del_fn,
+                         IODebugContext* /*dbg*/) override {
+      PendingAppend* pending = new PendingAppend{data, size_, cb, cb_arg};
+      size_ += data.size();
+      pending_.insert(pending);
+      *max_pending_ = std::max(*max_pending_, pending_.size());
+      *io_handle = pending;
+      *del_fn = [](void* h) { delete static_cast<PendingAppend*>(h); };
+      return IOStatus::OK();
+    }
+    IOStatus Poll(std::vector<void*>& io_handles,
+                  size_t /*min_completions*/) override {
+      for (void* h : io_handles) {
+        PendingAppend* pending = static_cast<PendingAppend*>(h);
+        if (pending_.erase(pending) == 0) {
+          continue;
+        }
+        if (file_data_->size() < pending->offset + pending->data.size()) {
+          file_data_->resize(pending->offset + pending->data.size());
+        }
+        file_data_->replace(pending->offset, pending->data.size(),
+                            pending->data.data(), pending->data.size());
+        pending->cb(IOStatus::OK(), pending->cb_arg);
+      }
+      return IOStatus::OK();
+    }
+    IOStatus Close(const IOOptions& /*options*/,
+                   IODebugContext* /*dbg*/) override {
+      EXPECT_TRUE(pending_.empty());
+      return IOStatus::OK();
+    }
+    IOStatus Flush(const IOOptions& /*options*/,
+                   IODebugContext* /*dbg*/) override {
+      return IOStatus::OK();
+    }
+    IOStatus Sync(const IOOptions& /*options*/,
+                  IODebugContext* /*dbg*/) override {
+      EXPECT_TRUE(pending_.empty());
+      return IOStatus::OK();
+    }
+    uint64_t GetFileSize(const IOOptions& /*options*/,
+                         IODebugContext* /*dbg*/) override {
+      return size_;
+    }
+
+    std::string* file_data_;
+    uint64_t size_ = 0;
+    std::set<PendingAppend*> pending_;
+    size_t* max_pending_;
+  };
+
+  std::string actual;
+  size_t max_pending = 0;
+  std::unique_ptr<FSWritableFile> wf(new FakeWF(&actual, &max_pending));
+  FileOptions file_options;
+  file_options.writable_file_max_buffer_size = 4096;
+  file_options.use_async_writes = true;
+  std::unique_ptr<WritableFileWriter> writer(
+      new WritableFileWriter(std::move(wf), "" /* don't care */, file_options));
+
+  Random r(301);
+  std::string target;
+  for (int i = 0; i < 200; i++) {
+    std::string data = r.RandomString(r.Uniform(3 * 4096));
+    ASSERT_OK(writer->Append(data));
+    target += data;
+    if (r.OneIn(20)) {
+      ASSERT_OK(writer->Sync(false /* use_fsync */));
+      ASSERT_EQ(target, actual);
+    }
+  }
+  ASSERT_OK(writer->Close());
+  ASSERT_EQ(target, actual);
+  // Several writes were in flight at a time
+  ASSERT_GT(max_pending, size_t{1});
+}
+
 class DBWritableFileWriterTest : public DBTestBase {
  public:
   DBWritableFileWriterTest()
@@ -328,6 +432,59 @@ TEST_F(DBWritableFileWriterTest, AppendVerifyNoChecksum) {
   Destroy(options);
 }
 
+TEST_F(DBWritableFileWriterTest, AppendWithFileChecksum) {
+  FileOptions file_options = FileOptions();
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.file_checksum_gen_factory = GetFileChecksumGenCrc32cFactory();
+  DestroyAndReopen(options);
+  std::string fname = this->dbname_ + "/test_file";
+  std::unique_ptr<FSWritableFile> writable_file_ptr;
+  ASSERT_OK(fault_fs_->NewWritableFile(fname, file_options, &writable_file_ptr,
+                                       /*dbg*/ nullptr));
+  std::unique_ptr<TestFSWritableFile> file;
+  file.reset(new TestFSWritableFile(
+      fname, file_options, std::move(writable_file_ptr), fault_fs_.get()));
+  std::unique_ptr<WritableFileWriter> file_writer;
+  ImmutableOptions ioptions(options);
+  file_writer.reset(new WritableFileWriter(
+      std::move(file), fname, file_options, SystemClock::Default().get(),
+      nullptr, ioptions.stats, ioptions.listeners,
+      ioptions.file_checksum_gen_factory.get(), true, true));
+  fault_fs_->SetChecksumHandoffFuncType(ChecksumType::kCRC32c);
+
+  // Sizes around the buffer size and the size of the pieces the writer
+  // checksums at a time, with and without the checksum of the data
+  Random rnd(301);
+  Random size_r(47);
+  std::string written;
+  for (int i = 0; i < 200; i++) {
+    std::string data =
+        rnd.RandomString(static_cast<int>(size_r.Next() % (256 << 10)));
+    if (i % 2 == 0) {
+      ASSERT_OK(file_writer->Append(Slice(data),
+                                    crc32c::Value(data.data(), data.size())));
+    } else {
+      ASSERT_OK(file_writer->Append(Slice(data)));
+    }
+    written += data;
+    if (size_r.OneIn(5)) {
+      ASSERT_OK(file_writer->Flush());
+    }
+  }
+  ASSERT_OK(file_writer->Close());
+
+  FileChecksumGenContext gen_context;
+  gen_context.file_name = fname;
+  std::unique_ptr<FileChecksumGenerator> checksum_generator =
+      options.file_checksum_gen_factory->CreateFileChecksumGenerator(
+          gen_context);
+  checksum_generator->Update(written.data(), written.size());
+  checksum_generator->Finalize();
+  ASSERT_EQ(checksum_generator->GetChecksum(), file_writer->GetFileChecksum());
+  Destroy(options);
+}
+
 TEST_F(DBWritableFileWriterTest, AppendWithChecksumRateLimiter) {
   FileOptions file_options = FileOptions();
   file_options.rate_limiter = nullptr;
@@ -23,7 +23,9 @@ int main() {
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/mock_block_based_table.h"
+#include "table/multiget_context.h"
 #include "table/plain/plain_table_bloom.h"
+#include "util/autovector.h"
 #include "util/cast_util.h"
 #include "util/gflags_compat.h"
 #include "util/hash.h"
@@ -120,6 +122,7 @@ void _always_assert_fail(int line, const char *file, const char *expr) {
 #endif
 
 using ROCKSDB_NAMESPACE::Arena;
+using ROCKSDB_NAMESPACE::autovector;
 using ROCKSDB_NAMESPACE::BlockContents;
 using ROCKSDB_NAMESPACE::BloomFilterPolicy;
 using ROCKSDB_NAMESPACE::BloomHash;
@@ -132,10 +135,13 @@ using ROCKSDB_NAMESPACE::FilterBuildingContext;
 using ROCKSDB_NAMESPACE::FullFilterBlockReader;
 using ROCKSDB_NAMESPACE::GetSliceHash;
 using ROCKSDB_NAMESPACE::GetSliceHash64;
+using ROCKSDB_NAMESPACE::KeyContext;
 using ROCKSDB_NAMESPACE::Lower32of64;
+using ROCKSDB_NAMESPACE::MultiGetContext;
 using ROCKSDB_NAMESPACE::ParsedFullFilterBlock;
 using ROCKSDB_NAMESPACE::PlainTableBloomV1;
 using ROCKSDB_NAMESPACE::Random32;
+using ROCKSDB_NAMESPACE::ReadOptions;
 using ROCKSDB_NAMESPACE::Slice;
 using ROCKSDB_NAMESPACE::static_cast_with_check;
 using ROCKSDB_NAMESPACE::StderrLogger;
@@ -191,6 +197,31 @@ void PrintWarnings() {
 #endif
 }
 
+// Queries a batch of keys the way MultiGet does, through a MultiGetContext
+// range passed to FullFilterBlockReader::KeysMayMatch.
+void FullBlockReaderMayMatch(FullFilterBlockReader *reader, uint32_t num_keys,
+                             const Slice *keys, bool *may_match) {
+  autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_contexts;
+  autovector<KeyContext *, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
+  for (uint32_t i = 0; i < num_keys; ++i) {
+    key_contexts.emplace_back(nullptr, keys[i], nullptr, nullptr, nullptr);
+    may_match[i] = false;
+  }
+  for (auto &key_context : key_contexts) {
+    sorted_keys.push_back(&key_context);
+  }
+  MultiGetContext ctx(&sorted_keys, 0, num_keys, /*snapshot=*/0,
+                      ReadOptions());
+  MultiGetContext::Range range = ctx.GetMultiGetRange();
+  reader->KeysMayMatch(&range, /*prefix_extractor=*/nullptr,
+                       /*block_offset=*/ROCKSDB_NAMESPACE::kNotValid,
+                       /*no_io=*/false, /*lookup_context=*/nullptr);
+  // Keys ruled out by the filter are skipped by the range
+  for (auto iter = range.begin(); iter != range.end(); ++iter) {
+    may_match[iter.index()] = true;
+  }
+}
+
 struct FilterInfo {
   uint32_t filter_id_ = 0;
   std::unique_ptr<const char[]> owner_;
@@ -298,6 +329,13 @@ void FilterBench::Go() {
     throw std::runtime_error(
         "Can't combine -use_plain_table_bloom and -use_full_block_reader");
   }
+  if (FLAGS_use_full_block_reader &&
+      FLAGS_batch_size >
+          static_cast<uint32_t>(MultiGetContext::MAX_BATCH_SIZE)) {
+    throw std::runtime_error(
+        "-batch_size must be <= 32 (MultiGet batch size) with "
+        "-use_full_block_reader");
+  }
   if (FLAGS_use_plain_table_bloom) {
     if (FLAGS_impl > 1) {
       throw std::runtime_error(
@@ -625,10 +663,8 @@ double FilterBench::RandomQueryTest(uint32_t inside_threshold, bool dry_run,
         info.outside_queries_++;
       }
     }
-    // TODO: implement batched interface to full block reader
     // TODO: implement batched interface to plain table bloom
-    if (mode == kBatchPrepared && !FLAGS_use_full_block_reader &&
-        !FLAGS_use_plain_table_bloom) {
+    if (mode == kBatchPrepared && !FLAGS_use_plain_table_bloom) {
       for (uint32_t i = 0; i < batch_size; ++i) {
         batch_results[i] = false;
       }
@@ -637,6 +673,9 @@ double FilterBench::RandomQueryTest(uint32_t inside_threshold, bool dry_run,
           batch_results[i] = true;
           dry_run_hash += dry_run_hash_fn(batch_slices[i]);
         }
+      } else if (FLAGS_use_full_block_reader) {
+        FullBlockReaderMayMatch(info.full_block_reader_.get(), batch_size,
+                                batch_slices.get(), batch_results.get());
       } else {
         info.reader_->MayMatch(batch_size, batch_slice_ptrs.get(),
                                batch_results.get());
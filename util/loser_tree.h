@@ -0,0 +1,171 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include "port/port.h"
+#include "util/autovector.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Tournament ("loser") tree over a set of pointers, exposing the same
+// interface as BinaryHeap so that it can stand in for the heap of a k-way
+// merge.  Compare has BinaryHeap semantics: cmp(a, b) returns true when a
+// should come out *after* b, so that top() returns the element every other
+// element compares "less" than.
+//
+// Every internal node holds the loser of the match played below it, and the
+// overall winner is kept separately.  replace_top() and pop() replay only
+// the path from the winner's leaf to the root, one comparison per level
+// (ceil(log2(k)) in total) versus up to two per level for a heap
+// sift-down.  The price is that a leaf that keeps on
+// winning is still compared all the way up; BinaryHeap short-circuits that
+// case after a single comparison.
+//
+// Elements are added with push(); the tree is (re)built lazily on the next
+// top()/replace_top()/pop().  Exhausted leaves are represented by nullptr
+// and always lose, so T must be a pointer type.
+template <typename T, typename Compare = std::less<T>>
+class LoserTree {
+ public:
+  LoserTree() {}
+  explicit LoserTree(Compare cmp) : cmp_(std::move(cmp)) {}
+
+  void push(const T& value) {
+    assert(value != nullptr);
+    leaves_.push_back(value);
+    ++size_;
+    needs_rebuild_ = true;
+  }
+
+  const T& top() const {
+    assert(!empty());
+    MaybeRebuild();
+    return leaves_[nodes_[0]];
+  }
+
+  void replace_top(const T& value) {
+    assert(!empty());
+    assert(value != nullptr);
+    MaybeRebuild();
+    size_t winner = nodes_[0];
+    leaves_[winner] = value;
+    Replay(winner);
+  }
+
+  void pop() {
+    assert(!empty());
+    MaybeRebuild();
+    size_t winner = nodes_[0];
+    leaves_[winner] = nullptr;
+    --size_;
+    if (size_ == 0) {
+      clear();
+    } else {
+      Replay(winner);
+    }
+  }
+
+  void clear() {
+    leaves_.clear();
+    size_ = 0;
+    needs_rebuild_ = true;
+  }
+
+  bool empty() const { return size_ == 0; }
+
+  size_t size() const { return size_; }
+
+ private:
+  // Returns true if a should be emitted no later than b.  nullptr loses to
+  // anything.
+  bool Beats(const T& a, const T& b) const {
+    if (a == nullptr) {
+      return false;
+    }
+    if (b == nullptr) {
+      return true;
+    }
+    return !cmp_(a, b);
+  }
+
+  void MaybeRebuild() const {
+    if (needs_rebuild_) {
+      Rebuild();
+    }
+  }
+
+  // Drops exhausted leaves, pads the leaf count to a power of two and plays
+  // the full tournament bottom-up.
+  void Rebuild() const {
+    size_t live = 0;
+    for (size_t i = 0; i < leaves_.size(); ++i) {
+      if (leaves_[i] != nullptr) {
+        leaves_[live++] = leaves_[i];
+      }
+    }
+    assert(live == size_);
+    while (leaves_.size() > live) {
+      leaves_.pop_back();
+    }
+    num_leaves_ = 1;
+    while (num_leaves_ < live) {
+      num_leaves_ <<= 1;
+    }
+    while (leaves_.size() < num_leaves_) {
+      leaves_.push_back(nullptr);
+    }
+
+    // winners_[i] is the leaf winning the subtree rooted at node i; the
+    // leaves themselves occupy positions [num_leaves_, 2 * num_leaves_).
+    winners_.resize(2 * num_leaves_);
+    nodes_.resize(num_leaves_);
+    for (size_t i = 0; i < num_leaves_; ++i) {
+      winners_[num_leaves_ + i] = i;
+    }
+    for (size_t n = num_leaves_ - 1; n >= 1; --n) {
+      size_t left = winners_[2 * n];
+      size_t right = winners_[2 * n + 1];
+      if (Beats(leaves_[left], leaves_[right])) {
+        winners_[n] = left;
+        nodes_[n] = right;
+      } else {
+        winners_[n] = right;
+        nodes_[n] = left;
+      }
+    }
+    nodes_[0] = num_leaves_ > 1 ? winners_[1] : 0;
+    needs_rebuild_ = false;
+  }
+
+  // Leaf `leaf` changed value: walk up to the root, swapping the running
+  // winner with each stored loser that now beats it.
+  void Replay(size_t leaf) {
+    size_t winner = leaf;
+    for (size_t n = (leaf + num_leaves_) >> 1; n >= 1; n >>= 1) {
+      if (!Beats(leaves_[winner], leaves_[nodes_[n]])) {
+        std::swap(winner, nodes_[n]);
+      }
+    }
+    nodes_[0] = winner;
+  }
+
+  Compare cmp_;
+  // Leaf values; nullptr marks an exhausted (or padding) leaf.
+  mutable autovector<T> leaves_;
+  // nodes_[0] is the index of the winning leaf, nodes_[1..num_leaves_) the
+  // index of the losing leaf at each internal node.
+  mutable autovector<size_t> nodes_;
+  // Scratch space for Rebuild(), kept to avoid reallocating on every seek.
+  mutable autovector<size_t> winners_;
+  mutable size_t num_leaves_ = 0;
+  mutable bool needs_rebuild_ = true;
+  size_t size_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
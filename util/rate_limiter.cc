@@ -68,22 +68,21 @@ GenericRateLimiter::GenericRateLimiter(
       prev_num_drains_(0),
       max_bytes_per_sec_(rate_bytes_per_sec),
       tuned_time_(NowMicrosMonotonic()) {
-  total_requests_[0] = 0;
-  total_requests_[1] = 0;
-  total_bytes_through_[0] = 0;
-  total_bytes_through_[1] = 0;
+  for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+    total_requests_[i] = 0;
+    total_bytes_through_[i] = 0;
+  }
 }
 
 GenericRateLimiter::~GenericRateLimiter() {
   MutexLock g(&request_mutex_);
   stop_ = true;
-  requests_to_wait_ = static_cast<int32_t>(queue_[Env::IO_LOW].size() +
-                                           queue_[Env::IO_HIGH].size());
-  for (auto& r : queue_[Env::IO_HIGH]) {
-    r->cv.Signal();
-  }
-  for (auto& r : queue_[Env::IO_LOW]) {
-    r->cv.Signal();
+  requests_to_wait_ = 0;
+  for (int i = Env::IO_TOTAL - 1; i >= Env::IO_LOW; --i) {
+    requests_to_wait_ += static_cast<int32_t>(queue_[i].size());
+    for (auto& r : queue_[i]) {
+      r->cv.Signal();
+    }
   }
   while (requests_to_wait_ > 0) {
     exit_cv_.Wait();
@@ -144,11 +143,7 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
     //     to lower priority
     // (3) a previous waiter at the front of queue, who got notified by
     //     previous leader
-    if (leader_ == nullptr &&
-        ((!queue_[Env::IO_HIGH].empty() &&
-            &r == queue_[Env::IO_HIGH].front()) ||
-         (!queue_[Env::IO_LOW].empty() &&
-            &r == queue_[Env::IO_LOW].front()))) {
+    if (leader_ == nullptr && IsFrontOfQueue(&r)) {
       leader_ = &r;
       int64_t delta = next_refill_us_ - NowMicrosMonotonic();
       delta = delta > 0 ? delta : 0;
@@ -173,16 +168,8 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
     }
 
     // Make sure the waken up request is always the header of its queue
-    assert(r.granted ||
-           (!queue_[Env::IO_HIGH].empty() &&
-            &r == queue_[Env::IO_HIGH].front()) ||
-           (!queue_[Env::IO_LOW].empty() &&
-            &r == queue_[Env::IO_LOW].front()));
-    assert(leader_ == nullptr ||
-           (!queue_[Env::IO_HIGH].empty() &&
-            leader_ == queue_[Env::IO_HIGH].front()) ||
-           (!queue_[Env::IO_LOW].empty() &&
-            leader_ == queue_[Env::IO_LOW].front()));
+    assert(r.granted || IsFrontOfQueue(&r));
+    assert(leader_ == nullptr || IsFrontOfQueue(leader_));
 
     if (leader_ == &r) {
       // Waken up from TimedWait()
@@ -198,14 +185,10 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
         if (r.granted) {
           // Current leader already got granted with quota. Notify header
           // of waiting queue to participate next round of election.
-          assert((queue_[Env::IO_HIGH].empty() ||
-                    &r != queue_[Env::IO_HIGH].front()) &&
-                 (queue_[Env::IO_LOW].empty() ||
-                    &r != queue_[Env::IO_LOW].front()));
-          if (!queue_[Env::IO_HIGH].empty()) {
-            queue_[Env::IO_HIGH].front()->cv.Signal();
-          } else if (!queue_[Env::IO_LOW].empty()) {
-            queue_[Env::IO_LOW].front()->cv.Signal();
+          assert(!IsFrontOfQueue(&r));
+          Req* next = FrontOfHighestPriorityQueue();
+          if (next != nullptr) {
+            next->cv.Signal();
           }
           // Done
           break;
@@ -238,30 +221,55 @@ void GenericRateLimiter::Refill() {
     available_bytes_ += refill_bytes_per_period;
   }
 
+  // User reads always go first. Low-pri requests go before high-pri ones
+  // once every `fairness_` refills on average, so they do not starve.
+  RefillQueue(Env::IO_USER);
   int use_low_pri_first = rnd_.OneIn(fairness_) ? 0 : 1;
   for (int q = 0; q < 2; ++q) {
-    auto use_pri = (use_low_pri_first == q) ? Env::IO_LOW : Env::IO_HIGH;
-    auto* queue = &queue_[use_pri];
-    while (!queue->empty()) {
-      auto* next_req = queue->front();
-      if (available_bytes_ < next_req->request_bytes) {
-        // avoid starvation
-        next_req->request_bytes -= available_bytes_;
-        available_bytes_ = 0;
-        break;
-      }
-      available_bytes_ -= next_req->request_bytes;
-      next_req->request_bytes = 0;
-      total_bytes_through_[use_pri] += next_req->bytes;
-      queue->pop_front();
-
-      next_req->granted = true;
-      if (next_req != leader_) {
-        // Quota granted, signal the thread
-        next_req->cv.Signal();
-      }
+    RefillQueue((use_low_pri_first == q) ? Env::IO_LOW : Env::IO_HIGH);
+  }
+}
+
+void GenericRateLimiter::RefillQueue(Env::IOPriority pri) {
+  auto* queue = &queue_[pri];
+  while (!queue->empty()) {
+    auto* next_req = queue->front();
+    if (available_bytes_ < next_req->request_bytes) {
+      // avoid starvation
+      next_req->request_bytes -= available_bytes_;
+      available_bytes_ = 0;
+      break;
+    }
+    available_bytes_ -= next_req->request_bytes;
+    next_req->request_bytes = 0;
+    total_bytes_through_[pri] += next_req->bytes;
+    queue->pop_front();
+
+    next_req->granted = true;
+    if (next_req != leader_) {
+      // Quota granted, signal the thread
+      next_req->cv.Signal();
+    }
+  }
+}
+
+bool GenericRateLimiter::IsFrontOfQueue(const Req* r) const {
+  for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+    if (!queue_[i].empty() && queue_[i].front() == r) {
+      return true;
+    }
+  }
+  return false;
+}
+
+GenericRateLimiter::Req* GenericRateLimiter::FrontOfHighestPriorityQueue()
+    const {
+  for (int i = Env::IO_TOTAL - 1; i >= Env::IO_LOW; --i) {
+    if (!queue_[i].empty()) {
+      return queue_[i].front();
     }
   }
+  return nullptr;
 }
 
 int64_t GenericRateLimiter::CalculateRefillBytesPerPeriod(
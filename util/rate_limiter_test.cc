@@ -12,6 +12,8 @@
 #include <chrono>
 #include <cinttypes>
 #include <limits>
+#include <mutex>
+#include <thread>
 
 #include "db/db_test_util.h"
 #include "rocksdb/system_clock.h"
@@ -195,6 +197,40 @@ TEST_F(RateLimiterTest, LimitChangeTest) {
   }
 }
 
+TEST_F(RateLimiterTest, UserPriorityFirst) {
+  // One burst of 1000 bytes per refill. With fairness 1, low-pri requests
+  // always go before high-pri ones, but not before user ones.
+  const int64_t kRefillPeriodUs = 500 * 1000;
+  GenericRateLimiter limiter(2000, kRefillPeriodUs, 1 /* fairness */,
+                             RateLimiter::Mode::kAllIo, SystemClock::Default(),
+                             false /* auto_tuned */);
+  std::mutex mu;
+  std::vector<Env::IOPriority> granted;
+  auto request = [&](Env::IOPriority pri) {
+    limiter.Request(1000, pri, nullptr /* stats */,
+                    RateLimiter::OpType::kRead);
+    std::lock_guard<std::mutex> lock(mu);
+    granted.push_back(pri);
+  };
+
+  // Takes the first refill
+  request(Env::IO_LOW);
+  // Both wait for the next refill, which only has room for one of them
+  std::thread low(request, Env::IO_LOW);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::thread user(request, Env::IO_USER);
+  low.join();
+  user.join();
+
+  ASSERT_EQ(3U, granted.size());
+  ASSERT_EQ(Env::IO_USER, granted[1]);
+  ASSERT_EQ(Env::IO_LOW, granted[2]);
+  ASSERT_EQ(1000, limiter.GetTotalBytesThrough(Env::IO_USER));
+  ASSERT_EQ(2000, limiter.GetTotalBytesThrough(Env::IO_LOW));
+  ASSERT_EQ(3000, limiter.GetTotalBytesThrough());
+  ASSERT_EQ(3, limiter.GetTotalRequests());
+}
+
 TEST_F(RateLimiterTest, AutoTuneIncreaseWhenFull) {
   const std::chrono::seconds kTimePerRefill(1);
   const int kRefillsPerTune = 100;  // needs to match util/rate_limiter.cc
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 
 #include "port/port.h"  // for PREFETCH
@@ -928,6 +930,38 @@ class SerializableInterleavedSolution {
     }
   }
 
+  // Same as FilterQuery on each of the inputs, but with the solution
+  // memory for a whole group of keys prefetched before any of them is
+  // queried, to hide memory latency across the batch.
+  template <typename FilterQueryHasher>
+  void FilterQueries(size_t num_inputs, const Key* inputs,
+                     const FilterQueryHasher& hasher, bool* may_match) const {
+    assert(TypesAndSettings::kIsFilter);
+    if (TypesAndSettings::kAllowZeroStarts && num_starts_ == 0) {
+      // Unusual. Zero starts presumes no keys added -> always false
+      std::fill(may_match, may_match + num_inputs, false);
+      return;
+    }
+    constexpr size_t kMaxGroup = 32;
+    std::array<Hash, kMaxGroup> hashes;
+    std::array<Index, kMaxGroup> segment_nums;
+    std::array<Index, kMaxGroup> num_columns;
+    std::array<Index, kMaxGroup> start_bits;
+    for (size_t begin = 0; begin < num_inputs; begin += kMaxGroup) {
+      const size_t count = std::min(kMaxGroup, num_inputs - begin);
+      for (size_t i = 0; i < count; ++i) {
+        InterleavedPrepareQuery(inputs[begin + i], hasher, *this, &hashes[i],
+                                &segment_nums[i], &num_columns[i],
+                                &start_bits[i]);
+      }
+      for (size_t i = 0; i < count; ++i) {
+        may_match[begin + i] = InterleavedPreparedFilterQuery(
+            hashes[i], segment_nums[i], num_columns[i], start_bits[i], hasher,
+            *this);
+      }
+    }
+  }
+
   double ExpectedFpRate() const {
     assert(TypesAndSettings::kIsFilter);
     if (TypesAndSettings::kAllowZeroStarts && num_starts_ == 0) {
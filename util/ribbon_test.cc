@@ -761,6 +761,19 @@ TYPED_TEST(RibbonTypeParamTest, CompactnessAndBacktrackAndFpRate) {
         // Since the bits used in isoln are a subset of the bits used in soln,
         // it cannot have fewer FPs
         EXPECT_GE(ifp_count, fp_count);
+
+        // Batched queries must agree with one-at-a-time queries
+        std::vector<typename std::decay<decltype(*cur)>::type> batch_storage;
+        for (cur = other_keys_begin; cur != other_keys_end; ++cur) {
+          batch_storage.push_back(*cur);
+        }
+        std::vector<Key> batch_keys(batch_storage.begin(), batch_storage.end());
+        std::unique_ptr<bool[]> batch_results(new bool[batch_keys.size()]);
+        isoln.FilterQueries(batch_keys.size(), batch_keys.data(), hasher,
+                            batch_results.get());
+        for (size_t j = 0; j < batch_keys.size(); ++j) {
+          ASSERT_EQ(isoln.FilterQuery(batch_keys[j], hasher), batch_results[j]);
+        }
       }
 
       // And compare to Bloom time, for fun
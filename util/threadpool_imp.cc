@@ -18,6 +18,10 @@
 #  include <sys/resource.h>
 #endif
 
+#ifdef NUMA
+#  include <numa.h>
+#endif
+
 #include <stdlib.h>
 
 #include <algorithm>
@@ -61,6 +65,8 @@ struct ThreadPoolImpl::Impl {
 
   void LowerCPUPriority(CpuPriority pri);
 
+  void SetNumaNode(int node);
+
   void WakeUpAllThreads() {
     bgsignal_.notify_all();
   }
@@ -105,6 +111,7 @@ private:
 
  bool low_io_priority_;
  CpuPriority cpu_priority_;
+ int numa_node_;
  Env::Priority priority_;
  Env* env_;
 
@@ -131,6 +138,7 @@ private:
 inline ThreadPoolImpl::Impl::Impl()
     : low_io_priority_(false),
       cpu_priority_(CpuPriority::kNormal),
+      numa_node_(-1),
       priority_(Env::LOW),
       env_(nullptr),
       total_threads_limit_(0),
@@ -181,9 +189,15 @@ inline void ThreadPoolImpl::Impl::LowerCPUPriority(CpuPriority pri) {
   cpu_priority_ = pri;
 }
 
+inline void ThreadPoolImpl::Impl::SetNumaNode(int node) {
+  std::lock_guard<std::mutex> lock(mu_);
+  numa_node_ = node;
+}
+
 void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
   bool low_io_priority = false;
   CpuPriority current_cpu_priority = CpuPriority::kNormal;
+  int current_numa_node = -1;
 
   while (true) {
     // Wait until there is an item that is ready to run
@@ -225,8 +239,27 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
 
     bool decrease_io_priority = (low_io_priority != low_io_priority_);
     CpuPriority cpu_priority = cpu_priority_;
+    int numa_node = numa_node_;
     lock.unlock();
 
+#ifdef NUMA
+    if (numa_node != current_numa_node) {
+      // Both apply to the current thread only
+      numa_run_on_node(numa_node);
+      if (numa_node >= 0) {
+        numa_set_preferred(numa_node);
+      } else {
+        numa_set_localalloc();
+      }
+      current_numa_node = numa_node;
+      TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::AfterSetNumaNode",
+                               &current_numa_node);
+    }
+#else
+    (void)numa_node;
+    (void)current_numa_node;
+#endif
+
     if (cpu_priority < current_cpu_priority) {
       TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::BeforeSetCpuPriority",
                                &current_cpu_priority);
@@ -358,7 +391,7 @@ void ThreadPoolImpl::Impl::StartBGThreads() {
 void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
   std::function<void()>&& unschedule, void* tag) {
 
-  std::lock_guard<std::mutex> lock(mu_);
+  std::unique_lock<std::mutex> lock(mu_);
 
   if (exit_all_threads_) {
     return;
@@ -377,7 +410,11 @@ void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
   queue_len_.store(static_cast<unsigned int>(queue_.size()),
     std::memory_order_relaxed);
 
-  if (!HasExcessiveThread()) {
+  const bool has_excessive_thread = HasExcessiveThread();
+  // Notify after unlocking, so that the woken up thread does not go right
+  // back to sleep on the mutex
+  lock.unlock();
+  if (!has_excessive_thread) {
     // Wake up at least one waiting thread.
     bgsignal_.notify_one();
   } else {
@@ -456,6 +493,22 @@ void ThreadPoolImpl::LowerCPUPriority(CpuPriority pri) {
   impl_->LowerCPUPriority(pri);
 }
 
+Status ThreadPoolImpl::SetNumaNode(int node) {
+#ifdef NUMA
+  if (numa_available() < 0) {
+    return Status::NotSupported("NUMA is not available");
+  }
+  if (node < -1 || node > numa_max_node()) {
+    return Status::InvalidArgument("No such NUMA node");
+  }
+  impl_->SetNumaNode(node);
+  return Status::OK();
+#else
+  (void)node;
+  return Status::NotSupported("Not built with NUMA support");
+#endif
+}
+
 void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num) {
   impl_->SetBackgroundThreadsInternal(num, false);
 }
@@ -53,6 +53,12 @@ class ThreadPoolImpl : public ThreadPool {
   // Currently only has effect on Linux
   void LowerCPUPriority(CpuPriority pri);
 
+  // Make threads run on the CPUs of the given NUMA node and prefer its
+  // memory for their allocations, so that the buffers of a job stay local
+  // to the node. -1 lets them run anywhere again. Only supported on Linux
+  // builds with libnuma.
+  Status SetNumaNode(int node);
+
   // Ensure there is at aleast num threads in the pool
   // but do not kill threads if there are more
   void IncBackgroundThreadsIfNeeded(int num);
@@ -118,6 +118,8 @@ void BackupEngineOptions::Dump(Logger* logger) const {
                  restore_rate_limit);
   ROCKS_LOG_INFO(logger, "Options.max_background_operations: %d",
                  max_background_operations);
+  ROCKS_LOG_INFO(logger, "           Options.io_buffer_size: %" PRIu64,
+                 io_buffer_size);
 }
 
 // -------- BackupEngineImpl class ---------
@@ -1264,8 +1266,11 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
   }
 
   RateLimiter* rate_limiter = options_.backup_rate_limiter.get();
-  if (rate_limiter) {
-    copy_file_buffer_size_ = static_cast<size_t>(rate_limiter->GetSingleBurstBytes());
+  if (options_.io_buffer_size > 0) {
+    copy_file_buffer_size_ = static_cast<size_t>(options_.io_buffer_size);
+  } else if (rate_limiter) {
+    copy_file_buffer_size_ =
+        static_cast<size_t>(rate_limiter->GetSingleBurstBytes());
   }
 
   // A set into which we will insert the dst_paths that are calculated for live
@@ -1701,7 +1706,9 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
   }
 
   RateLimiter* rate_limiter = options_.restore_rate_limiter.get();
-  if (rate_limiter) {
+  if (options_.io_buffer_size > 0) {
+    copy_file_buffer_size_ = static_cast<size_t>(options_.io_buffer_size);
+  } else if (rate_limiter) {
     copy_file_buffer_size_ =
         static_cast<size_t>(rate_limiter->GetSingleBurstBytes());
   }
@@ -1724,6 +1731,17 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
     // kWalFile lives in wal_dir and all the rest live in db_dir
     dst = ((type == kWalFile) ? wal_dir : db_dir) + "/" + dst;
 
+    if (options.link_table_files && backup_env_ == db_env_ &&
+        (type == kTableFile || type == kBlobFile)) {
+      Status link_s = db_env_->LinkFile(GetAbsolutePath(file), dst);
+      if (link_s.ok()) {
+        ROCKS_LOG_INFO(options_.info_log, "Linked %s to %s\n", file.c_str(),
+                       dst.c_str());
+        continue;
+      }
+      ROCKS_LOG_INFO(options_.info_log, "Failed to link %s to %s: %s\n",
+                     file.c_str(), dst.c_str(), link_s.ToString().c_str());
+    }
     ROCKS_LOG_INFO(options_.info_log, "Restoring %s to %s\n", file.c_str(),
                    dst.c_str());
     CopyOrCreateWorkItem copy_or_create_work_item(
@@ -1905,8 +1923,15 @@ Status BackupEngineImpl::CopyOrCreateFile(
     }
     s = dest_writer->Append(data);
     if (rate_limiter != nullptr) {
-      rate_limiter->Request(data.size(), Env::IO_LOW, nullptr /* stats */,
-                            RateLimiter::OpType::kWrite);
+      // With io_buffer_size, a read may be larger than a single burst
+      const size_t burst =
+          static_cast<size_t>(rate_limiter->GetSingleBurstBytes());
+      for (size_t left = data.size(); left > 0;) {
+        const size_t bytes = std::min(left, burst);
+        rate_limiter->Request(bytes, Env::IO_LOW, nullptr /* stats */,
+                              RateLimiter::OpType::kWrite);
+        left -= bytes;
+      }
     }
     if (processed_buffer_size > options_.callback_trigger_interval_size) {
       processed_buffer_size -= options_.callback_trigger_interval_size;
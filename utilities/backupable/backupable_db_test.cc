@@ -2530,6 +2530,64 @@ TEST_F(BackupEngineTest, KeepLogFiles) {
   AssertBackupConsistency(0, 0, 500, 600, true);
 }
 
+TEST_F(BackupEngineTest, RestoreWithLinkedTableFiles) {
+  // The backup on the same Env as the DB
+  backupable_options_->backup_env = nullptr;
+  OpenDBAndBackupEngine(true);
+  FillDB(db_.get(), 0, 100, kFlushAll);
+  ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+  CloseDBAndBackupEngine();
+
+  BackupEngine* backup_engine;
+  ASSERT_OK(BackupEngine::Open(test_db_env_.get(), *backupable_options_,
+                               &backup_engine));
+  backup_engine_.reset(backup_engine);
+  RestoreOptions restore_options;
+  restore_options.link_table_files = true;
+  ASSERT_OK(backup_engine_->RestoreDBFromLatestBackup(restore_options, dbname_,
+                                                      dbname_));
+
+  std::vector<std::string> children;
+  ASSERT_OK(db_chroot_env_->GetChildren(dbname_, &children));
+  int num_table_files = 0;
+  for (const auto& child : children) {
+    uint64_t number;
+    FileType type;
+    if (ParseFileName(child, &number, &type) && type == kTableFile) {
+      uint64_t links = 0;
+      ASSERT_OK(db_chroot_env_->NumFileLinks(dbname_ + "/" + child, &links));
+      ASSERT_EQ(2U, links);
+      num_table_files++;
+    }
+  }
+  ASSERT_GT(num_table_files, 0);
+  ASSERT_OK(backup_engine_->VerifyBackup(1, true /* verify_with_checksum */));
+  backup_engine_.reset();
+
+  DB* db;
+  ASSERT_OK(DB::Open(options_, dbname_, &db));
+  db_.reset(db);
+  AssertExists(db_.get(), 0, 100);
+  db_.reset();
+  DestroyDir(test_db_env_.get(), backupdir_).PermitUncheckedError();
+}
+
+TEST_F(BackupEngineTest, IoBufferSize) {
+  // Reads larger than a burst of the rate limiters
+  backupable_options_->io_buffer_size = 256 * 1024 + 7;
+  backupable_options_->backup_rate_limit = 2 * 1024 * 1024;
+  backupable_options_->restore_rate_limit = 2 * 1024 * 1024;
+  backupable_options_->max_background_operations = 4;
+  options_.compression = kNoCompression;
+  OpenDBAndBackupEngine(true);
+  FillDB(db_.get(), 0, 5000);
+  ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+  ASSERT_OK(backup_engine_->VerifyBackup(1, true /* verify_with_checksum */));
+  CloseDBAndBackupEngine();
+
+  AssertBackupConsistency(0, 0, 5000, 5010);
+}
+
 #if !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
 class BackupEngineRateLimitingTestWithParam
     : public BackupEngineTest,
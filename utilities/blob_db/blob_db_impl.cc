@@ -1818,14 +1818,7 @@ bool BlobDBImpl::VisibleToActiveSnapshot(
   // implementation more complicated.
   SequenceNumber obsolete_sequence = bfile->GetObsoleteSequence();
   SequenceNumber oldest_snapshot = kMaxSequenceNumber;
-  {
-    // Need to lock DBImpl mutex before access snapshot list.
-    InstrumentedMutexLock l(db_impl_->mutex());
-    auto& snapshots = db_impl_->snapshots();
-    if (!snapshots.empty()) {
-      oldest_snapshot = snapshots.oldest()->GetSequenceNumber();
-    }
-  }
+  db_impl_->snapshots().GetOldest(&oldest_snapshot);
   bool visible = oldest_snapshot < obsolete_sequence;
   if (visible) {
     ROCKS_LOG_INFO(db_options_.info_log,
@@ -0,0 +1,359 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/bulk_loader.h"
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/env.h"
+#include "rocksdb/sst_file_reader.h"
+#include "rocksdb/sst_file_writer.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// The number of keys of every sorted run that Finish() picks the partition
+// boundaries from
+const size_t kSamplesPerRun = 128;
+
+struct SortedRun {
+  std::string file_path;
+  // Evenly spaced keys of the run
+  std::vector<std::string> samples;
+  Status status;
+};
+
+using Entries = std::vector<std::pair<std::string, std::string>>;
+
+class BulkLoaderImpl : public BulkLoader {
+ public:
+  BulkLoaderImpl(DB* db, ColumnFamilyHandle* column_family,
+                 const BulkLoaderOptions& options, const Options& cf_options)
+      : db_(db),
+        column_family_(column_family),
+        options_(options),
+        num_threads_(std::max(options.num_threads, 1)),
+        cf_options_(cf_options),
+        spill_options_(cf_options),
+        buffer_size_(0),
+        finished_(false) {
+    if (options_.target_file_size == 0) {
+      options_.target_file_size = cf_options_.target_file_size_base;
+    }
+    // The runs are read back once, soon after they are written
+    spill_options_.compression = kNoCompression;
+  }
+
+  ~BulkLoaderImpl() override {
+    MutexLock l(&mutex_);
+    WaitForSpills();
+    if (!finished_) {
+      for (const auto& run : runs_) {
+        RemoveFile(run->file_path);
+      }
+    }
+  }
+
+  Status Put(const Slice& key, const Slice& value) override {
+    MutexLock l(&mutex_);
+    if (finished_) {
+      return Status::InvalidArgument("The bulk load is finished");
+    }
+    buffer_.emplace_back(key.ToString(), value.ToString());
+    buffer_size_ += key.size() + value.size();
+    if (buffer_size_ >= options_.sort_buffer_size) {
+      StartSpill();
+    }
+    return Status::OK();
+  }
+
+  Status Finish() override;
+
+ private:
+  // Sorts and spills buffer_ on a thread of its own. Waits for the earlier
+  // spills first if num_threads of them are running.
+  // REQUIRES: mutex_ held
+  void StartSpill();
+  // REQUIRES: mutex_ held
+  void WaitForSpills();
+  void SortAndSpill(Entries* entries, SortedRun* run) const;
+  // Merges the runs over [*lower, *upper) into table files, whose paths are
+  // appended to *files. A null bound is unbounded.
+  Status WritePartition(const std::string* lower, const std::string* upper,
+                        size_t partition, std::vector<std::string>* files);
+  void RemoveFile(const std::string& path) const {
+    db_->GetEnv()->DeleteFile(path).PermitUncheckedError();
+  }
+
+  DB* const db_;
+  ColumnFamilyHandle* const column_family_;
+  BulkLoaderOptions options_;
+  const int num_threads_;
+  const Options cf_options_;
+  Options spill_options_;
+
+  port::Mutex mutex_;
+  Entries buffer_;
+  size_t buffer_size_;
+  std::vector<std::unique_ptr<SortedRun>> runs_;
+  std::vector<port::Thread> spill_threads_;
+  bool finished_;
+};
+
+void BulkLoaderImpl::StartSpill() {
+  mutex_.AssertHeld();
+  if (spill_threads_.size() >= static_cast<size_t>(num_threads_)) {
+    WaitForSpills();
+  }
+  runs_.emplace_back(new SortedRun());
+  SortedRun* run = runs_.back().get();
+  run->file_path =
+      options_.work_dir + "/run-" + ToString(runs_.size()) + ".sst";
+  std::shared_ptr<Entries> entries(new Entries(std::move(buffer_)));
+  buffer_.clear();
+  buffer_size_ = 0;
+  spill_threads_.emplace_back(
+      [this, entries, run]() { SortAndSpill(entries.get(), run); });
+}
+
+void BulkLoaderImpl::WaitForSpills() {
+  mutex_.AssertHeld();
+  for (auto& t : spill_threads_) {
+    t.join();
+  }
+  spill_threads_.clear();
+}
+
+void BulkLoaderImpl::SortAndSpill(Entries* entries, SortedRun* run) const {
+  const Comparator* ucmp = cf_options_.comparator;
+  std::stable_sort(entries->begin(), entries->end(),
+                   [ucmp](const std::pair<std::string, std::string>& a,
+                          const std::pair<std::string, std::string>& b) {
+                     return ucmp->Compare(a.first, b.first) < 0;
+                   });
+
+  SstFileWriter writer(EnvOptions(), spill_options_);
+  run->status = writer.Open(run->file_path);
+  const size_t sample_interval =
+      std::max<size_t>(entries->size() / kSamplesPerRun, 1);
+  for (size_t i = 0; i < entries->size() && run->status.ok(); i++) {
+    const auto& entry = (*entries)[i];
+    // Of the entries with the same key, keeps the one added last
+    if (i + 1 < entries->size() &&
+        ucmp->Equal(entry.first, (*entries)[i + 1].first)) {
+      continue;
+    }
+    if (i % sample_interval == 0) {
+      run->samples.push_back(entry.first);
+    }
+    run->status = writer.Put(entry.first, entry.second);
+  }
+  if (run->status.ok()) {
+    run->status = writer.Finish();
+  }
+}
+
+Status BulkLoaderImpl::WritePartition(const std::string* lower,
+                                      const std::string* upper,
+                                      size_t partition,
+                                      std::vector<std::string>* files) {
+  const Comparator* ucmp = cf_options_.comparator;
+  Status s;
+  std::vector<std::unique_ptr<SstFileReader>> readers;
+  std::vector<std::unique_ptr<Iterator>> iters;
+  for (const auto& run : runs_) {
+    readers.emplace_back(new SstFileReader(spill_options_));
+    s = readers.back()->Open(run->file_path);
+    if (!s.ok()) {
+      return s;
+    }
+    iters.emplace_back(readers.back()->NewIterator(ReadOptions()));
+    if (lower != nullptr) {
+      iters.back()->Seek(*lower);
+    } else {
+      iters.back()->SeekToFirst();
+    }
+  }
+
+  // The smallest key on top, and of equal keys that of the latest run
+  auto after = [&](size_t a, size_t b) {
+    int c = ucmp->Compare(iters[a]->key(), iters[b]->key());
+    return c > 0 || (c == 0 && a < b);
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(
+      after);
+  for (size_t i = 0; i < iters.size(); i++) {
+    if (iters[i]->Valid()) {
+      heap.push(i);
+    } else if (!iters[i]->status().ok()) {
+      return iters[i]->status();
+    }
+  }
+
+  std::unique_ptr<SstFileWriter> writer;
+  std::string key;
+  while (!heap.empty()) {
+    Iterator* iter = iters[heap.top()].get();
+    if (upper != nullptr && ucmp->Compare(iter->key(), *upper) >= 0) {
+      break;
+    }
+    if (writer != nullptr && writer->FileSize() >= options_.target_file_size) {
+      s = writer->Finish();
+      writer.reset();
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    if (writer == nullptr) {
+      files->push_back(options_.work_dir + "/part-" + ToString(partition) +
+                       "-" + ToString(files->size()) + ".sst");
+      writer.reset(
+          new SstFileWriter(EnvOptions(), cf_options_, column_family_));
+      s = writer->Open(files->back());
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    s = writer->Put(iter->key(), iter->value());
+    if (!s.ok()) {
+      return s;
+    }
+
+    // Skips the older entries with the same key
+    key.assign(iter->key().data(), iter->key().size());
+    while (!heap.empty() && ucmp->Equal(iters[heap.top()]->key(), key)) {
+      size_t i = heap.top();
+      heap.pop();
+      iters[i]->Next();
+      if (iters[i]->Valid()) {
+        heap.push(i);
+      } else if (!iters[i]->status().ok()) {
+        return iters[i]->status();
+      }
+    }
+  }
+  if (writer != nullptr) {
+    s = writer->Finish();
+  }
+  return s;
+}
+
+Status BulkLoaderImpl::Finish() {
+  {
+    MutexLock l(&mutex_);
+    if (finished_) {
+      return Status::InvalidArgument("The bulk load is finished");
+    }
+    finished_ = true;
+    if (!buffer_.empty()) {
+      StartSpill();
+    }
+    WaitForSpills();
+  }
+
+  Status s;
+  for (const auto& run : runs_) {
+    if (!run->status.ok()) {
+      s = run->status;
+      break;
+    }
+  }
+
+  std::vector<std::vector<std::string>> files;
+  if (s.ok() && !runs_.empty()) {
+    const Comparator* ucmp = cf_options_.comparator;
+    std::vector<std::string> samples;
+    for (const auto& run : runs_) {
+      samples.insert(samples.end(), run->samples.begin(), run->samples.end());
+    }
+    std::sort(samples.begin(), samples.end(),
+              [ucmp](const std::string& a, const std::string& b) {
+                return ucmp->Compare(a, b) < 0;
+              });
+    std::vector<std::string> boundaries;
+    for (int i = 1; i < num_threads_; i++) {
+      const std::string& sample = samples[samples.size() * i / num_threads_];
+      const std::string& previous =
+          boundaries.empty() ? samples.front() : boundaries.back();
+      if (ucmp->Compare(sample, previous) > 0) {
+        boundaries.push_back(sample);
+      }
+    }
+
+    const size_t num_partitions = boundaries.size() + 1;
+    files.resize(num_partitions);
+    std::vector<Status> statuses(num_partitions);
+    auto write_partition = [&](size_t i) {
+      statuses[i] = WritePartition(i == 0 ? nullptr : &boundaries[i - 1],
+                                   i + 1 == num_partitions ? nullptr
+                                                           : &boundaries[i],
+                                   i, &files[i]);
+    };
+    std::vector<port::Thread> threads;
+    for (size_t i = 1; i < num_partitions; i++) {
+      threads.emplace_back(write_partition, i);
+    }
+    write_partition(0);
+    for (auto& t : threads) {
+      t.join();
+    }
+    for (const auto& status : statuses) {
+      if (!status.ok()) {
+        s = status;
+        break;
+      }
+    }
+  }
+
+  std::vector<std::string> all_files;
+  for (const auto& partition_files : files) {
+    all_files.insert(all_files.end(), partition_files.begin(),
+                     partition_files.end());
+  }
+  if (s.ok() && !all_files.empty()) {
+    IngestExternalFileOptions ingest_options = options_.ingest_options;
+    ingest_options.move_files = true;
+    s = db_->IngestExternalFile(column_family_, all_files, ingest_options);
+  }
+
+  for (const auto& run : runs_) {
+    RemoveFile(run->file_path);
+  }
+  for (const auto& file : all_files) {
+    RemoveFile(file);
+  }
+  return s;
+}
+
+}  // namespace
+
+Status BulkLoader::Open(DB* db, ColumnFamilyHandle* column_family,
+                        const BulkLoaderOptions& options,
+                        std::unique_ptr<BulkLoader>* loader) {
+  if (options.work_dir.empty()) {
+    return Status::InvalidArgument("BulkLoaderOptions::work_dir is not set");
+  }
+  Status s = db->GetEnv()->CreateDirIfMissing(options.work_dir);
+  if (!s.ok()) {
+    return s;
+  }
+  loader->reset(new BulkLoaderImpl(db, column_family, options,
+                                   db->GetOptions(column_family)));
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,156 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/bulk_loader.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "file/file_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/db.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class BulkLoaderTest : public testing::Test {
+ public:
+  BulkLoaderTest() {
+    path_ = test::PerThreadDBPath("bulk_loader_test");
+    DestroyDir(Env::Default(), path_).PermitUncheckedError();
+    options_.create_if_missing = true;
+    options_.target_file_size_base = 16 << 10;
+    loader_options_.work_dir = path_ + "/bulk_load";
+    loader_options_.sort_buffer_size = 32 << 10;
+    EXPECT_OK(DB::Open(options_, path_ + "/db", &db_));
+  }
+
+  ~BulkLoaderTest() override {
+    delete db_;
+    EXPECT_OK(DestroyDir(Env::Default(), path_));
+  }
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return buf;
+  }
+
+  std::string path_;
+  Options options_;
+  BulkLoaderOptions loader_options_;
+  DB* db_ = nullptr;
+};
+
+TEST_F(BulkLoaderTest, UnsortedInput) {
+  std::unique_ptr<BulkLoader> loader;
+  ASSERT_OK(BulkLoader::Open(db_, db_->DefaultColumnFamily(), loader_options_,
+                             &loader));
+  const int kNumKeys = 10000;
+  std::vector<int> order;
+  for (int i = 0; i < kNumKeys; i++) {
+    order.push_back(i);
+  }
+  Random rnd(301);
+  RandomShuffle(order.begin(), order.end(), rnd.Next());
+  for (int i : order) {
+    ASSERT_OK(loader->Put(Key(i), "old" + ToString(i)));
+  }
+  // The last of several entries with the same key wins
+  for (int i = 0; i < kNumKeys; i += 10) {
+    ASSERT_OK(loader->Put(Key(i), "new" + ToString(i)));
+  }
+  ASSERT_OK(loader->Finish());
+  ASSERT_TRUE(loader->Put("a", "b").IsInvalidArgument());
+
+  std::string value;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(db_->Get(ReadOptions(), Key(i), &value));
+    ASSERT_EQ((i % 10 == 0 ? "new" : "old") + ToString(i), value);
+  }
+
+  // The files do not overlap, so all of them are in the bottommost level
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_GT(files.size(), 1U);
+  for (const auto& f : files) {
+    ASSERT_EQ(options_.num_levels - 1, f.level);
+  }
+
+  // Only the directory is left behind
+  std::vector<std::string> children;
+  ASSERT_OK(Env::Default()->GetChildren(loader_options_.work_dir, &children));
+  for (const auto& child : children) {
+    ASSERT_TRUE(child == "." || child == "..") << child;
+  }
+}
+
+TEST_F(BulkLoaderTest, ConcurrentStreams) {
+  std::unique_ptr<BulkLoader> loader;
+  ASSERT_OK(BulkLoader::Open(db_, db_->DefaultColumnFamily(), loader_options_,
+                             &loader));
+  const int kNumStreams = 4;
+  const int kKeysPerStream = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumStreams; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = t; i < kNumStreams * kKeysPerStream; i += kNumStreams) {
+        ASSERT_OK(loader->Put(Key(i), ToString(i)));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_OK(loader->Finish());
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int expected = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(expected), iter->key().ToString());
+    ASSERT_EQ(ToString(expected), iter->value().ToString());
+    expected++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumStreams * kKeysPerStream, expected);
+}
+
+TEST_F(BulkLoaderTest, Empty) {
+  std::unique_ptr<BulkLoader> loader;
+  loader_options_.work_dir.clear();
+  ASSERT_TRUE(BulkLoader::Open(db_, db_->DefaultColumnFamily(),
+                               loader_options_, &loader)
+                  .IsInvalidArgument());
+  loader_options_.work_dir = path_ + "/bulk_load";
+  ASSERT_OK(BulkLoader::Open(db_, db_->DefaultColumnFamily(), loader_options_,
+                             &loader));
+  ASSERT_OK(loader->Finish());
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(0U, files.size());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as BulkLoader is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
@@ -19,28 +19,57 @@ CompactionFilter::Decision CassandraCompactionFilter::FilterV2(
     int /*level*/, const Slice& /*key*/, ValueType value_type,
     const Slice& existing_value, std::string* new_value,
     std::string* /*skip_until*/) const {
+  // Works on the serialized row in place. Unless an expired column is
+  // removed or turned into a tombstone, the row is kept as is.
+  RowValueView row_value(existing_value.data(), existing_value.size());
+  const bool remove_tombstones = value_type == ValueType::kValue;
   bool value_changed = false;
-  RowValue row_value = RowValue::Deserialize(
-    existing_value.data(), existing_value.size());
-  RowValue compacted =
-      purge_ttl_on_expiration_
-          ? row_value.RemoveExpiredColumns(&value_changed)
-          : row_value.ConvertExpiredColumnsToTombstones(&value_changed);
-
-  if (value_type == ValueType::kValue) {
-    compacted = compacted.RemoveTombstones(gc_grace_period_in_seconds_);
+  for (const auto& column : row_value.columns()) {
+    if (column.Mask() == ColumnTypeMask::EXPIRATION_MASK && column.Expired()) {
+      value_changed = true;
+      break;
+    }
   }
 
-  if(compacted.Empty()) {
+  if (!value_changed) {
+    for (const auto& column : row_value.columns()) {
+      if (!remove_tombstones ||
+          column.Mask() != ColumnTypeMask::DELETION_MASK ||
+          !column.Collectable(gc_grace_period_in_seconds_)) {
+        return Decision::kKeep;
+      }
+    }
     return Decision::kRemove;
   }
 
-  if (value_changed) {
-    compacted.Serialize(new_value);
-    return Decision::kChangeValue;
+  RowValueView::SerializeRowHeader(new_value);
+  bool empty = true;
+  for (const auto& column : row_value.columns()) {
+    if (column.Mask() == ColumnTypeMask::EXPIRATION_MASK && column.Expired()) {
+      if (purge_ttl_on_expiration_) {
+        continue;
+      }
+      Tombstone tombstone = column.ToTombstone();
+      if (remove_tombstones &&
+          tombstone.Collectable(gc_grace_period_in_seconds_)) {
+        continue;
+      }
+      tombstone.Serialize(new_value);
+    } else {
+      if (remove_tombstones && column.Mask() == ColumnTypeMask::DELETION_MASK &&
+          column.Collectable(gc_grace_period_in_seconds_)) {
+        continue;
+      }
+      column.Serialize(new_value);
+    }
+    empty = false;
   }
 
-  return Decision::kKeep;
+  if (empty) {
+    new_value->clear();
+    return Decision::kRemove;
+  }
+  return Decision::kChangeValue;
 }
 
 }  // namespace cassandra
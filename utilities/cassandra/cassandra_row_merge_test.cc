@@ -105,6 +105,63 @@ TEST(RowValueMergeTest, MergeWithRowTombstone) {
   EXPECT_EQ(merged.LastModifiedTime(), 17);
 }
 
+TEST(RowValueMergeTest, MergeSerialized) {
+  std::vector<std::string> serialized(4);
+  CreateTestRowValue({
+    CreateTestColumnSpec(kTombstone, 0, 5),
+    CreateTestColumnSpec(kColumn, 1, 8),
+    CreateTestColumnSpec(kExpiringColumn, 2, 5),
+  }).Serialize(&serialized[0]);
+  CreateTestRowValue({
+    CreateTestColumnSpec(kColumn, 0, 2),
+    CreateTestColumnSpec(kExpiringColumn, 1, 5),
+    CreateTestColumnSpec(kTombstone, 2, 7),
+    CreateTestColumnSpec(kExpiringColumn, -7, 17),
+  }).Serialize(&serialized[1]);
+  CreateTestRowValue({
+    CreateTestColumnSpec(kExpiringColumn, 0, 6),
+    CreateTestColumnSpec(kTombstone, 1, 5),
+    CreateTestColumnSpec(kColumn, 2, 4),
+    CreateTestColumnSpec(kTombstone, 11, 11),
+  }).Serialize(&serialized[2]);
+  CreateRowTombstone(3).Serialize(&serialized[3]);
+
+  // Same result as merging deserialized rows, with or without the row
+  // tombstone, the collectable column tombstones removed or not
+  for (std::size_t num_rows : {1, 3, 4}) {
+    for (bool remove_tombstones : {false, true}) {
+      std::vector<RowValue> row_values;
+      std::vector<RowValueView> views;
+      for (std::size_t i = 0; i < num_rows; ++i) {
+        row_values.push_back(
+            RowValue::Deserialize(serialized[i].data(), serialized[i].size()));
+        views.emplace_back(serialized[i].data(), serialized[i].size());
+      }
+      RowValue merged = RowValue::Merge(std::move(row_values));
+      if (remove_tombstones) {
+        merged = merged.RemoveTombstones(/*gc_grace_period=*/0);
+      }
+      std::string expected;
+      merged.Serialize(&expected);
+      std::string actual;
+      RowValueView::Merge(std::move(views), remove_tombstones,
+                          /*gc_grace_period=*/0, &actual);
+      EXPECT_EQ(expected, actual);
+    }
+  }
+
+  // A row tombstone newer than all the columns wins
+  std::string tombstone;
+  CreateRowTombstone(20).Serialize(&tombstone);
+  std::vector<RowValueView> views;
+  views.emplace_back(serialized[0].data(), serialized[0].size());
+  views.emplace_back(tombstone.data(), tombstone.size());
+  std::string merged;
+  RowValueView::Merge(std::move(views), /*remove_tombstones=*/false,
+                      /*gc_grace_period=*/0, &merged);
+  EXPECT_EQ(tombstone, merged);
+}
+
 } // namespace cassandra
 }  // namespace ROCKSDB_NAMESPACE
 
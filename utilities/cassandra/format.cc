@@ -6,6 +6,8 @@
 #include "format.h"
 
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <map>
 #include <memory>
 
@@ -18,6 +20,43 @@ const int32_t kDefaultLocalDeletionTime =
   std::numeric_limits<int32_t>::max();
 const int64_t kDefaultMarkedForDeleteAt =
   std::numeric_limits<int64_t>::min();
+
+std::chrono::time_point<std::chrono::system_clock> ExpirationTime(
+    int64_t timestamp, int32_t ttl) {
+  return std::chrono::time_point<std::chrono::system_clock>(
+             std::chrono::microseconds(timestamp)) +
+         std::chrono::seconds(ttl);
+}
+
+bool IsExpired(int64_t timestamp, int32_t ttl) {
+  return ExpirationTime(timestamp, ttl) < std::chrono::system_clock::now();
+}
+
+Tombstone ExpiredTombstone(int8_t index, int64_t timestamp, int32_t ttl) {
+  auto expired_at = ExpirationTime(timestamp, ttl).time_since_epoch();
+  int32_t local_deletion_time = static_cast<int32_t>(
+    std::chrono::duration_cast<std::chrono::seconds>(expired_at).count());
+  int64_t marked_for_delete_at =
+    std::chrono::duration_cast<std::chrono::microseconds>(expired_at).count();
+  return Tombstone(static_cast<int8_t>(ColumnTypeMask::DELETION_MASK), index,
+                   local_deletion_time, marked_for_delete_at);
+}
+
+bool IsCollectable(int32_t local_deletion_time,
+                   int32_t gc_grace_period_in_seconds) {
+  auto local_deleted_at = std::chrono::time_point<std::chrono::system_clock>(
+      std::chrono::seconds(local_deletion_time));
+  auto gc_grace_period = std::chrono::seconds(gc_grace_period_in_seconds);
+  return local_deleted_at + gc_grace_period < std::chrono::system_clock::now();
+}
+
+void SerializeRowHeader(int32_t local_deletion_time,
+                        int64_t marked_for_delete_at, std::string* dest) {
+  ROCKSDB_NAMESPACE::cassandra::Serialize<int32_t>(local_deletion_time, dest);
+  ROCKSDB_NAMESPACE::cassandra::Serialize<int64_t>(marked_for_delete_at, dest);
+}
+
+const std::size_t kRowHeaderSize = sizeof(int32_t) + sizeof(int64_t);
 }
 
 ColumnBase::ColumnBase(int8_t mask, int8_t index)
@@ -112,29 +151,13 @@ void ExpiringColumn::Serialize(std::string* dest) const {
   ROCKSDB_NAMESPACE::cassandra::Serialize<int32_t>(ttl_, dest);
 }
 
-std::chrono::time_point<std::chrono::system_clock> ExpiringColumn::TimePoint() const {
-  return std::chrono::time_point<std::chrono::system_clock>(std::chrono::microseconds(Timestamp()));
-}
-
-std::chrono::seconds ExpiringColumn::Ttl() const {
-  return std::chrono::seconds(ttl_);
-}
-
 bool ExpiringColumn::Expired() const {
-  return TimePoint() + Ttl() < std::chrono::system_clock::now();
+  return IsExpired(Timestamp(), ttl_);
 }
 
 std::shared_ptr<Tombstone> ExpiringColumn::ToTombstone() const {
-  auto expired_at = (TimePoint() + Ttl()).time_since_epoch();
-  int32_t local_deletion_time = static_cast<int32_t>(
-    std::chrono::duration_cast<std::chrono::seconds>(expired_at).count());
-  int64_t marked_for_delete_at =
-    std::chrono::duration_cast<std::chrono::microseconds>(expired_at).count();
   return std::make_shared<Tombstone>(
-    static_cast<int8_t>(ColumnTypeMask::DELETION_MASK),
-    Index(),
-    local_deletion_time,
-    marked_for_delete_at);
+      ExpiredTombstone(Index(), Timestamp(), ttl_));
 }
 
 std::shared_ptr<ExpiringColumn> ExpiringColumn::Deserialize(
@@ -181,10 +204,7 @@ void Tombstone::Serialize(std::string* dest) const {
 }
 
 bool Tombstone::Collectable(int32_t gc_grace_period_in_seconds) const {
-  auto local_deleted_at = std::chrono::time_point<std::chrono::system_clock>(
-      std::chrono::seconds(local_deletion_time_));
-  auto gc_grace_period = std::chrono::seconds(gc_grace_period_in_seconds);
-  return local_deleted_at + gc_grace_period < std::chrono::system_clock::now();
+  return IsCollectable(local_deletion_time_, gc_grace_period_in_seconds);
 }
 
 std::shared_ptr<Tombstone> Tombstone::Deserialize(const char *src,
@@ -235,8 +255,7 @@ bool RowValue::IsTombstone() const {
 }
 
 void RowValue::Serialize(std::string* dest) const {
-  ROCKSDB_NAMESPACE::cassandra::Serialize<int32_t>(local_deletion_time_, dest);
-  ROCKSDB_NAMESPACE::cassandra::Serialize<int64_t>(marked_for_delete_at_, dest);
+  SerializeRowHeader(local_deletion_time_, marked_for_delete_at_, dest);
   for (const auto& column : columns_) {
     column -> Serialize(dest);
   }
@@ -386,5 +405,173 @@ RowValue RowValue::Merge(std::vector<RowValue>&& values) {
   return RowValue(std::move(columns), last_modified_time);
 }
 
+ColumnView::ColumnView(const char* src, std::size_t offset)
+    : data_(src + offset) {
+  mask_ = ROCKSDB_NAMESPACE::cassandra::Deserialize<int8_t>(src, offset);
+  offset += sizeof(mask_);
+  index_ = ROCKSDB_NAMESPACE::cassandra::Deserialize<int8_t>(src, offset);
+  offset += sizeof(index_);
+  // Same layouts as Tombstone, ExpiringColumn and Column
+  if ((mask_ & ColumnTypeMask::DELETION_MASK) != 0) {
+    timestamp_ = ROCKSDB_NAMESPACE::cassandra::Deserialize<int64_t>(
+        src, offset + sizeof(int32_t));
+    size_ = sizeof(mask_) + sizeof(index_) + sizeof(int32_t) +
+            sizeof(int64_t);
+  } else {
+    timestamp_ =
+        ROCKSDB_NAMESPACE::cassandra::Deserialize<int64_t>(src, offset);
+    int32_t value_size = ROCKSDB_NAMESPACE::cassandra::Deserialize<int32_t>(
+        src, offset + sizeof(timestamp_));
+    size_ = sizeof(mask_) + sizeof(index_) + sizeof(timestamp_) +
+            sizeof(value_size) + value_size;
+    if ((mask_ & ColumnTypeMask::EXPIRATION_MASK) != 0) {
+      size_ += sizeof(int32_t);
+    }
+  }
+}
+
+bool ColumnView::Collectable(int32_t gc_grace_period) const {
+  assert(mask_ == ColumnTypeMask::DELETION_MASK);
+  int32_t local_deletion_time =
+      ROCKSDB_NAMESPACE::cassandra::Deserialize<int32_t>(
+          data_, sizeof(mask_) + sizeof(index_));
+  return IsCollectable(local_deletion_time, gc_grace_period);
+}
+
+bool ColumnView::Expired() const {
+  assert(mask_ == ColumnTypeMask::EXPIRATION_MASK);
+  int32_t ttl = ROCKSDB_NAMESPACE::cassandra::Deserialize<int32_t>(
+      data_, size_ - sizeof(int32_t));
+  return IsExpired(timestamp_, ttl);
+}
+
+Tombstone ColumnView::ToTombstone() const {
+  assert(mask_ == ColumnTypeMask::EXPIRATION_MASK);
+  int32_t ttl = ROCKSDB_NAMESPACE::cassandra::Deserialize<int32_t>(
+      data_, size_ - sizeof(int32_t));
+  return ExpiredTombstone(index_, timestamp_, ttl);
+}
+
+RowValueView::RowValueView(const char* src, std::size_t size)
+    : data_(src), size_(size), last_modified_time_(0) {
+  assert(size >= kRowHeaderSize);
+  std::size_t offset = 0;
+  local_deletion_time_ =
+      ROCKSDB_NAMESPACE::cassandra::Deserialize<int32_t>(src, offset);
+  offset += sizeof(int32_t);
+  marked_for_delete_at_ =
+      ROCKSDB_NAMESPACE::cassandra::Deserialize<int64_t>(src, offset);
+  offset += sizeof(int64_t);
+  while (offset < size) {
+    columns_.emplace_back(src, offset);
+    const ColumnView& c = columns_.back();
+    offset += c.Size();
+    assert(offset <= size);
+    last_modified_time_ = std::max(last_modified_time_, c.Timestamp());
+  }
+}
+
+bool RowValueView::IsTombstone() const {
+  return marked_for_delete_at_ > kDefaultMarkedForDeleteAt;
+}
+
+int64_t RowValueView::LastModifiedTime() const {
+  if (IsTombstone()) {
+    return marked_for_delete_at_;
+  } else {
+    return last_modified_time_;
+  }
+}
+
+void RowValueView::SerializeRowHeader(std::string* dest) {
+  ROCKSDB_NAMESPACE::cassandra::SerializeRowHeader(
+      kDefaultLocalDeletionTime, kDefaultMarkedForDeleteAt, dest);
+}
+
+// Same as RowValue::Merge(), but picks the columns by pointer and copies
+// the chosen ones from the serialized rows. The columns of the merged row
+// are ordered by index, using a slot per possible index instead of a map.
+void RowValueView::Merge(std::vector<RowValueView>&& values,
+                         bool remove_tombstones, int32_t gc_grace_period,
+                         std::string* dest) {
+  assert(values.size() > 0);
+  auto keep_column = [&](const ColumnView& column) {
+    return !remove_tombstones ||
+           column.Mask() != ColumnTypeMask::DELETION_MASK ||
+           !column.Collectable(gc_grace_period);
+  };
+
+  const RowValueView* single_row = nullptr;
+  if (values.size() == 1) {
+    single_row = &values[0];
+  } else {
+    std::stable_sort(values.begin(), values.end(),
+                     [](const RowValueView& r1, const RowValueView& r2) {
+                       return r1.LastModifiedTime() > r2.LastModifiedTime();
+                     });
+
+    const int kMinIndex = std::numeric_limits<int8_t>::min();
+    std::array<const ColumnView*, 1 << (8 * sizeof(int8_t))> merged_columns;
+    merged_columns.fill(nullptr);
+    bool has_columns = false;
+    int64_t tombstone_timestamp = 0;
+
+    for (const auto& value : values) {
+      if (value.IsTombstone()) {
+        if (!has_columns) {
+          single_row = &value;
+        } else {
+          tombstone_timestamp = value.LastModifiedTime();
+        }
+        break;
+      }
+      for (const auto& column : value.columns_) {
+        const ColumnView*& merged = merged_columns[column.Index() - kMinIndex];
+        if (merged == nullptr || column.Timestamp() > merged->Timestamp()) {
+          merged = &column;
+        }
+        has_columns = true;
+      }
+    }
+
+    if (single_row == nullptr) {
+      std::size_t size = kRowHeaderSize;
+      for (auto& column : merged_columns) {
+        // Also filter out the columns older than the row tombstone
+        if (column != nullptr &&
+            (column->Timestamp() <= tombstone_timestamp ||
+             !keep_column(*column))) {
+          column = nullptr;
+        }
+        if (column != nullptr) {
+          size += column->Size();
+        }
+      }
+      dest->reserve(dest->size() + size);
+      SerializeRowHeader(dest);
+      for (const ColumnView* column : merged_columns) {
+        if (column != nullptr) {
+          column->Serialize(dest);
+        }
+      }
+      return;
+    }
+  }
+
+  if (!remove_tombstones) {
+    dest->append(single_row->data_, single_row->size_);
+    return;
+  }
+  // As RowValue::RemoveTombstones(), which also turns a row tombstone into
+  // a row without columns
+  dest->reserve(dest->size() + single_row->size_);
+  SerializeRowHeader(dest);
+  for (const auto& column : single_row->columns_) {
+    if (keep_column(column)) {
+      column.Serialize(dest);
+    }
+  }
+}
+
 } // namepsace cassandrda
 }  // namespace ROCKSDB_NAMESPACE
@@ -57,6 +57,7 @@
 #pragma once
 #include <chrono>
 #include <memory>
+#include <string>
 #include <vector>
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/slice.h"
@@ -138,8 +139,6 @@ public:
 
 private:
   int32_t ttl_;
-  std::chrono::time_point<std::chrono::system_clock> TimePoint() const;
-  std::chrono::seconds Ttl() const;
 };
 
 typedef std::vector<std::shared_ptr<ColumnBase>> Columns;
@@ -180,5 +179,67 @@ public:
   int64_t last_modified_time_;
 };
 
+// A column of a serialized row value, read in place. The serialized bytes
+// must outlive it.
+class ColumnView {
+ public:
+  // Parses the column at `offset` of `src`
+  ColumnView(const char* src, std::size_t offset);
+
+  int8_t Mask() const { return mask_; }
+  int8_t Index() const { return index_; }
+  // Same as ColumnBase::Timestamp()
+  int64_t Timestamp() const { return timestamp_; }
+  std::size_t Size() const { return size_; }
+  // For a tombstone column
+  bool Collectable(int32_t gc_grace_period) const;
+  // For an expiring column
+  bool Expired() const;
+  // Appends the serialized column as is
+  void Serialize(std::string* dest) const { dest->append(data_, size_); }
+  // For an expiring column, same as ExpiringColumn::ToTombstone()
+  Tombstone ToTombstone() const;
+
+ private:
+  const char* data_;
+  std::size_t size_;
+  int8_t mask_;
+  int8_t index_;
+  int64_t timestamp_;
+};
+
+// A serialized row value, read in place: the columns are located in the
+// serialized bytes and copied from them as is, instead of being
+// deserialized into column objects and serialized again like with
+// RowValue. The serialized bytes must outlive it.
+class RowValueView {
+ public:
+  RowValueView(const char* src, std::size_t size);
+
+  bool IsTombstone() const;
+  // Same as RowValue::LastModifiedTime()
+  int64_t LastModifiedTime() const;
+  const std::vector<ColumnView>& columns() const { return columns_; }
+
+  // Merges the rows like RowValue::Merge() and appends the serialized
+  // result to *dest. With remove_tombstones, the column tombstones that are
+  // collectable after gc_grace_period are left out, like with
+  // RowValue::RemoveTombstones().
+  static void Merge(std::vector<RowValueView>&& values,
+                    bool remove_tombstones, int32_t gc_grace_period,
+                    std::string* dest);
+  // Appends the header of a row that is not a row tombstone, to be followed
+  // by its serialized columns
+  static void SerializeRowHeader(std::string* dest);
+
+ private:
+  const char* data_;
+  std::size_t size_;
+  int32_t local_deletion_time_;
+  int64_t marked_for_delete_at_;
+  std::vector<ColumnView> columns_;
+  int64_t last_modified_time_;
+};
+
 } // namepsace cassandrda
 }  // namespace ROCKSDB_NAMESPACE
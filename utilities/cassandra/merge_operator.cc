@@ -22,21 +22,19 @@ bool CassandraValueMergeOperator::FullMergeV2(
     MergeOperationOutput* merge_out) const {
   // Clear the *new_value for writing.
   merge_out->new_value.clear();
-  std::vector<RowValue> row_values;
+  std::vector<RowValueView> row_values;
+  row_values.reserve(merge_in.operand_list.size() + 1);
   if (merge_in.existing_value) {
-    row_values.push_back(
-      RowValue::Deserialize(merge_in.existing_value->data(),
-                            merge_in.existing_value->size()));
+    row_values.emplace_back(merge_in.existing_value->data(),
+                            merge_in.existing_value->size());
   }
 
   for (auto& operand : merge_in.operand_list) {
-    row_values.push_back(RowValue::Deserialize(operand.data(), operand.size()));
+    row_values.emplace_back(operand.data(), operand.size());
   }
 
-  RowValue merged = RowValue::Merge(std::move(row_values));
-  merged = merged.RemoveTombstones(gc_grace_period_in_seconds_);
-  merge_out->new_value.reserve(merged.Size());
-  merged.Serialize(&(merge_out->new_value));
+  RowValueView::Merge(std::move(row_values), /* remove_tombstones */ true,
+                      gc_grace_period_in_seconds_, &merge_out->new_value);
 
   return true;
 }
@@ -48,13 +46,13 @@ bool CassandraValueMergeOperator::PartialMergeMulti(
   assert(new_value);
   new_value->clear();
 
-  std::vector<RowValue> row_values;
+  std::vector<RowValueView> row_values;
+  row_values.reserve(operand_list.size());
   for (auto& operand : operand_list) {
-    row_values.push_back(RowValue::Deserialize(operand.data(), operand.size()));
+    row_values.emplace_back(operand.data(), operand.size());
   }
-  RowValue merged = RowValue::Merge(std::move(row_values));
-  new_value->reserve(merged.Size());
-  merged.Serialize(new_value);
+  RowValueView::Merge(std::move(row_values), /* remove_tombstones */ false,
+                      gc_grace_period_in_seconds_, new_value);
   return true;
 }
 
@@ -31,6 +31,7 @@
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
 #include "util/file_checksum_helper.h"
+#include "util/stop_watch.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -84,6 +85,9 @@ Status CheckpointImpl::CreateCheckpoint(const std::string& checkpoint_dir,
                                         const std::string& db_log_dir,
                                         const std::string& wal_dir) {
   DBOptions db_options = db_->GetDBOptions();
+  SystemClock* clock = db_->GetEnv()->GetSystemClock().get();
+  StopWatch sw(clock, db_options.statistics.get(), CHECKPOINT_MICROS);
+  const uint64_t start_micros = clock->NowMicros();
 
   Status s = db_->GetEnv()->FileExists(checkpoint_dir);
   if (s.ok()) {
@@ -229,6 +233,8 @@ Status CheckpointImpl::CreateCheckpoint(const std::string& checkpoint_dir,
     ROCKS_LOG_INFO(db_options.info_log, "Snapshot DONE. All is good");
     ROCKS_LOG_INFO(db_options.info_log, "Snapshot sequence number: %" PRIu64,
                    sequence_number);
+    ROCKS_LOG_INFO(db_options.info_log, "Snapshot took %" PRIu64 " micros",
+                   clock->NowMicros() - start_micros);
   } else {
     // clean all the files we might have created
     ROCKS_LOG_INFO(db_options.info_log, "Snapshot failed -- %s",
@@ -433,13 +439,14 @@ Status CheckpointImpl::CreateCustomCheckpoint(
                  live_wal_files.size());
 
   // Link WAL files. Copy exact size of last one because it is the only one
-  // that has changes after the last flush.
+  // that has changes after the last flush. Whether or not the memtables were
+  // flushed, the WALs before min_log_num only hold data that is already in
+  // the table files of the copied MANIFEST, so they are left out.
   ImmutableDBOptions ioptions(db_options);
   auto wal_dir = ioptions.GetWalDir();
   for (size_t i = 0; s.ok() && i < wal_size; ++i) {
     if ((live_wal_files[i]->Type() == kAliveLogFile) &&
-        (!flush_memtable ||
-         live_wal_files[i]->LogNumber() >= min_log_num)) {
+        live_wal_files[i]->LogNumber() >= min_log_num) {
       if (i + 1 == wal_size) {
         s = copy_file_cb(wal_dir, live_wal_files[i]->PathName(),
                          live_wal_files[i]->SizeFileBytes(), kWalFile,
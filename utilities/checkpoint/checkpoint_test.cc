@@ -600,6 +600,52 @@ TEST_F(CheckpointTest, CheckpointCFNoFlush) {
   snapshotDB = nullptr;
 }
 
+TEST_F(CheckpointTest, CheckpointNoFlushSkipsObsoleteWals) {
+  Options options = CurrentOptions();
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+
+  // Keeps the WAL that the flush makes obsolete
+  ASSERT_OK(db_->DisableFileDeletions());
+  ASSERT_OK(Put("a", "1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("b", "2"));
+  VectorLogPtr wal_files;
+  ASSERT_OK(db_->GetSortedWalFiles(wal_files));
+  ASSERT_GE(wal_files.size(), 2U);
+
+  Checkpoint* checkpoint;
+  ASSERT_OK(Checkpoint::Create(db_, &checkpoint));
+  ASSERT_OK(checkpoint->CreateCheckpoint(snapshot_name_, port::kMaxUint64));
+  delete checkpoint;
+  ASSERT_OK(db_->EnableFileDeletions(false));
+  HistogramData checkpoint_micros;
+  options.statistics->histogramData(CHECKPOINT_MICROS, &checkpoint_micros);
+  ASSERT_EQ(1U, checkpoint_micros.count);
+
+  std::vector<std::string> children;
+  ASSERT_OK(env_->GetChildren(snapshot_name_, &children));
+  int num_wal_files = 0;
+  for (const auto& child : children) {
+    uint64_t number;
+    FileType type;
+    if (ParseFileName(child, &number, &type) && type == kWalFile) {
+      num_wal_files++;
+    }
+  }
+  ASSERT_EQ(1, num_wal_files);
+
+  DB* snapshot_db;
+  options.create_if_missing = false;
+  ASSERT_OK(DB::Open(options, snapshot_name_, &snapshot_db));
+  std::string result;
+  ASSERT_OK(snapshot_db->Get(ReadOptions(), "a", &result));
+  ASSERT_EQ("1", result);
+  ASSERT_OK(snapshot_db->Get(ReadOptions(), "b", &result));
+  ASSERT_EQ("2", result);
+  delete snapshot_db;
+}
+
 TEST_F(CheckpointTest, CurrentFileModifiedWhileCheckpointing) {
   Options options = CurrentOptions();
   options.max_manifest_file_size = 0;  // always rollover manifest for file add
@@ -0,0 +1,106 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/parallel_scan.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+Status ScanRange(DB* db, ReadOptions read_options,
+                 ColumnFamilyHandle* column_family, const Slice* lower,
+                 const Slice* upper, size_t range_index,
+                 const ParallelScanFunc& scan_fn) {
+  read_options.iterate_lower_bound = lower;
+  read_options.iterate_upper_bound = upper;
+  std::unique_ptr<Iterator> iter(db->NewIterator(read_options, column_family));
+  if (lower != nullptr) {
+    iter->Seek(*lower);
+  } else {
+    iter->SeekToFirst();
+  }
+  Status s = iter->status();
+  if (s.ok()) {
+    s = scan_fn(range_index, iter.get());
+  }
+  if (s.ok()) {
+    s = iter->status();
+  }
+  return s;
+}
+
+}  // anonymous namespace
+
+Status ParallelScan(DB* db, const ReadOptions& read_options,
+                    ColumnFamilyHandle* column_family, size_t num_ranges,
+                    const ParallelScanFunc& scan_fn) {
+  if (db == nullptr || num_ranges == 0 || !scan_fn) {
+    return Status::InvalidArgument("Invalid arguments");
+  }
+  if (column_family == nullptr) {
+    column_family = db->DefaultColumnFamily();
+  }
+
+  std::vector<std::string> split_keys;
+  Status s = db->GetKeyRangeSplits(
+      column_family, read_options.iterate_lower_bound,
+      read_options.iterate_upper_bound, num_ranges, &split_keys);
+  if (!s.ok()) {
+    return s;
+  }
+  // bounds[i] and bounds[i + 1] delimit range i.
+  std::vector<Slice> split_slices(split_keys.begin(), split_keys.end());
+  std::vector<const Slice*> bounds;
+  bounds.push_back(read_options.iterate_lower_bound);
+  for (const auto& split : split_slices) {
+    bounds.push_back(&split);
+  }
+  bounds.push_back(read_options.iterate_upper_bound);
+  const size_t num_splits = split_keys.size() + 1;
+
+  ReadOptions ro = read_options;
+  const Snapshot* snapshot = nullptr;
+  if (ro.snapshot == nullptr) {
+    snapshot = db->GetSnapshot();
+    ro.snapshot = snapshot;
+  }
+
+  std::vector<Status> statuses(num_splits);
+  std::vector<port::Thread> threads;
+  threads.reserve(num_splits - 1);
+  for (size_t i = 1; i < num_splits; ++i) {
+    threads.emplace_back([&, i]() {
+      statuses[i] = ScanRange(db, ro, column_family, bounds[i], bounds[i + 1],
+                              i, scan_fn);
+    });
+  }
+  statuses[0] =
+      ScanRange(db, ro, column_family, bounds[0], bounds[1], 0, scan_fn);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (snapshot != nullptr) {
+    db->ReleaseSnapshot(snapshot);
+  }
+  for (const auto& status : statuses) {
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,199 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/parallel_scan.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "db/db_test_util.h"
+#include "port/port.h"
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ParallelScanTest : public DBTestBase {
+ public:
+  ParallelScanTest()
+      : DBTestBase("parallel_scan_test", /*env_do_fsync=*/false) {}
+
+  // Writes kNumKeys keys over several L0 files and a compacted lower level.
+  void FillDB() {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+      if (i == kNumKeys / 2) {
+        ASSERT_OK(Flush());
+        ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+      } else if (i % 1000 == 999) {
+        ASSERT_OK(Flush());
+      }
+    }
+    ASSERT_OK(Flush());
+    ASSERT_GT(NumTableFilesAtLevel(0), 1);
+  }
+
+  int CountKeys(const Slice* lower, const Slice* upper) {
+    ReadOptions ro;
+    ro.iterate_lower_bound = lower;
+    ro.iterate_upper_bound = upper;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ++count;
+    }
+    EXPECT_OK(iter->status());
+    return count;
+  }
+
+  static constexpr int kNumKeys = 8000;
+};
+
+constexpr int ParallelScanTest::kNumKeys;
+
+TEST_F(ParallelScanTest, GetKeyRangeSplits) {
+  FillDB();
+  std::vector<std::string> splits;
+  ASSERT_TRUE(db_->GetKeyRangeSplits(db_->DefaultColumnFamily(), nullptr,
+                                     nullptr, 0, &splits)
+                  .IsInvalidArgument());
+  ASSERT_OK(db_->GetKeyRangeSplits(db_->DefaultColumnFamily(), nullptr,
+                                   nullptr, 1, &splits));
+  ASSERT_TRUE(splits.empty());
+
+  ASSERT_OK(db_->GetKeyRangeSplits(db_->DefaultColumnFamily(), nullptr,
+                                   nullptr, 4, &splits));
+  ASSERT_EQ(3U, splits.size());
+  for (size_t i = 0; i <= splits.size(); ++i) {
+    Slice lower = i > 0 ? Slice(splits[i - 1]) : Slice();
+    Slice upper = i < splits.size() ? Slice(splits[i]) : Slice();
+    int count = CountKeys(i > 0 ? &lower : nullptr,
+                          i < splits.size() ? &upper : nullptr);
+    // Balanced to within the granularity of the index samples.
+    ASSERT_GT(count, kNumKeys / 4 / 2);
+    ASSERT_LT(count, kNumKeys / 4 * 2);
+  }
+
+  // Restricted to a sub-range, splits stay strictly inside it.
+  std::string begin = Key(1000);
+  std::string end = Key(3000);
+  Slice begin_slice(begin);
+  Slice end_slice(end);
+  ASSERT_OK(db_->GetKeyRangeSplits(db_->DefaultColumnFamily(), &begin_slice,
+                                   &end_slice, 2, &splits));
+  ASSERT_EQ(1U, splits.size());
+  ASSERT_GT(splits[0], begin);
+  ASSERT_LT(splits[0], end);
+  Slice split(splits[0]);
+  ASSERT_GT(CountKeys(&begin_slice, &split), 500);
+  ASSERT_GT(CountKeys(&split, &end_slice), 500);
+}
+
+TEST_F(ParallelScanTest, GetKeyRangeSplitsEmptyDB) {
+  std::vector<std::string> splits{"stale"};
+  ASSERT_OK(db_->GetKeyRangeSplits(db_->DefaultColumnFamily(), nullptr,
+                                   nullptr, 8, &splits));
+  ASSERT_TRUE(splits.empty());
+}
+
+TEST_F(ParallelScanTest, ScanAll) {
+  FillDB();
+  const size_t kNumRanges = 4;
+  std::vector<std::vector<std::string>> keys(kNumRanges);
+  std::atomic<size_t> calls{0};
+  ASSERT_OK(ParallelScan(db_, ReadOptions(), nullptr, kNumRanges,
+                         [&](size_t range_index, Iterator* iter) {
+                           EXPECT_LT(range_index, kNumRanges);
+                           calls++;
+                           if (range_index == 0) {
+                             // Not visible through the shared snapshot.
+                             EXPECT_OK(Put(Key(kNumKeys), "new"));
+                             EXPECT_OK(Delete(Key(kNumKeys - 1)));
+                           }
+                           for (; iter->Valid(); iter->Next()) {
+                             keys[range_index].push_back(
+                                 iter->key().ToString());
+                           }
+                           return Status::OK();
+                         }));
+  ASSERT_EQ(kNumRanges, calls.load());
+
+  std::vector<std::string> all;
+  for (const auto& range_keys : keys) {
+    ASSERT_FALSE(range_keys.empty());
+    if (!all.empty()) {
+      ASSERT_LT(all.back(), range_keys.front());
+    }
+    all.insert(all.end(), range_keys.begin(), range_keys.end());
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumKeys), all.size());
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(Key(i), all[i]);
+  }
+}
+
+TEST_F(ParallelScanTest, Bounds) {
+  FillDB();
+  std::string lower = Key(100);
+  std::string upper = Key(5100);
+  Slice lower_slice(lower);
+  Slice upper_slice(upper);
+  ReadOptions ro;
+  ro.iterate_lower_bound = &lower_slice;
+  ro.iterate_upper_bound = &upper_slice;
+  std::atomic<int> count{0};
+  ASSERT_OK(ParallelScan(db_, ro, nullptr, 3,
+                         [&](size_t /*range_index*/, Iterator* iter) {
+                           for (; iter->Valid(); iter->Next()) {
+                             EXPECT_GE(iter->key().ToString(), lower);
+                             EXPECT_LT(iter->key().ToString(), upper);
+                             count++;
+                           }
+                           return Status::OK();
+                         }));
+  ASSERT_EQ(5000, count.load());
+}
+
+TEST_F(ParallelScanTest, Error) {
+  FillDB();
+  Status s = ParallelScan(db_, ReadOptions(), nullptr, 4,
+                          [](size_t range_index, Iterator* /*iter*/) {
+                            return range_index == 2 ? Status::Aborted("stop")
+                                                    : Status::OK();
+                          });
+  ASSERT_TRUE(s.IsAborted());
+  ASSERT_TRUE(ParallelScan(db_, ReadOptions(), nullptr, 0,
+                           [](size_t, Iterator*) { return Status::OK(); })
+                  .IsInvalidArgument());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as ParallelScan is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
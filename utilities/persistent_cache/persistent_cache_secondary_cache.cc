@@ -0,0 +1,75 @@
+//  Copyright (c) 2021-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#ifndef ROCKSDB_LITE
+
+#include "utilities/persistent_cache/persistent_cache_secondary_cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The result of a lookup, ready as soon as it is returned.
+class ReadyResultHandle : public SecondaryCacheResultHandle {
+ public:
+  ReadyResultHandle(void* value, size_t size) : value_(value), size_(size) {}
+
+  bool IsReady() override { return true; }
+
+  void Wait() override {}
+
+  void* Value() override { return value_; }
+
+  size_t Size() override { return size_; }
+
+ private:
+  void* value_;
+  size_t size_;
+};
+}  // namespace
+
+Status PersistentCacheSecondaryCache::Insert(
+    const Slice& key, void* value, const Cache::CacheItemHelper* helper) {
+  size_t size = (*helper->size_cb)(value);
+  if (size == 0) {
+    return Status::OK();
+  }
+  std::unique_ptr<char[]> buf(new char[size]);
+  Status s = (*helper->saveto_cb)(value, 0, size, buf.get());
+  if (!s.ok()) {
+    return s;
+  }
+  return cache_->Insert(key, buf.get(), size);
+}
+
+std::unique_ptr<SecondaryCacheResultHandle>
+PersistentCacheSecondaryCache::Lookup(const Slice& key,
+                                      const Cache::CreateCallback& create_cb,
+                                      bool /*wait*/) {
+  std::unique_ptr<SecondaryCacheResultHandle> handle;
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  if (!cache_->Lookup(key, &data, &size).ok()) {
+    return handle;
+  }
+  void* value = nullptr;
+  size_t charge = 0;
+  if (create_cb(data.get(), size, &value, &charge).ok()) {
+    handle.reset(new ReadyResultHandle(value, charge));
+  }
+  return handle;
+}
+
+std::string PersistentCacheSecondaryCache::GetPrintableOptions() const {
+  return cache_->GetPrintableOptions();
+}
+
+std::shared_ptr<SecondaryCache> NewPersistentCacheSecondaryCache(
+    const std::shared_ptr<PersistentCache>& cache) {
+  return std::make_shared<PersistentCacheSecondaryCache>(cache);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
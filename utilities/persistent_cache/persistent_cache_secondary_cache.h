@@ -0,0 +1,55 @@
+//  Copyright (c) 2021-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/persistent_cache.h"
+#include "rocksdb/secondary_cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A SecondaryCache that stores the entries demoted from a block cache in a
+// PersistentCache, e.g. a BlockCacheTier on local flash, and promotes them
+// back on a hit. Created by NewPersistentCacheSecondaryCache().
+//
+// Lookups read the page synchronously. Entries are never erased: a promoted
+// entry is not demoted again when the block cache evicts it, so it must stay
+// in the persistent cache, which evicts pages on its own as it fills up.
+class PersistentCacheSecondaryCache : public SecondaryCache {
+ public:
+  explicit PersistentCacheSecondaryCache(
+      const std::shared_ptr<PersistentCache>& cache)
+      : cache_(cache) {}
+  ~PersistentCacheSecondaryCache() override {}
+
+  static const char* kClassName() { return "PersistentCacheSecondaryCache"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status Insert(const Slice& key, void* value,
+                const Cache::CacheItemHelper* helper) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CreateCallback& create_cb,
+      bool wait) override;
+
+  void Erase(const Slice& /*key*/) override {}
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> /*handles*/) override {}
+
+  std::string GetPrintableOptions() const override;
+
+ private:
+  std::shared_ptr<PersistentCache> cache_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
@@ -15,6 +15,8 @@
 #include <thread>
 
 #include "file/file_util.h"
+#include "rocksdb/perf_context.h"
+#include "rocksdb/secondary_cache.h"
 #include "utilities/persistent_cache/block_cache_tier.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -276,6 +278,57 @@ TEST_F(PersistentCacheTierTest, FactoryTest) {
   }
 }
 
+TEST_F(PersistentCacheTierTest, SecondaryCacheTest) {
+  struct Item {
+    std::string data;
+  };
+  Cache::CacheItemHelper helper(
+      [](void* obj) -> size_t { return static_cast<Item*>(obj)->data.size(); },
+      [](void* obj, size_t offset, size_t size, void* out) -> Status {
+        memcpy(out, static_cast<Item*>(obj)->data.data() + offset, size);
+        return Status::OK();
+      },
+      [](const Slice& /*key*/, void* obj) { delete static_cast<Item*>(obj); });
+  Cache::CreateCallback create_cb = [](void* buf, size_t size, void** out_obj,
+                                       size_t* charge) -> Status {
+    *out_obj = new Item{std::string(static_cast<char*>(buf), size)};
+    *charge = size;
+    return Status::OK();
+  };
+
+  cache_ = std::make_shared<VolatileCacheTier>();
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewPersistentCacheSecondaryCache(cache_);
+  LRUCacheOptions opts(/*capacity=*/1024, /*num_shard_bits=*/0,
+                       /*strict_capacity_limit=*/false,
+                       /*high_pri_pool_ratio=*/0.5, nullptr,
+                       kDefaultToAdaptiveMutex, kDontChargeCacheMetadata);
+  opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> block_cache = NewLRUCache(opts);
+
+  // Each entry evicts the previous one into the secondary cache.
+  const int kNumKeys = 10;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(block_cache->Insert("key" + ToString(i),
+                                  new Item{std::string(1000, 'a' + i)},
+                                  &helper, /*charge=*/1000));
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    Cache::Handle* handle =
+        block_cache->Lookup("key" + ToString(i), &helper, create_cb,
+                            Cache::Priority::LOW, /*wait=*/true);
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(static_cast<Item*>(block_cache->Value(handle))->data,
+              std::string(1000, 'a' + i));
+    block_cache->Release(handle);
+  }
+  ASSERT_EQ(block_cache->Lookup("key" + ToString(kNumKeys), &helper,
+                                create_cb, Cache::Priority::LOW,
+                                /*wait=*/true),
+            nullptr);
+  block_cache.reset();
+}
+
 PersistentCacheDBTest::PersistentCacheDBTest()
     : DBTestBase("cache_test", /*env_do_fsync=*/true) {
 #ifdef OS_LINUX
@@ -429,6 +482,47 @@ TEST_F(PersistentCacheDBTest, BasicTest) {
 
 // test table with block page cache
 // DISABLED for now (very expensive, especially memory)
+TEST_F(PersistentCacheDBTest, SecondaryCacheTest) {
+  std::shared_ptr<PersistentCacheTier> pcache =
+      NewBlockCache(env_, test::PerThreadDBPath(env_, "secondary_cache"));
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  LRUCacheOptions cache_opts(/*capacity=*/64 * 1024, /*num_shard_bits=*/0,
+                             /*strict_capacity_limit=*/false,
+                             /*high_pri_pool_ratio=*/0.5);
+  cache_opts.secondary_cache = NewPersistentCacheSecondaryCache(pcache);
+  table_options.block_cache = NewLRUCache(cache_opts);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 1000;
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumKeys; i++) {
+    values.push_back(rnd.RandomString(1000));
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  ASSERT_OK(Flush());
+
+  // The data blocks do not fit in the block cache, so reading them all
+  // spills most of them into the persistent cache.
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+  pcache->TEST_Flush();
+
+  get_perf_context()->Reset();
+  SetPerfLevel(PerfLevel::kEnableCount);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+  ASSERT_GT(get_perf_context()->secondary_cache_hit_count, 0);
+  SetPerfLevel(PerfLevel::kDisable);
+
+  Close();
+  ASSERT_OK(pcache->Close());
+}
+
 TEST_F(PersistentCacheDBTest, DISABLED_BlockCacheTest) {
   RunTest(std::bind(&MakeBlockCache, env_, dbname_));
 }
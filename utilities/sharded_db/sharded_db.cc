@@ -0,0 +1,542 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/sharded_db.h"
+
+#include <algorithm>
+
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/env.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+const char* kShardingFileName = "/SHARDING";
+
+class ShardedSnapshot : public Snapshot {
+ public:
+  SequenceNumber GetSequenceNumber() const override {
+    return snapshots[0]->GetSequenceNumber();
+  }
+
+  // By shard
+  std::vector<const Snapshot*> snapshots;
+};
+
+// Merges the iterators of the shards. The current child is picked by a
+// linear scan over all of them, which for the tens of shards a ShardedDB
+// has is about as fast as a heap.
+class ShardedIterator : public Iterator {
+ public:
+  ShardedIterator(const Comparator* comparator,
+                  std::vector<std::unique_ptr<Iterator>>&& children)
+      : comparator_(comparator), children_(std::move(children)) {}
+
+  bool Valid() const override { return current_ != nullptr; }
+
+  void SeekToFirst() override {
+    for (auto& child : children_) {
+      child->SeekToFirst();
+    }
+    forward_ = true;
+    FindSmallest();
+  }
+
+  void SeekToLast() override {
+    for (auto& child : children_) {
+      child->SeekToLast();
+    }
+    forward_ = false;
+    FindLargest();
+  }
+
+  void Seek(const Slice& target) override {
+    for (auto& child : children_) {
+      child->Seek(target);
+    }
+    forward_ = true;
+    FindSmallest();
+  }
+
+  void SeekForPrev(const Slice& target) override {
+    for (auto& child : children_) {
+      child->SeekForPrev(target);
+    }
+    forward_ = false;
+    FindLargest();
+  }
+
+  void Next() override {
+    assert(Valid());
+    if (!forward_) {
+      // Moves the other children to their first key after key()
+      for (auto& child : children_) {
+        if (child.get() == current_) {
+          continue;
+        }
+        child->Seek(key());
+        if (child->Valid() && comparator_->Equal(key(), child->key())) {
+          child->Next();
+        }
+      }
+      forward_ = true;
+    }
+    current_->Next();
+    FindSmallest();
+  }
+
+  void Prev() override {
+    assert(Valid());
+    if (forward_) {
+      // Moves the other children to their last key before key()
+      for (auto& child : children_) {
+        if (child.get() == current_) {
+          continue;
+        }
+        child->SeekForPrev(key());
+        if (child->Valid() && comparator_->Equal(key(), child->key())) {
+          child->Prev();
+        }
+      }
+      forward_ = false;
+    }
+    current_->Prev();
+    FindLargest();
+  }
+
+  Slice key() const override {
+    assert(Valid());
+    return current_->key();
+  }
+
+  Slice value() const override {
+    assert(Valid());
+    return current_->value();
+  }
+
+  Status status() const override {
+    for (const auto& child : children_) {
+      Status s = child->status();
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  void FindSmallest() {
+    current_ = nullptr;
+    for (auto& child : children_) {
+      if (child->Valid() &&
+          (current_ == nullptr ||
+           comparator_->Compare(child->key(), current_->key()) < 0)) {
+        current_ = child.get();
+      }
+    }
+  }
+
+  void FindLargest() {
+    current_ = nullptr;
+    for (auto& child : children_) {
+      if (child->Valid() &&
+          (current_ == nullptr ||
+           comparator_->Compare(child->key(), current_->key()) > 0)) {
+        current_ = child.get();
+      }
+    }
+  }
+
+  const Comparator* const comparator_;
+  std::vector<std::unique_ptr<Iterator>> children_;
+  Iterator* current_ = nullptr;
+  bool forward_ = true;
+};
+
+class ShardedDBImpl;
+
+// Splits a WriteBatch into one per shard
+class SplitBatchHandler : public WriteBatch::Handler {
+ public:
+  SplitBatchHandler(const ShardedDBImpl* db, std::vector<WriteBatch>* batches)
+      : db_(db), batches_(batches) {}
+
+  Status PutCF(uint32_t cf_id, const Slice& key, const Slice& value) override;
+  Status DeleteCF(uint32_t cf_id, const Slice& key) override;
+  Status SingleDeleteCF(uint32_t cf_id, const Slice& key) override;
+  Status DeleteRangeCF(uint32_t cf_id, const Slice& begin_key,
+                       const Slice& end_key) override;
+  Status MergeCF(uint32_t cf_id, const Slice& key,
+                 const Slice& value) override;
+  void LogData(const Slice& blob) override {
+    for (auto& batch : *batches_) {
+      batch.PutLogData(blob).PermitUncheckedError();
+    }
+  }
+
+ private:
+  WriteBatch* Batch(uint32_t cf_id, const Slice& key, Status* s);
+
+  const ShardedDBImpl* const db_;
+  std::vector<WriteBatch>* const batches_;
+};
+
+class ShardedDBImpl : public ShardedDB {
+ public:
+  ShardedDBImpl(const Options& options,
+                const ShardedDBOptions& sharded_options)
+      : comparator_(options.comparator), sharded_options_(sharded_options) {}
+
+  ~ShardedDBImpl() override {}
+
+  Status OpenShards(const Options& options, const std::string& path) {
+    for (size_t i = 0; i < sharded_options_.num_shards; i++) {
+      DB* db = nullptr;
+      Status s = DB::Open(options, path + "/shard-" + ToString(i), &db);
+      if (!s.ok()) {
+        return s;
+      }
+      shards_.emplace_back(db);
+    }
+    return Status::OK();
+  }
+
+  size_t num_shards() const override { return shards_.size(); }
+
+  size_t ShardForKey(const Slice& key) const override {
+    const auto& boundaries = sharded_options_.range_boundaries;
+    if (boundaries.empty()) {
+      return GetSliceRangedNPHash(key, shards_.size());
+    }
+    return static_cast<size_t>(
+        std::upper_bound(boundaries.begin(), boundaries.end(), key,
+                         [this](const Slice& a, const std::string& b) {
+                           return comparator_->Compare(a, b) < 0;
+                         }) -
+        boundaries.begin());
+  }
+
+  DB* GetShard(size_t shard) const override {
+    assert(shard < shards_.size());
+    return shards_[shard].get();
+  }
+
+  Status Put(const WriteOptions& options, const Slice& key,
+             const Slice& value) override {
+    return Shard(key)->Put(options, key, value);
+  }
+
+  Status Delete(const WriteOptions& options, const Slice& key) override {
+    return Shard(key)->Delete(options, key);
+  }
+
+  Status SingleDelete(const WriteOptions& options, const Slice& key) override {
+    return Shard(key)->SingleDelete(options, key);
+  }
+
+  Status Merge(const WriteOptions& options, const Slice& key,
+               const Slice& value) override {
+    return Shard(key)->Merge(options, key, value);
+  }
+
+  Status Write(const WriteOptions& options, WriteBatch* updates) override {
+    std::vector<WriteBatch> batches(shards_.size());
+    SplitBatchHandler handler(this, &batches);
+    Status s = updates->Iterate(&handler);
+    if (!s.ok()) {
+      return s;
+    }
+    size_t num_batches = 0;
+    size_t last_shard = 0;
+    for (size_t i = 0; i < batches.size(); i++) {
+      if (batches[i].Count() > 0) {
+        num_batches++;
+        last_shard = i;
+      }
+    }
+    if (num_batches == 0) {
+      return Status::OK();
+    }
+    if (num_batches == 1) {
+      return shards_[last_shard]->Write(options, &batches[last_shard]);
+    }
+    // Keeps GetSnapshot() from seeing only part of the batch
+    ReadLock l(&snapshot_mutex_);
+    for (size_t i = 0; i < batches.size() && s.ok(); i++) {
+      if (batches[i].Count() > 0) {
+        s = shards_[i]->Write(options, &batches[i]);
+      }
+    }
+    return s;
+  }
+
+  Status Get(const ReadOptions& options, const Slice& key,
+             std::string* value) override {
+    const size_t shard = ShardForKey(key);
+    return shards_[shard]->Get(ShardReadOptions(options, shard), key, value);
+  }
+
+  std::vector<Status> MultiGet(const ReadOptions& options,
+                               const std::vector<Slice>& keys,
+                               std::vector<std::string>* values) override {
+    std::vector<Status> statuses(keys.size());
+    values->assign(keys.size(), std::string());
+    std::vector<std::vector<size_t>> shard_indexes(shards_.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      shard_indexes[ShardForKey(keys[i])].push_back(i);
+    }
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+      const std::vector<size_t>& indexes = shard_indexes[shard];
+      if (indexes.empty()) {
+        continue;
+      }
+      std::vector<Slice> shard_keys;
+      for (size_t i : indexes) {
+        shard_keys.push_back(keys[i]);
+      }
+      std::vector<std::string> shard_values;
+      std::vector<Status> shard_statuses = shards_[shard]->MultiGet(
+          ShardReadOptions(options, shard), shard_keys, &shard_values);
+      for (size_t j = 0; j < indexes.size(); j++) {
+        statuses[indexes[j]] = shard_statuses[j];
+        (*values)[indexes[j]] = std::move(shard_values[j]);
+      }
+    }
+    return statuses;
+  }
+
+  Iterator* NewIterator(const ReadOptions& options) override {
+    ReadOptions read_options = options;
+    const Snapshot* owned_snapshot = nullptr;
+    if (read_options.snapshot == nullptr) {
+      owned_snapshot = GetSnapshot();
+      read_options.snapshot = owned_snapshot;
+    }
+    std::vector<std::unique_ptr<Iterator>> children;
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+      children.emplace_back(
+          shards_[shard]->NewIterator(ShardReadOptions(read_options, shard)));
+    }
+    Iterator* iter = new ShardedIterator(comparator_, std::move(children));
+    if (owned_snapshot != nullptr) {
+      iter->RegisterCleanup(
+          [](void* arg1, void* arg2) {
+            static_cast<ShardedDBImpl*>(arg1)->ReleaseSnapshot(
+                static_cast<const Snapshot*>(arg2));
+          },
+          this, const_cast<Snapshot*>(owned_snapshot));
+    }
+    return iter;
+  }
+
+  const Snapshot* GetSnapshot() override {
+    ShardedSnapshot* snapshot = new ShardedSnapshot();
+    WriteLock l(&snapshot_mutex_);
+    for (auto& shard : shards_) {
+      snapshot->snapshots.push_back(shard->GetSnapshot());
+    }
+    return snapshot;
+  }
+
+  void ReleaseSnapshot(const Snapshot* snapshot) override {
+    if (snapshot == nullptr) {
+      return;
+    }
+    const ShardedSnapshot* sharded_snapshot =
+        static_cast<const ShardedSnapshot*>(snapshot);
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+      shards_[shard]->ReleaseSnapshot(sharded_snapshot->snapshots[shard]);
+    }
+    delete sharded_snapshot;
+  }
+
+  Status Flush(const FlushOptions& options) override {
+    Status s;
+    for (auto& shard : shards_) {
+      Status shard_s = shard->Flush(options);
+      if (s.ok()) {
+        s = shard_s;
+      }
+    }
+    return s;
+  }
+
+  Status Close() override {
+    Status s;
+    for (auto& shard : shards_) {
+      Status shard_s = shard->Close();
+      if (s.ok()) {
+        s = shard_s;
+      }
+    }
+    return s;
+  }
+
+ private:
+  DB* Shard(const Slice& key) const {
+    return shards_[ShardForKey(key)].get();
+  }
+
+  // `options` with the snapshot of `shard`
+  static ReadOptions ShardReadOptions(const ReadOptions& options,
+                                      size_t shard) {
+    ReadOptions read_options = options;
+    if (options.snapshot != nullptr) {
+      read_options.snapshot =
+          static_cast<const ShardedSnapshot*>(options.snapshot)
+              ->snapshots[shard];
+    }
+    return read_options;
+  }
+
+  const Comparator* const comparator_;
+  const ShardedDBOptions sharded_options_;
+  std::vector<std::unique_ptr<DB>> shards_;
+  // Held shared by writes to several shards, and exclusively while taking
+  // a snapshot
+  port::RWMutex snapshot_mutex_;
+};
+
+WriteBatch* SplitBatchHandler::Batch(uint32_t cf_id, const Slice& key,
+                                     Status* s) {
+  if (cf_id != 0) {
+    *s = Status::NotSupported("ShardedDB only has the default column family");
+    return nullptr;
+  }
+  return &(*batches_)[db_->ShardForKey(key)];
+}
+
+Status SplitBatchHandler::PutCF(uint32_t cf_id, const Slice& key,
+                                const Slice& value) {
+  Status s;
+  WriteBatch* batch = Batch(cf_id, key, &s);
+  return batch != nullptr ? batch->Put(key, value) : s;
+}
+
+Status SplitBatchHandler::DeleteCF(uint32_t cf_id, const Slice& key) {
+  Status s;
+  WriteBatch* batch = Batch(cf_id, key, &s);
+  return batch != nullptr ? batch->Delete(key) : s;
+}
+
+Status SplitBatchHandler::SingleDeleteCF(uint32_t cf_id, const Slice& key) {
+  Status s;
+  WriteBatch* batch = Batch(cf_id, key, &s);
+  return batch != nullptr ? batch->SingleDelete(key) : s;
+}
+
+Status SplitBatchHandler::DeleteRangeCF(uint32_t cf_id, const Slice& begin_key,
+                                       const Slice& end_key) {
+  if (cf_id != 0) {
+    return Status::NotSupported("ShardedDB only has the default column family");
+  }
+  for (auto& batch : *batches_) {
+    Status s = batch.DeleteRange(begin_key, end_key);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+Status SplitBatchHandler::MergeCF(uint32_t cf_id, const Slice& key,
+                                  const Slice& value) {
+  Status s;
+  WriteBatch* batch = Batch(cf_id, key, &s);
+  return batch != nullptr ? batch->Merge(key, value) : s;
+}
+
+// The contents of the SHARDING file, which keeps a sharded DB from being
+// reopened with another partitioning
+std::string ShardingDescription(const ShardedDBOptions& sharded_options) {
+  std::string description =
+      "num_shards=" + ToString(sharded_options.num_shards) + "\n";
+  for (const std::string& boundary : sharded_options.range_boundaries) {
+    description += "range_boundary=" + Slice(boundary).ToString(true) + "\n";
+  }
+  return description;
+}
+
+}  // namespace
+
+Status ShardedDB::Open(const Options& options,
+                       const ShardedDBOptions& sharded_options,
+                       const std::string& path,
+                       std::unique_ptr<ShardedDB>* sharded_db) {
+  sharded_db->reset();
+  if (sharded_options.num_shards == 0) {
+    return Status::InvalidArgument("num_shards must be positive");
+  }
+  const auto& boundaries = sharded_options.range_boundaries;
+  if (!boundaries.empty()) {
+    if (boundaries.size() != sharded_options.num_shards - 1) {
+      return Status::InvalidArgument(
+          "range_boundaries must have num_shards - 1 keys");
+    }
+    for (size_t i = 1; i < boundaries.size(); i++) {
+      if (options.comparator->Compare(boundaries[i - 1], boundaries[i]) >= 0) {
+        return Status::InvalidArgument(
+            "range_boundaries must be in increasing order");
+      }
+    }
+  }
+
+  Env* env = options.env;
+  const std::string sharding_file = path + kShardingFileName;
+  const std::string description = ShardingDescription(sharded_options);
+  Status s = env->FileExists(sharding_file);
+  if (s.ok()) {
+    std::string existing;
+    s = ReadFileToString(env, sharding_file, &existing);
+    if (!s.ok()) {
+      return s;
+    }
+    if (existing != description) {
+      return Status::InvalidArgument(
+          path, "was created with another number of shards or boundaries");
+    }
+  } else if (s.IsNotFound()) {
+    if (!options.create_if_missing) {
+      return Status::InvalidArgument(
+          path, "does not exist (create_if_missing is false)");
+    }
+    s = env->CreateDirIfMissing(path);
+    if (s.ok()) {
+      s = WriteStringToFile(env, description, sharding_file,
+                            true /* should_sync */);
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  } else {
+    return s;
+  }
+
+  Options shard_options = options;
+  if (shard_options.write_buffer_manager == nullptr &&
+      shard_options.db_write_buffer_size > 0) {
+    shard_options.write_buffer_manager = std::make_shared<WriteBufferManager>(
+        shard_options.db_write_buffer_size);
+  }
+  std::unique_ptr<ShardedDBImpl> impl(
+      new ShardedDBImpl(shard_options, sharded_options));
+  s = impl->OpenShards(shard_options, path);
+  if (s.ok()) {
+    sharded_db->reset(impl.release());
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,217 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/sharded_db.h"
+
+#include <string>
+#include <vector>
+
+#include "file/file_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ShardedDBTest : public testing::Test {
+ public:
+  ShardedDBTest() {
+    path_ = test::PerThreadDBPath("sharded_db_test");
+    options_.create_if_missing = true;
+    sharded_options_.num_shards = 4;
+    DestroyDir(Env::Default(), path_).PermitUncheckedError();
+  }
+
+  ~ShardedDBTest() override {
+    db_.reset();
+    EXPECT_OK(DestroyDir(Env::Default(), path_));
+  }
+
+  Status Open() {
+    return ShardedDB::Open(options_, sharded_options_, path_, &db_);
+  }
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return buf;
+  }
+
+  std::string path_;
+  Options options_;
+  ShardedDBOptions sharded_options_;
+  std::unique_ptr<ShardedDB> db_;
+};
+
+TEST_F(ShardedDBTest, HashPartitioning) {
+  ASSERT_OK(Open());
+  ASSERT_EQ(4U, db_->num_shards());
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(db_->Put(WriteOptions(), Key(i), "v" + ToString(i)));
+  }
+  std::vector<int> keys_per_shard(db_->num_shards());
+  std::string value;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(db_->Get(ReadOptions(), Key(i), &value));
+    ASSERT_EQ("v" + ToString(i), value);
+    const size_t shard = db_->ShardForKey(Key(i));
+    ASSERT_OK(db_->GetShard(shard)->Get(ReadOptions(), Key(i), &value));
+    keys_per_shard[shard]++;
+  }
+  for (int count : keys_per_shard) {
+    ASSERT_GT(count, kNumKeys / 8);
+  }
+
+  ASSERT_OK(db_->Delete(WriteOptions(), Key(0)));
+  ASSERT_TRUE(db_->Get(ReadOptions(), Key(0), &value).IsNotFound());
+
+  const std::vector<std::string> key_data = {Key(0), Key(1), Key(2)};
+  std::vector<Slice> keys(key_data.begin(), key_data.end());
+  std::vector<std::string> values;
+  std::vector<Status> statuses = db_->MultiGet(ReadOptions(), keys, &values);
+  ASSERT_TRUE(statuses[0].IsNotFound());
+  ASSERT_OK(statuses[1]);
+  ASSERT_EQ("v1", values[1]);
+  ASSERT_OK(statuses[2]);
+  ASSERT_EQ("v2", values[2]);
+
+  // The shards share one write buffer manager
+  ASSERT_EQ(db_->GetShard(0)->GetOptions().write_buffer_manager,
+            db_->GetShard(3)->GetOptions().write_buffer_manager);
+}
+
+TEST_F(ShardedDBTest, RangePartitioning) {
+  sharded_options_.range_boundaries = {Key(100), Key(200), Key(300)};
+  ASSERT_OK(Open());
+  ASSERT_EQ(0U, db_->ShardForKey(Key(0)));
+  ASSERT_EQ(0U, db_->ShardForKey(Key(99)));
+  ASSERT_EQ(1U, db_->ShardForKey(Key(100)));
+  ASSERT_EQ(2U, db_->ShardForKey(Key(250)));
+  ASSERT_EQ(3U, db_->ShardForKey(Key(300)));
+  ASSERT_EQ(3U, db_->ShardForKey("z"));
+
+  sharded_options_.range_boundaries = {Key(200), Key(100), Key(300)};
+  std::unique_ptr<ShardedDB> db;
+  ASSERT_TRUE(ShardedDB::Open(options_, sharded_options_, path_ + "2", &db)
+                  .IsInvalidArgument());
+}
+
+TEST_F(ShardedDBTest, ReopenWithOtherPartitioning) {
+  ASSERT_OK(Open());
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "1"));
+  ASSERT_OK(db_->Close());
+  db_.reset();
+
+  sharded_options_.num_shards = 8;
+  ASSERT_TRUE(Open().IsInvalidArgument());
+  sharded_options_.num_shards = 4;
+  ASSERT_OK(Open());
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ("1", value);
+}
+
+TEST_F(ShardedDBTest, CrossShardBatchAndSnapshot) {
+  ASSERT_OK(Open());
+  WriteBatch batch;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(batch.Put(Key(i), "old"));
+  }
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+
+  const Snapshot* snapshot = db_->GetSnapshot();
+  batch.Clear();
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(batch.Put(Key(i), "new"));
+  }
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+
+  ReadOptions read_options;
+  read_options.snapshot = snapshot;
+  std::string value;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(db_->Get(read_options, Key(i), &value));
+    ASSERT_EQ("old", value);
+    ASSERT_OK(db_->Get(ReadOptions(), Key(i), &value));
+    ASSERT_EQ("new", value);
+  }
+  db_->ReleaseSnapshot(snapshot);
+
+  // Only the default column family is sharded
+  WriteBatch cf_batch;
+  ColumnFamilyHandle* cf = nullptr;
+  ASSERT_OK(db_->GetShard(0)->CreateColumnFamily(ColumnFamilyOptions(), "cf",
+                                                 &cf));
+  ASSERT_OK(cf_batch.Put(cf, "a", "1"));
+  ASSERT_TRUE(db_->Write(WriteOptions(), &cf_batch).IsNotSupported());
+  ASSERT_OK(db_->GetShard(0)->DestroyColumnFamilyHandle(cf));
+}
+
+TEST_F(ShardedDBTest, MergedIterator) {
+  ASSERT_OK(Open());
+  const int kNumKeys = 500;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(db_->Put(WriteOptions(), Key(i), ToString(i)));
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  // Not seen by the iterator, which has its own snapshot
+  ASSERT_OK(db_->Put(WriteOptions(), Key(1), "1"));
+
+  int expected = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(expected), iter->key().ToString());
+    ASSERT_EQ(ToString(expected), iter->value().ToString());
+    expected += 2;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, expected);
+
+  expected = kNumKeys - 2;
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    ASSERT_EQ(Key(expected), iter->key().ToString());
+    expected -= 2;
+  }
+  ASSERT_EQ(-2, expected);
+
+  // Changes direction
+  iter->Seek(Key(101));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(102), iter->key().ToString());
+  iter->Prev();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(100), iter->key().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(102), iter->key().ToString());
+
+  iter->SeekForPrev(Key(101));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(100), iter->key().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(102), iter->key().ToString());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as ShardedDB is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
@@ -6,6 +6,7 @@
 #include "utilities/simulator_cache/cache_simulator.h"
 #include <algorithm>
 #include "db/dbformat.h"
+#include "port/port.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -282,4 +283,51 @@ void BlockCacheTraceSimulator::Access(const BlockCacheTraceRecord& access) {
   }
 }
 
+void BlockCacheTraceSimulator::Access(
+    const std::vector<BlockCacheTraceRecord>& accesses, size_t num_threads) {
+  if (accesses.empty()) {
+    return;
+  }
+  if (trace_start_time_ == 0) {
+    trace_start_time_ = accesses.front().access_timestamp;
+  }
+  // The index of the access that completes the warmup, if in this batch
+  size_t warmup_index = accesses.size();
+  if (!warmup_complete_) {
+    for (size_t i = 0; i < accesses.size(); ++i) {
+      if (trace_start_time_ + warmup_seconds_ * kMicrosInSecond <=
+          accesses[i].access_timestamp) {
+        warmup_index = i;
+        warmup_complete_ = true;
+        break;
+      }
+    }
+  }
+  std::vector<CacheSimulator*> sim_caches;
+  for (auto& config_caches : sim_caches_) {
+    for (auto& sim_cache : config_caches.second) {
+      sim_caches.push_back(sim_cache.get());
+    }
+  }
+  auto simulate = [&](size_t first_cache) {
+    for (size_t c = first_cache; c < sim_caches.size(); c += num_threads) {
+      for (size_t i = 0; i < accesses.size(); ++i) {
+        if (i == warmup_index) {
+          sim_caches[c]->reset_counter();
+        }
+        sim_caches[c]->Access(accesses[i]);
+      }
+    }
+  };
+  num_threads = std::max<size_t>(1, std::min(num_threads, sim_caches.size()));
+  std::vector<port::Thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(simulate, t);
+  }
+  simulate(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -211,6 +211,12 @@ class BlockCacheTraceSimulator {
 
   void Access(const BlockCacheTraceRecord& access);
 
+  // Same as calling Access() on each of the accesses in order, with the
+  // simulated caches split among up to num_threads threads. The simulated
+  // caches are independent, so the results are the same.
+  void Access(const std::vector<BlockCacheTraceRecord>& accesses,
+              size_t num_threads);
+
   const std::map<CacheConfiguration,
                  std::vector<std::shared_ptr<CacheSimulator>>>&
   sim_caches() const {
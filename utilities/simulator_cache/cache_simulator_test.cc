@@ -486,6 +486,54 @@ TEST_F(CacheSimulatorTest, GhostHybridRowBlockCacheSimulator) {
                     cache_simulator->miss_ratio_stats().user_miss_ratio()));
 }
 
+TEST_F(CacheSimulatorTest, BlockCacheTraceSimulatorBatchedAccess) {
+  std::vector<CacheConfiguration> configs;
+  configs.push_back({"lru", /*num_shard_bits=*/0, /*ghost_cache_capacity=*/0,
+                     {4096, 3 * 4096, kCacheSize}});
+  configs.push_back({"lru_hybrid", /*num_shard_bits=*/0,
+                     /*ghost_cache_capacity=*/0, {4096, kCacheSize}});
+  std::vector<BlockCacheTraceRecord> accesses;
+  for (uint64_t i = 0; i < 100; i++) {
+    BlockCacheTraceRecord record = GenerateGetRecord(/*getid=*/i);
+    record.block_key = kBlockKeyPrefix + std::to_string(i % 7);
+    record.referenced_key =
+        kRefKeyPrefix + std::to_string(i % 5) + kRefKeySequenceNumber;
+    record.access_timestamp = i + 1;
+    accesses.push_back(record);
+  }
+  BlockCacheTraceSimulator sequential(/*warmup_seconds=*/0,
+                                      /*downsample_ratio=*/1, configs);
+  BlockCacheTraceSimulator batched(/*warmup_seconds=*/0,
+                                   /*downsample_ratio=*/1, configs);
+  ASSERT_OK(sequential.InitializeCaches());
+  ASSERT_OK(batched.InitializeCaches());
+  for (const auto& access : accesses) {
+    sequential.Access(access);
+  }
+  // Split across batches and more threads than simulated caches
+  const size_t kBatchSize = 30;
+  for (size_t i = 0; i < accesses.size(); i += kBatchSize) {
+    std::vector<BlockCacheTraceRecord> batch(
+        accesses.begin() + i,
+        accesses.begin() + std::min(accesses.size(), i + kBatchSize));
+    batched.Access(batch, /*num_threads=*/8);
+  }
+  ASSERT_EQ(sequential.sim_caches().size(), batched.sim_caches().size());
+  for (const auto& config_caches : sequential.sim_caches()) {
+    const auto& batched_caches = batched.sim_caches().at(config_caches.first);
+    ASSERT_EQ(config_caches.second.size(), batched_caches.size());
+    for (size_t i = 0; i < batched_caches.size(); i++) {
+      const MissRatioStats& expected =
+          config_caches.second[i]->miss_ratio_stats();
+      const MissRatioStats& actual = batched_caches[i]->miss_ratio_stats();
+      ASSERT_EQ(expected.total_accesses(), actual.total_accesses());
+      ASSERT_EQ(expected.total_misses(), actual.total_misses());
+      ASSERT_EQ(expected.user_accesses(), actual.user_accesses());
+      ASSERT_EQ(expected.user_misses(), actual.user_misses());
+    }
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,354 @@
+//  Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <algorithm>
+#include <cinttypes>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/utilities/sim_cache.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Computes the LRU stack distance of each access to a key: the total charge
+// of the distinct keys accessed since the previous access to the same key,
+// plus its own charge. An LRU cache of capacity C hits exactly the accesses
+// with distance <= C (Mattson et al.), so one pass yields the hits of all
+// capacities.
+//
+// Every tracked key owns one slot in access order; a Fenwick tree over the
+// slots holds the charge of the key in each slot, so the charge accessed
+// after a slot is a prefix sum away. Keys beyond `max_distance` are
+// forgotten, oldest first, as they cannot hit in any simulated cache.
+//
+// Not thread safe.
+class StackDistanceTracker {
+ public:
+  static constexpr uint64_t kColdMiss = std::numeric_limits<uint64_t>::max();
+
+  explicit StackDistanceTracker(uint64_t max_distance)
+      : max_distance_(max_distance) {
+    Resize(kMinSlots);
+  }
+
+  // Records an access and returns its stack distance, or kColdMiss if the
+  // key is not tracked.
+  uint64_t Access(const Slice& key, size_t charge) {
+    uint64_t distance = kColdMiss;
+    auto it = entries_.find(key.ToString());
+    if (it != entries_.end()) {
+      Entry& entry = it->second;
+      distance = tracked_bytes_ - PrefixSum(entry.slot) + charge;
+      Add(entry.slot, -static_cast<int64_t>(entry.charge));
+      slot_keys_[entry.slot] = nullptr;
+      tracked_bytes_ -= entry.charge;
+    } else {
+      it = entries_.emplace(key.ToString(), Entry()).first;
+    }
+    if (next_slot_ == slot_keys_.size()) {
+      Compact();
+    }
+    it->second.slot = next_slot_;
+    it->second.charge = charge;
+    Add(next_slot_, static_cast<int64_t>(charge));
+    slot_keys_[next_slot_] = &it->first;
+    ++next_slot_;
+    tracked_bytes_ += charge;
+
+    while (tracked_bytes_ > max_distance_) {
+      EvictOldest();
+    }
+    return distance;
+  }
+
+ private:
+  static constexpr size_t kMinSlots = 1024;
+
+  struct Entry {
+    size_t slot = 0;
+    size_t charge = 0;
+  };
+
+  void EvictOldest() {
+    while (slot_keys_[oldest_slot_] == nullptr) {
+      ++oldest_slot_;
+    }
+    auto it = entries_.find(*slot_keys_[oldest_slot_]);
+    assert(it != entries_.end());
+    Add(oldest_slot_, -static_cast<int64_t>(it->second.charge));
+    tracked_bytes_ -= it->second.charge;
+    slot_keys_[oldest_slot_] = nullptr;
+    entries_.erase(it);
+  }
+
+  // Moves the tracked keys to the first slots, keeping their order, with
+  // room for at least as many new accesses.
+  void Compact() {
+    std::vector<const std::string*> keys;
+    keys.reserve(entries_.size());
+    for (size_t slot = oldest_slot_; slot < next_slot_; ++slot) {
+      if (slot_keys_[slot] != nullptr) {
+        keys.push_back(slot_keys_[slot]);
+      }
+    }
+    Resize(std::max(kMinSlots, 2 * keys.size()));
+    for (const std::string* key : keys) {
+      Entry& entry = entries_[*key];
+      entry.slot = next_slot_++;
+      slot_keys_[entry.slot] = key;
+      tree_[entry.slot + 1] = static_cast<int64_t>(entry.charge);
+    }
+    // Linear-time Fenwick tree construction
+    for (size_t i = 1; i < tree_.size(); ++i) {
+      size_t parent = i + (i & (~i + 1));
+      if (parent < tree_.size()) {
+        tree_[parent] += tree_[i];
+      }
+    }
+  }
+
+  void Resize(size_t num_slots) {
+    slot_keys_.assign(num_slots, nullptr);
+    tree_.assign(num_slots + 1, 0);
+    oldest_slot_ = 0;
+    next_slot_ = 0;
+  }
+
+  void Add(size_t slot, int64_t delta) {
+    for (size_t i = slot + 1; i < tree_.size(); i += i & (~i + 1)) {
+      tree_[i] += delta;
+    }
+  }
+
+  // Total charge of the slots up to and including `slot`
+  uint64_t PrefixSum(size_t slot) const {
+    int64_t sum = 0;
+    for (size_t i = slot + 1; i > 0; i -= i & (~i + 1)) {
+      sum += tree_[i];
+    }
+    return static_cast<uint64_t>(sum);
+  }
+
+  const uint64_t max_distance_;
+  std::unordered_map<std::string, Entry> entries_;
+  // Key of the entry in each slot (owned by entries_), or nullptr
+  std::vector<const std::string*> slot_keys_;
+  std::vector<int64_t> tree_;
+  size_t oldest_slot_ = 0;
+  size_t next_slot_ = 0;
+  uint64_t tracked_bytes_ = 0;
+};
+
+class MissRatioCurveCacheImpl : public MissRatioCurveCache {
+ public:
+  MissRatioCurveCacheImpl(std::shared_ptr<Cache> cache,
+                          std::vector<size_t> capacities, double sampling_rate)
+      : cache_(std::move(cache)),
+        capacities_(std::move(capacities)),
+        sampling_threshold_(
+            static_cast<uint64_t>(sampling_rate * kSamplingModulus)),
+        hits_(capacities_.size(), 0),
+        tracker_(static_cast<uint64_t>(capacities_.back() * sampling_rate)) {
+    for (size_t capacity : capacities_) {
+      sampled_capacities_.push_back(
+          static_cast<uint64_t>(capacity * sampling_rate));
+    }
+  }
+
+  using Cache::Insert;
+  Status Insert(const Slice& key, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value), Handle** handle,
+                Priority priority) override {
+    // A lookup that missed is followed by the insert of the block read
+    // instead, so the access is recorded here, with the charge known.
+    RecordAccess(key, charge);
+    return cache_->Insert(key, value, charge, deleter, handle, priority);
+  }
+
+  using Cache::Lookup;
+  Handle* Lookup(const Slice& key, Statistics* stats) override {
+    Handle* h = cache_->Lookup(key, stats);
+    if (h != nullptr) {
+      RecordAccess(key, cache_->GetCharge(h));
+    }
+    return h;
+  }
+
+  bool Ref(Handle* handle) override { return cache_->Ref(handle); }
+
+  using Cache::Release;
+  bool Release(Handle* handle, bool force_erase = false) override {
+    return cache_->Release(handle, force_erase);
+  }
+
+  void Erase(const Slice& key) override { cache_->Erase(key); }
+
+  void* Value(Handle* handle) override { return cache_->Value(handle); }
+
+  uint64_t NewId() override { return cache_->NewId(); }
+
+  void SetCapacity(size_t capacity) override { cache_->SetCapacity(capacity); }
+
+  void SetStrictCapacityLimit(bool strict_capacity_limit) override {
+    cache_->SetStrictCapacityLimit(strict_capacity_limit);
+  }
+
+  bool HasStrictCapacityLimit() const override {
+    return cache_->HasStrictCapacityLimit();
+  }
+
+  size_t GetCapacity() const override { return cache_->GetCapacity(); }
+
+  size_t GetUsage() const override { return cache_->GetUsage(); }
+
+  size_t GetUsage(Handle* handle) const override {
+    return cache_->GetUsage(handle);
+  }
+
+  size_t GetCharge(Handle* handle) const override {
+    return cache_->GetCharge(handle);
+  }
+
+  DeleterFn GetDeleter(Handle* handle) const override {
+    return cache_->GetDeleter(handle);
+  }
+
+  size_t GetPinnedUsage() const override { return cache_->GetPinnedUsage(); }
+
+  void DisownData() override { cache_->DisownData(); }
+
+  void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
+                              bool thread_safe) override {
+    cache_->ApplyToAllCacheEntries(callback, thread_safe);
+  }
+
+  void ApplyToAllEntries(
+      const std::function<void(const Slice& key, void* value, size_t charge,
+                               DeleterFn deleter)>& callback,
+      const ApplyToAllEntriesOptions& opts) override {
+    cache_->ApplyToAllEntries(callback, opts);
+  }
+
+  void EraseUnRefEntries() override { cache_->EraseUnRefEntries(); }
+
+  std::string GetPrintableOptions() const override {
+    std::string ret;
+    ret.append("    cache_options:\n");
+    ret.append(cache_->GetPrintableOptions());
+    char buffer[100];
+    snprintf(buffer, sizeof(buffer), "    sampling_rate: %.6f\n",
+             static_cast<double>(sampling_threshold_) / kSamplingModulus);
+    ret.append(buffer);
+    return ret;
+  }
+
+  std::vector<Point> GetMissRatioCurve() const override {
+    MutexLock l(&mutex_);
+    std::vector<Point> curve;
+    for (size_t i = 0; i < capacities_.size(); ++i) {
+      double miss_ratio =
+          accesses_ == 0 ? 0.0 : 1.0 - static_cast<double>(hits_[i]) / accesses_;
+      curve.push_back({capacities_[i], miss_ratio});
+    }
+    return curve;
+  }
+
+  uint64_t GetSampledAccesses() const override {
+    MutexLock l(&mutex_);
+    return accesses_;
+  }
+
+  void ResetCounters() override {
+    MutexLock l(&mutex_);
+    accesses_ = 0;
+    std::fill(hits_.begin(), hits_.end(), 0);
+  }
+
+  std::string ToString() const override {
+    std::string res;
+    char buffer[100];
+    snprintf(buffer, sizeof(buffer), "Sampled accesses: %" PRIu64 "\n",
+             GetSampledAccesses());
+    res.append(buffer);
+    for (const Point& point : GetMissRatioCurve()) {
+      snprintf(buffer, sizeof(buffer),
+               "Capacity: %" ROCKSDB_PRIszt " Miss ratio: %.4f\n",
+               point.capacity, point.miss_ratio);
+      res.append(buffer);
+    }
+    return res;
+  }
+
+ private:
+  static constexpr uint64_t kSamplingModulus = uint64_t{1} << 24;
+
+  void RecordAccess(const Slice& key, size_t charge) {
+    // Sample keys by hash, so that all accesses to a sampled key are seen
+    if ((GetSliceNPHash64(key) >> 40) >= sampling_threshold_) {
+      return;
+    }
+    MutexLock l(&mutex_);
+    uint64_t distance = tracker_.Access(key, charge);
+    ++accesses_;
+    for (size_t i = 0; i < sampled_capacities_.size(); ++i) {
+      if (distance <= sampled_capacities_[i]) {
+        ++hits_[i];
+      }
+    }
+  }
+
+  std::shared_ptr<Cache> cache_;
+  // In increasing order
+  const std::vector<size_t> capacities_;
+  // The capacities scaled down by the sampling rate
+  std::vector<uint64_t> sampled_capacities_;
+  // Keys whose hash, reduced modulo kSamplingModulus, is below this are
+  // sampled
+  const uint64_t sampling_threshold_;
+
+  mutable port::Mutex mutex_;
+  uint64_t accesses_ = 0;
+  std::vector<uint64_t> hits_;
+  StackDistanceTracker tracker_;
+};
+
+}  // namespace
+
+std::shared_ptr<MissRatioCurveCache> NewMissRatioCurveCache(
+    std::shared_ptr<Cache> cache, const MissRatioCurveCacheOptions& options) {
+  if (cache == nullptr || !(options.sampling_rate > 0.0) ||
+      options.sampling_rate > 1.0) {
+    return nullptr;
+  }
+  std::vector<size_t> capacities = options.capacities;
+  if (capacities.empty()) {
+    // 1/8 to 4 times the current capacity
+    size_t c = cache->GetCapacity() / 8;
+    for (int i = 0; i < 6 && c > 0; ++i) {
+      capacities.push_back(c);
+      if (c > std::numeric_limits<size_t>::max() / 2) {
+        break;
+      }
+      c *= 2;
+    }
+    if (capacities.empty()) {
+      return nullptr;
+    }
+  }
+  std::sort(capacities.begin(), capacities.end());
+  capacities.erase(std::unique(capacities.begin(), capacities.end()),
+                   capacities.end());
+  return std::make_shared<MissRatioCurveCacheImpl>(
+      std::move(cache), std::move(capacities), options.sampling_rate);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
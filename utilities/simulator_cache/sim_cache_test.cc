@@ -219,6 +219,153 @@ TEST_F(SimCacheTest, SimCacheLogging) {
   ASSERT_GT(fsize, max_size - 100);
 }
 
+namespace {
+void AccessMissRatioCurveCache(Cache* cache, const std::string& key,
+                               size_t charge) {
+  Cache::Handle* h = cache->Lookup(key);
+  if (h != nullptr) {
+    cache->Release(h);
+  } else {
+    ASSERT_OK(cache->Insert(key, nullptr, charge,
+                            [](const Slice& /*k*/, void* /*v*/) {}));
+  }
+}
+
+std::shared_ptr<Cache> NewMissRatioCurveTestTargetCache(size_t capacity) {
+  LRUCacheOptions co;
+  co.capacity = capacity;
+  co.num_shard_bits = 0;
+  co.metadata_charge_policy = kDontChargeCacheMetadata;
+  return NewLRUCache(co);
+}
+}  // namespace
+
+TEST(MissRatioCurveCacheTest, ExactCurve) {
+  MissRatioCurveCacheOptions mrc_options;
+  mrc_options.capacities = {300, 100, 200};
+  mrc_options.sampling_rate = 1.0;
+  auto cache = NewMissRatioCurveCache(NewMissRatioCurveTestTargetCache(1000),
+                                      mrc_options);
+  ASSERT_NE(cache, nullptr);
+
+  // Each key is accessed again after two others
+  for (int i = 0; i < 2; i++) {
+    for (const char* key : {"a", "b", "c"}) {
+      AccessMissRatioCurveCache(cache.get(), key, 100);
+    }
+  }
+  ASSERT_EQ(6, cache->GetSampledAccesses());
+  auto curve = cache->GetMissRatioCurve();
+  ASSERT_EQ(3, curve.size());
+  ASSERT_EQ(100, curve[0].capacity);
+  ASSERT_EQ(1.0, curve[0].miss_ratio);
+  ASSERT_EQ(200, curve[1].capacity);
+  ASSERT_EQ(1.0, curve[1].miss_ratio);
+  ASSERT_EQ(300, curve[2].capacity);
+  ASSERT_EQ(0.5, curve[2].miss_ratio);
+
+  // Repeated accesses to the most recent key hit in every capacity
+  cache->ResetCounters();
+  AccessMissRatioCurveCache(cache.get(), "c", 100);
+  AccessMissRatioCurveCache(cache.get(), "c", 100);
+  ASSERT_EQ(2, cache->GetSampledAccesses());
+  for (const auto& point : cache->GetMissRatioCurve()) {
+    ASSERT_EQ(0.0, point.miss_ratio);
+  }
+
+  // A larger entry pushes the others out of the smaller caches
+  AccessMissRatioCurveCache(cache.get(), "d", 200);
+  AccessMissRatioCurveCache(cache.get(), "c", 100);
+  curve = cache->GetMissRatioCurve();
+  ASSERT_EQ(0.5, curve[0].miss_ratio);
+  ASSERT_EQ(0.5, curve[1].miss_ratio);
+  ASSERT_EQ(0.25, curve[2].miss_ratio);
+}
+
+TEST(MissRatioCurveCacheTest, SampledCurve) {
+  MissRatioCurveCacheOptions mrc_options;
+  mrc_options.capacities = {1000, 4000};
+  mrc_options.sampling_rate = 0.1;
+  auto cache = NewMissRatioCurveCache(NewMissRatioCurveTestTargetCache(10000),
+                                      mrc_options);
+  ASSERT_NE(cache, nullptr);
+
+  // Loop over 2000 keys: always misses in the smaller cache, and only misses
+  // on the first pass in the larger one.
+  const int kNumKeys = 2000;
+  const int kNumPasses = 5;
+  for (int pass = 0; pass < kNumPasses; pass++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      AccessMissRatioCurveCache(cache.get(), ToString(i), 1);
+    }
+  }
+  uint64_t sampled = cache->GetSampledAccesses();
+  ASSERT_GT(sampled, kNumKeys * kNumPasses / 20);
+  ASSERT_LT(sampled, kNumKeys * kNumPasses / 5);
+  auto curve = cache->GetMissRatioCurve();
+  ASSERT_EQ(2, curve.size());
+  ASSERT_EQ(1.0, curve[0].miss_ratio);
+  ASSERT_NEAR(1.0 / kNumPasses, curve[1].miss_ratio, 1e-9);
+}
+
+TEST(MissRatioCurveCacheTest, Options) {
+  MissRatioCurveCacheOptions mrc_options;
+  mrc_options.sampling_rate = 0.0;
+  ASSERT_EQ(nullptr, NewMissRatioCurveCache(
+                         NewMissRatioCurveTestTargetCache(800), mrc_options));
+  mrc_options.sampling_rate = 1.5;
+  ASSERT_EQ(nullptr, NewMissRatioCurveCache(
+                         NewMissRatioCurveTestTargetCache(800), mrc_options));
+
+  // Default capacities are based on the wrapped cache
+  auto cache = NewMissRatioCurveCache(NewMissRatioCurveTestTargetCache(800));
+  ASSERT_NE(cache, nullptr);
+  auto curve = cache->GetMissRatioCurve();
+  ASSERT_EQ(6, curve.size());
+  ASSERT_EQ(100, curve.front().capacity);
+  ASSERT_EQ(3200, curve.back().capacity);
+}
+
+TEST_F(SimCacheTest, MissRatioCurveProperty) {
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  std::string value;
+  // Not available with other block caches
+  table_options.block_cache = NewMissRatioCurveTestTargetCache(1 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_FALSE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &value));
+
+  MissRatioCurveCacheOptions mrc_options;
+  mrc_options.sampling_rate = 1.0;
+  table_options.block_cache = NewMissRatioCurveCache(
+      NewMissRatioCurveTestTargetCache(1 << 20), mrc_options);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < kNumBlocks * 2; i++) {
+      ASSERT_EQ(std::string(kValueSize, 'a'), Get(ToString(i)));
+    }
+  }
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &value));
+  ASSERT_NE(std::string::npos, value.find("Miss ratio"));
+
+  std::map<std::string, std::string> values;
+  ASSERT_TRUE(
+      db_->GetMapProperty(DB::Properties::kBlockCacheMissRatioCurve, &values));
+  ASSERT_LT(0, std::stoi(values["sampled-accesses"]));
+  // All the blocks fit in the largest simulated cache, so the second pass
+  // hits there.
+  std::string largest = "miss-ratio." + ToString((1 << 20) * 4);
+  ASSERT_EQ(1, values.count(largest));
+  ASSERT_GT(1.0, std::stod(values[largest]));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
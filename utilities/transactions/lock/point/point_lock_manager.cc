@@ -30,6 +30,7 @@ struct LockInfo {
   // Transaction locks are not valid after this time in us
   uint64_t expiration_time;
 
+  LockInfo() : exclusive(false), expiration_time(0) {}
   LockInfo(TransactionID id, uint64_t time, bool ex)
       : exclusive(ex), expiration_time(time) {
     txn_ids.push_back(id);
@@ -45,12 +46,189 @@ struct LockInfo {
   }
 };
 
+// The locked keys of a stripe for PointLockTable::kOpenAddressing: a linear
+// probing table of indexes into a pool of entries. Entries are reused with
+// their key buffer and condition variable, and never move, so that waiters
+// can hold on to them while the table is reorganized.
+class LockTable {
+ public:
+  struct Entry {
+    std::string key;
+    uint64_t hash = 0;
+    // No transaction holds the lock while txn_ids is empty; the entry is
+    // then only kept for its waiters.
+    LockInfo info;
+    // Transactions waiting on cv for the key
+    int num_waiters = 0;
+    std::shared_ptr<TransactionDBCondVar> cv;
+  };
+
+  LockTable(size_t num_entries,
+            std::shared_ptr<TransactionDBMutexFactory> factory)
+      : factory_(std::move(factory)) {
+    size_t num_slots = 4;
+    while (num_slots < 2 * num_entries) {
+      num_slots *= 2;
+    }
+    slots_.assign(num_slots, kEmptySlot);
+    for (size_t i = 0; i < num_entries; i++) {
+      free_.push_back(NewEntry());
+    }
+  }
+
+  Entry* Find(const std::string& key) const {
+    const uint64_t hash = GetSliceNPHash64(key);
+    for (size_t i = Home(hash);; i = Next(i)) {
+      if (slots_[i] == kEmptySlot) {
+        return nullptr;
+      }
+      Entry* entry = entries_[slots_[i]].get();
+      if (entry->hash == hash && entry->key == key) {
+        return entry;
+      }
+    }
+  }
+
+  // REQUIRES: key is not in the table
+  Entry* Insert(const std::string& key) {
+    if (2 * (size_ + 1) > slots_.size()) {
+      Grow();
+    }
+    if (free_.empty()) {
+      free_.push_back(NewEntry());
+    }
+    const uint32_t index = free_.back();
+    free_.pop_back();
+    Entry* entry = entries_[index].get();
+    entry->key.assign(key);
+    entry->hash = GetSliceNPHash64(key);
+    assert(entry->num_waiters == 0);
+    size_t i = Home(entry->hash);
+    while (slots_[i] != kEmptySlot) {
+      i = Next(i);
+    }
+    slots_[i] = index;
+    size_++;
+    return entry;
+  }
+
+  // REQUIRES: entry has neither holders nor waiters
+  void Erase(Entry* entry) {
+    assert(entry->info.txn_ids.empty() && entry->num_waiters == 0);
+    size_t i = Home(entry->hash);
+    while (entries_[slots_[i]].get() != entry) {
+      i = Next(i);
+    }
+    free_.push_back(slots_[i]);
+    slots_[i] = kEmptySlot;
+    size_--;
+    // Moves back the entries that probed past the freed slot
+    for (size_t j = Next(i); slots_[j] != kEmptySlot; j = Next(j)) {
+      const size_t home = Home(entries_[slots_[j]]->hash);
+      const bool reachable = i <= j ? (home <= i || home > j)
+                                    : (home <= i && home > j);
+      if (reachable) {
+        slots_[i] = slots_[j];
+        slots_[j] = kEmptySlot;
+        i = j;
+      }
+    }
+  }
+
+  template <typename F>
+  void ForEach(F&& f) const {
+    for (uint32_t index : slots_) {
+      if (index != kEmptySlot) {
+        f(*entries_[index]);
+      }
+    }
+  }
+
+ private:
+  static constexpr uint32_t kEmptySlot = port::kMaxUint32;
+
+  size_t Home(uint64_t hash) const {
+    return static_cast<size_t>(hash) & (slots_.size() - 1);
+  }
+  size_t Next(size_t i) const { return (i + 1) & (slots_.size() - 1); }
+
+  uint32_t NewEntry() {
+    entries_.emplace_back(new Entry());
+    entries_.back()->cv = factory_->AllocateCondVar();
+    assert(entries_.back()->cv);
+    return static_cast<uint32_t>(entries_.size() - 1);
+  }
+
+  void Grow() {
+    std::vector<uint32_t> old_slots(slots_.size() * 2, kEmptySlot);
+    old_slots.swap(slots_);
+    for (uint32_t index : old_slots) {
+      if (index != kEmptySlot) {
+        size_t i = Home(entries_[index]->hash);
+        while (slots_[i] != kEmptySlot) {
+          i = Next(i);
+        }
+        slots_[i] = index;
+      }
+    }
+  }
+
+  std::shared_ptr<TransactionDBMutexFactory> factory_;
+  // Indexes into entries_, a power of two of them
+  std::vector<uint32_t> slots_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  // Indexes of the entries not in use
+  std::vector<uint32_t> free_;
+  size_t size_ = 0;
+};
+
 struct LockMapStripe {
-  explicit LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory) {
+  LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory,
+                PointLockTable table_type, size_t num_entries) {
     stripe_mutex = factory->AllocateMutex();
     stripe_cv = factory->AllocateCondVar();
     assert(stripe_mutex);
     assert(stripe_cv);
+    if (table_type == PointLockTable::kOpenAddressing) {
+      table.reset(new LockTable(num_entries, factory));
+    }
+  }
+
+  // Returns the condition variable to wait on for `key` to be unlocked.
+  // REQUIRED: Stripe mutex must be held.
+  TransactionDBCondVar* BeginWait(const std::string& key) {
+    if (table != nullptr) {
+      LockTable::Entry* entry = table->Find(key);
+      if (entry != nullptr && !entry->info.txn_ids.empty()) {
+        entry->num_waiters++;
+        return entry->cv.get();
+      }
+      // Waiting for the lock limit
+      num_stripe_waiters++;
+    }
+    return stripe_cv.get();
+  }
+
+  // REQUIRED: Stripe mutex must be held.
+  void EndWait(const std::string& key, TransactionDBCondVar* cv) {
+    if (table == nullptr) {
+      return;
+    }
+    if (cv == stripe_cv.get()) {
+      num_stripe_waiters--;
+      return;
+    }
+    LockTable::Entry* entry = table->Find(key);
+    assert(entry != nullptr && entry->cv.get() == cv);
+    if (--entry->num_waiters == 0 && entry->info.txn_ids.empty()) {
+      table->Erase(entry);
+    }
+  }
+
+  // Whether an unlock has to wake up the waiters on stripe_cv.
+  // REQUIRED: Stripe mutex must be held.
+  bool NeedsStripeNotify() const {
+    return table == nullptr || num_stripe_waiters > 0;
   }
 
   // Mutex must be held before modifying keys map
@@ -59,19 +237,26 @@ struct LockMapStripe {
   // Condition Variable per stripe for waiting on a lock
   std::shared_ptr<TransactionDBCondVar> stripe_cv;
 
-  // Locked keys mapped to the info about the transactions that locked them.
-  // TODO(agiardullo): Explore performance of other data structures.
+  // With PointLockTable::kHashMap, the locked keys mapped to the info about
+  // the transactions that locked them.
   std::unordered_map<std::string, LockInfo> keys;
+
+  // With PointLockTable::kOpenAddressing, the locked keys, and the
+  // transactions waiting on stripe_cv
+  std::unique_ptr<LockTable> table;
+  int num_stripe_waiters = 0;
 };
 
 // Map of #num_stripes LockMapStripes
 struct LockMap {
-  explicit LockMap(size_t num_stripes,
-                   std::shared_ptr<TransactionDBMutexFactory> factory)
+  LockMap(size_t num_stripes,
+          std::shared_ptr<TransactionDBMutexFactory> factory,
+          PointLockTable table_type, size_t num_entries_per_stripe)
       : num_stripes_(num_stripes) {
     lock_map_stripes_.reserve(num_stripes);
     for (size_t i = 0; i < num_stripes; i++) {
-      LockMapStripe* stripe = new LockMapStripe(factory);
+      LockMapStripe* stripe =
+          new LockMapStripe(factory, table_type, num_entries_per_stripe);
       lock_map_stripes_.push_back(stripe);
     }
   }
@@ -108,6 +293,8 @@ PointLockManager::PointLockManager(PessimisticTransactionDB* txn_db,
     : txn_db_impl_(txn_db),
       default_num_stripes_(opt.num_stripes),
       max_num_locks_(opt.max_num_locks),
+      point_lock_table_(opt.point_lock_table),
+      point_lock_entries_per_stripe_(opt.point_lock_entries_per_stripe),
       lock_maps_cache_(new ThreadLocalPtr(&UnrefLockMapsCache)),
       dlock_buffer_(opt.max_num_deadlocks),
       mutex_factory_(opt.custom_mutex_factory
@@ -125,8 +312,10 @@ void PointLockManager::AddColumnFamily(const ColumnFamilyHandle* cf) {
   InstrumentedMutexLock l(&lock_map_mutex_);
 
   if (lock_maps_.find(cf->GetID()) == lock_maps_.end()) {
-    lock_maps_.emplace(cf->GetID(), std::make_shared<LockMap>(
-                                        default_num_stripes_, mutex_factory_));
+    lock_maps_.emplace(cf->GetID(),
+                       std::make_shared<LockMap>(
+                           default_num_stripes_, mutex_factory_,
+                           point_lock_table_, point_lock_entries_per_stripe_));
   } else {
     // column_family already exists in lock map
     assert(false);
@@ -288,6 +477,13 @@ Status PointLockManager::AcquireWithTimeout(
     // If we weren't able to acquire the lock, we will keep retrying as long
     // as the timeout allows.
     bool timed_out = false;
+    // With a detection delay, the wait-for graph is only updated once the
+    // lock wait has lasted until detect_time
+    uint64_t detect_time = 0;
+    if (txn->IsDeadlockDetect() && txn->GetDeadlockDetectDelayMicros() > 0) {
+      detect_time = env->NowMicros() +
+                    static_cast<uint64_t>(txn->GetDeadlockDetectDelayMicros());
+    }
     do {
       // Decide how long to wait
       int64_t cv_end_time = -1;
@@ -303,38 +499,49 @@ Status PointLockManager::AcquireWithTimeout(
 
       // We are dependent on a transaction to finish, so perform deadlock
       // detection.
+      bool detect = false;
+      bool wait_until_detect = false;
       if (wait_ids.size() != 0) {
         if (txn->IsDeadlockDetect()) {
-          if (IncrementWaiters(txn, wait_ids, key, column_family_id,
-                               lock_info.exclusive, env)) {
-            result = Status::Busy(Status::SubCode::kDeadlock);
-            stripe->stripe_mutex->UnLock();
-            return result;
+          detect = detect_time == 0 || env->NowMicros() >= detect_time;
+          if (detect) {
+            if (IncrementWaiters(txn, wait_ids, key, column_family_id,
+                                 lock_info.exclusive, env)) {
+              result = Status::Busy(Status::SubCode::kDeadlock);
+              stripe->stripe_mutex->UnLock();
+              return result;
+            }
+          } else if (cv_end_time < 0 ||
+                     static_cast<uint64_t>(cv_end_time) > detect_time) {
+            // Wake up at detect_time to run the detection
+            cv_end_time = static_cast<int64_t>(detect_time);
+            wait_until_detect = true;
           }
         }
         txn->SetWaitingTxn(wait_ids, column_family_id, &key);
       }
 
       TEST_SYNC_POINT("PointLockManager::AcquireWithTimeout:WaitingTxn");
+      TransactionDBCondVar* cv = stripe->BeginWait(key);
       if (cv_end_time < 0) {
         // Wait indefinitely
-        result = stripe->stripe_cv->Wait(stripe->stripe_mutex);
+        result = cv->Wait(stripe->stripe_mutex);
       } else {
         uint64_t now = env->NowMicros();
         if (static_cast<uint64_t>(cv_end_time) > now) {
-          result = stripe->stripe_cv->WaitFor(stripe->stripe_mutex,
-                                              cv_end_time - now);
+          result = cv->WaitFor(stripe->stripe_mutex, cv_end_time - now);
         }
       }
+      stripe->EndWait(key, cv);
 
       if (wait_ids.size() != 0) {
         txn->ClearWaitingTxn();
-        if (txn->IsDeadlockDetect()) {
+        if (detect) {
           DecrementWaiters(txn, wait_ids);
         }
       }
 
-      if (result.IsTimedOut()) {
+      if (result.IsTimedOut() && !wait_until_detect) {
           timed_out = true;
           // Even though we timed out, we will still make one more attempt to
           // acquire lock below (it is possible the lock expired and we
@@ -481,10 +688,22 @@ Status PointLockManager::AcquireLocked(LockMap* lock_map, LockMapStripe* stripe,
 
   Status result;
   // Check if this key is already locked
-  auto stripe_iter = stripe->keys.find(key);
-  if (stripe_iter != stripe->keys.end()) {
+  LockInfo* held = nullptr;
+  LockTable::Entry* entry = nullptr;
+  if (stripe->table != nullptr) {
+    entry = stripe->table->Find(key);
+    if (entry != nullptr && !entry->info.txn_ids.empty()) {
+      held = &entry->info;
+    }
+  } else {
+    auto stripe_iter = stripe->keys.find(key);
+    if (stripe_iter != stripe->keys.end()) {
+      held = &stripe_iter->second;
+    }
+  }
+  if (held != nullptr) {
     // Lock already held
-    LockInfo& lock_info = stripe_iter->second;
+    LockInfo& lock_info = *held;
     assert(lock_info.txn_ids.size() == 1 || !lock_info.exclusive);
 
     if (lock_info.exclusive || txn_lock_info.exclusive) {
@@ -526,7 +745,14 @@ Status PointLockManager::AcquireLocked(LockMap* lock_map, LockMapStripe* stripe,
       result = Status::Busy(Status::SubCode::kLockLimit);
     } else {
       // acquire lock
-      stripe->keys.emplace(key, std::move(txn_lock_info));
+      if (stripe->table != nullptr) {
+        if (entry == nullptr) {
+          entry = stripe->table->Insert(key);
+        }
+        entry->info = txn_lock_info;
+      } else {
+        stripe->keys.emplace(key, std::move(txn_lock_info));
+      }
 
       // Maintain lock count if there is a limit on the number of locks
       if (max_num_locks_) {
@@ -546,14 +772,35 @@ void PointLockManager::UnLockKey(PessimisticTransaction* txn,
 #endif
   TransactionID txn_id = txn->GetID();
 
-  auto stripe_iter = stripe->keys.find(key);
-  if (stripe_iter != stripe->keys.end()) {
-    auto& txns = stripe_iter->second.txn_ids;
+  LockInfo* held = nullptr;
+  LockTable::Entry* entry = nullptr;
+  std::unordered_map<std::string, LockInfo>::iterator stripe_iter;
+  if (stripe->table != nullptr) {
+    entry = stripe->table->Find(key);
+    if (entry != nullptr && !entry->info.txn_ids.empty()) {
+      held = &entry->info;
+    }
+  } else {
+    stripe_iter = stripe->keys.find(key);
+    if (stripe_iter != stripe->keys.end()) {
+      held = &stripe_iter->second;
+    }
+  }
+  if (held != nullptr) {
+    auto& txns = held->txn_ids;
     auto txn_it = std::find(txns.begin(), txns.end(), txn_id);
     // Found the key we locked.  unlock it.
     if (txn_it != txns.end()) {
       if (txns.size() == 1) {
-        stripe->keys.erase(stripe_iter);
+        if (entry == nullptr) {
+          stripe->keys.erase(stripe_iter);
+        } else if (entry->num_waiters > 0) {
+          txns.clear();
+        } else {
+          txns.clear();
+          stripe->table->Erase(entry);
+          entry = nullptr;
+        }
       } else {
         auto last_it = txns.end() - 1;
         if (txn_it != last_it) {
@@ -567,6 +814,11 @@ void PointLockManager::UnLockKey(PessimisticTransaction* txn,
         assert(lock_map->lock_cnt.load(std::memory_order_relaxed) > 0);
         lock_map->lock_cnt--;
       }
+
+      // Signal the transactions waiting for this key to retry locking
+      if (entry != nullptr && entry->num_waiters > 0) {
+        entry->cv->NotifyAll();
+      }
     }
   } else {
     // This key is either not locked or locked by someone else.  This should
@@ -593,10 +845,13 @@ void PointLockManager::UnLock(PessimisticTransaction* txn,
 
   stripe->stripe_mutex->Lock().PermitUncheckedError();
   UnLockKey(txn, key, stripe, lock_map, env);
+  const bool notify = stripe->NeedsStripeNotify();
   stripe->stripe_mutex->UnLock();
 
   // Signal waiting threads to retry locking
-  stripe->stripe_cv->NotifyAll();
+  if (notify) {
+    stripe->stripe_cv->NotifyAll();
+  }
 }
 
 void PointLockManager::UnLock(PessimisticTransaction* txn,
@@ -638,11 +893,14 @@ void PointLockManager::UnLock(PessimisticTransaction* txn,
       for (const std::string* key : stripe_keys) {
         UnLockKey(txn, *key, stripe, lock_map, env);
       }
+      const bool notify = stripe->NeedsStripeNotify();
 
       stripe->stripe_mutex->UnLock();
 
       // Signal waiting threads to retry locking
-      stripe->stripe_cv->NotifyAll();
+      if (notify) {
+        stripe->stripe_cv->NotifyAll();
+      }
     }
   }
 }
@@ -665,14 +923,25 @@ PointLockManager::PointLockStatus PointLockManager::GetPointLockStatus() {
     // Iterate and lock all stripes in ascending order.
     for (const auto& j : stripes) {
       j->stripe_mutex->Lock().PermitUncheckedError();
-      for (const auto& it : j->keys) {
+      auto add = [&](const std::string& key, const LockInfo& lock_info) {
         struct KeyLockInfo info;
-        info.exclusive = it.second.exclusive;
-        info.key = it.first;
-        for (const auto& id : it.second.txn_ids) {
+        info.exclusive = lock_info.exclusive;
+        info.key = key;
+        for (const auto& id : lock_info.txn_ids) {
           info.ids.push_back(id);
         }
         data.insert({i, info});
+      };
+      if (j->table != nullptr) {
+        j->table->ForEach([&](const LockTable::Entry& entry) {
+          if (!entry.info.txn_ids.empty()) {
+            add(entry.key, entry.info);
+          }
+        });
+      } else {
+        for (const auto& it : j->keys) {
+          add(it.first, it.second);
+        }
       }
     }
   }
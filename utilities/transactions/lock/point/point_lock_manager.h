@@ -162,6 +162,10 @@ class PointLockManager : public LockManager {
   // Limit on number of keys locked per column family
   const int64_t max_num_locks_;
 
+  // The table of locked keys of every stripe
+  const PointLockTable point_lock_table_;
+  const size_t point_lock_entries_per_stripe_;
+
   // The following lock order must be satisfied in order to avoid deadlocking
   // ourselves.
   //   - lock_map_mutex_
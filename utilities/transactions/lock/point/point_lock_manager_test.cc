@@ -158,8 +158,61 @@ TEST_F(PointLockManagerTest, DeadlockDepthExceeded) {
   delete txn1;
 }
 
+TEST_F(PointLockManagerTest, OpenAddressingLockTable) {
+  txn_opt_.num_stripes = 1;
+  txn_opt_.point_lock_table = PointLockTable::kOpenAddressing;
+  // Makes the table grow
+  txn_opt_.point_lock_entries_per_stripe = 1;
+  locker_.reset(new PointLockManager(
+      static_cast<PessimisticTransactionDB*>(db_), txn_opt_));
+  MockColumnFamilyHandle cf(1);
+  locker_->AddColumnFamily(&cf);
+
+  const int kNumKeys = 1000;
+  auto txn1 = NewTxn();
+  auto txn2 = NewTxn();
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(locker_->TryLock(txn1, 1, ToString(i), env_, true));
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumKeys),
+            locker_->GetPointLockStatus().size());
+
+  // Erases every other key from the table
+  for (int i = 0; i < kNumKeys; i += 2) {
+    locker_->UnLock(txn1, 1, ToString(i), env_);
+  }
+  auto status = locker_->GetPointLockStatus();
+  ASSERT_EQ(static_cast<size_t>(kNumKeys / 2), status.size());
+  for (const auto& it : status) {
+    ASSERT_EQ(1, std::stoi(it.second.key) % 2);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    Status s = locker_->TryLock(txn2, 1, ToString(i), env_, true);
+    if (i % 2 == 0) {
+      ASSERT_OK(s);
+    } else {
+      ASSERT_TRUE(s.IsTimedOut());
+    }
+  }
+
+  for (int i = 0; i < kNumKeys; i++) {
+    locker_->UnLock(i % 2 == 0 ? txn2 : txn1, 1, ToString(i), env_);
+  }
+  ASSERT_EQ(0u, locker_->GetPointLockStatus().size());
+
+  delete txn2;
+  delete txn1;
+}
+
+void OpenAddressingLockTableSetup(PointLockManagerTest* self) {
+  self->txn_opt_.point_lock_table = PointLockTable::kOpenAddressing;
+  self->txn_opt_.point_lock_entries_per_stripe = 2;
+  self->PointLockManagerTest::SetUp();
+}
+
 INSTANTIATE_TEST_CASE_P(PointLockManager, AnyLockManagerTest,
-                        ::testing::Values(nullptr));
+                        ::testing::Values(nullptr,
+                                          OpenAddressingLockTableSetup));
 
 }  // namespace ROCKSDB_NAMESPACE
 
@@ -43,15 +43,14 @@ class PointLockManagerTest : public testing::Test {
 
     Options opt;
     opt.create_if_missing = true;
-    TransactionDBOptions txn_opt;
-    txn_opt.transaction_lock_timeout = 0;
+    txn_opt_.transaction_lock_timeout = 0;
 
-    ASSERT_OK(TransactionDB::Open(opt, txn_opt, db_dir_, &db_));
+    ASSERT_OK(TransactionDB::Open(opt, txn_opt_, db_dir_, &db_));
 
     // CAUTION: This test creates a separate lock manager object (right, NOT
     // the one that the TransactionDB is using!), and runs tests on it.
     locker_.reset(new PointLockManager(
-        static_cast<PessimisticTransactionDB*>(db_), txn_opt));
+        static_cast<PessimisticTransactionDB*>(db_), txn_opt_));
 
     wait_sync_point_name_ = "PointLockManager::AcquireWithTimeout:WaitingTxn";
   }
@@ -71,11 +70,13 @@ class PointLockManagerTest : public testing::Test {
   Env* env_;
   std::shared_ptr<LockManager> locker_;
   const char* wait_sync_point_name_;
+  TransactionDBOptions txn_opt_;
+  TransactionDB* db_;
   friend void PointLockManagerTestExternalSetup(PointLockManagerTest*);
+  friend void OpenAddressingLockTableSetup(PointLockManagerTest*);
 
  private:
   std::string db_dir_;
-  TransactionDB* db_;
 };
 
 typedef void (*init_func_t)(PointLockManagerTest*);
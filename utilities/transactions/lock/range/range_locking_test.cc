@@ -288,6 +288,162 @@ TEST_F(RangeLockingTest, BasicLockEscalation) {
 }
 #endif
 
+class ShardedRangeLockingTest : public ::testing::Test {
+ public:
+  TransactionDB* db;
+  std::string dbname;
+  Options options;
+
+  std::shared_ptr<RangeLockManagerHandle> range_lock_mgr;
+  TransactionDBOptions txn_db_options;
+  TransactionOptions txn_options;
+
+  ShardedRangeLockingTest() : db(nullptr) {
+    options.create_if_missing = true;
+    dbname = test::PerThreadDBPath("sharded_range_locking_testdb");
+
+    DestroyDB(dbname, options);
+
+    // Ranges within a two-byte prefix are narrow
+    range_lock_mgr.reset(NewShardedRangeLockManager(nullptr, 4, 2));
+    txn_db_options.lock_mgr_handle = range_lock_mgr;
+    txn_options.lock_timeout = 10;
+
+    auto s = TransactionDB::Open(options, txn_db_options, dbname, &db);
+    assert(s.ok());
+  }
+
+  ~ShardedRangeLockingTest() {
+    delete db;
+    db = nullptr;
+    DestroyDB(dbname, options);
+  }
+
+  Transaction* NewTxn() {
+    return db->BeginTransaction(WriteOptions(), txn_options);
+  }
+};
+
+TEST_F(ShardedRangeLockingTest, BasicRangeLocking) {
+  std::string value;
+  auto cf = db->DefaultColumnFamily();
+
+  std::unique_ptr<Transaction> txn0(NewTxn());
+  std::unique_ptr<Transaction> txn1(NewTxn());
+
+  ASSERT_OK(txn0->GetRangeLock(cf, Endpoint("a"), Endpoint("c")));
+  ASSERT_TRUE(
+      txn1->GetRangeLock(cf, Endpoint("b"), Endpoint("z")).IsTimedOut());
+  ASSERT_TRUE(
+      txn1->GetForUpdate(ReadOptions(), cf, Slice("b"), &value).IsTimedOut());
+  // A transaction does not conflict with itself
+  ASSERT_OK(txn0->GetRangeLock(cf, Endpoint("b"), Endpoint("d")));
+  ASSERT_OK(txn1->GetRangeLock(cf, Endpoint("e"), Endpoint("z")));
+
+  ASSERT_OK(txn0->Put(cf, Slice("dd"), Slice("value")));
+  ASSERT_TRUE(
+      txn1->GetRangeLock(cf, Endpoint("d"), Endpoint("d", true)).IsTimedOut());
+
+  // An endpoint with inf_suffix covers all the keys it is a prefix of
+  ASSERT_OK(txn1->GetRangeLock(cf, Endpoint("f"), Endpoint("f", true)));
+  ASSERT_TRUE(txn0->Put(cf, Slice("ffff"), Slice("value")).IsTimedOut());
+
+  ASSERT_OK(txn0->Commit());
+  ASSERT_OK(txn1->GetRangeLock(cf, Endpoint("a"), Endpoint("d")));
+  ASSERT_OK(txn1->Rollback());
+}
+
+TEST_F(ShardedRangeLockingTest, WideAndNarrowRanges) {
+  auto cf = db->DefaultColumnFamily();
+
+  std::unique_ptr<Transaction> txn0(NewTxn());
+  std::unique_ptr<Transaction> txn1(NewTxn());
+
+  // Narrow ranges under different prefixes
+  ASSERT_OK(txn0->GetRangeLock(cf, Endpoint("aa1"), Endpoint("aa5")));
+  ASSERT_OK(txn1->GetRangeLock(cf, Endpoint("ab1"), Endpoint("ab5")));
+  ASSERT_TRUE(txn1->Put(cf, Slice("aa3"), Slice("value")).IsTimedOut());
+
+  // A wide range is checked against all narrow ones, and the other way
+  // around
+  ASSERT_TRUE(
+      txn1->GetRangeLock(cf, Endpoint("a"), Endpoint("b")).IsTimedOut());
+  ASSERT_OK(txn0->GetRangeLock(cf, Endpoint("b"), Endpoint("c")));
+  ASSERT_TRUE(txn1->Put(cf, Slice("bb"), Slice("value")).IsTimedOut());
+  ASSERT_OK(txn1->Put(cf, Slice("cd"), Slice("value")));
+
+  ASSERT_OK(txn0->Commit());
+  ASSERT_OK(txn1->GetRangeLock(cf, Endpoint("a"), Endpoint("b")));
+  ASSERT_OK(txn1->Put(cf, Slice("bb"), Slice("value")));
+  ASSERT_OK(txn1->Commit());
+}
+
+TEST_F(ShardedRangeLockingTest, WaitForRelease) {
+  auto cf = db->DefaultColumnFamily();
+
+  std::unique_ptr<Transaction> txn0(NewTxn());
+  ASSERT_OK(txn0->GetRangeLock(cf, Endpoint("aa1"), Endpoint("aa5")));
+
+  txn_options.lock_timeout = 60 * 1000;
+  std::unique_ptr<Transaction> txn1(NewTxn());
+  std::atomic<bool> locked(false);
+  port::Thread waiter([&]() {
+    ASSERT_OK(txn1->Put(cf, Slice("aa3"), Slice("value")));
+    locked = true;
+  });
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  ASSERT_FALSE(locked);
+  ASSERT_OK(txn0->Commit());
+  waiter.join();
+  ASSERT_TRUE(locked);
+  ASSERT_OK(txn1->Commit());
+}
+
+TEST_F(ShardedRangeLockingTest, LockStatusAndMemory) {
+  auto cf = db->DefaultColumnFamily();
+
+  ASSERT_EQ(range_lock_mgr->GetStatus().current_lock_memory, 0);
+
+  std::unique_ptr<Transaction> txn0(NewTxn());
+  std::unique_ptr<Transaction> txn1(NewTxn());
+  ASSERT_OK(txn0->GetRangeLock(cf, Endpoint("zz"), Endpoint("zz")));
+  ASSERT_OK(txn1->GetRangeLock(cf, Endpoint("b"), Endpoint("e", true)));
+
+  auto s = range_lock_mgr->GetRangeLockStatusData();
+  ASSERT_EQ(s.size(), 2);
+  for (auto it = s.begin(); it != s.end(); ++it) {
+    ASSERT_EQ(it->first, cf->GetID());
+    auto val = it->second;
+    ASSERT_FALSE(val.start.inf_suffix);
+    ASSERT_TRUE(val.exclusive);
+    ASSERT_EQ(val.ids.size(), 1);
+    if (val.ids[0] == txn0->GetID()) {
+      ASSERT_EQ(val.start.slice, "zz");
+      ASSERT_EQ(val.end.slice, "zz");
+      ASSERT_FALSE(val.end.inf_suffix);
+    } else if (val.ids[0] == txn1->GetID()) {
+      ASSERT_EQ(val.start.slice, "b");
+      ASSERT_EQ(val.end.slice, "e");
+      ASSERT_TRUE(val.end.inf_suffix);
+    } else {
+      FAIL();  // Unknown transaction ID.
+    }
+  }
+
+  // The limit on lock memory cannot go below what is in use
+  size_t used = range_lock_mgr->GetStatus().current_lock_memory;
+  ASSERT_GT(used, 0);
+  ASSERT_EQ(EDOM, range_lock_mgr->SetMaxLockMemory(used - 1));
+  ASSERT_EQ(0, range_lock_mgr->SetMaxLockMemory(used));
+  ASSERT_TRUE(txn0->Put(cf, Slice("k"), Slice("value")).IsBusy());
+  ASSERT_EQ(0, range_lock_mgr->SetMaxLockMemory(0));
+
+  ASSERT_OK(txn0->Commit());
+  ASSERT_OK(txn1->Commit());
+  ASSERT_EQ(range_lock_mgr->GetStatus().current_lock_memory, 0);
+  ASSERT_EQ(range_lock_mgr->GetRangeLockStatusData().size(), 0);
+}
+
 void PointLockManagerTestExternalSetup(PointLockManagerTest* self) {
   self->env_ = Env::Default();
   self->db_dir_ = test::PerThreadDBPath("point_lock_manager_test");
@@ -0,0 +1,462 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "utilities/transactions/lock/range/sharded/sharded_range_lock_manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+
+#include "rocksdb/comparator.h"
+#include "util/autovector.h"
+#include "util/hash.h"
+#include "utilities/transactions/transaction_db_mutex_impl.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+RangeLockManagerHandle* NewShardedRangeLockManager(
+    std::shared_ptr<TransactionDBMutexFactory> mutex_factory,
+    size_t num_shards, size_t prefix_length) {
+  std::shared_ptr<TransactionDBMutexFactory> use_factory;
+
+  if (mutex_factory) {
+    use_factory = mutex_factory;
+  } else {
+    use_factory.reset(new TransactionDBMutexFactoryImpl());
+  }
+  return new ShardedRangeLockManager(use_factory, num_shards, prefix_length);
+}
+
+void ShardedRangeLockTracker::Track(const PointLockRequest& lock_req) {
+  ranges_.push_back({lock_req.column_family_id,
+                     {lock_req.key, false},
+                     {lock_req.key, false}});
+}
+
+void ShardedRangeLockTracker::Track(const RangeLockRequest& lock_req) {
+  ranges_.push_back({lock_req.column_family_id,
+                     {lock_req.start_endp.slice.ToString(),
+                      lock_req.start_endp.inf_suffix},
+                     {lock_req.end_endp.slice.ToString(),
+                      lock_req.end_endp.inf_suffix}});
+}
+
+PointLockStatus ShardedRangeLockTracker::GetPointLockStatus(
+    ColumnFamilyId /*cf_id*/, const std::string& /*key*/) const {
+  // This function is not expected to be called as RangeLocking doesn't
+  // allow to use this tracker with point locks.
+  PointLockStatus p;
+  return p;
+}
+
+namespace {
+
+// Orders endpoints the way RangeTreeLockManager::CompareDbtEndpoints does:
+// an endpoint with inf_suffix comes after all the keys it is a prefix of.
+int CompareEndpoints(const Comparator* cmp, const Slice& a, bool a_inf,
+                     const Slice& b, bool b_inf) {
+  const size_t min_len = std::min(a.size(), b.size());
+  int res = cmp->Compare(Slice(a.data(), min_len), Slice(b.data(), min_len));
+  if (res != 0) {
+    return res;
+  }
+  if (a.size() < b.size()) {
+    return a_inf ? 1 : -1;
+  }
+  if (a.size() > b.size()) {
+    return b_inf ? -1 : 1;
+  }
+  return a_inf == b_inf ? 0 : (a_inf ? 1 : -1);
+}
+
+}  // namespace
+
+struct ShardedRangeLockManager::LockedRange {
+  std::string start;
+  std::string end;
+  bool start_inf;
+  bool end_inf;
+  bool exclusive;
+  PessimisticTransaction* txn;
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(LockedRange) + start.size() + end.size();
+  }
+};
+
+struct ShardedRangeLockManager::Shard {
+  explicit Shard(TransactionDBMutexFactory* factory)
+      : mutex(factory->AllocateMutex()),
+        cv(factory->AllocateCondVar()),
+        num_locks(0),
+        epoch(0) {}
+
+  std::shared_ptr<TransactionDBMutex> mutex;
+  std::shared_ptr<TransactionDBCondVar> cv;
+  // The first num_locks entries are the locks held. The ones after them
+  // were released and are kept for reuse.
+  std::vector<LockedRange> locks;
+  size_t num_locks;
+  // Bumped on every release, so that a transaction about to wait can tell
+  // whether a lock went away since it found the conflict
+  uint64_t epoch;
+};
+
+struct ShardedRangeLockManager::ColumnFamilyLocks {
+  ColumnFamilyLocks(const Comparator* comparator, size_t num_shards,
+                    TransactionDBMutexFactory* factory)
+      : cmp(comparator), num_wide_locks(0) {
+    for (size_t i = 0; i < num_shards; i++) {
+      shards.emplace_back(new Shard(factory));
+    }
+  }
+
+  const Comparator* cmp;
+  std::vector<std::unique_ptr<Shard>> shards;
+  // The number of locks in shards[0]. Changes with all shards locked when it
+  // goes up, so that it can be read with any narrow shard locked.
+  std::atomic<size_t> num_wide_locks;
+};
+
+ShardedRangeLockManager::ShardedRangeLockManager(
+    std::shared_ptr<TransactionDBMutexFactory> mutex_factory,
+    size_t num_shards, size_t prefix_length)
+    : mutex_factory_(mutex_factory),
+      num_shards_(std::max<size_t>(num_shards, 1)),
+      prefix_length_(prefix_length),
+      max_lock_memory_(0),
+      lock_memory_(0) {}
+
+ShardedRangeLockManager::~ShardedRangeLockManager() {}
+
+void ShardedRangeLockManager::AddColumnFamily(const ColumnFamilyHandle* cfh) {
+  std::shared_ptr<ColumnFamilyLocks> cf_locks(new ColumnFamilyLocks(
+      cfh->GetComparator(), num_shards_ + 1, mutex_factory_.get()));
+  WriteLock l(&cf_map_mutex_);
+  cf_map_.emplace(cfh->GetID(), cf_locks);
+}
+
+void ShardedRangeLockManager::RemoveColumnFamily(
+    const ColumnFamilyHandle* cfh) {
+  WriteLock l(&cf_map_mutex_);
+  cf_map_.erase(cfh->GetID());
+}
+
+std::shared_ptr<ShardedRangeLockManager::ColumnFamilyLocks>
+ShardedRangeLockManager::GetColumnFamilyLocks(ColumnFamilyId column_family_id) {
+  ReadLock l(&cf_map_mutex_);
+  auto it = cf_map_.find(column_family_id);
+  if (it == cf_map_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+size_t ShardedRangeLockManager::ShardOf(const Slice& start,
+                                        const Slice& end) const {
+  if (start.size() < prefix_length_ || end.size() < prefix_length_ ||
+      memcmp(start.data(), end.data(), prefix_length_) != 0) {
+    return 0;
+  }
+  return 1 + GetSliceHash(Slice(start.data(), prefix_length_)) % num_shards_;
+}
+
+Status ShardedRangeLockManager::TryLock(PessimisticTransaction* txn,
+                                        ColumnFamilyId column_family_id,
+                                        const Endpoint& start_endp,
+                                        const Endpoint& end_endp, Env* env,
+                                        bool exclusive) {
+  std::shared_ptr<ColumnFamilyLocks> cf_locks =
+      GetColumnFamilyLocks(column_family_id);
+  if (cf_locks == nullptr) {
+    char msg[255];
+    snprintf(msg, sizeof(msg), "Column family id not found: %" PRIu32,
+             column_family_id);
+    return Status::InvalidArgument(msg);
+  }
+  const Comparator* cmp = cf_locks->cmp;
+  const Slice& start = start_endp.slice;
+  const Slice& end = end_endp.slice;
+  const size_t shard_idx = ShardOf(start, end);
+  const size_t lock_memory = sizeof(LockedRange) + start.size() + end.size();
+
+  const int64_t timeout = txn->GetLockTimeout();
+  const uint64_t end_time = timeout > 0 ? env->NowMicros() + timeout : 0;
+  bool waiting = false;
+  std::string wait_key;
+  Status s;
+  while (true) {
+    // The shards to check, in increasing order of index
+    autovector<Shard*> shards;
+    if (shard_idx == 0) {
+      for (auto& shard : cf_locks->shards) {
+        shards.push_back(shard.get());
+      }
+    } else {
+      if (cf_locks->num_wide_locks.load() > 0) {
+        shards.push_back(cf_locks->shards[0].get());
+      }
+      shards.push_back(cf_locks->shards[shard_idx].get());
+    }
+    size_t num_locked = 0;
+    for (; num_locked < shards.size(); num_locked++) {
+      s = shards[num_locked]->mutex->Lock();
+      if (!s.ok()) {
+        break;
+      }
+    }
+    auto unlock_shards = [&]() {
+      for (size_t i = 0; i < num_locked; i++) {
+        shards[i]->mutex->UnLock();
+      }
+    };
+    if (!s.ok()) {
+      unlock_shards();
+      break;
+    }
+    if (shard_idx != 0 && shards.size() == 1 &&
+        cf_locks->num_wide_locks.load() > 0) {
+      // A wide lock came in before the shard was locked; start over with
+      // shard 0
+      unlock_shards();
+      continue;
+    }
+
+    Shard* conflict_shard = nullptr;
+    TransactionID conflict_id = 0;
+    bool held = false;
+    for (Shard* shard : shards) {
+      for (size_t i = 0; i < shard->num_locks && conflict_shard == nullptr;
+           i++) {
+        const LockedRange& lock = shard->locks[i];
+        if (CompareEndpoints(cmp, start, start_endp.inf_suffix, lock.end,
+                             lock.end_inf) > 0 ||
+            CompareEndpoints(cmp, lock.start, lock.start_inf, end,
+                             end_endp.inf_suffix) > 0) {
+          continue;
+        }
+        if (lock.txn == txn) {
+          held = held || ((lock.exclusive || !exclusive) &&
+                          lock.start_inf == start_endp.inf_suffix &&
+                          lock.end_inf == end_endp.inf_suffix &&
+                          lock.start == start && lock.end == end);
+        } else if (exclusive || lock.exclusive) {
+          conflict_shard = shard;
+          conflict_id = lock.txn->GetID();
+        }
+      }
+      if (conflict_shard != nullptr) {
+        break;
+      }
+    }
+
+    if (conflict_shard == nullptr) {
+      const size_t max_lock_memory = max_lock_memory_.load();
+      if (held) {
+        // Already locked by an equal range of this transaction
+      } else if (max_lock_memory > 0 &&
+                 lock_memory_.load() + lock_memory > max_lock_memory) {
+        s = Status::Busy(Status::SubCode::kLockLimit);
+      } else {
+        Shard* shard = cf_locks->shards[shard_idx].get();
+        if (shard->num_locks == shard->locks.size()) {
+          shard->locks.emplace_back();
+        }
+        LockedRange& lock = shard->locks[shard->num_locks++];
+        lock.start.assign(start.data(), start.size());
+        lock.end.assign(end.data(), end.size());
+        lock.start_inf = start_endp.inf_suffix;
+        lock.end_inf = end_endp.inf_suffix;
+        lock.exclusive = exclusive;
+        lock.txn = txn;
+        lock_memory_.fetch_add(lock_memory);
+        if (shard_idx == 0) {
+          cf_locks->num_wide_locks.fetch_add(1);
+        }
+      }
+      unlock_shards();
+      break;
+    }
+
+    // Waits for a release in the shard of the conflicting lock
+    const uint64_t epoch = conflict_shard->epoch;
+    unlock_shards();
+    int64_t wait_micros = -1;
+    if (timeout == 0) {
+      s = Status::TimedOut(Status::SubCode::kLockTimeout);
+      break;
+    } else if (timeout > 0) {
+      const uint64_t now = env->NowMicros();
+      if (now >= end_time) {
+        s = Status::TimedOut(Status::SubCode::kLockTimeout);
+        break;
+      }
+      wait_micros = static_cast<int64_t>(end_time - now);
+    }
+    if (!waiting) {
+      waiting = true;
+      wait_key = start.ToString();
+    }
+    autovector<TransactionID> wait_ids;
+    wait_ids.push_back(conflict_id);
+    txn->SetWaitingTxn(wait_ids, column_family_id, &wait_key);
+
+    s = conflict_shard->mutex->Lock();
+    if (!s.ok()) {
+      break;
+    }
+    if (conflict_shard->epoch == epoch) {
+      // A timeout is noticed on the next round
+      if (wait_micros < 0) {
+        conflict_shard->cv->Wait(conflict_shard->mutex).PermitUncheckedError();
+      } else {
+        conflict_shard->cv->WaitFor(conflict_shard->mutex, wait_micros)
+            .PermitUncheckedError();
+      }
+    }
+    conflict_shard->mutex->UnLock();
+  }
+  if (waiting) {
+    txn->ClearWaitingTxn();
+  }
+  return s;
+}
+
+void ShardedRangeLockManager::Release(PessimisticTransaction* txn,
+                                      ColumnFamilyLocks* cf_locks,
+                                      const Slice& start, bool start_inf,
+                                      const Slice& end, bool end_inf) {
+  const size_t shard_idx = ShardOf(start, end);
+  Shard* shard = cf_locks->shards[shard_idx].get();
+  if (!shard->mutex->Lock().ok()) {
+    return;
+  }
+  size_t num_released = 0;
+  for (size_t i = 0; i < shard->num_locks;) {
+    LockedRange& lock = shard->locks[i];
+    if (lock.txn != txn || lock.start_inf != start_inf ||
+        lock.end_inf != end_inf || lock.start != start || lock.end != end) {
+      i++;
+      continue;
+    }
+    lock_memory_.fetch_sub(lock.ApproximateMemoryUsage());
+    // Swapping keeps the memory of both entries for reuse
+    std::swap(lock, shard->locks[--shard->num_locks]);
+    num_released++;
+  }
+  if (num_released > 0) {
+    if (shard_idx == 0) {
+      cf_locks->num_wide_locks.fetch_sub(num_released);
+    }
+    shard->epoch++;
+  }
+  shard->mutex->UnLock();
+  if (num_released > 0) {
+    shard->cv->NotifyAll();
+  }
+}
+
+void ShardedRangeLockManager::UnLock(PessimisticTransaction* txn,
+                                     const LockTracker& tracker, Env*) {
+  const auto& ranges =
+      static_cast<const ShardedRangeLockTracker&>(tracker).ranges();
+  std::shared_ptr<ColumnFamilyLocks> cf_locks;
+  ColumnFamilyId cf_id = 0;
+  for (const auto& range : ranges) {
+    if (cf_locks == nullptr || range.column_family_id != cf_id) {
+      cf_id = range.column_family_id;
+      cf_locks = GetColumnFamilyLocks(cf_id);
+    }
+    if (cf_locks != nullptr) {
+      Release(txn, cf_locks.get(), range.start.slice, range.start.inf_suffix,
+              range.end.slice, range.end.inf_suffix);
+    }
+  }
+}
+
+void ShardedRangeLockManager::UnLock(PessimisticTransaction* txn,
+                                     ColumnFamilyId column_family_id,
+                                     const std::string& key, Env*) {
+  std::shared_ptr<ColumnFamilyLocks> cf_locks =
+      GetColumnFamilyLocks(column_family_id);
+  if (cf_locks != nullptr) {
+    Release(txn, cf_locks.get(), key, false, key, false);
+  }
+}
+
+void ShardedRangeLockManager::UnLock(PessimisticTransaction* txn,
+                                     ColumnFamilyId column_family_id,
+                                     const Endpoint& start_endp,
+                                     const Endpoint& end_endp, Env*) {
+  std::shared_ptr<ColumnFamilyLocks> cf_locks =
+      GetColumnFamilyLocks(column_family_id);
+  if (cf_locks != nullptr) {
+    Release(txn, cf_locks.get(), start_endp.slice, start_endp.inf_suffix,
+            end_endp.slice, end_endp.inf_suffix);
+  }
+}
+
+int ShardedRangeLockManager::SetMaxLockMemory(size_t max_lock_memory) {
+  if (max_lock_memory > 0 && lock_memory_.load() > max_lock_memory) {
+    return EDOM;
+  }
+  max_lock_memory_.store(max_lock_memory);
+  return 0;
+}
+
+RangeLockManagerHandle::Counters ShardedRangeLockManager::GetStatus() {
+  Counters res;
+  res.escalation_count = 0;
+  res.current_lock_memory = lock_memory_.load();
+  return res;
+}
+
+LockManager::PointLockStatus ShardedRangeLockManager::GetPointLockStatus() {
+  // Report the left endpoints of the ranges, as RangeTreeLockManager does
+  PointLockStatus res;
+  for (const auto& it : GetRangeLockStatus()) {
+    KeyLockInfo info;
+    info.key = it.second.start.slice;
+    info.ids = it.second.ids;
+    info.exclusive = it.second.exclusive;
+    res.emplace(it.first, std::move(info));
+  }
+  return res;
+}
+
+LockManager::RangeLockStatus ShardedRangeLockManager::GetRangeLockStatus() {
+  std::vector<std::pair<ColumnFamilyId, std::shared_ptr<ColumnFamilyLocks>>>
+      cfs;
+  {
+    ReadLock l(&cf_map_mutex_);
+    cfs.assign(cf_map_.begin(), cf_map_.end());
+  }
+  LockManager::RangeLockStatus res;
+  for (const auto& cf : cfs) {
+    for (const auto& shard : cf.second->shards) {
+      if (!shard->mutex->Lock().ok()) {
+        continue;
+      }
+      for (size_t i = 0; i < shard->num_locks; i++) {
+        const LockedRange& lock = shard->locks[i];
+        RangeLockInfo info;
+        info.start.slice = lock.start;
+        info.start.inf_suffix = lock.start_inf;
+        info.end.slice = lock.end;
+        info.end.inf_suffix = lock.end_inf;
+        info.ids.push_back(lock.txn->GetID());
+        info.exclusive = lock.exclusive;
+        res.emplace(cf.first, std::move(info));
+      }
+      shard->mutex->UnLock();
+    }
+  }
+  return res;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
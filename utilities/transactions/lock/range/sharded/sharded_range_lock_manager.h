@@ -0,0 +1,208 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "utilities/transactions/lock/range/range_lock_manager.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The ranges locked by a transaction through ShardedRangeLockManager. A
+// point lock is tracked as a single-point range.
+class ShardedRangeLockTracker : public LockTracker {
+ public:
+  struct TrackedRange {
+    ColumnFamilyId column_family_id;
+    EndpointWithString start;
+    EndpointWithString end;
+  };
+
+  ShardedRangeLockTracker() {}
+
+  ShardedRangeLockTracker(const ShardedRangeLockTracker&) = delete;
+  ShardedRangeLockTracker& operator=(const ShardedRangeLockTracker&) = delete;
+
+  void Track(const PointLockRequest& lock_request) override;
+  void Track(const RangeLockRequest& lock_request) override;
+
+  bool IsPointLockSupported() const override {
+    // This indicates that we don't implement GetPointLockStatus()
+    return false;
+  }
+  bool IsRangeLockSupported() const override { return true; }
+
+  // a Not-supported dummy implementation.
+  UntrackStatus Untrack(const RangeLockRequest& /*lock_request*/) override {
+    return UntrackStatus::NOT_TRACKED;
+  }
+
+  UntrackStatus Untrack(const PointLockRequest& /*lock_request*/) override {
+    return UntrackStatus::NOT_TRACKED;
+  }
+
+  // "If this method is not supported, leave it as a no-op."
+  void Merge(const LockTracker&) override {}
+
+  // "If this method is not supported, leave it as a no-op."
+  void Subtract(const LockTracker&) override {}
+
+  void Clear() override { ranges_.clear(); }
+
+  // "If this method is not supported, returns nullptr."
+  LockTracker* GetTrackedLocksSinceSavePoint(
+      const LockTracker&) const override {
+    return nullptr;
+  }
+
+  PointLockStatus GetPointLockStatus(ColumnFamilyId column_family_id,
+                                     const std::string& key) const override;
+
+  // The return value is only used for tests
+  uint64_t GetNumPointLocks() const override { return 0; }
+
+  ColumnFamilyIterator* GetColumnFamilyIterator() const override {
+    return nullptr;
+  }
+
+  KeyIterator* GetKeyIterator(
+      ColumnFamilyId /*column_family_id*/) const override {
+    return nullptr;
+  }
+
+  const std::vector<TrackedRange>& ranges() const { return ranges_; }
+
+ private:
+  std::vector<TrackedRange> ranges_;
+};
+
+class ShardedRangeLockTrackerFactory : public LockTrackerFactory {
+ public:
+  static const ShardedRangeLockTrackerFactory& Get() {
+    static const ShardedRangeLockTrackerFactory instance;
+    return instance;
+  }
+
+  LockTracker* Create() const override { return new ShardedRangeLockTracker(); }
+
+ private:
+  ShardedRangeLockTrackerFactory() {}
+};
+
+// A Range Lock Manager for short-lived and mostly disjoint ranges.
+//
+// The locks of every column family are kept in plain arrays, one per shard,
+// each under a mutex of its own. A range whose endpoints share their first
+// prefix_length bytes goes to the shard picked by the hash of that prefix,
+// so that transactions locking keys under different prefixes rarely meet on
+// a mutex. Any other range is "wide": it is kept in shard 0 and checked
+// against the locks of all shards, while a narrow range is checked against
+// shard 0 only as long as it holds any locks. Shards are always locked in
+// increasing order.
+//
+// The entries of a shard are reused once released, along with the memory
+// of their keys, so that locking does not allocate once a shard has grown
+// to its working size.
+//
+// Unlike RangeTreeLockManager, there is neither lock escalation nor
+// deadlock detection: a transaction in a deadlock waits for its lock
+// timeout.
+class ShardedRangeLockManager : public RangeLockManagerBase,
+                                public RangeLockManagerHandle {
+ public:
+  ShardedRangeLockManager(
+      std::shared_ptr<TransactionDBMutexFactory> mutex_factory,
+      size_t num_shards, size_t prefix_length);
+
+  ~ShardedRangeLockManager() override;
+
+  LockManager* getLockManager() override { return this; }
+
+  void AddColumnFamily(const ColumnFamilyHandle* cfh) override;
+  void RemoveColumnFamily(const ColumnFamilyHandle* cfh) override;
+
+  void Resize(uint32_t) override {}
+  std::vector<DeadlockPath> GetDeadlockInfoBuffer() override { return {}; }
+
+  std::vector<RangeDeadlockPath> GetRangeDeadlockInfoBuffer() override {
+    return {};
+  }
+  void SetRangeDeadlockInfoBufferSize(uint32_t) override {}
+
+  using LockManager::TryLock;
+  Status TryLock(PessimisticTransaction* txn, ColumnFamilyId column_family_id,
+                 const Endpoint& start_endp, const Endpoint& end_endp, Env* env,
+                 bool exclusive) override;
+
+  void UnLock(PessimisticTransaction* txn, const LockTracker& tracker,
+              Env* env) override;
+  void UnLock(PessimisticTransaction* txn, ColumnFamilyId column_family_id,
+              const std::string& key, Env* env) override;
+  void UnLock(PessimisticTransaction* txn, ColumnFamilyId column_family_id,
+              const Endpoint& start_endp, const Endpoint& end_endp,
+              Env* env) override;
+
+  int SetMaxLockMemory(size_t max_lock_memory) override;
+  size_t GetMaxLockMemory() override { return max_lock_memory_.load(); }
+
+  Counters GetStatus() override;
+
+  bool IsPointLockSupported() const override {
+    // One could have acquired a point lock (it is reduced to range lock)
+    return true;
+  }
+
+  PointLockStatus GetPointLockStatus() override;
+
+  // This is from LockManager
+  LockManager::RangeLockStatus GetRangeLockStatus() override;
+
+  // This has the same meaning as GetRangeLockStatus but is from
+  // RangeLockManagerHandle
+  RangeLockManagerHandle::RangeLockStatus GetRangeLockStatusData() override {
+    return GetRangeLockStatus();
+  }
+
+  bool IsRangeLockSupported() const override { return true; }
+
+  const LockTrackerFactory& GetLockTrackerFactory() const override {
+    return ShardedRangeLockTrackerFactory::Get();
+  }
+
+ private:
+  struct LockedRange;
+  struct Shard;
+  struct ColumnFamilyLocks;
+
+  std::shared_ptr<ColumnFamilyLocks> GetColumnFamilyLocks(
+      ColumnFamilyId column_family_id);
+  // The shard that keeps the locks on [start, end]: 0 for a wide range
+  size_t ShardOf(const Slice& start, const Slice& end) const;
+  void Release(PessimisticTransaction* txn, ColumnFamilyLocks* cf_locks,
+               const Slice& start, bool start_inf, const Slice& end,
+               bool end_inf);
+
+  std::shared_ptr<TransactionDBMutexFactory> mutex_factory_;
+  // The number of shards for narrow ranges; shard 0 comes on top
+  const size_t num_shards_;
+  const size_t prefix_length_;
+
+  std::atomic<size_t> max_lock_memory_;
+  std::atomic<size_t> lock_memory_;
+
+  port::RWMutex cf_map_mutex_;
+  std::unordered_map<ColumnFamilyId, std::shared_ptr<ColumnFamilyLocks>>
+      cf_map_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -120,8 +120,9 @@ Status OptimisticTransaction::CommitWithParallelValidate() {
     lks.emplace_back(txn_db_impl->LockBucket(v));
   }
 
-  Status s = TransactionUtil::CheckKeysForConflicts(db_impl, *tracked_locks_,
-                                                    true /* cache_only */);
+  Status s = TransactionUtil::CheckKeysForConflicts(
+      db_impl, *tracked_locks_, true /* cache_only */,
+      txn_db_impl->GetMaxValidationThreads());
   if (!s.ok()) {
     return s;
   }
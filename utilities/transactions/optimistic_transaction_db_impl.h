@@ -23,7 +23,9 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
       bool take_ownership = true)
       : OptimisticTransactionDB(db),
         db_owner_(take_ownership),
-        validate_policy_(occ_options.validate_policy) {
+        validate_policy_(occ_options.validate_policy),
+        max_validation_threads_(
+            std::max(1u, occ_options.max_validation_threads)) {
     if (validate_policy_ == OccValidationPolicy::kValidateParallel) {
       uint32_t bucket_size = std::max(16u, occ_options.occ_lock_buckets);
       bucketed_locks_.reserve(bucket_size);
@@ -66,6 +68,8 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
 
   OccValidationPolicy GetValidatePolicy() const { return validate_policy_; }
 
+  uint32_t GetMaxValidationThreads() const { return max_validation_threads_; }
+
   std::unique_lock<std::mutex> LockBucket(size_t idx);
 
  private:
@@ -77,6 +81,8 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
 
   const OccValidationPolicy validate_policy_;
 
+  const uint32_t max_validation_threads_;
+
   void ReinitializeTransaction(Transaction* txn,
                                const WriteOptions& write_options,
                                const OptimisticTransactionOptions& txn_options =
@@ -33,6 +33,7 @@ class OptimisticTransactionTest
   OptimisticTransactionDB* txn_db;
   string dbname;
   Options options;
+  uint32_t max_validation_threads = 1;
 
   OptimisticTransactionTest() {
     options.create_if_missing = true;
@@ -60,6 +61,7 @@ private:
     ColumnFamilyOptions cf_options(options);
     OptimisticTransactionDBOptions occ_opts;
     occ_opts.validate_policy = GetParam();
+    occ_opts.max_validation_threads = max_validation_threads;
     std::vector<ColumnFamilyDescriptor> column_families;
     std::vector<ColumnFamilyHandle*> handles;
     column_families.push_back(
@@ -168,6 +170,45 @@ TEST_P(OptimisticTransactionTest, WriteConflictTest2) {
   delete txn;
 }
 
+TEST_P(OptimisticTransactionTest, ManyKeysConflictTest) {
+  // Enough keys to be checked on several threads with kValidateParallel
+  max_validation_threads = 4;
+  Reopen();
+  WriteOptions write_options;
+  ReadOptions read_options;
+  const int kNumKeys = 2000;
+  std::vector<string> keys;
+  for (int i = 0; i < kNumKeys; i++) {
+    keys.push_back("key" + ToString(i));
+    ASSERT_OK(txn_db->Put(write_options, keys.back(), "v0"));
+  }
+
+  // No writes since the keys were tracked
+  Transaction* txn = txn_db->BeginTransaction(write_options);
+  for (const string& key : keys) {
+    ASSERT_OK(txn->GetForUpdate(read_options, key, nullptr));
+    ASSERT_OK(txn->Put(key, "v1"));
+  }
+  ASSERT_OK(txn->Commit());
+  delete txn;
+
+  // A write to one key, checked by whichever thread has it
+  txn = txn_db->BeginTransaction(write_options);
+  for (const string& key : keys) {
+    ASSERT_OK(txn->GetForUpdate(read_options, key, nullptr));
+    ASSERT_OK(txn->Put(key, "v2"));
+  }
+  ASSERT_OK(txn_db->Put(write_options, keys[kNumKeys - 10], "x"));
+  ASSERT_TRUE(txn->Commit().IsBusy());
+  delete txn;
+
+  string value;
+  ASSERT_OK(txn_db->Get(read_options, keys[0], &value));
+  ASSERT_EQ("v1", value);
+  ASSERT_OK(txn_db->Get(read_options, keys[kNumKeys - 10], &value));
+  ASSERT_EQ("x", value);
+}
+
 TEST_P(OptimisticTransactionTest, ReadConflictTest) {
   WriteOptions write_options;
   ReadOptions read_options, snapshot_read_options;
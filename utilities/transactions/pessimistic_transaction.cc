@@ -50,6 +50,7 @@ PessimisticTransaction::PessimisticTransaction(
       lock_timeout_(0),
       deadlock_detect_(false),
       deadlock_detect_depth_(0),
+      deadlock_detect_delay_micros_(0),
       skip_concurrency_control_(false) {
   txn_db_impl_ = static_cast_with_check<PessimisticTransactionDB>(txn_db);
   db_impl_ = static_cast_with_check<DBImpl>(db_);
@@ -65,6 +66,7 @@ void PessimisticTransaction::Initialize(const TransactionOptions& txn_options) {
 
   deadlock_detect_ = txn_options.deadlock_detect;
   deadlock_detect_depth_ = txn_options.deadlock_detect_depth;
+  deadlock_detect_delay_micros_ = txn_options.deadlock_detect_delay_micros;
   write_batch_.SetMaxBytes(txn_options.max_write_batch_size);
   skip_concurrency_control_ = txn_options.skip_concurrency_control;
 
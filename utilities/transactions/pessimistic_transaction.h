@@ -116,6 +116,10 @@ class PessimisticTransaction : public TransactionBaseImpl {
 
   int64_t GetDeadlockDetectDepth() const { return deadlock_detect_depth_; }
 
+  int64_t GetDeadlockDetectDelayMicros() const {
+    return deadlock_detect_delay_micros_;
+  }
+
   virtual Status GetRangeLock(ColumnFamilyHandle* column_family,
                               const Endpoint& start_key,
                               const Endpoint& end_key) override;
@@ -194,6 +198,9 @@ class PessimisticTransaction : public TransactionBaseImpl {
   // Whether to perform deadlock detection or not.
   int64_t deadlock_detect_depth_;
 
+  // Refer to TransactionOptions::deadlock_detect_delay_micros
+  int64_t deadlock_detect_delay_micros_;
+
   // Refer to TransactionOptions::skip_concurrency_control
   bool skip_concurrency_control_;
 
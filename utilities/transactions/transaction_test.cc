@@ -687,6 +687,49 @@ TEST_P(TransactionTest, DeadlockCycleShared) {
   }
 }
 
+TEST_P(TransactionTest, DeadlockDetectDelay) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  TransactionOptions txn_options;
+  txn_options.lock_timeout = 1000000;
+  txn_options.deadlock_detect = true;
+  txn_options.deadlock_detect_delay_micros = 50000;
+
+  Transaction* txn0 = db->BeginTransaction(write_options, txn_options);
+  Transaction* txn1 = db->BeginTransaction(write_options, txn_options);
+  ASSERT_OK(txn0->GetForUpdate(read_options, "0", nullptr));
+  ASSERT_OK(txn1->GetForUpdate(read_options, "1", nullptr));
+
+  std::atomic<uint32_t> checkpoints(0);
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "PointLockManager::AcquireWithTimeout:WaitingTxn",
+      [&](void* /*arg*/) { checkpoints.fetch_add(1); });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  // T1 -> T2, not yet in the wait-for graph
+  port::Thread blocking_thread([&] {
+    ASSERT_OK(txn0->GetForUpdate(read_options, "1", nullptr));
+    ASSERT_OK(txn0->Rollback());
+  });
+  while (checkpoints.load() == 0) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Completing the cycle T2 -> T1 is only detected after the delay
+  const uint64_t start = env->NowMicros();
+  auto s = txn1->GetForUpdate(read_options, "0", nullptr);
+  ASSERT_TRUE(s.IsDeadlock());
+  ASSERT_GE(env->NowMicros() - start, 50000U);
+  ASSERT_OK(txn1->Rollback());
+
+  blocking_thread.join();
+  delete txn0;
+  delete txn1;
+}
+
 #if !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
 TEST_P(TransactionStressTest, DeadlockCycle) {
   WriteOptions write_options;
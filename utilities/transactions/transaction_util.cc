@@ -7,11 +7,15 @@
 
 #include "utilities/transactions/transaction_util.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "db/db_impl/db_impl.h"
+#include "port/port.h"
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/write_batch_with_index.h"
 #include "util/cast_util.h"
@@ -138,9 +142,17 @@ Status TransactionUtil::CheckKey(DBImpl* db_impl, SuperVersion* sv,
 
 Status TransactionUtil::CheckKeysForConflicts(DBImpl* db_impl,
                                               const LockTracker& tracker,
-                                              bool cache_only) {
+                                              bool cache_only,
+                                              size_t max_threads) {
   Status result;
 
+  // No key tracked at or after this sequence number can have been written
+  // to since
+  const SequenceNumber last_seq = db_impl->GetLatestSequenceNumber();
+  // The keys of a column family still to check, with their tracked sequence
+  // numbers
+  std::vector<std::pair<const std::string*, SequenceNumber>> keys;
+
   std::unique_ptr<LockTracker::ColumnFamilyIterator> cf_it(
       tracker.GetColumnFamilyIterator());
   assert(cf_it != nullptr);
@@ -154,22 +166,72 @@ Status TransactionUtil::CheckKeysForConflicts(DBImpl* db_impl,
       break;
     }
 
-    SequenceNumber earliest_seq =
-        db_impl->GetEarliestMemTableSequenceNumber(sv, true);
-
-    // For each of the keys in this transaction, check to see if someone has
-    // written to this key since the start of the transaction.
+    keys.clear();
     std::unique_ptr<LockTracker::KeyIterator> key_it(
         tracker.GetKeyIterator(cf));
     assert(key_it != nullptr);
     while (key_it->HasNext()) {
       const std::string& key = key_it->Next();
       PointLockStatus status = tracker.GetPointLockStatus(cf, key);
-      const SequenceNumber key_seq = status.seq;
+      if (status.seq < last_seq) {
+        keys.emplace_back(&key, status.seq);
+      }
+    }
+    // The tracker keeps the keys in hash order. In key order, consecutive
+    // lookups walk mostly the same memtable nodes and SST blocks.
+    const Comparator* ucmp = sv->cfd->user_comparator();
+    std::sort(keys.begin(), keys.end(),
+              [ucmp](const std::pair<const std::string*, SequenceNumber>& a,
+                     const std::pair<const std::string*, SequenceNumber>& b) {
+                return ucmp->Compare(*a.first, *b.first) < 0;
+              });
 
-      result = CheckKey(db_impl, sv, earliest_seq, key_seq, key, cache_only);
-      if (!result.ok()) {
-        break;
+    SequenceNumber earliest_seq =
+        db_impl->GetEarliestMemTableSequenceNumber(sv, true);
+
+    // For each of the keys in [begin, end), check to see if someone has
+    // written to this key since the start of the transaction. Stops early
+    // once any range has found a conflict.
+    std::atomic<bool> failed(false);
+    auto check_range = [&](size_t begin, size_t end) {
+      Status s;
+      for (size_t i = begin; i < end && !failed.load(std::memory_order_relaxed);
+           i++) {
+        s = CheckKey(db_impl, sv, earliest_seq, keys[i].second, *keys[i].first,
+                     cache_only);
+        if (!s.ok()) {
+          failed.store(true, std::memory_order_relaxed);
+          break;
+        }
+      }
+      return s;
+    };
+
+    const size_t num_threads = std::max<size_t>(
+        1, std::min(max_threads, keys.size() / kMinKeysPerCheckThread));
+    if (num_threads == 1) {
+      result = check_range(0, keys.size());
+    } else {
+      const size_t keys_per_thread =
+          (keys.size() + num_threads - 1) / num_threads;
+      std::vector<Status> statuses(num_threads);
+      std::vector<port::Thread> threads;
+      threads.reserve(num_threads - 1);
+      for (size_t t = 1; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          statuses[t] =
+              check_range(t * keys_per_thread,
+                          std::min(keys.size(), (t + 1) * keys_per_thread));
+        });
+      }
+      statuses[0] = check_range(0, keys_per_thread);
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      for (auto& s : statuses) {
+        if (!s.ok() && result.ok()) {
+          result = s;
+        }
       }
     }
 
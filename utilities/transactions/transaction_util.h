@@ -51,13 +51,22 @@ class TransactionUtil {
   // Returns OK on success, BUSY if there is a conflicting write, or other error
   // status for any unexpected errors.
   //
+  // The keys of a column family are looked up in key order. Keys tracked at
+  // or after the latest sequence number are skipped, as nothing has been
+  // written to them since. With max_threads > 1, the keys of a column family
+  // are split into up to max_threads ranges of at least
+  // kMinKeysPerCheckThread keys, checked in parallel.
+  //
   // REQUIRED:
   // This function should only be called on the write thread or if the
   // mutex is held.
   // tracker must support point lock.
   static Status CheckKeysForConflicts(DBImpl* db_impl,
                                       const LockTracker& tracker,
-                                      bool cache_only);
+                                      bool cache_only,
+                                      size_t max_threads = 1);
+
+  static constexpr size_t kMinKeysPerCheckThread = 256;
 
  private:
   // If `snap_checker` == nullptr, writes are always commited in sequence number
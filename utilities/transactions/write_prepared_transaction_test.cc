@@ -1254,6 +1254,45 @@ TEST_P(SnapshotConcurrentAccessTest, SnapshotConcurrentAccess) {
 #endif  // !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
 #endif  // TRAVIS
 
+// Lingering prepared txns only make IsInSnapshot acquire prepared_mutex_ for
+// the sequence numbers within their range
+TEST_P(WritePreparedTransactionTest, DelayedPreparedRange) {
+  options.statistics = CreateDBStatistics();
+  DBImpl* mock_db = new DBImpl(options, dbname);
+  std::unique_ptr<WritePreparedTxnDBMock> wp_db(
+      new WritePreparedTxnDBMock(mock_db, txn_db_options));
+  ASSERT_FALSE(wp_db->DelayedPreparedMayContain(100));
+
+  wp_db->AddPrepared(100);
+  wp_db->AddPrepared(110);
+  wp_db->AdvanceMaxEvictedSeq(0, 150);
+  ASSERT_FALSE(wp_db->delayed_prepared_empty_);
+  ASSERT_FALSE(wp_db->DelayedPreparedMayContain(99));
+  ASSERT_TRUE(wp_db->DelayedPreparedMayContain(100));
+  ASSERT_TRUE(wp_db->DelayedPreparedMayContain(105));
+  ASSERT_TRUE(wp_db->DelayedPreparedMayContain(110));
+  ASSERT_FALSE(wp_db->DelayedPreparedMayContain(111));
+
+  // Evicted and outside of the range: committed before the snapshot
+  ASSERT_TRUE(wp_db->IsInSnapshot(120, 200));
+  ASSERT_EQ(1U, options.statistics->getTickerCount(TXN_PREPARE_MUTEX_SKIPPED));
+  ASSERT_EQ(0U, options.statistics->getTickerCount(TXN_PREPARE_MUTEX_OVERHEAD));
+  // Within the range
+  ASSERT_TRUE(wp_db->IsInSnapshot(105, 200));
+  ASSERT_FALSE(wp_db->IsInSnapshot(110, 200));
+  ASSERT_EQ(2U, options.statistics->getTickerCount(TXN_PREPARE_MUTEX_OVERHEAD));
+  ASSERT_EQ(3U, options.statistics->getTickerCount(
+                    TXN_COMMIT_CACHE_EVICTED_LOOKUP));
+
+  // The range shrinks as the delayed prepared txns finish
+  wp_db->RemovePrepared(100);
+  ASSERT_FALSE(wp_db->DelayedPreparedMayContain(105));
+  ASSERT_TRUE(wp_db->DelayedPreparedMayContain(110));
+  wp_db->RemovePrepared(110);
+  ASSERT_TRUE(wp_db->delayed_prepared_empty_);
+  ASSERT_FALSE(wp_db->DelayedPreparedMayContain(110));
+}
+
 // This test clarifies the contract of AdvanceMaxEvictedSeq method
 TEST_P(WritePreparedTransactionTest, AdvanceMaxEvictedSeqBasic) {
   DBImpl* mock_db = new DBImpl(options, dbname);
@@ -428,6 +428,13 @@ void WritePreparedTxnDB::CheckPreparedAgainstMax(SequenceNumber new_max,
     // Need to fetch fresh values of ::top after mutex is acquired
     while (!prepared_txns_.empty() && prepared_txns_.top() <= new_max) {
       auto to_be_popped = prepared_txns_.top();
+      // Widen the range before the insert. Refer to delayed_prepared_min_.
+      if (to_be_popped < delayed_prepared_min_.load()) {
+        delayed_prepared_min_.store(to_be_popped, std::memory_order_release);
+      }
+      if (to_be_popped > delayed_prepared_max_.load()) {
+        delayed_prepared_max_.store(to_be_popped, std::memory_order_release);
+      }
       delayed_prepared_.insert(to_be_popped);
       ROCKS_LOG_WARN(info_log_,
                      "prepared_mutex_ overhead %" PRIu64 " (prep=%" PRIu64
@@ -567,6 +574,11 @@ void WritePreparedTxnDB::RemovePrepared(const uint64_t prepare_seq,
         delayed_prepared_commits_.erase(it);
       }
       bool is_empty = delayed_prepared_.empty();
+      delayed_prepared_min_.store(
+          is_empty ? kMaxSequenceNumber : *delayed_prepared_.begin(),
+          std::memory_order_release);
+      delayed_prepared_max_.store(is_empty ? 0 : *delayed_prepared_.rbegin(),
+                                  std::memory_order_release);
       if (was_empty != is_empty) {
         delayed_prepared_empty_.store(is_empty, std::memory_order_release);
       }
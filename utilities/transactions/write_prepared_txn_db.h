@@ -208,10 +208,25 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
                           prep_seq, snapshot_seq, 0);
         return false;
       }
+      WPRecordTick(TXN_COMMIT_CACHE_EVICTED_LOOKUP);
       TEST_SYNC_POINT("WritePreparedTxnDB::IsInSnapshot:prepared_mutex_:pause");
       TEST_SYNC_POINT(
           "WritePreparedTxnDB::IsInSnapshot:prepared_mutex_:resume");
-      if (!was_empty) {
+      if (!was_empty && !DelayedPreparedMayContain(prep_seq)) {
+        // The delayed prepared txns are usually a few long-running ones,
+        // outside of whose range most reads can skip prepared_mutex_
+        WPRecordTick(TXN_PREPARE_MUTEX_SKIPPED);
+        // 2nd query to commit cache. Refer to was_empty comment above.
+        exist = GetCommitEntry(indexed_seq, &dont_care, &cached);
+        if (exist && prep_seq == cached.prep_seq) {
+          ROCKS_LOG_DETAILS(
+              info_log_,
+              "IsInSnapshot %" PRIu64 " in %" PRIu64 " returns %" PRId32,
+              prep_seq, snapshot_seq, cached.commit_seq <= snapshot_seq);
+          return cached.commit_seq <= snapshot_seq;
+        }
+        max_evicted_seq_ub = max_evicted_seq_.load(std::memory_order_acquire);
+      } else if (!was_empty) {
         // We should not normally reach here
         WPRecordTick(TXN_PREPARE_MUTEX_OVERHEAD);
         ReadLock rl(&prepared_mutex_);
@@ -484,6 +499,7 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   friend class WritePreparedTransactionTest_CleanupSnapshotEqualToMax_Test;
   friend class WritePreparedTransactionTest_ConflictDetectionAfterRecovery_Test;
   friend class WritePreparedTransactionTest_CommitMap_Test;
+  friend class WritePreparedTransactionTest_DelayedPreparedRange_Test;
   friend class WritePreparedTransactionTest_DoubleSnapshot_Test;
   friend class WritePreparedTransactionTest_IsInSnapshotEmptyMap_Test;
   friend class WritePreparedTransactionTest_IsInSnapshotReleased_Test;
@@ -509,6 +525,12 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
     RecordTick(db_impl_->immutable_db_options_.statistics.get(), ticker_type);
   }
 
+  // False if seq is not in delayed_prepared_, without prepared_mutex_
+  bool DelayedPreparedMayContain(SequenceNumber seq) const {
+    return seq >= delayed_prepared_min_.load(std::memory_order_acquire) &&
+           seq <= delayed_prepared_max_.load(std::memory_order_acquire);
+  }
+
   // A heap with the amortized O(1) complexity for erase. It uses one extra heap
   // to keep track of erased entries that are not yet on top of the main heap.
   class PreparedHeap {
@@ -780,6 +802,12 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   // Update when delayed_prepared_.empty() changes. Expected to be true
   // normally.
   std::atomic<bool> delayed_prepared_empty_ = {true};
+  // Bounds of the range of delayed_prepared_, for IsInSnapshot to tell
+  // without prepared_mutex_ that a sequence number is not in it. Widened
+  // before an insert and recomputed after an erase, so that they cover every
+  // entry at all times.
+  std::atomic<SequenceNumber> delayed_prepared_min_ = {kMaxSequenceNumber};
+  std::atomic<SequenceNumber> delayed_prepared_max_ = {0};
   // Update when old_commit_map_.empty() changes. Expected to be true normally.
   std::atomic<bool> old_commit_map_empty_ = {true};
   mutable port::RWMutex prepared_mutex_;
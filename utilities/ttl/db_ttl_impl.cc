@@ -6,6 +6,7 @@
 
 #include "utilities/ttl/db_ttl_impl.h"
 
+#include "db/db_impl/db_impl.h"
 #include "db/write_batch_internal.h"
 #include "file/filename.h"
 #include "rocksdb/convenience.h"
@@ -13,10 +14,16 @@
 #include "rocksdb/iterator.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/utilities/db_ttl.h"
+#include "util/cast_util.h"
 #include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+const std::string DBWithTTLImpl::kOldestTimestampProperty =
+    "rocksdb.ttl.oldest.timestamp";
+const std::string DBWithTTLImpl::kNewestTimestampProperty =
+    "rocksdb.ttl.newest.timestamp";
+
 void DBWithTTLImpl::SanitizeOptions(int32_t ttl, ColumnFamilyOptions* options,
                                     SystemClock* clock) {
   if (options->compaction_filter) {
@@ -32,10 +39,14 @@ void DBWithTTLImpl::SanitizeOptions(int32_t ttl, ColumnFamilyOptions* options,
     options->merge_operator.reset(
         new TtlMergeOperator(options->merge_operator, clock));
   }
+
+  options->table_properties_collector_factories.emplace_back(
+      new TtlTablePropertiesCollectorFactory());
 }
 
 // Open the db inside DBWithTTLImpl because options needs pointer to its ttl
-DBWithTTLImpl::DBWithTTLImpl(DB* db) : DBWithTTL(db), closed_(false) {}
+DBWithTTLImpl::DBWithTTLImpl(DB* db, bool read_only)
+    : DBWithTTL(db), closed_(false), read_only_(read_only) {}
 
 DBWithTTLImpl::~DBWithTTLImpl() {
   if (!closed_) {
@@ -118,7 +129,7 @@ Status DBWithTTL::Open(
     st = DB::Open(db_options, dbname, column_families_sanitized, handles, &db);
   }
   if (st.ok()) {
-    *dbptr = new DBWithTTLImpl(db);
+    *dbptr = new DBWithTTLImpl(db, read_only);
   } else {
     *dbptr = nullptr;
   }
@@ -189,6 +200,20 @@ bool DBWithTTLImpl::IsStale(const Slice& value, int32_t ttl,
   return (timestamp_value + ttl) < curtime;
 }
 
+bool DBWithTTLImpl::IsFileExpired(const TableProperties& props, int32_t ttl,
+                                  int64_t curtime) {
+  if (ttl <= 0 || props.num_range_deletions > 0) {
+    return false;
+  }
+  auto it = props.user_collected_properties.find(kNewestTimestampProperty);
+  if (it == props.user_collected_properties.end() ||
+      it->second.size() != sizeof(uint32_t)) {
+    return false;
+  }
+  int32_t newest = static_cast<int32_t>(DecodeFixed32(it->second.data()));
+  return (newest + ttl) < curtime;
+}
+
 // Strips the TS from the end of the slice
 Status DBWithTTLImpl::StripTS(PinnableSlice* pinnable_val) {
   if (pinnable_val->size() < kTSLength) {
@@ -325,7 +350,76 @@ Status DBWithTTLImpl::Write(const WriteOptions& opts, WriteBatch* updates) {
 
 Iterator* DBWithTTLImpl::NewIterator(const ReadOptions& opts,
                                      ColumnFamilyHandle* column_family) {
-  return new TtlIterator(db_->NewIterator(opts, column_family));
+  int32_t ttl = GetTtl(column_family);
+  int64_t curtime;
+  if (ttl <= 0 || !GetEnv()->GetSystemClock()->GetCurrentTime(&curtime).ok()) {
+    return new TtlIterator(db_->NewIterator(opts, column_family));
+  }
+  // Skips the files that hold nothing but expired Puts
+  ReadOptions ttl_opts = opts;
+  auto user_filter = opts.table_filter;
+  ttl_opts.table_filter = [ttl, curtime,
+                           user_filter](const TableProperties& props) {
+    if (IsFileExpired(props, ttl, curtime)) {
+      return false;
+    }
+    return !user_filter || user_filter(props);
+  };
+  return new TtlIterator(db_->NewIterator(ttl_opts, column_family));
+}
+
+Status DBWithTTLImpl::CompactRange(const CompactRangeOptions& options,
+                                   ColumnFamilyHandle* column_family,
+                                   const Slice* begin, const Slice* end) {
+  if (!read_only_) {
+    Status s = DropExpiredFiles(column_family);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return db_->CompactRange(options, column_family, begin, end);
+}
+
+Status DBWithTTLImpl::DropExpiredFiles(ColumnFamilyHandle* column_family) {
+  if (read_only_) {
+    return Status::NotSupported("Not supported in read only mode.");
+  }
+  int32_t ttl = GetTtl(column_family);
+  if (ttl <= 0) {
+    return Status::OK();
+  }
+  int64_t curtime;
+  Status s = GetEnv()->GetSystemClock()->GetCurrentTime(&curtime);
+  if (!s.ok()) {
+    return s;
+  }
+  DBImpl* db_impl = static_cast_with_check<DBImpl>(db_->GetRootDB());
+  return db_impl->DeleteFilesIf(
+      column_family, [ttl, curtime](const TableProperties& props) {
+        return IsFileExpired(props, ttl, curtime);
+      });
+}
+
+// Reads the immutable options rather than copying them with GetOptions(), as
+// this is called for every iterator
+int32_t DBWithTTLImpl::GetTtl(ColumnFamilyHandle* column_family) {
+  const ImmutableCFOptions* ioptions =
+      static_cast_with_check<ColumnFamilyHandleImpl>(column_family)
+          ->cfd()
+          ->ioptions();
+  if (ioptions->compaction_filter_factory != nullptr &&
+      strcmp(ioptions->compaction_filter_factory->Name(),
+             "TtlCompactionFilterFactory") == 0) {
+    return static_cast<TtlCompactionFilterFactory*>(
+               ioptions->compaction_filter_factory.get())
+        ->ttl();
+  }
+  if (ioptions->compaction_filter != nullptr &&
+      strcmp(ioptions->compaction_filter->Name(), "Delete By TTL") == 0) {
+    return static_cast<const TtlCompactionFilter*>(ioptions->compaction_filter)
+        ->ttl();
+  }
+  return 0;
 }
 
 void DBWithTTLImpl::SetTtl(ColumnFamilyHandle *h, int32_t ttl) {
@@ -6,6 +6,7 @@
 #pragma once
 
 #ifndef ROCKSDB_LITE
+#include <algorithm>
 #include <deque>
 #include <string>
 #include <vector>
@@ -15,6 +16,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/system_clock.h"
+#include "rocksdb/table_properties.h"
 #include "rocksdb/utilities/db_ttl.h"
 #include "rocksdb/utilities/utility_db.h"
 #include "utilities/compaction_filters/layered_compaction_filter_base.h"
@@ -31,7 +33,7 @@ class DBWithTTLImpl : public DBWithTTL {
   static void SanitizeOptions(int32_t ttl, ColumnFamilyOptions* options,
                               SystemClock* clock);
 
-  explicit DBWithTTLImpl(DB* db);
+  explicit DBWithTTLImpl(DB* db, bool read_only = false);
 
   virtual ~DBWithTTLImpl();
 
@@ -80,10 +82,23 @@ class DBWithTTLImpl : public DBWithTTL {
   virtual Iterator* NewIterator(const ReadOptions& opts,
                                 ColumnFamilyHandle* column_family) override;
 
+  using StackableDB::CompactRange;
+  // Drops the files that have expired as a whole before compacting the rest
+  virtual Status CompactRange(const CompactRangeOptions& options,
+                              ColumnFamilyHandle* column_family,
+                              const Slice* begin, const Slice* end) override;
+
+  Status DropExpiredFiles(ColumnFamilyHandle* column_family) override;
+
   virtual DB* GetBaseDB() override { return db_; }
 
   static bool IsStale(const Slice& value, int32_t ttl, SystemClock* clock);
 
+  // Whether all entries of the table are Puts that are stale at `curtime`,
+  // going by the properties of TtlTablePropertiesCollector
+  static bool IsFileExpired(const TableProperties& props, int32_t ttl,
+                            int64_t curtime);
+
   static Status AppendTS(const Slice& val, std::string* val_with_ts,
                          SystemClock* clock);
 
@@ -99,13 +114,22 @@ class DBWithTTLImpl : public DBWithTTL {
 
   static const int32_t kMaxTimestamp = 2147483647;  // 01/18/2038:7:14PM GMT-8
 
+  // The fixed32 timestamps of the oldest and newest Put of a table, only set
+  // if all of its entries are Puts
+  static const std::string kOldestTimestampProperty;
+  static const std::string kNewestTimestampProperty;
+
   void SetTtl(int32_t ttl) override { SetTtl(DefaultColumnFamily(), ttl); }
 
   void SetTtl(ColumnFamilyHandle *h, int32_t ttl) override;
 
  private:
+  // The TTL of the column family, 0 if it has none
+  int32_t GetTtl(ColumnFamilyHandle* column_family);
+
   // remember whether the Close completes or not
   bool closed_;
+  bool read_only_;
 };
 
 class TtlIterator : public Iterator {
@@ -187,6 +211,8 @@ class TtlCompactionFilter : public LayeredCompactionFilterBase {
 
   virtual const char* Name() const override { return "Delete By TTL"; }
 
+  int32_t ttl() const { return ttl_; }
+
  private:
   int32_t ttl_;
   SystemClock* clock_;
@@ -218,6 +244,8 @@ class TtlCompactionFilterFactory : public CompactionFilterFactory {
     ttl_ = ttl;
   }
 
+  int32_t ttl() const { return ttl_; }
+
   virtual const char* Name() const override {
     return "TtlCompactionFilterFactory";
   }
@@ -228,6 +256,71 @@ class TtlCompactionFilterFactory : public CompactionFilterFactory {
   std::shared_ptr<CompactionFilterFactory> user_comp_filter_factory_;
 };
 
+// Records the timestamps of the oldest and newest Put of a table, so that a
+// table that only holds expired Puts can be dropped without compacting it.
+class TtlTablePropertiesCollector : public TablePropertiesCollector {
+ public:
+  TtlTablePropertiesCollector()
+      : only_puts_(true),
+        oldest_(DBWithTTLImpl::kMaxTimestamp),
+        newest_(0) {}
+
+  Status AddUserKey(const Slice& /*key*/, const Slice& value, EntryType type,
+                    SequenceNumber /*seq*/,
+                    uint64_t /*file_size*/) override {
+    if (type != kEntryPut || value.size() < DBWithTTLImpl::kTSLength) {
+      only_puts_ = false;
+      return Status::OK();
+    }
+    int32_t timestamp = static_cast<int32_t>(DecodeFixed32(
+        value.data() + value.size() - DBWithTTLImpl::kTSLength));
+    oldest_ = std::min(oldest_, timestamp);
+    newest_ = std::max(newest_, timestamp);
+    return Status::OK();
+  }
+
+  Status Finish(UserCollectedProperties* properties) override {
+    if (only_puts_ && newest_ > 0) {
+      std::string encoded;
+      PutFixed32(&encoded, static_cast<uint32_t>(oldest_));
+      properties->emplace(DBWithTTLImpl::kOldestTimestampProperty, encoded);
+      encoded.clear();
+      PutFixed32(&encoded, static_cast<uint32_t>(newest_));
+      properties->emplace(DBWithTTLImpl::kNewestTimestampProperty, encoded);
+    }
+    return Status::OK();
+  }
+
+  UserCollectedProperties GetReadableProperties() const override {
+    if (!only_puts_ || newest_ == 0) {
+      return UserCollectedProperties{};
+    }
+    return UserCollectedProperties{
+        {DBWithTTLImpl::kOldestTimestampProperty, ToString(oldest_)},
+        {DBWithTTLImpl::kNewestTimestampProperty, ToString(newest_)}};
+  }
+
+  const char* Name() const override { return "TtlTablePropertiesCollector"; }
+
+ private:
+  bool only_puts_;
+  int32_t oldest_;
+  int32_t newest_;
+};
+
+class TtlTablePropertiesCollectorFactory
+    : public TablePropertiesCollectorFactory {
+ public:
+  TablePropertiesCollector* CreateTablePropertiesCollector(
+      TablePropertiesCollectorFactory::Context /*context*/) override {
+    return new TtlTablePropertiesCollector();
+  }
+
+  const char* Name() const override {
+    return "TtlTablePropertiesCollectorFactory";
+  }
+};
+
 class TtlMergeOperator : public MergeOperator {
 
  public:
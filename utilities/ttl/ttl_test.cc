@@ -719,6 +719,51 @@ TEST_F(TtlTest, DeleteRangeTest) {
   CloseTtl();
 }
 
+TEST_F(TtlTest, DropExpiredFiles) {
+  OpenTtl(1);
+  ASSERT_OK(db_ttl_->SetOptions({{"disable_auto_compactions", "true"}}));
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "a", "val"));
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "b", "val"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+  // Not dropped with the rest, as it holds a deletion
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "c", "val"));
+  ASSERT_OK(db_ttl_->Delete(WriteOptions(), "d"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+
+  std::vector<LiveFileMetaData> files;
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(2U, files.size());
+  ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+  files.clear();
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(2U, files.size());
+
+  env_->Sleep(2);
+  // Iterators skip the expired file before it is dropped
+  std::unique_ptr<Iterator> iter(db_ttl_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("c", iter->key().ToString());
+  iter->Next();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+  iter.reset();
+
+  ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+  files.clear();
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1U, files.size());
+  std::string value;
+  ASSERT_TRUE(db_ttl_->Get(ReadOptions(), "a", &value).IsNotFound());
+  ASSERT_OK(db_ttl_->Get(ReadOptions(), "c", &value));
+  CloseTtl();
+
+  OpenReadOnlyTtl(1);
+  ASSERT_TRUE(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily())
+                  .IsNotSupported());
+  CloseTtl();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 // A black-box test for the ttl wrapper around rocksdb
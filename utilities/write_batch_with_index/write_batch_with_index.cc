@@ -7,6 +7,7 @@
 
 #include "rocksdb/utilities/write_batch_with_index.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "db/column_family.h"
@@ -96,17 +97,15 @@ bool WriteBatchWithIndex::Rep::UpdateExistingEntryWithCfId(
     return false;
   } else if (!iter.MatchesKey(column_family_id, key)) {
     return false;
-  } else {
-    // Move to the end of this key (NextKey-Prev)
-    iter.NextKey();  // Move to the next key
-    if (iter.Valid()) {
-      iter.Prev();  // Move back one entry
-    } else {
-      iter.SeekToLast();
-    }
+  }
+  // Move to the last entry of this key. Stepping forward avoids Prev(), which
+  // searches the skip list from its head.
+  const WriteBatchIndexEntry* last_entry = iter.GetRawEntry();
+  for (iter.Next(); iter.MatchesKey(column_family_id, key); iter.Next()) {
+    last_entry = iter.GetRawEntry();
   }
   WriteBatchIndexEntry* non_const_entry =
-      const_cast<WriteBatchIndexEntry*>(iter.GetRawEntry());
+      const_cast<WriteBatchIndexEntry*>(last_entry);
   if (LIKELY(last_sub_batch_offset <= non_const_entry->offset)) {
     last_sub_batch_offset = last_entry_offset;
     sub_batch_cnt++;
@@ -162,9 +161,15 @@ void WriteBatchWithIndex::Rep::Clear() {
 }
 
 void WriteBatchWithIndex::Rep::ClearIndex() {
+  // A batch that outgrew the small blocks of its arena is likely to do so
+  // again after Clear(): give the new arena larger blocks, so that indexing a
+  // large batch allocates and frees fewer of them
+  const size_t block_size = std::max(
+      Arena::kMinBlockSize,
+      std::min<size_t>(1 << 20, arena.MemoryAllocatedBytes() / 16));
   skip_list.~WriteBatchEntrySkipList();
   arena.~Arena();
-  new (&arena) Arena();
+  new (&arena) Arena(block_size);
   new (&skip_list) WriteBatchEntrySkipList(comparator, &arena);
   last_entry_offset = 0;
   last_sub_batch_offset = 0;
@@ -628,5 +633,9 @@ size_t WriteBatchWithIndex::GetDataSize() const {
   return rep->write_batch.GetDataSize();
 }
 
+size_t WriteBatchWithIndex::GetIndexMemoryUsage() const {
+  return rep->arena.ApproximateMemoryUsage();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // !ROCKSDB_LITE
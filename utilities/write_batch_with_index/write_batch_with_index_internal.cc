@@ -359,7 +359,10 @@ void WBWIIteratorImpl::AdvanceKey(bool forward) {
   }
 }
 
-void WBWIIteratorImpl::NextKey() { AdvanceKey(true); }
+void WBWIIteratorImpl::NextKey() {
+  AdvanceKey(true);
+  at_key_start_ = true;
+}
 
 void WBWIIteratorImpl::PrevKey() {
   AdvanceKey(false);  // Move to the tail of the previous key
@@ -371,6 +374,7 @@ void WBWIIteratorImpl::PrevKey() {
     } else {
       SeekToFirst();  // Not valid, move to the start
     }
+    at_key_start_ = true;
   }
 }
 
@@ -395,6 +399,8 @@ WBWIIteratorImpl::Result WBWIIteratorImpl::FindLatestUpdate(
   } else if (comparator_->CompareKey(column_family_id_, Entry().key, key) !=
              0) {
     return result;
+  } else if (at_key_start_) {
+    return FindLatestUpdateForward(key, merge_context);
   } else {
     // We want to iterate in the reverse order that the writes were added to the
     // batch.  Since we don't have a reverse iterator, we must seek past the
@@ -446,6 +452,55 @@ WBWIIteratorImpl::Result WBWIIteratorImpl::FindLatestUpdate(
   return result;
 }
 
+WBWIIteratorImpl::Result WBWIIteratorImpl::FindLatestUpdateForward(
+    const Slice& key, MergeContext* merge_context) {
+  // The entries of a key are in the order they were added to the batch. Walk
+  // them forward, remembering the last Put or Delete and collecting the merges
+  // after it, rather than from the end backwards: Prev() on a skip list is a
+  // search from its head.
+  Result result = WBWIIteratorImpl::kNotFound;
+  WriteBatchEntrySkipList::Iterator update_iter = skip_list_iter_;
+  bool at_update = false;
+  do {
+    const WriteEntry entry = Entry();
+    switch (entry.type) {
+      case kPutRecord:
+        result = WBWIIteratorImpl::kFound;
+        break;
+      case kDeleteRecord:
+      case kSingleDeleteRecord:
+        result = WBWIIteratorImpl::kDeleted;
+        break;
+      case kMergeRecord:
+        if (result == WBWIIteratorImpl::kNotFound) {
+          result = WBWIIteratorImpl::kMergeInProgress;
+        }
+        merge_context->PushOperandBack(entry.value);
+        break;
+      case kLogDataRecord:
+      case kXIDRecord:
+        break;  // ignore
+      default:
+        result = WBWIIteratorImpl::kError;
+        break;
+    }
+    if (entry.type != kMergeRecord && entry.type != kLogDataRecord &&
+        entry.type != kXIDRecord) {
+      // Only the merges after it are still to be applied
+      update_iter = skip_list_iter_;
+      at_update = true;
+      merge_context->Clear();
+    }
+    skip_list_iter_.Next();
+  } while (MatchesKey(column_family_id_, key));
+
+  // Like the backward search, stop at the latest Put or Delete, or at the
+  // first entry of the key if there are only merges
+  skip_list_iter_ = update_iter;
+  at_key_start_ = !at_update;
+  return result;
+}
+
 Status ReadableWriteBatch::GetEntryFromDataOffset(size_t data_offset,
                                                   WriteType* type, Slice* Key,
                                                   Slice* value, Slice* blob,
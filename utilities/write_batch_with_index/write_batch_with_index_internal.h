@@ -187,7 +187,8 @@ class WBWIIteratorImpl : public WBWIIterator {
       : column_family_id_(column_family_id),
         skip_list_iter_(skip_list),
         write_batch_(write_batch),
-        comparator_(comparator) {}
+        comparator_(comparator),
+        at_key_start_(false) {}
 
   ~WBWIIteratorImpl() override {}
 
@@ -205,6 +206,7 @@ class WBWIIteratorImpl : public WBWIIterator {
         nullptr /* search_key */, column_family_id_,
         true /* is_forward_direction */, true /* is_seek_to_first */);
     skip_list_iter_.Seek(&search_entry);
+    at_key_start_ = true;
   }
 
   void SeekToLast() override {
@@ -217,6 +219,7 @@ class WBWIIteratorImpl : public WBWIIterator {
     } else {
       skip_list_iter_.Prev();
     }
+    at_key_start_ = false;
   }
 
   void Seek(const Slice& key) override {
@@ -224,6 +227,7 @@ class WBWIIteratorImpl : public WBWIIterator {
                                       true /* is_forward_direction */,
                                       false /* is_seek_to_first */);
     skip_list_iter_.Seek(&search_entry);
+    at_key_start_ = true;
   }
 
   void SeekForPrev(const Slice& key) override {
@@ -231,11 +235,18 @@ class WBWIIteratorImpl : public WBWIIterator {
                                       false /* is_forward_direction */,
                                       false /* is_seek_to_first */);
     skip_list_iter_.SeekForPrev(&search_entry);
+    at_key_start_ = false;
   }
 
-  void Next() override { skip_list_iter_.Next(); }
+  void Next() override {
+    skip_list_iter_.Next();
+    at_key_start_ = false;
+  }
 
-  void Prev() override { skip_list_iter_.Prev(); }
+  void Prev() override {
+    skip_list_iter_.Prev();
+    at_key_start_ = false;
+  }
 
   WriteEntry Entry() const override;
 
@@ -272,10 +283,17 @@ class WBWIIteratorImpl : public WBWIIterator {
   void AdvanceKey(bool forward);
 
  private:
+  // FindLatestUpdate() for an iterator at the first entry of the key
+  Result FindLatestUpdateForward(const Slice& key,
+                                 MergeContext* merge_context);
+
   uint32_t column_family_id_;
   WriteBatchEntrySkipList::Iterator skip_list_iter_;
   const ReadableWriteBatch* write_batch_;
   WriteBatchEntryComparator* comparator_;
+  // Whether the iterator is known to be at the first entry of its key, as
+  // after Seek(), SeekToFirst(), NextKey() and PrevKey()
+  bool at_key_start_;
 };
 
 class WriteBatchWithIndexInternal {
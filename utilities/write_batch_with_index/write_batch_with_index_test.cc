@@ -2212,6 +2212,36 @@ TEST_P(WriteBatchWithIndexTest, GetAfterMergeDelete) {
   ASSERT_EQ(value, "cc,dd");
 }
 
+TEST_P(WriteBatchWithIndexTest, IndexMemoryUsageAndClear) {
+  ASSERT_OK(OpenDB());
+  ColumnFamilyHandle* cf0 = db_->DefaultColumnFamily();
+  const size_t empty_usage = batch_->GetIndexMemoryUsage();
+  for (int round = 0; round < 2; round++) {
+    // Two entries per key, and a merge on top for every tenth key
+    for (int i = 0; i < 10000; i++) {
+      ASSERT_OK(batch_->Put("key" + ToString(i % 5000), "v" + ToString(i)));
+    }
+    for (int i = 0; i < 5000; i += 10) {
+      ASSERT_OK(batch_->Merge("key" + ToString(i), "m"));
+    }
+    const size_t usage = batch_->GetIndexMemoryUsage();
+    ASSERT_GT(usage, empty_usage + 5000 * sizeof(void*));
+
+    std::string value;
+    ASSERT_OK(batch_->GetFromBatch(cf0, options_, "key1", &value));
+    ASSERT_EQ("v5001", value);
+    ASSERT_OK(batch_->GetFromBatch(cf0, options_, "key10", &value));
+    ASSERT_EQ("v5010,m", value);
+    ASSERT_TRUE(
+        batch_->GetFromBatch(cf0, options_, "key5000", &value).IsNotFound());
+
+    batch_->Clear();
+    ASSERT_LT(batch_->GetIndexMemoryUsage(), usage);
+    ASSERT_TRUE(
+        batch_->GetFromBatch(cf0, options_, "key1", &value).IsNotFound());
+  }
+}
+
 TEST_F(WBWIOverwriteTest, TestBadMergeOperator) {
   class FailingMergeOperator : public MergeOperator {
    public: